@@ -7,6 +7,7 @@
 #ifndef PACKAGER_PUBLIC_AD_CUE_GENERATOR_PARAMS_H_
 #define PACKAGER_PUBLIC_AD_CUE_GENERATOR_PARAMS_H_
 
+#include <cstdint>
 #include <vector>
 
 namespace shaka {
@@ -23,6 +24,11 @@ struct Cuepoint {
 struct AdCueGeneratorParams {
   /// List of cuepoints.
   std::vector<Cuepoint> cue_points;
+
+  /// Maximum size, in bytes, of the sample payloads each input buffers in
+  /// memory while waiting for the streams to line up at a cue. The payloads
+  /// past it are spilled to a temporary file. 0 means that there is no limit.
+  uint64_t max_buffered_bytes_per_input = 0;
 };
 
 }  // namespace shaka
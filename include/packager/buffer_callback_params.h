@@ -9,6 +9,8 @@
 
 #include <cstdint>
 #include <functional>
+#include <string>
+#include <vector>
 
 namespace shaka {
 
@@ -29,6 +31,26 @@ struct BufferCallbackParams {
   std::function<
       int64_t(const std::string& name, const void* buffer, uint64_t size)>
       write_func;
+
+  /// Describes a media segment given to @a segment_write_func.
+  struct SegmentInfo {
+    /// The label of the segment, from @a StreamDescriptor.segment_template.
+    std::string name;
+    /// The label of the stream, from @a StreamDescriptor.output.
+    std::string stream_name;
+    int64_t segment_number = 0;
+    /// The start time and duration of the segment, in @a timescale units.
+    int64_t start_time = 0;
+    int64_t duration = 0;
+    uint32_t timescale = 0;
+  };
+  /// If this function is specified, along with @a write_func, the media
+  /// segments of the MP4 outputs with a @a StreamDescriptor.segment_template
+  /// are passed to it whole, once finished, as one buffer handed over to the
+  /// function, instead of being written with @a write_func.
+  /// @return true on success, false otherwise.
+  std::function<bool(const SegmentInfo& info, std::vector<uint8_t> data)>
+      segment_write_func;
 };
 
 }  // namespace shaka
@@ -97,6 +97,16 @@ struct WidevineEncryptionParams {
   std::vector<uint8_t> group_id;
   /// Enables entitlement license when set to true.
   bool enable_entitlement_license;
+  /// Time to live, in seconds, of cached key server responses. Responses are
+  /// not cached if it is not positive. The cache is shared by all the jobs
+  /// of the process with the same cache settings.
+  int64_t key_cache_ttl_seconds = 0;
+  /// Directory where cached responses are persisted, so that they survive
+  /// restarts. Responses are only cached in memory if it is empty.
+  std::string key_cache_dir;
+  /// 16-byte AES key used to encrypt the persisted responses. Required if
+  /// `key_cache_dir` is not empty.
+  std::vector<uint8_t> key_cache_encryption_key;
 };
 
 /// PlayReady encryption parameters.
@@ -181,6 +191,17 @@ struct EncryptionParams {
   double crypto_period_duration_in_seconds = kNoKeyRotation;
   /// Enable/disable subsample encryption for VP9.
   bool vp9_subsample_encryption = true;
+  /// Maximum number of samples of a stream that are encrypted concurrently on
+  /// worker threads. Samples are still output in order. Applies to the 'cenc'
+  /// protection scheme only, whose samples can be encrypted independently.
+  /// 0 or 1 means samples are encrypted on the calling thread.
+  uint32_t sample_encryption_threads = 0;
+  /// Derive the IV of each sample from the key, the decoding timestamp and the
+  /// content of the sample, instead of incrementing it from sample to sample,
+  /// so that the output does not depend on where packaging started, e.g. with
+  /// Packager::PackageInParallel or when packaging is resumed. Each sample is
+  /// hashed. Ignored with constant IVs, e.g. with 'cbcs'.
+  bool derive_sample_ivs = false;
 
   /// Encrypted stream information that is used to determine stream label.
   struct EncryptedStreamAttributes {
@@ -232,6 +253,10 @@ struct DecryptionParams {
   // Only one of the two fields is valid.
   WidevineDecryptionParams widevine;
   RawKeyParams raw_key;
+  /// Maximum number of samples of an MP4 input that are decrypted concurrently
+  /// on worker threads, off the demuxing thread. Samples are still output in
+  /// order. 0 or 1 means samples are decrypted on the demuxing thread.
+  uint32_t sample_decryption_threads = 0;
 };
 
 }  // namespace shaka
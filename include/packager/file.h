@@ -7,6 +7,7 @@
 #ifndef PACKAGER_PUBLIC_FILE_H_
 #define PACKAGER_PUBLIC_FILE_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -22,8 +23,22 @@ extern const char* kLocalFilePrefix;
 extern const char* kMemoryFilePrefix;
 extern const char* kUdpFilePrefix;
 extern const char* kHttpFilePrefix;
+extern const char* kShmFilePrefix;
 const int64_t kWholeFile = -1;
 
+/// How durable the atomic writes of local files, e.g. of the manifests, are.
+enum class FileDurability {
+  /// The file is replaced without waiting for its data to reach the disk,
+  /// e.g. for files on tmpfs. A crash may leave an empty or partial file.
+  kNone,
+  /// The data of the file reaches the disk before the file is replaced, so a
+  /// crash leaves either the previous or the new file.
+  kSyncFile,
+  /// The replacement of the file also reaches the disk before the write
+  /// returns, so the new file survives a crash.
+  kSyncFileAndDirectory,
+};
+
 /// Define an abstract file interface.
 class SHAKA_EXPORT File {
  public:
@@ -37,7 +52,9 @@ class SHAKA_EXPORT File {
 
   /// Open the specified file in direct-access mode (no buffering).
   /// This is a file factory method, it opens a proper file automatically
-  /// based on prefix, e.g. "file://" for LocalFile.
+  /// based on prefix, e.g. "file://" for LocalFile. Prefer it over Open() to
+  /// write a file from a buffer held whole, e.g. a media segment, which
+  /// does not benefit from threaded I/O.
   /// @param file_name contains the name of the file to be accessed.
   /// @param mode contains file access mode. Implementation dependent.
   /// @return A File pointer on success, false otherwise.
@@ -69,12 +86,32 @@ class SHAKA_EXPORT File {
   /// @return Number of bytes written, or a value < 0 on error.
   virtual int64_t Write(const void* buffer, uint64_t length) = 0;
 
+  /// A block of data, for WriteV().
+  struct IoBuffer {
+    const void* data;
+    uint64_t size;
+  };
+
+  /// Write blocks of data, in order, as a single write where the file type
+  /// supports it, so that they need not be concatenated first. Unlike
+  /// Write(), it writes all the data or fails.
+  /// @param buffers points to @a num_buffers blocks of data.
+  /// @param num_buffers indicates the number of blocks.
+  /// @return Number of bytes written, or a value < 0 on error.
+  virtual int64_t WriteV(const IoBuffer* buffers, size_t num_buffers);
+
   /// Close the file for writing.  This signals that no more data will be
   /// written.  Future writes are invalid and their behavior is undefined!
   /// Data may still be read from the file after calling this method.
   /// Some implementations may ignore this if they cannot use the signal.
   virtual void CloseForWriting() = 0;
 
+  /// Abort the file.  A Read() or Write() blocked in another thread, e.g.
+  /// waiting for the network, and the later ones fail soon.  It may be called
+  /// from any thread while the file is open; Close() must still be called.
+  /// Implementations which never block for long may ignore it.
+  virtual void Abort() {}
+
   /// @return Size of the file in bytes. A return value less than zero
   ///         indicates a problem getting the size.
   virtual int64_t Size() = 0;
@@ -129,6 +166,10 @@ class SHAKA_EXPORT File {
   static bool WriteFileAtomically(const char* file_name,
                                   const std::string& contents);
 
+  /// Set the durability of WriteFileAtomically() for local files, for the
+  /// whole process. It is kNone by default. Ignored on Windows.
+  static void SetAtomicWriteDurability(FileDurability durability);
+
   /// Copies files. This is not good for copying huge files. Although not
   /// recommended, it is safe to have source file and destination file name be
   /// the same.
@@ -72,6 +72,49 @@ struct HlsParams {
   std::optional<double> start_time_offset;
   /// Create EXT-X-SESSION-KEY in master playlist
   bool create_session_keys;
+  /// Enables LL-HLS output. The CMAF chunks of the segments are published as
+  /// partial segments (EXT-X-PART) as soon as they are written, with
+  /// EXT-X-PRELOAD-HINT, EXT-X-SERVER-CONTROL and EXT-X-RENDITION-REPORT tags.
+  /// Requires low latency chunking (ChunkingParams::low_latency_dash_mode) and
+  /// a live or event playlist.
+  bool low_latency_hls_mode = false;
+  /// The target duration of the partial segments in seconds, i.e. the value
+  /// of EXT-X-PART-INF:PART-TARGET. Consecutive chunks are grouped into
+  /// partial segments no longer than this duration.
+  double part_target_duration = 1.0;
+  /// Enables Playlist Delta Updates. The media playlists advertise
+  /// EXT-X-SERVER-CONTROL:CAN-SKIP-UNTIL, and a delta update playlist, with
+  /// the older segments replaced by EXT-X-SKIP, is written next to each of
+  /// them with "_skip" appended to the file name. It is meant to be served
+  /// for the requests with the _HLS_skip=YES query parameter. Requires a live
+  /// or event playlist.
+  bool delta_updates = false;
+  /// If positive, BANDWIDTH and AVERAGE-BANDWIDTH are computed from the last
+  /// this many segments of the media playlists only, instead of all the
+  /// segments, so that they follow the current bitrate of long running live
+  /// streams.
+  uint32_t bandwidth_window_segments = 0;
+  /// Save the state of the live and event media playlists, e.g. their
+  /// segments and their media sequence number, next to each of them with
+  /// ".state" appended to the file name, whenever they are written. A
+  /// packager restarted with the same playlists then restores them and
+  /// continues them, instead of starting them over. The segments of the
+  /// restarted packager must not reuse the names of the restored segments,
+  /// e.g. with `$Time$` or ChunkingParams::start_segment_number.
+  bool save_playlist_state = false;
+  /// Also write the playlists compressed with gzip, next to them with ".gz"
+  /// appended to the file names, whenever they are written, so that the
+  /// origin can serve them without compressing them for each request.
+  bool write_gzip_playlists = false;
+  /// If not empty, the segments of a live playlist which leave the live
+  /// window are kept in memory, and once the live presentation
+  /// ends, a VOD master playlist is written to this path, with VOD media
+  /// playlists of all the segments, named after the live ones with "_vod"
+  /// appended before their extension. The segments are not demuxed again.
+  /// It must be in the same directory as 'master_playlist_output', and
+  /// 'preserved_segments_outside_live_window' must be zero so that the
+  /// segments are kept.
+  std::string vod_archive_master_playlist_output;
 };
 
 }  // namespace shaka
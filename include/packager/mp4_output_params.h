@@ -26,6 +26,43 @@ struct Mp4OutputParams {
   /// and mdat atom. Each chunk is uploaded immediately upon creation,
   /// decoupling latency from segment duration.
   bool low_latency_dash_mode = false;
+  /// Open the file of the next media segment as soon as a media segment is
+  /// written, so that opening it, e.g. connecting to an HTTP server, is not on
+  /// the path of publishing the segment. Only applies to segment templates
+  /// without $Time$, where the name of the next segment is known in advance.
+  /// The file of the next segment exists, empty, until it is written.
+  bool preopen_next_segment = false;
+  /// Insert an event message box in the media segments for each cue, with
+  /// the SCTE-35 scheme and the cue data as the message. Applies to segment
+  /// templates and low latency DASH.
+  bool include_emsg_in_segments = false;
+  /// Insert a producer reference time box in each media segment, mapping its
+  /// earliest presentation time to the wall-clock time it is written at.
+  bool include_prft_in_segments = false;
+  /// Write the media segments in the background, so that a slow write, e.g.
+  /// an HTTP upload, does not hold up the muxer. The listeners are notified
+  /// of a segment once it is written, in order. Does not apply to callback
+  /// outputs.
+  bool async_segment_uploads = false;
+  /// The most media segments of an output being written in the background.
+  /// The muxer waits for the oldest segment to be written beyond that.
+  int max_pending_segment_uploads = 2;
+  /// Copy the fragments of a fragmented MP4 input with a single clear track
+  /// verbatim into the media segments of a segment template output, instead
+  /// of remuxing its samples, when nothing else needs its samples, i.e. no
+  /// encryption, decryption, trick play, ad cues, language override or low
+  /// latency DASH. The 'moov' of the input is the init segment. The segments
+  /// start at the fragments of the input, so the fragments are not split.
+  bool passthrough_fragments = false;
+  /// Append consecutive media segments of a segment template output to one
+  /// file, named after its first segment, until the file holds at least this
+  /// many seconds of media, so that an object store receives one object per
+  /// bundle rather than per segment. The manifests address the segments with
+  /// byte ranges. As a bundle is only complete once closed, its segments are
+  /// added to the manifests when the bundle is closed. 0 writes each segment
+  /// to its own file. Does not apply to low latency DASH or callback
+  /// outputs, and bundles are not written in the background.
+  double segment_bundle_duration_in_seconds = 0;
 };
 
 }  // namespace shaka
@@ -28,6 +28,12 @@ struct MpdParams {
   /// Set MPD@minimumUpdatePeriod attribute, which indicates to the player how
   /// often to refresh the MPD in seconds. For dynamic MPD only.
   double minimum_update_period = 0;
+  /// The minimum interval, in seconds, between two writes of a dynamic MPD.
+  /// When set, new segments only mark the MPD as changed and a background
+  /// thread writes it out at most once per interval, instead of regenerating
+  /// it for every segment of every representation. The MPD is written on
+  /// every new segment if the value is 0. For dynamic MPD only.
+  double min_write_interval = 0;
   /// Set MPD@suggestedPresentationDelay attribute. For 'dynamic' media
   /// presentations, it specifies a delay, in seconds, to be added to the media
   /// presentation time. The attribute is not set if the value is 0; the client
@@ -44,6 +50,19 @@ struct MpdParams {
   /// accessible as they may still be accessed by the player. The segments are
   /// not removed if the value is zero.
   size_t preserved_segments_outside_live_window = 0;
+  /// If not empty, the segments of a dynamic MPD which leave the live window
+  /// are kept in memory, and once the live presentation ends, a static MPD of
+  /// all the segments is written to this path. The segments are not demuxed
+  /// again. It must be in the same directory as 'mpd_output', and
+  /// 'preserved_segments_outside_live_window' must be zero so that the
+  /// segments are kept.
+  std::string vod_archive_mpd_output;
+  /// If not empty, an MPD Patch with the changes since the previous MPD, e.g.
+  /// the segments added and removed, is written to this path whenever a
+  /// dynamic MPD is written, and the MPD references it in a PatchLocation
+  /// element, so that the clients can update their MPD instead of
+  /// downloading it again. It must be in the same directory as 'mpd_output'.
+  std::string mpd_patch_output;
   /// UTCTimings. For dynamic MPD only.
   struct UtcTiming {
     std::string scheme_id_uri;
@@ -102,6 +121,14 @@ struct MpdParams {
   /// and is greatly influnced by the player.
   /// This parameter is required by DASH-IF Low Latency standards.
   double target_latency_seconds = 1;
+  /// If positive, the bandwidth of the Representations is computed from the
+  /// last this many segments only, instead of all the segments, so that it
+  /// follows the current bitrate of long running live streams.
+  uint32_t bandwidth_window_segments = 0;
+  /// Also write the MPD compressed with gzip, next to it with ".gz" appended
+  /// to the file name, whenever it is written, so that the origin can serve
+  /// it without compressing it for each request.
+  bool write_gzip_mpd = false;
 };
 
 }  // namespace shaka
@@ -7,7 +7,9 @@
 #ifndef PACKAGER_PUBLIC_PACKAGER_H_
 #define PACKAGER_PUBLIC_PACKAGER_H_
 
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -26,6 +28,19 @@
 
 namespace shaka {
 
+class MediaInfo;
+
+/// The format of MediaInfo files.
+enum class MediaInfoFormat {
+  /// Human readable protobuf text format, in files suffixed `.media_info`.
+  kText,
+  /// Binary protobuf format, in files suffixed `.media_info.pb`. Faster to
+  /// write and parse than the text format.
+  kBinary,
+  /// Protobuf JSON format, in files suffixed `.media_info.json`.
+  kJson,
+};
+
 /// Parameters used for testing.
 struct TestParams {
   /// Whether to dump input stream info.
@@ -33,15 +48,124 @@ struct TestParams {
   /// Inject a fake clock which always returns 0. This allows deterministic
   /// output from packaging.
   bool inject_fake_clock = false;
+  /// If set, the clock of the muxers and the MPD, e.g. to run live packaging
+  /// in simulated time, faster than real time. It overrides
+  /// `inject_fake_clock` and is called from the packaging threads.
+  std::function<std::chrono::system_clock::time_point()> clock;
   /// Inject and replace the library version string if specified, which is used
   /// to populate the version string in the manifests / media files.
   std::string injected_library_version;
 };
 
+/// How the packaging jobs are placed on the CPUs.
+enum class CpuPlacement {
+  /// The jobs run on any of the CPUs.
+  kNone,
+  /// Each job runs on a CPU of its own, the CPUs being assigned in turn.
+  kPerJob,
+  /// Each job runs on the CPUs of a NUMA node, the nodes being assigned in
+  /// turn, so that the memory of its samples and I/O buffers is local to it.
+  kPerNumaNode,
+};
+
+/// CPU placement parameters, only supported on Linux. They apply to the
+/// thread running each job, to the threads it starts, e.g. for the outputs
+/// with `thread_per_output`, and to the file I/O threads working for it.
+struct CpuPlacementParams {
+  /// The CPUs the jobs of the packager run on, as a list of CPUs and ranges
+  /// of CPUs, e.g. "0-11,48-59". The packagers of a process, e.g. one per
+  /// channel, can each be given CPUs of their own. If empty, the jobs run on
+  /// the CPUs of the thread which initializes the packager.
+  std::string cpus;
+  /// How the jobs are placed on `cpus`.
+  CpuPlacement placement = CpuPlacement::kNone;
+};
+
+/// The priority of the work of a packager relative to the other packagers of
+/// the process.
+enum class PriorityClass {
+  /// Latency-sensitive work, e.g. a live channel. It is never throttled.
+  kLive,
+  /// Work using the capacity left over by the live packagers, e.g. VOD
+  /// backfill. Its job threads run at a lower scheduling priority, and while
+  /// live packagers run, its file I/O is limited to
+  /// `background_io_bytes_per_second`.
+  kBackground,
+};
+
+/// The resources of a packager, so that the packagers of a process, e.g. the
+/// tenants of a service, cannot starve each other. The limits apply to the
+/// threads of the jobs of the packager, to the threads they start and to the
+/// file I/O threads working for them. Zero means no limit.
+struct ResourceQuotaParams {
+  /// The share of the CPUs of the machine the packager may use, e.g. 0.25 for
+  /// a quarter of them. The demuxers and the file writers are held back while
+  /// the packager is over it.
+  double cpu_share = 0;
+  /// The memory of the I/O caches of the files of the packager, in bytes.
+  /// The caches of the files opened once it is used up are shrunk, down to a
+  /// block each.
+  uint64_t memory_bytes = 0;
+  /// The number of HTTP uploads of the packager in flight at once. The other
+  /// uploads wait for one of them to complete. The single-file outputs upload
+  /// for the whole run, so it must be larger than their number.
+  uint32_t max_uploads_in_flight = 0;
+};
+
+/// The progress of a packager, measured from the inputs read by its demuxers
+/// and the segments written by its muxers. The rates are averaged since the
+/// packager started running.
+struct PackagingProgress {
+  /// The fraction of the inputs read, from 0 to 1, or -1 if it is unknown,
+  /// e.g. for live inputs. It is that of the least advanced input, from its
+  /// duration if known, otherwise from its size.
+  double fraction = -1;
+  /// The media time read from the least advanced input.
+  double media_seconds = 0;
+  /// The wall-clock time since the packager started running.
+  double elapsed_seconds = 0;
+  /// The media seconds processed per wall-clock second.
+  double realtime_factor = 0;
+  /// The bytes read from the inputs and written to the segments.
+  uint64_t input_bytes = 0;
+  uint64_t output_bytes = 0;
+  double input_bytes_per_second = 0;
+  double output_bytes_per_second = 0;
+  /// The estimated time left, or -1 if `fraction` is unknown.
+  double eta_seconds = -1;
+};
+
+/// The pages backing the large buffers of the process, e.g. the I/O caches and
+/// the fragment buffers. Huge pages are only supported on Linux.
+enum class HugePageMode {
+  /// Regular pages.
+  kNone,
+  /// Transparent huge pages, which the kernel provides when it can.
+  kTransparent,
+  /// Huge pages reserved by the administrator, e.g. with
+  /// /proc/sys/vm/nr_hugepages, falling back to transparent huge pages.
+  kExplicit,
+};
+
+/// What to do with the streams of an input which have not started when the
+/// samples queued for them exceed `max_pending_stream_bytes`.
+enum class PendingStreamPolicy {
+  /// Fail the input.
+  kFail,
+  /// Drop the streams which have not started and go on with the others.
+  /// Only MPEG-2 TS inputs can drop streams; the other inputs fail.
+  kDrop,
+};
+
 /// Packaging parameters.
 struct PackagingParams {
   /// Specify temporary directory for intermediate temporary files.
   std::string temp_dir;
+  /// Write single-segment WebM output in one pass: space for the Cues is
+  /// reserved after the header and filled in at the end, instead of writing
+  /// the clusters to a temporary file and copying them afterwards. Requires
+  /// seekable output files.
+  bool webm_one_pass_single_segment = false;
   /// MP4 (ISO-BMFF) output related parameters.
   Mp4OutputParams mp4_output_params;
   /// The offset to be applied to transport stream (e.g. MPEG2-TS, HLS packed
@@ -61,9 +185,132 @@ struct PackagingParams {
   /// Create a human readable format of MediaInfo. The output file name will be
   /// the name specified by output flag, suffixed with `.media_info`.
   bool output_media_info = false;
+  /// The format of the MediaInfo files created with `output_media_info`.
+  MediaInfoFormat media_info_format = MediaInfoFormat::kText;
+  /// If set, called with the MediaInfo of each output once it is complete,
+  /// which passes it to library users without going through files. As
+  /// `output_media_info`, it is only supported with the on-demand profile.
+  /// MediaInfo is defined in packager/mpd/base/media_info.proto.
+  std::function<void(const std::string& output, const MediaInfo& media_info)>
+      media_info_callback;
   /// Only use a single thread to generate output.  This is useful in tests to
   /// avoid non-deterministic outputs.
   bool single_threaded = false;
+  /// Run the handlers of each output stream (everything after the point where
+  /// an input stream is replicated to its outputs, including the muxer) in a
+  /// dedicated thread, handing stream data over through a bounded queue. This
+  /// allows outputs sharing a single input, e.g. an ABR ladder from one
+  /// mezzanine, to be processed in parallel. Ignored if `single_threaded` is
+  /// set.
+  bool thread_per_output = false;
+  /// The maximum number of threads used to run packaging jobs, which is one
+  /// job per input. Jobs which do not get a thread wait for an earlier job to
+  /// complete. Zero means one thread per input. It is ignored if ad cues are
+  /// specified, as cue alignment requires all inputs to be processed
+  /// concurrently.
+  uint32_t job_threads = 0;
+  /// The CPUs the jobs run on. Where each job ends up is logged when the jobs
+  /// are initialized.
+  CpuPlacementParams cpu_placement_params;
+  /// The priority of the jobs of the packager.
+  PriorityClass priority_class = PriorityClass::kLive;
+  /// If set, called with the progress of the packager every
+  /// `progress_interval_ms`, and once more when the packager completes. It
+  /// is called from the threads of the packager, one call at a time, and must
+  /// return quickly. The progress can also be polled with
+  /// Packager::GetProgress().
+  std::function<void(const PackagingProgress& progress)> progress_callback;
+  /// The time between two calls of `progress_callback`.
+  uint32_t progress_interval_ms = 1000;
+  /// The resources the packager may use, see Packager::GetResourceUsage().
+  ResourceQuotaParams resource_quota_params;
+  /// The file I/O rate of the background packagers, in bytes per second,
+  /// while live packagers run, or 0 for no limit. It is shared by all the
+  /// packagers of the process.
+  uint64_t background_io_bytes_per_second = 0;
+  /// Parse local MP4 inputs directly from a read-only memory mapping instead
+  /// of reading them through a buffered file. The file must not grow while it
+  /// is being packaged.
+  bool mmap_local_inputs = false;
+  /// The number of threads used to parse each fragmented MP4 input. If larger
+  /// than 1, the fragments of seekable inputs are split into ranges which are
+  /// parsed in parallel, and their samples are merged back in order. Inputs
+  /// which need to be decrypted are always parsed sequentially.
+  uint32_t parsing_threads = 0;
+  /// The maximum size of the samples of an input queued until all its streams
+  /// have started, e.g. until an audio PID of an MPEG-2 TS input which starts
+  /// late sends its configuration, or 0 for no limit.
+  uint64_t max_pending_stream_bytes = 0;
+  /// What to do when `max_pending_stream_bytes` is exceeded.
+  PendingStreamPolicy pending_stream_policy = PendingStreamPolicy::kFail;
+  /// Share the demuxing of each input with the other packagers of the process
+  /// which set this option and read the same input, e.g. the same live source.
+  /// The input is then read once, by the first packager to run. Its demuxer
+  /// settings apply to all the packagers sharing it, and a packager which
+  /// joins once the input is being read starts from the next key frame.
+  bool share_inputs = false;
+  /// Run the text inputs which only have text streams, e.g. WebVTT subtitles
+  /// in many languages, in a single job rather than one job each. The text
+  /// inputs are read in full before their streams are processed together.
+  /// Ignored for the inputs shared with `share_inputs`.
+  bool multiplex_text_inputs = false;
+  /// In live packaging, the text streams of an input with other streams, e.g.
+  /// the subtitles of an MPEG-2 TS input, which have had no sample for this
+  /// long in the media time of the other streams are advanced with empty
+  /// segments up to them, less this interval, instead of holding back their
+  /// output and the cue alignment until their next sample. It must be longer
+  /// than the delay of the text samples behind the other streams. 0 disables
+  /// it.
+  uint32_t text_heartbeat_interval_ms = 0;
+  /// Collect statistics of the media handlers of the audio and video
+  /// pipelines, see Packager::GetHandlerStats.
+  bool collect_handler_stats = false;
+  /// A budget for the memory of the process, in bytes, or 0 for no budget.
+  /// While the memory counted in Packager::GetMemoryStats() exceeds it, the
+  /// demuxers and the file writers are throttled. It is shared by all the
+  /// packagers of the process.
+  uint64_t memory_budget_bytes = 0;
+  /// The durability of the atomic writes of local files, e.g. of the
+  /// manifests, see File::SetAtomicWriteDurability(). It applies to all the
+  /// packagers of the process.
+  FileDurability atomic_write_durability = FileDurability::kNone;
+  /// The pages backing the large buffers allocated from now on. It applies
+  /// to all the packagers of the process.
+  HugePageMode huge_page_mode = HugePageMode::kNone;
+  /// The crypto library running the AES ciphers of the encryption and
+  /// decryption: "mbedtls", or "openssl" if the packager is built with
+  /// USE_OPENSSL_CRYPTO. It applies to all the packagers of the process.
+  std::string crypto_backend = "mbedtls";
+  /// If set, write a line of JSON to this file for each segment written, with
+  /// the wall-clock times at which the segment went through the packager, from
+  /// its first sample to its manifest update.
+  std::string segment_latency_log;
+  /// If set, send a line of JSON to this URL for each segment written, once
+  /// it is written, with its name, size, timestamps and output, e.g. for a CDN
+  /// to prefetch the segments. A udp:// URL receives a datagram for each
+  /// segment, and an http:// or https:// URL receives POST requests with
+  /// batches of lines. The events are sent from a thread of their own, and
+  /// are dropped if the URL does not keep up.
+  std::string segment_event_url;
+  /// If set, this packager is a node of a distributed packager: instead of
+  /// writing the manifests, it sends its manifest notifications to the
+  /// aggregator at this http:// or https:// URL, which writes the manifests of
+  /// the streams of all the nodes. The nodes must use the same segment
+  /// duration, start segment number and encryption keys. Only live outputs,
+  /// with a segment template, are supported.
+  std::string manifest_aggregator_url;
+  /// Identifies this node to the aggregator, in its logs.
+  std::string manifest_node_id;
+  /// For the single-file outputs, write a binary index of the byte ranges of
+  /// the segments and of their key frames next to each output, at its name
+  /// with ".idx" appended, so that the segments can be served without parsing
+  /// the output.
+  bool output_segment_index = false;
+  /// If set, the manifest and media info updates of each stream run on a
+  /// thread of their own, in order, so that the packaging of the stream does
+  /// not wait for the manifest writes. The updates are done when the stream
+  /// ends.
+  bool async_manifest_updates = false;
 
   /// DASH MPD related parameters.
   MpdParams mpd_params;
@@ -81,12 +328,66 @@ struct PackagingParams {
   TestParams test_params;
 };
 
+/// Statistics of one media handler of a packaging pipeline.
+struct HandlerStats {
+  /// Identifies the handler: the input, the stream selector and the output it
+  /// belongs to, followed by its type, e.g. "in.mp4:video/out.mp4/Muxer".
+  std::string label;
+  /// The number of samples processed. For demuxers, the number of samples
+  /// read.
+  uint64_t samples = 0;
+  /// The payload size of the media samples processed.
+  uint64_t bytes = 0;
+  /// Time spent in the handler, excluding the time spent in the handlers
+  /// downstream of it and blocked.
+  double process_seconds = 0;
+  /// Time spent blocked, e.g. waiting for room in a full queue or for the
+  /// other inputs to reach an ad cue.
+  double blocked_seconds = 0;
+};
+
+/// Memory used by one of the largest consumers of memory of the packager.
+struct SubsystemMemoryStats {
+  /// Identifies the subsystem, e.g. "media_samples" or "io_caches".
+  std::string name;
+  /// The bytes in use. Sample payloads queued by other subsystems are also
+  /// counted as "media_samples".
+  int64_t bytes = 0;
+  /// The highest number of bytes used.
+  int64_t peak_bytes = 0;
+};
+
+/// Memory statistics of the process.
+struct MemoryStats {
+  /// The peak resident set size of the process, or 0 if it is not available.
+  int64_t peak_rss_bytes = 0;
+  /// Memory of the largest consumers, which accounts for part of the resident
+  /// set size.
+  std::vector<SubsystemMemoryStats> subsystems;
+};
+
+/// The resources used by a packager, counted whether or not it has a
+/// ResourceQuotaParams limit.
+struct ResourceUsage {
+  /// The CPU time of the threads of the packager.
+  double cpu_seconds = 0;
+  /// The memory of the I/O caches of the files of the packager.
+  uint64_t memory_bytes = 0;
+  /// The highest `memory_bytes`.
+  uint64_t peak_memory_bytes = 0;
+  /// The HTTP uploads in flight.
+  uint32_t uploads_in_flight = 0;
+  /// Time the threads of the packager were held back by its limits.
+  double throttled_seconds = 0;
+};
+
 /// Defines a single input/output stream.
 struct StreamDescriptor {
   /// index of the stream to enforce ordering
   std::optional<uint32_t> index;
 
   /// Input/source media file path or network stream URL. Required.
+  /// An input starting with "push://" is fed with Packager::PushInput().
   std::string input;
 
   /// Stream selector, can be `audio`, `video`, `text` or a zero based stream
@@ -163,6 +464,17 @@ struct StreamDescriptor {
 
   /// Optional for DASH output. It defines the Label element in Adaptation Set.
   std::string dash_label;
+
+  /// Optional start of the clip of the input to package, in seconds of the
+  /// input timeline. Each stream starts at its last key frame at or before
+  /// it, so that the clip can be decoded. Non-fragmented MP4 inputs are read
+  /// from there instead of from the start. All the streams of an input must
+  /// have the same clip.
+  std::optional<double> clip_start_in_seconds;
+  /// Optional end of the clip of the input to package, in seconds of the
+  /// input timeline. The samples decoded at or after it are dropped, and the
+  /// input is not read further once all its streams have reached it.
+  std::optional<double> clip_end_in_seconds;
 };
 
 class SHAKA_EXPORT Packager {
@@ -177,17 +489,162 @@ class SHAKA_EXPORT Packager {
   Status Initialize(const PackagingParams& packaging_params,
                     const std::vector<StreamDescriptor>& stream_descriptors);
 
+  /// Reinitialize the packaging pipeline for other streams, e.g. the next
+  /// clip of a batch packaged with the same settings. The packaging
+  /// parameters given to Initialize() are kept, and so is what was set up for
+  /// them once, e.g. the encryption key source with the keys it has fetched.
+  /// Call it once Run() has returned.
+  /// @param stream_descriptors a list of stream descriptors.
+  /// @return OK on success, an appropriate error code on failure. The
+  ///         packager cannot run after a failure, until reinitialized.
+  Status Reinitialize(const std::vector<StreamDescriptor>& stream_descriptors);
+
   /// Run the pipeline to completion (or failed / been cancelled). Note
   /// that it blocks until completion.
   /// @return OK on success, an appropriate error code on failure.
   Status Run();
 
+  /// Start running the pipeline in the background, and return immediately.
+  /// Call Wait() before running, reinitializing or starting it again.
+  /// Destroying the packager cancels the pipeline if it is still running.
+  /// @param completion_callback is called, if set, from the background thread
+  ///        once the pipeline has completed (or failed / been cancelled), with
+  ///        what Run() would have returned. It must not call Wait().
+  /// @return OK if the pipeline is started, an error otherwise.
+  Status Start(std::function<void(const Status& status)> completion_callback);
+
+  /// Wait for the pipeline started with Start() to complete.
+  /// @return The status given to the completion callback.
+  Status Wait();
+
+  /// Feed data to an input whose StreamDescriptor::input starts with
+  /// "push://", e.g. from an event loop. Its demuxer reads the data as it is
+  /// pushed, without copying it beforehand, and blocks until there is more
+  /// data or EndInput() is called. It can be called from any thread, before
+  /// or while the pipeline runs.
+  /// @param input is the StreamDescriptor::input, e.g. "push://live".
+  /// @param data is the next bytes of the input.
+  /// @return OK on success, an error if there is no such input or it has
+  ///         ended.
+  Status PushInput(const std::string& input, std::vector<uint8_t> data);
+
+  /// Mark the end of an input fed with PushInput().
+  /// @param input is the StreamDescriptor::input, e.g. "push://live".
+  /// @return OK on success, an error if there is no such input.
+  Status EndInput(const std::string& input);
+
   /// Cancel packaging. Note that it has to be called from another thread.
+  /// Reads blocked on the network and waits for encryption keys are aborted.
+  /// The encryption keys cannot be fetched anymore once cancelled, so a
+  /// cancelled packager cannot be reinitialized to encrypt.
   void Cancel();
 
+  /// Cancel packaging, then wait for the pipeline to stop, e.g. to fail over
+  /// to another packager quickly. Note that it has to be called from another
+  /// thread than Run().
+  /// @param timeout is the longest time to wait.
+  /// @return true if the pipeline stopped within @a timeout.
+  bool Cancel(std::chrono::milliseconds timeout);
+
+  /// Get the statistics of the media handlers, if
+  /// `PackagingParams::collect_handler_stats` is set. It can be called from
+  /// another thread while the pipeline runs.
+  /// @return The statistics of each media handler, in pipeline order.
+  std::vector<HandlerStats> GetHandlerStats() const;
+
+  /// Get the progress of the packager. It can be called from another thread
+  /// while packaging.
+  PackagingProgress GetProgress() const;
+
+  /// Get the resources used by the packager since it was first initialized.
+  /// It can be called from another thread while packaging.
+  ResourceUsage GetResourceUsage() const;
+
+  /// Get the memory statistics of the process, which cover all the packagers
+  /// in it. It can be called from another thread while packaging.
+  static MemoryStats GetMemoryStats();
+
   /// @return The version of the library.
   static std::string GetLibraryVersion();
 
+  /// Describe the streams of an input without packaging it, e.g. to choose
+  /// the outputs of an upload. Only the start of the input is read, up to
+  /// the stream info, or the 'moov' box of a local MP4 file. No muxer, key
+  /// source or output is created.
+  /// @param input is the input, as in `StreamDescriptor::input`.
+  /// @param input_format is the format of the input, as in
+  ///        `StreamDescriptor::input_format`. Detected if empty.
+  /// @param[out] json is set to a JSON object with the input, and the
+  ///        `index`, `type`, `codec`, `time_scale`, `duration_seconds`,
+  ///        `language` and `encrypted` fields of each of its streams, along
+  ///        with the dimensions of video streams and the sample rate,
+  ///        channels and sample bits of audio streams.
+  /// @return OK on success, an appropriate error code on failure.
+  static Status ProbeInput(const std::string& input,
+                           const std::string& input_format,
+                           std::string* json);
+
+  /// Fetch the Widevine encryption keys of many contents, e.g. of a catalog
+  /// about to be packaged, with concurrent requests to the key server. The
+  /// keys are kept in the key cache shared by the packagers of the process,
+  /// so packagers initialized later with the same encryption parameters and
+  /// one of these content IDs do not need to contact the key server.
+  /// @param encryption_params contains the Widevine encryption parameters.
+  ///        `widevine.key_cache_ttl_seconds` must be positive. The content ID
+  ///        is ignored.
+  /// @param content_ids contains the IDs of the contents.
+  /// @param max_concurrent_requests is the maximum number of requests to the
+  ///        key server in flight at a time.
+  /// @return OK if the keys of all the contents were fetched.
+  static Status PrefetchKeys(
+      const EncryptionParams& encryption_params,
+      const std::vector<std::vector<uint8_t>>& content_ids,
+      uint32_t max_concurrent_requests = 8);
+
+  /// Package a single segment of an intermediate on request, e.g. for an
+  /// origin which keeps one on-demand MP4 per stream rather than every
+  /// packaged output. The intermediate must have been packaged with
+  /// `PackagingParams::output_segment_index`. Only the init section and the
+  /// bytes of the requested segment are read from it, and they go through
+  /// the same pipeline as Run(), e.g. for encryption or a TS output.
+  /// @param packaging_params contains the packaging parameters. The
+  ///        manifests, ad cues, MediaInfo files and segment indexes are
+  ///        disabled, and each request is packaged as a single segment. The
+  ///        clear lead is counted from the first segment of the input.
+  /// @param stream_descriptor describes the stream. `input` is the
+  ///        intermediate. The output format is `output_format` if set, or
+  ///        is detected from the names of `segment_template` or `output`,
+  ///        which are not written to.
+  /// @param segment_index is the zero based index of the segment.
+  /// @param init_segment receives the init segment, if the output format
+  ///        has one. Can be null.
+  /// @param segment receives the segment.
+  /// @return OK on success, an appropriate error code on failure.
+  static Status PackageSegment(const PackagingParams& packaging_params,
+                               const StreamDescriptor& stream_descriptor,
+                               size_t segment_index,
+                               std::vector<uint8_t>* init_segment,
+                               std::vector<uint8_t>* segment);
+
+  /// Package an intermediate in ranges of segments run in parallel, e.g. a
+  /// long VOD title on many cores. The intermediate must have been packaged
+  /// with `PackagingParams::output_segment_index` and with the same chunking
+  /// parameters, so that the segments of each range are known to start at
+  /// the same key frames. Each range is packaged by its own pipeline, which
+  /// numbers its segments from their index in the intermediate.
+  /// @param packaging_params contains the packaging parameters. Manifests and
+  ///        ad cues are not supported. With encryption, explicit IVs are only
+  ///        allowed with 'cbcs' or `derive_sample_ivs`, as each range starts
+  ///        from the same IV. With `derive_sample_ivs`, the output is the same
+  ///        as when the intermediate is packaged in a single range.
+  /// @param stream_descriptor describes the stream. `input` is the
+  ///        intermediate. `segment_template` is required.
+  /// @param num_ranges is the number of ranges packaged concurrently.
+  /// @return OK on success, an appropriate error code on failure.
+  static Status PackageInParallel(const PackagingParams& packaging_params,
+                                  const StreamDescriptor& stream_descriptor,
+                                  uint32_t num_ranges);
+
   /// Default stream label function implementation.
   /// @param max_sd_pixels The threshold to determine whether a video track
   ///                      should be considered as SD. If the max pixels per
@@ -8,6 +8,7 @@
 #define PACKAGER_PUBLIC_STATUS_H_
 
 #include <iostream>
+#include <memory>
 #include <string>
 
 #include <packager/export.h>
@@ -86,16 +87,29 @@ enum Code {
 
 }  // namespace error
 
+/// A successful Status holds a single null pointer, so that it is cheap to
+/// create, copy and destroy. The error code and message are only allocated
+/// on failure.
 class SHAKA_EXPORT Status {
  public:
   /// Creates a "successful" status.
-  Status() : error_code_(error::OK) {}
+  Status() = default;
 
   /// Create a status with the specified code, and error message.
   /// If "error_code == error::OK", error_message is ignored and a Status
   /// object identical to Status::OK is constructed.
   Status(error::Code error_code, const std::string& error_message);
 
+  Status(const Status& other)
+      : error_(other.error_ ? new Error(*other.error_) : nullptr) {}
+  Status(Status&& other) noexcept = default;
+  Status& operator=(const Status& other) {
+    if (this != &other)
+      error_.reset(other.error_ ? new Error(*other.error_) : nullptr);
+    return *this;
+  }
+  Status& operator=(Status&& other) noexcept = default;
+
   /// @name Some pre-defined Status objects.
   /// @{
   static const Status OK;  // Identical to 0-arg constructor.
@@ -110,14 +124,22 @@ class SHAKA_EXPORT Status {
   ///   if (overall_status.ok()) overall_status = new_status
   /// Use:
   ///   overall_status.Update(new_status);
-  void Update(Status new_status);
+  void Update(Status new_status) {
+    if (ok())
+      *this = std::move(new_status);
+  }
 
-  bool ok() const { return error_code_ == error::OK; }
-  error::Code error_code() const { return error_code_; }
-  const std::string& error_message() const { return error_message_; }
+  bool ok() const { return !error_; }
+  error::Code error_code() const {
+    return error_ ? error_->error_code : error::OK;
+  }
+  const std::string& error_message() const {
+    return error_ ? error_->error_message : EmptyErrorMessage();
+  }
 
   bool operator==(const Status& x) const {
-    return error_code_ == x.error_code() && error_message_ == x.error_message();
+    return error_code() == x.error_code() &&
+           error_message() == x.error_message();
   }
   bool operator!=(const Status& x) const { return !(*this == x); }
 
@@ -125,11 +147,15 @@ class SHAKA_EXPORT Status {
   std::string ToString() const;
 
  private:
-  error::Code error_code_;
-  std::string error_message_;
+  struct Error {
+    error::Code error_code;
+    std::string error_message;
+  };
+
+  static const std::string& EmptyErrorMessage();
 
-  // Not using DISALLOW_COPY_AND_ASSIGN here intentionally to allow the compiler
-  // generated copy constructor and assignment operator.
+  // Null on success.
+  std::unique_ptr<Error> error_;
 };
 
 std::ostream& operator<<(std::ostream& os, const Status& x);
@@ -18,3 +18,10 @@ ABSL_FLAG(std::string,
           "{start_time}[,{duration}][;{start_time}[,{duration}]]..."
           "The start_time represents the start of the cue marker in "
           "seconds relative to the start of the program.");
+ABSL_FLAG(uint64_t,
+          ad_cue_max_buffered_bytes,
+          0,
+          "Maximum size, in bytes, of the sample payloads each input buffers "
+          "in memory while waiting for the streams to line up at a cue. The "
+          "payloads past it are spilled to a temporary file in --temp_dir. "
+          "0 means that there is no limit.");
@@ -0,0 +1,85 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/app/allocator_stats.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <absl/strings/str_format.h>
+
+#if defined(SHAKA_USE_MIMALLOC)
+#include <mimalloc.h>
+#endif
+
+#include <packager/utils/metrics.h>
+
+namespace shaka {
+
+#if defined(SHAKA_USE_MIMALLOC)
+namespace {
+
+struct AllocatorInfo {
+  size_t current_rss = 0;
+  size_t peak_rss = 0;
+  size_t current_commit = 0;
+  size_t peak_commit = 0;
+  size_t page_faults = 0;
+};
+
+AllocatorInfo GetAllocatorInfo() {
+  AllocatorInfo info;
+  size_t elapsed_msecs = 0;
+  size_t user_msecs = 0;
+  size_t system_msecs = 0;
+  mi_process_info(&elapsed_msecs, &user_msecs, &system_msecs,
+                  &info.current_rss, &info.peak_rss, &info.current_commit,
+                  &info.peak_commit, &info.page_faults);
+  return info;
+}
+
+}  // namespace
+
+void RegisterAllocatorMetrics() {
+  MetricsRegistry* registry = MetricsRegistry::GetInstance();
+  MetricGauge* committed = registry->GetGauge(
+      "shaka_allocator_committed_bytes", "Memory committed by mimalloc.");
+  MetricGauge* peak_committed =
+      registry->GetGauge("shaka_allocator_peak_committed_bytes",
+                         "Peak memory committed by mimalloc.");
+  MetricGauge* rss = registry->GetGauge(
+      "shaka_allocator_rss_bytes", "Resident set size, seen by mimalloc.");
+  MetricGauge* page_faults = registry->GetGauge(
+      "shaka_allocator_page_faults", "Page faults of the process.");
+  registry->AddCollector([=]() {
+    const AllocatorInfo info = GetAllocatorInfo();
+    committed->Set(static_cast<int64_t>(info.current_commit));
+    peak_committed->Set(static_cast<int64_t>(info.peak_commit));
+    rss->Set(static_cast<int64_t>(info.current_rss));
+    page_faults->Set(static_cast<int64_t>(info.page_faults));
+  });
+}
+
+std::string GetAllocatorStats() {
+  const AllocatorInfo info = GetAllocatorInfo();
+  return absl::StrFormat(
+      "mimalloc: %u bytes committed, %u bytes peak committed, %u bytes "
+      "resident, %u page faults",
+      info.current_commit, info.peak_commit, info.current_rss,
+      info.page_faults);
+}
+
+#else
+
+void RegisterAllocatorMetrics() {}
+
+std::string GetAllocatorStats() {
+  return "";
+}
+
+#endif  // defined(SHAKA_USE_MIMALLOC)
+
+}  // namespace shaka
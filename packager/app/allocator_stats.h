@@ -0,0 +1,24 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_APP_ALLOCATOR_STATS_H_
+#define PACKAGER_APP_ALLOCATOR_STATS_H_
+
+#include <string>
+
+namespace shaka {
+
+/// Export the statistics of the allocator as metrics, if the app is linked
+/// against mimalloc. Does nothing otherwise.
+void RegisterAllocatorMetrics();
+
+/// @return A summary of the statistics of the allocator, or an empty string if
+///         the app is not linked against mimalloc.
+std::string GetAllocatorStats();
+
+}  // namespace shaka
+
+#endif  // PACKAGER_APP_ALLOCATOR_STATS_H_
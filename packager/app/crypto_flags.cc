@@ -35,6 +35,31 @@ ABSL_FLAG(bool,
           vp9_subsample_encryption,
           true,
           "Enable VP9 subsample encryption.");
+ABSL_FLAG(uint32_t,
+          sample_encryption_threads,
+          0,
+          "Maximum number of samples of a stream encrypted concurrently on "
+          "worker threads. Applies to 'cenc' protection scheme only. 0 or 1 "
+          "means samples are encrypted on the packaging thread.");
+ABSL_FLAG(bool,
+          derive_sample_ivs,
+          false,
+          "Derive the IV of each sample from the key, its decoding timestamp "
+          "and its content, instead of incrementing it from sample to sample, "
+          "so that the output does not depend on where packaging started. "
+          "Ignored with constant IVs.");
+ABSL_FLAG(uint32_t,
+          sample_decryption_threads,
+          0,
+          "Maximum number of samples of an MP4 input decrypted concurrently "
+          "on worker threads. 0 or 1 means samples are decrypted on the "
+          "demuxing thread.");
+ABSL_FLAG(std::string,
+          crypto_backend,
+          "mbedtls",
+          "The crypto library running the AES ciphers of the encryption and "
+          "decryption: 'mbedtls', or 'openssl' if the packager is built with "
+          "USE_OPENSSL_CRYPTO, which is faster on most platforms.");
 ABSL_FLAG(std::string,
           playready_extra_header_data,
           "",
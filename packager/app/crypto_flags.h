@@ -17,6 +17,10 @@ ABSL_DECLARE_FLAG(std::string, protection_scheme);
 ABSL_DECLARE_FLAG(int32_t, crypt_byte_block);
 ABSL_DECLARE_FLAG(int32_t, skip_byte_block);
 ABSL_DECLARE_FLAG(bool, vp9_subsample_encryption);
+ABSL_DECLARE_FLAG(uint32_t, sample_encryption_threads);
+ABSL_DECLARE_FLAG(bool, derive_sample_ivs);
+ABSL_DECLARE_FLAG(uint32_t, sample_decryption_threads);
+ABSL_DECLARE_FLAG(std::string, crypto_backend);
 ABSL_DECLARE_FLAG(std::string, playready_extra_header_data);
 
 namespace shaka {
@@ -51,3 +51,41 @@ ABSL_FLAG(bool,
           false,
           "Playback of Offline HLS assets shall use EXT-X-SESSION-KEY "
           "to declare all eligible content keys in the master playlist.");
+ABSL_FLAG(bool,
+          low_latency_hls_mode,
+          false,
+          "If enabled, LL-HLS playlists will be generated: the chunks of "
+          "the segments are published as partial segments as soon as they "
+          "are written. Requires --low_latency_dash_mode for chunking and "
+          "a LIVE or EVENT playlist.");
+ABSL_FLAG(double,
+          hls_part_target_duration,
+          1.0,
+          "Floating-point number. The target duration of the LL-HLS partial "
+          "segments in seconds, i.e. PART-TARGET in EXT-X-PART-INF.");
+ABSL_FLAG(bool,
+          hls_delta_updates,
+          false,
+          "If enabled, a Playlist Delta Update, with the older segments "
+          "replaced by EXT-X-SKIP, is written next to each media playlist "
+          "with '_skip' appended to the file name, e.g. video_skip.m3u8 for "
+          "video.m3u8. The origin should serve it for the requests with "
+          "_HLS_skip=YES. Requires a LIVE or EVENT playlist.");
+ABSL_FLAG(bool,
+          hls_save_playlist_state,
+          false,
+          "If enabled, the state of each LIVE or EVENT media playlist is "
+          "saved next to it with '.state' appended to the file name, and a "
+          "restarted packager continues the playlists from it instead of "
+          "starting them over.");
+ABSL_FLAG(std::string,
+          hls_vod_archive_output,
+          "",
+          "If set, a VOD master playlist is written to this path once a LIVE "
+          "presentation ends, with VOD media playlists of all the segments "
+          "named after the live ones with '_vod' appended, e.g. "
+          "video_vod.m3u8 for video.m3u8. The segments are not demuxed "
+          "again. It must be in the same directory as "
+          "--hls_master_playlist_output. Requires "
+          "--preserved_segments_outside_live_window=0 so that the segments "
+          "are kept.");
@@ -17,5 +17,10 @@ ABSL_DECLARE_FLAG(std::string, hls_playlist_type);
 ABSL_DECLARE_FLAG(int32_t, hls_media_sequence_number);
 ABSL_DECLARE_FLAG(std::optional<double>, hls_start_time_offset);
 ABSL_DECLARE_FLAG(bool, create_session_keys);
+ABSL_DECLARE_FLAG(bool, low_latency_hls_mode);
+ABSL_DECLARE_FLAG(double, hls_part_target_duration);
+ABSL_DECLARE_FLAG(bool, hls_delta_updates);
+ABSL_DECLARE_FLAG(bool, hls_save_playlist_state);
+ABSL_DECLARE_FLAG(std::string, hls_vod_archive_output);
 
 #endif  // PACKAGER_APP_HLS_FLAGS_H_
@@ -0,0 +1,272 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#if defined(OS_WIN)
+#include <codecvt>
+#include <functional>
+#endif  // defined(OS_WIN)
+
+#include <absl/flags/parse.h>
+#include <absl/flags/usage.h>
+#include <absl/flags/usage_config.h>
+#include <absl/log/check.h>
+#include <absl/log/initialize.h>
+#include <absl/log/log.h>
+#include <absl/strings/str_format.h>
+#include <absl/strings/str_split.h>
+#include <absl/strings/strip.h>
+
+#include <packager/app/hls_generator_flags.h>
+#include <packager/file.h>
+#include <packager/hls/util/hls_writer.h>
+#include <packager/tools/license_notice.h>
+#include <packager/version/version.h>
+
+ABSL_FLAG(bool, licenses, false, "Dump licenses.");
+ABSL_FLAG(std::string,
+          test_packager_version,
+          "",
+          "Packager version for testing. Should be used for testing only.");
+
+// From absl/log:
+ABSL_DECLARE_FLAG(int, stderrthreshold);
+
+namespace shaka {
+namespace {
+const char kUsage[] =
+    "HLS playlist generation driver program.\n"
+    "This program accepts the MediaInfo files of single-file outputs, "
+    "dumped with --output_media_info, and writes a master playlist and VOD "
+    "media playlists, without the media files. The segments are read from "
+    "the indexes written next to the outputs with --output_segment_index.\n"
+    "The main use case for this is to regenerate the playlists of VOD "
+    "content, e.g. with a new base URL or key URI, without repackaging it.\n"
+    "The media playlist of an output is written next to the master "
+    "playlist, named after the output with the \".m3u8\" extension.\n"
+    "Sample Usage:\n"
+    "%s --input=\"video.mp4.media_info,audio.mp4.media_info\" "
+    "--output=\"master.m3u8\"\n"
+    "MediaInfo files ending with \".pb\" are read as binary protobufs.";
+
+enum ExitStatus {
+  kSuccess = 0,
+  kEmptyInputError,
+  kEmptyOutputError,
+  kFailedToWritePlaylistsError,
+  kFailedToReadBatchError
+};
+
+// A master playlist to generate.
+struct HlsJob {
+  std::string output;
+  std::vector<std::string> input_files;
+};
+
+ExitStatus CheckRequiredFlags() {
+  if (!absl::GetFlag(FLAGS_batch).empty())
+    return kSuccess;
+
+  if (absl::GetFlag(FLAGS_input).empty()) {
+    LOG(ERROR) << "--input is required.";
+    return kEmptyInputError;
+  }
+
+  if (absl::GetFlag(FLAGS_output).empty()) {
+    LOG(ERROR) << "--output is required.";
+    return kEmptyOutputError;
+  }
+
+  return kSuccess;
+}
+
+// Returns the name of the media playlist of the output described by
+// |media_info_file|, e.g. "video.m3u8" for "out/video.mp4.media_info".
+std::string GetPlaylistName(const std::string& media_info_file) {
+  std::filesystem::path path = std::filesystem::u8path(media_info_file);
+  if (path.extension() == ".pb")
+    path.replace_extension();
+  // Remove the ".media_info" suffix, then replace the extension of the output.
+  path.replace_extension();
+  return path.filename().replace_extension(".m3u8").string();
+}
+
+bool GeneratePlaylists(const HlsJob& job, const HlsParams& hls_params) {
+  hls::HlsWriter hls_writer;
+  for (const std::string& file : job.input_files) {
+    if (!hls_writer.AddFile(file, GetPlaylistName(file))) {
+      LOG(WARNING) << "HlsWriter failed to read " << file << ", skipping.";
+    }
+  }
+
+  HlsParams params = hls_params;
+  params.master_playlist_output = job.output;
+  if (!hls_writer.WritePlaylists(params)) {
+    LOG(ERROR) << "Failed to write the playlists of " << job.output;
+    return false;
+  }
+  return true;
+}
+
+bool ReadBatch(const std::string& batch_file, std::vector<HlsJob>* jobs) {
+  std::string content;
+  if (!File::ReadFileToString(batch_file.c_str(), &content)) {
+    LOG(ERROR) << "Failed to read " << batch_file;
+    return false;
+  }
+  for (absl::string_view line : absl::StrSplit(content, '\n')) {
+    line = absl::StripAsciiWhitespace(line);
+    if (line.empty() || line[0] == '#')
+      continue;
+    std::vector<std::string> fields =
+        absl::StrSplit(line, absl::ByAnyChar(" \t"), absl::SkipEmpty());
+    if (fields.size() != 2) {
+      LOG(ERROR) << "Invalid line in " << batch_file << ": " << line;
+      return false;
+    }
+    HlsJob job;
+    job.output = fields[0];
+    job.input_files = absl::StrSplit(fields[1], ",", absl::SkipEmpty());
+    jobs->push_back(std::move(job));
+  }
+  return true;
+}
+
+// Generates the playlists of |jobs| on a pool of threads. Each thread reads
+// the MediaInfo files and writes the playlists of one job at a time.
+bool GenerateAllPlaylists(const std::vector<HlsJob>& jobs,
+                          const HlsParams& hls_params) {
+  int num_threads = absl::GetFlag(FLAGS_batch_threads);
+  if (num_threads <= 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  num_threads = std::min(num_threads, static_cast<int>(jobs.size()));
+
+  std::atomic<size_t> next_job(0);
+  std::atomic<bool> success(true);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&jobs, &hls_params, &next_job, &success]() {
+      for (size_t job = next_job++; job < jobs.size(); job = next_job++) {
+        if (!GeneratePlaylists(jobs[job], hls_params))
+          success = false;
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  return success;
+}
+
+ExitStatus RunHlsGenerator() {
+  DCHECK_EQ(CheckRequiredFlags(), kSuccess);
+  HlsParams hls_params;
+  hls_params.playlist_type = HlsPlaylistType::kVod;
+  hls_params.base_url = absl::GetFlag(FLAGS_base_url);
+  hls_params.key_uri = absl::GetFlag(FLAGS_key_uri);
+  hls_params.is_independent_segments = false;
+  hls_params.create_session_keys = false;
+
+  if (!absl::GetFlag(FLAGS_batch).empty()) {
+    std::vector<HlsJob> jobs;
+    if (!ReadBatch(absl::GetFlag(FLAGS_batch), &jobs))
+      return kFailedToReadBatchError;
+    if (!GenerateAllPlaylists(jobs, hls_params))
+      return kFailedToWritePlaylistsError;
+    return kSuccess;
+  }
+
+  HlsJob job;
+  job.output = absl::GetFlag(FLAGS_output);
+  job.input_files =
+      absl::StrSplit(absl::GetFlag(FLAGS_input), ",", absl::SkipEmpty());
+  if (!GeneratePlaylists(job, hls_params))
+    return kFailedToWritePlaylistsError;
+  return kSuccess;
+}
+
+int HlsMain(int argc, char** argv) {
+  absl::FlagsUsageConfig flag_config;
+  flag_config.version_string = []() -> std::string {
+    return "hls_generator version " + GetPackagerVersion() + "\n";
+  };
+  flag_config.contains_help_flags =
+      [](absl::string_view flag_file_name) -> bool { return true; };
+  absl::SetFlagsUsageConfig(flag_config);
+
+  auto usage = absl::StrFormat(kUsage, argv[0]);
+  absl::SetProgramUsageMessage(usage);
+
+  // Before parsing the command line, change the default value of some flags
+  // provided by libraries.
+
+  // Always log to stderr.  Log levels are still controlled by --minloglevel.
+  absl::SetFlag(&FLAGS_stderrthreshold, 0);
+
+  absl::ParseCommandLine(argc, argv);
+
+  if (absl::GetFlag(FLAGS_licenses)) {
+    for (const char* line : kLicenseNotice)
+      std::cout << line << std::endl;
+    return kSuccess;
+  }
+
+  ExitStatus status = CheckRequiredFlags();
+  if (status != kSuccess) {
+    std::cerr << "Usage " << absl::ProgramUsageMessage();
+    return status;
+  }
+
+  absl::InitializeLog();
+
+  if (!absl::GetFlag(FLAGS_test_packager_version).empty())
+    SetPackagerVersionForTesting(absl::GetFlag(FLAGS_test_packager_version));
+
+  return RunHlsGenerator();
+}
+
+}  // namespace
+}  // namespace shaka
+
+#if defined(OS_WIN)
+// Windows wmain, which converts wide character arguments to UTF-8.
+int wmain(int argc, wchar_t* argv[], wchar_t* envp[]) {
+  std::unique_ptr<char* [], std::function<void(char**)>> utf8_argv(
+      new char*[argc], [argc](char** utf8_args) {
+        // TODO(tinskip): This leaks, but if this code is enabled, it crashes.
+        // Figure out why. I suspect gflags does something funny with the
+        // argument array.
+        // for (int idx = 0; idx < argc; ++idx)
+        //   delete[] utf8_args[idx];
+        delete[] utf8_args;
+      });
+  std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
+
+  for (int idx = 0; idx < argc; ++idx) {
+    std::string utf8_arg(converter.to_bytes(argv[idx]));
+    utf8_arg += '\0';
+    utf8_argv[idx] = new char[utf8_arg.size()];
+    memcpy(utf8_argv[idx], &utf8_arg[0], utf8_arg.size());
+  }
+
+  // Because we just converted wide character args into UTF8, and because
+  // std::filesystem::u8path is used to interpret all std::string paths as
+  // UTF8, we should set the locale to UTF8 as well, for the transition point
+  // to C library functions like fopen to work correctly with non-ASCII paths.
+  std::setlocale(LC_ALL, ".UTF8");
+
+  return shaka::HlsMain(argc, utf8_argv.get());
+}
+#else
+int main(int argc, char** argv) {
+  return shaka::HlsMain(argc, argv);
+}
+#endif  // !defined(OS_WIN)
@@ -0,0 +1,40 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef APP_HLS_GENERATOR_FLAGS_H_
+#define APP_HLS_GENERATOR_FLAGS_H_
+
+#include <absl/flags/flag.h>
+
+ABSL_FLAG(std::string,
+          input,
+          "",
+          "Comma separated list of MediaInfo input files.");
+ABSL_FLAG(std::string, output, "", "Master playlist output file name.");
+ABSL_FLAG(std::string,
+          base_url,
+          "",
+          "The base URL for the media playlists and the media files listed in "
+          "the playlists.");
+ABSL_FLAG(std::string,
+          key_uri,
+          "",
+          "The key URI of the 'identity' and 'com.apple.streamingkeydelivery' "
+          "key formats of the encrypted streams.");
+ABSL_FLAG(std::string,
+          batch,
+          "",
+          "A file listing the master playlists to generate, replacing --input "
+          "and --output. Each line has a master playlist output file name and "
+          "a comma separated list of its MediaInfo input files, separated by "
+          "whitespace. Empty lines and lines starting with '#' are ignored. "
+          "The playlists are generated in parallel.");
+ABSL_FLAG(int32_t,
+          batch_threads,
+          0,
+          "The number of threads generating the playlists in --batch. "
+          "Defaults to the number of cores.");
+#endif  // APP_HLS_GENERATOR_FLAGS_H_
@@ -6,15 +6,47 @@
 
 #include <packager/app/job_manager.h>
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <set>
 
 #include <absl/log/check.h>
+#include <absl/log/log.h>
 
+#include <packager/macros/logging.h>
+#include <packager/macros/status.h>
 #include <packager/media/chunking/sync_point_queue.h>
 #include <packager/media/origin/origin_handler.h>
+#include <packager/utils/cpu_affinity.h>
+#include <packager/utils/resource_quota.h>
+#include <packager/utils/work_priority.h>
 
 namespace shaka {
 namespace media {
+namespace {
+
+// @return the CPUs in both |a| and |b|, which are sorted.
+std::vector<int> IntersectCpus(const std::vector<int>& a,
+                               const std::vector<int>& b) {
+  std::vector<int> cpus;
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                        std::back_inserter(cpus));
+  return cpus;
+}
+
+// @return the NUMA nodes with any of |cpus|.
+std::vector<int> GetNumaNodesOf(const std::vector<int>& cpus,
+                                const std::vector<std::vector<int>>& nodes) {
+  std::vector<int> node_numbers;
+  for (size_t node = 0; node < nodes.size(); ++node) {
+    if (!IntersectCpus(cpus, nodes[node]).empty())
+      node_numbers.push_back(static_cast<int>(node));
+  }
+  return node_numbers;
+}
+
+}  // namespace
 
 Job::Job(const std::string& name,
          std::shared_ptr<OriginHandler> work,
@@ -27,6 +59,11 @@ Job::Job(const std::string& name,
 }
 
 const Status& Job::Initialize() {
+  // The threads started by the handlers take the CPUs, the priority and the
+  // resource quota of the job.
+  ScopedCpuAffinity affinity(cpus_);
+  ScopedWorkPriority priority(background_);
+  ScopedResourceQuota quota(quota_);
   status_ = work_->Initialize();
   return status_;
 }
@@ -40,14 +77,28 @@ void Job::Cancel() {
 }
 
 const Status& Job::Run() {
-  if (status_.ok())  // initialized correctly
+  if (status_.ok()) {  // initialized correctly
+    ScopedCpuAffinity affinity(cpus_);
+    ScopedWorkPriority priority(background_);
+    ScopedResourceQuota quota(quota_);
     status_ = work_->Run();
+  }
 
   on_complete_(this);
 
   return status_;
 }
 
+bool Job::StartAsync() {
+  // A job which failed to initialize reports it when run.
+  if (!status_.ok())
+    return false;
+  return work_->StartAsync([this](const Status& status) {
+    status_ = status;
+    on_complete_(this);
+  });
+}
+
 void Job::Join() {
   if (thread_) {
     thread_->join();
@@ -56,16 +107,29 @@ void Job::Join() {
 }
 
 JobManager::JobManager(std::unique_ptr<SyncPointQueue> sync_points)
-    : sync_points_(std::move(sync_points)) {}
+    : JobManager(std::move(sync_points), 0) {}
+
+JobManager::JobManager(std::unique_ptr<SyncPointQueue> sync_points,
+                       size_t max_job_threads)
+    : sync_points_(std::move(sync_points)),
+      max_job_threads_(max_job_threads) {
+  if (sync_points_ && max_job_threads_) {
+    LOG(WARNING) << "Ignoring the job thread limit as cue alignment requires "
+                    "all jobs to run concurrently.";
+  }
+}
 
 void JobManager::Add(const std::string& name,
                      std::shared_ptr<OriginHandler> handler) {
   jobs_.emplace_back(new Job(
       name, std::move(handler),
       std::bind(&JobManager::OnJobComplete, this, std::placeholders::_1)));
+  jobs_.back()->set_background(priority_class_ == PriorityClass::kBackground);
+  jobs_.back()->set_resource_quota(resource_quota_);
 }
 
 Status JobManager::InitializeJobs() {
+  RETURN_IF_ERROR(PlaceJobs());
   Status status;
   for (auto& job : jobs_)
     status.Update(job->Initialize());
@@ -73,35 +137,58 @@ Status JobManager::InitializeJobs() {
 }
 
 Status JobManager::RunJobs() {
+  SetRunning(true);
   std::set<Job*> active_jobs;
+  // The jobs driven by the arrival of their data, which need no worker.
+  std::vector<Job*> async_jobs;
 
-  // Start every job and add it to the active jobs list so that we can wait
+  // Queue every job and add it to the active jobs list so that we can wait
   // on each one.
+  {
+    absl::MutexLock lock(&mutex_);
+    for (auto& job : jobs_)
+      active_jobs.insert(job.get());
+  }
   for (auto& job : jobs_) {
-    job->Start();
-
-    active_jobs.insert(job.get());
+    if (job->StartAsync()) {
+      async_jobs.push_back(job.get());
+    } else {
+      absl::MutexLock lock(&mutex_);
+      pending_jobs_.push_back(job.get());
+    }
   }
 
+  size_t num_threads = jobs_.size() - async_jobs.size();
+  if (max_job_threads_ && !sync_points_)
+    num_threads = std::min(num_threads, max_job_threads_);
+
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < num_threads; ++i)
+    workers.emplace_back(&JobManager::WorkerMain, this);
+
   // Wait for all jobs to complete or any job to error.
   Status status;
   {
     absl::MutexLock lock(&mutex_);
     while (status.ok() && active_jobs.size()) {
-      // any_job_complete_ is protected by mutex_.
-      any_job_complete_.Wait(&mutex_);
-
-      // complete_ is protected by mutex_.
+      // complete_ is protected by mutex_. Check it before waiting, as workers
+      // may have completed jobs before this thread acquired the lock.
       for (const auto& entry : complete_) {
         Job* job = entry.first;
         bool complete = entry.second;
-        if (complete) {
-          job->Join();
+        if (complete && active_jobs.erase(job))
           status.Update(job->status());
-          active_jobs.erase(job);
-        }
       }
+      if (!status.ok() || active_jobs.empty())
+        break;
+
+      // any_job_complete_ is protected by mutex_.
+      any_job_complete_.Wait(&mutex_);
     }
+
+    // If the main loop has exited, jobs which have not been picked up by a
+    // worker yet will not be run.
+    pending_jobs_.clear();
   }
 
   // If the main loop has exited and there are still jobs running,
@@ -112,12 +199,47 @@ Status JobManager::RunJobs() {
   for (auto& job : active_jobs)
     job->Cancel();
 
-  for (auto& job : active_jobs)
-    job->Join();
+  for (auto& worker : workers)
+    worker.join();
 
+  // The cancelled asynchronous jobs complete soon, but not necessarily yet.
+  {
+    absl::MutexLock lock(&mutex_);
+    for (Job* job : async_jobs) {
+      while (!complete_[job])
+        any_job_complete_.Wait(&mutex_);
+    }
+  }
+
+  if (sync_points_) {
+    VLOG(1) << "Threads were blocked on cue alignment for "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   sync_points_->GetBlockedTime())
+                   .count()
+            << " ms.";
+  }
+  SetRunning(false);
   return status;
 }
 
+void JobManager::WorkerMain() {
+  // The workers only run the jobs of this manager, which share a priority.
+  if (priority_class_ == PriorityClass::kBackground)
+    WorkPriority::DedicateThreadToBackgroundWork();
+
+  while (true) {
+    Job* job = nullptr;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (pending_jobs_.empty())
+        return;
+      job = pending_jobs_.front();
+      pending_jobs_.pop_front();
+    }
+    job->Run();
+  }
+}
+
 void JobManager::OnJobComplete(Job* job) {
   absl::MutexLock lock(&mutex_);
   // These are both protected by mutex_.
@@ -125,6 +247,74 @@ void JobManager::OnJobComplete(Job* job) {
   any_job_complete_.Signal();
 }
 
+void JobManager::SetRunning(bool running) {
+  absl::MutexLock lock(&mutex_);
+  idle_ = !running;
+}
+
+Status JobManager::PlaceJobs() {
+  const CpuPlacementParams& params = cpu_placement_params_;
+  if (params.cpus.empty() && params.placement == CpuPlacement::kNone)
+    return Status::OK;
+
+  const std::vector<int> allowed_cpus = CpuAffinity::GetThreadCpus();
+  if (allowed_cpus.empty()) {
+    return Status(error::UNIMPLEMENTED,
+                  "CPU placement is not supported on this platform.");
+  }
+  std::vector<int> cpus = allowed_cpus;
+  if (!params.cpus.empty()) {
+    std::vector<int> requested_cpus;
+    if (!CpuAffinity::ParseCpuList(params.cpus, &requested_cpus)) {
+      return Status(error::INVALID_ARGUMENT,
+                    "Invalid list of CPUs: " + params.cpus);
+    }
+    cpus = IntersectCpus(requested_cpus, allowed_cpus);
+    if (cpus.empty()) {
+      return Status(error::INVALID_ARGUMENT,
+                    "The packager may not run on any of the CPUs " +
+                        params.cpus + ", only on " +
+                        CpuAffinity::FormatCpuList(allowed_cpus) + ".");
+    }
+    if (cpus != requested_cpus) {
+      LOG(WARNING) << "Only using the CPUs " << CpuAffinity::FormatCpuList(cpus)
+                   << " of " << params.cpus
+                   << ", as the packager may not run on the others.";
+    }
+  }
+
+  const std::vector<std::vector<int>> numa_nodes = CpuAffinity::GetNumaNodes();
+  // The sets of CPUs assigned to the jobs in turn.
+  std::vector<std::vector<int>> cpu_sets;
+  switch (params.placement) {
+    case CpuPlacement::kNone:
+      cpu_sets.push_back(cpus);
+      break;
+    case CpuPlacement::kPerJob:
+      for (int cpu : cpus)
+        cpu_sets.push_back({cpu});
+      break;
+    case CpuPlacement::kPerNumaNode:
+      for (const std::vector<int>& node_cpus : numa_nodes) {
+        std::vector<int> cpu_set = IntersectCpus(cpus, node_cpus);
+        if (!cpu_set.empty())
+          cpu_sets.push_back(std::move(cpu_set));
+      }
+      break;
+  }
+  DCHECK(!cpu_sets.empty());
+
+  for (size_t i = 0; i < jobs_.size(); ++i) {
+    const std::vector<int>& cpu_set = cpu_sets[i % cpu_sets.size()];
+    LOG(INFO) << "Job " << jobs_[i]->name() << " runs on CPUs "
+              << CpuAffinity::FormatCpuList(cpu_set) << " of NUMA nodes "
+              << CpuAffinity::FormatCpuList(
+                     GetNumaNodesOf(cpu_set, numa_nodes));
+    jobs_[i]->set_cpus(cpu_set);
+  }
+  return Status::OK;
+}
+
 void JobManager::CancelJobs() {
   if (sync_points_)
     sync_points_->Cancel();
@@ -133,5 +323,15 @@ void JobManager::CancelJobs() {
     job->Cancel();
 }
 
+bool JobManager::CancelJobs(absl::Duration timeout) {
+  CancelJobs();
+  absl::MutexLock lock(&mutex_);
+  if (mutex_.AwaitWithTimeout(absl::Condition(&idle_), timeout))
+    return true;
+  LOG(WARNING) << "The jobs did not stop within "
+               << absl::FormatDuration(timeout) << " of being cancelled.";
+  return false;
+}
+
 }  // namespace media
 }  // namespace shaka
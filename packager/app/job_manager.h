@@ -7,6 +7,7 @@
 #ifndef PACKAGER_APP_JOB_MANAGER_H_
 #define PACKAGER_APP_JOB_MANAGER_H_
 
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
@@ -14,10 +15,15 @@
 #include <vector>
 
 #include <absl/synchronization/mutex.h>
+#include <absl/time/time.h>
 
+#include <packager/packager.h>
 #include <packager/status.h>
 
 namespace shaka {
+
+class ResourceQuota;
+
 namespace media {
 
 class OriginHandler;
@@ -49,6 +55,12 @@ class Job {
   // operation.  DO NOT USE BOTH!
   const Status& Run();
 
+  // Start the job's work without a thread if it is driven by the arrival of
+  // its data, see OriginHandler::StartAsync(). Updates status() once the work
+  // completes.
+  // @return false if the job must be run instead.
+  bool StartAsync();
+
   // Request that the job stops executing. This is only a request and will not
   // block. If you want to wait for the job to complete, use |complete|.
   void Cancel();
@@ -63,6 +75,18 @@ class Job {
   // The name given to this job in the constructor.
   const std::string& name() const { return name_; }
 
+  // Set the CPUs the job runs on. Empty, the default, to run on any CPU.
+  void set_cpus(std::vector<int> cpus) { cpus_ = std::move(cpus); }
+  const std::vector<int>& cpus() const { return cpus_; }
+
+  // Set whether the job is background work, see WorkPriority.
+  void set_background(bool background) { background_ = background; }
+
+  // Set the resource quota of the job, or nullptr for none.
+  void set_resource_quota(std::shared_ptr<ResourceQuota> quota) {
+    quota_ = std::move(quota);
+  }
+
  private:
   Job(const Job&) = delete;
   Job& operator=(const Job&) = delete;
@@ -72,11 +96,15 @@ class Job {
   OnCompleteFunction on_complete_;
   std::unique_ptr<std::thread> thread_;
   Status status_;
+  std::vector<int> cpus_;
+  bool background_ = false;
+  std::shared_ptr<ResourceQuota> quota_;
 };
 
 // Similar to a thread pool, JobManager manages multiple jobs that are expected
 // to run in parallel. It can be used to register, run, and stop a batch of
-// jobs.
+// jobs. The jobs are run by a bounded set of worker threads, which take the
+// next queued job whenever they complete one.
 class JobManager {
  public:
   // @param sync_points is an optional SyncPointQueue used to synchronize and
@@ -84,6 +112,17 @@ class JobManager {
   //        fails or is cancelled. It can be NULL.
   explicit JobManager(std::unique_ptr<SyncPointQueue> sync_points);
 
+  // @param sync_points is an optional SyncPointQueue used to synchronize and
+  //        align cue points. JobManager cancels @a sync_points when any job
+  //        fails or is cancelled. It can be NULL.
+  // @param max_job_threads is the maximum number of threads used to run
+  //        jobs. Jobs which do not get a thread are queued until an earlier
+  //        job completes. A value of zero means one thread per job. It is
+  //        ignored if @a sync_points is not NULL, as cue alignment requires
+  //        all jobs to run concurrently.
+  JobManager(std::unique_ptr<SyncPointQueue> sync_points,
+             size_t max_job_threads);
+
   virtual ~JobManager() = default;
 
   // Create a new job entry by specifying the origin handler at the top of the
@@ -91,6 +130,23 @@ class JobManager {
   // the job, you need to call |RunJobs|.
   void Add(const std::string& name, std::shared_ptr<OriginHandler> handler);
 
+  // Place the jobs on the CPUs as specified by |params| once they are
+  // initialized. Call before |InitializeJobs|.
+  void set_cpu_placement_params(const CpuPlacementParams& params) {
+    cpu_placement_params_ = params;
+  }
+
+  // Set the priority of the jobs. Call before adding jobs.
+  void set_priority_class(PriorityClass priority_class) {
+    priority_class_ = priority_class;
+  }
+
+  // Set the resource quota of the jobs, or nullptr for none. Call before
+  // adding jobs.
+  void set_resource_quota(std::shared_ptr<ResourceQuota> quota) {
+    resource_quota_ = std::move(quota);
+  }
+
   // Initialize all registered jobs. If any job fails to initialize, this will
   // return the error and it will not be safe to call |RunJobs| as not all jobs
   // will be properly initialized.
@@ -105,6 +161,11 @@ class JobManager {
   // unblock a call to |RunJobs|.
   void CancelJobs();
 
+  // Ask all jobs to stop running, then wait for |RunJobs| to return, for at
+  // most |timeout|. It has to be called from another thread than |RunJobs|.
+  // @return true if |RunJobs| is not running anymore.
+  bool CancelJobs(absl::Duration timeout);
+
   SyncPointQueue* sync_points() { return sync_points_.get(); }
 
  protected:
@@ -113,15 +174,32 @@ class JobManager {
 
   void OnJobComplete(Job* job);
 
+  // Mark whether |RunJobs| is running, for |CancelJobs| to wait.
+  void SetRunning(bool running);
+
+  // Assign the CPUs of the jobs as specified by |cpu_placement_params_|.
+  Status PlaceJobs();
+
+  // Run queued jobs in this thread until there are none left.
+  void WorkerMain();
+
   // Stored in JobManager so JobManager can cancel |sync_points| when any job
   // fails or is cancelled.
   std::unique_ptr<SyncPointQueue> sync_points_;
 
   std::vector<std::unique_ptr<Job>> jobs_;
+  const size_t max_job_threads_ = 0;
+  CpuPlacementParams cpu_placement_params_;
+  PriorityClass priority_class_ = PriorityClass::kLive;
+  std::shared_ptr<ResourceQuota> resource_quota_;
 
   absl::Mutex mutex_;
   std::map<Job*, bool> complete_ ABSL_GUARDED_BY(mutex_);
+  // Jobs waiting for a worker thread.
+  std::deque<Job*> pending_jobs_ ABSL_GUARDED_BY(mutex_);
   absl::CondVar any_job_complete_ ABSL_GUARDED_BY(mutex_);
+  // Whether |RunJobs| is not running.
+  bool idle_ ABSL_GUARDED_BY(mutex_) = true;
 };
 
 }  // namespace media
@@ -0,0 +1,252 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/app/job_server.h>
+
+#include <optional>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <absl/strings/match.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_cat.h>
+#include <absl/strings/str_format.h>
+#include <mongoose.h>
+#include <nlohmann/json.hpp>
+
+#include <packager/app/stream_descriptor.h>
+
+namespace shaka {
+namespace {
+
+const char kJobsUri[] = "/jobs";
+const char kJobUriPrefix[] = "/jobs/";
+const char kJsonHeaders[] = "Content-Type: application/json\r\n";
+// How long mongoose may wait for socket events.
+const int kPollIntervalMs = 100;
+// The most finished jobs whose state is kept for queries.
+const size_t kMaxFinishedJobs = 10000;
+
+std::string ToString(const mg_str& mg_string) {
+  return std::string(mg_string.ptr, mg_string.len);
+}
+
+void ReplyJson(struct mg_connection* connection,
+               int status_code,
+               const nlohmann::json& json) {
+  const std::string text = json.dump();
+  mg_http_reply(connection, status_code, kJsonHeaders, "%s\n", text.c_str());
+}
+
+void ReplyError(struct mg_connection* connection,
+                int status_code,
+                const std::string& error) {
+  ReplyJson(connection, status_code, {{"error", error}});
+}
+
+}  // namespace
+
+JobServer::JobServer(const PackagingParams& packaging_params,
+                     size_t num_workers)
+    : packaging_params_(packaging_params), manager_(new struct mg_mgr) {
+  DCHECK_GT(num_workers, 0u);
+  mg_mgr_init(manager_.get());
+  workers_.resize(num_workers);
+}
+
+JobServer::~JobServer() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopped_ = true;
+    job_queued_.SignalAll();
+  }
+  for (std::thread& worker : workers_) {
+    if (worker.joinable())
+      worker.join();
+  }
+  mg_mgr_free(manager_.get());
+}
+
+bool JobServer::Serve(const std::string& address, uint16_t port) {
+  // IPv6 addresses are bracketed in URLs.
+  const std::string host = absl::StrContains(address, ':')
+                               ? absl::StrCat("[", address, "]")
+                               : address;
+  const std::string url = absl::StrFormat("http://%s:%u", host, port);
+  if (!mg_http_listen(manager_.get(), url.c_str(), &JobServer::HandleEvent,
+                      this /* callback_data */)) {
+    LOG(ERROR) << "Unable to serve jobs on " << host << ":" << port;
+    return false;
+  }
+  LOG(INFO) << "Serving packaging jobs on " << host << ":" << port;
+
+  for (std::thread& worker : workers_)
+    worker = std::thread(&JobServer::WorkerMain, this);
+  while (true)
+    mg_mgr_poll(manager_.get(), kPollIntervalMs);
+}
+
+void JobServer::WorkerMain() {
+  while (true) {
+    uint64_t job_id = 0;
+    PackagingParams packaging_params;
+    std::vector<StreamDescriptor> stream_descriptors;
+    {
+      absl::MutexLock lock(&mutex_);
+      while (!stopped_ && queued_job_ids_.empty())
+        job_queued_.Wait(&mutex_);
+      if (stopped_)
+        return;
+      job_id = queued_job_ids_.front();
+      queued_job_ids_.pop_front();
+      Job& job = jobs_[job_id];
+      job.state = JobState::kRunning;
+      packaging_params = std::move(job.packaging_params);
+      stream_descriptors = std::move(job.stream_descriptors);
+    }
+
+    LOG(INFO) << "Running job " << job_id;
+    Packager packager;
+    Status status = packager.Initialize(packaging_params, stream_descriptors);
+    if (status.ok())
+      status = packager.Run();
+    if (status.ok())
+      LOG(INFO) << "Job " << job_id << " succeeded.";
+    else
+      LOG(ERROR) << "Job " << job_id << " failed: " << status.ToString();
+
+    absl::MutexLock lock(&mutex_);
+    Job& job = jobs_[job_id];
+    job.state = status.ok() ? JobState::kSucceeded : JobState::kFailed;
+    job.error = status.ok() ? "" : status.ToString();
+    finished_job_ids_.push_back(job_id);
+    if (finished_job_ids_.size() > kMaxFinishedJobs) {
+      jobs_.erase(finished_job_ids_.front());
+      finished_job_ids_.pop_front();
+    }
+  }
+}
+
+void JobServer::HandleSubmit(struct mg_connection* connection,
+                             const std::string& body) {
+  const nlohmann::json request =
+      nlohmann::json::parse(body, nullptr, false /* allow_exceptions */);
+  if (!request.is_object() || !request.contains("streams") ||
+      !request["streams"].is_array() || request["streams"].empty()) {
+    ReplyError(connection, 400 /* bad request */,
+               "Expecting a JSON object with an array of streams.");
+    return;
+  }
+
+  Job job;
+  for (const nlohmann::json& stream : request["streams"]) {
+    std::optional<StreamDescriptor> stream_descriptor;
+    if (stream.is_string())
+      stream_descriptor = ParseStreamDescriptor(stream.get<std::string>());
+    if (!stream_descriptor) {
+      ReplyError(connection, 400 /* bad request */,
+                 "Invalid stream descriptor: " + stream.dump());
+      return;
+    }
+    job.stream_descriptors.push_back(std::move(stream_descriptor.value()));
+  }
+
+  job.packaging_params = packaging_params_;
+  for (const char* field :
+       {"mpd_output", "hls_master_playlist_output", "priority"}) {
+    if (request.contains(field) && !request[field].is_string()) {
+      ReplyError(connection, 400 /* bad request */,
+                 absl::StrFormat("%s must be a string.", field));
+      return;
+    }
+  }
+  job.packaging_params.mpd_params.mpd_output =
+      request.value("mpd_output", packaging_params_.mpd_params.mpd_output);
+  job.packaging_params.hls_params.master_playlist_output =
+      request.value("hls_master_playlist_output",
+                    packaging_params_.hls_params.master_playlist_output);
+  if (request.contains("priority")) {
+    const nlohmann::json& priority = request["priority"];
+    if (priority == "live") {
+      job.packaging_params.priority_class = PriorityClass::kLive;
+    } else if (priority == "background") {
+      job.packaging_params.priority_class = PriorityClass::kBackground;
+    } else {
+      ReplyError(connection, 400 /* bad request */,
+                 "priority must be \"live\" or \"background\".");
+      return;
+    }
+  }
+
+  uint64_t job_id = 0;
+  {
+    absl::MutexLock lock(&mutex_);
+    job_id = next_job_id_++;
+    jobs_[job_id] = std::move(job);
+    queued_job_ids_.push_back(job_id);
+    job_queued_.Signal();
+  }
+  ReplyJson(connection, 202 /* accepted */, {{"id", job_id}});
+}
+
+void JobServer::HandleQuery(struct mg_connection* connection,
+                            const std::string& uri) {
+  uint64_t job_id = 0;
+  if (!absl::SimpleAtoi(uri.substr(sizeof(kJobUriPrefix) - 1), &job_id)) {
+    ReplyError(connection, 400 /* bad request */, "Invalid job id.");
+    return;
+  }
+
+  nlohmann::json reply = {{"id", job_id}};
+  {
+    absl::MutexLock lock(&mutex_);
+    auto iter = jobs_.find(job_id);
+    if (iter == jobs_.end()) {
+      ReplyError(connection, 404 /* not found */, "Unknown job.");
+      return;
+    }
+    const Job& job = iter->second;
+    switch (job.state) {
+      case JobState::kQueued:
+        reply["state"] = "queued";
+        break;
+      case JobState::kRunning:
+        reply["state"] = "running";
+        break;
+      case JobState::kSucceeded:
+        reply["state"] = "succeeded";
+        break;
+      case JobState::kFailed:
+        reply["state"] = "failed";
+        reply["error"] = job.error;
+        break;
+    }
+  }
+  ReplyJson(connection, 200 /* OK */, reply);
+}
+
+// static
+void JobServer::HandleEvent(struct mg_connection* connection,
+                            int event,
+                            void* event_data,
+                            void* callback_data) {
+  if (event != MG_EV_HTTP_MSG)
+    return;
+
+  JobServer* server = static_cast<JobServer*>(callback_data);
+  struct mg_http_message* message =
+      static_cast<struct mg_http_message*>(event_data);
+  const std::string method = ToString(message->method);
+  if (method == "POST" && mg_http_match_uri(message, kJobsUri)) {
+    server->HandleSubmit(connection, ToString(message->body));
+  } else if (method == "GET" && mg_http_match_uri(message, "/jobs/*")) {
+    server->HandleQuery(connection, ToString(message->uri));
+  } else {
+    ReplyError(connection, 404 /* not found */, "Not found.");
+  }
+}
+
+}  // namespace shaka
@@ -0,0 +1,96 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_APP_JOB_SERVER_H_
+#define PACKAGER_APP_JOB_SERVER_H_
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+
+#include <packager/packager.h>
+
+// Forward declare mongoose struct types, used as pointers below.
+struct mg_connection;
+struct mg_mgr;
+
+namespace shaka {
+
+/// Runs packaging jobs submitted over HTTP, so that a single packager process
+/// serves many short jobs, keeping its process wide state, e.g. the key
+/// caches, from one job to the next.
+///
+/// A job is submitted with a POST to "/jobs", with a JSON body such as
+///   {"streams": ["in=a.mp4,stream=video,out=v.mp4", ...],
+///    "mpd_output": "a.mpd", "hls_master_playlist_output": "a.m3u8",
+///    "priority": "background"}
+/// where the streams are stream descriptors as on the command line, and the
+/// manifest outputs and the priority class, "live" or "background", are
+/// optional. The reply is {"id": <job id>}. The state
+/// of the job is then polled with a GET of "/jobs/<job id>", which replies
+/// {"id": <job id>, "state": "queued|running|succeeded|failed"}, with an
+/// "error" message for failed jobs.
+class JobServer {
+ public:
+  /// @param packaging_params are the packaging parameters of all the jobs.
+  /// @param num_workers is the number of jobs run at a time. Must be positive.
+  JobServer(const PackagingParams& packaging_params, size_t num_workers);
+  ~JobServer();
+
+  /// Serves jobs from the calling thread. The jobs are not authenticated, so
+  /// @a address should only be reachable by trusted clients.
+  /// @param address is the IP address to listen on, e.g. "127.0.0.1" for
+  ///        local clients only, or "0.0.0.0" for all the interfaces.
+  /// @param port is the TCP port to listen on.
+  /// @return false if the port cannot be listened on. Does not return
+  ///         otherwise.
+  bool Serve(const std::string& address, uint16_t port);
+
+ private:
+  JobServer(const JobServer&) = delete;
+  JobServer& operator=(const JobServer&) = delete;
+
+  enum class JobState { kQueued, kRunning, kSucceeded, kFailed };
+
+  struct Job {
+    PackagingParams packaging_params;
+    std::vector<StreamDescriptor> stream_descriptors;
+    JobState state = JobState::kQueued;
+    std::string error;
+  };
+
+  void WorkerMain();
+  void HandleSubmit(struct mg_connection* connection, const std::string& body);
+  void HandleQuery(struct mg_connection* connection, const std::string& uri);
+
+  static void HandleEvent(struct mg_connection* connection,
+                          int event,
+                          void* event_data,
+                          void* callback_data);
+
+  const PackagingParams packaging_params_;
+  std::unique_ptr<struct mg_mgr> manager_;
+  std::vector<std::thread> workers_;
+
+  absl::Mutex mutex_;
+  uint64_t next_job_id_ ABSL_GUARDED_BY(mutex_) = 1;
+  std::map<uint64_t, Job> jobs_ ABSL_GUARDED_BY(mutex_);
+  std::deque<uint64_t> queued_job_ids_ ABSL_GUARDED_BY(mutex_);
+  // The oldest finished jobs are forgotten first.
+  std::deque<uint64_t> finished_job_ids_ ABSL_GUARDED_BY(mutex_);
+  absl::CondVar job_queued_ ABSL_GUARDED_BY(mutex_);
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_APP_JOB_SERVER_H_
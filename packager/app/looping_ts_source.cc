@@ -0,0 +1,226 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/app/looping_ts_source.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <absl/log/log.h>
+
+namespace shaka {
+namespace {
+
+const size_t kTsPacketSize = 188;
+const uint8_t kTsSyncByte = 0x47;
+const uint16_t kNullPacketPid = 0x1FFF;
+const int64_t kTimestampMask = (int64_t{1} << 33) - 1;
+
+// The offsets of the timestamps of a transport stream packet, or 0 for the
+// timestamps it does not have.
+struct TimestampOffsets {
+  size_t pcr = 0;
+  size_t pts = 0;
+  size_t dts = 0;
+};
+
+uint16_t GetPid(const uint8_t* packet) {
+  return static_cast<uint16_t>(((packet[1] & 0x1F) << 8) | packet[2]);
+}
+
+bool HasPayload(const uint8_t* packet) {
+  return (packet[3] & 0x10) != 0;
+}
+
+TimestampOffsets FindTimestamps(const uint8_t* packet) {
+  TimestampOffsets offsets;
+  size_t payload_offset = 4;
+  if (packet[3] & 0x20) {
+    const size_t adaptation_field_length = packet[4];
+    if (adaptation_field_length >= 7 && (packet[5] & 0x10))
+      offsets.pcr = 6;
+    payload_offset = 5 + adaptation_field_length;
+  }
+
+  const bool payload_unit_start = (packet[1] & 0x40) != 0;
+  // The PES header, up to the PTS, must be in the packet.
+  if (!HasPayload(packet) || !payload_unit_start ||
+      payload_offset + 14 > kTsPacketSize) {
+    return offsets;
+  }
+  const uint8_t* pes = packet + payload_offset;
+  if (pes[0] != 0 || pes[1] != 0 || pes[2] != 1)
+    return offsets;
+  switch (pes[3]) {
+    // The streams without the optional PES header, see ISO/IEC 13818-1
+    // 2.4.3.7.
+    case 0xBC:
+    case 0xBE:
+    case 0xBF:
+    case 0xF0:
+    case 0xF1:
+    case 0xF2:
+    case 0xF8:
+    case 0xFF:
+      return offsets;
+  }
+  const uint8_t pts_dts_flags = pes[7] >> 6;
+  if (pts_dts_flags & 2)
+    offsets.pts = payload_offset + 9;
+  if (pts_dts_flags == 3 && payload_offset + 19 <= kTsPacketSize)
+    offsets.dts = payload_offset + 14;
+  return offsets;
+}
+
+int64_t ReadTimestamp(const uint8_t* data) {
+  return (static_cast<int64_t>(data[0] & 0x0E) << 29) |
+         (static_cast<int64_t>(data[1]) << 22) |
+         (static_cast<int64_t>(data[2] & 0xFE) << 14) |
+         (static_cast<int64_t>(data[3]) << 7) | (data[4] >> 1);
+}
+
+void WriteTimestamp(int64_t timestamp, uint8_t* data) {
+  data[0] = static_cast<uint8_t>((data[0] & 0xF1) | ((timestamp >> 29) & 0x0E));
+  data[1] = static_cast<uint8_t>(timestamp >> 22);
+  data[2] = static_cast<uint8_t>(((timestamp >> 14) & 0xFE) | 1);
+  data[3] = static_cast<uint8_t>(timestamp >> 7);
+  data[4] = static_cast<uint8_t>(((timestamp << 1) & 0xFE) | 1);
+}
+
+// Only the 90 kHz base of the PCR is shifted, its extension is kept.
+int64_t ReadPcrBase(const uint8_t* data) {
+  return (static_cast<int64_t>(data[0]) << 25) |
+         (static_cast<int64_t>(data[1]) << 17) |
+         (static_cast<int64_t>(data[2]) << 9) |
+         (static_cast<int64_t>(data[3]) << 1) | (data[4] >> 7);
+}
+
+void WritePcrBase(int64_t pcr_base, uint8_t* data) {
+  data[0] = static_cast<uint8_t>(pcr_base >> 25);
+  data[1] = static_cast<uint8_t>(pcr_base >> 17);
+  data[2] = static_cast<uint8_t>(pcr_base >> 9);
+  data[3] = static_cast<uint8_t>(pcr_base >> 1);
+  data[4] = static_cast<uint8_t>((data[4] & 0x7F) | ((pcr_base << 7) & 0x80));
+}
+
+}  // namespace
+
+LoopingTsSource::LoopingTsSource() = default;
+LoopingTsSource::~LoopingTsSource() = default;
+
+bool LoopingTsSource::Initialize(std::vector<uint8_t> data) {
+  if (data.empty() || data.size() % kTsPacketSize != 0) {
+    LOG(ERROR) << "The input is not a whole number of transport stream "
+                  "packets.";
+    return false;
+  }
+
+  std::map<uint16_t, std::vector<int64_t>> pts_by_pid;
+  int64_t earliest_timestamp = std::numeric_limits<int64_t>::max();
+  int64_t latest_pts = std::numeric_limits<int64_t>::min();
+  for (size_t position = 0; position < data.size();
+       position += kTsPacketSize) {
+    const uint8_t* packet = &data[position];
+    if (packet[0] != kTsSyncByte) {
+      LOG(ERROR) << "Lost the transport stream sync at " << position;
+      return false;
+    }
+    const TimestampOffsets offsets = FindTimestamps(packet);
+    if (!offsets.pts)
+      continue;
+    const int64_t pts = ReadTimestamp(packet + offsets.pts);
+    pts_by_pid[GetPid(packet)].push_back(pts);
+    earliest_timestamp = std::min(earliest_timestamp, pts);
+    latest_pts = std::max(latest_pts, pts);
+    if (offsets.dts) {
+      earliest_timestamp =
+          std::min(earliest_timestamp, ReadTimestamp(packet + offsets.dts));
+    }
+  }
+
+  // The next loop starts a frame after the end of this one, the longest frame
+  // of the streams, so that every stream goes on after its last frame.
+  int64_t frame_duration = 0;
+  for (auto& entry : pts_by_pid) {
+    std::vector<int64_t>& pts = entry.second;
+    std::sort(pts.begin(), pts.end());
+    int64_t stream_frame_duration = 0;
+    for (size_t i = 1; i < pts.size(); ++i) {
+      const int64_t delta = pts[i] - pts[i - 1];
+      if (delta > 0 &&
+          (stream_frame_duration == 0 || delta < stream_frame_duration)) {
+        stream_frame_duration = delta;
+      }
+    }
+    frame_duration = std::max(frame_duration, stream_frame_duration);
+  }
+  if (frame_duration == 0) {
+    LOG(ERROR) << "The input does not have enough timestamped frames to be "
+                  "looped.";
+    return false;
+  }
+
+  data_ = std::move(data);
+  start_timestamp_ = earliest_timestamp;
+  loop_duration_ = latest_pts - earliest_timestamp + frame_duration;
+  return true;
+}
+
+int64_t LoopingTsSource::Read(size_t max_packets,
+                              std::vector<uint8_t>* packets) {
+  packets->clear();
+  packets->reserve(max_packets * kTsPacketSize);
+  for (size_t i = 0; i < max_packets; ++i) {
+    if (position_ == data_.size()) {
+      position_ = 0;
+      ++loop_;
+    }
+    packets->insert(packets->end(), data_.begin() + position_,
+                    data_.begin() + position_ + kTsPacketSize);
+    position_ += kTsPacketSize;
+    uint8_t* packet = packets->data() + packets->size() - kTsPacketSize;
+
+    const int64_t offset = loop_ * loop_duration_;
+    const TimestampOffsets offsets = FindTimestamps(packet);
+    if (offsets.pcr) {
+      WritePcrBase((ReadPcrBase(packet + offsets.pcr) + offset) &
+                       kTimestampMask,
+                   packet + offsets.pcr);
+    }
+    if (offsets.pts) {
+      const int64_t pts = ReadTimestamp(packet + offsets.pts);
+      media_time_ = std::max(media_time_, pts - start_timestamp_ + offset);
+      WriteTimestamp((pts + offset) & kTimestampMask, packet + offsets.pts);
+    }
+    if (offsets.dts) {
+      WriteTimestamp(
+          (ReadTimestamp(packet + offsets.dts) + offset) & kTimestampMask,
+          packet + offsets.dts);
+    }
+
+    // Continue the continuity counters of the previous loop. Packets without
+    // payload repeat the counter of the previous packet.
+    const uint16_t pid = GetPid(packet);
+    if (pid == kNullPacketPid)
+      continue;
+    auto iter = continuity_counters_.find(pid);
+    if (iter == continuity_counters_.end()) {
+      iter = continuity_counters_.emplace(pid, packet[3] & 0x0F).first;
+      if (!HasPayload(packet))
+        iter->second = (iter->second + 1) & 0x0F;
+    }
+    if (HasPayload(packet)) {
+      packet[3] = static_cast<uint8_t>((packet[3] & 0xF0) | iter->second);
+      iter->second = (iter->second + 1) & 0x0F;
+    } else {
+      packet[3] = static_cast<uint8_t>((packet[3] & 0xF0) |
+                                       ((iter->second - 1) & 0x0F));
+    }
+  }
+  return media_time_;
+}
+
+}  // namespace shaka
@@ -0,0 +1,63 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_APP_LOOPING_TS_SOURCE_H_
+#define PACKAGER_APP_LOOPING_TS_SOURCE_H_
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace shaka {
+
+/// A synthetic live source which plays an MPEG-2 transport stream in a loop.
+/// Each loop is shifted in time, i.e. the PTS, DTS and PCR of its packets,
+/// and the continuity counters continue from the previous loop, so that the
+/// demuxer sees one endless stream. The timestamps wrap around at 33 bits, as
+/// in a real live stream.
+class LoopingTsSource {
+ public:
+  /// The clock of the timestamps of the transport stream.
+  static constexpr int64_t kTimescale = 90000;
+
+  LoopingTsSource();
+  ~LoopingTsSource();
+
+  /// @param data is the whole transport stream to loop. It must have PES
+  ///        packets with timestamps.
+  /// @return false if |data| is not a transport stream which can be looped.
+  bool Initialize(std::vector<uint8_t> data);
+
+  /// Read the next packets of the endless stream.
+  /// @param max_packets is the maximum number of packets to read.
+  /// @param packets receives the packets.
+  /// @return The media time reached by the packets, i.e. the latest PTS read
+  ///         so far, in kTimescale units since the start of the first loop.
+  int64_t Read(size_t max_packets, std::vector<uint8_t>* packets);
+
+  /// @return The duration of a loop, in kTimescale units.
+  int64_t loop_duration() const { return loop_duration_; }
+
+ private:
+  LoopingTsSource(const LoopingTsSource&) = delete;
+  LoopingTsSource& operator=(const LoopingTsSource&) = delete;
+
+  std::vector<uint8_t> data_;
+  // The earliest timestamp of the stream.
+  int64_t start_timestamp_ = 0;
+  int64_t loop_duration_ = 0;
+
+  // The next packet to read, in |loop_|.
+  size_t position_ = 0;
+  int64_t loop_ = 0;
+  int64_t media_time_ = 0;
+  // The next continuity counter of each PID.
+  std::map<uint16_t, uint8_t> continuity_counters_;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_APP_LOOPING_TS_SOURCE_H_
@@ -0,0 +1,124 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/app/manifest_aggregator.h>
+
+#include <absl/log/log.h>
+#include <absl/strings/str_format.h>
+#include <mongoose.h>
+
+#include <packager/hls/base/simple_hls_notifier.h>
+#include <packager/media/base/language_utils.h>
+#include <packager/media/event/manifest_aggregation.h>
+#include <packager/mpd/base/simple_mpd_notifier.h>
+
+namespace shaka {
+namespace {
+
+const char kEventsUri[] = "/events";
+const char kTextHeaders[] = "Content-Type: text/plain\r\n";
+// How long mongoose may wait for socket events.
+const int kPollIntervalMs = 100;
+
+}  // namespace
+
+ManifestAggregator::ManifestAggregator(const PackagingParams& packaging_params)
+    : manager_(new struct mg_mgr) {
+  // As the manifests of a packager, see Packager::Initialize().
+  MpdParams mpd_params = packaging_params.mpd_params;
+  HlsParams hls_params = packaging_params.hls_params;
+  const double target_segment_duration =
+      packaging_params.chunking_params.segment_duration_in_seconds;
+  mpd_params.target_segment_duration = target_segment_duration;
+  hls_params.target_segment_duration = target_segment_duration;
+  mpd_params.default_language =
+      LanguageToShortestForm(mpd_params.default_language);
+  mpd_params.default_text_language =
+      LanguageToShortestForm(mpd_params.default_text_language);
+  hls_params.default_language =
+      LanguageToShortestForm(hls_params.default_language);
+  hls_params.default_text_language =
+      LanguageToShortestForm(hls_params.default_text_language);
+  hls_params.is_independent_segments =
+      packaging_params.chunking_params.segment_sap_aligned;
+
+  if (!mpd_params.mpd_output.empty()) {
+    // The nodes only forward the notifications of live outputs.
+    MpdOptions mpd_options;
+    mpd_options.dash_profile = DashProfile::kLive;
+    mpd_options.mpd_type = mpd_params.generate_static_live_mpd
+                               ? MpdType::kStatic
+                               : MpdType::kDynamic;
+    mpd_options.mpd_params = mpd_params;
+    mpd_notifier_.reset(new SimpleMpdNotifier(mpd_options));
+  }
+  if (!hls_params.master_playlist_output.empty())
+    hls_notifier_.reset(new hls::SimpleHlsNotifier(hls_params));
+  replayer_.reset(new media::ManifestEventReplayer(mpd_notifier_.get(),
+                                                   hls_notifier_.get()));
+  mg_mgr_init(manager_.get());
+}
+
+ManifestAggregator::~ManifestAggregator() {
+  mg_mgr_free(manager_.get());
+}
+
+bool ManifestAggregator::Serve(uint16_t port) {
+  if (!mpd_notifier_ && !hls_notifier_) {
+    LOG(ERROR) << "The manifest aggregator requires --mpd_output or "
+                  "--hls_master_playlist_output.";
+    return false;
+  }
+  if ((mpd_notifier_ && !mpd_notifier_->Init()) ||
+      (hls_notifier_ && !hls_notifier_->Init())) {
+    LOG(ERROR) << "Failed to initialize the manifests.";
+    return false;
+  }
+
+  const std::string url = absl::StrFormat("http://0.0.0.0:%u", port);
+  if (!mg_http_listen(manager_.get(), url.c_str(),
+                      &ManifestAggregator::HandleEvent,
+                      this /* callback_data */)) {
+    LOG(ERROR) << "Unable to aggregate manifests on port " << port;
+    return false;
+  }
+  LOG(INFO) << "Aggregating manifest notifications on port " << port;
+
+  while (true)
+    mg_mgr_poll(manager_.get(), kPollIntervalMs);
+}
+
+// static
+void ManifestAggregator::HandleEvent(struct mg_connection* connection,
+                                     int event,
+                                     void* event_data,
+                                     void* callback_data) {
+  if (event != MG_EV_HTTP_MSG)
+    return;
+
+  ManifestAggregator* aggregator =
+      static_cast<ManifestAggregator*>(callback_data);
+  struct mg_http_message* message =
+      static_cast<struct mg_http_message*>(event_data);
+  if (std::string(message->method.ptr, message->method.len) != "POST" ||
+      !mg_http_match_uri(message, kEventsUri)) {
+    mg_http_reply(connection, 404 /* not found */, kTextHeaders,
+                  "Not found.\n");
+    return;
+  }
+
+  const Status status = aggregator->replayer_->Apply(
+      std::string(message->body.ptr, message->body.len));
+  if (!status.ok()) {
+    LOG(WARNING) << "Rejected manifest notifications: " << status;
+    mg_http_reply(connection, 400 /* bad request */, kTextHeaders, "%s\n",
+                  status.ToString().c_str());
+    return;
+  }
+  mg_http_reply(connection, 200 /* OK */, kTextHeaders, "");
+}
+
+}  // namespace shaka
@@ -0,0 +1,67 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_APP_MANIFEST_AGGREGATOR_H_
+#define PACKAGER_APP_MANIFEST_AGGREGATOR_H_
+
+#include <cstdint>
+#include <memory>
+
+#include <packager/packager.h>
+
+// Forward declare mongoose struct types, used as pointers below.
+struct mg_connection;
+struct mg_mgr;
+
+namespace shaka {
+
+class MpdNotifier;
+
+namespace hls {
+class HlsNotifier;
+}  // namespace hls
+
+namespace media {
+class ManifestEventReplayer;
+}  // namespace media
+
+/// Writes the live manifests of a distributed packager, from the manifest
+/// notifications of its nodes, the packagers run with
+/// PackagingParams::manifest_aggregator_url pointing to the aggregator.
+///
+/// The nodes POST batches of notifications, lines of JSON, to "/events". The
+/// reply is 200 once they are applied, or 400 if they are malformed.
+class ManifestAggregator {
+ public:
+  /// @param packaging_params are the parameters of the manifests, with the
+  ///        segment duration used by the nodes.
+  explicit ManifestAggregator(const PackagingParams& packaging_params);
+  ~ManifestAggregator();
+
+  /// Serves the nodes from the calling thread.
+  /// @param port is the TCP port to listen on, on all interfaces.
+  /// @return false if the manifests cannot be written or the port cannot be
+  ///         listened on. Does not return otherwise.
+  bool Serve(uint16_t port);
+
+ private:
+  ManifestAggregator(const ManifestAggregator&) = delete;
+  ManifestAggregator& operator=(const ManifestAggregator&) = delete;
+
+  static void HandleEvent(struct mg_connection* connection,
+                          int event,
+                          void* event_data,
+                          void* callback_data);
+
+  std::unique_ptr<MpdNotifier> mpd_notifier_;
+  std::unique_ptr<hls::HlsNotifier> hls_notifier_;
+  std::unique_ptr<media::ManifestEventReplayer> replayer_;
+  std::unique_ptr<struct mg_mgr> manager_;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_APP_MANIFEST_AGGREGATOR_H_
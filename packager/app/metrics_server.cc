@@ -0,0 +1,75 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/app/metrics_server.h>
+
+#include <string>
+
+#include <absl/log/log.h>
+#include <absl/strings/str_format.h>
+#include <mongoose.h>
+
+#include <packager/utils/metrics.h>
+
+namespace shaka {
+namespace {
+
+// How long mongoose may wait for socket events before the stop flag is checked
+// again.
+const int kPollIntervalMs = 100;
+
+}  // namespace
+
+MetricsServer::MetricsServer() : manager_(new struct mg_mgr) {
+  mg_mgr_init(manager_.get());
+}
+
+MetricsServer::~MetricsServer() {
+  stopped_ = true;
+  if (thread_)
+    thread_->join();
+  mg_mgr_free(manager_.get());
+}
+
+bool MetricsServer::Start(uint16_t port) {
+  const std::string url = absl::StrFormat("http://0.0.0.0:%u", port);
+  if (!mg_http_listen(manager_.get(), url.c_str(), &MetricsServer::HandleEvent,
+                      this /* callback_data */)) {
+    LOG(ERROR) << "Unable to serve metrics on port " << port;
+    return false;
+  }
+  thread_.reset(new std::thread(&MetricsServer::ThreadMain, this));
+  return true;
+}
+
+void MetricsServer::ThreadMain() {
+  while (!stopped_)
+    mg_mgr_poll(manager_.get(), kPollIntervalMs);
+}
+
+// static
+void MetricsServer::HandleEvent(struct mg_connection* connection,
+                                int event,
+                                void* event_data,
+                                void* callback_data) {
+  if (event != MG_EV_HTTP_MSG)
+    return;
+
+  struct mg_http_message* message =
+      static_cast<struct mg_http_message*>(event_data);
+  if (!mg_http_match_uri(message, "/metrics")) {
+    mg_http_reply(connection, 404 /* not found */, NULL /* headers */,
+                  "Not found\n");
+    return;
+  }
+
+  const std::string text = MetricsRegistry::GetInstance()->ToPrometheusText();
+  mg_http_reply(connection, 200 /* OK */,
+                "Content-Type: text/plain; version=0.0.4\r\n", "%s",
+                text.c_str());
+}
+
+}  // namespace shaka
@@ -0,0 +1,50 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_APP_METRICS_SERVER_H_
+#define PACKAGER_APP_METRICS_SERVER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+// Forward declare mongoose struct types, used as pointers below.
+struct mg_connection;
+struct mg_mgr;
+
+namespace shaka {
+
+/// Serves the metrics of MetricsRegistry at "/metrics" in the Prometheus text
+/// format, from a thread of its own, until destroyed.
+class MetricsServer {
+ public:
+  MetricsServer();
+  ~MetricsServer();
+
+  /// @param port is the TCP port to listen on, on all interfaces.
+  /// @return true if the server is listening, false otherwise.
+  bool Start(uint16_t port);
+
+ private:
+  MetricsServer(const MetricsServer&) = delete;
+  MetricsServer& operator=(const MetricsServer&) = delete;
+
+  void ThreadMain();
+
+  static void HandleEvent(struct mg_connection* connection,
+                          int event,
+                          void* event_data,
+                          void* callback_data);
+
+  std::unique_ptr<struct mg_mgr> manager_;
+  std::atomic<bool> stopped_{false};
+  std::unique_ptr<std::thread> thread_;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_APP_METRICS_SERVER_H_
@@ -23,6 +23,14 @@ ABSL_FLAG(bool,
           "Create a human readable format of MediaInfo. The output file name "
           "will be the name specified by output flag, suffixed with "
           "'.media_info'.");
+ABSL_FLAG(std::string,
+          media_info_format,
+          "text",
+          "The format of the MediaInfo files created with --output_media_info: "
+          "'text', 'binary' or 'json'. The suffix of binary files is "
+          "'.media_info.pb' and the suffix of JSON files is "
+          "'.media_info.json'. Binary files are the fastest to write and to "
+          "parse, e.g. with mpd_generator.");
 ABSL_FLAG(std::string, mpd_output, "", "MPD output file name.");
 ABSL_FLAG(std::string,
           base_urls,
@@ -40,6 +48,13 @@ ABSL_FLAG(double,
           "Indicates to the player how often to refresh the media "
           "presentation description in seconds. This value is used for "
           "dynamic MPD only.");
+ABSL_FLAG(double,
+          mpd_min_write_interval,
+          0.0,
+          "The minimum interval, in seconds, between two writes of the MPD. "
+          "If set, updates from all the representations within the interval "
+          "are coalesced into a single write. This value is used for dynamic "
+          "MPD only.");
 ABSL_FLAG(double,
           suggested_presentation_delay,
           0.0,
@@ -98,3 +113,18 @@ ABSL_FLAG(
     "https://shaka-project.github.io/shaka-packager/html/tutorials/low_latency.html "
     // clang-format on
     "for more information.");
+ABSL_FLAG(std::string,
+          mpd_vod_archive_output,
+          "",
+          "If set, a static MPD of all the segments of a dynamic MPD is "
+          "written to this path once the live presentation ends, without "
+          "demuxing the segments again. It must be in the same directory as "
+          "--mpd_output. Requires --preserved_segments_outside_live_window=0 "
+          "so that the segments are kept.");
+ABSL_FLAG(std::string,
+          mpd_patch_output,
+          "",
+          "If set, each update of a dynamic MPD also writes an MPD Patch from "
+          "the previous update to this path, and the MPD points to it with a "
+          "PatchLocation, so that the clients fetch the changes instead of "
+          "the whole MPD. It must be in the same directory as --mpd_output.");
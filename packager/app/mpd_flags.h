@@ -14,9 +14,11 @@
 
 ABSL_DECLARE_FLAG(bool, generate_static_live_mpd);
 ABSL_DECLARE_FLAG(bool, output_media_info);
+ABSL_DECLARE_FLAG(std::string, media_info_format);
 ABSL_DECLARE_FLAG(std::string, mpd_output);
 ABSL_DECLARE_FLAG(std::string, base_urls);
 ABSL_DECLARE_FLAG(double, minimum_update_period);
+ABSL_DECLARE_FLAG(double, mpd_min_write_interval);
 ABSL_DECLARE_FLAG(double, min_buffer_time);
 ABSL_DECLARE_FLAG(double, suggested_presentation_delay);
 ABSL_DECLARE_FLAG(std::string, utc_timings);
@@ -26,5 +28,7 @@ ABSL_DECLARE_FLAG(bool, allow_codec_switching);
 ABSL_DECLARE_FLAG(bool, include_mspr_pro_for_playready);
 ABSL_DECLARE_FLAG(bool, dash_force_segment_list);
 ABSL_DECLARE_FLAG(bool, low_latency_dash_mode);
+ABSL_DECLARE_FLAG(std::string, mpd_vod_archive_output);
+ABSL_DECLARE_FLAG(std::string, mpd_patch_output);
 
 #endif  // APP_MPD_FLAGS_H_
@@ -4,7 +4,11 @@
 // license that can be found in the LICENSE file or at
 // https://developers.google.com/open-source/licenses/bsd
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #if defined(OS_WIN)
 #include <codecvt>
@@ -19,8 +23,10 @@
 #include <absl/log/log.h>
 #include <absl/strings/str_format.h>
 #include <absl/strings/str_split.h>
+#include <absl/strings/strip.h>
 
 #include <packager/app/mpd_generator_flags.h>
+#include <packager/file.h>
 #include <packager/mpd/util/mpd_writer.h>
 #include <packager/tools/license_notice.h>
 #include <packager/version/version.h>
@@ -47,16 +53,27 @@ const char kUsage[] =
     "audio, and 1 text.\n"
     "Sample Usage:\n"
     "%s --input=\"video1.media_info,video2.media_info,audio1.media_info\" "
-    "--output=\"video_audio.mpd\"";
+    "--output=\"video_audio.mpd\"\n"
+    "MediaInfo files ending with \".pb\" are read as binary protobufs.";
 
 enum ExitStatus {
   kSuccess = 0,
   kEmptyInputError,
   kEmptyOutputError,
-  kFailedToWriteMpdToFileError
+  kFailedToWriteMpdToFileError,
+  kFailedToReadBatchError
+};
+
+// An MPD to generate.
+struct MpdJob {
+  std::string output;
+  std::vector<std::string> input_files;
 };
 
 ExitStatus CheckRequiredFlags() {
+  if (!absl::GetFlag(FLAGS_batch).empty())
+    return kSuccess;
+
   if (absl::GetFlag(FLAGS_input).empty()) {
     LOG(ERROR) << "--input is required.";
     return kEmptyInputError;
@@ -70,34 +87,97 @@ ExitStatus CheckRequiredFlags() {
   return kSuccess;
 }
 
+bool GenerateMpd(const MpdJob& job,
+                 const std::vector<std::string>& base_urls) {
+  MpdWriter mpd_writer;
+  for (const std::string& base_url : base_urls)
+    mpd_writer.AddBaseUrl(base_url);
+
+  for (const std::string& file : job.input_files) {
+    if (!mpd_writer.AddFile(file)) {
+      LOG(WARNING) << "MpdWriter failed to read " << file << ", skipping.";
+    }
+  }
+
+  if (!mpd_writer.WriteMpdToFile(job.output.c_str())) {
+    LOG(ERROR) << "Failed to write MPD to " << job.output;
+    return false;
+  }
+  return true;
+}
+
+bool ReadBatch(const std::string& batch_file, std::vector<MpdJob>* jobs) {
+  std::string content;
+  if (!File::ReadFileToString(batch_file.c_str(), &content)) {
+    LOG(ERROR) << "Failed to read " << batch_file;
+    return false;
+  }
+  for (absl::string_view line : absl::StrSplit(content, '\n')) {
+    line = absl::StripAsciiWhitespace(line);
+    if (line.empty() || line[0] == '#')
+      continue;
+    std::vector<std::string> fields =
+        absl::StrSplit(line, absl::ByAnyChar(" \t"), absl::SkipEmpty());
+    if (fields.size() != 2) {
+      LOG(ERROR) << "Invalid line in " << batch_file << ": " << line;
+      return false;
+    }
+    MpdJob job;
+    job.output = fields[0];
+    job.input_files = absl::StrSplit(fields[1], ",", absl::SkipEmpty());
+    jobs->push_back(std::move(job));
+  }
+  return true;
+}
+
+// Generates the MPDs of |jobs| on a pool of threads. Each thread reads the
+// MediaInfo files and writes the MPD of one job at a time.
+bool GenerateMpds(const std::vector<MpdJob>& jobs,
+                  const std::vector<std::string>& base_urls) {
+  int num_threads = absl::GetFlag(FLAGS_batch_threads);
+  if (num_threads <= 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  num_threads = std::min(num_threads, static_cast<int>(jobs.size()));
+
+  std::atomic<size_t> next_job(0);
+  std::atomic<bool> success(true);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&jobs, &base_urls, &next_job, &success]() {
+      for (size_t job = next_job++; job < jobs.size(); job = next_job++) {
+        if (!GenerateMpd(jobs[job], base_urls))
+          success = false;
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  return success;
+}
+
 ExitStatus RunMpdGenerator() {
   DCHECK_EQ(CheckRequiredFlags(), kSuccess);
   std::vector<std::string> base_urls;
-  typedef std::vector<std::string>::const_iterator Iterator;
-
-  std::vector<std::string> input_files =
-      absl::StrSplit(absl::GetFlag(FLAGS_input), ",", absl::AllowEmpty());
-
   if (!absl::GetFlag(FLAGS_base_urls).empty()) {
     base_urls =
         absl::StrSplit(absl::GetFlag(FLAGS_base_urls), ",", absl::AllowEmpty());
   }
 
-  MpdWriter mpd_writer;
-  for (Iterator it = base_urls.begin(); it != base_urls.end(); ++it)
-    mpd_writer.AddBaseUrl(*it);
-
-  for (const std::string& file : input_files) {
-    if (!mpd_writer.AddFile(file)) {
-      LOG(WARNING) << "MpdWriter failed to read " << file << ", skipping.";
-    }
+  if (!absl::GetFlag(FLAGS_batch).empty()) {
+    std::vector<MpdJob> jobs;
+    if (!ReadBatch(absl::GetFlag(FLAGS_batch), &jobs))
+      return kFailedToReadBatchError;
+    if (!GenerateMpds(jobs, base_urls))
+      return kFailedToWriteMpdToFileError;
+    return kSuccess;
   }
 
-  if (!mpd_writer.WriteMpdToFile(absl::GetFlag(FLAGS_output).c_str())) {
-    LOG(ERROR) << "Failed to write MPD to " << absl::GetFlag(FLAGS_output);
+  MpdJob job;
+  job.output = absl::GetFlag(FLAGS_output);
+  job.input_files =
+      absl::StrSplit(absl::GetFlag(FLAGS_input), ",", absl::AllowEmpty());
+  if (!GenerateMpd(job, base_urls))
     return kFailedToWriteMpdToFileError;
-  }
-
   return kSuccess;
 }
 
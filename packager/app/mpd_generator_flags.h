@@ -19,4 +19,17 @@ ABSL_FLAG(std::string,
           "",
           "Comma separated BaseURLs for the MPD. The values will be added "
           "as <BaseURL> element(s) immediately under the <MPD> element.");
+ABSL_FLAG(std::string,
+          batch,
+          "",
+          "A file listing the MPDs to generate, replacing --input and "
+          "--output. Each line has an MPD output file name and a comma "
+          "separated list of its MediaInfo input files, separated by "
+          "whitespace. Empty lines and lines starting with '#' are ignored. "
+          "The MPDs are generated in parallel.");
+ABSL_FLAG(int32_t,
+          batch_threads,
+          0,
+          "The number of threads generating the MPDs in --batch. Defaults to "
+          "the number of cores.");
 #endif  // APP_MPD_GENERATOR_FLAGS_H_
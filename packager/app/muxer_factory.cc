@@ -21,20 +21,15 @@ namespace media {
 MuxerFactory::MuxerFactory(const PackagingParams& packaging_params)
     : mp4_params_(packaging_params.mp4_output_params),
       temp_dir_(packaging_params.temp_dir),
+      webm_one_pass_single_segment_(
+          packaging_params.webm_one_pass_single_segment),
       transport_stream_timestamp_offset_ms_(
           packaging_params.transport_stream_timestamp_offset_ms) {}
 
 std::shared_ptr<Muxer> MuxerFactory::CreateMuxer(
     MediaContainerName output_format,
     const StreamDescriptor& stream) {
-  MuxerOptions options;
-  options.mp4_params = mp4_params_;
-  options.transport_stream_timestamp_offset_ms =
-      transport_stream_timestamp_offset_ms_;
-  options.temp_dir = temp_dir_;
-  options.output_file_name = stream.output;
-  options.segment_template = stream.segment_template;
-  options.bandwidth = stream.bandwidth;
+  const MuxerOptions options = CreateMuxerOptions(stream);
 
   std::shared_ptr<Muxer> muxer;
 
@@ -78,6 +73,20 @@ std::shared_ptr<Muxer> MuxerFactory::CreateMuxer(
   return muxer;
 }
 
+MuxerOptions MuxerFactory::CreateMuxerOptions(
+    const StreamDescriptor& stream) const {
+  MuxerOptions options;
+  options.mp4_params = mp4_params_;
+  options.transport_stream_timestamp_offset_ms =
+      transport_stream_timestamp_offset_ms_;
+  options.temp_dir = temp_dir_;
+  options.webm_one_pass_single_segment = webm_one_pass_single_segment_;
+  options.output_file_name = stream.output;
+  options.segment_template = stream.segment_template;
+  options.bandwidth = stream.bandwidth;
+  return options;
+}
+
 void MuxerFactory::OverrideClock(std::shared_ptr<Clock> clock) {
   clock_ = clock;
 }
@@ -11,6 +11,7 @@
 #include <string>
 
 #include <packager/media/base/container_names.h>
+#include <packager/media/base/muxer_options.h>
 #include <packager/mp4_output_params.h>
 #include <packager/mpd/base/mpd_builder.h>
 
@@ -35,6 +36,9 @@ class MuxerFactory {
   std::shared_ptr<Muxer> CreateMuxer(MediaContainerName output_format,
                                      const StreamDescriptor& stream);
 
+  /// @return the options of the muxers created for @a stream.
+  MuxerOptions CreateMuxerOptions(const StreamDescriptor& stream) const;
+
   /// For testing, if you need to replace the clock that muxers work with
   /// this will replace the clock for all muxers created after this call.
   void OverrideClock(std::shared_ptr<Clock> clock);
@@ -49,6 +53,7 @@ class MuxerFactory {
 
   const Mp4OutputParams mp4_params_;
   const std::string temp_dir_;
+  const bool webm_one_pass_single_segment_;
   int32_t transport_stream_timestamp_offset_ms_ = 0;
   std::shared_ptr<Clock> clock_ = nullptr;
 };
@@ -50,10 +50,65 @@ ABSL_FLAG(std::string,
           "",
           "Specify a directory in which to store temporary (intermediate) "
           " files. Used only if single_segment=true.");
+ABSL_FLAG(bool,
+          webm_one_pass_single_segment,
+          false,
+          "WebM only: write single-segment output in one pass, reserving "
+          "space for the Cues after the header instead of copying the "
+          "clusters from a temporary file. Requires seekable output files.");
 ABSL_FLAG(bool,
           mp4_include_pssh_in_stream,
           true,
           "MP4 only: include pssh in the encrypted stream.");
+ABSL_FLAG(bool,
+          mp4_preopen_next_segment,
+          false,
+          "MP4 only: open the file of the next media segment as soon as a "
+          "media segment is written, so that the next segment is published "
+          "without waiting for its file to open. Only applies to segment "
+          "templates without $Time$. The file of the next segment exists, "
+          "empty, until it is written.");
+ABSL_FLAG(bool,
+          mp4_include_emsg,
+          false,
+          "MP4 only: insert an event message (emsg) box in the media "
+          "segments for each ad cue, with the SCTE-35 scheme. Applies to "
+          "multi-segment and low latency DASH outputs.");
+ABSL_FLAG(bool,
+          mp4_include_prft,
+          false,
+          "MP4 only: insert a producer reference time (prft) box in each "
+          "media segment, with the wall-clock time the segment is written. "
+          "Applies to multi-segment and low latency DASH outputs.");
+ABSL_FLAG(bool,
+          mp4_async_segment_uploads,
+          false,
+          "MP4 only: write the media segments in the background, so that a "
+          "slow upload does not hold up packaging. The manifests are updated "
+          "once the segments are written. See also --max_uploads_per_host.");
+ABSL_FLAG(int32_t,
+          mp4_max_pending_segment_uploads,
+          2,
+          "MP4 only: the most media segments of an output written in the "
+          "background with --mp4_async_segment_uploads. Packaging of the "
+          "output waits for the oldest segment to be written beyond that.");
+ABSL_FLAG(bool,
+          mp4_passthrough_fragments,
+          false,
+          "MP4 only: copy the fragments of a fragmented MP4 input with a "
+          "single clear track verbatim into the media segments, instead of "
+          "remuxing its samples, if the output has a segment template and "
+          "nothing else, e.g. encryption or trick play, needs the samples. "
+          "The segments then start at fragments of the input.");
+ABSL_FLAG(double,
+          mp4_segment_bundle_duration,
+          0,
+          "MP4 only: append consecutive media segments of a segment template "
+          "output to one file, named after its first segment, until the file "
+          "holds at least this many seconds of media. The manifests address "
+          "the segments with byte ranges, and are updated once a bundle is "
+          "closed. Cuts the number of objects written to an object store. "
+          "0 writes each segment to its own file.");
 ABSL_FLAG(int32_t,
           transport_stream_timestamp_offset_ms,
           100,
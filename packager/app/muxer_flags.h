@@ -19,7 +19,15 @@ ABSL_DECLARE_FLAG(double, fragment_duration);
 ABSL_DECLARE_FLAG(bool, fragment_sap_aligned);
 ABSL_DECLARE_FLAG(bool, generate_sidx_in_media_segments);
 ABSL_DECLARE_FLAG(std::string, temp_dir);
+ABSL_DECLARE_FLAG(bool, webm_one_pass_single_segment);
 ABSL_DECLARE_FLAG(bool, mp4_include_pssh_in_stream);
+ABSL_DECLARE_FLAG(bool, mp4_preopen_next_segment);
+ABSL_DECLARE_FLAG(bool, mp4_include_emsg);
+ABSL_DECLARE_FLAG(bool, mp4_include_prft);
+ABSL_DECLARE_FLAG(bool, mp4_async_segment_uploads);
+ABSL_DECLARE_FLAG(int32_t, mp4_max_pending_segment_uploads);
+ABSL_DECLARE_FLAG(bool, mp4_passthrough_fragments);
+ABSL_DECLARE_FLAG(double, mp4_segment_bundle_duration);
 ABSL_DECLARE_FLAG(int32_t, transport_stream_timestamp_offset_ms);
 ABSL_DECLARE_FLAG(int32_t, default_text_zero_bias_ms);
 ABSL_DECLARE_FLAG(int64_t, start_segment_number);
@@ -4,8 +4,12 @@
 // license that can be found in the LICENSE file or at
 // https://developers.google.com/open-source/licenses/bsd
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <optional>
+#include <set>
+#include <thread>
 
 #if defined(OS_WIN)
 #include <codecvt>
@@ -19,14 +23,20 @@
 #include <absl/log/globals.h>
 #include <absl/log/initialize.h>
 #include <absl/log/log.h>
+#include <absl/strings/match.h>
 #include <absl/strings/numbers.h>
 #include <absl/strings/str_format.h>
 #include <absl/strings/str_split.h>
+#include <absl/synchronization/notification.h>
 
 #include <packager/app/ad_cue_generator_flags.h>
+#include <packager/app/allocator_stats.h>
 #include <packager/app/crypto_flags.h>
 #include <packager/app/hls_flags.h>
+#include <packager/app/job_server.h>
+#include <packager/app/manifest_aggregator.h>
 #include <packager/app/manifest_flags.h>
+#include <packager/app/metrics_server.h>
 #include <packager/app/mpd_flags.h>
 #include <packager/app/muxer_flags.h>
 #include <packager/app/playready_key_encryption_flags.h>
@@ -38,10 +48,19 @@
 #include <packager/file.h>
 #include <packager/kv_pairs/kv_pairs.h>
 #include <packager/tools/license_notice.h>
+#include <packager/utils/container_limits.h>
+#include <packager/utils/trace.h>
 #include <packager/utils/string_trim_split.h>
 
 ABSL_FLAG(bool, dump_stream_info, false, "Dump demuxed stream info.");
 ABSL_FLAG(bool, licenses, false, "Dump licenses.");
+ABSL_FLAG(bool,
+          probe,
+          false,
+          "Print the streams of the inputs of the stream descriptors, one JSON "
+          "object per input, instead of packaging them. Only the start of "
+          "each input is read. Only the input fields of the stream "
+          "descriptors are used.");
 ABSL_FLAG(bool, quiet, false, "When enabled, LOG(INFO) output is suppressed.");
 ABSL_FLAG(bool,
           use_fake_clock_for_muxer,
@@ -57,9 +76,219 @@ ABSL_FLAG(bool,
           single_threaded,
           false,
           "If enabled, only use one thread when generating content.");
+ABSL_FLAG(bool,
+          thread_per_output,
+          false,
+          "If enabled, process each output stream in its own thread, so that "
+          "multiple outputs from the same input can be generated in "
+          "parallel. Ignored if --single_threaded is set.");
+ABSL_FLAG(uint32_t,
+          job_threads,
+          0,
+          "The maximum number of inputs to process in parallel. Additional "
+          "inputs wait for earlier ones to complete. Zero (the default) "
+          "processes all inputs in parallel. Ignored with --ad_cues.");
+ABSL_FLAG(std::string,
+          cpus,
+          "",
+          "The CPUs to run the inputs on, as a list of CPUs and ranges of "
+          "CPUs, e.g. '0-11,48-59'. Linux only.");
+ABSL_FLAG(std::string,
+          cpu_placement,
+          "none",
+          "How the inputs are placed on the CPUs: 'none' to run them on any "
+          "of the CPUs, 'job' to run each input on a CPU of its own, or "
+          "'numa_node' to run each input on the CPUs of a NUMA node, so that "
+          "its memory is local. Where each input runs is logged. Linux "
+          "only.");
+ABSL_FLAG(std::string,
+          priority_class,
+          "live",
+          "The priority of the packaging relative to the other packagers of "
+          "the process, e.g. of --job_server_port: 'live' or 'background'. "
+          "Background work yields the CPU to the live work, and its file I/O "
+          "is limited to --background_io_rate while live work runs.");
+ABSL_FLAG(uint64_t,
+          background_io_rate,
+          0,
+          "If positive, the file I/O rate, in bytes per second, of the "
+          "background packagers of the process while live packagers run.");
+ABSL_FLAG(uint32_t,
+          bandwidth_window_segments,
+          0,
+          "If positive, the bandwidth in the MPD and the HLS playlists is "
+          "computed from the last this many segments of each stream, instead "
+          "of all its segments. Useful for long running live streams.");
+ABSL_FLAG(bool,
+          write_gzip_manifests,
+          false,
+          "If enabled, the MPD and the HLS playlists are also written "
+          "compressed with gzip, next to them with '.gz' appended to the "
+          "file names, so that the origin can serve them precompressed.");
+ABSL_FLAG(bool,
+          mmap_local_inputs,
+          false,
+          "If enabled, local MP4 inputs are memory mapped and parsed directly "
+          "from the mapping. Do not use with inputs that are still being "
+          "written.");
+ABSL_FLAG(uint32_t,
+          parsing_threads,
+          0,
+          "The number of threads used to parse each fragmented MP4 input. If "
+          "larger than 1, the fragments of seekable inputs are parsed in "
+          "parallel and merged back in order. Encrypted inputs that are "
+          "decrypted are always parsed on one thread.");
+ABSL_FLAG(uint64_t,
+          max_pending_stream_bytes,
+          0,
+          "The maximum size of the samples of an input queued until all its "
+          "streams have started, e.g. until an audio PID of an MPEG-2 TS "
+          "input which starts late sends its configuration. 0 for no limit.");
+ABSL_FLAG(std::string,
+          pending_stream_policy,
+          "fail",
+          "What to do when --max_pending_stream_bytes is exceeded: 'fail' to "
+          "fail the input, or 'drop' to drop the streams which have not "
+          "started and go on with the others (MPEG-2 TS inputs only).");
+ABSL_FLAG(bool,
+          multiplex_text_inputs,
+          false,
+          "If enabled, the text inputs, e.g. subtitles in many languages, are "
+          "all processed in a single job instead of one thread each.");
+ABSL_FLAG(uint32_t,
+          text_heartbeat_interval_ms,
+          0,
+          "In live packaging, the text streams of an input with other "
+          "streams, e.g. the subtitles of an MPEG-2 TS input, which have had "
+          "no sample for this long are advanced with empty segments up to "
+          "the other streams, less this interval, instead of holding back "
+          "their output until their next sample. It must be longer than the "
+          "delay of the text samples behind the other streams. 0 disables "
+          "it.");
+ABSL_FLAG(uint32_t,
+          handler_stats_interval,
+          0,
+          "If positive, log the time spent and the samples processed in each "
+          "media handler of the pipeline, and the memory used by the largest "
+          "consumers, every this many seconds, and once more when packaging "
+          "completes.");
+ABSL_FLAG(uint32_t,
+          progress_interval,
+          0,
+          "If positive, log the progress of packaging every this many "
+          "seconds: the fraction of the inputs read, the media time, the "
+          "realtime factor, the input and output rates and the estimated "
+          "time left.");
+ABSL_FLAG(uint32_t,
+          metrics_port,
+          0,
+          "If positive, serve live packaging metrics in the Prometheus text "
+          "format at http://<host>:<metrics_port>/metrics while packaging.");
+ABSL_FLAG(uint32_t,
+          job_server_port,
+          0,
+          "If positive, run as a server of packaging jobs, submitted over "
+          "HTTP on this port, instead of packaging the stream descriptors of "
+          "the command line. The other flags apply to all the jobs. See "
+          "packager/app/job_server.h for the protocol.");
+ABSL_FLAG(std::string,
+          job_server_address,
+          "127.0.0.1",
+          "The IP address which --job_server_port listens on. The jobs are "
+          "not authenticated, so the default only accepts local clients. Use "
+          "0.0.0.0 to accept the clients of all the interfaces, on a trusted "
+          "network only.");
+ABSL_FLAG(uint32_t,
+          job_server_workers,
+          1,
+          "The number of jobs run at a time with --job_server_port.");
+ABSL_FLAG(std::string,
+          trace_output,
+          "",
+          "If set, record the segment lifecycle events, e.g. segment cuts, "
+          "fragment and segment finalization, file opens and closes and "
+          "manifest flushes, and write them to this file in the Chrome "
+          "trace event format when packaging completes.");
+ABSL_FLAG(uint64_t,
+          memory_budget,
+          0,
+          "If positive, the memory, in bytes, above which the inputs are read "
+          "and the outputs are written more slowly, so that the buffered "
+          "samples and files stay within it.");
+ABSL_FLAG(std::string,
+          atomic_write_durability,
+          "none",
+          "The durability of the manifest updates and other atomic writes of "
+          "local files: 'none' to not wait for the disk, e.g. on tmpfs, 'file' "
+          "to sync the data of the new file before it replaces the previous "
+          "one, or 'directory' to also sync the directory after the "
+          "replacement.");
+ABSL_FLAG(std::string,
+          huge_pages,
+          "none",
+          "The pages backing the large buffers, e.g. the I/O caches and the "
+          "fragment buffers: 'none' for regular pages, 'transparent' for "
+          "transparent huge pages, or 'explicit' for the huge pages reserved "
+          "in /proc/sys/vm/nr_hugepages. Linux only.");
+ABSL_FLAG(bool,
+          container_limits,
+          true,
+          "Derive the defaults of --job_threads, --memory_budget and "
+          "--io_cache_size from the CPU quota and the memory limit of the "
+          "control group, e.g. of the container, the packager runs in. The "
+          "flags set on the command line are kept.");
+ABSL_FLAG(bool,
+          output_segment_index,
+          false,
+          "For single-file outputs, write a binary index of the byte ranges "
+          "of the segments and of their key frames next to each output, at "
+          "its name with '.idx' appended.");
+ABSL_FLAG(bool,
+          async_manifest_updates,
+          false,
+          "Update the manifests and the media info files of each stream from "
+          "a thread of their own, in order, so that the packaging never waits "
+          "for the manifest writes. The published times of "
+          "--segment_latency_log are then the times the updates are queued.");
+ABSL_FLAG(std::string,
+          segment_latency_log,
+          "",
+          "If set, write a line of JSON to this file for each segment, with "
+          "the wall-clock times, in milliseconds, at which its first sample "
+          "was read, it was cut by the chunker, its encryption finished, it "
+          "was fully written and the manifests were updated with it.");
+ABSL_FLAG(std::string,
+          segment_event_url,
+          "",
+          "If set, send a line of JSON to this URL for each segment once it "
+          "is written, with its name, size, timestamps and output, e.g. for "
+          "a CDN to prefetch the segments. A udp:// URL receives a datagram "
+          "for each segment, and an http:// or https:// URL receives POST "
+          "requests with batches of lines.");
+ABSL_FLAG(std::string,
+          manifest_aggregator_url,
+          "",
+          "If set, this packager is a node of a distributed packager, which "
+          "packages some of the streams of a live channel, and sends its "
+          "manifest notifications to the aggregator at this URL instead of "
+          "writing the manifests. The nodes must use the same "
+          "--segment_duration, --start_segment_number and keys.");
+ABSL_FLAG(std::string,
+          manifest_node_id,
+          "",
+          "Identifies this node to the manifest aggregator, in its logs.");
+ABSL_FLAG(uint32_t,
+          manifest_aggregator_port,
+          0,
+          "If set, run the manifest aggregator of a distributed packager on "
+          "this port instead of packaging: write the manifests set with "
+          "--mpd_output and --hls_master_playlist_output from the manifest "
+          "notifications POSTed by the nodes to '/events'.");
 
 // From absl/log:
 ABSL_DECLARE_FLAG(int, stderrthreshold);
+// From packager/file/file.cc:
+ABSL_DECLARE_FLAG(uint64_t, io_cache_size);
 
 namespace shaka {
 namespace {
@@ -96,6 +325,9 @@ const char kUsage[] =
     "    of the input files or streams. If not specified, it will be\n"
     "    autodetected, which in some cases (such as live UDP webvtt) may\n"
     "    fail.\n"
+    "  - clip_start, clip_end: Optional start and end, in seconds of the\n"
+    "    input timeline, of the clip of the input to package. Each stream\n"
+    "    starts at its last key frame at or before clip_start.\n"
     "  - skip_encryption=0|1: Optional. Defaults to 0 if not specified. If\n"
     "    it is set to 1, no encryption of the stream will be made.\n"
     "  - drm_label: Optional value for custom DRM label, which defines the\n"
@@ -171,6 +403,143 @@ bool GetWidevineSigner(WidevineSigner* signer) {
   return true;
 }
 
+bool GetFileDurability(const std::string& durability,
+                       FileDurability* durability_enum) {
+  if (durability == "none") {
+    *durability_enum = FileDurability::kNone;
+  } else if (durability == "file") {
+    *durability_enum = FileDurability::kSyncFile;
+  } else if (durability == "directory") {
+    *durability_enum = FileDurability::kSyncFileAndDirectory;
+  } else {
+    LOG(ERROR) << "Unrecognized atomic write durability " << durability;
+    return false;
+  }
+  return true;
+}
+
+bool GetHugePageMode(const std::string& mode, HugePageMode* mode_enum) {
+  if (mode == "none") {
+    *mode_enum = HugePageMode::kNone;
+  } else if (mode == "transparent") {
+    *mode_enum = HugePageMode::kTransparent;
+  } else if (mode == "explicit") {
+    *mode_enum = HugePageMode::kExplicit;
+  } else {
+    LOG(ERROR) << "Unrecognized huge page mode " << mode;
+    return false;
+  }
+  return true;
+}
+
+// Returns whether |flag| still has its default value.
+template <typename T>
+bool HasDefaultValue(const absl::Flag<T>& flag) {
+  const absl::CommandLineFlag& handle = absl::GetFlagReflectionHandle(flag);
+  return handle.CurrentValue() == handle.DefaultValue();
+}
+
+// Sizes the executor, the I/O caches and the memory budget for the limits of
+// the container, unless they are set on the command line. |args| are the
+// stream descriptors, after the program name.
+void ApplyContainerLimits(const std::vector<std::string>& args) {
+  // The share of the memory limit kept for the samples and files buffered.
+  const double kMemoryBudgetRatio = 0.75;
+  // The share of the memory limit for the I/O cache of each file. Many files
+  // are open at the same time.
+  const uint64_t kIoCacheDivisor = 256;
+  const uint64_t kMinIoCacheSize = 1ULL << 20;
+
+  // Live inputs never complete, so they cannot wait for a job thread.
+  bool has_live_input = false;
+  for (const std::string& arg : args)
+    has_live_input |= absl::StrContains(arg, "udp://");
+
+  const ContainerLimits limits = ContainerLimits::Get();
+  if (limits.cpus && !has_live_input && HasDefaultValue(FLAGS_job_threads)) {
+    const uint32_t job_threads =
+        std::max(1, static_cast<int>(std::ceil(limits.cpus.value())));
+    absl::SetFlag(&FLAGS_job_threads, job_threads);
+    LOG(INFO) << "CPU quota of " << limits.cpus.value()
+              << " CPUs: --job_threads=" << job_threads;
+  }
+  if (!limits.memory_bytes)
+    return;
+  const uint64_t memory_bytes = limits.memory_bytes.value();
+  if (HasDefaultValue(FLAGS_memory_budget)) {
+    const uint64_t memory_budget =
+        static_cast<uint64_t>(memory_bytes * kMemoryBudgetRatio);
+    absl::SetFlag(&FLAGS_memory_budget, memory_budget);
+    LOG(INFO) << "Memory limit of " << memory_bytes
+              << " bytes: --memory_budget=" << memory_budget;
+  }
+  const uint64_t io_cache_size = absl::GetFlag(FLAGS_io_cache_size);
+  if (io_cache_size > 0 && HasDefaultValue(FLAGS_io_cache_size)) {
+    const uint64_t limited_io_cache_size = std::min(
+        io_cache_size,
+        std::max(kMinIoCacheSize, memory_bytes / kIoCacheDivisor));
+    absl::SetFlag(&FLAGS_io_cache_size, limited_io_cache_size);
+    LOG(INFO) << "Memory limit of " << memory_bytes
+              << " bytes: --io_cache_size=" << limited_io_cache_size;
+  }
+}
+
+bool GetPendingStreamPolicy(const std::string& policy,
+                            PendingStreamPolicy* policy_enum) {
+  if (policy == "fail") {
+    *policy_enum = PendingStreamPolicy::kFail;
+  } else if (policy == "drop") {
+    *policy_enum = PendingStreamPolicy::kDrop;
+  } else {
+    LOG(ERROR) << "Unrecognized pending stream policy " << policy;
+    return false;
+  }
+  return true;
+}
+
+bool GetCpuPlacement(const std::string& placement,
+                     CpuPlacement* placement_enum) {
+  if (placement == "none") {
+    *placement_enum = CpuPlacement::kNone;
+  } else if (placement == "job") {
+    *placement_enum = CpuPlacement::kPerJob;
+  } else if (placement == "numa_node") {
+    *placement_enum = CpuPlacement::kPerNumaNode;
+  } else {
+    LOG(ERROR) << "Unrecognized CPU placement " << placement;
+    return false;
+  }
+  return true;
+}
+
+bool GetPriorityClass(const std::string& priority_class,
+                      PriorityClass* priority_class_enum) {
+  if (priority_class == "live") {
+    *priority_class_enum = PriorityClass::kLive;
+  } else if (priority_class == "background") {
+    *priority_class_enum = PriorityClass::kBackground;
+  } else {
+    LOG(ERROR) << "Unrecognized priority class " << priority_class;
+    return false;
+  }
+  return true;
+}
+
+bool GetMediaInfoFormat(const std::string& format,
+                        MediaInfoFormat* format_enum) {
+  if (format == "text") {
+    *format_enum = MediaInfoFormat::kText;
+  } else if (format == "binary") {
+    *format_enum = MediaInfoFormat::kBinary;
+  } else if (format == "json") {
+    *format_enum = MediaInfoFormat::kJson;
+  } else {
+    LOG(ERROR) << "Unrecognized media info format " << format;
+    return false;
+  }
+  return true;
+}
+
 bool GetHlsPlaylistType(const std::string& playlist_type,
                         HlsPlaylistType* playlist_type_enum) {
   if (absl::AsciiStrToUpper(playlist_type) == "VOD") {
@@ -336,11 +705,122 @@ bool ParseProtectionSystems(const std::string& protection_systems_str,
   return true;
 }
 
+void LogHandlerStats(const Packager& packager) {
+  for (const HandlerStats& stats : packager.GetHandlerStats()) {
+    LOG(INFO) << absl::StrFormat(
+        "%s: %u samples, %u bytes, %.3fs processing, %.3fs blocked",
+        stats.label, stats.samples, stats.bytes, stats.process_seconds,
+        stats.blocked_seconds);
+  }
+  const MemoryStats memory_stats = Packager::GetMemoryStats();
+  LOG(INFO) << absl::StrFormat("Peak RSS: %d bytes",
+                               memory_stats.peak_rss_bytes);
+  for (const SubsystemMemoryStats& stats : memory_stats.subsystems) {
+    LOG(INFO) << absl::StrFormat("Memory of %s: %d bytes, %d bytes peak",
+                                 stats.name, stats.bytes, stats.peak_bytes);
+  }
+  const std::string allocator_stats = GetAllocatorStats();
+  if (!allocator_stats.empty())
+    LOG(INFO) << allocator_stats;
+}
+
+int ProbeInputs(const std::vector<char*>& args) {
+  std::set<std::string> inputs;
+  for (size_t i = 1; i < args.size(); ++i) {
+    std::optional<StreamDescriptor> stream_descriptor =
+        ParseStreamDescriptor(args[i]);
+    if (!stream_descriptor)
+      return kArgumentValidationFailed;
+    if (!inputs.insert(stream_descriptor->input).second)
+      continue;
+    std::string json;
+    Status status = Packager::ProbeInput(
+        stream_descriptor->input, stream_descriptor->input_format, &json);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to probe " << stream_descriptor->input << ": "
+                 << status.ToString();
+      return kPackagingFailed;
+    }
+    std::cout << json << std::endl;
+  }
+  return kSuccess;
+}
+
+void LogProgress(const PackagingProgress& progress) {
+  const std::string fraction =
+      progress.fraction < 0
+          ? std::string("unknown")
+          : absl::StrFormat("%.1f%%", progress.fraction * 100);
+  const std::string eta = progress.eta_seconds < 0
+                              ? std::string("unknown")
+                              : absl::StrFormat("%.0fs", progress.eta_seconds);
+  LOG(INFO) << absl::StrFormat(
+      "Progress: %s, %.1fs of media in %.1fs (%.2fx realtime), %.0f bytes/s "
+      "in, %.0f bytes/s out, ETA %s",
+      fraction, progress.media_seconds, progress.elapsed_seconds,
+      progress.realtime_factor, progress.input_bytes_per_second,
+      progress.output_bytes_per_second, eta);
+}
+
 std::optional<PackagingParams> GetPackagingParams() {
   PackagingParams packaging_params;
 
   packaging_params.temp_dir = absl::GetFlag(FLAGS_temp_dir);
+  packaging_params.webm_one_pass_single_segment =
+      absl::GetFlag(FLAGS_webm_one_pass_single_segment);
   packaging_params.single_threaded = absl::GetFlag(FLAGS_single_threaded);
+  packaging_params.thread_per_output = absl::GetFlag(FLAGS_thread_per_output);
+  packaging_params.job_threads = absl::GetFlag(FLAGS_job_threads);
+  packaging_params.cpu_placement_params.cpus = absl::GetFlag(FLAGS_cpus);
+  if (!GetCpuPlacement(absl::GetFlag(FLAGS_cpu_placement),
+                       &packaging_params.cpu_placement_params.placement)) {
+    return std::nullopt;
+  }
+  if (!GetPriorityClass(absl::GetFlag(FLAGS_priority_class),
+                        &packaging_params.priority_class)) {
+    return std::nullopt;
+  }
+  packaging_params.background_io_bytes_per_second =
+      absl::GetFlag(FLAGS_background_io_rate);
+  packaging_params.mmap_local_inputs = absl::GetFlag(FLAGS_mmap_local_inputs);
+  packaging_params.parsing_threads = absl::GetFlag(FLAGS_parsing_threads);
+  packaging_params.max_pending_stream_bytes =
+      absl::GetFlag(FLAGS_max_pending_stream_bytes);
+  if (!GetPendingStreamPolicy(absl::GetFlag(FLAGS_pending_stream_policy),
+                              &packaging_params.pending_stream_policy)) {
+    return std::nullopt;
+  }
+  packaging_params.multiplex_text_inputs =
+      absl::GetFlag(FLAGS_multiplex_text_inputs);
+  packaging_params.text_heartbeat_interval_ms =
+      absl::GetFlag(FLAGS_text_heartbeat_interval_ms);
+  packaging_params.collect_handler_stats =
+      absl::GetFlag(FLAGS_handler_stats_interval) > 0;
+  if (absl::GetFlag(FLAGS_progress_interval) > 0) {
+    packaging_params.progress_callback = LogProgress;
+    packaging_params.progress_interval_ms =
+        absl::GetFlag(FLAGS_progress_interval) * 1000;
+  }
+  packaging_params.segment_latency_log =
+      absl::GetFlag(FLAGS_segment_latency_log);
+  packaging_params.segment_event_url = absl::GetFlag(FLAGS_segment_event_url);
+  packaging_params.manifest_aggregator_url =
+      absl::GetFlag(FLAGS_manifest_aggregator_url);
+  packaging_params.manifest_node_id = absl::GetFlag(FLAGS_manifest_node_id);
+  packaging_params.output_segment_index =
+      absl::GetFlag(FLAGS_output_segment_index);
+  packaging_params.async_manifest_updates =
+      absl::GetFlag(FLAGS_async_manifest_updates);
+  packaging_params.memory_budget_bytes = absl::GetFlag(FLAGS_memory_budget);
+  if (!GetFileDurability(absl::GetFlag(FLAGS_atomic_write_durability),
+                         &packaging_params.atomic_write_durability)) {
+    return std::nullopt;
+  }
+  if (!GetHugePageMode(absl::GetFlag(FLAGS_huge_pages),
+                       &packaging_params.huge_page_mode)) {
+    return std::nullopt;
+  }
+  packaging_params.crypto_backend = absl::GetFlag(FLAGS_crypto_backend);
 
   AdCueGeneratorParams& ad_cue_generator_params =
       packaging_params.ad_cue_generator_params;
@@ -348,6 +828,8 @@ std::optional<PackagingParams> GetPackagingParams() {
                    &ad_cue_generator_params.cue_points)) {
     return std::nullopt;
   }
+  ad_cue_generator_params.max_buffered_bytes_per_input =
+      absl::GetFlag(FLAGS_ad_cue_max_buffered_bytes);
 
   ChunkingParams& chunking_params = packaging_params.chunking_params;
   chunking_params.segment_duration_in_seconds =
@@ -400,6 +882,10 @@ std::optional<PackagingParams> GetPackagingParams() {
         absl::GetFlag(FLAGS_crypto_period_duration);
     encryption_params.vp9_subsample_encryption =
         absl::GetFlag(FLAGS_vp9_subsample_encryption);
+    encryption_params.sample_encryption_threads =
+        absl::GetFlag(FLAGS_sample_encryption_threads);
+    encryption_params.derive_sample_ivs =
+        absl::GetFlag(FLAGS_derive_sample_ivs);
     encryption_params.stream_label_func = std::bind(
         &Packager::DefaultStreamLabelFunction,
         absl::GetFlag(FLAGS_max_sd_pixels), absl::GetFlag(FLAGS_max_hd_pixels),
@@ -417,6 +903,10 @@ std::optional<PackagingParams> GetPackagingParams() {
       widevine.group_id = absl::GetFlag(FLAGS_group_id).bytes;
       widevine.enable_entitlement_license =
           absl::GetFlag(FLAGS_enable_entitlement_license);
+      widevine.key_cache_ttl_seconds = absl::GetFlag(FLAGS_key_cache_ttl);
+      widevine.key_cache_dir = absl::GetFlag(FLAGS_key_cache_dir);
+      widevine.key_cache_encryption_key =
+          absl::GetFlag(FLAGS_key_cache_encryption_key).bytes;
       if (!GetWidevineSigner(&widevine.signer))
         return std::nullopt;
       break;
@@ -468,6 +958,8 @@ std::optional<PackagingParams> GetPackagingParams() {
     case KeyProvider::kNone:
       break;
   }
+  decryption_params.sample_decryption_threads =
+      absl::GetFlag(FLAGS_sample_decryption_threads);
 
   Mp4OutputParams& mp4_params = packaging_params.mp4_output_params;
   mp4_params.generate_sidx_in_media_segments =
@@ -475,6 +967,20 @@ std::optional<PackagingParams> GetPackagingParams() {
   mp4_params.include_pssh_in_stream =
       absl::GetFlag(FLAGS_mp4_include_pssh_in_stream);
   mp4_params.low_latency_dash_mode = absl::GetFlag(FLAGS_low_latency_dash_mode);
+  mp4_params.preopen_next_segment =
+      absl::GetFlag(FLAGS_mp4_preopen_next_segment);
+  mp4_params.include_emsg_in_segments =
+      absl::GetFlag(FLAGS_mp4_include_emsg);
+  mp4_params.include_prft_in_segments =
+      absl::GetFlag(FLAGS_mp4_include_prft);
+  mp4_params.async_segment_uploads =
+      absl::GetFlag(FLAGS_mp4_async_segment_uploads);
+  mp4_params.max_pending_segment_uploads =
+      absl::GetFlag(FLAGS_mp4_max_pending_segment_uploads);
+  mp4_params.passthrough_fragments =
+      absl::GetFlag(FLAGS_mp4_passthrough_fragments);
+  mp4_params.segment_bundle_duration_in_seconds =
+      absl::GetFlag(FLAGS_mp4_segment_bundle_duration);
 
   packaging_params.transport_stream_timestamp_offset_ms =
       absl::GetFlag(FLAGS_transport_stream_timestamp_offset_ms);
@@ -482,6 +988,10 @@ std::optional<PackagingParams> GetPackagingParams() {
       absl::GetFlag(FLAGS_default_text_zero_bias_ms);
 
   packaging_params.output_media_info = absl::GetFlag(FLAGS_output_media_info);
+  if (!GetMediaInfoFormat(absl::GetFlag(FLAGS_media_info_format),
+                          &packaging_params.media_info_format)) {
+    return std::nullopt;
+  }
 
   MpdParams& mpd_params = packaging_params.mpd_params;
   mpd_params.mpd_output = absl::GetFlag(FLAGS_mpd_output);
@@ -492,6 +1002,7 @@ std::optional<PackagingParams> GetPackagingParams() {
   mpd_params.base_urls = base_urls;
   mpd_params.min_buffer_time = absl::GetFlag(FLAGS_min_buffer_time);
   mpd_params.minimum_update_period = absl::GetFlag(FLAGS_minimum_update_period);
+  mpd_params.min_write_interval = absl::GetFlag(FLAGS_mpd_min_write_interval);
   mpd_params.suggested_presentation_delay =
       absl::GetFlag(FLAGS_suggested_presentation_delay);
   mpd_params.time_shift_buffer_depth =
@@ -524,6 +1035,12 @@ std::optional<PackagingParams> GetPackagingParams() {
   mpd_params.include_mspr_pro =
       absl::GetFlag(FLAGS_include_mspr_pro_for_playready);
   mpd_params.low_latency_dash_mode = absl::GetFlag(FLAGS_low_latency_dash_mode);
+  mpd_params.bandwidth_window_segments =
+      absl::GetFlag(FLAGS_bandwidth_window_segments);
+  mpd_params.write_gzip_mpd = absl::GetFlag(FLAGS_write_gzip_manifests);
+  mpd_params.vod_archive_mpd_output =
+      absl::GetFlag(FLAGS_mpd_vod_archive_output);
+  mpd_params.mpd_patch_output = absl::GetFlag(FLAGS_mpd_patch_output);
 
   HlsParams& hls_params = packaging_params.hls_params;
   if (!GetHlsPlaylistType(absl::GetFlag(FLAGS_hls_playlist_type),
@@ -544,6 +1061,17 @@ std::optional<PackagingParams> GetPackagingParams() {
       absl::GetFlag(FLAGS_hls_media_sequence_number);
   hls_params.start_time_offset = absl::GetFlag(FLAGS_hls_start_time_offset);
   hls_params.create_session_keys = absl::GetFlag(FLAGS_create_session_keys);
+  hls_params.low_latency_hls_mode = absl::GetFlag(FLAGS_low_latency_hls_mode);
+  hls_params.part_target_duration =
+      absl::GetFlag(FLAGS_hls_part_target_duration);
+  hls_params.delta_updates = absl::GetFlag(FLAGS_hls_delta_updates);
+  hls_params.save_playlist_state =
+      absl::GetFlag(FLAGS_hls_save_playlist_state);
+  hls_params.bandwidth_window_segments =
+      absl::GetFlag(FLAGS_bandwidth_window_segments);
+  hls_params.write_gzip_playlists = absl::GetFlag(FLAGS_write_gzip_manifests);
+  hls_params.vod_archive_master_playlist_output =
+      absl::GetFlag(FLAGS_hls_vod_archive_output);
 
   TestParams& test_params = packaging_params.test_params;
   test_params.dump_stream_info = absl::GetFlag(FLAGS_dump_stream_info);
@@ -580,7 +1108,11 @@ int PackagerMain(int argc, char** argv) {
     return kSuccess;
   }
 
-  if (remaining_args.size() < 2) {
+  const uint32_t job_server_port = absl::GetFlag(FLAGS_job_server_port);
+  const uint32_t manifest_aggregator_port =
+      absl::GetFlag(FLAGS_manifest_aggregator_port);
+  if (remaining_args.size() < 2 && job_server_port == 0 &&
+      manifest_aggregator_port == 0) {
     std::cerr << "Usage: " << absl::ProgramUsageMessage();
     return kSuccess;
   }
@@ -591,6 +1123,14 @@ int PackagerMain(int argc, char** argv) {
 
   absl::InitializeLog();
 
+  if (absl::GetFlag(FLAGS_container_limits)) {
+    ApplyContainerLimits(std::vector<std::string>(remaining_args.begin() + 1,
+                                                  remaining_args.end()));
+  }
+
+  if (absl::GetFlag(FLAGS_probe))
+    return ProbeInputs(remaining_args);
+
   if (!ValidateWidevineCryptoFlags() || !ValidateRawKeyCryptoFlags() ||
       !ValidatePRCryptoFlags() || !ValidateCryptoFlags() ||
       !ValidateRetiredFlags()) {
@@ -617,6 +1157,49 @@ int PackagerMain(int argc, char** argv) {
     }
   }
 
+  // Started first so that key requests made while initializing are exported.
+  const uint32_t metrics_port = absl::GetFlag(FLAGS_metrics_port);
+  std::unique_ptr<MetricsServer> metrics_server;
+  if (metrics_port > 0) {
+    if (metrics_port > 65535) {
+      LOG(ERROR) << "--metrics_port must be a valid TCP port.";
+      return kArgumentValidationFailed;
+    }
+    RegisterAllocatorMetrics();
+    metrics_server.reset(new MetricsServer);
+    if (!metrics_server->Start(static_cast<uint16_t>(metrics_port)))
+      return kArgumentValidationFailed;
+  }
+
+  if (job_server_port > 0) {
+    if (job_server_port > 65535 || !stream_descriptors.empty() ||
+        absl::GetFlag(FLAGS_job_server_workers) == 0) {
+      LOG(ERROR) << "--job_server_port must be a valid TCP port, without "
+                    "stream descriptors, and with positive "
+                    "--job_server_workers.";
+      return kArgumentValidationFailed;
+    }
+    JobServer job_server(packaging_params.value(),
+                         absl::GetFlag(FLAGS_job_server_workers));
+    if (!job_server.Serve(absl::GetFlag(FLAGS_job_server_address),
+                          static_cast<uint16_t>(job_server_port))) {
+      return kArgumentValidationFailed;
+    }
+    return kSuccess;
+  }
+
+  if (manifest_aggregator_port > 0) {
+    if (manifest_aggregator_port > 65535 || !stream_descriptors.empty()) {
+      LOG(ERROR) << "--manifest_aggregator_port must be a valid TCP port, "
+                    "without stream descriptors.";
+      return kArgumentValidationFailed;
+    }
+    ManifestAggregator aggregator(packaging_params.value());
+    if (!aggregator.Serve(static_cast<uint16_t>(manifest_aggregator_port)))
+      return kArgumentValidationFailed;
+    return kSuccess;
+  }
+
   Packager packager;
   Status status =
       packager.Initialize(packaging_params.value(), stream_descriptors);
@@ -624,7 +1207,34 @@ int PackagerMain(int argc, char** argv) {
     LOG(ERROR) << "Failed to initialize packager: " << status.ToString();
     return kArgumentValidationFailed;
   }
+
+  // Log the handler statistics periodically while packaging.
+  const uint32_t stats_interval = absl::GetFlag(FLAGS_handler_stats_interval);
+  absl::Notification packaging_done;
+  std::thread stats_logger;
+  if (stats_interval > 0) {
+    stats_logger = std::thread([&packager, &packaging_done, stats_interval]() {
+      while (!packaging_done.WaitForNotificationWithTimeout(
+          absl::Seconds(stats_interval))) {
+        LogHandlerStats(packager);
+      }
+    });
+  }
+
+  const std::string trace_output = absl::GetFlag(FLAGS_trace_output);
+  if (!trace_output.empty())
+    Tracing::Start();
+
   status = packager.Run();
+  if (stats_logger.joinable()) {
+    packaging_done.Notify();
+    stats_logger.join();
+    LogHandlerStats(packager);
+  }
+  if (!trace_output.empty() &&
+      !File::WriteStringToFile(trace_output.c_str(), Tracing::Stop())) {
+    LOG(ERROR) << "Failed to write the trace to " << trace_output;
+  }
   if (!status.ok()) {
     LOG(ERROR) << "Packaging Error: " << status.ToString();
     return kPackagingFailed;
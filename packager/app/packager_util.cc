@@ -6,9 +6,21 @@
 
 #include <packager/app/packager_util.h>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <tuple>
+
+#include <absl/base/const_init.h>
 #include <absl/log/log.h>
+#include <absl/synchronization/blocking_counter.h>
+#include <absl/synchronization/mutex.h>
 
 #include <packager/file.h>
+#include <packager/file/thread_pool.h>
+#include <packager/media/base/async_key_source.h>
+#include <packager/media/base/key_cache.h>
 #include <packager/media/base/media_handler.h>
 #include <packager/media/base/muxer_options.h>
 #include <packager/media/base/playready_key_source.h>
@@ -40,11 +52,48 @@ std::unique_ptr<RequestSigner> CreateSigner(const WidevineSigner& signer) {
   return request_signer;
 }
 
+// Returns the key cache shared by all the key sources of the process with the
+// same cache settings.
+std::shared_ptr<KeyCache> GetSharedKeyCache(
+    const WidevineEncryptionParams& widevine) {
+  using CacheSettings = std::tuple<int64_t, std::string, std::vector<uint8_t>>;
+  ABSL_CONST_INIT static absl::Mutex mutex(absl::kConstInit);
+  static auto* caches = new std::map<CacheSettings, std::shared_ptr<KeyCache>>;
+
+  absl::MutexLock lock(&mutex);
+  std::shared_ptr<KeyCache>& cache = (*caches)[CacheSettings(
+      widevine.key_cache_ttl_seconds, widevine.key_cache_dir,
+      widevine.key_cache_encryption_key)];
+  if (!cache) {
+    cache.reset(new KeyCache(
+        std::chrono::seconds(widevine.key_cache_ttl_seconds),
+        widevine.key_cache_dir, widevine.key_cache_encryption_key));
+  }
+  return cache;
+}
+
+// Fetches the initial keys of |key_source| with |fetch_keys|, in the
+// background if |fetch_keys_async| is true.
+// @return the key source, or nullptr if the keys are fetched synchronously and
+//         the fetch fails.
+std::unique_ptr<KeySource> FetchKeys(std::unique_ptr<KeySource> key_source,
+                                     std::function<Status()> fetch_keys,
+                                     bool fetch_keys_async) {
+  if (fetch_keys_async) {
+    return std::unique_ptr<KeySource>(
+        new AsyncKeySource(std::move(key_source), std::move(fetch_keys)));
+  }
+  if (!fetch_keys().ok())
+    return nullptr;
+  return key_source;
+}
+
 }  // namespace
 
 std::unique_ptr<KeySource> CreateEncryptionKeySource(
     FourCC protection_scheme,
-    const EncryptionParams& encryption_params) {
+    const EncryptionParams& encryption_params,
+    bool fetch_keys_async) {
   std::unique_ptr<KeySource> encryption_key_source;
   switch (encryption_params.key_provider) {
     case KeyProvider::kWidevine: {
@@ -71,15 +120,30 @@ std::unique_ptr<KeySource> CreateEncryptionKeySource(
       widevine_key_source->set_group_id(widevine.group_id);
       widevine_key_source->set_enable_entitlement_license(
           widevine.enable_entitlement_license);
-
-      Status status =
-          widevine_key_source->FetchKeys(widevine.content_id, widevine.policy);
-      if (!status.ok()) {
-        LOG(ERROR) << "Widevine encryption key source failed to fetch keys: "
-                   << status.ToString();
-        return nullptr;
+      if (widevine.key_cache_ttl_seconds > 0) {
+        if (!widevine.key_cache_dir.empty() &&
+            widevine.key_cache_encryption_key.size() != 16) {
+          LOG(ERROR) << "'key_cache_encryption_key' should be 16 bytes.";
+          return nullptr;
+        }
+        widevine_key_source->set_key_cache(GetSharedKeyCache(widevine));
       }
-      encryption_key_source = std::move(widevine_key_source);
+
+      WidevineKeySource* source = widevine_key_source.get();
+      const std::vector<uint8_t> content_id = widevine.content_id;
+      const std::string policy = widevine.policy;
+      encryption_key_source = FetchKeys(
+          std::move(widevine_key_source),
+          [source, content_id, policy]() {
+            Status status = source->FetchKeys(content_id, policy);
+            if (!status.ok()) {
+              LOG(ERROR)
+                  << "Widevine encryption key source failed to fetch keys: "
+                  << status.ToString();
+            }
+            return status;
+          },
+          fetch_keys_async);
       break;
     }
     case KeyProvider::kRawKey: {
@@ -100,14 +164,21 @@ std::unique_ptr<KeySource> CreateEncryptionKeySource(
         // private_key_password is allowed to be empty for unencrypted key.
         playready_key_source.reset(new PlayReadyKeySource(
             playready.key_server_url, encryption_params.protection_systems));
-        Status status = playready_key_source->FetchKeysWithProgramIdentifier(
-            playready.program_identifier);
-        if (!status.ok()) {
-          LOG(ERROR) << "PlayReady encryption key source failed to fetch keys: "
-                     << status.ToString();
-          return nullptr;
-        }
-        encryption_key_source = std::move(playready_key_source);
+        PlayReadyKeySource* source = playready_key_source.get();
+        const std::string program_identifier = playready.program_identifier;
+        encryption_key_source = FetchKeys(
+            std::move(playready_key_source),
+            [source, program_identifier]() {
+              Status status =
+                  source->FetchKeysWithProgramIdentifier(program_identifier);
+              if (!status.ok()) {
+                LOG(ERROR)
+                    << "PlayReady encryption key source failed to fetch keys: "
+                    << status.ToString();
+              }
+              return status;
+            },
+            fetch_keys_async);
       } else {
         LOG(ERROR) << "Error creating PlayReady key source.";
         return nullptr;
@@ -120,6 +191,56 @@ std::unique_ptr<KeySource> CreateEncryptionKeySource(
   return encryption_key_source;
 }
 
+Status PrefetchEncryptionKeys(
+    FourCC protection_scheme,
+    const EncryptionParams& encryption_params,
+    const std::vector<std::vector<uint8_t>>& content_ids,
+    uint32_t max_concurrent_requests) {
+  if (encryption_params.key_provider != KeyProvider::kWidevine ||
+      encryption_params.widevine.key_cache_ttl_seconds <= 0) {
+    return Status(error::INVALID_ARGUMENT,
+                  "Prefetching keys requires Widevine encryption with a key "
+                  "cache.");
+  }
+  if (max_concurrent_requests == 0) {
+    return Status(error::INVALID_ARGUMENT,
+                  "'max_concurrent_requests' should be positive.");
+  }
+
+  // Each worker fetches the keys of the next content until there are none
+  // left. The connections to the key server are reused across requests.
+  std::atomic<size_t> next_content{0};
+  std::atomic<size_t> num_failures{0};
+  auto fetch_keys = [&]() {
+    for (size_t i = next_content++; i < content_ids.size();
+         i = next_content++) {
+      EncryptionParams params = encryption_params;
+      params.widevine.content_id = content_ids[i];
+      if (!CreateEncryptionKeySource(protection_scheme, params,
+                                     false /* fetch_keys_async */))
+        ++num_failures;
+    }
+  };
+  const size_t num_workers = std::min<size_t>(
+      max_concurrent_requests, std::max<size_t>(content_ids.size(), 1));
+  absl::BlockingCounter workers_done(static_cast<int>(num_workers));
+  for (size_t i = 0; i < num_workers; ++i) {
+    ThreadPool::instance.PostTask([&fetch_keys, &workers_done]() {
+      fetch_keys();
+      workers_done.DecrementCount();
+    });
+  }
+  workers_done.Wait();
+
+  if (num_failures > 0) {
+    return Status(error::SERVER_ERROR,
+                  "Failed to fetch the keys of " +
+                      std::to_string(num_failures) + " of " +
+                      std::to_string(content_ids.size()) + " contents.");
+  }
+  return Status::OK;
+}
+
 std::unique_ptr<KeySource> CreateDecryptionKeySource(
     const DecryptionParams& decryption_params) {
   std::unique_ptr<KeySource> decryption_key_source;
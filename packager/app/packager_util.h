@@ -9,6 +9,7 @@
 #ifndef PACKAGER_APP_PACKAGER_UTIL_H_
 #define PACKAGER_APP_PACKAGER_UTIL_H_
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -31,11 +32,32 @@ class KeySource;
 /// fetches keys.
 /// @param protection_scheme specifies the protection scheme to be used for
 ///        encryption.
+/// @param fetch_keys_async specifies whether the keys of the Widevine and
+///        PlayReady key sources are fetched in the background. The key source
+///        calls then wait for the fetch, and return its error if it fails.
 /// @return A std::unique_ptr containing a new KeySource, or nullptr if
 ///         encryption is not required.
 std::unique_ptr<KeySource> CreateEncryptionKeySource(
     FourCC protection_scheme,
-    const EncryptionParams& encryption_params);
+    const EncryptionParams& encryption_params,
+    bool fetch_keys_async);
+
+/// Fetch the encryption keys of many contents concurrently into the shared key
+/// cache, so that the key sources later created for these contents by
+/// CreateEncryptionKeySource() do not need to contact the key server.
+/// @param protection_scheme specifies the protection scheme to be used for
+///        encryption.
+/// @param encryption_params contains the Widevine encryption parameters, with
+///        a positive key cache time to live. The content ID is ignored.
+/// @param content_ids contains the IDs of the contents.
+/// @param max_concurrent_requests is the maximum number of requests to the key
+///        server in flight at a time.
+/// @return OK if the keys of all the contents were fetched.
+Status PrefetchEncryptionKeys(
+    FourCC protection_scheme,
+    const EncryptionParams& encryption_params,
+    const std::vector<std::vector<uint8_t>>& content_ids,
+    uint32_t max_concurrent_requests);
 
 /// Create KeySource based on provided params for content decryption. Does not
 /// fetch keys.
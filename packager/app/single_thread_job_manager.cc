@@ -17,11 +17,13 @@ SingleThreadJobManager::SingleThreadJobManager(
     : JobManager(std::move(sync_points)) {}
 
 Status SingleThreadJobManager::RunJobs() {
+  SetRunning(true);
   Status status;
 
   for (auto& job : jobs_)
     status.Update(job->Run());
 
+  SetRunning(false);
   return status;
 }
 
@@ -0,0 +1,383 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// Runs live packaging of a looping input for hours or days of simulated time,
+// faster than real time, and reports every simulated hour how the memory, the
+// segment latency and the manifest updates evolve, so that leaks and
+// regressions which only show after a long time are seen up front.
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif  // defined(__linux__)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/flags/usage.h>
+#include <absl/log/initialize.h>
+#include <absl/log/log.h>
+#include <absl/strings/match.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_format.h>
+#include <absl/strings/str_split.h>
+#include <nlohmann/json.hpp>
+
+#include <packager/app/looping_ts_source.h>
+#include <packager/file.h>
+#include <packager/packager.h>
+#include <packager/utils/metrics.h>
+
+ABSL_FLAG(std::string,
+          input,
+          "",
+          "The MPEG-2 transport stream to loop, e.g. "
+          "packager/media/test/data/bear-640x360.ts. Required.");
+ABSL_FLAG(std::string,
+          stream_selectors,
+          "video,audio",
+          "The streams of the input to package.");
+ABSL_FLAG(std::string,
+          output_dir,
+          "",
+          "The directory of the segments, the manifests and the segment "
+          "latency log. Required.");
+ABSL_FLAG(double,
+          speed,
+          100,
+          "How many times faster than real time the input is pushed. The "
+          "harness falls behind if the packager is slower.");
+ABSL_FLAG(double, duration_hours, 24, "The simulated duration of the run.");
+ABSL_FLAG(double,
+          report_interval_minutes,
+          60,
+          "The simulated time between two reports.");
+ABSL_FLAG(double, segment_duration, 2, "The segment duration, in seconds.");
+ABSL_FLAG(double,
+          time_shift_buffer_depth,
+          60,
+          "The live window of the manifests, in seconds. The segments out of "
+          "it are deleted.");
+
+// From absl/log:
+ABSL_DECLARE_FLAG(int, stderrthreshold);
+
+namespace shaka {
+namespace {
+
+const char kUsage[] =
+    "Live soak test driver program.\n"
+    "This program packages a transport stream played in a loop as a live "
+    "DASH and HLS stream, in simulated time driven by the input, and reports "
+    "the resident memory, the segment latencies and the manifest update "
+    "times at each interval.\n"
+    "Sample Usage:\n"
+    "%s --input=bear-640x360.ts --output_dir=/tmp/soak --speed=100 "
+    "--duration_hours=72";
+
+const char kPushedInput[] = "push://soak";
+// About 48 KiB of input per push.
+const size_t kPacketsPerPush = 256;
+// The segments kept out of the live window, after which they are deleted so
+// that the run does not fill the disk.
+const size_t kPreservedSegmentsOutsideLiveWindow = 5;
+
+enum ExitStatus {
+  kSuccess = 0,
+  kArgumentError,
+  kInputError,
+  kPackagingError,
+};
+
+// The simulated time, in microseconds since the epoch. It is set from the
+// input as it is pushed, and read by the packaging threads.
+std::atomic<int64_t> g_simulated_time_us{0};
+
+std::chrono::system_clock::time_point SimulatedNow() {
+  return std::chrono::system_clock::time_point(
+      std::chrono::microseconds(g_simulated_time_us.load()));
+}
+
+// @return The resident set size of the process, or its peak if the current
+//         size is not available.
+int64_t GetResidentSetSize() {
+#if defined(__linux__)
+  std::ifstream statm("/proc/self/statm");
+  int64_t size_pages = 0;
+  int64_t resident_pages = 0;
+  if (statm >> size_pages >> resident_pages)
+    return resident_pages * sysconf(_SC_PAGESIZE);
+#endif  // defined(__linux__)
+  return Packager::GetMemoryStats().peak_rss_bytes;
+}
+
+// @return The value of the metric |name| in |metrics|, in the Prometheus text
+//         format, or 0 if it is not there.
+double GetMetric(const std::string& metrics, const std::string& name) {
+  const std::vector<std::string> lines = absl::StrSplit(metrics, '\n');
+  for (const std::string& line : lines) {
+    double value = 0;
+    if (absl::StartsWith(line, name + " ") &&
+        absl::SimpleAtod(line.substr(name.size() + 1), &value)) {
+      return value;
+    }
+  }
+  return 0;
+}
+
+// Reports the measurements of each interval.
+class SoakReporter {
+ public:
+  explicit SoakReporter(const std::string& latency_log)
+      : latency_log_(latency_log),
+        start_time_(std::chrono::steady_clock::now()),
+        previous_rss_(GetResidentSetSize()) {}
+
+  // @param media_time is the simulated time reached, in
+  //        LoopingTsSource::kTimescale units.
+  void Report(int64_t media_time) {
+    const int64_t rss = GetResidentSetSize();
+    const double real_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                      start_time_)
+            .count();
+
+    std::vector<int64_t> latencies = ReadSegmentLatencies();
+    std::sort(latencies.begin(), latencies.end());
+
+    const std::string metrics =
+        MetricsRegistry::GetInstance()->ToPrometheusText();
+    const double manifest_updates =
+        GetMetric(metrics, "shaka_mpd_flush_seconds_count") +
+        GetMetric(metrics, "shaka_hls_flush_seconds_count");
+    const double manifest_seconds =
+        GetMetric(metrics, "shaka_mpd_flush_seconds_sum") +
+        GetMetric(metrics, "shaka_hls_flush_seconds_sum");
+    const double interval_updates = manifest_updates - manifest_updates_;
+    const double interval_seconds = manifest_seconds - manifest_seconds_;
+
+    const int64_t simulated_seconds =
+        media_time / LoopingTsSource::kTimescale;
+    std::cout << absl::StrFormat(
+                     "%d:%02d:%02d simulated, %.1fs real: rss %.1f MiB "
+                     "(%+.1f MiB), %d segments, latency p50 %d ms p90 %d ms "
+                     "p99 %d ms max %d ms, %.0f manifest updates, %.3f ms "
+                     "each",
+                     simulated_seconds / 3600, simulated_seconds / 60 % 60,
+                     simulated_seconds % 60, real_seconds, rss / 1048576.0,
+                     (rss - previous_rss_) / 1048576.0, latencies.size(),
+                     Percentile(latencies, 50), Percentile(latencies, 90),
+                     Percentile(latencies, 99), Percentile(latencies, 100),
+                     interval_updates,
+                     interval_updates > 0
+                         ? interval_seconds * 1000 / interval_updates
+                         : 0.0)
+              << std::endl;
+
+    previous_rss_ = rss;
+    manifest_updates_ = manifest_updates;
+    manifest_seconds_ = manifest_seconds;
+  }
+
+ private:
+  static int64_t Percentile(const std::vector<int64_t>& sorted_values,
+                            int percentile) {
+    if (sorted_values.empty())
+      return 0;
+    const size_t index = std::min(
+        sorted_values.size() - 1, sorted_values.size() * percentile / 100);
+    return sorted_values[index];
+  }
+
+  // @return The latencies, from the first sample to the manifest update, of
+  //         the segments logged since the previous call, in milliseconds.
+  std::vector<int64_t> ReadSegmentLatencies() {
+    std::vector<int64_t> latencies;
+    std::ifstream log(latency_log_, std::ios::binary);
+    if (!log)
+      return latencies;
+    log.seekg(latency_log_offset_);
+    std::stringstream contents;
+    contents << log.rdbuf();
+    const std::string data = partial_line_ + contents.str();
+    latency_log_offset_ += data.size() - partial_line_.size();
+
+    // The last line may not be complete yet.
+    const size_t end = data.rfind('\n');
+    partial_line_ =
+        end == std::string::npos ? data : data.substr(end + 1);
+    if (end == std::string::npos)
+      return latencies;
+    const std::vector<std::string> lines =
+        absl::StrSplit(data.substr(0, end), '\n');
+    for (const std::string& line : lines) {
+      const nlohmann::json json = nlohmann::json::parse(line, nullptr, false);
+      if (json.is_discarded() || !json.contains("first_sample_ms") ||
+          !json.contains("published_ms")) {
+        continue;
+      }
+      latencies.push_back(json["published_ms"].get<int64_t>() -
+                          json["first_sample_ms"].get<int64_t>());
+    }
+    return latencies;
+  }
+
+  const std::string latency_log_;
+  const std::chrono::steady_clock::time_point start_time_;
+  int64_t previous_rss_ = 0;
+  std::streamoff latency_log_offset_ = 0;
+  std::string partial_line_;
+  double manifest_updates_ = 0;
+  double manifest_seconds_ = 0;
+};
+
+ExitStatus RunSoak() {
+  std::string input_data;
+  LoopingTsSource source;
+  if (!File::ReadFileToString(absl::GetFlag(FLAGS_input).c_str(),
+                              &input_data) ||
+      !source.Initialize(
+          std::vector<uint8_t>(input_data.begin(), input_data.end()))) {
+    LOG(ERROR) << "Cannot loop " << absl::GetFlag(FLAGS_input);
+    return kInputError;
+  }
+
+  const std::filesystem::path output_dir(absl::GetFlag(FLAGS_output_dir));
+  std::error_code error;
+  std::filesystem::create_directories(output_dir, error);
+  if (error) {
+    LOG(ERROR) << "Cannot create " << output_dir << ": " << error.message();
+    return kArgumentError;
+  }
+
+  PackagingParams packaging_params;
+  packaging_params.chunking_params.segment_duration_in_seconds =
+      absl::GetFlag(FLAGS_segment_duration);
+  packaging_params.mpd_params.mpd_output = (output_dir / "soak.mpd").string();
+  packaging_params.mpd_params.time_shift_buffer_depth =
+      absl::GetFlag(FLAGS_time_shift_buffer_depth);
+  packaging_params.mpd_params.preserved_segments_outside_live_window =
+      kPreservedSegmentsOutsideLiveWindow;
+  packaging_params.hls_params.master_playlist_output =
+      (output_dir / "soak.m3u8").string();
+  packaging_params.hls_params.playlist_type = HlsPlaylistType::kLive;
+  packaging_params.hls_params.time_shift_buffer_depth =
+      absl::GetFlag(FLAGS_time_shift_buffer_depth);
+  packaging_params.hls_params.preserved_segments_outside_live_window =
+      kPreservedSegmentsOutsideLiveWindow;
+  packaging_params.segment_latency_log =
+      (output_dir / "segment_latency.log").string();
+  packaging_params.test_params.clock = SimulatedNow;
+
+  std::vector<StreamDescriptor> stream_descriptors;
+  const std::vector<std::string> stream_selectors =
+      absl::StrSplit(absl::GetFlag(FLAGS_stream_selectors), ',');
+  for (const std::string& stream_selector : stream_selectors) {
+    StreamDescriptor stream_descriptor;
+    stream_descriptor.input = kPushedInput;
+    stream_descriptor.stream_selector = stream_selector;
+    stream_descriptor.output =
+        (output_dir / (stream_selector + "_init.mp4")).string();
+    stream_descriptor.segment_template =
+        (output_dir / (stream_selector + "_$Number$.m4s")).string();
+    stream_descriptor.hls_name = stream_selector;
+    stream_descriptor.hls_playlist_name = stream_selector + ".m3u8";
+    stream_descriptors.push_back(stream_descriptor);
+  }
+
+  // The simulated time starts now, so that the manifests look live.
+  const int64_t simulated_start_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  g_simulated_time_us.store(simulated_start_us);
+
+  Packager packager;
+  Status status = packager.Initialize(packaging_params, stream_descriptors);
+  if (status.ok())
+    status = packager.Start(nullptr);
+  if (!status.ok()) {
+    LOG(ERROR) << "Packaging failed: " << status.ToString();
+    return kPackagingError;
+  }
+
+  SoakReporter reporter(packaging_params.segment_latency_log);
+  const double speed = absl::GetFlag(FLAGS_speed);
+  const int64_t duration = static_cast<int64_t>(
+      absl::GetFlag(FLAGS_duration_hours) * 3600 * LoopingTsSource::kTimescale);
+  const int64_t report_interval = std::max<int64_t>(
+      1, static_cast<int64_t>(absl::GetFlag(FLAGS_report_interval_minutes) *
+                              60 * LoopingTsSource::kTimescale));
+  const auto real_start = std::chrono::steady_clock::now();
+  int64_t next_report = report_interval;
+  int64_t media_time = 0;
+  std::vector<uint8_t> packets;
+  while (media_time < duration) {
+    media_time = source.Read(kPacketsPerPush, &packets);
+    g_simulated_time_us.store(simulated_start_us +
+                              media_time * 1000000 /
+                                  LoopingTsSource::kTimescale);
+    // Fails if the pipeline has failed.
+    if (!packager.PushInput(kPushedInput, std::move(packets)).ok())
+      break;
+
+    std::this_thread::sleep_until(
+        real_start + std::chrono::duration_cast<
+                         std::chrono::steady_clock::duration>(
+                         std::chrono::duration<double>(
+                             static_cast<double>(media_time) /
+                             LoopingTsSource::kTimescale / speed)));
+    if (media_time >= next_report) {
+      reporter.Report(media_time);
+      next_report += report_interval;
+    }
+  }
+
+  packager.EndInput(kPushedInput);
+  status = packager.Wait();
+  reporter.Report(media_time);
+  if (!status.ok()) {
+    LOG(ERROR) << "Packaging failed: " << status.ToString();
+    return kPackagingError;
+  }
+  return kSuccess;
+}
+
+int SoakMain(int argc, char** argv) {
+  absl::SetProgramUsageMessage(absl::StrFormat(kUsage, argv[0]));
+
+  // Always log to stderr.  Log levels are still controlled by --minloglevel.
+  absl::SetFlag(&FLAGS_stderrthreshold, 0);
+
+  absl::ParseCommandLine(argc, argv);
+
+  if (absl::GetFlag(FLAGS_input).empty() ||
+      absl::GetFlag(FLAGS_output_dir).empty() ||
+      absl::GetFlag(FLAGS_speed) <= 0) {
+    std::cerr << "Usage " << absl::ProgramUsageMessage();
+    return kArgumentError;
+  }
+
+  absl::InitializeLog();
+
+  return RunSoak();
+}
+
+}  // namespace
+}  // namespace shaka
+
+int main(int argc, char** argv) {
+  return shaka::SoakMain(argc, argv);
+}
@@ -42,6 +42,8 @@ enum FieldType {
   kDashLabelField,
   kForcedSubtitleField,
   kInputFormatField,
+  kClipStartField,
+  kClipEndField,
 };
 
 struct FieldNameToTypeMapping {
@@ -92,6 +94,8 @@ const FieldNameToTypeMapping kFieldNameTypeMappings[] = {
     {"dash_label", kDashLabelField},
     {"forced_subtitle", kForcedSubtitleField},
     {"input_format", kInputFormatField},
+    {"clip_start", kClipStartField},
+    {"clip_end", kClipEndField},
 };
 
 FieldType GetFieldType(const std::string& field_name) {
@@ -102,6 +106,17 @@ FieldType GetFieldType(const std::string& field_name) {
   return kUnknownField;
 }
 
+bool ParseSeconds(const KVPair& pair, std::optional<double>* seconds) {
+  double value;
+  if (!absl::SimpleAtod(pair.second, &value) || value < 0) {
+    LOG(ERROR) << "Invalid " << pair.first << " " << pair.second
+               << " specified; should be a non-negative number of seconds.";
+    return false;
+  }
+  *seconds = value;
+  return true;
+}
+
 }  // anonymous namespace
 
 std::optional<StreamDescriptor> ParseStreamDescriptor(
@@ -277,6 +292,14 @@ std::optional<StreamDescriptor> ParseStreamDescriptor(
         descriptor.input_format = pair.second;
         break;
       }
+      case kClipStartField:
+        if (!ParseSeconds(pair, &descriptor.clip_start_in_seconds))
+          return std::nullopt;
+        break;
+      case kClipEndField:
+        if (!ParseSeconds(pair, &descriptor.clip_end_in_seconds))
+          return std::nullopt;
+        break;
       default:
         LOG(ERROR) << "Unknown field in stream descriptor (\"" << pair.first
                    << "\").";
@@ -82,6 +82,23 @@ ABSL_FLAG(bool,
           enable_entitlement_license,
           false,
           "Enable entitlement license when using Widevine key server.");
+ABSL_FLAG(int64_t,
+          key_cache_ttl,
+          0,
+          "Time to live, in seconds, of cached Widevine key server responses. "
+          "If it is positive, the responses are cached and reused by other "
+          "streams and jobs requesting the same keys.");
+ABSL_FLAG(std::string,
+          key_cache_dir,
+          "",
+          "Directory where cached Widevine key server responses are stored, "
+          "so that they are reused across runs. --key_cache_encryption_key "
+          "is required.");
+ABSL_FLAG(shaka::HexBytes,
+          key_cache_encryption_key,
+          {},
+          "16-byte AES key in hex string used to encrypt the responses "
+          "stored in --key_cache_dir.");
 
 namespace shaka {
 namespace {
@@ -181,6 +198,24 @@ bool ValidateWidevineCryptoFlags() {
     PrintError("--crypto_period_duration should not be negative.");
     success = false;
   }
+
+  if (absl::GetFlag(FLAGS_key_cache_ttl) < 0) {
+    PrintError("--key_cache_ttl should not be negative.");
+    success = false;
+  }
+  const char key_cache_label[] = "--key_cache_ttl";
+  if (!ValidateFlag("key_cache_dir", absl::GetFlag(FLAGS_key_cache_dir),
+                    absl::GetFlag(FLAGS_key_cache_ttl) > 0, kOptional,
+                    key_cache_label)) {
+    success = false;
+  }
+  if (!absl::GetFlag(FLAGS_key_cache_dir).empty() &&
+      absl::GetFlag(FLAGS_key_cache_encryption_key).bytes.size() != 16) {
+    PrintError(
+        "--key_cache_encryption_key of 16 bytes is required with "
+        "--key_cache_dir.");
+    success = false;
+  }
   return success;
 }
 
@@ -29,6 +29,9 @@ ABSL_DECLARE_FLAG(std::string, rsa_signing_key_path);
 ABSL_DECLARE_FLAG(int32_t, crypto_period_duration);
 ABSL_DECLARE_FLAG(shaka::HexBytes, group_id);
 ABSL_DECLARE_FLAG(bool, enable_entitlement_license);
+ABSL_DECLARE_FLAG(int64_t, key_cache_ttl);
+ABSL_DECLARE_FLAG(std::string, key_cache_dir);
+ABSL_DECLARE_FLAG(shaka::HexBytes, key_cache_encryption_key);
 
 namespace shaka {
 
@@ -0,0 +1,130 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/benchmark/allocation_counter.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace shaka {
+namespace benchmark {
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_allocated_bytes{0};
+
+void* Allocate(size_t size, size_t alignment) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  // malloc does not return nullptr for zero bytes everywhere, but new must
+  // return a unique pointer.
+  if (size == 0)
+    size = 1;
+  if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    return malloc(size);
+#if defined(OS_WIN)
+  return _aligned_malloc(size, alignment);
+#else
+  // aligned_alloc requires a multiple of the alignment.
+  return aligned_alloc(alignment, (size + alignment - 1) / alignment *
+                                      alignment);
+#endif  // defined(OS_WIN)
+}
+
+void Free(void* ptr, [[maybe_unused]] size_t alignment) {
+#if defined(OS_WIN)
+  if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    _aligned_free(ptr);
+    return;
+  }
+#endif  // defined(OS_WIN)
+  free(ptr);
+}
+
+void* AllocateOrThrow(size_t size, size_t alignment) {
+  void* ptr = Allocate(size, alignment);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+}  // namespace
+
+uint64_t AllocationCounter::allocations() {
+  return g_allocations.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocationCounter::allocated_bytes() {
+  return g_allocated_bytes.load(std::memory_order_relaxed);
+}
+
+}  // namespace benchmark
+}  // namespace shaka
+
+using shaka::benchmark::AllocateOrThrow;
+using shaka::benchmark::Allocate;
+using shaka::benchmark::Free;
+
+namespace {
+const size_t kDefaultAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+}  // namespace
+
+void* operator new(size_t size) {
+  return AllocateOrThrow(size, kDefaultAlignment);
+}
+
+void* operator new[](size_t size) {
+  return AllocateOrThrow(size, kDefaultAlignment);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size, kDefaultAlignment);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size, kDefaultAlignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+  return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept {
+  Free(ptr, kDefaultAlignment);
+}
+
+void operator delete[](void* ptr) noexcept {
+  Free(ptr, kDefaultAlignment);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  Free(ptr, kDefaultAlignment);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  Free(ptr, kDefaultAlignment);
+}
+
+void operator delete(void* ptr, std::align_val_t alignment) noexcept {
+  Free(ptr, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept {
+  Free(ptr, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t alignment) noexcept {
+  Free(ptr, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t alignment) noexcept {
+  Free(ptr, static_cast<size_t>(alignment));
+}
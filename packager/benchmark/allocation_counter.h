@@ -0,0 +1,30 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_BENCHMARK_ALLOCATION_COUNTER_H_
+#define PACKAGER_BENCHMARK_ALLOCATION_COUNTER_H_
+
+#include <cstdint>
+
+namespace shaka {
+namespace benchmark {
+
+/// Counts the heap allocations made with the global operator new, which
+/// allocation_counter.cc replaces in the binaries it is linked into. The
+/// allocations made with malloc directly, e.g. by C libraries, are not
+/// counted.
+class AllocationCounter {
+ public:
+  /// @return the number of allocations made by all the threads so far.
+  static uint64_t allocations();
+  /// @return the number of bytes requested by these allocations.
+  static uint64_t allocated_bytes();
+};
+
+}  // namespace benchmark
+}  // namespace shaka
+
+#endif  // PACKAGER_BENCHMARK_ALLOCATION_COUNTER_H_
@@ -0,0 +1,162 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#include <absl/log/check.h>
+#include <absl/strings/match.h>
+#include <absl/strings/str_format.h>
+
+#include <packager/benchmark/allocation_counter.h>
+
+namespace shaka {
+namespace benchmark {
+namespace {
+
+// Upper bounds of the number of iterations of a run, and of how much it can
+// grow from one run to the next.
+const uint64_t kMaxIterations = 1000000000;
+const double kMaxIterationsGrowth = 100;
+
+struct Benchmark {
+  std::string name;
+  BenchmarkFunction function;
+  std::vector<int64_t> args;
+};
+
+std::vector<Benchmark>* GetBenchmarks() {
+  static std::vector<Benchmark>* const benchmarks = new std::vector<Benchmark>;
+  return benchmarks;
+}
+
+double ToSeconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration<double>(duration).count();
+}
+
+// Runs |function| with more and more iterations until a run takes at least
+// |min_seconds|, then reports that run.
+bool RunBenchmark(const std::string& name,
+                  BenchmarkFunction function,
+                  int64_t arg,
+                  double min_seconds) {
+  uint64_t iterations = 1;
+  while (true) {
+    State state(iterations, arg);
+    function(&state);
+    if (state.error()) {
+      printf("%-48s ERROR: %s\n", name.c_str(), state.error());
+      return false;
+    }
+
+    const double seconds = ToSeconds(state.elapsed());
+    if (seconds >= min_seconds || iterations >= kMaxIterations) {
+      std::string line = absl::StrFormat("%-48s %12d %14.1f ns", name,
+                                         iterations, seconds * 1e9 / iterations);
+      if (state.bytes_processed() > 0) {
+        absl::StrAppendFormat(&line, " %10.1f MB/s",
+                              state.bytes_processed() / seconds / 1e6);
+      }
+      const char* unit = "iteration";
+      double items = static_cast<double>(iterations);
+      if (state.items_processed() > 0) {
+        absl::StrAppendFormat(&line, " %12.0f items/s",
+                              state.items_processed() / seconds);
+        unit = "item";
+        items = static_cast<double>(state.items_processed());
+      }
+      absl::StrAppendFormat(&line, " %9.2f allocs/%s %11.1f B/%s",
+                            state.allocations() / items, unit,
+                            state.allocated_bytes() / items, unit);
+      printf("%s\n", line.c_str());
+      return true;
+    }
+
+    // Aim a bit past |min_seconds| so that the next run is likely the last.
+    const double growth =
+        seconds > 0 ? std::min(min_seconds * 1.4 / seconds, kMaxIterationsGrowth)
+                    : kMaxIterationsGrowth;
+    iterations = std::min(
+        kMaxIterations,
+        std::max(iterations + 1, static_cast<uint64_t>(iterations * growth)));
+  }
+}
+
+}  // namespace
+
+State::State(uint64_t iterations, int64_t arg)
+    : iterations_(iterations), arg_(arg), iterations_left_(iterations) {}
+
+bool State::KeepRunning() {
+  if (!started_) {
+    started_ = true;
+    ResumeTiming();
+  }
+  if (iterations_left_ > 0 && !error_) {
+    --iterations_left_;
+    return true;
+  }
+  PauseTiming();
+  return false;
+}
+
+void State::PauseTiming() {
+  if (!timing_)
+    return;
+  elapsed_ += std::chrono::steady_clock::now() - start_;
+  allocations_ += AllocationCounter::allocations() - start_allocations_;
+  allocated_bytes_ +=
+      AllocationCounter::allocated_bytes() - start_allocated_bytes_;
+  timing_ = false;
+}
+
+void State::ResumeTiming() {
+  DCHECK(!timing_);
+  start_allocations_ = AllocationCounter::allocations();
+  start_allocated_bytes_ = AllocationCounter::allocated_bytes();
+  start_ = std::chrono::steady_clock::now();
+  timing_ = true;
+}
+
+void State::SkipWithError(const char* error) {
+  error_ = error;
+}
+
+bool RegisterBenchmark(const char* name,
+                       BenchmarkFunction function,
+                       std::vector<int64_t> args) {
+  GetBenchmarks()->push_back({name, function, std::move(args)});
+  return true;
+}
+
+int RunBenchmarks(const std::string& filter, double min_seconds) {
+  printf("%-48s %12s %17s %15s\n", "Benchmark", "Iterations", "Time",
+         "Throughput, allocations");
+
+  int num_failures = 0;
+  for (const Benchmark& benchmark : *GetBenchmarks()) {
+    if (benchmark.args.empty()) {
+      if (!absl::StrContains(benchmark.name, filter))
+        continue;
+      if (!RunBenchmark(benchmark.name, benchmark.function, 0, min_seconds))
+        ++num_failures;
+      continue;
+    }
+    for (int64_t arg : benchmark.args) {
+      const std::string name = absl::StrFormat("%s/%d", benchmark.name, arg);
+      if (!absl::StrContains(name, filter))
+        continue;
+      if (!RunBenchmark(name, benchmark.function, arg, min_seconds))
+        ++num_failures;
+    }
+  }
+  return num_failures;
+}
+
+}  // namespace benchmark
+}  // namespace shaka
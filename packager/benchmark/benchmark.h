@@ -0,0 +1,110 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// A minimal microbenchmark harness, modeled after Google Benchmark's API, so
+// that the hot kernels of the packager can be timed without another
+// third-party dependency.
+
+#ifndef PACKAGER_BENCHMARK_BENCHMARK_H_
+#define PACKAGER_BENCHMARK_BENCHMARK_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace shaka {
+namespace benchmark {
+
+/// The state of one run of a benchmark. The benchmark repeats its operation
+/// while KeepRunning() returns true:
+///
+///   void BM_Foo(State* state) {
+///     Setup();
+///     while (state->KeepRunning())
+///       Foo();
+///   }
+class State {
+ public:
+  State(uint64_t iterations, int64_t arg);
+
+  /// @return true if another iteration should run. The time is measured
+  ///         from the first call to the last one.
+  bool KeepRunning();
+
+  /// Stops and restarts the timer, e.g. around a per-iteration setup.
+  void PauseTiming();
+  void ResumeTiming();
+
+  /// Sets the number of bytes processed by all the iterations, to report the
+  /// throughput.
+  void SetBytesProcessed(int64_t bytes) { bytes_processed_ = bytes; }
+
+  /// Sets the number of items, e.g. samples, processed by all the
+  /// iterations, to report the items per second and the heap allocations per
+  /// item rather than per iteration.
+  void SetItemsProcessed(int64_t items) { items_processed_ = items; }
+
+  /// Marks the run as failed, e.g. if the operation benchmarked failed.
+  void SkipWithError(const char* error);
+
+  /// @return the argument of the run, from SHAKA_BENCHMARK's arguments.
+  int64_t arg() const { return arg_; }
+  uint64_t iterations() const { return iterations_; }
+  std::chrono::steady_clock::duration elapsed() const { return elapsed_; }
+  int64_t bytes_processed() const { return bytes_processed_; }
+  int64_t items_processed() const { return items_processed_; }
+  /// @return the heap allocations made while timing, and their bytes, if the
+  ///         binary counts them, see AllocationCounter.
+  uint64_t allocations() const { return allocations_; }
+  uint64_t allocated_bytes() const { return allocated_bytes_; }
+  const char* error() const { return error_; }
+
+ private:
+  State(const State&) = delete;
+  State& operator=(const State&) = delete;
+
+  const uint64_t iterations_;
+  const int64_t arg_;
+  uint64_t iterations_left_;
+  bool started_ = false;
+  bool timing_ = false;
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::duration elapsed_{0};
+  uint64_t start_allocations_ = 0;
+  uint64_t start_allocated_bytes_ = 0;
+  uint64_t allocations_ = 0;
+  uint64_t allocated_bytes_ = 0;
+  int64_t bytes_processed_ = 0;
+  int64_t items_processed_ = 0;
+  const char* error_ = nullptr;
+};
+
+using BenchmarkFunction = void (*)(State* state);
+
+/// Registers a benchmark, run once per argument, or once without argument if
+/// @a args is empty.
+/// @return true, so that it can initialize a static.
+bool RegisterBenchmark(const char* name,
+                       BenchmarkFunction function,
+                       std::vector<int64_t> args);
+
+/// Runs the registered benchmarks whose name contains @a filter.
+/// @param min_seconds is the minimum time spent in each benchmark run.
+/// @return the number of runs which failed.
+int RunBenchmarks(const std::string& filter, double min_seconds);
+
+}  // namespace benchmark
+}  // namespace shaka
+
+/// Registers |function| as a benchmark, with optional integer arguments
+/// available in State::arg().
+#define SHAKA_BENCHMARK(function, ...)                                    \
+  static const bool function##_registered [[maybe_unused]] =              \
+      ::shaka::benchmark::RegisterBenchmark(#function, function,          \
+                                            std::vector<int64_t>{__VA_ARGS__})
+
+#endif  // PACKAGER_BENCHMARK_BENCHMARK_H_
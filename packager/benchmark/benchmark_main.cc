@@ -0,0 +1,31 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/flags/usage.h>
+
+#include <packager/benchmark/benchmark.h>
+
+ABSL_FLAG(std::string,
+          benchmark_filter,
+          "",
+          "Only run the benchmarks whose name, including the argument, "
+          "contains this string.");
+ABSL_FLAG(double,
+          benchmark_min_time,
+          0.5,
+          "The minimum time, in seconds, spent in each benchmark run.");
+
+int main(int argc, char** argv) {
+  absl::SetProgramUsageMessage(
+      "Microbenchmarks of the packager's hot kernels.");
+  absl::ParseCommandLine(argc, argv);
+  const int num_failures = shaka::benchmark::RunBenchmarks(
+      absl::GetFlag(FLAGS_benchmark_filter),
+      absl::GetFlag(FLAGS_benchmark_min_time));
+  return num_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/benchmark/benchmark.h>
+#include <packager/media/codecs/nalu_reader.h>
+#include <packager/media/test/test_data_util.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+// Splits an H.264 Annex B byte stream into NAL units.
+void BM_NaluReaderAdvance(benchmark::State* state) {
+  const std::vector<uint8_t> stream = ReadTestDataFile("bear.h264");
+  if (stream.empty()) {
+    state->SkipWithError("Unable to read bear.h264");
+    return;
+  }
+
+  while (state->KeepRunning()) {
+    NaluReader reader(Nalu::kH264, kIsAnnexbByteStream, stream.data(),
+                      stream.size());
+    Nalu nalu;
+    while (reader.Advance(&nalu) == NaluReader::kOk) {
+    }
+  }
+  state->SetBytesProcessed(state->iterations() * stream.size());
+}
+SHAKA_BENCHMARK(BM_NaluReaderAdvance);
+
+}  // namespace
+}  // namespace media
+}  // namespace shaka
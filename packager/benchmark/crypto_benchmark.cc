@@ -0,0 +1,64 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <memory>
+#include <vector>
+
+#include <packager/benchmark/benchmark.h>
+#include <packager/media/base/aes_encryptor.h>
+#include <packager/media/base/aes_pattern_cryptor.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const std::vector<uint8_t> kKey(16, 0x42);
+const std::vector<uint8_t> kIv(16, 0x24);
+
+// Encrypts buffers of State::arg() bytes, which are multiples of the AES block
+// size so that no padding is involved.
+void RunCryptBenchmark(AesCryptor* cryptor, benchmark::State* state) {
+  if (!cryptor->InitializeWithIv(kKey, kIv)) {
+    state->SkipWithError("Unable to initialize the cryptor");
+    return;
+  }
+
+  const std::vector<uint8_t> text(state->arg(), 0x5a);
+  std::vector<uint8_t> crypt_text(text.size());
+  while (state->KeepRunning()) {
+    if (!cryptor->Crypt(text.data(), text.size(), crypt_text.data())) {
+      state->SkipWithError("Crypt failed");
+      return;
+    }
+  }
+  state->SetBytesProcessed(state->iterations() * text.size());
+}
+
+void BM_AesCtrEncryptor(benchmark::State* state) {
+  AesCtrEncryptor encryptor;
+  RunCryptBenchmark(&encryptor, state);
+}
+SHAKA_BENCHMARK(BM_AesCtrEncryptor, 1024, 64 * 1024, 1024 * 1024);
+
+void BM_AesCbcEncryptor(benchmark::State* state) {
+  AesCbcEncryptor encryptor(kNoPadding);
+  RunCryptBenchmark(&encryptor, state);
+}
+SHAKA_BENCHMARK(BM_AesCbcEncryptor, 1024, 64 * 1024, 1024 * 1024);
+
+// The 1:9 pattern of 'cbcs', as set up by the encryptor factory.
+void BM_AesPatternCryptor(benchmark::State* state) {
+  AesPatternCryptor cryptor(
+      1, 9, AesPatternCryptor::kEncryptIfCryptByteBlockRemaining,
+      AesCryptor::kUseConstantIv,
+      std::unique_ptr<AesCryptor>(new AesCbcEncryptor(kNoPadding)));
+  RunCryptBenchmark(&cryptor, state);
+}
+SHAKA_BENCHMARK(BM_AesPatternCryptor, 1024, 64 * 1024, 1024 * 1024);
+
+}  // namespace
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,110 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <string>
+
+#include <packager/benchmark/benchmark.h>
+#include <packager/hls/base/media_playlist.h>
+#include <packager/mpd/base/adaptation_set.h>
+#include <packager/mpd/base/media_info.pb.h>
+#include <packager/mpd/base/mpd_builder.h>
+#include <packager/mpd/base/period.h>
+#include <packager/mpd/base/representation.h>
+
+namespace shaka {
+namespace {
+
+const uint32_t kTimeScale = 90000;
+// Alternate two segment durations, so that segments are not collapsed into a
+// single repeated entry and the manifests grow with the DVR window as they do
+// with real encoders.
+const int64_t kSegmentDurations[] = {180000, 180180};
+const uint64_t kSegmentSize = 500000;
+
+// The number of segments in the DVR window of the benchmarks.
+#define DVR_WINDOW_SIZES 100, 1000, 10000
+
+MediaInfo GetVideoMediaInfo() {
+  MediaInfo media_info;
+  MediaInfo::VideoInfo* video_info = media_info.mutable_video_info();
+  video_info->set_codec("avc1.64001f");
+  video_info->set_width(1280);
+  video_info->set_height(720);
+  video_info->set_time_scale(kTimeScale);
+  video_info->set_frame_duration(3003);
+  video_info->set_pixel_width(1);
+  video_info->set_pixel_height(1);
+  media_info.set_reference_time_scale(kTimeScale);
+  media_info.set_container_type(MediaInfo::CONTAINER_MP4);
+  media_info.set_init_segment_url("init.mp4");
+  media_info.set_segment_template_url("segment-$Number$.m4s");
+  media_info.set_bandwidth(2000000);
+  return media_info;
+}
+
+// Generates a live MPD with State::arg() segments in its timeline.
+void BM_MpdBuilderToString(benchmark::State* state) {
+  MpdOptions mpd_options;
+  mpd_options.dash_profile = DashProfile::kLive;
+  mpd_options.mpd_type = MpdType::kDynamic;
+  mpd_options.mpd_params.minimum_update_period = 2;
+  MpdBuilder mpd_builder(mpd_options);
+
+  const MediaInfo media_info = GetVideoMediaInfo();
+  AdaptationSet* adaptation_set =
+      mpd_builder.GetOrCreatePeriod(0)->GetOrCreateAdaptationSet(
+          media_info, true /* content_protection_in_adaptation_set */);
+  Representation* representation =
+      adaptation_set->AddRepresentation(media_info);
+  int64_t start_time = 0;
+  for (int64_t i = 0; i < state->arg(); ++i) {
+    const int64_t duration = kSegmentDurations[i % 2];
+    representation->AddNewSegment(start_time, duration, kSegmentSize, i + 1);
+    start_time += duration;
+  }
+
+  int64_t bytes = 0;
+  while (state->KeepRunning()) {
+    std::string mpd;
+    if (!mpd_builder.ToString(&mpd)) {
+      state->SkipWithError("Unable to generate the MPD");
+      return;
+    }
+    bytes += mpd.size();
+  }
+  state->SetBytesProcessed(bytes);
+}
+SHAKA_BENCHMARK(BM_MpdBuilderToString, DVR_WINDOW_SIZES);
+
+// Writes an event media playlist of State::arg() segments to memory.
+void BM_MediaPlaylistWriteToFile(benchmark::State* state) {
+  HlsParams hls_params;
+  hls_params.playlist_type = HlsPlaylistType::kEvent;
+  hls::MediaPlaylist media_playlist(hls_params, "video.m3u8", "video",
+                                    "video_group");
+  if (!media_playlist.SetMediaInfo(GetVideoMediaInfo())) {
+    state->SkipWithError("Unable to set the MediaInfo");
+    return;
+  }
+  int64_t start_time = 0;
+  for (int64_t i = 0; i < state->arg(); ++i) {
+    const int64_t duration = kSegmentDurations[i % 2];
+    media_playlist.AddSegment("segment-" + std::to_string(i + 1) + ".m4s",
+                              start_time, duration, 0, kSegmentSize);
+    start_time += duration;
+  }
+
+  while (state->KeepRunning()) {
+    if (!media_playlist.WriteToFile("memory://video.m3u8")) {
+      state->SkipWithError("Unable to write the playlist");
+      return;
+    }
+  }
+}
+SHAKA_BENCHMARK(BM_MediaPlaylistWriteToFile, DVR_WINDOW_SIZES);
+
+}  // namespace
+}  // namespace shaka
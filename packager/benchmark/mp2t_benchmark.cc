@@ -0,0 +1,57 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <memory>
+
+#include <packager/benchmark/benchmark.h>
+#include <packager/media/base/buffer_writer.h>
+#include <packager/media/formats/mp2t/pes_packet.h>
+#include <packager/media/formats/mp2t/program_map_table_writer.h>
+#include <packager/media/formats/mp2t/ts_writer.h>
+
+namespace shaka {
+namespace media {
+namespace mp2t {
+namespace {
+
+const uint8_t kVideoStreamId = 0xE0;
+const int64_t kFrameDuration = 3003;
+
+// Packetizes video PES packets of State::arg() bytes into TS packets.
+void BM_TsWriterAddPesPacket(benchmark::State* state) {
+  TsWriter writer(std::unique_ptr<ProgramMapTableWriter>(
+      new VideoProgramMapTableWriter(kCodecH264)));
+  BufferWriter buffer;
+  if (!writer.NewSegment(&buffer)) {
+    state->SkipWithError("Unable to start a segment");
+    return;
+  }
+
+  int64_t timestamp = 0;
+  while (state->KeepRunning()) {
+    state->PauseTiming();
+    std::unique_ptr<PesPacket> pes_packet(new PesPacket);
+    pes_packet->set_stream_id(kVideoStreamId);
+    pes_packet->set_pts(timestamp);
+    pes_packet->set_dts(timestamp);
+    pes_packet->mutable_data()->assign(state->arg(), 0x5a);
+    timestamp += kFrameDuration;
+    buffer.Clear();
+    state->ResumeTiming();
+
+    if (!writer.AddPesPacket(std::move(pes_packet), &buffer)) {
+      state->SkipWithError("AddPesPacket failed");
+      return;
+    }
+  }
+  state->SetBytesProcessed(state->iterations() * state->arg());
+}
+SHAKA_BENCHMARK(BM_TsWriterAddPesPacket, 1024, 16 * 1024, 256 * 1024);
+
+}  // namespace
+}  // namespace mp2t
+}  // namespace media
+}  // namespace shaka
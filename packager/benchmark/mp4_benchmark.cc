@@ -0,0 +1,76 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <memory>
+#include <vector>
+
+#include <packager/benchmark/benchmark.h>
+#include <packager/media/formats/mp4/box_definitions.h>
+#include <packager/media/formats/mp4/box_reader.h>
+#include <packager/media/test/test_data_util.h>
+
+namespace shaka {
+namespace media {
+namespace mp4 {
+namespace {
+
+// Extracts the 'moov' box of an MP4 file in media/test/data.
+std::vector<uint8_t> ReadMoov(const std::string& file_name) {
+  const std::vector<uint8_t> file = ReadTestDataFile(file_name);
+  size_t offset = 0;
+  while (offset < file.size()) {
+    FourCC type = FOURCC_NULL;
+    uint64_t box_size = 0;
+    bool err = false;
+    if (!BoxReader::StartBox(file.data() + offset, file.size() - offset, &type,
+                             &box_size, &err) ||
+        box_size == 0 || box_size > file.size() - offset) {
+      break;
+    }
+    if (type == FOURCC_moov) {
+      return std::vector<uint8_t>(file.begin() + offset,
+                                  file.begin() + offset + box_size);
+    }
+    offset += box_size;
+  }
+  return std::vector<uint8_t>();
+}
+
+void RunMoovParseBenchmark(const std::string& file_name,
+                           benchmark::State* state) {
+  const std::vector<uint8_t> moov = ReadMoov(file_name);
+  if (moov.empty()) {
+    state->SkipWithError("Unable to find the moov box");
+    return;
+  }
+
+  while (state->KeepRunning()) {
+    bool err = false;
+    std::unique_ptr<BoxReader> reader(
+        BoxReader::ReadBox(moov.data(), moov.size(), &err));
+    Movie movie;
+    if (!reader || !movie.Parse(reader.get())) {
+      state->SkipWithError("Unable to parse the moov box");
+      return;
+    }
+  }
+  state->SetBytesProcessed(state->iterations() * moov.size());
+}
+
+void BM_BoxReaderParseMoovAvc(benchmark::State* state) {
+  RunMoovParseBenchmark("bear-1280x720.mp4", state);
+}
+SHAKA_BENCHMARK(BM_BoxReaderParseMoovAvc);
+
+void BM_BoxReaderParseMoovHevc(benchmark::State* state) {
+  RunMoovParseBenchmark("bear-1280x720-hevc.mp4", state);
+}
+SHAKA_BENCHMARK(BM_BoxReaderParseMoovHevc);
+
+}  // namespace
+}  // namespace mp4
+}  // namespace media
+}  // namespace shaka
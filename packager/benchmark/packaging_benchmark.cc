@@ -0,0 +1,274 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// End-to-end throughput benchmark of representative packaging graphs. The
+// inputs are synthesized by repeating the fragments of a test file, and all
+// the files live in memory, so that the disk is not part of the measurement.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#if !defined(OS_WIN)
+#include <sys/resource.h>
+#endif  // !defined(OS_WIN)
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/flags/usage.h>
+#include <absl/strings/str_split.h>
+
+#include <packager/benchmark/synthetic_input.h>
+#include <packager/file.h>
+#include <packager/file/memory_file.h>
+#include <packager/media/test/test_data_util.h>
+#include <packager/packager.h>
+
+ABSL_FLAG(std::string,
+          graphs,
+          "cmaf_abr,hls_ts_cbcs,ll_dash,text_ad_cues",
+          "Comma separated list of the packaging graphs to run.");
+ABSL_FLAG(std::string,
+          threading,
+          "single,multi",
+          "Comma separated list of the threading modes to run each graph "
+          "with: 'single' for single_threaded, 'multi' for the JobManager.");
+ABSL_FLAG(uint32_t,
+          input_repeats,
+          30,
+          "The number of times the fragments of the test input are repeated "
+          "to synthesize the long input.");
+
+namespace shaka {
+namespace {
+
+const char kInputFile[] = "bear-640x360-av_frag.mp4";
+const char kTextInputFile[] = "bear-english.vtt";
+const char kInput[] = "memory://input/av.mp4";
+const char kTextInput[] = "memory://input/text.vtt";
+const char kOutputDir[] = "memory://output/";
+const int kNumAbrOutputs = 8;
+
+const uint8_t kKeyId[] = {
+    0xe5, 0x00, 0x7e, 0x6e, 0x9d, 0xcd, 0x5a, 0xc0,
+    0x95, 0x20, 0x2e, 0xd3, 0x75, 0x83, 0x82, 0xcd,
+};
+const uint8_t kKey[]{
+    0x6f, 0xc9, 0x6f, 0xe6, 0x28, 0xa2, 0x65, 0xb1,
+    0x3a, 0xed, 0xde, 0xc0, 0xbc, 0x42, 0x1f, 0x4d,
+};
+
+std::string Output(const std::string& name) {
+  return kOutputDir + name;
+}
+
+PackagingParams DefaultParams() {
+  PackagingParams params;
+  params.temp_dir = kOutputDir;
+  params.chunking_params.segment_duration_in_seconds = 2;
+  params.collect_handler_stats = true;
+  return params;
+}
+
+StreamDescriptor Stream(const std::string& input,
+                        const std::string& stream_selector,
+                        const std::string& name,
+                        const std::string& extension) {
+  StreamDescriptor stream;
+  stream.input = input;
+  stream.stream_selector = stream_selector;
+  stream.output = Output(name + "_init.mp4");
+  stream.segment_template = Output(name + "_$Number$." + extension);
+  return stream;
+}
+
+// One input, with its video stream packaged into eight CMAF renditions, as an
+// ABR ladder would be, and its audio into one.
+void CmafAbrGraph(PackagingParams* params,
+                  std::vector<StreamDescriptor>* streams) {
+  params->mpd_params.mpd_output = Output("cmaf_abr.mpd");
+  for (int i = 0; i < kNumAbrOutputs; ++i) {
+    streams->push_back(
+        Stream(kInput, "video", "video_" + std::to_string(i), "m4s"));
+  }
+  streams->push_back(Stream(kInput, "audio", "audio", "m4s"));
+}
+
+// SAMPLE-AES (cbcs) encrypted HLS in MPEG-2 TS.
+void HlsTsCbcsGraph(PackagingParams* params,
+                    std::vector<StreamDescriptor>* streams) {
+  params->hls_params.master_playlist_output = Output("master.m3u8");
+  EncryptionParams& encryption_params = params->encryption_params;
+  encryption_params.key_provider = KeyProvider::kRawKey;
+  encryption_params.protection_scheme =
+      EncryptionParams::kProtectionSchemeCbcs;
+  encryption_params.raw_key.key_map[""].key_id.assign(std::begin(kKeyId),
+                                                      std::end(kKeyId));
+  encryption_params.raw_key.key_map[""].key.assign(std::begin(kKey),
+                                                   std::end(kKey));
+
+  StreamDescriptor video = Stream(kInput, "video", "video", "ts");
+  video.output.clear();
+  video.hls_playlist_name = "video.m3u8";
+  streams->push_back(video);
+  StreamDescriptor audio = Stream(kInput, "audio", "audio", "ts");
+  audio.output.clear();
+  audio.hls_playlist_name = "audio.m3u8";
+  audio.hls_group_id = "audio";
+  audio.hls_name = "audio";
+  streams->push_back(audio);
+}
+
+// Low latency DASH, with one chunk per frame.
+void LlDashGraph(PackagingParams* params,
+                 std::vector<StreamDescriptor>* streams) {
+  params->chunking_params.low_latency_dash_mode = true;
+  params->mp4_output_params.low_latency_dash_mode = true;
+  params->mpd_params.low_latency_dash_mode = true;
+  params->mpd_params.mpd_output = Output("ll_dash.mpd");
+  params->mpd_params.utc_timings = {
+      {"urn:mpeg:dash:utc:http-xsdate:2014", "https://time.akamai.com/?iso"}};
+  streams->push_back(Stream(kInput, "video", "video", "m4s"));
+  streams->push_back(Stream(kInput, "audio", "audio", "m4s"));
+}
+
+// Text and video, split into periods by ad cues.
+void TextAdCuesGraph(PackagingParams* params,
+                     std::vector<StreamDescriptor>* streams) {
+  params->mpd_params.mpd_output = Output("text_ad_cues.mpd");
+  for (double time : {10.0, 30.0, 60.0})
+    params->ad_cue_generator_params.cue_points.push_back({time, 0});
+  streams->push_back(Stream(kInput, "video", "video", "m4s"));
+  StreamDescriptor text = Stream(kTextInput, "text", "text", "vtt");
+  text.output.clear();
+  streams->push_back(text);
+}
+
+const std::map<std::string,
+               std::function<void(PackagingParams*,
+                                  std::vector<StreamDescriptor>*)>>
+    kGraphs = {
+        {"cmaf_abr", CmafAbrGraph},
+        {"hls_ts_cbcs", HlsTsCbcsGraph},
+        {"ll_dash", LlDashGraph},
+        {"text_ad_cues", TextAdCuesGraph},
+};
+
+double PeakRssMegabytes() {
+#if defined(OS_WIN)
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+  // In kilobytes on Linux, in bytes on Mac.
+#if defined(__APPLE__)
+  return usage.ru_maxrss / 1e6;
+#else
+  return usage.ru_maxrss / 1e3;
+#endif
+#endif  // defined(OS_WIN)
+}
+
+bool RunGraph(const std::string& graph_name,
+              bool single_threaded,
+              const std::string& input,
+              const std::string& text_input) {
+  // Start from a clean slate, so that the outputs of the previous runs do not
+  // add up in memory.
+  MemoryFile::DeleteAll();
+  if (!File::WriteStringToFile(kInput, input) ||
+      !File::WriteStringToFile(kTextInput, text_input)) {
+    fprintf(stderr, "Unable to write the inputs.\n");
+    return false;
+  }
+
+  PackagingParams params = DefaultParams();
+  params.single_threaded = single_threaded;
+  std::vector<StreamDescriptor> streams;
+  kGraphs.at(graph_name)(&params, &streams);
+
+  Packager packager;
+  Status status = packager.Initialize(params, streams);
+  const auto start = std::chrono::steady_clock::now();
+  if (status.ok())
+    status = packager.Run();
+  const double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  if (!status.ok()) {
+    fprintf(stderr, "%s failed: %s\n", graph_name.c_str(),
+            status.ToString().c_str());
+    return false;
+  }
+
+  // The samples read by the demuxers, and the time spent per type of
+  // handler, which ends the labels.
+  uint64_t samples = 0;
+  uint64_t bytes = 0;
+  std::map<std::string, double> stage_seconds;
+  for (const HandlerStats& stats : packager.GetHandlerStats()) {
+    const std::string stage = stats.label.substr(stats.label.rfind('/') + 1);
+    if (stage == "Demuxer") {
+      samples += stats.samples;
+      bytes += stats.bytes;
+    }
+    stage_seconds[stage] += stats.process_seconds;
+  }
+
+  printf("%-14s %-7s %8.3f s %12.0f samples/s %9.1f MB/s %8.1f MB peak RSS\n",
+         graph_name.c_str(), single_threaded ? "single" : "multi", seconds,
+         samples / seconds, bytes / seconds / 1e6, PeakRssMegabytes());
+  for (const auto& pair : stage_seconds)
+    printf("    %-30s %8.3f s\n", pair.first.c_str(), pair.second);
+  return true;
+}
+
+int Run() {
+  std::string input;
+  if (!benchmark::MakeLongInput(media::ReadTestDataFile(kInputFile),
+                     absl::GetFlag(FLAGS_input_repeats), &input)) {
+    fprintf(stderr, "Unable to synthesize the input from %s.\n", kInputFile);
+    return 1;
+  }
+  const std::vector<uint8_t> text = media::ReadTestDataFile(kTextInputFile);
+  const std::string text_input(text.begin(), text.end());
+
+  int num_failures = 0;
+  for (const auto& graph : absl::StrSplit(absl::GetFlag(FLAGS_graphs), ',',
+                                          absl::SkipEmpty())) {
+    const std::string graph_name(graph);
+    if (!kGraphs.count(graph_name)) {
+      fprintf(stderr, "Unknown graph %s.\n", graph_name.c_str());
+      return 1;
+    }
+    for (const auto& mode : absl::StrSplit(absl::GetFlag(FLAGS_threading),
+                                           ',', absl::SkipEmpty())) {
+      if (mode != "single" && mode != "multi") {
+        fprintf(stderr, "Unknown threading mode %s.\n",
+                std::string(mode).c_str());
+        return 1;
+      }
+      if (!RunGraph(graph_name, mode == "single", input, text_input))
+        ++num_failures;
+    }
+  }
+  return num_failures == 0 ? 0 : 1;
+}
+
+}  // namespace
+}  // namespace shaka
+
+int main(int argc, char** argv) {
+  absl::SetProgramUsageMessage(
+      "End-to-end throughput benchmark of representative packaging graphs.");
+  absl::ParseCommandLine(argc, argv);
+  return shaka::Run();
+}
@@ -0,0 +1,126 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// Throughput of each MediaParser over the test data, fed in chunks of
+// State::arg() bytes as a demuxer would, from small reads to the default I/O
+// block size. Each iteration parses the whole input with a new parser, and
+// the samples emitted are the items, so that the heap allocations are
+// reported per sample.
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <packager/benchmark/benchmark.h>
+#include <packager/benchmark/synthetic_input.h>
+#include <packager/media/base/media_parser.h>
+#include <packager/media/formats/mp2t/mp2t_media_parser.h>
+#include <packager/media/formats/mp4/mp4_media_parser.h>
+#include <packager/media/formats/webm/webm_media_parser.h>
+#include <packager/media/formats/webvtt/webvtt_parser.h>
+#include <packager/media/formats/wvm/wvm_media_parser.h>
+#include <packager/media/test/test_data_util.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+// The number of times the fragments of the MP4 input are repeated, so that
+// the parsing of the fragments rather than of the header dominates.
+const uint32_t kMp4InputRepeats = 10;
+
+using ParserFactory = std::function<std::unique_ptr<MediaParser>()>;
+
+// Parses |input| in chunks of State::arg() bytes with a new parser per
+// iteration.
+void RunParserBenchmark(const std::vector<uint8_t>& input,
+                        const ParserFactory& create_parser,
+                        benchmark::State* state) {
+  if (input.empty()) {
+    state->SkipWithError("Unable to read the input");
+    return;
+  }
+
+  int64_t samples = 0;
+  while (state->KeepRunning()) {
+    std::unique_ptr<MediaParser> parser = create_parser();
+    parser->Init(
+        [](const std::vector<std::shared_ptr<StreamInfo>>&) {},
+        [&samples](uint32_t, std::shared_ptr<MediaSample>) {
+          ++samples;
+          return true;
+        },
+        [&samples](uint32_t, std::shared_ptr<TextSample>) {
+          ++samples;
+          return true;
+        },
+        nullptr);
+    for (size_t offset = 0; offset < input.size();) {
+      const size_t size =
+          std::min(input.size() - offset, static_cast<size_t>(state->arg()));
+      if (!parser->Parse(input.data() + offset, static_cast<int>(size))) {
+        state->SkipWithError("Parse failed");
+        return;
+      }
+      offset += size;
+    }
+    if (!parser->Flush()) {
+      state->SkipWithError("Flush failed");
+      return;
+    }
+  }
+  state->SetBytesProcessed(state->iterations() * input.size());
+  state->SetItemsProcessed(samples);
+}
+
+template <typename Parser>
+std::unique_ptr<MediaParser> CreateParser() {
+  return std::unique_ptr<MediaParser>(new Parser);
+}
+
+void BM_Mp4MediaParser(benchmark::State* state) {
+  std::string long_input;
+  if (!benchmark::MakeLongInput(ReadTestDataFile("bear-640x360-av_frag.mp4"),
+                                kMp4InputRepeats, &long_input)) {
+    state->SkipWithError("Unable to synthesize the input");
+    return;
+  }
+  RunParserBenchmark(
+      std::vector<uint8_t>(long_input.begin(), long_input.end()),
+      CreateParser<mp4::MP4MediaParser>, state);
+}
+SHAKA_BENCHMARK(BM_Mp4MediaParser, 4 * 1024, 64 * 1024);
+
+void BM_Mp2tMediaParser(benchmark::State* state) {
+  RunParserBenchmark(ReadTestDataFile("bear-640x360.ts"),
+                     CreateParser<mp2t::Mp2tMediaParser>, state);
+}
+SHAKA_BENCHMARK(BM_Mp2tMediaParser, 4 * 1024, 64 * 1024);
+
+void BM_WebMMediaParser(benchmark::State* state) {
+  RunParserBenchmark(ReadTestDataFile("bear-640x360.webm"),
+                     CreateParser<WebMMediaParser>, state);
+}
+SHAKA_BENCHMARK(BM_WebMMediaParser, 4 * 1024, 64 * 1024);
+
+// Without a key source, the encrypted samples are emitted as is.
+void BM_WvmMediaParser(benchmark::State* state) {
+  RunParserBenchmark(ReadTestDataFile("bear-640x360.wvm"),
+                     CreateParser<wvm::WvmMediaParser>, state);
+}
+SHAKA_BENCHMARK(BM_WvmMediaParser, 4 * 1024, 64 * 1024);
+
+void BM_WebVttParser(benchmark::State* state) {
+  RunParserBenchmark(ReadTestDataFile("bear-english.vtt"),
+                     CreateParser<WebVttParser>, state);
+}
+SHAKA_BENCHMARK(BM_WebVttParser, 4 * 1024, 64 * 1024);
+
+}  // namespace
+}  // namespace media
+}  // namespace shaka
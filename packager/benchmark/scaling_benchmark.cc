@@ -0,0 +1,315 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// Concurrency scalability benchmark. Packages N inputs into M outputs each,
+// for each threading mode, and reports the throughput with the CPU time, the
+// utilization of each core, the contended mutex acquisitions and the context
+// switches it took. All the files live in memory, so that the disk is not
+// part of the measurement.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(OS_WIN)
+#include <sys/resource.h>
+#endif  // !defined(OS_WIN)
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/flags/usage.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_format.h>
+#include <absl/strings/str_split.h>
+#include <absl/synchronization/mutex.h>
+
+#include <packager/benchmark/synthetic_input.h>
+#include <packager/file.h>
+#include <packager/file/memory_file.h>
+#include <packager/media/test/test_data_util.h>
+#include <packager/packager.h>
+
+ABSL_FLAG(std::string,
+          inputs,
+          "1,2,4,8",
+          "Comma separated list of the numbers of inputs to package at once.");
+ABSL_FLAG(std::string,
+          outputs,
+          "1,4",
+          "Comma separated list of the numbers of outputs per input.");
+ABSL_FLAG(std::string,
+          threading,
+          "single,multi,per_output",
+          "Comma separated list of the threading modes: 'single' for "
+          "single_threaded, 'multi' for the JobManager, and 'per_output' for "
+          "the JobManager with thread_per_output.");
+ABSL_FLAG(uint32_t,
+          input_repeats,
+          10,
+          "The number of times the fragments of the test input are repeated "
+          "to synthesize each input.");
+ABSL_FLAG(bool,
+          per_core,
+          true,
+          "Report the utilization of each core, from /proc/stat. Linux only.");
+
+namespace shaka {
+namespace {
+
+const char kInputFile[] = "bear-640x360-av_frag.mp4";
+const char kOutputDir[] = "memory://output/";
+
+// Configures a threading mode.
+using ThreadingFunction = std::function<void(PackagingParams*)>;
+
+const std::map<std::string, ThreadingFunction> kThreadingModes = {
+    {"single", [](PackagingParams* params) { params->single_threaded = true; }},
+    {"multi", [](PackagingParams* /* params */) {}},
+    {"per_output",
+     [](PackagingParams* params) { params->thread_per_output = true; }},
+};
+
+// The contended acquisitions of absl::Mutex, from the mutex profiler hook.
+std::atomic<uint64_t> g_contentions{0};
+std::atomic<uint64_t> g_contention_wait_cycles{0};
+
+void OnMutexContention(int64_t wait_cycles) {
+  g_contentions.fetch_add(1, std::memory_order_relaxed);
+  if (wait_cycles > 0) {
+    g_contention_wait_cycles.fetch_add(static_cast<uint64_t>(wait_cycles),
+                                       std::memory_order_relaxed);
+  }
+}
+
+// The resources used by the process since it started.
+struct Usage {
+  double cpu_seconds = 0;
+  uint64_t voluntary_switches = 0;
+  uint64_t involuntary_switches = 0;
+  uint64_t contentions = 0;
+  uint64_t contention_wait_cycles = 0;
+  // The busy and total jiffies of each core.
+  std::vector<std::pair<uint64_t, uint64_t>> core_times;
+};
+
+// Reads the busy and total times of each core from /proc/stat. Empty if they
+// are unknown.
+std::vector<std::pair<uint64_t, uint64_t>> ReadCoreTimes() {
+  std::vector<std::pair<uint64_t, uint64_t>> core_times;
+  std::ifstream stat("/proc/stat");
+  std::string line;
+  while (std::getline(stat, line)) {
+    // "cpuN user nice system idle iowait irq softirq steal ...". The first
+    // line, "cpu ...", sums all the cores.
+    if (line.compare(0, 3, "cpu") != 0 || line.size() < 4 || line[3] == ' ')
+      continue;
+    const std::vector<std::string> fields =
+        absl::StrSplit(line, ' ', absl::SkipEmpty());
+    uint64_t total = 0;
+    uint64_t idle = 0;
+    for (size_t i = 1; i < fields.size(); ++i) {
+      uint64_t value = 0;
+      if (!absl::SimpleAtoi(fields[i], &value))
+        return {};
+      total += value;
+      // The idle and iowait times.
+      if (i == 4 || i == 5)
+        idle += value;
+    }
+    core_times.emplace_back(total - idle, total);
+  }
+  return core_times;
+}
+
+Usage GetUsage() {
+  Usage usage;
+#if !defined(OS_WIN)
+  struct rusage rusage;
+  if (getrusage(RUSAGE_SELF, &rusage) == 0) {
+    usage.cpu_seconds = rusage.ru_utime.tv_sec + rusage.ru_stime.tv_sec +
+                        (rusage.ru_utime.tv_usec + rusage.ru_stime.tv_usec) /
+                            1e6;
+    usage.voluntary_switches = rusage.ru_nvcsw;
+    usage.involuntary_switches = rusage.ru_nivcsw;
+  }
+#endif  // !defined(OS_WIN)
+  usage.contentions = g_contentions.load(std::memory_order_relaxed);
+  usage.contention_wait_cycles =
+      g_contention_wait_cycles.load(std::memory_order_relaxed);
+  if (absl::GetFlag(FLAGS_per_core))
+    usage.core_times = ReadCoreTimes();
+  return usage;
+}
+
+// Formats the utilization of each core between |start| and |end|, e.g.
+// "0:98% 1:12%".
+std::string FormatCoreUtilization(const Usage& start, const Usage& end) {
+  if (start.core_times.size() != end.core_times.size())
+    return "";
+  std::string utilization;
+  for (size_t i = 0; i < end.core_times.size(); ++i) {
+    const uint64_t busy = end.core_times[i].first - start.core_times[i].first;
+    const uint64_t total =
+        end.core_times[i].second - start.core_times[i].second;
+    absl::StrAppendFormat(&utilization, "%s%d:%.0f%%",
+                          utilization.empty() ? "" : " ", i,
+                          total ? 100.0 * busy / total : 0.0);
+  }
+  return utilization;
+}
+
+std::string Input(int input) {
+  return absl::StrFormat("memory://input/av_%d.mp4", input);
+}
+
+bool RunScenario(int num_inputs,
+                 int num_outputs,
+                 const std::string& threading,
+                 const std::string& input) {
+  // Start from a clean slate, so that the outputs of the previous runs do not
+  // add up in memory.
+  MemoryFile::DeleteAll();
+  for (int i = 0; i < num_inputs; ++i) {
+    if (!File::WriteStringToFile(Input(i).c_str(), input)) {
+      fprintf(stderr, "Unable to write the inputs.\n");
+      return false;
+    }
+  }
+
+  PackagingParams params;
+  params.temp_dir = kOutputDir;
+  params.chunking_params.segment_duration_in_seconds = 2;
+  params.collect_handler_stats = true;
+  kThreadingModes.at(threading)(&params);
+
+  // Each output is a rendition of the video of its input, as in an ABR
+  // ladder.
+  std::vector<StreamDescriptor> streams;
+  for (int i = 0; i < num_inputs; ++i) {
+    for (int j = 0; j < num_outputs; ++j) {
+      const std::string name = absl::StrFormat("%sinput_%d_output_%d",
+                                               kOutputDir, i, j);
+      StreamDescriptor stream;
+      stream.input = Input(i);
+      stream.stream_selector = "video";
+      stream.output = name + "_init.mp4";
+      stream.segment_template = name + "_$Number$.m4s";
+      streams.push_back(stream);
+    }
+  }
+
+  Packager packager;
+  Status status = packager.Initialize(params, streams);
+  const Usage start_usage = GetUsage();
+  const auto start = std::chrono::steady_clock::now();
+  if (status.ok())
+    status = packager.Run();
+  const double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  const Usage end_usage = GetUsage();
+  if (!status.ok()) {
+    fprintf(stderr, "%d x %d %s failed: %s\n", num_inputs, num_outputs,
+            threading.c_str(), status.ToString().c_str());
+    return false;
+  }
+
+  uint64_t samples = 0;
+  uint64_t bytes = 0;
+  for (const HandlerStats& stats : packager.GetHandlerStats()) {
+    if (stats.label.substr(stats.label.rfind('/') + 1) == "Demuxer") {
+      samples += stats.samples;
+      bytes += stats.bytes;
+    }
+  }
+
+  const double cpu_seconds = end_usage.cpu_seconds - start_usage.cpu_seconds;
+  printf(
+      "%3d x %-3d %-10s %8.3f s %12.0f samples/s %9.1f MB/s %6.2f CPUs "
+      "%9llu contentions %8.1f Mcycles waited %9llu+%llu switches\n",
+      num_inputs, num_outputs, threading.c_str(), seconds, samples / seconds,
+      bytes / seconds / 1e6, cpu_seconds / seconds,
+      static_cast<unsigned long long>(end_usage.contentions -
+                                      start_usage.contentions),
+      (end_usage.contention_wait_cycles - start_usage.contention_wait_cycles) /
+          1e6,
+      static_cast<unsigned long long>(end_usage.voluntary_switches -
+                                      start_usage.voluntary_switches),
+      static_cast<unsigned long long>(end_usage.involuntary_switches -
+                                      start_usage.involuntary_switches));
+  const std::string core_utilization =
+      FormatCoreUtilization(start_usage, end_usage);
+  if (!core_utilization.empty())
+    printf("    cores: %s\n", core_utilization.c_str());
+  return true;
+}
+
+bool ParseCounts(const std::string& list, std::vector<int>* counts) {
+  for (const auto& item : absl::StrSplit(list, ',', absl::SkipEmpty())) {
+    int count = 0;
+    if (!absl::SimpleAtoi(item, &count) || count <= 0)
+      return false;
+    counts->push_back(count);
+  }
+  return !counts->empty();
+}
+
+int Run() {
+  std::vector<int> input_counts;
+  std::vector<int> output_counts;
+  if (!ParseCounts(absl::GetFlag(FLAGS_inputs), &input_counts) ||
+      !ParseCounts(absl::GetFlag(FLAGS_outputs), &output_counts)) {
+    fprintf(stderr, "--inputs and --outputs must list positive counts.\n");
+    return 1;
+  }
+  const std::vector<std::string> threading_modes = absl::StrSplit(
+      absl::GetFlag(FLAGS_threading), ',', absl::SkipEmpty());
+  for (const std::string& threading : threading_modes) {
+    if (!kThreadingModes.count(threading)) {
+      fprintf(stderr, "Unknown threading mode %s.\n", threading.c_str());
+      return 1;
+    }
+  }
+
+  std::string input;
+  if (!benchmark::MakeLongInput(media::ReadTestDataFile(kInputFile),
+                                absl::GetFlag(FLAGS_input_repeats), &input)) {
+    fprintf(stderr, "Unable to synthesize the input from %s.\n", kInputFile);
+    return 1;
+  }
+
+  absl::RegisterMutexProfiler(OnMutexContention);
+  printf("%u hardware threads\n", std::thread::hardware_concurrency());
+
+  int num_failures = 0;
+  for (int num_inputs : input_counts) {
+    for (int num_outputs : output_counts) {
+      for (const std::string& threading : threading_modes) {
+        if (!RunScenario(num_inputs, num_outputs, threading, input))
+          ++num_failures;
+      }
+    }
+  }
+  return num_failures == 0 ? 0 : 1;
+}
+
+}  // namespace
+}  // namespace shaka
+
+int main(int argc, char** argv) {
+  absl::SetProgramUsageMessage(
+      "Concurrency scalability benchmark, over the numbers of inputs and "
+      "outputs and the threading modes.");
+  absl::ParseCommandLine(argc, argv);
+  return shaka::Run();
+}
@@ -0,0 +1,200 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// Startup time benchmark of the packager binary. Each scenario launches the
+// binary on a tiny job, so that the process startup and the initialization of
+// the libraries it uses, rather than the packaging, dominate the time.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#if !defined(OS_WIN)
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#endif  // !defined(OS_WIN)
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/flags/usage.h>
+#include <absl/strings/str_split.h>
+
+#include <packager/media/test/test_data_util.h>
+
+#if !defined(OS_WIN)
+extern char** environ;
+#endif  // !defined(OS_WIN)
+
+ABSL_FLAG(std::string,
+          packager,
+          "packager",
+          "Path of the packager binary to launch.");
+ABSL_FLAG(std::string,
+          scenarios,
+          "version,text_hls,ts_hls,ts_dash",
+          "Comma separated list of the scenarios to run.");
+ABSL_FLAG(uint32_t,
+          runs,
+          20,
+          "The number of times the packager is launched per scenario.");
+
+namespace shaka {
+namespace {
+
+// Builds the arguments of a scenario, which writes its outputs to
+// |output_dir|.
+using ScenarioFunction =
+    std::function<std::vector<std::string>(const std::string& output_dir)>;
+
+std::string TestData(const char* name) {
+  return media::GetTestDataFilePath(name).string();
+}
+
+// Only parses the flags.
+std::vector<std::string> Version(const std::string& /* output_dir */) {
+  return {"--version"};
+}
+
+// WebVTT to HLS, which needs neither libxml2 nor libcurl.
+std::vector<std::string> TextHls(const std::string& output_dir) {
+  return {"in=" + TestData("bear-english.vtt") +
+              ",stream=text,segment_template=" + output_dir +
+              "/text_$Number$.vtt,playlist_name=text.m3u8",
+          "--hls_master_playlist_output", output_dir + "/master.m3u8",
+          "--quiet"};
+}
+
+// MPEG-2 TS to HLS.
+std::vector<std::string> TsHls(const std::string& output_dir) {
+  return {"in=" + TestData("bear-640x360.ts") +
+              ",stream=video,segment_template=" + output_dir +
+              "/video_$Number$.ts,playlist_name=video.m3u8",
+          "--hls_master_playlist_output", output_dir + "/master.m3u8",
+          "--quiet"};
+}
+
+// MPEG-2 TS to DASH, which initializes libxml2 for the manifest.
+std::vector<std::string> TsDash(const std::string& output_dir) {
+  return {"in=" + TestData("bear-640x360.ts") +
+              ",stream=video,init_segment=" + output_dir +
+              "/video_init.mp4,segment_template=" + output_dir +
+              "/video_$Number$.m4s",
+          "--mpd_output", output_dir + "/manifest.mpd", "--quiet"};
+}
+
+const std::map<std::string, ScenarioFunction> kScenarios = {
+    {"version", Version},
+    {"text_hls", TextHls},
+    {"ts_hls", TsHls},
+    {"ts_dash", TsDash},
+};
+
+// Launches the packager with |args|, and waits for it to exit.
+// @return true if it exits successfully.
+bool RunPackager(const std::vector<std::string>& args) {
+#if defined(OS_WIN)
+  fprintf(stderr, "The startup benchmark is not supported on Windows.\n");
+  return false;
+#else
+  const std::string packager = absl::GetFlag(FLAGS_packager);
+  std::vector<char*> argv;
+  argv.push_back(const_cast<char*>(packager.c_str()));
+  for (const std::string& arg : args)
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  argv.push_back(nullptr);
+
+  // The output of the packager is not part of the measurement.
+  posix_spawn_file_actions_t file_actions;
+  posix_spawn_file_actions_init(&file_actions);
+  posix_spawn_file_actions_addopen(&file_actions, 1, "/dev/null", O_WRONLY,
+                                   0);
+  posix_spawn_file_actions_addopen(&file_actions, 2, "/dev/null", O_WRONLY,
+                                   0);
+  pid_t pid = 0;
+  const int error = posix_spawnp(&pid, packager.c_str(), &file_actions,
+                                 nullptr, argv.data(), environ);
+  posix_spawn_file_actions_destroy(&file_actions);
+  if (error != 0) {
+    fprintf(stderr, "Unable to launch %s, error %d.\n", packager.c_str(),
+            error);
+    return false;
+  }
+  int status = 0;
+  if (waitpid(pid, &status, 0) != pid)
+    return false;
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif  // defined(OS_WIN)
+}
+
+bool RunScenario(const std::string& scenario_name,
+                 const std::string& output_dir) {
+  const std::vector<std::string> args =
+      kScenarios.at(scenario_name)(output_dir);
+  const uint32_t runs = std::max(absl::GetFlag(FLAGS_runs), 1u);
+
+  std::vector<double> milliseconds;
+  for (uint32_t i = 0; i < runs; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    if (!RunPackager(args)) {
+      fprintf(stderr, "%s failed.\n", scenario_name.c_str());
+      return false;
+    }
+    milliseconds.push_back(std::chrono::duration<double, std::milli>(
+                               std::chrono::steady_clock::now() - start)
+                               .count());
+  }
+
+  std::sort(milliseconds.begin(), milliseconds.end());
+  double total = 0;
+  for (double value : milliseconds)
+    total += value;
+  printf("%-10s %8.2f ms mean %8.2f ms median %8.2f ms min %8.2f ms max\n",
+         scenario_name.c_str(), total / milliseconds.size(),
+         milliseconds[milliseconds.size() / 2], milliseconds.front(),
+         milliseconds.back());
+  return true;
+}
+
+int Run() {
+  const std::filesystem::path output_dir =
+      std::filesystem::temp_directory_path() / "packager_startup_benchmark";
+  std::error_code ec;
+  std::filesystem::create_directories(output_dir, ec);
+  if (ec) {
+    fprintf(stderr, "Unable to create %s.\n", output_dir.string().c_str());
+    return 1;
+  }
+
+  int num_failures = 0;
+  for (const auto& scenario :
+       absl::StrSplit(absl::GetFlag(FLAGS_scenarios), ',', absl::SkipEmpty())) {
+    const std::string scenario_name(scenario);
+    if (!kScenarios.count(scenario_name)) {
+      fprintf(stderr, "Unknown scenario %s.\n", scenario_name.c_str());
+      return 1;
+    }
+    if (!RunScenario(scenario_name, output_dir.string()))
+      ++num_failures;
+  }
+  std::filesystem::remove_all(output_dir, ec);
+  return num_failures == 0 ? 0 : 1;
+}
+
+}  // namespace
+}  // namespace shaka
+
+int main(int argc, char** argv) {
+  absl::SetProgramUsageMessage(
+      "Startup time benchmark of the packager binary, launched on tiny jobs.");
+  absl::ParseCommandLine(argc, argv);
+  return shaka::Run();
+}
@@ -0,0 +1,266 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/benchmark/synthetic_input.h>
+
+#include <algorithm>
+#include <map>
+
+namespace shaka {
+namespace benchmark {
+namespace {
+
+uint32_t ReadUint32(const uint8_t* data) {
+  return (uint32_t{data[0]} << 24) | (uint32_t{data[1]} << 16) |
+         (uint32_t{data[2]} << 8) | data[3];
+}
+
+uint64_t ReadUint64(const uint8_t* data) {
+  return (uint64_t{ReadUint32(data)} << 32) | ReadUint32(data + 4);
+}
+
+void WriteUint32(uint32_t value, uint8_t* data) {
+  for (int i = 3; i >= 0; --i, value >>= 8)
+    data[i] = static_cast<uint8_t>(value);
+}
+
+void WriteUint64(uint64_t value, uint8_t* data) {
+  WriteUint32(static_cast<uint32_t>(value >> 32), data);
+  WriteUint32(static_cast<uint32_t>(value), data + 4);
+}
+
+uint32_t ToFourCC(const char* type) {
+  return ReadUint32(reinterpret_cast<const uint8_t*>(type));
+}
+
+// An MP4 box in a buffer.
+struct Mp4Box {
+  uint32_t type;
+  size_t offset;
+  size_t size;
+  // Offset of the payload, i.e. past the box header.
+  size_t payload;
+};
+
+// Lists the boxes in [begin, end) of |data|. Returns false if a box does not
+// fit.
+bool ListBoxes(const std::vector<uint8_t>& data,
+               size_t begin,
+               size_t end,
+               std::vector<Mp4Box>* boxes) {
+  boxes->clear();
+  size_t offset = begin;
+  while (offset + 8 <= end) {
+    uint64_t size = ReadUint32(&data[offset]);
+    const uint32_t type = ReadUint32(&data[offset + 4]);
+    size_t header_size = 8;
+    if (size == 1) {
+      if (offset + 16 > end)
+        return false;
+      size = ReadUint64(&data[offset + 8]);
+      header_size = 16;
+    } else if (size == 0) {
+      size = end - offset;
+    }
+    if (size < header_size || size > end - offset)
+      return false;
+    boxes->push_back({type, offset, static_cast<size_t>(size),
+                      offset + header_size});
+    offset += size;
+  }
+  return offset == end;
+}
+
+const Mp4Box* FindBox(const std::vector<Mp4Box>& boxes, const char* type) {
+  for (const Mp4Box& box : boxes) {
+    if (box.type == ToFourCC(type))
+      return &box;
+  }
+  return nullptr;
+}
+
+// A track fragment: where its decode time is and how long it lasts.
+struct TrackFragmentInfo {
+  uint32_t track_id = 0;
+  size_t tfdt_offset = 0;
+  uint64_t decode_time = 0;
+  uint64_t duration = 0;
+};
+
+// Parses the 'traf' boxes of the 'moof' box |moof|. |default_durations| are
+// the default sample durations of 'trex', per track.
+bool ParseMovieFragment(const std::vector<uint8_t>& data,
+                        const Mp4Box& moof,
+                        const std::map<uint32_t, uint32_t>& default_durations,
+                        std::vector<TrackFragmentInfo>* fragments) {
+  std::vector<Mp4Box> moof_children;
+  if (!ListBoxes(data, moof.payload, moof.offset + moof.size, &moof_children))
+    return false;
+  for (const Mp4Box& traf : moof_children) {
+    if (traf.type != ToFourCC("traf"))
+      continue;
+    std::vector<Mp4Box> children;
+    if (!ListBoxes(data, traf.payload, traf.offset + traf.size, &children))
+      return false;
+    const Mp4Box* tfhd = FindBox(children, "tfhd");
+    const Mp4Box* tfdt = FindBox(children, "tfdt");
+    if (!tfhd || !tfdt)
+      return false;
+
+    TrackFragmentInfo fragment;
+    const uint32_t tfhd_flags = ReadUint32(&data[tfhd->payload]) & 0xFFFFFF;
+    fragment.track_id = ReadUint32(&data[tfhd->payload + 4]);
+    size_t position = tfhd->payload + 8;
+    if (tfhd_flags & 0x1)  // base_data_offset
+      position += 8;
+    if (tfhd_flags & 0x2)  // sample_description_index
+      position += 4;
+    uint32_t default_duration = 0;
+    if (tfhd_flags & 0x8) {
+      default_duration = ReadUint32(&data[position]);
+    } else {
+      auto iter = default_durations.find(fragment.track_id);
+      if (iter != default_durations.end())
+        default_duration = iter->second;
+    }
+
+    fragment.tfdt_offset = tfdt->payload;
+    fragment.decode_time = data[tfdt->payload] == 1
+                               ? ReadUint64(&data[tfdt->payload + 4])
+                               : ReadUint32(&data[tfdt->payload + 4]);
+
+    for (const Mp4Box& trun : children) {
+      if (trun.type != ToFourCC("trun"))
+        continue;
+      const uint32_t flags = ReadUint32(&data[trun.payload]) & 0xFFFFFF;
+      const uint32_t sample_count = ReadUint32(&data[trun.payload + 4]);
+      if (!(flags & 0x100)) {
+        fragment.duration += uint64_t{sample_count} * default_duration;
+        continue;
+      }
+      position = trun.payload + 8;
+      if (flags & 0x1)  // data_offset
+        position += 4;
+      if (flags & 0x4)  // first_sample_flags
+        position += 4;
+      for (uint32_t i = 0; i < sample_count; ++i) {
+        fragment.duration += ReadUint32(&data[position]);
+        position += 4;
+        for (uint32_t mask : {0x200, 0x400, 0x800}) {
+          if (flags & mask)
+            position += 4;
+        }
+      }
+    }
+    fragments->push_back(fragment);
+  }
+  return true;
+}
+
+}  // namespace
+
+bool MakeLongInput(const std::vector<uint8_t>& file,
+                   uint32_t repeats,
+                   std::string* input) {
+  std::vector<Mp4Box> boxes;
+  if (!ListBoxes(file, 0, file.size(), &boxes))
+    return false;
+
+  // The default sample durations in moov/mvex/trex.
+  std::map<uint32_t, uint32_t> default_durations;
+  const Mp4Box* moov = FindBox(boxes, "moov");
+  if (!moov)
+    return false;
+  std::vector<Mp4Box> moov_children;
+  if (!ListBoxes(file, moov->payload, moov->offset + moov->size,
+                 &moov_children)) {
+    return false;
+  }
+  if (const Mp4Box* mvex = FindBox(moov_children, "mvex")) {
+    std::vector<Mp4Box> mvex_children;
+    if (!ListBoxes(file, mvex->payload, mvex->offset + mvex->size,
+                   &mvex_children)) {
+      return false;
+    }
+    for (const Mp4Box& trex : mvex_children) {
+      if (trex.type == ToFourCC("trex")) {
+        default_durations[ReadUint32(&file[trex.payload + 4])] =
+            ReadUint32(&file[trex.payload + 12]);
+      }
+    }
+  }
+
+  // The time span of each track, by which each repetition is shifted.
+  std::map<uint32_t, uint64_t> track_start;
+  std::map<uint32_t, uint64_t> track_end;
+  uint32_t num_fragments = 0;
+  for (const Mp4Box& box : boxes) {
+    if (box.type != ToFourCC("moof"))
+      continue;
+    ++num_fragments;
+    std::vector<TrackFragmentInfo> fragments;
+    if (!ParseMovieFragment(file, box, default_durations, &fragments))
+      return false;
+    for (const TrackFragmentInfo& fragment : fragments) {
+      if (!track_start.count(fragment.track_id))
+        track_start[fragment.track_id] = fragment.decode_time;
+      track_end[fragment.track_id] =
+          std::max(track_end[fragment.track_id],
+                   fragment.decode_time + fragment.duration);
+    }
+  }
+  if (num_fragments == 0)
+    return false;
+
+  size_t first_fragment = 0;
+  while (boxes[first_fragment].type != ToFourCC("moof"))
+    ++first_fragment;
+
+  input->clear();
+  for (uint32_t repeat = 0; repeat < repeats; ++repeat) {
+    // The header is only written once.
+    for (size_t i = repeat == 0 ? 0 : first_fragment; i < boxes.size(); ++i) {
+      const Mp4Box& box = boxes[i];
+      if (box.type == ToFourCC("sidx"))
+        continue;
+
+      std::vector<uint8_t> copy(file.begin() + box.offset,
+                                file.begin() + box.offset + box.size);
+      if (box.type == ToFourCC("moof") && repeat > 0) {
+        std::vector<Mp4Box> children;
+        if (!ListBoxes(file, box.payload, box.offset + box.size, &children))
+          return false;
+        if (const Mp4Box* mfhd = FindBox(children, "mfhd")) {
+          uint8_t* sequence_number = &copy[mfhd->payload + 4 - box.offset];
+          WriteUint32(ReadUint32(sequence_number) + repeat * num_fragments,
+                      sequence_number);
+        }
+        std::vector<TrackFragmentInfo> fragments;
+        if (!ParseMovieFragment(file, box, default_durations, &fragments))
+          return false;
+        for (const TrackFragmentInfo& fragment : fragments) {
+          const uint64_t decode_time =
+              fragment.decode_time +
+              repeat * (track_end[fragment.track_id] -
+                        track_start[fragment.track_id]);
+          uint8_t* tfdt = &copy[fragment.tfdt_offset - box.offset];
+          if (tfdt[0] == 1) {
+            WriteUint64(decode_time, tfdt + 4);
+          } else if (decode_time <= UINT32_MAX) {
+            WriteUint32(static_cast<uint32_t>(decode_time), tfdt + 4);
+          } else {
+            return false;
+          }
+        }
+      }
+      input->append(copy.begin(), copy.end());
+    }
+  }
+  return true;
+}
+
+}  // namespace benchmark
+}  // namespace shaka
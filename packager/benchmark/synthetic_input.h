@@ -0,0 +1,28 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_BENCHMARK_SYNTHETIC_INPUT_H_
+#define PACKAGER_BENCHMARK_SYNTHETIC_INPUT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace shaka {
+namespace benchmark {
+
+/// Synthesizes a long fragmented MP4 by repeating the fragments of @a file
+/// @a repeats times, shifting their decode times and sequence numbers. The
+/// 'sidx' boxes are dropped since they would no longer match.
+/// @return false if @a file is not a fragmented MP4 this can repeat.
+bool MakeLongInput(const std::vector<uint8_t>& file,
+                   uint32_t repeats,
+                   std::string* input);
+
+}  // namespace benchmark
+}  // namespace shaka
+
+#endif  // PACKAGER_BENCHMARK_SYNTHETIC_INPUT_H_
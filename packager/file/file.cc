@@ -6,11 +6,19 @@
 
 #include <packager/file.h>
 
+#if !defined(OS_WIN)
+#include <fcntl.h>
+#include <unistd.h>
+#endif  // !defined(OS_WIN)
+
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <cinttypes>
 #include <filesystem>
 #include <memory>
 
+#include <absl/flags/declare.h>
 #include <absl/flags/flag.h>
 #include <absl/log/check.h>
 #include <absl/log/log.h>
@@ -19,13 +27,19 @@
 
 #include <packager/file/callback_file.h>
 #include <packager/file/file_util.h>
+#include <packager/file/http_cache_file.h>
 #include <packager/file/http_file.h>
+#include <packager/file/http_range_file.h>
 #include <packager/file/local_file.h>
+#include <packager/file/mapped_file.h>
 #include <packager/file/memory_file.h>
+#include <packager/file/shm_file.h>
 #include <packager/file/threaded_io_file.h>
 #include <packager/file/udp_file.h>
 #include <packager/macros/compiler.h>
 #include <packager/macros/logging.h>
+#include <packager/utils/resource_quota.h>
+#include <packager/utils/trace.h>
 
 ABSL_FLAG(uint64_t,
           io_cache_size,
@@ -36,6 +50,22 @@ ABSL_FLAG(uint64_t,
           io_block_size,
           1ULL << 16,
           "Size of the block size used for threaded I/O, in bytes.");
+ABSL_FLAG(uint64_t,
+          io_input_block_size,
+          0,
+          "Size of the block size used for threaded I/O of input files, in "
+          "bytes, e.g. larger than --io_block_size to read local inputs in "
+          "fewer calls. Uses --io_block_size if 0.");
+ABSL_FLAG(bool,
+          lock_free_io_cache,
+          false,
+          "Use a lock-free single producer single consumer cache for threaded "
+          "I/O. It avoids taking a lock on every read and write, which helps "
+          "when writing many small boxes.");
+
+ABSL_DECLARE_FLAG(std::string, http_input_cache_dir);
+ABSL_DECLARE_FLAG(int32_t, http_parallel_range_requests);
+ABSL_DECLARE_FLAG(uint64_t, http_range_request_size);
 
 namespace shaka {
 
@@ -45,6 +75,7 @@ const char* kMemoryFilePrefix = "memory://";
 const char* kUdpFilePrefix = "udp://";
 const char* kHttpFilePrefix = "http://";
 const char* kHttpsFilePrefix = "https://";
+const char* kShmFilePrefix = "shm://";
 
 
 namespace {
@@ -73,6 +104,59 @@ bool DeleteLocalFile(const char* file_name) {
   return LocalFile::Delete(file_name);
 }
 
+std::atomic<FileDurability> g_atomic_write_durability{FileDurability::kNone};
+
+#if !defined(OS_WIN)
+// Writes |contents| to a new local file, with plain syscalls rather than
+// through a LocalFile and its caches.
+bool WriteNewLocalFile(const std::string& file_name,
+                       const std::string& contents,
+                       bool sync) {
+  const int fd =
+      open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (fd < 0) {
+    LOG(ERROR) << "Cannot open " << file_name << ", errno " << errno;
+    return false;
+  }
+  const char* data = contents.data();
+  size_t remaining_size = contents.size();
+  bool success = true;
+  while (remaining_size > 0) {
+    const ssize_t bytes_written = write(fd, data, remaining_size);
+    if (bytes_written < 0 && errno == EINTR)
+      continue;
+    if (bytes_written <= 0) {
+      LOG(ERROR) << "Cannot write " << file_name << ", errno " << errno;
+      success = false;
+      break;
+    }
+    data += bytes_written;
+    remaining_size -= bytes_written;
+  }
+  if (success && sync && fsync(fd) != 0) {
+    LOG(ERROR) << "Cannot sync " << file_name << ", errno " << errno;
+    success = false;
+  }
+  if (close(fd) != 0)
+    success = false;
+  return success;
+}
+
+bool SyncDirectory(const std::filesystem::path& dir_path) {
+  const std::string dir_name = dir_path.empty() ? "." : dir_path.string();
+  const int fd = open(dir_name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    LOG(ERROR) << "Cannot open directory " << dir_name << ", errno " << errno;
+    return false;
+  }
+  const bool success = fsync(fd) == 0;
+  if (!success)
+    LOG(ERROR) << "Cannot sync directory " << dir_name << ", errno " << errno;
+  close(fd);
+  return success;
+}
+#endif  // !defined(OS_WIN)
+
 bool WriteLocalFileAtomically(const char* file_name,
                               const std::string& contents) {
   const auto file_path = std::filesystem::u8path(file_name);
@@ -81,10 +165,21 @@ bool WriteLocalFileAtomically(const char* file_name,
   std::string temp_file_name;
   if (!TempFilePath(dir_path.string(), &temp_file_name))
     return false;
+  std::error_code ec;
+#if defined(OS_WIN)
   if (!File::WriteStringToFile(temp_file_name.c_str(), contents))
     return false;
+#else
+  const FileDurability durability = g_atomic_write_durability.load();
+  // Created as LocalFile does when opening a file for writing.
+  if (!dir_path.empty() && !std::filesystem::is_directory(dir_path, ec))
+    std::filesystem::create_directories(dir_path, ec);
+  if (!WriteNewLocalFile(temp_file_name, contents,
+                         durability != FileDurability::kNone)) {
+    return false;
+  }
+#endif  // defined(OS_WIN)
 
-  std::error_code ec;
   auto temp_file_path = std::filesystem::u8path(temp_file_name);
   std::filesystem::rename(temp_file_path, file_name, ec);
   if (ec) {
@@ -92,23 +187,41 @@ bool WriteLocalFileAtomically(const char* file_name,
                << temp_file_name << "', error: " << ec;
     return false;
   }
+#if !defined(OS_WIN)
+  if (durability == FileDurability::kSyncFileAndDirectory)
+    return SyncDirectory(dir_path);
+#endif  // !defined(OS_WIN)
   return true;
 }
 
 File* CreateUdpFile(const char* file_name, const char* mode) {
-  if (strcmp(mode, "r")) {
-    NOTIMPLEMENTED() << "UdpFile only supports read (receive) mode.";
+  if (strcmp(mode, "r") && strcmp(mode, "w")) {
+    NOTIMPLEMENTED() << "UdpFile only supports read (receive) and write (send) "
+                        "modes.";
     return NULL;
   }
-  return new UdpFile(file_name);
+  return new UdpFile(file_name, strcmp(mode, "w") == 0);
 }
 
-File* CreateHttpsFile(const char* file_name, const char* mode) {
-  HttpMethod method = HttpMethod::kGet;
-  if (strcmp(mode, "r") != 0) {
-    method = HttpMethod::kPut;
+File* CreateHttpFileForUrl(const std::string& url, const char* mode) {
+  if (strcmp(mode, "r") != 0)
+    return new HttpFile(HttpMethod::kPut, url);
+  const std::string cache_dir = absl::GetFlag(FLAGS_http_input_cache_dir);
+  if (!cache_dir.empty()) {
+    return new HttpCacheFile(url, cache_dir,
+                             absl::GetFlag(FLAGS_http_parallel_range_requests),
+                             absl::GetFlag(FLAGS_http_range_request_size));
   }
-  return new HttpFile(method, std::string("https://") + file_name);
+  if (absl::GetFlag(FLAGS_http_parallel_range_requests) > 0) {
+    return new HttpRangeFile(url,
+                             absl::GetFlag(FLAGS_http_parallel_range_requests),
+                             absl::GetFlag(FLAGS_http_range_request_size));
+  }
+  return new HttpFile(HttpMethod::kGet, url);
+}
+
+File* CreateHttpsFile(const char* file_name, const char* mode) {
+  return CreateHttpFileForUrl(std::string("https://") + file_name, mode);
 }
 
 bool DeleteHttpsFile(const char* file_name) {
@@ -116,11 +229,7 @@ bool DeleteHttpsFile(const char* file_name) {
 }
 
 File* CreateHttpFile(const char* file_name, const char* mode) {
-  HttpMethod method = HttpMethod::kGet;
-  if (strcmp(mode, "r") != 0) {
-    method = HttpMethod::kPut;
-  }
-  return new HttpFile(method, std::string("http://") + file_name);
+  return CreateHttpFileForUrl(std::string("http://") + file_name, mode);
 }
 
 bool DeleteHttpFile(const char* file_name) {
@@ -136,6 +245,21 @@ bool DeleteMemoryFile(const char* file_name) {
   return true;
 }
 
+File* CreateShmFile(const char* file_name, const char* mode) {
+  return new ShmFile(file_name, mode);
+}
+
+bool DeleteShmFile(const char* file_name) {
+  return ShmFile::Delete(file_name);
+}
+
+// An object is published whole when its file is closed.
+bool WriteShmFileAtomically(const char* file_name,
+                            const std::string& contents) {
+  return File::WriteStringToFile(
+      (std::string(kShmFilePrefix) + file_name).c_str(), contents);
+}
+
 static const FileTypeInfo kFileTypeInfo[] = {
     {
         kLocalFilePrefix,
@@ -146,6 +270,7 @@ static const FileTypeInfo kFileTypeInfo[] = {
     {kUdpFilePrefix, &CreateUdpFile, nullptr, nullptr},
     {kMemoryFilePrefix, &CreateMemoryFile, &DeleteMemoryFile, nullptr},
     {kCallbackFilePrefix, &CreateCallbackFile, nullptr, nullptr},
+    {kShmFilePrefix, &CreateShmFile, &DeleteShmFile, &WriteShmFileAtomically},
     {kHttpFilePrefix, &CreateHttpFile, &DeleteHttpFile, nullptr},
     {kHttpsFilePrefix, &CreateHttpsFile, &DeleteHttpsFile, nullptr},
 };
@@ -177,23 +302,41 @@ File* File::Create(const char* file_name, const char* mode) {
 
   std::string_view file_type_prefix = GetFileTypePrefix(file_name);
   if (file_type_prefix == kMemoryFilePrefix ||
-      file_type_prefix == kCallbackFilePrefix) {
-    // Disable caching for memory and callback files.
+      file_type_prefix == kCallbackFilePrefix ||
+      file_type_prefix == kShmFilePrefix) {
+    // Disable caching for memory, callback and shared memory files, which
+    // are written to memory anyway.
+    return internal_file.release();
+  }
+  if (file_type_prefix == kHttpFilePrefix ||
+      file_type_prefix == kHttpsFilePrefix) {
+    // HttpFile already has its own cache and runs the transfer on its own
+    // thread, and HttpRangeFile and HttpCacheFile download their blocks ahead
+    // of time. Uploads use chunked transfer encoding, so every write, e.g. a
+    // low latency chunk, is sent as soon as it is made. Another threaded cache
+    // would only add a copy and a thread handoff for each write.
     return internal_file.release();
   }
 
   if (absl::GetFlag(FLAGS_io_cache_size)) {
-    // Enable threaded I/O for "r", "w", and "a" modes only.
+    // Enable threaded I/O for "r", "w", and "a" modes only. The cache holds at
+    // least a block, even when the resource quota is short of memory.
     if (!strcmp(mode, "r")) {
-      return new ThreadedIoFile(std::move(internal_file),
-                                ThreadedIoFile::kInputMode,
-                                absl::GetFlag(FLAGS_io_cache_size),
-                                absl::GetFlag(FLAGS_io_block_size));
+      uint64_t block_size = absl::GetFlag(FLAGS_io_input_block_size);
+      if (block_size == 0)
+        block_size = absl::GetFlag(FLAGS_io_block_size);
+      return new ThreadedIoFile(
+          std::move(internal_file), ThreadedIoFile::kInputMode,
+          ResourceQuota::FitIoCache(absl::GetFlag(FLAGS_io_cache_size),
+                                    block_size),
+          block_size, absl::GetFlag(FLAGS_lock_free_io_cache));
     } else if (!strcmp(mode, "w") || !strcmp(mode, "a")) {
-      return new ThreadedIoFile(std::move(internal_file),
-                                ThreadedIoFile::kOutputMode,
-                                absl::GetFlag(FLAGS_io_cache_size),
-                                absl::GetFlag(FLAGS_io_block_size));
+      const uint64_t block_size = absl::GetFlag(FLAGS_io_block_size);
+      return new ThreadedIoFile(
+          std::move(internal_file), ThreadedIoFile::kOutputMode,
+          ResourceQuota::FitIoCache(absl::GetFlag(FLAGS_io_cache_size),
+                                    block_size),
+          block_size, absl::GetFlag(FLAGS_lock_free_io_cache));
     }
   }
 
@@ -211,6 +354,7 @@ File* File::CreateInternalFile(const char* file_name, const char* mode) {
 }
 
 File* File::Open(const char* file_name, const char* mode) {
+  ScopedTraceEvent trace_event("File::Open", file_name);
   File* file = File::Create(file_name, mode);
   if (!file)
     return NULL;
@@ -222,6 +366,7 @@ File* File::Open(const char* file_name, const char* mode) {
 }
 
 File* File::OpenWithNoBuffering(const char* file_name, const char* mode) {
+  ScopedTraceEvent trace_event("File::Open", file_name);
   File* file = File::CreateInternalFile(file_name, mode);
   if (!file)
     return NULL;
@@ -232,6 +377,23 @@ File* File::OpenWithNoBuffering(const char* file_name, const char* mode) {
   return file;
 }
 
+int64_t File::WriteV(const IoBuffer* buffers, size_t num_buffers) {
+  int64_t total_bytes_written = 0;
+  for (size_t i = 0; i < num_buffers; ++i) {
+    const uint8_t* data = static_cast<const uint8_t*>(buffers[i].data);
+    uint64_t remaining_size = buffers[i].size;
+    while (remaining_size > 0) {
+      const int64_t bytes_written = Write(data, remaining_size);
+      if (bytes_written <= 0)
+        return -1;
+      data += bytes_written;
+      remaining_size -= bytes_written;
+      total_bytes_written += bytes_written;
+    }
+  }
+  return total_bytes_written;
+}
+
 bool File::Delete(const char* file_name) {
   static bool logged = false;
   std::string_view real_file_name;
@@ -281,7 +443,10 @@ bool File::ReadFileToString(const char* file_name, std::string* contents) {
 bool File::WriteStringToFile(const char* file_name,
                              const std::string& contents) {
   VLOG(2) << "File::WriteStringToFile: " << file_name;
-  std::unique_ptr<File, FileCloser> file(File::Open(file_name, "w"));
+  // The contents are written in a single call, so threaded I/O would only add
+  // a thread handoff.
+  std::unique_ptr<File, FileCloser> file(
+      File::OpenWithNoBuffering(file_name, "w"));
   if (!file) {
     LOG(ERROR) << "Failed to open file " << file_name;
     return false;
@@ -330,9 +495,22 @@ bool File::WriteFileAtomically(const char* file_name,
   return WriteStringToFile(file_name, contents);
 }
 
+void File::SetAtomicWriteDurability(FileDurability durability) {
+  g_atomic_write_durability = durability;
+}
+
 bool File::Copy(const char* from_file_name, const char* to_file_name) {
   std::string content;
   VLOG(2) << "File::Copy from " << from_file_name << " to " << to_file_name;
+
+  const std::string_view to_file_type = GetFileTypePrefix(to_file_name);
+  if (to_file_type == kHttpFilePrefix || to_file_type == kHttpsFilePrefix) {
+    // Upload a local file straight from its memory mapping, without copying
+    // it through memory and the upload cache first.
+    std::unique_ptr<MappedFile> source = MappedFile::Open(from_file_name);
+    if (source)
+      return HttpFile::UploadMappedFile(std::move(source), to_file_name).ok();
+  }
   if (!ReadFileToString(from_file_name, &content)) {
     LOG(ERROR) << "Failed to open file " << from_file_name;
     return false;
@@ -0,0 +1,142 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/file_reaper.h>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <absl/log/log.h>
+#include <absl/synchronization/blocking_counter.h>
+
+#include <packager/file.h>
+#include <packager/file/thread_pool.h>
+#include <packager/macros/logging.h>
+
+namespace shaka {
+namespace {
+
+// The most files deleted concurrently.
+const size_t kMaxBatchSize = 16;
+const absl::Duration kInitialRetryDelay = absl::Seconds(1);
+const absl::Duration kMaxRetryDelay = absl::Minutes(1);
+
+absl::Duration GetRetryDelay(int attempts) {
+  absl::Duration delay = kInitialRetryDelay;
+  for (int i = 1; i < attempts && delay < kMaxRetryDelay; ++i)
+    delay *= 2;
+  return std::min(delay, kMaxRetryDelay);
+}
+
+}  // namespace
+
+// static
+FileReaper* FileReaper::GetInstance() {
+  static FileReaper* const instance = new FileReaper;
+  return instance;
+}
+
+FileReaper::FileReaper() {
+  // The reaper lives as long as the process.
+  std::thread(&FileReaper::ThreadMain, this).detach();
+}
+
+void FileReaper::Delete(const std::string& file_name) {
+  absl::MutexLock lock(&mutex_);
+  PendingFile file;
+  file.file_name = file_name;
+  queued_files_.push_back(std::move(file));
+  changed_.SignalAll();
+}
+
+void FileReaper::Flush() {
+  absl::MutexLock lock(&mutex_);
+  ++num_flushes_;
+  changed_.SignalAll();
+  while (!queued_files_.empty() || !failed_files_.empty() ||
+         num_files_in_flight_ > 0) {
+    changed_.Wait(&mutex_);
+  }
+  --num_flushes_;
+}
+
+void FileReaper::ThreadMain() {
+  while (true) {
+    std::vector<PendingFile> batch;
+    {
+      absl::MutexLock lock(&mutex_);
+      while (queued_files_.empty()) {
+        if (failed_files_.empty()) {
+          changed_.Wait(&mutex_);
+          continue;
+        }
+        if (num_flushes_ > 0 ||
+            failed_files_.front().retry_time <= absl::Now()) {
+          break;
+        }
+        changed_.WaitWithDeadline(&mutex_, failed_files_.front().retry_time);
+      }
+      const absl::Time now = absl::Now();
+      while (batch.size() < kMaxBatchSize && !queued_files_.empty()) {
+        batch.push_back(std::move(queued_files_.front()));
+        queued_files_.pop_front();
+      }
+      while (batch.size() < kMaxBatchSize && !failed_files_.empty() &&
+             (num_flushes_ > 0 || failed_files_.front().retry_time <= now)) {
+        batch.push_back(std::move(failed_files_.front()));
+        failed_files_.pop_front();
+      }
+      num_files_in_flight_ = batch.size();
+    }
+
+    for (const PendingFile& file : batch)
+      VLOG(2) << "Deleting " << file.file_name;
+    std::unique_ptr<bool[]> deleted(new bool[batch.size()]);
+    if (batch.size() == 1) {
+      deleted[0] = File::Delete(batch[0].file_name.c_str());
+    } else {
+      absl::BlockingCounter done(static_cast<int>(batch.size()));
+      for (size_t i = 0; i < batch.size(); ++i) {
+        ThreadPool::instance.PostTask([&batch, &deleted, &done, i]() {
+          deleted[i] = File::Delete(batch[i].file_name.c_str());
+          done.DecrementCount();
+        });
+      }
+      done.Wait();
+    }
+
+    absl::MutexLock lock(&mutex_);
+    const absl::Time now = absl::Now();
+    for (size_t i = 0; i < batch.size(); ++i) {
+      if (deleted[i])
+        continue;
+      PendingFile& file = batch[i];
+      ++file.attempts;
+      // The process is shutting down and the file may have been retried
+      // already.
+      if (num_flushes_ > 0 && file.attempts > 1) {
+        LOG(ERROR) << "Failed to delete " << file.file_name << " after "
+                   << file.attempts << " attempts.";
+        continue;
+      }
+      LOG(WARNING) << "Failed to delete " << file.file_name
+                   << "; Will retry later.";
+      file.retry_time = now + GetRetryDelay(file.attempts);
+      failed_files_.push_back(std::move(file));
+    }
+    // The retry delays differ, so keep the failed files ordered.
+    std::stable_sort(failed_files_.begin(), failed_files_.end(),
+                     [](const PendingFile& a, const PendingFile& b) {
+                       return a.retry_time < b.retry_time;
+                     });
+    num_files_in_flight_ = 0;
+    changed_.SignalAll();
+  }
+}
+
+}  // namespace shaka
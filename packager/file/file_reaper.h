@@ -0,0 +1,66 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_FILE_REAPER_H_
+#define PACKAGER_FILE_FILE_REAPER_H_
+
+#include <cstddef>
+#include <deque>
+#include <string>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/time/time.h>
+
+#include <packager/macros/classes.h>
+
+namespace shaka {
+
+/// Deletes files in the background, e.g. the live segments which have left
+/// the manifests, so that a slow deletion, e.g. an HTTP DELETE, does not
+/// delay the manifest updates. The queued files are deleted in batches, the
+/// files of a batch concurrently, and a failed deletion is retried, with a
+/// growing delay, until Flush() is called at shutdown.
+class FileReaper {
+ public:
+  static FileReaper* GetInstance();
+
+  /// Queues a file for deletion.
+  /// @param file_name is the name of the file, as for File::Delete().
+  void Delete(const std::string& file_name);
+
+  /// Blocks until the files queued so far are deleted. The files whose
+  /// deletion failed are retried once more right away, and given up on if
+  /// they fail again.
+  void Flush();
+
+ private:
+  struct PendingFile {
+    std::string file_name;
+    int attempts = 0;
+    // When a failed deletion may be retried.
+    absl::Time retry_time;
+  };
+
+  FileReaper();
+
+  void ThreadMain();
+
+  absl::Mutex mutex_;
+  absl::CondVar changed_ ABSL_GUARDED_BY(mutex_);
+  std::deque<PendingFile> queued_files_ ABSL_GUARDED_BY(mutex_);
+  // Ordered by retry time.
+  std::deque<PendingFile> failed_files_ ABSL_GUARDED_BY(mutex_);
+  size_t num_files_in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+  // The number of Flush() calls in progress.
+  int num_flushes_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(FileReaper);
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_FILE_REAPER_H_
@@ -0,0 +1,55 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/file_reaper.h>
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <packager/file.h>
+#include <packager/file/file_closer.h>
+
+namespace shaka {
+namespace {
+
+bool FileExists(const std::string& file_name) {
+  std::unique_ptr<File, FileCloser> file(File::Open(file_name.c_str(), "r"));
+  return file != nullptr;
+}
+
+}  // namespace
+
+TEST(FileReaperTest, DeletesFiles) {
+  const int kNumFiles = 40;
+  for (int i = 0; i < kNumFiles; ++i) {
+    const std::string file_name = "memory://reaper/" + std::to_string(i);
+    ASSERT_TRUE(File::WriteStringToFile(file_name.c_str(), "segment"));
+  }
+
+  // More files than are deleted in a batch.
+  for (int i = 1; i < kNumFiles; ++i)
+    FileReaper::GetInstance()->Delete("memory://reaper/" + std::to_string(i));
+  FileReaper::GetInstance()->Flush();
+
+  EXPECT_TRUE(FileExists("memory://reaper/0"));
+  for (int i = 1; i < kNumFiles; ++i)
+    EXPECT_FALSE(FileExists("memory://reaper/" + std::to_string(i)));
+}
+
+TEST(FileReaperTest, FlushGivesUpOnFailedDeletions) {
+  ASSERT_TRUE(File::WriteStringToFile("memory://reaper/kept", "segment"));
+
+  // Does not exist, so the deletion keeps failing.
+  FileReaper::GetInstance()->Delete("/reaper_missing_dir/segment");
+  FileReaper::GetInstance()->Delete("memory://reaper/kept");
+  FileReaper::GetInstance()->Flush();
+
+  EXPECT_FALSE(FileExists("memory://reaper/kept"));
+}
+
+}  // namespace shaka
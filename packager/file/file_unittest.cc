@@ -6,13 +6,17 @@
 
 #include <packager/file.h>
 
+#include <chrono>
 #include <cstdio>
 #include <filesystem>
 #include <locale>
+#include <thread>
+#include <vector>
 
 #include <absl/flags/declare.h>
 #include <gtest/gtest.h>
 
+#include <packager/file/file_closer.h>
 #include <packager/file/file_test_util.h>
 #include <packager/flag_saver.h>
 
@@ -157,6 +161,24 @@ TEST_F(LocalFileTest, Write) {
   EXPECT_EQ(data_, read_data);
 }
 
+TEST_F(LocalFileTest, WriteV) {
+  File* file = File::Open(local_file_name_.c_str(), "w");
+  ASSERT_TRUE(file != NULL);
+  // Goes through the stdio buffer, ahead of the blocks.
+  EXPECT_EQ(10, file->Write(&data_[0], 10));
+  const File::IoBuffer buffers[] = {
+      {&data_[10], 100}, {&data_[110], 0}, {&data_[110], kDataSize - 120}};
+  EXPECT_EQ(kDataSize - 20, file->WriteV(buffers, 3));
+  EXPECT_EQ(10, file->Write(&data_[kDataSize - 10], 10));
+  EXPECT_TRUE(file->Close());
+
+  std::string read_data;
+  ASSERT_EQ(kDataSize, FileSize(local_file_name_no_prefix_));
+  ASSERT_EQ(kDataSize,
+            ReadFile(local_file_name_no_prefix_, &read_data, kDataSize));
+  EXPECT_EQ(data_, read_data);
+}
+
 TEST_F(LocalFileTest, Read_And_Eof) {
   WriteFile(local_file_name_no_prefix_, data_);
 
@@ -222,6 +244,18 @@ TEST_F(LocalFileTest, AtomicWriteRead) {
   EXPECT_EQ(data_, read_data);
 }
 
+TEST_F(LocalFileTest, DurableAtomicWriteRead) {
+  File::SetAtomicWriteDurability(FileDurability::kSyncFileAndDirectory);
+  const bool written =
+      File::WriteFileAtomically(local_file_name_no_prefix_.c_str(), data_);
+  File::SetAtomicWriteDurability(FileDurability::kNone);
+  ASSERT_TRUE(written);
+  std::string read_data;
+  ASSERT_TRUE(
+      File::ReadFileToString(local_file_name_no_prefix_.c_str(), &read_data));
+  EXPECT_EQ(data_, read_data);
+}
+
 TEST_F(LocalFileTest, WriteFlushCheckSize) {
   const uint32_t kNumCycles(10);
   const uint32_t kNumWrites(10);
@@ -392,4 +426,21 @@ TEST(FileTest, ParseCallbackFileNameFailed) {
   ASSERT_FALSE(File::ParseCallbackFileName("abc/some name", &params, &name));
 }
 
+TEST(FileTest, AbortUnblocksUdpRead) {
+  // Port 0 binds to any free port. No datagram is ever received.
+  std::unique_ptr<File, FileCloser> file(
+      File::Open("udp://127.0.0.1:0", "r"));
+  ASSERT_TRUE(file);
+
+  std::thread abort_thread([&file]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    file->Abort();
+  });
+  std::vector<uint8_t> buffer(65536);
+  EXPECT_LT(file->Read(buffer.data(), buffer.size()), 0);
+  abort_thread.join();
+  // Later reads fail too.
+  EXPECT_LT(file->Read(buffer.data(), buffer.size()), 0);
+}
+
 }  // namespace shaka
@@ -0,0 +1,120 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/file_uploader.h>
+
+#include <algorithm>
+
+#include <absl/flags/flag.h>
+#include <absl/log/log.h>
+
+#include <packager/file.h>
+#include <packager/file/file_closer.h>
+#include <packager/file/thread_pool.h>
+#include <packager/macros/logging.h>
+
+ABSL_FLAG(int32_t,
+          max_uploads_per_host,
+          4,
+          "The most files written concurrently to a host by background "
+          "uploads, e.g. with --mp4_async_segment_uploads. Local files count "
+          "as a single host.");
+
+namespace shaka {
+namespace {
+
+// @return the host of |file_name|, e.g. "example.com:8080" for
+//         "https://example.com:8080/live/1.m4s", or an empty string for a
+//         local file.
+std::string GetHost(const std::string& file_name) {
+  const size_t scheme_end = file_name.find("://");
+  if (scheme_end == std::string::npos)
+    return std::string();
+  const size_t host_begin = scheme_end + 3;
+  const size_t host_end = file_name.find('/', host_begin);
+  return file_name.substr(host_begin, host_end == std::string::npos
+                                          ? std::string::npos
+                                          : host_end - host_begin);
+}
+
+Status WriteFile(const std::string& file_name,
+                 const std::vector<uint8_t>& data) {
+  std::unique_ptr<File, FileCloser> file(
+      File::OpenWithNoBuffering(file_name.c_str(), "w"));
+  if (!file) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot open file for write " + file_name);
+  }
+  size_t bytes_written = 0;
+  while (bytes_written < data.size()) {
+    const int64_t result = file->Write(data.data() + bytes_written,
+                                       data.size() - bytes_written);
+    if (result <= 0) {
+      return Status(error::FILE_FAILURE,
+                    "Cannot write to file " + file_name);
+    }
+    bytes_written += static_cast<size_t>(result);
+  }
+  if (!file.release()->Close())
+    return Status(error::FILE_FAILURE, "Cannot close file " + file_name);
+  return Status::OK;
+}
+
+}  // namespace
+
+Status FileUploader::Upload::Wait() {
+  done_.WaitForNotification();
+  return status_;
+}
+
+// static
+FileUploader* FileUploader::GetInstance() {
+  static FileUploader* const instance = new FileUploader;
+  return instance;
+}
+
+std::shared_ptr<FileUploader::Upload> FileUploader::Write(
+    const std::string& file_name,
+    std::vector<uint8_t> data) {
+  auto upload = std::make_shared<Upload>();
+  upload->file_name_ = file_name;
+  upload->data_ = std::move(data);
+
+  absl::MutexLock lock(&mutex_);
+  Host* host = &hosts_[GetHost(file_name)];
+  host->queued_uploads.push_back(upload);
+  StartUploads(host);
+  return upload;
+}
+
+void FileUploader::StartUploads(Host* host) {
+  const size_t max_uploads = static_cast<size_t>(
+      std::max(absl::GetFlag(FLAGS_max_uploads_per_host), 1));
+  while (host->num_uploads_in_flight < max_uploads &&
+         !host->queued_uploads.empty()) {
+    std::shared_ptr<Upload> upload = std::move(host->queued_uploads.front());
+    host->queued_uploads.pop_front();
+    ++host->num_uploads_in_flight;
+    ThreadPool::instance.PostTask(
+        [this, host, upload]() { RunUpload(host, upload); });
+  }
+}
+
+void FileUploader::RunUpload(Host* host, std::shared_ptr<Upload> upload) {
+  VLOG(2) << "Uploading " << upload->file_name_;
+  upload->status_ = WriteFile(upload->file_name_, upload->data_);
+  // The data is no longer needed, though the upload may be held for a while.
+  std::vector<uint8_t>().swap(upload->data_);
+
+  {
+    absl::MutexLock lock(&mutex_);
+    --host->num_uploads_in_flight;
+    StartUploads(host);
+  }
+  upload->done_.Notify();
+}
+
+}  // namespace shaka
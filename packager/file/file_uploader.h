@@ -0,0 +1,88 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_FILE_UPLOADER_H_
+#define PACKAGER_FILE_FILE_UPLOADER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/synchronization/notification.h>
+
+#include <packager/macros/classes.h>
+#include <packager/status.h>
+
+namespace shaka {
+
+/// Writes files in the background, e.g. the live segments of the outputs, so
+/// that a slow upload, e.g. an HTTP PUT, does not hold up the muxer which
+/// produced the file. Files on the same host are written at most
+/// --max_uploads_per_host at a time; the others wait in order. Local files
+/// count as a single host.
+class FileUploader {
+ public:
+  /// The background write of a file.
+  class Upload {
+   public:
+    Upload() = default;
+
+    /// @return true if the file is written or failed to be written.
+    bool done() const { return done_.HasBeenNotified(); }
+
+    /// Blocks until the file is written or failed to be written.
+    /// @return OK if the file is written.
+    Status Wait();
+
+   private:
+    friend class FileUploader;
+
+    std::string file_name_;
+    std::vector<uint8_t> data_;
+    Status status_;
+    absl::Notification done_;
+
+    DISALLOW_COPY_AND_ASSIGN(Upload);
+  };
+
+  static FileUploader* GetInstance();
+
+  /// Queues @a data to be written to @a file_name, replacing the file.
+  /// @param file_name is the name of the file, as for File::Open().
+  /// @param data is the content of the file, owned by the upload.
+  /// @return the upload, which may be waited on.
+  std::shared_ptr<Upload> Write(const std::string& file_name,
+                                std::vector<uint8_t> data);
+
+ private:
+  struct Host {
+    size_t num_uploads_in_flight = 0;
+    std::deque<std::shared_ptr<Upload>> queued_uploads;
+  };
+
+  FileUploader() = default;
+
+  // Starts the queued uploads of |host| while under its limit.
+  void StartUploads(Host* host) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void RunUpload(Host* host, std::shared_ptr<Upload> upload);
+
+  absl::Mutex mutex_;
+  // Keyed by host name. The hosts are never removed, as the outputs of a
+  // process are on a few hosts.
+  std::map<std::string, Host> hosts_ ABSL_GUARDED_BY(mutex_);
+
+  DISALLOW_COPY_AND_ASSIGN(FileUploader);
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_FILE_UPLOADER_H_
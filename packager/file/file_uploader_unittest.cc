@@ -0,0 +1,48 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/file_uploader.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <packager/file.h>
+
+namespace shaka {
+
+TEST(FileUploaderTest, WritesFiles) {
+  const int kNumFiles = 20;
+  std::vector<std::shared_ptr<FileUploader::Upload>> uploads;
+  for (int i = 0; i < kNumFiles; ++i) {
+    const std::string content = "segment " + std::to_string(i);
+    uploads.push_back(FileUploader::GetInstance()->Write(
+        "memory://uploader/" + std::to_string(i),
+        std::vector<uint8_t>(content.begin(), content.end())));
+  }
+
+  for (int i = 0; i < kNumFiles; ++i) {
+    ASSERT_TRUE(uploads[i]->Wait().ok());
+    EXPECT_TRUE(uploads[i]->done());
+    std::string content;
+    ASSERT_TRUE(File::ReadFileToString(
+        ("memory://uploader/" + std::to_string(i)).c_str(), &content));
+    EXPECT_EQ("segment " + std::to_string(i), content);
+  }
+}
+
+TEST(FileUploaderTest, WritesEmptyFile) {
+  auto upload = FileUploader::GetInstance()->Write("memory://uploader/empty",
+                                                   std::vector<uint8_t>());
+  ASSERT_TRUE(upload->Wait().ok());
+  std::string content;
+  ASSERT_TRUE(File::ReadFileToString("memory://uploader/empty", &content));
+  EXPECT_TRUE(content.empty());
+}
+
+}  // namespace shaka
@@ -9,13 +9,29 @@
 #if defined(OS_WIN)
 #include <windows.h>
 #else
+#include <fcntl.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif
 
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <filesystem>
+#include <limits>
 #include <thread>
 
+#include <absl/log/log.h>
+#include <absl/strings/match.h>
 #include <absl/strings/str_format.h>
+#include <zlib.h>
+
+#include <packager/file.h>
+#include <packager/macros/logging.h>
 
 namespace shaka {
 namespace {
@@ -38,6 +54,47 @@ std::string TempFileName() {
   return absl::StrFormat("packager-tempfile-%x-%zx-%x", process_id, thread_id,
                          instance_id);
 }
+
+// Returns the path of |file_name| on the local file system, or an empty string
+// if |file_name| does not refer to a local file.
+std::string LocalFilePath(const std::string& file_name) {
+  if (absl::StartsWith(file_name, kLocalFilePrefix))
+    return file_name.substr(strlen(kLocalFilePrefix));
+  if (file_name.find("://") != std::string::npos)
+    return "";
+  return file_name;
+}
+
+#if defined(__linux__)
+// Closes the file descriptor on destruction.
+class ScopedFd {
+ public:
+  explicit ScopedFd(int fd) : fd_(fd) {}
+  ~ScopedFd() {
+    if (fd_ >= 0)
+      close(fd_);
+  }
+  int get() const { return fd_; }
+  int release() {
+    const int fd = fd_;
+    fd_ = -1;
+    return fd;
+  }
+
+ private:
+  ScopedFd(const ScopedFd&) = delete;
+  ScopedFd& operator=(const ScopedFd&) = delete;
+
+  int fd_;
+};
+
+// Errors indicating that the kernel cannot copy between the two files, as
+// opposed to an I/O failure.
+bool IsCopyUnsupported(int error) {
+  return error == ENOSYS || error == EXDEV || error == EINVAL ||
+         error == EOPNOTSUPP;
+}
+#endif  // defined(__linux__)
 }  // namespace
 
 bool TempFilePath(const std::string& temp_dir, std::string* temp_file_path) {
@@ -53,6 +110,132 @@ bool TempFilePath(const std::string& temp_dir, std::string* temp_file_path) {
   return true;
 }
 
+Status AppendLocalFileInKernel(
+    const std::string& from_file_name,
+    const std::string& to_file_name,
+    const std::function<void(uint64_t chunk_size, uint64_t file_size)>&
+        progress_callback) {
+#if defined(__linux__)
+  const std::string from_path = LocalFilePath(from_file_name);
+  const std::string to_path = LocalFilePath(to_file_name);
+  if (from_path.empty() || to_path.empty())
+    return Status(error::UNIMPLEMENTED, "Not a local file.");
+
+  ScopedFd from_fd(open(from_path.c_str(), O_RDONLY | O_CLOEXEC));
+  if (from_fd.get() < 0) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot open file to read " + from_file_name);
+  }
+  // Not O_APPEND: copy_file_range rejects append-only destinations, so the
+  // destination offset is tracked explicitly instead.
+  ScopedFd to_fd(open(to_path.c_str(), O_WRONLY | O_CLOEXEC));
+  if (to_fd.get() < 0) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot open file to write " + to_file_name);
+  }
+
+  struct stat from_stat;
+  if (fstat(from_fd.get(), &from_stat) != 0 || !S_ISREG(from_stat.st_mode))
+    return Status(error::UNIMPLEMENTED, "Not a regular file.");
+  const uint64_t file_size = static_cast<uint64_t>(from_stat.st_size);
+
+  const off_t to_offset = lseek(to_fd.get(), 0, SEEK_END);
+  if (to_offset < 0)
+    return Status(error::UNIMPLEMENTED, "Destination is not seekable.");
+
+  // Large enough to amortize the syscalls, small enough to report progress.
+  const size_t kChunkSize = 0x4000000;  // 64MB.
+  off_t in_offset = 0;
+  off_t out_offset = to_offset;
+  bool use_sendfile = false;
+  uint64_t bytes_copied = 0;
+  while (bytes_copied < file_size) {
+    const size_t size = static_cast<size_t>(
+        std::min<uint64_t>(kChunkSize, file_size - bytes_copied));
+    ssize_t result;
+    if (!use_sendfile) {
+      result = copy_file_range(from_fd.get(), &in_offset, to_fd.get(),
+                               &out_offset, size, 0);
+      if (result < 0 && bytes_copied == 0 && IsCopyUnsupported(errno)) {
+        VLOG(1) << "copy_file_range is not supported from " << from_file_name
+                << " to " << to_file_name << ", trying sendfile.";
+        use_sendfile = true;
+        continue;
+      }
+    } else {
+      // sendfile writes at the current file offset of the destination, which
+      // has been moved to the end of the file above.
+      result = sendfile(to_fd.get(), from_fd.get(), &in_offset, size);
+      if (result < 0 && bytes_copied == 0 && IsCopyUnsupported(errno)) {
+        return Status(error::UNIMPLEMENTED,
+                      "In-kernel copy is not supported.");
+      }
+    }
+    if (result < 0) {
+      if (errno == EINTR)
+        continue;
+      return Status(error::FILE_FAILURE,
+                    absl::StrFormat("Failed to copy %s to %s: %s",
+                                    from_file_name, to_file_name,
+                                    strerror(errno)));
+    }
+    if (result == 0) {
+      return Status(error::FILE_FAILURE,
+                    "Unexpected end of file " + from_file_name);
+    }
+    bytes_copied += result;
+    if (progress_callback)
+      progress_callback(result, file_size);
+  }
+
+  if (close(to_fd.release()) != 0) {
+    return Status(
+        error::FILE_FAILURE,
+        "Cannot close file " + to_file_name +
+            ", possibly file permission issue or running out of disk space.");
+  }
+  return Status::OK;
+#else
+  return Status(error::UNIMPLEMENTED,
+                "In-kernel copy is not supported on this platform.");
+#endif  // defined(__linux__)
+}
+
+bool WriteGzipFileAtomically(const std::string& file_name,
+                             const std::string& contents) {
+  if (contents.size() > std::numeric_limits<uInt>::max()) {
+    LOG(ERROR) << "Too large to compress " << file_name;
+    return false;
+  }
+
+  z_stream stream = {};
+  // 16 is added to the window bits to write a gzip header and trailer.
+  const int kGzipWindowBits = 15 + 16;
+  const int kMemoryLevel = 8;
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, kGzipWindowBits,
+                   kMemoryLevel, Z_DEFAULT_STRATEGY) != Z_OK) {
+    LOG(ERROR) << "Failed to initialize gzip compression for " << file_name;
+    return false;
+  }
+  // Compressed in a single pass into a buffer large enough for the output.
+  std::string compressed(
+      deflateBound(&stream, static_cast<uLong>(contents.size())), '\0');
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(contents.data()));
+  stream.avail_in = static_cast<uInt>(contents.size());
+  stream.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+  stream.avail_out = static_cast<uInt>(compressed.size());
+  const int result = deflate(&stream, Z_FINISH);
+  const size_t compressed_size = stream.total_out;
+  deflateEnd(&stream);
+  if (result != Z_STREAM_END) {
+    LOG(ERROR) << "Failed to compress " << file_name << ": " << result;
+    return false;
+  }
+  compressed.resize(compressed_size);
+  return File::WriteFileAtomically(file_name.c_str(), compressed);
+}
+
 std::string MakePathRelative(const std::filesystem::path& media_path,
                              const std::filesystem::path& parent_path) {
   auto relative_path = std::filesystem::relative(media_path, parent_path);
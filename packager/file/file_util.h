@@ -4,9 +4,13 @@
 // license that can be found in the LICENSE file or at
 // https://developers.google.com/open-source/licenses/bsd
 
+#include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <string>
 
+#include <packager/status.h>
+
 namespace shaka {
 
 /// Create a temp file name in directory @a temp_dir. Generate the temp file
@@ -16,6 +20,28 @@ namespace shaka {
 /// @returns true on success, false otherwise.
 bool TempFilePath(const std::string& temp_dir, std::string* temp_file_path);
 
+/// Append the content of local file @a from_file_name to the end of local file
+/// @a to_file_name with an in-kernel copy, i.e. copy_file_range or sendfile,
+/// so the data does not make a round trip through a userspace buffer.
+/// @param progress_callback, if not null, is called after each chunk that is
+///        copied with the size of the chunk and the size of @a from_file_name.
+/// @returns error::UNIMPLEMENTED if either file is not a local file or the
+///          in-kernel copy is not supported for the two files, in which case
+///          @a to_file_name is left untouched and the caller should fall back
+///          to a regular copy.
+Status AppendLocalFileInKernel(
+    const std::string& from_file_name,
+    const std::string& to_file_name,
+    const std::function<void(uint64_t chunk_size, uint64_t file_size)>&
+        progress_callback);
+
+/// Compresses @a contents with gzip and writes the result to @a file_name
+/// with File::WriteFileAtomically(), e.g. to write a precompressed variant of
+/// a manifest next to it.
+/// @returns true on success, false otherwise.
+bool WriteGzipFileAtomically(const std::string& file_name,
+                             const std::string& contents);
+
 std::string MakePathRelative(const std::filesystem::path& media_path,
                              const std::filesystem::path& parent_path);
 
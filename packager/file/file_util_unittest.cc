@@ -8,6 +8,9 @@
 
 #include <absl/log/log.h>
 #include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <packager/file.h>
 
 namespace shaka {
 
@@ -36,4 +39,76 @@ TEST(FileUtilTest, TempFilePathCalledTwice) {
   LOG(INFO) << "temp file path2: " << temp_file_path2;
 }
 
+TEST(FileUtilTest, AppendLocalFileInKernel) {
+  std::string from_file_name;
+  std::string to_file_name;
+  ASSERT_TRUE(TempFilePath("", &from_file_name));
+  ASSERT_TRUE(TempFilePath("", &to_file_name));
+
+  const std::string kHeader = "header";
+  const std::string kContent(0x12345, 'x');
+  ASSERT_TRUE(File::WriteStringToFile(from_file_name.c_str(), kContent));
+  ASSERT_TRUE(File::WriteStringToFile(to_file_name.c_str(), kHeader));
+
+  uint64_t bytes_reported = 0;
+  Status status = AppendLocalFileInKernel(
+      from_file_name, to_file_name,
+      [&bytes_reported](uint64_t chunk_size, uint64_t file_size) {
+        EXPECT_EQ(0x12345u, file_size);
+        bytes_reported += chunk_size;
+      });
+  if (status.error_code() == error::UNIMPLEMENTED) {
+    // The in-kernel copy is not available here; the destination must be left
+    // untouched so that the caller can fall back.
+    std::string contents;
+    ASSERT_TRUE(File::ReadFileToString(to_file_name.c_str(), &contents));
+    EXPECT_EQ(kHeader, contents);
+  } else {
+    ASSERT_TRUE(status.ok()) << status;
+    EXPECT_EQ(kContent.size(), bytes_reported);
+    std::string contents;
+    ASSERT_TRUE(File::ReadFileToString(to_file_name.c_str(), &contents));
+    EXPECT_EQ(kHeader + kContent, contents);
+  }
+
+  File::Delete(from_file_name.c_str());
+  File::Delete(to_file_name.c_str());
+}
+
+TEST(FileUtilTest, AppendLocalFileInKernelRejectsNonLocalFiles) {
+  std::string to_file_name;
+  ASSERT_TRUE(TempFilePath("", &to_file_name));
+  EXPECT_EQ(error::UNIMPLEMENTED,
+            AppendLocalFileInKernel("memory://file", to_file_name, nullptr)
+                .error_code());
+}
+
+TEST(FileUtilTest, WriteGzipFileAtomically) {
+  std::string contents;
+  for (int i = 0; i < 1000; ++i)
+    contents += "#EXTINF:2.000,\nsegment_" + std::to_string(i) + ".ts\n";
+  ASSERT_TRUE(WriteGzipFileAtomically("memory://file.m3u8.gz", contents));
+
+  std::string compressed;
+  ASSERT_TRUE(File::ReadFileToString("memory://file.m3u8.gz", &compressed));
+  EXPECT_LT(compressed.size(), contents.size() / 5);
+  // The gzip magic number.
+  ASSERT_GT(compressed.size(), 2u);
+  EXPECT_EQ('\x1f', compressed[0]);
+  EXPECT_EQ('\x8b', compressed[1]);
+
+  z_stream stream = {};
+  // 16 is added to the window bits to read a gzip header and trailer.
+  ASSERT_EQ(Z_OK, inflateInit2(&stream, 15 + 16));
+  std::string decompressed(contents.size(), '\0');
+  stream.next_in = reinterpret_cast<Bytef*>(&compressed[0]);
+  stream.avail_in = static_cast<uInt>(compressed.size());
+  stream.next_out = reinterpret_cast<Bytef*>(&decompressed[0]);
+  stream.avail_out = static_cast<uInt>(decompressed.size());
+  EXPECT_EQ(Z_STREAM_END, inflate(&stream, Z_FINISH));
+  EXPECT_EQ(contents.size(), stream.total_out);
+  inflateEnd(&stream);
+  EXPECT_EQ(contents, decompressed);
+}
+
 }  // namespace shaka
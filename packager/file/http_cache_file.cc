@@ -0,0 +1,275 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/http_cache_file.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#include <absl/flags/flag.h>
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <absl/strings/escaping.h>
+#include <absl/strings/str_format.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/synchronization/notification.h>
+#include <mbedtls/md.h>
+
+#include <packager/file/file_closer.h>
+#include <packager/file/http_file.h>
+#include <packager/file/http_range_file.h>
+#include <packager/file/thread_pool.h>
+#include <packager/macros/compiler.h>
+#include <packager/macros/logging.h>
+#include <packager/utils/metrics.h>
+
+ABSL_FLAG(std::string,
+          http_input_cache_dir,
+          "",
+          "If set, http(s) inputs are read with byte range requests of "
+          "--http_range_request_size bytes through a local disk cache in this "
+          "directory, keyed by the URL and ETag of the inputs, so that the "
+          "jobs reading the same input download it only once. Up to "
+          "--http_parallel_range_requests requests, at least one, run ahead "
+          "of the read position. The server has to support range requests. "
+          "The cache is never pruned by the packager.");
+
+namespace shaka {
+
+namespace {
+
+// Returns the name of the directory of a resource in the cache.
+std::string GetEntryName(const std::string& url,
+                         const std::string& etag,
+                         int64_t size) {
+  const std::string key = absl::StrFormat("%s\n%s\n%d", url, etag, size);
+  const mbedtls_md_info_t* md_info =
+      mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+  DCHECK(md_info);
+  std::string hash(mbedtls_md_get_size(md_info), 0);
+  CHECK_EQ(0, mbedtls_md(md_info, reinterpret_cast<const uint8_t*>(key.data()),
+                         key.size(), reinterpret_cast<uint8_t*>(hash.data())));
+  return absl::BytesToHexString(hash);
+}
+
+}  // namespace
+
+struct HttpCacheFile::Chunk {
+  std::string data;
+  bool ok = false;
+  // Notified when |data| and |ok| are set.
+  absl::Notification done;
+};
+
+HttpCacheFile::HttpCacheFile(const std::string& url,
+                             const std::string& cache_dir,
+                             int32_t num_parallel_requests,
+                             uint64_t chunk_size)
+    : File(url.c_str()),
+      url_(url),
+      cache_dir_(cache_dir),
+      num_parallel_requests_(std::max(num_parallel_requests, 1)),
+      chunk_size_(chunk_size) {
+  DCHECK_GT(chunk_size_, 0u);
+}
+
+HttpCacheFile::~HttpCacheFile() {}
+
+bool HttpCacheFile::Open() {
+  VLOG(2) << "Opening " << url_ << " through the cache in " << cache_dir_;
+  std::unique_ptr<HttpFile, FileCloser> file(
+      new HttpFile(HttpMethod::kHead, url_));
+  if (!file->Open())
+    return false;
+  size_ = file->Size();
+  const std::string etag = file->ETag();
+  if (!file.release()->Close() || size_ < 0) {
+    LOG(ERROR) << "Unable to get the size of " << url_;
+    return false;
+  }
+
+  if (etag.empty()) {
+    LOG(WARNING) << url_ << " has no ETag and is not cached.";
+    return true;
+  }
+  const std::filesystem::path entry_path =
+      std::filesystem::u8path(cache_dir_) / GetEntryName(url_, etag, size_);
+  std::error_code ec;
+  std::filesystem::create_directories(entry_path, ec);
+  if (ec) {
+    LOG(WARNING) << "Unable to create " << entry_path.string() << ", error: "
+                 << ec << ". " << url_ << " is not cached.";
+    return true;
+  }
+  entry_dir_ = entry_path.string();
+  return true;
+}
+
+bool HttpCacheFile::Close() {
+  // The chunks being downloaded are still stored in the cache.
+  chunks_.clear();
+  delete this;
+  return true;
+}
+
+int64_t HttpCacheFile::Read(void* buffer, uint64_t length) {
+  DCHECK_GE(size_, 0);
+  const uint64_t size = static_cast<uint64_t>(size_);
+  if (position_ >= size || length == 0)
+    return 0;
+
+  const uint64_t index = position_ / chunk_size_;
+  RequestChunks(index, position_ == last_read_end_);
+  const std::shared_ptr<Chunk> chunk = chunks_[index];
+  chunk->done.WaitForNotification();
+  if (!chunk->ok)
+    return -1;
+
+  const uint64_t offset = position_ - index * chunk_size_;
+  DCHECK_LT(offset, chunk->data.size());
+  length = std::min<uint64_t>(length, chunk->data.size() - offset);
+  memcpy(buffer, chunk->data.data() + offset, length);
+  position_ += length;
+  last_read_end_ = position_;
+  return length;
+}
+
+int64_t HttpCacheFile::Write(const void* buffer, uint64_t length) {
+  UNUSED(buffer);
+  UNUSED(length);
+  LOG(ERROR) << "HttpCacheFile does not support Write().";
+  return -1;
+}
+
+void HttpCacheFile::CloseForWriting() {}
+
+int64_t HttpCacheFile::Size() {
+  return size_;
+}
+
+bool HttpCacheFile::Flush() {
+  LOG(ERROR) << "HttpCacheFile does not support Flush().";
+  return false;
+}
+
+bool HttpCacheFile::Seek(uint64_t position) {
+  if (size_ < 0 || position > static_cast<uint64_t>(size_))
+    return false;
+  position_ = position;
+  return true;
+}
+
+bool HttpCacheFile::Tell(uint64_t* position) {
+  *position = position_;
+  return true;
+}
+
+// static
+std::shared_ptr<HttpCacheFile::Chunk> HttpCacheFile::GetChunk(
+    const std::string& url,
+    const std::string& path,
+    uint64_t start,
+    uint64_t size) {
+  // The chunks being loaded, by path.  A chunk is removed once it is stored in
+  // the cache, so a chunk missing from both is loaded again.
+  struct Loads {
+    absl::Mutex mutex;
+    std::map<std::string, std::shared_ptr<Chunk>> chunks
+        ABSL_GUARDED_BY(mutex);
+  };
+  static Loads* const loads = new Loads;
+
+  std::shared_ptr<Chunk> chunk;
+  if (!path.empty()) {
+    absl::MutexLock lock(&loads->mutex);
+    std::shared_ptr<Chunk>& loading_chunk = loads->chunks[path];
+    if (loading_chunk)
+      return loading_chunk;
+    chunk = loading_chunk = std::make_shared<Chunk>();
+  } else {
+    chunk = std::make_shared<Chunk>();
+  }
+
+  ThreadPool::instance.PostTask([url, path, start, size, chunk]() {
+    LoadChunk(url, path, start, size, chunk);
+    if (!path.empty()) {
+      absl::MutexLock lock(&loads->mutex);
+      loads->chunks.erase(path);
+    }
+    chunk->done.Notify();
+  });
+  return chunk;
+}
+
+// static
+void HttpCacheFile::LoadChunk(const std::string& url,
+                              const std::string& path,
+                              uint64_t start,
+                              uint64_t size,
+                              std::shared_ptr<Chunk> chunk) {
+  static MetricCounter* const cache_hits =
+      MetricsRegistry::GetInstance()->GetCounter(
+          "shaka_http_input_cache_hits_total",
+          "Chunks of http(s) inputs read from the local disk cache.");
+  static MetricCounter* const cache_misses =
+      MetricsRegistry::GetInstance()->GetCounter(
+          "shaka_http_input_cache_misses_total",
+          "Chunks of http(s) inputs downloaded into the local disk cache.");
+
+  std::error_code ec;
+  if (!path.empty() &&
+      std::filesystem::file_size(std::filesystem::u8path(path), ec) == size &&
+      File::ReadFileToString(path.c_str(), &chunk->data) &&
+      chunk->data.size() == size) {
+    cache_hits->Increment();
+    chunk->ok = true;
+    return;
+  }
+
+  chunk->data.resize(size);
+  chunk->ok = HttpRangeFile::ReadRange(
+      url, start, size, reinterpret_cast<uint8_t*>(&chunk->data[0]));
+  if (!chunk->ok || path.empty())
+    return;
+  cache_misses->Increment();
+  // Other processes sharing the cache may store the same chunk concurrently,
+  // with the same content.
+  if (!File::WriteFileAtomically(path.c_str(), chunk->data))
+    LOG(WARNING) << "Unable to store " << path << " in the cache.";
+}
+
+void HttpCacheFile::RequestChunks(uint64_t index, bool prefetch) {
+  const uint64_t size = static_cast<uint64_t>(size_);
+  const uint64_t num_chunks = (size + chunk_size_ - 1) / chunk_size_;
+  const uint64_t end_index = std::min<uint64_t>(
+      num_chunks, index + (prefetch ? num_parallel_requests_ : 1));
+
+  // Drop the chunks which are behind the read position or beyond the window.
+  // Those still being downloaded are stored in the cache nevertheless.
+  for (auto it = chunks_.begin(); it != chunks_.end();) {
+    if (it->first >= index && it->first < end_index)
+      ++it;
+    else
+      it = chunks_.erase(it);
+  }
+
+  for (uint64_t i = index; i < end_index; ++i) {
+    if (chunks_.count(i))
+      continue;
+    const uint64_t start = i * chunk_size_;
+    const std::string path =
+        entry_dir_.empty()
+            ? ""
+            : (std::filesystem::u8path(entry_dir_) /
+               absl::StrFormat("%u-%u", start, chunk_size_))
+                  .string();
+    chunks_[i] = GetChunk(url_, path, start,
+                          std::min(chunk_size_, size - start));
+  }
+}
+
+}  // namespace shaka
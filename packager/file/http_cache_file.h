@@ -0,0 +1,100 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_HTTP_CACHE_FILE_H_
+#define PACKAGER_FILE_HTTP_CACHE_FILE_H_
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+
+#include <packager/file.h>
+
+namespace shaka {
+
+/// HttpCacheFile reads a network resource through a local disk cache, shared
+/// by all the readers of the resource, e.g. the jobs packaging the same input.
+///
+/// The resource is split in chunks which are downloaded with byte range
+/// requests, as HttpRangeFile does, and stored in a directory of the cache
+/// named after a hash of the URL, ETag and size of the resource.  A new ETag
+/// thus leads to a new directory.  Chunks already in the cache are read from
+/// disk, and the readers of a process which need a chunk being downloaded
+/// wait for that download rather than making their own.  Resources without an
+/// ETag are read with range requests but are not cached.
+///
+/// The cache is never pruned by the packager.
+class HttpCacheFile : public File {
+ public:
+  /// @param url is the URL of the resource.
+  /// @param cache_dir is the directory of the cache, created if needed.
+  /// @param num_parallel_requests is the maximum number of chunks requested
+  ///        ahead of the read position.
+  /// @param chunk_size is the size, in bytes, of each chunk. The readers of a
+  ///        resource share its chunks only if they use the same size.
+  HttpCacheFile(const std::string& url,
+                const std::string& cache_dir,
+                int32_t num_parallel_requests,
+                uint64_t chunk_size);
+
+  HttpCacheFile(const HttpCacheFile&) = delete;
+  HttpCacheFile& operator=(const HttpCacheFile&) = delete;
+
+  /// @name File implementation overrides.
+  /// @{
+  bool Close() override;
+  int64_t Read(void* buffer, uint64_t length) override;
+  int64_t Write(const void* buffer, uint64_t length) override;
+  void CloseForWriting() override;
+  int64_t Size() override;
+  bool Flush() override;
+  bool Seek(uint64_t position) override;
+  bool Tell(uint64_t* position) override;
+  bool Open() override;
+  /// @}
+
+ protected:
+  ~HttpCacheFile() override;
+
+ private:
+  struct Chunk;
+
+  // Returns the chunk stored in |path|, loading it from the cache or
+  // downloading the bytes [start, start + size) of |url| into the cache if
+  // needed.  The chunk is not cached if |path| is empty.
+  static std::shared_ptr<Chunk> GetChunk(const std::string& url,
+                                         const std::string& path,
+                                         uint64_t start,
+                                         uint64_t size);
+  static void LoadChunk(const std::string& url,
+                        const std::string& path,
+                        uint64_t start,
+                        uint64_t size,
+                        std::shared_ptr<Chunk> chunk);
+  // Makes sure that the chunk at |index| is requested and, if |prefetch| is
+  // true, the chunks after it too.  Chunks outside of that window are dropped.
+  void RequestChunks(uint64_t index, bool prefetch);
+
+  const std::string url_;
+  const std::string cache_dir_;
+  const int32_t num_parallel_requests_;
+  const uint64_t chunk_size_;
+  // The directory of the chunks in the cache, empty if not cached.
+  std::string entry_dir_;
+  int64_t size_ = -1;
+  uint64_t position_ = 0;
+  // The position right after the last read, used to detect sequential reads.
+  // The first read does not count as sequential.
+  uint64_t last_read_end_ = std::numeric_limits<uint64_t>::max();
+  // Requested chunks, by index.
+  std::map<uint64_t, std::shared_ptr<Chunk>> chunks_;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_HTTP_CACHE_FILE_H_
@@ -0,0 +1,140 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/http_cache_file.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <packager/file/file_closer.h>
+#include <packager/file/file_util.h>
+#include <packager/media/test/test_web_server.h>
+
+namespace shaka {
+
+namespace {
+
+// Small enough for a local server, but spanning several chunks.
+const int kContentSize = 100000;
+const uint64_t kChunkSize = 16384;
+const int kNumChunks = 7;
+const int32_t kNumParallelRequests = 3;
+
+using FilePtr = std::unique_ptr<HttpCacheFile, FileCloser>;
+
+class HttpCacheFileTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(server_.Start());
+    ASSERT_TRUE(TempFilePath("", &cache_dir_));
+  }
+
+  void TearDown() override {
+    std::error_code ec;
+    std::filesystem::remove_all(std::filesystem::u8path(cache_dir_), ec);
+  }
+
+  FilePtr OpenFile() {
+    FilePtr file(new HttpCacheFile(server_.RangeUrl(kContentSize), cache_dir_,
+                                   kNumParallelRequests, kChunkSize));
+    if (!file->Open())
+      file.release();
+    return file;
+  }
+
+  std::vector<uint8_t> ReadAll(HttpCacheFile* file) {
+    std::vector<uint8_t> content;
+    std::vector<uint8_t> buffer(10000);
+    while (true) {
+      const int64_t bytes_read = file->Read(buffer.data(), buffer.size());
+      EXPECT_GE(bytes_read, 0);
+      if (bytes_read <= 0)
+        break;
+      content.insert(content.end(), buffer.begin(),
+                     buffer.begin() + bytes_read);
+    }
+    return content;
+  }
+
+  void ExpectContent(const std::vector<uint8_t>& data, int position) {
+    for (size_t i = 0; i < data.size(); ++i) {
+      ASSERT_EQ(media::TestWebServer::RangeContentByte(position + i), data[i])
+          << "at position " << position + i;
+    }
+  }
+
+  media::TestWebServer server_;
+  std::string cache_dir_;
+};
+
+}  // namespace
+
+TEST_F(HttpCacheFileTest, DownloadsOnce) {
+  FilePtr file = OpenFile();
+  ASSERT_TRUE(file);
+  EXPECT_EQ(kContentSize, file->Size());
+  std::vector<uint8_t> content = ReadAll(file.get());
+  ASSERT_EQ(static_cast<size_t>(kContentSize), content.size());
+  ExpectContent(content, 0);
+  ASSERT_TRUE(file.release()->Close());
+  EXPECT_EQ(kNumChunks, server_.range_get_requests());
+
+  // Another reader gets the content from the cache.
+  file = OpenFile();
+  ASSERT_TRUE(file);
+  content = ReadAll(file.get());
+  ASSERT_EQ(static_cast<size_t>(kContentSize), content.size());
+  ExpectContent(content, 0);
+  ASSERT_TRUE(file.release()->Close());
+  EXPECT_EQ(kNumChunks, server_.range_get_requests());
+}
+
+TEST_F(HttpCacheFileTest, SharesDownloads) {
+  FilePtr file1 = OpenFile();
+  ASSERT_TRUE(file1);
+  FilePtr file2 = OpenFile();
+  ASSERT_TRUE(file2);
+
+  // Reads which do not cross the chunks.
+  const int kReadSize = 1024;
+  std::vector<uint8_t> buffer1(kReadSize);
+  std::vector<uint8_t> buffer2(kReadSize);
+  for (int position = 0; position < kContentSize; position += kReadSize) {
+    const int size = std::min(kReadSize, kContentSize - position);
+    buffer1.resize(size);
+    buffer2.resize(size);
+    ASSERT_EQ(size, file1->Read(buffer1.data(), buffer1.size()));
+    ASSERT_EQ(size, file2->Read(buffer2.data(), buffer2.size()));
+    ExpectContent(buffer1, position);
+    ExpectContent(buffer2, position);
+  }
+  ASSERT_TRUE(file1.release()->Close());
+  ASSERT_TRUE(file2.release()->Close());
+  EXPECT_EQ(kNumChunks, server_.range_get_requests());
+}
+
+TEST_F(HttpCacheFileTest, SeeksToCachedChunks) {
+  FilePtr file = OpenFile();
+  ASSERT_TRUE(file);
+  ReadAll(file.get());
+
+  const int kPosition = 70000;
+  std::vector<uint8_t> buffer(16);
+  ASSERT_TRUE(file->Seek(kPosition));
+  ASSERT_EQ(16, file->Read(buffer.data(), buffer.size()));
+  ExpectContent(buffer, kPosition);
+  uint64_t position = 0;
+  ASSERT_TRUE(file->Tell(&position));
+  EXPECT_EQ(kPosition + 16u, position);
+  ASSERT_TRUE(file.release()->Close());
+  EXPECT_EQ(kNumChunks, server_.range_get_requests());
+}
+
+}  // namespace shaka
@@ -6,18 +6,33 @@
 
 #include <packager/file/http_file.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+
 #include <absl/flags/declare.h>
 #include <absl/flags/flag.h>
 #include <absl/log/check.h>
 #include <absl/log/log.h>
+#include <absl/strings/ascii.h>
 #include <absl/strings/escaping.h>
+#include <absl/strings/match.h>
 #include <absl/strings/str_format.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/time/time.h>
 #include <curl/curl.h>
 
 #include <packager/file/file_closer.h>
+#include <packager/file/mapped_file.h>
 #include <packager/file/thread_pool.h>
 #include <packager/macros/compiler.h>
 #include <packager/macros/logging.h>
+#include <packager/utils/metrics.h>
+#include <packager/utils/resource_quota.h>
+#include <packager/utils/trace.h>
+#include <packager/utils/work_priority.h>
 #include <packager/version/version.h>
 
 ABSL_FLAG(std::string,
@@ -52,6 +67,42 @@ ABSL_FLAG(bool,
           "Ignore HTTP output failures. Can help recover from live stream "
           "upload errors.");
 
+ABSL_FLAG(uint64_t,
+          http_io_cache_size,
+          0,
+          "Size of each of the upload and download caches of HTTP files, in "
+          "bytes. The caches grow to this size only as data backs up. Uses "
+          "--io_cache_size if 0.");
+ABSL_FLAG(int32_t,
+          http_max_retries,
+          2,
+          "Number of times to retry HTTP requests which fail with a transient "
+          "error, e.g. a timeout or a 5xx response. POST requests are not "
+          "retried.");
+ABSL_FLAG(uint64_t,
+          http_retry_buffer_size,
+          32ull * 1024 * 1024,
+          "Size in bytes of the data kept per HTTP upload to send it again on "
+          "retries. Larger uploads are not retried.");
+ABSL_FLAG(int32_t,
+          http_dns_cache_timeout,
+          60,
+          "Number of seconds host names resolved for HTTP requests are cached "
+          "for, shared by all the requests. -1 caches them forever, 0 "
+          "disables the cache.");
+ABSL_FLAG(int32_t,
+          http_connect_timeout,
+          30,
+          "Timeout in seconds of the host name resolution and connection "
+          "phase of HTTP requests, so that an unresponsive resolver or host "
+          "fails the request, which may then be retried, instead of stalling "
+          "it. 0 uses the libcurl default.");
+ABSL_FLAG(int32_t,
+          http_happy_eyeballs_timeout_ms,
+          200,
+          "Head start in milliseconds given to connecting over IPv6 before "
+          "also trying IPv4, for hosts with both AAAA and A records.");
+
 ABSL_DECLARE_FLAG(uint64_t, io_cache_size);
 
 namespace shaka {
@@ -59,12 +110,25 @@ namespace shaka {
 namespace {
 
 constexpr const char* kBinaryContentType = "application/octet-stream";
+constexpr const char* kChunkedTransferEncoding = "Transfer-Encoding: chunked";
 constexpr const int kMinLogLevelForCurlDebugFunction = 2;
+constexpr const int kFirstRetryDelayMilliseconds = 250;
+// The smallest cache left to a request when its resource quota is short of
+// memory.
+constexpr const uint64_t kMinHttpCacheSize = 64 * 1024;
+
+uint64_t HttpCacheSize() {
+  const uint64_t cache_size = absl::GetFlag(FLAGS_http_io_cache_size);
+  return ResourceQuota::FitIoCache(
+      cache_size ? cache_size : absl::GetFlag(FLAGS_io_cache_size),
+      kMinHttpCacheSize);
+}
 
 size_t CurlWriteCallback(char* buffer, size_t size, size_t nmemb, void* user) {
   IoCache* cache = reinterpret_cast<IoCache*>(user);
   size_t length = size * nmemb;
   if (cache) {
+    WorkPriority::ThrottleIo(length);
     length = cache->Write(buffer, length);
     VLOG(3) << "CurlWriteCallback length=" << length;
   } else {
@@ -74,13 +138,66 @@ size_t CurlWriteCallback(char* buffer, size_t size, size_t nmemb, void* user) {
   return length;
 }
 
-size_t CurlReadCallback(char* buffer, size_t size, size_t nitems, void* user) {
-  IoCache* cache = reinterpret_cast<IoCache*>(user);
-  size_t length = cache->Read(buffer, size * nitems);
-  VLOG(3) << "CurlRead length=" << length;
+// Keeps the ETag header of the last response in |user|, a std::string.
+size_t CurlHeaderCallback(char* buffer,
+                          size_t size,
+                          size_t nitems,
+                          void* user) {
+  std::string* etag = static_cast<std::string*>(user);
+  const size_t length = size * nitems;
+  absl::string_view header(buffer, length);
+  if (absl::StartsWith(header, "HTTP/")) {
+    // The status line of a new response, e.g. after a redirection.
+    etag->clear();
+  } else if (absl::StartsWithIgnoreCase(header, "ETag:")) {
+    *etag = std::string(absl::StripAsciiWhitespace(header.substr(5)));
+  }
   return length;
 }
 
+// Aborts the request, by returning non-zero, once |user|, the aborted flag of
+// the file, is set.
+int CurlProgressCallback(void* user,
+                         curl_off_t /* download_total */,
+                         curl_off_t /* downloaded */,
+                         curl_off_t /* upload_total */,
+                         curl_off_t /* uploaded */) {
+  return reinterpret_cast<std::atomic<bool>*>(user)->load() ? 1 : 0;
+}
+
+// Whether a request which failed with |res| may succeed if made again.
+bool IsTransientError(CURL* curl, CURLcode res) {
+  switch (res) {
+    case CURLE_COULDNT_RESOLVE_HOST:
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_OPERATION_TIMEDOUT:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_GOT_NOTHING:
+    case CURLE_PARTIAL_FILE:
+      return true;
+    case CURLE_HTTP_RETURNED_ERROR: {
+      long response_code = 0;
+      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+      return response_code >= 500 || response_code == 429 ||
+             response_code == 408;
+    }
+    default:
+      return false;
+  }
+}
+
+// The delay before the retry which follows |attempt| failed attempts: it
+// doubles with each attempt, and is jittered so that the requests which
+// failed together are not all made again at the same time.
+std::chrono::milliseconds RetryDelay(int attempt) {
+  thread_local std::minstd_rand random_engine(std::random_device{}());
+  std::uniform_real_distribution<double> jitter(0.5, 1.5);
+  return std::chrono::milliseconds(static_cast<int64_t>(
+      kFirstRetryDelayMilliseconds * (1 << std::min(attempt - 1, 10)) *
+      jitter(random_engine)));
+}
+
 int CurlDebugCallback(CURL* /* handle */,
                       curl_infotype type,
                       const char* data,
@@ -143,14 +260,70 @@ class LibCurlInitializer {
  public:
   LibCurlInitializer() {
     curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    // Share the connection cache, DNS cache and TLS sessions between all the
+    // requests, so that requests to the same host reuse a warm connection
+    // instead of paying for a new TCP and TLS handshake each time.
+    share_ = curl_share_init();
+    if (!share_) {
+      LOG(WARNING) << "curl_share_init() failed. Connections will not be "
+                      "reused across requests.";
+      return;
+    }
+    curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &LibCurlInitializer::Lock);
+    curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC,
+                      &LibCurlInitializer::Unlock);
+    curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+
+    // With the c-ares resolver, host names are resolved asynchronously, within
+    // the connect timeout, and all the requests share its channel settings.
+    // Without it, a hung resolver blocks the thread making the request.
+    const curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+    if (!(info->features & CURL_VERSION_ASYNCHDNS)) {
+      LOG(WARNING) << "libcurl is built without an asynchronous resolver. "
+                      "Slow DNS lookups will block HTTP requests.";
+    } else if (info->ares) {
+      VLOG(1) << "libcurl resolves host names with c-ares " << info->ares;
+    }
   }
 
   ~LibCurlInitializer() {
+    if (share_)
+      curl_share_cleanup(share_);
     curl_global_cleanup();
   }
 
   LibCurlInitializer(const LibCurlInitializer&) = delete;
   LibCurlInitializer& operator=(const LibCurlInitializer&) = delete;
+
+  static LibCurlInitializer& instance() {
+    static LibCurlInitializer lib_curl_initializer;
+    return lib_curl_initializer;
+  }
+
+  // May be null if the share handle could not be created.
+  CURLSH* share() const { return share_; }
+
+ private:
+  static void Lock(CURL* /* handle */,
+                   curl_lock_data data,
+                   curl_lock_access /* access */,
+                   void* user) {
+    auto* self = reinterpret_cast<LibCurlInitializer*>(user);
+    self->mutexes_[data].Lock();
+  }
+
+  static void Unlock(CURL* /* handle */, curl_lock_data data, void* user) {
+    auto* self = reinterpret_cast<LibCurlInitializer*>(user);
+    self->mutexes_[data].Unlock();
+  }
+
+  CURLSH* share_ = nullptr;
+  // One mutex per type of shared data, as recommended by libcurl.
+  absl::Mutex mutexes_[CURL_LOCK_DATA_LAST];
 };
 
 template <typename List>
@@ -181,9 +354,12 @@ HttpFile::HttpFile(HttpMethod method,
       timeout_in_seconds_(timeout_in_seconds),
       method_(method),
       isUpload_(method == HttpMethod::kPut || method == HttpMethod::kPost),
-      download_cache_(absl::GetFlag(FLAGS_io_cache_size)),
-      upload_cache_(absl::GetFlag(FLAGS_io_cache_size)),
-      curl_(curl_easy_init()),
+      max_retries_(std::max(absl::GetFlag(FLAGS_http_max_retries), 0)),
+      max_replay_size_(absl::GetFlag(FLAGS_http_retry_buffer_size)),
+      cache_size_(HttpCacheSize()),
+      download_cache_(cache_size_),
+      upload_cache_(cache_size_),
+      caches_quota_(2 * cache_size_),
       status_(Status::OK),
       user_agent_(absl::GetFlag(FLAGS_user_agent)),
       ca_file_(absl::GetFlag(FLAGS_ca_file)),
@@ -192,7 +368,11 @@ HttpFile::HttpFile(HttpMethod method,
           absl::GetFlag(FLAGS_client_cert_private_key_file)),
       client_cert_private_key_password_(
           absl::GetFlag(FLAGS_client_cert_private_key_password)) {
-  static LibCurlInitializer lib_curl_initializer;
+  // libcurl is initialized by the first request, so that runs without network
+  // files never pay for it, and before curl_easy_init() which would otherwise
+  // initialize it implicitly.
+  LibCurlInitializer::instance();
+  curl_.reset(curl_easy_init());
   if (user_agent_.empty()) {
     user_agent_ += "ShakaPackager/" + GetPackagerVersion();
   }
@@ -208,7 +388,7 @@ HttpFile::HttpFile(HttpMethod method,
       !AppendHeader("Content-Type: " + upload_content_type_, &temp_headers)) {
     return;
   }
-  if (isUpload_ && !AppendHeader("Transfer-Encoding: chunked", &temp_headers)) {
+  if (isUpload_ && !AppendHeader(kChunkedTransferEncoding, &temp_headers)) {
     return;
   }
   for (const auto& item : headers) {
@@ -231,6 +411,19 @@ bool HttpFile::Delete(const std::string& url) {
   return file.release()->Close();
 }
 
+// static
+Status HttpFile::UploadMappedFile(std::unique_ptr<MappedFile> source,
+                                  const std::string& url) {
+  DCHECK(source);
+  std::unique_ptr<HttpFile, FileCloser> file(
+      new HttpFile(HttpMethod::kPut, url));
+  source->AdviseSequential();
+  file->upload_source_ = std::move(source);
+  if (!file->Open())
+    return Status(error::HTTP_FAILURE, "Cannot upload to " + url + ".");
+  return file.release()->CloseWithStatus();
+}
+
 bool HttpFile::Open() {
   VLOG(2) << "Opening " << url_;
 
@@ -240,9 +433,6 @@ bool HttpFile::Open() {
   }
   // TODO: Try to connect initially so we can return connection error here.
 
-  // TODO: Implement retrying with exponential backoff, see
-  // "widevine_key_source.cc"
-
   ThreadPool::instance.PostTask(std::bind(&HttpFile::ThreadMain, this));
 
   return true;
@@ -266,15 +456,19 @@ Status HttpFile::CloseWithStatus() {
 }
 
 bool HttpFile::Close() {
+  ScopedTraceEvent trace_event("File::Close", url_);
   return CloseWithStatus().ok();
 }
 
 int64_t HttpFile::Read(void* buffer, uint64_t length) {
   VLOG(2) << "Reading from " << url_ << ", length=" << length;
-  return download_cache_.Read(buffer, length);
+  const uint64_t result = download_cache_.Read(buffer, length);
+  return aborted_ ? -1 : result;
 }
 
 int64_t HttpFile::Write(const void* buffer, uint64_t length) {
+  if (aborted_)
+    return -1;
   DCHECK(!upload_cache_.closed());
   VLOG(2) << "Writing to " << url_ << ", length=" << length;
   return upload_cache_.Write(buffer, length);
@@ -285,11 +479,34 @@ void HttpFile::CloseForWriting() {
   upload_cache_.Close();
 }
 
+void HttpFile::Abort() {
+  if (aborted_.exchange(true))
+    return;
+  VLOG(1) << "Aborting " << url_;
+  abort_event_.Notify();
+  // Wake up the caller and the request, if blocked on the caches. The request
+  // is then aborted by the progress callback.
+  upload_cache_.Close();
+  download_cache_.Close();
+}
+
 int64_t HttpFile::Size() {
+  if (method_ == HttpMethod::kHead) {
+    // The size is the Content-Length of the response, which is only known
+    // once the request completes.
+    task_exit_event_.WaitForNotification();
+    return status_.ok() ? content_length_ : -1;
+  }
   VLOG(1) << "HttpFile does not support Size().";
   return -1;
 }
 
+std::string HttpFile::ETag() {
+  DCHECK(method_ == HttpMethod::kHead);
+  task_exit_event_.WaitForNotification();
+  return status_.ok() ? etag_ : "";
+}
+
 bool HttpFile::Flush() {
   // Wait for curl to read any data we may have buffered.
   upload_cache_.WaitUntilEmptyOrClosed();
@@ -319,6 +536,22 @@ void HttpFile::CurlDelete::operator()(curl_slist* headers) {
 void HttpFile::SetupRequest() {
   auto* curl = curl_.get();
 
+  if (upload_source_) {
+    // The size of the file is known, so it is sent with a Content-Length
+    // rather than in chunks.
+    std::unique_ptr<curl_slist, CurlDelete> headers;
+    bool headers_ok = true;
+    for (curl_slist* header = request_headers_.get(); header && headers_ok;
+         header = header->next) {
+      if (strcmp(header->data, kChunkedTransferEncoding) != 0)
+        headers_ok = AppendHeader(header->data, &headers);
+    }
+    if (headers_ok)
+      request_headers_ = std::move(headers);
+    curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE,
+                     static_cast<curl_off_t>(upload_source_->size()));
+  }
+
   switch (method_) {
     case HttpMethod::kGet:
       curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
@@ -332,6 +565,11 @@ void HttpFile::SetupRequest() {
     case HttpMethod::kDelete:
       curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
       break;
+    case HttpMethod::kHead:
+      curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+      curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, &CurlHeaderCallback);
+      curl_easy_setopt(curl, CURLOPT_HEADERDATA, &etag_);
+      break;
   }
 
   curl_easy_setopt(curl, CURLOPT_URL, url_.c_str());
@@ -342,12 +580,35 @@ void HttpFile::SetupRequest() {
   curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &CurlWriteCallback);
   curl_easy_setopt(curl, CURLOPT_WRITEDATA, &download_cache_);
   if (isUpload_) {
-    curl_easy_setopt(curl, CURLOPT_READFUNCTION, &CurlReadCallback);
-    curl_easy_setopt(curl, CURLOPT_READDATA, &upload_cache_);
+    curl_easy_setopt(curl, CURLOPT_READFUNCTION, &CurlUploadCallback);
+    curl_easy_setopt(curl, CURLOPT_READDATA, this);
   }
+  // Called at least once a second, so that Abort() ends the request soon.
+  curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+  curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, &CurlProgressCallback);
+  curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &aborted_);
 
   curl_easy_setopt(curl, CURLOPT_HTTPHEADER, request_headers_.get());
 
+  CURLSH* share = LibCurlInitializer::instance().share();
+  if (share)
+    curl_easy_setopt(curl, CURLOPT_SHARE, share);
+  // Negotiate HTTP/2 over TLS when libcurl supports it, HTTP/1.1 otherwise.
+  curl_easy_setopt(curl, CURLOPT_HTTP_VERSION,
+                   static_cast<long>(CURL_HTTP_VERSION_2TLS));
+  // Keep pooled connections alive while they are idle between requests.
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  // Resolved host names are kept in the DNS cache of the share handle.
+  curl_easy_setopt(
+      curl, CURLOPT_DNS_CACHE_TIMEOUT,
+      static_cast<long>(absl::GetFlag(FLAGS_http_dns_cache_timeout)));
+  curl_easy_setopt(
+      curl, CURLOPT_CONNECTTIMEOUT,
+      static_cast<long>(absl::GetFlag(FLAGS_http_connect_timeout)));
+  curl_easy_setopt(
+      curl, CURLOPT_HAPPY_EYEBALLS_TIMEOUT_MS,
+      static_cast<long>(absl::GetFlag(FLAGS_http_happy_eyeballs_timeout_ms)));
+
   if (absl::GetFlag(FLAGS_disable_peer_verification))
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
 
@@ -374,11 +635,121 @@ void HttpFile::SetupRequest() {
   }
 }
 
+// static
+size_t HttpFile::CurlUploadCallback(char* buffer,
+                                    size_t size,
+                                    size_t nitems,
+                                    void* user) {
+  HttpFile* file = reinterpret_cast<HttpFile*>(user);
+  size_t length = file->ReadUpload(buffer, size * nitems);
+  VLOG(3) << "CurlRead length=" << length;
+  // Do not end an aborted upload as if it was complete.
+  if (file->aborted_)
+    return CURL_READFUNC_ABORT;
+  return length;
+}
+
+size_t HttpFile::ReadUpload(char* buffer, size_t length) {
+  if (upload_source_) {
+    length = std::min<uint64_t>(
+        length, upload_source_->size() - upload_source_position_);
+    memcpy(buffer, upload_source_->data() + upload_source_position_, length);
+    upload_source_position_ += length;
+    // The pages sent are read back from the file on retries.
+    upload_source_->ReleaseBefore(upload_source_position_);
+    return length;
+  }
+
+  if (upload_replay_position_ < upload_replay_.size()) {
+    length = std::min(length, upload_replay_.size() - upload_replay_position_);
+    memcpy(buffer, upload_replay_.data() + upload_replay_position_, length);
+    upload_replay_position_ += length;
+    return length;
+  }
+
+  length = upload_cache_.Read(buffer, length);
+  WorkPriority::ThrottleIo(length);
+  if (max_retries_ > 0 && upload_replayable_) {
+    if (upload_replay_.size() + length > max_replay_size_) {
+      upload_replayable_ = false;
+      std::vector<uint8_t>().swap(upload_replay_);
+    } else {
+      upload_replay_.insert(upload_replay_.end(), buffer, buffer + length);
+    }
+  }
+  upload_replay_position_ = upload_replay_.size();
+  return length;
+}
+
+bool HttpFile::CanRetry() const {
+  if (method_ == HttpMethod::kPost)
+    return false;
+  if (upload_source_)
+    return true;
+  if (isUpload_)
+    return upload_replayable_;
+  // The data received by a failed attempt may have been read already.
+  curl_off_t downloaded = 0;
+  curl_easy_getinfo(curl_.get(), CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+  return downloaded == 0;
+}
+
 void HttpFile::ThreadMain() {
+  static MetricDurations* const request_durations =
+      MetricsRegistry::GetInstance()->GetDurations(
+          "shaka_http_file_request_seconds",
+          "Time spent in HTTP file requests, including uploads.");
+  static MetricCounter* const request_failures =
+      MetricsRegistry::GetInstance()->GetCounter(
+          "shaka_http_file_request_failures_total",
+          "HTTP file requests which failed.");
+
+  static MetricCounter* const request_retries =
+      MetricsRegistry::GetInstance()->GetCounter(
+          "shaka_http_file_request_retries_total",
+          "HTTP file requests made again after a transient error.");
+
   SetupRequest();
 
-  CURLcode res = curl_easy_perform(curl_.get());
-  if (res != CURLE_OK) {
+  // The task has the resource quota of the thread which opened the file.
+  // Uploads wait for a slot of the quota, unless they are aborted first.
+  std::shared_ptr<ResourceQuota> upload_quota;
+  if (isUpload_ || upload_source_)
+    upload_quota = ResourceQuota::current();
+  CURLcode res = CURLE_OK;
+  if (upload_quota && !upload_quota->AcquireUpload(abort_event_)) {
+    upload_quota.reset();
+    res = CURLE_ABORTED_BY_CALLBACK;
+  }
+
+  for (int attempt = 0; res == CURLE_OK || attempt > 0; ++attempt) {
+    if (attempt > 0) {
+      request_retries->Increment();
+      if (abort_event_.WaitForNotificationWithTimeout(
+              absl::FromChrono(RetryDelay(attempt)))) {
+        break;
+      }
+      upload_replay_position_ = 0;
+      upload_source_position_ = 0;
+    }
+    const auto request_start = std::chrono::steady_clock::now();
+    res = curl_easy_perform(curl_.get());
+    request_durations->Record(std::chrono::steady_clock::now() -
+                              request_start);
+    if (res == CURLE_OK || aborted_ || attempt == max_retries_ ||
+        !CanRetry() ||
+        !IsTransientError(curl_.get(), res)) {
+      break;
+    }
+    LOG(WARNING) << "Retrying " << url_ << " after transient error: "
+                 << curl_easy_strerror(res);
+  }
+  if (upload_quota)
+    upload_quota->ReleaseUpload();
+  if (res != CURLE_OK && aborted_) {
+    status_ = Status(error::CANCELLED, "Aborted request to " + url_ + ".");
+  } else if (res != CURLE_OK) {
+    request_failures->Increment();
     std::string error_message = curl_easy_strerror(res);
     if (res == CURLE_HTTP_RETURNED_ERROR) {
       long response_code = 0;
@@ -389,6 +760,11 @@ void HttpFile::ThreadMain() {
     status_ = Status(
         res == CURLE_OPERATION_TIMEDOUT ? error::TIME_OUT : error::HTTP_FAILURE,
         error_message);
+  } else if (method_ == HttpMethod::kHead) {
+    curl_off_t content_length = -1;
+    curl_easy_getinfo(curl_.get(), CURLINFO_CONTENT_LENGTH_DOWNLOAD_T,
+                      &content_length);
+    content_length_ = content_length;
   }
 
   // In some cases it is possible that the server has already closed the
@@ -7,24 +7,31 @@
 #ifndef PACKAGER_FILE_HTTP_H_
 #define PACKAGER_FILE_HTTP_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <absl/synchronization/notification.h>
 
 #include <packager/file.h>
 #include <packager/file/io_cache.h>
+#include <packager/utils/resource_quota.h>
 
 typedef void CURL;
 struct curl_slist;
 
 namespace shaka {
 
+class MappedFile;
+
 enum class HttpMethod {
   kGet,
   kPost,
   kPut,
   kDelete,
+  kHead,
 };
 
 /// HttpFile reads or writes network requests.
@@ -32,6 +39,16 @@ enum class HttpMethod {
 /// Note that calling Flush will indicate EOF for the upload and no more can be
 /// uploaded.
 ///
+/// Requests which fail with a transient error, e.g. a timeout or a 5xx
+/// response, are retried with a jittered exponential backoff, up to
+/// --http_max_retries times. POST requests are not retried, and neither are
+/// uploads larger than --http_retry_buffer_size, as the uploaded data is kept
+/// to be sent again.
+///
+/// All the requests share their connections and a DNS cache, which keeps host
+/// names for --http_dns_cache_timeout seconds. Host names are resolved with
+/// c-ares where libcurl is built with it, within --http_connect_timeout.
+///
 /// About how to use this, please visit the corresponding documentation [1].
 ///
 /// [1]
@@ -50,14 +67,29 @@ class HttpFile : public File {
 
   static bool Delete(const std::string& url);
 
+  /// Upload a whole local file with a PUT request. The request reads the file
+  /// straight from its memory mapping rather than through the upload cache,
+  /// sends it with a Content-Length, and can be retried whatever its size.
+  /// @param source is the mapping of the file to upload.
+  /// @param url is the destination URL.
+  /// @return OK on success, or the error of the request.
+  static Status UploadMappedFile(std::unique_ptr<MappedFile> source,
+                                 const std::string& url);
+
   Status CloseWithStatus();
 
+  /// Only for HEAD requests, waits for the response.
+  /// @return the ETag of the response, as sent by the server, or an empty
+  ///         string if it has none or the request failed.
+  std::string ETag();
+
   /// @name File implementation overrides.
   /// @{
   bool Close() override;
   int64_t Read(void* buffer, uint64_t length) override;
   int64_t Write(const void* buffer, uint64_t length) override;
   void CloseForWriting() override;
+  void Abort() override;
   int64_t Size() override;
   bool Flush() override;
   bool Seek(uint64_t position) override;
@@ -74,20 +106,47 @@ class HttpFile : public File {
     void operator()(curl_slist* headers);
   };
 
+  static size_t CurlUploadCallback(char* buffer,
+                                   size_t size,
+                                   size_t nitems,
+                                   void* user);
+
   void SetupRequest();
   void ThreadMain();
+  // Reads the data to upload: from |upload_source_| if set, otherwise from
+  // |upload_cache_|, replaying the data sent by a failed attempt first.
+  size_t ReadUpload(char* buffer, size_t length);
+  // Whether the request can be made again once it failed.
+  bool CanRetry() const;
 
   const std::string url_;
   const std::string upload_content_type_;
   const int32_t timeout_in_seconds_;
   const HttpMethod method_;
   const bool isUpload_;
+  const int32_t max_retries_;
+  const uint64_t max_replay_size_;
+  const uint64_t cache_size_;
   IoCache download_cache_;
   IoCache upload_cache_;
+  ResourceQuotaCharge caches_quota_;
+  // The data read from |upload_cache_|, to send it again on retries. Cleared
+  // once it exceeds |max_replay_size_|, which disables retries.
+  std::vector<uint8_t> upload_replay_;
+  size_t upload_replay_position_ = 0;
+  bool upload_replayable_ = true;
+  // The local file uploaded by UploadMappedFile(), instead of the data
+  // written to |upload_cache_|.
+  std::unique_ptr<MappedFile> upload_source_;
+  uint64_t upload_source_position_ = 0;
   std::unique_ptr<CURL, CurlDelete> curl_;
   // The headers need to remain alive for the duration of the request.
   std::unique_ptr<curl_slist, CurlDelete> request_headers_;
   Status status_;
+  // The Content-Length of the response to a HEAD request.
+  int64_t content_length_ = -1;
+  // The ETag of the response to a HEAD request.
+  std::string etag_;
   std::string user_agent_;
   std::string ca_file_;
   std::string client_cert_file_;
@@ -96,6 +155,9 @@ class HttpFile : public File {
 
   // Signaled when the "curl easy perform" task completes.
   absl::Notification task_exit_event_;
+  // Set and signaled by Abort().
+  std::atomic<bool> aborted_{false};
+  absl::Notification abort_event_;
 };
 
 }  // namespace shaka
@@ -6,7 +6,9 @@
 
 #include <packager/file/http_file.h>
 
+#include <chrono>
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include <absl/strings/str_split.h>
@@ -15,6 +17,8 @@
 
 #include <packager/file.h>
 #include <packager/file/file_closer.h>
+#include <packager/file/file_test_util.h>
+#include <packager/file/mapped_file.h>
 #include <packager/macros/logging.h>
 #include <packager/media/test/test_web_server.h>
 
@@ -300,6 +304,77 @@ TEST_F(HttpFileTest, Error404) {
   ASSERT_EQ(status.error_code(), error::HTTP_FAILURE);
 }
 
+TEST_F(HttpFileTest, RetriesTransientErrors) {
+  FilePtr file(new HttpFile(HttpMethod::kGet, server_.FlakyUrl(2),
+                            kNoContentType, kNoHeaders, kDefaultTestTimeout));
+  ASSERT_TRUE(file);
+  ASSERT_TRUE(file->Open());
+
+  auto json = HandleResponse(file);
+  ASSERT_TRUE(json.is_object());
+  ASSERT_TRUE(file.release()->Close());
+  ASSERT_JSON_STRING(json, "method", "GET");
+}
+
+TEST_F(HttpFileTest, RetriesUpload) {
+  FilePtr file(new HttpFile(HttpMethod::kPut, server_.FlakyUrl(1),
+                            kBinaryContentType, kNoHeaders,
+                            kDefaultTestTimeout));
+  ASSERT_TRUE(file);
+  ASSERT_TRUE(file->Open());
+
+  const std::string data = "abcd";
+  ASSERT_EQ(file->Write(data.data(), data.size()),
+            static_cast<int64_t>(data.size()));
+  file->CloseForWriting();
+
+  // The data is sent again by the retry.
+  auto json = HandleResponse(file);
+  ASSERT_TRUE(json.is_object());
+  ASSERT_TRUE(file.release()->Close());
+  ASSERT_JSON_STRING(json, "method", "PUT");
+  ASSERT_JSON_STRING(json, "body", data);
+}
+
+TEST_F(HttpFileTest, UploadMappedFile) {
+  TempFile temp_file;
+  ASSERT_TRUE(File::WriteStringToFile(temp_file.path().c_str(), "abcd"));
+  std::unique_ptr<MappedFile> source = MappedFile::Open(temp_file.path());
+  ASSERT_TRUE(source);
+
+  // The file is sent again by the retry.
+  EXPECT_TRUE(
+      HttpFile::UploadMappedFile(std::move(source), server_.FlakyUrl(1)).ok());
+}
+
+TEST_F(HttpFileTest, UploadMappedFileError) {
+  TempFile temp_file;
+  ASSERT_TRUE(File::WriteStringToFile(temp_file.path().c_str(), "abcd"));
+  std::unique_ptr<MappedFile> source = MappedFile::Open(temp_file.path());
+  ASSERT_TRUE(source);
+
+  const Status status =
+      HttpFile::UploadMappedFile(std::move(source), server_.StatusCodeUrl(404));
+  EXPECT_EQ(error::HTTP_FAILURE, status.error_code());
+}
+
+TEST_F(HttpFileTest, DoesNotRetryPost) {
+  FilePtr file(new HttpFile(HttpMethod::kPost, server_.FlakyUrl(1),
+                            kBinaryContentType, kNoHeaders,
+                            kDefaultTestTimeout));
+  ASSERT_TRUE(file);
+  ASSERT_TRUE(file->Open());
+
+  const std::string data = "abcd";
+  ASSERT_EQ(file->Write(data.data(), data.size()),
+            static_cast<int64_t>(data.size()));
+  file->CloseForWriting();
+
+  auto status = file.release()->CloseWithStatus();
+  ASSERT_FALSE(status.ok());
+  ASSERT_EQ(status.error_code(), error::HTTP_FAILURE);
+}
+
 TEST_F(HttpFileTest, TimeoutTriggered) {
   FilePtr file(new HttpFile(HttpMethod::kGet, server_.DelayUrl(8),
                             kNoContentType, kNoHeaders,
@@ -328,4 +403,25 @@ TEST_F(HttpFileTest, TimeoutNotTriggered) {
   ASSERT_TRUE(file.release()->Close());
 }
 
+TEST_F(HttpFileTest, AbortUnblocksRead) {
+  FilePtr file(new HttpFile(HttpMethod::kGet, server_.DelayUrl(8),
+                            kNoContentType, kNoHeaders, kDefaultTestTimeout));
+  ASSERT_TRUE(file);
+  ASSERT_TRUE(file->Open());
+
+  const auto start = std::chrono::steady_clock::now();
+  std::thread abort_thread([&file]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    file->Abort();
+  });
+  uint8_t buffer[1];
+  ASSERT_LT(file->Read(buffer, sizeof(buffer)), 0);
+  abort_thread.join();
+
+  // The request is aborted long before the response comes.
+  auto status = file.release()->CloseWithStatus();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(4));
+  ASSERT_EQ(status.error_code(), error::CANCELLED);
+}
+
 }  // namespace shaka
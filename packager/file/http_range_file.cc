@@ -0,0 +1,227 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/http_range_file.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <absl/flags/flag.h>
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <absl/strings/str_format.h>
+#include <absl/synchronization/notification.h>
+
+#include <packager/file/file_closer.h>
+#include <packager/file/http_file.h>
+#include <packager/file/thread_pool.h>
+#include <packager/macros/compiler.h>
+#include <packager/macros/logging.h>
+
+ABSL_FLAG(int32_t,
+          http_parallel_range_requests,
+          0,
+          "If positive, http(s) inputs are read with byte range requests of "
+          "--http_range_request_size bytes, and up to this many of them run "
+          "in parallel ahead of the read position. This also allows seeking, "
+          "e.g. for MP4 inputs with 'moov' after 'mdat'. The server has to "
+          "support range requests. If 0, inputs are streamed with a single "
+          "request.");
+ABSL_FLAG(uint64_t,
+          http_range_request_size,
+          4ULL << 20,
+          "Size of each byte range request, in bytes. Used only if "
+          "--http_parallel_range_requests is positive.");
+
+namespace shaka {
+
+struct HttpRangeFile::Block {
+  std::vector<uint8_t> data;
+  bool ok = false;
+  // Notified when |data| and |ok| are set.
+  absl::Notification done;
+};
+
+// static
+bool HttpRangeFile::ReadRange(const std::string& url,
+                              uint64_t start,
+                              uint64_t size,
+                              uint8_t* buffer) {
+  const std::vector<std::string> headers = {
+      absl::StrFormat("Range: bytes=%u-%u", start, start + size - 1)};
+  std::unique_ptr<HttpFile, FileCloser> file(
+      new HttpFile(HttpMethod::kGet, url, "", headers, 0));
+
+  uint64_t bytes_read = 0;
+  bool ok = file->Open();
+  while (ok) {
+    int64_t result;
+    if (bytes_read < size) {
+      result = file->Read(buffer + bytes_read, size - bytes_read);
+    } else {
+      // The download has to be consumed until the end before the file can be
+      // closed, so any extra data is discarded.
+      uint8_t extra_data[4096];
+      result = file->Read(extra_data, sizeof(extra_data));
+    }
+    if (result < 0) {
+      ok = false;
+    } else if (result == 0) {
+      break;
+    }
+    bytes_read += result;
+  }
+  if (ok && bytes_read != size) {
+    LOG(ERROR) << "Expected " << size << " bytes at offset " << start
+               << " of " << url << " but got " << bytes_read
+               << " bytes. Does the server support range requests?";
+    ok = false;
+  }
+
+  if (!file.release()->Close())
+    ok = false;
+  return ok;
+}
+
+// static
+void HttpRangeFile::FetchBlock(const std::string& url,
+                               uint64_t start,
+                               uint64_t size,
+                               std::shared_ptr<Block> block) {
+  block->data.resize(size);
+  block->ok = ReadRange(url, start, size, block->data.data());
+  block->done.Notify();
+}
+
+HttpRangeFile::HttpRangeFile(const std::string& url,
+                             int32_t num_parallel_requests,
+                             uint64_t block_size)
+    : File(url.c_str()),
+      url_(url),
+      num_parallel_requests_(std::max(num_parallel_requests, 1)),
+      block_size_(block_size) {
+  DCHECK_GT(block_size_, 0u);
+}
+
+HttpRangeFile::~HttpRangeFile() {}
+
+bool HttpRangeFile::Open() {
+  VLOG(2) << "Opening " << url_ << " for range requests";
+  std::unique_ptr<HttpFile, FileCloser> file(
+      new HttpFile(HttpMethod::kHead, url_));
+  if (!file->Open())
+    return false;
+  size_ = file->Size();
+  if (!file.release()->Close() || size_ < 0) {
+    LOG(ERROR) << "Unable to get the size of " << url_;
+    return false;
+  }
+  return true;
+}
+
+bool HttpRangeFile::Close() {
+  for (const auto& entry : blocks_)
+    dropped_blocks_.push_back(entry.second);
+  blocks_.clear();
+  WaitForPendingBlocks();
+  delete this;
+  return true;
+}
+
+int64_t HttpRangeFile::Read(void* buffer, uint64_t length) {
+  DCHECK_GE(size_, 0);
+  const uint64_t size = static_cast<uint64_t>(size_);
+  if (position_ >= size || length == 0)
+    return 0;
+
+  const uint64_t index = position_ / block_size_;
+  RequestBlocks(index, position_ == last_read_end_);
+  const std::shared_ptr<Block> block = blocks_[index];
+  block->done.WaitForNotification();
+  if (!block->ok)
+    return -1;
+
+  const uint64_t offset = position_ - index * block_size_;
+  DCHECK_LT(offset, block->data.size());
+  length = std::min<uint64_t>(length, block->data.size() - offset);
+  memcpy(buffer, block->data.data() + offset, length);
+  position_ += length;
+  last_read_end_ = position_;
+  return length;
+}
+
+int64_t HttpRangeFile::Write(const void* buffer, uint64_t length) {
+  UNUSED(buffer);
+  UNUSED(length);
+  LOG(ERROR) << "HttpRangeFile does not support Write().";
+  return -1;
+}
+
+void HttpRangeFile::CloseForWriting() {}
+
+int64_t HttpRangeFile::Size() {
+  return size_;
+}
+
+bool HttpRangeFile::Flush() {
+  LOG(ERROR) << "HttpRangeFile does not support Flush().";
+  return false;
+}
+
+bool HttpRangeFile::Seek(uint64_t position) {
+  if (size_ < 0 || position > static_cast<uint64_t>(size_))
+    return false;
+  position_ = position;
+  return true;
+}
+
+bool HttpRangeFile::Tell(uint64_t* position) {
+  *position = position_;
+  return true;
+}
+
+void HttpRangeFile::RequestBlocks(uint64_t index, bool prefetch) {
+  const uint64_t size = static_cast<uint64_t>(size_);
+  const uint64_t num_blocks = (size + block_size_ - 1) / block_size_;
+  const uint64_t end_index = std::min<uint64_t>(
+      num_blocks, index + (prefetch ? num_parallel_requests_ : 1));
+
+  // Drop the blocks which are behind the read position or beyond the window.
+  for (auto it = blocks_.begin(); it != blocks_.end();) {
+    if (it->first >= index && it->first < end_index) {
+      ++it;
+      continue;
+    }
+    if (!it->second->done.HasBeenNotified())
+      dropped_blocks_.push_back(it->second);
+    it = blocks_.erase(it);
+  }
+  dropped_blocks_.erase(
+      std::remove_if(dropped_blocks_.begin(), dropped_blocks_.end(),
+                     [](const std::shared_ptr<Block>& block) {
+                       return block->done.HasBeenNotified();
+                     }),
+      dropped_blocks_.end());
+
+  for (uint64_t i = index; i < end_index; ++i) {
+    if (blocks_.count(i))
+      continue;
+    std::shared_ptr<Block> block = std::make_shared<Block>();
+    blocks_[i] = block;
+    const uint64_t start = i * block_size_;
+    ThreadPool::instance.PostTask(
+        std::bind(&FetchBlock, url_, start,
+                  std::min(block_size_, size - start), block));
+  }
+}
+
+void HttpRangeFile::WaitForPendingBlocks() {
+  for (const std::shared_ptr<Block>& block : dropped_blocks_)
+    block->done.WaitForNotification();
+  dropped_blocks_.clear();
+}
+
+}  // namespace shaka
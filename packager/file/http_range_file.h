@@ -0,0 +1,100 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_HTTP_RANGE_FILE_H_
+#define PACKAGER_FILE_HTTP_RANGE_FILE_H_
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <packager/file.h>
+
+namespace shaka {
+
+/// HttpRangeFile reads a network resource with byte range requests.
+///
+/// The resource is split in blocks which are downloaded with separate GET
+/// requests.  While the file is read sequentially, the blocks following the
+/// read position are requested in parallel ahead of time.  Unlike a GET
+/// HttpFile, this supports Size() and Seek(), e.g. to read 'moov' boxes which
+/// are after 'mdat' boxes.  The server has to support range requests and
+/// report the Content-Length in the response to a HEAD request.
+class HttpRangeFile : public File {
+ public:
+  /// @param url is the URL of the resource.
+  /// @param num_parallel_requests is the maximum number of blocks requested
+  ///        ahead of the read position.
+  /// @param block_size is the size, in bytes, of each range request.
+  HttpRangeFile(const std::string& url,
+                int32_t num_parallel_requests,
+                uint64_t block_size);
+
+  HttpRangeFile(const HttpRangeFile&) = delete;
+  HttpRangeFile& operator=(const HttpRangeFile&) = delete;
+
+  /// Download a byte range of a network resource with a GET request.
+  /// @param url is the URL of the resource.
+  /// @param start is the offset of the range.
+  /// @param size is the size of the range, which has to be within the
+  ///        resource.
+  /// @param buffer receives the @a size bytes of the range.
+  /// @return true on success.
+  static bool ReadRange(const std::string& url,
+                        uint64_t start,
+                        uint64_t size,
+                        uint8_t* buffer);
+
+  /// @name File implementation overrides.
+  /// @{
+  bool Close() override;
+  int64_t Read(void* buffer, uint64_t length) override;
+  int64_t Write(const void* buffer, uint64_t length) override;
+  void CloseForWriting() override;
+  int64_t Size() override;
+  bool Flush() override;
+  bool Seek(uint64_t position) override;
+  bool Tell(uint64_t* position) override;
+  bool Open() override;
+  /// @}
+
+ protected:
+  ~HttpRangeFile() override;
+
+ private:
+  struct Block;
+
+  // Downloads the bytes [start, start + size) of |url| into |block|.
+  static void FetchBlock(const std::string& url,
+                         uint64_t start,
+                         uint64_t size,
+                         std::shared_ptr<Block> block);
+  // Makes sure that the block at |index| is requested and, if |prefetch| is
+  // true, the blocks after it too.  Blocks outside of that window are dropped.
+  void RequestBlocks(uint64_t index, bool prefetch);
+  // Waits for the blocks which are still being downloaded.
+  void WaitForPendingBlocks();
+
+  const std::string url_;
+  const int32_t num_parallel_requests_;
+  const uint64_t block_size_;
+  int64_t size_ = -1;
+  uint64_t position_ = 0;
+  // The position right after the last read, used to detect sequential reads.
+  // The first read does not count as sequential.
+  uint64_t last_read_end_ = std::numeric_limits<uint64_t>::max();
+  // Requested blocks, by index.
+  std::map<uint64_t, std::shared_ptr<Block>> blocks_;
+  // Blocks which were dropped while they were still being downloaded.
+  std::vector<std::shared_ptr<Block>> dropped_blocks_;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_HTTP_RANGE_FILE_H_
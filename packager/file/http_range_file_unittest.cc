@@ -0,0 +1,113 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/http_range_file.h>
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <packager/file/file_closer.h>
+#include <packager/media/test/test_web_server.h>
+
+namespace shaka {
+
+namespace {
+
+// Small enough for a local server, but spanning several blocks.
+const int kContentSize = 100000;
+const uint64_t kBlockSize = 16384;
+const int32_t kNumParallelRequests = 3;
+
+using FilePtr = std::unique_ptr<HttpRangeFile, FileCloser>;
+
+class HttpRangeFileTest : public testing::Test {
+ protected:
+  void SetUp() override { ASSERT_TRUE(server_.Start()); }
+
+  FilePtr OpenFile() {
+    FilePtr file(new HttpRangeFile(server_.RangeUrl(kContentSize),
+                                   kNumParallelRequests, kBlockSize));
+    if (!file->Open())
+      file.release();
+    return file;
+  }
+
+  void ExpectContent(const std::vector<uint8_t>& data, int position) {
+    for (size_t i = 0; i < data.size(); ++i) {
+      ASSERT_EQ(media::TestWebServer::RangeContentByte(position + i), data[i])
+          << "at position " << position + i;
+    }
+  }
+
+  media::TestWebServer server_;
+};
+
+}  // namespace
+
+TEST_F(HttpRangeFileTest, ReadsSequentially) {
+  FilePtr file = OpenFile();
+  ASSERT_TRUE(file);
+  EXPECT_EQ(kContentSize, file->Size());
+
+  std::vector<uint8_t> content;
+  std::vector<uint8_t> buffer(10000);
+  while (true) {
+    const int64_t bytes_read = file->Read(buffer.data(), buffer.size());
+    ASSERT_GE(bytes_read, 0);
+    if (bytes_read == 0)
+      break;
+    content.insert(content.end(), buffer.begin(), buffer.begin() + bytes_read);
+  }
+  ASSERT_EQ(static_cast<size_t>(kContentSize), content.size());
+  ExpectContent(content, 0);
+  ASSERT_TRUE(file.release()->Close());
+}
+
+TEST_F(HttpRangeFileTest, Seeks) {
+  FilePtr file = OpenFile();
+  ASSERT_TRUE(file);
+
+  const int kPosition = 70000;
+  std::vector<uint8_t> buffer(16);
+  ASSERT_TRUE(file->Seek(kPosition));
+  ASSERT_EQ(16, file->Read(buffer.data(), buffer.size()));
+  ExpectContent(buffer, kPosition);
+
+  ASSERT_TRUE(file->Seek(0));
+  ASSERT_EQ(16, file->Read(buffer.data(), buffer.size()));
+  ExpectContent(buffer, 0);
+
+  uint64_t position = 0;
+  ASSERT_TRUE(file->Tell(&position));
+  EXPECT_EQ(16u, position);
+
+  ASSERT_TRUE(file->Seek(kContentSize));
+  EXPECT_EQ(0, file->Read(buffer.data(), buffer.size()));
+  EXPECT_FALSE(file->Seek(kContentSize + 1));
+  ASSERT_TRUE(file.release()->Close());
+}
+
+TEST_F(HttpRangeFileTest, ReadsAcrossBlocks) {
+  FilePtr file = OpenFile();
+  ASSERT_TRUE(file);
+
+  // Reads return at most the rest of a block.
+  const int kPosition = kBlockSize - 10;
+  std::vector<uint8_t> buffer(100);
+  ASSERT_TRUE(file->Seek(kPosition));
+  ASSERT_EQ(10, file->Read(buffer.data(), buffer.size()));
+  buffer.resize(10);
+  ExpectContent(buffer, kPosition);
+
+  buffer.resize(100);
+  ASSERT_EQ(100, file->Read(buffer.data(), buffer.size()));
+  ExpectContent(buffer, kBlockSize);
+  ASSERT_TRUE(file.release()->Close());
+}
+
+}  // namespace shaka
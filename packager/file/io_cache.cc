@@ -15,13 +15,20 @@
 #include <packager/macros/logging.h>
 
 namespace shaka {
+namespace {
+
+// The initial size of the circular buffer, which grows from there as needed.
+const uint64_t kInitialCapacity = 64 * 1024;
+
+}  // namespace
 
 IoCache::IoCache(uint64_t cache_size)
     : cache_size_(cache_size),
+      capacity_(std::min(cache_size, kInitialCapacity)),
       // Make the buffer one byte larger than the cache so that when the
       // condition r_ptr == w_ptr is unambiguous (buffer empty).
-      circular_buffer_(cache_size + 1),
-      end_ptr_(&circular_buffer_[0] + cache_size + 1),
+      circular_buffer_(capacity_ + 1),
+      end_ptr_(&circular_buffer_[0] + capacity_ + 1),
       r_ptr_(circular_buffer_.data()),
       w_ptr_(circular_buffer_.data()),
       closed_(false) {}
@@ -74,6 +81,8 @@ uint64_t IoCache::Write(const void* buffer, uint64_t size) {
       return 0;
 
     uint64_t write_size(std::min(bytes_left, BytesFreeInternal()));
+    if (BytesCachedInternal() + write_size > capacity_)
+      Grow(BytesCachedInternal() + write_size);
     uint64_t first_chunk_size(
         std::min(write_size, static_cast<uint64_t>(end_ptr_ - w_ptr_)));
     memcpy(w_ptr_, r_ptr, first_chunk_size);
@@ -136,6 +145,30 @@ uint64_t IoCache::BytesFreeInternal() {
   return cache_size_ - BytesCachedInternal();
 }
 
+void IoCache::Grow(uint64_t min_capacity) {
+  DCHECK_LE(min_capacity, cache_size_);
+  const uint64_t capacity =
+      std::min(cache_size_, std::max(capacity_ * 2, min_capacity));
+  const uint64_t bytes_cached = BytesCachedInternal();
+
+  // Move the cached data to the start of the new buffer.
+  std::vector<uint8_t, HugePageAllocator<uint8_t>> circular_buffer(
+      capacity + 1, circular_buffer_.get_allocator());
+  if (r_ptr_ <= w_ptr_) {
+    memcpy(circular_buffer.data(), r_ptr_, bytes_cached);
+  } else {
+    const uint64_t first_chunk_size = end_ptr_ - r_ptr_;
+    memcpy(circular_buffer.data(), r_ptr_, first_chunk_size);
+    memcpy(circular_buffer.data() + first_chunk_size, circular_buffer_.data(),
+           bytes_cached - first_chunk_size);
+  }
+  circular_buffer_.swap(circular_buffer);
+  capacity_ = capacity;
+  end_ptr_ = circular_buffer_.data() + capacity + 1;
+  r_ptr_ = circular_buffer_.data();
+  w_ptr_ = r_ptr_ + bytes_cached;
+}
+
 void IoCache::WaitUntilEmptyOrClosed() {
   absl::MutexLock lock(&mutex_);
   while (!closed_ && BytesCachedInternal()) {
@@ -13,14 +13,15 @@
 #include <absl/synchronization/mutex.h>
 
 #include <packager/macros/classes.h>
+#include <packager/utils/huge_pages.h>
 
 namespace shaka {
 
-/// Declaration of class which implements a thread-safe circular buffer.
-class IoCache {
+/// Interface of a thread-safe circular buffer which passes data from a writer
+/// to a reader.
+class IoCacheBase {
  public:
-  explicit IoCache(uint64_t cache_size);
-  ~IoCache();
+  virtual ~IoCacheBase() = default;
 
   /// Read data from the cache. This function may block until there is data in
   /// the cache.
@@ -28,7 +29,7 @@ class IoCache {
   /// @param size is the size of @a buffer.
   /// @return the number of bytes read into @a buffer, or 0 if the call
   ///         unblocked because the cache has been closed and is empty.
-  uint64_t Read(void* buffer, uint64_t size);
+  virtual uint64_t Read(void* buffer, uint64_t size) = 0;
 
   /// Write data to the cache. This function may block until there is enough
   /// room in the cache.
@@ -37,41 +38,69 @@ class IoCache {
   /// @return the amount of data written to the buffer (which will equal
   ///         @a data), or 0 if the call unblocked because the cache has been
   ///         closed.
-  uint64_t Write(const void* buffer, uint64_t size);
+  virtual uint64_t Write(const void* buffer, uint64_t size) = 0;
 
   /// Empties the cache.
-  void Clear();
+  virtual void Clear() = 0;
 
   /// Close the cache. This will call any blocking calls to unblock, and the
   /// cache won't be usable until Reopened.
-  void Close();
+  virtual void Close() = 0;
 
   /// @return true if the cache is closed, false otherwise.
-  bool closed() { return closed_; }
+  virtual bool closed() = 0;
 
   /// Reopens the cache. Any data still in the cache will be lost.
-  void Reopen();
+  virtual void Reopen() = 0;
 
   /// Returns the number of bytes in the cache.
   /// @return the number of bytes in the cache.
-  uint64_t BytesCached();
+  virtual uint64_t BytesCached() = 0;
 
   /// Returns the number of free bytes in the cache.
   /// @return the number of free bytes in the cache.
-  uint64_t BytesFree();
+  virtual uint64_t BytesFree() = 0;
 
   /// Waits until the cache is empty or has been closed.
-  void WaitUntilEmptyOrClosed();
+  virtual void WaitUntilEmptyOrClosed() = 0;
+};
+
+/// Declaration of class which implements a thread-safe circular buffer. The
+/// buffer starts small and grows up to the size of the cache as the data
+/// backs up, so that the caches of the many small files, e.g. manifests, or
+/// of the unused direction of an HTTP file take little memory.
+class IoCache : public IoCacheBase {
+ public:
+  explicit IoCache(uint64_t cache_size);
+  ~IoCache() override;
+
+  /// @name IoCacheBase implementation overrides.
+  /// @{
+  uint64_t Read(void* buffer, uint64_t size) override;
+  uint64_t Write(const void* buffer, uint64_t size) override;
+  void Clear() override;
+  void Close() override;
+  bool closed() override { return closed_; }
+  void Reopen() override;
+  uint64_t BytesCached() override;
+  uint64_t BytesFree() override;
+  void WaitUntilEmptyOrClosed() override;
+  /// @}
 
  private:
   uint64_t BytesCachedInternal();
   uint64_t BytesFreeInternal();
+  // Grows the circular buffer to hold at least |min_capacity| bytes.
+  void Grow(uint64_t min_capacity) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   const uint64_t cache_size_;
   absl::Mutex mutex_;
   absl::CondVar read_event_ ABSL_GUARDED_BY(mutex_);
   absl::CondVar write_event_ ABSL_GUARDED_BY(mutex_);
-  std::vector<uint8_t> circular_buffer_ ABSL_GUARDED_BY(mutex_);
+  // The most bytes the circular buffer holds, up to |cache_size_|.
+  uint64_t capacity_ ABSL_GUARDED_BY(mutex_);
+  std::vector<uint8_t, HugePageAllocator<uint8_t>> circular_buffer_
+      ABSL_GUARDED_BY(mutex_);
   const uint8_t* end_ptr_ ABSL_GUARDED_BY(mutex_);
   uint8_t* r_ptr_ ABSL_GUARDED_BY(mutex_);
   uint8_t* w_ptr_ ABSL_GUARDED_BY(mutex_);
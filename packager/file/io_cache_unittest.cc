@@ -10,9 +10,13 @@
 #include <chrono>
 #include <cstring>
 #include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include <packager/file/spsc_io_cache.h>
+#include <packager/utils/huge_pages.h>
+
 namespace {
 const uint64_t kBlockSize = 256;
 const uint64_t kCacheSize = 16 * kBlockSize;
@@ -20,7 +24,8 @@ const uint64_t kCacheSize = 16 * kBlockSize;
 
 namespace shaka {
 
-class IoCacheTest : public testing::Test {
+// The parameter selects SpscIoCache instead of IoCache.
+class IoCacheTest : public testing::TestWithParam<bool> {
  public:
   void WriteToCache(const std::vector<uint8_t>& test_buffer,
                     uint64_t num_writes,
@@ -48,7 +53,10 @@ class IoCacheTest : public testing::Test {
   void SetUp() override {
     for (unsigned int idx = 0; idx < kBlockSize; ++idx)
       reference_block_[idx] = idx & 0xff;
-    cache_.reset(new IoCache(kCacheSize));
+    if (GetParam())
+      cache_.reset(new SpscIoCache(kCacheSize));
+    else
+      cache_.reset(new IoCache(kCacheSize));
     cache_closed_ = false;
   }
 
@@ -81,13 +89,13 @@ class IoCacheTest : public testing::Test {
     }
   }
 
-  std::unique_ptr<IoCache> cache_;
+  std::unique_ptr<IoCacheBase> cache_;
   std::unique_ptr<std::thread> writer_thread_;
   uint8_t reference_block_[kBlockSize];
   bool cache_closed_;
 };
 
-TEST_F(IoCacheTest, VerySmallWrite) {
+TEST_P(IoCacheTest, VerySmallWrite) {
   const uint64_t kTestBytes(5);
 
   std::vector<uint8_t> write_buffer;
@@ -99,7 +107,7 @@ TEST_F(IoCacheTest, VerySmallWrite) {
   EXPECT_EQ(write_buffer, read_buffer);
 }
 
-TEST_F(IoCacheTest, LotsOfAlignedBlocks) {
+TEST_P(IoCacheTest, LotsOfAlignedBlocks) {
   const uint64_t kNumWrites(kCacheSize * 1000 / kBlockSize);
 
   std::vector<uint8_t> write_buffer;
@@ -112,7 +120,7 @@ TEST_F(IoCacheTest, LotsOfAlignedBlocks) {
   }
 }
 
-TEST_F(IoCacheTest, LotsOfUnalignedBlocks) {
+TEST_P(IoCacheTest, LotsOfUnalignedBlocks) {
   const uint64_t kNumWrites(kCacheSize * 1000 / kBlockSize);
   const uint64_t kUnalignBlockSize(55);
 
@@ -143,7 +151,7 @@ TEST_F(IoCacheTest, LotsOfUnalignedBlocks) {
   }
 }
 
-TEST_F(IoCacheTest, SlowWrite) {
+TEST_P(IoCacheTest, SlowWrite) {
   const int kWriteDelayMs(50);
   const uint64_t kNumWrites(kCacheSize * 5 / kBlockSize);
 
@@ -157,7 +165,7 @@ TEST_F(IoCacheTest, SlowWrite) {
   }
 }
 
-TEST_F(IoCacheTest, SlowRead) {
+TEST_P(IoCacheTest, SlowRead) {
   const int kReadDelayMs(50);
   const uint64_t kNumWrites(kCacheSize * 5 / kBlockSize);
 
@@ -172,7 +180,7 @@ TEST_F(IoCacheTest, SlowRead) {
   }
 }
 
-TEST_F(IoCacheTest, CloseByReader) {
+TEST_P(IoCacheTest, CloseByReader) {
   const uint64_t kNumWrites(kCacheSize * 1000 / kBlockSize);
 
   std::vector<uint8_t> write_buffer;
@@ -186,7 +194,7 @@ TEST_F(IoCacheTest, CloseByReader) {
   EXPECT_TRUE(cache_closed_);
 }
 
-TEST_F(IoCacheTest, CloseByWriter) {
+TEST_P(IoCacheTest, CloseByWriter) {
   uint8_t test_buffer[kBlockSize];
   std::vector<uint8_t> write_buffer;
   WriteToCacheThreaded(write_buffer, 0, 0, true);
@@ -194,7 +202,7 @@ TEST_F(IoCacheTest, CloseByWriter) {
   WaitForWriterThread();
 }
 
-TEST_F(IoCacheTest, Reopen) {
+TEST_P(IoCacheTest, Reopen) {
   const uint64_t kTestBytes1(5);
   const uint64_t kTestBytes2(10);
 
@@ -218,7 +226,7 @@ TEST_F(IoCacheTest, Reopen) {
   EXPECT_EQ(write_buffer, read_buffer);
 }
 
-TEST_F(IoCacheTest, SingleLargeWrite) {
+TEST_P(IoCacheTest, SingleLargeWrite) {
   const uint64_t kTestBytes(kCacheSize * 10);
 
   std::vector<uint8_t> write_buffer;
@@ -233,7 +241,7 @@ TEST_F(IoCacheTest, SingleLargeWrite) {
   EXPECT_EQ(write_buffer, read_buffer);
 }
 
-TEST_F(IoCacheTest, LargeRead) {
+TEST_P(IoCacheTest, LargeRead) {
   const uint64_t kNumWrites(kCacheSize * 10 / kBlockSize);
 
   std::vector<uint8_t> write_buffer;
@@ -253,4 +261,56 @@ TEST_F(IoCacheTest, LargeRead) {
   cache_->Close();
 }
 
+// The circular buffer grows while it holds wrapped around data.
+TEST(IoCacheGrowthTest, KeepsDataInOrder) {
+  const uint64_t kLargeCacheSize = 1024 * 1024;
+  IoCache cache(kLargeCacheSize);
+
+  std::vector<uint8_t> data(200 * 1024);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<uint8_t>(i % 251);
+
+  std::vector<uint8_t> read_buffer(data.size());
+  // Fill most of the initial buffer, then wrap around.
+  const uint64_t kFirstWriteSize = 60 * 1024;
+  const uint64_t kFirstReadSize = 50 * 1024;
+  const uint64_t kSecondWriteSize = 20 * 1024;
+  ASSERT_EQ(kFirstWriteSize, cache.Write(data.data(), kFirstWriteSize));
+  ASSERT_EQ(kFirstReadSize, cache.Read(read_buffer.data(), kFirstReadSize));
+  ASSERT_EQ(kSecondWriteSize,
+            cache.Write(data.data() + kFirstWriteSize, kSecondWriteSize));
+  const uint64_t kBytesWritten = kFirstWriteSize + kSecondWriteSize;
+  ASSERT_EQ(data.size() - kBytesWritten,
+            cache.Write(data.data() + kBytesWritten,
+                        data.size() - kBytesWritten));
+  EXPECT_EQ(data.size() - kFirstReadSize, cache.BytesCached());
+  EXPECT_EQ(kLargeCacheSize - cache.BytesCached(), cache.BytesFree());
+
+  ASSERT_EQ(data.size() - kFirstReadSize,
+            cache.Read(read_buffer.data() + kFirstReadSize,
+                       data.size() - kFirstReadSize));
+  EXPECT_EQ(data, read_buffer);
+}
+
+// Caches larger than a huge page are backed by huge pages if enabled.
+TEST(IoCacheHugePagesTest, LargeCache) {
+  const uint64_t kLargeCacheSize = 3 * HugePages::kHugePageSize;
+  HugePages::SetMode(HugePages::Mode::kTransparent);
+  SpscIoCache cache(kLargeCacheSize);
+  HugePages::SetMode(HugePages::Mode::kNone);
+
+  std::vector<uint8_t> data(kLargeCacheSize);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<uint8_t>(i % 251);
+  ASSERT_EQ(data.size(), cache.Write(data.data(), data.size()));
+
+  std::vector<uint8_t> read_buffer(data.size());
+  ASSERT_EQ(data.size(), cache.Read(read_buffer.data(), read_buffer.size()));
+  EXPECT_EQ(data, read_buffer);
+}
+
+INSTANTIATE_TEST_CASE_P(LockedAndLockFree,
+                        IoCacheTest,
+                        testing::Values(false, true));
+
 }  // namespace shaka
@@ -9,11 +9,17 @@
 #if defined(OS_WIN)
 #include <windows.h>
 #else
+#include <fcntl.h>
+#include <limits.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #endif  // defined(OS_WIN)
 
+#include <algorithm>
+#include <cerrno>
 #include <cstdio>
 #include <filesystem>
+#include <vector>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
@@ -24,6 +30,9 @@ namespace shaka {
 
 // Always open files in binary mode.
 const char kAdditionalFileMode[] = "b";
+// Size of the stdio buffer. The default is the file system block size, which
+// turns a stream of small box writes into one syscall every few KB.
+const size_t kStdioBufferSize = 0x40000;  // 256KB.
 
 LocalFile::LocalFile(const char* file_name, const char* mode)
     : File(file_name), file_mode_(mode), internal_file_(NULL) {
@@ -65,6 +74,69 @@ int64_t LocalFile::Write(const void* buffer, uint64_t length) {
   return bytes_written;
 }
 
+int64_t LocalFile::WriteV(const IoBuffer* buffers, size_t num_buffers) {
+#if defined(OS_WIN)
+  return File::WriteV(buffers, num_buffers);
+#else
+  // Writes to files opened for appending go to the end whatever the offset
+  // given to pwritev.
+  if (file_mode_.find("a") != std::string::npos)
+    return File::WriteV(buffers, num_buffers);
+
+  // The data buffered by stdio goes first.
+  uint64_t position = 0;
+  if (!Flush() || !Tell(&position))
+    return -1;
+
+  std::vector<struct iovec> iovecs(num_buffers);
+  for (size_t i = 0; i < num_buffers; ++i) {
+    iovecs[i].iov_base = const_cast<void*>(buffers[i].data);
+    iovecs[i].iov_len = buffers[i].size;
+  }
+
+  const int fd = fileno(internal_file_);
+  int64_t total_bytes_written = 0;
+  size_t index = 0;
+  while (index < iovecs.size()) {
+    if (iovecs[index].iov_len == 0) {
+      ++index;
+      continue;
+    }
+    const int count =
+        static_cast<int>(std::min<size_t>(iovecs.size() - index, IOV_MAX));
+    const ssize_t bytes_written =
+        pwritev(fd, &iovecs[index], count, position + total_bytes_written);
+    if (bytes_written < 0) {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    if (bytes_written == 0)
+      return -1;
+    total_bytes_written += bytes_written;
+
+    // Skip what was written, which may end within a block.
+    size_t remaining_bytes = static_cast<size_t>(bytes_written);
+    while (index < iovecs.size() && remaining_bytes >= iovecs[index].iov_len) {
+      remaining_bytes -= iovecs[index].iov_len;
+      ++index;
+    }
+    if (index < iovecs.size()) {
+      iovecs[index].iov_base =
+          static_cast<uint8_t*>(iovecs[index].iov_base) + remaining_bytes;
+      iovecs[index].iov_len -= remaining_bytes;
+    }
+  }
+  VLOG(2) << "WriteV " << num_buffers << " buffers return "
+          << total_bytes_written;
+
+  // Moves the stdio stream past the data written.
+  if (!Seek(position + total_bytes_written))
+    return -1;
+  return total_bytes_written;
+#endif  // defined(OS_WIN)
+}
+
 void LocalFile::CloseForWriting() {}
 
 int64_t LocalFile::Size() {
@@ -132,7 +204,22 @@ bool LocalFile::Open() {
   }
 
   internal_file_ = fopen(file_path.u8string().c_str(), file_mode_.c_str());
-  return (internal_file_ != NULL);
+  if (!internal_file_)
+    return false;
+
+  // Must be done before any I/O on the stream. Failure is not fatal, the
+  // default buffer is used instead.
+  if (setvbuf(internal_file_, NULL, _IOFBF, kStdioBufferSize) != 0)
+    VLOG(1) << "Cannot set the stdio buffer size for " << file_name();
+
+#if defined(__linux__)
+  // Files are mostly read front to back, so ask the kernel for a larger read
+  // ahead window.
+  if (file_mode_.find("r") != std::string::npos) {
+    posix_fadvise(fileno(internal_file_), 0, 0, POSIX_FADV_SEQUENTIAL);
+  }
+#endif  // defined(__linux__)
+  return true;
 }
 
 bool LocalFile::Delete(const char* file_name) {
@@ -28,6 +28,7 @@ class LocalFile : public File {
   bool Close() override;
   int64_t Read(void* buffer, uint64_t length) override;
   int64_t Write(const void* buffer, uint64_t length) override;
+  int64_t WriteV(const IoBuffer* buffers, size_t num_buffers) override;
   void CloseForWriting() override;
   int64_t Size() override;
   bool Flush() override;
@@ -0,0 +1,90 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/mapped_file.h>
+
+#if !defined(OS_WIN)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !defined(OS_WIN)
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <absl/log/log.h>
+#include <absl/strings/match.h>
+
+#include <packager/file.h>
+#include <packager/macros/logging.h>
+
+namespace shaka {
+
+MappedFile::MappedFile(const uint8_t* data, uint64_t size)
+    : data_(data), size_(size) {}
+
+MappedFile::~MappedFile() {
+#if !defined(OS_WIN)
+  munmap(const_cast<uint8_t*>(data_), size_);
+#endif  // !defined(OS_WIN)
+}
+
+// static
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& file_name) {
+#if defined(OS_WIN)
+  return nullptr;
+#else
+  if (!File::IsLocalRegularFile(file_name.c_str()))
+    return nullptr;
+  const std::string path =
+      absl::StartsWith(file_name, kLocalFilePrefix)
+          ? file_name.substr(strlen(kLocalFilePrefix))
+          : file_name;
+
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return nullptr;
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+    close(fd);
+    return nullptr;
+  }
+  const uint64_t size = static_cast<uint64_t>(file_stat.st_size);
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  if (data == MAP_FAILED) {
+    VLOG(1) << "Cannot memory map " << file_name << ": " << strerror(errno);
+    return nullptr;
+  }
+  return std::unique_ptr<MappedFile>(
+      new MappedFile(static_cast<const uint8_t*>(data), size));
+#endif  // defined(OS_WIN)
+}
+
+void MappedFile::AdviseSequential() {
+#if !defined(OS_WIN)
+  madvise(const_cast<uint8_t*>(data_), size_, MADV_SEQUENTIAL);
+#endif  // !defined(OS_WIN)
+}
+
+void MappedFile::ReleaseBefore(uint64_t position) {
+#if !defined(OS_WIN)
+  static const uint64_t kPageSize = sysconf(_SC_PAGESIZE);
+  position = std::min(position, size_) / kPageSize * kPageSize;
+  if (position <= released_position_)
+    return;
+  // Dropping the pages of a read only private file mapping only affects this
+  // process; the pages are read back from the file if accessed again.
+  madvise(const_cast<uint8_t*>(data_) + released_position_,
+          position - released_position_, MADV_DONTNEED);
+  released_position_ = position;
+#endif  // !defined(OS_WIN)
+}
+
+}  // namespace shaka
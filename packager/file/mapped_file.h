@@ -0,0 +1,53 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_MAPPED_FILE_H_
+#define PACKAGER_FILE_MAPPED_FILE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace shaka {
+
+/// A read-only memory mapping of a whole local file.
+class MappedFile {
+ public:
+  ~MappedFile();
+
+  /// Map a local regular file into memory.
+  /// @param file_name is the name of the file, which may have the "file://"
+  ///        prefix.
+  /// @return the mapping on success, or nullptr if the file is not a local
+  ///         regular file, is empty, or memory mapping is not supported.
+  static std::unique_ptr<MappedFile> Open(const std::string& file_name);
+
+  /// Tell the kernel that the file will be read front to back, so it reads
+  /// ahead aggressively.
+  void AdviseSequential();
+
+  /// Tell the kernel that the bytes before @a position will not be accessed
+  /// anymore, so the pages backing them can be dropped from this process.
+  /// Only whole pages are released.
+  void ReleaseBefore(uint64_t position);
+
+  const uint8_t* data() const { return data_; }
+  uint64_t size() const { return size_; }
+
+ private:
+  MappedFile(const uint8_t* data, uint64_t size);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const uint8_t* const data_;
+  const uint64_t size_;
+  // Bytes before this position have already been released.
+  uint64_t released_position_ = 0;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_MAPPED_FILE_H_
@@ -8,9 +8,9 @@
 
 #include <algorithm>
 #include <cstring>  // for memcpy
-#include <map>
+#include <functional>
 #include <memory>
-#include <set>
+#include <unordered_map>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
@@ -19,9 +19,104 @@
 #include <packager/macros/logging.h>
 
 namespace shaka {
+
+// The data of a memory file, in chunks which are never moved or resized.
+// Chunks double in size up to kMaxChunkSize, so that small files stay small
+// and large files have few chunks.
+class MemoryFileData {
+ public:
+  uint64_t size() const { return size_; }
+
+  void Clear() {
+    chunks_.clear();
+    chunk_offsets_.clear();
+    capacity_ = 0;
+    size_ = 0;
+  }
+
+  // |position| must not be past the end of the data.
+  void Write(uint64_t position, const uint8_t* data, uint64_t length) {
+    DCHECK_LE(position, size_);
+    if (length == 0)
+      return;
+    while (capacity_ < position + length) {
+      const uint64_t chunk_size =
+          std::min(std::max(capacity_, kMinChunkSize), kMaxChunkSize);
+      chunks_.emplace_back(new uint8_t[chunk_size]);
+      chunk_offsets_.push_back(capacity_);
+      capacity_ += chunk_size;
+    }
+
+    for (size_t i = FindChunk(position); length > 0; ++i) {
+      const uint64_t offset = position - chunk_offsets_[i];
+      const uint64_t bytes_to_copy = std::min(length, ChunkSize(i) - offset);
+      memcpy(chunks_[i].get() + offset, data, bytes_to_copy);
+      position += bytes_to_copy;
+      data += bytes_to_copy;
+      length -= bytes_to_copy;
+    }
+    size_ = std::max(size_, position);
+  }
+
+  // |position| must not be past the end of the data.
+  uint64_t Read(uint64_t position, uint8_t* data, uint64_t length) const {
+    DCHECK_LE(position, size_);
+    length = std::min(length, size_ - position);
+    if (length == 0)
+      return 0;
+    const uint64_t bytes_read = length;
+    for (size_t i = FindChunk(position); length > 0; ++i) {
+      const uint64_t offset = position - chunk_offsets_[i];
+      const uint64_t bytes_to_copy = std::min(length, ChunkSize(i) - offset);
+      memcpy(data, chunks_[i].get() + offset, bytes_to_copy);
+      position += bytes_to_copy;
+      data += bytes_to_copy;
+      length -= bytes_to_copy;
+    }
+    return bytes_read;
+  }
+
+  std::vector<absl::Span<const uint8_t>> GetSpans() const {
+    std::vector<absl::Span<const uint8_t>> spans;
+    for (size_t i = 0; i < chunks_.size() && chunk_offsets_[i] < size_; ++i) {
+      spans.emplace_back(chunks_[i].get(),
+                         std::min(ChunkSize(i), size_ - chunk_offsets_[i]));
+    }
+    return spans;
+  }
+
+ private:
+  static constexpr uint64_t kMinChunkSize = 4 << 10;
+  static constexpr uint64_t kMaxChunkSize = 1 << 20;
+
+  uint64_t ChunkSize(size_t index) const {
+    const uint64_t end = index + 1 < chunk_offsets_.size()
+                             ? chunk_offsets_[index + 1]
+                             : capacity_;
+    return end - chunk_offsets_[index];
+  }
+
+  // The index of the chunk holding |position|, which must be below the
+  // capacity.
+  size_t FindChunk(uint64_t position) const {
+    auto iter = std::upper_bound(chunk_offsets_.begin(), chunk_offsets_.end(),
+                                 position);
+    return iter - chunk_offsets_.begin() - 1;
+  }
+
+  std::vector<std::unique_ptr<uint8_t[]>> chunks_;
+  // The offset of each chunk in the file.
+  std::vector<uint64_t> chunk_offsets_;
+  uint64_t capacity_ = 0;
+  uint64_t size_ = 0;
+};
+
 namespace {
 
-// A helper filesystem object.  This holds the data for the memory files.
+// A helper filesystem object.  This holds the data for the memory files. The
+// files are spread over shards, each with its own lock, so that the files of
+// different threads seldom contend. The data of an open file is only touched
+// by its MemoryFile, without a lock.
 class FileSystem {
  public:
   ~FileSystem() {}
@@ -32,82 +127,102 @@ class FileSystem {
   }
 
   void Delete(const std::string& file_name) {
-    absl::MutexLock auto_lock(&mutex_);
+    Shard& shard = GetShard(file_name);
+    absl::MutexLock auto_lock(&shard.mutex);
 
-    if (open_files_.find(file_name) != open_files_.end()) {
+    if (shard.open_files.find(file_name) != shard.open_files.end()) {
       LOG(ERROR) << "File '" << file_name
                  << "' is still open. Deleting an open MemoryFile is not "
                     "allowed. Exit without deleting the file.";
       return;
     }
 
-    files_.erase(file_name);
+    shard.files.erase(file_name);
   }
 
   void DeleteAll() {
-    absl::MutexLock auto_lock(&mutex_);
-    if (!open_files_.empty()) {
-      LOG(ERROR) << "There are still files open. Deleting an open MemoryFile "
-                    "is not allowed. Exit without deleting the file.";
-      return;
+    for (Shard& shard : shards_) {
+      absl::MutexLock auto_lock(&shard.mutex);
+      if (!shard.open_files.empty()) {
+        LOG(ERROR) << "There are still files open. Deleting an open "
+                      "MemoryFile is not allowed. Exit without deleting the "
+                      "file.";
+        return;
+      }
+    }
+    for (Shard& shard : shards_) {
+      absl::MutexLock auto_lock(&shard.mutex);
+      shard.files.clear();
     }
-    files_.clear();
   }
 
-  std::vector<uint8_t>* Open(const std::string& file_name,
-                             const std::string& mode) {
-    absl::MutexLock auto_lock(&mutex_);
+  MemoryFileData* Open(const std::string& file_name, const std::string& mode) {
+    Shard& shard = GetShard(file_name);
+    absl::MutexLock auto_lock(&shard.mutex);
 
-    if (open_files_.find(file_name) != open_files_.end()) {
+    if (shard.open_files.find(file_name) != shard.open_files.end()) {
       NOTIMPLEMENTED() << "File '" << file_name
                        << "' is already open. MemoryFile does not support "
                           "opening the same file before it is closed.";
       return nullptr;
     }
 
-    auto iter = files_.find(file_name);
+    auto iter = shard.files.find(file_name);
     if (mode == "r") {
-      if (iter == files_.end())
+      if (iter == shard.files.end())
         return nullptr;
     } else if (mode == "w") {
-      if (iter != files_.end())
-        iter->second.clear();
+      if (iter != shard.files.end())
+        iter->second.Clear();
     } else {
       NOTIMPLEMENTED() << "File mode '" << mode
                        << "' not supported by MemoryFile";
       return nullptr;
     }
 
-    open_files_[file_name] = mode;
-    return &files_[file_name];
+    shard.open_files[file_name] = mode;
+    // The elements of an unordered_map are never moved.
+    return &shard.files[file_name];
   }
 
   bool Close(const std::string& file_name) {
-    absl::MutexLock auto_lock(&mutex_);
+    Shard& shard = GetShard(file_name);
+    absl::MutexLock auto_lock(&shard.mutex);
 
-    auto iter = open_files_.find(file_name);
-    if (iter == open_files_.end()) {
+    auto iter = shard.open_files.find(file_name);
+    if (iter == shard.open_files.end()) {
       LOG(ERROR) << "Cannot close file '" << file_name
                  << "' which is not open.";
       return false;
     }
 
-    open_files_.erase(iter);
+    shard.open_files.erase(iter);
     return true;
   }
 
  private:
+  static const size_t kNumShards = 16;
+
+  struct Shard {
+    absl::Mutex mutex;
+    // Filename to file data map.
+    std::unordered_map<std::string, MemoryFileData> files
+        ABSL_GUARDED_BY(mutex);
+    // Filename to file open modes map.
+    std::unordered_map<std::string, std::string> open_files
+        ABSL_GUARDED_BY(mutex);
+  };
+
   FileSystem(const FileSystem&) = delete;
   FileSystem& operator=(const FileSystem&) = delete;
 
   FileSystem() = default;
 
-  // Filename to file data map.
-  std::map<std::string, std::vector<uint8_t>> files_ ABSL_GUARDED_BY(mutex_);
-  // Filename to file open modes map.
-  std::map<std::string, std::string> open_files_ ABSL_GUARDED_BY(mutex_);
+  Shard& GetShard(const std::string& file_name) {
+    return shards_[std::hash<std::string>()(file_name) % kNumShards];
+  }
 
-  absl::Mutex mutex_;
+  Shard shards_[kNumShards];
 };
 
 }  // namespace
@@ -130,26 +245,14 @@ int64_t MemoryFile::Read(void* buffer, uint64_t length) {
   if (position_ >= size)
     return 0;
 
-  const uint64_t bytes_to_read = std::min(length, size - position_);
-  memcpy(buffer, &(*file_)[position_], bytes_to_read);
-  position_ += bytes_to_read;
-  return bytes_to_read;
+  const uint64_t bytes_read =
+      file_->Read(position_, static_cast<uint8_t*>(buffer), length);
+  position_ += bytes_read;
+  return bytes_read;
 }
 
 int64_t MemoryFile::Write(const void* buffer, uint64_t length) {
-  // If length is zero, we won't resize the buffer and it is possible for
-  // |position| to equal the length of the buffer. This will cause a segfault
-  // when indexing into the buffer for the memcpy.
-  if (length == 0) {
-    return 0;
-  }
-
-  const uint64_t size = Size();
-  if (size < position_ + length) {
-    file_->resize(position_ + length);
-  }
-
-  memcpy(&(*file_)[position_], buffer, length);
+  file_->Write(position_, static_cast<const uint8_t*>(buffer), length);
   position_ += length;
   return length;
 }
@@ -178,6 +281,11 @@ bool MemoryFile::Tell(uint64_t* position) {
   return true;
 }
 
+std::vector<absl::Span<const uint8_t>> MemoryFile::GetSpans() const {
+  DCHECK(file_);
+  return file_->GetSpans();
+}
+
 bool MemoryFile::Open() {
   file_ = FileSystem::Instance()->Open(file_name(), mode_);
   if (!file_)
@@ -11,13 +11,18 @@
 #include <string>
 #include <vector>
 
+#include <absl/types/span.h>
+
 #include <packager/file.h>
 #include <packager/macros/classes.h>
 
 namespace shaka {
 
-/// Implements a File that is stored in memory.  This should be only used for
-/// testing, since this does not support larger files.
+class MemoryFileData;
+
+/// Implements a File that is stored in memory, e.g. to hand the outputs to
+/// the application without touching the disk. The data of a file is stored
+/// in chunks, so that writes never copy the data written before.
 class MemoryFile : public File {
  public:
   MemoryFile(const std::string& file_name, const std::string& mode);
@@ -34,6 +39,10 @@ class MemoryFile : public File {
   bool Tell(uint64_t* position) override;
   /// @}
 
+  /// @return The data of the file, as spans of its chunks, to be read without
+  ///         copying. They are valid until the file is written to or closed.
+  std::vector<absl::Span<const uint8_t>> GetSpans() const;
+
   /// Deletes all memory file data created.  This assumes that there are no
   /// MemoryFile objects alive.  Any alive objects will be in an undefined
   /// state.
@@ -48,7 +57,7 @@ class MemoryFile : public File {
 
  private:
   std::string mode_;
-  std::vector<uint8_t>* file_;
+  MemoryFileData* file_;
   uint64_t position_;
 
   DISALLOW_COPY_AND_ASSIGN(MemoryFile);
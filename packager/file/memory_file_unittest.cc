@@ -4,7 +4,10 @@
 
 #include <packager/file/memory_file.h>
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -112,4 +115,53 @@ TEST_F(MemoryFileTest, WriteExistingFileDeletes) {
   EXPECT_EQ(0, file2->Size());
 }
 
+TEST_F(MemoryFileTest, LargeFile) {
+  // Spans several chunks.
+  std::vector<uint8_t> data(3 << 20);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<uint8_t>(i * 7);
+
+  std::unique_ptr<File, FileCloser> writer(File::Open("memory://file1", "w"));
+  ASSERT_TRUE(writer);
+  // Written in pieces which straddle the chunks, and overwritten in part.
+  const size_t kPieceSize = 100000;
+  for (size_t offset = 0; offset < data.size(); offset += kPieceSize) {
+    const size_t size = std::min(kPieceSize, data.size() - offset);
+    ASSERT_EQ(static_cast<int64_t>(size), writer->Write(&data[offset], size));
+  }
+  ASSERT_TRUE(writer->Seek(5000));
+  ASSERT_EQ(kWriteBufferSize, writer->Write(kWriteBuffer, kWriteBufferSize));
+  memcpy(&data[5000], kWriteBuffer, kWriteBufferSize);
+  writer.release()->Close();
+
+  std::unique_ptr<File, FileCloser> reader(File::Open("memory://file1", "r"));
+  ASSERT_TRUE(reader);
+  ASSERT_EQ(static_cast<int64_t>(data.size()), reader->Size());
+  std::vector<uint8_t> read_data(data.size());
+  ASSERT_EQ(static_cast<int64_t>(data.size()),
+            reader->Read(read_data.data(), read_data.size()));
+  EXPECT_EQ(data, read_data);
+}
+
+TEST_F(MemoryFileTest, GetSpans) {
+  std::vector<uint8_t> data(100000);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<uint8_t>(i);
+
+  std::unique_ptr<File, FileCloser> writer(File::Open("memory://file1", "w"));
+  ASSERT_TRUE(writer);
+  ASSERT_EQ(static_cast<int64_t>(data.size()),
+            writer->Write(data.data(), data.size()));
+  writer.release()->Close();
+
+  std::unique_ptr<File, FileCloser> reader(File::Open("memory://file1", "r"));
+  ASSERT_TRUE(reader);
+  std::vector<uint8_t> span_data;
+  for (absl::Span<const uint8_t> span :
+       static_cast<MemoryFile*>(reader.get())->GetSpans()) {
+    span_data.insert(span_data.end(), span.begin(), span.end());
+  }
+  EXPECT_EQ(data, span_data);
+}
+
 }  // namespace shaka
@@ -0,0 +1,402 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/shm_file.h>
+
+#if !defined(OS_WIN)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !defined(OS_WIN)
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <thread>
+
+#include <absl/flags/flag.h>
+#include <absl/log/log.h>
+#include <absl/synchronization/mutex.h>
+
+#include <packager/macros/logging.h>
+
+ABSL_FLAG(uint64_t,
+          shm_ring_size,
+          256ULL << 20,
+          "The size of the data of the shared memory rings created for "
+          "shm:// outputs, in bytes. The oldest objects are overwritten when "
+          "a ring is full, so it should hold more than the live windows of "
+          "its outputs.");
+ABSL_FLAG(uint64_t,
+          shm_ring_index_size,
+          4096,
+          "The number of objects indexed by the shared memory rings created "
+          "for shm:// outputs.");
+
+namespace shaka {
+namespace {
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "The ring is shared with other processes.");
+
+const uint64_t kAlignment = 64;
+
+uint64_t AlignUp(uint64_t size) {
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+uint64_t GetEntriesOffset() {
+  return AlignUp(sizeof(ShmRingHeader));
+}
+
+uint64_t GetDataOffset(uint64_t num_entries) {
+  return AlignUp(GetEntriesOffset() + num_entries * sizeof(ShmRingEntry));
+}
+
+// Splits "<ring name>/<object name>".
+bool SplitFileName(const std::string& file_name,
+                   std::string* ring_name,
+                   std::string* object_name) {
+  const size_t pos = file_name.find('/');
+  if (pos == 0 || pos == std::string::npos || pos + 1 == file_name.size()) {
+    LOG(ERROR) << "Expecting <ring name>/<object name> for shm file "
+               << file_name;
+    return false;
+  }
+  *ring_name = file_name.substr(0, pos);
+  *object_name = file_name.substr(pos + 1);
+  return true;
+}
+
+}  // namespace
+
+ShmRing::ShmRing(uint8_t* mapping, uint64_t mapping_size)
+    : header_(reinterpret_cast<ShmRingHeader*>(mapping)),
+      entries_(reinterpret_cast<ShmRingEntry*>(mapping + GetEntriesOffset())),
+      data_(mapping + GetDataOffset(header_->num_entries)) {
+  DCHECK_LE(GetDataOffset(header_->num_entries) + header_->data_size,
+            mapping_size);
+}
+
+// static
+ShmRing* ShmRing::Get(const std::string& ring_name) {
+#if defined(OS_WIN)
+  NOTIMPLEMENTED() << "Shared memory files are not supported on Windows.";
+  return nullptr;
+#else
+  static absl::Mutex mutex(absl::kConstInit);
+  // The rings are never unmapped, as objects found may still be read.
+  static auto* const rings = new std::map<std::string, ShmRing*>;
+
+  absl::MutexLock lock(&mutex);
+  auto iter = rings->find(ring_name);
+  if (iter != rings->end())
+    return iter->second;
+
+  const std::string shm_name = "/" + ring_name;
+  bool created = true;
+  int fd = shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+  if (fd < 0 && errno == EEXIST) {
+    created = false;
+    fd = shm_open(shm_name.c_str(), O_RDWR, 0666);
+  }
+  if (fd < 0) {
+    LOG(ERROR) << "Cannot open shared memory " << shm_name << ": "
+               << strerror(errno);
+    return nullptr;
+  }
+
+  uint64_t mapping_size = 0;
+  if (created) {
+    const uint64_t num_entries =
+        std::max<uint64_t>(absl::GetFlag(FLAGS_shm_ring_index_size), 1);
+    const uint64_t data_size =
+        AlignUp(std::max<uint64_t>(absl::GetFlag(FLAGS_shm_ring_size), 1));
+    mapping_size = GetDataOffset(num_entries) + data_size;
+    if (ftruncate(fd, static_cast<off_t>(mapping_size)) != 0) {
+      LOG(ERROR) << "Cannot size shared memory " << shm_name << ": "
+                 << strerror(errno);
+      close(fd);
+      shm_unlink(shm_name.c_str());
+      return nullptr;
+    }
+  } else {
+    // The creator may not have sized it yet.
+    struct stat shm_stat = {};
+    for (int i = 0; i < 100; ++i) {
+      if (fstat(fd, &shm_stat) == 0 && shm_stat.st_size > 0)
+        break;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    mapping_size = static_cast<uint64_t>(shm_stat.st_size);
+    if (mapping_size < sizeof(ShmRingHeader)) {
+      LOG(ERROR) << "Shared memory " << shm_name << " is not a ring.";
+      close(fd);
+      return nullptr;
+    }
+  }
+
+  void* mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    LOG(ERROR) << "Cannot map shared memory " << shm_name << ": "
+               << strerror(errno);
+    return nullptr;
+  }
+
+  // The memory of a new shared memory object is zeroed.
+  ShmRingHeader* header = static_cast<ShmRingHeader*>(mapping);
+  if (created) {
+    header->version = ShmRingHeader::kVersion;
+    header->num_entries =
+        std::max<uint64_t>(absl::GetFlag(FLAGS_shm_ring_index_size), 1);
+    header->data_size = mapping_size - GetDataOffset(header->num_entries);
+    header->magic.store(ShmRingHeader::kMagic, std::memory_order_release);
+  } else {
+    for (int i = 0; i < 100 && header->magic.load(std::memory_order_acquire) !=
+                                   ShmRingHeader::kMagic;
+         ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (header->magic.load(std::memory_order_acquire) !=
+            ShmRingHeader::kMagic ||
+        header->version != ShmRingHeader::kVersion ||
+        GetDataOffset(header->num_entries) + header->data_size >
+            mapping_size) {
+      LOG(ERROR) << "Shared memory " << shm_name
+                 << " is not a ring of this version.";
+      munmap(mapping, mapping_size);
+      return nullptr;
+    }
+  }
+
+  ShmRing* ring = new ShmRing(static_cast<uint8_t*>(mapping), mapping_size);
+  (*rings)[ring_name] = ring;
+  return ring;
+#endif  // defined(OS_WIN)
+}
+
+// static
+bool ShmRing::Unlink(const std::string& ring_name) {
+#if defined(OS_WIN)
+  return false;
+#else
+  return shm_unlink(("/" + ring_name).c_str()) == 0;
+#endif  // defined(OS_WIN)
+}
+
+bool ShmRing::Publish(const std::string& name,
+                      const uint8_t* data,
+                      uint64_t size) {
+  if (name.empty() || name.size() > ShmRingEntry::kMaxNameLength) {
+    LOG(ERROR) << "Invalid shared memory object name " << name;
+    return false;
+  }
+  const uint64_t data_size = header_->data_size;
+  if (size > data_size) {
+    LOG(ERROR) << "Object " << name << " of " << size
+               << " bytes does not fit in a ring of " << data_size
+               << " bytes.";
+    return false;
+  }
+
+  // Reserve the space before overwriting it, so that the readers of the
+  // objects overwritten see that they are not intact anymore. An object
+  // which would wrap around starts at the beginning of the data instead.
+  uint64_t position = 0;
+  uint64_t write_position =
+      header_->write_position.load(std::memory_order_relaxed);
+  do {
+    position = write_position;
+    const uint64_t offset = position % data_size;
+    if (offset + size > data_size)
+      position += data_size - offset;
+  } while (!header_->write_position.compare_exchange_weak(
+      write_position, position + size, std::memory_order_acq_rel));
+  if (size > 0)
+    memcpy(data_ + position % data_size, data, size);
+
+  ShmRingEntry* ring_entry =
+      entry(header_->next_entry.fetch_add(1, std::memory_order_acq_rel));
+  uint64_t sequence = ring_entry->sequence.load(std::memory_order_relaxed);
+  while ((sequence & 1) ||
+         !ring_entry->sequence.compare_exchange_weak(
+             sequence, sequence + 1, std::memory_order_acquire)) {
+    // Another writer is still publishing in this slot, which only happens
+    // if the whole index was published meanwhile.
+    std::this_thread::yield();
+    sequence = ring_entry->sequence.load(std::memory_order_relaxed);
+  }
+  ring_entry->position.store(position, std::memory_order_relaxed);
+  ring_entry->size.store(size, std::memory_order_relaxed);
+  memcpy(ring_entry->name, name.c_str(), name.size() + 1);
+  ring_entry->sequence.store(sequence + 2, std::memory_order_release);
+  return true;
+}
+
+bool ShmRing::Find(const std::string& name, Object* object) const {
+  if (name.size() > ShmRingEntry::kMaxNameLength)
+    return false;
+  const uint64_t num_entries = header_->num_entries;
+  const uint64_t next_entry =
+      header_->next_entry.load(std::memory_order_acquire);
+  const uint64_t first_entry =
+      next_entry > num_entries ? next_entry - num_entries : 0;
+  char entry_name[ShmRingEntry::kMaxNameLength + 1];
+  for (uint64_t i = next_entry; i-- > first_entry;) {
+    const ShmRingEntry* ring_entry = entry(i);
+    const uint64_t sequence =
+        ring_entry->sequence.load(std::memory_order_acquire);
+    if (sequence & 1)
+      continue;
+    memcpy(entry_name, ring_entry->name, sizeof(entry_name));
+    const uint64_t position =
+        ring_entry->position.load(std::memory_order_relaxed);
+    const uint64_t size = ring_entry->size.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (ring_entry->sequence.load(std::memory_order_relaxed) != sequence)
+      continue;
+    entry_name[ShmRingEntry::kMaxNameLength] = '\0';
+    if (name != entry_name)
+      continue;
+
+    object->data = data_ + position % header_->data_size;
+    object->size = size;
+    object->position = position;
+    return IsIntact(*object);
+  }
+  return false;
+}
+
+bool ShmRing::IsIntact(const Object& object) const {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return header_->write_position.load(std::memory_order_acquire) <=
+         object.position + header_->data_size;
+}
+
+void ShmRing::Remove(const std::string& name) {
+  const uint64_t num_entries = header_->num_entries;
+  const uint64_t next_entry =
+      header_->next_entry.load(std::memory_order_acquire);
+  const uint64_t first_entry =
+      next_entry > num_entries ? next_entry - num_entries : 0;
+  for (uint64_t i = first_entry; i < next_entry; ++i) {
+    ShmRingEntry* ring_entry = entry(i);
+    uint64_t sequence = ring_entry->sequence.load(std::memory_order_relaxed);
+    // An entry being published is newer than the removal.
+    if ((sequence & 1) ||
+        !ring_entry->sequence.compare_exchange_strong(
+            sequence, sequence + 1, std::memory_order_acquire)) {
+      continue;
+    }
+    if (strncmp(ring_entry->name, name.c_str(), sizeof(ring_entry->name)) ==
+        0) {
+      ring_entry->name[0] = '\0';
+    }
+    ring_entry->sequence.store(sequence + 2, std::memory_order_release);
+  }
+}
+
+ShmFile::ShmFile(const char* file_name, const char* mode)
+    : File(file_name), mode_(mode) {}
+
+ShmFile::~ShmFile() {}
+
+bool ShmFile::Close() {
+  bool result = true;
+  if (mode_ == "w" &&
+      !ring_->Publish(object_name_, data_.data(), data_.size())) {
+    LOG(ERROR) << "Cannot publish " << file_name();
+    result = false;
+  }
+  delete this;
+  return result;
+}
+
+int64_t ShmFile::Read(void* buffer, uint64_t length) {
+  DCHECK_LE(position_, data_.size());
+  length = std::min<uint64_t>(length, data_.size() - position_);
+  if (length > 0)
+    memcpy(buffer, data_.data() + position_, length);
+  position_ += length;
+  return length;
+}
+
+int64_t ShmFile::Write(const void* buffer, uint64_t length) {
+  if (mode_ != "w") {
+    LOG(ERROR) << "ShmFile " << file_name() << " is not opened for write.";
+    return -1;
+  }
+  const uint8_t* data = static_cast<const uint8_t*>(buffer);
+  const uint64_t overwrite_length =
+      std::min<uint64_t>(length, data_.size() - position_);
+  std::copy(data, data + overwrite_length, data_.begin() + position_);
+  data_.insert(data_.end(), data + overwrite_length, data + length);
+  position_ += length;
+  return length;
+}
+
+int64_t ShmFile::Size() {
+  return data_.size();
+}
+
+bool ShmFile::Seek(uint64_t position) {
+  if (position > data_.size())
+    return false;
+  position_ = position;
+  return true;
+}
+
+bool ShmFile::Tell(uint64_t* position) {
+  *position = position_;
+  return true;
+}
+
+// static
+bool ShmFile::Delete(const char* file_name) {
+  std::string ring_name;
+  std::string object_name;
+  if (!SplitFileName(file_name, &ring_name, &object_name))
+    return false;
+  ShmRing* ring = ShmRing::Get(ring_name);
+  if (!ring)
+    return false;
+  ring->Remove(object_name);
+  return true;
+}
+
+bool ShmFile::Open() {
+  std::string ring_name;
+  if (!SplitFileName(file_name(), &ring_name, &object_name_))
+    return false;
+  if (mode_ != "r" && mode_ != "w") {
+    NOTIMPLEMENTED() << "File mode '" << mode_ << "' not supported by ShmFile";
+    return false;
+  }
+  ring_ = ShmRing::Get(ring_name);
+  if (!ring_)
+    return false;
+  if (mode_ == "w")
+    return true;
+
+  ShmRing::Object object;
+  if (!ring_->Find(object_name_, &object))
+    return false;
+  data_.assign(object.data, object.data + object.size);
+  if (!ring_->IsIntact(object)) {
+    LOG(WARNING) << file_name() << " was overwritten while read.";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace shaka
@@ -0,0 +1,152 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_SHM_FILE_H_
+#define PACKAGER_FILE_SHM_FILE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <packager/file.h>
+
+namespace shaka {
+
+/// The layout of a ring in shared memory, for the servers mapping it. A ring
+/// is a header, followed by an index of ShmRingEntry, followed by the data.
+/// The data of each object is contiguous in the ring. Positions are logical:
+/// they grow forever, and the object at position p starts at byte
+/// p % data_size of the data.
+struct ShmRingHeader {
+  static constexpr uint32_t kMagic = 0x53484b52;  // "SHKR".
+  static constexpr uint32_t kVersion = 1;
+
+  /// Set once the ring is initialized.
+  std::atomic<uint32_t> magic;
+  uint32_t version;
+  uint64_t data_size;
+  uint64_t num_entries;
+  /// The end of the data reserved by the writers. The data of an object at
+  /// position p is intact as long as write_position <= p + data_size.
+  std::atomic<uint64_t> write_position;
+  /// The number of entries ever published. Entry i is in slot
+  /// i % num_entries of the index.
+  std::atomic<uint64_t> next_entry;
+};
+
+/// An entry of the index, which is a seqlock: the sequence is odd while the
+/// entry is being written, and a reader retries if the sequence changed
+/// while it read the entry.
+struct ShmRingEntry {
+  static constexpr size_t kMaxNameLength = 255;
+
+  std::atomic<uint64_t> sequence;
+  std::atomic<uint64_t> position;
+  std::atomic<uint64_t> size;
+  /// Null terminated. Empty if the entry is deleted.
+  char name[kMaxNameLength + 1];
+};
+
+/// A ring of objects in POSIX shared memory, to hand segments and manifests
+/// to an origin server on the same host without writing them to a file
+/// system. Objects are published lock-free by any number of writers, and the
+/// oldest objects are overwritten when the ring is full. A published object
+/// is never modified, so a reader can serve it from the mapping without
+/// copying, as long as it checks IsIntact() once done.
+class ShmRing {
+ public:
+  /// An object found in the ring.
+  struct Object {
+    const uint8_t* data = nullptr;
+    uint64_t size = 0;
+    uint64_t position = 0;
+  };
+
+  /// @param ring_name is the name of the shared memory object, without the
+  ///        leading slash.
+  /// @return the ring, which is created with --shm_ring_size and
+  ///         --shm_ring_index_size if it does not exist yet, or nullptr on
+  ///         failure. The ring is mapped for the lifetime of the process.
+  static ShmRing* Get(const std::string& ring_name);
+
+  /// Remove the shared memory object of a ring. The processes which mapped
+  /// it keep their mappings.
+  static bool Unlink(const std::string& ring_name);
+
+  /// Copy an object into the ring and publish it, hiding the objects
+  /// published with the same name before.
+  /// @return false if the object does not fit in the ring or its name is
+  ///         too long.
+  bool Publish(const std::string& name, const uint8_t* data, uint64_t size);
+
+  /// Find the newest object published with @a name.
+  /// @return false if there is no such object, or it has been overwritten.
+  bool Find(const std::string& name, Object* object) const;
+
+  /// @return true if the data of @a object has not been overwritten since it
+  ///         was found. Check it after reading the data.
+  bool IsIntact(const Object& object) const;
+
+  /// Delete the objects published with @a name.
+  void Remove(const std::string& name);
+
+ private:
+  ShmRing(uint8_t* mapping, uint64_t mapping_size);
+  ShmRing(const ShmRing&) = delete;
+  ShmRing& operator=(const ShmRing&) = delete;
+
+  ShmRingEntry* entry(uint64_t index) const {
+    return &entries_[index % header_->num_entries];
+  }
+
+  ShmRingHeader* const header_;
+  ShmRingEntry* const entries_;
+  uint8_t* const data_;
+};
+
+/// Implements a File in a ShmRing. The file name is
+/// "<ring name>/<object name>". A file written is published when it is
+/// closed, replacing the previous object with the same name; a file read is
+/// copied out of the ring when it is opened.
+class ShmFile : public File {
+ public:
+  ShmFile(const char* file_name, const char* mode);
+
+  /// @name File implementation overrides.
+  /// @{
+  bool Close() override;
+  int64_t Read(void* buffer, uint64_t length) override;
+  int64_t Write(const void* buffer, uint64_t length) override;
+  void CloseForWriting() override {}
+  int64_t Size() override;
+  bool Flush() override { return true; }
+  bool Seek(uint64_t position) override;
+  bool Tell(uint64_t* position) override;
+  /// @}
+
+  /// Delete the object of a file from its ring.
+  static bool Delete(const char* file_name);
+
+ protected:
+  ~ShmFile() override;
+
+  bool Open() override;
+
+ private:
+  ShmFile(const ShmFile&) = delete;
+  ShmFile& operator=(const ShmFile&) = delete;
+
+  const std::string mode_;
+  ShmRing* ring_ = nullptr;
+  std::string object_name_;
+  std::vector<uint8_t> data_;
+  uint64_t position_ = 0;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_SHM_FILE_H_
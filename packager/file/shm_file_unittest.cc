@@ -0,0 +1,156 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/shm_file.h>
+
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/flags/declare.h>
+#include <absl/flags/flag.h>
+#include <absl/strings/str_format.h>
+#include <gtest/gtest.h>
+
+#include <packager/file.h>
+#include <packager/file/file_closer.h>
+#include <packager/flag_saver.h>
+
+ABSL_DECLARE_FLAG(uint64_t, shm_ring_size);
+ABSL_DECLARE_FLAG(uint64_t, shm_ring_index_size);
+
+namespace shaka {
+
+class ShmFileTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ring_name_ = absl::StrFormat(
+        "shaka_test_%d_%s", getpid(),
+        testing::UnitTest::GetInstance()->current_test_info()->name());
+  }
+
+  void TearDown() override { ShmRing::Unlink(ring_name_); }
+
+  std::string GetFileName(const std::string& object_name) {
+    return std::string(kShmFilePrefix) + ring_name_ + "/" + object_name;
+  }
+
+  std::string ring_name_;
+};
+
+TEST_F(ShmFileTest, WriteAndRead) {
+  ASSERT_TRUE(File::WriteStringToFile(GetFileName("live/1.m4s").c_str(),
+                                      "segment 1"));
+  std::string contents;
+  ASSERT_TRUE(File::ReadFileToString(GetFileName("live/1.m4s").c_str(),
+                                     &contents));
+  EXPECT_EQ("segment 1", contents);
+  EXPECT_FALSE(File::ReadFileToString(GetFileName("live/2.m4s").c_str(),
+                                      &contents));
+}
+
+TEST_F(ShmFileTest, PublishedOnClose) {
+  std::unique_ptr<File, FileCloser> file(
+      File::Open(GetFileName("manifest.mpd").c_str(), "w"));
+  ASSERT_TRUE(file);
+  ASSERT_EQ(5, file->Write("abcde", 5));
+  ASSERT_TRUE(file->Seek(1));
+  ASSERT_EQ(2, file->Write("XY", 2));
+
+  ShmRing* ring = ShmRing::Get(ring_name_);
+  ASSERT_TRUE(ring);
+  ShmRing::Object object;
+  EXPECT_FALSE(ring->Find("manifest.mpd", &object));
+
+  ASSERT_TRUE(file.release()->Close());
+  ASSERT_TRUE(ring->Find("manifest.mpd", &object));
+  EXPECT_EQ("aXYde", std::string(reinterpret_cast<const char*>(object.data),
+                                 object.size));
+  EXPECT_TRUE(ring->IsIntact(object));
+}
+
+TEST_F(ShmFileTest, ReplacesAndDeletes) {
+  const std::string file_name = GetFileName("manifest.mpd");
+  ASSERT_TRUE(File::WriteFileAtomically(file_name.c_str(), "version 1"));
+  ASSERT_TRUE(File::WriteFileAtomically(file_name.c_str(), "version 2"));
+  std::string contents;
+  ASSERT_TRUE(File::ReadFileToString(file_name.c_str(), &contents));
+  EXPECT_EQ("version 2", contents);
+
+  ASSERT_TRUE(File::Delete(file_name.c_str()));
+  EXPECT_FALSE(File::ReadFileToString(file_name.c_str(), &contents));
+}
+
+TEST_F(ShmFileTest, OverwritesOldestObjects) {
+  FlagSaver<uint64_t> ring_size(&FLAGS_shm_ring_size);
+  FlagSaver<uint64_t> index_size(&FLAGS_shm_ring_index_size);
+  absl::SetFlag(&FLAGS_shm_ring_size, 256);
+  absl::SetFlag(&FLAGS_shm_ring_index_size, 4);
+
+  ShmRing* ring = ShmRing::Get(ring_name_);
+  ASSERT_TRUE(ring);
+  const std::vector<uint8_t> data(100, 1);
+  ASSERT_TRUE(ring->Publish("1", data.data(), data.size()));
+  ShmRing::Object object_1;
+  ASSERT_TRUE(ring->Find("1", &object_1));
+  ASSERT_TRUE(ring->Publish("2", data.data(), data.size()));
+  EXPECT_TRUE(ring->IsIntact(object_1));
+
+  // Wraps around to the beginning, over the first object.
+  ASSERT_TRUE(ring->Publish("3", data.data(), data.size()));
+  EXPECT_FALSE(ring->IsIntact(object_1));
+  ShmRing::Object object;
+  EXPECT_FALSE(ring->Find("1", &object));
+  ASSERT_TRUE(ring->Find("3", &object));
+  EXPECT_EQ(object_1.data, object.data);
+  EXPECT_TRUE(ring->Find("2", &object));
+
+  // Does not fit.
+  const std::vector<uint8_t> large_data(300);
+  EXPECT_FALSE(ring->Publish("4", large_data.data(), large_data.size()));
+
+  // Out of the index.
+  for (int i = 5; i < 9; ++i)
+    ASSERT_TRUE(ring->Publish(std::to_string(i), data.data(), 1));
+  EXPECT_FALSE(ring->Find("3", &object));
+  EXPECT_TRUE(ring->Find("5", &object));
+}
+
+TEST_F(ShmFileTest, ConcurrentWriters) {
+  const int kNumThreads = 4;
+  const int kNumObjects = 100;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([this, i]() {
+      for (int j = 0; j < kNumObjects; ++j) {
+        const std::string object_name = absl::StrFormat("%d/%d", i, j);
+        EXPECT_TRUE(File::WriteStringToFile(
+            GetFileName(object_name).c_str(), object_name));
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (int i = 0; i < kNumThreads; ++i) {
+    for (int j = 0; j < kNumObjects; ++j) {
+      const std::string object_name = absl::StrFormat("%d/%d", i, j);
+      std::string contents;
+      ASSERT_TRUE(File::ReadFileToString(GetFileName(object_name).c_str(),
+                                         &contents));
+      EXPECT_EQ(object_name, contents);
+    }
+  }
+}
+
+TEST_F(ShmFileTest, InvalidFileName) {
+  EXPECT_FALSE(File::Open("shm://no_object_name", "w"));
+  EXPECT_FALSE(File::Open("shm:///no_ring_name", "w"));
+}
+
+}  // namespace shaka
@@ -0,0 +1,178 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/spsc_io_cache.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+
+#include <packager/macros/logging.h>
+
+namespace shaka {
+
+// All the accesses to the positions, the closed flag and the waiting flags
+// which are involved in blocking use sequentially consistent ordering: a side
+// which is about to block sets its waiting flag and then re-checks the
+// positions, while the other side updates the positions and then checks the
+// waiting flag, so at least one of them is guaranteed to see the other.
+
+SpscIoCache::SpscIoCache(uint64_t cache_size)
+    : cache_size_(cache_size), circular_buffer_(cache_size) {
+  DCHECK_GT(cache_size_, 0u);
+}
+
+SpscIoCache::~SpscIoCache() {
+  Close();
+}
+
+uint64_t SpscIoCache::Read(void* buffer, uint64_t size) {
+  DCHECK(buffer);
+
+  const uint64_t read_position = read_position_.load(std::memory_order_relaxed);
+  uint64_t bytes_cached;
+  while ((bytes_cached = write_position_.load() - read_position) == 0) {
+    if (closed_.load()) {
+      // The writer may have written more data just before closing.
+      bytes_cached = write_position_.load() - read_position;
+      if (bytes_cached == 0)
+        return 0;
+      break;
+    }
+    WaitForData(read_position);
+  }
+
+  size = std::min(size, bytes_cached);
+  const uint64_t offset = read_position % cache_size_;
+  const uint64_t first_chunk_size = std::min(size, cache_size_ - offset);
+  memcpy(buffer, &circular_buffer_[offset], first_chunk_size);
+  const uint64_t second_chunk_size = size - first_chunk_size;
+  if (second_chunk_size) {
+    memcpy(static_cast<uint8_t*>(buffer) + first_chunk_size,
+           circular_buffer_.data(), second_chunk_size);
+  }
+
+  read_position_.store(read_position + size);
+  NotifyWriter();
+  return size;
+}
+
+uint64_t SpscIoCache::Write(const void* buffer, uint64_t size) {
+  DCHECK(buffer);
+
+  const uint8_t* r_ptr(static_cast<const uint8_t*>(buffer));
+  uint64_t write_position = write_position_.load(std::memory_order_relaxed);
+  uint64_t bytes_left(size);
+  while (bytes_left) {
+    if (closed_.load())
+      return 0;
+
+    const uint64_t bytes_free =
+        cache_size_ - (write_position - read_position_.load());
+    if (bytes_free == 0) {
+      VLOG(1) << "Circular buffer is full, which can happen if data arrives "
+                 "faster than being consumed by packager. Ignore if it is not "
+                 "live packaging. Otherwise, try increasing --io_cache_size.";
+      WaitForSpace([this, write_position]() {
+        return write_position - read_position_.load() < cache_size_;
+      });
+      continue;
+    }
+
+    const uint64_t write_size = std::min(bytes_left, bytes_free);
+    const uint64_t offset = write_position % cache_size_;
+    const uint64_t first_chunk_size =
+        std::min(write_size, cache_size_ - offset);
+    memcpy(&circular_buffer_[offset], r_ptr, first_chunk_size);
+    const uint64_t second_chunk_size = write_size - first_chunk_size;
+    if (second_chunk_size) {
+      memcpy(circular_buffer_.data(), r_ptr + first_chunk_size,
+             second_chunk_size);
+    }
+    r_ptr += write_size;
+    bytes_left -= write_size;
+
+    write_position += write_size;
+    write_position_.store(write_position);
+    NotifyReader();
+  }
+  return size;
+}
+
+void SpscIoCache::Clear() {
+  read_position_.store(write_position_.load());
+  // Let the writer know that there is room in the cache.
+  NotifyWriter();
+}
+
+void SpscIoCache::Close() {
+  closed_.store(true);
+  absl::MutexLock lock(&mutex_);
+  data_available_.Signal();
+  space_available_.Signal();
+}
+
+bool SpscIoCache::closed() {
+  return closed_.load();
+}
+
+void SpscIoCache::Reopen() {
+  CHECK(closed_.load());
+  read_position_.store(0);
+  write_position_.store(0);
+  closed_.store(false);
+}
+
+uint64_t SpscIoCache::BytesCached() {
+  return write_position_.load() - read_position_.load();
+}
+
+uint64_t SpscIoCache::BytesFree() {
+  return cache_size_ - BytesCached();
+}
+
+void SpscIoCache::WaitUntilEmptyOrClosed() {
+  auto is_empty = [this]() {
+    return read_position_.load() == write_position_.load();
+  };
+  if (!is_empty() && !closed_.load())
+    WaitForSpace(is_empty);
+}
+
+void SpscIoCache::WaitForData(uint64_t read_position) {
+  absl::MutexLock lock(&mutex_);
+  reader_waiting_.store(true);
+  while (write_position_.load() == read_position && !closed_.load())
+    data_available_.Wait(&mutex_);
+  reader_waiting_.store(false);
+}
+
+template <typename Condition>
+void SpscIoCache::WaitForSpace(Condition condition) {
+  absl::MutexLock lock(&mutex_);
+  writer_waiting_.store(true);
+  while (!condition() && !closed_.load())
+    space_available_.Wait(&mutex_);
+  writer_waiting_.store(false);
+}
+
+void SpscIoCache::NotifyReader() {
+  if (!reader_waiting_.load())
+    return;
+  absl::MutexLock lock(&mutex_);
+  data_available_.Signal();
+}
+
+void SpscIoCache::NotifyWriter() {
+  if (!writer_waiting_.load())
+    return;
+  absl::MutexLock lock(&mutex_);
+  space_available_.Signal();
+}
+
+}  // namespace shaka
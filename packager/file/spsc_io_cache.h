@@ -0,0 +1,86 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_SPSC_IO_CACHE_H_
+#define PACKAGER_FILE_SPSC_IO_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+
+#include <packager/file/io_cache.h>
+#include <packager/utils/huge_pages.h>
+
+namespace shaka {
+
+/// A circular buffer for exactly one writer thread and one reader thread.
+///
+/// Unlike IoCache, Read() and Write() do not take a lock when they can make
+/// progress: the read and write positions are atomics owned by one side each.
+/// A mutex and condition variables are only used by a side which has to block
+/// because the cache is empty or full, and the other side only touches them if
+/// it sees that a side is blocked.
+///
+/// Read(), Clear() and BytesCached() may only be called from the reader, and
+/// Write(), BytesFree() and WaitUntilEmptyOrClosed() from the writer. Close()
+/// may be called from either side. Reopen() must not be called concurrently
+/// with any other call.
+class SpscIoCache : public IoCacheBase {
+ public:
+  explicit SpscIoCache(uint64_t cache_size);
+  ~SpscIoCache() override;
+
+  /// @name IoCacheBase implementation overrides.
+  /// @{
+  uint64_t Read(void* buffer, uint64_t size) override;
+  uint64_t Write(const void* buffer, uint64_t size) override;
+  void Clear() override;
+  void Close() override;
+  bool closed() override;
+  void Reopen() override;
+  uint64_t BytesCached() override;
+  uint64_t BytesFree() override;
+  void WaitUntilEmptyOrClosed() override;
+  /// @}
+
+ private:
+  SpscIoCache(const SpscIoCache&) = delete;
+  SpscIoCache& operator=(const SpscIoCache&) = delete;
+
+  // Blocks the reader until there is data in the cache or it is closed.
+  void WaitForData(uint64_t read_position);
+  // Blocks the writer until |condition| returns true or the cache is closed.
+  template <typename Condition>
+  void WaitForSpace(Condition condition);
+  // Wakes up the other side if it is blocked.
+  void NotifyReader();
+  void NotifyWriter();
+
+  // Avoid false sharing between the positions owned by different threads.
+  static constexpr size_t kCacheLineSize = 64;
+
+  const uint64_t cache_size_;
+  std::vector<uint8_t, HugePageAllocator<uint8_t>> circular_buffer_;
+
+  // Total number of bytes read and written since the cache was (re)opened.
+  // The byte at position p lives at circular_buffer_[p % cache_size_].
+  alignas(kCacheLineSize) std::atomic<uint64_t> read_position_{0};
+  alignas(kCacheLineSize) std::atomic<uint64_t> write_position_{0};
+  alignas(kCacheLineSize) std::atomic<bool> closed_{false};
+  std::atomic<bool> reader_waiting_{false};
+  std::atomic<bool> writer_waiting_{false};
+
+  // Only used when one side needs to block.
+  absl::Mutex mutex_;
+  absl::CondVar data_available_ ABSL_GUARDED_BY(mutex_);
+  absl::CondVar space_available_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_SPSC_IO_CACHE_H_
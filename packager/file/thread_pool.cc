@@ -12,6 +12,10 @@
 #include <absl/log/log.h>
 #include <absl/time/time.h>
 
+#include <packager/utils/cpu_affinity.h>
+#include <packager/utils/resource_quota.h>
+#include <packager/utils/work_priority.h>
+
 namespace shaka {
 
 namespace {
@@ -30,6 +34,12 @@ ThreadPool::~ThreadPool() {
 }
 
 void ThreadPool::PostTask(const std::function<void()>& task) {
+  // The workers are shared by all the jobs, so they take the CPUs of the job
+  // which posts the task rather than those of the job which created them.
+  std::vector<int> cpus;
+  if (CpuAffinity::pinned())
+    cpus = CpuAffinity::GetThreadCpus();
+
   absl::MutexLock lock(&mutex_);
 
   DCHECK(!terminated_) << "Should not call PostTask after Terminate!";
@@ -45,7 +55,8 @@ void ThreadPool::PostTask(const std::function<void()>& task) {
     return;
   }
 
-  tasks_.push(std::move(task));
+  tasks_.push({task, std::move(cpus), WorkPriority::IsBackground(),
+               ResourceQuota::current()});
 
   if (num_idle_threads_ >= tasks_.size()) {
     // We have enough threads available.
@@ -68,11 +79,11 @@ void ThreadPool::Terminate() {
   tasks_available_.SignalAll();
 }
 
-ThreadPool::Task ThreadPool::WaitForTask() {
+ThreadPool::PendingTask ThreadPool::WaitForTask() {
   absl::MutexLock lock(&mutex_);
   if (terminated_) {
     // The pool is terminated.  Terminate this thread.
-    return Task();
+    return PendingTask();
   }
 
   if (tasks_.empty()) {
@@ -83,26 +94,29 @@ ThreadPool::Task ThreadPool::WaitForTask() {
 
     if (tasks_.empty()) {
       // No work before the timeout.  Terminate this thread.
-      return Task();
+      return PendingTask();
     }
   }
 
   // Get the next task from the queue.
-  Task task = tasks_.front();
+  PendingTask task = std::move(tasks_.front());
   tasks_.pop();
   return task;
 }
 
 void ThreadPool::ThreadMain() {
   while (true) {
-    auto task = WaitForTask();
-    if (!task) {
+    PendingTask pending_task = WaitForTask();
+    if (!pending_task.task) {
       // An empty task signals the thread to terminate.
       return;
     }
 
     // Run the task, then loop to wait for another.
-    task();
+    ScopedCpuAffinity affinity(pending_task.cpus);
+    ScopedWorkPriority priority(pending_task.background);
+    ScopedResourceQuota quota(std::move(pending_task.quota));
+    pending_task.task();
   }
 }
 
@@ -8,7 +8,9 @@
 #define PACKAGER_FILE_THREAD_POOL_H_
 
 #include <functional>
+#include <memory>
 #include <queue>
+#include <vector>
 
 #include <absl/base/thread_annotations.h>
 #include <absl/synchronization/mutex.h>
@@ -17,6 +19,8 @@
 
 namespace shaka {
 
+class ResourceQuota;
+
 /// A simple thread pool.  We used to get this from Chromium base::, but there
 /// is no replacement in the C++ standard library nor in absl.
 /// (As of June 2022.)  The pool will grow when there are no threads available
@@ -28,7 +32,10 @@ class ThreadPool {
   ThreadPool();
   ~ThreadPool();
 
-  /// Find or spawn a worker thread to handle |task|.
+  /// Find or spawn a worker thread to handle |task|. The task has the work
+  /// priority and the resource quota of the calling thread, see WorkPriority
+  /// and ResourceQuota, and once threads are pinned to CPUs, see CpuAffinity,
+  /// it runs on the CPUs of the calling thread.
   /// @param task A potentially long-running task to be handled by the pool.
   void PostTask(const Task& task);
 
@@ -39,12 +46,20 @@ class ThreadPool {
   /// exit.
   void Terminate();
 
-  Task WaitForTask();
+  struct PendingTask {
+    Task task;
+    // The CPUs to run |task| on, or empty to run it anywhere.
+    std::vector<int> cpus;
+    bool background = false;
+    std::shared_ptr<ResourceQuota> quota;
+  };
+
+  PendingTask WaitForTask();
   void ThreadMain();
 
   absl::Mutex mutex_;
   absl::CondVar tasks_available_ ABSL_GUARDED_BY(mutex_);
-  std::queue<Task> tasks_ ABSL_GUARDED_BY(mutex_);
+  std::queue<PendingTask> tasks_ ABSL_GUARDED_BY(mutex_);
   size_t num_idle_threads_ ABSL_GUARDED_BY(mutex_);
   bool terminated_ ABSL_GUARDED_BY(mutex_);
 
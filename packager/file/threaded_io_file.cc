@@ -8,19 +8,41 @@
 
 #include <absl/log/check.h>
 
+#include <packager/file/spsc_io_cache.h>
 #include <packager/file/thread_pool.h>
+#include <packager/utils/memory_budget.h>
+#include <packager/utils/metrics.h>
+#include <packager/utils/trace.h>
+#include <packager/utils/work_priority.h>
 
 namespace shaka {
+namespace {
+
+MetricGauge* BufferedBytes() {
+  static MetricGauge* const buffered_bytes =
+      MetricsRegistry::GetInstance()->GetGauge(
+          "shaka_io_cache_buffered_bytes",
+          "Bytes buffered between the packager and threaded files.");
+  return buffered_bytes;
+}
+
+}  // namespace
 
 ThreadedIoFile::ThreadedIoFile(std::unique_ptr<File, FileCloser> internal_file,
                                Mode mode,
                                uint64_t io_cache_size,
-                               uint64_t io_block_size)
+                               uint64_t io_block_size,
+                               bool use_lock_free_cache)
     : File(internal_file->file_name()),
       internal_file_(std::move(internal_file)),
       mode_(mode),
-      cache_(io_cache_size),
+      cache_(use_lock_free_cache
+                 ? static_cast<IoCacheBase*>(new SpscIoCache(io_cache_size))
+                 : new IoCache(io_cache_size)),
       io_buffer_(io_block_size),
+      buffers_memory_(MemorySubsystem::kIoCaches,
+                      io_cache_size + io_block_size),
+      buffers_quota_(io_cache_size + io_block_size),
       position_(0),
       size_(0),
       eof_(false),
@@ -48,13 +70,16 @@ bool ThreadedIoFile::Open() {
 
 bool ThreadedIoFile::Close() {
   DCHECK(internal_file_);
+  ScopedTraceEvent trace_event("File::Close", file_name());
 
   bool result = true;
   if (mode_ == kOutputMode)
     result = Flush();
 
-  cache_.Close();
+  cache_->Close();
   WaitForSignal(&task_exited_mutex_, &task_exited_);
+  // Bytes read ahead but never consumed.
+  BufferedBytes()->Add(-static_cast<int64_t>(cache_->BytesCached()));
 
   result &= internal_file_.release()->Close();
   delete this;
@@ -65,13 +90,17 @@ int64_t ThreadedIoFile::Read(void* buffer, uint64_t length) {
   DCHECK(internal_file_);
   DCHECK_EQ(kInputMode, mode_);
 
-  if (eof_.load(std::memory_order_relaxed) && !cache_.BytesCached())
+  if (eof_.load(std::memory_order_relaxed) && !cache_->BytesCached())
     return 0;
 
   if (internal_file_error_.load(std::memory_order_relaxed))
     return internal_file_error_.load(std::memory_order_relaxed);
 
-  uint64_t bytes_read = cache_.Read(buffer, length);
+  uint64_t bytes_read = cache_->Read(buffer, length);
+  // The cache is also closed when the file fails or is aborted.
+  if (bytes_read == 0 && internal_file_error_.load(std::memory_order_relaxed))
+    return internal_file_error_.load(std::memory_order_relaxed);
+  BufferedBytes()->Add(-static_cast<int64_t>(bytes_read));
   position_ += bytes_read;
 
   return bytes_read;
@@ -84,7 +113,14 @@ int64_t ThreadedIoFile::Write(const void* buffer, uint64_t length) {
   if (internal_file_error_.load(std::memory_order_relaxed))
     return internal_file_error_.load(std::memory_order_relaxed);
 
-  uint64_t bytes_written = cache_.Write(buffer, length);
+  MemoryBudget::Throttle();
+  ResourceQuota::Throttle();
+  uint64_t bytes_written = cache_->Write(buffer, length);
+  if (bytes_written == 0 &&
+      internal_file_error_.load(std::memory_order_relaxed)) {
+    return internal_file_error_.load(std::memory_order_relaxed);
+  }
+  BufferedBytes()->Add(bytes_written);
   position_ += bytes_written;
   if (position_ > size_)
     size_ = position_;
@@ -94,6 +130,14 @@ int64_t ThreadedIoFile::Write(const void* buffer, uint64_t length) {
 
 void ThreadedIoFile::CloseForWriting() {}
 
+void ThreadedIoFile::Abort() {
+  DCHECK(internal_file_);
+  internal_file_error_.store(-1, std::memory_order_relaxed);
+  // Wake up the I/O thread, then the caller, if blocked.
+  internal_file_->Abort();
+  cache_->Close();
+}
+
 int64_t ThreadedIoFile::Size() {
   DCHECK(internal_file_);
 
@@ -112,7 +156,7 @@ bool ThreadedIoFile::Flush() {
     flushing_ = true;
     flush_complete_ = false;
   }
-  cache_.Close();
+  cache_->Close();
 
   WaitForSignal(&flush_mutex_, &flush_complete_);
 
@@ -129,7 +173,7 @@ bool ThreadedIoFile::Seek(uint64_t position) {
   } else {
     // Reading. Close cache, wait for thread task to exit, seek, and re-post
     // the task.
-    cache_.Close();
+    cache_->Close();
     WaitForSignal(&task_exited_mutex_, &task_exited_);
 
     bool result = internal_file_->Seek(position);
@@ -139,7 +183,8 @@ bool ThreadedIoFile::Seek(uint64_t position) {
         LOG(WARNING) << "Seek failed. ThreadedIoFile left in invalid state.";
       }
     }
-    cache_.Reopen();
+    BufferedBytes()->Add(-static_cast<int64_t>(cache_->BytesCached()));
+    cache_->Reopen();
     eof_ = false;
 
     ThreadPool::instance.PostTask(
@@ -185,12 +230,14 @@ void ThreadedIoFile::RunInInputMode() {
     if (read_result <= 0) {
       eof_.store(read_result == 0, std::memory_order_relaxed);
       internal_file_error_.store(read_result, std::memory_order_relaxed);
-      cache_.Close();
+      cache_->Close();
       return;
     }
-    if (cache_.Write(&io_buffer_[0], read_result) == 0) {
+    WorkPriority::ThrottleIo(read_result);
+    if (cache_->Write(&io_buffer_[0], read_result) == 0) {
       return;
     }
+    BufferedBytes()->Add(read_result);
   }
 }
 
@@ -199,24 +246,26 @@ void ThreadedIoFile::RunInOutputMode() {
   DCHECK_EQ(kOutputMode, mode_);
 
   while (true) {
-    uint64_t write_bytes = cache_.Read(&io_buffer_[0], io_buffer_.size());
+    uint64_t write_bytes = cache_->Read(&io_buffer_[0], io_buffer_.size());
+    BufferedBytes()->Add(-static_cast<int64_t>(write_bytes));
     if (write_bytes == 0) {
       absl::MutexLock lock(&flush_mutex_);
       if (flushing_) {
-        cache_.Reopen();
+        cache_->Reopen();
         flushing_ = false;
         flush_complete_ = true;
       } else {
         return;
       }
     } else {
+      WorkPriority::ThrottleIo(write_bytes);
       uint64_t bytes_written(0);
       while (bytes_written < write_bytes) {
         int64_t write_result = internal_file_->Write(
             &io_buffer_[bytes_written], write_bytes - bytes_written);
         if (write_result < 0) {
           internal_file_error_.store(write_result, std::memory_order_relaxed);
-          cache_.Close();
+          cache_->Close();
 
           absl::MutexLock lock(&flush_mutex_);
           if (flushing_) {
@@ -16,6 +16,8 @@
 #include <packager/file/file_closer.h>
 #include <packager/file/io_cache.h>
 #include <packager/macros/classes.h>
+#include <packager/utils/memory_accounting.h>
+#include <packager/utils/resource_quota.h>
 
 namespace shaka {
 
@@ -24,10 +26,13 @@ class ThreadedIoFile : public File {
  public:
   enum Mode { kInputMode, kOutputMode };
 
+  /// @param use_lock_free_cache selects SpscIoCache instead of IoCache for
+  ///        passing data between the caller and the I/O thread.
   ThreadedIoFile(std::unique_ptr<File, FileCloser> internal_file,
                  Mode mode,
                  uint64_t io_cache_size,
-                 uint64_t io_block_size);
+                 uint64_t io_block_size,
+                 bool use_lock_free_cache);
 
   /// @name File implementation overrides.
   /// @{
@@ -35,6 +40,7 @@ class ThreadedIoFile : public File {
   int64_t Read(void* buffer, uint64_t length) override;
   int64_t Write(const void* buffer, uint64_t length) override;
   void CloseForWriting() override;
+  void Abort() override;
   int64_t Size() override;
   bool Flush() override;
   bool Seek(uint64_t position) override;
@@ -56,8 +62,11 @@ class ThreadedIoFile : public File {
 
   std::unique_ptr<File, FileCloser> internal_file_;
   const Mode mode_;
-  IoCache cache_;
+  std::unique_ptr<IoCacheBase> cache_;
   std::vector<uint8_t> io_buffer_;
+  // The cache and the I/O buffer.
+  MemoryCharge buffers_memory_;
+  ResourceQuotaCharge buffers_quota_;
   uint64_t position_;
   uint64_t size_;
   std::atomic<bool> eof_;
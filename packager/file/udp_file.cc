@@ -27,7 +27,9 @@
 #endif
 #endif  // defined(OS_WIN)
 
+#include <algorithm>
 #include <limits>
+#include <thread>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
@@ -53,15 +55,122 @@ int GetSocketErrorCode() {
 #endif
 }
 
+// Outputs are sent as datagrams of 7 TS packets, which fit an Ethernet frame.
+const size_t kTsPacketSize = 188;
+const uint8_t kTsSyncByte = 0x47;
+const size_t kDatagramSize = 7 * kTsPacketSize;
+// Each send batch holds up to this many datagrams.
+const size_t kMaxDatagramsPerSend = 64;
+// PCRs are in units of a 27 MHz clock and wrap around after 2^33 * 300 ticks.
+const uint64_t kPcrClockRate = 27000000;
+const uint64_t kPcrWrapAround = (1ull << 33) * 300;
+// Datagrams due within this duration are sent in the same batch.
+const std::chrono::milliseconds kPacingGranularity(1);
+// A paced output which falls behind by more than this duration, e.g. after a
+// stall of the input, restarts pacing from the current time instead of
+// bursting to catch up.
+const std::chrono::seconds kMaxPacingDelay(1);
+
+// Read the PCR of the TS packet at |packet|, in units of the 27 MHz clock.
+// Returns false if the packet does not carry a PCR.
+bool ReadPcr(const uint8_t* packet, uint64_t* pcr) {
+  const bool has_adaptation_field = (packet[3] & 0x20) != 0;
+  const uint8_t adaptation_field_length = packet[4];
+  const bool has_pcr = (packet[5] & 0x10) != 0;
+  if (packet[0] != kTsSyncByte || !has_adaptation_field ||
+      adaptation_field_length < 7 || !has_pcr) {
+    return false;
+  }
+  const uint64_t pcr_base = (static_cast<uint64_t>(packet[6]) << 25) |
+                            (static_cast<uint64_t>(packet[7]) << 17) |
+                            (static_cast<uint64_t>(packet[8]) << 9) |
+                            (static_cast<uint64_t>(packet[9]) << 1) |
+                            (packet[10] >> 7);
+  const uint64_t pcr_extension = ((packet[10] & 1) << 8) | packet[11];
+  *pcr = pcr_base * 300 + pcr_extension;
+  return true;
+}
+
+// Set up |socket| to send the datagrams to |address|.
+bool SetUpOutputSocket(SOCKET socket,
+                       const UdpOptions& options,
+                       const struct in_addr& address) {
+  const bool is_multicast = IsIpv4MulticastAddress(address);
+  if (options.ttl() > 0) {
+    const int ttl = options.ttl();
+    if (setsockopt(socket, IPPROTO_IP, is_multicast ? IP_MULTICAST_TTL : IP_TTL,
+                   reinterpret_cast<const char*>(&ttl), sizeof(ttl)) < 0) {
+      LOG(ERROR) << "Failed to set the UDP socket TTL, error = "
+                 << GetSocketErrorCode();
+      return false;
+    }
+  }
+
+  if (is_multicast) {
+    struct in_addr interface_in_addr = {0};
+    if (inet_pton(AF_INET, options.interface_address().c_str(),
+                  &interface_in_addr) != 1) {
+      LOG(ERROR) << "Malformed IPv4 interface address "
+                 << options.interface_address();
+      return false;
+    }
+    if (interface_in_addr.s_addr != htonl(INADDR_ANY) &&
+        setsockopt(socket, IPPROTO_IP, IP_MULTICAST_IF,
+                   reinterpret_cast<const char*>(&interface_in_addr),
+                   sizeof(interface_in_addr)) < 0) {
+      LOG(ERROR) << "Failed to set the multicast interface, error = "
+                 << GetSocketErrorCode();
+      return false;
+    }
+  }
+
+  if (options.buffer_size() > 0) {
+    const int send_buffer_size = options.buffer_size();
+    if (setsockopt(socket, SOL_SOCKET, SO_SNDBUF,
+                   reinterpret_cast<const char*>(&send_buffer_size),
+                   sizeof(send_buffer_size)) < 0) {
+      LOG(ERROR) << "Failed to set the maximum send buffer size, error = "
+                 << GetSocketErrorCode();
+      return false;
+    }
+  }
+
+  struct sockaddr_in remote_sock_addr;
+  memset(&remote_sock_addr, 0, sizeof(remote_sock_addr));
+  remote_sock_addr.sin_family = AF_INET;
+  remote_sock_addr.sin_port = htons(options.port());
+  remote_sock_addr.sin_addr = address;
+  if (connect(socket, reinterpret_cast<struct sockaddr*>(&remote_sock_addr),
+              sizeof(remote_sock_addr)) < 0) {
+    LOG(ERROR) << "Could not connect UDP socket, error = "
+               << GetSocketErrorCode();
+    return false;
+  }
+  return true;
+}
+
+#if defined(__linux__)
+// The largest UDP payload over IPv4.
+const size_t kMaxDatagramSize = 65507;
+// Each recvmmsg() call receives up to this many datagrams. Multicast TS
+// streams usually carry 7 TS packets, i.e. 1316 bytes, per datagram, so a
+// high bitrate stream delivers many datagrams between two reads.
+const size_t kMaxDatagramsPerReceive = 16;
+// Room for the SO_RXQ_OVFL counter of each datagram.
+const size_t kControlBufferSize = CMSG_SPACE(sizeof(uint32_t));
+#endif  // defined(__linux__)
+
 }  // anonymous namespace
 
-UdpFile::UdpFile(const char* file_name)
-    : File(file_name), socket_(INVALID_SOCKET) {}
+UdpFile::UdpFile(const char* file_name, bool is_output)
+    : File(file_name), socket_(INVALID_SOCKET), is_output_(is_output) {}
 
 UdpFile::~UdpFile() {}
 
 bool UdpFile::Close() {
   if (socket_ != INVALID_SOCKET) {
+    if (is_output_ && !send_buffer_.empty())
+      Flush();
     close(socket_);
     socket_ = INVALID_SOCKET;
   }
@@ -78,23 +187,280 @@ int64_t UdpFile::Read(void* buffer, uint64_t length) {
   DCHECK_GE(length, 65535u)
       << "Buffer may be too small to read entire datagram.";
 
-  if (socket_ == INVALID_SOCKET)
+  if (socket_ == INVALID_SOCKET || aborted_)
     return -1;
 
+#if defined(__linux__)
+  if (next_datagram_ == num_received_datagrams_) {
+    int result;
+    do {
+      result = ReceiveDatagrams();
+    } while (result == -1 && GetSocketErrorCode() == EINTR_CODE);
+    // Abort() wakes up the receive, which then returns 0 or fails.
+    if (aborted_)
+      return -1;
+    if (result <= 0)
+      return result;
+  }
+
+  // Return as many whole datagrams as |buffer| can hold.
+  uint8_t* const output = static_cast<uint8_t*>(buffer);
+  uint64_t size = 0;
+  while (next_datagram_ < num_received_datagrams_) {
+    const size_t datagram_size = messages_[next_datagram_].msg_len;
+    if (size + datagram_size > length) {
+      if (size > 0)
+        break;
+      // Like recvfrom, truncate a datagram larger than |buffer| and drop the
+      // rest of it, rather than returning 0, which signals EOF.
+      LOG(WARNING) << "Truncating datagram of " << datagram_size
+                   << " bytes to " << length << " bytes.";
+      memcpy(output, &datagram_buffer_[next_datagram_ * kMaxDatagramSize],
+             length);
+      ++next_datagram_;
+      return length;
+    }
+    memcpy(output + size, &datagram_buffer_[next_datagram_ * kMaxDatagramSize],
+           datagram_size);
+    size += datagram_size;
+    ++next_datagram_;
+  }
+  return size;
+#else
   int64_t result;
   do {
     result = recvfrom(socket_, reinterpret_cast<char*>(buffer),
                       static_cast<int>(length), 0, NULL, 0);
   } while (result == -1 && GetSocketErrorCode() == EINTR_CODE);
 
+  return aborted_ ? -1 : result;
+#endif  // defined(__linux__)
+}
+
+#if defined(__linux__)
+int UdpFile::ReceiveDatagrams() {
+  if (messages_.empty()) {
+    datagram_buffer_.resize(kMaxDatagramsPerReceive * kMaxDatagramSize);
+    control_buffer_.resize(kMaxDatagramsPerReceive * kControlBufferSize);
+    iovecs_.resize(kMaxDatagramsPerReceive);
+    messages_.resize(kMaxDatagramsPerReceive);
+  }
+  for (size_t i = 0; i < kMaxDatagramsPerReceive; ++i) {
+    iovecs_[i].iov_base = &datagram_buffer_[i * kMaxDatagramSize];
+    iovecs_[i].iov_len = kMaxDatagramSize;
+    struct msghdr& message = messages_[i].msg_hdr;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iovecs_[i];
+    message.msg_iovlen = 1;
+    message.msg_control = &control_buffer_[i * kControlBufferSize];
+    message.msg_controllen = kControlBufferSize;
+  }
+
+  // Block until one datagram arrives, then take all the datagrams already
+  // queued in the socket.
+  const int result = recvmmsg(socket_, messages_.data(),
+                              kMaxDatagramsPerReceive, MSG_WAITFORONE, nullptr);
+  if (result <= 0)
+    return result;
+  num_received_datagrams_ = result;
+  next_datagram_ = 0;
+  UpdateDroppedDatagrams(messages_[result - 1].msg_hdr);
   return result;
 }
 
+void UdpFile::UpdateDroppedDatagrams(const struct msghdr& message) {
+  for (const struct cmsghdr* control_message =
+           CMSG_FIRSTHDR(const_cast<struct msghdr*>(&message));
+       control_message; control_message = CMSG_NXTHDR(
+           const_cast<struct msghdr*>(&message),
+           const_cast<struct cmsghdr*>(control_message))) {
+    if (control_message->cmsg_level != SOL_SOCKET ||
+        control_message->cmsg_type != SO_RXQ_OVFL) {
+      continue;
+    }
+    uint32_t num_dropped_datagrams;
+    memcpy(&num_dropped_datagrams, CMSG_DATA(control_message),
+           sizeof(num_dropped_datagrams));
+    if (num_dropped_datagrams != num_dropped_datagrams_) {
+      LOG(WARNING) << "UDP socket " << file_name() << " dropped "
+                   << num_dropped_datagrams - num_dropped_datagrams_
+                   << " datagrams (" << num_dropped_datagrams
+                   << " in total). Consider increasing the buffer_size "
+                      "option.";
+      num_dropped_datagrams_ = num_dropped_datagrams;
+    }
+  }
+}
+#endif  // defined(__linux__)
+
 int64_t UdpFile::Write(const void* buffer, uint64_t length) {
-  UNUSED(buffer);
-  UNUSED(length);
-  NOTIMPLEMENTED() << "UdpFile is unwritable!";
-  return -1;
+  DCHECK(buffer);
+  if (!is_output_) {
+    NOTIMPLEMENTED() << "UdpFile is not opened for write!";
+    return -1;
+  }
+  if (socket_ == INVALID_SOCKET)
+    return -1;
+
+  const uint8_t* data = static_cast<const uint8_t*>(buffer);
+  send_buffer_.insert(send_buffer_.end(), data, data + length);
+  if (!pacing_) {
+    if (!SendDatagrams(send_buffer_.size(), false,
+                       std::chrono::steady_clock::now())) {
+      return -1;
+    }
+    return length;
+  }
+
+  // The packets before each PCR are spread until the time of the PCR. The
+  // packets after the last PCR wait for the next one.
+  while (scanned_size_ + kTsPacketSize <= send_buffer_.size()) {
+    uint64_t pcr = 0;
+    if (ReadPcr(&send_buffer_[scanned_size_], &pcr)) {
+      if (!SendDatagrams(scanned_size_, true, GetSendTime(pcr)))
+        return -1;
+      scanned_size_ = 0;
+    }
+    scanned_size_ += kTsPacketSize;
+  }
+  return length;
+}
+
+bool UdpFile::SendDatagrams(size_t size,
+                            bool send_partial_datagram,
+                            std::chrono::steady_clock::time_point deadline) {
+  DCHECK_LE(size, send_buffer_.size());
+  size_t num_datagrams = size / kDatagramSize;
+  size_t send_size = num_datagrams * kDatagramSize;
+  if (send_partial_datagram && send_size < size) {
+    ++num_datagrams;
+    send_size = size;
+  }
+  if (num_datagrams == 0)
+    return true;
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto interval =
+      deadline > start
+          ? std::chrono::duration_cast<std::chrono::nanoseconds>(
+                deadline - start) /
+                static_cast<int64_t>(num_datagrams)
+          : std::chrono::nanoseconds::zero();
+  size_t num_sent = 0;
+  while (num_sent < num_datagrams) {
+    size_t num_due = num_datagrams;
+    if (interval.count() > 0) {
+      const auto elapsed =
+          std::chrono::steady_clock::now() - start + kPacingGranularity;
+      num_due = std::min(num_datagrams,
+                         static_cast<size_t>(elapsed / interval) + 1);
+      if (num_due <= num_sent) {
+        std::this_thread::sleep_until(
+            start + interval * static_cast<int64_t>(num_sent));
+        continue;
+      }
+    }
+    num_due = std::min(num_due, num_sent + kMaxDatagramsPerSend);
+    const size_t offset = num_sent * kDatagramSize;
+    const size_t end = std::min(send_size, num_due * kDatagramSize);
+    if (!SendBatch(&send_buffer_[offset], end - offset, num_due - num_sent))
+      return false;
+    num_sent = num_due;
+  }
+  send_buffer_.erase(send_buffer_.begin(), send_buffer_.begin() + send_size);
+  return true;
+}
+
+bool UdpFile::SendBatch(const uint8_t* data,
+                        size_t size,
+                        size_t num_datagrams) {
+#if defined(__linux__)
+  if (send_messages_.size() < num_datagrams) {
+    send_iovecs_.resize(num_datagrams);
+    send_messages_.resize(num_datagrams);
+  }
+  for (size_t i = 0; i < num_datagrams; ++i) {
+    const size_t offset = i * kDatagramSize;
+    send_iovecs_[i].iov_base = const_cast<uint8_t*>(data + offset);
+    send_iovecs_[i].iov_len = std::min(kDatagramSize, size - offset);
+    struct msghdr& message = send_messages_[i].msg_hdr;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &send_iovecs_[i];
+    message.msg_iovlen = 1;
+  }
+
+  size_t num_sent = 0;
+  // Whether the datagram at |num_sent| failed with ECONNREFUSED already.
+  bool refused = false;
+  while (num_sent < num_datagrams) {
+    const int result = sendmmsg(socket_, &send_messages_[num_sent],
+                                num_datagrams - num_sent, 0);
+    if (result < 0) {
+      const int error = GetSocketErrorCode();
+      if (error == EINTR_CODE)
+        continue;
+      // Reported for an earlier datagram sent to a unicast receiver which is
+      // not listening yet. The datagram at |num_sent| was not sent, so retry
+      // it once, and drop it if it is refused again.
+      if (error == ECONNREFUSED) {
+        if (!refused) {
+          refused = true;
+          continue;
+        }
+        LOG(WARNING) << "Dropping a datagram refused by UDP socket "
+                     << file_name() << ".";
+        ++num_sent;
+        refused = false;
+        continue;
+      }
+      LOG(ERROR) << "Failed to send to UDP socket " << file_name()
+                 << ", error = " << error;
+      return false;
+    }
+    num_sent += result;
+    refused = false;
+  }
+#else
+  UNUSED(num_datagrams);
+  for (size_t offset = 0; offset < size; offset += kDatagramSize) {
+    const int datagram_size =
+        static_cast<int>(std::min(kDatagramSize, size - offset));
+    int result;
+    do {
+      result = send(socket_, reinterpret_cast<const char*>(data + offset),
+                    datagram_size, 0);
+    } while (result == -1 && GetSocketErrorCode() == EINTR_CODE);
+    if (result < 0) {
+      LOG(ERROR) << "Failed to send to UDP socket " << file_name()
+                 << ", error = " << GetSocketErrorCode();
+      return false;
+    }
+  }
+#endif  // defined(__linux__)
+  return true;
+}
+
+std::chrono::steady_clock::time_point UdpFile::GetSendTime(uint64_t pcr) {
+  const auto now = std::chrono::steady_clock::now();
+  if (has_pcr_) {
+    const uint64_t delta =
+        (pcr + kPcrWrapAround - last_pcr_) % kPcrWrapAround;
+    // More than a second between two PCRs is a discontinuity.
+    if (delta <= kPcrClockRate) {
+      const auto send_time =
+          last_pcr_time_ +
+          std::chrono::nanoseconds(delta * 1000000000 / kPcrClockRate);
+      if (send_time + kMaxPacingDelay >= now) {
+        last_pcr_ = pcr;
+        last_pcr_time_ = send_time;
+        return send_time;
+      }
+    }
+  }
+  has_pcr_ = true;
+  last_pcr_ = pcr;
+  last_pcr_time_ = now;
+  return now;
 }
 
 void UdpFile::CloseForWriting() {
@@ -105,6 +471,17 @@ void UdpFile::CloseForWriting() {
 #endif
 }
 
+void UdpFile::Abort() {
+  aborted_ = true;
+  // Shutting the socket down wakes up a blocked receive, even if the socket is
+  // not connected.
+#if defined(OS_WIN)
+  shutdown(socket_, SD_BOTH);
+#else
+  shutdown(socket_, SHUT_RDWR);
+#endif
+}
+
 int64_t UdpFile::Size() {
   if (socket_ == INVALID_SOCKET)
     return -1;
@@ -113,8 +490,15 @@ int64_t UdpFile::Size() {
 }
 
 bool UdpFile::Flush() {
-  NOTIMPLEMENTED() << "UdpFile is unflushable!";
-  return false;
+  if (!is_output_) {
+    NOTIMPLEMENTED() << "UdpFile is unflushable!";
+    return false;
+  }
+  if (socket_ == INVALID_SOCKET)
+    return false;
+  scanned_size_ = 0;
+  return SendDatagrams(send_buffer_.size(), true,
+                       std::chrono::steady_clock::now());
 }
 
 bool UdpFile::Seek(uint64_t position) {
@@ -182,6 +566,14 @@ bool UdpFile::Open() {
     return false;
   }
 
+  if (is_output_) {
+    if (!SetUpOutputSocket(new_socket.get(), *options, local_in_addr))
+      return false;
+    pacing_ = options->pacing();
+    socket_ = new_socket.release();
+    return true;
+  }
+
   // TODO(kqyang): Support IPv6.
   struct sockaddr_in local_sock_addr;
   memset(&local_sock_addr, 0, sizeof(local_sock_addr));
@@ -280,6 +672,17 @@ bool UdpFile::Open() {
 #endif  // #if defined(__linux__)
   }
 
+#if defined(__linux__)
+  // Report the number of datagrams dropped because the receive buffer was
+  // full along with the received datagrams.
+  const int optval_one = 1;
+  if (setsockopt(new_socket.get(), SOL_SOCKET, SO_RXQ_OVFL, &optval_one,
+                 sizeof(optval_one)) < 0) {
+    VLOG(1) << "Failed to enable SO_RXQ_OVFL, error = "
+            << GetSocketErrorCode();
+  }
+#endif  // defined(__linux__)
+
   // Set timeout if needed.
   if (options->timeout_us() != 0) {
     struct timeval tv;
@@ -7,13 +7,17 @@
 #ifndef MEDIA_FILE_UDP_FILE_H_
 #define MEDIA_FILE_UDP_FILE_H_
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #if defined(OS_WIN)
 #include <windows.h>
 #include <winsock2.h>
 #else
+#include <sys/socket.h>
 typedef int SOCKET;
 #endif  // defined(OS_WIN)
 
@@ -22,12 +26,14 @@ typedef int SOCKET;
 
 namespace shaka {
 
-/// Implements UdpFile, which receives UDP unicast and multicast streams.
+/// Implements UdpFile, which receives UDP unicast and multicast streams, or
+/// sends MPEG-TS streams as datagrams of 7 TS packets.
 class UdpFile : public File {
  public:
-  /// @param file_name C string containing the address of the stream to receive.
-  ///        It should be of the form "<ip_address>:<port>".
-  explicit UdpFile(const char* address_and_port);
+  /// @param file_name C string containing the address of the stream to receive
+  ///        or to send to. It should be of the form "<ip_address>:<port>".
+  /// @param is_output is true to send the data written to the stream.
+  explicit UdpFile(const char* address_and_port, bool is_output = false);
 
   /// @name File implementation overrides.
   /// @{
@@ -35,6 +41,7 @@ class UdpFile : public File {
   int64_t Read(void* buffer, uint64_t length) override;
   int64_t Write(const void* buffer, uint64_t length) override;
   void CloseForWriting() override;
+  void Abort() override;
   int64_t Size() override;
   bool Flush() override;
   bool Seek(uint64_t position) override;
@@ -47,7 +54,56 @@ class UdpFile : public File {
   bool Open() override;
 
  private:
+  // Send the whole datagrams in the first |size| bytes of |send_buffer_|, or
+  // all of them if |send_partial_datagram|. With pacing, the datagrams are
+  // spread until |deadline|. Returns false on error.
+  bool SendDatagrams(size_t size,
+                     bool send_partial_datagram,
+                     std::chrono::steady_clock::time_point deadline);
+  // Send |num_datagrams| datagrams of |size| bytes in total from |data| with
+  // as few system calls as possible. Returns false on error.
+  bool SendBatch(const uint8_t* data, size_t size, size_t num_datagrams);
+  // Returns the time at which the TS packet carrying |pcr|, in 27 MHz units,
+  // is to be sent.
+  std::chrono::steady_clock::time_point GetSendTime(uint64_t pcr);
+
+#if defined(__linux__)
+  // Receive up to kMaxDatagramsPerReceive datagrams with a single system call.
+  // Returns the number of datagrams received, or -1 on error.
+  int ReceiveDatagrams();
+  // Log the datagrams dropped by the kernel, as reported with the last
+  // received datagram.
+  void UpdateDroppedDatagrams(const struct msghdr& message);
+
+  // The datagrams received but not returned by Read() yet.
+  std::vector<uint8_t> datagram_buffer_;
+  std::vector<uint8_t> control_buffer_;
+  std::vector<struct iovec> iovecs_;
+  std::vector<struct mmsghdr> messages_;
+  int num_received_datagrams_ = 0;
+  int next_datagram_ = 0;
+  // Number of datagrams dropped by the kernel because the socket receive
+  // buffer was full.
+  uint32_t num_dropped_datagrams_ = 0;
+#endif  // defined(__linux__)
+
   SOCKET socket_;
+  const bool is_output_;
+  std::atomic<bool> aborted_{false};
+
+  // The bytes written but not sent yet.
+  std::vector<uint8_t> send_buffer_;
+  // The size of the start of |send_buffer_| already scanned for PCRs.
+  size_t scanned_size_ = 0;
+  bool pacing_ = false;
+  // The last PCR seen and the time at which it was sent, to pace the output.
+  bool has_pcr_ = false;
+  uint64_t last_pcr_ = 0;
+  std::chrono::steady_clock::time_point last_pcr_time_;
+#if defined(__linux__)
+  std::vector<struct iovec> send_iovecs_;
+  std::vector<struct mmsghdr> send_messages_;
+#endif  // defined(__linux__)
 #if defined(OS_WIN)
   // For Winsock in Windows.
   bool wsa_started_ = false;
@@ -0,0 +1,201 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/udp_file.h>
+
+#if !defined(OS_WIN)
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <packager/file.h>
+
+namespace shaka {
+namespace {
+
+const size_t kTsPacketSize = 188;
+const size_t kPacketsPerDatagram = 7;
+const size_t kDatagramSize = kPacketsPerDatagram * kTsPacketSize;
+const uint64_t kPcrClockRate = 27000000;
+
+// Returns a TS packet whose payload is filled with |index|, with |pcr| in its
+// adaptation field if it is not negative.
+std::vector<uint8_t> TsPacket(uint8_t index, int64_t pcr = -1) {
+  std::vector<uint8_t> packet(kTsPacketSize, index);
+  packet[0] = 0x47;
+  packet[1] = 0x01;
+  packet[2] = 0x00;
+  if (pcr < 0) {
+    packet[3] = 0x10;
+    return packet;
+  }
+  packet[3] = 0x30;
+  packet[4] = 7;
+  packet[5] = 0x10;
+  const uint64_t pcr_base = pcr / 300;
+  const uint64_t pcr_extension = pcr % 300;
+  packet[6] = static_cast<uint8_t>(pcr_base >> 25);
+  packet[7] = static_cast<uint8_t>(pcr_base >> 17);
+  packet[8] = static_cast<uint8_t>(pcr_base >> 9);
+  packet[9] = static_cast<uint8_t>(pcr_base >> 1);
+  packet[10] = static_cast<uint8_t>(((pcr_base & 1) << 7) | 0x7e |
+                                    (pcr_extension >> 8));
+  packet[11] = static_cast<uint8_t>(pcr_extension);
+  return packet;
+}
+
+void AppendPacket(const std::vector<uint8_t>& packet,
+                  std::vector<uint8_t>* data) {
+  data->insert(data->end(), packet.begin(), packet.end());
+}
+
+// A UDP socket bound to a free port of the loopback interface, which receives
+// the datagrams sent by a UdpFile.
+class Receiver {
+ public:
+  Receiver() {
+    socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t address_size = sizeof(address);
+    const int buffer_size = 4 * 1024 * 1024;
+    struct timeval timeout = {1, 0};
+    if (bind(socket_, reinterpret_cast<struct sockaddr*>(&address),
+             sizeof(address)) == 0 &&
+        getsockname(socket_, reinterpret_cast<struct sockaddr*>(&address),
+                    &address_size) == 0 &&
+        setsockopt(socket_, SOL_SOCKET, SO_RCVBUF, &buffer_size,
+                   sizeof(buffer_size)) == 0 &&
+        setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                   sizeof(timeout)) == 0) {
+      port_ = ntohs(address.sin_port);
+    }
+  }
+
+  ~Receiver() { close(socket_); }
+
+  // Returns the next datagram, or an empty one on timeout.
+  std::vector<uint8_t> Receive() {
+    std::vector<uint8_t> datagram(65536);
+    const ssize_t size = recv(socket_, datagram.data(), datagram.size(), 0);
+    datagram.resize(size > 0 ? size : 0);
+    return datagram;
+  }
+
+  std::string url() const {
+    return "udp://127.0.0.1:" + std::to_string(port_);
+  }
+  uint16_t port() const { return port_; }
+
+ private:
+  int socket_ = -1;
+  uint16_t port_ = 0;
+};
+
+}  // namespace
+
+TEST(UdpFileTest, SendsDatagramsOfSevenPackets) {
+  Receiver receiver;
+  ASSERT_NE(0u, receiver.port());
+
+  // More datagrams than are sent in a batch, followed by a partial datagram.
+  const size_t kNumPackets = 100 * kPacketsPerDatagram + 3;
+  std::vector<uint8_t> data;
+  for (size_t i = 0; i < kNumPackets; ++i)
+    AppendPacket(TsPacket(static_cast<uint8_t>(i)), &data);
+
+  File* file = File::Open((receiver.url() + "?pacing=0").c_str(), "w");
+  ASSERT_TRUE(file);
+  EXPECT_EQ(static_cast<int64_t>(data.size()),
+            file->Write(data.data(), data.size()));
+  ASSERT_TRUE(file->Close());
+
+  std::vector<uint8_t> received;
+  for (size_t i = 0; i < 100; ++i) {
+    std::vector<uint8_t> datagram = receiver.Receive();
+    ASSERT_EQ(kDatagramSize, datagram.size()) << "datagram " << i;
+    received.insert(received.end(), datagram.begin(), datagram.end());
+  }
+  std::vector<uint8_t> datagram = receiver.Receive();
+  EXPECT_EQ(3 * kTsPacketSize, datagram.size());
+  received.insert(received.end(), datagram.begin(), datagram.end());
+  EXPECT_EQ(data, received);
+}
+
+TEST(UdpFileTest, PacesDatagramsByPcr) {
+  Receiver receiver;
+  ASSERT_NE(0u, receiver.port());
+
+  // Three PCRs 150 ms apart, with 10 datagrams between each two of them.
+  const int64_t kPcrInterval = kPcrClockRate * 150 / 1000;
+  std::vector<uint8_t> data;
+  for (int64_t pcr = 0; pcr <= 2 * kPcrInterval; pcr += kPcrInterval) {
+    AppendPacket(TsPacket(0, pcr), &data);
+    for (size_t i = 1; i < 10 * kPacketsPerDatagram; ++i)
+      AppendPacket(TsPacket(static_cast<uint8_t>(i)), &data);
+  }
+
+  File* file = File::Open(receiver.url().c_str(), "w");
+  ASSERT_TRUE(file);
+  // The datagrams are sent in the background, until Close() returns.
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(static_cast<int64_t>(data.size()),
+            file->Write(data.data(), data.size()));
+  ASSERT_TRUE(file->Close());
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  // The datagrams before the second and the third PCRs are spread over the
+  // 300 ms between the first and the third PCRs, the last datagram of each
+  // being sent up to one interval early.
+  EXPECT_GE(elapsed, std::chrono::milliseconds(250));
+
+  size_t received_size = 0;
+  for (std::vector<uint8_t> datagram = receiver.Receive(); !datagram.empty();
+       datagram = receiver.Receive()) {
+    received_size += datagram.size();
+  }
+  EXPECT_EQ(data.size(), received_size);
+}
+
+#if defined(__linux__)
+TEST(UdpFileTest, WritesWithoutReceiver) {
+  uint16_t port = 0;
+  {
+    // The port is free once the receiver is gone, so the datagrams are
+    // refused.
+    Receiver receiver;
+    port = receiver.port();
+  }
+  ASSERT_NE(0u, port);
+
+  std::vector<uint8_t> data;
+  for (size_t i = 0; i < 10 * kPacketsPerDatagram; ++i)
+    AppendPacket(TsPacket(static_cast<uint8_t>(i)), &data);
+
+  File* file = File::Open(
+      ("udp://127.0.0.1:" + std::to_string(port) + "?pacing=0").c_str(), "w");
+  ASSERT_TRUE(file);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(static_cast<int64_t>(data.size()),
+              file->Write(data.data(), data.size()));
+  }
+  EXPECT_TRUE(file->Close());
+}
+#endif  // defined(__linux__)
+
+}  // namespace shaka
+
+#endif  // !defined(OS_WIN)
@@ -31,8 +31,10 @@ enum FieldType {
   kBufferSizeField,
   kInterfaceAddressField,
   kMulticastSourceField,
+  kPacingField,
   kReuseField,
   kTimeoutField,
+  kTtlField,
 };
 
 struct FieldNameToTypeMapping {
@@ -43,9 +45,11 @@ struct FieldNameToTypeMapping {
 const FieldNameToTypeMapping kFieldNameTypeMappings[] = {
     {"buffer_size", kBufferSizeField},
     {"interface", kInterfaceAddressField},
+    {"pacing", kPacingField},
     {"reuse", kReuseField},
     {"source", kMulticastSourceField},
     {"timeout", kTimeoutField},
+    {"ttl", kTtlField},
 };
 
 FieldType GetFieldType(const std::string& field_name) {
@@ -108,6 +112,16 @@ std::unique_ptr<UdpOptions> UdpOptions::ParseFromString(
           options->source_address_ = pair.second;
           options->is_source_specific_multicast_ = true;
           break;
+        case kPacingField: {
+          int pacing_value = 0;
+          if (!absl::SimpleAtoi(pair.second, &pacing_value)) {
+            LOG(ERROR) << "Invalid udp option for pacing field "
+                       << pair.second;
+            return nullptr;
+          }
+          options->pacing_ = pacing_value > 0;
+          break;
+        }
         case kReuseField: {
           int reuse_value = 0;
           if (!absl::SimpleAtoi(pair.second, &reuse_value)) {
@@ -124,6 +138,13 @@ std::unique_ptr<UdpOptions> UdpOptions::ParseFromString(
             return nullptr;
           }
           break;
+        case kTtlField:
+          if (!absl::SimpleAtoi(pair.second, &options->ttl_) ||
+              options->ttl_ < 0 || options->ttl_ > 255) {
+            LOG(ERROR) << "Invalid udp option for ttl field " << pair.second;
+            return nullptr;
+          }
+          break;
         default:
           LOG(ERROR) << "Unknown field in udp options (\"" << pair.first
                      << "\").";
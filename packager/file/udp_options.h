@@ -29,6 +29,8 @@ class UdpOptions {
     return is_source_specific_multicast_;
   }
   int buffer_size() const { return buffer_size_; }
+  int ttl() const { return ttl_; }
+  bool pacing() const { return pacing_; }
 
  private:
   UdpOptions() = default;
@@ -45,11 +47,15 @@ class UdpOptions {
   // Source specific multicast source address
   std::string source_address_ = "0.0.0.0";
   bool is_source_specific_multicast_ = false;
-  // Maximum receive buffer size in bytes.
+  // Maximum receive buffer size in bytes, or send buffer size for outputs.
   // Note that the actual buffer size is capped by the maximum buffer size set
   // by the underlying operating system ('sysctl net.core.rmem_max' on Linux
   // returns the maximum receive memory size).
   int buffer_size_ = 0;
+  // Time to live of the multicast datagrams sent. 0 to use the system default.
+  int ttl_ = 0;
+  // Whether to send MPEG-TS outputs at the rate given by their PCRs.
+  bool pacing_ = true;
 };
 
 }  // namespace shaka
@@ -130,4 +130,21 @@ TEST_F(UdpOptionsTest, BufferSize) {
   EXPECT_EQ(1234, options->buffer_size());
 }
 
+TEST_F(UdpOptionsTest, OutputOptions) {
+  auto options = UdpOptions::ParseFromString("224.1.2.30:88");
+  ASSERT_TRUE(options);
+  EXPECT_EQ(0, options->ttl());
+  EXPECT_TRUE(options->pacing());
+
+  options = UdpOptions::ParseFromString("224.1.2.30:88?ttl=16&pacing=0");
+  ASSERT_TRUE(options);
+  EXPECT_EQ(16, options->ttl());
+  EXPECT_FALSE(options->pacing());
+}
+
+TEST_F(UdpOptionsTest, InvalidOutputOptions) {
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?ttl=256"));
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?pacing=on"));
+}
+
 }  // namespace shaka
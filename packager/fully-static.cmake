@@ -6,9 +6,8 @@
 
 # Fully-static build settings.
 if(FULLY_STATIC)
-  # This is the "object" version of mimalloc, as opposed to the library
-  # version.  This is important for a static override of malloc and friends.
-  set(EXTRA_EXE_LIBRARIES $<TARGET_OBJECTS:mimalloc-obj>)
+  # Replace the standard allocator in musl, which is slow.
+  set(USE_MIMALLOC ON)
 
   # Keep the linker from searching for dynamic libraries.
   set(CMAKE_LINK_SEARCH_START_STATIC OFF)
@@ -25,3 +24,11 @@ if(FULLY_STATIC)
   # as intermediate outputs, which then could not run on a glibc host system.
   add_link_options(-static-libgcc -static-libstdc++ -static)
 endif()
+
+if(USE_MIMALLOC)
+  # This is the "object" version of mimalloc, as opposed to the library
+  # version.  This is important for a static override of malloc and friends.
+  set(EXTRA_EXE_LIBRARIES $<TARGET_OBJECTS:mimalloc-obj>)
+  set(MIMALLOC_INCLUDE_DIR
+      "${CMAKE_CURRENT_SOURCE_DIR}/third_party/mimalloc/source/include")
+endif()
@@ -65,6 +65,25 @@ class HlsNotifier {
                                 uint64_t start_byte_offset,
                                 uint64_t size) = 0;
 
+  /// Called on every chunk of a segment being written, for LL-HLS. The
+  /// containing segment is notified with NotifyNewSegment() once all its
+  /// chunks are written.
+  /// @param stream_id is the value set by NotifyNewStream().
+  /// @param segment_name is the name of the segment being written.
+  /// @param start_time is the start time of the chunk in timescale units
+  ///        passed in @a media_info.
+  /// @param duration is also in terms of timescale.
+  /// @param start_byte_offset is the offset of the chunk in the segment.
+  /// @param size is the size in bytes.
+  /// @param independent is true if the chunk starts with a key frame.
+  virtual bool NotifyNewPartialSegment(uint32_t stream_id,
+                                       const std::string& segment_name,
+                                       int64_t start_time,
+                                       int64_t duration,
+                                       uint64_t start_byte_offset,
+                                       uint64_t size,
+                                       bool independent) = 0;
+
   /// Called on every key frame. For Video only.
   /// @param stream_id is the value set by NotifyNewStream().
   /// @param timestamp is the timesamp of the key frame in timescale units
@@ -100,6 +119,13 @@ class HlsNotifier {
   /// @return true on success, false otherwise.
   virtual bool Flush() = 0;
 
+  /// Write the VOD playlists of a live presentation which has ended, see
+  /// HlsParams::vod_archive_master_playlist_output. No stream may be updated
+  /// after.
+  /// @return true on success or if there is nothing to write, false
+  ///         otherwise.
+  virtual bool WriteVodArchive() { return true; }
+
   /// @return The HLS parameters.
   const HlsParams& hls_params() const { return hls_params_; }
 
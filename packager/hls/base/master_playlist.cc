@@ -17,6 +17,7 @@
 #include <absl/strings/str_join.h>
 
 #include <packager/file.h>
+#include <packager/file/file_util.h>
 #include <packager/hls/base/media_playlist.h>
 #include <packager/hls/base/tag.h>
 #include <packager/macros/logging.h>
@@ -564,6 +565,17 @@ bool MasterPlaylist::WriteMasterPlaylist(
     const std::string& base_url,
     const std::string& output_dir,
     const std::list<MediaPlaylist*>& playlists) {
+  std::vector<std::pair<const MediaPlaylist*, uint64_t>> revisions;
+  revisions.reserve(playlists.size());
+  for (const MediaPlaylist* playlist : playlists)
+    revisions.emplace_back(playlist, playlist->master_playlist_revision());
+  // Skip if nothing in the master playlist may have changed since the last
+  // write.
+  if (!written_playlist_.empty() && revisions == written_revisions_ &&
+      base_url == written_base_url_) {
+    return true;
+  }
+
   std::string content = "#EXTM3U\n";
   AppendVersionString(&content);
 
@@ -591,15 +603,23 @@ bool MasterPlaylist::WriteMasterPlaylist(
                   playlists, &content);
 
   // Skip if the playlist is already written.
-  if (content == written_playlist_)
-    return true;
-
-  auto file_path = std::filesystem::u8path(output_dir) / file_name_;
-  if (!File::WriteFileAtomically(file_path.string().c_str(), content)) {
-    LOG(ERROR) << "Failed to write master playlist to: " << file_path.string();
-    return false;
+  if (content != written_playlist_) {
+    auto file_path = std::filesystem::u8path(output_dir) / file_name_;
+    if (!File::WriteFileAtomically(file_path.string().c_str(), content)) {
+      LOG(ERROR) << "Failed to write master playlist to: "
+                 << file_path.string();
+      return false;
+    }
+    if (write_gzip_ &&
+        !WriteGzipFileAtomically(file_path.string() + ".gz", content)) {
+      LOG(ERROR) << "Failed to write compressed master playlist to: "
+                 << file_path.string() << ".gz";
+      return false;
+    }
+    written_playlist_ = std::move(content);
   }
-  written_playlist_ = content;
+  written_base_url_ = base_url;
+  written_revisions_ = std::move(revisions);
   return true;
 }
 
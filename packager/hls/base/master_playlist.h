@@ -7,9 +7,12 @@
 #ifndef PACKAGER_HLS_BASE_MASTER_PLAYLIST_H_
 #define PACKAGER_HLS_BASE_MASTER_PLAYLIST_H_
 
+#include <cstdint>
 #include <filesystem>
 #include <list>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace shaka {
 namespace hls {
@@ -32,6 +35,10 @@ class MasterPlaylist {
                  const bool create_session_keys = false);
   virtual ~MasterPlaylist();
 
+  /// Also write the playlist compressed with gzip, next to it with ".gz"
+  /// appended to the file name.
+  void set_write_gzip(bool write_gzip) { write_gzip_ = write_gzip; }
+
   /// Writes Master Playlist to output_dir + <name of playlist>.
   /// This assumes that @a base_url is used as the prefix for Media Playlists.
   /// @param base_url is the prefix for the Media Playlist files. This should be
@@ -50,11 +57,17 @@ class MasterPlaylist {
   MasterPlaylist& operator=(const MasterPlaylist&) = delete;
 
   std::string written_playlist_;
+  // The arguments and the playlist revisions |written_playlist_| was
+  // generated from. The master playlist is only generated again if they
+  // change.
+  std::string written_base_url_;
+  std::vector<std::pair<const MediaPlaylist*, uint64_t>> written_revisions_;
   const std::filesystem::path file_name_;
   const std::string default_audio_language_;
   const std::string default_text_language_;
   bool is_independent_segments_;
   bool create_session_keys_;
+  bool write_gzip_ = false;
 };
 
 }  // namespace hls
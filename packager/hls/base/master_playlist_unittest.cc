@@ -23,6 +23,7 @@ namespace hls {
 using ::testing::_;
 using ::testing::AtLeast;
 using ::testing::DoAll;
+using ::testing::HasSubstr;
 using ::testing::NotNull;
 using ::testing::Return;
 using ::testing::ReturnRef;
@@ -184,6 +185,39 @@ TEST_F(MasterPlaylistTest, WriteMasterPlaylistOneVideo) {
   ASSERT_EQ(expected, actual);
 }
 
+TEST_F(MasterPlaylistTest, WriteMasterPlaylistOnlyIfPlaylistsChanged) {
+  const uint64_t kMaxBitrate = 435889;
+  const uint64_t kNewMaxBitrate = 535889;
+  const uint64_t kAvgBitrate = 235889;
+
+  std::unique_ptr<MockMediaPlaylist> mock_playlist =
+      CreateVideoPlaylist("media1.m3u8", "avc1", kMaxBitrate, kAvgBitrate);
+
+  const char kBaseUrl[] = "http://myplaylistdomain.com/";
+  EXPECT_TRUE(master_playlist_->WriteMasterPlaylist(kBaseUrl, test_output_dir_,
+                                                   {mock_playlist.get()}));
+
+  // The master playlist is not generated again if the playlists are the same.
+  EXPECT_CALL(*mock_playlist, MaxBitrate()).Times(0);
+  EXPECT_TRUE(master_playlist_->WriteMasterPlaylist(kBaseUrl, test_output_dir_,
+                                                   {mock_playlist.get()}));
+
+  // It is generated again once a playlist changes.
+  mock_playlist->MediaPlaylist::AddEncryptionInfo(
+      MediaPlaylist::EncryptionMethod::kSampleAes, "http://example.com", "",
+      "0x12345678", "com.widevine", "1");
+  EXPECT_CALL(*mock_playlist, MaxBitrate())
+      .Times(AtLeast(1))
+      .WillRepeatedly(Return(kNewMaxBitrate));
+  EXPECT_TRUE(master_playlist_->WriteMasterPlaylist(kBaseUrl, test_output_dir_,
+                                                   {mock_playlist.get()}));
+
+  std::string actual;
+  ASSERT_TRUE(
+      File::ReadFileToString(master_playlist_path_.string().c_str(), &actual));
+  EXPECT_THAT(actual, HasSubstr("BANDWIDTH=535889,"));
+}
+
 TEST_F(MasterPlaylistTest, 
        WriteMasterPlaylistOneVideoWithIndependentSegments) {
   const uint64_t kMaxBitrate = 435889;
@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cmath>
+#include <deque>
 #include <memory>
 #include <optional>
 
@@ -18,6 +19,8 @@
 #include <absl/strings/str_format.h>
 
 #include <packager/file.h>
+#include <packager/file/file_reaper.h>
+#include <packager/file/file_util.h>
 #include <packager/hls/base/tag.h>
 #include <packager/macros/logging.h>
 #include <packager/media/base/language_utils.h>
@@ -104,6 +107,25 @@ void AppendExtXMap(const MediaInfo& media_info, std::string* out) {
   }
 }
 
+// CAN-SKIP-UNTIL must be at least six target durations.
+const int kMinSkipTargetDurations = 6;
+
+// The Playlist Delta Update of "dir/video.m3u8" is "dir/video_skip.m3u8".
+std::string GetDeltaUpdatePlaylistPath(const std::string& playlist_path) {
+  const size_t file_name_pos = playlist_path.find_last_of("/\\");
+  const size_t extension_pos = playlist_path.rfind('.');
+  if (extension_pos == std::string::npos ||
+      (file_name_pos != std::string::npos && extension_pos < file_name_pos)) {
+    return playlist_path + "_skip";
+  }
+  return playlist_path.substr(0, extension_pos) + "_skip" +
+         playlist_path.substr(extension_pos);
+}
+
+std::string GetStatePath(const std::string& playlist_path) {
+  return playlist_path + ".state";
+}
+
 std::string CreatePlaylistHeader(
     const MediaInfo& media_info,
     int32_t target_duration,
@@ -111,7 +133,10 @@ std::string CreatePlaylistHeader(
     MediaPlaylist::MediaPlaylistStreamType stream_type,
     uint32_t media_sequence_number,
     int discontinuity_sequence_number,
-    std::optional<double> start_time_offset) {
+    std::optional<double> start_time_offset,
+    std::optional<double> part_target_duration,
+    std::optional<double> can_skip_until,
+    bool is_delta_update) {
   const std::string version = GetPackagerVersion();
   std::string version_line;
   if (!version.empty()) {
@@ -120,13 +145,14 @@ std::string CreatePlaylistHeader(
                         GetPackagerProjectUrl().c_str(), version.c_str());
   }
 
-  // 6 is required for EXT-X-MAP without EXT-X-I-FRAMES-ONLY.
+  // 6 is required for EXT-X-MAP without EXT-X-I-FRAMES-ONLY, and 9 for
+  // EXT-X-SKIP.
   std::string header = absl::StrFormat(
       "#EXTM3U\n"
-      "#EXT-X-VERSION:6\n"
+      "#EXT-X-VERSION:%d\n"
       "%s"
       "#EXT-X-TARGETDURATION:%d\n",
-      version_line.c_str(), target_duration);
+      is_delta_update ? 9 : 6, version_line.c_str(), target_duration);
 
   switch (type) {
     case HlsPlaylistType::kVod:
@@ -149,6 +175,22 @@ std::string CreatePlaylistHeader(
       NOTIMPLEMENTED() << "Unexpected MediaPlaylistType "
                        << static_cast<int>(type);
   }
+  if (part_target_duration.has_value() || can_skip_until.has_value()) {
+    Tag tag("#EXT-X-SERVER-CONTROL", &header);
+    if (part_target_duration.has_value()) {
+      tag.AddString("CAN-BLOCK-RELOAD", "YES");
+      // PART-HOLD-BACK must be at least twice the part target duration.
+      // Three times is recommended.
+      tag.AddFloat("PART-HOLD-BACK", 3 * part_target_duration.value());
+    }
+    if (can_skip_until.has_value())
+      tag.AddFloat("CAN-SKIP-UNTIL", can_skip_until.value());
+    header += "\n";
+  }
+  if (part_target_duration.has_value()) {
+    absl::StrAppendFormat(&header, "#EXT-X-PART-INF:PART-TARGET=%.3f\n",
+                          part_target_duration.value());
+  }
   if (stream_type ==
       MediaPlaylist::MediaPlaylistStreamType::kVideoIFramesOnly) {
     absl::StrAppendFormat(&header, "#EXT-X-I-FRAMES-ONLY\n");
@@ -171,6 +213,12 @@ std::string CreatePlaylistHeader(
 HlsEntry::HlsEntry(HlsEntry::EntryType type) : type_(type) {}
 HlsEntry::~HlsEntry() {}
 
+const std::string& HlsEntry::ToCachedString() {
+  if (cached_string_.empty())
+    cached_string_ = ToString();
+  return cached_string_;
+}
+
 class SegmentInfoEntry : public HlsEntry {
  public:
   // If |use_byte_range| true then this will append EXT-X-BYTERANGE
@@ -188,10 +236,13 @@ class SegmentInfoEntry : public HlsEntry {
                    uint64_t previous_segment_end_offset);
 
   std::string ToString() override;
+  bool SaveState(MediaPlaylistState::Entry* entry) const override;
   int64_t start_time() const { return start_time_; }
   double duration_seconds() const { return duration_seconds_; }
+  uint64_t start_byte_offset() const { return start_byte_offset_; }
   void set_duration_seconds(double duration_seconds) {
     duration_seconds_ = duration_seconds;
+    InvalidateCachedString();
   }
 
  private:
@@ -239,12 +290,85 @@ std::string SegmentInfoEntry::ToString() {
   return result;
 }
 
+bool SegmentInfoEntry::SaveState(MediaPlaylistState::Entry* entry) const {
+  MediaPlaylistState::Segment* segment = entry->mutable_segment();
+  segment->set_file_name(file_name_);
+  segment->set_start_time(start_time_);
+  segment->set_duration_seconds(duration_seconds_);
+  segment->set_use_byte_range(use_byte_range_);
+  segment->set_start_byte_offset(start_byte_offset_);
+  segment->set_segment_file_size(segment_file_size_);
+  segment->set_previous_segment_end_offset(previous_segment_end_offset_);
+  return true;
+}
+
+class PartialSegmentEntry : public HlsEntry {
+ public:
+  // |start_time| and |duration| are in timescale.
+  // |duration_seconds| is duration in seconds.
+  PartialSegmentEntry(const std::string& file_name,
+                      int64_t start_time,
+                      int64_t duration,
+                      double duration_seconds,
+                      uint64_t start_byte_offset,
+                      uint64_t size,
+                      bool independent);
+
+  std::string ToString() override;
+  // Partial segments are not saved, as they are only kept for a few target
+  // durations.
+  bool SaveState(MediaPlaylistState::Entry*) const override { return false; }
+  int64_t end_time() const { return start_time_ + duration_; }
+
+ private:
+  PartialSegmentEntry(const PartialSegmentEntry&) = delete;
+  PartialSegmentEntry& operator=(const PartialSegmentEntry&) = delete;
+
+  const std::string file_name_;
+  const int64_t start_time_;
+  const int64_t duration_;
+  const double duration_seconds_;
+  const uint64_t start_byte_offset_;
+  const uint64_t size_;
+  const bool independent_;
+};
+
+PartialSegmentEntry::PartialSegmentEntry(const std::string& file_name,
+                                         int64_t start_time,
+                                         int64_t duration,
+                                         double duration_seconds,
+                                         uint64_t start_byte_offset,
+                                         uint64_t size,
+                                         bool independent)
+    : HlsEntry(HlsEntry::EntryType::kExtPart),
+      file_name_(file_name),
+      start_time_(start_time),
+      duration_(duration),
+      duration_seconds_(duration_seconds),
+      start_byte_offset_(start_byte_offset),
+      size_(size),
+      independent_(independent) {}
+
+std::string PartialSegmentEntry::ToString() {
+  std::string result;
+  Tag tag("#EXT-X-PART", &result);
+  tag.AddFloat("DURATION", duration_seconds_);
+  tag.AddQuotedString("URI", file_name_);
+  tag.AddQuotedNumberPair("BYTERANGE", size_, '@', start_byte_offset_);
+  if (independent_)
+    tag.AddString("INDEPENDENT", "YES");
+  return result;
+}
 
 class DiscontinuityEntry : public HlsEntry {
  public:
   DiscontinuityEntry();
 
   std::string ToString() override;
+  bool SaveState(MediaPlaylistState::Entry* entry) const override {
+    entry->set_discontinuity(true);
+    return true;
+  }
 
  private:
   DiscontinuityEntry(const DiscontinuityEntry&) = delete;
@@ -263,6 +387,10 @@ class PlacementOpportunityEntry : public HlsEntry {
   PlacementOpportunityEntry();
 
   std::string ToString() override;
+  bool SaveState(MediaPlaylistState::Entry* entry) const override {
+    entry->set_placement_opportunity(true);
+    return true;
+  }
 
  private:
   PlacementOpportunityEntry(const PlacementOpportunityEntry&) = delete;
@@ -330,6 +458,18 @@ std::string EncryptionInfoEntry::ToString(std::string tag_name) {
   return tag_string;
 }
 
+bool EncryptionInfoEntry::SaveState(MediaPlaylistState::Entry* entry) const {
+  MediaPlaylistState::EncryptionInfo* encryption_info =
+      entry->mutable_encryption_info();
+  encryption_info->set_method(static_cast<int32_t>(method_));
+  encryption_info->set_url(url_);
+  encryption_info->set_key_id(key_id_);
+  encryption_info->set_iv(iv_);
+  encryption_info->set_key_format(key_format_);
+  encryption_info->set_key_format_versions(key_format_versions_);
+  return true;
+}
+
 MediaPlaylist::MediaPlaylist(const HlsParams& hls_params,
                              const std::string& file_name,
                              const std::string& name,
@@ -338,7 +478,8 @@ MediaPlaylist::MediaPlaylist(const HlsParams& hls_params,
       file_name_(file_name),
       name_(name),
       group_id_(group_id),
-      media_sequence_number_(hls_params_.media_sequence_number) {
+      media_sequence_number_(hls_params_.media_sequence_number),
+      bandwidth_estimator_(hls_params_.bandwidth_window_segments) {
         // When there's a forced media_sequence_number, start with discontinuity
         if (media_sequence_number_ > 0)
           entries_.emplace_back(new DiscontinuityEntry());
@@ -379,7 +520,7 @@ void MediaPlaylist::AddEncryptionInfoForTesting(
       method, url, key_id, iv, key_format, key_format_versions));
 }
 
-bool MediaPlaylist::SetMediaInfo(const MediaInfo& media_info) {
+bool MediaPlaylist::SetMediaInfo(MediaInfo media_info) {
   const int32_t time_scale = GetTimeScale(media_info);
   if (time_scale == 0) {
     LOG(ERROR) << "MediaInfo does not contain a valid timescale.";
@@ -405,9 +546,10 @@ bool MediaPlaylist::SetMediaInfo(const MediaInfo& media_info) {
   }
 
   time_scale_ = time_scale;
-  media_info_ = media_info;
-  language_ = GetLanguage(media_info);
-  use_byte_range_ = !media_info_.has_segment_template_url() &&
+  media_info_ = std::move(media_info);
+  language_ = GetLanguage(media_info_);
+  use_byte_range_ = (!media_info_.has_segment_template_url() ||
+                     media_info_.segments_bundled()) &&
                     media_info_.container_type() != MediaInfo::CONTAINER_TEXT;
   characteristics_ =
       std::vector<std::string>(media_info_.hls_characteristics().begin(),
@@ -415,12 +557,16 @@ bool MediaPlaylist::SetMediaInfo(const MediaInfo& media_info) {
 
   forced_subtitle_ = media_info_.forced_subtitle();
 
+  ++master_playlist_revision_;
   return true;
 }
 
 void MediaPlaylist::SetSampleDuration(int32_t sample_duration) {
-  if (media_info_.has_video_info())
+  if (media_info_.has_video_info() &&
+      media_info_.video_info().frame_duration() != sample_duration) {
     media_info_.mutable_video_info()->set_frame_duration(sample_duration);
+    ++master_playlist_revision_;
+  }
 }
 
 void MediaPlaylist::AddSegment(const std::string& file_name,
@@ -447,8 +593,84 @@ void MediaPlaylist::AddSegment(const std::string& file_name,
     key_frames_.clear();
     return;
   }
-  return AddSegmentInfoEntry(file_name, start_time, duration, start_byte_offset,
-                             size);
+
+  if (hls_params_.low_latency_hls_mode) {
+    // The remaining chunks make up the last partial segment of the segment.
+    if (pending_part_)
+      AddPendingPartialSegmentEntry();
+    preload_hint_file_name_.clear();
+    num_parts_in_last_segment_ = num_parts_in_current_segment_;
+    num_parts_in_current_segment_ = 0;
+  }
+
+  AddSegmentInfoEntry(file_name, start_time, duration, start_byte_offset, size);
+  ++num_segments_added_;
+
+  if (hls_params_.low_latency_hls_mode)
+    RemoveOldPartialSegmentEntries(start_time + duration);
+}
+
+bool MediaPlaylist::AddPartialSegment(const std::string& file_name,
+                                      int64_t start_time,
+                                      int64_t duration,
+                                      uint64_t start_byte_offset,
+                                      uint64_t size,
+                                      bool independent) {
+  if (!hls_params_.low_latency_hls_mode || time_scale_ == 0 ||
+      stream_type_ == MediaPlaylistStreamType::kVideoIFramesOnly) {
+    return false;
+  }
+
+  const int64_t part_target_duration =
+      static_cast<int64_t>(hls_params_.part_target_duration * time_scale_);
+  bool part_added = false;
+  if (pending_part_ &&
+      (pending_part_->file_name != file_name ||
+       start_time + duration - pending_part_->start_time >
+           part_target_duration)) {
+    AddPendingPartialSegmentEntry();
+    part_added = true;
+  }
+
+  if (!pending_part_) {
+    pending_part_ = PartialSegmentInfo{
+        file_name, start_time, duration, start_byte_offset, size, independent};
+    preload_hint_file_name_ = file_name;
+    preload_hint_byte_offset_ = start_byte_offset;
+  } else {
+    pending_part_->duration = start_time + duration - pending_part_->start_time;
+    pending_part_->size =
+        start_byte_offset + size - pending_part_->start_byte_offset;
+  }
+
+  if (pending_part_->duration >= part_target_duration) {
+    AddPendingPartialSegmentEntry();
+    part_added = true;
+  }
+  return part_added;
+}
+
+bool MediaPlaylist::GetLastPartialSegment(uint64_t* media_sequence_number,
+                                          uint32_t* part_index) const {
+  DCHECK(media_sequence_number);
+  DCHECK(part_index);
+  const uint64_t next_media_sequence_number =
+      hls_params_.media_sequence_number + num_segments_added_;
+  if (num_parts_in_current_segment_ > 0) {
+    *media_sequence_number = next_media_sequence_number;
+    *part_index = num_parts_in_current_segment_ - 1;
+    return true;
+  }
+  if (num_segments_added_ > 0 && num_parts_in_last_segment_ > 0) {
+    *media_sequence_number = next_media_sequence_number - 1;
+    *part_index = num_parts_in_last_segment_ - 1;
+    return true;
+  }
+  return false;
+}
+
+void MediaPlaylist::SetRenditionReports(std::vector<RenditionReport> reports) {
+  rendition_reports_ = std::move(reports);
 }
 
 void MediaPlaylist::AddKeyFrame(int64_t timestamp,
@@ -481,6 +703,7 @@ void MediaPlaylist::AddEncryptionInfo(MediaPlaylist::EncryptionMethod method,
   }
   entries_.emplace_back(new EncryptionInfoEntry(
       method, url, key_id, iv, key_format, key_format_versions));
+  ++master_playlist_revision_;
 }
 
 void MediaPlaylist::AddPlacementOpportunity() {
@@ -488,29 +711,180 @@ void MediaPlaylist::AddPlacementOpportunity() {
 }
 
 bool MediaPlaylist::WriteToFile(const std::filesystem::path& file_path) {
+  const bool low_latency_hls_mode =
+      hls_params_.low_latency_hls_mode && !vod_archive_ &&
+      stream_type_ != MediaPlaylistStreamType::kVideoIFramesOnly;
   if (!target_duration_set_) {
-    SetTargetDuration(ceil(GetLongestSegmentDuration()));
+    double longest_segment_duration = GetLongestSegmentDuration();
+    // In LL-HLS mode, partial segments are published before the first
+    // segment is complete.
+    if (low_latency_hls_mode && longest_segment_duration == 0)
+      longest_segment_duration = hls_params_.target_segment_duration;
+    SetTargetDuration(ceil(longest_segment_duration));
   }
 
-  std::string content = CreatePlaylistHeader(
-      media_info_, target_duration_, hls_params_.playlist_type, stream_type_,
-      media_sequence_number_, discontinuity_sequence_number_,
-      hls_params_.start_time_offset);
+  const bool delta_updates =
+      hls_params_.delta_updates &&
+      playlist_type() != HlsPlaylistType::kVod;
+  const std::optional<double> can_skip_until =
+      delta_updates ? std::optional<double>(kMinSkipTargetDurations *
+                                            target_duration_)
+                    : std::nullopt;
 
-  for (const auto& entry : entries_)
-    absl::StrAppendFormat(&content, "%s\n", entry->ToString().c_str());
+  const std::string content =
+      CreatePlaylistContent(low_latency_hls_mode, can_skip_until, 0);
+  if (!File::WriteFileAtomically(file_path.string().c_str(), content)) {
+    LOG(ERROR) << "Failed to write playlist to: " << file_path.string();
+    return false;
+  }
+  if (hls_params_.write_gzip_playlists &&
+      !WriteGzipFileAtomically(file_path.string() + ".gz", content)) {
+    LOG(ERROR) << "Failed to write compressed playlist to: "
+               << file_path.string() << ".gz";
+    return false;
+  }
 
-  if (hls_params_.playlist_type == HlsPlaylistType::kVod) {
-    content += "#EXT-X-ENDLIST\n";
+  if (delta_updates) {
+    // Written even if no segment can be skipped yet, so that the requests
+    // with _HLS_skip=YES always get a playlist. A full playlist is a valid
+    // response to these requests.
+    const size_t num_skipped_segments =
+        GetNumSkippableSegments(can_skip_until.value());
+    const std::string delta_update_path =
+        GetDeltaUpdatePlaylistPath(file_path.string());
+    const std::string delta_update =
+        num_skipped_segments == 0
+            ? content
+            : CreatePlaylistContent(low_latency_hls_mode, can_skip_until,
+                                    num_skipped_segments);
+    if (!File::WriteFileAtomically(delta_update_path.c_str(), delta_update)) {
+      LOG(ERROR) << "Failed to write playlist to: " << delta_update_path;
+      return false;
+    }
+    if (hls_params_.write_gzip_playlists &&
+        !WriteGzipFileAtomically(delta_update_path + ".gz", delta_update)) {
+      LOG(ERROR) << "Failed to write compressed playlist to: "
+                 << delta_update_path << ".gz";
+      return false;
+    }
   }
 
-  if (!File::WriteFileAtomically(file_path.string().c_str(), content)) {
-    LOG(ERROR) << "Failed to write playlist to: " << file_path.string();
+  if (hls_params_.save_playlist_state &&
+      playlist_type() != HlsPlaylistType::kVod) {
+    const std::string state_path = GetStatePath(file_path.string());
+    if (!File::WriteFileAtomically(state_path.c_str(),
+                                   SaveState().SerializeAsString())) {
+      LOG(ERROR) << "Failed to write playlist state to: " << state_path;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MediaPlaylist::RestoreState(const std::filesystem::path& file_path) {
+  const std::string state_path = GetStatePath(file_path.string());
+  std::string content;
+  if (!File::ReadFileToString(state_path.c_str(), &content))
+    return false;
+  MediaPlaylistState state;
+  if (!state.ParseFromString(content)) {
+    LOG(WARNING) << "Ignoring invalid playlist state " << state_path;
     return false;
   }
+  if (state.time_scale() != time_scale_) {
+    LOG(WARNING) << "Ignoring playlist state " << state_path
+                 << " with timescale " << state.time_scale() << " instead of "
+                 << time_scale_;
+    return false;
+  }
+
+  std::deque<std::unique_ptr<HlsEntry>> entries;
+  for (const MediaPlaylistState::Entry& entry : state.entries()) {
+    if (entry.has_segment()) {
+      const MediaPlaylistState::Segment& segment = entry.segment();
+      entries.emplace_back(new SegmentInfoEntry(
+          segment.file_name(), segment.start_time(),
+          segment.duration_seconds(), segment.use_byte_range(),
+          segment.start_byte_offset(), segment.segment_file_size(),
+          segment.previous_segment_end_offset()));
+    } else if (entry.has_encryption_info()) {
+      const MediaPlaylistState::EncryptionInfo& info = entry.encryption_info();
+      entries.emplace_back(new EncryptionInfoEntry(
+          static_cast<EncryptionMethod>(info.method()), info.url(),
+          info.key_id(), info.iv(), info.key_format(),
+          info.key_format_versions()));
+    } else if (entry.has_discontinuity()) {
+      entries.emplace_back(new DiscontinuityEntry());
+    } else if (entry.has_placement_opportunity()) {
+      entries.emplace_back(new PlacementOpportunityEntry());
+    }
+  }
+
+  entries_ = std::move(entries);
+  media_sequence_number_ = state.media_sequence_number();
+  discontinuity_sequence_number_ = state.discontinuity_sequence_number();
+  inserted_discontinuity_tag_ = state.inserted_discontinuity_tag();
+  longest_segment_duration_seconds_ = state.longest_segment_duration_seconds();
+  current_buffer_depth_ = state.current_buffer_depth();
+  previous_segment_end_offset_ = state.previous_segment_end_offset();
+  num_segments_added_ = state.num_segments_added();
+  if (state.has_target_duration())
+    SetTargetDuration(state.target_duration());
+  segments_to_be_removed_.assign(state.segments_to_be_removed().begin(),
+                                 state.segments_to_be_removed().end());
+  UpdateEntriesMemory();
+  ++master_playlist_revision_;
+  VLOG(1) << "Restored " << entries_.size() << " entries of " << file_name_
+          << " from " << state_path;
   return true;
 }
 
+void MediaPlaylist::ConvertToVodArchive() {
+  if (vod_archive_)
+    return;
+  vod_archive_ = true;
+  const std::filesystem::path file_path = std::filesystem::u8path(file_name_);
+  file_name_ = (file_path.parent_path() /
+                (file_path.stem().u8string() + "_vod" +
+                 file_path.extension().u8string()))
+                   .generic_u8string();
+  // The archive starts with the first segment ever added.
+  media_sequence_number_ = 0;
+  discontinuity_sequence_number_ = 0;
+  // The segments are complete, so their partial segments are not listed.
+  entries_.erase(
+      std::remove_if(entries_.begin(), entries_.end(),
+                     [](const std::unique_ptr<HlsEntry>& entry) {
+                       return entry->type() == HlsEntry::EntryType::kExtPart;
+                     }),
+      entries_.end());
+  UpdateEntriesMemory();
+  ++master_playlist_revision_;
+}
+
+MediaPlaylistState MediaPlaylist::SaveState() const {
+  MediaPlaylistState state;
+  state.set_time_scale(time_scale_);
+  state.set_media_sequence_number(media_sequence_number_);
+  state.set_discontinuity_sequence_number(discontinuity_sequence_number_);
+  state.set_inserted_discontinuity_tag(inserted_discontinuity_tag_);
+  state.set_longest_segment_duration_seconds(
+      longest_segment_duration_seconds_);
+  state.set_current_buffer_depth(current_buffer_depth_);
+  state.set_previous_segment_end_offset(previous_segment_end_offset_);
+  state.set_num_segments_added(num_segments_added_);
+  if (target_duration_set_)
+    state.set_target_duration(target_duration_);
+  for (const std::unique_ptr<HlsEntry>& entry : entries_) {
+    MediaPlaylistState::Entry entry_state;
+    if (entry->SaveState(&entry_state))
+      *state.add_entries() = std::move(entry_state);
+  }
+  for (const std::string& segment : segments_to_be_removed_)
+    state.add_segments_to_be_removed(segment);
+  return state;
+}
+
 uint64_t MediaPlaylist::MaxBitrate() const {
   if (media_info_.has_bandwidth())
     return media_info_.bandwidth();
@@ -636,7 +1010,11 @@ void MediaPlaylist::AddSegmentInfoEntry(const std::string& segment_file_name,
       static_cast<double>(duration) / time_scale_;
   longest_segment_duration_seconds_ =
       std::max(longest_segment_duration_seconds_, segment_duration_seconds);
+  const uint64_t max_bitrate = MaxBitrate();
+  const uint64_t avg_bitrate = AvgBitrate();
   bandwidth_estimator_.AddBlock(size, segment_duration_seconds);
+  if (MaxBitrate() != max_bitrate || AvgBitrate() != avg_bitrate)
+    ++master_playlist_revision_;
   current_buffer_depth_ += segment_duration_seconds;
 
   if (!entries_.empty() &&
@@ -656,6 +1034,7 @@ void MediaPlaylist::AddSegmentInfoEntry(const std::string& segment_file_name,
       segment_file_name, start_time, segment_duration_seconds, use_byte_range_,
       start_byte_offset, size, previous_segment_end_offset_));
   previous_segment_end_offset_ = start_byte_offset + size - 1;
+  UpdateEntriesMemory();
 }
 
 void MediaPlaylist::AdjustLastSegmentInfoEntryDuration(int64_t next_timestamp) {
@@ -683,6 +1062,146 @@ void MediaPlaylist::AdjustLastSegmentInfoEntryDuration(int64_t next_timestamp) {
   }
 }
 
+std::string MediaPlaylist::CreatePlaylistContent(
+    bool low_latency_hls_mode,
+    std::optional<double> can_skip_until,
+    size_t num_skipped_segments) {
+  std::string content = CreatePlaylistHeader(
+      media_info_, target_duration_, playlist_type(), stream_type_,
+      media_sequence_number_, discontinuity_sequence_number_,
+      hls_params_.start_time_offset,
+      low_latency_hls_mode
+          ? std::optional<double>(hls_params_.part_target_duration)
+          : std::nullopt,
+      can_skip_until, num_skipped_segments > 0);
+
+  auto first_entry = entries_.begin();
+  if (num_skipped_segments > 0) {
+    // The last EXT-X-KEYs in the skipped range still apply to the segments
+    // after it, unless new ones follow right away.
+    std::vector<HlsEntry*> ext_x_keys;
+    HlsEntry::EntryType prev_entry_type = HlsEntry::EntryType::kExtInf;
+    size_t skipped_segments = 0;
+    for (; skipped_segments < num_skipped_segments; ++first_entry) {
+      DCHECK(first_entry != entries_.end());
+      const HlsEntry::EntryType entry_type = first_entry->get()->type();
+      if (entry_type == HlsEntry::EntryType::kExtKey) {
+        if (prev_entry_type != HlsEntry::EntryType::kExtKey)
+          ext_x_keys.clear();
+        ext_x_keys.push_back(first_entry->get());
+      } else if (entry_type == HlsEntry::EntryType::kExtInf) {
+        ++skipped_segments;
+      }
+      prev_entry_type = entry_type;
+    }
+    absl::StrAppendFormat(&content, "#EXT-X-SKIP:SKIPPED-SEGMENTS=%zu\n",
+                          num_skipped_segments);
+    if (first_entry != entries_.end() &&
+        first_entry->get()->type() != HlsEntry::EntryType::kExtKey) {
+      for (HlsEntry* ext_x_key : ext_x_keys) {
+        content += ext_x_key->ToCachedString();
+        content += '\n';
+      }
+    }
+  }
+
+  // The entries are only rendered once, so this is mostly copying.
+  size_t content_size = content.size() + archived_entries_.size();
+  for (auto entry = first_entry; entry != entries_.end(); ++entry)
+    content_size += entry->get()->ToCachedString().size() + 1;
+  content.reserve(content_size + sizeof("#EXT-X-ENDLIST\n"));
+  if (vod_archive_)
+    content += archived_entries_;
+  for (auto entry = first_entry; entry != entries_.end(); ++entry) {
+    content += entry->get()->ToCachedString();
+    content += '\n';
+  }
+
+  if (low_latency_hls_mode) {
+    if (!preload_hint_file_name_.empty()) {
+      Tag tag("#EXT-X-PRELOAD-HINT", &content);
+      tag.AddString("TYPE", "PART");
+      tag.AddQuotedString("URI", preload_hint_file_name_);
+      tag.AddNumber("BYTERANGE-START", preload_hint_byte_offset_);
+      content += '\n';
+    }
+    for (const RenditionReport& report : rendition_reports_) {
+      Tag tag("#EXT-X-RENDITION-REPORT", &content);
+      tag.AddQuotedString("URI", report.uri);
+      tag.AddNumber("LAST-MSN", report.last_media_sequence_number);
+      tag.AddNumber("LAST-PART", report.last_part_index);
+      content += '\n';
+    }
+  }
+
+  if (playlist_type() == HlsPlaylistType::kVod) {
+    content += "#EXT-X-ENDLIST\n";
+  }
+  return content;
+}
+
+size_t MediaPlaylist::GetNumSkippableSegments(double can_skip_until) const {
+  double remaining_duration_seconds = 0;
+  for (const auto& entry : entries_) {
+    if (entry->type() == HlsEntry::EntryType::kExtInf) {
+      remaining_duration_seconds +=
+          static_cast<const SegmentInfoEntry*>(entry.get())
+              ->duration_seconds();
+    }
+  }
+
+  // A segment can be skipped if it ends at least |can_skip_until| seconds
+  // before the end of the playlist.
+  size_t num_skippable_segments = 0;
+  for (const auto& entry : entries_) {
+    if (entry->type() != HlsEntry::EntryType::kExtInf)
+      continue;
+    remaining_duration_seconds -=
+        static_cast<const SegmentInfoEntry*>(entry.get())->duration_seconds();
+    if (remaining_duration_seconds < can_skip_until)
+      break;
+    ++num_skippable_segments;
+  }
+  return num_skippable_segments;
+}
+
+void MediaPlaylist::AddPendingPartialSegmentEntry() {
+  DCHECK(pending_part_);
+  const PartialSegmentInfo& part = pending_part_.value();
+  entries_.emplace_back(new PartialSegmentEntry(
+      part.file_name, part.start_time, part.duration,
+      static_cast<double>(part.duration) / time_scale_, part.start_byte_offset,
+      part.size, part.independent));
+  preload_hint_byte_offset_ = part.start_byte_offset + part.size;
+  ++num_parts_in_current_segment_;
+  pending_part_.reset();
+  UpdateEntriesMemory();
+}
+
+void MediaPlaylist::RemoveOldPartialSegmentEntries(int64_t end_time) {
+  const int32_t target_duration =
+      std::max(target_duration_,
+               static_cast<int32_t>(ceil(GetLongestSegmentDuration())));
+  const int64_t oldest_end_time =
+      end_time - int64_t{3} * target_duration * time_scale_;
+  entries_.erase(
+      std::remove_if(
+          entries_.begin(), entries_.end(),
+          [oldest_end_time](const std::unique_ptr<HlsEntry>& entry) {
+            return entry->type() == HlsEntry::EntryType::kExtPart &&
+                   static_cast<const PartialSegmentEntry*>(entry.get())
+                           ->end_time() <= oldest_end_time;
+          }),
+      entries_.end());
+  UpdateEntriesMemory();
+}
+
+void MediaPlaylist::UpdateEntriesMemory() {
+  // Estimated with the size of a segment entry, which most entries are.
+  entries_memory_.Set(entries_.size() * sizeof(SegmentInfoEntry) +
+                      archived_entries_.size());
+}
+
 // TODO(kqyang): Right now this class manages the segments including the
 // deletion of segments when it is no longer needed. However, this class does
 // not have access to the segment file paths, which is already translated to
@@ -708,20 +1227,42 @@ void MediaPlaylist::SlideWindow() {
   //    #EXT-X-KEY   <2>
   //    #EXTINF      <3>
   //    #EXTINF      <4>
-  std::list<std::unique_ptr<HlsEntry>> ext_x_keys;
+  std::deque<std::unique_ptr<HlsEntry>> ext_x_keys;
   // Consecutive key entries are either fully removed or not removed at all.
   // Keep track of entry types so we know if it is consecutive key entries.
   HlsEntry::EntryType prev_entry_type = HlsEntry::EntryType::kExtInf;
 
-  std::list<std::unique_ptr<HlsEntry>>::iterator last = entries_.begin();
+  // The removed entries are rendered in order for the VOD archive, with the
+  // key entries which are added back, as they apply to the segments after
+  // them.
+  const bool archive_entries =
+      !hls_params_.vod_archive_master_playlist_output.empty();
+  auto archive_entry = [this, archive_entries](HlsEntry* entry) {
+    if (!archive_entries)
+      return;
+    archived_entries_ += entry->ToCachedString();
+    archived_entries_ += '\n';
+  };
+
+  size_t num_keys = 0;
+  std::deque<std::unique_ptr<HlsEntry>>::iterator last = entries_.begin();
   for (; last != entries_.end(); ++last) {
     HlsEntry::EntryType entry_type = last->get()->type();
+    if (entry_type != HlsEntry::EntryType::kExtInf &&
+        entry_type != HlsEntry::EntryType::kExtPart) {
+      archive_entry(last->get());
+    }
     if (entry_type == HlsEntry::EntryType::kExtKey) {
+      ++num_keys;
       if (prev_entry_type != HlsEntry::EntryType::kExtKey)
         ext_x_keys.clear();
       ext_x_keys.push_back(std::move(*last));
     } else if (entry_type == HlsEntry::EntryType::kExtDiscontinuity) {
       ++discontinuity_sequence_number_;
+    } else if (entry_type == HlsEntry::EntryType::kExtPart ||
+               entry_type == HlsEntry::EntryType::kExtPlacementOpportunity) {
+      // Partial segments and placement opportunities are removed together
+      // with the segment after them.
     } else {
       DCHECK_EQ(static_cast<int>(entry_type),
                 static_cast<int>(HlsEntry::EntryType::kExtInf));
@@ -735,13 +1276,23 @@ void MediaPlaylist::SlideWindow() {
           hls_params_.time_shift_buffer_depth;
       if (segment_within_time_shift_buffer)
         break;
+      archive_entry(last->get());
       current_buffer_depth_ -= segment_info.duration_seconds();
-      RemoveOldSegment(segment_info.start_time());
+      // A bundle is named after its first segment, and queued for removal
+      // with it. It is only deleted once a later bundle is queued, by when
+      // all its segments are out of the window.
+      if (!media_info_.segments_bundled() ||
+          segment_info.start_byte_offset() == 0) {
+        RemoveOldSegment(segment_info.start_time());
+      }
       media_sequence_number_++;
     }
     prev_entry_type = entry_type;
   }
   entries_.erase(entries_.begin(), last);
+  // The session keys in the master playlist may change.
+  if (ext_x_keys.size() != num_keys)
+    ++master_playlist_revision_;
   // Add key entries back.
   entries_.insert(entries_.begin(), std::make_move_iterator(ext_x_keys.begin()),
                   std::make_move_iterator(ext_x_keys.end()));
@@ -758,12 +1309,8 @@ void MediaPlaylist::RemoveOldSegment(int64_t start_time) {
       media_info_.bandwidth()));
   while (segments_to_be_removed_.size() >
          hls_params_.preserved_segments_outside_live_window) {
-    VLOG(2) << "Deleting " << segments_to_be_removed_.front();
-    if (!File::Delete(segments_to_be_removed_.front().c_str())) {
-      LOG(WARNING) << "Failed to delete " << segments_to_be_removed_.front()
-                   << "; Will retry later.";
-      break;
-    }
+    // Deleted in the background, not to delay the manifest update.
+    FileReaper::GetInstance()->Delete(segments_to_be_removed_.front());
     segments_to_be_removed_.pop_front();
   }
 }
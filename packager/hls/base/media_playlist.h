@@ -7,16 +7,20 @@
 #ifndef PACKAGER_HLS_BASE_MEDIA_PLAYLIST_H_
 #define PACKAGER_HLS_BASE_MEDIA_PLAYLIST_H_
 
+#include <deque>
 #include <filesystem>
 #include <list>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include <packager/hls_params.h>
 #include <packager/macros/classes.h>
 #include <packager/mpd/base/bandwidth_estimator.h>
+#include <packager/hls/base/media_playlist_state.pb.h>
 #include <packager/mpd/base/media_info.pb.h>
+#include <packager/utils/memory_accounting.h>
 #include "packager/media/base/fourccs.h"
 
 namespace shaka {
@@ -32,17 +36,31 @@ class HlsEntry {
     kExtKey,
     kExtDiscontinuity,
     kExtPlacementOpportunity,
+    kExtPart,
   };
   virtual ~HlsEntry();
 
   EntryType type() const { return type_; }
   virtual std::string ToString() = 0;
 
+  /// @return the same text as ToString(). The text is rendered once and
+  ///         reused until the entry changes.
+  const std::string& ToCachedString();
+
+  /// Save the entry, to restore the playlist later.
+  /// @return false if the entry is not saved, e.g. a partial segment.
+  virtual bool SaveState(MediaPlaylistState::Entry* entry) const = 0;
+
  protected:
   explicit HlsEntry(EntryType type);
 
+  /// Subclasses must call this whenever a change affects ToString().
+  void InvalidateCachedString() { cached_string_.clear(); }
+
  private:
   EntryType type_;
+  // Empty if not rendered yet. No entry renders to an empty string.
+  std::string cached_string_;
 };
 
 /// Methods are virtual for mocking.
@@ -61,6 +79,14 @@ class MediaPlaylist {
     kSampleAes,      // Encrypted using SAMPLE-AES method.
     kSampleAesCenc,  // 'cenc' encrypted content.
   };
+  /// The last partial segment of another Media Playlist, for
+  /// EXT-X-RENDITION-REPORT.
+  struct RenditionReport {
+    /// URI of the other Media Playlist, relative to this playlist.
+    std::string uri;
+    uint64_t last_media_sequence_number = 0;
+    uint32_t last_part_index = 0;
+  };
 
   /// @param hls_params contains HLS parameters.
   /// @param file_name is the file name of this media playlist, relative to
@@ -83,7 +109,7 @@ class MediaPlaylist {
   const std::string& codec() const { return codec_; }
   const std::string& supplemental_codec() const { return supplemental_codec_; }
   const media::FourCC& compatible_brand() const { return compatible_brand_; }
-  const std::list<std::unique_ptr<HlsEntry>>& entries() const {
+  const std::deque<std::unique_ptr<HlsEntry>>& entries() const {
     return entries_;
   }
 
@@ -115,8 +141,8 @@ class MediaPlaylist {
   /// @param media_info is the info of the segments that are going to be added
   ///        to this playlist.
   /// @return true on success, false otherwise.
-  virtual bool SetMediaInfo(const MediaInfo& media_info);
-  MediaInfo GetMediaInfo() const { return media_info_; }
+  virtual bool SetMediaInfo(MediaInfo media_info);
+  const MediaInfo& GetMediaInfo() const { return media_info_; }
 
   /// Set the sample duration. Sample duration is used to generate frame rate.
   /// Sample duration is not available right away especially. This allows
@@ -137,6 +163,37 @@ class MediaPlaylist {
                           uint64_t start_byte_offset,
                           uint64_t size);
 
+  /// Add a chunk of the segment being written, for LL-HLS. Chunks must be
+  /// added in order and before the containing segment is added with
+  /// AddSegment(). Consecutive chunks are grouped into partial segments
+  /// (EXT-X-PART) no longer than the part target duration.
+  /// @param file_name is the file name of the segment.
+  /// @param start_time is in terms of the timescale of the media.
+  /// @param duration is in terms of the timescale of the media.
+  /// @param start_byte_offset is the offset of the chunk in the segment.
+  /// @param size is size in bytes.
+  /// @param independent is true if the chunk starts with a key frame.
+  /// @return true if a partial segment has been completed, i.e. the playlist
+  ///         should be written out again.
+  virtual bool AddPartialSegment(const std::string& file_name,
+                                 int64_t start_time,
+                                 int64_t duration,
+                                 uint64_t start_byte_offset,
+                                 uint64_t size,
+                                 bool independent);
+
+  /// @param media_sequence_number is set to the media sequence number of the
+  ///        segment containing the last partial segment.
+  /// @param part_index is set to the index of the last partial segment in
+  ///        that segment.
+  /// @return false if no partial segment has been completed yet.
+  virtual bool GetLastPartialSegment(uint64_t* media_sequence_number,
+                                     uint32_t* part_index) const;
+
+  /// Set the EXT-X-RENDITION-REPORT tags written with the playlist in LL-HLS
+  /// mode.
+  virtual void SetRenditionReports(std::vector<RenditionReport> reports);
+
   /// Keyframes must be added in order. It is also called before the containing
   /// segment being called.
   /// @param timestamp is the timestamp of the key frame in timescale of the
@@ -170,6 +227,11 @@ class MediaPlaylist {
   virtual void AddPlacementOpportunity();
 
   /// Write the playlist to |file_path|.
+  /// If Playlist Delta Updates are enabled, the delta update playlist served
+  /// for _HLS_skip=YES requests is also written next to it, with "_skip"
+  /// appended to the file name, e.g. "video_skip.m3u8" for "video.m3u8".
+  /// With HlsParams::save_playlist_state, the state of live and event
+  /// playlists is also saved next to it, with ".state" appended.
   /// This does not close the file.
   /// If target duration is not set explicitly, this will try to find the target
   /// duration. Note that target duration cannot be changed. So calling this
@@ -181,6 +243,21 @@ class MediaPlaylist {
   /// @return true on success, false otherwise.
   virtual bool WriteToFile(const std::filesystem::path& file_path);
 
+  /// Restore the state saved next to the playlist by WriteToFile() with
+  /// HlsParams::save_playlist_state, e.g. by a packager which has restarted.
+  /// It must be called after SetMediaInfo(), before any segment is added.
+  /// @param file_path is the path of the playlist.
+  /// @return true if the state is restored, false if there is no state or if
+  ///         it cannot be used, in which case the playlist is unchanged.
+  virtual bool RestoreState(const std::filesystem::path& file_path);
+
+  /// Turn the live playlist, once its presentation has ended, into a VOD
+  /// playlist of all its segments, including the ones which have left the
+  /// live window with HlsParams::vod_archive_master_playlist_output set. The
+  /// playlist is renamed with "_vod" appended before its extension, for
+  /// WriteToFile() and the master playlist. No segment may be added after.
+  virtual void ConvertToVodArchive();
+
   /// If bitrate is specified in MediaInfo then it will use that value.
   /// Otherwise, returns the max bitrate.
   /// @return the max bitrate (in bits per second) of this MediaPlaylist.
@@ -242,6 +319,13 @@ class MediaPlaylist {
 
   bool forced_subtitle() const { return forced_subtitle_; }
 
+  /// @return A number which changes whenever the playlist changes in a way
+  ///         that may change the master playlist, e.g. when its bitrates or
+  ///         its encryption keys change.
+  uint64_t master_playlist_revision() const {
+    return master_playlist_revision_;
+  }
+
   bool is_dvs() const {
     // HLS Authoring Specification for Apple Devices
     // https://developer.apple.com/documentation/http_live_streaming/hls_authoring_specification_for_apple_devices#overview
@@ -268,10 +352,32 @@ class MediaPlaylist {
   // happen at a later time depending on the value of
   // |preserved_segment_outside_live_window| in |hls_params_|.
   void RemoveOldSegment(int64_t start_time);
+  // Update the memory accounted for |entries_|.
+  void UpdateEntriesMemory();
+  // @return The type of the playlist, VOD once converted to a VOD archive.
+  HlsPlaylistType playlist_type() const {
+    return vod_archive_ ? HlsPlaylistType::kVod : hls_params_.playlist_type;
+  }
+  // Save the state restored by RestoreState().
+  MediaPlaylistState SaveState() const;
+  // Render the playlist. If |num_skipped_segments| is not zero, the first
+  // |num_skipped_segments| segments are replaced with EXT-X-SKIP, i.e. this
+  // renders a Playlist Delta Update.
+  std::string CreatePlaylistContent(bool low_latency_hls_mode,
+                                    std::optional<double> can_skip_until,
+                                    size_t num_skipped_segments);
+  // Return the number of segments at the start of the playlist which end at
+  // least |can_skip_until| seconds before the end of the playlist.
+  size_t GetNumSkippableSegments(double can_skip_until) const;
+  // Add |pending_part_| as a PartialSegmentEntry (#EXT-X-PART).
+  void AddPendingPartialSegmentEntry();
+  // Remove the partial segments which are more than three target durations
+  // older than the end of the playlist.
+  void RemoveOldPartialSegmentEntries(int64_t end_time);
 
   const HlsParams& hls_params_;
   // Mainly for MasterPlaylist to use these values.
-  const std::string file_name_;
+  std::string file_name_;
   const std::string name_;
   const std::string group_id_;
   MediaInfo media_info_;
@@ -292,18 +398,47 @@ class MediaPlaylist {
   int32_t time_scale_ = 0;
 
   BandwidthEstimator bandwidth_estimator_;
+  uint64_t master_playlist_revision_ = 0;
 
   // Cache the previous calls AddSegment() end offset. This is used to construct
   // SegmentInfoEntry.
   uint64_t previous_segment_end_offset_ = 0;
 
+  // State of the partial segments in LL-HLS mode.
+  struct PartialSegmentInfo {
+    std::string file_name;
+    int64_t start_time;
+    int64_t duration;
+    uint64_t start_byte_offset;
+    uint64_t size;
+    bool independent;
+  };
+  // Chunks not published as a partial segment yet.
+  std::optional<PartialSegmentInfo> pending_part_;
+  // The segment being written and the offset of its next partial segment,
+  // for EXT-X-PRELOAD-HINT. The file name is empty if there is none.
+  std::string preload_hint_file_name_;
+  uint64_t preload_hint_byte_offset_ = 0;
+  // Number of segments added with AddSegment().
+  uint64_t num_segments_added_ = 0;
+  // Number of partial segments in the segment being written and in the last
+  // segment added.
+  uint32_t num_parts_in_current_segment_ = 0;
+  uint32_t num_parts_in_last_segment_ = 0;
+  std::vector<RenditionReport> rendition_reports_;
+
   // See SetTargetDuration() comments.
   bool target_duration_set_ = false;
   int32_t target_duration_ = 0;
 
   // TODO(kqyang): This could be managed better by a separate class, than having
   // all them managed in MediaPlaylist.
-  std::list<std::unique_ptr<HlsEntry>> entries_;
+  std::deque<std::unique_ptr<HlsEntry>> entries_;
+  MemoryCharge entries_memory_{MemorySubsystem::kHlsPlaylistEntries};
+  // The rendered entries which have left the live window, for the VOD
+  // archive.
+  std::string archived_entries_;
+  bool vod_archive_ = false;
   double current_buffer_depth_ = 0;
   // A list to hold the file names of the segments to be removed temporarily.
   // Once a file is actually removed, it is removed from the list.
@@ -316,7 +451,7 @@ class MediaPlaylist {
     uint64_t size;
     std::string segment_file_name;
   };
-  std::list<KeyFrameInfo> key_frames_;
+  std::deque<KeyFrameInfo> key_frames_;
 
   DISALLOW_COPY_AND_ASSIGN(MediaPlaylist);
 };
@@ -332,6 +467,7 @@ class EncryptionInfoEntry : public HlsEntry {
 
   std::string ToString() override;
   std::string ToString(std::string);
+  bool SaveState(MediaPlaylistState::Entry* entry) const override;
 
  private:
   EncryptionInfoEntry(const EncryptionInfoEntry&) = delete;
@@ -12,6 +12,7 @@
 
 #include <packager/file.h>
 #include <packager/file/file_closer.h>
+#include <packager/file/file_reaper.h>
 #include <packager/file/file_test_util.h>
 #include <packager/version/version.h>
 
@@ -588,6 +589,43 @@ TEST_F(MediaPlaylistMultiSegmentTest, InitSegment) {
   ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
 }
 
+// Bundled segments are byte ranges of the bundles.
+TEST_F(MediaPlaylistMultiSegmentTest, BundledSegments) {
+  valid_video_media_info_.set_init_segment_url("init_segment.mp4");
+  valid_video_media_info_.set_segments_bundled(true);
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+
+  media_playlist_->AddSegment("file1.mp4", 0, 10 * kTimeScale, kZeroByteOffset,
+                              kMBytes);
+  media_playlist_->AddSegment("file1.mp4", 10 * kTimeScale, 10 * kTimeScale,
+                              kMBytes, 2 * kMBytes);
+  media_playlist_->AddSegment("file3.mp4", 20 * kTimeScale, 10 * kTimeScale,
+                              kZeroByteOffset, kMBytes);
+
+  const char kExpectedOutput[] =
+      "#EXTM3U\n"
+      "#EXT-X-VERSION:6\n"
+      "## Generated with https://github.com/shaka-project/shaka-packager "
+      "version test\n"
+      "#EXT-X-TARGETDURATION:10\n"
+      "#EXT-X-PLAYLIST-TYPE:VOD\n"
+      "#EXT-X-MAP:URI=\"init_segment.mp4\"\n"
+      "#EXTINF:10.000,\n"
+      "#EXT-X-BYTERANGE:1000000@0\n"
+      "file1.mp4\n"
+      "#EXTINF:10.000,\n"
+      "#EXT-X-BYTERANGE:2000000\n"
+      "file1.mp4\n"
+      "#EXTINF:10.000,\n"
+      "#EXT-X-BYTERANGE:1000000@0\n"
+      "file3.mp4\n"
+      "#EXT-X-ENDLIST\n";
+
+  const char kMemoryFilePath[] = "memory://media.m3u8";
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
+}
+
 // Verify that kSampleAesCenc is handled correctly.
 TEST_F(MediaPlaylistMultiSegmentTest, SampleAesCenc) {
   valid_video_media_info_.set_reference_time_scale(90000);
@@ -801,6 +839,40 @@ TEST_F(LiveMediaPlaylistTest, TimeShifted) {
   ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
 }
 
+TEST_F(LiveMediaPlaylistTest, VodArchive) {
+  mutable_hls_params()->vod_archive_master_playlist_output =
+      "memory://master_vod.m3u8";
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+
+  media_playlist_->AddSegment("file1.ts", 0, 10 * kTimeScale, kZeroByteOffset,
+                              kMBytes);
+  media_playlist_->AddSegment("file2.ts", 10 * kTimeScale, 20 * kTimeScale,
+                              kZeroByteOffset, 2 * kMBytes);
+  media_playlist_->AddSegment("file3.ts", 30 * kTimeScale, 20 * kTimeScale,
+                              kZeroByteOffset, 2 * kMBytes);
+  media_playlist_->ConvertToVodArchive();
+  EXPECT_EQ("default_playlist_vod.m3u8", media_playlist_->file_name());
+
+  const char kExpectedOutput[] =
+      "#EXTM3U\n"
+      "#EXT-X-VERSION:6\n"
+      "## Generated with https://github.com/shaka-project/shaka-packager "
+      "version test\n"
+      "#EXT-X-TARGETDURATION:20\n"
+      "#EXT-X-PLAYLIST-TYPE:VOD\n"
+      "#EXTINF:10.000,\n"
+      "file1.ts\n"
+      "#EXTINF:20.000,\n"
+      "file2.ts\n"
+      "#EXTINF:20.000,\n"
+      "file3.ts\n"
+      "#EXT-X-ENDLIST\n";
+
+  const char kMemoryFilePath[] = "memory://media.m3u8";
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
+}
+
 TEST_F(LiveMediaPlaylistTest, TimeShiftedWithEncryptionInfo) {
   ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
 
@@ -841,6 +913,48 @@ TEST_F(LiveMediaPlaylistTest, TimeShiftedWithEncryptionInfo) {
   ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
 }
 
+TEST_F(LiveMediaPlaylistTest, RestoresState) {
+  mutable_hls_params()->save_playlist_state = true;
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+
+  media_playlist_->AddEncryptionInfo(
+      MediaPlaylist::EncryptionMethod::kSampleAes, "http://example.com", "",
+      "0x12345678", "com.widevine", "1/2/4");
+  media_playlist_->AddSegment("file1.ts", 0, 10 * kTimeScale, kZeroByteOffset,
+                              kMBytes);
+  media_playlist_->AddSegment("file2.ts", 10 * kTimeScale, 20 * kTimeScale,
+                              kZeroByteOffset, 2 * kMBytes);
+  media_playlist_->AddPlacementOpportunity();
+  media_playlist_->AddSegment("file3.ts", 30 * kTimeScale, 20 * kTimeScale,
+                              kZeroByteOffset, 2 * kMBytes);
+
+  const char kMemoryFilePath[] = "memory://state/media.m3u8";
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  std::string expected_output;
+  ASSERT_TRUE(File::ReadFileToString(kMemoryFilePath, &expected_output));
+
+  MediaPlaylist restored_playlist(hls_params_, default_file_name_,
+                                  default_name_, default_group_id_);
+  ASSERT_TRUE(restored_playlist.SetMediaInfo(valid_video_media_info_));
+  EXPECT_FALSE(restored_playlist.RestoreState("memory://state/other.m3u8"));
+  ASSERT_TRUE(restored_playlist.RestoreState(kMemoryFilePath));
+
+  const char kRestoredFilePath[] = "memory://state/restored.m3u8";
+  EXPECT_TRUE(restored_playlist.WriteToFile(kRestoredFilePath));
+  ASSERT_FILE_STREQ(kRestoredFilePath, expected_output);
+
+  // Both playlists continue the same way.
+  media_playlist_->AddSegment("file4.ts", 50 * kTimeScale, 20 * kTimeScale,
+                              kZeroByteOffset, 2 * kMBytes);
+  restored_playlist.AddSegment("file4.ts", 50 * kTimeScale, 20 * kTimeScale,
+                               kZeroByteOffset, 2 * kMBytes);
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  EXPECT_TRUE(restored_playlist.WriteToFile(kRestoredFilePath));
+  std::string continued_output;
+  ASSERT_TRUE(File::ReadFileToString(kMemoryFilePath, &continued_output));
+  ASSERT_FILE_STREQ(kRestoredFilePath, continued_output);
+}
+
 TEST_F(LiveMediaPlaylistTest, TimeShiftedWithEncryptionInfoShifted) {
   ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
 
@@ -938,6 +1052,229 @@ TEST_F(EventMediaPlaylistTest, Basic) {
   ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
 }
 
+class DeltaUpdateMediaPlaylistTest : public EventMediaPlaylistTest {
+ protected:
+  void SetUp() override {
+    EventMediaPlaylistTest::SetUp();
+    mutable_hls_params()->delta_updates = true;
+  }
+};
+
+TEST_F(DeltaUpdateMediaPlaylistTest, SkipOldSegments) {
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+  media_playlist_->SetTargetDuration(10);
+
+  media_playlist_->AddEncryptionInfo(
+      MediaPlaylist::EncryptionMethod::kSampleAes, "http://example.com", "",
+      "0x12345678", "com.widevine", "1/2/4");
+  // CAN-SKIP-UNTIL is 60 seconds, so the first two of the eight segments can
+  // be skipped.
+  for (int i = 0; i < 8; ++i) {
+    media_playlist_->AddSegment(absl::StrFormat("file%d.ts", i + 1),
+                                i * 10 * kTimeScale, 10 * kTimeScale,
+                                kZeroByteOffset, kMBytes);
+  }
+
+  const char kExpectedHeader[] =
+      "#EXTM3U\n"
+      "#EXT-X-VERSION:%d\n"
+      "## Generated with https://github.com/shaka-project/shaka-packager "
+      "version test\n"
+      "#EXT-X-TARGETDURATION:10\n"
+      "#EXT-X-PLAYLIST-TYPE:EVENT\n"
+      "#EXT-X-SERVER-CONTROL:CAN-SKIP-UNTIL=60.000\n";
+  const char kExpectedKey[] =
+      "#EXT-X-KEY:METHOD=SAMPLE-AES,URI=\"http://example.com\","
+      "IV=0x12345678,KEYFORMATVERSIONS=\"1/2/4\","
+      "KEYFORMAT=\"com.widevine\"\n";
+  std::string expected_segments;
+  for (int i = 3; i <= 8; ++i)
+    absl::StrAppendFormat(&expected_segments, "#EXTINF:10.000,\nfile%d.ts\n", i);
+
+  const std::string expected_output =
+      absl::StrFormat(kExpectedHeader, 6) + kExpectedKey +
+      "#EXTINF:10.000,\nfile1.ts\n#EXTINF:10.000,\nfile2.ts\n" +
+      expected_segments;
+  const std::string expected_delta_update_output =
+      absl::StrFormat(kExpectedHeader, 9) +
+      "#EXT-X-SKIP:SKIPPED-SEGMENTS=2\n" + kExpectedKey + expected_segments;
+
+  const char kMemoryFilePath[] = "memory://media.m3u8";
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  ASSERT_FILE_STREQ(kMemoryFilePath, expected_output);
+  ASSERT_FILE_STREQ("memory://media_skip.m3u8", expected_delta_update_output);
+}
+
+TEST_F(EventMediaPlaylistTest, WriteGzipPlaylist) {
+  mutable_hls_params()->write_gzip_playlists = true;
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+  for (int i = 0; i < 100; ++i) {
+    media_playlist_->AddSegment(absl::StrFormat("file%d.ts", i + 1),
+                                i * 10 * kTimeScale, 10 * kTimeScale,
+                                kZeroByteOffset, kMBytes);
+  }
+
+  const char kMemoryFilePath[] = "memory://media.m3u8";
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  std::string playlist;
+  ASSERT_TRUE(File::ReadFileToString(kMemoryFilePath, &playlist));
+  std::string compressed_playlist;
+  ASSERT_TRUE(File::ReadFileToString("memory://media.m3u8.gz",
+                                     &compressed_playlist));
+  // The gzip magic number.
+  ASSERT_GT(compressed_playlist.size(), 2u);
+  EXPECT_EQ('\x1f', compressed_playlist[0]);
+  EXPECT_EQ('\x8b', compressed_playlist[1]);
+  EXPECT_LT(compressed_playlist.size(), playlist.size() / 5);
+}
+
+class LowLatencyMediaPlaylistTest : public MediaPlaylistMultiSegmentTest {
+ protected:
+  LowLatencyMediaPlaylistTest()
+      : MediaPlaylistMultiSegmentTest(HlsPlaylistType::kLive) {}
+
+  void SetUp() override {
+    MediaPlaylistMultiSegmentTest::SetUp();
+    mutable_hls_params()->low_latency_hls_mode = true;
+    mutable_hls_params()->part_target_duration = 1.0;
+    mutable_hls_params()->target_segment_duration = 2.0;
+  }
+
+  // Adds a 2 second segment made of four 0.5 second chunks of 1000 bytes.
+  void AddSegmentWithChunks(const std::string& file_name, int64_t start_time) {
+    const int64_t kChunkDuration = kTimeScale / 2;
+    const uint64_t kChunkSize = 1000;
+    for (int i = 0; i < 4; ++i) {
+      media_playlist_->AddPartialSegment(
+          file_name, start_time + i * kChunkDuration, kChunkDuration,
+          i * kChunkSize, kChunkSize, i == 0);
+    }
+    media_playlist_->AddSegment(file_name, start_time, 4 * kChunkDuration,
+                                kZeroByteOffset, 4 * kChunkSize);
+  }
+};
+
+TEST_F(LowLatencyMediaPlaylistTest, PartialSegments) {
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+
+  uint64_t media_sequence_number = 0;
+  uint32_t part_index = 0;
+  EXPECT_FALSE(media_playlist_->GetLastPartialSegment(&media_sequence_number,
+                                                      &part_index));
+
+  // The chunks are grouped into 1 second partial segments.
+  const int64_t kChunkDuration = kTimeScale / 2;
+  EXPECT_FALSE(media_playlist_->AddPartialSegment("file1.mp4", 0,
+                                                  kChunkDuration, 0, 1000,
+                                                  true));
+  EXPECT_TRUE(media_playlist_->AddPartialSegment(
+      "file1.mp4", kChunkDuration, kChunkDuration, 1000, 1000, false));
+  EXPECT_FALSE(media_playlist_->AddPartialSegment(
+      "file1.mp4", 2 * kChunkDuration, kChunkDuration, 2000, 1000, false));
+  EXPECT_TRUE(media_playlist_->GetLastPartialSegment(&media_sequence_number,
+                                                     &part_index));
+  EXPECT_EQ(0u, media_sequence_number);
+  EXPECT_EQ(0u, part_index);
+
+  const char kExpectedOutput[] =
+      "#EXTM3U\n"
+      "#EXT-X-VERSION:6\n"
+      "## Generated with https://github.com/shaka-project/shaka-packager "
+      "version test\n"
+      "#EXT-X-TARGETDURATION:2\n"
+      "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=3.000\n"
+      "#EXT-X-PART-INF:PART-TARGET=1.000\n"
+      "#EXT-X-PART:DURATION=1.000,URI=\"file1.mp4\",BYTERANGE=\"2000@0\","
+      "INDEPENDENT=YES\n"
+      "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"file1.mp4\",BYTERANGE-START=2000\n";
+
+  const char kMemoryFilePath[] = "memory://media.m3u8";
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
+}
+
+TEST_F(LowLatencyMediaPlaylistTest, CompletedSegmentWithRenditionReports) {
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+
+  AddSegmentWithChunks("file1.mp4", 0);
+  EXPECT_FALSE(media_playlist_->AddPartialSegment(
+      "file2.mp4", 2 * kTimeScale, kTimeScale / 2, 0, 1000, true));
+
+  uint64_t media_sequence_number = 0;
+  uint32_t part_index = 0;
+  EXPECT_TRUE(media_playlist_->GetLastPartialSegment(&media_sequence_number,
+                                                     &part_index));
+  EXPECT_EQ(0u, media_sequence_number);
+  EXPECT_EQ(1u, part_index);
+
+  MediaPlaylist::RenditionReport report;
+  report.uri = "audio.m3u8";
+  report.last_media_sequence_number = 1;
+  report.last_part_index = 0;
+  media_playlist_->SetRenditionReports({report});
+
+  const char kExpectedOutput[] =
+      "#EXTM3U\n"
+      "#EXT-X-VERSION:6\n"
+      "## Generated with https://github.com/shaka-project/shaka-packager "
+      "version test\n"
+      "#EXT-X-TARGETDURATION:2\n"
+      "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=3.000\n"
+      "#EXT-X-PART-INF:PART-TARGET=1.000\n"
+      "#EXT-X-PART:DURATION=1.000,URI=\"file1.mp4\",BYTERANGE=\"2000@0\","
+      "INDEPENDENT=YES\n"
+      "#EXT-X-PART:DURATION=1.000,URI=\"file1.mp4\",BYTERANGE=\"2000@2000\"\n"
+      "#EXTINF:2.000,\n"
+      "file1.mp4\n"
+      "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"file2.mp4\",BYTERANGE-START=0\n"
+      "#EXT-X-RENDITION-REPORT:URI=\"audio.m3u8\",LAST-MSN=1,LAST-PART=0\n";
+
+  const char kMemoryFilePath[] = "memory://media.m3u8";
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
+}
+
+// Partial segments more than three target durations older than the end of the
+// playlist are removed.
+TEST_F(LowLatencyMediaPlaylistTest, OldPartialSegmentsRemoved) {
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+
+  AddSegmentWithChunks("file1.mp4", 0);
+  AddSegmentWithChunks("file2.mp4", 2 * kTimeScale);
+  AddSegmentWithChunks("file3.mp4", 4 * kTimeScale);
+  AddSegmentWithChunks("file4.mp4", 6 * kTimeScale);
+
+  const char kExpectedOutput[] =
+      "#EXTM3U\n"
+      "#EXT-X-VERSION:6\n"
+      "## Generated with https://github.com/shaka-project/shaka-packager "
+      "version test\n"
+      "#EXT-X-TARGETDURATION:2\n"
+      "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=3.000\n"
+      "#EXT-X-PART-INF:PART-TARGET=1.000\n"
+      "#EXTINF:2.000,\n"
+      "file1.mp4\n"
+      "#EXT-X-PART:DURATION=1.000,URI=\"file2.mp4\",BYTERANGE=\"2000@0\","
+      "INDEPENDENT=YES\n"
+      "#EXT-X-PART:DURATION=1.000,URI=\"file2.mp4\",BYTERANGE=\"2000@2000\"\n"
+      "#EXTINF:2.000,\n"
+      "file2.mp4\n"
+      "#EXT-X-PART:DURATION=1.000,URI=\"file3.mp4\",BYTERANGE=\"2000@0\","
+      "INDEPENDENT=YES\n"
+      "#EXT-X-PART:DURATION=1.000,URI=\"file3.mp4\",BYTERANGE=\"2000@2000\"\n"
+      "#EXTINF:2.000,\n"
+      "file3.mp4\n"
+      "#EXT-X-PART:DURATION=1.000,URI=\"file4.mp4\",BYTERANGE=\"2000@0\","
+      "INDEPENDENT=YES\n"
+      "#EXT-X-PART:DURATION=1.000,URI=\"file4.mp4\",BYTERANGE=\"2000@2000\"\n"
+      "#EXTINF:2.000,\n"
+      "file4.mp4\n";
+
+  const char kMemoryFilePath[] = "memory://media.m3u8";
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
+}
+
 class IFrameMediaPlaylistTest : public MediaPlaylistTest {};
 
 TEST_F(IFrameMediaPlaylistTest, MediaPlaylistType) {
@@ -1035,6 +1372,66 @@ TEST_F(IFrameMediaPlaylistTest, MultiSegment) {
   ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
 }
 
+// The duration of the last I-frame of a segment is adjusted when the next
+// segment arrives, after the playlist may already have been written.
+TEST_F(IFrameMediaPlaylistTest, DurationAdjustedAfterWriteToFile) {
+  valid_video_media_info_.set_reference_time_scale(90000);
+  valid_video_media_info_.set_segment_template_url("file$Number$.ts");
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+  media_playlist_->SetTargetDuration(25);
+
+  media_playlist_->AddKeyFrame(0, 1000, 2345);
+  media_playlist_->AddKeyFrame(2 * kTimeScale, 5000, 6345);
+  media_playlist_->AddSegment("file1.ts", 0, 10 * kTimeScale, kZeroByteOffset,
+                              kMBytes);
+
+  const char kExpectedOutputBefore[] =
+      "#EXTM3U\n"
+      "#EXT-X-VERSION:6\n"
+      "## Generated with https://github.com/shaka-project/shaka-packager "
+      "version test\n"
+      "#EXT-X-TARGETDURATION:25\n"
+      "#EXT-X-PLAYLIST-TYPE:VOD\n"
+      "#EXT-X-I-FRAMES-ONLY\n"
+      "#EXTINF:2.000,\n"
+      "#EXT-X-BYTERANGE:2345@1000\n"
+      "file1.ts\n"
+      "#EXTINF:8.000,\n"
+      "#EXT-X-BYTERANGE:6345@5000\n"
+      "file1.ts\n"
+      "#EXT-X-ENDLIST\n";
+
+  const char kMemoryFilePath[] = "memory://media.m3u8";
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutputBefore);
+
+  media_playlist_->AddKeyFrame(11 * kTimeScale, 1000, 2345);
+  media_playlist_->AddSegment("file2.ts", 10 * kTimeScale, 30 * kTimeScale,
+                              kZeroByteOffset, 5 * kMBytes);
+
+  const char kExpectedOutputAfter[] =
+      "#EXTM3U\n"
+      "#EXT-X-VERSION:6\n"
+      "## Generated with https://github.com/shaka-project/shaka-packager "
+      "version test\n"
+      "#EXT-X-TARGETDURATION:25\n"
+      "#EXT-X-PLAYLIST-TYPE:VOD\n"
+      "#EXT-X-I-FRAMES-ONLY\n"
+      "#EXTINF:2.000,\n"
+      "#EXT-X-BYTERANGE:2345@1000\n"
+      "file1.ts\n"
+      "#EXTINF:9.000,\n"
+      "#EXT-X-BYTERANGE:6345@5000\n"
+      "file1.ts\n"
+      "#EXTINF:29.000,\n"
+      "#EXT-X-BYTERANGE:2345@1000\n"
+      "file2.ts\n"
+      "#EXT-X-ENDLIST\n";
+
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutputAfter);
+}
+
 TEST_F(IFrameMediaPlaylistTest, MultiSegmentWithPlacementOpportunity) {
   valid_video_media_info_.set_reference_time_scale(90000);
   valid_video_media_info_.set_segment_template_url("file$Number$.ts");
@@ -1126,6 +1523,7 @@ class MediaPlaylistDeleteSegmentsTest
   }
 
   bool SegmentDeleted(const std::string& segment_name) {
+    FileReaper::GetInstance()->Flush();
     std::unique_ptr<File, FileCloser> file_closer(
         File::Open(segment_name.c_str(), "r"));
     return file_closer.get() == nullptr;
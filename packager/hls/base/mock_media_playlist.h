@@ -23,7 +23,7 @@ class MockMediaPlaylist : public MediaPlaylist {
                     const std::string& group_id);
   ~MockMediaPlaylist() override;
 
-  MOCK_METHOD1(SetMediaInfo, bool(const MediaInfo& media_info));
+  MOCK_METHOD1(SetMediaInfo, bool(MediaInfo media_info));
   MOCK_METHOD5(AddSegment,
                void(const std::string& file_name,
                     int64_t start_time,
@@ -41,6 +41,18 @@ class MockMediaPlaylist : public MediaPlaylist {
                     const std::string& iv,
                     const std::string& key_format,
                     const std::string& key_format_versions));
+  MOCK_METHOD6(AddPartialSegment,
+               bool(const std::string& file_name,
+                    int64_t start_time,
+                    int64_t duration,
+                    uint64_t start_byte_offset,
+                    uint64_t size,
+                    bool independent));
+  MOCK_CONST_METHOD2(GetLastPartialSegment,
+                     bool(uint64_t* media_sequence_number,
+                          uint32_t* part_index));
+  MOCK_METHOD1(SetRenditionReports,
+               void(std::vector<RenditionReport> reports));
   MOCK_METHOD0(AddPlacementOpportunity, void());
   MOCK_METHOD1(WriteToFile, bool(const std::filesystem::path& file_path));
   MOCK_CONST_METHOD0(MaxBitrate, uint64_t());
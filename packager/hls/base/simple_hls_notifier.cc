@@ -21,6 +21,8 @@
 #include <packager/media/base/protection_system_specific_info.h>
 #include <packager/media/base/proto_json_util.h>
 #include <packager/media/base/widevine_pssh_data.pb.h>
+#include <packager/utils/metrics.h>
+#include <packager/utils/trace.h>
 
 ABSL_FLAG(bool,
           enable_legacy_widevine_hls_signaling,
@@ -286,6 +288,7 @@ SimpleHlsNotifier::SimpleHlsNotifier(const HlsParams& hls_params)
       master_playlist_path.filename(), default_audio_langauge,
       default_text_language, hls_params.is_independent_segments,
       hls_params.create_session_keys));
+  master_playlist_->set_write_gzip(hls_params.write_gzip_playlists);
 }
 
 SimpleHlsNotifier::~SimpleHlsNotifier() {}
@@ -310,10 +313,15 @@ bool SimpleHlsNotifier::NotifyNewStream(const MediaInfo& media_info,
   MediaInfo adjusted_media_info = MakeMediaInfoPathsRelativeToPlaylist(
       media_info, hls_params().base_url, master_playlist_dir_,
       media_playlist->file_name());
-  if (!media_playlist->SetMediaInfo(adjusted_media_info)) {
+  if (!media_playlist->SetMediaInfo(std::move(adjusted_media_info))) {
     LOG(ERROR) << "Failed to set media info for playlist " << playlist_name;
     return false;
   }
+  if (hls_params().save_playlist_state &&
+      hls_params().playlist_type != HlsPlaylistType::kVod) {
+    media_playlist->RestoreState(std::filesystem::u8path(master_playlist_dir_) /
+                                 media_playlist->file_name());
+  }
 
   MediaPlaylist::EncryptionMethod encryption_method =
       MediaPlaylist::EncryptionMethod::kNone;
@@ -340,12 +348,13 @@ bool SimpleHlsNotifier::NotifyNewStream(const MediaInfo& media_info,
 
 bool SimpleHlsNotifier::NotifySampleDuration(uint32_t stream_id,
                                              int32_t sample_duration) {
-  absl::MutexLock lock(&lock_);
+  absl::ReaderMutexLock lock(&lock_);
   auto stream_iterator = stream_map_.find(stream_id);
   if (stream_iterator == stream_map_.end()) {
     LOG(ERROR) << "Cannot find stream with ID: " << stream_id;
     return false;
   }
+  absl::MutexLock stream_lock(&stream_iterator->second->lock);
   auto& media_playlist = stream_iterator->second->media_playlist;
   media_playlist->SetSampleDuration(sample_duration);
   return true;
@@ -357,73 +366,120 @@ bool SimpleHlsNotifier::NotifyNewSegment(uint32_t stream_id,
                                          int64_t duration,
                                          uint64_t start_byte_offset,
                                          uint64_t size) {
+  bool target_duration_updated = false;
+  {
+    absl::ReaderMutexLock lock(&lock_);
+    auto stream_iterator = stream_map_.find(stream_id);
+    if (stream_iterator == stream_map_.end()) {
+      LOG(ERROR) << "Cannot find stream with ID: " << stream_id;
+      return false;
+    }
+    absl::MutexLock stream_lock(&stream_iterator->second->lock);
+    auto& media_playlist = stream_iterator->second->media_playlist;
+    const std::string& segment_url =
+        GenerateSegmentUrl(segment_name, hls_params().base_url,
+                           master_playlist_dir_, media_playlist->file_name());
+    media_playlist->AddSegment(segment_url, start_time, duration,
+                               start_byte_offset, size);
+
+    // Update target duration.
+    const int32_t longest_segment_duration =
+        static_cast<int32_t>(ceil(media_playlist->GetLongestSegmentDuration()));
+    int32_t target_duration = target_duration_.load();
+    while (longest_segment_duration > target_duration) {
+      if (target_duration_.compare_exchange_weak(target_duration,
+                                                 longest_segment_duration)) {
+        target_duration_updated = true;
+        break;
+      }
+    }
+
+    // Update the playlists when there is new segments in live mode.
+    if (hls_params().playlist_type != HlsPlaylistType::kLive &&
+        hls_params().playlist_type != HlsPlaylistType::kEvent) {
+      return true;
+    }
+    if (hls_params().low_latency_hls_mode)
+      UpdateRenditionReports(stream_id, media_playlist.get());
+    // All playlists are written below if target duration is updated.
+    if (!target_duration_updated &&
+        !WriteMediaPlaylist(master_playlist_dir_, media_playlist.get())) {
+      return false;
+    }
+    // Most segments do not change the master playlist, e.g. the bitrates, so
+    // the other streams are only blocked when it needs to be rewritten.
+    if (!target_duration_updated &&
+        stream_iterator->second->written_master_playlist_revision ==
+            media_playlist->master_playlist_revision()) {
+      return true;
+    }
+  }
+
+  // The master playlist depends on all the streams.
   absl::MutexLock lock(&lock_);
+  if (target_duration_updated) {
+    // Update all playlists if target duration is updated.
+    for (MediaPlaylist* playlist : media_playlists_) {
+      playlist->SetTargetDuration(target_duration_.load());
+      if (!WriteMediaPlaylist(master_playlist_dir_, playlist))
+        return false;
+    }
+  }
+  return WriteMasterPlaylist();
+}
+
+bool SimpleHlsNotifier::NotifyNewPartialSegment(uint32_t stream_id,
+                                                const std::string& segment_name,
+                                                int64_t start_time,
+                                                int64_t duration,
+                                                uint64_t start_byte_offset,
+                                                uint64_t size,
+                                                bool independent) {
+  absl::ReaderMutexLock lock(&lock_);
   auto stream_iterator = stream_map_.find(stream_id);
   if (stream_iterator == stream_map_.end()) {
     LOG(ERROR) << "Cannot find stream with ID: " << stream_id;
     return false;
   }
+  absl::MutexLock stream_lock(&stream_iterator->second->lock);
   auto& media_playlist = stream_iterator->second->media_playlist;
   const std::string& segment_url =
       GenerateSegmentUrl(segment_name, hls_params().base_url,
                          master_playlist_dir_, media_playlist->file_name());
-  media_playlist->AddSegment(segment_url, start_time, duration,
-                             start_byte_offset, size);
-
-  // Update target duration.
-  int32_t longest_segment_duration =
-      static_cast<int32_t>(ceil(media_playlist->GetLongestSegmentDuration()));
-  bool target_duration_updated = false;
-  if (longest_segment_duration > target_duration_) {
-    target_duration_ = longest_segment_duration;
-    target_duration_updated = true;
-  }
-
-  // Update the playlists when there is new segments in live mode.
-  if (hls_params().playlist_type == HlsPlaylistType::kLive ||
-      hls_params().playlist_type == HlsPlaylistType::kEvent) {
-    // Update all playlists if target duration is updated.
-    if (target_duration_updated) {
-      for (MediaPlaylist* playlist : media_playlists_) {
-        playlist->SetTargetDuration(target_duration_);
-        if (!WriteMediaPlaylist(master_playlist_dir_, playlist))
-          return false;
-      }
-    } else {
-      if (!WriteMediaPlaylist(master_playlist_dir_, media_playlist.get()))
-        return false;
-    }
-    if (!master_playlist_->WriteMasterPlaylist(
-            hls_params().base_url, master_playlist_dir_, media_playlists_)) {
-      LOG(ERROR) << "Failed to write master playlist.";
-      return false;
-    }
+  // Only this playlist changes, and only once a partial segment is complete.
+  if (!media_playlist->AddPartialSegment(segment_url, start_time, duration,
+                                         start_byte_offset, size,
+                                         independent)) {
+    return true;
   }
-  return true;
+  UpdateRenditionReports(stream_id, media_playlist.get());
+  return WriteMediaPlaylist(master_playlist_dir_, media_playlist.get());
 }
 
 bool SimpleHlsNotifier::NotifyKeyFrame(uint32_t stream_id,
                                        int64_t timestamp,
                                        uint64_t start_byte_offset,
                                        uint64_t size) {
-  absl::MutexLock lock(&lock_);
+  absl::ReaderMutexLock lock(&lock_);
   auto stream_iterator = stream_map_.find(stream_id);
   if (stream_iterator == stream_map_.end()) {
     LOG(ERROR) << "Cannot find stream with ID: " << stream_id;
     return false;
   }
+  absl::MutexLock stream_lock(&stream_iterator->second->lock);
   auto& media_playlist = stream_iterator->second->media_playlist;
   media_playlist->AddKeyFrame(timestamp, start_byte_offset, size);
   return true;
 }
 
 bool SimpleHlsNotifier::NotifyCueEvent(uint32_t stream_id, int64_t timestamp) {
-  absl::MutexLock lock(&lock_);
+  absl::ReaderMutexLock lock(&lock_);
   auto stream_iterator = stream_map_.find(stream_id);
   if (stream_iterator == stream_map_.end()) {
     LOG(ERROR) << "Cannot find stream with ID: " << stream_id;
     return false;
   }
+  absl::MutexLock stream_lock(&stream_iterator->second->lock);
   auto& media_playlist = stream_iterator->second->media_playlist;
   media_playlist->AddPlacementOpportunity();
   return true;
@@ -435,12 +491,13 @@ bool SimpleHlsNotifier::NotifyEncryptionUpdate(
     const std::vector<uint8_t>& system_id,
     const std::vector<uint8_t>& iv,
     const std::vector<uint8_t>& protection_system_specific_data) {
-  absl::MutexLock lock(&lock_);
+  absl::ReaderMutexLock lock(&lock_);
   auto stream_iterator = stream_map_.find(stream_id);
   if (stream_iterator == stream_map_.end()) {
     LOG(ERROR) << "Cannot find stream with ID: " << stream_id;
     return false;
   }
+  absl::MutexLock stream_lock(&stream_iterator->second->lock);
 
   std::unique_ptr<MediaPlaylist>& media_playlist =
       stream_iterator->second->media_playlist;
@@ -507,18 +564,88 @@ bool SimpleHlsNotifier::NotifyEncryptionUpdate(
   return true;
 }
 
+void SimpleHlsNotifier::UpdateRenditionReports(uint32_t stream_id,
+                                               MediaPlaylist* media_playlist) {
+  MediaPlaylist::RenditionReport last_part;
+  const bool has_part = media_playlist->GetLastPartialSegment(
+      &last_part.last_media_sequence_number, &last_part.last_part_index);
+  // The URIs of the reports are relative to the playlist carrying them.
+  const std::filesystem::path playlist_dir =
+      std::filesystem::u8path(media_playlist->file_name()).parent_path();
+
+  std::vector<MediaPlaylist::RenditionReport> reports;
+  absl::MutexLock lock(&rendition_reports_lock_);
+  if (has_part) {
+    last_part.uri = media_playlist->file_name();
+    rendition_reports_[stream_id] = last_part;
+  }
+  for (const auto& entry : rendition_reports_) {
+    if (entry.first == stream_id)
+      continue;
+    MediaPlaylist::RenditionReport report = entry.second;
+    report.uri = std::filesystem::u8path(report.uri)
+                     .lexically_relative(playlist_dir)
+                     .generic_string();
+    reports.push_back(std::move(report));
+  }
+  media_playlist->SetRenditionReports(std::move(reports));
+}
+
 bool SimpleHlsNotifier::Flush() {
+  static MetricDurations* const flush_durations =
+      MetricsRegistry::GetInstance()->GetDurations(
+          "shaka_hls_flush_seconds",
+          "Time spent generating and writing HLS playlists.");
+
   absl::MutexLock lock(&lock_);
+  ScopedMetricTimer timer(flush_durations);
+  ScopedTraceEvent trace_event("SimpleHlsNotifier::Flush");
   for (MediaPlaylist* playlist : media_playlists_) {
-    playlist->SetTargetDuration(target_duration_);
+    playlist->SetTargetDuration(target_duration_.load());
     if (!WriteMediaPlaylist(master_playlist_dir_, playlist))
       return false;
   }
+  return WriteMasterPlaylist();
+}
+
+bool SimpleHlsNotifier::WriteMasterPlaylist() {
   if (!master_playlist_->WriteMasterPlaylist(
           hls_params().base_url, master_playlist_dir_, media_playlists_)) {
     LOG(ERROR) << "Failed to write master playlist.";
     return false;
   }
+  for (auto& pair : stream_map_) {
+    pair.second->written_master_playlist_revision =
+        pair.second->media_playlist->master_playlist_revision();
+  }
+  return true;
+}
+
+bool SimpleHlsNotifier::WriteVodArchive() {
+  const std::string& output = hls_params().vod_archive_master_playlist_output;
+  if (output.empty() || hls_params().playlist_type != HlsPlaylistType::kLive)
+    return true;
+
+  absl::MutexLock lock(&lock_);
+  for (MediaPlaylist* playlist : media_playlists_) {
+    playlist->ConvertToVodArchive();
+    if (!WriteMediaPlaylist(master_playlist_dir_, playlist))
+      return false;
+  }
+  const std::filesystem::path output_path = std::filesystem::u8path(output);
+  MasterPlaylist vod_master_playlist(
+      output_path.filename(), hls_params().default_language,
+      hls_params().default_text_language.empty()
+          ? hls_params().default_language
+          : hls_params().default_text_language,
+      hls_params().is_independent_segments, hls_params().create_session_keys);
+  vod_master_playlist.set_write_gzip(hls_params().write_gzip_playlists);
+  if (!vod_master_playlist.WriteMasterPlaylist(
+          hls_params().base_url, output_path.parent_path().string(),
+          media_playlists_)) {
+    LOG(ERROR) << "Failed to write VOD master playlist " << output;
+    return false;
+  }
   return true;
 }
 
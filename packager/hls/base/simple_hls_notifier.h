@@ -7,9 +7,11 @@
 #ifndef PACKAGER_HLS_BASE_SIMPLE_HLS_NOTIFIER_H_
 #define PACKAGER_HLS_BASE_SIMPLE_HLS_NOTIFIER_H_
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -58,6 +60,13 @@ class SimpleHlsNotifier : public HlsNotifier {
                         int64_t duration,
                         uint64_t start_byte_offset,
                         uint64_t size) override;
+  bool NotifyNewPartialSegment(uint32_t stream_id,
+                               const std::string& segment_name,
+                               int64_t start_time,
+                               int64_t duration,
+                               uint64_t start_byte_offset,
+                               uint64_t size,
+                               bool independent) override;
   bool NotifyKeyFrame(uint32_t stream_id,
                       int64_t timestamp,
                       uint64_t start_byte_offset,
@@ -70,6 +79,7 @@ class SimpleHlsNotifier : public HlsNotifier {
       const std::vector<uint8_t>& iv,
       const std::vector<uint8_t>& protection_system_specific_data) override;
   bool Flush() override;
+  bool WriteVodArchive() override;
   /// }@
 
  private:
@@ -78,10 +88,26 @@ class SimpleHlsNotifier : public HlsNotifier {
   struct StreamEntry {
     std::unique_ptr<MediaPlaylist> media_playlist;
     MediaPlaylist::EncryptionMethod encryption_method;
+    // Protects |media_playlist| while |lock_| is only held in shared mode.
+    absl::Mutex lock;
+    // The master playlist revision of |media_playlist| when the master
+    // playlist was last written, if it was. Only set while |lock_| is held
+    // exclusively.
+    std::optional<uint64_t> written_master_playlist_revision;
   };
 
+  // Writes the master playlist, and records the revisions of the media
+  // playlists it was written from. |lock_| must be held exclusively.
+  bool WriteMasterPlaylist();
+
+  // Records the last partial segment of |stream_id| and passes the ones of the
+  // other streams to |media_playlist| as rendition reports.
+  void UpdateRenditionReports(uint32_t stream_id,
+                              MediaPlaylist* media_playlist);
+
   std::string master_playlist_dir_;
-  int32_t target_duration_ = 0;
+  // Updated from the streams while |lock_| is only held in shared mode.
+  std::atomic<int32_t> target_duration_{0};
 
   std::unique_ptr<MediaPlaylistFactory> media_playlist_factory_;
   std::unique_ptr<MasterPlaylist> master_playlist_;
@@ -92,8 +118,17 @@ class SimpleHlsNotifier : public HlsNotifier {
 
   uint32_t sequence_number_ = 0;
 
+  // Held exclusively to add streams and to write playlists which depend on
+  // all the streams. Updates to a single stream only hold it in shared mode,
+  // together with StreamEntry::lock, so updates to different streams do not
+  // contend.
   absl::Mutex lock_;
 
+  // Only used in LL-HLS mode. Acquired while holding StreamEntry::lock.
+  absl::Mutex rendition_reports_lock_;
+  std::map<uint32_t, MediaPlaylist::RenditionReport> rendition_reports_
+      ABSL_GUARDED_BY(rendition_reports_lock_);
+
   DISALLOW_COPY_AND_ASSIGN(SimpleHlsNotifier);
 };
 
@@ -577,6 +577,55 @@ TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewSegment) {
                                         kDuration, 0, kSize));
 }
 
+// In LL-HLS mode the media playlist is written once a partial segment is
+// complete.
+TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewPartialSegment) {
+  std::unique_ptr<MockMediaPlaylistFactory> factory(
+      new MockMediaPlaylistFactory());
+
+  // Pointer released by SimpleHlsNotifier.
+  MockMediaPlaylist* mock_media_playlist =
+      new MockMediaPlaylist("playlist.m3u8", "", "");
+
+  EXPECT_CALL(*mock_media_playlist, SetMediaInfo(_)).WillOnce(Return(true));
+  EXPECT_CALL(*factory, CreateMock(_, _, _, _))
+      .WillOnce(Return(mock_media_playlist));
+
+  const int64_t kStartTime = 1328;
+  const int64_t kDuration = 3000;
+  const uint64_t kSize = 6595;
+  const std::string segment_name = "segmentname";
+  EXPECT_CALL(*mock_media_playlist,
+              AddPartialSegment(StrEq(kTestPrefix + segment_name), kStartTime,
+                                kDuration, 0, kSize, true))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*mock_media_playlist,
+              AddPartialSegment(StrEq(kTestPrefix + segment_name),
+                                kStartTime + kDuration, kDuration, kSize,
+                                kSize, false))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*mock_media_playlist,
+              WriteToFile(Eq(
+                  (std::filesystem::u8path(kAnyOutputDir) / "playlist.m3u8"))))
+      .WillOnce(Return(true));
+
+  hls_params_.playlist_type = GetParam();
+  hls_params_.low_latency_hls_mode = true;
+  SimpleHlsNotifier notifier(hls_params_);
+  InjectMediaPlaylistFactory(std::move(factory), &notifier);
+  EXPECT_TRUE(notifier.Init());
+  MediaInfo media_info;
+  uint32_t stream_id;
+  EXPECT_TRUE(notifier.NotifyNewStream(media_info, "playlist.m3u8", "name",
+                                       "groupid", &stream_id));
+
+  EXPECT_TRUE(notifier.NotifyNewPartialSegment(
+      stream_id, segment_name, kStartTime, kDuration, 0, kSize, true));
+  EXPECT_TRUE(notifier.NotifyNewPartialSegment(stream_id, segment_name,
+                                               kStartTime + kDuration,
+                                               kDuration, kSize, kSize, false));
+}
+
 TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewSegmentsWithMultipleStreams) {
   const int64_t kStartTime = 1328;
   const int64_t kDuration = 398407;
@@ -647,13 +696,14 @@ TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewSegmentsWithMultipleStreams) {
   EXPECT_CALL(*mock_media_playlist2, AddSegment(_, _, _, _, _)).Times(1);
   EXPECT_CALL(*mock_media_playlist2, GetLongestSegmentDuration())
       .WillOnce(Return(kLongestSegmentDuration));
-  // Not updating other playlists as target duration does not change.
+  // Not updating other playlists as target duration does not change, nor the
+  // master playlist as the playlist does not change it.
   EXPECT_CALL(*mock_media_playlist2,
               WriteToFile(Eq(
                   (std::filesystem::u8path(kAnyOutputDir) / "playlist2.m3u8"))))
       .WillOnce(Return(true));
   EXPECT_CALL(*mock_master_playlist_ptr, WriteMasterPlaylist(_, _, _))
-      .WillOnce(Return(true));
+      .Times(0);
   EXPECT_TRUE(notifier.NotifyNewSegment(stream_id2, "segment_name", kStartTime,
                                         kDuration, 0, kSize));
 }
@@ -0,0 +1,163 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/hls/util/hls_writer.h>
+
+#include <cstring>
+
+#include <absl/log/log.h>
+#include <absl/strings/escaping.h>
+#include <absl/strings/match.h>
+#include <absl/strings/str_format.h>
+#include <absl/strings/str_replace.h>
+#include <google/protobuf/text_format.h>
+
+#include <packager/file.h>
+#include <packager/hls/base/simple_hls_notifier.h>
+
+namespace shaka {
+namespace hls {
+
+namespace {
+
+// The extension of MediaInfo files in the binary protobuf format.
+const char kBinaryMediaInfoExtension[] = ".pb";
+// The suffixes of the MediaInfo files dumped next to the outputs.
+const char* const kMediaInfoSuffixes[] = {".media_info.pb", ".media_info"};
+
+bool ReadMediaInfo(const std::string& media_info_path, MediaInfo* media_info) {
+  std::string file_content;
+  if (!File::ReadFileToString(media_info_path.c_str(), &file_content)) {
+    LOG(ERROR) << "Failed to read " << media_info_path << " to string.";
+    return false;
+  }
+  if (absl::EndsWith(media_info_path, kBinaryMediaInfoExtension)) {
+    if (!media_info->ParseFromString(file_content)) {
+      LOG(ERROR) << "Failed to parse " << media_info_path << " to MediaInfo.";
+      return false;
+    }
+  } else if (!::google::protobuf::TextFormat::ParseFromString(file_content,
+                                                              media_info)) {
+    LOG(ERROR) << "Failed to parse " << media_info_path << " to MediaInfo.";
+    return false;
+  }
+  return true;
+}
+
+// Returns the name of the output described by a MediaInfo file.
+std::string GetOutputFileName(const std::string& media_info_path,
+                              const MediaInfo& media_info) {
+  for (const char* suffix : kMediaInfoSuffixes) {
+    if (absl::EndsWith(media_info_path, suffix)) {
+      return media_info_path.substr(0,
+                                    media_info_path.size() - strlen(suffix));
+    }
+  }
+  return media_info.media_file_name();
+}
+
+// Converts a UUID written by CreateUUIDString() back to a system ID.
+std::vector<uint8_t> UuidToSystemId(const std::string& uuid) {
+  const std::string bytes =
+      absl::HexStringToBytes(absl::StrReplaceAll(uuid, {{"-", ""}}));
+  return std::vector<uint8_t>(bytes.begin(), bytes.end());
+}
+
+bool NotifyEncryption(const MediaInfo& media_info,
+                      uint32_t stream_id,
+                      HlsNotifier* notifier) {
+  if (!media_info.has_protected_content())
+    return true;
+  const MediaInfo::ProtectedContent& protected_content =
+      media_info.protected_content();
+  const std::vector<uint8_t> key_id(protected_content.default_key_id().begin(),
+                                    protected_content.default_key_id().end());
+  // The IV is not in the MediaInfo. It is carried in the media with the
+  // protection schemes of the MP4 outputs anyway.
+  const std::vector<uint8_t> iv;
+  for (const auto& entry : protected_content.content_protection_entry()) {
+    const std::vector<uint8_t> pssh(entry.pssh().begin(), entry.pssh().end());
+    if (!notifier->NotifyEncryptionUpdate(
+            stream_id, key_id, UuidToSystemId(entry.uuid()), iv, pssh)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+HlsWriter::HlsWriter() {}
+HlsWriter::~HlsWriter() {}
+
+bool HlsWriter::AddFile(const std::string& media_info_path,
+                        const std::string& playlist_name) {
+  Stream stream;
+  if (!ReadMediaInfo(media_info_path, &stream.media_info))
+    return false;
+  if (stream.media_info.has_segment_template()) {
+    LOG(ERROR) << media_info_path
+               << " describes segments with a template, only single-file "
+                  "outputs are supported.";
+    return false;
+  }
+
+  const std::string output_file_name =
+      GetOutputFileName(media_info_path, stream.media_info);
+  Status status = media::ReadSegmentIndex(output_file_name, &stream.index);
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to read the segment index of " << output_file_name
+               << ": " << status;
+    return false;
+  }
+  // The times of the index are in its own timescale.
+  stream.media_info.set_reference_time_scale(stream.index.time_scale);
+  stream.playlist_name = playlist_name;
+  streams_.push_back(std::move(stream));
+  return true;
+}
+
+bool HlsWriter::WritePlaylists(const HlsParams& hls_params) {
+  HlsParams params = hls_params;
+  params.playlist_type = HlsPlaylistType::kVod;
+  SimpleHlsNotifier notifier(params);
+  if (!notifier.Init()) {
+    LOG(ERROR) << "Failed to initialize HlsNotifier.";
+    return false;
+  }
+
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    const Stream& stream = streams_[i];
+    uint32_t stream_id = 0;
+    if (!notifier.NotifyNewStream(stream.media_info, stream.playlist_name,
+                                  absl::StrFormat("stream_%d", i), "",
+                                  &stream_id) ||
+        !NotifyEncryption(stream.media_info, stream_id, &notifier)) {
+      LOG(ERROR) << "Failed to add the stream of "
+                 << stream.media_info.media_file_name();
+      return false;
+    }
+    for (const media::SegmentIndex::Segment& segment : stream.index.segments) {
+      if (!notifier.NotifyNewSegment(
+              stream_id, stream.media_info.media_file_name(),
+              segment.start_time, segment.duration, segment.range.start,
+              segment.range.end + 1 - segment.range.start)) {
+        LOG(ERROR) << "Failed to add the segments of "
+                   << stream.media_info.media_file_name();
+        return false;
+      }
+    }
+  }
+
+  if (!notifier.Flush()) {
+    LOG(ERROR) << "Failed to flush HlsNotifier.";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace hls
+}  // namespace shaka
@@ -0,0 +1,70 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// Class for reading in MediaInfo and segment index files and writing out HLS
+// playlists.
+
+#ifndef PACKAGER_HLS_UTIL_HLS_WRITER_H_
+#define PACKAGER_HLS_UTIL_HLS_WRITER_H_
+
+#include <string>
+#include <vector>
+
+#include <packager/hls_params.h>
+#include <packager/media/event/segment_index_muxer_listener.h>
+#include <packager/mpd/base/media_info.pb.h>
+
+namespace shaka {
+namespace hls {
+
+/// Writes the VOD playlists of single-file outputs from the MediaInfo files
+/// dumped with --output_media_info and the segment indexes written with
+/// --output_segment_index, without the media files. This is the HLS
+/// counterpart of MpdWriter.
+///
+/// The segment index of a MediaInfo file is read next to the output it
+/// describes, i.e. next to the MediaInfo file with its suffix removed, or
+/// next to the media file name in the MediaInfo if the MediaInfo file does
+/// not have the usual suffix.
+class HlsWriter {
+ public:
+  HlsWriter();
+  ~HlsWriter();
+
+  /// Add the stream of a MediaInfo file.
+  /// @param media_info_path is a MediaInfo file in the text format, or in the
+  ///        binary format if it ends with ".pb".
+  /// @param playlist_name is the name of the media playlist of the stream,
+  ///        relative to the master playlist.
+  /// @return true on success, false if the MediaInfo or the segment index of
+  ///         the stream cannot be read.
+  bool AddFile(const std::string& media_info_path,
+               const std::string& playlist_name);
+
+  /// Write the master playlist HlsParams::master_playlist_output, and the
+  /// media playlists of the streams added.
+  /// @param hls_params are the HLS parameters. The playlists are VOD
+  ///        playlists whatever the playlist type.
+  /// @return true on success, false otherwise.
+  bool WritePlaylists(const HlsParams& hls_params);
+
+ private:
+  HlsWriter(const HlsWriter&) = delete;
+  HlsWriter& operator=(const HlsWriter&) = delete;
+
+  struct Stream {
+    MediaInfo media_info;
+    media::SegmentIndex index;
+    std::string playlist_name;
+  };
+
+  std::vector<Stream> streams_;
+};
+
+}  // namespace hls
+}  // namespace shaka
+
+#endif  // PACKAGER_HLS_UTIL_HLS_WRITER_H_
@@ -0,0 +1,140 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/hls/util/hls_writer.h>
+
+#include <filesystem>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <packager/file.h>
+#include <packager/file/file_util.h>
+#include <packager/media/base/buffer_writer.h>
+
+using ::testing::HasSubstr;
+
+namespace shaka {
+namespace hls {
+
+namespace {
+
+const char kMediaInfo[] =
+    "video_info {\n"
+    "  codec: 'avc1.64001e'\n"
+    "  width: 640\n"
+    "  height: 360\n"
+    "  time_scale: 30000\n"
+    "  frame_duration: 1001\n"
+    "  pixel_width: 1\n"
+    "  pixel_height: 1\n"
+    "}\n"
+    "bandwidth: 1000000\n"
+    "init_range { begin: 0 end: 799 }\n"
+    "index_range { begin: 800 end: 899 }\n"
+    "media_duration_seconds: 4\n"
+    "container_type: CONTAINER_MP4\n";
+
+const int32_t kTimeScale = 90000;
+
+// Appends a byte range of the segment index format, see
+// SegmentIndexMuxerListener.
+void AppendRange(uint64_t offset, uint64_t size, media::BufferWriter* buffer) {
+  buffer->AppendInt(offset);
+  buffer->AppendInt(size);
+}
+
+// Appends a segment without key frames.
+void AppendSegment(int64_t start_time,
+                   int64_t duration,
+                   uint64_t offset,
+                   uint64_t size,
+                   media::BufferWriter* buffer) {
+  buffer->AppendInt(start_time);
+  buffer->AppendInt(duration);
+  AppendRange(offset, size, buffer);
+  buffer->AppendInt(static_cast<uint32_t>(0));
+}
+
+}  // namespace
+
+class HlsWriterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(TempFilePath("", &temp_dir_));
+    output_dir_ = std::filesystem::u8path(temp_dir_);
+    ASSERT_TRUE(std::filesystem::create_directories(output_dir_));
+
+    media::BufferWriter index;
+    // The index of video.mp4, see SegmentIndexMuxerListener.
+    index.AppendString("SPIX");
+    index.AppendInt(static_cast<uint32_t>(1) << 24);
+    index.AppendInt(kTimeScale);
+    AppendRange(0, 800, &index);
+    AppendRange(800, 100, &index);
+    index.AppendInt(static_cast<uint32_t>(2));
+    AppendSegment(0, 2 * kTimeScale, 900, 1000, &index);
+    AppendSegment(2 * kTimeScale, 2 * kTimeScale, 1900, 1200, &index);
+    ASSERT_TRUE(File::WriteStringToFile(
+        (output_dir_ / "video.mp4.idx").string().c_str(),
+        std::string(index.Buffer(), index.Buffer() + index.Size())));
+    media_info_path_ = (output_dir_ / "video.mp4.media_info").string();
+    const std::string media_info =
+        std::string(kMediaInfo) + "media_file_name: '" +
+        (output_dir_ / "video.mp4").string() + "'\n";
+    ASSERT_TRUE(
+        File::WriteStringToFile(media_info_path_.c_str(), media_info));
+  }
+
+  void TearDown() override {
+    std::error_code ec;
+    std::filesystem::remove_all(output_dir_, ec);
+  }
+
+  std::string temp_dir_;
+  std::filesystem::path output_dir_;
+  std::string media_info_path_;
+};
+
+TEST_F(HlsWriterTest, WritesPlaylists) {
+  HlsWriter hls_writer;
+  ASSERT_TRUE(hls_writer.AddFile(media_info_path_, "video.m3u8"));
+
+  HlsParams hls_params;
+  hls_params.is_independent_segments = false;
+  hls_params.create_session_keys = false;
+  hls_params.master_playlist_output = (output_dir_ / "master.m3u8").string();
+  hls_params.base_url = "https://cdn.example.com/";
+  ASSERT_TRUE(hls_writer.WritePlaylists(hls_params));
+
+  std::string master_playlist;
+  ASSERT_TRUE(File::ReadFileToString(hls_params.master_playlist_output.c_str(),
+                                     &master_playlist));
+  EXPECT_THAT(master_playlist, HasSubstr("https://cdn.example.com/video.m3u8"));
+
+  std::string media_playlist;
+  ASSERT_TRUE(File::ReadFileToString(
+      (output_dir_ / "video.m3u8").string().c_str(), &media_playlist));
+  EXPECT_THAT(media_playlist, HasSubstr("#EXT-X-PLAYLIST-TYPE:VOD\n"));
+  EXPECT_THAT(media_playlist,
+              HasSubstr("#EXT-X-MAP:URI=\"https://cdn.example.com/video.mp4\","
+                        "BYTERANGE=\"800@0\"\n"));
+  EXPECT_THAT(media_playlist, HasSubstr("#EXTINF:2.000,\n"
+                                        "#EXT-X-BYTERANGE:1000@900\n"
+                                        "https://cdn.example.com/video.mp4\n"
+                                        "#EXTINF:2.000,\n"
+                                        "#EXT-X-BYTERANGE:1200\n"));
+  EXPECT_THAT(media_playlist, HasSubstr("#EXT-X-ENDLIST\n"));
+}
+
+TEST_F(HlsWriterTest, MissingSegmentIndex) {
+  std::filesystem::remove(output_dir_ / "video.mp4.idx");
+  HlsWriter hls_writer;
+  EXPECT_FALSE(hls_writer.AddFile(media_info_path_, "video.m3u8"));
+}
+
+}  // namespace hls
+}  // namespace shaka
@@ -14,4 +14,20 @@
 /// You can use the insertion operator to add specific logs to this.
 #define NOTIMPLEMENTED() LOG(ERROR) << "NOTIMPLEMENTED: "
 
+/// Logs at most once per second from a given statement. Use it on the paths
+/// run for every sample or packet, where bad input, e.g. from a live feed,
+/// would otherwise log a flood of messages and slow the pipeline down.
+#define LOG_RATE_LIMITED(severity) LOG_EVERY_N_SEC(severity, 1)
+
+/// Builds configured with -DSHAKA_MAX_VLOG_LEVEL=<level>, e.g. with the
+/// MAX_VLOG_LEVEL CMake option, compile out the VLOG statements above that
+/// level, so that they cost nothing, not even a check of the verbosity.
+#if defined(SHAKA_MAX_VLOG_LEVEL)
+#undef VLOG
+#define VLOG(verbose_level)                                \
+  LOG_IF(INFO, (verbose_level) <= SHAKA_MAX_VLOG_LEVEL &&  \
+                   VLOG_IS_ON(verbose_level))              \
+      .WithVerbosity(verbose_level)
+#endif  // defined(SHAKA_MAX_VLOG_LEVEL)
+
 #endif  // PACKAGER_MACROS_LOGGING_H_
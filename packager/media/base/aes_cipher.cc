@@ -0,0 +1,140 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/aes_cipher.h>
+
+#include <map>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <absl/synchronization/mutex.h>
+#include <mbedtls/aes.h>
+
+#if defined(SHAKA_USE_OPENSSL_CRYPTO)
+#include <packager/media/base/openssl_aes_cipher.h>
+#endif
+
+namespace shaka {
+namespace media {
+namespace {
+
+const char kMbedtlsBackend[] = "mbedtls";
+
+class MbedtlsAesCipher : public AesCipher {
+ public:
+  MbedtlsAesCipher() { mbedtls_aes_init(&aes_ctx_); }
+  ~MbedtlsAesCipher() override { mbedtls_aes_free(&aes_ctx_); }
+
+  bool SetKey(const std::vector<uint8_t>& key, Direction direction) override {
+    const unsigned int key_bits = static_cast<unsigned int>(8 * key.size());
+    mode_ = direction == Direction::kEncrypt ? MBEDTLS_AES_ENCRYPT
+                                             : MBEDTLS_AES_DECRYPT;
+    const int rv = direction == Direction::kEncrypt
+                       ? mbedtls_aes_setkey_enc(&aes_ctx_, key.data(), key_bits)
+                       : mbedtls_aes_setkey_dec(&aes_ctx_, key.data(), key_bits);
+    return rv == 0;
+  }
+
+  bool CryptCtr(const uint8_t* input,
+                size_t size,
+                uint8_t* output,
+                uint8_t* counter,
+                size_t* block_offset,
+                uint8_t* stream_block) override {
+    DCHECK_EQ(mode_, MBEDTLS_AES_ENCRYPT);
+    return mbedtls_aes_crypt_ctr(&aes_ctx_, size, block_offset, counter,
+                                 stream_block, input, output) == 0;
+  }
+
+  bool CryptCbc(const uint8_t* input,
+                size_t size,
+                uint8_t* output,
+                uint8_t* iv) override {
+    // mbedtls updates |iv| to the last ciphertext block in both directions.
+    return mbedtls_aes_crypt_cbc(&aes_ctx_, mode_, size, iv, input, output) ==
+           0;
+  }
+
+ private:
+  mbedtls_aes_context aes_ctx_;
+  int mode_ = MBEDTLS_AES_ENCRYPT;
+};
+
+std::unique_ptr<AesCipher> CreateMbedtlsAesCipher() {
+  return std::unique_ptr<AesCipher>(new MbedtlsAesCipher);
+}
+
+class BackendRegistry {
+ public:
+  BackendRegistry() {
+    factories_[kMbedtlsBackend] = &CreateMbedtlsAesCipher;
+#if defined(SHAKA_USE_OPENSSL_CRYPTO)
+    factories_[kOpensslBackend] = &CreateOpensslAesCipher;
+#endif
+  }
+
+  std::unique_ptr<AesCipher> Create() {
+    AesCipher::Factory factory;
+    {
+      absl::MutexLock lock(&mutex_);
+      factory = factories_.at(backend_);
+    }
+    return factory();
+  }
+
+  void Register(const std::string& name, AesCipher::Factory factory) {
+    CHECK(factory);
+    absl::MutexLock lock(&mutex_);
+    factories_[name] = factory;
+  }
+
+  bool Select(const std::string& name) {
+    absl::MutexLock lock(&mutex_);
+    if (factories_.find(name) == factories_.end()) {
+      LOG(ERROR) << "Unknown crypto backend: " << name;
+      return false;
+    }
+    backend_ = name;
+    return true;
+  }
+
+  std::string backend() {
+    absl::MutexLock lock(&mutex_);
+    return backend_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::map<std::string, AesCipher::Factory> factories_
+      ABSL_GUARDED_BY(mutex_);
+  std::string backend_ ABSL_GUARDED_BY(mutex_) = kMbedtlsBackend;
+};
+
+BackendRegistry& GetRegistry() {
+  static BackendRegistry* registry = new BackendRegistry;
+  return *registry;
+}
+
+}  // namespace
+
+std::unique_ptr<AesCipher> AesCipher::Create() {
+  return GetRegistry().Create();
+}
+
+void AesCipher::RegisterBackend(const std::string& name, Factory factory) {
+  GetRegistry().Register(name, factory);
+}
+
+bool AesCipher::SetBackend(const std::string& name) {
+  return GetRegistry().Select(name);
+}
+
+std::string AesCipher::backend() {
+  return GetRegistry().backend();
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,103 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_AES_CIPHER_H_
+#define PACKAGER_MEDIA_BASE_AES_CIPHER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace shaka {
+namespace media {
+
+/// The raw AES modes used by the AES cryptors, implemented by a crypto
+/// library, the backend. The padding schemes, the subsamples and the counter
+/// rules of CENC are handled by the cryptors, so that a backend only has to
+/// run the block cipher modes.
+///
+/// The backend is selected at runtime for the whole process, "mbedtls" by
+/// default. Other backends, e.g. "openssl" if the packager is built with
+/// USE_OPENSSL_CRYPTO, can be much faster on some platforms.
+class AesCipher {
+ public:
+  enum class Direction {
+    kEncrypt,
+    kDecrypt,
+  };
+
+  /// Creates a cipher of the current backend.
+  using Factory = std::unique_ptr<AesCipher> (*)();
+
+  virtual ~AesCipher() = default;
+
+  /// @param key is a 128, 192 or 256-bit AES key.
+  /// @param direction is the direction of CryptCbc(). CryptCtr() always
+  ///        encrypts the counters, which requires kEncrypt.
+  /// @return true on success, false if the key is invalid.
+  virtual bool SetKey(const std::vector<uint8_t>& key,
+                      Direction direction) = 0;
+
+  /// Crypt in counter mode, with the same semantics as
+  /// mbedtls_aes_crypt_ctr(). The whole 128-bit counter is incremented, in
+  /// big-endian order, after each block.
+  /// @param input points to @a size bytes.
+  /// @param output points to @a size bytes. It can be the same as @a input.
+  /// @param counter points to the 16-byte counter of the next block, which is
+  ///        updated.
+  /// @param block_offset is the offset in @a stream_block of the next byte
+  ///        to use, or 0 to start with a new block. It is updated.
+  /// @param stream_block points to the 16-byte key stream block being used,
+  ///        which is updated.
+  /// @return true on success, false otherwise.
+  virtual bool CryptCtr(const uint8_t* input,
+                        size_t size,
+                        uint8_t* output,
+                        uint8_t* counter,
+                        size_t* block_offset,
+                        uint8_t* stream_block) = 0;
+
+  /// Crypt whole blocks in cipher block chaining mode, without padding.
+  /// @param input points to @a size bytes, a multiple of the block size.
+  /// @param output points to @a size bytes. It can be the same as @a input.
+  /// @param iv points to the 16-byte initialization vector, which is updated
+  ///        to continue the chain, i.e. to the last ciphertext block.
+  /// @return true on success, false otherwise.
+  virtual bool CryptCbc(const uint8_t* input,
+                        size_t size,
+                        uint8_t* output,
+                        uint8_t* iv) = 0;
+
+  /// @return A cipher of the current backend.
+  static std::unique_ptr<AesCipher> Create();
+
+  /// Make a backend selectable with SetBackend(), e.g. one implemented with
+  /// another crypto library. A backend registered with the same name is
+  /// replaced.
+  static void RegisterBackend(const std::string& name, Factory factory);
+
+  /// Select the backend of the ciphers created from now on, for the whole
+  /// process.
+  /// @return false if no backend is registered with @a name.
+  static bool SetBackend(const std::string& name);
+
+  /// @return The name of the current backend.
+  static std::string backend();
+
+ protected:
+  AesCipher() = default;
+
+ private:
+  AesCipher(const AesCipher&) = delete;
+  AesCipher& operator=(const AesCipher&) = delete;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_AES_CIPHER_H_
@@ -0,0 +1,202 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/aes_cipher.h>
+
+#include <iterator>
+
+#include <gtest/gtest.h>
+
+#include <packager/media/base/aes_encryptor.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const size_t kAesBlockSize = 16;
+
+// From NIST SP 800-38a test cases F.2.1 CBC-AES128.Encrypt and F.5.1
+// CTR-AES128.Encrypt.
+const uint8_t kKey[] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                        0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+
+const uint8_t kPlaintext[] = {
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e,
+    0x11, 0x73, 0x93, 0x17, 0x2a, 0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03,
+    0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51, 0x30,
+    0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19,
+    0x1a, 0x0a, 0x52, 0xef, 0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b,
+    0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10};
+
+const uint8_t kCbcIv[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                          0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+
+const uint8_t kCbcCiphertext[] = {
+    0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e,
+    0x9b, 0x12, 0xe9, 0x19, 0x7d, 0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72,
+    0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2, 0x73,
+    0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b, 0x71, 0x16, 0xe6, 0x9e,
+    0x22, 0x22, 0x95, 0x16, 0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac,
+    0x09, 0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7};
+
+const uint8_t kCtrCounter[] = {0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5,
+                               0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb,
+                               0xfc, 0xfd, 0xfe, 0xff};
+
+const uint8_t kCtrCiphertext[] = {
+    0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68,
+    0x64, 0x99, 0x0d, 0xb6, 0xce, 0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70,
+    0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff, 0x5a,
+    0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02,
+    0x0d, 0xb0, 0x3e, 0xab, 0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03,
+    0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee};
+
+const char* kBackends[] = {
+    "mbedtls",
+#if defined(SHAKA_USE_OPENSSL_CRYPTO)
+    "openssl",
+#endif
+};
+
+}  // namespace
+
+class AesCipherTest : public testing::TestWithParam<const char*> {
+ public:
+  void SetUp() override {
+    ASSERT_TRUE(AesCipher::SetBackend(GetParam()));
+    cipher_ = AesCipher::Create();
+    key_.assign(std::begin(kKey), std::end(kKey));
+    plaintext_.assign(std::begin(kPlaintext), std::end(kPlaintext));
+  }
+
+  void TearDown() override { AesCipher::SetBackend("mbedtls"); }
+
+ protected:
+  std::unique_ptr<AesCipher> cipher_;
+  std::vector<uint8_t> key_;
+  std::vector<uint8_t> plaintext_;
+};
+
+TEST_P(AesCipherTest, Backend) {
+  EXPECT_EQ(GetParam(), AesCipher::backend());
+}
+
+TEST_P(AesCipherTest, InvalidKey) {
+  key_.resize(13);
+  EXPECT_FALSE(cipher_->SetKey(key_, AesCipher::Direction::kEncrypt));
+}
+
+TEST_P(AesCipherTest, CryptCtr) {
+  ASSERT_TRUE(cipher_->SetKey(key_, AesCipher::Direction::kEncrypt));
+
+  // Split the input so that calls start and end in the middle of key stream
+  // blocks.
+  const size_t kChunkSizes[] = {5, 11, 17, 1, 30};
+  std::vector<uint8_t> counter(std::begin(kCtrCounter), std::end(kCtrCounter));
+  std::vector<uint8_t> stream_block(kAesBlockSize);
+  size_t block_offset = 0;
+  std::vector<uint8_t> ciphertext(plaintext_.size());
+  size_t offset = 0;
+  for (size_t chunk_size : kChunkSizes) {
+    ASSERT_TRUE(cipher_->CryptCtr(&plaintext_[offset], chunk_size,
+                                  &ciphertext[offset], counter.data(),
+                                  &block_offset, stream_block.data()));
+    offset += chunk_size;
+  }
+  ASSERT_EQ(plaintext_.size(), offset);
+  EXPECT_EQ(std::vector<uint8_t>(std::begin(kCtrCiphertext),
+                                 std::end(kCtrCiphertext)),
+            ciphertext);
+  EXPECT_EQ(0u, block_offset);
+
+  // The counter is past the 4 blocks, with a carry out of the last byte.
+  std::vector<uint8_t> expected_counter(std::begin(kCtrCounter),
+                                        std::end(kCtrCounter));
+  expected_counter[14] = 0xff;
+  expected_counter[15] = 0x03;
+  EXPECT_EQ(expected_counter, counter);
+}
+
+TEST_P(AesCipherTest, CryptCbc) {
+  ASSERT_TRUE(cipher_->SetKey(key_, AesCipher::Direction::kEncrypt));
+  const std::vector<uint8_t> expected_ciphertext(std::begin(kCbcCiphertext),
+                                                 std::end(kCbcCiphertext));
+
+  // Chained across calls.
+  std::vector<uint8_t> iv(std::begin(kCbcIv), std::end(kCbcIv));
+  std::vector<uint8_t> ciphertext(plaintext_.size());
+  ASSERT_TRUE(cipher_->CryptCbc(plaintext_.data(), kAesBlockSize,
+                                ciphertext.data(), iv.data()));
+  EXPECT_EQ(std::vector<uint8_t>(ciphertext.begin(),
+                                 ciphertext.begin() + kAesBlockSize),
+            iv);
+  ASSERT_TRUE(cipher_->CryptCbc(&plaintext_[kAesBlockSize],
+                                plaintext_.size() - kAesBlockSize,
+                                &ciphertext[kAesBlockSize], iv.data()));
+  EXPECT_EQ(expected_ciphertext, ciphertext);
+  EXPECT_EQ(std::vector<uint8_t>(ciphertext.end() - kAesBlockSize,
+                                 ciphertext.end()),
+            iv);
+
+  // In place.
+  ASSERT_TRUE(cipher_->SetKey(key_, AesCipher::Direction::kDecrypt));
+  iv.assign(std::begin(kCbcIv), std::end(kCbcIv));
+  ASSERT_TRUE(cipher_->CryptCbc(ciphertext.data(), ciphertext.size(),
+                                ciphertext.data(), iv.data()));
+  EXPECT_EQ(plaintext_, ciphertext);
+  EXPECT_EQ(std::vector<uint8_t>(expected_ciphertext.end() - kAesBlockSize,
+                                 expected_ciphertext.end()),
+            iv);
+}
+
+// The cryptors use the backend selected when they are created.
+TEST_P(AesCipherTest, CtrEncryptor) {
+  AesCtrEncryptor encryptor;
+  ASSERT_TRUE(encryptor.InitializeWithIv(
+      key_, std::vector<uint8_t>(std::begin(kCtrCounter),
+                                 std::end(kCtrCounter))));
+  std::vector<uint8_t> ciphertext;
+  ASSERT_TRUE(encryptor.Crypt(plaintext_, &ciphertext));
+  EXPECT_EQ(std::vector<uint8_t>(std::begin(kCtrCiphertext),
+                                 std::end(kCtrCiphertext)),
+            ciphertext);
+}
+
+INSTANTIATE_TEST_CASE_P(Backends,
+                        AesCipherTest,
+                        testing::ValuesIn(kBackends));
+
+TEST(AesCipherBackendTest, DefaultBackend) {
+  EXPECT_EQ("mbedtls", AesCipher::backend());
+}
+
+TEST(AesCipherBackendTest, UnknownBackend) {
+  EXPECT_FALSE(AesCipher::SetBackend("unknown"));
+  EXPECT_EQ("mbedtls", AesCipher::backend());
+}
+
+namespace {
+
+int g_num_created_ciphers = 0;
+
+std::unique_ptr<AesCipher> CreateCountedCipher() {
+  ++g_num_created_ciphers;
+  return nullptr;
+}
+
+}  // namespace
+
+TEST(AesCipherBackendTest, RegisterBackend) {
+  AesCipher::RegisterBackend("counted", &CreateCountedCipher);
+  ASSERT_TRUE(AesCipher::SetBackend("counted"));
+  EXPECT_EQ("counted", AesCipher::backend());
+  EXPECT_FALSE(AesCipher::Create());
+  EXPECT_EQ(1, g_num_created_ciphers);
+  ASSERT_TRUE(AesCipher::SetBackend("mbedtls"));
+}
+
+}  // namespace media
+}  // namespace shaka
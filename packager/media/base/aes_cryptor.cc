@@ -6,6 +6,7 @@
 
 #include <packager/media/base/aes_cryptor.h>
 
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -30,13 +31,11 @@ namespace shaka {
 namespace media {
 
 AesCryptor::AesCryptor(ConstantIvFlag constant_iv_flag)
-    : constant_iv_flag_(constant_iv_flag), num_crypt_bytes_(0) {
-  mbedtls_cipher_init(&cipher_ctx_);
-}
+    : cipher_(AesCipher::Create()),
+      constant_iv_flag_(constant_iv_flag),
+      num_crypt_bytes_(0) {}
 
-AesCryptor::~AesCryptor() {
-  mbedtls_cipher_free(&cipher_ctx_);
-}
+AesCryptor::~AesCryptor() {}
 
 bool AesCryptor::Crypt(const std::vector<uint8_t>& text,
                        std::vector<uint8_t>* crypt_text) {
@@ -67,6 +66,80 @@ bool AesCryptor::Crypt(const std::string& text, std::string* crypt_text) {
   return true;
 }
 
+bool AesCryptor::CryptSubsamples(const uint8_t* text,
+                                 size_t text_size,
+                                 const std::vector<SubsampleEntry>& subsamples,
+                                 uint8_t* crypt_text) {
+  if (subsamples.empty())
+    return Crypt(text, text_size, crypt_text);
+
+  // Validate the ranges up front so that nothing is crypted for a malformed
+  // sample.
+  size_t total_size = 0;
+  for (const SubsampleEntry& subsample : subsamples)
+    total_size += subsample.clear_bytes + subsample.cipher_bytes;
+  if (total_size > text_size) {
+    LOG(ERROR) << "Subsamples overflow sample buffer.";
+    return false;
+  }
+
+  // With a constant iv, every cipher range restarts from the iv, so the ranges
+  // are crypted one by one. Otherwise the implementation may crypt them as one
+  // stream.
+  if (constant_iv_flag_ == kUseConstantIv) {
+    for (const SubsampleEntry& subsample : subsamples) {
+      if (subsample.clear_bytes > 0) {
+        if (text != crypt_text)
+          memcpy(crypt_text, text, subsample.clear_bytes);
+        text += subsample.clear_bytes;
+        crypt_text += subsample.clear_bytes;
+      }
+      if (subsample.cipher_bytes > 0) {
+        if (!Crypt(text, subsample.cipher_bytes, crypt_text))
+          return false;
+        text += subsample.cipher_bytes;
+        crypt_text += subsample.cipher_bytes;
+      }
+    }
+  } else {
+    for (const SubsampleEntry& subsample : subsamples)
+      num_crypt_bytes_ += subsample.cipher_bytes;
+    if (!CryptSubsamplesInternal(text, subsamples, crypt_text))
+      return false;
+    text += total_size;
+    crypt_text += total_size;
+  }
+
+  // The bytes after the subsamples are clear.
+  if (total_size < text_size && text != crypt_text)
+    memcpy(crypt_text, text, text_size - total_size);
+  return true;
+}
+
+bool AesCryptor::CryptSubsamplesInternal(
+    const uint8_t* text,
+    const std::vector<SubsampleEntry>& subsamples,
+    uint8_t* crypt_text) {
+  for (const SubsampleEntry& subsample : subsamples) {
+    if (subsample.clear_bytes > 0) {
+      if (text != crypt_text)
+        memcpy(crypt_text, text, subsample.clear_bytes);
+      text += subsample.clear_bytes;
+      crypt_text += subsample.clear_bytes;
+    }
+    if (subsample.cipher_bytes > 0) {
+      size_t crypt_text_size = subsample.cipher_bytes;
+      if (!CryptInternal(text, subsample.cipher_bytes, crypt_text,
+                         &crypt_text_size)) {
+        return false;
+      }
+      text += subsample.cipher_bytes;
+      crypt_text += subsample.cipher_bytes;
+    }
+  }
+  return true;
+}
+
 bool AesCryptor::SetIv(const std::vector<uint8_t>& iv) {
   if (!IsIvSizeValid(iv.size())) {
     LOG(ERROR) << "Invalid IV size: " << iv.size();
@@ -107,6 +180,13 @@ void AesCryptor::UpdateIv() {
   SetIvInternal();
 }
 
+void AesCryptor::UpdateIv(size_t crypt_text_size) {
+  if (constant_iv_flag_ == kUseConstantIv)
+    return;
+  num_crypt_bytes_ += crypt_text_size;
+  UpdateIv();
+}
+
 bool AesCryptor::GenerateRandomIv(FourCC protection_scheme,
                                   std::vector<uint8_t>* iv) {
   // ISO/IEC 23001-7:2016 10.1 and 10.3 For 'cenc' and 'cens'
@@ -137,50 +217,18 @@ size_t AesCryptor::NumPaddingBytes(size_t size) const {
   return 0;
 }
 
-bool AesCryptor::SetupCipher(size_t key_size, CipherMode mode) {
-  mbedtls_cipher_type_t type;
-
+bool AesCryptor::SetKey(const std::vector<uint8_t>& key,
+                        AesCipher::Direction direction) {
   // AES defines three key sizes: 128, 192 and 256 bits.
-  // NOTE: Because we use ECB mode in the CTR cryptors, this returns ECB
-  // instead of CTR.  Counters and block offsets are managed internally.
-  switch (key_size) {
-    case 16:
-      type = mode == kCtrMode ? MBEDTLS_CIPHER_AES_128_ECB
-                              : MBEDTLS_CIPHER_AES_128_CBC;
-      break;
-    case 24:
-      type = mode == kCtrMode ? MBEDTLS_CIPHER_AES_192_ECB
-                              : MBEDTLS_CIPHER_AES_192_CBC;
-      break;
-    case 32:
-      type = mode == kCtrMode ? MBEDTLS_CIPHER_AES_256_ECB
-                              : MBEDTLS_CIPHER_AES_256_CBC;
-      break;
-    default:
-      LOG(ERROR) << "Invalid AES key size: " << key_size;
-      return false;
-  }
-
-  const mbedtls_cipher_info_t* cipher_info =
-      mbedtls_cipher_info_from_type(type);
-  CHECK(cipher_info);
-
-  if (mbedtls_cipher_setup(&cipher_ctx_, cipher_info) != 0) {
-    LOG(ERROR) << "Cipher setup failed";
+  if (key.size() != 16 && key.size() != 24 && key.size() != 32) {
+    LOG(ERROR) << "Invalid AES key size: " << key.size();
     return false;
   }
-
-  // Padding mode only applies to CBC.
-  if (mode == kCbcMode) {
-    // We handle padding ourselves.  Don't let mbedtls mess with it.
-    mbedtls_cipher_padding_t cipher_padding = MBEDTLS_PADDING_NONE;
-
-    if (mbedtls_cipher_set_padding_mode(&cipher_ctx_, cipher_padding) != 0) {
-      LOG(ERROR) << "Failed to set CBC padding mode";
-      return false;
-    }
+  if (!cipher_->SetKey(key, direction)) {
+    LOG(ERROR) << "Failed to set the AES key with the "
+               << AesCipher::backend() << " crypto backend";
+    return false;
   }
-
   return true;
 }
 
@@ -11,9 +11,9 @@
 #include <string>
 #include <vector>
 
-#include <mbedtls/cipher.h>
-
 #include <packager/macros/classes.h>
+#include <packager/media/base/aes_cipher.h>
+#include <packager/media/base/decrypt_config.h>
 #include <packager/media/base/fourccs.h>
 
 namespace shaka {
@@ -71,6 +71,22 @@ class AesCryptor {
   }
   /// @}
 
+  /// Crypt a whole sample in a single call. Clear bytes are copied as is and
+  /// cipher bytes are crypted as one continuous stream, i.e. as if Crypt() was
+  /// called on each cipher range in order.
+  /// @param text points to the sample data.
+  /// @param text_size is the size of the sample data.
+  /// @param subsamples contains the clear and cipher ranges of the sample, in
+  ///        order. The whole sample is crypted if it is empty.
+  /// @param crypt_text should have at least @a text_size bytes. It can be the
+  ///        same address as @a text for in place encryption/decryption.
+  /// @return false if the subsamples overflow the sample or if there is any
+  ///         error in encryption/decryption, true otherwise.
+  bool CryptSubsamples(const uint8_t* text,
+                       size_t text_size,
+                       const std::vector<SubsampleEntry>& subsamples,
+                       uint8_t* crypt_text);
+
   /// Set IV. SetIv() implementation guarantees that the iv passed to SetIv()
   /// is set to iv() and then calls SetIvInternal().
   /// @return true if successful, false if the input is invalid.
@@ -81,6 +97,11 @@ class AesCryptor {
   /// This is used by encryptors only. It is a NOP if using kUseConstantIv.
   void UpdateIv();
 
+  /// Update IV for next sample as if @a crypt_text_size bytes had been crypted
+  /// for the current sample. This is used when the current sample is crypted
+  /// by another cryptor instance. It is a NOP if using kUseConstantIv.
+  void UpdateIv(size_t crypt_text_size);
+
   /// @return The current iv.
   const std::vector<uint8_t>& iv() const { return iv_; }
 
@@ -95,15 +116,24 @@ class AesCryptor {
                                std::vector<uint8_t>* iv);
 
  protected:
-  enum CipherMode {
-    kCtrMode,
-    kCbcMode,
-  };
-
-  // mbedTLS cipher context.
-  mbedtls_cipher_context_t cipher_ctx_;
-
-  bool SetupCipher(size_t key_size, CipherMode mode);
+  // Sets the key of |cipher_|, which must be a 128, 192 or 256-bit AES key.
+  bool SetKey(const std::vector<uint8_t>& key,
+              AesCipher::Direction direction);
+
+  // The block cipher modes, from the crypto backend selected when the cryptor
+  // was created.
+  std::unique_ptr<AesCipher> cipher_;
+
+  // Internal implementation of CryptSubsamples for cryptors which do not use a
+  // constant iv, i.e. whose cipher ranges are crypted as one continuous
+  // stream. |subsamples| is not empty and has been validated against the
+  // sample size. The default implementation calls CryptInternal() on each
+  // cipher range. Implementations can override it to crypt all the ranges in
+  // fewer calls.
+  virtual bool CryptSubsamplesInternal(
+      const uint8_t* text,
+      const std::vector<SubsampleEntry>& subsamples,
+      uint8_t* crypt_text);
 
  private:
   // Internal implementation of crypt function.
@@ -7,6 +7,7 @@
 #include <packager/media/base/aes_decryptor.h>
 #include <packager/media/base/aes_encryptor.h>
 
+#include <algorithm>
 #include <iterator>
 #include <memory>
 
@@ -185,6 +186,63 @@ TEST_F(AesCtrEncryptorTest, 128BitIVBoundaryCaseEncryption) {
   EXPECT_EQ(encrypted, encrypted_verify);
 }
 
+TEST_F(AesCtrEncryptorTest, 128BitIVBoundaryCaseSplitEncryption) {
+  // Crypting in pieces which are not aligned to the block boundary must give
+  // the same result across the 64-bit counter wrap around.
+  std::vector<uint8_t> iv_max64(kIv128Max64,
+                                kIv128Max64 + std::size(kIv128Max64));
+  ASSERT_TRUE(encryptor_.InitializeWithIv(key_, iv_max64));
+  std::vector<uint8_t> encrypted;
+  ASSERT_TRUE(encryptor_.Crypt(plaintext_, &encrypted));
+
+  ASSERT_TRUE(encryptor_.InitializeWithIv(key_, iv_max64));
+  std::vector<uint8_t> encrypted_verify(plaintext_.size(), 0);
+  const size_t kPieceSize = 5;
+  for (size_t offset = 0; offset < plaintext_.size(); offset += kPieceSize) {
+    const size_t size = std::min(kPieceSize, plaintext_.size() - offset);
+    ASSERT_TRUE(encryptor_.Crypt(&plaintext_[offset], size,
+                                 &encrypted_verify[offset]));
+  }
+  EXPECT_EQ(encrypted, encrypted_verify);
+}
+
+TEST_F(AesCtrEncryptorTest, CryptSubsamples) {
+  const std::vector<SubsampleEntry> subsamples = {{5, 20}, {0, 10}, {3, 26}};
+  std::vector<uint8_t> encrypted(plaintext_.size());
+  ASSERT_TRUE(encryptor_.CryptSubsamples(plaintext_.data(), plaintext_.size(),
+                                         subsamples, encrypted.data()));
+
+  // Same as crypting the cipher bytes as one continuous stream.
+  std::vector<uint8_t> cipher_bytes(plaintext_.begin() + 5,
+                                    plaintext_.begin() + 35);
+  cipher_bytes.insert(cipher_bytes.end(), plaintext_.begin() + 38,
+                      plaintext_.end());
+  ASSERT_TRUE(decryptor_.Crypt(cipher_bytes, &cipher_bytes));
+  std::vector<uint8_t> expected(plaintext_.begin(), plaintext_.begin() + 5);
+  expected.insert(expected.end(), cipher_bytes.begin(),
+                  cipher_bytes.begin() + 30);
+  expected.insert(expected.end(), plaintext_.begin() + 35,
+                  plaintext_.begin() + 38);
+  expected.insert(expected.end(), cipher_bytes.begin() + 30,
+                  cipher_bytes.end());
+  EXPECT_EQ(expected, encrypted);
+
+  // Subsamples overflowing the sample are rejected.
+  const std::vector<SubsampleEntry> overflow_subsamples = {{5, 60}};
+  EXPECT_FALSE(encryptor_.CryptSubsamples(plaintext_.data(), plaintext_.size(),
+                                          overflow_subsamples,
+                                          encrypted.data()));
+}
+
+TEST_F(AesCtrEncryptorTest, CryptSubsamplesCopiesTrailingClearBytes) {
+  const std::vector<SubsampleEntry> subsamples = {{5, 20}};
+  std::vector<uint8_t> encrypted(plaintext_.size(), 0);
+  ASSERT_TRUE(encryptor_.CryptSubsamples(plaintext_.data(), plaintext_.size(),
+                                         subsamples, encrypted.data()));
+  EXPECT_EQ(std::vector<uint8_t>(plaintext_.begin() + 25, plaintext_.end()),
+            std::vector<uint8_t>(encrypted.begin() + 25, encrypted.end()));
+}
+
 TEST_F(AesCtrEncryptorTest, 64BitIvUpdate) {
   std::vector<uint8_t> iv_zero(kIv64Zero, kIv64Zero + std::size(kIv64Zero));
   ASSERT_TRUE(encryptor_.InitializeWithIv(key_, iv_zero));
@@ -538,6 +596,56 @@ TEST_F(AesCbcTest, NoPaddingChainAcrossCalls) {
   EXPECT_EQ(plaintext, decrypted);
 }
 
+TEST_F(AesCbcTest, NoPaddingCryptSubsamples) {
+  // Syncframe-like ranges with residual blocks and ranges without a whole
+  // block, which are all encrypted in one call.
+  const std::vector<SubsampleEntry> kSubsamples = {
+      {16, 36}, {16, 4}, {10, 0}, {16, 48}, {3, 17}};
+  std::vector<uint8_t> plaintext(16 + 36 + 16 + 4 + 10 + 16 + 48 + 3 + 17);
+  for (size_t i = 0; i < plaintext.size(); ++i)
+    plaintext[i] = static_cast<uint8_t>(i * 7);
+
+  // Encrypt the cipher ranges one by one.
+  AesCbcEncryptor expected_encryptor(kNoPadding,
+                                     AesCryptor::kDontUseConstantIv);
+  ASSERT_TRUE(expected_encryptor.InitializeWithIv(key_, iv_));
+  std::vector<uint8_t> expected_ciphertext(plaintext);
+  uint8_t* range = expected_ciphertext.data();
+  for (const SubsampleEntry& subsample : kSubsamples) {
+    range += subsample.clear_bytes;
+    ASSERT_TRUE(expected_encryptor.Crypt(range, subsample.cipher_bytes, range));
+    range += subsample.cipher_bytes;
+  }
+
+  AesCbcEncryptor encryptor(kNoPadding, AesCryptor::kDontUseConstantIv);
+  ASSERT_TRUE(encryptor.InitializeWithIv(key_, iv_));
+  std::vector<uint8_t> ciphertext(plaintext.size());
+  ASSERT_TRUE(encryptor.CryptSubsamples(plaintext.data(), plaintext.size(),
+                                        kSubsamples, ciphertext.data()));
+  EXPECT_EQ(expected_ciphertext, ciphertext);
+
+  // In place.
+  ASSERT_TRUE(encryptor.InitializeWithIv(key_, iv_));
+  std::vector<uint8_t> buffer(plaintext);
+  ASSERT_TRUE(encryptor.CryptSubsamples(buffer.data(), buffer.size(),
+                                        kSubsamples, buffer.data()));
+  EXPECT_EQ(expected_ciphertext, buffer);
+
+  // The chain carries on across samples as it does across calls.
+  expected_encryptor.UpdateIv();
+  encryptor.UpdateIv();
+  EXPECT_EQ(expected_encryptor.iv(), encryptor.iv());
+  std::vector<uint8_t> expected_next(plaintext);
+  ASSERT_TRUE(expected_encryptor.Crypt(plaintext.data(), plaintext.size(),
+                                       expected_next.data()));
+  const std::vector<SubsampleEntry> kWholeSample = {
+      {0, static_cast<uint32_t>(plaintext.size())}};
+  std::vector<uint8_t> next(plaintext.size());
+  ASSERT_TRUE(encryptor.CryptSubsamples(plaintext.data(), plaintext.size(),
+                                        kWholeSample, next.data()));
+  EXPECT_EQ(expected_next, next);
+}
+
 TEST_F(AesCbcTest, UnsupportedKeySize) {
   EXPECT_FALSE(encryptor_->InitializeWithIv(std::vector<uint8_t>(15, 0), iv_));
   EXPECT_FALSE(decryptor_->InitializeWithIv(std::vector<uint8_t>(15, 0), iv_));
@@ -33,17 +33,8 @@ AesCbcDecryptor::~AesCbcDecryptor() {}
 
 bool AesCbcDecryptor::InitializeWithIv(const std::vector<uint8_t>& key,
                                        const std::vector<uint8_t>& iv) {
-  if (!SetupCipher(key.size(), kCbcMode)) {
+  if (!SetKey(key, AesCipher::Direction::kDecrypt))
     return false;
-  }
-
-  if (mbedtls_cipher_setkey(&cipher_ctx_, key.data(),
-                            static_cast<int>(8 * key.size()),
-                            MBEDTLS_DECRYPT) != 0) {
-    LOG(ERROR) << "Failed to set CBC decryption key";
-    return false;
-  }
-
   return SetIv(iv);
 }
 
@@ -168,18 +159,9 @@ void AesCbcDecryptor::CbcDecryptBlocks(const uint8_t* ciphertext,
   CHECK_EQ(ciphertext_size % AES_BLOCK_SIZE, 0u);
   CHECK_GT(ciphertext_size, 0u);
 
-  // Copy the final block of ciphertext before decryption, since we could be
-  // decrypting in-place.
-  const uint8_t* last_block = ciphertext + ciphertext_size - AES_BLOCK_SIZE;
-  std::vector<uint8_t> next_iv(last_block, last_block + AES_BLOCK_SIZE);
-
-  size_t output_size = 0;
-  CHECK_EQ(mbedtls_cipher_crypt(&cipher_ctx_, iv, AES_BLOCK_SIZE, ciphertext,
-                                ciphertext_size, plaintext, &output_size),
-           0);
-  DCHECK_EQ(output_size % AES_BLOCK_SIZE, 0u);
-
-  memcpy(iv, next_iv.data(), next_iv.size());
+  // |iv| is updated to the last ciphertext block, even when decrypting in
+  // place.
+  CHECK(cipher_->CryptCbc(ciphertext, ciphertext_size, plaintext, iv));
 }
 
 }  // namespace media
@@ -6,6 +6,8 @@
 
 #include <packager/media/base/aes_encryptor.h>
 
+#include <algorithm>
+
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 
@@ -13,14 +15,12 @@
 
 namespace {
 
-// Increment an 8-byte counter by 1. Return true if overflowed.
-bool Increment64(uint8_t* counter) {
-  DCHECK(counter);
-  for (int i = 7; i >= 0; --i) {
-    if (++counter[i] != 0)
-      return false;
-  }
-  return true;
+// Reads the 8-byte big endian counter at |counter|.
+uint64_t ReadCounter64(const uint8_t* counter) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i)
+    value = (value << 8) | counter[i];
+  return value;
 }
 
 }  // namespace
@@ -39,17 +39,8 @@ AesCtrEncryptor::~AesCtrEncryptor() {}
 
 bool AesCtrEncryptor::InitializeWithIv(const std::vector<uint8_t>& key,
                                        const std::vector<uint8_t>& iv) {
-  if (!SetupCipher(key.size(), kCtrMode)) {
+  if (!SetKey(key, AesCipher::Direction::kEncrypt))
     return false;
-  }
-
-  if (mbedtls_cipher_setkey(&cipher_ctx_, key.data(),
-                            static_cast<int>(8 * key.size()),
-                            MBEDTLS_ENCRYPT) != 0) {
-    LOG(ERROR) << "Failed to set CTR encryption key";
-    return false;
-  }
-
   return SetIv(iv);
 }
 
@@ -68,24 +59,45 @@ bool AesCtrEncryptor::CryptInternal(const uint8_t* plaintext,
   }
   *ciphertext_size = plaintext_size;
 
-  for (size_t i = 0; i < plaintext_size; ++i) {
-    if (block_offset_ == 0) {
-      size_t ignored_output_size;
-      CHECK_EQ(
-          mbedtls_cipher_crypt(&cipher_ctx_, /* iv= */ NULL, /* iv_len= */ 0,
-                               &counter_[0], AES_BLOCK_SIZE,
-                               &encrypted_counter_[0], &ignored_output_size),
-          0);
-
-      // As mentioned in ISO/IEC 23001-7:2016 CENC spec, of the 16 byte counter
-      // block, bytes 8 to 15 (i.e. the least significant bytes) are used as a
-      // simple 64 bit unsigned integer that is incremented by one for each
-      // subsequent block of sample data processed and is kept in network byte
-      // order.
-      Increment64(&counter_[8]);
+  // As mentioned in ISO/IEC 23001-7:2016 CENC spec, of the 16 byte counter
+  // block, bytes 8 to 15 (i.e. the least significant bytes) are used as a
+  // simple 64 bit unsigned integer that is incremented by one for each
+  // subsequent block of sample data processed and is kept in network byte
+  // order. The cipher increments all 16 bytes instead, so the input is split
+  // where the lower 64 bits wrap around, and the carry into the upper 64 bits
+  // is undone there.
+  const std::vector<uint8_t> upper_counter(counter_.begin(),
+                                           counter_.begin() + 8);
+  while (plaintext_size > 0) {
+    // Bytes left in the current key stream block, which do not need a new
+    // counter.
+    const size_t partial_block_size =
+        std::min(static_cast<size_t>((AES_BLOCK_SIZE - block_offset_) %
+                                     AES_BLOCK_SIZE),
+                 plaintext_size);
+    // Number of counter values left before the lower 64 bits wrap around. 0
+    // means 2^64, which is effectively unlimited.
+    const uint64_t blocks_before_wrap = 0 - ReadCounter64(&counter_[8]);
+
+    size_t chunk_size = plaintext_size;
+    if (blocks_before_wrap != 0 &&
+        blocks_before_wrap <=
+            (plaintext_size - partial_block_size) / AES_BLOCK_SIZE) {
+      chunk_size = partial_block_size + blocks_before_wrap * AES_BLOCK_SIZE;
+    }
+
+    size_t block_offset = block_offset_;
+    if (!cipher_->CryptCtr(plaintext, chunk_size, ciphertext, counter_.data(),
+                           &block_offset, encrypted_counter_.data())) {
+      LOG(ERROR) << "Failed to run AES-CTR";
+      return false;
     }
-    ciphertext[i] = plaintext[i] ^ encrypted_counter_[block_offset_];
-    block_offset_ = (block_offset_ + 1) % AES_BLOCK_SIZE;
+    block_offset_ = static_cast<uint32_t>(block_offset);
+    std::copy(upper_counter.begin(), upper_counter.end(), counter_.begin());
+
+    plaintext += chunk_size;
+    ciphertext += chunk_size;
+    plaintext_size -= chunk_size;
   }
   return true;
 }
@@ -113,17 +125,8 @@ AesCbcEncryptor::~AesCbcEncryptor() {}
 
 bool AesCbcEncryptor::InitializeWithIv(const std::vector<uint8_t>& key,
                                        const std::vector<uint8_t>& iv) {
-  if (!SetupCipher(key.size(), kCbcMode)) {
+  if (!SetKey(key, AesCipher::Direction::kEncrypt))
     return false;
-  }
-
-  if (mbedtls_cipher_setkey(&cipher_ctx_, key.data(),
-                            static_cast<int>(8 * key.size()),
-                            MBEDTLS_ENCRYPT) != 0) {
-    LOG(ERROR) << "Failed to set CBC encryption key";
-    return false;
-  }
-
   return SetIv(iv);
 }
 
@@ -202,6 +205,59 @@ bool AesCbcEncryptor::CryptInternal(const uint8_t* plaintext,
   return true;
 }
 
+bool AesCbcEncryptor::CryptSubsamplesInternal(
+    const uint8_t* text,
+    const std::vector<SubsampleEntry>& subsamples,
+    uint8_t* crypt_text) {
+  // Padding only applies to the end of each range.
+  if (padding_scheme_ != kNoPadding)
+    return AesCryptor::CryptSubsamplesInternal(text, subsamples, crypt_text);
+
+  // Without padding, the residual block of each cipher range is left in the
+  // clear and the chain carries on into the next range, so the ranges are
+  // equivalent to the concatenation of their whole blocks. Small ranges, e.g.
+  // SAMPLE-AES audio frames, are then encrypted in one call instead of one
+  // call per range.
+  size_t total_size = 0;
+  size_t gathered_size = 0;
+  for (const SubsampleEntry& subsample : subsamples) {
+    total_size += subsample.clear_bytes + subsample.cipher_bytes;
+    gathered_size += subsample.cipher_bytes -
+                     subsample.cipher_bytes % AES_BLOCK_SIZE;
+  }
+  if (text != crypt_text)
+    memcpy(crypt_text, text, total_size);
+  if (gathered_size == 0)
+    return true;
+
+  gathered_blocks_.resize(gathered_size);
+  uint8_t* gathered = gathered_blocks_.data();
+  size_t offset = 0;
+  for (const SubsampleEntry& subsample : subsamples) {
+    offset += subsample.clear_bytes;
+    const size_t size =
+        subsample.cipher_bytes - subsample.cipher_bytes % AES_BLOCK_SIZE;
+    memcpy(gathered, text + offset, size);
+    gathered += size;
+    offset += subsample.cipher_bytes;
+  }
+
+  CbcEncryptBlocks(gathered_blocks_.data(), gathered_size,
+                   gathered_blocks_.data(), internal_iv_.data());
+
+  gathered = gathered_blocks_.data();
+  offset = 0;
+  for (const SubsampleEntry& subsample : subsamples) {
+    offset += subsample.clear_bytes;
+    const size_t size =
+        subsample.cipher_bytes - subsample.cipher_bytes % AES_BLOCK_SIZE;
+    memcpy(crypt_text + offset, gathered, size);
+    gathered += size;
+    offset += subsample.cipher_bytes;
+  }
+  return true;
+}
+
 void AesCbcEncryptor::SetIvInternal() {
   internal_iv_ = iv();
   internal_iv_.resize(AES_BLOCK_SIZE, 0);
@@ -218,17 +274,10 @@ void AesCbcEncryptor::CbcEncryptBlocks(const uint8_t* plaintext,
                                        uint8_t* ciphertext,
                                        uint8_t* iv) {
   CHECK_EQ(plaintext_size % AES_BLOCK_SIZE, 0u);
+  CHECK_GT(plaintext_size, 0u);
 
-  size_t output_size = 0;
-  CHECK_EQ(mbedtls_cipher_crypt(&cipher_ctx_, iv, AES_BLOCK_SIZE, plaintext,
-                                plaintext_size, ciphertext, &output_size),
-           0);
-
-  CHECK_EQ(output_size % AES_BLOCK_SIZE, 0u);
-  CHECK_GT(output_size, 0u);
-
-  uint8_t* last_block = ciphertext + output_size - AES_BLOCK_SIZE;
-  memcpy(iv, last_block, AES_BLOCK_SIZE);
+  // |iv| is updated to the last ciphertext block.
+  CHECK(cipher_->CryptCbc(plaintext, plaintext_size, ciphertext, iv));
 }
 
 }  // namespace media
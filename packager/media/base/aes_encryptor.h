@@ -4,7 +4,7 @@
 // license that can be found in the LICENSE file or at
 // https://developers.google.com/open-source/licenses/bsd
 //
-// AES Encryptor implementation using mbedtls.
+// AES Encryptor implementation using the AesCipher crypto backend.
 
 #ifndef PACKAGER_MEDIA_BASE_AES_ENCRYPTOR_H_
 #define PACKAGER_MEDIA_BASE_AES_ENCRYPTOR_H_
@@ -93,6 +93,9 @@ class AesCbcEncryptor : public AesCryptor {
                      size_t* ciphertext_size) override;
   void SetIvInternal() override;
   size_t NumPaddingBytes(size_t size) const override;
+  bool CryptSubsamplesInternal(const uint8_t* text,
+                               const std::vector<SubsampleEntry>& subsamples,
+                               uint8_t* crypt_text) override;
 
   void CbcEncryptBlocks(const uint8_t* plaintext,
                         size_t plaintext_size,
@@ -102,6 +105,9 @@ class AesCbcEncryptor : public AesCryptor {
   const CbcPaddingScheme padding_scheme_;
   // 16-byte internal iv for crypto operations.
   std::vector<uint8_t> internal_iv_;
+  // The blocks of the cipher ranges of a sample, gathered to be encrypted in a
+  // single call. Kept to reuse its allocation across samples.
+  std::vector<uint8_t> gathered_blocks_;
 
   DISALLOW_COPY_AND_ASSIGN(AesCbcEncryptor);
 };
@@ -7,6 +7,7 @@
 #include <packager/media/base/aes_pattern_cryptor.h>
 
 #include <algorithm>
+#include <cstring>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
@@ -52,42 +53,59 @@ bool AesPatternCryptor::CryptInternal(const uint8_t* text,
   }
   *crypt_text_size = text_size;
 
-  while (text_size > 0) {
-    const size_t crypt_byte_size = crypt_byte_block_ * AES_BLOCK_SIZE;
-
-    if (text_size <= crypt_byte_size) {
-      const bool need_encrypt =
-          encryption_mode_ != kSkipIfCryptByteBlockRemaining &&
-          text_size >= AES_BLOCK_SIZE;
-      if (need_encrypt) {
-        // The partial pattern SHALL be followed with the partial 16-byte block
-        // remains unencrypted.
-        const size_t aligned_crypt_byte_size =
-            text_size / AES_BLOCK_SIZE * AES_BLOCK_SIZE;
-        if (!cryptor_->Crypt(text, aligned_crypt_byte_size, crypt_text))
-          return false;
-        text += aligned_crypt_byte_size;
-        text_size -= aligned_crypt_byte_size;
-        crypt_text += aligned_crypt_byte_size;
-      }
-
-      // The remaining bytes are not encrypted.
-      memcpy(crypt_text, text, text_size);
-      return true;
+  // The bytes to be encrypted in a pattern form a single continuous stream for
+  // |cryptor_|. Gather them into |crypt_blocks_| and crypt them in a single
+  // call, instead of calling |cryptor_| for every pattern, which is only one
+  // block for the common 1:9 pattern. Unencrypted bytes are copied directly.
+  const size_t crypt_byte_size = crypt_byte_block_ * AES_BLOCK_SIZE;
+  const size_t skip_byte_size = skip_byte_block_ * AES_BLOCK_SIZE;
+  crypt_blocks_.clear();
+  size_t total_crypt_size = 0;
+  size_t offset = 0;
+  while (offset < text_size) {
+    const size_t remaining = text_size - offset;
+    size_t crypt_size = crypt_byte_size;
+    if (remaining <= crypt_byte_size) {
+      // The partial pattern SHALL be followed with the partial 16-byte block
+      // remains unencrypted.
+      crypt_size = encryption_mode_ != kSkipIfCryptByteBlockRemaining
+                       ? remaining / AES_BLOCK_SIZE * AES_BLOCK_SIZE
+                       : 0;
+    }
+    // Without skipped blocks the bytes are already continuous.
+    if (skip_byte_size > 0) {
+      crypt_blocks_.insert(crypt_blocks_.end(), text + offset,
+                           text + offset + crypt_size);
     }
+    total_crypt_size += crypt_size;
+    offset += crypt_size;
+
+    const size_t clear_size = remaining <= crypt_byte_size
+                                  ? remaining - crypt_size
+                                  : std::min(skip_byte_size, text_size - offset);
+    memcpy(crypt_text + offset, text + offset, clear_size);
+    offset += clear_size;
+  }
 
-    if (!cryptor_->Crypt(text, crypt_byte_size, crypt_text))
-      return false;
-    text += crypt_byte_size;
-    text_size -= crypt_byte_size;
-    crypt_text += crypt_byte_size;
+  if (total_crypt_size == 0)
+    return true;
+  if (skip_byte_size == 0)
+    return cryptor_->Crypt(text, total_crypt_size, crypt_text);
+  if (!cryptor_->Crypt(crypt_blocks_.data(), crypt_blocks_.size(),
+                       crypt_blocks_.data())) {
+    return false;
+  }
 
-    const size_t skip_byte_size = std::min(
-        static_cast<size_t>(skip_byte_block_ * AES_BLOCK_SIZE), text_size);
-    memcpy(crypt_text, text, skip_byte_size);
-    text += skip_byte_size;
-    text_size -= skip_byte_size;
-    crypt_text += skip_byte_size;
+  // Scatter the crypted bytes back to their positions.
+  const uint8_t* crypted = crypt_blocks_.data();
+  const uint8_t* const crypted_end = crypted + crypt_blocks_.size();
+  offset = 0;
+  while (crypted < crypted_end) {
+    const size_t crypt_size = std::min(
+        crypt_byte_size, static_cast<size_t>(crypted_end - crypted));
+    memcpy(crypt_text + offset, crypted, crypt_size);
+    crypted += crypt_size;
+    offset += crypt_size + skip_byte_size;
   }
   return true;
 }
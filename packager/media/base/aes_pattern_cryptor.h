@@ -5,6 +5,7 @@
 // https://developers.google.com/open-source/licenses/bsd
 
 #include <memory>
+#include <vector>
 
 #include <packager/macros/classes.h>
 #include <packager/media/base/aes_cryptor.h>
@@ -71,6 +72,8 @@ class AesPatternCryptor : public AesCryptor {
   const uint8_t skip_byte_block_;
   const PatternEncryptionMode encryption_mode_;
   std::unique_ptr<AesCryptor> cryptor_;
+  // Scratch buffer for the bytes to be crypted in a CryptInternal() call.
+  std::vector<uint8_t> crypt_blocks_;
 
   DISALLOW_COPY_AND_ASSIGN(AesPatternCryptor);
 };
@@ -47,6 +47,16 @@ TEST_F(AesPatternCryptorTest, InitializeWithIv) {
   EXPECT_EQ(iv, pattern_cryptor_.iv());
 }
 
+TEST_F(AesPatternCryptorTest, CryptsAllPatternsInOneCall) {
+  // Seven blocks: 2 crypt, 1 skip, 2 crypt, 1 skip, 1 crypt.
+  const std::vector<uint8_t> text(7 * 16, 1);
+  EXPECT_CALL(*mock_cryptor_, CryptInternal(_, 5 * 16u, _, _))
+      .WillOnce(Return(true));
+
+  std::vector<uint8_t> crypt_text;
+  ASSERT_TRUE(pattern_cryptor_.Crypt(text, &crypt_text));
+}
+
 struct PatternTestCase {
   const char* text_hex;
   const char* expected_crypt_text_hex;
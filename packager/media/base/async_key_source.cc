@@ -0,0 +1,90 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/async_key_source.h>
+
+#include <absl/log/check.h>
+
+#include <packager/macros/status.h>
+
+namespace shaka {
+namespace media {
+
+AsyncKeySource::AsyncKeySource(std::unique_ptr<KeySource> key_source,
+                               std::function<Status()> fetch_keys)
+    : key_source_(std::move(key_source)) {
+  DCHECK(key_source_);
+  fetch_thread_ = std::thread([this, fetch_keys]() {
+    const Status status = fetch_keys();
+    absl::MutexLock lock(&mutex_);
+    if (!done_) {
+      fetch_status_ = status;
+      done_ = true;
+    }
+  });
+}
+
+AsyncKeySource::~AsyncKeySource() {
+  // Nobody waits for a fetch still running, e.g. if the packaging failed to
+  // start.
+  bool done = false;
+  {
+    absl::MutexLock lock(&mutex_);
+    done = done_;
+  }
+  if (!done)
+    key_source_->Cancel();
+  fetch_thread_.join();
+}
+
+Status AsyncKeySource::FetchKeys(EmeInitDataType init_data_type,
+                                 const std::vector<uint8_t>& init_data) {
+  RETURN_IF_ERROR(WaitForKeys());
+  return key_source_->FetchKeys(init_data_type, init_data);
+}
+
+Status AsyncKeySource::GetKey(const std::string& stream_label,
+                              EncryptionKey* key) {
+  RETURN_IF_ERROR(WaitForKeys());
+  return key_source_->GetKey(stream_label, key);
+}
+
+Status AsyncKeySource::GetKey(const std::vector<uint8_t>& key_id,
+                              EncryptionKey* key) {
+  RETURN_IF_ERROR(WaitForKeys());
+  return key_source_->GetKey(key_id, key);
+}
+
+Status AsyncKeySource::GetCryptoPeriodKey(
+    uint32_t crypto_period_index,
+    int32_t crypto_period_duration_in_seconds,
+    const std::string& stream_label,
+    EncryptionKey* key) {
+  RETURN_IF_ERROR(WaitForKeys());
+  return key_source_->GetCryptoPeriodKey(
+      crypto_period_index, crypto_period_duration_in_seconds, stream_label,
+      key);
+}
+
+void AsyncKeySource::Cancel() {
+  key_source_->Cancel();
+  // The calls waiting for the keys fail right away, even if the fetch itself
+  // cannot be interrupted.
+  absl::MutexLock lock(&mutex_);
+  if (!done_) {
+    fetch_status_ = Status(error::CANCELLED, "Key fetch cancelled.");
+    done_ = true;
+  }
+}
+
+Status AsyncKeySource::WaitForKeys() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(&done_));
+  return fetch_status_;
+}
+
+}  // namespace media
+}  // namespace shaka
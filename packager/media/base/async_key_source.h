@@ -0,0 +1,71 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_ASYNC_KEY_SOURCE_H_
+#define PACKAGER_MEDIA_BASE_ASYNC_KEY_SOURCE_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+
+#include <packager/media/base/key_source.h>
+
+namespace shaka {
+namespace media {
+
+/// A key source which fetches the initial keys of another key source in the
+/// background, e.g. while the inputs are opened and probed. The calls which
+/// need keys wait for that fetch, and fail with its error if it failed.
+class AsyncKeySource : public KeySource {
+ public:
+  /// @param key_source is the key source the calls are forwarded to.
+  /// @param fetch_keys fetches the initial keys of @a key_source. It is run
+  ///        on a thread started by the constructor.
+  AsyncKeySource(std::unique_ptr<KeySource> key_source,
+                 std::function<Status()> fetch_keys);
+
+  /// Cancels the fetch if it is still running, and waits for it to complete.
+  ~AsyncKeySource() override;
+
+  /// @name KeySource implementation overrides.
+  /// @{
+  Status FetchKeys(EmeInitDataType init_data_type,
+                   const std::vector<uint8_t>& init_data) override;
+  Status GetKey(const std::string& stream_label, EncryptionKey* key) override;
+  Status GetKey(const std::vector<uint8_t>& key_id,
+                EncryptionKey* key) override;
+  Status GetCryptoPeriodKey(uint32_t crypto_period_index,
+                            int32_t crypto_period_duration_in_seconds,
+                            const std::string& stream_label,
+                            EncryptionKey* key) override;
+  void Cancel() override;
+  /// @}
+
+  /// Waits for the initial keys, or for Cancel().
+  /// @return the status of the fetch, or CANCELLED.
+  Status WaitForKeys();
+
+ private:
+  AsyncKeySource(const AsyncKeySource&) = delete;
+  AsyncKeySource& operator=(const AsyncKeySource&) = delete;
+
+  const std::unique_ptr<KeySource> key_source_;
+  absl::Mutex mutex_;
+  // Set once the fetch completes or is cancelled, with its status.
+  bool done_ ABSL_GUARDED_BY(mutex_) = false;
+  Status fetch_status_ ABSL_GUARDED_BY(mutex_);
+  std::thread fetch_thread_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_ASYNC_KEY_SOURCE_H_
@@ -0,0 +1,76 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/async_key_source.h>
+
+#include <atomic>
+
+#include <absl/synchronization/notification.h>
+#include <absl/time/clock.h>
+#include <gtest/gtest.h>
+
+#include <packager/media/base/raw_key_source.h>
+#include <packager/status/status_test_util.h>
+
+namespace shaka {
+namespace media {
+
+namespace {
+const char kDrmLabel[] = "SomeDrmLabel";
+const uint8_t kKeyId[] = {0x01, 0x01, 0x02, 0x03, 0x05, 0x08, 0x0d, 0x15,
+                          0x22, 0x37, 0x59, 0x90, 0xe9, 0x00, 0x00, 0x00};
+const uint8_t kKey[] = {0x00, 0x10, 0x01, 0x00, 0x20, 0x03, 0x00, 0x50,
+                        0x08, 0x01, 0x30, 0x21, 0x03, 0x40, 0x55, 0x00};
+
+std::unique_ptr<KeySource> CreateRawKeySource() {
+  RawKeyParams raw_key_params;
+  raw_key_params.key_map[kDrmLabel].key_id.assign(std::begin(kKeyId),
+                                                  std::end(kKeyId));
+  raw_key_params.key_map[kDrmLabel].key.assign(std::begin(kKey),
+                                               std::end(kKey));
+  return RawKeySource::Create(raw_key_params);
+}
+}  // namespace
+
+TEST(AsyncKeySourceTest, GetKeyWaitsForFetch) {
+  std::atomic<bool> fetched(false);
+  AsyncKeySource key_source(CreateRawKeySource(), [&fetched]() {
+    absl::SleepFor(absl::Milliseconds(50));
+    fetched = true;
+    return Status::OK;
+  });
+
+  EncryptionKey key;
+  ASSERT_OK(key_source.GetKey(kDrmLabel, &key));
+  EXPECT_TRUE(fetched);
+  EXPECT_EQ(std::vector<uint8_t>(std::begin(kKey), std::end(kKey)), key.key);
+}
+
+TEST(AsyncKeySourceTest, FetchFailure) {
+  const Status kError(error::SERVER_ERROR, "Fetch failed.");
+  AsyncKeySource key_source(CreateRawKeySource(),
+                            [&kError]() { return kError; });
+
+  EncryptionKey key;
+  EXPECT_EQ(kError, key_source.GetKey(kDrmLabel, &key));
+  EXPECT_EQ(kError, key_source.GetCryptoPeriodKey(0, 10, kDrmLabel, &key));
+}
+
+TEST(AsyncKeySourceTest, Cancel) {
+  absl::Notification release_fetch;
+  AsyncKeySource key_source(CreateRawKeySource(), [&release_fetch]() {
+    release_fetch.WaitForNotification();
+    return Status::OK;
+  });
+
+  key_source.Cancel();
+  EncryptionKey key;
+  EXPECT_EQ(error::CANCELLED, key_source.GetKey(kDrmLabel, &key).error_code());
+  release_fetch.Notify();
+}
+
+}  // namespace media
+}  // namespace shaka
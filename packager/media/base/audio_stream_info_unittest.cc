@@ -69,5 +69,29 @@ TEST(AudioStreamInfo, IamfGetCodecStringForBaseProfilesAndPcm) {
   EXPECT_EQ("iamf.001.001.ipcm", codec_string);
 }
 
+TEST(AudioStreamInfo, CodecContextIsSharedByCopies) {
+  const uint8_t kCodecConfig[] = {0x12, 0x10};
+  AudioStreamInfo stream_info(1, 44100, 0, kCodecAAC, "mp4a.40.2",
+                              kCodecConfig, sizeof(kCodecConfig), 16, 2, 44100,
+                              0, 0, 0, 0, "und", false);
+  int num_created = 0;
+  auto create = [&num_created]() {
+    ++num_created;
+    return std::unique_ptr<int>(new int(num_created));
+  };
+
+  std::shared_ptr<const int> context = stream_info.GetCodecContext<int>(create);
+  ASSERT_TRUE(context);
+  EXPECT_EQ(1, *context);
+  std::unique_ptr<StreamInfo> copy = stream_info.Clone();
+  EXPECT_EQ(context, copy->GetCodecContext<int>(create));
+  EXPECT_EQ(1, num_created);
+
+  // The context depends on the codec configuration.
+  copy->set_codec_config(std::vector<uint8_t>(1, 0x12));
+  EXPECT_EQ(2, *copy->GetCodecContext<int>(create));
+  EXPECT_EQ(context, stream_info.GetCodecContext<int>(create));
+}
+
 }  // namespace media
 }  // namespace shaka
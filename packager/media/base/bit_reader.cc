@@ -4,111 +4,117 @@
 
 #include <packager/media/base/bit_reader.h>
 
-#include <algorithm>
-
+#include <absl/base/internal/endian.h>
 #include <absl/log/check.h>
 
 namespace shaka {
 namespace media {
 
 BitReader::BitReader(const uint8_t* data, size_t size)
-    : data_(data),
-      initial_size_(size),
-      bytes_left_(size),
-      num_remaining_bits_in_curr_byte_(0) {
-  DCHECK(data_ != NULL && bytes_left_ > 0);
-
-  UpdateCurrByte();
+    : data_(data), initial_size_(size), end_(data + size), next_(data) {
+  DCHECK(data_ != NULL && initial_size_ > 0);
 }
 
 BitReader::~BitReader() {}
 
 bool BitReader::SkipBits(size_t num_bits) {
-  // Skip any bits in the current byte waiting to be processed, then
-  // process full bytes until less than 8 bits remaining.
-  if (num_bits > num_remaining_bits_in_curr_byte_) {
-    num_bits -= num_remaining_bits_in_curr_byte_;
-    num_remaining_bits_in_curr_byte_ = 0;
-
-    size_t num_bytes = num_bits / 8;
+  if (num_bits > bits_available()) {
+    SetToEnd();
+    return false;
+  }
+  if (num_bits >= num_cached_bits_) {
+    // Skip the cached bits and the whole bytes after them, then read the
+    // remaining bits from the byte after them.
+    num_bits -= num_cached_bits_;
+    next_ += num_bits / 8;
     num_bits %= 8;
-    if (bytes_left_ < num_bytes) {
-      bytes_left_ = 0;
-      return false;
-    }
-    bytes_left_ -= num_bytes;
-    data_ += num_bytes;
-    UpdateCurrByte();
-
-    // If there is no more data remaining, only return true if we
-    // skipped all that were requested.
-    if (num_remaining_bits_in_curr_byte_ == 0)
-      return (num_bits == 0);
+    cache_ = 0;
+    num_cached_bits_ = 0;
+    if (num_bits == 0)
+      return true;
+    FillCache(num_bits);
   }
-
-  // Less than 8 bits remaining to skip. Use ReadBitsInternal to verify
-  // that the remaining bits we need exist, and adjust them as necessary
-  // for subsequent operations.
-  uint64_t not_needed;
-  return ReadBitsInternal(num_bits, &not_needed);
+  // Less than 64 bits as the cache does not hold more.
+  cache_ <<= num_bits;
+  num_cached_bits_ -= num_bits;
+  return true;
 }
 
 void BitReader::SkipToNextByte() {
-  // Already aligned.
-  if (num_remaining_bits_in_curr_byte_ == 8)
-    return;
-
-  num_remaining_bits_in_curr_byte_ = 0;
-  UpdateCurrByte();
+  // The bytes are loaded whole, so the bits of the current byte are the first
+  // ones in the cache.
+  const size_t num_bits = num_cached_bits_ % 8;
+  cache_ <<= num_bits;
+  num_cached_bits_ -= num_bits;
 }
 
 bool BitReader::SkipBytes(size_t num_bytes) {
   if (num_bytes == 0)
     return true;
-  if (num_remaining_bits_in_curr_byte_ != 8)
+  if (num_cached_bits_ % 8 != 0)
     return false;
-
-  data_ += num_bytes - 1;  // One additional byte in curr_byte_.
-  if (num_bytes > bytes_left_ + 1)
+  if (num_bytes > bits_available() / 8)
     return false;
-  bytes_left_ -= num_bytes - 1;
-  num_remaining_bits_in_curr_byte_ = 0;
-  UpdateCurrByte();
-  return true;
+  return SkipBits(num_bytes * 8);
 }
 
 bool BitReader::ReadBitsInternal(size_t num_bits, uint64_t* out) {
   DCHECK_LE(num_bits, 64u);
 
   *out = 0;
+  if (num_bits == 0)
+    return true;
+  if (num_bits > bits_available()) {
+    SetToEnd();
+    return false;
+  }
 
-  while (num_remaining_bits_in_curr_byte_ != 0 && num_bits != 0) {
-    size_t bits_to_take = std::min(num_remaining_bits_in_curr_byte_, num_bits);
-
-    *out <<= bits_to_take;
-    *out += curr_byte_ >> (num_remaining_bits_in_curr_byte_ - bits_to_take);
-    num_bits -= bits_to_take;
-    num_remaining_bits_in_curr_byte_ -= bits_to_take;
-    curr_byte_ &= (1 << num_remaining_bits_in_curr_byte_) - 1;
-
-    if (num_remaining_bits_in_curr_byte_ == 0)
-      UpdateCurrByte();
+  // The cache provides at most kMaxCachedReadBits bits at once.
+  if (num_bits > kMaxCachedReadBits) {
+    const size_t num_high_bits = num_bits - 32;
+    uint64_t high_bits = 0;
+    ReadBitsInternal(num_high_bits, &high_bits);
+    ReadBitsInternal(32, out);
+    *out |= high_bits << 32;
+    return true;
   }
 
-  return num_bits == 0;
+  if (num_cached_bits_ < num_bits)
+    FillCache(num_bits);
+  *out = cache_ >> (64 - num_bits);
+  cache_ <<= num_bits;
+  num_cached_bits_ -= num_bits;
+  return true;
 }
 
-void BitReader::UpdateCurrByte() {
-  DCHECK_EQ(num_remaining_bits_in_curr_byte_, 0u);
+bool BitReader::FillCache(size_t num_bits) {
+  DCHECK_LE(num_bits, kMaxCachedReadBits);
+
+  if (end_ - next_ >= 8) {
+    // Load 8 bytes at once and keep the whole bytes which fit after the
+    // cached bits. The bits of the partial byte, if any, are loaded again
+    // by the next fill.
+    cache_ |= absl::big_endian::Load64(next_) >> num_cached_bits_;
+    next_ += (63 - num_cached_bits_) >> 3;
+    num_cached_bits_ |= 56;
+    return true;
+  }
 
-  if (bytes_left_ == 0)
-    return;
+  while (num_cached_bits_ <= 56 && next_ != end_) {
+    cache_ |= static_cast<uint64_t>(*next_++) << (56 - num_cached_bits_);
+    num_cached_bits_ += 8;
+  }
+  if (num_cached_bits_ < num_bits) {
+    SetToEnd();
+    return false;
+  }
+  return true;
+}
 
-  // Load a new byte and advance pointers.
-  curr_byte_ = *data_;
-  ++data_;
-  --bytes_left_;
-  num_remaining_bits_in_curr_byte_ = 8;
+void BitReader::SetToEnd() {
+  next_ = end_;
+  cache_ = 0;
+  num_cached_bits_ = 0;
 }
 
 }  // namespace media
@@ -52,6 +52,22 @@ class BitReader {
     return ret;
   }
 
+  /// Read a fixed number of bits from stream, e.g. ReadBits<4>(&value). It
+  /// behaves like ReadBits(kNumBits, out) and is inlined.
+  /// @tparam kNumBits is the number of bits to read, from 1 to 56.
+  template <size_t kNumBits, typename T>
+  bool ReadBits(T* out) {
+    static_assert(kNumBits > 0 && kNumBits <= kMaxCachedReadBits,
+                  "Unsupported number of bits.");
+    static_assert(kNumBits <= sizeof(T) * 8, "The type is too small.");
+    if (num_cached_bits_ < kNumBits && !FillCache(kNumBits))
+      return false;
+    *out = static_cast<T>(cache_ >> (64 - kNumBits));
+    cache_ <<= kNumBits;
+    num_cached_bits_ -= kNumBits;
+    return true;
+  }
+
   /// Skip a number of bits from stream.
   /// @param num_bits specifies the number of bits to be skipped.
   /// @return false if the given number of bits cannot be skipped (not enough
@@ -90,39 +106,49 @@ class BitReader {
 
   /// @return The number of bits available for reading.
   size_t bits_available() const {
-    return 8 * bytes_left_ + num_remaining_bits_in_curr_byte_;
+    return 8 * static_cast<size_t>(end_ - next_) + num_cached_bits_;
   }
 
   /// @return The current bit position.
   size_t bit_position() const { return 8 * initial_size_ - bits_available(); }
 
-  /// @return A pointer to the current byte.
-  const uint8_t* current_byte_ptr() const { return data_ - 1; }
+  /// @return A pointer to the byte of the current bit position.
+  const uint8_t* current_byte_ptr() const { return data_ + bit_position() / 8; }
 
  private:
+  // The most bits read from |cache_| at once.
+  static constexpr size_t kMaxCachedReadBits = 56;
+
   // Help function used by ReadBits to avoid inlining the bit reading logic.
   bool ReadBitsInternal(size_t num_bits, uint64_t* out);
 
-  // Advance to the next byte, loading it into curr_byte_.
-  // If the num_remaining_bits_in_curr_byte_ is 0 after this function returns,
-  // the stream has reached the end.
-  void UpdateCurrByte();
+  // Load bytes into |cache_| until it holds at least |num_bits| bits, which is
+  // at most kMaxCachedReadBits. The stream reaches its end if there are not
+  // enough bits.
+  // @return true if |cache_| holds |num_bits| bits.
+  bool FillCache(size_t num_bits);
+
+  // Discard all the bits, so that further reads fail.
+  void SetToEnd();
 
-  // Pointer to the next unread (not in curr_byte_) byte in the stream.
-  const uint8_t* data_;
+  // The beginning of the stream.
+  const uint8_t* const data_;
 
   // Initial size of the input data.
-  size_t initial_size_;
+  const size_t initial_size_;
+
+  // The end of the stream.
+  const uint8_t* const end_;
 
-  // Bytes left in the stream (without the curr_byte_).
-  size_t bytes_left_;
+  // The next byte not loaded in |cache_|.
+  const uint8_t* next_;
 
-  // Contents of the current byte; first unread bit starting at position
-  // 8 - num_remaining_bits_in_curr_byte_ from MSB.
-  uint8_t curr_byte_;
+  // The next |num_cached_bits_| bits of the stream, from the MSB. The bits
+  // after them are either zeros or the bits following them in the stream.
+  uint64_t cache_ = 0;
 
-  // Number of bits remaining in curr_byte_
-  size_t num_remaining_bits_in_curr_byte_;
+  // Number of bits of the stream in |cache_|.
+  size_t num_cached_bits_ = 0;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(BitReader);
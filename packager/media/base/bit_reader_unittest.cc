@@ -48,6 +48,24 @@ TEST(BitReaderTest, ReadBeyondEndTest) {
   EXPECT_TRUE(reader1.ReadBits(0, &value8));
 }
 
+TEST(BitReaderTest, FixedWidthReadTest) {
+  uint8_t value8;
+  uint16_t value16;
+  uint64_t value64;
+  uint8_t buffer[] = {0x55, 0x99, 0x55, 0x99, 0x55, 0x99, 0x55, 0x99, 0x55};
+  BitReader reader(buffer, sizeof(buffer));
+
+  EXPECT_TRUE(reader.ReadBits<1>(&value8));
+  EXPECT_EQ(0, value8);
+  EXPECT_TRUE(reader.ReadBits<12>(&value16));
+  EXPECT_EQ(0xab3, value16);  // 1010 1011 0011
+  EXPECT_TRUE(reader.ReadBits<56>(&value64));
+  EXPECT_EQ(0x2ab32ab32ab32aull, value64);
+  EXPECT_EQ(3u, reader.bits_available());
+  EXPECT_FALSE(reader.ReadBits<4>(&value8));
+  EXPECT_EQ(0u, reader.bits_available());
+}
+
 TEST(BitReaderTest, SkipBitsTest) {
   uint8_t value8;
   uint8_t buffer[] = {0x0a, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
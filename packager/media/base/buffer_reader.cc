@@ -6,6 +6,7 @@
 
 #include <packager/media/base/buffer_reader.h>
 
+#include <absl/base/internal/endian.h>
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 
@@ -45,6 +46,18 @@ bool BufferReader::ReadNBytesInto8s(int64_t* v, size_t num_bytes) {
   return ReadNBytes(v, num_bytes);
 }
 
+bool BufferReader::Read4Array(uint32_t* values, size_t count) {
+  DCHECK(values != NULL || count == 0);
+  if (count > (size() - pos()) / sizeof(uint32_t))
+    return false;
+  // A loop of plain loads, which compilers turn into vector byte swaps.
+  const uint8_t* data = buf_ + pos_;
+  for (size_t i = 0; i < count; ++i)
+    values[i] = absl::big_endian::Load32(data + i * sizeof(uint32_t));
+  pos_ += count * sizeof(uint32_t);
+  return true;
+}
+
 bool BufferReader::ReadToVector(std::vector<uint8_t>* vec, size_t count) {
   DCHECK(vec != NULL);
   if (!HasBytes(count))
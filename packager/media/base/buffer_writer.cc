@@ -6,11 +6,14 @@
 
 #include <packager/media/base/buffer_writer.h>
 
+#include <algorithm>
+
 #include <absl/base/internal/endian.h>
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 
 #include <packager/file.h>
+#include <packager/utils/huge_pages.h>
 
 namespace shaka {
 namespace media {
@@ -46,6 +49,14 @@ void BufferWriter::AppendInt(int64_t v) {
   AppendInternal(absl::big_endian::FromHost64(v));
 }
 
+void BufferWriter::AppendInts(const uint32_t* values, size_t count) {
+  const size_t pos = buf_.size();
+  buf_.resize(pos + count * sizeof(uint32_t));
+  uint8_t* data = buf_.data() + pos;
+  for (size_t i = 0; i < count; ++i)
+    absl::big_endian::Store32(data + i * sizeof(uint32_t), values[i]);
+}
+
 void BufferWriter::AppendNBytes(uint64_t v, size_t num_bytes) {
   DCHECK_GE(sizeof(v), num_bytes);
   v = absl::big_endian::FromHost64(v);
@@ -54,18 +65,22 @@ void BufferWriter::AppendNBytes(uint64_t v, size_t num_bytes) {
 }
 
 void BufferWriter::AppendVector(const std::vector<uint8_t>& v) {
+  Grow(v.size());
   buf_.insert(buf_.end(), v.begin(), v.end());
 }
 
 void BufferWriter::AppendString(const std::string& s) {
+  Grow(s.size());
   buf_.insert(buf_.end(), s.begin(), s.end());
 }
 
 void BufferWriter::AppendArray(const uint8_t* buf, size_t size) {
+  Grow(size);
   buf_.insert(buf_.end(), buf, buf + size);
 }
 
 void BufferWriter::AppendBuffer(const BufferWriter& buffer) {
+  Grow(buffer.Size());
   buf_.insert(buf_.end(), buffer.buf_.begin(), buffer.buf_.end());
 }
 
@@ -88,6 +103,22 @@ Status BufferWriter::WriteToFile(File* file) {
   return Status::OK;
 }
 
+void BufferWriter::Grow(size_t size) {
+  const size_t needed = buf_.size() + size;
+  if (!use_huge_pages_ || needed <= buf_.capacity() ||
+      needed < HugePages::kHugePageSize) {
+    return;
+  }
+  // Grow geometrically like the vector would, but advise the new buffer
+  // before the contents are copied into it, so that the kernel backs it with
+  // huge pages from the first write.
+  std::vector<uint8_t> grown;
+  grown.reserve(std::max(needed, 2 * buf_.capacity()));
+  HugePages::Advise(grown.data(), grown.capacity());
+  grown.assign(buf_.begin(), buf_.end());
+  buf_.swap(grown);
+}
+
 template <typename T>
 void BufferWriter::AppendInternal(T v) {
   AppendArray(reinterpret_cast<uint8_t*>(&v), sizeof(T));
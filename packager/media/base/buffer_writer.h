@@ -7,6 +7,7 @@
 #ifndef PACKAGER_MEDIA_BASE_BUFFER_WRITER_H_
 #define PACKAGER_MEDIA_BASE_BUFFER_WRITER_H_
 
+#include <algorithm>
 #include <cstdint>
 #include <vector>
 
@@ -43,6 +44,10 @@ class BufferWriter {
   void AppendInt(int64_t v);
   /// @}
 
+  /// Append @a count 4-byte integers at once, in network byte order. Faster
+  /// than appending them one by one, e.g. for the sample tables.
+  void AppendInts(const uint32_t* values, size_t count);
+
   /// Append the least significant @a num_bytes of @a v to buffer.
   /// @param num_bytes should not be larger than sizeof(@a v), i.e. 8 on a
   ///        64-bit system.
@@ -56,8 +61,25 @@ class BufferWriter {
   void Swap(BufferWriter* buffer) { buf_.swap(buffer->buf_); }
   void SwapBuffer(std::vector<uint8_t>* buffer) { buf_.swap(*buffer); }
 
+  /// Make room for @a size more bytes, so that appending them does not
+  /// reallocate the buffer. The buffer grows geometrically, so that
+  /// reserving repeatedly while appending stays linear.
+  void Reserve(size_t size) {
+    Grow(size);
+    const size_t needed = buf_.size() + size;
+    if (needed > buf_.capacity())
+      buf_.reserve(std::max(needed, 2 * buf_.capacity()));
+  }
+
+  /// Back the buffer with transparent huge pages once it grows past a huge
+  /// page, if enabled, see HugePages. Meant for the large buffers which are
+  /// reused, e.g. the fragment buffers.
+  void UseHugePages() { use_huge_pages_ = true; }
+
   void Clear() { buf_.clear(); }
   size_t Size() const { return buf_.size(); }
+  /// @return The number of bytes allocated for the buffer.
+  size_t Capacity() const { return buf_.capacity(); }
   /// @return Underlying buffer. Behavior is undefined if the buffer size is 0.
   const uint8_t* Buffer() const { return buf_.data(); }
 
@@ -72,7 +94,12 @@ class BufferWriter {
   template <typename T>
   void AppendInternal(T v);
 
+  // Make room for |size| more bytes, advising huge pages for the new buffer
+  // if |use_huge_pages_|.
+  void Grow(size_t size);
+
   std::vector<uint8_t> buf_;
+  bool use_huge_pages_ = false;
 
   DISALLOW_COPY_AND_ASSIGN(BufferWriter);
 };
@@ -6,9 +6,12 @@
 
 #include <packager/media/base/buffer_writer.h>
 
+#include <algorithm>
 #include <filesystem>
+#include <iterator>
 #include <limits>
 #include <memory>
+#include <vector>
 
 #include <absl/log/log.h>
 
@@ -17,6 +20,7 @@
 #include <packager/macros/classes.h>
 #include <packager/media/base/buffer_reader.h>
 #include <packager/status/status_test_util.h>
+#include <packager/utils/huge_pages.h>
 
 namespace {
 const int kReservedBufferCapacity = 1000;
@@ -97,6 +101,24 @@ TEST_F(BufferWriterTest, AppendNBytes) {
   ReadAndExpect(static_cast<uint32_t>(kuint64 & 0xFFFFFFFF));
 }
 
+TEST_F(BufferWriterTest, AppendInts) {
+  const uint32_t kValues[] = {0, 1, 0x01020304, kuint32,
+                              std::numeric_limits<uint32_t>::max()};
+  writer_->AppendInts(kValues, std::size(kValues));
+  ASSERT_EQ(sizeof(kValues), writer_->Size());
+  EXPECT_EQ(0x01, writer_->Buffer()[8]);
+  EXPECT_EQ(0x04, writer_->Buffer()[11]);
+
+  CreateReader();
+  uint32_t values[std::size(kValues)];
+  ASSERT_TRUE(reader_->Read4Array(values, std::size(values)));
+  for (size_t i = 0; i < std::size(kValues); ++i)
+    EXPECT_EQ(kValues[i], values[i]);
+  // There are no more values to read.
+  EXPECT_FALSE(reader_->Read4Array(values, 1));
+  EXPECT_TRUE(reader_->Read4Array(values, 0));
+}
+
 TEST_F(BufferWriterTest, AppendEmptyVector) {
   std::vector<uint8_t> v;
   writer_->AppendVector(v);
@@ -174,6 +196,43 @@ TEST_F(BufferWriterTest, Clear) {
   ASSERT_EQ(0u, writer_->Size());
 }
 
+TEST_F(BufferWriterTest, ReserveGrowsGeometrically) {
+  BufferWriter writer(0);
+  writer.Reserve(100);
+  EXPECT_GE(writer.Capacity(), 100u);
+
+  // Reserving a little more at a time does not reallocate every time.
+  size_t num_reallocations = 0;
+  for (int i = 0; i < 1000; ++i) {
+    const size_t capacity = writer.Capacity();
+    writer.Reserve(sizeof(kuint8Array));
+    writer.AppendArray(kuint8Array, sizeof(kuint8Array));
+    if (writer.Capacity() != capacity)
+      ++num_reallocations;
+  }
+  EXPECT_LT(num_reallocations, 10u);
+}
+
+TEST_F(BufferWriterTest, UseHugePages) {
+  HugePages::SetMode(HugePages::Mode::kTransparent);
+  writer_->UseHugePages();
+
+  // Grow the buffer past a few huge pages, one chunk at a time.
+  std::vector<uint8_t> chunk(HugePages::kHugePageSize / 3);
+  std::vector<uint8_t> expected;
+  for (int i = 0; i < 10; ++i) {
+    std::fill(chunk.begin(), chunk.end(), static_cast<uint8_t>(i));
+    writer_->AppendVector(chunk);
+    expected.insert(expected.end(), chunk.begin(), chunk.end());
+  }
+  HugePages::SetMode(HugePages::Mode::kNone);
+
+  ASSERT_EQ(expected.size(), writer_->Size());
+  EXPECT_EQ(expected,
+            std::vector<uint8_t>(writer_->Buffer(),
+                                 writer_->Buffer() + writer_->Size()));
+}
+
 TEST_F(BufferWriterTest, WriteToFile) {
   TempFile temp_file;
   LOG(INFO) << "Created temporary file: " << temp_file.path();
@@ -14,7 +14,7 @@ namespace media {
 enum { kDefaultQueueSize = 1024 };
 
 ByteQueue::ByteQueue()
-    : buffer_(new uint8_t[kDefaultQueueSize]),
+    : buffer_(new uint8_t[kDefaultQueueSize], std::default_delete<uint8_t[]>()),
       size_(kDefaultQueueSize),
       offset_(0),
       used_(0) {
@@ -25,6 +25,9 @@ ByteQueue::~ByteQueue() {}
 void ByteQueue::Reset() {
   offset_ = 0;
   used_ = 0;
+  // The start of the buffer is about to be overwritten.
+  if (IsShared())
+    Reallocate(size_);
 }
 
 void ByteQueue::Push(const uint8_t* data, int size) {
@@ -32,28 +35,27 @@ void ByteQueue::Push(const uint8_t* data, int size) {
 
   size_t size_needed = used_ + size;
 
-  // Check to see if we need a bigger buffer.
-  if (size_needed > size_) {
-    size_t new_size = 2 * size_;
-    while (size_needed > new_size && new_size > size_)
-      new_size *= 2;
-
-    // Sanity check to make sure we didn't overflow.
-    CHECK_GT(new_size, size_);
-
-    std::unique_ptr<uint8_t[]> new_buffer(new uint8_t[new_size]);
-
-    // Copy the data from the old buffer to the start of the new one.
-    if (used_ > 0)
-      memcpy(new_buffer.get(), front(), used_);
-
-    buffer_.reset(new_buffer.release());
-    size_ = new_size;
-    offset_ = 0;
-  } else if ((offset_ + used_ + size) > size_) {
-    // The buffer is big enough, but we need to move the data in the queue.
-    memmove(buffer_.get(), front(), used_);
-    offset_ = 0;
+  if (offset_ + size_needed > size_) {
+    // Moving the queued bytes to the front of the buffer only pays off if they
+    // fill at most half of it: each move then frees at least as much room as
+    // it copies, so long-running queues, e.g. of partial PES packets, copy
+    // each byte at most once on average. Grow the buffer otherwise.
+    if (2 * size_needed > size_) {
+      size_t new_size = 2 * size_;
+      while (2 * size_needed > new_size && new_size > size_)
+        new_size *= 2;
+
+      // Sanity check to make sure we didn't overflow.
+      CHECK_GT(new_size, size_);
+
+      Reallocate(new_size);
+    } else if (IsShared()) {
+      // Shared bytes must not be moved, so copy to a new buffer instead.
+      Reallocate(size_);
+    } else {
+      memmove(buffer_.get(), front(), used_);
+      offset_ = 0;
+    }
   }
 
   memcpy(front() + used_, data, size);
@@ -73,16 +75,45 @@ void ByteQueue::Pop(int count) {
   offset_ += count;
   used_ -= count;
 
-  // Move the offset back to 0 if we have reached the end of the buffer.
-  if (offset_ == size_) {
-    DCHECK_EQ(used_, 0);
+  // Move the offset back to 0 when the queue is empty, which avoids moving
+  // bytes in Push(), unless the start of the buffer is still shared.
+  if (used_ == 0 && !IsShared()) {
     offset_ = 0;
+  } else if (offset_ == size_) {
+    DCHECK_EQ(used_, 0);
+    // The start of the buffer is about to be overwritten.
+    Reallocate(size_);
   }
 }
 
+std::shared_ptr<const uint8_t> ByteQueue::Share(const uint8_t* data) const {
+  DCHECK_GE(data, front());
+  DCHECK_LE(data, front() + used_);
+  // Aliasing constructor: shares ownership of the whole buffer.
+  return std::shared_ptr<const uint8_t>(buffer_, data);
+}
+
 uint8_t* ByteQueue::front() const {
   return buffer_.get() + offset_;
 }
 
+bool ByteQueue::IsShared() const {
+  return buffer_.use_count() > 1;
+}
+
+void ByteQueue::Reallocate(size_t new_size) {
+  DCHECK_GE(new_size, static_cast<size_t>(used_));
+  std::shared_ptr<uint8_t> new_buffer(new uint8_t[new_size],
+                                      std::default_delete<uint8_t[]>());
+
+  // Copy the data from the old buffer to the start of the new one.
+  if (used_ > 0)
+    memcpy(new_buffer.get(), front(), used_);
+
+  buffer_ = std::move(new_buffer);
+  size_ = new_size;
+  offset_ = 0;
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -17,7 +17,12 @@ namespace media {
 /// Data is added to the end of the queue via an Push() and removed via Pop().
 /// The contents of the queue can be observed via the Peek() method. This class
 /// manages the underlying storage of the queue and tries to minimize the
-/// number of buffer copies when data is appended and removed.
+/// number of buffer copies when data is appended and removed: the queued bytes
+/// are only moved within the buffer when they fill at most half of it, so
+/// that each byte is copied at most once on average.
+/// Queued bytes can also be shared without copying via Share(). The queue
+/// never modifies storage while it is shared; it switches to new storage
+/// instead (copy-on-write).
 class ByteQueue {
  public:
   ByteQueue();
@@ -37,11 +42,26 @@ class ByteQueue {
   /// @param count specifies number of bytes to be popped.
   void Pop(int count);
 
+  /// Get a reference counted pointer to queued bytes without copying them.
+  /// Unlike the pointer returned by Peek(), the returned pointer and the bytes
+  /// it points to remain valid after subsequent calls to Push(), Pop() and
+  /// Reset(), until it is released.
+  /// @param data points to a byte in the queue, i.e. in the range returned by
+  ///        Peek().
+  std::shared_ptr<const uint8_t> Share(const uint8_t* data) const;
+
  private:
   // Returns a pointer to the front of the queue.
   uint8_t* front() const;
 
-  std::unique_ptr<uint8_t[]> buffer_;
+  // @return true if |buffer_| is referenced by pointers returned from Share().
+  bool IsShared() const;
+
+  // Replace |buffer_| with a new buffer of |new_size| bytes, copying the
+  // queued bytes to its start.
+  void Reallocate(size_t new_size);
+
+  std::shared_ptr<uint8_t> buffer_;
 
   // Size of |buffer_|.
   size_t size_;
@@ -6,11 +6,37 @@
 
 #include <packager/media/base/cc_stream_filter.h>
 
+#include <absl/log/check.h>
+
+#include <packager/macros/status.h>
 #include <packager/media/base/stream_info.h>
 #include <packager/media/base/text_stream_info.h>
 
 namespace shaka {
 namespace media {
+namespace {
+
+// Overwrites the per-input-stream language with a per-output-stream language;
+// this requires cloning the stream info as it is used by other output streams.
+std::unique_ptr<StreamData> SetTextLanguage(const StreamData& stream_data,
+                                            const std::string& language,
+                                            uint16_t cc_index) {
+  auto clone = stream_data.stream_info->Clone();
+  if (!language.empty()) {
+    clone->set_language(language);
+  } else {
+    // Try to find the language in the sub-stream info.
+    auto* text_info = static_cast<TextStreamInfo*>(clone.get());
+    auto it = text_info->sub_streams().find(cc_index);
+    if (it != text_info->sub_streams().end()) {
+      clone->set_language(it->second.language);
+    }
+  }
+  return StreamData::FromStreamInfo(stream_data.stream_index,
+                                    std::move(clone));
+}
+
+}  // namespace
 
 CcStreamFilter::CcStreamFilter(const std::string& language, uint16_t cc_index)
     : language_(language), cc_index_(cc_index) {}
@@ -27,28 +53,68 @@ Status CcStreamFilter::Process(std::unique_ptr<StreamData> stream_data) {
     }
   } else if (stream_data->stream_data_type == StreamDataType::kStreamInfo) {
     if (stream_data->stream_info->stream_type() == kStreamText) {
-      // Overwrite the per-input-stream language with our per-output-stream
-      // language; this requires cloning the stream info as it is used by other
-      // output streams.
-      auto clone = stream_data->stream_info->Clone();
-      if (!language_.empty()) {
-        clone->set_language(language_);
-      } else {
-        // Try to find the language in the sub-stream info.
-        auto* text_info = static_cast<TextStreamInfo*>(clone.get());
-        auto it = text_info->sub_streams().find(cc_index_);
-        if (it != text_info->sub_streams().end()) {
-          clone->set_language(it->second.language);
-        }
-      }
-
-      stream_data = StreamData::FromStreamInfo(stream_data->stream_index,
-                                               std::move(clone));
+      stream_data = SetTextLanguage(*stream_data, language_, cc_index_);
     }
   }
 
   return Dispatch(std::move(stream_data));
 }
 
+Status CcStreamSplitter::AddOutput(const std::string& language,
+                                   uint16_t cc_index,
+                                   std::shared_ptr<MediaHandler> handler) {
+  const size_t stream_index = outputs_.size();
+  RETURN_IF_ERROR(SetHandler(stream_index, std::move(handler)));
+  outputs_.push_back({language, cc_index});
+  outputs_by_cc_index_[cc_index].push_back(stream_index);
+  return Status::OK;
+}
+
+Status CcStreamSplitter::InitializeInternal() {
+  return Status::OK;
+}
+
+Status CcStreamSplitter::Process(std::unique_ptr<StreamData> stream_data) {
+  if (stream_data->stream_data_type == StreamDataType::kTextSample &&
+      stream_data->text_sample->sub_stream_index() != -1) {
+    auto it = outputs_by_cc_index_.find(
+        static_cast<uint16_t>(stream_data->text_sample->sub_stream_index()));
+    if (it == outputs_by_cc_index_.end())
+      return Status::OK;
+    for (size_t stream_index : it->second) {
+      std::unique_ptr<StreamData> copy(new StreamData(*stream_data));
+      copy->stream_index = stream_index;
+      RETURN_IF_ERROR(Dispatch(std::move(copy)));
+    }
+    return Status::OK;
+  }
+
+  const bool is_text_info =
+      stream_data->stream_data_type == StreamDataType::kStreamInfo &&
+      stream_data->stream_info->stream_type() == kStreamText;
+  for (size_t stream_index = 0; stream_index < outputs_.size();
+       ++stream_index) {
+    const Output& output = outputs_[stream_index];
+    std::unique_ptr<StreamData> copy;
+    if (is_text_info) {
+      copy = SetTextLanguage(*stream_data, output.language, output.cc_index);
+    } else {
+      copy.reset(new StreamData(*stream_data));
+    }
+    copy->stream_index = stream_index;
+    RETURN_IF_ERROR(Dispatch(std::move(copy)));
+  }
+  return Status::OK;
+}
+
+bool CcStreamSplitter::ValidateOutputStreamIndex(size_t stream_index) const {
+  return stream_index < outputs_.size();
+}
+
+Status CcStreamSplitter::OnFlushRequest(size_t input_stream_index) {
+  DCHECK_EQ(input_stream_index, 0u);
+  return FlushAllDownstreams();
+}
+
 }  // namespace media
 }  // namespace shaka
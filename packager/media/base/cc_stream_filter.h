@@ -7,7 +7,9 @@
 #ifndef PACKAGER_MEDIA_BASE_CC_STREAM_FILTER_H_
 #define PACKAGER_MEDIA_BASE_CC_STREAM_FILTER_H_
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include <packager/media/base/media_handler.h>
 #include <packager/media/base/text_sample.h>
@@ -33,6 +35,45 @@ class CcStreamFilter : public MediaHandler {
   const uint16_t cc_index_;
 };
 
+/// Splits the channels of a text stream among many outputs in one pass, in
+/// place of a replicator followed by a CcStreamFilter per output. Each text
+/// sample is only dispatched to the outputs of its channel, so the outputs do
+/// not each receive and drop the samples of the other channels.
+class CcStreamSplitter : public MediaHandler {
+ public:
+  CcStreamSplitter() = default;
+  ~CcStreamSplitter() override = default;
+
+  /// Adds an output for a channel of the stream.
+  /// @param language overrides the language of the stream if not empty, as
+  ///        for CcStreamFilter.
+  /// @param cc_index is the channel of the output.
+  /// @param handler is the downstream handler of the output.
+  /// @return OK on success.
+  Status AddOutput(const std::string& language,
+                   uint16_t cc_index,
+                   std::shared_ptr<MediaHandler> handler);
+
+ protected:
+  Status InitializeInternal() override;
+  Status Process(std::unique_ptr<StreamData> stream_data) override;
+  bool ValidateOutputStreamIndex(size_t stream_index) const override;
+  Status OnFlushRequest(size_t input_stream_index) override;
+
+ private:
+  CcStreamSplitter(const CcStreamSplitter&) = delete;
+  CcStreamSplitter& operator=(const CcStreamSplitter&) = delete;
+
+  struct Output {
+    std::string language;
+    uint16_t cc_index;
+  };
+
+  std::vector<Output> outputs_;
+  // The output stream indices of each channel.
+  std::map<uint16_t, std::vector<size_t>> outputs_by_cc_index_;
+};
+
 }  // namespace media
 }  // namespace shaka
 
@@ -1664,19 +1664,72 @@ bool CheckTtml(const uint8_t* buffer, int buffer_size) {
   return root_node_name == "tt";
 }
 
+// The leading bytes of the containers supported for packaging.
+struct ContainerSignature {
+  const char* signature;
+  size_t signature_size;
+  // Offset of the signature in the buffer.
+  int offset;
+  MediaContainerName container;
+  // Confirms the container if the signature alone is not conclusive. May be
+  // null.
+  bool (*check)(const uint8_t* buffer, int buffer_size);
+};
+
+#define SIGNATURE(signature, offset, container, check) \
+  { (signature), sizeof(signature) - 1, (offset), (container), (check) }
+
+const ContainerSignature kContainerSignatures[] = {
+    SIGNATURE("ftyp", 4, CONTAINER_MOV, CheckMov),
+    SIGNATURE("styp", 4, CONTAINER_MOV, CheckMov),
+    SIGNATURE("moov", 4, CONTAINER_MOV, CheckMov),
+    SIGNATURE("moof", 4, CONTAINER_MOV, CheckMov),
+    SIGNATURE("sidx", 4, CONTAINER_MOV, CheckMov),
+    SIGNATURE("\x1a\x45\xdf\xa3", 0, CONTAINER_WEBM, CheckWebm),
+    SIGNATURE("\x47", 0, CONTAINER_MPEG2TS, CheckMpeg2TransportStream),
+    SIGNATURE("\x00\x00\x01\xba", 0, CONTAINER_MPEG2PS, nullptr),
+    SIGNATURE(UTF8_BYTE_ORDER_MARK "WEBVTT", 0, CONTAINER_WEBVTT, nullptr),
+    SIGNATURE("WEBVTT", 0, CONTAINER_WEBVTT, nullptr),
+    SIGNATURE("<?xml", 0, CONTAINER_TTML, CheckTtml),
+};
+
+#undef SIGNATURE
+
+// Recognizes the containers supported for packaging from their leading bytes,
+// so that the probes scanning the buffer only run for the other inputs.
+MediaContainerName LookupContainerBySignature(const uint8_t* buffer,
+                                              int buffer_size) {
+  for (const ContainerSignature& entry : kContainerSignatures) {
+    if (buffer_size < entry.offset ||
+        !StartsWith(buffer + entry.offset, buffer_size - entry.offset,
+                    reinterpret_cast<const uint8_t*>(entry.signature),
+                    entry.signature_size)) {
+      continue;
+    }
+    if (!entry.check || entry.check(buffer, buffer_size))
+      return entry.container;
+  }
+  return CONTAINER_UNKNOWN;
+}
+
 }  // namespace
 
 // Attempt to determine the container name from the buffer provided.
 MediaContainerName DetermineContainer(const uint8_t* buffer, int buffer_size) {
   DCHECK(buffer);
 
+  // Most inputs are in one of the containers supported for packaging.
+  MediaContainerName result = LookupContainerBySignature(buffer, buffer_size);
+  if (result != CONTAINER_UNKNOWN)
+    return result;
+
   // Since MOV/QuickTime/MPEG4 streams are common, check for them first.
   if (CheckMov(buffer, buffer_size))
     return CONTAINER_MOV;
 
   // Next attempt the simple checks, that typically look at just the
   // first few bytes of the file.
-  MediaContainerName result = LookupContainerByFirst4(buffer, buffer_size);
+  result = LookupContainerByFirst4(buffer, buffer_size);
   if (result != CONTAINER_UNKNOWN)
     return result;
 
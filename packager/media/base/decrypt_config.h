@@ -5,12 +5,14 @@
 #ifndef PACKAGER_MEDIA_BASE_DECRYPT_CONFIG_H_
 #define PACKAGER_MEDIA_BASE_DECRYPT_CONFIG_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
 
 #include <packager/macros/classes.h>
 #include <packager/media/base/fourccs.h>
+#include <packager/media/base/small_object_pool.h>
 
 namespace shaka {
 namespace media {
@@ -34,6 +36,17 @@ struct SubsampleEntry {
   uint32_t cipher_bytes;
 };
 
+/// A range of a frame which is left clear followed by a range which can be
+/// encrypted, as parsed from the bitstream. Unlike SubsampleEntry, the ranges
+/// are not yet adjusted for a protection scheme, e.g. aligned to AES blocks.
+struct SubsampleRange {
+  size_t clear_bytes = 0;
+  size_t cipher_bytes = 0;
+};
+
+/// The subsample ranges of a frame, in order.
+typedef std::vector<SubsampleRange> SubsampleLayout;
+
 /// Contains all the information that a decryptor needs to decrypt a media
 /// sample.
 class DecryptConfig {
@@ -72,6 +85,13 @@ class DecryptConfig {
 
   ~DecryptConfig();
 
+  static void* operator new(size_t size) {
+    return SmallObjectPool::Allocate(size);
+  }
+  static void operator delete(void* ptr, size_t size) {
+    SmallObjectPool::Free(ptr, size);
+  }
+
   /// @param clear_bytes is the size of clear bytes in the subsample to be
   ///        added.
   /// @param cipher_bytes is the size of cipher bytes in the subsample to be
@@ -46,20 +46,34 @@ bool DecryptorSource::DecryptSampleBuffer(const DecryptConfig* decrypt_config,
     return false;
   }
 
-  // Get the decryptor object.
+  AesCryptor* decryptor = GetDecryptor(*decrypt_config);
+  if (!decryptor)
+    return false;
+
+  if (!decryptor->CryptSubsamples(encrypted_buffer, buffer_size,
+                                  decrypt_config->subsamples(),
+                                  decrypted_buffer)) {
+    LOG(ERROR) << "Error during sample decryption.";
+    return false;
+  }
+  return true;
+}
+
+AesCryptor* DecryptorSource::GetDecryptor(
+    const DecryptConfig& decrypt_config) {
   AesCryptor* decryptor = nullptr;
-  auto found = decryptor_map_.find(decrypt_config->key_id());
+  auto found = decryptor_map_.find(decrypt_config.key_id());
   if (found == decryptor_map_.end()) {
     // Create new AesDecryptor based on decryption mode.
     EncryptionKey key;
-    Status status(key_source_->GetKey(decrypt_config->key_id(), &key));
+    Status status(key_source_->GetKey(decrypt_config.key_id(), &key));
     if (!status.ok()) {
       LOG(ERROR) << "Error retrieving decryption key: " << status;
-      return false;
+      return nullptr;
     }
 
     std::unique_ptr<AesCryptor> aes_decryptor;
-    switch (decrypt_config->protection_scheme()) {
+    switch (decrypt_config.protection_scheme()) {
       case FOURCC_cenc:
         aes_decryptor.reset(new AesCtrDecryptor);
         break;
@@ -68,71 +82,40 @@ bool DecryptorSource::DecryptSampleBuffer(const DecryptConfig* decrypt_config,
         break;
       case FOURCC_cens:
         aes_decryptor.reset(new AesPatternCryptor(
-            decrypt_config->crypt_byte_block(),
-            decrypt_config->skip_byte_block(),
+            decrypt_config.crypt_byte_block(),
+            decrypt_config.skip_byte_block(),
             AesPatternCryptor::kEncryptIfCryptByteBlockRemaining,
             AesCryptor::kDontUseConstantIv,
             std::unique_ptr<AesCryptor>(new AesCtrDecryptor())));
         break;
       case FOURCC_cbcs:
         aes_decryptor.reset(new AesPatternCryptor(
-            decrypt_config->crypt_byte_block(),
-            decrypt_config->skip_byte_block(),
+            decrypt_config.crypt_byte_block(),
+            decrypt_config.skip_byte_block(),
             AesPatternCryptor::kEncryptIfCryptByteBlockRemaining,
             AesCryptor::kUseConstantIv,
             std::unique_ptr<AesCryptor>(new AesCbcDecryptor(kNoPadding))));
         break;
       default:
         LOG(ERROR) << "Unsupported protection scheme: "
-                   << decrypt_config->protection_scheme();
-        return false;
+                   << decrypt_config.protection_scheme();
+        return nullptr;
     }
 
-    if (!aes_decryptor->InitializeWithIv(key.key, decrypt_config->iv())) {
+    if (!aes_decryptor->InitializeWithIv(key.key, decrypt_config.iv())) {
       LOG(ERROR) << "Failed to initialize AesDecryptor for decryption.";
-      return false;
+      return nullptr;
     }
     decryptor = aes_decryptor.get();
-    decryptor_map_[decrypt_config->key_id()] = std::move(aes_decryptor);
+    decryptor_map_[decrypt_config.key_id()] = std::move(aes_decryptor);
   } else {
     decryptor = found->second.get();
   }
-  if (!decryptor->SetIv(decrypt_config->iv())) {
+  if (!decryptor->SetIv(decrypt_config.iv())) {
     LOG(ERROR) << "Invalid initialization vector.";
-    return false;
+    return nullptr;
   }
-
-  if (decrypt_config->subsamples().empty()) {
-    // Sample not encrypted using subsample encryption. Decrypt whole.
-    if (!decryptor->Crypt(encrypted_buffer, buffer_size, decrypted_buffer)) {
-      LOG(ERROR) << "Error during bulk sample decryption.";
-      return false;
-    }
-    return true;
-  }
-
-  // Subsample decryption.
-  const std::vector<SubsampleEntry>& subsamples = decrypt_config->subsamples();
-  const uint8_t* current_ptr = encrypted_buffer;
-  const uint8_t* const buffer_end = encrypted_buffer + buffer_size;
-  for (const auto& subsample : subsamples) {
-    if ((current_ptr + subsample.clear_bytes + subsample.cipher_bytes) >
-        buffer_end) {
-      LOG(ERROR) << "Subsamples overflow sample buffer.";
-      return false;
-    }
-    memcpy(decrypted_buffer, current_ptr, subsample.clear_bytes);
-    current_ptr += subsample.clear_bytes;
-    decrypted_buffer += subsample.clear_bytes;
-    if (!decryptor->Crypt(current_ptr, subsample.cipher_bytes,
-                          decrypted_buffer)) {
-      LOG(ERROR) << "Error decrypting subsample buffer.";
-      return false;
-    }
-    current_ptr += subsample.cipher_bytes;
-    decrypted_buffer += subsample.cipher_bytes;
-  }
-  return true;
+  return decryptor;
 }
 
 }  // namespace media
@@ -41,6 +41,14 @@ class DecryptorSource {
                            size_t buffer_size,
                            uint8_t* decrypted_buffer);
 
+  /// Get the decryptor of a sample, e.g. to decrypt its subsamples one at a
+  /// time. Decryptors are cached by key ID.
+  /// @param decrypt_config contains decrypt configuration of the sample.
+  /// @return the decryptor, set up with the iv of the sample, or nullptr on
+  ///         failure. It is owned by this DecryptorSource and is only valid
+  ///         until the next call.
+  AesCryptor* GetDecryptor(const DecryptConfig& decrypt_config);
+
  private:
   KeySource* key_source_;
   std::map<std::vector<uint8_t>, std::unique_ptr<AesCryptor>> decryptor_map_;
@@ -6,6 +6,8 @@
 
 #include <packager/media/base/id3_tag.h>
 
+#include <algorithm>
+
 #include <absl/log/log.h>
 
 #include <packager/media/base/buffer_writer.h>
@@ -47,21 +49,59 @@ bool WriteId3v2Header(uint32_t frames_size, BufferWriter* buffer_writer) {
 
 }  // namespace
 
+// Implemented per http://id3.org/id3v2.4.0-frames 4.27.
 void Id3Tag::AddPrivateFrame(const std::string& owner,
                              const std::string& data) {
-  private_frames_.push_back({owner, data});
+  const uint32_t frame_size =
+      static_cast<uint32_t>(owner.size() + 1 + data.size());
+  if (frame_size > kMaxSynchsafeSize) {
+    LOG(ERROR) << "Input size (" << frame_size
+               << ") is out of range (> max synchsafe integer "
+               << kMaxSynchsafeSize << ").";
+    frames_valid_ = false;
+    return;
+  }
+
+  BufferWriter buffer_writer;
+  buffer_writer.AppendInt(static_cast<uint32_t>(FOURCC_PRIV));
+  buffer_writer.AppendInt(EncodeSynchsafe(frame_size));
+  const uint16_t flags = 0;
+  buffer_writer.AppendInt(flags);
+  buffer_writer.AppendString(owner);
+  uint8_t byte = 0;  // NULL terminating byte between owner and value.
+  buffer_writer.AppendInt(byte);
+
+  private_frames_.push_back(
+      {owner, frames_.size() + buffer_writer.Size(), data.size()});
+  frames_.insert(frames_.end(), buffer_writer.Buffer(),
+                 buffer_writer.Buffer() + buffer_writer.Size());
+  frames_.insert(frames_.end(), data.begin(), data.end());
 }
 
-bool Id3Tag::WriteToBuffer(BufferWriter* buffer_writer) {
-  BufferWriter frames_buffer;
+bool Id3Tag::SetPrivateFrameData(const std::string& owner,
+                                 const std::string& data) {
   for (const PrivateFrame& private_frame : private_frames_) {
-    if (!WritePrivateFrame(private_frame, &frames_buffer))
+    if (private_frame.owner != owner)
+      continue;
+    if (private_frame.data_size != data.size())
       return false;
+    std::copy(data.begin(), data.end(),
+              frames_.begin() + private_frame.data_offset);
+    return true;
   }
+  return false;
+}
+
+void Id3Tag::AddEncodedFrame(const std::vector<uint8_t>& frame) {
+  frames_.insert(frames_.end(), frame.begin(), frame.end());
+}
 
-  if (!WriteId3v2Header(frames_buffer.Size(), buffer_writer))
+bool Id3Tag::WriteToBuffer(BufferWriter* buffer_writer) {
+  if (!frames_valid_)
     return false;
-  buffer_writer->AppendBuffer(frames_buffer);
+  if (!WriteId3v2Header(frames_.size(), buffer_writer))
+    return false;
+  buffer_writer->AppendVector(frames_);
   return true;
 }
 
@@ -73,30 +113,5 @@ bool Id3Tag::WriteToVector(std::vector<uint8_t>* output) {
   return true;
 }
 
-// Implemented per http://id3.org/id3v2.4.0-frames 4.27.
-bool Id3Tag::WritePrivateFrame(const PrivateFrame& private_frame,
-                               BufferWriter* buffer_writer) {
-  buffer_writer->AppendInt(static_cast<uint32_t>(FOURCC_PRIV));
-
-  const uint32_t frame_size = static_cast<uint32_t>(
-      private_frame.owner.size() + 1 + private_frame.data.size());
-  if (frame_size > kMaxSynchsafeSize) {
-    LOG(ERROR) << "Input size (" << frame_size
-               << ") is out of range (> max synchsafe integer "
-               << kMaxSynchsafeSize << ").";
-    return false;
-  }
-  buffer_writer->AppendInt(EncodeSynchsafe(frame_size));
-
-  const uint16_t flags = 0;
-  buffer_writer->AppendInt(flags);
-
-  buffer_writer->AppendString(private_frame.owner);
-  uint8_t byte = 0;  // NULL terminating byte between owner and value.
-  buffer_writer->AppendInt(byte);
-  buffer_writer->AppendString(private_frame.data);
-  return true;
-}
-
 }  // namespace media
 }  // namespace shaka
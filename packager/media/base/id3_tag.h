@@ -17,7 +17,10 @@ namespace media {
 class BufferWriter;
 
 /// Implements ID3 tag defined in: http://id3.org/.
-/// Only PrivateFrame is supported right now.
+/// Only PrivateFrame is supported right now; other frames can be passed
+/// through already encoded. The frames are serialized as they are added, so
+/// that a tag written once per segment, e.g. with a timestamp, is only
+/// serialized once per stream and then patched.
 class Id3Tag {
  public:
   Id3Tag() = default;
@@ -31,6 +34,21 @@ class Id3Tag {
   virtual void AddPrivateFrame(const std::string& owner,
                                const std::string& data);
 
+  /// Replace the data of the first "Private Frame" of @a owner in place.
+  /// @owner contains the owner identifier.
+  /// @data contains the new data for this private frame. It must have the
+  ///       same size as the current data.
+  /// @return true on success, false if there is no private frame of @a owner
+  ///         with data of the same size.
+  // This function is made virtual for testing.
+  virtual bool SetPrivateFrameData(const std::string& owner,
+                                   const std::string& data);
+
+  /// Add an already encoded frame, e.g. from the timed metadata of the input,
+  /// which is written as is.
+  /// @frame contains the frame, including its frame header.
+  void AddEncodedFrame(const std::vector<uint8_t>& frame);
+
   /// Write the ID3 tag to a buffer.
   /// @param buffer_writer points to the @a BufferWriter to write to.
   /// @return true on success.
@@ -49,13 +67,16 @@ class Id3Tag {
 
   struct PrivateFrame {
     std::string owner;
-    std::string data;
+    // The position of the data in |frames_|.
+    size_t data_offset;
+    size_t data_size;
   };
 
-  bool WritePrivateFrame(const PrivateFrame& private_frame,
-                         BufferWriter* buffer_writer);
-
   std::vector<PrivateFrame> private_frames_;
+  // The serialized frames.
+  std::vector<uint8_t> frames_;
+  // Whether all the frames could be serialized.
+  bool frames_valid_ = true;
 };
 
 }  // namespace media
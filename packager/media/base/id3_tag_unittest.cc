@@ -102,6 +102,51 @@ TEST(Id3TagTest, AddBigPrivateFrameOnce) {
   EXPECT_EQ(expected_output, output);
 }
 
+TEST(Id3TagTest, SetPrivateFrameData) {
+  Id3Tag id3_tag;
+  id3_tag.AddPrivateFrame("testing.owner1", "data1");
+  id3_tag.AddPrivateFrame("testing.owner2", "data2");
+
+  std::vector<uint8_t> output;
+  id3_tag.WriteToVector(&output);
+
+  EXPECT_TRUE(id3_tag.SetPrivateFrameData("testing.owner1", "DATA1"));
+  // The data must keep its size.
+  EXPECT_FALSE(id3_tag.SetPrivateFrameData("testing.owner2", "data"));
+  EXPECT_FALSE(id3_tag.SetPrivateFrameData("testing.owner3", "data3"));
+  id3_tag.WriteToVector(&output);
+
+  const uint8_t kExpectedOutput[] = {
+      'I', 'D', '3', 4,   0,   0,   0,   0,   0,   60,  // Header
+      'P', 'R', 'I', 'V', 0,   0,   0,   20,  0,   0,  't', 'e', 's', 't', 'i',
+      'n', 'g', '.', 'o', 'w', 'n', 'e', 'r', '1', 0,  'D', 'A', 'T', 'A', '1',
+      'P', 'R', 'I', 'V', 0,   0,   0,   20,  0,   0,  't', 'e', 's', 't', 'i',
+      'n', 'g', '.', 'o', 'w', 'n', 'e', 'r', '2', 0,  'd', 'a', 't', 'a', '2',
+  };
+  EXPECT_THAT(output, ElementsAreArray(kExpectedOutput));
+}
+
+TEST(Id3TagTest, AddEncodedFrame) {
+  const std::vector<uint8_t> kEncodedFrame = {
+      'T', 'X', 'X', 'X', 0, 0, 0, 3, 0, 0, 3, 'a', 0,
+  };
+
+  Id3Tag id3_tag;
+  id3_tag.AddPrivateFrame("owner", "data");
+  id3_tag.AddEncodedFrame(kEncodedFrame);
+
+  std::vector<uint8_t> output;
+  id3_tag.WriteToVector(&output);
+
+  const uint8_t kExpectedOutput[] = {
+      'I', 'D', '3', 4,   0,   0,   0,   0,   0,   33,  // Header
+      'P', 'R', 'I', 'V', 0,   0,   0,   10,  0,   0,   'o', 'w', 'n',
+      'e', 'r', 0,   'd', 'a', 't', 'a', 'T', 'X', 'X', 'X', 0,   0,
+      0,   3,   0,   0,   3,   'a', 0,
+  };
+  EXPECT_THAT(output, ElementsAreArray(kExpectedOutput));
+}
+
 }  // namespace media
 
 }  // namespace shaka
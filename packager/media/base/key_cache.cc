@@ -0,0 +1,214 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/key_cache.h>
+
+#include <filesystem>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <absl/strings/escaping.h>
+#include <mbedtls/md.h>
+
+#include <packager/file.h>
+#include <packager/macros/logging.h>
+#include <packager/media/base/aes_decryptor.h>
+#include <packager/media/base/aes_encryptor.h>
+#include <packager/media/base/buffer_reader.h>
+#include <packager/media/base/buffer_writer.h>
+#include <packager/media/base/fourccs.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const size_t kEncryptionKeySize = 16;
+const size_t kIvSize = 16;
+const char kEntryFileExtension[] = ".key_cache";
+// Derives the key which authenticates the entries from the encryption key.
+const char kMacKeyLabel[] = "shaka-packager key cache mac";
+
+std::string Sha256(const std::string& data) {
+  const mbedtls_md_info_t* md_info =
+      mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+  DCHECK(md_info);
+
+  std::string hash(mbedtls_md_get_size(md_info), 0);
+  CHECK_EQ(0, mbedtls_md(md_info, reinterpret_cast<const uint8_t*>(data.data()),
+                         data.size(), reinterpret_cast<uint8_t*>(hash.data())));
+  return hash;
+}
+
+std::string HmacSha256(const std::string& key, const std::string& data) {
+  const mbedtls_md_info_t* md_info =
+      mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+  DCHECK(md_info);
+
+  std::string mac(mbedtls_md_get_size(md_info), 0);
+  CHECK_EQ(0, mbedtls_md_hmac(
+                  md_info, reinterpret_cast<const uint8_t*>(key.data()),
+                  key.size(), reinterpret_cast<const uint8_t*>(data.data()),
+                  data.size(), reinterpret_cast<uint8_t*>(mac.data())));
+  return mac;
+}
+
+// Compares in constant time, so that the time taken does not reveal how much
+// of a forged MAC is right.
+bool ConstantTimeEquals(const std::string& a, const std::string& b) {
+  if (a.size() != b.size())
+    return false;
+  uint8_t diff = 0;
+  for (size_t i = 0; i < a.size(); ++i)
+    diff |= static_cast<uint8_t>(a[i] ^ b[i]);
+  return diff == 0;
+}
+
+int64_t ToSeconds(Clock::time_point time) {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             time.time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+KeyCache::KeyCache(std::chrono::seconds ttl,
+                   const std::string& directory,
+                   const std::vector<uint8_t>& encryption_key)
+    : ttl_(ttl),
+      directory_(directory),
+      encryption_key_(encryption_key),
+      clock_(new Clock) {
+  DCHECK(directory_.empty() || encryption_key_.size() == kEncryptionKeySize);
+  if (!directory_.empty()) {
+    mac_key_ = HmacSha256(
+        std::string(encryption_key_.begin(), encryption_key_.end()),
+        kMacKeyLabel);
+  }
+}
+
+KeyCache::~KeyCache() {}
+
+bool KeyCache::Get(const std::string& request, std::string* response) {
+  DCHECK(response);
+  const std::string request_hash = Sha256(request);
+  const Clock::time_point now = clock_->now();
+
+  absl::MutexLock lock(&mutex_);
+  auto iter = entries_.find(request_hash);
+  if (iter == entries_.end()) {
+    Entry entry;
+    if (!ReadEntry(request_hash, &entry))
+      return false;
+    iter = entries_.emplace(request_hash, std::move(entry)).first;
+  }
+  if (iter->second.expiration <= now) {
+    entries_.erase(iter);
+    return false;
+  }
+  *response = iter->second.response;
+  return true;
+}
+
+void KeyCache::Put(const std::string& request, const std::string& response) {
+  const std::string request_hash = Sha256(request);
+  Entry entry;
+  entry.response = response;
+  entry.expiration = clock_->now() + ttl_;
+
+  absl::MutexLock lock(&mutex_);
+  WriteEntry(request_hash, entry);
+  entries_[request_hash] = std::move(entry);
+}
+
+std::string KeyCache::GetEntryPath(const std::string& request_hash) const {
+  return (std::filesystem::u8path(directory_) /
+          (absl::BytesToHexString(request_hash) + kEntryFileExtension))
+      .string();
+}
+
+// A persisted entry is a random IV, followed by the encryption of the request
+// hash, the expiration time in seconds since the epoch and the response,
+// followed by the HMAC-SHA256 of the IV and the ciphertext. The MAC is
+// verified before anything is decrypted or parsed. The request hash makes
+// sure that the entry is not the one of another request.
+bool KeyCache::ReadEntry(const std::string& request_hash, Entry* entry) const {
+  if (directory_.empty())
+    return false;
+  const std::string path = GetEntryPath(request_hash);
+  std::string contents;
+  if (!File::ReadFileToString(path.c_str(), &contents))
+    return false;
+
+  const size_t mac_size = mac_key_.size();
+  if (contents.size() < kIvSize + mac_size ||
+      !ConstantTimeEquals(
+          HmacSha256(mac_key_, contents.substr(0, contents.size() - mac_size)),
+          contents.substr(contents.size() - mac_size))) {
+    LOG(WARNING) << "Ignoring unauthenticated key cache entry '" << path
+                 << "'.";
+    return false;
+  }
+  AesCbcDecryptor decryptor(kPkcs5Padding);
+  std::string plaintext;
+  if (!decryptor.InitializeWithIv(
+          encryption_key_,
+          std::vector<uint8_t>(contents.begin(), contents.begin() + kIvSize)) ||
+      !decryptor.Crypt(
+          contents.substr(kIvSize, contents.size() - kIvSize - mac_size),
+          &plaintext)) {
+    LOG(WARNING) << "Cannot decrypt key cache entry '" << path << "'.";
+    return false;
+  }
+
+  BufferReader reader(reinterpret_cast<const uint8_t*>(plaintext.data()),
+                      plaintext.size());
+  std::string stored_request_hash;
+  int64_t expiration_seconds;
+  if (!reader.ReadToString(&stored_request_hash, request_hash.size()) ||
+      stored_request_hash != request_hash ||
+      !reader.Read8s(&expiration_seconds) ||
+      !reader.ReadToString(&entry->response, reader.size() - reader.pos())) {
+    LOG(WARNING) << "Ignoring invalid key cache entry '" << path << "'.";
+    return false;
+  }
+  entry->expiration =
+      Clock::time_point(std::chrono::seconds(expiration_seconds));
+  VLOG(1) << "Read key cache entry '" << path << "'.";
+  return true;
+}
+
+void KeyCache::WriteEntry(const std::string& request_hash,
+                          const Entry& entry) const {
+  if (directory_.empty())
+    return;
+
+  BufferWriter writer;
+  writer.AppendString(request_hash);
+  writer.AppendInt(ToSeconds(entry.expiration));
+  writer.AppendString(entry.response);
+  const std::string plaintext(reinterpret_cast<const char*>(writer.Buffer()),
+                              writer.Size());
+
+  std::vector<uint8_t> iv;
+  AesCbcEncryptor encryptor(kPkcs5Padding);
+  std::string ciphertext;
+  if (!AesCryptor::GenerateRandomIv(FOURCC_cbcs, &iv) ||
+      !encryptor.InitializeWithIv(encryption_key_, iv) ||
+      !encryptor.Crypt(plaintext, &ciphertext)) {
+    LOG(WARNING) << "Cannot encrypt key cache entry.";
+    return;
+  }
+
+  std::string contents = std::string(iv.begin(), iv.end()) + ciphertext;
+  contents += HmacSha256(mac_key_, contents);
+  const std::string path = GetEntryPath(request_hash);
+  if (!File::WriteFileAtomically(path.c_str(), contents)) {
+    LOG(WARNING) << "Cannot write key cache entry '" << path << "'.";
+  }
+}
+
+}  // namespace media
+}  // namespace shaka
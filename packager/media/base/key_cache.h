@@ -0,0 +1,92 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_KEY_CACHE_H_
+#define PACKAGER_MEDIA_BASE_KEY_CACHE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+
+#include <packager/utils/clock.h>
+
+namespace shaka {
+namespace media {
+
+/// KeyCache caches key server responses, so that packaging the same content
+/// again does not need another round trip to the key server.
+///
+/// The entries are kept in memory, so one cache can be shared by the key
+/// sources of all the jobs of a process. If a directory is given, the entries
+/// are also written to it, encrypted with AES-CBC and authenticated with
+/// HMAC-SHA256, and entries which are not in memory are read from it, so
+/// that they survive restarts. Entries expire after a fixed time to live.
+///
+/// Requests and responses are opaque strings. The request must identify the
+/// keys completely and must not contain anything that changes between
+/// otherwise identical requests, e.g. a signature.
+class KeyCache {
+ public:
+  /// @param ttl is how long an entry stays valid after it is added.
+  /// @param directory is where the entries are persisted. Entries are only
+  ///        kept in memory if it is empty.
+  /// @param encryption_key is the 16-byte AES key used to encrypt the
+  ///        persisted entries, from which the key which authenticates them
+  ///        is derived. Required if @a directory is not empty.
+  KeyCache(std::chrono::seconds ttl,
+           const std::string& directory,
+           const std::vector<uint8_t>& encryption_key);
+  virtual ~KeyCache();
+
+  /// Look up the response to a request.
+  /// @param request is the request sent to the key server.
+  /// @param[out] response is set to the cached response on success.
+  /// @return true if a response which has not expired was found.
+  virtual bool Get(const std::string& request, std::string* response);
+
+  /// Add the response to a request, replacing any previous entry.
+  /// @param request is the request sent to the key server.
+  /// @param response is the response of the key server.
+  virtual void Put(const std::string& request, const std::string& response);
+
+  /// Override the clock used to expire entries, for testing.
+  void set_clock(std::shared_ptr<Clock> clock) { clock_ = clock; }
+
+ private:
+  KeyCache(const KeyCache&) = delete;
+  KeyCache& operator=(const KeyCache&) = delete;
+
+  struct Entry {
+    std::string response;
+    Clock::time_point expiration;
+  };
+
+  // @return the path of the file which persists the entry of the request
+  //         with |request_hash|.
+  std::string GetEntryPath(const std::string& request_hash) const;
+  bool ReadEntry(const std::string& request_hash, Entry* entry) const;
+  void WriteEntry(const std::string& request_hash, const Entry& entry) const;
+
+  const std::chrono::seconds ttl_;
+  const std::string directory_;
+  const std::vector<uint8_t> encryption_key_;
+  std::string mac_key_;
+  std::shared_ptr<Clock> clock_;
+
+  absl::Mutex mutex_;
+  // Entries by the SHA-256 hash of their request.
+  std::map<std::string, Entry> entries_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_KEY_CACHE_H_
@@ -0,0 +1,130 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/key_cache.h>
+
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+#include <packager/file.h>
+#include <packager/file/file_test_util.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const std::chrono::seconds kTtl(3600);
+const char kRequest[] = "request";
+const char kResponse[] = "response";
+const std::vector<uint8_t> kEncryptionKey(16, 0x12);
+
+class FakeClock : public Clock {
+ public:
+  time_point now() noexcept override { return now_; }
+  void Advance(std::chrono::seconds duration) { now_ += duration; }
+
+ private:
+  time_point now_ = time_point(std::chrono::seconds(1700000000));
+};
+
+}  // namespace
+
+class KeyCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Replace the unique temporary file with a directory.
+    directory_ = generate_unique_temp_path();
+    delete_file(directory_);
+    std::filesystem::create_directory(directory_);
+  }
+
+  void TearDown() override {
+    std::error_code ec;
+    std::filesystem::remove_all(directory_, ec);
+  }
+
+  std::unique_ptr<KeyCache> CreateCache(
+      const std::string& directory,
+      const std::vector<uint8_t>& encryption_key) {
+    std::unique_ptr<KeyCache> cache(
+        new KeyCache(kTtl, directory, encryption_key));
+    cache->set_clock(clock_);
+    return cache;
+  }
+
+  std::string directory_;
+  std::shared_ptr<FakeClock> clock_ = std::make_shared<FakeClock>();
+};
+
+TEST_F(KeyCacheTest, InMemory) {
+  std::unique_ptr<KeyCache> cache = CreateCache("", {});
+  std::string response;
+  EXPECT_FALSE(cache->Get(kRequest, &response));
+
+  cache->Put(kRequest, kResponse);
+  ASSERT_TRUE(cache->Get(kRequest, &response));
+  EXPECT_EQ(kResponse, response);
+  EXPECT_FALSE(cache->Get("another request", &response));
+}
+
+TEST_F(KeyCacheTest, Expiration) {
+  std::unique_ptr<KeyCache> cache = CreateCache("", {});
+  cache->Put(kRequest, kResponse);
+
+  std::string response;
+  clock_->Advance(kTtl - std::chrono::seconds(1));
+  EXPECT_TRUE(cache->Get(kRequest, &response));
+  clock_->Advance(std::chrono::seconds(1));
+  EXPECT_FALSE(cache->Get(kRequest, &response));
+}
+
+TEST_F(KeyCacheTest, Persistence) {
+  CreateCache(directory_, kEncryptionKey)->Put(kRequest, kResponse);
+
+  std::unique_ptr<KeyCache> cache = CreateCache(directory_, kEncryptionKey);
+  std::string response;
+  ASSERT_TRUE(cache->Get(kRequest, &response));
+  EXPECT_EQ(kResponse, response);
+}
+
+TEST_F(KeyCacheTest, PersistedEntryExpires) {
+  CreateCache(directory_, kEncryptionKey)->Put(kRequest, kResponse);
+
+  clock_->Advance(kTtl);
+  std::string response;
+  EXPECT_FALSE(
+      CreateCache(directory_, kEncryptionKey)->Get(kRequest, &response));
+}
+
+TEST_F(KeyCacheTest, PersistedEntryWithWrongKey) {
+  CreateCache(directory_, kEncryptionKey)->Put(kRequest, kResponse);
+
+  std::string response;
+  EXPECT_FALSE(CreateCache(directory_, std::vector<uint8_t>(16, 0x34))
+                   ->Get(kRequest, &response));
+}
+
+TEST_F(KeyCacheTest, TamperedPersistedEntry) {
+  CreateCache(directory_, kEncryptionKey)->Put(kRequest, kResponse);
+
+  for (const auto& file : std::filesystem::directory_iterator(directory_)) {
+    std::string contents;
+    ASSERT_TRUE(File::ReadFileToString(file.path().string().c_str(),
+                                       &contents));
+    // Flip a bit of the last block of the ciphertext.
+    contents[contents.size() - 40] ^= 1;
+    ASSERT_TRUE(File::WriteStringToFile(file.path().string().c_str(),
+                                        contents));
+  }
+
+  std::string response;
+  EXPECT_FALSE(
+      CreateCache(directory_, kEncryptionKey)->Get(kRequest, &response));
+}
+
+}  // namespace media
+}  // namespace shaka
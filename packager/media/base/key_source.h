@@ -92,6 +92,11 @@ class KeySource {
                                     const std::string& stream_label,
                                     EncryptionKey* key) = 0;
 
+  /// Make the calls waiting for keys, and the later ones, fail soon. It may be
+  /// called from any thread. Key sources which never wait for keys may ignore
+  /// it.
+  virtual void Cancel() {}
+
  private:
   DISALLOW_COPY_AND_ASSIGN(KeySource);
 };
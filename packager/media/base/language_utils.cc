@@ -6,6 +6,8 @@
 
 #include <packager/media/base/language_utils.h>
 
+#include <algorithm>
+#include <array>
 #include <iterator>
 
 #include <absl/log/check.h>
@@ -14,12 +16,13 @@
 namespace {
 
 // A map from 3-letter language codes (ISO 639-2) to 2-letter language codes
-// (ISO 639-1) for all languages which have both in the registry.
+// (ISO 639-1) for all languages which have both in the registry. It must stay
+// sorted by the 3-letter codes, which are looked up with a binary search.
 typedef struct {
   const char iso_639_2[4];  // 3 letters + nul
   const char iso_639_1[3];  // 2 letters + nul
 } LanguageMapPairType;
-const LanguageMapPairType kLanguageMap[] = {
+constexpr LanguageMapPairType kLanguageMap[] = {
     {"aar", "aa"}, {"abk", "ab"}, {"afr", "af"}, {"aka", "ak"}, {"alb", "sq"},
     {"amh", "am"}, {"ara", "ar"}, {"arg", "an"}, {"arm", "hy"}, {"asm", "as"},
     {"ava", "av"}, {"ave", "ae"}, {"aym", "ay"}, {"aze", "az"}, {"bak", "ba"},
@@ -63,6 +66,40 @@ const LanguageMapPairType kLanguageMap[] = {
     {"yid", "yi"}, {"yor", "yo"}, {"zha", "za"}, {"zho", "zh"}, {"zul", "zu"},
 };
 
+// Returns true if |a| sorts before |b|. std::strcmp is not constexpr.
+constexpr bool CodeLess(const char* a, const char* b) {
+  while (*a && *a == *b) {
+    ++a;
+    ++b;
+  }
+  return static_cast<unsigned char>(*a) < static_cast<unsigned char>(*b);
+}
+
+constexpr bool IsSortedByIso639_2() {
+  for (size_t i = 1; i < std::size(kLanguageMap); ++i) {
+    if (CodeLess(kLanguageMap[i].iso_639_2, kLanguageMap[i - 1].iso_639_2))
+      return false;
+  }
+  return true;
+}
+static_assert(IsSortedByIso639_2(), "kLanguageMap must be sorted");
+
+// Indices into kLanguageMap sorted by the 2-letter codes. Entries with the same
+// 2-letter code keep their order in kLanguageMap, so the first one is the
+// preferred 3-letter code, e.g. "alb" rather than "sqi" for "sq".
+const std::array<size_t, std::size(kLanguageMap)>& Iso639_1Index() {
+  static const std::array<size_t, std::size(kLanguageMap)> index = [] {
+    std::array<size_t, std::size(kLanguageMap)> index;
+    for (size_t i = 0; i < index.size(); ++i)
+      index[i] = i;
+    std::stable_sort(index.begin(), index.end(), [](size_t a, size_t b) {
+      return CodeLess(kLanguageMap[a].iso_639_1, kLanguageMap[b].iso_639_1);
+    });
+    return index;
+  }();
+  return index;
+}
+
 void SplitLanguageTag(const std::string& tag,
                       std::string* main_language, std::string* subtag) {
   // Split the main language from its subtag (if any).
@@ -95,11 +132,13 @@ std::string LanguageToShortestForm(const std::string& language) {
     return main_language + subtag;
   }
 
-  for (size_t i = 0; i < std::size(kLanguageMap); ++i) {
-    if (main_language == kLanguageMap[i].iso_639_2) {
-      return kLanguageMap[i].iso_639_1 + subtag;
-    }
-  }
+  const LanguageMapPairType* entry = std::lower_bound(
+      std::begin(kLanguageMap), std::end(kLanguageMap), main_language.c_str(),
+      [](const LanguageMapPairType& entry, const char* code) {
+        return CodeLess(entry.iso_639_2, code);
+      });
+  if (entry != std::end(kLanguageMap) && main_language == entry->iso_639_2)
+    return entry->iso_639_1 + subtag;
 
   // This could happen legitimately for languages which have no 2-letter code,
   // but that would imply that the input language code is a 3-letter code.
@@ -117,11 +156,13 @@ std::string LanguageToISO_639_2(const std::string& language) {
     return main_language + subtag;
   }
 
-  for (size_t i = 0; i < std::size(kLanguageMap); ++i) {
-    if (main_language == kLanguageMap[i].iso_639_1) {
-      return kLanguageMap[i].iso_639_2 + subtag;
-    }
-  }
+  const auto& index = Iso639_1Index();
+  auto it = std::lower_bound(index.begin(), index.end(), main_language.c_str(),
+                             [](size_t i, const char* code) {
+                               return CodeLess(kLanguageMap[i].iso_639_1, code);
+                             });
+  if (it != index.end() && main_language == kLanguageMap[*it].iso_639_1)
+    return kLanguageMap[*it].iso_639_2 + subtag;
 
   LOG(WARNING) << "No equivalent 3-letter language code for " << main_language;
   // This is probably a mistake on the part of the user and should be treated
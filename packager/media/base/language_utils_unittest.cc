@@ -0,0 +1,39 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/language_utils.h>
+
+#include <gtest/gtest.h>
+
+namespace shaka {
+
+TEST(LanguageUtilsTest, ShortestForm) {
+  EXPECT_EQ("", LanguageToShortestForm(""));
+  EXPECT_EQ("en", LanguageToShortestForm("en"));
+  EXPECT_EQ("en", LanguageToShortestForm("eng"));
+  EXPECT_EQ("en-US", LanguageToShortestForm("eng-US"));
+  EXPECT_EQ("aa", LanguageToShortestForm("aar"));
+  EXPECT_EQ("zu", LanguageToShortestForm("zul"));
+  // The first entry wins if a 3-letter code has several 2-letter codes.
+  EXPECT_EQ("he", LanguageToShortestForm("heb"));
+  // 3-letter codes without a 2-letter code are kept.
+  EXPECT_EQ("zxx", LanguageToShortestForm("zxx"));
+}
+
+TEST(LanguageUtilsTest, Iso639_2) {
+  EXPECT_EQ("eng", LanguageToISO_639_2("eng"));
+  EXPECT_EQ("eng", LanguageToISO_639_2("en"));
+  EXPECT_EQ("por-BR", LanguageToISO_639_2("pt-BR"));
+  EXPECT_EQ("aar", LanguageToISO_639_2("aa"));
+  EXPECT_EQ("zul", LanguageToISO_639_2("zu"));
+  EXPECT_EQ("heb", LanguageToISO_639_2("iw"));
+  // The bibliographic code comes first in the table and is preferred.
+  EXPECT_EQ("alb", LanguageToISO_639_2("sq"));
+  EXPECT_EQ("ces", LanguageToISO_639_2("cs"));
+  EXPECT_EQ("und", LanguageToISO_639_2("xx"));
+}
+
+}  // namespace shaka
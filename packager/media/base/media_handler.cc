@@ -6,10 +6,39 @@
 
 #include <packager/media/base/media_handler.h>
 
+#include <iterator>
+
 #include <packager/macros/status.h>
 
 namespace shaka {
 namespace media {
+namespace {
+
+// The innermost process timer of the current thread.
+thread_local MediaHandler::ScopedProcessTimer* g_current_process_timer =
+    nullptr;
+
+int64_t ToMicroseconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+      .count();
+}
+
+void CountStreamData(const StreamData& stream_data, MediaHandlerStats* stats) {
+  switch (stream_data.stream_data_type) {
+    case StreamDataType::kMediaSample:
+      stats->samples.fetch_add(1, std::memory_order_relaxed);
+      stats->bytes.fetch_add(stream_data.media_sample->data_size(),
+                             std::memory_order_relaxed);
+      break;
+    case StreamDataType::kTextSample:
+      stats->samples.fetch_add(1, std::memory_order_relaxed);
+      break;
+    default:
+      break;
+  }
+}
+
+}  // namespace
 
 std::string StreamDataTypeToString(StreamDataType type) {
   switch (type) {
@@ -31,14 +60,45 @@ std::string StreamDataTypeToString(StreamDataType type) {
   return "unknown";
 }
 
+StreamData::StreamData(const StreamData& other)
+    : stream_index(other.stream_index),
+      stream_data_type(other.stream_data_type) {
+  switch (stream_data_type) {
+    case StreamDataType::kStreamInfo:
+      stream_info = other.stream_info;
+      break;
+    case StreamDataType::kMediaSample:
+      media_sample = other.media_sample;
+      break;
+    case StreamDataType::kTextSample:
+      text_sample = other.text_sample;
+      break;
+    case StreamDataType::kSegmentInfo:
+      segment_info = other.segment_info;
+      break;
+    case StreamDataType::kScte35Event:
+      scte35_event = other.scte35_event;
+      break;
+    case StreamDataType::kCueEvent:
+      cue_event = other.cue_event;
+      break;
+    case StreamDataType::kUnknown:
+      break;
+  }
+}
+
 Status MediaHandler::SetHandler(size_t output_stream_index,
                                 std::shared_ptr<MediaHandler> handler) {
   if (output_handlers_.find(output_stream_index) != output_handlers_.end()) {
     return Status(error::ALREADY_EXISTS,
                   "The handler at the specified index already exists.");
   }
-  output_handlers_[output_stream_index] =
-      std::make_pair(handler, handler->num_input_streams_++);
+  OutputHandler& output_handler = output_handlers_[output_stream_index];
+  output_handler = std::make_pair(handler, handler->num_input_streams_++);
+  // The map does not move its entries, so the table can point to them.
+  if (output_handler_table_.size() <= output_stream_index)
+    output_handler_table_.resize(output_stream_index + 1);
+  output_handler_table_[output_stream_index] = &output_handler;
   next_output_stream_index_ = output_stream_index + 1;
   return Status::OK;
 }
@@ -80,6 +140,45 @@ Status MediaHandler::Chain(
   return Status::OK;
 }
 
+std::shared_ptr<const MediaHandlerStats> MediaHandler::EnableStats(
+    const std::string& label) {
+  if (!stats_)
+    stats_ = std::make_shared<MediaHandlerStats>(label);
+  return stats_;
+}
+
+MediaHandler::ScopedProcessTimer::ScopedProcessTimer(
+    const MediaHandler* handler)
+    : stats_(handler->stats_.get()) {
+  if (!stats_)
+    return;
+  parent_ = g_current_process_timer;
+  g_current_process_timer = this;
+  start_ = std::chrono::steady_clock::now();
+}
+
+MediaHandler::ScopedProcessTimer::~ScopedProcessTimer() {
+  if (!stats_)
+    return;
+  const auto elapsed = std::chrono::steady_clock::now() - start_;
+  stats_->process_time_us.fetch_add(ToMicroseconds(elapsed - excluded_),
+                                    std::memory_order_relaxed);
+  g_current_process_timer = parent_;
+  if (parent_)
+    parent_->excluded_ += elapsed;
+}
+
+void MediaHandler::AddBlockedTime(
+    std::chrono::steady_clock::time_point start) const {
+  if (!stats_)
+    return;
+  const auto blocked = std::chrono::steady_clock::now() - start;
+  stats_->blocked_time_us.fetch_add(ToMicroseconds(blocked),
+                                    std::memory_order_relaxed);
+  if (g_current_process_timer)
+    g_current_process_timer->excluded_ += blocked;
+}
+
 Status MediaHandler::OnFlushRequest(size_t input_stream_index) {
   // The default implementation treats the output stream index to be identical
   // to the input stream index, which is true for most handlers.
@@ -92,27 +191,68 @@ bool MediaHandler::ValidateOutputStreamIndex(size_t stream_index) const {
 }
 
 Status MediaHandler::Dispatch(std::unique_ptr<StreamData> stream_data) const {
-  size_t output_stream_index = stream_data->stream_index;
-  auto handler_it = output_handlers_.find(output_stream_index);
-  if (handler_it == output_handlers_.end()) {
+  const OutputHandler* output_handler =
+      FindOutputHandler(stream_data->stream_index);
+  if (!output_handler) {
     return Status(error::NOT_FOUND,
                   "No output handler exist at the specified index.");
   }
-  stream_data->stream_index = handler_it->second.second;
-  return handler_it->second.first->Process(std::move(stream_data));
+  return DispatchToHandler(*output_handler, std::move(stream_data));
+}
+
+Status MediaHandler::DispatchToAllOutputs(
+    std::unique_ptr<StreamData> stream_data) const {
+  Status status;
+  if (output_handlers_.empty())
+    return status;
+
+  // The copies come from SmallObjectPool and share the payload of
+  // |stream_data|. Copying the null shared_ptrs is free, so each copy adds a
+  // single reference to the payload.
+  auto last = std::prev(output_handlers_.end());
+  for (auto it = output_handlers_.begin(); it != last; ++it) {
+    std::unique_ptr<StreamData> copy(new StreamData(*stream_data));
+    status.Update(DispatchToHandler(it->second, std::move(copy)));
+  }
+  // The last output takes the original, which saves a copy per sample.
+  status.Update(DispatchToHandler(last->second, std::move(stream_data)));
+  return status;
+}
+
+const MediaHandler::OutputHandler* MediaHandler::FindOutputHandler(
+    size_t output_stream_index) const {
+  return output_stream_index < output_handler_table_.size()
+             ? output_handler_table_[output_stream_index]
+             : nullptr;
+}
+
+Status MediaHandler::DispatchToHandler(
+    const OutputHandler& output_handler,
+    std::unique_ptr<StreamData> stream_data) const {
+  const std::shared_ptr<MediaHandler>& handler = output_handler.first;
+  if (handler->stats_)
+    CountStreamData(*stream_data, handler->stats_.get());
+  if (stats_ && num_input_streams_ == 0)
+    CountStreamData(*stream_data, stats_.get());
+
+  stream_data->stream_index = output_handler.second;
+  ScopedProcessTimer timer(handler.get());
+  return handler->Process(std::move(stream_data));
 }
 
 Status MediaHandler::FlushDownstream(size_t output_stream_index) {
-  auto handler_it = output_handlers_.find(output_stream_index);
-  if (handler_it == output_handlers_.end()) {
+  const OutputHandler* output_handler = FindOutputHandler(output_stream_index);
+  if (!output_handler) {
     return Status(error::NOT_FOUND,
                   "No output handler exist at the specified index.");
   }
-  return handler_it->second.first->OnFlushRequest(handler_it->second.second);
+  ScopedProcessTimer timer(output_handler->first.get());
+  return output_handler->first->OnFlushRequest(output_handler->second);
 }
 
 Status MediaHandler::FlushAllDownstreams() {
   for (const auto& pair : output_handlers_) {
+    ScopedProcessTimer timer(pair.second.first.get());
     Status status = pair.second.first->OnFlushRequest(pair.second.second);
     if (!status.ok()) {
       return status;
@@ -7,11 +7,16 @@
 #ifndef PACKAGER_MEDIA_BASE_MEDIA_HANDLER_H_
 #define PACKAGER_MEDIA_BASE_MEDIA_HANDLER_H_
 
+#include <atomic>
+#include <chrono>
 #include <map>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include <packager/media/base/media_sample.h>
+#include <packager/media/base/small_object_pool.h>
 #include <packager/media/base/stream_info.h>
 #include <packager/media/base/text_sample.h>
 #include <packager/status.h>
@@ -64,6 +69,12 @@ struct SegmentInfo {
   // a |key_rotation_encryption_config| even if the segment is not encrypted,
   // which is the case for clear lead.
   std::shared_ptr<EncryptionConfig> key_rotation_encryption_config;
+  // Wall-clock times of the segment on its way to the muxer, for live latency
+  // accounting, see MuxerListener::OnSegmentLatency. They are left at the epoch
+  // by the handlers which do not set them.
+  std::chrono::system_clock::time_point first_sample_time;
+  std::chrono::system_clock::time_point chunked_time;
+  std::chrono::system_clock::time_point encrypted_time;
 };
 
 // TODO(kqyang): Should we use protobuf?
@@ -78,6 +89,20 @@ struct StreamData {
   std::shared_ptr<const Scte35Event> scte35_event;
   std::shared_ptr<const CueEvent> cue_event;
 
+  StreamData() = default;
+  // Only the payload of |stream_data_type| is copied, as the other payloads
+  // are not set.
+  StreamData(const StreamData& other);
+
+  // Stream data is created for every sample and for every output of a
+  // Replicator, so its memory is recycled.
+  static void* operator new(size_t size) {
+    return SmallObjectPool::Allocate(size);
+  }
+  static void operator delete(void* ptr, size_t size) {
+    SmallObjectPool::Free(ptr, size);
+  }
+
   static std::unique_ptr<StreamData> FromStreamInfo(
       size_t stream_index,
       std::shared_ptr<const StreamInfo> stream_info) {
@@ -139,6 +164,27 @@ struct StreamData {
   }
 };
 
+/// Statistics of the stream data processed by a media handler. A handler only
+/// collects them once enabled with MediaHandler::EnableStats. They are updated
+/// while the graph runs and can be read from any thread.
+struct MediaHandlerStats {
+  explicit MediaHandlerStats(const std::string& label) : label(label) {}
+
+  /// Identifies the handler in the graph.
+  const std::string label;
+  /// The number of media and text samples processed. Origin handlers, which
+  /// have no input, count the samples they dispatch instead.
+  std::atomic<uint64_t> samples{0};
+  /// The payload size of the media samples counted in |samples|.
+  std::atomic<uint64_t> bytes{0};
+  /// Time spent processing stream data and flush requests, in microseconds.
+  /// The time spent in downstream handlers and blocked is not included.
+  std::atomic<int64_t> process_time_us{0};
+  /// Time spent blocked, e.g. waiting for room in a full queue, in
+  /// microseconds.
+  std::atomic<int64_t> blocked_time_us{0};
+};
+
 /// MediaHandler is the base media processing unit. Media handlers transform
 /// the input streams and propagate the outputs to downstream media handlers.
 /// There are three different types of media handlers:
@@ -156,6 +202,28 @@ struct StreamData {
 /// Other types of media handlers are disallowed and not supported.
 class MediaHandler {
  public:
+  /// Accounts the time spent in its scope to the process time of a handler,
+  /// less the time spent in the nested scopes of other handlers on the same
+  /// thread and the time recorded with AddBlockedTime. Dispatch and the flush
+  /// functions use it for the downstream handler; origin handlers should use
+  /// it in Run. It does nothing if the handler does not collect statistics.
+  class ScopedProcessTimer {
+   public:
+    explicit ScopedProcessTimer(const MediaHandler* handler);
+    ~ScopedProcessTimer();
+
+   private:
+    ScopedProcessTimer(const ScopedProcessTimer&) = delete;
+    ScopedProcessTimer& operator=(const ScopedProcessTimer&) = delete;
+
+    friend class MediaHandler;
+
+    MediaHandlerStats* const stats_;
+    ScopedProcessTimer* parent_ = nullptr;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::duration excluded_{};
+  };
+
   MediaHandler() = default;
   virtual ~MediaHandler() = default;
 
@@ -177,7 +245,17 @@ class MediaHandler {
 
   static Status Chain(const std::vector<std::shared_ptr<MediaHandler>>& list);
 
+  /// Start collecting statistics of the stream data processed by this handler.
+  /// It should be called after setting up the graph before running the graph.
+  /// @param label identifies the handler in the statistics.
+  /// @return The statistics, which are updated as the graph runs.
+  std::shared_ptr<const MediaHandlerStats> EnableStats(
+      const std::string& label);
+
  protected:
+  /// Record the time since |start| as time spent blocked by this handler.
+  void AddBlockedTime(std::chrono::steady_clock::time_point start) const;
+
   /// Internal implementation of initialize. Note that it should only initialize
   /// the MediaHandler itself. Downstream handlers are handled in Initialize().
   virtual Status InitializeInternal() = 0;
@@ -198,6 +276,13 @@ class MediaHandler {
   /// stream_data.stream_index should be the output stream index.
   Status Dispatch(std::unique_ptr<StreamData> stream_data) const;
 
+  /// Dispatch the stream data to all the downstream handlers, which share its
+  /// payload. This walks the downstream handlers directly instead of looking
+  /// up each output stream index. stream_data.stream_index is ignored. All
+  /// the handlers get the data even if some of them fail.
+  /// @return the first error, if any.
+  Status DispatchToAllOutputs(std::unique_ptr<StreamData> stream_data) const;
+
   /// Dispatch the stream info to downstream handlers.
   Status DispatchStreamInfo(
       size_t stream_index,
@@ -264,7 +349,16 @@ class MediaHandler {
   MediaHandler(const MediaHandler&) = delete;
   MediaHandler& operator=(const MediaHandler&) = delete;
 
+  using OutputHandler = std::pair<std::shared_ptr<MediaHandler>, size_t>;
+
+  // Returns null if no handler is set at |output_stream_index|.
+  const OutputHandler* FindOutputHandler(size_t output_stream_index) const;
+  Status DispatchToHandler(const OutputHandler& output_handler,
+                           std::unique_ptr<StreamData> stream_data) const;
+
   bool initialized_ = false;
+  // Null unless the statistics are enabled.
+  std::shared_ptr<MediaHandlerStats> stats_;
   // Number of input streams.
   size_t num_input_streams_ = 0;
   // The next available output stream index, used by AddHandler.
@@ -273,6 +367,10 @@ class MediaHandler {
   // map.
   std::map<size_t, std::pair<std::shared_ptr<MediaHandler>, size_t>>
       output_handlers_;
+  // The entries of |output_handlers_| indexed by output stream index, null
+  // where no handler is set. Dispatch runs for every sample at every stage of
+  // the graph, so it indexes this instead of searching the map.
+  std::vector<const OutputHandler*> output_handler_table_;
 };
 
 }  // namespace media
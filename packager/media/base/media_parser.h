@@ -9,6 +9,7 @@
 
 #include <functional>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -77,6 +78,13 @@ class MediaParser {
   /// @return true if successful.
   [[nodiscard]] virtual bool Parse(const uint8_t* buf, int size) = 0;
 
+  /// Only emit the samples of some tracks from now on, e.g. of the streams
+  /// which have an output. May be called from the initialization callback.
+  /// The parsers which support it skip the data of the other tracks instead
+  /// of demuxing it; the others keep emitting all the samples.
+  /// @param track_ids are the track ids of the selected tracks.
+  virtual void SetSelectedTracks(const std::set<uint32_t>& track_ids) {}
+
  private:
   DISALLOW_COPY_AND_ASSIGN(MediaParser);
 };
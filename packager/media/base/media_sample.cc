@@ -12,8 +12,21 @@
 #include <absl/log/log.h>
 #include <absl/strings/str_format.h>
 
+#include <packager/utils/memory_accounting.h>
+
 namespace shaka {
 namespace media {
+namespace {
+
+// Samples are created at the frame rate of every stream, so the control blocks
+// of their shared pointers come from SmallObjectPool too, as the samples do.
+std::shared_ptr<MediaSample> MakeShared(MediaSample* media_sample) {
+  return std::shared_ptr<MediaSample>(media_sample,
+                                      std::default_delete<MediaSample>(),
+                                      SmallObjectAllocator<MediaSample>());
+}
+
+}  // namespace
 
 MediaSample::MediaSample(const uint8_t* data,
                          size_t data_size,
@@ -27,8 +40,7 @@ MediaSample::MediaSample(const uint8_t* data,
 
   SetData(data, data_size);
   if (side_data) {
-    std::shared_ptr<uint8_t> shared_side_data(new uint8_t[side_data_size],
-                                              std::default_delete<uint8_t[]>());
+    std::shared_ptr<uint8_t> shared_side_data = AllocateData(side_data_size);
     memcpy(shared_side_data.get(), side_data, side_data_size);
     side_data_ = std::move(shared_side_data);
     side_data_size_ = side_data_size;
@@ -45,7 +57,7 @@ std::shared_ptr<MediaSample> MediaSample::CopyFrom(const uint8_t* data,
                                                    bool is_key_frame) {
   // If you hit this CHECK you likely have a bug in a demuxer. Go fix it.
   CHECK(data);
-  return std::shared_ptr<MediaSample>(
+  return MakeShared(
       new MediaSample(data, data_size, nullptr, 0u, is_key_frame));
 }
 
@@ -57,30 +69,29 @@ std::shared_ptr<MediaSample> MediaSample::CopyFrom(const uint8_t* data,
                                                    bool is_key_frame) {
   // If you hit this CHECK you likely have a bug in a demuxer. Go fix it.
   CHECK(data);
-  return std::shared_ptr<MediaSample>(new MediaSample(
+  return MakeShared(new MediaSample(
       data, data_size, side_data, side_data_size, is_key_frame));
 }
 
 // static
 std::shared_ptr<MediaSample> MediaSample::FromMetadata(const uint8_t* metadata,
                                                        size_t metadata_size) {
-  return std::shared_ptr<MediaSample>(
+  return MakeShared(
       new MediaSample(nullptr, 0, metadata, metadata_size, false));
 }
 
 // static
 std::shared_ptr<MediaSample> MediaSample::CreateEmptyMediaSample() {
-  return std::shared_ptr<MediaSample>(new MediaSample);
+  return MakeShared(new MediaSample);
 }
 
 // static
 std::shared_ptr<MediaSample> MediaSample::CreateEOSBuffer() {
-  return std::shared_ptr<MediaSample>(
-      new MediaSample(nullptr, 0, nullptr, 0, false));
+  return MakeShared(new MediaSample(nullptr, 0, nullptr, 0, false));
 }
 
 std::shared_ptr<MediaSample> MediaSample::Clone() const {
-  std::shared_ptr<MediaSample> new_media_sample(new MediaSample);
+  std::shared_ptr<MediaSample> new_media_sample = MakeShared(new MediaSample);
   new_media_sample->dts_ = dts_;
   new_media_sample->pts_ = pts_;
   new_media_sample->duration_ = duration_;
@@ -91,6 +102,7 @@ std::shared_ptr<MediaSample> MediaSample::Clone() const {
   new_media_sample->side_data_ = side_data_;
   new_media_sample->side_data_size_ = side_data_size_;
   new_media_sample->config_id_ = config_id_;
+  new_media_sample->subsample_layout_ = subsample_layout();
   if (decrypt_config_) {
     new_media_sample->decrypt_config_.reset(new DecryptConfig(
         decrypt_config_->key_id(), decrypt_config_->iv(),
@@ -101,15 +113,25 @@ std::shared_ptr<MediaSample> MediaSample::Clone() const {
   return new_media_sample;
 }
 
-void MediaSample::TransferData(std::shared_ptr<uint8_t> data,
+// static
+std::shared_ptr<uint8_t> MediaSample::AllocateData(size_t size) {
+  MemoryAccounting::Add(MemorySubsystem::kMediaSamples, size);
+  return std::shared_ptr<uint8_t>(new uint8_t[size], [size](uint8_t* data) {
+    delete[] data;
+    MemoryAccounting::Add(MemorySubsystem::kMediaSamples,
+                          -static_cast<int64_t>(size));
+  });
+}
+
+void MediaSample::TransferData(std::shared_ptr<const uint8_t> data,
                                size_t data_size) {
   data_ = std::move(data);
   data_size_ = data_size;
+  set_subsample_layout(nullptr);
 }
 
 void MediaSample::SetData(const uint8_t* data, size_t data_size) {
-  std::shared_ptr<uint8_t> shared_data(new uint8_t[data_size],
-                                       std::default_delete<uint8_t[]>());
+  std::shared_ptr<uint8_t> shared_data = AllocateData(data_size);
   memcpy(shared_data.get(), data, data_size);
   TransferData(std::move(shared_data), data_size);
 }
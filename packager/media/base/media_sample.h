@@ -17,6 +17,7 @@
 
 #include <packager/macros/classes.h>
 #include <packager/media/base/decrypt_config.h>
+#include <packager/media/base/small_object_pool.h>
 
 namespace shaka {
 namespace media {
@@ -67,13 +68,28 @@ class MediaSample {
 
   virtual ~MediaSample();
 
+  static void* operator new(size_t size) {
+    return SmallObjectPool::Allocate(size);
+  }
+  static void operator delete(void* ptr, size_t size) {
+    SmallObjectPool::Free(ptr, size);
+  }
+
   /// Clone the object and return a new MediaSample.
   std::shared_ptr<MediaSample> Clone() const;
 
-  /// Transfer data to this media sample. No data copying is involved.
+  /// Allocate a buffer for the data of media samples, which is accounted for
+  /// as memory of MemorySubsystem::kMediaSamples until it is released.
+  /// @param size is the size of the buffer in bytes.
+  static std::shared_ptr<uint8_t> AllocateData(size_t size);
+
+  /// Transfer data to this media sample. No data copying is involved. The
+  /// data may be shared with other owners, e.g. point into a demuxer buffer,
+  /// as a media sample never modifies its data. Handlers changing the payload
+  /// must set a new buffer on a Clone() instead.
   /// @param data points to the data to be transferred.
   /// @param data_size is the size of the data to be transferred.
-  void TransferData(std::shared_ptr<uint8_t> data, size_t data_size);
+  void TransferData(std::shared_ptr<const uint8_t> data, size_t data_size);
 
   /// Set the data in this media sample. Note that this method involves data
   /// copying.
@@ -145,6 +161,22 @@ class MediaSample {
     decrypt_config_ = std::move(decrypt_config);
   }
 
+  /// @return the subsample layout of the frame in the sample, if it has been
+  ///         attached with set_subsample_layout(), or nullptr.
+  std::shared_ptr<const SubsampleLayout> subsample_layout() const {
+    return std::atomic_load(&subsample_layout_);
+  }
+
+  /// Attaches the subsample layout parsed from the data of the sample, so
+  /// that the other handlers getting the same sample, e.g. the encryption
+  /// handlers of several outputs, do not parse it again. As it only caches
+  /// what the data determines, it can be set on a const sample, from any
+  /// thread.
+  void set_subsample_layout(
+      std::shared_ptr<const SubsampleLayout> subsample_layout) const {
+    std::atomic_store(&subsample_layout_, std::move(subsample_layout));
+  }
+
   // If there's no data in this buffer, it represents end of stream.
   bool end_of_stream() const { return data_size_ == 0; }
 
@@ -190,6 +222,9 @@ class MediaSample {
   // Decrypt configuration.
   std::unique_ptr<DecryptConfig> decrypt_config_;
 
+  // Subsample layout of |data_|, if it has been parsed.
+  mutable std::shared_ptr<const SubsampleLayout> subsample_layout_;
+
   DISALLOW_COPY_AND_ASSIGN(MediaSample);
 };
 
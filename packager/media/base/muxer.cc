@@ -14,16 +14,28 @@
 #include <packager/macros/status.h>
 #include <packager/media/base/media_sample.h>
 #include <packager/media/base/muxer_util.h>
+#include <packager/utils/metrics.h>
 
 namespace shaka {
 namespace media {
 namespace {
 const bool kInitialEncryptionInfo = true;
 const int64_t kStartTime = 0;
+
+MetricDurations* SegmentLatencies() {
+  static MetricDurations* const segment_latencies =
+      MetricsRegistry::GetInstance()->GetDurations(
+          "shaka_segment_latency_seconds",
+          "Time from the first sample of a segment reaching the muxer to the "
+          "segment being finalized.");
+  return segment_latencies;
+}
 }  // namespace
 
 Muxer::Muxer(const MuxerOptions& options)
-    : options_(options), clock_(new Clock) {
+    : options_(options),
+      segment_template_(options.segment_template),
+      clock_(new Clock) {
   // "$" is only allowed if the output file name is a template, which is used to
   // support one file per Representation per Period when there are Ad Cues.
   if (options_.output_file_name.find("$") != std::string::npos)
@@ -69,15 +81,39 @@ Status Muxer::Process(std::unique_ptr<StreamData> stream_data) {
           muxer_listener_->OnEncryptionStart();
         }
       }
-      return FinalizeSegment(stream_data->stream_index, segment_info);
+      RETURN_IF_ERROR(FinalizeSegment(stream_data->stream_index, segment_info));
+      if (muxer_listener_ && !segment_info.is_subsegment) {
+        SegmentLatency latency;
+        latency.start_time = segment_info.start_timestamp;
+        latency.first_sample_time = segment_info.first_sample_time;
+        latency.chunked_time = segment_info.chunked_time;
+        latency.encrypted_time = segment_info.encrypted_time;
+        latency.published_time = std::chrono::system_clock::now();
+        muxer_listener_->OnSegmentLatency(latency);
+      }
+      if (!segment_info.is_subsegment && segment_start_time_) {
+        SegmentLatencies()->Record(std::chrono::steady_clock::now() -
+                                   *segment_start_time_);
+        segment_start_time_.reset();
+      }
+      return Status::OK;
     }
     case StreamDataType::kMediaSample:
+      if (!segment_start_time_)
+        segment_start_time_ = std::chrono::steady_clock::now();
       return AddMediaSample(stream_data->stream_index,
                             *stream_data->media_sample);
     case StreamDataType::kTextSample:
+      // Heartbeats are for the handlers segmenting the text.
+      if (stream_data->text_sample->is_heartbeat())
+        return Status::OK;
+      if (!segment_start_time_)
+        segment_start_time_ = std::chrono::steady_clock::now();
       return AddTextSample(stream_data->stream_index,
                            *stream_data->text_sample);
     case StreamDataType::kCueEvent:
+      RETURN_IF_ERROR(
+          AddCueEvent(stream_data->stream_index, *stream_data->cue_event));
       if (muxer_listener_) {
         const int64_t time_scale =
             streams_[stream_data->stream_index]->time_scale();
@@ -120,6 +156,12 @@ Status Muxer::AddTextSample(size_t stream_id, const TextSample& sample) {
   return Status::OK;
 }
 
+Status Muxer::AddCueEvent(size_t stream_id, const CueEvent& cue_event) {
+  UNUSED(stream_id);
+  UNUSED(cue_event);
+  return Status::OK;
+}
+
 Status Muxer::ReinitializeMuxer(int64_t timestamp) {
   if (muxer_listener_ && streams_.back()->is_encrypted()) {
     const EncryptionConfig& encryption_config =
@@ -9,11 +9,14 @@
 #ifndef PACKAGER_MEDIA_BASE_MUXER_H_
 #define PACKAGER_MEDIA_BASE_MUXER_H_
 
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include <packager/media/base/media_handler.h>
 #include <packager/media/base/muxer_options.h>
+#include <packager/media/base/muxer_util.h>
 #include <packager/media/event/muxer_listener.h>
 #include <packager/media/event/progress_listener.h>
 #include <packager/mpd/base/mpd_builder.h>
@@ -65,9 +68,13 @@ class Muxer : public MediaHandler {
   /// @}
 
   const MuxerOptions& options() const { return options_; }
+  /// @return the segment template of the options, parsed once.
+  const SegmentTemplate& segment_template() const { return segment_template_; }
   MuxerListener* muxer_listener() { return muxer_listener_.get(); }
   ProgressListener* progress_listener() { return progress_listener_.get(); }
 
+  Clock* clock() const { return clock_.get(); }
+
   uint64_t Now() const {
     auto duration = clock_->now().time_since_epoch();
     auto seconds =
@@ -95,6 +102,10 @@ class Muxer : public MediaHandler {
   // handle text samples will need to replace this.
   virtual Status AddTextSample(size_t stream_id, const TextSample& sample);
 
+  // Add a cue event, e.g. to signal it in the media segments. This does
+  // nothing by default; the muxer listener is notified of the cue either way.
+  virtual Status AddCueEvent(size_t stream_id, const CueEvent& cue_event);
+
   // Finalize the segment or subsegment.
   virtual Status FinalizeSegment(
       size_t stream_id,
@@ -105,10 +116,14 @@ class Muxer : public MediaHandler {
   Status ReinitializeMuxer(int64_t timestamp);
 
   MuxerOptions options_;
+  const SegmentTemplate segment_template_;
   std::vector<std::shared_ptr<const StreamInfo>> streams_;
   std::vector<uint8_t> current_key_id_;
   bool encryption_started_ = false;
   bool cancelled_ = false;
+  // When the first sample of the current segment arrived, to measure how long
+  // it takes to produce the segment.
+  std::optional<std::chrono::steady_clock::time_point> segment_start_time_;
 
   std::unique_ptr<MuxerListener> muxer_listener_;
   std::unique_ptr<ProgressListener> progress_listener_;
@@ -41,6 +41,10 @@ struct MuxerOptions {
   /// Specify temporary directory for intermediate files.
   std::string temp_dir;
 
+  /// Write single-segment WebM output in one pass, reserving space for the
+  /// Cues up front. Requires a seekable output file.
+  bool webm_one_pass_single_segment = false;
+
   /// User-specified bit rate for the media stream. If zero, the muxer will
   /// attempt to estimate.
   uint32_t bandwidth = 0;
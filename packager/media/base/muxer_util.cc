@@ -6,16 +6,18 @@
 
 #include <packager/media/base/muxer_util.h>
 
-#include <cinttypes>
 #include <string>
 #include <vector>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
+#include <absl/strings/match.h>
 #include <absl/strings/numbers.h>
-#include <absl/strings/str_format.h>
+#include <absl/strings/str_cat.h>
 #include <absl/strings/str_split.h>
 
+#include <packager/file.h>
+#include <packager/media/base/muxer_options.h>
 #include <packager/media/base/video_stream_info.h>
 
 namespace shaka {
@@ -112,59 +114,94 @@ std::string GetSegmentName(const std::string& segment_template,
                            int64_t segment_start_time,
                            uint32_t segment_number,
                            uint32_t bandwidth) {
+  return SegmentTemplate(segment_template)
+      .GetSegmentName(segment_start_time, segment_number, bandwidth);
+}
+
+bool BundlesMp4Segments(const MuxerOptions& options) {
+  return options.mp4_params.segment_bundle_duration_in_seconds > 0 &&
+         !options.mp4_params.low_latency_dash_mode &&
+         !options.segment_template.empty() &&
+         !absl::StartsWith(options.segment_template, kCallbackFilePrefix);
+}
+
+SegmentTemplate::SegmentTemplate(const std::string& segment_template) {
+  if (segment_template.empty())
+    return;
   DCHECK_EQ(Status::OK, ValidateSegmentTemplate(segment_template));
 
   std::vector<std::string> splits = absl::StrSplit(segment_template, "$");
   // "$" always appears in pairs, so there should be odd number of splits.
   DCHECK_EQ(1u, splits.size() % 2);
 
-  std::string segment_name;
+  Token token;
   for (size_t i = 0; i < splits.size(); ++i) {
     // Every second substring in split output should be an identifier.
     // Simply copy the non-identifier part.
     if (i % 2 == 0) {
-      segment_name += splits[i];
+      token.literal += splits[i];
       continue;
     }
     if (splits[i].empty()) {
       // "$$" is an escape sequence, replaced with a single "$".
-      segment_name += "$";
+      token.literal += "$";
       continue;
     }
     size_t format_pos = splits[i].find('%');
     std::string identifier = splits[i].substr(0, format_pos);
     DCHECK(identifier == "Number" || identifier == "Time" ||
            identifier == "Bandwidth");
-
-    std::string format_tag;
-    if (format_pos != std::string::npos) {
-      format_tag = splits[i].substr(format_pos);
-      DCHECK_EQ(Status::OK, ValidateFormatTag(format_tag));
-      // Replace %d formatting to correctly format uint64_t.
-      format_tag = format_tag.substr(0, format_tag.size() - 1) + PRIu64;
-    } else {
-      // Default format tag "%01d", modified to format uint64_t correctly.
-      format_tag = "%01" PRIu64;
-    }
-
-    // absl::StrFormat requires compile-time constants for format strings.
-    // If you don't have that, you build the formatter using this interface
-    // instead.
-    std::vector<absl::FormatArg> format_args;
-    absl::UntypedFormatSpec format(format_tag);
     if (identifier == "Number") {
-      // SegmentNumber starts from 1.
-      format_args.emplace_back(static_cast<uint64_t>(segment_number));
+      token.identifier = Identifier::kNumber;
     } else if (identifier == "Time") {
-      format_args.emplace_back(static_cast<uint64_t>(segment_start_time));
+      token.identifier = Identifier::kTime;
     } else if (identifier == "Bandwidth") {
-      format_args.emplace_back(static_cast<uint64_t>(bandwidth));
+      token.identifier = Identifier::kBandwidth;
     }
 
-    std::string format_output;
-    if (absl::FormatUntyped(&format_output, format, format_args)) {
-      segment_name += format_output;
+    if (format_pos != std::string::npos) {
+      // The format tag is %0[width]d.
+      const std::string format_tag = splits[i].substr(format_pos);
+      DCHECK_EQ(Status::OK, ValidateFormatTag(format_tag));
+      unsigned width = 0;
+      if (absl::SimpleAtoi(format_tag.substr(2, format_tag.size() - 3),
+                           &width)) {
+        token.width = width;
+      }
+    }
+    tokens_.push_back(std::move(token));
+    token = Token();
+  }
+  if (!token.literal.empty())
+    tokens_.push_back(std::move(token));
+}
+
+std::string SegmentTemplate::GetSegmentName(int64_t segment_start_time,
+                                            uint32_t segment_number,
+                                            uint32_t bandwidth) const {
+  std::string segment_name;
+  for (const Token& token : tokens_) {
+    segment_name += token.literal;
+
+    uint64_t value = 0;
+    switch (token.identifier) {
+      case Identifier::kNone:
+        continue;
+      case Identifier::kNumber:
+        // SegmentNumber starts from 1.
+        value = segment_number;
+        break;
+      case Identifier::kTime:
+        value = static_cast<uint64_t>(segment_start_time);
+        break;
+      case Identifier::kBandwidth:
+        value = bandwidth;
+        break;
     }
+    const absl::AlphaNum digits(value);
+    if (digits.size() < token.width)
+      segment_name.append(token.width - digits.size(), '0');
+    segment_name.append(digits.data(), digits.size());
   }
   return segment_name;
 }
@@ -10,12 +10,15 @@
 #define PACKAGER_MEDIA_BASE_MUXER_UTIL_H_
 
 #include <cstdint>
+#include <string>
+#include <vector>
 
 #include <packager/status.h>
 
 namespace shaka {
 namespace media {
 
+struct MuxerOptions;
 class StreamInfo;
 
 /// Validates the segment template against segment URL construction rule
@@ -37,6 +40,46 @@ std::string GetSegmentName(const std::string& segment_template,
                            uint32_t segment_number,
                            uint32_t bandwidth);
 
+/// @return true if the media segments of an MP4 output with @a options are
+///         appended to bundle files, see
+///         Mp4OutputParams::segment_bundle_duration_in_seconds.
+bool BundlesMp4Segments(const MuxerOptions& options);
+
+/// A segment template which is parsed once, for building the names of the
+/// segments of a stream without parsing the template again for each segment.
+class SegmentTemplate {
+ public:
+  /// Creates an empty template, which builds empty segment names.
+  SegmentTemplate() = default;
+
+  /// @param segment_template is the segment template pattern, which should
+  ///        comply with ISO/IEC 23009-1:2012 5.3.9.4.4.
+  explicit SegmentTemplate(const std::string& segment_template);
+
+  /// Same as the GetSegmentName() function with this template.
+  std::string GetSegmentName(int64_t segment_start_time,
+                             uint32_t segment_number,
+                             uint32_t bandwidth) const;
+
+ private:
+  enum class Identifier {
+    kNone,
+    kNumber,
+    kTime,
+    kBandwidth,
+  };
+
+  // A literal string followed by an identifier, if any.
+  struct Token {
+    std::string literal;
+    Identifier identifier = Identifier::kNone;
+    // The minimum width of the identifier, which is padded with zeros.
+    size_t width = 1;
+  };
+
+  std::vector<Token> tokens_;
+};
+
 }  // namespace media
 }  // namespace shaka
 
@@ -115,5 +115,23 @@ TEST(MuxerUtilTest, GetSegmentNameLargeTime) {
                                             kSegmentNumber, kBandwidth));
 }
 
+TEST(MuxerUtilTest, SegmentTemplate) {
+  const uint32_t kBandwidth = 1234;
+  const SegmentTemplate segment_template("$$seg-$Number%03d$-$Bandwidth$.ts");
+  EXPECT_EQ("$seg-001-1234.ts",
+            segment_template.GetSegmentName(0, 1, kBandwidth));
+  EXPECT_EQ("$seg-012-1234.ts",
+            segment_template.GetSegmentName(0, 12, kBandwidth));
+  EXPECT_EQ("$seg-12345-1234.ts",
+            segment_template.GetSegmentName(0, 12345, kBandwidth));
+
+  const SegmentTemplate time_template("$Time%05d$");
+  EXPECT_EQ("00000", time_template.GetSegmentName(0, 1, kBandwidth));
+  EXPECT_EQ("1601599839840",
+            time_template.GetSegmentName(1601599839840LL, 1, kBandwidth));
+
+  EXPECT_EQ("", SegmentTemplate().GetSegmentName(0, 1, kBandwidth));
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -49,6 +49,13 @@ class OffsetByteQueue {
   ///         buffered are still cleared).
   bool Trim(int64_t max_offset);
 
+  /// Get a reference counted pointer to buffered bytes without copying them.
+  /// See ByteQueue::Share().
+  /// @param buf points to a buffered byte, as returned by Peek() or PeekAt().
+  std::shared_ptr<const uint8_t> Share(const uint8_t* buf) const {
+    return queue_.Share(buf);
+  }
+
   /// @return The head position, in terms of the file's absolute offset.
   int64_t head() { return head_; }
   /// @return The tail position (exclusive), in terms of the file's absolute
@@ -91,5 +91,25 @@ TEST_F(OffsetByteQueueTest, Trim) {
   EXPECT_TRUE(queue_->Trim(512));
 }
 
+TEST_F(OffsetByteQueueTest, Share) {
+  const uint8_t* buf;
+  int size;
+  queue_->PeekAt(400, &buf, &size);
+  std::shared_ptr<const uint8_t> shared = queue_->Share(buf);
+  EXPECT_EQ(buf, shared.get());
+
+  // Shared bytes must survive the queue being drained and refilled.
+  uint8_t new_data[1024];
+  memset(new_data, 0xff, sizeof(new_data));
+  queue_->Trim(512);
+  queue_->Push(new_data, sizeof(new_data));
+  queue_->Push(new_data, sizeof(new_data));
+  queue_->Reset();
+  queue_->Push(new_data, sizeof(new_data));
+
+  for (int i = 0; i < 512 - 400; i++)
+    EXPECT_EQ(400 - 256 + i, shared.get()[i]);
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -0,0 +1,193 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/openssl_aes_cipher.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <absl/log/check.h>
+#include <openssl/evp.h>
+
+#include <packager/macros/crypto.h>
+
+namespace shaka {
+namespace media {
+
+const char kOpensslBackend[] = "openssl";
+
+namespace {
+
+// EVP_CipherUpdate() takes an int size, so larger inputs are split in chunks
+// of whole blocks.
+const size_t kMaxChunkSize = 1 << 30;
+
+struct EvpCipherCtxDeleter {
+  void operator()(EVP_CIPHER_CTX* ctx) const { EVP_CIPHER_CTX_free(ctx); }
+};
+using ScopedEvpCipherCtx =
+    std::unique_ptr<EVP_CIPHER_CTX, EvpCipherCtxDeleter>;
+
+// Adds |num_blocks| to the 128-bit big endian counter at |counter|.
+void AddToCounter(uint64_t num_blocks, uint8_t* counter) {
+  for (int i = AES_BLOCK_SIZE - 1; i >= 0 && num_blocks != 0; --i) {
+    num_blocks += counter[i];
+    counter[i] = static_cast<uint8_t>(num_blocks);
+    num_blocks >>= 8;
+  }
+}
+
+class OpensslAesCipher : public AesCipher {
+ public:
+  OpensslAesCipher() = default;
+
+  bool SetKey(const std::vector<uint8_t>& key, Direction direction) override {
+    const EVP_CIPHER* ctr_cipher = nullptr;
+    const EVP_CIPHER* ecb_cipher = nullptr;
+    const EVP_CIPHER* cbc_cipher = nullptr;
+    switch (key.size()) {
+      case 16:
+        ctr_cipher = EVP_aes_128_ctr();
+        ecb_cipher = EVP_aes_128_ecb();
+        cbc_cipher = EVP_aes_128_cbc();
+        break;
+      case 24:
+        ctr_cipher = EVP_aes_192_ctr();
+        ecb_cipher = EVP_aes_192_ecb();
+        cbc_cipher = EVP_aes_192_cbc();
+        break;
+      case 32:
+        ctr_cipher = EVP_aes_256_ctr();
+        ecb_cipher = EVP_aes_256_ecb();
+        cbc_cipher = EVP_aes_256_cbc();
+        break;
+      default:
+        return false;
+    }
+
+    const int encrypt = direction == Direction::kEncrypt ? 1 : 0;
+    cbc_ctx_.reset(EVP_CIPHER_CTX_new());
+    if (!cbc_ctx_ || !EVP_CipherInit_ex(cbc_ctx_.get(), cbc_cipher, nullptr,
+                                        key.data(), nullptr, encrypt)) {
+      return false;
+    }
+    // The padding schemes are handled by the cryptors.
+    EVP_CIPHER_CTX_set_padding(cbc_ctx_.get(), 0);
+
+    // Counter mode always encrypts the counters.
+    ctr_ctx_.reset();
+    ecb_ctx_.reset();
+    if (direction == Direction::kDecrypt)
+      return true;
+    ctr_ctx_.reset(EVP_CIPHER_CTX_new());
+    ecb_ctx_.reset(EVP_CIPHER_CTX_new());
+    return ctr_ctx_ && ecb_ctx_ &&
+           EVP_EncryptInit_ex(ctr_ctx_.get(), ctr_cipher, nullptr, key.data(),
+                              nullptr) &&
+           EVP_EncryptInit_ex(ecb_ctx_.get(), ecb_cipher, nullptr, key.data(),
+                              nullptr) &&
+           EVP_CIPHER_CTX_set_padding(ecb_ctx_.get(), 0);
+  }
+
+  bool CryptCtr(const uint8_t* input,
+                size_t size,
+                uint8_t* output,
+                uint8_t* counter,
+                size_t* block_offset,
+                uint8_t* stream_block) override {
+    DCHECK(ctr_ctx_);
+    // The rest of the current key stream block.
+    size_t offset = *block_offset;
+    while (size > 0 && offset != 0) {
+      *output++ = *input++ ^ stream_block[offset];
+      offset = (offset + 1) % AES_BLOCK_SIZE;
+      --size;
+    }
+
+    // The whole blocks, in counter mode from |counter|, which is then moved
+    // past them. The EVP context keeps its own copy of the counter.
+    while (size >= AES_BLOCK_SIZE) {
+      const size_t chunk_size =
+          std::min(size, kMaxChunkSize) / AES_BLOCK_SIZE * AES_BLOCK_SIZE;
+      int output_size = 0;
+      if (!EVP_EncryptInit_ex(ctr_ctx_.get(), nullptr, nullptr, nullptr,
+                              counter) ||
+          !EVP_EncryptUpdate(ctr_ctx_.get(), output, &output_size, input,
+                             static_cast<int>(chunk_size)) ||
+          static_cast<size_t>(output_size) != chunk_size) {
+        return false;
+      }
+      AddToCounter(chunk_size / AES_BLOCK_SIZE, counter);
+      input += chunk_size;
+      output += chunk_size;
+      size -= chunk_size;
+    }
+
+    // The partial last block, from a new key stream block which is kept for
+    // the next call.
+    if (size > 0) {
+      int output_size = 0;
+      if (!EVP_EncryptUpdate(ecb_ctx_.get(), stream_block, &output_size,
+                             counter, AES_BLOCK_SIZE) ||
+          output_size != AES_BLOCK_SIZE) {
+        return false;
+      }
+      AddToCounter(1, counter);
+      for (size_t i = 0; i < size; ++i)
+        output[i] = input[i] ^ stream_block[i];
+      offset = size;
+    }
+    *block_offset = offset;
+    return true;
+  }
+
+  bool CryptCbc(const uint8_t* input,
+                size_t size,
+                uint8_t* output,
+                uint8_t* iv) override {
+    DCHECK(cbc_ctx_);
+    DCHECK_EQ(size % AES_BLOCK_SIZE, 0u);
+    if (size == 0)
+      return true;
+    // Decryption chains from the last ciphertext block of the input, which
+    // may be overwritten in place.
+    const bool encrypt = EVP_CIPHER_CTX_encrypting(cbc_ctx_.get());
+    uint8_t next_iv[AES_BLOCK_SIZE];
+    if (!encrypt)
+      memcpy(next_iv, input + size - AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+
+    if (!EVP_CipherInit_ex(cbc_ctx_.get(), nullptr, nullptr, nullptr, iv, -1))
+      return false;
+    for (size_t offset = 0; offset < size;) {
+      const size_t chunk_size = std::min(size - offset, kMaxChunkSize);
+      int output_size = 0;
+      if (!EVP_CipherUpdate(cbc_ctx_.get(), output + offset, &output_size,
+                            input + offset, static_cast<int>(chunk_size)) ||
+          static_cast<size_t>(output_size) != chunk_size) {
+        return false;
+      }
+      offset += chunk_size;
+    }
+
+    memcpy(iv, encrypt ? output + size - AES_BLOCK_SIZE : next_iv,
+           AES_BLOCK_SIZE);
+    return true;
+  }
+
+ private:
+  ScopedEvpCipherCtx ctr_ctx_;
+  ScopedEvpCipherCtx ecb_ctx_;
+  ScopedEvpCipherCtx cbc_ctx_;
+};
+
+}  // namespace
+
+std::unique_ptr<AesCipher> CreateOpensslAesCipher() {
+  return std::unique_ptr<AesCipher>(new OpensslAesCipher);
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,30 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// AES cipher backend implemented with the EVP interface of OpenSSL, or of
+// BoringSSL which provides the same interface. Only built with
+// USE_OPENSSL_CRYPTO.
+
+#ifndef PACKAGER_MEDIA_BASE_OPENSSL_AES_CIPHER_H_
+#define PACKAGER_MEDIA_BASE_OPENSSL_AES_CIPHER_H_
+
+#include <memory>
+
+#include <packager/media/base/aes_cipher.h>
+
+namespace shaka {
+namespace media {
+
+/// The name of the OpenSSL backend, for AesCipher::SetBackend().
+extern const char kOpensslBackend[];
+
+/// @return A new AesCipher using OpenSSL.
+std::unique_ptr<AesCipher> CreateOpensslAesCipher();
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_OPENSSL_AES_CIPHER_H_
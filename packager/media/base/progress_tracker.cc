@@ -0,0 +1,132 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/progress_tracker.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace shaka {
+namespace media {
+namespace {
+
+int64_t NowNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+ProgressTracker::ProgressTracker(
+    absl::Duration interval,
+    std::function<void(const PackagingProgress& progress)> callback)
+    : interval_ns_(absl::ToInt64Nanoseconds(interval)),
+      callback_(std::move(callback)) {}
+
+ProgressTracker::Input* ProgressTracker::AddInput() {
+  absl::MutexLock lock(&mutex_);
+  inputs_.emplace_back(new Input);
+  return inputs_.back().get();
+}
+
+void ProgressTracker::Start() {
+  const int64_t now = NowNanoseconds();
+  start_ns_.store(now, std::memory_order_relaxed);
+  next_report_ns_.store(now + interval_ns_, std::memory_order_relaxed);
+}
+
+void ProgressTracker::MaybeReport() {
+  if (!callback_ || start_ns_.load(std::memory_order_relaxed) == 0)
+    return;
+  const int64_t now = NowNanoseconds();
+  int64_t next_report = next_report_ns_.load(std::memory_order_relaxed);
+  if (now < next_report)
+    return;
+  // Only the thread which moves the next report forward reports.
+  if (!next_report_ns_.compare_exchange_strong(next_report,
+                                               now + interval_ns_,
+                                               std::memory_order_relaxed)) {
+    return;
+  }
+  Report();
+}
+
+void ProgressTracker::Report() {
+  if (!callback_)
+    return;
+  const PackagingProgress progress = GetProgress();
+  absl::MutexLock lock(&report_mutex_);
+  callback_(progress);
+}
+
+PackagingProgress ProgressTracker::GetProgress() const {
+  PackagingProgress progress;
+  progress.output_bytes = output_bytes_.load(std::memory_order_relaxed);
+
+  // The packager is as far as its least advanced input which is still read,
+  // or as its longest input once all are read.
+  double fraction = 1;
+  double unfinished_seconds = std::numeric_limits<double>::infinity();
+  double longest_seconds = 0;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (inputs_.empty())
+      fraction = -1;
+    for (const std::unique_ptr<Input>& input : inputs_) {
+      const uint64_t bytes = input->bytes_.load(std::memory_order_relaxed);
+      const int64_t size = input->size_.load(std::memory_order_relaxed);
+      const double duration =
+          input->duration_seconds_.load(std::memory_order_relaxed);
+      const double input_seconds =
+          input->media_seconds_.load(std::memory_order_relaxed);
+      const bool done = input->done_.load(std::memory_order_relaxed);
+      progress.input_bytes += bytes;
+      longest_seconds = std::max(longest_seconds, input_seconds);
+      if (!done)
+        unfinished_seconds = std::min(unfinished_seconds, input_seconds);
+
+      double input_fraction = -1;
+      if (done)
+        input_fraction = 1;
+      else if (duration > 0)
+        input_fraction = std::min(input_seconds / duration, 1.0);
+      else if (size > 0)
+        input_fraction = std::min(static_cast<double>(bytes) / size, 1.0);
+      fraction = input_fraction < 0 || fraction < 0
+                     ? -1
+                     : std::min(fraction, input_fraction);
+    }
+  }
+  const double media_seconds =
+      std::isinf(unfinished_seconds) ? longest_seconds : unfinished_seconds;
+  progress.fraction = fraction;
+  progress.media_seconds = media_seconds;
+
+  const int64_t start = start_ns_.load(std::memory_order_relaxed);
+  if (start == 0)
+    return progress;
+  progress.elapsed_seconds = (NowNanoseconds() - start) / 1e9;
+  if (progress.elapsed_seconds <= 0)
+    return progress;
+  progress.realtime_factor = media_seconds / progress.elapsed_seconds;
+  progress.input_bytes_per_second =
+      progress.input_bytes / progress.elapsed_seconds;
+  progress.output_bytes_per_second =
+      progress.output_bytes / progress.elapsed_seconds;
+  if (fraction >= 1) {
+    progress.eta_seconds = 0;
+  } else if (fraction > 0) {
+    progress.eta_seconds =
+        progress.elapsed_seconds * (1 - fraction) / fraction;
+  }
+  return progress;
+}
+
+}  // namespace media
+}  // namespace shaka
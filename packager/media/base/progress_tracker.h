@@ -0,0 +1,119 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_PROGRESS_TRACKER_H_
+#define PACKAGER_MEDIA_BASE_PROGRESS_TRACKER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/time/time.h>
+
+#include <packager/packager.h>
+
+namespace shaka {
+namespace media {
+
+/// Measures the progress of the jobs of a packager, from the inputs read by
+/// the demuxers and the segments written by the muxers, and reports it
+/// periodically. It is shared by the demuxers and the muxer listeners of the
+/// packager, which update it from their threads with relaxed atomics, so that
+/// tracking costs next to nothing between the reports.
+class ProgressTracker {
+ public:
+  /// The progress of an input, updated by its demuxer.
+  class Input {
+   public:
+    /// @param bytes is the number of bytes of the input just read.
+    void AddBytes(uint64_t bytes) {
+      bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    /// @param size is the size of the input, or -1 if it is unknown.
+    void set_size(int64_t size) {
+      size_.store(size, std::memory_order_relaxed);
+    }
+    /// @param seconds is the duration of the input, or 0 if it is unknown.
+    void set_duration(double seconds) {
+      duration_seconds_.store(seconds, std::memory_order_relaxed);
+    }
+    double duration_seconds() const {
+      return duration_seconds_.load(std::memory_order_relaxed);
+    }
+    /// @param seconds is the media time read so far, from the start of the
+    ///        input. It never goes back.
+    void UpdateMediaTime(double seconds) {
+      if (seconds > media_seconds_.load(std::memory_order_relaxed))
+        media_seconds_.store(seconds, std::memory_order_relaxed);
+    }
+    /// Mark the input as read in full.
+    void set_done() { done_.store(true, std::memory_order_relaxed); }
+
+   private:
+    friend class ProgressTracker;
+
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<int64_t> size_{-1};
+    std::atomic<double> duration_seconds_{0};
+    std::atomic<double> media_seconds_{0};
+    std::atomic<bool> done_{false};
+  };
+
+  /// @param interval is the time between two reports.
+  /// @param callback is called with the progress every @a interval, from the
+  ///        threads of the demuxers and the muxers, one call at a time. It
+  ///        can be null, to only poll GetProgress().
+  ProgressTracker(
+      absl::Duration interval,
+      std::function<void(const PackagingProgress& progress)> callback);
+
+  /// Add an input. Call it before the jobs run.
+  /// @return the progress of the input, owned by the tracker.
+  Input* AddInput();
+
+  /// @param bytes is the number of bytes just written to an output.
+  void AddOutputBytes(uint64_t bytes) {
+    output_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  /// Start the clock of the rates, when the jobs start running.
+  void Start();
+
+  /// Call the callback if the last report is older than the interval.
+  void MaybeReport();
+
+  /// Call the callback now, e.g. once the jobs have completed.
+  void Report();
+
+  /// @return the progress so far.
+  PackagingProgress GetProgress() const;
+
+ private:
+  ProgressTracker(const ProgressTracker&) = delete;
+  ProgressTracker& operator=(const ProgressTracker&) = delete;
+
+  const int64_t interval_ns_;
+  const std::function<void(const PackagingProgress& progress)> callback_;
+
+  mutable absl::Mutex mutex_;
+  std::vector<std::unique_ptr<Input>> inputs_ ABSL_GUARDED_BY(mutex_);
+  std::atomic<uint64_t> output_bytes_{0};
+  // The monotonic times at which the jobs started, or 0, and of the next
+  // report, which the thread reporting claims.
+  std::atomic<int64_t> start_ns_{0};
+  std::atomic<int64_t> next_report_ns_{0};
+  // Serializes the calls to |callback_|.
+  absl::Mutex report_mutex_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_PROGRESS_TRACKER_H_
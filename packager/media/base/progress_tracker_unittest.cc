@@ -0,0 +1,122 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/progress_tracker.h>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace shaka {
+namespace media {
+
+TEST(ProgressTrackerTest, NoInput) {
+  ProgressTracker tracker(absl::Seconds(1), nullptr);
+  const PackagingProgress progress = tracker.GetProgress();
+  EXPECT_EQ(-1, progress.fraction);
+  EXPECT_EQ(0, progress.media_seconds);
+  EXPECT_EQ(-1, progress.eta_seconds);
+}
+
+TEST(ProgressTrackerTest, FractionOfLeastAdvancedInput) {
+  ProgressTracker tracker(absl::Seconds(1), nullptr);
+  ProgressTracker::Input* by_duration = tracker.AddInput();
+  by_duration->set_duration(100);
+  by_duration->UpdateMediaTime(50);
+  ProgressTracker::Input* by_size = tracker.AddInput();
+  by_size->set_size(1000);
+  by_size->AddBytes(250);
+  by_size->UpdateMediaTime(20);
+  tracker.AddOutputBytes(300);
+
+  PackagingProgress progress = tracker.GetProgress();
+  EXPECT_DOUBLE_EQ(0.25, progress.fraction);
+  EXPECT_DOUBLE_EQ(20, progress.media_seconds);
+  EXPECT_EQ(250u, progress.input_bytes);
+  EXPECT_EQ(300u, progress.output_bytes);
+  // Not started yet.
+  EXPECT_EQ(0, progress.elapsed_seconds);
+  EXPECT_EQ(-1, progress.eta_seconds);
+
+  tracker.Start();
+  progress = tracker.GetProgress();
+  EXPECT_GE(progress.elapsed_seconds, 0);
+  if (progress.elapsed_seconds > 0) {
+    EXPECT_DOUBLE_EQ(progress.elapsed_seconds * 3, progress.eta_seconds);
+    EXPECT_DOUBLE_EQ(20 / progress.elapsed_seconds, progress.realtime_factor);
+  }
+
+  // The inputs read in full no longer hold the media time back.
+  by_size->set_done();
+  progress = tracker.GetProgress();
+  EXPECT_DOUBLE_EQ(0.5, progress.fraction);
+  EXPECT_DOUBLE_EQ(50, progress.media_seconds);
+}
+
+TEST(ProgressTrackerTest, UnknownFraction) {
+  ProgressTracker tracker(absl::Seconds(1), nullptr);
+  ProgressTracker::Input* live = tracker.AddInput();
+  live->AddBytes(100);
+  live->UpdateMediaTime(10);
+  ProgressTracker::Input* vod = tracker.AddInput();
+  vod->set_duration(100);
+  vod->UpdateMediaTime(30);
+
+  const PackagingProgress progress = tracker.GetProgress();
+  EXPECT_EQ(-1, progress.fraction);
+  EXPECT_DOUBLE_EQ(10, progress.media_seconds);
+}
+
+TEST(ProgressTrackerTest, MediaTimeNeverGoesBack) {
+  ProgressTracker tracker(absl::Seconds(1), nullptr);
+  ProgressTracker::Input* input = tracker.AddInput();
+  input->UpdateMediaTime(10);
+  input->UpdateMediaTime(5);
+  EXPECT_DOUBLE_EQ(10, tracker.GetProgress().media_seconds);
+}
+
+TEST(ProgressTrackerTest, Reports) {
+  std::vector<PackagingProgress> reports;
+  ProgressTracker tracker(
+      absl::ZeroDuration(),
+      [&reports](const PackagingProgress& progress) {
+        reports.push_back(progress);
+      });
+  ProgressTracker::Input* input = tracker.AddInput();
+  input->set_size(100);
+
+  // Nothing is reported until the jobs run.
+  tracker.MaybeReport();
+  EXPECT_TRUE(reports.empty());
+
+  tracker.Start();
+  input->AddBytes(100);
+  tracker.MaybeReport();
+  ASSERT_EQ(1u, reports.size());
+  EXPECT_DOUBLE_EQ(1, reports[0].fraction);
+  EXPECT_EQ(0, reports[0].eta_seconds);
+
+  input->set_done();
+  tracker.Report();
+  ASSERT_EQ(2u, reports.size());
+  EXPECT_DOUBLE_EQ(1, reports[1].fraction);
+}
+
+TEST(ProgressTrackerTest, ReportsOncePerInterval) {
+  int num_reports = 0;
+  ProgressTracker tracker(
+      absl::Hours(1),
+      [&num_reports](const PackagingProgress&) { ++num_reports; });
+  tracker.Start();
+  tracker.MaybeReport();
+  tracker.MaybeReport();
+  EXPECT_EQ(0, num_reports);
+  tracker.Report();
+  EXPECT_EQ(1, num_reports);
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -37,17 +37,12 @@ Status RawKeySource::FetchKeys(EmeInitDataType init_data_type,
 Status RawKeySource::GetKey(const std::string& stream_label,
                             EncryptionKey* key) {
   DCHECK(key);
-  // Try to find the key with label |stream_label|. If it is not available,
-  // fall back to the default empty label if it is available.
-  auto iter = encryption_key_map_.find(stream_label);
-  if (iter == encryption_key_map_.end()) {
-    iter = encryption_key_map_.find(kEmptyDrmLabel);
-    if (iter == encryption_key_map_.end()) {
-      return Status(error::NOT_FOUND,
-                    "Key for '" + stream_label + "' was not found.");
-    }
+  const EncryptionKey* encryption_key = FindKey(stream_label);
+  if (!encryption_key) {
+    return Status(error::NOT_FOUND,
+                  "Key for '" + stream_label + "' was not found.");
   }
-  *key = *iter->second;
+  *key = *encryption_key;
   return Status::OK;
 }
 
@@ -79,7 +74,7 @@ Status RawKeySource::GetCryptoPeriodKey(
   // key, key_id and pssh. Note that this implementation is only intended for
   // testing purpose. The actual key rotation algorithm can be much more
   // complicated.
-  LOG(WARNING)
+  LOG_FIRST_N(WARNING, 1)
       << "This naive key rotation algorithm should not be used in production.";
   std::rotate(key->key_id.begin(),
               key->key_id.begin() + (crypto_period_index % key->key_id.size()),
@@ -146,7 +141,19 @@ std::unique_ptr<RawKeySource> RawKeySource::Create(
 RawKeySource::RawKeySource() {}
 
 RawKeySource::RawKeySource(EncryptionKeyMap&& encryption_key_map)
-    : encryption_key_map_(std::move(encryption_key_map)) {}
+    : encryption_key_map_(std::move(encryption_key_map)) {
+  auto iter = encryption_key_map_.find(kEmptyDrmLabel);
+  if (iter != encryption_key_map_.end())
+    default_key_ = iter->second.get();
+}
+
+const EncryptionKey* RawKeySource::FindKey(
+    const std::string& stream_label) const {
+  // Try to find the key with label |stream_label|. If it is not available,
+  // fall back to the default empty label if it is available.
+  auto iter = encryption_key_map_.find(stream_label);
+  return iter != encryption_key_map_.end() ? iter->second.get() : default_key_;
+}
 
 }  // namespace media
 }  // namespace shaka
@@ -49,7 +49,15 @@ class RawKeySource : public KeySource {
   RawKeySource(const RawKeySource&) = delete;
   RawKeySource& operator=(const RawKeySource&) = delete;
 
+  // @return the key of |stream_label|, or the key of the empty label if there
+  //         is no such key, or null if there is neither.
+  const EncryptionKey* FindKey(const std::string& stream_label) const;
+
+  // The keys are not modified after construction, so they can be looked up
+  // concurrently by all the streams without locking.
   EncryptionKeyMap encryption_key_map_;
+  // The key of the empty label, if any, used for the other labels.
+  const EncryptionKey* default_key_ = nullptr;
 };
 
 }  // namespace media
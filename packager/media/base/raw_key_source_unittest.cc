@@ -92,6 +92,24 @@ TEST(RawKeySourceTest, Success) {
   EXPECT_HEX_EQ(kPsshBox2Hex, key_from_drm_label.key_system_info[1].psshs);
 }
 
+TEST(RawKeySourceTest, NoKeyForLabel) {
+  RawKeyParams raw_key_params;
+  raw_key_params.key_map[kDrmLabel].key_id = HexStringToVector(kKeyIdHex);
+  raw_key_params.key_map[kDrmLabel].key = HexStringToVector(kKeyHex);
+  raw_key_params.iv = HexStringToVector(kIvHex);
+  std::unique_ptr<RawKeySource> key_source =
+      RawKeySource::Create(raw_key_params);
+  ASSERT_NE(nullptr, key_source);
+
+  // There is no key for the empty label to fall back to.
+  EncryptionKey key;
+  EXPECT_EQ(error::NOT_FOUND,
+            key_source->GetKey(kAnotherDrmLabel, &key).error_code());
+  EXPECT_EQ(error::NOT_FOUND,
+            key_source->GetCryptoPeriodKey(1, 10, kAnotherDrmLabel, &key)
+                .error_code());
+}
+
 TEST(RawKeySourceTest, Failure) {
   // Invalid key id size.
   RawKeyParams raw_key_params;
@@ -0,0 +1,109 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/small_object_pool.h>
+
+#include <new>
+
+namespace shaka {
+namespace media {
+namespace {
+
+// Sizes are rounded up to a multiple of kGranularity, which keeps the blocks
+// aligned as the heap aligns them.
+const size_t kGranularity = alignof(std::max_align_t);
+const size_t kNumSizeClasses =
+    (SmallObjectPool::kMaxSize + kGranularity - 1) / kGranularity;
+// The most blocks kept per size class and per thread. Bounds the memory held
+// by a thread which frees more blocks than it allocates, e.g. a muxer thread
+// releasing the samples of a demuxer thread.
+const size_t kMaxFreeBlocks = 512;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+size_t SizeClass(size_t size) {
+  return size == 0 ? 0 : (size - 1) / kGranularity;
+}
+
+size_t BlockSize(size_t size_class) {
+  return (size_class + 1) * kGranularity;
+}
+
+class ThreadCache {
+ public:
+  ThreadCache() = default;
+  ~ThreadCache();
+
+  void* Allocate(size_t size_class) {
+    FreeBlock* block = free_lists_[size_class];
+    if (!block)
+      return ::operator new(BlockSize(size_class));
+    free_lists_[size_class] = block->next;
+    --num_free_blocks_[size_class];
+    return block;
+  }
+
+  void Free(void* ptr, size_t size_class) {
+    if (num_free_blocks_[size_class] >= kMaxFreeBlocks) {
+      ::operator delete(ptr);
+      return;
+    }
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = free_lists_[size_class];
+    free_lists_[size_class] = block;
+    ++num_free_blocks_[size_class];
+  }
+
+ private:
+  ThreadCache(const ThreadCache&) = delete;
+  ThreadCache& operator=(const ThreadCache&) = delete;
+
+  FreeBlock* free_lists_[kNumSizeClasses] = {};
+  size_t num_free_blocks_[kNumSizeClasses] = {};
+};
+
+// Objects may still be freed by the destructors of other thread locals after
+// the cache of their thread is gone. They then go straight to the heap.
+thread_local bool g_thread_cache_destroyed = false;
+thread_local ThreadCache g_thread_cache;
+
+ThreadCache::~ThreadCache() {
+  g_thread_cache_destroyed = true;
+  for (FreeBlock*& block : free_lists_) {
+    while (block) {
+      FreeBlock* next = block->next;
+      ::operator delete(block);
+      block = next;
+    }
+  }
+}
+
+}  // namespace
+
+// static
+void* SmallObjectPool::Allocate(size_t size) {
+  if (size > kMaxSize)
+    return ::operator new(size);
+  if (g_thread_cache_destroyed)
+    return ::operator new(BlockSize(SizeClass(size)));
+  return g_thread_cache.Allocate(SizeClass(size));
+}
+
+// static
+void SmallObjectPool::Free(void* ptr, size_t size) {
+  if (!ptr)
+    return;
+  if (size > kMaxSize || g_thread_cache_destroyed) {
+    ::operator delete(ptr);
+    return;
+  }
+  g_thread_cache.Free(ptr, SizeClass(size));
+}
+
+}  // namespace media
+}  // namespace shaka
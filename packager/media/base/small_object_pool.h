@@ -0,0 +1,62 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_SMALL_OBJECT_POOL_H_
+#define PACKAGER_MEDIA_BASE_SMALL_OBJECT_POOL_H_
+
+#include <cstddef>
+
+namespace shaka {
+namespace media {
+
+/// Recycles the memory of the small objects created for every sample, e.g.
+/// StreamData and MediaSample. Freed blocks are kept in a free list per size
+/// class and per thread, so allocating and freeing them takes no lock. A block
+/// may be freed by another thread than the one which allocated it; it then
+/// joins the free list of that thread. The free lists are bounded, the blocks
+/// beyond the bound go back to the heap.
+class SmallObjectPool {
+ public:
+  /// The largest size served from the pool. Larger blocks come from the heap.
+  static constexpr size_t kMaxSize = 256;
+
+  static void* Allocate(size_t size);
+  /// @param size must be the size passed to Allocate().
+  static void Free(void* ptr, size_t size);
+};
+
+/// An allocator drawing from SmallObjectPool, e.g. for the control blocks of
+/// shared pointers.
+template <typename T>
+class SmallObjectAllocator {
+ public:
+  using value_type = T;
+
+  SmallObjectAllocator() = default;
+  template <typename U>
+  SmallObjectAllocator(const SmallObjectAllocator<U>&) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(SmallObjectPool::Allocate(n * sizeof(T)));
+  }
+  void deallocate(T* ptr, size_t n) {
+    SmallObjectPool::Free(ptr, n * sizeof(T));
+  }
+
+  template <typename U>
+  bool operator==(const SmallObjectAllocator<U>&) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const SmallObjectAllocator<U>&) const {
+    return false;
+  }
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_SMALL_OBJECT_POOL_H_
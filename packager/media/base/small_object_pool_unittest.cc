@@ -0,0 +1,57 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/small_object_pool.h>
+
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <packager/media/base/media_sample.h>
+
+namespace shaka {
+namespace media {
+
+TEST(SmallObjectPoolTest, ReusesFreedBlocks) {
+  void* ptr = SmallObjectPool::Allocate(40);
+  SmallObjectPool::Free(ptr, 40);
+  // Sizes of the same size class share the free list.
+  EXPECT_EQ(ptr, SmallObjectPool::Allocate(48));
+  SmallObjectPool::Free(ptr, 48);
+}
+
+TEST(SmallObjectPoolTest, LargeBlocks) {
+  const size_t kSize = SmallObjectPool::kMaxSize + 1;
+  void* ptr = SmallObjectPool::Allocate(kSize);
+  memset(ptr, 0, kSize);
+  SmallObjectPool::Free(ptr, kSize);
+}
+
+TEST(SmallObjectPoolTest, FreeOnAnotherThread) {
+  std::vector<void*> blocks;
+  for (int i = 0; i < 1000; ++i)
+    blocks.push_back(SmallObjectPool::Allocate(64));
+  std::thread([&blocks]() {
+    for (void* ptr : blocks)
+      SmallObjectPool::Free(ptr, 64);
+  }).join();
+}
+
+TEST(SmallObjectPoolTest, SharedMediaSample) {
+  const uint8_t kData[] = {1, 2, 3};
+  std::shared_ptr<MediaSample> sample =
+      MediaSample::CopyFrom(kData, sizeof(kData), true);
+  std::shared_ptr<MediaSample> clone = sample->Clone();
+  sample.reset();
+  ASSERT_EQ(sizeof(kData), clone->data_size());
+  EXPECT_EQ(0, memcmp(kData, clone->data(), sizeof(kData)));
+}
+
+}  // namespace media
+}  // namespace shaka
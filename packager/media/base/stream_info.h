@@ -7,10 +7,16 @@
 #ifndef PACKAGER_MEDIA_BASE_STREAM_INFO_H_
 #define PACKAGER_MEDIA_BASE_STREAM_INFO_H_
 
+#include <functional>
+#include <map>
 #include <memory>
 #include <string>
+#include <typeindex>
+#include <typeinfo>
 #include <vector>
 
+#include <absl/synchronization/mutex.h>
+
 #include <packager/media/base/encryption_config.h>
 
 namespace shaka {
@@ -112,9 +118,13 @@ class StreamInfo {
   }
 
   void set_duration(int64_t duration) { duration_ = duration; }
-  void set_codec(Codec codec) { codec_ = codec; }
+  void set_codec(Codec codec) {
+    codec_ = codec;
+    codec_contexts_ = std::make_shared<CodecContexts>();
+  }
   void set_codec_config(const std::vector<uint8_t>& data) {
     codec_config_ = data;
+    codec_contexts_ = std::make_shared<CodecContexts>();
   }
   void set_codec_string(const std::string& codec_string) {
     codec_string_ = codec_string;
@@ -128,7 +138,35 @@ class StreamInfo {
     encryption_config_ = encryption_config;
   }
 
+  /// Get an object of type T derived from codec() and codec_config(), e.g. an
+  /// initialized parser, creating it with @a create on first use. The object
+  /// is shared by all the copies of this stream info, e.g. the ones passed to
+  /// the outputs of the same input, so it is only created once per stream. It
+  /// must not be modified. Changing the codec or codec configuration of a
+  /// stream info drops the objects of that stream info.
+  /// @return the object, or nullptr if @a create returned nullptr.
+  template <typename T>
+  std::shared_ptr<const T> GetCodecContext(
+      const std::function<std::unique_ptr<T>()>& create) const {
+    CodecContexts& contexts = *codec_contexts_;
+    absl::MutexLock lock(&contexts.mutex);
+    const std::type_index type(typeid(T));
+    auto iter = contexts.objects.find(type);
+    if (iter == contexts.objects.end()) {
+      iter = contexts.objects
+                 .emplace(type, std::shared_ptr<const T>(create()))
+                 .first;
+    }
+    return std::static_pointer_cast<const T>(iter->second);
+  }
+
  private:
+  struct CodecContexts {
+    absl::Mutex mutex;
+    std::map<std::type_index, std::shared_ptr<const void>> objects
+        ABSL_GUARDED_BY(mutex);
+  };
+
   // Whether the stream is Audio or Video.
   StreamType stream_type_;
   uint32_t track_id_;
@@ -149,6 +187,9 @@ class StreamInfo {
   // Optional byte data required for some audio/video decoders such as Vorbis
   // codebooks.
   std::vector<uint8_t> codec_config_;
+  // Shared by the copies of this stream info.
+  std::shared_ptr<CodecContexts> codec_contexts_ =
+      std::make_shared<CodecContexts>();
 
   // Not using DISALLOW_COPY_AND_ASSIGN here intentionally to allow the compiler
   // generated copy constructor and assignment operator. Since the extra data is
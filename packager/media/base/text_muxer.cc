@@ -84,8 +84,7 @@ Status TextMuxer::FinalizeSegment(size_t stream_id,
 
   total_duration_ms_ += segment_info.duration;
 
-  const std::string& segment_template = options().segment_template;
-  DCHECK(!segment_template.empty());
+  DCHECK(!options().segment_template.empty());
 
   const int64_t start = segment_info.start_timestamp;
   const int64_t duration = segment_info.duration;
@@ -94,7 +93,7 @@ Status TextMuxer::FinalizeSegment(size_t stream_id,
   const uint32_t bandwidth = options().bandwidth;
 
   const std::string filename =
-      GetSegmentName(segment_template, start, segment_number, bandwidth);
+      segment_template().GetSegmentName(start, segment_number, bandwidth);
   uint64_t size;
   RETURN_IF_ERROR(WriteToFile(filename, &size));
 
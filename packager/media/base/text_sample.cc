@@ -31,6 +31,24 @@ TextSample::TextSample(const std::string& id,
       settings_(settings),
       body_(body) {}
 
+TextSample::TextSample(const std::string& id,
+                       int64_t start_time,
+                       int64_t end_time,
+                       const TextSettings& settings,
+                       TextFragment&& body)
+    : id_(id),
+      start_time_(start_time),
+      duration_(end_time - start_time),
+      settings_(settings),
+      body_(std::move(body)) {}
+
+std::shared_ptr<TextSample> TextSample::CreateHeartbeat(int64_t time) {
+  auto heartbeat = std::make_shared<TextSample>("", time, time, TextSettings{},
+                                                TextFragment{});
+  heartbeat->is_heartbeat_ = true;
+  return heartbeat;
+}
+
 int64_t TextSample::EndTime() const {
   return start_time_ + duration_;
 }
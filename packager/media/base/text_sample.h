@@ -8,8 +8,10 @@
 #define PACKAGER_MEDIA_BASE_TEXT_SAMPLE_H_
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace shaka {
@@ -98,6 +100,8 @@ struct TextFragment {
       : style(style), body(body) {}
   TextFragment(const TextFragmentStyle& style, const std::string& body)
       : style(style), body(body) {}
+  TextFragment(const TextFragmentStyle& style, std::string&& body)
+      : style(style), body(std::move(body)) {}
   TextFragment(const TextFragmentStyle& style,
                const std::vector<uint8_t>& image)
       : style(style), image(image) {}
@@ -122,6 +126,17 @@ class TextSample {
              int64_t end_time,
              const TextSettings& settings,
              const TextFragment& body);
+  TextSample(const std::string& id,
+             int64_t start_time,
+             int64_t end_time,
+             const TextSettings& settings,
+             TextFragment&& body);
+
+  /// Create a heartbeat, which carries no cue and only marks that the stream
+  /// has advanced to @a time, e.g. while a live subtitle stream is silent.
+  /// The handlers which segment the text use it to end the segments before
+  /// it, and the others ignore it.
+  static std::shared_ptr<TextSample> CreateHeartbeat(int64_t time);
 
   const std::string& id() const { return id_; }
   int64_t start_time() const { return start_time_; }
@@ -133,6 +148,8 @@ class TextSample {
   int32_t sub_stream_index() const { return sub_stream_index_; }
   void set_sub_stream_index(int32_t idx) { sub_stream_index_ = idx; }
 
+  bool is_heartbeat() const { return is_heartbeat_; }
+
  private:
   // Allow the compiler generated copy constructor and assignment operator
   // intentionally. Since the text data is typically small, the performance
@@ -144,6 +161,7 @@ class TextSample {
   const TextSettings settings_;
   const TextFragment body_;
   int32_t sub_stream_index_ = -1;
+  bool is_heartbeat_ = false;
 };
 
 }  // namespace media
@@ -6,6 +6,8 @@
 
 #include <packager/media/base/widevine_key_source.h>
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
 #include <iterator>
 
@@ -16,6 +18,7 @@
 
 #include <packager/macros/logging.h>
 #include <packager/media/base/http_key_fetcher.h>
+#include <packager/media/base/key_cache.h>
 #include <packager/media/base/producer_consumer_queue.h>
 #include <packager/media/base/protection_system_ids.h>
 #include <packager/media/base/protection_system_specific_info.h>
@@ -24,6 +27,7 @@
 #include <packager/media/base/rcheck.h>
 #include <packager/media/base/request_signer.h>
 #include <packager/media/base/widevine_common_encryption.pb.h>
+#include <packager/utils/metrics.h>
 
 ABSL_FLAG(std::string,
           video_feature,
@@ -44,6 +48,16 @@ const int kFirstRetryDelayMilliseconds = 1000;
 // Default crypto period count, which is the number of keys to fetch on every
 // key rotation enabled request.
 const int kDefaultCryptoPeriodCount = 10;
+// The key pool holds ten times the crypto period count. At most half of it is
+// ahead of the consumers, so requests grow up to that size.
+const int kKeyPoolSizeMultiplier = 10;
+const int kMaxCryptoPeriodCountMultiplier = kKeyPoolSizeMultiplier / 2;
+// Using up the crypto periods of a request should take this many times as long
+// as the request.
+const double kFetchLatencySafetyFactor = 2.0;
+// Weight of the latest measurement in the moving averages of the fetch latency
+// and of the crypto period consumption time.
+const double kMovingAverageWeight = 0.25;
 const int kGetKeyTimeoutInSeconds = 5 * 60;  // 5 minutes.
 const int kKeyFetchTimeoutInSeconds = 60;  // 1 minute.
 
@@ -85,6 +99,21 @@ ProtectionSystemSpecificInfo ProtectionSystemInfoFromPsshProto(
   }
 }
 
+// Approximates the memory used by the keys of |key_map|.
+int64_t EstimateKeyMapSize(const EncryptionKeyMap& key_map) {
+  int64_t size = 0;
+  for (const auto& pair : key_map) {
+    const EncryptionKey& key = *pair.second;
+    size += sizeof(EncryptionKey) + pair.first.size() + key.key_id.size() +
+            key.key.size() + key.iv.size();
+    for (const auto& key_id : key.key_ids)
+      size += key_id.size();
+    for (const auto& info : key.key_system_info)
+      size += info.system_id.size() + info.psshs.size();
+  }
+  return size;
+}
+
 }  // namespace
 
 WidevineKeySource::WidevineKeySource(const std::string& server_url,
@@ -100,6 +129,8 @@ WidevineKeySource::WidevineKeySource(const std::string& server_url,
       server_url_(server_url),
       crypto_period_count_(kDefaultCryptoPeriodCount),
       protection_scheme_(protection_scheme),
+      clock_(new Clock),
+      request_crypto_period_count_(crypto_period_count_),
       key_production_thread_(
           std::bind(&WidevineKeySource::FetchKeysTask, this)) {}
 
@@ -193,11 +224,12 @@ Status WidevineKeySource::FetchKeys(EmeInitDataType init_data_type,
 Status WidevineKeySource::GetKey(const std::string& stream_label,
                                  EncryptionKey* key) {
   DCHECK(key);
-  if (encryption_key_map_.find(stream_label) == encryption_key_map_.end()) {
+  auto iter = encryption_key_map_.find(stream_label);
+  if (iter == encryption_key_map_.end()) {
     return Status(error::INTERNAL_ERROR,
                   "Cannot find key for '" + stream_label + "'.");
   }
-  *key = *encryption_key_map_[stream_label];
+  *key = *iter->second;
   return Status::OK;
 }
 
@@ -229,9 +261,11 @@ Status WidevineKeySource::GetCryptoPeriodKey(
       first_crypto_period_index_ =
           crypto_period_index ? crypto_period_index - 1 : 0;
       DCHECK(!key_pool_);
-      const size_t queue_size = crypto_period_count_ * 10;
+      const size_t queue_size = crypto_period_count_ * kKeyPoolSizeMultiplier;
       key_pool_.reset(
           new EncryptionKeyQueue(queue_size, first_crypto_period_index_));
+      if (cancelled_)
+        key_pool_->Stop();
       start_key_production_.Notify();
       key_production_started_ = true;
     }  else if (crypto_period_duration_in_seconds_ !=
@@ -239,6 +273,7 @@ Status WidevineKeySource::GetCryptoPeriodKey(
       return Status(error::INVALID_ARGUMENT,
                     "Crypto period duration should not change.");
     }
+    UpdateCryptoPeriodConsumption(crypto_period_index);
   }
   return GetKeyInternal(crypto_period_index, stream_label, key);
 }
@@ -252,6 +287,18 @@ void WidevineKeySource::set_key_fetcher(
   key_fetcher_ = std::move(key_fetcher);
 }
 
+void WidevineKeySource::set_key_cache(std::shared_ptr<KeyCache> key_cache) {
+  key_cache_ = std::move(key_cache);
+}
+
+void WidevineKeySource::Cancel() {
+  absl::MutexLock scoped_lock(&mutex_);
+  cancelled_ = true;
+  // Wakes up GetKeyInternal() and the thread fetching the keys.
+  if (key_pool_)
+    key_pool_->Stop();
+}
+
 Status WidevineKeySource::GetKeyInternal(uint32_t crypto_period_index,
                                          const std::string& stream_label,
                                          EncryptionKey* key) {
@@ -259,21 +306,30 @@ Status WidevineKeySource::GetKeyInternal(uint32_t crypto_period_index,
   DCHECK(key);
 
   std::shared_ptr<EncryptionKeyMap> encryption_key_map;
-  Status status = key_pool_->Peek(crypto_period_index, &encryption_key_map,
-                                  kGetKeyTimeoutInSeconds * 1000);
+  Status status = key_pool_->Peek(crypto_period_index, &encryption_key_map, 0);
+  if (status.error_code() == error::TIME_OUT) {
+    ++key_stall_count_;
+    VLOG(1) << "Waiting for the keys of crypto period " << crypto_period_index
+            << ".";
+    status = key_pool_->Peek(crypto_period_index, &encryption_key_map,
+                             kGetKeyTimeoutInSeconds * 1000);
+  }
   if (!status.ok()) {
     if (status.error_code() == error::STOPPED) {
+      if (cancelled_)
+        return Status(error::CANCELLED, "Waiting for the keys was cancelled.");
       CHECK(!common_encryption_request_status_.ok());
       return common_encryption_request_status_;
     }
     return status;
   }
 
-  if (encryption_key_map->find(stream_label) == encryption_key_map->end()) {
+  auto iter = encryption_key_map->find(stream_label);
+  if (iter == encryption_key_map->end()) {
     return Status(error::INTERNAL_ERROR,
                   "Cannot find key for '" + stream_label + "'.");
   }
-  *key = *encryption_key_map->at(stream_label);
+  *key = *iter->second;
   return Status::OK;
 }
 
@@ -283,19 +339,84 @@ void WidevineKeySource::FetchKeysTask() {
   if (!key_pool_ || key_pool_->Stopped())
     return;
 
-  Status status = FetchKeysInternal(kEnableKeyRotation,
-                                    first_crypto_period_index_,
-                                    false);
+  Status status = FetchCryptoPeriodKeys();
   while (status.ok()) {
-    first_crypto_period_index_ += crypto_period_count_;
-    status = FetchKeysInternal(kEnableKeyRotation,
-                               first_crypto_period_index_,
-                               false);
+    first_crypto_period_index_ += request_crypto_period_count_;
+    status = FetchCryptoPeriodKeys();
   }
   common_encryption_request_status_ = status;
   key_pool_->Stop();
 }
 
+Status WidevineKeySource::FetchCryptoPeriodKeys() {
+  const Clock::time_point start_time = clock_->now();
+  {
+    absl::MutexLock scoped_lock(&mutex_);
+    request_crypto_period_count_ = GetRequestCryptoPeriodCount();
+  }
+  Status status =
+      FetchKeysInternal(kEnableKeyRotation, first_crypto_period_index_, false);
+  const double fetch_latency_seconds =
+      std::chrono::duration<double>(clock_->now() - start_time).count();
+
+  absl::MutexLock scoped_lock(&mutex_);
+  fetch_latency_seconds_ =
+      fetch_latency_seconds_ == 0
+          ? fetch_latency_seconds
+          : kMovingAverageWeight * fetch_latency_seconds +
+                (1 - kMovingAverageWeight) * fetch_latency_seconds_;
+  return status;
+}
+
+void WidevineKeySource::UpdateCryptoPeriodConsumption(
+    uint32_t crypto_period_index) {
+  const Clock::time_point now = clock_->now();
+  if (!crypto_period_requested_) {
+    crypto_period_requested_ = true;
+  } else if (crypto_period_index > last_requested_crypto_period_index_) {
+    const double seconds =
+        std::chrono::duration<double>(now -
+                                      last_requested_crypto_period_time_)
+            .count() /
+        (crypto_period_index - last_requested_crypto_period_index_);
+    crypto_period_consumption_seconds_ =
+        crypto_period_consumption_seconds_ < 0
+            ? seconds
+            : kMovingAverageWeight * seconds +
+                  (1 - kMovingAverageWeight) *
+                      crypto_period_consumption_seconds_;
+  } else {
+    // The other streams are using up the same crypto periods.
+    return;
+  }
+  last_requested_crypto_period_index_ = crypto_period_index;
+  last_requested_crypto_period_time_ = now;
+}
+
+int WidevineKeySource::GetRequestCryptoPeriodCount() const {
+  const int max_crypto_period_count =
+      crypto_period_count_ * kMaxCryptoPeriodCountMultiplier;
+  if (fetch_latency_seconds_ <= 0 || crypto_period_consumption_seconds_ < 0)
+    return crypto_period_count_;
+  // Request enough crypto periods so that they are not used up before the
+  // next request completes.
+  const double required_count =
+      crypto_period_consumption_seconds_ > 0
+          ? std::ceil(kFetchLatencySafetyFactor * fetch_latency_seconds_ /
+                      crypto_period_consumption_seconds_)
+          : max_crypto_period_count;
+  const int count = static_cast<int>(std::min<double>(
+      std::max<double>(required_count, crypto_period_count_),
+      max_crypto_period_count));
+  if (count != request_crypto_period_count_) {
+    VLOG(1) << "Requesting " << count << " crypto periods at a time: fetches "
+            << "take " << fetch_latency_seconds_ << " seconds and a crypto "
+            << "period is used up in " << crypto_period_consumption_seconds_
+            << " seconds.";
+  }
+  return count;
+}
+
 Status WidevineKeySource::FetchKeysInternal(bool enable_key_rotation,
                                             uint32_t first_crypto_period_index,
                                             bool widevine_classic) {
@@ -308,20 +429,51 @@ Status WidevineKeySource::FetchKeysInternal(bool enable_key_rotation,
     return status;
   VLOG(1) << "Message: " << message;
 
+  // The signature changes between otherwise identical requests, so the cache
+  // is keyed by the unsigned request.
+  const std::string cache_key =
+      key_cache_ ? server_url_ + "\n" + MessageToJsonString(request) : "";
   std::string raw_response;
+  if (key_cache_ && key_cache_->Get(cache_key, &raw_response)) {
+    bool transient_error = false;
+    if (ExtractEncryptionKey(enable_key_rotation, widevine_classic,
+                             raw_response, &transient_error)) {
+      VLOG(1) << "Using cached response for crypto period "
+              << first_crypto_period_index << ".";
+      return Status::OK;
+    }
+    LOG(WARNING) << "Ignoring invalid cached key response.";
+  }
+
   int64_t sleep_duration = kFirstRetryDelayMilliseconds;
 
   // Perform client side retries if seeing server transient error to workaround
   // server limitation.
+  static MetricDurations* const fetch_durations =
+      MetricsRegistry::GetInstance()->GetDurations(
+          "shaka_key_fetch_seconds",
+          "Time spent in Widevine key server requests.");
+  static MetricCounter* const fetch_failures =
+      MetricsRegistry::GetInstance()->GetCounter(
+          "shaka_key_fetch_failures_total",
+          "Widevine key server requests which failed.");
   for (int i = 0; i < kNumTransientErrorRetries; ++i) {
-    status = key_fetcher_->FetchKeys(server_url_, message, &raw_response);
+    {
+      ScopedMetricTimer timer(fetch_durations);
+      status = key_fetcher_->FetchKeys(server_url_, message, &raw_response);
+    }
+    if (!status.ok())
+      fetch_failures->Increment();
     if (status.ok()) {
       VLOG(1) << "Retry [" << i << "] Response:" << raw_response;
 
       bool transient_error = false;
       if (ExtractEncryptionKey(enable_key_rotation, widevine_classic,
-                               raw_response, &transient_error))
+                               raw_response, &transient_error)) {
+        if (key_cache_)
+          key_cache_->Put(cache_key, raw_response);
         return Status::OK;
+      }
 
       if (!transient_error) {
         return Status(
@@ -359,7 +511,7 @@ void WidevineKeySource::FillRequest(bool enable_key_rotation,
 
   if (enable_key_rotation) {
     request->set_first_crypto_period_index(first_crypto_period_index);
-    request->set_crypto_period_count(crypto_period_count_);
+    request->set_crypto_period_count(request_crypto_period_count_);
     request->set_crypto_period_seconds(crypto_period_duration_in_seconds_);
   }
 
@@ -424,7 +576,7 @@ bool WidevineKeySource::ExtractEncryptionKey(
   }
 
   RCHECK(enable_key_rotation
-             ? response_proto.tracks_size() >= crypto_period_count_
+             ? response_proto.tracks_size() >= request_crypto_period_count_
              : response_proto.tracks_size() >= 1);
 
   uint32_t current_crypto_period_index = first_crypto_period_index_;
@@ -495,6 +647,7 @@ bool WidevineKeySource::PushToKeyPool(
     EncryptionKeyMap* encryption_key_map) {
   DCHECK(key_pool_);
   DCHECK(encryption_key_map);
+  const int64_t key_map_size = EstimateKeyMapSize(*encryption_key_map);
   auto encryption_key_map_shared = std::make_shared<EncryptionKeyMap>();
   encryption_key_map_shared->swap(*encryption_key_map);
   Status status = key_pool_->Push(encryption_key_map_shared, kInfiniteTimeout);
@@ -502,6 +655,8 @@ bool WidevineKeySource::PushToKeyPool(
     DCHECK_EQ(error::STOPPED, status.error_code());
     return false;
   }
+  // The crypto periods have keys of similar sizes.
+  key_pool_memory_.Set(key_pool_->Size() * key_map_size);
   return true;
 }
 
@@ -7,6 +7,7 @@
 #ifndef PACKAGER_MEDIA_BASE_WIDEVINE_KEY_SOURCE_H_
 #define PACKAGER_MEDIA_BASE_WIDEVINE_KEY_SOURCE_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <thread>
@@ -17,6 +18,8 @@
 #include <packager/macros/classes.h>
 #include <packager/media/base/fourccs.h>
 #include <packager/media/base/key_source.h>
+#include <packager/utils/clock.h>
+#include <packager/utils/memory_accounting.h>
 
 namespace shaka {
 
@@ -24,6 +27,7 @@ class CommonEncryptionRequest;
 
 namespace media {
 
+class KeyCache;
 class KeyFetcher;
 class RequestSigner;
 template <class T> class ProducerConsumerQueue;
@@ -55,6 +59,7 @@ class WidevineKeySource : public KeySource {
                             int32_t crypto_period_duration_in_seconds,
                             const std::string& stream_label,
                             EncryptionKey* key) override;
+  void Cancel() override;
   /// @}
 
   /// Fetch keys for CENC from the key server.
@@ -72,6 +77,20 @@ class WidevineKeySource : public KeySource {
   /// @param key_fetcher points to the @b KeyFetcher object to be injected.
   void set_key_fetcher(std::unique_ptr<KeyFetcher> key_fetcher);
 
+  /// Set the cache of key server responses, which can be shared with other
+  /// key sources. Must be called before FetchKeys().
+  /// @param key_cache is consulted before each request to the key server and
+  ///        updated with the successful responses.
+  void set_key_cache(std::shared_ptr<KeyCache> key_cache);
+
+  /// Override the clock used to measure key fetches and the use of crypto
+  /// periods, for testing. Must be called before GetCryptoPeriodKey().
+  void set_clock(std::shared_ptr<Clock> clock) { clock_ = clock; }
+
+  /// @return The number of times GetCryptoPeriodKey() had to wait for the
+  ///         keys of a crypto period to be fetched.
+  uint64_t key_stall_count() const { return key_stall_count_; }
+
   /// Not protected by Mutex.  Must be called before FetchKeys().
   void set_group_id(const std::vector<uint8_t>& group_id) {
     group_id_ = group_id;
@@ -93,6 +112,16 @@ class WidevineKeySource : public KeySource {
 
   // The closure task to fetch keys repeatedly.
   void FetchKeysTask();
+  // Fetch the keys of the crypto periods starting from
+  // |first_crypto_period_index_| and measure how long it takes.
+  Status FetchCryptoPeriodKeys();
+  // Record that the keys of |crypto_period_index| are requested, to measure
+  // how fast crypto periods are used up.
+  void UpdateCryptoPeriodConsumption(uint32_t crypto_period_index)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // @return The number of crypto periods to request at a time, which grows
+  //         when the key server cannot keep up with the use of the keys.
+  int GetRequestCryptoPeriodCount() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   // Fetch keys from server.
   Status FetchKeysInternal(bool enable_key_rotation,
@@ -126,6 +155,7 @@ class WidevineKeySource : public KeySource {
   // It is initialized to a default fetcher on class initialization.
   // Can be overridden using set_key_fetcher for testing or other purposes.
   std::unique_ptr<KeyFetcher> key_fetcher_;
+  std::shared_ptr<KeyCache> key_cache_;
   std::string server_url_;
   std::unique_ptr<RequestSigner> signer_;
   std::unique_ptr<CommonEncryptionRequest> common_encryption_request_;
@@ -141,6 +171,22 @@ class WidevineKeySource : public KeySource {
   std::vector<uint8_t> group_id_;
   bool enable_entitlement_license_ = false;
   std::unique_ptr<EncryptionKeyQueue> key_pool_;
+  // Only updated by the thread fetching the keys.
+  MemoryCharge key_pool_memory_{MemorySubsystem::kKeyPools};
+  std::shared_ptr<Clock> clock_;
+
+  // The number of crypto periods of the current key rotation request.
+  int request_crypto_period_count_;
+  // Moving averages of how long a key rotation request takes and how long
+  // it takes to use up a crypto period. Zero and negative values mean unknown.
+  double fetch_latency_seconds_ ABSL_GUARDED_BY(mutex_) = 0;
+  double crypto_period_consumption_seconds_ ABSL_GUARDED_BY(mutex_) = -1;
+  bool crypto_period_requested_ ABSL_GUARDED_BY(mutex_) = false;
+  uint32_t last_requested_crypto_period_index_ ABSL_GUARDED_BY(mutex_) = 0;
+  Clock::time_point last_requested_crypto_period_time_ ABSL_GUARDED_BY(mutex_);
+  std::atomic<uint64_t> key_stall_count_{0};
+  // Set by Cancel().
+  std::atomic<bool> cancelled_{false};
 
   EncryptionKeyMap encryption_key_map_;  // For non key rotation request.
   Status common_encryption_request_status_;
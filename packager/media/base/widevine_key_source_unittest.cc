@@ -7,8 +7,10 @@
 #include <packager/media/base/widevine_key_source.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <iterator>
+#include <thread>
 
 #include <absl/strings/escaping.h>
 #include <absl/strings/str_format.h>
@@ -16,6 +18,7 @@
 #include <gtest/gtest.h>
 
 #include <packager/macros/classes.h>
+#include <packager/media/base/key_cache.h>
 #include <packager/media/base/key_fetcher.h>
 #include <packager/media/base/protection_system_ids.h>
 #include <packager/media/base/request_signer.h>
@@ -27,7 +30,9 @@ using ::testing::Bool;
 using ::testing::Combine;
 using ::testing::DoAll;
 using ::testing::InSequence;
+using ::testing::Invoke;
 using ::testing::Return;
+using ::testing::SaveArg;
 using ::testing::SetArgPointee;
 using ::testing::StrEq;
 using ::testing::Test;
@@ -210,6 +215,19 @@ class MockRequestSigner : public RequestSigner {
   DISALLOW_COPY_AND_ASSIGN(MockRequestSigner);
 };
 
+class FakeClock : public Clock {
+ public:
+  time_point now() noexcept override {
+    return time_point(std::chrono::milliseconds(now_ms_));
+  }
+  void Advance(std::chrono::milliseconds duration) {
+    now_ms_ += duration.count();
+  }
+
+ private:
+  std::atomic<int64_t> now_ms_{0};
+};
+
 class MockKeyFetcher : public KeyFetcher {
  public:
   MockKeyFetcher() : KeyFetcher() {}
@@ -263,6 +281,7 @@ class WidevineKeySourceTest : public Test {
     widevine_key_source_.reset(new WidevineKeySource(
         kServerUrl, protection_system, protection_scheme_));
     widevine_key_source_->set_key_fetcher(std::move(mock_key_fetcher_));
+    widevine_key_source_->set_clock(clock_);
   }
 
   void VerifyKeys(bool classic, bool has_iv) {
@@ -303,6 +322,7 @@ class WidevineKeySourceTest : public Test {
   std::unique_ptr<MockRequestSigner> mock_request_signer_;
   std::unique_ptr<MockKeyFetcher> mock_key_fetcher_;
   std::unique_ptr<WidevineKeySource> widevine_key_source_;
+  std::shared_ptr<FakeClock> clock_ = std::make_shared<FakeClock>();
   std::vector<uint8_t> content_id_;
   bool add_widevine_pssh_ = false;
   bool add_common_pssh_ = false;
@@ -383,6 +403,28 @@ TEST_F(WidevineKeySourceTest, CheckIv) {
   VerifyKeys(!kClassic, kHasIv);
 }
 
+TEST_F(WidevineKeySourceTest, SharedKeyCache) {
+  std::string mock_response = absl::StrFormat(
+      kHttpResponseFormat, Base64Encode(GenerateMockLicenseResponse()).c_str());
+
+  EXPECT_CALL(*mock_key_fetcher_, FetchKeys(_, _, _))
+      .WillOnce(DoAll(SetArgPointee<2>(mock_response), Return(Status::OK)));
+
+  std::shared_ptr<KeyCache> key_cache(
+      new KeyCache(std::chrono::seconds(3600), "", {}));
+  CreateWidevineKeySource();
+  widevine_key_source_->set_key_cache(key_cache);
+  ASSERT_OK(widevine_key_source_->FetchKeys(content_id_, kPolicy));
+
+  // The second key source gets the keys from the cache.
+  mock_key_fetcher_.reset(new MockKeyFetcher());
+  EXPECT_CALL(*mock_key_fetcher_, FetchKeys(_, _, _)).Times(0);
+  CreateWidevineKeySource();
+  widevine_key_source_->set_key_cache(key_cache);
+  ASSERT_OK(widevine_key_source_->FetchKeys(content_id_, kPolicy));
+  VerifyKeys(!kClassic, !kHasIv);
+}
+
 TEST_F(WidevineKeySourceTest, BoxesInResponse) {
   const char kMockBoxes[] = "mock_pssh_boxes";
   std::string mock_response = absl::StrFormat(
@@ -589,8 +631,106 @@ std::string GenerateMockKeyRotationLicenseResponse(
   return absl::StrFormat(kLicenseResponseFormat, "OK", tracks.c_str());
 }
 
+// Responds to the unsigned key rotation request |message| with the keys of the
+// requested crypto periods, and to other requests with the keys of
+// GenerateMockLicenseResponse. Returns the number of requested crypto periods
+// in |crypto_period_count|.
+Status RespondToRequest(const std::string& message,
+                        std::string* response,
+                        uint32_t* crypto_period_count) {
+  const char kFirstIndexField[] = R"("first_crypto_period_index":)";
+  const char kCountField[] = R"("crypto_period_count":)";
+  const size_t first_index_pos = message.find(kFirstIndexField);
+  const size_t count_pos = message.find(kCountField);
+  std::string license_response;
+  *crypto_period_count = 0;
+  if (first_index_pos == std::string::npos || count_pos == std::string::npos) {
+    license_response = GenerateMockLicenseResponse();
+  } else {
+    const uint32_t first_index = static_cast<uint32_t>(
+        std::stoul(message.substr(first_index_pos + strlen(kFirstIndexField))));
+    *crypto_period_count = static_cast<uint32_t>(
+        std::stoul(message.substr(count_pos + strlen(kCountField))));
+    license_response = GenerateMockKeyRotationLicenseResponse(
+        first_index, *crypto_period_count);
+  }
+  *response = absl::StrFormat(kHttpResponseFormat,
+                              Base64Encode(license_response).c_str());
+  return Status::OK;
+}
+
 }  // namespace
 
+TEST_F(WidevineKeySourceTest, KeyRotationStallCount) {
+  const uint32_t kCryptoPeriodSeconds = 100;
+  // Requests are signed and sent on the same thread. The key production
+  // thread may outlive the locals of the test.
+  auto request = std::make_shared<std::string>();
+  EXPECT_CALL(*mock_request_signer_, GenerateSignature(_, _))
+      .WillRepeatedly(DoAll(SaveArg<0>(request.get()), Return(true)));
+  EXPECT_CALL(*mock_key_fetcher_, FetchKeys(_, _, _))
+      .WillRepeatedly(Invoke([request](const std::string&, const std::string&,
+                                       std::string* response) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        uint32_t crypto_period_count;
+        return RespondToRequest(*request, response, &crypto_period_count);
+      }));
+
+  CreateWidevineKeySource();
+  widevine_key_source_->set_signer(std::move(mock_request_signer_));
+  ASSERT_OK(widevine_key_source_->FetchKeys(content_id_, kPolicy));
+
+  // The keys of the first crypto period are not available until the first
+  // key rotation request completes.
+  EncryptionKey encryption_key;
+  ASSERT_OK(widevine_key_source_->GetCryptoPeriodKey(0, kCryptoPeriodSeconds,
+                                                     "SD", &encryption_key));
+  EXPECT_EQ(1u, widevine_key_source_->key_stall_count());
+
+  // The keys of the next crypto periods come in the same response.
+  for (uint32_t index = 1; index < 10; ++index) {
+    ASSERT_OK(widevine_key_source_->GetCryptoPeriodKey(
+        index, kCryptoPeriodSeconds, "SD", &encryption_key));
+    EXPECT_EQ(GetMockKey("SD", index), ToString(encryption_key.key));
+  }
+  EXPECT_EQ(1u, widevine_key_source_->key_stall_count());
+}
+
+TEST_F(WidevineKeySourceTest, KeyRotationRequestsMoreCryptoPeriodsIfSlow) {
+  const uint32_t kCryptoPeriodSeconds = 100;
+  auto max_crypto_period_count = std::make_shared<std::atomic<uint32_t>>(0);
+  std::shared_ptr<FakeClock> clock = clock_;
+  auto request = std::make_shared<std::string>();
+  EXPECT_CALL(*mock_request_signer_, GenerateSignature(_, _))
+      .WillRepeatedly(DoAll(SaveArg<0>(request.get()), Return(true)));
+  EXPECT_CALL(*mock_key_fetcher_, FetchKeys(_, _, _))
+      .WillRepeatedly(Invoke([clock, request, max_crypto_period_count](
+                                 const std::string&, const std::string&,
+                                 std::string* response) {
+        // Each request takes as long as using up 50 crypto periods.
+        clock->Advance(std::chrono::seconds(50));
+        uint32_t crypto_period_count;
+        Status status =
+            RespondToRequest(*request, response, &crypto_period_count);
+        if (crypto_period_count > *max_crypto_period_count)
+          *max_crypto_period_count = crypto_period_count;
+        return status;
+      }));
+
+  CreateWidevineKeySource();
+  widevine_key_source_->set_signer(std::move(mock_request_signer_));
+  ASSERT_OK(widevine_key_source_->FetchKeys(content_id_, kPolicy));
+
+  EncryptionKey encryption_key;
+  for (uint32_t index = 0; index < 200; ++index) {
+    ASSERT_OK(widevine_key_source_->GetCryptoPeriodKey(
+        index, kCryptoPeriodSeconds, "SD", &encryption_key));
+    EXPECT_EQ(GetMockKey("SD", index), ToString(encryption_key.key));
+    clock_->Advance(std::chrono::seconds(1));
+  }
+  EXPECT_GT(*max_crypto_period_count, 10u);
+}
+
 TEST_P(WidevineKeySourceParameterizedTest, KeyRotationTest) {
   const uint32_t kFirstCryptoPeriodIndex = 8;
   const uint32_t kCryptoPeriodCount = 10;
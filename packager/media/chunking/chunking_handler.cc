@@ -7,6 +7,8 @@
 #include <packager/media/chunking/chunking_handler.h>
 
 #include <algorithm>
+#include <chrono>
+#include <limits>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
@@ -14,6 +16,7 @@
 #include <packager/macros/logging.h>
 #include <packager/macros/status.h>
 #include <packager/media/base/media_sample.h>
+#include <packager/utils/trace.h>
 
 namespace shaka {
 namespace media {
@@ -70,10 +73,10 @@ Status ChunkingHandler::OnFlushRequest(size_t /*input_stream_index*/) {
 
 Status ChunkingHandler::OnStreamInfo(std::shared_ptr<const StreamInfo> info) {
   time_scale_ = info->time_scale();
-  segment_duration_ =
-      chunking_params_.segment_duration_in_seconds * time_scale_;
-  subsegment_duration_ =
-      chunking_params_.subsegment_duration_in_seconds * time_scale_;
+  segment_clock_ =
+      SegmentClock(chunking_params_.segment_duration_in_seconds, time_scale_);
+  subsegment_duration_ = SegmentClock::ToTimeScale(
+      chunking_params_.subsegment_duration_in_seconds, time_scale_);
   return DispatchStreamInfo(kStreamIndex, std::move(info));
 }
 
@@ -84,9 +87,9 @@ Status ChunkingHandler::OnCueEvent(std::shared_ptr<const CueEvent> event) {
 
   // Force start new segment after cue event.
   segment_start_time_ = std::nullopt;
-  // |cue_offset_| will be applied to sample timestamp so the segment after cue
-  // point have duration ~= |segment_duration_|.
-  cue_offset_ = event_time_in_seconds * time_scale_;
+  // The segments after the cue point are aligned to it, so the first one has
+  // a full segment duration.
+  segment_clock_.SetEpoch(event_time_in_seconds);
   return Status::OK;
 }
 
@@ -100,19 +103,19 @@ Status ChunkingHandler::OnMediaSample(
   const bool can_start_new_segment =
       sample->is_key_frame() || !chunking_params_.segment_sap_aligned;
   if (can_start_new_segment) {
-    const int64_t segment_index =
-        timestamp < cue_offset_ ? 0
-                                : (timestamp - cue_offset_) / segment_duration_;
-    if (!segment_start_time_ ||
-        IsNewSegmentIndex(segment_index, current_segment_index_)) {
-      current_segment_index_ = segment_index;
+    // Most samples are in the current segment, which is checked against its
+    // bounds without dividing.
+    if (!segment_start_time_ || timestamp < segment_bounds_.first ||
+        timestamp >= segment_bounds_.second) {
+      SetSegmentIndex(segment_clock_.GetSegmentIndex(timestamp));
       // Reset subsegment index.
-      current_subsegment_index_ = 0;
+      SetSubsegmentIndex(0);
 
       RETURN_IF_ERROR(EndSegmentIfStarted());
       segment_start_time_ = timestamp;
       subsegment_start_time_ = timestamp;
       max_segment_time_ = timestamp + sample->duration();
+      segment_first_sample_time_ = std::chrono::system_clock::now();
       started_new_segment = true;
     }
   }
@@ -122,7 +125,7 @@ Status ChunkingHandler::OnMediaSample(
   // we must increment the current_subsegment_index_
   // in order to hit FinalizeSegment() within Segmenter.
   if (!started_new_segment && chunking_params_.low_latency_dash_mode) {
-    current_subsegment_index_++;
+    SetSubsegmentIndex(current_subsegment_index_ + 1);
 
     RETURN_IF_ERROR(EndSubsegmentIfStarted());
     subsegment_start_time_ = timestamp;
@@ -136,13 +139,18 @@ Status ChunkingHandler::OnMediaSample(
     const bool can_start_new_subsegment =
         sample->is_key_frame() || !chunking_params_.subsegment_sap_aligned;
     if (can_start_new_subsegment) {
-      const int64_t subsegment_index =
-          (timestamp - segment_start_time_.value()) / subsegment_duration_;
-      if (IsNewSegmentIndex(subsegment_index, current_subsegment_index_)) {
-        current_subsegment_index_ = subsegment_index;
-
-        RETURN_IF_ERROR(EndSubsegmentIfStarted());
-        subsegment_start_time_ = timestamp;
+      const int64_t subsegment_offset =
+          timestamp - segment_start_time_.value();
+      if (subsegment_offset < subsegment_bounds_.first ||
+          subsegment_offset >= subsegment_bounds_.second) {
+        const int64_t subsegment_index =
+            subsegment_offset / subsegment_duration_;
+        if (IsNewSegmentIndex(subsegment_index, current_subsegment_index_)) {
+          SetSubsegmentIndex(subsegment_index);
+
+          RETURN_IF_ERROR(EndSubsegmentIfStarted());
+          subsegment_start_time_ = timestamp;
+        }
       }
     }
   }
@@ -164,14 +172,39 @@ Status ChunkingHandler::OnMediaSample(
   return DispatchMediaSample(kStreamIndex, std::move(sample));
 }
 
+void ChunkingHandler::SetSegmentIndex(int64_t segment_index) {
+  DCHECK_GE(segment_index, 0);
+  current_segment_index_ = segment_index;
+  // The timestamps before the epoch are in the first segment.
+  segment_bounds_ = {segment_index <= 1
+                         ? std::numeric_limits<int64_t>::min()
+                         : segment_clock_.GetSegmentStart(segment_index - 1),
+                     segment_clock_.GetSegmentStart(segment_index + 1)};
+}
+
+void ChunkingHandler::SetSubsegmentIndex(int64_t subsegment_index) {
+  current_subsegment_index_ = subsegment_index;
+  // The offsets can be negative, where the division rounds towards zero, so
+  // the bounds are only used for non-negative indexes.
+  if (subsegment_index < 0) {
+    subsegment_bounds_ = {0, 0};
+    return;
+  }
+  subsegment_bounds_ = {(subsegment_index - 1) * subsegment_duration_,
+                        (subsegment_index + 1) * subsegment_duration_};
+}
+
 Status ChunkingHandler::EndSegmentIfStarted() {
   if (!segment_start_time_)
     return Status::OK;
+  ScopedTraceEvent trace_event("ChunkingHandler::EndSegment");
 
   auto segment_info = std::make_shared<SegmentInfo>();
   segment_info->start_timestamp = segment_start_time_.value();
   segment_info->duration = max_segment_time_ - segment_start_time_.value();
   segment_info->segment_number = segment_number_++;
+  segment_info->first_sample_time = segment_first_sample_time_;
+  segment_info->chunked_time = std::chrono::system_clock::now();
 
   if (chunking_params_.low_latency_dash_mode) {
     segment_info->is_chunk = true;
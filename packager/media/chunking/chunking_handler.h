@@ -8,13 +8,16 @@
 #define PACKAGER_MEDIA_CHUNKING_CHUNKING_HANDLER_
 
 #include <atomic>
+#include <chrono>
 #include <optional>
 #include <queue>
+#include <utility>
 
 #include <absl/log/log.h>
 
 #include <packager/chunking_params.h>
 #include <packager/media/base/media_handler.h>
+#include <packager/media/chunking/segment_clock.h>
 
 namespace shaka {
 namespace media {
@@ -60,18 +63,23 @@ class ChunkingHandler : public MediaHandler {
   Status OnCueEvent(std::shared_ptr<const CueEvent> event);
   Status OnMediaSample(std::shared_ptr<const MediaSample> sample);
 
+  // Set the current (sub)segment index and the bounds of the offsets in it.
+  void SetSegmentIndex(int64_t segment_index);
+  void SetSubsegmentIndex(int64_t subsegment_index);
+
   Status EndSegmentIfStarted();
   Status EndSubsegmentIfStarted() const;
 
   bool IsSubsegmentEnabled() {
     return subsegment_duration_ > 0 &&
-           subsegment_duration_ != segment_duration_;
+           subsegment_duration_ != segment_clock_.segment_duration();
   }
 
   const ChunkingParams chunking_params_;
 
-  // Segment and subsegment duration in stream's time scale.
-  int64_t segment_duration_ = 0;
+  // The segment boundaries, shared with the other streams by construction.
+  SegmentClock segment_clock_;
+  // Subsegment duration in stream's time scale.
   int64_t subsegment_duration_ = 0;
 
   // Segment number that keeps monotically increasing.
@@ -84,14 +92,18 @@ class ChunkingHandler : public MediaHandler {
   // Current subsegment index, useful to determine where to do chunking.
   int64_t current_subsegment_index_ = -1;
 
+  // The samples with a timestamp in [first, second) for segments, or an offset
+  // from |segment_start_time_| in [first, second) for subsegments, do not
+  // start a new (sub)segment. See IsNewSegmentIndex().
+  std::pair<int64_t, int64_t> segment_bounds_ = {0, 0};
+  std::pair<int64_t, int64_t> subsegment_bounds_ = {0, 0};
+
   std::optional<int64_t> segment_start_time_;
   std::optional<int64_t> subsegment_start_time_;
   int64_t max_segment_time_ = 0;
   int32_t time_scale_ = 0;
-
-  // The offset is applied to sample timestamps so a full segment is generated
-  // after cue points.
-  int64_t cue_offset_ = 0;
+  // When the first sample of the current segment arrived.
+  std::chrono::system_clock::time_point segment_first_sample_time_;
 };
 
 }  // namespace media
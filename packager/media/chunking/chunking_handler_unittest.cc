@@ -155,6 +155,46 @@ TEST_F(ChunkingHandlerTest, VideoAndSubsegmentAndNonzeroStart) {
                         kDuration, !kEncrypted, _)));
 }
 
+TEST_F(ChunkingHandlerTest, SegmentBoundariesAreExactAfterLongRuns) {
+  ChunkingParams chunking_params;
+  // 0.7 * 90000 is slightly less than 63000 in double precision.
+  chunking_params.segment_duration_in_seconds = 0.7;
+  SetUpChunkingHandler(1, chunking_params);
+
+  const int32_t kTimeScale = 90000;
+  const int64_t kSegmentDuration = 63000;
+  const int64_t kSampleDuration = kSegmentDuration / 3;
+  // About 8 days in, where a segment duration truncated to 62999 ticks
+  // would put the boundaries more than a sample off.
+  const int64_t kBoundary = kSegmentDuration * 1000000;
+
+  ASSERT_OK(Process(StreamData::FromStreamInfo(
+      kStreamIndex, GetVideoStreamInfo(kTimeScale))));
+  for (int i = -1; i < 4; ++i) {
+    ASSERT_OK(Process(StreamData::FromMediaSample(
+        kStreamIndex, GetMediaSample(kBoundary + i * kSampleDuration,
+                                     kSampleDuration, kKeyFrame))));
+  }
+  EXPECT_THAT(
+      GetOutputStreamDataVector(),
+      ElementsAre(
+          IsStreamInfo(kStreamIndex, kTimeScale, !kEncrypted, _),
+          IsMediaSample(kStreamIndex, kBoundary - kSampleDuration,
+                        kSampleDuration, !kEncrypted, _),
+          IsSegmentInfo(kStreamIndex, kBoundary - kSampleDuration,
+                        kSampleDuration, !kIsSubsegment, !kEncrypted),
+          IsMediaSample(kStreamIndex, kBoundary, kSampleDuration, !kEncrypted,
+                        _),
+          IsMediaSample(kStreamIndex, kBoundary + kSampleDuration,
+                        kSampleDuration, !kEncrypted, _),
+          IsMediaSample(kStreamIndex, kBoundary + 2 * kSampleDuration,
+                        kSampleDuration, !kEncrypted, _),
+          IsSegmentInfo(kStreamIndex, kBoundary, kSegmentDuration,
+                        !kIsSubsegment, !kEncrypted),
+          IsMediaSample(kStreamIndex, kBoundary + kSegmentDuration,
+                        kSampleDuration, !kEncrypted, _)));
+}
+
 TEST_F(ChunkingHandlerTest, CueEvent) {
   ChunkingParams chunking_params;
   chunking_params.segment_duration_in_seconds = 1;
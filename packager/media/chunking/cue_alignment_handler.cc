@@ -10,6 +10,7 @@
 
 #include <absl/log/check.h>
 
+#include <packager/file/file_util.h>
 #include <packager/macros/logging.h>
 #include <packager/macros/status.h>
 
@@ -77,8 +78,20 @@ Status GetNextCue(double hint,
 }
 }  // namespace
 
-CueAlignmentHandler::CueAlignmentHandler(SyncPointQueue* sync_points)
-    : sync_points_(sync_points) {}
+CueAlignmentHandler::CueAlignmentHandler(SyncPointQueue* sync_points,
+                                         uint64_t max_buffered_bytes,
+                                         const std::string& temp_dir)
+    : sync_points_(sync_points),
+      max_buffered_bytes_(max_buffered_bytes),
+      temp_dir_(temp_dir) {}
+
+CueAlignmentHandler::~CueAlignmentHandler() {
+  if (spill_file_) {
+    spill_file_.reset();
+    if (!File::Delete(spill_file_name_.c_str()))
+      LOG(WARNING) << "Unable to delete temporary file " << spill_file_name_;
+  }
+}
 
 Status CueAlignmentHandler::InitializeInternal() {
   sync_points_->AddThread();
@@ -136,7 +149,9 @@ Status CueAlignmentHandler::OnFlushRequest(size_t stream_index) {
   // when we call |UseNextSyncPoint|.
   while (sync_points_->HasMore(hint_)) {
     std::shared_ptr<const CueEvent> next_cue;
+    const auto wait_start = std::chrono::steady_clock::now();
     RETURN_IF_ERROR(GetNextCue(hint_, sync_points_, &next_cue));
+    AddBlockedTime(wait_start);
     RETURN_IF_ERROR(UseNewSyncPoint(std::move(next_cue)));
   }
 
@@ -165,6 +180,11 @@ Status CueAlignmentHandler::OnFlushRequest(size_t stream_index) {
     stream.cues.clear();
   }
 
+  VLOG(1) << "Cue alignment buffered at most "
+          << max_buffered_sample_count_seen_ << " samples and "
+          << max_buffered_bytes_seen_
+          << " bytes of payloads in memory, and spilled "
+          << total_spilled_bytes_ << " bytes.";
   return FlushAllDownstreams();
 }
 
@@ -224,7 +244,9 @@ Status CueAlignmentHandler::OnNonVideoSample(
   // sync point.
   if (EveryoneWaitingAtHint()) {
     std::shared_ptr<const CueEvent> next_sync;
+    const auto wait_start = std::chrono::steady_clock::now();
     RETURN_IF_ERROR(GetNextCue(hint_, sync_points_, &next_sync));
+    AddBlockedTime(wait_start);
     RETURN_IF_ERROR(UseNewSyncPoint(next_sync));
   }
 
@@ -244,7 +266,8 @@ Status CueAlignmentHandler::OnSample(std::unique_ptr<StreamData> sample) {
 
   const size_t stream_index = sample->stream_index;
 
-  if (sample->text_sample) {
+  // A heartbeat moves the stream on like a sample, but has nothing to show.
+  if (sample->text_sample && !sample->text_sample->is_heartbeat()) {
     StreamState& stream = stream_states_[stream_index];
     stream.max_text_sample_end_time_seconds =
         std::max(stream.max_text_sample_end_time_seconds,
@@ -294,7 +317,7 @@ Status CueAlignmentHandler::AcceptSample(std::unique_ptr<StreamData> sample,
   // the sample to the queue.
   const size_t stream_index = sample->stream_index;
 
-  stream->samples.push_back(std::move(sample));
+  RETURN_IF_ERROR(BufferSample(std::move(sample), stream));
 
   if (stream->samples.size() > kMaxBufferSize) {
     LOG(ERROR) << "Stream " << stream_index << " has buffered "
@@ -312,12 +335,10 @@ Status CueAlignmentHandler::RunThroughSamples(StreamState* stream) {
   // Think of this as a merge sort.
   while (stream->cues.size() && stream->samples.size()) {
     const double cue_time = stream->cues.front()->cue_event->time_in_seconds;
-    const double sample_time =
-        TimeInSeconds(*stream->info, *stream->samples.front());
+    const double sample_time = stream->samples.front().time_in_seconds;
 
     if (sample_time < cue_time) {
-      RETURN_IF_ERROR(Dispatch(std::move(stream->samples.front())));
-      stream->samples.pop_front();
+      RETURN_IF_ERROR(DispatchFirstSample(stream));
     } else {
       RETURN_IF_ERROR(Dispatch(std::move(stream->cues.front())));
       stream->cues.pop_front();
@@ -328,12 +349,115 @@ Status CueAlignmentHandler::RunThroughSamples(StreamState* stream) {
   // now work up to the hint. So now send all samples that come before the hint
   // downstream.
   while (stream->samples.size() &&
-         TimeInSeconds(*stream->info, *stream->samples.front()) < hint_) {
-    RETURN_IF_ERROR(Dispatch(std::move(stream->samples.front())));
-    stream->samples.pop_front();
+         stream->samples.front().time_in_seconds < hint_) {
+    RETURN_IF_ERROR(DispatchFirstSample(stream));
   }
 
   return Status::OK;
 }
+
+Status CueAlignmentHandler::BufferSample(std::unique_ptr<StreamData> sample,
+                                         StreamState* stream) {
+  BufferedSample buffered;
+  buffered.time_in_seconds = TimeInSeconds(*stream->info, *sample);
+
+  // Text samples are small, only media sample payloads are accounted for.
+  const size_t size =
+      sample->media_sample ? sample->media_sample->data_size() : 0;
+  if (max_buffered_bytes_ > 0 && size > 0 &&
+      buffered_bytes_ + size > max_buffered_bytes_) {
+    // Spill the newest samples, as they are dispatched last.
+    RETURN_IF_ERROR(SpillPayload(*sample->media_sample, &buffered));
+    std::shared_ptr<MediaSample> spilled_sample =
+        sample->media_sample->Clone();
+    spilled_sample->TransferData(nullptr, 0);
+    sample->media_sample = std::move(spilled_sample);
+  } else {
+    buffered_bytes_ += size;
+    buffered_memory_.Set(buffered_bytes_);
+  }
+  buffered.data = std::move(sample);
+  stream->samples.push_back(std::move(buffered));
+  ++buffered_sample_count_;
+
+  max_buffered_bytes_seen_ =
+      std::max(max_buffered_bytes_seen_, buffered_bytes_);
+  max_buffered_sample_count_seen_ =
+      std::max(max_buffered_sample_count_seen_, buffered_sample_count_);
+  return Status::OK;
+}
+
+Status CueAlignmentHandler::DispatchFirstSample(StreamState* stream) {
+  DCHECK(!stream->samples.empty());
+  BufferedSample buffered = std::move(stream->samples.front());
+  stream->samples.pop_front();
+  --buffered_sample_count_;
+
+  if (buffered.spilled) {
+    RETURN_IF_ERROR(RestorePayload(&buffered));
+  } else if (buffered.data->media_sample) {
+    buffered_bytes_ -= buffered.data->media_sample->data_size();
+    buffered_memory_.Set(buffered_bytes_);
+  }
+  return Dispatch(std::move(buffered.data));
+}
+
+Status CueAlignmentHandler::SpillPayload(const MediaSample& sample,
+                                         BufferedSample* buffered) {
+  if (!spill_file_) {
+    if (!TempFilePath(temp_dir_, &spill_file_name_))
+      return Status(error::FILE_FAILURE, "Unable to create temporary file.");
+    spill_file_.reset(File::Open(spill_file_name_.c_str(), "w+"));
+    if (!spill_file_) {
+      return Status(error::FILE_FAILURE,
+                    "Cannot open file to write " + spill_file_name_);
+    }
+    VLOG(1) << "Spilling buffered samples to " << spill_file_name_;
+  }
+
+  if (!spill_file_->Seek(spill_file_end_) ||
+      spill_file_->Write(sample.data(), sample.data_size()) !=
+          static_cast<int64_t>(sample.data_size())) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot write to temporary file " + spill_file_name_);
+  }
+  buffered->spilled = true;
+  buffered->spill_offset = spill_file_end_;
+  buffered->spill_size = sample.data_size();
+  spill_file_end_ += sample.data_size();
+  total_spilled_bytes_ += sample.data_size();
+  ++spilled_sample_count_;
+  return Status::OK;
+}
+
+Status CueAlignmentHandler::RestorePayload(BufferedSample* buffered) {
+  DCHECK(spill_file_);
+  std::shared_ptr<uint8_t> data(new uint8_t[buffered->spill_size],
+                                std::default_delete<uint8_t[]>());
+  if (!spill_file_->Seek(buffered->spill_offset)) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot seek in temporary file " + spill_file_name_);
+  }
+  size_t bytes_read = 0;
+  while (bytes_read < buffered->spill_size) {
+    const int64_t result = spill_file_->Read(
+        data.get() + bytes_read, buffered->spill_size - bytes_read);
+    if (result <= 0) {
+      return Status(error::FILE_FAILURE,
+                    "Cannot read from temporary file " + spill_file_name_);
+    }
+    bytes_read += result;
+  }
+
+  std::shared_ptr<MediaSample> sample = buffered->data->media_sample->Clone();
+  sample->TransferData(std::move(data), buffered->spill_size);
+  buffered->data->media_sample = std::move(sample);
+  buffered->spilled = false;
+
+  // Reuse the file once all the spilled payloads have been read back.
+  if (--spilled_sample_count_ == 0)
+    spill_file_end_ = 0;
+  return Status::OK;
+}
 }  // namespace media
 }  // namespace shaka
@@ -7,11 +7,17 @@
 #ifndef PACKAGER_MEDIA_CHUNKING_CUE_ALIGNMENT_HANDLER_
 #define PACKAGER_MEDIA_CHUNKING_CUE_ALIGNMENT_HANDLER_
 
+#include <cstdint>
 #include <deque>
 #include <list>
+#include <memory>
+#include <string>
 
+#include <packager/file.h>
+#include <packager/file/file_closer.h>
 #include <packager/media/base/media_handler.h>
 #include <packager/media/chunking/sync_point_queue.h>
+#include <packager/utils/memory_accounting.h>
 
 namespace shaka {
 namespace media {
@@ -23,21 +29,44 @@ namespace media {
 /// There should be a cue alignment handler per demuxer/thread and not per
 /// stream. A cue alignment handler must be one per thread in order to properly
 /// manage blocking.
+///
+/// Non-video samples after the hint are buffered until the next sync point is
+/// known. The payloads of the buffered samples can be bounded in memory, in
+/// which case the payloads past the bound are spilled to a temporary file and
+/// read back when the samples are dispatched.
 class CueAlignmentHandler : public MediaHandler {
  public:
-  explicit CueAlignmentHandler(SyncPointQueue* sync_points);
-  ~CueAlignmentHandler() = default;
+  /// @param sync_points is the queue shared by all the cue alignment handlers.
+  /// @param max_buffered_bytes is the maximum size of the sample payloads
+  ///        buffered in memory. 0 means that there is no limit.
+  /// @param temp_dir is the directory of the spill file. The OS temporary
+  ///        directory is used if it is empty.
+  explicit CueAlignmentHandler(SyncPointQueue* sync_points,
+                               uint64_t max_buffered_bytes = 0,
+                               const std::string& temp_dir = "");
+  ~CueAlignmentHandler() override;
 
  private:
   CueAlignmentHandler(const CueAlignmentHandler&) = delete;
   CueAlignmentHandler& operator=(const CueAlignmentHandler&) = delete;
 
+  struct BufferedSample {
+    std::unique_ptr<StreamData> data;
+    // The time of the sample, kept as the sample of a spilled payload has no
+    // data and no timestamps can be read from it.
+    double time_in_seconds = 0;
+    // Set if the payload of |data| is in the spill file.
+    bool spilled = false;
+    uint64_t spill_offset = 0;
+    size_t spill_size = 0;
+  };
+
   struct StreamState {
     // Information for the stream.
     std::shared_ptr<const StreamInfo> info;
     // Cached samples that cannot be dispatched. All the samples should be at or
     // after |hint|.
-    std::list<std::unique_ptr<StreamData>> samples;
+    std::list<BufferedSample> samples;
     // If set, the stream is pending to be flushed.
     bool to_be_flushed = false;
     // Only set for text stream.
@@ -73,9 +102,36 @@ class CueAlignmentHandler : public MediaHandler {
   // Dispatch all samples and cues (in the correct order) for the given stream.
   Status RunThroughSamples(StreamState* stream);
 
+  // Add |sample| to the samples of |stream|, spilling its payload if the
+  // buffered payloads would exceed |max_buffered_bytes_|.
+  Status BufferSample(std::unique_ptr<StreamData> sample, StreamState* stream);
+  // Remove the first sample of |stream|, reading its payload back if it was
+  // spilled, and dispatch it.
+  Status DispatchFirstSample(StreamState* stream);
+  Status SpillPayload(const MediaSample& sample, BufferedSample* buffered);
+  Status RestorePayload(BufferedSample* buffered);
+
   SyncPointQueue* const sync_points_ = nullptr;
   std::deque<StreamState> stream_states_;
 
+  const uint64_t max_buffered_bytes_ = 0;
+  const std::string temp_dir_;
+  // The size of the payloads of the samples buffered in memory.
+  uint64_t buffered_bytes_ = 0;
+  MemoryCharge buffered_memory_{MemorySubsystem::kCueAlignmentQueues};
+  size_t buffered_sample_count_ = 0;
+  // High-water marks, logged at the end of the stream.
+  uint64_t max_buffered_bytes_seen_ = 0;
+  size_t max_buffered_sample_count_seen_ = 0;
+  uint64_t total_spilled_bytes_ = 0;
+
+  std::string spill_file_name_;
+  std::unique_ptr<File, FileCloser> spill_file_;
+  // The end of the payloads written to |spill_file_|. The file is rewritten
+  // from the start once all the spilled payloads have been read back.
+  uint64_t spill_file_end_ = 0;
+  size_t spilled_sample_count_ = 0;
+
   // A common hint used by all streams. When a new cue is given to all streams,
   // the hint will be updated. The hint will always be larger than any cue. The
   // hint represents the min time in seconds for the next cue appear. The hints
@@ -16,6 +16,7 @@
 #include <packager/status/status_test_util.h>
 
 using ::testing::_;
+using ::testing::AllOf;
 using ::testing::ElementsAre;
 using ::testing::IsEmpty;
 
@@ -33,6 +34,14 @@ const bool kKeyFrame = true;
 const int32_t kMsTimeScale = 1000;
 
 const size_t kStreamIndex = 0;
+
+MATCHER_P(HasPayload, payload, "") {
+  const std::vector<uint8_t> data(
+      arg->media_sample->data(),
+      arg->media_sample->data() + arg->media_sample->data_size());
+  *result_listener << "which has a payload of " << data.size() << " bytes";
+  return data == payload;
+}
 }  // namespace
 
 class CueAlignmentHandlerTest : public MediaHandlerTestBase {
@@ -82,6 +91,18 @@ class CueAlignmentHandlerTest : public MediaHandlerTestBase {
     return Input(input_index)->Dispatch(std::move(data));
   }
 
+  Status DispatchMediaSample(size_t input_index,
+                             int64_t start_time,
+                             int64_t duration,
+                             bool keyframe,
+                             const std::vector<uint8_t>& payload) {
+    auto sample = GetMediaSample(start_time, duration, keyframe,
+                                 payload.data(), payload.size());
+    auto data = StreamData::FromMediaSample(kStreamIndex, std::move(sample));
+
+    return Input(input_index)->Dispatch(std::move(data));
+  }
+
   Status DispatchTextSample(size_t input_index,
                             int64_t start_time,
                             int64_t end_time) {
@@ -609,6 +630,67 @@ TEST_F(CueAlignmentHandlerTest, TextAudioVideoInputWithCues) {
   ASSERT_OK(FlushAll({kTextStream, kAudioStream, kVideoStream}));
 }
 
+// Audio samples are buffered until the other audio stream reaches the cue.
+// A tiny memory limit spills all of their payloads to a temporary file.
+TEST_F(CueAlignmentHandlerTest, AudioInputsWithCuesSpillBufferedPayloads) {
+  const size_t kAudioStream0 = 0;
+  const size_t kAudioStream1 = 1;
+  const size_t kTwoInputs = 2;
+  const size_t kTwoOutputs = 2;
+  const uint64_t kMaxBufferedBytes = 1;
+
+  const int64_t kSampleDuration = 1000;
+  const int64_t kSample0Start = 0;
+  const int64_t kSample1Start = kSample0Start + kSampleDuration;
+  const int64_t kSample2Start = kSample1Start + kSampleDuration;
+
+  const double kSample1StartInSeconds =
+      static_cast<double>(kSample1Start) / kMsTimeScale;
+
+  const std::vector<std::vector<uint8_t>> kPayloads = {
+      {0x00, 0x01, 0x02}, {0x10, 0x11, 0x12, 0x13}, {0x20, 0x21}};
+
+  auto sync_points = CreateSyncPoints({kSample1StartInSeconds});
+  auto handler = std::make_shared<CueAlignmentHandler>(sync_points.get(),
+                                                       kMaxBufferedBytes);
+  ASSERT_OK(SetUpAndInitializeGraph(handler, kTwoInputs, kTwoOutputs));
+
+  for (size_t stream : {kAudioStream0, kAudioStream1}) {
+    testing::InSequence s;
+
+    EXPECT_CALL(*Output(stream),
+                OnProcess(IsStreamInfo(_, kMsTimeScale, _, _)));
+    EXPECT_CALL(*Output(stream),
+                OnProcess(AllOf(
+                    IsMediaSample(_, kSample0Start, kSampleDuration, _, _),
+                    HasPayload(kPayloads[0]))));
+    EXPECT_CALL(*Output(stream),
+                OnProcess(IsCueEvent(_, kSample1StartInSeconds)));
+    EXPECT_CALL(*Output(stream),
+                OnProcess(AllOf(
+                    IsMediaSample(_, kSample1Start, kSampleDuration, _, _),
+                    HasPayload(kPayloads[1]))));
+    EXPECT_CALL(*Output(stream),
+                OnProcess(AllOf(
+                    IsMediaSample(_, kSample2Start, kSampleDuration, _, _),
+                    HasPayload(kPayloads[2]))));
+    EXPECT_CALL(*Output(stream), OnFlush(_));
+  }
+
+  ASSERT_OK(DispatchAudioInfo(kAudioStream0));
+  ASSERT_OK(DispatchAudioInfo(kAudioStream1));
+  for (size_t stream : {kAudioStream0, kAudioStream1}) {
+    ASSERT_OK(DispatchMediaSample(stream, kSample0Start, kSampleDuration,
+                                  kKeyFrame, kPayloads[0]));
+    ASSERT_OK(DispatchMediaSample(stream, kSample1Start, kSampleDuration,
+                                  kKeyFrame, kPayloads[1]));
+    ASSERT_OK(DispatchMediaSample(stream, kSample2Start, kSampleDuration,
+                                  kKeyFrame, kPayloads[2]));
+  }
+
+  ASSERT_OK(FlushAll({kAudioStream0, kAudioStream1}));
+}
+
 // TODO(kqyang): Add more tests, in particular, multi-thread tests.
 
 }  // namespace media
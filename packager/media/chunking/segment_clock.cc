@@ -0,0 +1,36 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/chunking/segment_clock.h>
+
+#include <cmath>
+
+#include <absl/log/check.h>
+
+namespace shaka {
+namespace media {
+
+SegmentClock::SegmentClock(double segment_duration_in_seconds,
+                           int32_t time_scale)
+    : segment_duration_(ToTimeScale(segment_duration_in_seconds, time_scale)),
+      time_scale_(time_scale) {}
+
+// static
+int64_t SegmentClock::ToTimeScale(double seconds, int32_t time_scale) {
+  return std::llround(seconds * time_scale);
+}
+
+void SegmentClock::SetEpoch(double time_in_seconds) {
+  epoch_ = ToTimeScale(time_in_seconds, time_scale_);
+}
+
+int64_t SegmentClock::GetSegmentIndex(int64_t timestamp) const {
+  DCHECK_GT(segment_duration_, 0);
+  return timestamp < epoch_ ? 0 : (timestamp - epoch_) / segment_duration_;
+}
+
+}  // namespace media
+}  // namespace shaka
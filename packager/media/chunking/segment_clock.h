@@ -0,0 +1,57 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_CHUNKING_SEGMENT_CLOCK_H_
+#define PACKAGER_MEDIA_CHUNKING_SEGMENT_CLOCK_H_
+
+#include <cstdint>
+
+namespace shaka {
+namespace media {
+
+/// The segment boundaries of a stream, at multiples of the segment duration
+/// from an epoch, in the time scale of the stream. The epoch is 0 at first and
+/// moves to each cue point.
+///
+/// The boundaries only depend on the segment duration, the time scale and the
+/// cue points, so the chunkers of different streams, including streams from
+/// different inputs processed on different threads, each keep their own clock
+/// and still cut at aligned times, without communicating or waiting for each
+/// other.
+class SegmentClock {
+ public:
+  SegmentClock() = default;
+  SegmentClock(double segment_duration_in_seconds, int32_t time_scale);
+
+  /// @return @a seconds in @a time_scale, rounded to the nearest tick, e.g.
+  ///         6.006 seconds is exactly 540540 ticks at 90 kHz.
+  static int64_t ToTimeScale(double seconds, int32_t time_scale);
+
+  /// Restart the boundaries at @a time_in_seconds, e.g. at a cue point.
+  void SetEpoch(double time_in_seconds);
+
+  /// @return the index of the segment containing @a timestamp. Timestamps
+  ///         before the epoch are in the first segment, i.e. 0.
+  int64_t GetSegmentIndex(int64_t timestamp) const;
+
+  /// @return the start time of the segment at @a segment_index.
+  int64_t GetSegmentStart(int64_t segment_index) const {
+    return epoch_ + segment_index * segment_duration_;
+  }
+
+  int64_t segment_duration() const { return segment_duration_; }
+  int64_t epoch() const { return epoch_; }
+
+ private:
+  int64_t segment_duration_ = 0;
+  int32_t time_scale_ = 0;
+  int64_t epoch_ = 0;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_CHUNKING_SEGMENT_CLOCK_H_
@@ -0,0 +1,51 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/chunking/segment_clock.h>
+
+#include <gtest/gtest.h>
+
+namespace shaka {
+namespace media {
+
+TEST(SegmentClockTest, RoundsToNearestTick) {
+  EXPECT_EQ(540540, SegmentClock::ToTimeScale(6.006, 90000));
+  // 0.7 * 90000 is slightly less than 63000 in double precision.
+  EXPECT_EQ(63000, SegmentClock::ToTimeScale(0.7, 90000));
+  EXPECT_EQ(63000, SegmentClock(0.7, 90000).segment_duration());
+}
+
+TEST(SegmentClockTest, SegmentIndex) {
+  SegmentClock segment_clock(2, 1000);
+  EXPECT_EQ(0, segment_clock.GetSegmentIndex(-1));
+  EXPECT_EQ(0, segment_clock.GetSegmentIndex(0));
+  EXPECT_EQ(0, segment_clock.GetSegmentIndex(1999));
+  EXPECT_EQ(1, segment_clock.GetSegmentIndex(2000));
+  EXPECT_EQ(4000, segment_clock.GetSegmentStart(2));
+}
+
+TEST(SegmentClockTest, Epoch) {
+  SegmentClock segment_clock(2, 1000);
+  segment_clock.SetEpoch(4.5);
+  EXPECT_EQ(4500, segment_clock.epoch());
+  EXPECT_EQ(0, segment_clock.GetSegmentIndex(1000));
+  EXPECT_EQ(0, segment_clock.GetSegmentIndex(6499));
+  EXPECT_EQ(1, segment_clock.GetSegmentIndex(6500));
+  EXPECT_EQ(8500, segment_clock.GetSegmentStart(2));
+}
+
+TEST(SegmentClockTest, IndependentClocksAgree) {
+  // The clocks of streams in different time scales cut at the same times.
+  SegmentClock video_clock(6.006, 90000);
+  SegmentClock audio_clock(6.006, 48000);
+  for (int64_t index = 0; index < 100000; index += 997) {
+    EXPECT_EQ(video_clock.GetSegmentStart(index) * 48000,
+              audio_clock.GetSegmentStart(index) * 90000);
+  }
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -30,11 +30,8 @@ void SyncPointQueue::AddThread() {
 }
 
 void SyncPointQueue::Cancel() {
-  {
-    absl::MutexLock lock(&mutex_);
-    cancelled_ = true;
-  }
-  sync_condition_.SignalAll();
+  absl::MutexLock lock(&mutex_);
+  cancelled_ = true;
 }
 
 double SyncPointQueue::GetHint(double time_in_seconds) {
@@ -56,31 +53,35 @@ double SyncPointQueue::GetHint(double time_in_seconds) {
 std::shared_ptr<const CueEvent> SyncPointQueue::GetNext(
     double hint_in_seconds) {
   absl::MutexLock lock(&mutex_);
-  while (!cancelled_) {
-    // Find the promoted cue that would line up with our hint, which is the
-    // first cue that is not less than |hint_in_seconds|.
-    auto iter = promoted_.lower_bound(hint_in_seconds);
-    if (iter != promoted_.end()) {
-      return iter->second;
-    }
-
-    // Promote |hint_in_seconds| if everyone is waiting.
+  if (!CanGetNextNoLocking(hint_in_seconds)) {
+    // Promote |hint_in_seconds| if everyone else is waiting.
     if (waiting_thread_count_ + 1 == thread_count_) {
       std::shared_ptr<const CueEvent> cue = PromoteAtNoLocking(hint_in_seconds);
       CHECK(cue);
       return cue;
     }
 
+    // This blocks until either a cue not less than |hint_in_seconds| is
+    // promoted, by another thread or by the last thread to block (see the
+    // section above), or the queue is cancelled.
     waiting_thread_count_++;
-    // This blocks until either a cue is promoted or all threads are blocked
-    // (in which case, the unpromoted cue at the hint will be self-promoted
-    // and returned - see section above). Spurious signal events are possible
-    // with most condition variable implementations, so if it returns, we go
-    // back and check if a cue is actually promoted or not.
-    sync_condition_.Wait(&mutex_);
+    const auto wait_start = std::chrono::steady_clock::now();
+    const auto can_get_next = [this, hint_in_seconds]()
+                                  ABSL_NO_THREAD_SAFETY_ANALYSIS {
+                                    return CanGetNextNoLocking(hint_in_seconds);
+                                  };
+    mutex_.Await(absl::Condition(&can_get_next));
+    blocked_time_ += std::chrono::steady_clock::now() - wait_start;
     waiting_thread_count_--;
   }
-  return nullptr;
+  if (cancelled_)
+    return nullptr;
+
+  // Find the promoted cue that would line up with our hint, which is the
+  // first cue that is not less than |hint_in_seconds|.
+  auto iter = promoted_.lower_bound(hint_in_seconds);
+  DCHECK(iter != promoted_.end());
+  return iter->second;
 }
 
 std::shared_ptr<const CueEvent> SyncPointQueue::PromoteAt(
@@ -93,6 +94,16 @@ bool SyncPointQueue::HasMore(double hint_in_seconds) const {
   return hint_in_seconds < std::numeric_limits<double>::max();
 }
 
+std::chrono::nanoseconds SyncPointQueue::GetBlockedTime() {
+  absl::MutexLock lock(&mutex_);
+  return blocked_time_;
+}
+
+bool SyncPointQueue::CanGetNextNoLocking(double hint_in_seconds) const {
+  return cancelled_ || (!promoted_.empty() &&
+                        promoted_.rbegin()->first >= hint_in_seconds);
+}
+
 std::shared_ptr<const CueEvent> SyncPointQueue::PromoteAtNoLocking(
     double time_in_seconds) {
   mutex_.AssertHeld();
@@ -123,9 +134,7 @@ std::shared_ptr<const CueEvent> SyncPointQueue::PromoteAtNoLocking(
   // User may provide multiple cue points at the same or similar timestamps. The
   // extra unused cues are simply ignored.
   unpromoted_.erase(unpromoted_.begin(), iter);
-
-  // Wake up other threads that may be waiting.
-  sync_condition_.SignalAll();
+  // The threads waiting for this cue are woken up when |mutex_| is released.
   return cue;
 }
 
@@ -4,6 +4,7 @@
 // license that can be found in the LICENSE file or at
 // https://developers.google.com/open-source/licenses/bsd
 
+#include <chrono>
 #include <map>
 #include <memory>
 
@@ -52,6 +53,10 @@ class SyncPointQueue {
   ///         in undefined behavior.
   bool HasMore(double hint_in_seconds) const;
 
+  /// @return The total time the threads spent blocked in GetNext() waiting
+  ///         for cues to be promoted.
+  std::chrono::nanoseconds GetBlockedTime();
+
  private:
   SyncPointQueue(const SyncPointQueue&) = delete;
   SyncPointQueue& operator=(const SyncPointQueue&) = delete;
@@ -60,14 +65,22 @@ class SyncPointQueue {
   // functions that have locks.
   std::shared_ptr<const CueEvent> PromoteAtNoLocking(double time_in_seconds);
 
-  absl::Mutex mutex_;
-  absl::CondVar sync_condition_ ABSL_GUARDED_BY(mutex_);
-  size_t thread_count_ = 0;
-  size_t waiting_thread_count_ = 0;
-  bool cancelled_ = false;
+  // @return true if GetNext(@a hint_in_seconds) does not need to wait.
+  bool CanGetNextNoLocking(double hint_in_seconds) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
-  std::map<double, std::shared_ptr<CueEvent>> unpromoted_;
-  std::map<double, std::shared_ptr<CueEvent>> promoted_;
+  // Waiting threads block on conditions evaluated under |mutex_|, so a
+  // promotion only wakes up the threads whose hint it satisfies.
+  absl::Mutex mutex_;
+  size_t thread_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  size_t waiting_thread_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool cancelled_ ABSL_GUARDED_BY(mutex_) = false;
+  std::chrono::nanoseconds blocked_time_ ABSL_GUARDED_BY(mutex_){0};
+
+  std::map<double, std::shared_ptr<CueEvent>> unpromoted_
+      ABSL_GUARDED_BY(mutex_);
+  std::map<double, std::shared_ptr<CueEvent>> promoted_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace media
@@ -9,6 +9,7 @@
 #include <absl/log/check.h>
 
 #include <packager/macros/status.h>
+#include <packager/media/chunking/segment_clock.h>
 
 namespace shaka {
 namespace media {
@@ -92,6 +93,10 @@ Status TextChunker::OnTextSample(std::shared_ptr<const TextSample> sample) {
     RETURN_IF_ERROR(DispatchSegment(segment_duration_));
   }
 
+  // A heartbeat only ends the segments before it.
+  if (sample->is_heartbeat())
+    return Status::OK;
+
   samples_in_current_segment_.push_back(std::move(sample));
 
   return Status::OK;
@@ -100,9 +105,23 @@ Status TextChunker::OnTextSample(std::shared_ptr<const TextSample> sample) {
 Status TextChunker::DispatchSegment(int64_t duration) {
   DCHECK_GT(duration, 0) << "Segment duration should always be positive";
 
-  // Output all the samples that are part of the segment.
-  for (const auto& sample : samples_in_current_segment_) {
-    RETURN_IF_ERROR(DispatchTextSample(kStreamIndex, sample));
+  const int64_t new_segment_start = segment_start_ + duration;
+
+  // Output all the samples that are part of the segment. Every active sample
+  // has to be output anyway, so samples that end before the next segment
+  // starts are removed in the same pass rather than in a second walk over the
+  // list.
+  auto it = samples_in_current_segment_.begin();
+  while (it != samples_in_current_segment_.end()) {
+    RETURN_IF_ERROR(DispatchTextSample(kStreamIndex, *it));
+
+    // For the sample to even be in this list, it should have started before
+    // the next segment.
+    DCHECK_LT((*it)->start_time(), new_segment_start);
+    if ((*it)->EndTime() <= new_segment_start)
+      it = samples_in_current_segment_.erase(it);
+    else
+      ++it;
   }
 
   // Output the segment info.
@@ -114,24 +133,16 @@ Status TextChunker::DispatchSegment(int64_t duration) {
   RETURN_IF_ERROR(DispatchSegmentInfo(kStreamIndex, std::move(info)));
 
   // Move onto the next segment.
-  const int64_t new_segment_start = segment_start_ + duration;
   segment_start_ = new_segment_start;
 
-  // Remove all samples that end before the (new) current segment started.
-  samples_in_current_segment_.remove_if(
-      [new_segment_start](const std::shared_ptr<const TextSample>& sample) {
-        // For the sample to even be in this list, it should have started
-        // before the (new) current segment.
-        DCHECK_LT(sample->start_time(), new_segment_start);
-        return sample->EndTime() <= new_segment_start;
-      });
-
   return Status::OK;
 }
 
 int64_t TextChunker::ScaleTime(double seconds) const {
   DCHECK_GT(time_scale_, 0) << "Need positive time scale to scale time.";
-  return static_cast<int64_t>(seconds * time_scale_);
+  // As in the SegmentClock of ChunkingHandler, so that text segments end at
+  // the same ticks as the audio and video segments.
+  return SegmentClock::ToTimeScale(seconds, time_scale_);
 }
 }  // namespace media
 }  // namespace shaka
@@ -92,6 +92,54 @@ TEST_F(TextChunkerTest, SegmentsStartAtFirstSample) {
   ASSERT_OK(Input(kInput)->FlushAllDownstreams());
 }
 
+// Verify that a heartbeat ends the segments before it, including the empty
+// ones, and is not output itself.
+//
+// Segment Duration = 100 MS
+//
+// TIME (ms):0     5     1     1     2     2     3     3
+//                 0     0     5     0     5     0     5
+//                       0     0     0     0     0     0
+// SAMPLES  :               [--A--]                  H
+// SEGMENTS :            ^           ^           ^
+//
+TEST_F(TextChunkerTest, HeartbeatEndsSegments) {
+  const double kSegmentDurationSec = 0.1;
+  const int64_t kSegmentDurationMs = 100;
+  const int64_t kSegment0Start = 100;
+  const int64_t kSegment1Start = 200;
+
+  const int64_t kSampleAStart = 120;
+  const int64_t kSampleAEnd = 180;
+  const int64_t kHeartbeatTime = 350;
+
+  ASSERT_OK(Init(kSegmentDurationSec));
+
+  {
+    testing::InSequence s;
+
+    EXPECT_CALL(*Output(kOutput), OnProcess(IsStreamInfo(_, _, _, _)));
+    EXPECT_CALL(*Output(kOutput),
+                OnProcess(IsTextSample(_, _, kSampleAStart, kSampleAEnd)));
+    EXPECT_CALL(
+        *Output(kOutput),
+        OnProcess(IsSegmentInfo(_, kSegment0Start, kSegmentDurationMs, _, _)));
+    EXPECT_CALL(
+        *Output(kOutput),
+        OnProcess(IsSegmentInfo(_, kSegment1Start, kSegmentDurationMs, _, _)));
+    EXPECT_CALL(*Output(kOutput), OnFlush(kStreamIndex));
+  }
+
+  ASSERT_OK(Input(kInput)->Dispatch(StreamData::FromStreamInfo(
+      kStreamIndex, GetTextStreamInfo(kTimescaleMs))));
+  ASSERT_OK(Input(kInput)->Dispatch(StreamData::FromTextSample(
+      kStreamIndex,
+      GetTextSample(kNoId, kSampleAStart, kSampleAEnd, kNoPayload))));
+  ASSERT_OK(Input(kInput)->Dispatch(StreamData::FromTextSample(
+      kStreamIndex, TextSample::CreateHeartbeat(kHeartbeatTime))));
+  ASSERT_OK(Input(kInput)->FlushAllDownstreams());
+}
+
 // Verify that when a sample elapses a full segment, that it only appears
 // in the one segment.
 //
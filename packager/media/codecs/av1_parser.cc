@@ -283,8 +283,19 @@ bool AV1Parser::ParseOpenBitstreamUnit(BitReader* reader,
   VLOG(4) << "OBU " << obu_header.obu_type << " size " << obu_size;
 
   const size_t start_position = reader->bit_position();
+  const uint8_t* sequence_header_obu = nullptr;
   switch (obu_header.obu_type) {
     case OBU_SEQUENCE_HEADER:
+      if (IsRepeatedSequenceHeaderObu(obu_size, *reader)) {
+        // Its trailing bits have been checked when it was first parsed.
+        RCHECK(reader->SkipBytes(obu_size));
+        return true;
+      }
+      // The OBU is byte aligned. It is only remembered once fully checked.
+      DCHECK_EQ(reader->bit_position() % 8, 0u);
+      RCHECK(reader->bits_available() >= obu_size * 8);
+      sequence_header_obu = reader->current_byte_ptr();
+      sequence_header_obu_.clear();
       RCHECK(ParseSequenceHeaderObu(reader));
       break;
     case OBU_FRAME_HEADER:
@@ -312,9 +323,25 @@ bool AV1Parser::ParseOpenBitstreamUnit(BitReader* reader,
     RCHECK(payload_bits <= obu_size * 8);
     RCHECK(ParseTrailingBits(obu_size * 8 - payload_bits, reader));
   }
+  if (sequence_header_obu) {
+    sequence_header_obu_.assign(sequence_header_obu,
+                                sequence_header_obu + obu_size);
+  }
   return true;
 }
 
+// Sequence headers are usually repeated with every key frame without changes,
+// so only a sequence header which differs from the last one is parsed.
+bool AV1Parser::IsRepeatedSequenceHeaderObu(size_t obu_size,
+                                            const BitReader& reader) const {
+  if (obu_size == 0 || obu_size != sequence_header_obu_.size() ||
+      reader.bits_available() < obu_size * 8) {
+    return false;
+  }
+  return std::equal(sequence_header_obu_.begin(), sequence_header_obu_.end(),
+                    reader.current_byte_ptr());
+}
+
 // 5.3.2. OBU header syntax.
 bool AV1Parser::ParseObuHeader(BitReader* reader, ObuHeader* obu_header) {
   int obu_forbidden_bit = 0;
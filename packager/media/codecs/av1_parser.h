@@ -195,6 +195,10 @@ class AV1Parser {
   };
 
   bool ParseOpenBitstreamUnit(BitReader* reader, std::vector<Tile>* tiles);
+  // @return true if the sequence header OBU of @a obu_size bytes at the
+  //         position of @a reader is the same as the last one parsed.
+  bool IsRepeatedSequenceHeaderObu(size_t obu_size,
+                                   const BitReader& reader) const;
   bool ParseObuHeader(BitReader* reader, ObuHeader* obu_header);
   bool ParseObuExtensionHeader(BitReader* reader,
                                ObuExtensionHeader* obu_extension_header);
@@ -276,6 +280,9 @@ class AV1Parser {
   int GetQIndex(bool ignore_delta_q, int segment_id);
 
   SequenceHeaderObu sequence_header_;
+  // The payload of the last sequence header OBU parsed into
+  // |sequence_header_|.
+  std::vector<uint8_t> sequence_header_obu_;
   FrameHeaderObu frame_header_;
   static constexpr int kNumRefFrames = 8;
   ReferenceFrame reference_frames_[kNumRefFrames];
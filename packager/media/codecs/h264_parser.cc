@@ -4,6 +4,7 @@
 
 #include <packager/media/codecs/h264_parser.h>
 
+#include <cstring>
 #include <memory>
 
 #include <absl/log/check.h>
@@ -21,6 +22,30 @@
 
 namespace shaka {
 namespace media {
+namespace {
+
+// Returns the id of the entry of |payloads| equal to the payload of |nalu|, or
+// -1 if there is none.
+template <size_t kCount>
+int FindParameterSet(const std::array<std::vector<uint8_t>, kCount>& payloads,
+                     const Nalu& nalu) {
+  const uint8_t* payload = nalu.data() + nalu.header_size();
+  const uint64_t payload_size = nalu.payload_size();
+  for (size_t id = 0; id < kCount; ++id) {
+    if (!payloads[id].empty() && payloads[id].size() == payload_size &&
+        memcmp(payloads[id].data(), payload, payload_size) == 0) {
+      return static_cast<int>(id);
+    }
+  }
+  return -1;
+}
+
+void SetPayload(const Nalu& nalu, std::vector<uint8_t>* payload) {
+  const uint8_t* data = nalu.data() + nalu.header_size();
+  payload->assign(data, data + nalu.payload_size());
+}
+
+}  // namespace
 
 // Implemented according to ISO/IEC 14496-10:2005 7.4.2.1 Sequence parameter set
 // RBSP semantics.
@@ -192,13 +217,30 @@ H264Parser::H264Parser() {}
 H264Parser::~H264Parser() {}
 
 const H264Pps* H264Parser::GetPps(int pps_id) {
+  if (pps_id < 0 || static_cast<size_t>(pps_id) >= kMaxPpsCount)
+    return nullptr;
   return active_PPSes_[pps_id].get();
 }
 
 const H264Sps* H264Parser::GetSps(int sps_id) {
+  if (sps_id < 0 || static_cast<size_t>(sps_id) >= kMaxSpsCount)
+    return nullptr;
   return active_SPSes_[sps_id].get();
 }
 
+void H264Parser::CopyParameterSetsFrom(const H264Parser& other) {
+  for (size_t id = 0; id < kMaxSpsCount; ++id) {
+    const auto& sps = other.active_SPSes_[id];
+    active_SPSes_[id].reset(sps ? new H264Sps(*sps) : nullptr);
+  }
+  for (size_t id = 0; id < kMaxPpsCount; ++id) {
+    const auto& pps = other.active_PPSes_[id];
+    active_PPSes_[id].reset(pps ? new H264Pps(*pps) : nullptr);
+  }
+  sps_payloads_ = other.sps_payloads_;
+  pps_payloads_ = other.pps_payloads_;
+}
+
 // Default scaling lists (per spec).
 static const int kDefault4x4Intra[kH264ScalingList4x4Length] = {
     6, 13, 13, 20, 20, 20, 28, 28, 28, 28, 32, 32, 32, 37, 37, 42, };
@@ -581,7 +623,15 @@ static void FillDefaultSeqScalingLists(H264Sps* sps) {
       sps->scaling_list8x8[i][j] = 16;
 }
 
-H264Parser::Result H264Parser::ParseSps(const Nalu& nalu, int* sps_id) {
+H264Parser::Result H264Parser::ParseSps(const Nalu& nalu,
+                                        int* sps_id,
+                                        bool* is_repeated) {
+  *sps_id = FindParameterSet(sps_payloads_, nalu);
+  if (is_repeated)
+    *is_repeated = *sps_id >= 0;
+  if (*sps_id >= 0)
+    return kOk;
+
   // See 7.4.2.1.
   int data;
   Result res;
@@ -589,8 +639,6 @@ H264Parser::Result H264Parser::ParseSps(const Nalu& nalu, int* sps_id) {
   reader.Initialize(nalu.data() + nalu.header_size(), nalu.payload_size());
   H26xBitReader* br = &reader;
 
-  *sps_id = -1;
-
   std::unique_ptr<H264Sps> sps(new H264Sps());
 
   READ_BITS_OR_RETURN(8, &sps->profile_idc);
@@ -698,11 +746,23 @@ H264Parser::Result H264Parser::ParseSps(const Nalu& nalu, int* sps_id) {
   // If an SPS with the same id already exists, replace it.
   *sps_id = sps->seq_parameter_set_id;
   active_SPSes_[*sps_id] = std::move(sps);
+  SetPayload(nalu, &sps_payloads_[*sps_id]);
+  // The PPSes are parsed according to their SPS, so parse them again.
+  for (std::vector<uint8_t>& pps_payload : pps_payloads_)
+    pps_payload.clear();
 
   return kOk;
 }
 
-H264Parser::Result H264Parser::ParsePps(const Nalu& nalu, int* pps_id) {
+H264Parser::Result H264Parser::ParsePps(const Nalu& nalu,
+                                        int* pps_id,
+                                        bool* is_repeated) {
+  *pps_id = FindParameterSet(pps_payloads_, nalu);
+  if (is_repeated)
+    *is_repeated = *pps_id >= 0;
+  if (*pps_id >= 0)
+    return kOk;
+
   // See 7.4.2.2.
   const H264Sps* sps;
   Result res;
@@ -710,11 +770,10 @@ H264Parser::Result H264Parser::ParsePps(const Nalu& nalu, int* pps_id) {
   reader.Initialize(nalu.data() + nalu.header_size(), nalu.payload_size());
   H26xBitReader* br = &reader;
 
-  *pps_id = -1;
-
   std::unique_ptr<H264Pps> pps(new H264Pps());
 
   READ_UE_OR_RETURN(&pps->pic_parameter_set_id);
+  TRUE_OR_RETURN(pps->pic_parameter_set_id < 256);
   READ_UE_OR_RETURN(&pps->seq_parameter_set_id);
   TRUE_OR_RETURN(pps->seq_parameter_set_id < 32);
 
@@ -771,6 +830,7 @@ H264Parser::Result H264Parser::ParsePps(const Nalu& nalu, int* pps_id) {
   // If a PPS with the same id already exists, replace it.
   *pps_id = pps->pic_parameter_set_id;
   active_PPSes_[*pps_id] = std::move(pps);
+  SetPayload(nalu, &pps_payloads_[*pps_id]);
 
   return kOk;
 }
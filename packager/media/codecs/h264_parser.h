@@ -7,10 +7,11 @@
 #ifndef PACKAGER_MEDIA_CODECS_H264_PARSER_H_
 #define PACKAGER_MEDIA_CODECS_H264_PARSER_H_
 
+#include <array>
 #include <cstdint>
 #include <cstdlib>
-#include <map>
 #include <memory>
+#include <vector>
 
 #include <packager/macros/classes.h>
 #include <packager/media/codecs/h26x_bit_reader.h>
@@ -268,14 +269,21 @@ class H264Parser {
   // of the parsed structure in |*pps_id|/|*sps_id|.
   // To get a pointer to a given SPS/PPS structure, use GetSps()/GetPps(),
   // passing the returned |*sps_id|/|*pps_id| as parameter.
-  Result ParseSps(const Nalu& nalu, int* sps_id);
-  Result ParsePps(const Nalu& nalu, int* pps_id);
+  // A SPS/PPS identical to the stored one with the same id, e.g. repeated
+  // before every key frame, is not parsed again. |*is_repeated|, if not null,
+  // tells whether that is the case.
+  Result ParseSps(const Nalu& nalu, int* sps_id, bool* is_repeated = nullptr);
+  Result ParsePps(const Nalu& nalu, int* pps_id, bool* is_repeated = nullptr);
 
   // Return a pointer to SPS/PPS with given |sps_id|/|pps_id| or NULL if not
   // present.
   const H264Sps* GetSps(int sps_id);
   const H264Pps* GetPps(int pps_id);
 
+  // Replace the SPSes and PPSes of this parser with copies of the ones of
+  // |other|, which is cheaper than parsing them again.
+  void CopyParameterSetsFrom(const H264Parser& other);
+
   // Slice headers and SEI messages are not used across NALUs by the parser
   // and can be discarded after current NALU, so the parser does not store
   // them, nor does it manage their memory.
@@ -328,11 +336,16 @@ class H264Parser {
   // Parse decoded reference picture marking information (see spec).
   Result ParseDecRefPicMarking(H26xBitReader* br, H264SliceHeader* shdr);
 
-  // PPSes and SPSes stored for future reference.
-  typedef std::map<int, std::unique_ptr<H264Sps>> SpsById;
-  typedef std::map<int, std::unique_ptr<H264Pps>> PpsById;
-  SpsById active_SPSes_;
-  PpsById active_PPSes_;
+  // The ranges of the SPS and PPS ids, see 7.4.2.1.1 and 7.4.2.2.
+  static constexpr size_t kMaxSpsCount = 32;
+  static constexpr size_t kMaxPpsCount = 256;
+
+  // PPSes and SPSes stored for future reference, by id.
+  std::array<std::unique_ptr<H264Sps>, kMaxSpsCount> active_SPSes_;
+  std::array<std::unique_ptr<H264Pps>, kMaxPpsCount> active_PPSes_;
+  // The NALU payloads of the SPSes and PPSes above, to detect repeated ones.
+  std::array<std::vector<uint8_t>, kMaxSpsCount> sps_payloads_;
+  std::array<std::vector<uint8_t>, kMaxPpsCount> pps_payloads_;
 
   DISALLOW_COPY_AND_ASSIGN(H264Parser);
 };
@@ -194,6 +194,33 @@ TEST(H264ParserTest, PredWeightTable) {
   EXPECT_EQ(0, pred_weight_table.chroma_offset[3][1]);
 }
 
+TEST(H264ParserTest, RepeatedParameterSets) {
+  H264Parser parser;
+  int id;
+  bool is_repeated;
+  Nalu sps_nalu;
+  ASSERT_TRUE(sps_nalu.Initialize(Nalu::kH264, kSps2, std::size(kSps2)));
+  Nalu pps_nalu;
+  ASSERT_TRUE(pps_nalu.Initialize(Nalu::kH264, kPps2, std::size(kPps2)));
+
+  ASSERT_EQ(H264Parser::kOk, parser.ParseSps(sps_nalu, &id, &is_repeated));
+  EXPECT_FALSE(is_repeated);
+  ASSERT_EQ(H264Parser::kOk, parser.ParsePps(pps_nalu, &id, &is_repeated));
+  EXPECT_FALSE(is_repeated);
+  const H264Pps* pps = parser.GetPps(id);
+  ASSERT_TRUE(pps);
+
+  ASSERT_EQ(H264Parser::kOk, parser.ParseSps(sps_nalu, &id, &is_repeated));
+  EXPECT_TRUE(is_repeated);
+  EXPECT_EQ(0, id);
+  ASSERT_EQ(H264Parser::kOk, parser.ParsePps(pps_nalu, &id, &is_repeated));
+  EXPECT_TRUE(is_repeated);
+  EXPECT_EQ(pps, parser.GetPps(id));
+
+  EXPECT_FALSE(parser.GetSps(32));
+  EXPECT_FALSE(parser.GetPps(-1));
+}
+
 TEST(H264ParserTest, ParseSps) {
   const uint8_t kSps[] = {0x67, 0x64, 0x00, 0x1E, 0xAC, 0xD9, 0x40, 0xB4,
                           0x2F, 0xF9, 0x7F, 0xF0, 0x00, 0x80, 0x00, 0x91,
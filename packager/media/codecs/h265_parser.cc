@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
@@ -51,6 +52,27 @@ namespace shaka {
 namespace media {
 
 namespace {
+// Returns the ID of the entry of |payloads| equal to the payload of |nalu|, or
+// -1 if there is none.
+template <size_t kCount>
+int FindParameterSet(const std::array<std::vector<uint8_t>, kCount>& payloads,
+                     const Nalu& nalu) {
+  const uint8_t* payload = nalu.data() + nalu.header_size();
+  const uint64_t payload_size = nalu.payload_size();
+  for (size_t id = 0; id < kCount; ++id) {
+    if (!payloads[id].empty() && payloads[id].size() == payload_size &&
+        memcmp(payloads[id].data(), payload, payload_size) == 0) {
+      return static_cast<int>(id);
+    }
+  }
+  return -1;
+}
+
+void SetPayload(const Nalu& nalu, std::vector<uint8_t>* payload) {
+  const uint8_t* data = nalu.data() + nalu.header_size();
+  payload->assign(data, data + nalu.payload_size());
+}
+
 int GetNumPicTotalCurr(const H265SliceHeader& slice_header,
                        const H265Sps& sps) {
   int num_pic_total_curr = 0;
@@ -417,18 +439,28 @@ H265Parser::Result H265Parser::ParseSliceHeader(const Nalu& nalu,
   return kOk;
 }
 
-H265Parser::Result H265Parser::ParsePps(const Nalu& nalu, int* pps_id) {
+H265Parser::Result H265Parser::ParsePps(const Nalu& nalu,
+                                        int* pps_id,
+                                        bool* is_repeated) {
   DCHECK_EQ(Nalu::H265_PPS, nalu.type());
 
+  *pps_id = FindParameterSet(pps_payloads_, nalu);
+  if (is_repeated)
+    *is_repeated = *pps_id >= 0;
+  if (*pps_id >= 0)
+    return kOk;
+
   // Reads most of the element, not reading the extension data.
   H26xBitReader reader;
   reader.Initialize(nalu.data() + nalu.header_size(), nalu.payload_size());
   H26xBitReader* br = &reader;
 
-  *pps_id = -1;
   std::unique_ptr<H265Pps> pps(new H265Pps);
 
   TRUE_OR_RETURN(br->ReadUE(&pps->pic_parameter_set_id));
+  TRUE_OR_RETURN(pps->pic_parameter_set_id >= 0 &&
+                 static_cast<size_t>(pps->pic_parameter_set_id) <
+                     kMaxPpsCount);
   TRUE_OR_RETURN(br->ReadUE(&pps->seq_parameter_set_id));
 
   TRUE_OR_RETURN(br->ReadBool(&pps->dependent_slice_segments_enabled_flag));
@@ -521,20 +553,27 @@ H265Parser::Result H265Parser::ParsePps(const Nalu& nalu, int* pps_id) {
   // This will replace any existing PPS instance.
   *pps_id = pps->pic_parameter_set_id;
   active_ppses_[*pps_id] = std::move(pps);
+  SetPayload(nalu, &pps_payloads_[*pps_id]);
 
   return kOk;
 }
 
-H265Parser::Result H265Parser::ParseSps(const Nalu& nalu, int* sps_id) {
+H265Parser::Result H265Parser::ParseSps(const Nalu& nalu,
+                                        int* sps_id,
+                                        bool* is_repeated) {
   DCHECK_EQ(Nalu::H265_SPS, nalu.type());
 
+  *sps_id = FindParameterSet(sps_payloads_, nalu);
+  if (is_repeated)
+    *is_repeated = *sps_id >= 0;
+  if (*sps_id >= 0)
+    return kOk;
+
   // Reads most of the element, not reading the extension data.
   H26xBitReader reader;
   reader.Initialize(nalu.data() + nalu.header_size(), nalu.payload_size());
   H26xBitReader* br = &reader;
 
-  *sps_id = -1;
-
   std::unique_ptr<H265Sps> sps(new H265Sps);
 
   TRUE_OR_RETURN(br->ReadBits(4, &sps->video_parameter_set_id));
@@ -545,6 +584,9 @@ H265Parser::Result H265Parser::ParseSps(const Nalu& nalu, int* sps_id) {
       ReadProfileTierLevel(true, sps->max_sub_layers_minus1, br, sps.get()));
 
   TRUE_OR_RETURN(br->ReadUE(&sps->seq_parameter_set_id));
+  TRUE_OR_RETURN(sps->seq_parameter_set_id >= 0 &&
+                 static_cast<size_t>(sps->seq_parameter_set_id) <
+                     kMaxSpsCount);
   TRUE_OR_RETURN(br->ReadUE(&sps->chroma_format_idc));
   if (sps->chroma_format_idc == 3) {
     TRUE_OR_RETURN(br->ReadBool(&sps->separate_colour_plane_flag));
@@ -638,18 +680,36 @@ H265Parser::Result H265Parser::ParseSps(const Nalu& nalu, int* sps_id) {
   // This will replace any existing SPS instance.
   *sps_id = sps->seq_parameter_set_id;
   active_spses_[*sps_id] = std::move(sps);
+  SetPayload(nalu, &sps_payloads_[*sps_id]);
 
   return kOk;
 }
 
 const H265Pps* H265Parser::GetPps(int pps_id) {
+  if (pps_id < 0 || static_cast<size_t>(pps_id) >= kMaxPpsCount)
+    return nullptr;
   return active_ppses_[pps_id].get();
 }
 
 const H265Sps* H265Parser::GetSps(int sps_id) {
+  if (sps_id < 0 || static_cast<size_t>(sps_id) >= kMaxSpsCount)
+    return nullptr;
   return active_spses_[sps_id].get();
 }
 
+void H265Parser::CopyParameterSetsFrom(const H265Parser& other) {
+  for (size_t id = 0; id < kMaxSpsCount; ++id) {
+    const auto& sps = other.active_spses_[id];
+    active_spses_[id].reset(sps ? new H265Sps(*sps) : nullptr);
+  }
+  for (size_t id = 0; id < kMaxPpsCount; ++id) {
+    const auto& pps = other.active_ppses_[id];
+    active_ppses_[id].reset(pps ? new H265Pps(*pps) : nullptr);
+  }
+  sps_payloads_ = other.sps_payloads_;
+  pps_payloads_ = other.pps_payloads_;
+}
+
 H265Parser::Result H265Parser::ParseVuiParameters(int max_num_sub_layers_minus1,
                                                   H26xBitReader* br,
                                                   H265VuiParameters* vui) {
@@ -7,7 +7,7 @@
 #ifndef PACKAGER_MEDIA_CODECS_H265_PARSER_H_
 #define PACKAGER_MEDIA_CODECS_H265_PARSER_H_
 
-#include <map>
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -309,16 +309,24 @@ class H265Parser {
 
   /// Parses a PPS element.  This object is owned and managed by this class.
   /// The unique ID of the parsed PPS is stored in |*pps_id| if kOk is returned.
-  Result ParsePps(const Nalu& nalu, int* pps_id);
+  /// A PPS identical to the stored one with the same ID is not parsed again.
+  /// @param is_repeated, if not null, tells whether that is the case.
+  Result ParsePps(const Nalu& nalu, int* pps_id, bool* is_repeated = nullptr);
   /// Parses a SPS element.  This object is owned and managed by this class.
   /// The unique ID of the parsed SPS is stored in |*sps_id| if kOk is returned.
-  Result ParseSps(const Nalu& nalu, int* sps_id);
+  /// A SPS identical to the stored one with the same ID is not parsed again.
+  /// @param is_repeated, if not null, tells whether that is the case.
+  Result ParseSps(const Nalu& nalu, int* sps_id, bool* is_repeated = nullptr);
 
   /// @return a pointer to the PPS with the given ID, or NULL if none exists.
   const H265Pps* GetPps(int pps_id);
   /// @return a pointer to the SPS with the given ID, or NULL if none exists.
   const H265Sps* GetSps(int sps_id);
 
+  /// Replace the SPSes and PPSes of this parser with copies of the ones of
+  /// @a other, which is cheaper than parsing them again.
+  void CopyParameterSetsFrom(const H265Parser& other);
+
  private:
   Result ParseVuiParameters(int max_num_sub_layers_minus1,
                             H26xBitReader* br,
@@ -361,11 +369,16 @@ class H265Parser {
 
   Result ByteAlignment(H26xBitReader* br);
 
-  typedef std::map<int, std::unique_ptr<H265Sps>> SpsById;
-  typedef std::map<int, std::unique_ptr<H265Pps>> PpsById;
+  // The ranges of the SPS and PPS IDs, see 7.4.3.2.1 and 7.4.3.3.1.
+  static constexpr size_t kMaxSpsCount = 16;
+  static constexpr size_t kMaxPpsCount = 64;
 
-  SpsById active_spses_;
-  PpsById active_ppses_;
+  // Indexed by ID.
+  std::array<std::unique_ptr<H265Sps>, kMaxSpsCount> active_spses_;
+  std::array<std::unique_ptr<H265Pps>, kMaxPpsCount> active_ppses_;
+  // The NALU payloads of the SPSes and PPSes above, to detect repeated ones.
+  std::array<std::vector<uint8_t>, kMaxSpsCount> sps_payloads_;
+  std::array<std::vector<uint8_t>, kMaxPpsCount> pps_payloads_;
 
   DISALLOW_COPY_AND_ASSIGN(H265Parser);
 };
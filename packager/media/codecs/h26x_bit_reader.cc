@@ -16,6 +16,15 @@ bool CheckAnyBitsSet(int byte, int valid_bits) {
   return (byte & ((1 << valid_bits) - 1)) != 0;
 }
 
+// Returns the number of bits needed to represent |byte|, i.e. the position of
+// the most significant bit set plus one.
+int BitWidth(int byte) {
+  int bit_width = 0;
+  for (; byte != 0; byte >>= 1)
+    ++bit_width;
+  return bit_width;
+}
+
 }  // namespace
 
 H26xBitReader::H26xBitReader()
@@ -109,16 +118,28 @@ bool H26xBitReader::SkipBits(int num_bits) {
 }
 
 bool H26xBitReader::ReadUE(int* val) {
-  int num_bits = -1;
-  int bit;
+  int num_bits = 0;
   int rest;
 
-  // Count the number of contiguous zero bits.
-  do {
-    if (!ReadBits(1, &bit))
+  // Count the number of contiguous zero bits, a byte at a time, and consume
+  // the bit set after them.
+  while (true) {
+    if (num_remaining_bits_in_curr_byte_ == 0 && !UpdateCurrByte())
       return false;
-    num_bits++;
-  } while (bit == 0);
+    const int remaining_bits =
+        curr_byte_ & ((1 << num_remaining_bits_in_curr_byte_) - 1);
+    if (remaining_bits != 0) {
+      const int leading_zero_bits =
+          num_remaining_bits_in_curr_byte_ - BitWidth(remaining_bits);
+      num_bits += leading_zero_bits;
+      num_remaining_bits_in_curr_byte_ -= leading_zero_bits + 1;
+      break;
+    }
+    num_bits += num_remaining_bits_in_curr_byte_;
+    num_remaining_bits_in_curr_byte_ = 0;
+    if (num_bits > 31)
+      return false;
+  }
 
   if (num_bits > 31)
     return false;
@@ -132,5 +132,30 @@ TEST(H26xBitReaderTest, StopBitOccupyFullByte) {
   EXPECT_FALSE(reader.HasMoreRBSPData());
 }
 
+TEST(H26xBitReaderTest, ReadUE) {
+  H26xBitReader reader;
+  // 1 010 011 00100 00101, then a code with 30 leading zero bits, which has
+  // an emulation prevention byte in between.
+  const unsigned char rbsp[] = {0xa6, 0x42, 0x80, 0x00, 0x00, 0x03,
+                                0x01, 0xff, 0xff, 0xff, 0xfc};
+  int value = 0;
+
+  ASSERT_TRUE(reader.Initialize(rbsp, sizeof(rbsp)));
+  EXPECT_TRUE(reader.ReadUE(&value));
+  EXPECT_EQ(0, value);
+  EXPECT_TRUE(reader.ReadUE(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(reader.ReadUE(&value));
+  EXPECT_EQ(2, value);
+  EXPECT_TRUE(reader.ReadUE(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_TRUE(reader.ReadUE(&value));
+  EXPECT_EQ(4, value);
+  EXPECT_TRUE(reader.ReadUE(&value));
+  EXPECT_EQ((1 << 30) - 1 + ((1 << 30) - 1), value);
+  EXPECT_EQ(1u, reader.NumEmulationPreventionBytesRead());
+  EXPECT_EQ(2, reader.NumBitsLeft());
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -58,6 +58,27 @@ void AddAccessUnitDelimiter(BufferWriter* buffer_writer) {
   buffer_writer->AppendInt(kAccessUnitDelimiterRbspAnyPrimaryPicType);
 }
 
+// Returns the size of |sample| once each of its NAL unit length fields is
+// replaced by a start code, which the output is sized for up front.
+size_t GetByteStreamSize(const uint8_t* sample,
+                         size_t sample_size,
+                         int nalu_length_size) {
+  const size_t length_field_size = static_cast<size_t>(nalu_length_size);
+  if (length_field_size >= std::size(kNaluStartCode))
+    return sample_size;
+  size_t num_nalus = 0;
+  size_t offset = 0;
+  while (offset + length_field_size <= sample_size) {
+    size_t nalu_size = 0;
+    for (size_t i = 0; i < length_field_size; ++i)
+      nalu_size = (nalu_size << 8) | sample[offset + i];
+    offset += length_field_size + nalu_size;
+    ++num_nalus;
+  }
+  return sample_size +
+         num_nalus * (std::size(kNaluStartCode) - length_field_size);
+}
+
 }  // namespace
 
 void EscapeNalByteSequence(const uint8_t* input,
@@ -232,6 +253,10 @@ bool NalUnitToByteStreamConverter::Initialize(
   nalu_length_size_ = decoder_config_.nalu_length_size();
 
   BufferWriter buffer_writer(decoder_configuration_data_size);
+  buffer_writer.AppendArray(kNaluStartCode, std::size(kNaluStartCode));
+  AddAccessUnitDelimiter(&buffer_writer);
+  access_unit_prefix_.assign(buffer_writer.Buffer(),
+                             buffer_writer.Buffer() + buffer_writer.Size());
   bool found_sps = false;
   bool found_pps = false;
   for (uint32_t i = 0; i < decoder_config_.nalu_count(); ++i) {
@@ -254,7 +279,7 @@ bool NalUnitToByteStreamConverter::Initialize(
     return false;
   }
 
-  buffer_writer.SwapBuffer(&decoder_configuration_in_byte_stream_);
+  buffer_writer.SwapBuffer(&key_frame_access_unit_prefix_);
   return true;
 }
 
@@ -285,11 +310,15 @@ bool NalUnitToByteStreamConverter::ConvertUnitToByteStreamWithSubsamples(
 
   std::vector<SubsampleEntry> temp_subsamples;
 
-  BufferWriter buffer_writer(sample_size);
-  buffer_writer.AppendArray(kNaluStartCode, std::size(kNaluStartCode));
-  AddAccessUnitDelimiter(&buffer_writer);
-  if (is_key_frame)
-    buffer_writer.AppendVector(decoder_configuration_in_byte_stream_);
+  // Write to the storage of |output|, sized for the whole access unit.
+  const std::vector<uint8_t>& prefix =
+      is_key_frame ? key_frame_access_unit_prefix_ : access_unit_prefix_;
+  BufferWriter buffer_writer;
+  output->clear();
+  buffer_writer.SwapBuffer(output);
+  buffer_writer.Reserve(prefix.size() + GetByteStreamSize(sample, sample_size,
+                                                          nalu_length_size_));
+  buffer_writer.AppendVector(prefix);
 
   if (subsamples && !subsamples->empty()) {
     // The inserted part in buffer_writer is all clear. Add a corresponding
@@ -68,7 +68,9 @@ class NalUnitToByteStreamConverter {
   /// @param escape_encrypted_nalu indicates whether an encrypted nalu should be
   ///        escaped. This is needed for Apple Sample AES. Note that
   ///        |subsamples| on return contains the sizes before escaping.
-  /// @param[out] output is set to the the converted sample, on success.
+  /// @param[out] output is set to the the converted sample, on success. Its
+  ///        storage is reused, and grown at most once in most cases, so the
+  ///        sample can be converted straight into e.g. a PES payload.
   /// @param[in,out] subsamples has the input subsamples and output updated
   ///                subsamples, on success.
   /// @return true on success, false otherwise.
@@ -85,7 +87,11 @@ class NalUnitToByteStreamConverter {
 
   int nalu_length_size_;
   AVCDecoderConfigurationRecord decoder_config_;
-  std::vector<uint8_t> decoder_configuration_in_byte_stream_;
+  // The start code and the access unit delimiter which start every converted
+  // access unit, then for key frames the parameter sets of the decoder
+  // configuration. They are built once in Initialize().
+  std::vector<uint8_t> access_unit_prefix_;
+  std::vector<uint8_t> key_frame_access_unit_prefix_;
 
   DISALLOW_COPY_AND_ASSIGN(NalUnitToByteStreamConverter);
 };
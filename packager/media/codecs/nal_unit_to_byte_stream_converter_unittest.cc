@@ -202,6 +202,35 @@ TEST(NalUnitToByteStreamConverterTest, ConvertUnitToByteStream) {
             output);
 }
 
+// The output storage is reused, but not its content.
+TEST(NalUnitToByteStreamConverterTest, ReplacesOutput) {
+  const uint8_t kUnitStreamLikeMediaSample[] = {
+      0x00, 0x00, 0x00, 0x03,  // Size 3 NALU.
+      0x06,                    // NAL unit type.
+      0xFD, 0x78,
+  };
+  NalUnitToByteStreamConverter converter;
+  EXPECT_TRUE(
+      converter.Initialize(kTestAVCDecoderConfigurationRecord,
+                           std::size(kTestAVCDecoderConfigurationRecord)));
+
+  std::vector<uint8_t> output(100, 0xFF);
+  EXPECT_TRUE(converter.ConvertUnitToByteStream(
+      kUnitStreamLikeMediaSample, std::size(kUnitStreamLikeMediaSample),
+      !kIsKeyFrame, &output));
+
+  const uint8_t kExpectedOutput[] = {
+      0x00, 0x00, 0x00, 0x01,  // Start code.
+      0x09,                    // AUD type.
+      0xF0,                    // primary pic type is anything.
+      0x00, 0x00, 0x00, 0x01,  // Start code.
+      0x06, 0xFD, 0x78,        // The input NALU.
+  };
+  EXPECT_EQ(std::vector<uint8_t>(kExpectedOutput,
+                                 kExpectedOutput + std::size(kExpectedOutput)),
+            output);
+}
+
 // Expect a valid AVCDecoderConfigurationRecord with SPSExtension to pass.
 TEST(NalUnitToByteStreamConverterTest, ConvertUnitToByteStreamWithSPSExtension) {
   NalUnitToByteStreamConverter converter;
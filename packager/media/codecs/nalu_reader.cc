@@ -6,6 +6,7 @@
 
 #include <packager/media/codecs/nalu_reader.h>
 
+#include <cstring>
 #include <iostream>
 
 #include <absl/log/check.h>
@@ -316,31 +317,38 @@ bool NaluReader::FindStartCode(const uint8_t* data,
                                uint64_t data_size,
                                uint64_t* offset,
                                uint8_t* start_code_size) {
-  uint64_t bytes_left = data_size;
-
-  while (bytes_left >= 3) {
-    if (IsStartCode(data)) {
+  // A start code can only begin at one of the first |data_size| - 2 bytes.
+  const uint8_t* const search_end =
+      data_size >= 3 ? data + data_size - 2 : data;
+
+  // Jump between the zero bytes with memchr(), which is vectorized by the C
+  // library, instead of checking every byte. Zero bytes are rare in the
+  // payload of the NAL units because of the emulation prevention bytes.
+  const uint8_t* pos = data;
+  while (pos < search_end) {
+    pos = static_cast<const uint8_t*>(memchr(pos, 0x00, search_end - pos));
+    if (!pos)
+      break;
+    if (IsStartCode(pos)) {
       // Found three-byte start code, set pointer at its beginning.
-      *offset = data_size - bytes_left;
+      *offset = pos - data;
       *start_code_size = 3;
 
       // If there is a zero byte before this start code,
       // then it's actually a four-byte start code, so backtrack one byte.
-      if (*offset > 0 && *(data - 1) == 0x00) {
+      if (*offset > 0 && *(pos - 1) == 0x00) {
         --(*offset);
         ++(*start_code_size);
       }
 
       return true;
     }
-
-    ++data;
-    --bytes_left;
+    ++pos;
   }
 
   // End of data: offset is pointing to the first byte that was not considered
   // as a possible start of a start code.
-  *offset = data_size - bytes_left;
+  *offset = search_end - data;
   *start_code_size = 0;
   return false;
 }
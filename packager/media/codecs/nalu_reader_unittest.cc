@@ -309,6 +309,35 @@ TEST(NaluReaderTest, SubsamplesWithInvalidNalu) {
   EXPECT_EQ(0x14, nalu.type());
 }
 
+TEST(NaluReaderTest, FindStartCode) {
+  const uint8_t kData[] = {
+      0x12, 0x00, 0x34, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x65,
+      0x00, 0x00, 0x01, 0x67, 0x00, 0x00,
+  };
+
+  uint64_t offset = 0;
+  uint8_t start_code_size = 0;
+  ASSERT_TRUE(NaluReader::FindStartCode(kData, std::size(kData), &offset,
+                                        &start_code_size));
+  EXPECT_EQ(6u, offset);
+  EXPECT_EQ(4u, start_code_size);
+
+  ASSERT_TRUE(NaluReader::FindStartCode(kData + 10, std::size(kData) - 10,
+                                        &offset, &start_code_size));
+  EXPECT_EQ(1u, offset);
+  EXPECT_EQ(3u, start_code_size);
+
+  // The last two bytes cannot start a start code and are not consumed.
+  EXPECT_FALSE(NaluReader::FindStartCode(kData + 12, std::size(kData) - 12,
+                                         &offset, &start_code_size));
+  EXPECT_EQ(3u, offset);
+  EXPECT_EQ(0u, start_code_size);
+
+  EXPECT_FALSE(
+      NaluReader::FindStartCode(kData, 2, &offset, &start_code_size));
+  EXPECT_EQ(0u, offset);
+}
+
 // No NALU start code in the subsample range. A NALU start code in the buffer
 // not specified by subsamples.
 TEST(NaluReaderTest, FindStartCodeInClearRangeNoNalu) {
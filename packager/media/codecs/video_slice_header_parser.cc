@@ -67,6 +67,14 @@ int64_t H264VideoSliceHeaderParser::GetHeaderSize(const Nalu& nalu) {
   return NumBitsToNumBytes(slice_header.header_bit_size);
 }
 
+std::unique_ptr<VideoSliceHeaderParser> H264VideoSliceHeaderParser::Clone()
+    const {
+  std::unique_ptr<H264VideoSliceHeaderParser> clone(
+      new H264VideoSliceHeaderParser);
+  clone->parser_.CopyParameterSetsFrom(parser_);
+  return clone;
+}
+
 H265VideoSliceHeaderParser::H265VideoSliceHeaderParser() {}
 H265VideoSliceHeaderParser::~H265VideoSliceHeaderParser() {}
 
@@ -117,6 +125,14 @@ int64_t H265VideoSliceHeaderParser::GetHeaderSize(const Nalu& nalu) {
   return NumBitsToNumBytes(slice_header.header_bit_size);
 }
 
+std::unique_ptr<VideoSliceHeaderParser> H265VideoSliceHeaderParser::Clone()
+    const {
+  std::unique_ptr<H265VideoSliceHeaderParser> clone(
+      new H265VideoSliceHeaderParser);
+  clone->parser_.CopyParameterSetsFrom(parser_);
+  return clone;
+}
+
 }  // namespace media
 }  // namespace shaka
 
@@ -7,6 +7,7 @@
 #ifndef PACKAGER_MEDIA_CODECS_VIDEO_SLICE_HEADER_PARSER_H_
 #define PACKAGER_MEDIA_CODECS_VIDEO_SLICE_HEADER_PARSER_H_
 
+#include <memory>
 #include <vector>
 
 #include <packager/macros/classes.h>
@@ -37,6 +38,10 @@ class VideoSliceHeaderParser {
   /// Gets the header size of the given NALU.  Returns < 0 on error.
   virtual int64_t GetHeaderSize(const Nalu& nalu) = 0;
 
+  /// Creates a parser with the same parameter sets as this one, without
+  /// parsing them again.
+  virtual std::unique_ptr<VideoSliceHeaderParser> Clone() const = 0;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(VideoSliceHeaderParser);
 };
@@ -51,6 +56,7 @@ class H264VideoSliceHeaderParser : public VideoSliceHeaderParser {
   bool Initialize(const std::vector<uint8_t>& decoder_configuration) override;
   bool ProcessNalu(const Nalu& nalu) override;
   int64_t GetHeaderSize(const Nalu& nalu) override;
+  std::unique_ptr<VideoSliceHeaderParser> Clone() const override;
   /// @}
 
  private:
@@ -69,6 +75,7 @@ class H265VideoSliceHeaderParser : public VideoSliceHeaderParser {
   bool Initialize(const std::vector<uint8_t>& decoder_configuration) override;
   bool ProcessNalu(const Nalu& nalu) override;
   int64_t GetHeaderSize(const Nalu& nalu) override;
+  std::unique_ptr<VideoSliceHeaderParser> Clone() const override;
   /// @}
 
  private:
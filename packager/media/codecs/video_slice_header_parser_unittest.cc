@@ -45,6 +45,10 @@ TEST(H264VideoSliceHeaderParserTest, BasicSupport) {
   ASSERT_TRUE(nalu.Initialize(Nalu::kH264, kData, std::size(kData)));
   // Real header size is 34 bits, but we round up to 5 bytes.
   EXPECT_EQ(5, parser.GetHeaderSize(nalu));
+
+  // The parameter sets are copied.
+  std::unique_ptr<VideoSliceHeaderParser> clone = parser.Clone();
+  EXPECT_EQ(5, clone->GetHeaderSize(nalu));
 }
 
 TEST(H264VideoSliceHeaderParserTest, SupportsMultipleEntriesInExtraData) {
@@ -6,6 +6,9 @@
 
 #include <packager/media/codecs/vp9_parser.h>
 
+#include <algorithm>
+#include <cstring>
+
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 
@@ -34,6 +37,8 @@ const uint32_t MI_SIZE_LOG2 = 3;
 const uint32_t MI_BLOCK_SIZE_LOG2 = (6 - MI_SIZE_LOG2);  // 64 = 2^6
 const uint32_t MIN_TILE_WIDTH_B64 = 4;
 const uint32_t MAX_TILE_WIDTH_B64 = 64;
+// The number of inter frame headers remembered.
+const size_t kMaxCachedHeaders = 8;
 
 const bool SEG_FEATURE_DATA_SIGNED[SEG_LVL_MAX] = {true, true, false, false};
 const uint32_t SEG_FEATURE_DATA_MAX_BITS[SEG_LVL_MAX] = {8, 6, 2, 0};
@@ -464,113 +469,177 @@ bool VP9Parser::Parse(const uint8_t* data,
   RCHECK(ParseIfSuperframeIndex(data, data_size, vpx_frames));
 
   for (auto& vpx_frame : *vpx_frames) {
-    VLOG(4) << "process frame with size " << vpx_frame.frame_size;
-    BitReader reader(data, vpx_frame.frame_size);
-    uint8_t frame_marker;
-    RCHECK(reader.ReadBits(2, &frame_marker));
-    RCHECK(frame_marker == VP9_FRAME_MARKER);
-
-    RCHECK(ReadProfile(&reader, writable_codec_config()));
-
-    bool show_existing_frame;
-    RCHECK(reader.ReadBits(1, &show_existing_frame));
-    if (show_existing_frame) {
-      RCHECK(reader.SkipBits(3));  // ref_frame_index
-      // End of current frame data. There should be no more bytes available.
-      RCHECK(reader.bits_available() < 8);
-
-      vpx_frame.is_keyframe = false;
-      vpx_frame.uncompressed_header_size = vpx_frame.frame_size;
-      vpx_frame.width = width_;
-      vpx_frame.height = height_;
-      continue;
-    }
+    if (!ParseCachedFrame(data, &vpx_frame))
+      RCHECK(ParseFrame(data, &vpx_frame));
+    data += vpx_frame.frame_size;
+  }
+  return true;
+}
+
+bool VP9Parser::ParseFrame(const uint8_t* data, VPxFrameInfo* vpx_frame) {
+  VLOG(4) << "process frame with size " << vpx_frame->frame_size;
+  const uint32_t width = width_;
+  const uint32_t height = height_;
+  BitReader reader(data, vpx_frame->frame_size);
+  uint8_t frame_marker;
+  RCHECK(reader.ReadBits(2, &frame_marker));
+  RCHECK(frame_marker == VP9_FRAME_MARKER);
+
+  RCHECK(ReadProfile(&reader, writable_codec_config()));
 
-    bool is_interframe;
-    RCHECK(reader.ReadBits(1, &is_interframe));
-    vpx_frame.is_keyframe = !is_interframe;
+  bool show_existing_frame;
+  RCHECK(reader.ReadBits(1, &show_existing_frame));
+  if (show_existing_frame) {
+    RCHECK(reader.SkipBits(3));  // ref_frame_index
+    // End of current frame data. There should be no more bytes available.
+    RCHECK(reader.bits_available() < 8);
+
+    vpx_frame->is_keyframe = false;
+    vpx_frame->uncompressed_header_size = vpx_frame->frame_size;
+    vpx_frame->width = width_;
+    vpx_frame->height = height_;
+    return true;
+  }
 
-    bool show_frame;
-    RCHECK(reader.ReadBits(1, &show_frame));
-    bool error_resilient_mode;
-    RCHECK(reader.ReadBits(1, &error_resilient_mode));
+  bool is_interframe;
+  RCHECK(reader.ReadBits(1, &is_interframe));
+  vpx_frame->is_keyframe = !is_interframe;
+
+  bool show_frame;
+  RCHECK(reader.ReadBits(1, &show_frame));
+  bool error_resilient_mode;
+  RCHECK(reader.ReadBits(1, &error_resilient_mode));
+
+  bool intra_only = false;
+  if (vpx_frame->is_keyframe) {
+    RCHECK(ReadSyncCode(&reader));
+    RCHECK(ReadBitDepthAndColorSpace(&reader, writable_codec_config()));
+    RCHECK(ReadFrameSizes(&reader, &width_, &height_));
+  } else {
+    if (!show_frame)
+      RCHECK(reader.ReadBits(1, &intra_only));
+    if (!error_resilient_mode)
+      RCHECK(reader.SkipBits(2));  // reset_frame_context
 
-    if (vpx_frame.is_keyframe) {
+    if (intra_only) {
       RCHECK(ReadSyncCode(&reader));
-      RCHECK(ReadBitDepthAndColorSpace(&reader, writable_codec_config()));
+      if (codec_config().profile() > 0) {
+        RCHECK(ReadBitDepthAndColorSpace(&reader, writable_codec_config()));
+      } else {
+        // NOTE: The intra-only frame header does not include the
+        // specification of either the color format or color sub-sampling in
+        // profile 0. VP9 specifies that the default color format should be
+        // YUV 4:2:0 in this case (normative).
+        writable_codec_config()->SetChromaSubsampling(
+            VPCodecConfigurationRecord::CHROMA_420_COLLOCATED_WITH_LUMA);
+        writable_codec_config()->set_bit_depth(8);
+      }
+
+      RCHECK(reader.SkipBits(REF_FRAMES));  // refresh_frame_flags
       RCHECK(ReadFrameSizes(&reader, &width_, &height_));
     } else {
-      bool intra_only = false;
-      if (!show_frame)
-        RCHECK(reader.ReadBits(1, &intra_only));
-      if (!error_resilient_mode)
-        RCHECK(reader.SkipBits(2));  // reset_frame_context
-
-      if (intra_only) {
-        RCHECK(ReadSyncCode(&reader));
-        if (codec_config().profile() > 0) {
-          RCHECK(ReadBitDepthAndColorSpace(&reader, writable_codec_config()));
-        } else {
-          // NOTE: The intra-only frame header does not include the
-          // specification of either the color format or color sub-sampling in
-          // profile 0. VP9 specifies that the default color format should be
-          // YUV 4:2:0 in this case (normative).
-          writable_codec_config()->SetChromaSubsampling(
-              VPCodecConfigurationRecord::CHROMA_420_COLLOCATED_WITH_LUMA);
-          writable_codec_config()->set_bit_depth(8);
-        }
-
-        RCHECK(reader.SkipBits(REF_FRAMES));  // refresh_frame_flags
-        RCHECK(ReadFrameSizes(&reader, &width_, &height_));
-      } else {
-        RCHECK(reader.SkipBits(REF_FRAMES));  // refresh_frame_flags
-        RCHECK(reader.SkipBits(REFS_PER_FRAME * (REF_FRAMES_LOG2 + 1)));
+      RCHECK(reader.SkipBits(REF_FRAMES));  // refresh_frame_flags
+      RCHECK(reader.SkipBits(REFS_PER_FRAME * (REF_FRAMES_LOG2 + 1)));
 
-        // TODO(kqyang): We may need to actually build the refs to extract the
-        // correct width and height for the current frame. The width will be
-        // used later in ReadTileInfo.
-        RCHECK(ReadFrameSizesWithRefs(&reader, &width_, &height_));
+      // TODO(kqyang): We may need to actually build the refs to extract the
+      // correct width and height for the current frame. The width will be
+      // used later in ReadTileInfo.
+      RCHECK(ReadFrameSizesWithRefs(&reader, &width_, &height_));
 
-        RCHECK(reader.SkipBits(1));  // allow_high_precision_mv
+      RCHECK(reader.SkipBits(1));  // allow_high_precision_mv
 
-        bool interp_filter;
-        RCHECK(reader.ReadBits(1, &interp_filter));
-        if (!interp_filter)
-          RCHECK(reader.SkipBits(2));  // more interp_filter
-      }
+      bool interp_filter;
+      RCHECK(reader.ReadBits(1, &interp_filter));
+      if (!interp_filter)
+        RCHECK(reader.SkipBits(2));  // more interp_filter
     }
+  }
 
-    if (!error_resilient_mode) {
-      RCHECK(reader.SkipBits(1));  // refresh_frame_context
-      RCHECK(reader.SkipBits(1));  // frame_parallel_decoding_mode
-    }
-    RCHECK(reader.SkipBits(FRAME_CONTEXTS_LOG2));  // frame_context_idx
+  if (!error_resilient_mode) {
+    RCHECK(reader.SkipBits(1));  // refresh_frame_context
+    RCHECK(reader.SkipBits(1));  // frame_parallel_decoding_mode
+  }
+  RCHECK(reader.SkipBits(FRAME_CONTEXTS_LOG2));  // frame_context_idx
+
+  VLOG(4) << "bits read before ReadLoopFilter: " << reader.bit_position();
+  RCHECK(ReadLoopFilter(&reader));
+  RCHECK(ReadQuantization(&reader));
+  RCHECK(ReadSegmentation(&reader));
+  RCHECK(ReadTileInfo(width_, &reader));
+
+  const size_t header_size_position = reader.bit_position();
+  uint16_t header_size;
+  RCHECK(reader.ReadBits(16, &header_size));
+  vpx_frame->uncompressed_header_size =
+      vpx_frame->frame_size - reader.bits_available() / 8;
+  vpx_frame->width = width_;
+  vpx_frame->height = height_;
+
+  VLOG(3) << "\n frame_size: " << vpx_frame->frame_size
+          << "\n uncompressed_header_size: "
+          << vpx_frame->uncompressed_header_size
+          << "\n bits read: " << reader.bit_position()
+          << "\n header_size: " << header_size;
+
+  RCHECK(header_size > 0);
+  RCHECK(header_size * 8u <= reader.bits_available());
+
+  if (vpx_frame->is_keyframe || intra_only)
+    return true;
+  CachedHeader cached_header;
+  cached_header.data.assign(data, data + (header_size_position + 7) / 8);
+  if (header_size_position % 8 != 0)
+    cached_header.data.back() &= 0xff << (8 - header_size_position % 8);
+  cached_header.num_bits = header_size_position;
+  cached_header.profile = codec_config().profile();
+  cached_header.width = width;
+  cached_header.height = height;
+  cached_header.new_width = width_;
+  cached_header.new_height = height_;
+  cached_headers_.push_front(std::move(cached_header));
+  if (cached_headers_.size() > kMaxCachedHeaders)
+    cached_headers_.pop_back();
+  return true;
+}
 
-    VLOG(4) << "bits read before ReadLoopFilter: " << reader.bit_position();
-    RCHECK(ReadLoopFilter(&reader));
-    RCHECK(ReadQuantization(&reader));
-    RCHECK(ReadSegmentation(&reader));
-    RCHECK(ReadTileInfo(width_, &reader));
+bool VP9Parser::ParseCachedFrame(const uint8_t* data,
+                                 VPxFrameInfo* vpx_frame) {
+  for (auto iter = cached_headers_.begin(); iter != cached_headers_.end();
+       ++iter) {
+    const CachedHeader& cached_header = *iter;
+    const size_t num_bytes = cached_header.data.size();
+    const size_t num_whole_bytes = cached_header.num_bits / 8;
+    if (cached_header.width != width_ || cached_header.height != height_ ||
+        vpx_frame->frame_size < num_bytes ||
+        memcmp(data, cached_header.data.data(), num_whole_bytes) != 0) {
+      continue;
+    }
+    if (num_bytes > num_whole_bytes) {
+      const uint8_t mask = 0xff << (8 - cached_header.num_bits % 8);
+      if ((data[num_whole_bytes] & mask) != cached_header.data.back())
+        continue;
+    }
 
+    BitReader reader(data, vpx_frame->frame_size);
     uint16_t header_size;
+    RCHECK(reader.SkipBits(cached_header.num_bits));
     RCHECK(reader.ReadBits(16, &header_size));
-    vpx_frame.uncompressed_header_size =
-        vpx_frame.frame_size - reader.bits_available() / 8;
-    vpx_frame.width = width_;
-    vpx_frame.height = height_;
-
-    VLOG(3) << "\n frame_size: " << vpx_frame.frame_size
-            << "\n uncompressed_header_size: "
-            << vpx_frame.uncompressed_header_size
-            << "\n bits read: " << reader.bit_position()
-            << "\n header_size: " << header_size;
-
     RCHECK(header_size > 0);
     RCHECK(header_size * 8u <= reader.bits_available());
 
-    data += vpx_frame.frame_size;
+    writable_codec_config()->set_profile(cached_header.profile);
+    width_ = cached_header.new_width;
+    height_ = cached_header.new_height;
+    vpx_frame->is_keyframe = false;
+    vpx_frame->uncompressed_header_size =
+        vpx_frame->frame_size - reader.bits_available() / 8;
+    vpx_frame->width = width_;
+    vpx_frame->height = height_;
+    if (iter != cached_headers_.begin())
+      std::rotate(cached_headers_.begin(), iter, iter + 1);
+    return true;
   }
-  return true;
+  return false;
 }
 
 bool VP9Parser::IsKeyframe(const uint8_t* data, size_t data_size) {
@@ -9,6 +9,8 @@
 
 #include <cstdint>
 #include <cstdlib>
+#include <deque>
+#include <vector>
 
 #include <packager/macros/classes.h>
 #include <packager/media/codecs/vpx_parser.h>
@@ -17,6 +19,11 @@ namespace shaka {
 namespace media {
 
 /// Class to parse a vp9 bit stream.
+///
+/// The uncompressed headers of the recent inter frames are remembered up to
+/// their header_size_in_bytes field. Most inter frames of a stream start with
+/// the same bits as one of them, e.g. with the same quantizer and loop filter
+/// levels, and only their header_size_in_bytes field is read.
 class VP9Parser : public VPxParser {
  public:
   VP9Parser();
@@ -40,10 +47,34 @@ class VP9Parser : public VPxParser {
   static bool IsKeyframe(const uint8_t* data, size_t data_size);
 
  private:
+  // The uncompressed header of an inter frame, up to its header_size_in_bytes
+  // field. An inter frame header only depends on its bits and on the current
+  // frame size, so the frames which start with the same bits, at the same
+  // frame size, have the same header size.
+  struct CachedHeader {
+    // The bytes of the header, with the bits past |num_bits| cleared.
+    std::vector<uint8_t> data;
+    size_t num_bits = 0;
+    uint8_t profile = 0;
+    // The frame size before and after the frame.
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t new_width = 0;
+    uint32_t new_height = 0;
+  };
+
+  // Parse the frame at |data|, of |vpx_frame->frame_size| bytes.
+  bool ParseFrame(const uint8_t* data, VPxFrameInfo* vpx_frame);
+  // Parse the frame at |data| from the header of a recent frame.
+  // @return false if the frame does not start with one of them.
+  bool ParseCachedFrame(const uint8_t* data, VPxFrameInfo* vpx_frame);
+
   // Keep track of the current width and height. Note that they may change from
   // frame to frame.
   uint32_t width_;
   uint32_t height_;
+  // The most recently used first.
+  std::deque<CachedHeader> cached_headers_;
 
   DISALLOW_COPY_AND_ASSIGN(VP9Parser);
 };
@@ -199,6 +199,18 @@ TEST(VP9ParserTest, Interframe) {
   ASSERT_TRUE(parser.Parse(kData, std::size(kData), &frames));
   EXPECT_THAT(frames,
               ElementsAre(EqualVPxFrame(std::size(kData), 10u, false, 0u, 0u)));
+
+  // The following frames with the same header, up to its header size field,
+  // are parsed from the header of the first one.
+  std::vector<uint8_t> data(std::begin(kData), std::end(kData));
+  data[9] = 0x05;  // header_size_in_bytes.
+  data.back() = 0x00;
+  ASSERT_TRUE(parser.Parse(data.data(), data.size(), &frames));
+  EXPECT_THAT(frames,
+              ElementsAre(EqualVPxFrame(data.size(), 10u, false, 0u, 0u)));
+
+  data[9] = 0x00;
+  EXPECT_FALSE(parser.Parse(data.data(), data.size(), &frames));
 }
 
 TEST(VP9ParserTest, CorruptedFrameMarker) {
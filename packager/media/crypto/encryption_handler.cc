@@ -7,16 +7,24 @@
 #include <packager/media/crypto/encryption_handler.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include <absl/log/check.h>
+#include <absl/synchronization/notification.h>
+#include <mbedtls/aes.h>
+#include <mbedtls/md.h>
 
+#include <packager/file/thread_pool.h>
 #include <packager/macros/logging.h>
 #include <packager/macros/status.h>
 #include <packager/media/base/aes_encryptor.h>
 #include <packager/media/base/audio_stream_info.h>
+#include <packager/media/base/buffer_writer.h>
 #include <packager/media/base/common_pssh_generator.h>
+#include <packager/media/base/decryptor_source.h>
 #include <packager/media/base/key_source.h>
 #include <packager/media/base/media_sample.h>
 #include <packager/media/base/playready_pssh_generator.h>
@@ -24,11 +32,21 @@
 #include <packager/media/base/video_stream_info.h>
 #include <packager/media/base/widevine_pssh_generator.h>
 #include <packager/media/crypto/aes_encryptor_factory.h>
+#include <packager/media/crypto/protection_system_info_cache.h>
 #include <packager/media/crypto/subsample_generator.h>
+#include <packager/utils/trace.h>
 
 namespace shaka {
 namespace media {
 
+// A sample being encrypted on a worker thread.
+struct EncryptionHandler::PendingSample {
+  std::shared_ptr<MediaSample> cipher_sample;
+  // Set by the worker thread before |done| is notified.
+  bool success = false;
+  absl::Notification done;
+};
+
 namespace {
 // The encryption handler only supports a single output.
 const size_t kStreamIndex = 0;
@@ -70,6 +88,47 @@ bool IsPatternEncryptionScheme(FourCC protection_scheme) {
          protection_scheme == FOURCC_cbcs || protection_scheme == FOURCC_cens;
 }
 
+// Derive the iv of a sample as the encryption with |key| of the hash of its
+// decoding timestamp and its |data|, so that it does not depend on the samples
+// before it. Samples with different data get unrelated ivs.
+bool DeriveSampleIv(const std::vector<uint8_t>& key,
+                    int64_t dts,
+                    const uint8_t* data,
+                    size_t data_size,
+                    std::vector<uint8_t>* iv) {
+  const size_t kBlockSize = 16;
+  BufferWriter dts_bytes;
+  dts_bytes.AppendInt(dts);
+
+  const mbedtls_md_info_t* md_info =
+      mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+  uint8_t hash[32];
+  mbedtls_md_context_t md_ctx;
+  mbedtls_md_init(&md_ctx);
+  bool success = mbedtls_md_setup(&md_ctx, md_info, 0) == 0 &&
+                 mbedtls_md_starts(&md_ctx) == 0 &&
+                 mbedtls_md_update(&md_ctx, dts_bytes.Buffer(),
+                                   dts_bytes.Size()) == 0 &&
+                 mbedtls_md_update(&md_ctx, data, data_size) == 0 &&
+                 mbedtls_md_finish(&md_ctx, hash) == 0;
+  mbedtls_md_free(&md_ctx);
+
+  uint8_t block[kBlockSize];
+  mbedtls_aes_context aes_ctx;
+  mbedtls_aes_init(&aes_ctx);
+  success = success &&
+            mbedtls_aes_setkey_enc(&aes_ctx, key.data(),
+                                   static_cast<unsigned int>(key.size() * 8)) ==
+                0 &&
+            mbedtls_aes_crypt_ecb(&aes_ctx, MBEDTLS_AES_ENCRYPT, hash, block) ==
+                0;
+  mbedtls_aes_free(&aes_ctx);
+  if (!success || iv->size() > kBlockSize)
+    return false;
+  iv->assign(block, block + iv->size());
+  return true;
+}
+
 void FillPsshGenerators(
     const EncryptionParams& encryption_params,
     std::vector<std::unique_ptr<PsshGenerator>>* pssh_generators,
@@ -123,13 +182,9 @@ void AddProtectionSystemIfNotExist(
   encryption_config->key_system_info.push_back(pssh_info);
 }
 
-Status FillProtectionSystemInfo(const EncryptionParams& encryption_params,
-                                const EncryptionKey& encryption_key,
-                                EncryptionConfig* encryption_config) {
-  // If generating dummy keys for key rotation, don't generate PSSH info.
-  if (encryption_key.key_ids.empty())
-    return Status::OK;
-
+Status GenerateProtectionSystemInfo(const EncryptionParams& encryption_params,
+                                    const EncryptionKey& encryption_key,
+                                    EncryptionConfig* encryption_config) {
   std::vector<std::unique_ptr<PsshGenerator>> pssh_generators;
   std::vector<std::vector<uint8_t>> no_pssh_systems;
   FillPsshGenerators(encryption_params, &pssh_generators, &no_pssh_systems);
@@ -159,17 +214,80 @@ Status FillProtectionSystemInfo(const EncryptionParams& encryption_params,
   return Status::OK;
 }
 
+void AppendToCacheKey(const std::vector<uint8_t>& data, BufferWriter* writer) {
+  writer->AppendInt(static_cast<uint64_t>(data.size()));
+  writer->AppendVector(data);
+}
+
+// The generated protection system information depends only on the key and on
+// the parameters used by FillPsshGenerators().
+std::string GetProtectionSystemInfoCacheKey(
+    const EncryptionParams& encryption_params,
+    const EncryptionKey& encryption_key) {
+  BufferWriter writer;
+  writer.AppendInt(static_cast<uint16_t>(encryption_params.protection_systems));
+  writer.AppendInt(encryption_params.protection_scheme);
+  writer.AppendInt(static_cast<uint8_t>(
+      encryption_params.key_provider == KeyProvider::kRawKey &&
+      !encryption_params.raw_key.pssh.empty()));
+  const std::string& extra_header_data =
+      encryption_params.playready_extra_header_data;
+  writer.AppendInt(static_cast<uint64_t>(extra_header_data.size()));
+  writer.AppendString(extra_header_data);
+  AppendToCacheKey(encryption_key.key_id, &writer);
+  AppendToCacheKey(encryption_key.key, &writer);
+  writer.AppendInt(static_cast<uint64_t>(encryption_key.key_ids.size()));
+  for (const auto& key_id : encryption_key.key_ids)
+    AppendToCacheKey(key_id, &writer);
+  const auto& key_system_info = encryption_key.key_system_info;
+  writer.AppendInt(static_cast<uint64_t>(key_system_info.size()));
+  for (const auto& info : key_system_info) {
+    AppendToCacheKey(info.system_id, &writer);
+    AppendToCacheKey(info.psshs, &writer);
+  }
+  return std::string(writer.Buffer(), writer.Buffer() + writer.Size());
+}
+
+Status FillProtectionSystemInfo(const EncryptionParams& encryption_params,
+                                const EncryptionKey& encryption_key,
+                                EncryptionConfig* encryption_config) {
+  // If generating dummy keys for key rotation, don't generate PSSH info.
+  if (encryption_key.key_ids.empty())
+    return Status::OK;
+
+  // The streams encrypted with the same key share the generated boxes.
+  const std::string cache_key =
+      GetProtectionSystemInfoCacheKey(encryption_params, encryption_key);
+  std::shared_ptr<const ProtectionSystemInfoCache::Info> cached_info =
+      ProtectionSystemInfoCache::instance.Get(cache_key);
+  if (!cached_info) {
+    RETURN_IF_ERROR(GenerateProtectionSystemInfo(
+        encryption_params, encryption_key, encryption_config));
+    cached_info = ProtectionSystemInfoCache::instance.Put(
+        cache_key, encryption_config->key_system_info);
+  }
+  encryption_config->key_system_info = *cached_info;
+  return Status::OK;
+}
+
 }  // namespace
 
 EncryptionHandler::EncryptionHandler(const EncryptionParams& encryption_params,
-                                     KeySource* key_source)
+                                     KeySource* key_source,
+                                     KeySource* decryption_key_source)
     : encryption_params_(encryption_params),
       protection_scheme_(
           static_cast<FourCC>(encryption_params.protection_scheme)),
       key_source_(key_source),
+      decryptor_source_(decryption_key_source
+                            ? new DecryptorSource(decryption_key_source)
+                            : nullptr),
       subsample_generator_(
           new SubsampleGenerator(encryption_params.vp9_subsample_encryption)),
-      encryptor_factory_(new AesEncryptorFactory) {}
+      encryptor_factory_(new AesEncryptorFactory),
+      encrypt_on_worker_threads_(
+          encryption_params.sample_encryption_threads > 1 &&
+          protection_scheme_ == FOURCC_cenc) {}
 
 EncryptionHandler::~EncryptionHandler() = default;
 
@@ -185,6 +303,10 @@ Status EncryptionHandler::InitializeInternal() {
 }
 
 Status EncryptionHandler::Process(std::unique_ptr<StreamData> stream_data) {
+  // Samples being encrypted on worker threads go out before anything else.
+  if (stream_data->stream_data_type != StreamDataType::kMediaSample)
+    RETURN_IF_ERROR(DispatchPendingSamples(0));
+
   switch (stream_data->stream_data_type) {
     case StreamDataType::kStreamInfo:
       return ProcessStreamInfo(*stream_data->stream_info);
@@ -203,6 +325,8 @@ Status EncryptionHandler::Process(std::unique_ptr<StreamData> stream_data) {
         if (remaining_clear_lead_ > 0)
           remaining_clear_lead_ -= segment_info->duration;
       }
+      // The samples of the segment have all been dispatched above.
+      segment_info->encrypted_time = std::chrono::system_clock::now();
 
       return DispatchSegmentInfo(kStreamIndex, segment_info);
     }
@@ -215,8 +339,15 @@ Status EncryptionHandler::Process(std::unique_ptr<StreamData> stream_data) {
   }
 }
 
+Status EncryptionHandler::OnFlushRequest(size_t input_stream_index) {
+  RETURN_IF_ERROR(DispatchPendingSamples(0));
+  return MediaHandler::OnFlushRequest(input_stream_index);
+}
+
 Status EncryptionHandler::ProcessStreamInfo(const StreamInfo& clear_info) {
-  if (clear_info.is_encrypted()) {
+  // The samples of an encrypted stream are transcrypted if they can be
+  // decrypted.
+  if (clear_info.is_encrypted() && !decryptor_source_) {
     return Status(error::INVALID_ARGUMENT,
                   "Input stream is already encrypted.");
   }
@@ -263,14 +394,42 @@ Status EncryptionHandler::ProcessStreamInfo(const StreamInfo& clear_info) {
 }
 
 Status EncryptionHandler::ProcessMediaSample(
-    std::shared_ptr<const MediaSample> clear_sample) {
-  DCHECK(clear_sample);
+    std::shared_ptr<const MediaSample> sample) {
+  DCHECK(sample);
+
+  // Samples of encrypted inputs are transcrypted, without an intermediate
+  // clear copy. If the subsamples of the input are kept, each subsample is
+  // decrypted then encrypted into the output buffer while it is in cache.
+  // Otherwise the sample is decrypted into the output buffer first, then
+  // encrypted in place.
+  std::shared_ptr<const MediaSample> clear_sample;
+  std::shared_ptr<MediaSample> decrypted_sample;
+  std::shared_ptr<uint8_t> decrypted_data;
+  std::vector<SubsampleEntry> subsamples;
+  if (!sample->is_encrypted()) {
+    clear_sample = sample;
+  } else {
+    if (!decryptor_source_) {
+      return Status(error::INVALID_ARGUMENT,
+                    "Input sample is already encrypted.");
+    }
+    if (!sample->decrypt_config())
+      return Status(error::ENCRYPTION_FAILURE, "Missing decrypt config.");
+    if (CanKeepSubsamples(*sample->decrypt_config())) {
+      subsamples = sample->decrypt_config()->subsamples();
+    } else {
+      RETURN_IF_ERROR(
+          DecryptSample(*sample, &decrypted_sample, &decrypted_data));
+      clear_sample = decrypted_sample;
+    }
+  }
 
   // Process the frame even if the frame is not encrypted as the next
   // (encrypted) frame may be dependent on this clear frame.
-  std::vector<SubsampleEntry> subsamples;
-  RETURN_IF_ERROR(subsample_generator_->GenerateSubsamples(
-      clear_sample->data(), clear_sample->data_size(), &subsamples));
+  if (clear_sample) {
+    RETURN_IF_ERROR(
+        subsample_generator_->GenerateSubsamples(*clear_sample, &subsamples));
+  }
 
   // Need to setup the encryptor for new segments even if this segment does not
   // need to be encrypted, so we can signal encryption metadata earlier to
@@ -278,11 +437,12 @@ Status EncryptionHandler::ProcessMediaSample(
   if (check_new_crypto_period_) {
     // |dts| can be negative, e.g. after EditList adjustments. Normalized to 0
     // in that case.
-    const int64_t dts = std::max(clear_sample->dts(), static_cast<int64_t>(0));
+    const int64_t dts = std::max(sample->dts(), static_cast<int64_t>(0));
     const int64_t current_crypto_period_index = dts / crypto_period_duration_;
     const int32_t crypto_period_duration_in_seconds = static_cast<int32_t>(
         encryption_params_.crypto_period_duration_in_seconds);
     if (current_crypto_period_index != prev_crypto_period_index_) {
+      ScopedTraceEvent trace_event("EncryptionHandler::SwitchKey");
       EncryptionKey encryption_key;
       RETURN_IF_ERROR(key_source_->GetCryptoPeriodKey(
           current_crypto_period_index, crypto_period_duration_in_seconds,
@@ -297,43 +457,38 @@ Status EncryptionHandler::ProcessMediaSample(
   // Since there is no encryption needed right now, send the clear copy
   // downstream so we can save the costs of copying it.
   if (remaining_clear_lead_ > 0) {
+    RETURN_IF_ERROR(DispatchPendingSamples(0));
+    if (!clear_sample) {
+      RETURN_IF_ERROR(
+          DecryptSample(*sample, &decrypted_sample, &decrypted_data));
+      clear_sample = decrypted_sample;
+    }
     return DispatchMediaSample(kStreamIndex, std::move(clear_sample));
   }
 
-  size_t ciphertext_size =
-      encryptor_->RequiredOutputSize(clear_sample->data_size());
-
-  std::shared_ptr<uint8_t> cipher_sample_data(new uint8_t[ciphertext_size],
-                                              std::default_delete<uint8_t[]>());
-
-  const uint8_t* source = clear_sample->data();
-  uint8_t* dest = cipher_sample_data.get();
-  if (!subsamples.empty()) {
-    size_t total_size = 0;
-    for (const SubsampleEntry& subsample : subsamples) {
-      if (subsample.clear_bytes > 0) {
-        // clear_bytes is the number of bytes to leave in the clear
-        memcpy(dest, source, subsample.clear_bytes);
-        source += subsample.clear_bytes;
-        dest += subsample.clear_bytes;
-        total_size += subsample.clear_bytes;
-      }
-      if (subsample.cipher_bytes > 0) {
-        // cipher_bytes is the number of bytes we want to encrypt
-        EncryptBytes(source, subsample.cipher_bytes, dest, ciphertext_size);
-        source += subsample.cipher_bytes;
-        dest += subsample.cipher_bytes;
-        total_size += subsample.cipher_bytes;
-      }
-    }
-    DCHECK_EQ(total_size, clear_sample->data_size());
+  std::shared_ptr<uint8_t> cipher_sample_data;
+  std::shared_ptr<MediaSample> cipher_sample;
+  if (decrypted_sample) {
+    // The decrypted buffer has room for the cipher text.
+    cipher_sample_data = std::move(decrypted_data);
+    cipher_sample = std::move(decrypted_sample);
   } else {
-    EncryptBytes(source, clear_sample->data_size(), dest, ciphertext_size);
+    size_t ciphertext_size =
+        encryptor_->RequiredOutputSize(sample->data_size());
+    cipher_sample_data = MediaSample::AllocateData(ciphertext_size);
+    cipher_sample = sample->Clone();
+    cipher_sample->TransferData(cipher_sample_data, sample->data_size());
   }
 
-  std::shared_ptr<MediaSample> cipher_sample(clear_sample->Clone());
-  cipher_sample->TransferData(std::move(cipher_sample_data),
-                              clear_sample->data_size());
+  if (encryption_params_.derive_sample_ivs && !encryptor_->use_constant_iv()) {
+    const MediaSample& source = clear_sample ? *clear_sample : *sample;
+    std::vector<uint8_t> iv = encryptor_->iv();
+    if (!DeriveSampleIv(encryption_key_, sample->dts(), source.data(),
+                        source.data_size(), &iv) ||
+        !encryptor_->SetIv(iv)) {
+      return Status(error::ENCRYPTION_FAILURE, "Failed to derive sample iv.");
+    }
+  }
 
   // Finish initializing the sample before sending it downstream. We must
   // wait until now to finish the initialization as we will lose access to
@@ -342,13 +497,156 @@ Status EncryptionHandler::ProcessMediaSample(
   std::unique_ptr<DecryptConfig> decrypt_config(new DecryptConfig(
       encryption_config_->key_id, encryptor_->iv(), subsamples,
       protection_scheme_, crypt_byte_block_, skip_byte_block_));
+
+  if (!clear_sample) {
+    RETURN_IF_ERROR(
+        TranscryptSample(*sample, subsamples, cipher_sample_data.get()));
+    cipher_sample->set_decrypt_config(std::move(decrypt_config));
+    encryptor_->UpdateIv();
+    return DispatchMediaSample(kStreamIndex, std::move(cipher_sample));
+  }
   cipher_sample->set_decrypt_config(std::move(decrypt_config));
 
+  if (encrypt_on_worker_threads_) {
+    return EncryptSampleOnWorkerThread(std::move(clear_sample), subsamples,
+                                       std::move(cipher_sample),
+                                       cipher_sample_data.get());
+  }
+
+  if (!encryptor_->CryptSubsamples(clear_sample->data(),
+                                   clear_sample->data_size(), subsamples,
+                                   cipher_sample_data.get())) {
+    return Status(error::ENCRYPTION_FAILURE, "Failed to encrypt sample.");
+  }
+
   encryptor_->UpdateIv();
 
   return DispatchMediaSample(kStreamIndex, std::move(cipher_sample));
 }
 
+bool EncryptionHandler::CanKeepSubsamples(
+    const DecryptConfig& decrypt_config) const {
+  // The subsamples of the input are valid for the output if the protection
+  // is the same, e.g. when only the keys change. Samples encrypted on worker
+  // threads are decrypted first.
+  return !encrypt_on_worker_threads_ && !decrypt_config.subsamples().empty() &&
+         decrypt_config.protection_scheme() == protection_scheme_ &&
+         decrypt_config.crypt_byte_block() == crypt_byte_block_ &&
+         decrypt_config.skip_byte_block() == skip_byte_block_;
+}
+
+Status EncryptionHandler::DecryptSample(
+    const MediaSample& encrypted_sample,
+    std::shared_ptr<MediaSample>* decrypted_sample,
+    std::shared_ptr<uint8_t>* decrypted_data) {
+  // Leave room to encrypt the sample in place.
+  std::shared_ptr<uint8_t> data = MediaSample::AllocateData(
+      encryptor_->RequiredOutputSize(encrypted_sample.data_size()));
+  if (!decryptor_source_->DecryptSampleBuffer(
+          encrypted_sample.decrypt_config(), encrypted_sample.data(),
+          encrypted_sample.data_size(), data.get())) {
+    return Status(error::ENCRYPTION_FAILURE, "Failed to decrypt sample.");
+  }
+  std::shared_ptr<MediaSample> sample = encrypted_sample.Clone();
+  sample->TransferData(data, encrypted_sample.data_size());
+  sample->set_is_encrypted(false);
+  sample->set_decrypt_config(nullptr);
+  *decrypted_sample = std::move(sample);
+  *decrypted_data = std::move(data);
+  return Status::OK;
+}
+
+Status EncryptionHandler::TranscryptSample(
+    const MediaSample& encrypted_sample,
+    const std::vector<SubsampleEntry>& subsamples,
+    uint8_t* cipher_sample_data) {
+  AesCryptor* decryptor =
+      decryptor_source_->GetDecryptor(*encrypted_sample.decrypt_config());
+  if (!decryptor)
+    return Status(error::ENCRYPTION_FAILURE, "Failed to get decryptor.");
+
+  const uint8_t* data = encrypted_sample.data();
+  size_t remaining_size = encrypted_sample.data_size();
+  for (const SubsampleEntry& subsample : subsamples) {
+    if (static_cast<size_t>(subsample.clear_bytes) + subsample.cipher_bytes >
+        remaining_size) {
+      return Status(error::ENCRYPTION_FAILURE,
+                    "Subsamples overflow sample buffer.");
+    }
+    memcpy(cipher_sample_data, data, subsample.clear_bytes);
+    data += subsample.clear_bytes;
+    cipher_sample_data += subsample.clear_bytes;
+    if (subsample.cipher_bytes > 0) {
+      if (!decryptor->Crypt(data, subsample.cipher_bytes, cipher_sample_data) ||
+          !encryptor_->Crypt(cipher_sample_data, subsample.cipher_bytes,
+                             cipher_sample_data)) {
+        return Status(error::ENCRYPTION_FAILURE,
+                      "Failed to transcrypt sample.");
+      }
+      data += subsample.cipher_bytes;
+      cipher_sample_data += subsample.cipher_bytes;
+    }
+    remaining_size -= subsample.clear_bytes + subsample.cipher_bytes;
+  }
+  // Bytes past the subsamples are clear.
+  memcpy(cipher_sample_data, data, remaining_size);
+  return Status::OK;
+}
+
+Status EncryptionHandler::EncryptSampleOnWorkerThread(
+    std::shared_ptr<const MediaSample> clear_sample,
+    const std::vector<SubsampleEntry>& subsamples,
+    std::shared_ptr<MediaSample> cipher_sample,
+    uint8_t* cipher_sample_data) {
+  // Each sample gets its own encryptor, starting from the iv of the sample, so
+  // that samples can be encrypted independently. |encryptor_| only tracks the
+  // iv of the next sample.
+  std::shared_ptr<AesCryptor> sample_encryptor =
+      encryptor_factory_->CreateEncryptor(protection_scheme_, crypt_byte_block_,
+                                          skip_byte_block_, codec_,
+                                          encryption_key_, encryptor_->iv());
+  if (!sample_encryptor)
+    return Status(error::ENCRYPTION_FAILURE, "Failed to create encryptor");
+
+  size_t crypt_text_size = clear_sample->data_size();
+  if (!subsamples.empty()) {
+    crypt_text_size = 0;
+    for (const SubsampleEntry& subsample : subsamples)
+      crypt_text_size += subsample.cipher_bytes;
+  }
+  encryptor_->UpdateIv(crypt_text_size);
+
+  std::shared_ptr<PendingSample> pending_sample(new PendingSample);
+  pending_sample->cipher_sample = std::move(cipher_sample);
+  ThreadPool::instance.PostTask(
+      [pending_sample, sample_encryptor, clear_sample, subsamples,
+       cipher_sample_data]() {
+        pending_sample->success = sample_encryptor->CryptSubsamples(
+            clear_sample->data(), clear_sample->data_size(), subsamples,
+            cipher_sample_data);
+        pending_sample->done.Notify();
+      });
+  pending_samples_.push_back(std::move(pending_sample));
+
+  return DispatchPendingSamples(encryption_params_.sample_encryption_threads -
+                                1);
+}
+
+Status EncryptionHandler::DispatchPendingSamples(size_t max_pending_samples) {
+  while (pending_samples_.size() > max_pending_samples) {
+    std::shared_ptr<PendingSample> pending_sample =
+        std::move(pending_samples_.front());
+    pending_samples_.pop_front();
+
+    pending_sample->done.WaitForNotification();
+    if (!pending_sample->success)
+      return Status(error::ENCRYPTION_FAILURE, "Failed to encrypt sample.");
+    RETURN_IF_ERROR(DispatchMediaSample(
+        kStreamIndex, std::move(pending_sample->cipher_sample)));
+  }
+  return Status::OK;
+}
+
 void EncryptionHandler::SetupProtectionPattern(StreamType stream_type) {
   if (stream_type == kStreamVideo &&
       IsPatternEncryptionScheme(protection_scheme_)) {
@@ -370,6 +668,7 @@ bool EncryptionHandler::CreateEncryptor(const EncryptionKey& encryption_key) {
   if (!encryptor)
     return false;
   encryptor_ = std::move(encryptor);
+  encryption_key_ = encryption_key.key;
 
   encryption_config_.reset(new EncryptionConfig);
   encryption_config_->protection_scheme = protection_scheme_;
@@ -390,16 +689,6 @@ bool EncryptionHandler::CreateEncryptor(const EncryptionKey& encryption_key) {
   return status.ok();
 }
 
-void EncryptionHandler::EncryptBytes(const uint8_t* source,
-                                     size_t source_size,
-                                     uint8_t* dest,
-                                     size_t dest_size) {
-  DCHECK(source);
-  DCHECK(dest);
-  DCHECK(encryptor_);
-  CHECK(encryptor_->Crypt(source, source_size, dest, &dest_size));
-}
-
 void EncryptionHandler::InjectSubsampleGeneratorForTesting(
     std::unique_ptr<SubsampleGenerator> generator) {
   subsample_generator_ = std::move(generator);
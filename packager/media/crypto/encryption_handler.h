@@ -7,6 +7,11 @@
 #ifndef PACKAGER_MEDIA_CRYPTO_ENCRYPTION_HANDLER_H_
 #define PACKAGER_MEDIA_CRYPTO_ENCRYPTION_HANDLER_H_
 
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
 #include <packager/crypto_params.h>
 #include <packager/media/base/key_source.h>
 #include <packager/media/base/media_handler.h>
@@ -16,13 +21,19 @@ namespace media {
 
 class AesCryptor;
 class AesEncryptorFactory;
+class DecryptorSource;
 class SubsampleGenerator;
 struct EncryptionKey;
 
 class EncryptionHandler : public MediaHandler {
  public:
+  /// @param key_source is the source of the encryption keys.
+  /// @param decryption_key_source is the source of the keys of encrypted
+  ///        input samples, which are then transcrypted. Encrypted input
+  ///        samples are rejected if it is not set.
   EncryptionHandler(const EncryptionParams& encryption_params,
-                    KeySource* key_source);
+                    KeySource* key_source,
+                    KeySource* decryption_key_source = nullptr);
 
   ~EncryptionHandler() override;
 
@@ -31,18 +42,45 @@ class EncryptionHandler : public MediaHandler {
   /// @{
   Status InitializeInternal() override;
   Status Process(std::unique_ptr<StreamData> stream_data) override;
+  Status OnFlushRequest(size_t input_stream_index) override;
   /// @}
 
  private:
   friend class EncryptionHandlerTest;
 
+  struct PendingSample;
+
   EncryptionHandler(const EncryptionHandler&) = delete;
   EncryptionHandler& operator=(const EncryptionHandler&) = delete;
 
   // Processes |stream_info| and sets up stream specific variables.
   Status ProcessStreamInfo(const StreamInfo& stream_info);
   // Processes media sample and encrypts it if needed.
-  Status ProcessMediaSample(std::shared_ptr<const MediaSample> clear_sample);
+  Status ProcessMediaSample(std::shared_ptr<const MediaSample> sample);
+  // Whether the subsamples of an input sample with |decrypt_config| are kept
+  // when it is transcrypted.
+  bool CanKeepSubsamples(const DecryptConfig& decrypt_config) const;
+  // Decrypts |encrypted_sample| into |decrypted_data|, which is owned by
+  // |decrypted_sample| and large enough to encrypt it in place.
+  Status DecryptSample(const MediaSample& encrypted_sample,
+                       std::shared_ptr<MediaSample>* decrypted_sample,
+                       std::shared_ptr<uint8_t>* decrypted_data);
+  // Decrypts and encrypts |encrypted_sample| into |cipher_sample_data| one
+  // subsample at a time, keeping the subsamples of the input.
+  Status TranscryptSample(const MediaSample& encrypted_sample,
+                          const std::vector<SubsampleEntry>& subsamples,
+                          uint8_t* cipher_sample_data);
+  // Encrypts |clear_sample| into |cipher_sample_data|, which is owned by
+  // |cipher_sample|, on a worker thread. |cipher_sample| is dispatched later by
+  // DispatchPendingSamples().
+  Status EncryptSampleOnWorkerThread(
+      std::shared_ptr<const MediaSample> clear_sample,
+      const std::vector<SubsampleEntry>& subsamples,
+      std::shared_ptr<MediaSample> cipher_sample,
+      uint8_t* cipher_sample_data);
+  // Waits for the samples being encrypted on worker threads and dispatches
+  // them in order, until at most |max_pending_samples| are left.
+  Status DispatchPendingSamples(size_t max_pending_samples);
 
   void SetupProtectionPattern(StreamType stream_type);
   bool CreateEncryptor(const EncryptionKey& encryption_key);
@@ -51,12 +89,6 @@ class EncryptionHandler : public MediaHandler {
   bool SampleAesEncryptEac3Frame(const uint8_t* source,
                                  size_t source_size,
                                  uint8_t* dest);
-  // Encrypt an array with size |source_size|. |dest| should have at
-  // least |source_size| bytes.
-  void EncryptBytes(const uint8_t* source,
-                    size_t source_size,
-                    uint8_t* dest,
-                    size_t dest_size);
 
   // An E-AC3 frame comprises of one or more syncframes. This function extracts
   // the syncframe sizes from the source bytes.
@@ -74,10 +106,14 @@ class EncryptionHandler : public MediaHandler {
   const EncryptionParams encryption_params_;
   const FourCC protection_scheme_ = FOURCC_NULL;
   KeySource* key_source_ = nullptr;
+  // Decrypts the input samples which are transcrypted.
+  std::unique_ptr<DecryptorSource> decryptor_source_;
   std::string stream_label_;
   // Current encryption config and encryptor.
   std::shared_ptr<EncryptionConfig> encryption_config_;
   std::unique_ptr<AesCryptor> encryptor_;
+  // Key of |encryptor_|.
+  std::vector<uint8_t> encryption_key_;
   Codec codec_ = kUnknownCodec;
   // Remaining clear lead in the stream's time scale.
   int64_t remaining_clear_lead_ = 0;
@@ -93,6 +129,12 @@ class EncryptionHandler : public MediaHandler {
   uint8_t crypt_byte_block_ = 0;
   /// Number of unencrypted blocks (16-byte-block) in pattern based encryption.
   uint8_t skip_byte_block_ = 0;
+
+  // Whether samples are encrypted on worker threads, see
+  // EncryptionParams::sample_encryption_threads.
+  const bool encrypt_on_worker_threads_ = false;
+  // Samples being encrypted on worker threads, in input order.
+  std::deque<std::shared_ptr<PendingSample>> pending_samples_;
 };
 
 }  // namespace media
@@ -11,6 +11,8 @@
 #include <gtest/gtest.h>
 
 #include <packager/media/base/aes_cryptor.h>
+#include <packager/media/base/aes_encryptor.h>
+#include <packager/media/base/decrypt_config.h>
 #include <packager/media/base/media_handler_test_base.h>
 #include <packager/media/base/mock_aes_cryptor.h>
 #include <packager/media/base/protection_system_ids.h>
@@ -101,7 +103,8 @@ class EncryptionHandlerTest : public MediaHandlerGraphTestBase {
  public:
   void SetUp() override { SetUpEncryptionHandler(EncryptionParams()); }
 
-  void SetUpEncryptionHandler(const EncryptionParams& encryption_params) {
+  void SetUpEncryptionHandler(const EncryptionParams& encryption_params,
+                              KeySource* decryption_key_source = nullptr) {
     EncryptionParams new_encryption_params = encryption_params;
     if (!encryption_params.stream_label_func) {
       // Setup default stream label function.
@@ -115,8 +118,8 @@ class EncryptionHandlerTest : public MediaHandlerGraphTestBase {
             return kSdVideoStreamLabel;
           };
     }
-    encryption_handler_.reset(
-        new EncryptionHandler(new_encryption_params, &mock_key_source_));
+    encryption_handler_.reset(new EncryptionHandler(
+        new_encryption_params, &mock_key_source_, decryption_key_source));
     SetUpGraph(1 /* one input */, 1 /* one output */, encryption_handler_);
     // Inject default subsamples to avoid parsing problems.
     const std::vector<SubsampleEntry> empty_subsamples;
@@ -669,5 +672,176 @@ TEST_F(EncryptionHandlerPsshTest, UsesKeyInfoFirst) {
       stream_info->encryption_config().key_system_info[0].psshs.empty());
 }
 
+class EncryptionHandlerWorkerThreadsTest : public EncryptionHandlerTest {
+ protected:
+  struct EncryptedSample {
+    int64_t dts;
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> iv;
+  };
+
+  // Encrypts a few segments with cenc, from |first_segment|, and returns the
+  // encrypted samples.
+  std::vector<EncryptedSample> Encrypt(uint32_t sample_encryption_threads,
+                                       bool derive_sample_ivs = false,
+                                       int first_segment = 0) {
+    EncryptionParams encryption_params;
+    encryption_params.sample_encryption_threads = sample_encryption_threads;
+    encryption_params.derive_sample_ivs = derive_sample_ivs;
+    SetUpEncryptionHandler(encryption_params);
+    InjectSubsamples({{5, 20}, {3, 12}});
+    EXPECT_CALL(mock_key_source_, GetKey(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(GetMockEncryptionKey()),
+                        Return(Status::OK)));
+
+    std::vector<EncryptedSample> samples;
+    EXPECT_OK(Process(StreamData::FromStreamInfo(
+        kStreamIndex, GetVideoStreamInfo(kTimeScale, kCodecH264))));
+    const int kNumSegments = 3;
+    const int kSamplesPerSegment = 7;
+    for (int i = first_segment; i < kNumSegments; ++i) {
+      for (int j = 0; j < kSamplesPerSegment; ++j) {
+        std::vector<uint8_t> data(40);
+        for (size_t k = 0; k < data.size(); ++k)
+          data[k] = static_cast<uint8_t>(i * 100 + j * 10 + k);
+        const int64_t dts = (i * kSamplesPerSegment + j) * kSampleDuration;
+        EXPECT_OK(Process(StreamData::FromMediaSample(
+            kStreamIndex, GetMediaSample(dts, kSampleDuration, kIsKeyFrame,
+                                         data.data(), data.size()))));
+      }
+      EXPECT_OK(Process(StreamData::FromSegmentInfo(
+          kStreamIndex,
+          GetSegmentInfo(i * kSamplesPerSegment * kSampleDuration,
+                         kSamplesPerSegment * kSampleDuration, !kIsSubsegment,
+                         i))));
+
+      // All the samples of the segment go out before the segment info.
+      const auto& output_stream_data = GetOutputStreamDataVector();
+      EXPECT_EQ(StreamDataType::kSegmentInfo,
+                output_stream_data.back()->stream_data_type);
+      for (const auto& stream_data : output_stream_data) {
+        if (stream_data->stream_data_type != StreamDataType::kMediaSample)
+          continue;
+        const MediaSample& sample = *stream_data->media_sample;
+        samples.push_back({sample.dts(),
+                           std::vector<uint8_t>(
+                               sample.data(), sample.data() + sample.data_size()),
+                           sample.decrypt_config()->iv()});
+      }
+      ClearOutputStreamDataVector();
+    }
+    return samples;
+  }
+};
+
+TEST_F(EncryptionHandlerWorkerThreadsTest, SameOutputAsCallingThread) {
+  const std::vector<EncryptedSample> expected_samples = Encrypt(0);
+  const std::vector<EncryptedSample> samples = Encrypt(4);
+
+  ASSERT_EQ(expected_samples.size(), samples.size());
+  for (size_t i = 0; i < samples.size(); ++i) {
+    EXPECT_EQ(expected_samples[i].dts, samples[i].dts);
+    EXPECT_EQ(expected_samples[i].data, samples[i].data);
+    EXPECT_EQ(expected_samples[i].iv, samples[i].iv);
+  }
+}
+
+TEST_F(EncryptionHandlerWorkerThreadsTest, DerivedIvsDoNotDependOnStart) {
+  const std::vector<EncryptedSample> expected_samples = Encrypt(0, true);
+  const std::vector<EncryptedSample> samples = Encrypt(4, true, 1);
+
+  ASSERT_LT(samples.size(), expected_samples.size());
+  const size_t offset = expected_samples.size() - samples.size();
+  for (size_t i = 0; i < samples.size(); ++i) {
+    EXPECT_EQ(expected_samples[offset + i].dts, samples[i].dts);
+    EXPECT_EQ(expected_samples[offset + i].data, samples[i].data);
+    EXPECT_EQ(expected_samples[offset + i].iv, samples[i].iv);
+  }
+  // The ivs are not incremented from sample to sample.
+  EXPECT_NE(Encrypt(0, false, 1)[0].iv, samples[0].iv);
+}
+
+class EncryptionHandlerTranscryptionTest
+    : public EncryptionHandlerTest,
+      public WithParamInterface<FourCC> {
+ protected:
+  // Encrypts a few samples with the protection scheme of the test and returns
+  // the encrypted data. The input samples are clear if |transcrypt| is false,
+  // or encrypted with 'cenc' and another key otherwise.
+  std::vector<std::vector<uint8_t>> Encrypt(bool transcrypt) {
+    const std::vector<uint8_t> source_key_id(16, 0x11);
+    const std::vector<uint8_t> source_key(16, 0x22);
+    const std::vector<uint8_t> source_iv(8, 0x33);
+    RawKeyParams raw_key;
+    raw_key.key_map[""].key_id = source_key_id;
+    raw_key.key_map[""].key = source_key;
+    std::unique_ptr<RawKeySource> decryption_key_source =
+        RawKeySource::Create(raw_key);
+    EXPECT_TRUE(decryption_key_source);
+
+    EncryptionParams encryption_params;
+    encryption_params.protection_scheme = GetParam();
+    SetUpEncryptionHandler(encryption_params, decryption_key_source.get());
+    const std::vector<SubsampleEntry> subsamples = {{5, 20}, {3, 12}};
+    InjectSubsamples(subsamples);
+    EXPECT_CALL(mock_key_source_, GetKey(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(GetMockEncryptionKey()),
+                        Return(Status::OK)));
+
+    std::unique_ptr<StreamInfo> stream_info =
+        GetVideoStreamInfo(kTimeScale, kCodecH264);
+    stream_info->set_is_encrypted(transcrypt);
+    EXPECT_OK(Process(
+        StreamData::FromStreamInfo(kStreamIndex, std::move(stream_info))));
+
+    std::vector<std::vector<uint8_t>> samples;
+    const int kNumSamples = 5;
+    for (int i = 0; i < kNumSamples; ++i) {
+      std::vector<uint8_t> data(40);
+      for (size_t k = 0; k < data.size(); ++k)
+        data[k] = static_cast<uint8_t>(i * 10 + k);
+      if (transcrypt) {
+        AesCtrEncryptor source_encryptor;
+        EXPECT_TRUE(source_encryptor.InitializeWithIv(source_key, source_iv));
+        EXPECT_TRUE(source_encryptor.CryptSubsamples(
+            data.data(), data.size(), subsamples, data.data()));
+      }
+      std::shared_ptr<MediaSample> sample = GetMediaSample(
+          i * kSampleDuration, kSampleDuration, kIsKeyFrame, data.data(),
+          data.size());
+      if (transcrypt) {
+        sample->set_is_encrypted(true);
+        sample->set_decrypt_config(std::unique_ptr<DecryptConfig>(
+            new DecryptConfig(source_key_id, source_iv, subsamples,
+                              FOURCC_cenc, 0, 0)));
+      }
+      EXPECT_OK(Process(StreamData::FromMediaSample(kStreamIndex, sample)));
+    }
+
+    for (const auto& stream_data : GetOutputStreamDataVector()) {
+      if (stream_data->stream_data_type != StreamDataType::kMediaSample)
+        continue;
+      const MediaSample& sample = *stream_data->media_sample;
+      EXPECT_TRUE(sample.is_encrypted());
+      EXPECT_EQ(subsamples, sample.decrypt_config()->subsamples());
+      samples.emplace_back(sample.data(), sample.data() + sample.data_size());
+    }
+    ClearOutputStreamDataVector();
+    return samples;
+  }
+};
+
+TEST_P(EncryptionHandlerTranscryptionTest, SameOutputAsClearInput) {
+  const std::vector<std::vector<uint8_t>> expected_samples = Encrypt(false);
+  const std::vector<std::vector<uint8_t>> samples = Encrypt(true);
+  ASSERT_EQ(5u, samples.size());
+  EXPECT_EQ(expected_samples, samples);
+}
+
+// 'cenc' keeps the subsamples of the input, 'cbcs' decrypts it first.
+INSTANTIATE_TEST_CASE_P(ProtectionSchemes,
+                        EncryptionHandlerTranscryptionTest,
+                        Values(FOURCC_cenc, FOURCC_cbcs));
+
 }  // namespace media
 }  // namespace shaka
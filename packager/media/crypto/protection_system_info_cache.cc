@@ -0,0 +1,56 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/crypto/protection_system_info_cache.h>
+
+#include <absl/log/check.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+// Enough for the keys of the current and next crypto periods of many
+// channels.
+const size_t kDefaultCapacity = 256;
+
+}  // namespace
+
+ProtectionSystemInfoCache ProtectionSystemInfoCache::instance(
+    kDefaultCapacity);
+
+ProtectionSystemInfoCache::ProtectionSystemInfoCache(size_t capacity)
+    : capacity_(capacity) {
+  DCHECK_GT(capacity_, 0u);
+}
+
+ProtectionSystemInfoCache::~ProtectionSystemInfoCache() = default;
+
+std::shared_ptr<const ProtectionSystemInfoCache::Info>
+ProtectionSystemInfoCache::Get(const std::string& key) {
+  absl::MutexLock lock(&mutex_);
+  auto iter = entries_.find(key);
+  return iter == entries_.end() ? nullptr : iter->second;
+}
+
+std::shared_ptr<const ProtectionSystemInfoCache::Info>
+ProtectionSystemInfoCache::Put(const std::string& key, Info info) {
+  absl::MutexLock lock(&mutex_);
+  auto iter = entries_.find(key);
+  if (iter != entries_.end())
+    return iter->second;
+
+  while (keys_.size() >= capacity_) {
+    entries_.erase(keys_.front());
+    keys_.pop_front();
+  }
+  std::shared_ptr<const Info> entry(new Info(std::move(info)));
+  entries_[key] = entry;
+  keys_.push_back(key);
+  return entry;
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,62 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_CRYPTO_PROTECTION_SYSTEM_INFO_CACHE_H_
+#define PACKAGER_MEDIA_CRYPTO_PROTECTION_SYSTEM_INFO_CACHE_H_
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+
+#include <packager/macros/classes.h>
+#include <packager/media/base/protection_system_specific_info.h>
+
+namespace shaka {
+namespace media {
+
+/// Caches the protection system information generated for a key, so that the
+/// streams and outputs encrypted with the same key, e.g. at every crypto
+/// period with key rotation, generate the 'pssh' boxes only once. The oldest
+/// entries are evicted once the cache is full.
+class ProtectionSystemInfoCache {
+ public:
+  typedef std::vector<ProtectionSystemSpecificInfo> Info;
+
+  /// @param capacity is the maximum number of entries.
+  explicit ProtectionSystemInfoCache(size_t capacity);
+  ~ProtectionSystemInfoCache();
+
+  /// @param key identifies the key and the protection systems.
+  /// @return The cached information, or null if it is not cached.
+  std::shared_ptr<const Info> Get(const std::string& key);
+
+  /// Add the information generated for @a key, unless some is already cached.
+  /// @return The cached information.
+  std::shared_ptr<const Info> Put(const std::string& key, Info info);
+
+  /// The cache shared by all the encryption handlers.
+  static ProtectionSystemInfoCache instance;
+
+ private:
+  const size_t capacity_;
+
+  absl::Mutex mutex_;
+  std::map<std::string, std::shared_ptr<const Info>> entries_
+      ABSL_GUARDED_BY(mutex_);
+  // The keys of |entries_|, from the oldest to the newest.
+  std::deque<std::string> keys_ ABSL_GUARDED_BY(mutex_);
+
+  DISALLOW_COPY_AND_ASSIGN(ProtectionSystemInfoCache);
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_CRYPTO_PROTECTION_SYSTEM_INFO_CACHE_H_
@@ -0,0 +1,50 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/crypto/protection_system_info_cache.h>
+
+#include <gtest/gtest.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+ProtectionSystemInfoCache::Info CreateInfo(uint8_t system_id) {
+  ProtectionSystemSpecificInfo info;
+  info.system_id = {system_id};
+  info.psshs = {1, 2, 3};
+  return {info};
+}
+
+}  // namespace
+
+TEST(ProtectionSystemInfoCacheTest, GetAndPut) {
+  ProtectionSystemInfoCache cache(2);
+  EXPECT_FALSE(cache.Get("key"));
+
+  auto info = cache.Put("key", CreateInfo(1));
+  ASSERT_TRUE(info);
+  EXPECT_EQ(info, cache.Get("key"));
+  ASSERT_EQ(1u, info->size());
+  EXPECT_EQ(std::vector<uint8_t>({1}), info->front().system_id);
+
+  // The first information added for a key is kept.
+  EXPECT_EQ(info, cache.Put("key", CreateInfo(2)));
+}
+
+TEST(ProtectionSystemInfoCacheTest, EvictsOldestEntries) {
+  ProtectionSystemInfoCache cache(2);
+  cache.Put("key1", CreateInfo(1));
+  cache.Put("key2", CreateInfo(2));
+  cache.Put("key3", CreateInfo(3));
+
+  EXPECT_FALSE(cache.Get("key1"));
+  EXPECT_TRUE(cache.Get("key2"));
+  EXPECT_TRUE(cache.Get("key3"));
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -92,21 +92,19 @@ bool SampleAesEc3Cryptor::CryptInternal(const uint8_t* text,
   // encrypted.
   const size_t kLeadingClearBytesSize = 16u;
 
+  // The syncframes are laid out as subsamples up front, so that the
+  // underlying cryptor can crypt all of them at once rather than one call per
+  // syncframe. The residual block of each syncframe is left untouched (copied
+  // without encryption/decryption) by the underlying cryptor.
+  subsamples_.clear();
   for (size_t syncframe_size : syncframe_sizes) {
-    memcpy(crypt_text, text, std::min(syncframe_size, kLeadingClearBytesSize));
-    if (syncframe_size > kLeadingClearBytesSize) {
-      // The residual block is left untouched (copied without
-      // encryption/decryption). No need to do special handling here.
-      if (!cryptor_->Crypt(text + kLeadingClearBytesSize,
-                           syncframe_size - kLeadingClearBytesSize,
-                           crypt_text + kLeadingClearBytesSize)) {
-        return false;
-      }
-    }
-    text += syncframe_size;
-    crypt_text += syncframe_size;
+    const size_t clear_bytes =
+        std::min(syncframe_size, kLeadingClearBytesSize);
+    subsamples_.emplace_back(static_cast<uint16_t>(clear_bytes),
+                             static_cast<uint32_t>(syncframe_size -
+                                                   clear_bytes));
   }
-  return true;
+  return cryptor_->CryptSubsamples(text, text_size, subsamples_, crypt_text);
 }
 
 void SampleAesEc3Cryptor::SetIvInternal() {
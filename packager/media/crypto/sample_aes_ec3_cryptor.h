@@ -39,6 +39,8 @@ class SampleAesEc3Cryptor : public AesCryptor {
   void SetIvInternal() override;
 
   std::unique_ptr<AesCryptor> cryptor_;
+  // The syncframes of the current sample. Kept to reuse its allocation.
+  std::vector<SubsampleEntry> subsamples_;
 };
 
 }  // namespace media
@@ -10,9 +10,12 @@
 #include <limits>
 
 #include <absl/log/check.h>
+#include <absl/synchronization/mutex.h>
 
 #include <packager/macros/compiler.h>
+#include <packager/macros/status.h>
 #include <packager/media/base/decrypt_config.h>
+#include <packager/media/base/media_sample.h>
 #include <packager/media/base/video_stream_info.h>
 #include <packager/media/codecs/av1_parser.h>
 #include <packager/media/codecs/video_slice_header_parser.h>
@@ -118,8 +121,66 @@ class SubsampleOrganizer {
   size_t accumulated_clear_bytes_ = 0;
 };
 
+void OrganizeSubsamples(const SubsampleLayout& layout,
+                        bool align_protected_data,
+                        std::vector<SubsampleEntry>* subsamples) {
+  subsamples->clear();
+  SubsampleOrganizer subsample_organizer(align_protected_data, subsamples);
+  for (const SubsampleRange& range : layout)
+    subsample_organizer.AddSubsample(range.clear_bytes, range.cipher_bytes);
+}
+
 }  // namespace
 
+// Parses the subsample layouts of the frames of a stream for all its
+// generators, and caches them in the samples. The frames must be parsed in
+// stream order as the parsers are stateful: the generators process the same
+// samples in the same order, so the first generator to reach a sample has
+// already parsed, or found parsed, the samples before it. A generator which
+// starts later, e.g. of a late subscriber to a shared input, starts at a key
+// frame. Shared through the codec contexts of the stream info, hence the const
+// methods.
+class SharedSubsampleParser {
+ public:
+  SharedSubsampleParser() : generator_(new SubsampleGenerator(true)) {}
+
+  Status Initialize(const StreamInfo& stream_info) const {
+    absl::MutexLock lock(&mutex_);
+    if (!initialized_) {
+      // The protection scheme only matters to adjust the layouts, except for
+      // SAMPLE-AES, whose layouts are not shared.
+      RETURN_IF_ERROR(generator_->InitializeParsers(FOURCC_cenc, stream_info));
+      initialized_ = true;
+    }
+    return Status::OK;
+  }
+
+  Status GetSubsampleLayout(
+      const MediaSample& sample,
+      std::shared_ptr<const SubsampleLayout>* layout) const {
+    *layout = sample.subsample_layout();
+    if (*layout)
+      return Status::OK;
+
+    absl::MutexLock lock(&mutex_);
+    // The sample may have been parsed while waiting for the lock.
+    *layout = sample.subsample_layout();
+    if (*layout)
+      return Status::OK;
+    std::shared_ptr<SubsampleLayout> new_layout(new SubsampleLayout);
+    RETURN_IF_ERROR(generator_->ParseFrame(sample.data(), sample.data_size(),
+                                           new_layout.get()));
+    sample.set_subsample_layout(new_layout);
+    *layout = std::move(new_layout);
+    return Status::OK;
+  }
+
+ private:
+  mutable absl::Mutex mutex_;
+  mutable bool initialized_ ABSL_GUARDED_BY(mutex_) = false;
+  const std::unique_ptr<SubsampleGenerator> generator_;
+};
+
 SubsampleGenerator::SubsampleGenerator(bool vp9_subsample_encryption)
     : vp9_subsample_encryption_(vp9_subsample_encryption) {}
 
@@ -127,6 +188,24 @@ SubsampleGenerator::~SubsampleGenerator() {}
 
 Status SubsampleGenerator::Initialize(FourCC protection_scheme,
                                       const StreamInfo& stream_info) {
+  RETURN_IF_ERROR(InitializeParsers(protection_scheme, stream_info));
+
+  // The layouts of the frames do not depend on the protection scheme, except
+  // for SAMPLE-AES, so they are parsed once for all the generators of the
+  // stream, e.g. of the outputs with different DRM labels or schemes.
+  shared_parser_.reset();
+  if (leading_clear_bytes_size_ == 0 &&
+      (header_parser_ || vpx_parser_ || av1_parser_)) {
+    shared_parser_ = stream_info.GetCodecContext<SharedSubsampleParser>(
+        []() { return std::unique_ptr<SharedSubsampleParser>(
+                   new SharedSubsampleParser); });
+    RETURN_IF_ERROR(shared_parser_->Initialize(stream_info));
+  }
+  return Status::OK;
+}
+
+Status SubsampleGenerator::InitializeParsers(FourCC protection_scheme,
+                                             const StreamInfo& stream_info) {
   codec_ = stream_info.codec();
   nalu_length_size_ = GetNaluLengthSize(stream_info);
 
@@ -171,10 +250,20 @@ Status SubsampleGenerator::Initialize(FourCC protection_scheme,
   }
   if (header_parser_) {
     CHECK_NE(nalu_length_size_, 0u) << "AnnexB stream is not supported yet";
-    if (!header_parser_->Initialize(stream_info.codec_config())) {
+    // The parameter sets are parsed once per stream and copied to the parser
+    // of each output.
+    std::shared_ptr<const VideoSliceHeaderParser> initialized_parser =
+        stream_info.GetCodecContext<VideoSliceHeaderParser>(
+            [this, &stream_info]() -> std::unique_ptr<VideoSliceHeaderParser> {
+              if (!header_parser_->Initialize(stream_info.codec_config()))
+                return nullptr;
+              return std::move(header_parser_);
+            });
+    if (!initialized_parser) {
       return Status(error::ENCRYPTION_FAILURE,
                     "Failed to read SPS and PPS data.");
     }
+    header_parser_ = initialized_parser->Clone();
   }
 
   align_protected_data_ = ShouldAlignProtectedData(codec_, protection_scheme,
@@ -214,30 +303,48 @@ Status SubsampleGenerator::GenerateSubsamples(
     const uint8_t* frame,
     size_t frame_size,
     std::vector<SubsampleEntry>* subsamples) {
-  subsamples->clear();
+  SubsampleLayout layout;
+  RETURN_IF_ERROR(ParseFrame(frame, frame_size, &layout));
+  OrganizeSubsamples(layout, align_protected_data_, subsamples);
+  return Status::OK;
+}
+
+Status SubsampleGenerator::GenerateSubsamples(
+    const MediaSample& sample,
+    std::vector<SubsampleEntry>* subsamples) {
+  if (!shared_parser_)
+    return GenerateSubsamples(sample.data(), sample.data_size(), subsamples);
+
+  std::shared_ptr<const SubsampleLayout> layout;
+  RETURN_IF_ERROR(shared_parser_->GetSubsampleLayout(sample, &layout));
+  OrganizeSubsamples(*layout, align_protected_data_, subsamples);
+  return Status::OK;
+}
+
+Status SubsampleGenerator::ParseFrame(const uint8_t* frame,
+                                      size_t frame_size,
+                                      SubsampleLayout* layout) {
   switch (codec_) {
     case kCodecAV1:
-      return GenerateSubsamplesFromAV1Frame(frame, frame_size, subsamples);
+      return ParseAV1Frame(frame, frame_size, layout);
     case kCodecH264:
       FALLTHROUGH_INTENDED;
     case kCodecH265:
     case kCodecH265DolbyVision:
-      return GenerateSubsamplesFromH26xFrame(frame, frame_size, subsamples);
+      return ParseH26xFrame(frame, frame_size, layout);
     case kCodecVP9:
       if (vp9_subsample_encryption_)
-        return GenerateSubsamplesFromVPxFrame(frame, frame_size, subsamples);
+        return ParseVPxFrame(frame, frame_size, layout);
       // Full sample encrypted so no subsamples.
       break;
     default:
       // Other codecs are full sample encrypted unless there are clear leading
       // bytes.
       if (leading_clear_bytes_size_ > 0) {
-        SubsampleOrganizer subsample_organizer(align_protected_data_,
-                                               subsamples);
         const size_t clear_bytes =
             std::min(frame_size, leading_clear_bytes_size_);
         const size_t cipher_bytes = frame_size - clear_bytes;
-        subsample_organizer.AddSubsample(clear_bytes, cipher_bytes);
+        layout->push_back({clear_bytes, cipher_bytes});
       } else {
         // Full sample encrypted so no subsamples.
       }
@@ -261,22 +368,19 @@ void SubsampleGenerator::InjectAV1ParserForTesting(
   av1_parser_ = std::move(av1_parser);
 }
 
-Status SubsampleGenerator::GenerateSubsamplesFromVPxFrame(
-    const uint8_t* frame,
-    size_t frame_size,
-    std::vector<SubsampleEntry>* subsamples) {
+Status SubsampleGenerator::ParseVPxFrame(const uint8_t* frame,
+                                         size_t frame_size,
+                                         SubsampleLayout* layout) {
   DCHECK(vpx_parser_);
   std::vector<VPxFrameInfo> vpx_frames;
   if (!vpx_parser_->Parse(frame, frame_size, &vpx_frames))
     return Status(error::ENCRYPTION_FAILURE, "Failed to parse vpx frame.");
 
-  SubsampleOrganizer subsample_organizer(align_protected_data_, subsamples);
-
   size_t total_size = 0;
   for (const VPxFrameInfo& vpx_frame : vpx_frames) {
-    subsample_organizer.AddSubsample(
-        vpx_frame.uncompressed_header_size,
-        vpx_frame.frame_size - vpx_frame.uncompressed_header_size);
+    layout->push_back(
+        {vpx_frame.uncompressed_header_size,
+         vpx_frame.frame_size - vpx_frame.uncompressed_header_size});
     total_size += vpx_frame.frame_size;
   }
   // Add subsample for the superframe index if exists.
@@ -285,22 +389,19 @@ Status SubsampleGenerator::GenerateSubsamplesFromVPxFrame(
     const size_t index_size = frame_size - total_size;
     DCHECK_LE(index_size, 2 + vpx_frames.size() * 4);
     DCHECK_GE(index_size, 2 + vpx_frames.size() * 1);
-    subsample_organizer.AddSubsample(index_size, 0);
+    layout->push_back({index_size, 0});
   } else {
     DCHECK_EQ(total_size, frame_size);
   }
   return Status::OK;
 }
 
-Status SubsampleGenerator::GenerateSubsamplesFromH26xFrame(
-    const uint8_t* frame,
-    size_t frame_size,
-    std::vector<SubsampleEntry>* subsamples) {
+Status SubsampleGenerator::ParseH26xFrame(const uint8_t* frame,
+                                          size_t frame_size,
+                                          SubsampleLayout* layout) {
   DCHECK_NE(nalu_length_size_, 0u);
   DCHECK(header_parser_);
 
-  SubsampleOrganizer subsample_organizer(align_protected_data_, subsamples);
-
   const Nalu::CodecType nalu_type =
       (codec_ == kCodecH265 || codec_ == kCodecH265DolbyVision) ? Nalu::kH265
                                                                 : Nalu::kH264;
@@ -337,8 +438,7 @@ Status SubsampleGenerator::GenerateSubsamplesFromH26xFrame(
       clear_bytes = nalu_total_size;
     }
     const size_t cipher_bytes = nalu_total_size - clear_bytes;
-    subsample_organizer.AddSubsample(nalu_length_size_ + clear_bytes,
-                                     cipher_bytes);
+    layout->push_back({nalu_length_size_ + clear_bytes, cipher_bytes});
   }
   if (result != NaluReader::kEOStream) {
     LOG(ERROR) << "Failed to parse NAL units.";
@@ -347,29 +447,26 @@ Status SubsampleGenerator::GenerateSubsamplesFromH26xFrame(
   return Status::OK;
 }
 
-Status SubsampleGenerator::GenerateSubsamplesFromAV1Frame(
-    const uint8_t* frame,
-    size_t frame_size,
-    std::vector<SubsampleEntry>* subsamples) {
+Status SubsampleGenerator::ParseAV1Frame(const uint8_t* frame,
+                                         size_t frame_size,
+                                         SubsampleLayout* layout) {
   DCHECK(av1_parser_);
   std::vector<AV1Parser::Tile> av1_tiles;
   if (!av1_parser_->Parse(frame, frame_size, &av1_tiles))
     return Status(error::ENCRYPTION_FAILURE, "Failed to parse AV1 frame.");
 
-  SubsampleOrganizer subsample_organizer(align_protected_data_, subsamples);
-
   size_t last_tile_end_offset = 0;
   for (const AV1Parser::Tile& tile : av1_tiles) {
     DCHECK_LE(last_tile_end_offset, tile.start_offset_in_bytes);
     // Per AV1 in ISO-BMFF spec [1], only decode_tile is encrypted.
     // [1] https://aomediacodec.github.io/av1-isobmff/#subsample-encryption
-    subsample_organizer.AddSubsample(
-        tile.start_offset_in_bytes - last_tile_end_offset, tile.size_in_bytes);
+    layout->push_back({tile.start_offset_in_bytes - last_tile_end_offset,
+                       tile.size_in_bytes});
     last_tile_end_offset = tile.start_offset_in_bytes + tile.size_in_bytes;
   }
   DCHECK_LE(last_tile_end_offset, frame_size);
   if (last_tile_end_offset < frame_size)
-    subsample_organizer.AddSubsample(frame_size - last_tile_end_offset, 0);
+    layout->push_back({frame_size - last_tile_end_offset, 0});
   return Status::OK;
 }
 
@@ -18,9 +18,12 @@ namespace shaka {
 namespace media {
 
 class AV1Parser;
+class MediaSample;
+class SharedSubsampleParser;
 class VideoSliceHeaderParser;
 class VPxParser;
 struct SubsampleEntry;
+struct SubsampleRange;
 
 /// Parsing and generating encryption subsamples from bitstreams. Note that the
 /// class can be used to generate subsamples from both audio and video
@@ -60,6 +63,15 @@ class SubsampleGenerator {
                                     size_t frame_size,
                                     std::vector<SubsampleEntry>* subsamples);
 
+  /// Same as above, but reuses the layout of the frame attached to @a sample
+  /// if another generator of the same stream has parsed it already, or
+  /// attaches it otherwise.
+  /// @param sample is the sample with the frame.
+  /// @param[out] subsamples will contain the output subsamples on success.
+  /// @returns OK on success, an error status otherwise.
+  Status GenerateSubsamples(const MediaSample& sample,
+                            std::vector<SubsampleEntry>* subsamples);
+
   // Testing injections.
   void InjectVpxParserForTesting(std::unique_ptr<VPxParser> vpx_parser);
   void InjectVideoSliceHeaderParserForTesting(
@@ -70,18 +82,25 @@ class SubsampleGenerator {
   SubsampleGenerator(const SubsampleGenerator&) = delete;
   SubsampleGenerator& operator=(const SubsampleGenerator&) = delete;
 
-  Status GenerateSubsamplesFromVPxFrame(
-      const uint8_t* frame,
-      size_t frame_size,
-      std::vector<SubsampleEntry>* subsamples);
-  Status GenerateSubsamplesFromH26xFrame(
-      const uint8_t* frame,
-      size_t frame_size,
-      std::vector<SubsampleEntry>* subsamples);
-  Status GenerateSubsamplesFromAV1Frame(
-      const uint8_t* frame,
-      size_t frame_size,
-      std::vector<SubsampleEntry>* subsamples);
+  friend class SharedSubsampleParser;
+
+  // Initializes the codec parsers, without sharing them.
+  Status InitializeParsers(FourCC protection_scheme,
+                           const StreamInfo& stream_info);
+  // Parses the subsample ranges of a frame, before they are organized into
+  // subsamples.
+  Status ParseFrame(const uint8_t* frame,
+                    size_t frame_size,
+                    std::vector<SubsampleRange>* layout);
+  Status ParseVPxFrame(const uint8_t* frame,
+                       size_t frame_size,
+                       std::vector<SubsampleRange>* layout);
+  Status ParseH26xFrame(const uint8_t* frame,
+                        size_t frame_size,
+                        std::vector<SubsampleRange>* layout);
+  Status ParseAV1Frame(const uint8_t* frame,
+                       size_t frame_size,
+                       std::vector<SubsampleRange>* layout);
 
   const bool vp9_subsample_encryption_ = false;
   // Whether the protected portion should be AES block (16 bytes) aligned.
@@ -103,6 +122,9 @@ class SubsampleGenerator {
   std::unique_ptr<VideoSliceHeaderParser> header_parser_;
   // AV1 parser for AV1 streams.
   std::unique_ptr<AV1Parser> av1_parser_;
+  // Parses the frames for all the generators of the stream, if their layouts
+  // do not depend on the protection scheme.
+  std::shared_ptr<const SharedSubsampleParser> shared_parser_;
 };
 
 }  // namespace media
@@ -10,6 +10,8 @@
 #include <gtest/gtest.h>
 
 #include <packager/media/base/audio_stream_info.h>
+#include <packager/media/base/decrypt_config.h>
+#include <packager/media/base/media_sample.h>
 #include <packager/media/base/video_stream_info.h>
 #include <packager/media/codecs/av1_parser.h>
 #include <packager/media/codecs/video_slice_header_parser.h>
@@ -130,6 +132,7 @@ class MockVideoSliceHeaderParser : public VideoSliceHeaderParser {
                bool(const std::vector<uint8_t>& decoder_configuration));
   MOCK_METHOD1(ProcessNalu, bool(const Nalu& nalu));
   MOCK_METHOD1(GetHeaderSize, int64_t(const Nalu& nalu));
+  MOCK_CONST_METHOD0(Clone, std::unique_ptr<VideoSliceHeaderParser>());
 };
 
 class MockAV1Parser : public AV1Parser {
@@ -448,6 +451,40 @@ TEST_P(SubsampleGeneratorTest, AACIsFullSampleEncrypted) {
   EXPECT_THAT(subsamples, ElementsAre());
 }
 
+TEST_P(SubsampleGeneratorTest, H264LayoutSharedBetweenGenerators) {
+  // Copies of a stream info, e.g. replicated to several handlers, share the
+  // slice header parser.
+  const VideoStreamInfo stream_info = GetVideoStreamInfo(kCodecH264);
+  const VideoStreamInfo stream_info_copy = stream_info;
+  SubsampleGenerator generator(kVP9SubsampleEncryption);
+  ASSERT_OK(generator.Initialize(protection_scheme_, stream_info));
+  SubsampleGenerator other_generator(kVP9SubsampleEncryption);
+  ASSERT_OK(other_generator.Initialize(FOURCC_cbcs, stream_info_copy));
+
+  // A single non-video-slice NALU (nalu_size = 4).
+  const uint8_t kFrame[] = {0x04, 0x06, 0x01, 0x02, 0x03};
+  std::shared_ptr<MediaSample> sample =
+      MediaSample::CopyFrom(kFrame, sizeof(kFrame), true);
+
+  std::vector<SubsampleEntry> subsamples;
+  ASSERT_OK(generator.GenerateSubsamples(*sample, &subsamples));
+  EXPECT_THAT(subsamples, ElementsAre(SubsampleEntry(sizeof(kFrame), 0)));
+  std::shared_ptr<const SubsampleLayout> layout = sample->subsample_layout();
+  ASSERT_TRUE(layout);
+
+  ASSERT_OK(other_generator.GenerateSubsamples(*sample, &subsamples));
+  EXPECT_THAT(subsamples, ElementsAre(SubsampleEntry(sizeof(kFrame), 0)));
+  EXPECT_EQ(layout, sample->subsample_layout());
+
+  // The layout attached to a sample is not parsed again.
+  const uint8_t kUnparsedFrame[42] = {};
+  sample = MediaSample::CopyFrom(kUnparsedFrame, sizeof(kUnparsedFrame), true);
+  sample->set_subsample_layout(std::make_shared<const SubsampleLayout>(
+      SubsampleLayout{{10, 32}}));
+  ASSERT_OK(other_generator.GenerateSubsamples(*sample, &subsamples));
+  EXPECT_THAT(subsamples, ElementsAre(SubsampleEntry(10, 32)));
+}
+
 INSTANTIATE_TEST_CASE_P(
     CencProtectionSchemes,
     SubsampleGeneratorTest,
@@ -0,0 +1,379 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/demuxer/demux_hub.h>
+
+#include <algorithm>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+
+#include <packager/macros/status.h>
+#include <packager/media/base/media_sample.h>
+#include <packager/media/demuxer/demuxer.h>
+
+namespace shaka {
+namespace media {
+
+// The stream data waiting to be dispatched by a subscriber. Guarded by the
+// mutex of the source.
+struct DemuxHubSubscriber::Queue {
+  struct Entry {
+    size_t output_index = 0;
+    // Null marks the end of the stream.
+    std::unique_ptr<StreamData> stream_data;
+  };
+
+  explicit Queue(size_t capacity) : capacity(capacity) {}
+
+  const size_t capacity;
+  std::deque<Entry> entries;
+  // Set once the subscriber stops reading.
+  bool detached = false;
+  bool cancelled = false;
+};
+
+// An input shared by subscribers. Owns the demuxer of the input and the
+// thread running it.
+class DemuxHubSubscriber::Source {
+ public:
+  explicit Source(std::shared_ptr<Demuxer> demuxer);
+  ~Source();
+
+  Status Subscribe(const std::string& stream_selector,
+                   std::shared_ptr<Queue> queue,
+                   size_t output_index);
+  // Stops delivering stream data to |queue|.
+  void Detach(Queue* queue);
+  // Wakes up the subscriber of |queue| waiting in Pop().
+  void Cancel(Queue* queue);
+
+  // Starts the demuxer, unless it has started already.
+  void Start();
+  // Waits for the next entry of |queue|.
+  Status Pop(Queue* queue, Queue::Entry* entry);
+
+  bool finished();
+
+ private:
+  struct Subscription {
+    std::shared_ptr<Queue> queue;
+    size_t output_index = 0;
+    // Set for the subscribers which attach while the stream is demuxed, until
+    // they get a sample they can start from.
+    bool waiting_for_key_frame = false;
+  };
+  struct Stream {
+    std::vector<std::shared_ptr<Subscription>> subscriptions;
+    // The last stream info, for the subscribers which attach late.
+    std::unique_ptr<StreamData> stream_info;
+    bool ended = false;
+  };
+  class FanOut;
+
+  // Called on the demuxer thread, through the FanOut of |stream|.
+  Status Distribute(Stream* stream, std::unique_ptr<StreamData> stream_data);
+  void EndStream(Stream* stream);
+
+  void RunDemuxer();
+
+  const std::shared_ptr<Demuxer> demuxer_;
+
+  absl::Mutex mutex_;
+  // Signaled whenever a queue changes or the source stops.
+  absl::CondVar changed_ ABSL_GUARDED_BY(mutex_);
+  // Keyed by stream selector.
+  std::map<std::string, Stream> streams_ ABSL_GUARDED_BY(mutex_);
+  bool started_ ABSL_GUARDED_BY(mutex_) = false;
+  bool finished_ ABSL_GUARDED_BY(mutex_) = false;
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+  // The status returned by the demuxer.
+  Status status_ ABSL_GUARDED_BY(mutex_);
+
+  std::unique_ptr<std::thread> thread_;
+};
+
+// The handler of a stream of the demuxer. Fans the stream data out to the
+// queues of the subscribers.
+class DemuxHubSubscriber::Source::FanOut : public MediaHandler {
+ public:
+  FanOut(Source* source, Stream* stream) : source_(source), stream_(stream) {}
+
+ protected:
+  Status InitializeInternal() override { return Status::OK; }
+
+  Status Process(std::unique_ptr<StreamData> stream_data) override {
+    return source_->Distribute(stream_, std::move(stream_data));
+  }
+
+  Status OnFlushRequest(size_t /*input_stream_index*/) override {
+    source_->EndStream(stream_);
+    return Status::OK;
+  }
+
+ private:
+  Source* const source_;
+  Stream* const stream_;
+};
+
+DemuxHubSubscriber::Source::Source(std::shared_ptr<Demuxer> demuxer)
+    : demuxer_(std::move(demuxer)) {
+  DCHECK(demuxer_);
+}
+
+DemuxHubSubscriber::Source::~Source() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopped_ = true;
+    changed_.SignalAll();
+  }
+  demuxer_->Cancel();
+  if (thread_)
+    thread_->join();
+}
+
+Status DemuxHubSubscriber::Source::Subscribe(
+    const std::string& stream_selector,
+    std::shared_ptr<Queue> queue,
+    size_t output_index) {
+  absl::MutexLock lock(&mutex_);
+  auto it = streams_.find(stream_selector);
+  if (it == streams_.end()) {
+    if (started_) {
+      return Status(error::INVALID_ARGUMENT,
+                    "Cannot subscribe to stream " + stream_selector +
+                        " of an input which is being demuxed.");
+    }
+    it = streams_.emplace(stream_selector, Stream()).first;
+    Status status = demuxer_->SetHandler(
+        stream_selector, std::make_shared<FanOut>(this, &it->second));
+    if (!status.ok()) {
+      streams_.erase(it);
+      return status;
+    }
+  }
+
+  Stream& stream = it->second;
+  std::shared_ptr<Subscription> subscription(new Subscription);
+  subscription->queue = queue;
+  subscription->output_index = output_index;
+  if (stream.stream_info) {
+    queue->entries.push_back(
+        {output_index, std::unique_ptr<StreamData>(
+                           new StreamData(*stream.stream_info))});
+    subscription->waiting_for_key_frame = true;
+  }
+  if (stream.ended)
+    queue->entries.push_back({output_index, nullptr});
+  stream.subscriptions.push_back(std::move(subscription));
+  return Status::OK;
+}
+
+void DemuxHubSubscriber::Source::Detach(Queue* queue) {
+  absl::MutexLock lock(&mutex_);
+  if (queue->detached)
+    return;
+  queue->detached = true;
+  queue->entries.clear();
+  for (auto& pair : streams_) {
+    auto& subscriptions = pair.second.subscriptions;
+    subscriptions.erase(
+        std::remove_if(subscriptions.begin(), subscriptions.end(),
+                       [queue](const std::shared_ptr<Subscription>& entry) {
+                         return entry->queue.get() == queue;
+                       }),
+        subscriptions.end());
+  }
+  changed_.SignalAll();
+}
+
+void DemuxHubSubscriber::Source::Cancel(Queue* queue) {
+  absl::MutexLock lock(&mutex_);
+  queue->cancelled = true;
+  changed_.SignalAll();
+}
+
+void DemuxHubSubscriber::Source::Start() {
+  absl::MutexLock lock(&mutex_);
+  if (started_)
+    return;
+  started_ = true;
+  thread_.reset(new std::thread(&Source::RunDemuxer, this));
+}
+
+Status DemuxHubSubscriber::Source::Pop(Queue* queue, Queue::Entry* entry) {
+  absl::MutexLock lock(&mutex_);
+  while (queue->entries.empty() && !queue->cancelled && !finished_ &&
+         !stopped_) {
+    changed_.Wait(&mutex_);
+  }
+  if (queue->cancelled)
+    return Status(error::CANCELLED, "DemuxHub subscriber cancelled.");
+  if (queue->entries.empty()) {
+    if (!status_.ok())
+      return status_;
+    return Status(error::INTERNAL_ERROR,
+                  "The demuxer stopped before the end of the streams.");
+  }
+  *entry = std::move(queue->entries.front());
+  queue->entries.pop_front();
+  changed_.SignalAll();
+  return Status::OK;
+}
+
+bool DemuxHubSubscriber::Source::finished() {
+  absl::MutexLock lock(&mutex_);
+  return finished_;
+}
+
+Status DemuxHubSubscriber::Source::Distribute(
+    Stream* stream,
+    std::unique_ptr<StreamData> stream_data) {
+  absl::MutexLock lock(&mutex_);
+  if (stream_data->stream_data_type == StreamDataType::kStreamInfo)
+    stream->stream_info.reset(new StreamData(*stream_data));
+  // The subscribers which attach late start from a key frame.
+  const bool can_start =
+      stream_data->stream_data_type == StreamDataType::kTextSample ||
+      (stream_data->stream_data_type == StreamDataType::kMediaSample &&
+       stream_data->media_sample->is_key_frame());
+
+  // Subscriptions may come and go while waiting for room in a queue.
+  const std::vector<std::shared_ptr<Subscription>> subscriptions =
+      stream->subscriptions;
+  for (const auto& subscription : subscriptions) {
+    if (subscription->waiting_for_key_frame) {
+      if (!can_start)
+        continue;
+      subscription->waiting_for_key_frame = false;
+    }
+    Queue* queue = subscription->queue.get();
+    while (queue->entries.size() >= queue->capacity && !queue->detached &&
+           !stopped_) {
+      changed_.Wait(&mutex_);
+    }
+    if (stopped_)
+      return Status(error::CANCELLED, "DemuxHub source stopped.");
+    if (queue->detached)
+      continue;
+    queue->entries.push_back(
+        {subscription->output_index,
+         std::unique_ptr<StreamData>(new StreamData(*stream_data))});
+    changed_.SignalAll();
+  }
+  return Status::OK;
+}
+
+void DemuxHubSubscriber::Source::EndStream(Stream* stream) {
+  absl::MutexLock lock(&mutex_);
+  stream->ended = true;
+  // The end of a stream is not subject to the queue capacity, so that it can
+  // always be delivered.
+  for (const auto& subscription : stream->subscriptions) {
+    subscription->queue->entries.push_back(
+        {subscription->output_index, nullptr});
+  }
+  changed_.SignalAll();
+}
+
+void DemuxHubSubscriber::Source::RunDemuxer() {
+  Status status = demuxer_->Initialize();
+  if (status.ok())
+    status = demuxer_->Run();
+  if (!status.ok())
+    LOG(ERROR) << "Shared demuxer failed: " << status;
+
+  absl::MutexLock lock(&mutex_);
+  status_ = status;
+  finished_ = true;
+  changed_.SignalAll();
+}
+
+DemuxHubSubscriber::DemuxHubSubscriber(std::shared_ptr<Source> source,
+                                       std::shared_ptr<Queue> queue)
+    : source_(std::move(source)), queue_(std::move(queue)) {}
+
+DemuxHubSubscriber::~DemuxHubSubscriber() {
+  source_->Detach(queue_.get());
+}
+
+Status DemuxHubSubscriber::SetHandler(const std::string& stream_selector,
+                                      std::shared_ptr<MediaHandler> handler) {
+  const size_t output_index = next_output_stream_index();
+  RETURN_IF_ERROR(source_->Subscribe(stream_selector, queue_, output_index));
+  return MediaHandler::SetHandler(output_index, std::move(handler));
+}
+
+Status DemuxHubSubscriber::Run() {
+  if (output_handlers().empty())
+    return Status::OK;
+
+  source_->Start();
+  Status status;
+  size_t num_streams_ended = 0;
+  while (num_streams_ended < output_handlers().size()) {
+    Queue::Entry entry;
+    status = source_->Pop(queue_.get(), &entry);
+    if (!status.ok())
+      break;
+    if (entry.stream_data) {
+      entry.stream_data->stream_index = entry.output_index;
+      status = Dispatch(std::move(entry.stream_data));
+    } else {
+      status = FlushDownstream(entry.output_index);
+      ++num_streams_ended;
+    }
+    if (!status.ok())
+      break;
+  }
+  // The demuxer must not wait on a subscriber which stopped reading.
+  source_->Detach(queue_.get());
+  return status;
+}
+
+void DemuxHubSubscriber::Cancel() {
+  source_->Cancel(queue_.get());
+}
+
+DemuxHub* DemuxHub::GetInstance() {
+  static DemuxHub* const instance = new DemuxHub;
+  return instance;
+}
+
+Status DemuxHub::Subscribe(const std::string& input,
+                           const DemuxerFactory& create_demuxer,
+                           size_t queue_capacity,
+                           std::shared_ptr<DemuxHubSubscriber>* subscriber) {
+  DCHECK_GT(queue_capacity, 0u);
+  DCHECK(subscriber);
+
+  absl::MutexLock lock(&mutex_);
+  for (auto it = sources_.begin(); it != sources_.end();) {
+    if (it->second.expired())
+      it = sources_.erase(it);
+    else
+      ++it;
+  }
+
+  std::shared_ptr<DemuxHubSubscriber::Source> source = sources_[input].lock();
+  // A source which has finished is not restarted, the input is demuxed anew.
+  if (!source || source->finished()) {
+    std::shared_ptr<Demuxer> demuxer;
+    RETURN_IF_ERROR(create_demuxer(&demuxer));
+    source = std::make_shared<DemuxHubSubscriber::Source>(std::move(demuxer));
+    sources_[input] = source;
+  }
+  subscriber->reset(new DemuxHubSubscriber(
+      std::move(source),
+      std::make_shared<DemuxHubSubscriber::Queue>(queue_capacity)));
+  return Status::OK;
+}
+
+}  // namespace media
+}  // namespace shaka
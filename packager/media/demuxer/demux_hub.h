@@ -0,0 +1,104 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_DEMUXER_DEMUX_HUB_H_
+#define PACKAGER_MEDIA_DEMUXER_DEMUX_HUB_H_
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+#include <absl/synchronization/mutex.h>
+
+#include <packager/media/origin/origin_handler.h>
+#include <packager/status.h>
+
+namespace shaka {
+namespace media {
+
+class Demuxer;
+
+/// Receives the streams of an input demuxed by DemuxHub. It takes the place of
+/// a Demuxer at the origin of a packaging graph: handlers are set per stream
+/// selector, and the job manager of the graph runs it. Run() returns once all
+/// the streams it subscribed to have ended.
+class DemuxHubSubscriber : public OriginHandler {
+ public:
+  ~DemuxHubSubscriber() override;
+
+  /// Subscribes to a stream of the input and sets its handler.
+  /// @param stream_selector is "audio", "video", "text" or a stream index, as
+  ///        for Demuxer::SetHandler().
+  /// @return OK on success. Fails if the demuxer of the input has started and
+  ///         no other subscriber reads @a stream_selector.
+  Status SetHandler(const std::string& stream_selector,
+                    std::shared_ptr<MediaHandler> handler);
+
+  /// @name OriginHandler implementation overrides.
+  /// @{
+  Status Run() override;
+  void Cancel() override;
+  /// @}
+
+ private:
+  friend class DemuxHub;
+  class Source;
+  struct Queue;
+
+  DemuxHubSubscriber(std::shared_ptr<Source> source,
+                     std::shared_ptr<Queue> queue);
+
+  Status InitializeInternal() override { return Status::OK; }
+
+  std::shared_ptr<Source> source_;
+  std::shared_ptr<Queue> queue_;
+};
+
+/// Shares the demuxing of an input among the packaging graphs of the process,
+/// e.g. of Packager instances making different outputs from the same live
+/// source. Inputs are keyed by their URL: the first subscription to an input
+/// creates its demuxer, which runs on a thread of the hub once the first
+/// subscriber runs. The stream data of each stream is fanned out to its
+/// subscribers, each with its own bounded queue. The demuxer waits on a full
+/// queue, so the slowest subscriber paces the input.
+///
+/// A subscriber which attaches once the demuxer has started receives the
+/// last stream info of its streams, then the samples from the next key frame.
+/// The demuxer is cancelled when all its subscribers are destroyed.
+class DemuxHub {
+ public:
+  using DemuxerFactory = std::function<Status(std::shared_ptr<Demuxer>*)>;
+
+  static DemuxHub* GetInstance();
+
+  /// Creates a subscriber to @a input.
+  /// @param create_demuxer creates the demuxer of @a input if it is not being
+  ///        demuxed yet. Its settings, e.g. the key source, then apply to all
+  ///        the subscribers.
+  /// @param queue_capacity is the most stream data queued for the subscriber.
+  ///        Must be positive.
+  Status Subscribe(const std::string& input,
+                   const DemuxerFactory& create_demuxer,
+                   size_t queue_capacity,
+                   std::shared_ptr<DemuxHubSubscriber>* subscriber);
+
+ private:
+  DemuxHub() = default;
+  DemuxHub(const DemuxHub&) = delete;
+  DemuxHub& operator=(const DemuxHub&) = delete;
+
+  absl::Mutex mutex_;
+  // The sources are owned by their subscribers.
+  std::map<std::string, std::weak_ptr<DemuxHubSubscriber::Source>> sources_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_DEMUXER_DEMUX_HUB_H_
@@ -0,0 +1,68 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/demuxer/demux_hub.h>
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <packager/media/base/media_handler_test_base.h>
+#include <packager/media/demuxer/demuxer.h>
+#include <packager/media/test/test_data_util.h>
+#include <packager/status/status_test_util.h>
+
+namespace shaka {
+namespace media {
+
+TEST(DemuxHubTest, SubscribersShareTheDemuxer) {
+  const std::string input = GetTestDataFilePath("bear-640x360.mp4").string();
+  int demuxers_created = 0;
+  auto create_demuxer = [&](std::shared_ptr<Demuxer>* demuxer) {
+    ++demuxers_created;
+    *demuxer = std::make_shared<Demuxer>(input);
+    return Status::OK;
+  };
+  // Small queues, so that the demuxer waits on the subscribers.
+  const size_t kQueueCapacity = 2;
+
+  std::shared_ptr<DemuxHubSubscriber> subscriber1;
+  std::shared_ptr<DemuxHubSubscriber> subscriber2;
+  ASSERT_OK(DemuxHub::GetInstance()->Subscribe(input, create_demuxer,
+                                               kQueueCapacity, &subscriber1));
+  ASSERT_OK(DemuxHub::GetInstance()->Subscribe(input, create_demuxer,
+                                               kQueueCapacity, &subscriber2));
+  EXPECT_EQ(1, demuxers_created);
+
+  auto handler1 = std::make_shared<CachingMediaHandler>();
+  auto handler2 = std::make_shared<CachingMediaHandler>();
+  ASSERT_OK(subscriber1->SetHandler("video", handler1));
+  ASSERT_OK(subscriber2->SetHandler("video", handler2));
+  ASSERT_OK(subscriber1->Initialize());
+  ASSERT_OK(subscriber2->Initialize());
+
+  Status status2;
+  std::thread thread([&]() { status2 = subscriber2->Run(); });
+  EXPECT_OK(subscriber1->Run());
+  thread.join();
+  EXPECT_OK(status2);
+
+  ASSERT_GT(handler1->Cache().size(), 1u);
+  EXPECT_EQ(handler1->Cache().size(), handler2->Cache().size());
+  EXPECT_EQ(StreamDataType::kStreamInfo,
+            handler1->Cache()[0]->stream_data_type);
+  EXPECT_EQ(StreamDataType::kStreamInfo,
+            handler2->Cache()[0]->stream_data_type);
+
+  // The input is demuxed anew once its demuxer has finished.
+  std::shared_ptr<DemuxHubSubscriber> subscriber3;
+  ASSERT_OK(DemuxHub::GetInstance()->Subscribe(input, create_demuxer,
+                                               kQueueCapacity, &subscriber3));
+  EXPECT_EQ(2, demuxers_created);
+}
+
+}  // namespace media
+}  // namespace shaka
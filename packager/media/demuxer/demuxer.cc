@@ -7,31 +7,46 @@
 #include <packager/media/demuxer/demuxer.h>
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <functional>
+#include <limits>
+#include <set>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 #include <absl/strings/escaping.h>
 #include <absl/strings/numbers.h>
 #include <absl/strings/str_format.h>
+#include <absl/synchronization/notification.h>
 
 #include <packager/file.h>
+#include <packager/file/mapped_file.h>
+#include <packager/file/thread_pool.h>
 #include <packager/macros/compiler.h>
 #include <packager/macros/logging.h>
+#include <packager/macros/status.h>
 #include <packager/media/base/decryptor_source.h>
 #include <packager/media/base/key_source.h>
 #include <packager/media/base/media_sample.h>
 #include <packager/media/base/stream_info.h>
+#include <packager/media/base/text_sample.h>
 #include <packager/media/formats/mp2t/mp2t_media_parser.h>
 #include <packager/media/formats/mp4/mp4_media_parser.h>
+#include <packager/media/formats/mp4/parallel_fragment_parser.h>
 #include <packager/media/formats/webm/webm_media_parser.h>
 #include <packager/media/formats/webvtt/webvtt_parser.h>
 #include <packager/media/formats/wvm/wvm_media_parser.h>
+#include <packager/utils/memory_budget.h>
+#include <packager/utils/resource_quota.h>
+#include <packager/utils/trace.h>
 
 namespace {
 // 65KB, sufficient to determine the container and likely all init data.
 const size_t kInitBufSize = 0x10000;
 const size_t kBufSize = 0x200000;  // 2MB
+// The minimum size of the ranges of fragments parsed in parallel.
+const uint64_t kMinParallelRangeSize = 8 << 20;  // 8MB
 // Maximum number of allowed queued samples. If we are receiving a lot of
 // samples before seeing init_event, something is not right. The number
 // set here is arbitrary though.
@@ -82,16 +97,41 @@ Demuxer::Demuxer(const std::string& file_name)
     : file_name_(file_name), buffer_(new uint8_t[kBufSize]) {}
 
 Demuxer::~Demuxer() {
-  if (media_file_)
-    media_file_->Close();
+  CloseMediaFile();
 }
 
 void Demuxer::SetKeySource(std::unique_ptr<KeySource> key_source) {
   key_source_ = std::move(key_source);
 }
 
+void Demuxer::set_progress_tracker(ProgressTracker* progress_tracker) {
+  progress_tracker_ = progress_tracker;
+  progress_ = progress_tracker->AddInput();
+}
+
+void Demuxer::SetClipRange(double start_seconds, double end_seconds) {
+  DCHECK_GE(start_seconds, 0);
+  DCHECK_LT(start_seconds, end_seconds);
+  has_clip_range_ = true;
+  clip_start_seconds_ = start_seconds;
+  clip_end_seconds_ = end_seconds;
+}
+
 Status Demuxer::Run() {
+  if (push_mode_) {
+    // The input is parsed on the ThreadPool anyway; wait for it.
+    absl::Notification done;
+    Status status;
+    StartAsync([&done, &status](const Status& result) {
+      status = result;
+      done.Notify();
+    });
+    done.WaitForNotification();
+    return status;
+  }
+
   LOG(INFO) << "Demuxer::Run() on file '" << file_name_ << "'.";
+  ScopedProcessTimer timer(this);
   Status status = InitializeParser();
   // ParserInitEvent callback is called after a few calls to Parse(), which sets
   // up the streams. Only after that, we can verify the outputs below.
@@ -105,18 +145,16 @@ Status Demuxer::Run() {
     return init_event_status_;
   if (!status.ok())
     return status;
-  // Check if all specified outputs exists.
-  for (const auto& pair : output_handlers()) {
-    if (std::find(stream_indexes_.begin(), stream_indexes_.end(), pair.first) ==
-        stream_indexes_.end()) {
-      LOG(ERROR) << "Invalid argument, stream=" << GetStreamLabel(pair.first)
-                 << " not available.";
-      return Status(error::INVALID_ARGUMENT, "Stream not available");
-    }
-  }
+  RETURN_IF_ERROR(CheckOutputStreams());
 
-  while (!cancelled_ && status.ok())
+  MaybeStartIndexedParsing();
+  while (!cancelled_ && status.ok()) {
+    MemoryBudget::Throttle();
+    ResourceQuota::Throttle();
     status.Update(Parse());
+    if (progress_tracker_)
+      progress_tracker_->MaybeReport();
+  }
   if (cancelled_ && status.ok())
     return Status(error::CANCELLED, "Demuxer run cancelled");
 
@@ -126,13 +164,199 @@ Status Demuxer::Run() {
       if (!status.ok())
         return status;
     }
+    if (progress_)
+      progress_->set_done();
     return Status::OK;
   }
   return status;
 }
 
+Status Demuxer::Probe(std::vector<std::shared_ptr<StreamInfo>>* stream_infos) {
+  DCHECK(stream_infos);
+  DCHECK(output_handlers().empty());
+  DCHECK(!push_mode_);
+
+  VLOG(1) << "Probing '" << file_name_ << "'.";
+  probing_ = true;
+  Status status = InitializeParser();
+  while (!all_streams_ready_ && status.ok())
+    status.Update(Parse());
+  if (!all_streams_ready_) {
+    if (status.ok() || status.error_code() == error::END_OF_STREAM) {
+      return Status(error::PARSER_FAILURE,
+                    "Cannot find the streams of " + file_name_);
+    }
+    return status;
+  }
+  *stream_infos = std::move(probed_stream_infos_);
+  return Status::OK;
+}
+
+bool Demuxer::StartAsync(std::function<void(const Status&)> on_complete) {
+  if (!push_mode_)
+    return false;
+  LOG(INFO) << "Demuxer::StartAsync() on input '" << file_name_ << "'.";
+  absl::MutexLock lock(&push_mutex_);
+  DCHECK(!push_started_);
+  on_complete_ = std::move(on_complete);
+  push_started_ = true;
+  MaybeSchedulePushedData();
+  return true;
+}
+
 void Demuxer::Cancel() {
   cancelled_ = true;
+  {
+    // Unblock a read of the input, e.g. waiting for the network.
+    absl::MutexLock lock(&media_file_mutex_);
+    if (media_file_)
+      media_file_->Abort();
+  }
+  if (key_source_)
+    key_source_->Cancel();
+  if (push_mode_) {
+    absl::MutexLock lock(&push_mutex_);
+    MaybeSchedulePushedData();
+  }
+}
+
+bool Demuxer::PushData(std::vector<uint8_t> data) {
+  DCHECK(push_mode_);
+  absl::MutexLock lock(&push_mutex_);
+  if (end_of_data_)
+    return false;
+  // The data is dropped once the demuxer has completed, e.g. on an error.
+  if (!data.empty() && !push_completed_) {
+    pushed_data_.push_back(std::move(data));
+    MaybeSchedulePushedData();
+  }
+  return true;
+}
+
+void Demuxer::EndOfData() {
+  DCHECK(push_mode_);
+  absl::MutexLock lock(&push_mutex_);
+  end_of_data_ = true;
+  MaybeSchedulePushedData();
+}
+
+void Demuxer::MaybeSchedulePushedData() {
+  if (!push_started_ || push_completed_ || push_parsing_posted_)
+    return;
+  if (pushed_data_.empty() && !end_of_data_ && !cancelled_)
+    return;
+  push_parsing_posted_ = true;
+  ThreadPool::instance.PostTask([this]() { ParsePushedData(); });
+}
+
+void Demuxer::ParsePushedData() {
+  while (true) {
+    std::vector<uint8_t> data;
+    bool end_of_data = false;
+    {
+      absl::MutexLock lock(&push_mutex_);
+      if (!pushed_data_.empty() && !cancelled_) {
+        data = std::move(pushed_data_.front());
+        pushed_data_.pop_front();
+      } else if (end_of_data_ || cancelled_) {
+        end_of_data = true;
+      } else {
+        push_parsing_posted_ = false;
+        return;
+      }
+    }
+
+    Status status;
+    if (cancelled_) {
+      status = Status(error::CANCELLED, "Demuxer run cancelled");
+    } else {
+      ScopedProcessTimer timer(this);
+      if (progress_)
+        progress_->AddBytes(data.size());
+      status = end_of_data ? FinishPushedData() : ParsePushedBlock(data);
+    }
+    if (progress_tracker_)
+      progress_tracker_->MaybeReport();
+    if (status.ok() && !end_of_data)
+      continue;
+
+    std::function<void(const Status&)> on_complete;
+    {
+      absl::MutexLock lock(&push_mutex_);
+      push_completed_ = true;
+      push_parsing_posted_ = false;
+      pushed_data_.clear();
+      on_complete = std::move(on_complete_);
+    }
+    // The demuxer may be destroyed as soon as |on_complete| is called.
+    on_complete(status);
+    return;
+  }
+}
+
+Status Demuxer::ParsePushedBlock(const std::vector<uint8_t>& data) {
+  if (!parser_) {
+    pushed_header_.insert(pushed_header_.end(), data.begin(), data.end());
+    // Wait for enough bytes to detect the container.
+    if (input_format_.empty() && pushed_header_.size() < kInitBufSize)
+      return Status::OK;
+    return ParsePushedHeader();
+  }
+
+  MemoryBudget::Throttle();
+  ResourceQuota::Throttle();
+  if (!parser_->Parse(data.data(), static_cast<int>(data.size()))) {
+    return Status(error::PARSER_FAILURE,
+                  "Cannot parse media file " + file_name_);
+  }
+  return CheckOutputStreams();
+}
+
+Status Demuxer::ParsePushedHeader() {
+  container_name_ =
+      input_format_.empty()
+          ? DetermineContainer(pushed_header_.data(), pushed_header_.size())
+          : DetermineContainerFromFormatName(input_format_);
+  RETURN_IF_ERROR(CreateParser(pushed_header_.data(), pushed_header_.size()));
+  std::vector<uint8_t> header;
+  header.swap(pushed_header_);
+  return ParsePushedBlock(header);
+}
+
+Status Demuxer::FinishPushedData() {
+  // The input may be too short to have detected its container yet.
+  if (!parser_)
+    RETURN_IF_ERROR(ParsePushedHeader());
+  if (!parser_->Flush())
+    return Status(error::PARSER_FAILURE, "Failed to flush.");
+  RETURN_IF_ERROR(CheckOutputStreams());
+  if (!all_streams_ready_)
+    return Status(error::END_OF_STREAM, "");
+
+  for (size_t stream_index : stream_indexes_)
+    RETURN_IF_ERROR(FlushDownstream(stream_index));
+  if (progress_)
+    progress_->set_done();
+  return Status::OK;
+}
+
+Status Demuxer::CheckOutputStreams() {
+  if (!init_event_status_.ok())
+    return init_event_status_;
+  if (!all_streams_ready_ || output_streams_checked_)
+    return Status::OK;
+  output_streams_checked_ = true;
+
+  // Check if all specified outputs exists.
+  for (const auto& pair : output_handlers()) {
+    if (std::find(stream_indexes_.begin(), stream_indexes_.end(), pair.first) ==
+        stream_indexes_.end()) {
+      LOG(ERROR) << "Invalid argument, stream=" << GetStreamLabel(pair.first)
+                 << " not available.";
+      return Status(error::INVALID_ARGUMENT, "Stream not available");
+    }
+  }
+  return Status::OK;
 }
 
 Status Demuxer::SetHandler(const std::string& stream_label,
@@ -153,25 +377,44 @@ void Demuxer::SetLanguageOverride(const std::string& stream_label,
   language_overrides_[stream_index] = language_override;
 }
 
+void Demuxer::CloseMediaFile() {
+  File* media_file = nullptr;
+  {
+    absl::MutexLock lock(&media_file_mutex_);
+    std::swap(media_file, media_file_);
+  }
+  if (media_file)
+    media_file->Close();
+}
+
 Status Demuxer::InitializeParser() {
   DCHECK(!media_file_);
   DCHECK(!all_streams_ready_);
 
   LOG(INFO) << "Initialize Demuxer for file '" << file_name_ << "'.";
 
-  media_file_ = File::Open(file_name_.c_str(), "r");
-  if (!media_file_) {
+  File* media_file = File::Open(file_name_.c_str(), "r");
+  if (!media_file) {
     return Status(error::FILE_FAILURE,
                   "Cannot open file for reading " + file_name_);
   }
+  {
+    absl::MutexLock lock(&media_file_mutex_);
+    media_file_ = media_file;
+    // Cancel() may have been called while the file was opened.
+    if (cancelled_)
+      media_file_->Abort();
+  }
+  if (progress_)
+    progress_->set_size(media_file_->Size());
 
   int64_t bytes_read = 0;
   bool eof = false;
   if (input_format_.empty()) {
     // Read enough bytes before detecting the container.
     while (static_cast<size_t>(bytes_read) < kInitBufSize) {
-      int64_t read_result =
-          media_file_->Read(buffer_.get() + bytes_read, kInitBufSize);
+      int64_t read_result = media_file_->Read(buffer_.get() + bytes_read,
+                                              kInitBufSize - bytes_read);
       if (read_result < 0)
         return Status(error::FILE_FAILURE, "Cannot read file " + file_name_);
       if (read_result == 0) {
@@ -181,18 +424,69 @@ Status Demuxer::InitializeParser() {
       bytes_read += read_result;
     }
     container_name_ = DetermineContainer(buffer_.get(), bytes_read);
+    if (progress_)
+      progress_->AddBytes(bytes_read);
   } else {
     container_name_ = DetermineContainerFromFormatName(input_format_);
   }
 
-  // Initialize media parser.
+  RETURN_IF_ERROR(CreateParser(buffer_.get(), bytes_read));
+
+  if (MaybeStartParallelParsing()) {
+    const std::vector<uint8_t>& header = parallel_parser_->header();
+    if (!parser_->Parse(header.data(), static_cast<int>(header.size()))) {
+      return Status(error::PARSER_FAILURE,
+                    "Cannot parse media file " + file_name_);
+    }
+    return Status::OK;
+  }
+
+  if (use_mmap_ && container_name_ == CONTAINER_MOV)
+    mapped_file_ = MappedFile::Open(file_name_);
+  if (mapped_file_) {
+    VLOG(1) << "Parsing memory mapped file '" << file_name_ << "'.";
+    mapped_file_->AdviseSequential();
+    // The bytes already read are parsed below; continue after them.
+    mapped_position_ = bytes_read;
+    CloseMediaFile();
+  }
+
+  // Handle trailing 'moov'.
+  if (mapped_file_) {
+    static_cast<mp4::MP4MediaParser*>(parser_.get())
+        ->LoadMoov(mapped_file_->data(), mapped_file_->size());
+  } else if (container_name_ == CONTAINER_MOV &&
+             File::IsLocalRegularFile(file_name_.c_str())) {
+    // TODO(kqyang): Investigate whether we can reuse the existing file
+    // descriptor |media_file_| instead of opening the same file again.
+    static_cast<mp4::MP4MediaParser*>(parser_.get())->LoadMoov(file_name_);
+  }
+  if (!parser_->Parse(buffer_.get(), bytes_read) || (eof && !parser_->Flush())) {
+    return Status(error::PARSER_FAILURE,
+                  "Cannot parse media file " + file_name_);
+  }
+  return Status::OK;
+}
+
+Status Demuxer::CreateParser(const uint8_t* header, size_t header_size) {
   switch (container_name_) {
-    case CONTAINER_MOV:
-      parser_.reset(new mp4::MP4MediaParser());
+    case CONTAINER_MOV: {
+      std::unique_ptr<mp4::MP4MediaParser> mp4_parser(
+          new mp4::MP4MediaParser());
+      mp4_parser->set_num_decryption_threads(num_decryption_threads_);
+      mp4_parser->set_decrypt_samples(decrypt_samples_);
+      parser_ = std::move(mp4_parser);
       break;
-    case CONTAINER_MPEG2TS:
-      parser_.reset(new mp2t::Mp2tMediaParser());
+    }
+    case CONTAINER_MPEG2TS: {
+      std::unique_ptr<mp2t::Mp2tMediaParser> mp2t_parser(
+          new mp2t::Mp2tMediaParser());
+      mp2t_parser->SetPendingStreamLimit(max_pending_bytes_,
+                                         drop_pending_streams_);
+      mp2t_parser->SetSelectedTextSubStreams(selected_text_sub_streams_);
+      parser_ = std::move(mp2t_parser);
       break;
+    }
       // Widevine classic (WVM) is derived from MPEG2PS. We do not support
       // non-WVM MPEG2PS file, thus we do not differentiate between the two.
       // Every MPEG2PS file is assumed to be WVM file. If it turns out not the
@@ -210,11 +504,11 @@ Status Demuxer::InitializeParser() {
       parser_.reset(new WebVttParser());
       break;
     case CONTAINER_UNKNOWN: {
-      const int64_t kDumpSizeLimit = 512;
+      const size_t kDumpSizeLimit = 512;
       LOG(ERROR) << "Failed to detect the container type from the buffer: "
                  << absl::BytesToHexString(absl::string_view(
-                        reinterpret_cast<const char*>(buffer_.get()),
-                        std::min(bytes_read, kDumpSizeLimit)));
+                        reinterpret_cast<const char*>(header),
+                        std::min(header_size, kDumpSizeLimit)));
       return Status(error::INVALID_ARGUMENT,
                     "Failed to detect the container type.");
     }
@@ -231,18 +525,6 @@ Status Demuxer::InitializeParser() {
       std::bind(&Demuxer::NewTextSampleEvent, this, std::placeholders::_1,
                 std::placeholders::_2),
       key_source_.get());
-
-  // Handle trailing 'moov'.
-  if (container_name_ == CONTAINER_MOV &&
-      File::IsLocalRegularFile(file_name_.c_str())) {
-    // TODO(kqyang): Investigate whether we can reuse the existing file
-    // descriptor |media_file_| instead of opening the same file again.
-    static_cast<mp4::MP4MediaParser*>(parser_.get())->LoadMoov(file_name_);
-  }
-  if (!parser_->Parse(buffer_.get(), bytes_read) || (eof && !parser_->Flush())) {
-    return Status(error::PARSER_FAILURE,
-                  "Cannot parse media file " + file_name_);
-  }
   return Status::OK;
 }
 
@@ -255,6 +537,12 @@ void Demuxer::ParserInitEvent(
       printf("Stream [%zu] %s\n", i, stream_infos[i]->ToString().c_str());
   }
 
+  if (probing_) {
+    probed_stream_infos_ = stream_infos;
+    all_streams_ready_ = true;
+    return;
+  }
+
   int base_stream_index = 0;
   bool video_handler_set =
       output_handlers().find(kBaseVideoOutputStreamIndex) !=
@@ -286,12 +574,44 @@ void Demuxer::ParserInitEvent(
         output_handlers().find(stream_index) != output_handlers().end();
     if (handler_set) {
       track_id_to_stream_index_map_[stream_info->track_id()] = stream_index;
+      if (progress_ && stream_info->time_scale() > 0) {
+        progress_time_scales_[stream_info->track_id()] =
+            stream_info->time_scale();
+        if (stream_info->duration() > 0) {
+          progress_->set_duration(
+              std::max(progress_->duration_seconds(),
+                       static_cast<double>(stream_info->duration()) /
+                           stream_info->time_scale()));
+        }
+      }
+      // The heartbeats would not respect the clip of the text streams.
+      if (text_heartbeat_interval_seconds_ > 0 && !has_clip_range_ &&
+          stream_info->time_scale() > 0) {
+        if (stream_info->stream_type() == kStreamText) {
+          TextHeartbeat& text_heartbeat =
+              text_heartbeats_[stream_info->track_id()];
+          text_heartbeat.stream_index = stream_index;
+          text_heartbeat.time_scale = stream_info->time_scale();
+        } else {
+          heartbeat_time_scales_[stream_info->track_id()] =
+              stream_info->time_scale();
+        }
+      }
       stream_indexes_.push_back(stream_index);
       auto iter = language_overrides_.find(stream_index);
       if (iter != language_overrides_.end() &&
           stream_info->stream_type() != kStreamVideo) {
         stream_info->set_language(iter->second);
       }
+      if (has_clip_range_) {
+        Clip& clip = clips_[stream_info->track_id()];
+        clip.start =
+            std::llround(clip_start_seconds_ * stream_info->time_scale());
+        clip.end = std::isinf(clip_end_seconds_)
+                       ? std::numeric_limits<int64_t>::max()
+                       : std::llround(clip_end_seconds_ *
+                                      stream_info->time_scale());
+      }
       if (stream_info->is_encrypted()) {
         init_event_status_.Update(Status(error::INVALID_ARGUMENT,
                                          "A decryption key source is not "
@@ -306,16 +626,34 @@ void Demuxer::ParserInitEvent(
     }
     ++base_stream_index;
   }
+
+  // Let the parser skip the tracks without an output.
+  std::set<uint32_t> selected_track_ids;
+  for (const auto& pair : track_id_to_stream_index_map_) {
+    if (pair.second != kInvalidStreamIndex)
+      selected_track_ids.insert(pair.first);
+  }
+  if (selected_track_ids.size() < track_id_to_stream_index_map_.size())
+    parser_->SetSelectedTracks(selected_track_ids);
   all_streams_ready_ = true;
 }
 
 bool Demuxer::NewMediaSampleEvent(uint32_t track_id,
                                   std::shared_ptr<MediaSample> sample) {
+  // Only the stream info is needed.
+  if (probing_)
+    return true;
   if (!all_streams_ready_) {
     if (queued_media_samples_.size() >= kQueuedSamplesLimit) {
       LOG(ERROR) << "Queued samples limit reached: " << kQueuedSamplesLimit;
       return false;
     }
+    queued_media_bytes_ += sample->data_size();
+    if (max_pending_bytes_ > 0 && queued_media_bytes_ > max_pending_bytes_) {
+      LOG(ERROR) << "Queued samples limit reached: " << max_pending_bytes_
+                 << " bytes";
+      return false;
+    }
     queued_media_samples_.emplace_back(track_id, sample);
     return true;
   }
@@ -330,11 +668,15 @@ bool Demuxer::NewMediaSampleEvent(uint32_t track_id,
     }
     queued_media_samples_.pop_front();
   }
+  queued_media_bytes_ = 0;
   return PushMediaSample(track_id, sample);
 }
 
 bool Demuxer::NewTextSampleEvent(uint32_t track_id,
                                  std::shared_ptr<TextSample> sample) {
+  // Only the stream info is needed.
+  if (probing_)
+    return true;
   if (!all_streams_ready_) {
     if (queued_text_samples_.size() >= kQueuedSamplesLimit) {
       LOG(ERROR) << "Queued samples limit reached: " << kQueuedSamplesLimit;
@@ -366,7 +708,16 @@ bool Demuxer::PushMediaSample(uint32_t track_id,
   }
   if (stream_index_iter->second == kInvalidStreamIndex)
     return true;
-  Status status = DispatchMediaSample(stream_index_iter->second, sample);
+  UpdateProgress(track_id, sample->pts() + sample->duration());
+  const int64_t pts = sample->pts();
+  auto clip = clips_.find(track_id);
+  Status status =
+      clip != clips_.end()
+          ? DispatchClippedSample(stream_index_iter->second, &clip->second,
+                                  std::move(sample))
+          : DispatchMediaSample(stream_index_iter->second, sample);
+  if (status.ok() && !text_heartbeats_.empty())
+    status = SendTextHeartbeats(track_id, pts);
   if (!status.ok()) {
     LOG(ERROR) << "Failed to process sample " << stream_index_iter->second
                << " " << status;
@@ -384,6 +735,22 @@ bool Demuxer::PushTextSample(uint32_t track_id,
   }
   if (stream_index_iter->second == kInvalidStreamIndex)
     return true;
+  UpdateProgress(track_id, sample->EndTime());
+  auto text_heartbeat = text_heartbeats_.find(track_id);
+  if (text_heartbeat != text_heartbeats_.end()) {
+    TextHeartbeat& text = text_heartbeat->second;
+    const double end_seconds =
+        static_cast<double>(sample->EndTime()) / text.time_scale;
+    text.end_seconds = std::max(text.end_seconds.value_or(end_seconds),
+                                end_seconds);
+  }
+  auto clip = clips_.find(track_id);
+  if (clip != clips_.end()) {
+    if (sample->start_time() >= clip->second.end)
+      clip->second.ended = true;
+    if (clip->second.ended || sample->EndTime() <= clip->second.start)
+      return true;
+  }
   Status status = DispatchTextSample(stream_index_iter->second, sample);
   if (!status.ok()) {
     LOG(ERROR) << "Failed to process sample " << stream_index_iter->second
@@ -393,12 +760,72 @@ bool Demuxer::PushTextSample(uint32_t track_id,
   return true;
 }
 
+Status Demuxer::DispatchClippedSample(size_t stream_index,
+                                      Clip* clip,
+                                      std::shared_ptr<MediaSample> sample) {
+  if (clip->ended)
+    return Status::OK;
+  if (sample->dts() >= clip->end) {
+    clip->ended = true;
+    clip->held_samples.clear();
+    return Status::OK;
+  }
+
+  if (!clip->started) {
+    if (sample->is_key_frame() && sample->pts() <= clip->start) {
+      // The samples before it are not needed to decode the clip.
+      clip->held_samples.clear();
+      clip->held_samples.push_back(std::move(sample));
+      return Status::OK;
+    }
+    if (clip->held_samples.empty()) {
+      // Cannot be decoded without the key frame before it.
+      if (!sample->is_key_frame())
+        return Status::OK;
+    } else if (sample->dts() < clip->start) {
+      clip->held_samples.push_back(std::move(sample));
+      return Status::OK;
+    }
+    clip->started = true;
+    for (std::shared_ptr<MediaSample>& held_sample : clip->held_samples)
+      RETURN_IF_ERROR(DispatchMediaSample(stream_index, held_sample));
+    clip->held_samples.clear();
+  }
+  return DispatchMediaSample(stream_index, std::move(sample));
+}
+
+bool Demuxer::AllClipsEnded() const {
+  if (clips_.empty())
+    return false;
+  for (const auto& pair : clips_) {
+    if (!pair.second.ended)
+      return false;
+  }
+  return true;
+}
+
 Status Demuxer::Parse() {
-  DCHECK(media_file_);
+  DCHECK(media_file_ || mapped_file_ || indexed_parsing_ || parallel_parser_);
   DCHECK(parser_);
   DCHECK(buffer_);
+  ScopedTraceEvent trace_event("Demuxer::Parse");
 
-  int64_t bytes_read = media_file_->Read(buffer_.get(), kBufSize);
+  if (AllClipsEnded()) {
+    // The rest of the input is after the clip.
+    if (!parser_->Flush())
+      return Status(error::PARSER_FAILURE, "Failed to flush.");
+    return Status(error::END_OF_STREAM, "");
+  }
+  if (parallel_parser_)
+    return ParseParallel();
+  if (indexed_parsing_)
+    return ParseIndexed();
+  if (mapped_file_)
+    return ParseMappedFile();
+
+  // Probing stops as soon as the streams are known, so read little at once.
+  int64_t bytes_read =
+      media_file_->Read(buffer_.get(), probing_ ? kInitBufSize : kBufSize);
   if (bytes_read == 0) {
     if (!parser_->Flush())
       return Status(error::PARSER_FAILURE, "Failed to flush.");
@@ -406,6 +833,8 @@ Status Demuxer::Parse() {
   } else if (bytes_read < 0) {
     return Status(error::FILE_FAILURE, "Cannot read file " + file_name_);
   }
+  if (progress_)
+    progress_->AddBytes(bytes_read);
 
   return parser_->Parse(buffer_.get(), bytes_read)
              ? Status::OK
@@ -413,5 +842,198 @@ Status Demuxer::Parse() {
                       "Cannot parse media file " + file_name_);
 }
 
+Status Demuxer::ParseMappedFile() {
+  const uint64_t size =
+      std::min<uint64_t>(kBufSize, mapped_file_->size() - mapped_position_);
+  if (size == 0) {
+    if (!parser_->Flush())
+      return Status(error::PARSER_FAILURE, "Failed to flush.");
+    return Status(error::END_OF_STREAM, "");
+  }
+
+  // The parser copies what it needs to keep, so the mapped pages can be
+  // dropped once they have been parsed.
+  const uint8_t* data = mapped_file_->data() + mapped_position_;
+  mapped_position_ += size;
+  if (progress_)
+    progress_->AddBytes(size);
+  const bool result = parser_->Parse(data, static_cast<int>(size));
+  mapped_file_->ReleaseBefore(mapped_position_);
+  return result ? Status::OK
+                : Status(error::PARSER_FAILURE,
+                         "Cannot parse media file " + file_name_);
+}
+
+bool Demuxer::MaybeStartParallelParsing() {
+  // Decryption keys are fetched by the parser that sees the 'pssh' boxes, so
+  // encrypted inputs are parsed sequentially.
+  if (num_parsing_threads_ <= 1 || container_name_ != CONTAINER_MOV ||
+      key_source_) {
+    return false;
+  }
+  std::unique_ptr<mp4::ParallelFragmentParser> parallel_parser(
+      new mp4::ParallelFragmentParser(file_name_, num_parsing_threads_,
+                                      kMinParallelRangeSize));
+  if (!parallel_parser->Initialize())
+    return false;
+
+  LOG(INFO) << "Parsing the fragments of '" << file_name_ << "' on "
+            << num_parsing_threads_ << " threads.";
+  parallel_parser_ = std::move(parallel_parser);
+  CloseMediaFile();
+  return true;
+}
+
+Status Demuxer::ParseParallel() {
+  bool end_of_stream = false;
+  if (!parallel_parser_->ParseNextRange(
+          std::bind(&Demuxer::NewMediaSampleEvent, this, std::placeholders::_1,
+                    std::placeholders::_2),
+          std::bind(&Demuxer::NewTextSampleEvent, this, std::placeholders::_1,
+                    std::placeholders::_2),
+          &end_of_stream)) {
+    return Status(error::PARSER_FAILURE,
+                  "Cannot parse media file " + file_name_);
+  }
+  if (end_of_stream) {
+    if (!parser_->Flush())
+      return Status(error::PARSER_FAILURE, "Failed to flush.");
+    return Status(error::END_OF_STREAM, "");
+  }
+  return Status::OK;
+}
+
+void Demuxer::MaybeStartIndexedParsing() {
+  if (container_name_ != CONTAINER_MOV)
+    return;
+  auto* mp4_parser = static_cast<mp4::MP4MediaParser*>(parser_.get());
+  if (!mp4_parser->IsFullyIndexed())
+    return;
+
+  std::set<uint32_t> selected_track_ids;
+  for (const auto& pair : track_id_to_stream_index_map_) {
+    if (pair.second != kInvalidStreamIndex)
+      selected_track_ids.insert(pair.first);
+  }
+  // Reading the whole input sequentially is cheaper if all the tracks are
+  // needed anyway, unless the clip starts after the start of the input.
+  const bool seek = has_clip_range_ && clip_start_seconds_ > 0;
+  if (selected_track_ids.size() == track_id_to_stream_index_map_.size() &&
+      !seek) {
+    return;
+  }
+
+  if (!mapped_file_) {
+    indexed_file_.reset(File::OpenWithNoBuffering(file_name_.c_str(), "r"));
+    if (!indexed_file_ || !indexed_file_->Seek(0)) {
+      VLOG(1) << "'" << file_name_ << "' does not support random access.";
+      indexed_file_.reset();
+      return;
+    }
+    indexed_file_position_ = 0;
+  }
+  // Stop reading ahead in the sequential input.
+  CloseMediaFile();
+
+  LOG(INFO) << "Reading only the samples of the selected tracks from '"
+            << file_name_ << "'.";
+  mp4_parser->StartIndexedReading(
+      selected_track_ids,
+      std::bind(&Demuxer::ReadAt, this, std::placeholders::_1,
+                std::placeholders::_2, std::placeholders::_3));
+  if (seek)
+    mp4_parser->SeekIndexed(clip_start_seconds_);
+  indexed_parsing_ = true;
+}
+
+Status Demuxer::ParseIndexed() {
+  bool end_of_stream = false;
+  if (!static_cast<mp4::MP4MediaParser*>(parser_.get())
+           ->ParseIndexedRun(&end_of_stream)) {
+    return Status(error::PARSER_FAILURE,
+                  "Cannot parse media file " + file_name_);
+  }
+  if (end_of_stream) {
+    if (!parser_->Flush())
+      return Status(error::PARSER_FAILURE, "Failed to flush.");
+    return Status(error::END_OF_STREAM, "");
+  }
+  return Status::OK;
+}
+
+bool Demuxer::ReadAt(uint64_t position, uint8_t* buffer, uint64_t size) {
+  if (progress_)
+    progress_->AddBytes(size);
+  if (mapped_file_) {
+    if (position > mapped_file_->size() ||
+        size > mapped_file_->size() - position) {
+      return false;
+    }
+    memcpy(buffer, mapped_file_->data() + position, size);
+    return true;
+  }
+
+  if (position != indexed_file_position_) {
+    if (!indexed_file_->Seek(position))
+      return false;
+    indexed_file_position_ = position;
+  }
+  while (size > 0) {
+    const int64_t bytes_read = indexed_file_->Read(buffer, size);
+    if (bytes_read <= 0)
+      return false;
+    buffer += bytes_read;
+    size -= bytes_read;
+    indexed_file_position_ += bytes_read;
+  }
+  return true;
+}
+
+void Demuxer::UpdateProgress(uint32_t track_id, int64_t timestamp) {
+  if (!progress_)
+    return;
+  auto time_scale = progress_time_scales_.find(track_id);
+  if (time_scale == progress_time_scales_.end())
+    return;
+  const double seconds = static_cast<double>(timestamp) / time_scale->second;
+  if (!progress_started_) {
+    // The duration of an input is counted from the start of its timeline
+    // when it is known, e.g. for MP4 inputs, and from the first sample
+    // otherwise, e.g. for MPEG-2 TS inputs.
+    progress_start_seconds_ = progress_->duration_seconds() > 0 ? 0 : seconds;
+    progress_started_ = true;
+  }
+  progress_->UpdateMediaTime(seconds - progress_start_seconds_);
+}
+
+Status Demuxer::SendTextHeartbeats(uint32_t track_id, int64_t timestamp) {
+  auto time_scale = heartbeat_time_scales_.find(track_id);
+  if (time_scale == heartbeat_time_scales_.end())
+    return Status::OK;
+  const double seconds = static_cast<double>(timestamp) / time_scale->second;
+  heartbeat_start_seconds_ =
+      std::min(heartbeat_start_seconds_.value_or(seconds), seconds);
+
+  // The heartbeats lag the other streams by the interval, so that the text
+  // samples which are a little behind them still come after the heartbeats.
+  const double interval = text_heartbeat_interval_seconds_;
+  const double heartbeat_seconds = seconds - interval;
+  for (auto& entry : text_heartbeats_) {
+    TextHeartbeat& text = entry.second;
+    // A text stream which has not started is silent from the start of the
+    // other streams.
+    const double silent_since =
+        text.end_seconds.value_or(*heartbeat_start_seconds_);
+    if (heartbeat_seconds - silent_since < interval)
+      continue;
+    text.end_seconds = heartbeat_seconds;
+    RETURN_IF_ERROR(DispatchTextSample(
+        text.stream_index,
+        TextSample::CreateHeartbeat(
+            std::llround(heartbeat_seconds * text.time_scale))));
+  }
+  return Status::OK;
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -7,18 +7,28 @@
 #ifndef PACKAGER_MEDIA_BASE_DEMUXER_H_
 #define PACKAGER_MEDIA_BASE_DEMUXER_H_
 
+#include <atomic>
 #include <deque>
+#include <functional>
+#include <map>
 #include <memory>
+#include <optional>
+#include <set>
 #include <vector>
 
+#include <absl/synchronization/mutex.h>
+
+#include <packager/file/file_closer.h>
 #include <packager/macros/classes.h>
 #include <packager/media/base/container_names.h>
+#include <packager/media/base/progress_tracker.h>
 #include <packager/media/origin/origin_handler.h>
 #include <packager/status.h>
 
 namespace shaka {
 
 class File;
+class MappedFile;
 
 namespace media {
 
@@ -27,6 +37,11 @@ class KeySource;
 class MediaParser;
 class MediaSample;
 class StreamInfo;
+class TextSample;
+
+namespace mp4 {
+class ParallelFragmentParser;
+}  // namespace mp4
 
 /// Demuxer is responsible for extracting elementary stream samples from a
 /// media file, e.g. an ISO BMFF file.
@@ -48,10 +63,36 @@ class Demuxer : public OriginHandler {
   /// the Data to Muxer until Eof.
   Status Run() override;
 
+  /// Find the streams of the input without demuxing its samples. Only the
+  /// start of the input is read, up to the stream info, or the 'moov' box of
+  /// a local MP4 file. The demuxer must have no handler. Do not call Run()
+  /// afterwards.
+  /// @param[out] stream_infos is set to the streams of the input.
+  /// @return OK on success, an error if the streams are not found.
+  Status Probe(std::vector<std::shared_ptr<StreamInfo>>* stream_infos);
+
+  /// Start parsing the input pushed with PushData(), if in push mode, as it
+  /// arrives. The input is parsed on the shared ThreadPool, so an input
+  /// waiting for data holds no thread.
+  /// @return false if not in push mode.
+  bool StartAsync(std::function<void(const Status&)> on_complete) override;
+
   /// Cancel a demuxing job in progress. Will cause @a Run to exit with an error
   /// status of type CANCELLED.
   void Cancel() override;
 
+  /// @param push_mode is true to parse the data given to PushData() instead
+  ///        of reading the input. Call it before running the demuxer.
+  void set_push_mode(bool push_mode) { push_mode_ = push_mode; }
+
+  /// Feed the next bytes of the input, in push mode. It can be called from
+  /// any thread, before or while the demuxer runs.
+  /// @return false if EndOfData() has been called.
+  bool PushData(std::vector<uint8_t> data);
+
+  /// Mark the end of the input, in push mode.
+  void EndOfData();
+
   /// @return Container name (type). Value is CONTAINER_UNKNOWN if the demuxer
   ///         is not initialized.
   MediaContainerName container_name() { return container_name_; }
@@ -79,6 +120,80 @@ class Demuxer : public OriginHandler {
     input_format_ = input_format;
   }
 
+  /// @param use_mmap enables parsing local MP4 files directly from a memory
+  ///        mapping instead of reading them through File.
+  void set_use_mmap(bool use_mmap) { use_mmap_ = use_mmap; }
+
+  /// @param num_parsing_threads is the number of threads used to parse
+  ///        fragmented MP4 inputs. If larger than 1, ranges of fragments of
+  ///        seekable inputs are parsed in parallel.
+  void set_num_parsing_threads(uint32_t num_parsing_threads) {
+    num_parsing_threads_ = num_parsing_threads;
+  }
+
+  /// @param num_decryption_threads is the maximum number of samples of MP4
+  ///        inputs decrypted concurrently on worker threads, when a key
+  ///        source is set.
+  void set_num_decryption_threads(uint32_t num_decryption_threads) {
+    num_decryption_threads_ = num_decryption_threads;
+  }
+
+  /// @param decrypt_samples is false to keep the samples of MP4 inputs
+  ///        encrypted even if a key source is set, e.g. to transcrypt them
+  ///        downstream with key_source().
+  void set_decrypt_samples(bool decrypt_samples) {
+    decrypt_samples_ = decrypt_samples;
+  }
+
+  /// Limit the size of the samples queued until all the streams have
+  /// started, e.g. until an audio PID of an MPEG-2 TS input which starts late
+  /// sends its configuration.
+  /// @param max_pending_bytes is the limit, or 0 for no limit.
+  /// @param drop_pending_streams is true to drop the streams which have not
+  ///        started when the limit is exceeded, if the container allows it,
+  ///        and to go on with the others. Otherwise demuxing fails.
+  void set_pending_stream_limit(uint64_t max_pending_bytes,
+                                bool drop_pending_streams) {
+    max_pending_bytes_ = max_pending_bytes;
+    drop_pending_streams_ = drop_pending_streams;
+  }
+
+  /// Only decode the given sub-streams of the text streams, e.g. the teletext
+  /// pages of the cc_index of the outputs, if the container allows it.
+  /// @param sub_streams are the sub-stream indexes, or empty for all.
+  void set_selected_text_sub_streams(std::set<uint16_t> sub_streams) {
+    selected_text_sub_streams_ = std::move(sub_streams);
+  }
+
+  /// Advance the text streams which are silent, e.g. the subtitles of a live
+  /// MPEG-2 TS input overnight, with heartbeats (see
+  /// TextSample::CreateHeartbeat()) driven by the timeline of the other
+  /// streams of the input, so that their segments and the cue alignment do
+  /// not wait for their next sample. Must be called before running.
+  /// @param interval_seconds is how long a text stream is silent before it
+  ///        gets a heartbeat, in media time. The heartbeats also lag the
+  ///        other streams by it, so it must be longer than the delay of the
+  ///        text samples behind them. 0 disables the heartbeats.
+  void set_text_heartbeat_interval(double interval_seconds) {
+    text_heartbeat_interval_seconds_ = interval_seconds;
+  }
+
+  /// Report the progress of the input to @a progress_tracker, which must
+  /// outlive the demuxer. Call it before running the demuxer.
+  void set_progress_tracker(ProgressTracker* progress_tracker);
+
+  /// Only demux a clip of the input. Must be called before running.
+  /// @param start_seconds is the start of the clip, in seconds of the input
+  ///        timeline. Each stream starts at its last key frame at or before
+  ///        it. Non-fragmented MP4 inputs are read from there.
+  /// @param end_seconds is the end of the clip, possibly infinite. The
+  ///        samples decoded at or after it are dropped, and the input is not
+  ///        read further once all the streams have reached it.
+  void SetClipRange(double start_seconds, double end_seconds);
+
+  /// @return the key source of the decryption keys, or nullptr.
+  KeySource* key_source() const { return key_source_.get(); }
+
  protected:
   /// @name MediaHandler implementation overrides.
   /// @{
@@ -109,10 +224,43 @@ class Demuxer : public OriginHandler {
     std::shared_ptr<T> sample;
   };
 
+  // The clip of a stream, in its timescale.
+  struct Clip {
+    int64_t start = 0;
+    int64_t end = 0;
+    bool started = false;
+    bool ended = false;
+    // The samples from the last key frame at or before |start|, held until
+    // |start| is reached.
+    std::vector<std::shared_ptr<MediaSample>> held_samples;
+  };
+
   // Initialize the parser. This method primes the demuxer by parsing portions
   // of the media file to extract stream information.
   // @return OK on success.
   Status InitializeParser();
+  // Close |media_file_|, if open.
+  void CloseMediaFile();
+  // Create |parser_| for |container_name_|. |header| is the start of the
+  // input, logged if the container is unknown.
+  Status CreateParser(const uint8_t* header, size_t header_size);
+  // Verify that the streams with an output handler exist in the input, once
+  // all the streams are ready.
+  Status CheckOutputStreams();
+
+  // Parse the data pushed so far. Runs on the ThreadPool, one task at a time.
+  void ParsePushedData();
+  // Parse the next pushed |data|.
+  Status ParsePushedBlock(const std::vector<uint8_t>& data);
+  // Create the parser for the pushed input from |pushed_header_|, then parse
+  // it.
+  Status ParsePushedHeader();
+  // Flush the parser and the downstream handlers at the end of the pushed
+  // input.
+  Status FinishPushedData();
+  // Post ParsePushedData() if there is something to do and it is not posted
+  // yet.
+  void MaybeSchedulePushedData() ABSL_EXCLUSIVE_LOCKS_REQUIRED(push_mutex_);
 
   // Parser init event.
   void ParserInitEvent(const std::vector<std::shared_ptr<StreamInfo>>& streams);
@@ -126,17 +274,101 @@ class Demuxer : public OriginHandler {
   // Helper function to push the sample to corresponding stream.
   bool PushMediaSample(uint32_t track_id, std::shared_ptr<MediaSample> sample);
   bool PushTextSample(uint32_t track_id, std::shared_ptr<TextSample> sample);
+  // Dispatch the samples of |clip| which can be decoded, given its next
+  // |sample|.
+  Status DispatchClippedSample(size_t stream_index,
+                               Clip* clip,
+                               std::shared_ptr<MediaSample> sample);
+  // @return true if all the streams have reached the end of their clip.
+  bool AllClipsEnded() const;
 
   // Read from the source and send it to the parser.
   Status Parse();
+  // Send the next block of |mapped_file_| to the parser.
+  Status ParseMappedFile();
+  // Sets up |parallel_parser_| if the input is a fragmented MP4 file which
+  // can be parsed in parallel.
+  bool MaybeStartParallelParsing();
+  // Pass the samples of the next range of fragments to the event handlers.
+  Status ParseParallel();
+  // Switches an MP4 parser to reading only the samples of the selected tracks
+  // if some tracks are not selected and the input allows random access.
+  void MaybeStartIndexedParsing();
+  // Have the parser read and emit the samples of the next selected run.
+  Status ParseIndexed();
+  // Reads |size| bytes at |position| of the input for indexed parsing.
+  bool ReadAt(uint64_t position, uint8_t* buffer, uint64_t size);
+  // Reports that the input has been read up to |timestamp| of |track_id|, if
+  // its progress is tracked.
+  void UpdateProgress(uint32_t track_id, int64_t timestamp);
+  // Sends heartbeats to the text streams which have been silent for the
+  // heartbeat interval, given that a non-text stream reached |timestamp| of
+  // |track_id|.
+  Status SendTextHeartbeats(uint32_t track_id, int64_t timestamp);
 
   std::string file_name_;
+  // Set if the progress of the input is tracked.
+  ProgressTracker* progress_tracker_ = nullptr;
+  ProgressTracker::Input* progress_ = nullptr;
+  // The time scales of the streams by track ID, and the earliest timestamp
+  // of the input in seconds, to report its media time.
+  std::map<uint32_t, int32_t> progress_time_scales_;
+  double progress_start_seconds_ = 0;
+  bool progress_started_ = false;
+  // Set by set_text_heartbeat_interval().
+  double text_heartbeat_interval_seconds_ = 0;
+  // A text stream which gets heartbeats.
+  struct TextHeartbeat {
+    size_t stream_index = 0;
+    int32_t time_scale = 0;
+    // The end of its last sample or heartbeat, in seconds, if any.
+    std::optional<double> end_seconds;
+  };
+  // The text streams which get heartbeats, and the time scales of the
+  // streams which drive them, by track ID, and the earliest time of the
+  // latter in seconds.
+  std::map<uint32_t, TextHeartbeat> text_heartbeats_;
+  std::map<uint32_t, int32_t> heartbeat_time_scales_;
+  std::optional<double> heartbeat_start_seconds_;
+  // Only changed by the parsing thread, under |media_file_mutex_| so that
+  // Cancel() can abort it from another thread.
+  absl::Mutex media_file_mutex_;
   File* media_file_ = nullptr;
+  // Set instead of |media_file_| when the input is parsed from a mapping.
+  std::unique_ptr<MappedFile> mapped_file_;
+  // The position in |mapped_file_| of the next byte to parse.
+  uint64_t mapped_position_ = 0;
+  bool use_mmap_ = false;
+  uint32_t num_parsing_threads_ = 0;
+  uint32_t num_decryption_threads_ = 0;
+  bool decrypt_samples_ = true;
+  uint64_t max_pending_bytes_ = 0;
+  bool drop_pending_streams_ = false;
+  std::set<uint16_t> selected_text_sub_streams_;
+  // Set if the fragments of the input are parsed in parallel. |parser_| then
+  // only parses the boxes before the first fragment.
+  std::unique_ptr<mp4::ParallelFragmentParser> parallel_parser_;
+  // Set if only the samples of the selected tracks are read, from their
+  // positions in the input.
+  bool indexed_parsing_ = false;
+  // Used for random access to the input in indexed parsing, unless it is
+  // memory mapped.
+  std::unique_ptr<File, FileCloser> indexed_file_;
+  // The current position in |indexed_file_|.
+  uint64_t indexed_file_position_ = 0;
+  // Set by SetClipRange().
+  bool has_clip_range_ = false;
+  double clip_start_seconds_ = 0;
+  double clip_end_seconds_ = 0;
+  // The clips of the streams with an output handler, by track ID.
+  std::map<uint32_t, Clip> clips_;
   // A stream is considered ready after receiving the stream info.
   bool all_streams_ready_ = false;
   // Queued samples received in NewSampleEvent() before ParserInitEvent().
   std::deque<QueuedSample<MediaSample>> queued_media_samples_;
   std::deque<QueuedSample<TextSample>> queued_text_samples_;
+  // The size of the data of |queued_media_samples_|.
+  uint64_t queued_media_bytes_ = 0;
   std::unique_ptr<MediaParser> parser_;
   // TrackId -> StreamIndex map.
   std::map<uint32_t, size_t> track_id_to_stream_index_map_;
@@ -148,12 +380,29 @@ class Demuxer : public OriginHandler {
   MediaContainerName container_name_ = CONTAINER_UNKNOWN;
   std::unique_ptr<uint8_t[]> buffer_;
   std::unique_ptr<KeySource> key_source_;
-  bool cancelled_ = false;
+  std::atomic<bool> cancelled_{false};
   // Whether to dump stream info when it is received.
   bool dump_stream_info_ = false;
+  // Set by Probe(), which then keeps the stream info received.
+  bool probing_ = false;
+  std::vector<std::shared_ptr<StreamInfo>> probed_stream_infos_;
   Status init_event_status_;
   // Explicitly defined input format, for avoiding autodetection.
   std::string input_format_;
+
+  // Set if the input is given with PushData() rather than read.
+  bool push_mode_ = false;
+  absl::Mutex push_mutex_;
+  std::deque<std::vector<uint8_t>> pushed_data_ ABSL_GUARDED_BY(push_mutex_);
+  bool end_of_data_ ABSL_GUARDED_BY(push_mutex_) = false;
+  // Set by StartAsync(), and reset once it is called.
+  std::function<void(const Status&)> on_complete_ ABSL_GUARDED_BY(push_mutex_);
+  bool push_started_ ABSL_GUARDED_BY(push_mutex_) = false;
+  bool push_completed_ ABSL_GUARDED_BY(push_mutex_) = false;
+  bool push_parsing_posted_ ABSL_GUARDED_BY(push_mutex_) = false;
+  // The start of the pushed input, until the parser is created.
+  std::vector<uint8_t> pushed_header_;
+  bool output_streams_checked_ = false;
 };
 
 }  // namespace media
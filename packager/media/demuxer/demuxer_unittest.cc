@@ -6,6 +6,7 @@
 
 #include <packager/media/demuxer/demuxer.h>
 
+#include <absl/synchronization/notification.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -23,11 +24,80 @@ using ::testing::DoAll;
 using ::testing::Return;
 using ::testing::SetArgPointee;
 
+const double kClipStartSeconds = 1;
+const double kClipEndSeconds = 2;
+
 class MockKeySource : public RawKeySource {
  public:
   MOCK_METHOD2(GetKey,
                Status(const std::vector<uint8_t>& key_id, EncryptionKey* key));
 };
+
+struct DemuxedStream {
+  int32_t time_scale = 0;
+  std::vector<std::shared_ptr<const MediaSample>> samples;
+};
+
+// @return the audio and video streams of |file_name|, clipped to
+//         [kClipStartSeconds, kClipEndSeconds) if |clip| is true.
+std::vector<DemuxedStream> Demux(const std::string& file_name, bool clip) {
+  Demuxer demuxer(GetTestDataFilePath(file_name).string());
+  if (clip)
+    demuxer.SetClipRange(kClipStartSeconds, kClipEndSeconds);
+  std::vector<std::shared_ptr<CachingMediaHandler>> handlers;
+  for (const char* stream_label : {"audio", "video"}) {
+    handlers.push_back(std::make_shared<CachingMediaHandler>());
+    EXPECT_OK(demuxer.SetHandler(stream_label, handlers.back()));
+  }
+  EXPECT_OK(demuxer.Run());
+
+  std::vector<DemuxedStream> streams(handlers.size());
+  for (size_t i = 0; i < handlers.size(); ++i) {
+    for (const auto& stream_data : handlers[i]->Cache()) {
+      if (stream_data->stream_data_type == StreamDataType::kStreamInfo)
+        streams[i].time_scale = stream_data->stream_info->time_scale();
+      if (stream_data->stream_data_type == StreamDataType::kMediaSample)
+        streams[i].samples.push_back(stream_data->media_sample);
+    }
+  }
+  return streams;
+}
+
+// Checks that the clip of each stream of |file_name| starts at its last key
+// frame presented at or before the start of the clip, and has the samples
+// decoded before the end of the clip.
+void CheckClip(const std::string& file_name) {
+  const std::vector<DemuxedStream> streams = Demux(file_name, false);
+  const std::vector<DemuxedStream> clipped_streams = Demux(file_name, true);
+  ASSERT_EQ(streams.size(), clipped_streams.size());
+  for (size_t i = 0; i < streams.size(); ++i) {
+    const DemuxedStream& stream = streams[i];
+    const int64_t start = kClipStartSeconds * stream.time_scale;
+    const int64_t end = kClipEndSeconds * stream.time_scale;
+    size_t first = 0;
+    for (size_t j = 0; j < stream.samples.size(); ++j) {
+      if (stream.samples[j]->is_key_frame() &&
+          stream.samples[j]->pts() <= start) {
+        first = j;
+      }
+    }
+    size_t last = first;
+    while (last < stream.samples.size() && stream.samples[last]->dts() < end)
+      ++last;
+
+    const DemuxedStream& clipped_stream = clipped_streams[i];
+    ASSERT_EQ(last - first, clipped_stream.samples.size());
+    EXPECT_FALSE(clipped_stream.samples.empty());
+    EXPECT_LT(clipped_stream.samples.size(), stream.samples.size());
+    for (size_t j = 0; j < clipped_stream.samples.size(); ++j) {
+      EXPECT_EQ(stream.samples[first + j]->dts(),
+                clipped_stream.samples[j]->dts());
+      EXPECT_EQ(stream.samples[first + j]->data_size(),
+                clipped_stream.samples[j]->data_size());
+    }
+  }
+}
+
 }  // namespace
 
 class DemuxerTest : public MediaHandlerGraphTestBase {
@@ -73,6 +143,112 @@ TEST_F(DemuxerTest, EncryptedContentWithKeySource) {
   EXPECT_OK(demuxer.Run());
 }
 
+TEST_F(DemuxerTest, MemoryMappedInputWithTrailingMoov) {
+  Demuxer demuxer(
+      GetTestDataFilePath("bear-640x360-trailing-moov.mp4").string());
+  demuxer.set_use_mmap(true);
+  ASSERT_OK(demuxer.SetHandler("video", some_handler()));
+  EXPECT_OK(demuxer.Run());
+}
+
+TEST_F(DemuxerTest, IndexedReadingOfSelectedTracks) {
+  // The audio track is not selected, so only the video samples are read.
+  Demuxer demuxer(GetTestDataFilePath("bear-640x360.mp4").string());
+  ASSERT_OK(demuxer.SetHandler("video", some_handler()));
+  EXPECT_OK(demuxer.Run());
+}
+
+TEST_F(DemuxerTest, MemoryMappedIndexedReadingOfSelectedTracks) {
+  Demuxer demuxer(GetTestDataFilePath("bear-640x360.mp4").string());
+  demuxer.set_use_mmap(true);
+  ASSERT_OK(demuxer.SetHandler("video", some_handler()));
+  EXPECT_OK(demuxer.Run());
+}
+
+TEST_F(DemuxerTest, PushedInput) {
+  const std::vector<uint8_t> input = ReadTestDataFile("bear-640x360.mp4");
+  ASSERT_FALSE(input.empty());
+
+  Demuxer demuxer("pushed input");
+  demuxer.set_push_mode(true);
+  ASSERT_OK(demuxer.SetHandler("video", some_handler()));
+  // Small blocks, so that the container is detected over several of them.
+  const size_t kBlockSize = 1000;
+  for (size_t offset = 0; offset < input.size(); offset += kBlockSize) {
+    const size_t end = std::min(offset + kBlockSize, input.size());
+    ASSERT_TRUE(demuxer.PushData(
+        std::vector<uint8_t>(input.begin() + offset, input.begin() + end)));
+  }
+  demuxer.EndOfData();
+  EXPECT_FALSE(demuxer.PushData({0}));
+  EXPECT_OK(demuxer.Run());
+}
+
+TEST_F(DemuxerTest, PushedInputCompletesAsynchronously) {
+  const std::vector<uint8_t> input = ReadTestDataFile("bear-640x360.mp4");
+  ASSERT_FALSE(input.empty());
+
+  Demuxer demuxer("pushed input");
+  demuxer.set_push_mode(true);
+  ASSERT_OK(demuxer.SetHandler("video", some_handler()));
+  absl::Notification done;
+  Status status;
+  ASSERT_TRUE(demuxer.StartAsync([&done, &status](const Status& result) {
+    status = result;
+    done.Notify();
+  }));
+  ASSERT_TRUE(demuxer.PushData(input));
+  demuxer.EndOfData();
+  done.WaitForNotification();
+  EXPECT_OK(status);
+}
+
+TEST_F(DemuxerTest, CancelPushedInput) {
+  Demuxer demuxer("pushed input");
+  demuxer.set_push_mode(true);
+  ASSERT_OK(demuxer.SetHandler("video", some_handler()));
+  absl::Notification done;
+  Status status;
+  ASSERT_TRUE(demuxer.StartAsync([&done, &status](const Status& result) {
+    status = result;
+    done.Notify();
+  }));
+  // No data is coming.
+  demuxer.Cancel();
+  done.WaitForNotification();
+  EXPECT_EQ(error::CANCELLED, status.error_code());
+}
+
+TEST_F(DemuxerTest, NoAsyncStartWithoutPushMode) {
+  Demuxer demuxer(GetTestDataFilePath("bear-640x360.mp4").string());
+  EXPECT_FALSE(demuxer.StartAsync([](const Status&) {}));
+}
+
+TEST_F(DemuxerTest, ProbeMp4) {
+  Demuxer demuxer(GetTestDataFilePath("bear-640x360.mp4").string());
+  std::vector<std::shared_ptr<StreamInfo>> stream_infos;
+  ASSERT_OK(demuxer.Probe(&stream_infos));
+  ASSERT_EQ(2u, stream_infos.size());
+  EXPECT_EQ(kStreamVideo, stream_infos[0]->stream_type());
+  EXPECT_EQ(kStreamAudio, stream_infos[1]->stream_type());
+}
+
+TEST_F(DemuxerTest, ProbeTs) {
+  Demuxer demuxer(GetTestDataFilePath("bear-640x360.ts").string());
+  std::vector<std::shared_ptr<StreamInfo>> stream_infos;
+  ASSERT_OK(demuxer.Probe(&stream_infos));
+  EXPECT_EQ(2u, stream_infos.size());
+}
+
+TEST_F(DemuxerTest, ClipOfIndexedInput) {
+  // Read from the key frames before the start of the clip.
+  CheckClip("bear-640x360.mp4");
+}
+
+TEST_F(DemuxerTest, ClipOfFragmentedInput) {
+  CheckClip("bear-640x360-av_frag.mp4");
+}
+
 // TODO(kqyang): Add more tests.
 
 }  // namespace media
@@ -0,0 +1,144 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/demuxer/text_multiplexer.h>
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+#include <absl/log/check.h>
+
+#include <packager/macros/compiler.h>
+#include <packager/macros/status.h>
+#include <packager/media/demuxer/demuxer.h>
+
+namespace shaka {
+namespace media {
+
+// Keeps the stream data of a text stream until it is dispatched.
+class TextMultiplexer::Collector : public MediaHandler {
+ public:
+  bool empty() const { return stream_data_.empty(); }
+
+  // @return the presentation time of the next stream data in seconds, or
+  //         negative infinity if it is not a sample, so that it is dispatched
+  //         right away.
+  double NextTimeInSeconds() const {
+    DCHECK(!empty());
+    const StreamData& data = *stream_data_.front();
+    if (!stream_info_ || !(data.text_sample || data.media_sample))
+      return -std::numeric_limits<double>::infinity();
+    const int64_t time = data.text_sample ? data.text_sample->start_time()
+                                          : data.media_sample->pts();
+    return static_cast<double>(time) / stream_info_->time_scale();
+  }
+
+  std::unique_ptr<StreamData> Pop() {
+    DCHECK(!empty());
+    std::unique_ptr<StreamData> data = std::move(stream_data_.front());
+    stream_data_.pop_front();
+    if (data->stream_data_type == StreamDataType::kStreamInfo)
+      stream_info_ = data->stream_info;
+    return data;
+  }
+
+ private:
+  Status InitializeInternal() override { return Status::OK; }
+
+  Status Process(std::unique_ptr<StreamData> stream_data) override {
+    stream_data_.push_back(std::move(stream_data));
+    return Status::OK;
+  }
+
+  // The multiplexer flushes its outputs once all the data is dispatched.
+  Status OnFlushRequest(size_t input_stream_index) override {
+    UNUSED(input_stream_index);
+    return Status::OK;
+  }
+
+  bool ValidateOutputStreamIndex(size_t stream_index) const override {
+    UNUSED(stream_index);
+    return false;
+  }
+
+  std::deque<std::unique_ptr<StreamData>> stream_data_;
+  // The stream info of the dispatched stream data.
+  std::shared_ptr<const StreamInfo> stream_info_;
+};
+
+TextMultiplexer::TextMultiplexer() = default;
+
+TextMultiplexer::~TextMultiplexer() = default;
+
+Status TextMultiplexer::AddInput(std::shared_ptr<Demuxer> demuxer,
+                                 const std::string& stream_selector,
+                                 std::shared_ptr<MediaHandler> handler) {
+  DCHECK(demuxer);
+  auto collector = std::make_shared<Collector>();
+  RETURN_IF_ERROR(demuxer->SetHandler(stream_selector, collector));
+  RETURN_IF_ERROR(SetHandler(collectors_.size(), std::move(handler)));
+  if (std::find(demuxers_.begin(), demuxers_.end(), demuxer) ==
+      demuxers_.end()) {
+    demuxers_.push_back(std::move(demuxer));
+  }
+  collectors_.push_back(std::move(collector));
+  return Status::OK;
+}
+
+Status TextMultiplexer::InitializeInternal() {
+  for (const auto& demuxer : demuxers_)
+    RETURN_IF_ERROR(demuxer->Initialize());
+  return Status::OK;
+}
+
+bool TextMultiplexer::ValidateOutputStreamIndex(size_t stream_index) const {
+  return stream_index < collectors_.size();
+}
+
+Status TextMultiplexer::Run() {
+  for (const auto& demuxer : demuxers_) {
+    if (cancelled_)
+      return Status(error::CANCELLED, "Text multiplexer cancelled.");
+    RETURN_IF_ERROR(demuxer->Run());
+  }
+
+  ScopedProcessTimer timer(this);
+  while (true) {
+    if (cancelled_)
+      return Status(error::CANCELLED, "Text multiplexer cancelled.");
+
+    // Dispatch the earliest stream data of all the streams, the stream data
+    // of lower output streams first on ties.
+    size_t next_index = collectors_.size();
+    double next_time = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < collectors_.size(); ++i) {
+      if (collectors_[i]->empty())
+        continue;
+      const double time = collectors_[i]->NextTimeInSeconds();
+      if (next_index == collectors_.size() || time < next_time) {
+        next_index = i;
+        next_time = time;
+      }
+    }
+    if (next_index == collectors_.size())
+      break;
+
+    std::unique_ptr<StreamData> data = collectors_[next_index]->Pop();
+    data->stream_index = next_index;
+    RETURN_IF_ERROR(Dispatch(std::move(data)));
+  }
+  return FlushAllDownstreams();
+}
+
+void TextMultiplexer::Cancel() {
+  cancelled_ = true;
+  for (const auto& demuxer : demuxers_)
+    demuxer->Cancel();
+}
+
+}  // namespace media
+}  // namespace shaka
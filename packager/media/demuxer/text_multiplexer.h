@@ -0,0 +1,75 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_DEMUXER_TEXT_MULTIPLEXER_H_
+#define PACKAGER_MEDIA_DEMUXER_TEXT_MULTIPLEXER_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <packager/media/origin/origin_handler.h>
+#include <packager/status.h>
+
+namespace shaka {
+namespace media {
+
+class Demuxer;
+
+/// Runs the demuxers of many text inputs, e.g. the subtitles of a title in
+/// many languages, in a single job instead of one job each. The text streams
+/// are read in full, as they are small, then dispatched together in
+/// presentation order: the samples of all the streams around a segment
+/// boundary reach the downstream handlers, e.g. a shared cue alignment
+/// handler, at about the same time.
+class TextMultiplexer : public OriginHandler {
+ public:
+  TextMultiplexer();
+  ~TextMultiplexer() override;
+
+  /// Adds a text stream of @a demuxer as the next output stream.
+  /// @param demuxer is the demuxer of the text input. It is run by the
+  ///        multiplexer, so it must not be run by a job of its own. It may be
+  ///        passed again for another stream of the same input.
+  /// @param stream_selector selects the stream of the input, as for
+  ///        Demuxer::SetHandler().
+  /// @param handler is the downstream handler of the stream.
+  /// @return OK on success.
+  Status AddInput(std::shared_ptr<Demuxer> demuxer,
+                  const std::string& stream_selector,
+                  std::shared_ptr<MediaHandler> handler);
+
+  /// @name OriginHandler implementation overrides.
+  /// @{
+  Status Run() override;
+  void Cancel() override;
+  /// @}
+
+ protected:
+  /// @name MediaHandler implementation overrides.
+  /// @{
+  Status InitializeInternal() override;
+  bool ValidateOutputStreamIndex(size_t stream_index) const override;
+  /// @}
+
+ private:
+  TextMultiplexer(const TextMultiplexer&) = delete;
+  TextMultiplexer& operator=(const TextMultiplexer&) = delete;
+
+  class Collector;
+
+  // The demuxers, without duplicates, in the order they were added.
+  std::vector<std::shared_ptr<Demuxer>> demuxers_;
+  // The collector of each output stream.
+  std::vector<std::shared_ptr<Collector>> collectors_;
+  std::atomic<bool> cancelled_{false};
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_DEMUXER_TEXT_MULTIPLEXER_H_
@@ -0,0 +1,52 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/demuxer/text_multiplexer.h>
+
+#include <gtest/gtest.h>
+
+#include <packager/media/base/media_handler_test_base.h>
+#include <packager/media/demuxer/demuxer.h>
+#include <packager/media/test/test_data_util.h>
+#include <packager/status/status_test_util.h>
+
+namespace shaka {
+namespace media {
+
+TEST(TextMultiplexerTest, DispatchesStreamsInPresentationOrder) {
+  const std::string input = GetTestDataFilePath("bear-english.vtt").string();
+  auto demuxer1 = std::make_shared<Demuxer>(input);
+  auto demuxer2 = std::make_shared<Demuxer>(input);
+  auto handler = std::make_shared<CachingMediaHandler>();
+
+  auto multiplexer = std::make_shared<TextMultiplexer>();
+  ASSERT_OK(multiplexer->AddInput(demuxer1, "text", handler));
+  ASSERT_OK(multiplexer->AddInput(demuxer2, "text", handler));
+  ASSERT_OK(multiplexer->Initialize());
+  ASSERT_OK(multiplexer->Run());
+
+  const auto& cache = handler->Cache();
+  ASSERT_GT(cache.size(), 2u);
+  EXPECT_EQ(StreamDataType::kStreamInfo, cache[0]->stream_data_type);
+  EXPECT_EQ(StreamDataType::kStreamInfo, cache[1]->stream_data_type);
+
+  // The cues of both streams are interleaved by start time.
+  size_t num_samples[2] = {};
+  int64_t previous_start_time = 0;
+  for (size_t i = 2; i < cache.size(); ++i) {
+    ASSERT_EQ(StreamDataType::kTextSample, cache[i]->stream_data_type);
+    ASSERT_LT(cache[i]->stream_index, 2u);
+    ++num_samples[cache[i]->stream_index];
+    const int64_t start_time = cache[i]->text_sample->start_time();
+    EXPECT_LE(previous_start_time, start_time);
+    previous_start_time = start_time;
+  }
+  EXPECT_GT(num_samples[0], 0u);
+  EXPECT_EQ(num_samples[0], num_samples[1]);
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,172 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/event/async_muxer_listener.h>
+
+#include <absl/log/check.h>
+
+#include <packager/file/thread_pool.h>
+#include <packager/media/base/muxer_options.h>
+#include <packager/media/base/protection_system_specific_info.h>
+#include <packager/media/base/stream_info.h>
+
+namespace shaka {
+namespace media {
+
+AsyncMuxerListener::AsyncMuxerListener(std::unique_ptr<MuxerListener> listener)
+    : listener_(std::move(listener)) {
+  DCHECK(listener_);
+}
+
+AsyncMuxerListener::~AsyncMuxerListener() {
+  Flush();
+}
+
+void AsyncMuxerListener::Flush() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(
+      +[](bool* draining) { return !*draining; }, &draining_));
+}
+
+void AsyncMuxerListener::OnEncryptionInfoReady(
+    bool is_initial_encryption_info,
+    FourCC protection_scheme,
+    const std::vector<uint8_t>& key_id,
+    const std::vector<uint8_t>& iv,
+    const std::vector<ProtectionSystemSpecificInfo>& key_system_info) {
+  Post([=](MuxerListener* listener) {
+    listener->OnEncryptionInfoReady(is_initial_encryption_info,
+                                    protection_scheme, key_id, iv,
+                                    key_system_info);
+  });
+}
+
+void AsyncMuxerListener::OnEncryptionStart() {
+  Post([](MuxerListener* listener) { listener->OnEncryptionStart(); });
+}
+
+void AsyncMuxerListener::OnMediaStart(const MuxerOptions& muxer_options,
+                                      const StreamInfo& stream_info,
+                                      int32_t time_scale,
+                                      ContainerType container_type) {
+  std::shared_ptr<const StreamInfo> stream_info_copy = stream_info.Clone();
+  Post([=](MuxerListener* listener) {
+    listener->OnMediaStart(muxer_options, *stream_info_copy, time_scale,
+                           container_type);
+  });
+}
+
+void AsyncMuxerListener::OnAvailabilityOffsetReady() {
+  Post([](MuxerListener* listener) { listener->OnAvailabilityOffsetReady(); });
+}
+
+void AsyncMuxerListener::OnSampleDurationReady(int32_t sample_duration) {
+  Post([=](MuxerListener* listener) {
+    listener->OnSampleDurationReady(sample_duration);
+  });
+}
+
+void AsyncMuxerListener::OnSegmentDurationReady() {
+  Post([](MuxerListener* listener) { listener->OnSegmentDurationReady(); });
+}
+
+void AsyncMuxerListener::OnMediaEnd(const MediaRanges& media_ranges,
+                                    float duration_seconds) {
+  Post([=](MuxerListener* listener) {
+    listener->OnMediaEnd(media_ranges, duration_seconds);
+  });
+  // The manifests are finalized once the muxers are done.
+  Flush();
+}
+
+void AsyncMuxerListener::OnNewSegment(const std::string& file_name,
+                                      int64_t start_time,
+                                      int64_t duration,
+                                      uint64_t segment_file_size,
+                                      int64_t segment_number) {
+  Post([=](MuxerListener* listener) {
+    listener->OnNewSegment(file_name, start_time, duration, segment_file_size,
+                           segment_number);
+  });
+}
+
+void AsyncMuxerListener::OnNewBundledSegment(const std::string& bundle_name,
+                                             int64_t start_time,
+                                             int64_t duration,
+                                             uint64_t start_byte_offset,
+                                             uint64_t segment_size,
+                                             int64_t segment_number) {
+  Post([=](MuxerListener* listener) {
+    listener->OnNewBundledSegment(bundle_name, start_time, duration,
+                                  start_byte_offset, segment_size,
+                                  segment_number);
+  });
+}
+
+void AsyncMuxerListener::OnCompletedSegment(int64_t duration,
+                                            uint64_t segment_file_size) {
+  Post([=](MuxerListener* listener) {
+    listener->OnCompletedSegment(duration, segment_file_size);
+  });
+}
+
+void AsyncMuxerListener::OnNewChunk(int64_t start_time,
+                                    int64_t duration,
+                                    uint64_t start_byte_offset,
+                                    uint64_t size,
+                                    bool is_independent) {
+  Post([=](MuxerListener* listener) {
+    listener->OnNewChunk(start_time, duration, start_byte_offset, size,
+                         is_independent);
+  });
+}
+
+void AsyncMuxerListener::OnSegmentLatency(const SegmentLatency& latency) {
+  Post([=](MuxerListener* listener) { listener->OnSegmentLatency(latency); });
+}
+
+void AsyncMuxerListener::OnKeyFrame(int64_t timestamp,
+                                    uint64_t start_byte_offset,
+                                    uint64_t size) {
+  Post([=](MuxerListener* listener) {
+    listener->OnKeyFrame(timestamp, start_byte_offset, size);
+  });
+}
+
+void AsyncMuxerListener::OnCueEvent(int64_t timestamp,
+                                    const std::string& cue_data) {
+  Post([=](MuxerListener* listener) {
+    listener->OnCueEvent(timestamp, cue_data);
+  });
+}
+
+void AsyncMuxerListener::Post(Event event) {
+  absl::MutexLock lock(&mutex_);
+  events_.push_back(std::move(event));
+  if (draining_)
+    return;
+  draining_ = true;
+  ThreadPool::instance.PostTask([this]() { Drain(); });
+}
+
+void AsyncMuxerListener::Drain() {
+  while (true) {
+    Event event;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (events_.empty()) {
+        draining_ = false;
+        return;
+      }
+      event = std::move(events_.front());
+      events_.pop_front();
+    }
+    event(listener_.get());
+  }
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,104 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// Implementation of MuxerListener that forwards the events to another
+// listener from a thread of the pool, so that the muxers do not wait for the
+// manifest updates.
+
+#ifndef PACKAGER_MEDIA_EVENT_ASYNC_MUXER_LISTENER_H_
+#define PACKAGER_MEDIA_EVENT_ASYNC_MUXER_LISTENER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include <absl/synchronization/mutex.h>
+
+#include <packager/media/event/muxer_listener.h>
+
+namespace shaka {
+namespace media {
+
+/// Queues the events and forwards them, in order, to another listener from a
+/// thread of the pool. The muxer only waits for the events to be forwarded in
+/// OnMediaEnd(), which returns once the listener has processed all the
+/// events, and in the destructor.
+class AsyncMuxerListener : public MuxerListener {
+ public:
+  /// @param listener is the listener the events are forwarded to. It is only
+  ///        called from one thread at a time.
+  explicit AsyncMuxerListener(std::unique_ptr<MuxerListener> listener);
+  /// Waits for the queued events to be forwarded.
+  ~AsyncMuxerListener() override;
+
+  /// Waits for the queued events to be forwarded.
+  void Flush();
+
+  /// @name MuxerListener implementation overrides.
+  /// @{
+  void OnEncryptionInfoReady(bool is_initial_encryption_info,
+                             FourCC protection_scheme,
+                             const std::vector<uint8_t>& key_id,
+                             const std::vector<uint8_t>& iv,
+                             const std::vector<ProtectionSystemSpecificInfo>&
+                                 key_system_info) override;
+  void OnEncryptionStart() override;
+  void OnMediaStart(const MuxerOptions& muxer_options,
+                    const StreamInfo& stream_info,
+                    int32_t time_scale,
+                    ContainerType container_type) override;
+  void OnAvailabilityOffsetReady() override;
+  void OnSampleDurationReady(int32_t sample_duration) override;
+  void OnSegmentDurationReady() override;
+  void OnMediaEnd(const MediaRanges& media_ranges,
+                  float duration_seconds) override;
+  void OnNewSegment(const std::string& file_name,
+                    int64_t start_time,
+                    int64_t duration,
+                    uint64_t segment_file_size,
+                    int64_t segment_number) override;
+  void OnNewBundledSegment(const std::string& bundle_name,
+                           int64_t start_time,
+                           int64_t duration,
+                           uint64_t start_byte_offset,
+                           uint64_t segment_size,
+                           int64_t segment_number) override;
+  void OnCompletedSegment(int64_t duration,
+                          uint64_t segment_file_size) override;
+  void OnNewChunk(int64_t start_time,
+                  int64_t duration,
+                  uint64_t start_byte_offset,
+                  uint64_t size,
+                  bool is_independent) override;
+  void OnSegmentLatency(const SegmentLatency& latency) override;
+  void OnKeyFrame(int64_t timestamp,
+                  uint64_t start_byte_offset,
+                  uint64_t size) override;
+  void OnCueEvent(int64_t timestamp, const std::string& cue_data) override;
+  /// @}
+
+ private:
+  AsyncMuxerListener(const AsyncMuxerListener&) = delete;
+  AsyncMuxerListener& operator=(const AsyncMuxerListener&) = delete;
+
+  using Event = std::function<void(MuxerListener* listener)>;
+
+  void Post(Event event);
+  // Forwards the queued events until the queue is empty.
+  void Drain();
+
+  const std::unique_ptr<MuxerListener> listener_;
+
+  absl::Mutex mutex_;
+  std::deque<Event> events_ ABSL_GUARDED_BY(mutex_);
+  // Whether a task of the pool is forwarding the events.
+  bool draining_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_EVENT_ASYNC_MUXER_LISTENER_H_
@@ -0,0 +1,95 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/event/async_muxer_listener.h>
+
+#include <thread>
+
+#include <absl/synchronization/notification.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <packager/media/event/mock_muxer_listener.h>
+
+using ::testing::_;
+using ::testing::InSequence;
+using ::testing::Invoke;
+
+namespace shaka {
+namespace media {
+
+namespace {
+const int kNumSegments = 20;
+const int64_t kSegmentDuration = 1000;
+const uint64_t kSegmentSize = 5000;
+}  // namespace
+
+class AsyncMuxerListenerTest : public ::testing::Test {
+ protected:
+  AsyncMuxerListenerTest() {
+    std::unique_ptr<MockMuxerListener> mock_listener(
+        new ::testing::StrictMock<MockMuxerListener>);
+    mock_listener_ = mock_listener.get();
+    listener_.reset(new AsyncMuxerListener(std::move(mock_listener)));
+  }
+
+  MockMuxerListener* mock_listener_;
+  std::unique_ptr<AsyncMuxerListener> listener_;
+};
+
+TEST_F(AsyncMuxerListenerTest, ForwardsEventsInOrder) {
+  const std::thread::id muxer_thread = std::this_thread::get_id();
+  {
+    InSequence s;
+    for (int i = 0; i < kNumSegments; ++i) {
+      const int64_t start_time = i * kSegmentDuration;
+      EXPECT_CALL(*mock_listener_, OnKeyFrame(start_time, 0, kSegmentSize));
+      EXPECT_CALL(*mock_listener_,
+                  OnNewSegment("segment.m4s", start_time, kSegmentDuration,
+                               kSegmentSize, i + 1))
+          .WillOnce(Invoke([muxer_thread](const std::string&, int64_t,
+                                          int64_t, uint64_t, int64_t) {
+            EXPECT_NE(muxer_thread, std::this_thread::get_id());
+          }));
+    }
+    EXPECT_CALL(*mock_listener_, OnCueEvent(kNumSegments * kSegmentDuration,
+                                            "cue data"));
+    EXPECT_CALL(*mock_listener_, OnMediaEndMock(_, _, _, _, _, _, _, _, _));
+  }
+
+  for (int i = 0; i < kNumSegments; ++i) {
+    const int64_t start_time = i * kSegmentDuration;
+    listener_->OnKeyFrame(start_time, 0, kSegmentSize);
+    listener_->OnNewSegment("segment.m4s", start_time, kSegmentDuration,
+                            kSegmentSize, i + 1);
+  }
+  listener_->OnCueEvent(kNumSegments * kSegmentDuration, "cue data");
+  // Returns once the listener got all the events.
+  listener_->OnMediaEnd(MuxerListener::MediaRanges(), 10);
+  ::testing::Mock::VerifyAndClearExpectations(mock_listener_);
+}
+
+TEST_F(AsyncMuxerListenerTest, DoesNotWaitForTheListener) {
+  absl::Notification release_listener;
+  EXPECT_CALL(*mock_listener_, OnNewSegment(_, _, _, _, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&release_listener](const std::string&, int64_t,
+                                                 int64_t, uint64_t, int64_t) {
+        release_listener.WaitForNotification();
+      }));
+
+  // Returns while the listener is blocked on the first segment.
+  listener_->OnNewSegment("segment1.m4s", 0, kSegmentDuration, kSegmentSize,
+                          1);
+  listener_->OnNewSegment("segment2.m4s", kSegmentDuration, kSegmentDuration,
+                          kSegmentSize, 2);
+  release_listener.Notify();
+  listener_->Flush();
+  ::testing::Mock::VerifyAndClearExpectations(mock_listener_);
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -79,6 +79,19 @@ void CombinedMuxerListener::OnNewSegment(const std::string& file_name,
   }
 }
 
+void CombinedMuxerListener::OnNewBundledSegment(const std::string& bundle_name,
+                                                int64_t start_time,
+                                                int64_t duration,
+                                                uint64_t start_byte_offset,
+                                                uint64_t segment_size,
+                                                int64_t segment_number) {
+  for (auto& listener : muxer_listeners_) {
+    listener->OnNewBundledSegment(bundle_name, start_time, duration,
+                                  start_byte_offset, segment_size,
+                                  segment_number);
+  }
+}
+
 void CombinedMuxerListener::OnCompletedSegment(int64_t duration,
                                                uint64_t segment_file_size) {
   for (auto& listener : muxer_listeners_) {
@@ -86,6 +99,23 @@ void CombinedMuxerListener::OnCompletedSegment(int64_t duration,
   }
 }
 
+void CombinedMuxerListener::OnNewChunk(int64_t start_time,
+                                       int64_t duration,
+                                       uint64_t start_byte_offset,
+                                       uint64_t size,
+                                       bool is_independent) {
+  for (auto& listener : muxer_listeners_) {
+    listener->OnNewChunk(start_time, duration, start_byte_offset, size,
+                         is_independent);
+  }
+}
+
+void CombinedMuxerListener::OnSegmentLatency(const SegmentLatency& latency) {
+  for (auto& listener : muxer_listeners_) {
+    listener->OnSegmentLatency(latency);
+  }
+}
+
 void CombinedMuxerListener::OnKeyFrame(int64_t timestamp,
                                        uint64_t start_byte_offset,
                                        uint64_t size) {
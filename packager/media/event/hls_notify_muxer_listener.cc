@@ -252,6 +252,10 @@ void HlsNotifyMuxerListener::OnNewSegment(const std::string& file_name,
     event_info.segment_info = {start_time, duration, segment_file_size,
                                segment_number};
     event_info_.push_back(event_info);
+  } else if (hls_notifier_->hls_params().low_latency_hls_mode) {
+    // Only the first chunk is written so far. The segment is notified in
+    // OnCompletedSegment().
+    low_latency_segment_ = LowLatencySegmentInfo{file_name, start_time};
   } else {
     // For multisegment, it always starts from the beginning of the file.
     const size_t kStartingByteOffset = 0u;
@@ -262,6 +266,44 @@ void HlsNotifyMuxerListener::OnNewSegment(const std::string& file_name,
   }
 }
 
+void HlsNotifyMuxerListener::OnNewBundledSegment(const std::string& bundle_name,
+                                                 int64_t start_time,
+                                                 int64_t duration,
+                                                 uint64_t start_byte_offset,
+                                                 uint64_t segment_size,
+                                                 int64_t segment_number) {
+  UNUSED(segment_number);
+  const bool result = hls_notifier_->NotifyNewSegment(
+      stream_id_.value(), bundle_name, start_time, duration, start_byte_offset,
+      segment_size);
+  LOG_IF(WARNING, !result) << "Failed to add new segment.";
+}
+
+void HlsNotifyMuxerListener::OnCompletedSegment(int64_t duration,
+                                                uint64_t segment_file_size) {
+  if (!low_latency_segment_)
+    return;
+  const bool result = hls_notifier_->NotifyNewSegment(
+      stream_id_.value(), low_latency_segment_->file_name,
+      low_latency_segment_->start_time, duration, 0, segment_file_size);
+  LOG_IF(WARNING, !result) << "Failed to add new segment.";
+  low_latency_segment_.reset();
+}
+
+void HlsNotifyMuxerListener::OnNewChunk(int64_t start_time,
+                                        int64_t duration,
+                                        uint64_t start_byte_offset,
+                                        uint64_t size,
+                                        bool is_independent) {
+  // I-Frames Only playlists do not have partial segments.
+  if (!low_latency_segment_ || iframes_only_)
+    return;
+  const bool result = hls_notifier_->NotifyNewPartialSegment(
+      stream_id_.value(), low_latency_segment_->file_name, start_time,
+      duration, start_byte_offset, size, is_independent);
+  LOG_IF(WARNING, !result) << "Failed to add new partial segment.";
+}
+
 void HlsNotifyMuxerListener::OnKeyFrame(int64_t timestamp,
                                         uint64_t start_byte_offset,
                                         uint64_t size) {
@@ -74,6 +74,19 @@ class HlsNotifyMuxerListener : public MuxerListener {
                     int64_t duration,
                     uint64_t segment_file_size,
                     int64_t segment_number) override;
+  void OnNewBundledSegment(const std::string& bundle_name,
+                           int64_t start_time,
+                           int64_t duration,
+                           uint64_t start_byte_offset,
+                           uint64_t segment_size,
+                           int64_t segment_number) override;
+  void OnCompletedSegment(int64_t duration,
+                          uint64_t segment_file_size) override;
+  void OnNewChunk(int64_t start_time,
+                  int64_t duration,
+                  uint64_t start_byte_offset,
+                  uint64_t size,
+                  bool is_independent) override;
   void OnKeyFrame(int64_t timestamp,
                   uint64_t start_byte_offset,
                   uint64_t size) override;
@@ -96,6 +109,14 @@ class HlsNotifyMuxerListener : public MuxerListener {
   std::optional<uint32_t> stream_id_;
   std::optional<uint32_t> index_;
 
+  // The low latency segment being written in LL-HLS mode. It is notified once
+  // complete, its chunks are notified as partial segments before that.
+  struct LowLatencySegmentInfo {
+    std::string file_name;
+    int64_t start_time;
+  };
+  std::optional<LowLatencySegmentInfo> low_latency_segment_;
+
   bool must_notify_encryption_start_ = false;
   // Cached encryption info before OnMediaStart() is called.
   std::vector<uint8_t> next_key_id_;
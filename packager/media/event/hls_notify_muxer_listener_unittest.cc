@@ -31,6 +31,8 @@ namespace {
 class MockHlsNotifier : public hls::HlsNotifier {
  public:
   MockHlsNotifier() : HlsNotifier(HlsParams()) {}
+  explicit MockHlsNotifier(const HlsParams& hls_params)
+      : HlsNotifier(hls_params) {}
 
   MOCK_METHOD0(Init, bool());
   MOCK_METHOD5(NotifyNewStream,
@@ -48,6 +50,14 @@ class MockHlsNotifier : public hls::HlsNotifier {
                     int64_t duration,
                     uint64_t start_byte_offset,
                     uint64_t size));
+  MOCK_METHOD7(NotifyNewPartialSegment,
+               bool(uint32_t stream_id,
+                    const std::string& segment_name,
+                    int64_t start_time,
+                    int64_t duration,
+                    uint64_t start_byte_offset,
+                    uint64_t size,
+                    bool independent));
   MOCK_METHOD4(NotifyKeyFrame,
                bool(uint32_t stream_id,
                     int64_t timestamp,
@@ -353,6 +363,55 @@ TEST_F(HlsNotifyMuxerListenerTest, OnNewSegmentAndCueEvent) {
                          kSegmentDuration, kSegmentSize, kAnySegmentNumber);
 }
 
+// Verify that in LL-HLS mode the chunks are notified as partial segments and
+// the segment is only notified once it is complete.
+TEST(HlsNotifyMuxerListenerLowLatencyTest, OnNewChunk) {
+  HlsParams hls_params;
+  hls_params.low_latency_hls_mode = true;
+  MockHlsNotifier mock_notifier(hls_params);
+  HlsNotifyMuxerListener listener(
+      kDefaultPlaylistName, !kIFramesOnlyPlaylist, kDefaultName,
+      kDefaultGroupId, std::vector<std::string>(), kForced, &mock_notifier, 0);
+
+  ON_CALL(mock_notifier, NotifyNewStream(_, _, _, _, _))
+      .WillByDefault(Return(true));
+  VideoStreamInfoParameters video_params = GetDefaultVideoStreamInfoParams();
+  std::shared_ptr<StreamInfo> video_stream_info =
+      CreateVideoStreamInfo(video_params);
+  MuxerOptions muxer_options;
+  muxer_options.segment_template = "$Number$.mp4";
+  listener.OnMediaStart(muxer_options, *video_stream_info, 90000,
+                        MuxerListener::kContainerMp4);
+
+  const int64_t kChunkDuration = kSegmentDuration / 2;
+  const uint64_t kChunkSize = kSegmentSize / 2;
+  const bool kIndependent = true;
+  {
+    InSequence s;
+    EXPECT_CALL(mock_notifier,
+                NotifyNewPartialSegment(_, StrEq("new_segment_name10.mp4"),
+                                        kSegmentStartTime, kChunkDuration, 0,
+                                        kChunkSize, kIndependent));
+    EXPECT_CALL(mock_notifier,
+                NotifyNewPartialSegment(
+                    _, StrEq("new_segment_name10.mp4"),
+                    kSegmentStartTime + kChunkDuration, kChunkDuration,
+                    kChunkSize, kSegmentSize - kChunkSize, !kIndependent));
+    EXPECT_CALL(mock_notifier,
+                NotifyNewSegment(_, StrEq("new_segment_name10.mp4"),
+                                 kSegmentStartTime, kSegmentDuration, 0,
+                                 kSegmentSize));
+  }
+
+  listener.OnNewSegment("new_segment_name10.mp4", kSegmentStartTime,
+                        kChunkDuration, kChunkSize, kAnySegmentNumber);
+  listener.OnNewChunk(kSegmentStartTime, kChunkDuration, 0, kChunkSize,
+                      kIndependent);
+  listener.OnNewChunk(kSegmentStartTime + kChunkDuration, kChunkDuration,
+                      kChunkSize, kSegmentSize - kChunkSize, !kIndependent);
+  listener.OnCompletedSegment(kSegmentDuration, kSegmentSize);
+}
+
 // Verify that the notifier is called for every segment in OnMediaEnd if
 // segment_template is not set.
 TEST_F(HlsNotifyMuxerListenerTest, NoSegmentTemplateOnMediaEnd) {
@@ -0,0 +1,643 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/event/manifest_aggregation.h>
+
+#include <algorithm>
+#include <random>
+#include <type_traits>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <absl/strings/escaping.h>
+#include <absl/strings/match.h>
+#include <absl/strings/str_format.h>
+#include <absl/strings/str_split.h>
+#include <nlohmann/json.hpp>
+
+#include <packager/file/file_closer.h>
+#include <packager/file/http_file.h>
+#include <packager/mpd/base/media_info.pb.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+// The most notifications sent in a request.
+const size_t kMaxBatchSize = 1024;
+// The delay before sending a batch again, which doubles up to the maximum.
+const absl::Duration kFirstRetryDelay = absl::Milliseconds(250);
+const absl::Duration kMaxRetryDelay = absl::Seconds(8);
+const int32_t kRequestTimeoutInSeconds = 10;
+
+std::string RandomSuffix() {
+  std::random_device random_device;
+  std::uniform_int_distribution<uint32_t> distribution;
+  return absl::StrFormat("%08x", distribution(random_device));
+}
+
+std::string ToBase64(const std::vector<uint8_t>& data) {
+  return absl::Base64Escape(std::string(data.begin(), data.end()));
+}
+
+std::string ToBase64(const MediaInfo& media_info) {
+  return absl::Base64Escape(media_info.SerializeAsString());
+}
+
+bool GetField(const nlohmann::json& event,
+              const char* name,
+              std::string* value) {
+  auto iter = event.find(name);
+  if (iter == event.end() || !iter->is_string())
+    return false;
+  *value = iter->get<std::string>();
+  return true;
+}
+
+bool GetField(const nlohmann::json& event, const char* name, bool* value) {
+  auto iter = event.find(name);
+  if (iter == event.end() || !iter->is_boolean())
+    return false;
+  *value = iter->get<bool>();
+  return true;
+}
+
+template <typename T,
+          typename = std::enable_if_t<std::is_integral<T>::value>>
+bool GetField(const nlohmann::json& event, const char* name, T* value) {
+  auto iter = event.find(name);
+  if (iter == event.end() || !iter->is_number_integer())
+    return false;
+  *value = iter->get<T>();
+  return true;
+}
+
+bool GetField(const nlohmann::json& event,
+              const char* name,
+              std::vector<uint8_t>* value) {
+  std::string base64;
+  std::string data;
+  if (!GetField(event, name, &base64) || !absl::Base64Unescape(base64, &data))
+    return false;
+  value->assign(data.begin(), data.end());
+  return true;
+}
+
+bool GetField(const nlohmann::json& event,
+              const char* name,
+              MediaInfo* value) {
+  std::string base64;
+  std::string data;
+  return GetField(event, name, &base64) &&
+         absl::Base64Unescape(base64, &data) && value->ParseFromString(data);
+}
+
+// Maps the id of a node in |event| to the id of a notifier.
+bool GetMappedId(const nlohmann::json& event,
+                 const std::map<uint32_t, uint32_t>& ids,
+                 uint32_t* id) {
+  uint32_t node_id = 0;
+  if (!GetField(event, "id", &node_id))
+    return false;
+  auto iter = ids.find(node_id);
+  if (iter == ids.end())
+    return false;
+  *id = iter->second;
+  return true;
+}
+
+}  // namespace
+
+ManifestEventSender::ManifestEventSender(const std::string& node_id,
+                                         SendFunction send_function)
+    : node_id_(node_id.empty() ? RandomSuffix()
+                               : node_id + "-" + RandomSuffix()),
+      send_function_(std::move(send_function)) {
+  thread_ = std::thread(&ManifestEventSender::Run, this);
+}
+
+ManifestEventSender::~ManifestEventSender() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopping_ = true;
+    events_available_.Signal();
+    if (!events_.empty()) {
+      LOG(WARNING) << events_.size()
+                   << " manifest notifications were not sent to the "
+                      "aggregator.";
+    }
+  }
+  thread_.join();
+}
+
+// static
+std::unique_ptr<ManifestEventSender> ManifestEventSender::Create(
+    const std::string& url,
+    const std::string& node_id) {
+  auto send = [url](const std::string& lines) {
+    std::unique_ptr<HttpFile, FileCloser> file(
+        new HttpFile(HttpMethod::kPost, url, "application/x-ndjson",
+                     std::vector<std::string>(), kRequestTimeoutInSeconds));
+    if (!file->Open())
+      return Status(error::HTTP_FAILURE, "Cannot open " + url);
+    if (file->Write(lines.data(), lines.size()) !=
+        static_cast<int64_t>(lines.size())) {
+      file->Abort();
+    }
+    return file.release()->CloseWithStatus();
+  };
+  return std::unique_ptr<ManifestEventSender>(
+      new ManifestEventSender(node_id, send));
+}
+
+void ManifestEventSender::Send(const std::string& event) {
+  DCHECK(event.size() >= 2 && event.front() == '{' && event.back() == '}');
+  absl::MutexLock lock(&mutex_);
+  // Prepend the node and the sequence number to the members of |event|.
+  std::string line = absl::StrFormat(
+      "{\"node\":%s,\"seq\":%d", nlohmann::json(node_id_).dump(), next_seq_++);
+  line.append(event.size() > 2 ? "," : "");
+  line.append(event, 1, std::string::npos);
+  events_.push_back(std::move(line));
+  events_available_.Signal();
+}
+
+bool ManifestEventSender::WaitUntilSent(absl::Duration timeout) {
+  const absl::Time deadline = absl::Now() + timeout;
+  absl::MutexLock lock(&mutex_);
+  while (!events_.empty()) {
+    if (events_sent_.WaitWithDeadline(&mutex_, deadline))
+      return events_.empty();
+  }
+  return true;
+}
+
+void ManifestEventSender::Run() {
+  absl::Duration retry_delay = kFirstRetryDelay;
+  while (true) {
+    std::string lines;
+    {
+      absl::MutexLock lock(&mutex_);
+      while (events_.empty() && !stopping_)
+        events_available_.Wait(&mutex_);
+      if (stopping_)
+        return;
+      num_events_in_flight_ = std::min(events_.size(), kMaxBatchSize);
+      for (size_t i = 0; i < num_events_in_flight_; ++i)
+        lines += events_[i] + "\n";
+    }
+
+    const Status status = send_function_(lines);
+
+    absl::MutexLock lock(&mutex_);
+    if (status.ok()) {
+      events_.erase(events_.begin(), events_.begin() + num_events_in_flight_);
+      num_events_in_flight_ = 0;
+      retry_delay = kFirstRetryDelay;
+      events_sent_.SignalAll();
+      continue;
+    }
+    LOG(WARNING) << "Failed to send " << num_events_in_flight_
+                 << " manifest notifications to the aggregator, retrying in "
+                 << retry_delay << ": " << status;
+    const absl::Time deadline = absl::Now() + retry_delay;
+    while (!stopping_ && absl::Now() < deadline)
+      events_available_.WaitWithDeadline(&mutex_, deadline);
+    retry_delay = std::min(retry_delay * 2, kMaxRetryDelay);
+  }
+}
+
+RemoteMpdNotifier::RemoteMpdNotifier(const MpdOptions& mpd_options,
+                                     ManifestEventSender* sender)
+    : MpdNotifier(mpd_options), sender_(sender) {
+  DCHECK(sender_);
+}
+
+RemoteMpdNotifier::~RemoteMpdNotifier() {}
+
+bool RemoteMpdNotifier::Init() {
+  return true;
+}
+
+bool RemoteMpdNotifier::NotifyNewContainer(const MediaInfo& media_info,
+                                           uint32_t* container_id) {
+  {
+    absl::MutexLock lock(&mutex_);
+    *container_id = next_container_id_++;
+  }
+  sender_->Send(nlohmann::json({{"event", "mpd.new_container"},
+                                {"id", *container_id},
+                                {"media_info", ToBase64(media_info)}})
+                    .dump());
+  return true;
+}
+
+bool RemoteMpdNotifier::NotifyAvailabilityTimeOffset(uint32_t container_id) {
+  sender_->Send(nlohmann::json(
+                    {{"event", "mpd.availability_time_offset"},
+                     {"id", container_id}})
+                    .dump());
+  return true;
+}
+
+bool RemoteMpdNotifier::NotifySampleDuration(uint32_t container_id,
+                                             int32_t sample_duration) {
+  sender_->Send(nlohmann::json({{"event", "mpd.sample_duration"},
+                                {"id", container_id},
+                                {"sample_duration", sample_duration}})
+                    .dump());
+  return true;
+}
+
+bool RemoteMpdNotifier::NotifySegmentDuration(uint32_t container_id) {
+  sender_->Send(
+      nlohmann::json({{"event", "mpd.segment_duration"}, {"id", container_id}})
+          .dump());
+  return true;
+}
+
+bool RemoteMpdNotifier::NotifyNewSegment(uint32_t container_id,
+                                         int64_t start_time,
+                                         int64_t duration,
+                                         uint64_t size,
+                                         int64_t segment_number) {
+  sender_->Send(nlohmann::json({{"event", "mpd.new_segment"},
+                                {"id", container_id},
+                                {"start_time", start_time},
+                                {"duration", duration},
+                                {"size", size},
+                                {"number", segment_number}})
+                    .dump());
+  return true;
+}
+
+bool RemoteMpdNotifier::NotifyNewBundledSegment(uint32_t container_id,
+                                                int64_t start_time,
+                                                int64_t duration,
+                                                uint64_t start_byte_offset,
+                                                uint64_t size,
+                                                int64_t segment_number) {
+  sender_->Send(nlohmann::json({{"event", "mpd.new_bundled_segment"},
+                                {"id", container_id},
+                                {"start_time", start_time},
+                                {"duration", duration},
+                                {"offset", start_byte_offset},
+                                {"size", size},
+                                {"number", segment_number}})
+                    .dump());
+  return true;
+}
+
+bool RemoteMpdNotifier::NotifyCompletedSegment(uint32_t container_id,
+                                               int64_t duration,
+                                               uint64_t size) {
+  sender_->Send(nlohmann::json({{"event", "mpd.completed_segment"},
+                                {"id", container_id},
+                                {"duration", duration},
+                                {"size", size}})
+                    .dump());
+  return true;
+}
+
+bool RemoteMpdNotifier::NotifyCueEvent(uint32_t container_id,
+                                       int64_t timestamp) {
+  sender_->Send(nlohmann::json({{"event", "mpd.cue"},
+                                {"id", container_id},
+                                {"timestamp", timestamp}})
+                    .dump());
+  return true;
+}
+
+bool RemoteMpdNotifier::NotifyEncryptionUpdate(
+    uint32_t container_id,
+    const std::string& drm_uuid,
+    const std::vector<uint8_t>& new_key_id,
+    const std::vector<uint8_t>& new_pssh) {
+  sender_->Send(nlohmann::json({{"event", "mpd.encryption_update"},
+                                {"id", container_id},
+                                {"drm_uuid", drm_uuid},
+                                {"key_id", ToBase64(new_key_id)},
+                                {"pssh", ToBase64(new_pssh)}})
+                    .dump());
+  return true;
+}
+
+bool RemoteMpdNotifier::NotifyMediaInfoUpdate(uint32_t container_id,
+                                              const MediaInfo& media_info) {
+  sender_->Send(nlohmann::json({{"event", "mpd.media_info_update"},
+                                {"id", container_id},
+                                {"media_info", ToBase64(media_info)}})
+                    .dump());
+  return true;
+}
+
+bool RemoteMpdNotifier::Flush() {
+  sender_->Send(nlohmann::json({{"event", "mpd.flush"}}).dump());
+  return true;
+}
+
+bool RemoteMpdNotifier::RequestFlush() {
+  sender_->Send(nlohmann::json({{"event", "mpd.request_flush"}}).dump());
+  return true;
+}
+
+RemoteHlsNotifier::RemoteHlsNotifier(const HlsParams& hls_params,
+                                     ManifestEventSender* sender)
+    : HlsNotifier(hls_params), sender_(sender) {
+  DCHECK(sender_);
+}
+
+RemoteHlsNotifier::~RemoteHlsNotifier() {}
+
+bool RemoteHlsNotifier::Init() {
+  return true;
+}
+
+bool RemoteHlsNotifier::NotifyNewStream(const MediaInfo& media_info,
+                                        const std::string& playlist_name,
+                                        const std::string& stream_name,
+                                        const std::string& group_id,
+                                        uint32_t* stream_id) {
+  {
+    absl::MutexLock lock(&mutex_);
+    *stream_id = next_stream_id_++;
+  }
+  sender_->Send(nlohmann::json({{"event", "hls.new_stream"},
+                                {"id", *stream_id},
+                                {"media_info", ToBase64(media_info)},
+                                {"playlist", playlist_name},
+                                {"name", stream_name},
+                                {"group", group_id}})
+                    .dump());
+  return true;
+}
+
+bool RemoteHlsNotifier::NotifySampleDuration(uint32_t stream_id,
+                                             int32_t sample_duration) {
+  sender_->Send(nlohmann::json({{"event", "hls.sample_duration"},
+                                {"id", stream_id},
+                                {"sample_duration", sample_duration}})
+                    .dump());
+  return true;
+}
+
+bool RemoteHlsNotifier::NotifyNewSegment(uint32_t stream_id,
+                                         const std::string& segment_name,
+                                         int64_t start_time,
+                                         int64_t duration,
+                                         uint64_t start_byte_offset,
+                                         uint64_t size) {
+  sender_->Send(nlohmann::json({{"event", "hls.new_segment"},
+                                {"id", stream_id},
+                                {"name", segment_name},
+                                {"start_time", start_time},
+                                {"duration", duration},
+                                {"offset", start_byte_offset},
+                                {"size", size}})
+                    .dump());
+  return true;
+}
+
+bool RemoteHlsNotifier::NotifyNewPartialSegment(
+    uint32_t stream_id,
+    const std::string& segment_name,
+    int64_t start_time,
+    int64_t duration,
+    uint64_t start_byte_offset,
+    uint64_t size,
+    bool independent) {
+  sender_->Send(nlohmann::json({{"event", "hls.new_partial_segment"},
+                                {"id", stream_id},
+                                {"name", segment_name},
+                                {"start_time", start_time},
+                                {"duration", duration},
+                                {"offset", start_byte_offset},
+                                {"size", size},
+                                {"independent", independent}})
+                    .dump());
+  return true;
+}
+
+bool RemoteHlsNotifier::NotifyKeyFrame(uint32_t stream_id,
+                                       int64_t timestamp,
+                                       uint64_t start_byte_offset,
+                                       uint64_t size) {
+  sender_->Send(nlohmann::json({{"event", "hls.key_frame"},
+                                {"id", stream_id},
+                                {"timestamp", timestamp},
+                                {"offset", start_byte_offset},
+                                {"size", size}})
+                    .dump());
+  return true;
+}
+
+bool RemoteHlsNotifier::NotifyCueEvent(uint32_t stream_id, int64_t timestamp) {
+  sender_->Send(nlohmann::json({{"event", "hls.cue"},
+                                {"id", stream_id},
+                                {"timestamp", timestamp}})
+                    .dump());
+  return true;
+}
+
+bool RemoteHlsNotifier::NotifyEncryptionUpdate(
+    uint32_t stream_id,
+    const std::vector<uint8_t>& key_id,
+    const std::vector<uint8_t>& system_id,
+    const std::vector<uint8_t>& iv,
+    const std::vector<uint8_t>& protection_system_specific_data) {
+  sender_->Send(
+      nlohmann::json({{"event", "hls.encryption_update"},
+                      {"id", stream_id},
+                      {"key_id", ToBase64(key_id)},
+                      {"system_id", ToBase64(system_id)},
+                      {"iv", ToBase64(iv)},
+                      {"data", ToBase64(protection_system_specific_data)}})
+          .dump());
+  return true;
+}
+
+bool RemoteHlsNotifier::Flush() {
+  sender_->Send(nlohmann::json({{"event", "hls.flush"}}).dump());
+  return true;
+}
+
+ManifestEventReplayer::ManifestEventReplayer(MpdNotifier* mpd_notifier,
+                                             hls::HlsNotifier* hls_notifier)
+    : mpd_notifier_(mpd_notifier), hls_notifier_(hls_notifier) {}
+
+ManifestEventReplayer::~ManifestEventReplayer() {}
+
+Status ManifestEventReplayer::Apply(const std::string& lines) {
+  absl::MutexLock lock(&mutex_);
+  for (absl::string_view line :
+       absl::StrSplit(lines, '\n', absl::SkipEmpty())) {
+    const nlohmann::json event =
+        nlohmann::json::parse(line, nullptr, false /* allow_exceptions */);
+    std::string node_id;
+    uint64_t seq = 0;
+    std::string name;
+    if (!event.is_object() || !GetField(event, "node", &node_id) ||
+        !GetField(event, "seq", &seq) || !GetField(event, "event", &name)) {
+      return Status(error::INVALID_ARGUMENT,
+                    "Invalid manifest notification: " + std::string(line));
+    }
+
+    Node& node = nodes_[node_id];
+    // Sent again after a request which failed on the side of the node.
+    if (seq < node.next_seq)
+      continue;
+    LOG_IF(WARNING, seq > node.next_seq)
+        << "Missed manifest notifications " << node.next_seq << " to "
+        << seq - 1 << " of " << node_id;
+    node.next_seq = seq + 1;
+
+    bool applied = false;
+    uint32_t id = 0;
+    MediaInfo media_info;
+    std::string text;
+    std::string text2;
+    std::string text3;
+    int64_t start_time = 0;
+    int64_t duration = 0;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    int64_t number = 0;
+    int32_t sample_duration = 0;
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> data2;
+    std::vector<uint8_t> data3;
+    std::vector<uint8_t> data4;
+    bool independent = false;
+
+    if (absl::StartsWith(name, "mpd.")) {
+      if (!mpd_notifier_)
+        continue;
+      if (name == "mpd.new_container") {
+        uint32_t node_container_id = 0;
+        applied = GetField(event, "id", &node_container_id) &&
+                  GetField(event, "media_info", &media_info) &&
+                  mpd_notifier_->NotifyNewContainer(media_info, &id);
+        if (applied)
+          node.container_ids[node_container_id] = id;
+      } else if (name == "mpd.availability_time_offset") {
+        applied = GetMappedId(event, node.container_ids, &id) &&
+                  mpd_notifier_->NotifyAvailabilityTimeOffset(id);
+      } else if (name == "mpd.sample_duration") {
+        applied = GetMappedId(event, node.container_ids, &id) &&
+                  GetField(event, "sample_duration", &sample_duration) &&
+                  mpd_notifier_->NotifySampleDuration(id, sample_duration);
+      } else if (name == "mpd.segment_duration") {
+        applied = GetMappedId(event, node.container_ids, &id) &&
+                  mpd_notifier_->NotifySegmentDuration(id);
+      } else if (name == "mpd.new_segment") {
+        applied = GetMappedId(event, node.container_ids, &id) &&
+                  GetField(event, "start_time", &start_time) &&
+                  GetField(event, "duration", &duration) &&
+                  GetField(event, "size", &size) &&
+                  GetField(event, "number", &number) &&
+                  mpd_notifier_->NotifyNewSegment(id, start_time, duration,
+                                                  size, number);
+      } else if (name == "mpd.new_bundled_segment") {
+        applied = GetMappedId(event, node.container_ids, &id) &&
+                  GetField(event, "start_time", &start_time) &&
+                  GetField(event, "duration", &duration) &&
+                  GetField(event, "offset", &offset) &&
+                  GetField(event, "size", &size) &&
+                  GetField(event, "number", &number) &&
+                  mpd_notifier_->NotifyNewBundledSegment(
+                      id, start_time, duration, offset, size, number);
+      } else if (name == "mpd.completed_segment") {
+        applied = GetMappedId(event, node.container_ids, &id) &&
+                  GetField(event, "duration", &duration) &&
+                  GetField(event, "size", &size) &&
+                  mpd_notifier_->NotifyCompletedSegment(id, duration, size);
+      } else if (name == "mpd.cue") {
+        applied = GetMappedId(event, node.container_ids, &id) &&
+                  GetField(event, "timestamp", &start_time) &&
+                  mpd_notifier_->NotifyCueEvent(id, start_time);
+      } else if (name == "mpd.encryption_update") {
+        applied = GetMappedId(event, node.container_ids, &id) &&
+                  GetField(event, "drm_uuid", &text) &&
+                  GetField(event, "key_id", &data) &&
+                  GetField(event, "pssh", &data2) &&
+                  mpd_notifier_->NotifyEncryptionUpdate(id, text, data, data2);
+      } else if (name == "mpd.media_info_update") {
+        applied = GetMappedId(event, node.container_ids, &id) &&
+                  GetField(event, "media_info", &media_info) &&
+                  mpd_notifier_->NotifyMediaInfoUpdate(id, media_info);
+      } else if (name == "mpd.flush") {
+        applied = mpd_notifier_->Flush();
+      } else if (name == "mpd.request_flush") {
+        applied = mpd_notifier_->RequestFlush();
+      }
+    } else if (absl::StartsWith(name, "hls.")) {
+      if (!hls_notifier_)
+        continue;
+      if (name == "hls.new_stream") {
+        uint32_t node_stream_id = 0;
+        applied = GetField(event, "id", &node_stream_id) &&
+                  GetField(event, "media_info", &media_info) &&
+                  GetField(event, "playlist", &text) &&
+                  GetField(event, "name", &text2) &&
+                  GetField(event, "group", &text3) &&
+                  hls_notifier_->NotifyNewStream(media_info, text, text2,
+                                                 text3, &id);
+        if (applied)
+          node.stream_ids[node_stream_id] = id;
+      } else if (name == "hls.sample_duration") {
+        applied = GetMappedId(event, node.stream_ids, &id) &&
+                  GetField(event, "sample_duration", &sample_duration) &&
+                  hls_notifier_->NotifySampleDuration(id, sample_duration);
+      } else if (name == "hls.new_segment") {
+        applied = GetMappedId(event, node.stream_ids, &id) &&
+                  GetField(event, "name", &text) &&
+                  GetField(event, "start_time", &start_time) &&
+                  GetField(event, "duration", &duration) &&
+                  GetField(event, "offset", &offset) &&
+                  GetField(event, "size", &size) &&
+                  hls_notifier_->NotifyNewSegment(id, text, start_time,
+                                                  duration, offset, size);
+      } else if (name == "hls.new_partial_segment") {
+        applied = GetMappedId(event, node.stream_ids, &id) &&
+                  GetField(event, "name", &text) &&
+                  GetField(event, "start_time", &start_time) &&
+                  GetField(event, "duration", &duration) &&
+                  GetField(event, "offset", &offset) &&
+                  GetField(event, "size", &size) &&
+                  GetField(event, "independent", &independent) &&
+                  hls_notifier_->NotifyNewPartialSegment(
+                      id, text, start_time, duration, offset, size,
+                      independent);
+      } else if (name == "hls.key_frame") {
+        applied = GetMappedId(event, node.stream_ids, &id) &&
+                  GetField(event, "timestamp", &start_time) &&
+                  GetField(event, "offset", &offset) &&
+                  GetField(event, "size", &size) &&
+                  hls_notifier_->NotifyKeyFrame(id, start_time, offset, size);
+      } else if (name == "hls.cue") {
+        applied = GetMappedId(event, node.stream_ids, &id) &&
+                  GetField(event, "timestamp", &start_time) &&
+                  hls_notifier_->NotifyCueEvent(id, start_time);
+      } else if (name == "hls.encryption_update") {
+        applied = GetMappedId(event, node.stream_ids, &id) &&
+                  GetField(event, "key_id", &data) &&
+                  GetField(event, "system_id", &data2) &&
+                  GetField(event, "iv", &data3) &&
+                  GetField(event, "data", &data4) &&
+                  hls_notifier_->NotifyEncryptionUpdate(id, data, data2, data3,
+                                                        data4);
+      } else if (name == "hls.flush") {
+        applied = hls_notifier_->Flush();
+      }
+    }
+    LOG_IF(WARNING, !applied) << "Failed to apply manifest notification "
+                              << line;
+  }
+  return Status::OK;
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,244 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// Distributed packaging: the packagers of a channel, the nodes, each package
+// some of its streams, and forward their manifest notifications to a single
+// aggregator, which writes the manifests of the streams of all the nodes.
+//
+// The notifications are sent as lines of JSON, each with the node, a sequence
+// number, the notification and its arguments, e.g.
+//   {"node":"edge1-5f0c9a2e","seq":12,"event":"mpd.new_segment","id":0,
+//    "start_time":540540,"duration":540540,"size":123456,"number":2}
+// MediaInfos and binary data are sent in base64.
+
+#ifndef PACKAGER_MEDIA_EVENT_MANIFEST_AGGREGATION_H_
+#define PACKAGER_MEDIA_EVENT_MANIFEST_AGGREGATION_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/time/time.h>
+
+#include <packager/hls/base/hls_notifier.h>
+#include <packager/mpd/base/mpd_notifier.h>
+#include <packager/status.h>
+
+namespace shaka {
+namespace media {
+
+/// Sends the manifest notifications of a node to the aggregator, in order,
+/// from a thread of its own. Unlike the segment events, no notification is
+/// dropped: the notifications which fail to be sent are sent again, and the
+/// aggregator skips those it has already applied.
+class ManifestEventSender {
+ public:
+  /// Sends a batch of lines of JSON.
+  using SendFunction = std::function<Status(const std::string& lines)>;
+
+  /// @param node_id identifies the node. A random suffix is appended, so that
+  ///        the notifications of a restarted node are told apart.
+  /// @param send_function sends the batches, from the thread of the sender.
+  ManifestEventSender(const std::string& node_id, SendFunction send_function);
+  /// Stops, dropping the notifications not sent yet.
+  ~ManifestEventSender();
+
+  /// @return A sender which POSTs the notifications to the aggregator at
+  ///         @a url.
+  static std::unique_ptr<ManifestEventSender> Create(
+      const std::string& url,
+      const std::string& node_id);
+
+  /// Queue a notification. Never blocks on I/O.
+  /// @param event is the serialized JSON object of the notification, to which
+  ///        the node and the sequence number are added.
+  void Send(const std::string& event);
+
+  /// Blocks until all the notifications queued are sent.
+  /// @return false if they are not all sent within @a timeout.
+  bool WaitUntilSent(absl::Duration timeout);
+
+  /// @return The node id, with its random suffix.
+  const std::string& node_id() const { return node_id_; }
+
+ private:
+  ManifestEventSender(const ManifestEventSender&) = delete;
+  ManifestEventSender& operator=(const ManifestEventSender&) = delete;
+
+  void Run();
+
+  const std::string node_id_;
+  const SendFunction send_function_;
+
+  absl::Mutex mutex_;
+  absl::CondVar events_available_;
+  absl::CondVar events_sent_;
+  // The lines of JSON not sent yet.
+  std::deque<std::string> events_ ABSL_GUARDED_BY(mutex_);
+  uint64_t next_seq_ ABSL_GUARDED_BY(mutex_) = 0;
+  // The number of events being sent, at the front of |events_|.
+  size_t num_events_in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool stopping_ ABSL_GUARDED_BY(mutex_) = false;
+
+  std::thread thread_;
+};
+
+/// An MpdNotifier which forwards the notifications to the aggregator. The
+/// VOD archive is not written, as the presentation only ends once all the
+/// nodes are done.
+class RemoteMpdNotifier : public MpdNotifier {
+ public:
+  /// @param sender must outlive the notifier.
+  RemoteMpdNotifier(const MpdOptions& mpd_options,
+                    ManifestEventSender* sender);
+  ~RemoteMpdNotifier() override;
+
+  /// @name MpdNotifier implementation overrides.
+  /// @{
+  bool Init() override;
+  bool NotifyNewContainer(const MediaInfo& media_info,
+                          uint32_t* container_id) override;
+  bool NotifyAvailabilityTimeOffset(uint32_t container_id) override;
+  bool NotifySampleDuration(uint32_t container_id,
+                            int32_t sample_duration) override;
+  bool NotifySegmentDuration(uint32_t container_id) override;
+  bool NotifyNewSegment(uint32_t container_id,
+                        int64_t start_time,
+                        int64_t duration,
+                        uint64_t size,
+                        int64_t segment_number) override;
+  bool NotifyNewBundledSegment(uint32_t container_id,
+                               int64_t start_time,
+                               int64_t duration,
+                               uint64_t start_byte_offset,
+                               uint64_t size,
+                               int64_t segment_number) override;
+  bool NotifyCompletedSegment(uint32_t container_id,
+                              int64_t duration,
+                              uint64_t size) override;
+  bool NotifyCueEvent(uint32_t container_id, int64_t timestamp) override;
+  bool NotifyEncryptionUpdate(uint32_t container_id,
+                              const std::string& drm_uuid,
+                              const std::vector<uint8_t>& new_key_id,
+                              const std::vector<uint8_t>& new_pssh) override;
+  bool NotifyMediaInfoUpdate(uint32_t container_id,
+                             const MediaInfo& media_info) override;
+  bool Flush() override;
+  bool RequestFlush() override;
+  /// @}
+
+ private:
+  RemoteMpdNotifier(const RemoteMpdNotifier&) = delete;
+  RemoteMpdNotifier& operator=(const RemoteMpdNotifier&) = delete;
+
+  ManifestEventSender* const sender_;
+  absl::Mutex mutex_;
+  uint32_t next_container_id_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+/// An HlsNotifier which forwards the notifications to the aggregator. The
+/// VOD archive is not written, as for RemoteMpdNotifier.
+class RemoteHlsNotifier : public hls::HlsNotifier {
+ public:
+  /// @param sender must outlive the notifier.
+  RemoteHlsNotifier(const HlsParams& hls_params, ManifestEventSender* sender);
+  ~RemoteHlsNotifier() override;
+
+  /// @name HlsNotifier implementation overrides.
+  /// @{
+  bool Init() override;
+  bool NotifyNewStream(const MediaInfo& media_info,
+                       const std::string& playlist_name,
+                       const std::string& stream_name,
+                       const std::string& group_id,
+                       uint32_t* stream_id) override;
+  bool NotifySampleDuration(uint32_t stream_id,
+                            int32_t sample_duration) override;
+  bool NotifyNewSegment(uint32_t stream_id,
+                        const std::string& segment_name,
+                        int64_t start_time,
+                        int64_t duration,
+                        uint64_t start_byte_offset,
+                        uint64_t size) override;
+  bool NotifyNewPartialSegment(uint32_t stream_id,
+                               const std::string& segment_name,
+                               int64_t start_time,
+                               int64_t duration,
+                               uint64_t start_byte_offset,
+                               uint64_t size,
+                               bool independent) override;
+  bool NotifyKeyFrame(uint32_t stream_id,
+                      int64_t timestamp,
+                      uint64_t start_byte_offset,
+                      uint64_t size) override;
+  bool NotifyCueEvent(uint32_t stream_id, int64_t timestamp) override;
+  bool NotifyEncryptionUpdate(
+      uint32_t stream_id,
+      const std::vector<uint8_t>& key_id,
+      const std::vector<uint8_t>& system_id,
+      const std::vector<uint8_t>& iv,
+      const std::vector<uint8_t>& protection_system_specific_data) override;
+  bool Flush() override;
+  /// @}
+
+ private:
+  RemoteHlsNotifier(const RemoteHlsNotifier&) = delete;
+  RemoteHlsNotifier& operator=(const RemoteHlsNotifier&) = delete;
+
+  ManifestEventSender* const sender_;
+  absl::Mutex mutex_;
+  uint32_t next_stream_id_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+/// Applies the notifications forwarded by the nodes to the notifiers of the
+/// aggregator, mapping the container and stream ids of each node to those of
+/// the notifiers.
+class ManifestEventReplayer {
+ public:
+  /// @param mpd_notifier is the notifier of the MPD, or null to ignore the
+  ///        MPD notifications. Must outlive the replayer.
+  /// @param hls_notifier is the notifier of the HLS playlists, or null to
+  ///        ignore the HLS notifications. Must outlive the replayer.
+  ManifestEventReplayer(MpdNotifier* mpd_notifier,
+                        hls::HlsNotifier* hls_notifier);
+  ~ManifestEventReplayer();
+
+  /// Apply a batch of notifications, lines of JSON. The notifications already
+  /// applied, sent again after a failed request, are skipped. A notification
+  /// which fails to be applied is logged and skipped, so that the node does
+  /// not send it forever.
+  /// @return an error if the batch is malformed.
+  Status Apply(const std::string& lines);
+
+ private:
+  struct Node {
+    uint64_t next_seq = 0;
+    // The ids of the node, to those of the notifiers.
+    std::map<uint32_t, uint32_t> container_ids;
+    std::map<uint32_t, uint32_t> stream_ids;
+  };
+
+  ManifestEventReplayer(const ManifestEventReplayer&) = delete;
+  ManifestEventReplayer& operator=(const ManifestEventReplayer&) = delete;
+
+  MpdNotifier* const mpd_notifier_;
+  hls::HlsNotifier* const hls_notifier_;
+
+  absl::Mutex mutex_;
+  std::map<std::string, Node> nodes_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_EVENT_MANIFEST_AGGREGATION_H_
@@ -0,0 +1,182 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/event/manifest_aggregation.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <packager/mpd/base/mock_mpd_notifier.h>
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Property;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+
+namespace shaka {
+namespace media {
+namespace {
+
+const int64_t kStartTime = 1000;
+const int64_t kDuration = 2000;
+const uint64_t kSize = 12345;
+const int64_t kSegmentNumber = 3;
+
+// Collects the batches sent, failing the first |num_failures|.
+class SendCollector {
+ public:
+  explicit SendCollector(int num_failures = 0) : num_failures_(num_failures) {}
+
+  ManifestEventSender::SendFunction function() {
+    return [this](const std::string& lines) {
+      absl::MutexLock lock(&mutex_);
+      ++num_requests_;
+      if (num_failures_ > 0) {
+        --num_failures_;
+        return Status(error::HTTP_FAILURE, "Failed");
+      }
+      lines_ += lines;
+      return Status::OK;
+    };
+  }
+
+  std::string lines() {
+    absl::MutexLock lock(&mutex_);
+    return lines_;
+  }
+
+  int num_requests() {
+    absl::MutexLock lock(&mutex_);
+    return num_requests_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  int num_failures_ ABSL_GUARDED_BY(mutex_);
+  int num_requests_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::string lines_ ABSL_GUARDED_BY(mutex_);
+};
+
+MediaInfo GetMediaInfo(const std::string& segment_template) {
+  MediaInfo media_info;
+  media_info.set_segment_template(segment_template);
+  media_info.mutable_video_info()->set_width(1280);
+  media_info.mutable_video_info()->set_height(720);
+  return media_info;
+}
+
+}  // namespace
+
+class ManifestAggregationTest : public ::testing::Test {
+ protected:
+  ManifestAggregationTest()
+      : mpd_notifier_(MpdOptions()), replayer_(&mpd_notifier_, nullptr) {}
+
+  // Forwards the notifications of a node, made by |notify|.
+  std::string Forward(ManifestEventSender* sender,
+                      SendCollector* collector,
+                      const std::function<void(MpdNotifier*)>& notify) {
+    RemoteMpdNotifier notifier(MpdOptions(), sender);
+    EXPECT_TRUE(notifier.Init());
+    notify(&notifier);
+    EXPECT_TRUE(sender->WaitUntilSent(absl::Seconds(10)));
+    return collector->lines();
+  }
+
+  MockMpdNotifier mpd_notifier_;
+  ManifestEventReplayer replayer_;
+};
+
+TEST_F(ManifestAggregationTest, MapsContainersOfNodes) {
+  SendCollector collector1;
+  ManifestEventSender sender1("node1", collector1.function());
+  SendCollector collector2;
+  ManifestEventSender sender2("node2", collector2.function());
+  EXPECT_NE(sender1.node_id(), sender2.node_id());
+
+  auto notify = [](MpdNotifier* notifier) {
+    uint32_t container_id = 0;
+    ASSERT_TRUE(notifier->NotifyNewContainer(
+        GetMediaInfo("video-$Number$.m4s"), &container_id));
+    EXPECT_EQ(0u, container_id);
+    ASSERT_TRUE(notifier->NotifyNewSegment(container_id, kStartTime,
+                                           kDuration, kSize, kSegmentNumber));
+    ASSERT_TRUE(notifier->Flush());
+  };
+  const std::string lines1 = Forward(&sender1, &collector1, notify);
+  const std::string lines2 = Forward(&sender2, &collector2, notify);
+
+  // Both nodes use container 0, which map to different containers.
+  EXPECT_CALL(mpd_notifier_,
+              NotifyNewContainer(Property(&MediaInfo::segment_template,
+                                          "video-$Number$.m4s"),
+                                 _))
+      .WillOnce(DoAll(SetArgPointee<1>(5), Return(true)))
+      .WillOnce(DoAll(SetArgPointee<1>(6), Return(true)));
+  EXPECT_CALL(mpd_notifier_, NotifyNewSegment(5, kStartTime, kDuration, kSize,
+                                              kSegmentNumber))
+      .WillOnce(Return(true));
+  EXPECT_CALL(mpd_notifier_, NotifyNewSegment(6, kStartTime, kDuration, kSize,
+                                              kSegmentNumber))
+      .WillOnce(Return(true));
+  EXPECT_CALL(mpd_notifier_, Flush()).Times(2).WillRepeatedly(Return(true));
+
+  ASSERT_TRUE(replayer_.Apply(lines1).ok());
+  ASSERT_TRUE(replayer_.Apply(lines2).ok());
+}
+
+TEST_F(ManifestAggregationTest, SkipsNotificationsAlreadyApplied) {
+  SendCollector collector;
+  ManifestEventSender sender("node", collector.function());
+  const std::string lines =
+      Forward(&sender, &collector, [](MpdNotifier* notifier) {
+        uint32_t container_id = 0;
+        ASSERT_TRUE(notifier->NotifyNewContainer(
+            GetMediaInfo("audio-$Number$.m4s"), &container_id));
+        ASSERT_TRUE(notifier->NotifyCueEvent(container_id, kStartTime));
+      });
+
+  EXPECT_CALL(mpd_notifier_, NotifyNewContainer(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(2), Return(true)));
+  EXPECT_CALL(mpd_notifier_, NotifyCueEvent(2, kStartTime))
+      .WillOnce(Return(true));
+
+  ASSERT_TRUE(replayer_.Apply(lines).ok());
+  // As when the response to the node is lost, and the batch is sent again.
+  ASSERT_TRUE(replayer_.Apply(lines).ok());
+}
+
+TEST_F(ManifestAggregationTest, ResendsFailedBatches) {
+  SendCollector collector(1);
+  ManifestEventSender sender("node", collector.function());
+  const std::string lines =
+      Forward(&sender, &collector, [](MpdNotifier* notifier) {
+        ASSERT_TRUE(notifier->Flush());
+      });
+  EXPECT_EQ(2, collector.num_requests());
+
+  EXPECT_CALL(mpd_notifier_, Flush()).WillOnce(Return(true));
+  ASSERT_TRUE(replayer_.Apply(lines).ok());
+}
+
+TEST_F(ManifestAggregationTest, IgnoresUnknownContainers) {
+  EXPECT_CALL(mpd_notifier_, NotifyNewSegment(_, _, _, _, _)).Times(0);
+  ASSERT_TRUE(replayer_
+                  .Apply("{\"node\":\"node\",\"seq\":0,"
+                         "\"event\":\"mpd.new_segment\",\"id\":0,"
+                         "\"start_time\":0,\"duration\":1,\"size\":1,"
+                         "\"number\":1}\n")
+                  .ok());
+}
+
+TEST_F(ManifestAggregationTest, RejectsMalformedNotifications) {
+  EXPECT_FALSE(replayer_.Apply("{\"event\":\"mpd.flush\"}\n").ok());
+  EXPECT_FALSE(replayer_.Apply("not json\n").ok());
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -63,6 +63,14 @@ class MockMuxerListener : public MuxerListener {
                     uint64_t segment_file_size,
                     int64_t segment_number));
 
+  MOCK_METHOD6(OnNewBundledSegment,
+               void(const std::string& bundle_name,
+                    int64_t start_time,
+                    int64_t duration,
+                    uint64_t start_byte_offset,
+                    uint64_t segment_size,
+                    int64_t segment_number));
+
   MOCK_METHOD3(OnKeyFrame,
                void(int64_t timestamp,
                     uint64_t start_byte_offset,
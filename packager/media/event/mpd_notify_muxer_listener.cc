@@ -209,7 +209,7 @@ void MpdNotifyMuxerListener::OnNewSegment(const std::string& file_name,
                                     duration, segment_file_size,
                                     segment_number);
     if (mpd_notifier_->mpd_type() == MpdType::kDynamic)
-      mpd_notifier_->Flush();
+      mpd_notifier_->RequestFlush();
   } else {
     EventInfo event_info;
     event_info.type = EventInfoType::kSegment;
@@ -219,6 +219,21 @@ void MpdNotifyMuxerListener::OnNewSegment(const std::string& file_name,
   }
 }
 
+void MpdNotifyMuxerListener::OnNewBundledSegment(const std::string& bundle_name,
+                                                 int64_t start_time,
+                                                 int64_t duration,
+                                                 uint64_t start_byte_offset,
+                                                 uint64_t segment_size,
+                                                 int64_t segment_number) {
+  UNUSED(bundle_name);
+  // Bundles only apply to segment templates, i.e. the live profile.
+  mpd_notifier_->NotifyNewBundledSegment(notification_id_.value(), start_time,
+                                         duration, start_byte_offset,
+                                         segment_size, segment_number);
+  if (mpd_notifier_->mpd_type() == MpdType::kDynamic)
+    mpd_notifier_->RequestFlush();
+}
+
 void MpdNotifyMuxerListener::OnCompletedSegment(int64_t duration,
                                                 uint64_t segment_file_size) {
   mpd_notifier_->NotifyCompletedSegment(notification_id_.value(), duration,
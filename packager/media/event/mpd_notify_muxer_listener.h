@@ -54,6 +54,12 @@ class MpdNotifyMuxerListener : public MuxerListener {
                     int64_t duration,
                     uint64_t segment_file_size,
                     int64_t segment_number) override;
+  void OnNewBundledSegment(const std::string& bundle_name,
+                           int64_t start_time,
+                           int64_t duration,
+                           uint64_t start_byte_offset,
+                           uint64_t segment_size,
+                           int64_t segment_number) override;
   void OnCompletedSegment(int64_t duration,
                           uint64_t segment_file_size) override;
   void OnKeyFrame(int64_t timestamp,
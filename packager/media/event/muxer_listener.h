@@ -9,6 +9,7 @@
 #ifndef PACKAGER_MEDIA_EVENT_MUXER_LISTENER_H_
 #define PACKAGER_MEDIA_EVENT_MUXER_LISTENER_H_
 
+#include <chrono>
 #include <cstdint>
 #include <optional>
 #include <string>
@@ -26,6 +27,23 @@ struct MuxerOptions;
 struct ProtectionSystemSpecificInfo;
 class StreamInfo;
 
+/// Wall-clock times of a segment on its way through the packager, for live
+/// latency accounting. Times which are not known are left at the epoch.
+struct SegmentLatency {
+  /// Start time of the segment, relative to the timescale specified by
+  /// MediaInfo passed to OnMediaStart().
+  int64_t start_time = 0;
+  /// When the first sample of the segment reached the chunking handler.
+  std::chrono::system_clock::time_point first_sample_time;
+  /// When the chunking handler ended the segment.
+  std::chrono::system_clock::time_point chunked_time;
+  /// When the encryption handler dispatched the last sample of the segment.
+  std::chrono::system_clock::time_point encrypted_time;
+  /// When the listeners, which update the manifests, returned from
+  /// OnNewSegment().
+  std::chrono::system_clock::time_point published_time;
+};
+
 /// MuxerListener is an event handler that can be registered to a muxer.
 /// A MuxerListener cannot be shared amongst muxer instances, in other words,
 /// every muxer instance either owns a unique MuxerListener instance.
@@ -140,6 +158,26 @@ class MuxerListener {
                             uint64_t segment_file_size,
                             int64_t segment_number) = 0;
 
+  /// Called instead of OnNewSegment() for a segment which was appended to a
+  /// bundle file with other segments, see
+  /// Mp4OutputParams::segment_bundle_duration_in_seconds. The bundle file
+  /// has been written and closed. Calls OnNewSegment() by default, which
+  /// suits the listeners which do not address the segment in the file.
+  /// @param bundle_name is the name of the bundle file.
+  /// @param start_byte_offset is the offset of the segment in the bundle.
+  /// @param segment_size is the segment size in bytes.
+  /// The other parameters are the same as for OnNewSegment().
+  virtual void OnNewBundledSegment(const std::string& bundle_name,
+                                   int64_t start_time,
+                                   int64_t duration,
+                                   uint64_t start_byte_offset,
+                                   uint64_t segment_size,
+                                   int64_t segment_number) {
+    UNUSED(start_byte_offset);
+    OnNewSegment(bundle_name, start_time, duration, segment_size,
+                 segment_number);
+  }
+
   /// Called when a segment has been muxed and the entire file has been written.
   /// For Low Latency only. Note that it should be called after OnNewSegment.
   /// When the low latency segment is initally added to the manifest, the size
@@ -152,6 +190,28 @@ class MuxerListener {
     UNUSED(segment_file_size);
   }
 
+  /// Called when a chunk of a low latency segment has been written. For Low
+  /// Latency only. The first chunk of a segment is notified after
+  /// OnNewSegment, and all the chunks are notified before OnCompletedSegment.
+  /// @param start_time is the start time of the chunk, relative to the
+  ///        timescale specified by MediaInfo passed to OnMediaStart().
+  /// @param duration is the duration of the chunk, relative to the timescale
+  ///        specified by MediaInfo passed to OnMediaStart().
+  /// @param start_byte_offset is the offset of the chunk in the segment file.
+  /// @param size is the chunk size in bytes.
+  /// @param is_independent is true if the chunk starts with a key frame.
+  virtual void OnNewChunk(int64_t start_time,
+                          int64_t duration,
+                          uint64_t start_byte_offset,
+                          uint64_t size,
+                          bool is_independent) {
+    UNUSED(start_time);
+    UNUSED(duration);
+    UNUSED(start_byte_offset);
+    UNUSED(size);
+    UNUSED(is_independent);
+  }
+
   /// Called when there is a new key frame. For Video only. Note that it should
   /// be called before OnNewSegment is called on the containing segment.
   /// @param timestamp is in terms of the timescale of the media.
@@ -161,6 +221,14 @@ class MuxerListener {
                           uint64_t start_byte_offset,
                           uint64_t size) = 0;
 
+  /// Called after OnNewSegment() with the times the segment went through the
+  /// packager. The segment file is fully written, or uploaded, when
+  /// OnNewSegment() is called.
+  /// @param latency contains the times of the segment.
+  virtual void OnSegmentLatency(const SegmentLatency& latency) {
+    UNUSED(latency);
+  }
+
   /// Called when there is a new Ad Cue, which should align with (sub)segments.
   /// @param timestamp indicate the cue timestamp.
   /// @param cue_data is the data of the cue.
@@ -13,26 +13,44 @@
 #include <absl/strings/str_format.h>
 
 #include <packager/hls/base/hls_notifier.h>
+#include <packager/media/event/async_muxer_listener.h>
 #include <packager/media/event/combined_muxer_listener.h>
 #include <packager/media/event/hls_notify_muxer_listener.h>
 #include <packager/media/event/mpd_notify_muxer_listener.h>
 #include <packager/media/event/multi_codec_muxer_listener.h>
 #include <packager/media/event/muxer_listener.h>
+#include <packager/media/event/progress_muxer_listener.h>
+#include <packager/media/event/segment_event_muxer_listener.h>
+#include <packager/media/event/segment_index_muxer_listener.h>
+#include <packager/media/event/segment_latency_muxer_listener.h>
 #include <packager/media/event/vod_media_info_dump_muxer_listener.h>
 #include <packager/mpd/base/mpd_notifier.h>
 
 namespace shaka {
 namespace media {
 namespace {
-const char kMediaInfoSuffix[] = ".media_info";
-
 std::unique_ptr<MuxerListener> CreateMediaInfoDumpListenerInternal(
     const std::string& output,
+    bool output_media_info,
+    MediaInfoFormat format,
+    const std::function<void(const std::string&, const MediaInfo&)>& callback,
     bool use_segment_list) {
   DCHECK(!output.empty());
 
-  std::unique_ptr<MuxerListener> listener(
-      new VodMediaInfoDumpMuxerListener(output + kMediaInfoSuffix, use_segment_list));
+  const std::string output_file_name =
+      output_media_info
+          ? output + VodMediaInfoDumpMuxerListener::GetMediaInfoFileSuffix(
+                         format)
+          : "";
+  auto listener = std::make_unique<VodMediaInfoDumpMuxerListener>(
+      output_file_name, use_segment_list);
+  listener->set_media_info_format(format);
+  if (callback) {
+    listener->set_media_info_callback(
+        [callback, output](const MediaInfo& media_info) {
+          callback(output, media_info);
+        });
+  }
   return listener;
 }
 
@@ -89,10 +107,12 @@ std::list<std::unique_ptr<MuxerListener>> CreateHlsListenersInternal(
 MuxerListenerFactory::MuxerListenerFactory(bool output_media_info,
                                            bool use_segment_list,
                                            MpdNotifier* mpd_notifier,
-                                           hls::HlsNotifier* hls_notifier)
+                                           hls::HlsNotifier* hls_notifier,
+                                           SegmentLatencyLog* segment_latency_log)
     : output_media_info_(output_media_info),
       mpd_notifier_(mpd_notifier),
       hls_notifier_(hls_notifier),
+      segment_latency_log_(segment_latency_log),
       use_segment_list_(use_segment_list) {}
 
 std::unique_ptr<MuxerListener> MuxerListenerFactory::CreateListener(
@@ -110,21 +130,41 @@ std::unique_ptr<MuxerListener> MuxerListenerFactory::CreateListener(
   for (int i = 0; i < 2; i++) {
     std::unique_ptr<CombinedMuxerListener> combined_listener(
         new CombinedMuxerListener);
-    if (output_media_info_) {
+    // Added first so that the segments are stamped as flushed before the
+    // manifests are updated. Only one child logs the latencies of the stream.
+    if (segment_latency_log_ && i == 0) {
+      combined_listener->AddListener(
+          std::make_unique<SegmentLatencyMuxerListener>(segment_latency_log_));
+    }
+    if (segment_event_publisher_ && i == 0) {
+      combined_listener->AddListener(
+          std::make_unique<SegmentEventMuxerListener>(
+              segment_event_publisher_));
+    }
+    if (progress_tracker_ && i == 0) {
       combined_listener->AddListener(
-          CreateMediaInfoDumpListenerInternal(stream.media_info_output,
-                                              use_segment_list_));
+          std::make_unique<ProgressMuxerListener>(progress_tracker_));
+    }
+    if (output_segment_index_ && i == 0) {
+      combined_listener->AddListener(
+          std::make_unique<SegmentIndexMuxerListener>());
+    }
+    if (output_media_info_ || media_info_callback_) {
+      combined_listener->AddListener(
+          MaybeAsync(CreateMediaInfoDumpListenerInternal(
+              stream.media_info_output, output_media_info_, media_info_format_,
+              media_info_callback_, use_segment_list_)));
     }
 
     if (mpd_notifier_ && !stream.hls_only) {
       combined_listener->AddListener(
-          CreateMpdListenerInternal(stream, mpd_notifier_));
+          MaybeAsync(CreateMpdListenerInternal(stream, mpd_notifier_)));
     }
 
     if (hls_notifier_ && !stream.dash_only) {
       for (auto& listener :
            CreateHlsListenersInternal(stream, stream_index, hls_notifier_)) {
-        combined_listener->AddListener(std::move(listener));
+        combined_listener->AddListener(MaybeAsync(std::move(listener)));
       }
     }
 
@@ -134,6 +174,13 @@ std::unique_ptr<MuxerListener> MuxerListenerFactory::CreateListener(
   return multi_codec_listener;
 }
 
+std::unique_ptr<MuxerListener> MuxerListenerFactory::MaybeAsync(
+    std::unique_ptr<MuxerListener> listener) {
+  if (!async_notifications_)
+    return listener;
+  return std::make_unique<AsyncMuxerListener>(std::move(listener));
+}
+
 std::unique_ptr<MuxerListener> MuxerListenerFactory::CreateHlsListener(
     const StreamData& stream) {
   if (!hls_notifier_) {
@@ -7,11 +7,14 @@
 #ifndef PACKAGER_MEDIA_EVENT_MUXER_LISTENER_FACTORY_H_
 #define PACKAGER_MEDIA_EVENT_MUXER_LISTENER_FACTORY_H_
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include <packager/packager.h>
+
 namespace shaka {
 class MpdNotifier;
 
@@ -21,6 +24,9 @@ class HlsNotifier;
 
 namespace media {
 class MuxerListener;
+class ProgressTracker;
+class SegmentEventPublisher;
+class SegmentLatencyLog;
 
 /// Factory class for creating MuxerListeners. Will produce a single muxer
 /// listener that will wrap the various muxer listeners that the factory
@@ -73,25 +79,81 @@ class MuxerListenerFactory {
   ///        mpd listener.
   /// @param hls_notifier must be non-null for the combined listener to include
   ///        an HLS listener.
+  /// @param segment_latency_log must be non-null for the combined listener to
+  ///        include a segment latency listener.
   MuxerListenerFactory(bool output_media_info,
                        bool use_segment_list,
                        MpdNotifier* mpd_notifier,
-                       hls::HlsNotifier* hls_notifier);
+                       hls::HlsNotifier* hls_notifier,
+                       SegmentLatencyLog* segment_latency_log);
 
   /// Create a listener for a stream.
   std::unique_ptr<MuxerListener> CreateListener(const StreamData& stream);
 
+  /// Set the format of the media info files. Defaults to text.
+  void set_media_info_format(MediaInfoFormat format) {
+    media_info_format_ = format;
+  }
+
+  /// Set a callback which receives the MediaInfo of the streams, with the
+  /// media info output of the stream. If set, the combined listener includes
+  /// a media info dump listener even if output_media_info is false.
+  void set_media_info_callback(
+      std::function<void(const std::string&, const MediaInfo&)> callback) {
+    media_info_callback_ = std::move(callback);
+  }
+
+  /// Set whether the combined listener includes a segment index listener,
+  /// which indexes the segments of the single-file outputs.
+  void set_output_segment_index(bool output_segment_index) {
+    output_segment_index_ = output_segment_index;
+  }
+
+  /// Set whether the manifest listeners, i.e. the MPD, HLS and media info
+  /// dump listeners, receive the events from a thread of the pool rather than
+  /// from the muxer thread, so that the muxers do not wait for the manifest
+  /// updates. The events of a listener keep their order.
+  void set_async_notifications(bool async_notifications) {
+    async_notifications_ = async_notifications;
+  }
+
+  /// Set a publisher of segment events. If set, the combined listener
+  /// includes a segment event listener. It must outlive the listeners.
+  void set_segment_event_publisher(SegmentEventPublisher* publisher) {
+    segment_event_publisher_ = publisher;
+  }
+
+  /// Set a tracker of the progress of the packager. If set, the combined
+  /// listener includes a listener counting the bytes of the segments written.
+  /// It must outlive the listeners.
+  void set_progress_tracker(ProgressTracker* progress_tracker) {
+    progress_tracker_ = progress_tracker;
+  }
+
   /// Create an HLS listener if possible. If it is not possible to
   /// create an HLS listener, this method will return null.
   std::unique_ptr<MuxerListener> CreateHlsListener(const StreamData& stream);
 
  private:
+  // Wraps |listener| in an AsyncMuxerListener if the notifications are
+  // asynchronous.
+  std::unique_ptr<MuxerListener> MaybeAsync(
+      std::unique_ptr<MuxerListener> listener);
+
   MuxerListenerFactory(const MuxerListenerFactory&) = delete;
   MuxerListenerFactory operator=(const MuxerListenerFactory&) = delete;
 
   bool output_media_info_;
+  MediaInfoFormat media_info_format_ = MediaInfoFormat::kText;
+  std::function<void(const std::string&, const MediaInfo&)>
+      media_info_callback_;
   MpdNotifier* mpd_notifier_;
   hls::HlsNotifier* hls_notifier_;
+  SegmentLatencyLog* segment_latency_log_;
+  SegmentEventPublisher* segment_event_publisher_ = nullptr;
+  ProgressTracker* progress_tracker_ = nullptr;
+  bool output_segment_index_ = false;
+  bool async_notifications_ = false;
 
   /// This is set when mpd_notifier_ is NULL and --output_media_info is set.
   bool use_segment_list_;
@@ -16,6 +16,7 @@
 #include <packager/macros/logging.h>
 #include <packager/media/base/audio_stream_info.h>
 #include <packager/media/base/muxer_options.h>
+#include <packager/media/base/muxer_util.h>
 #include <packager/media/base/protection_system_specific_info.h>
 #include <packager/media/base/text_stream_info.h>
 #include <packager/media/base/video_stream_info.h>
@@ -222,6 +223,10 @@ void SetMediaInfoMuxerOptions(const MuxerOptions& muxer_options,
     if (!muxer_options.output_file_name.empty())
       media_info->set_init_segment_name(muxer_options.output_file_name);
     media_info->set_segment_template(muxer_options.segment_template);
+    if (media_info->container_type() == MediaInfo::CONTAINER_MP4 &&
+        BundlesMp4Segments(muxer_options)) {
+      media_info->set_segments_bundled(true);
+    }
   }
 }
 
@@ -254,9 +259,9 @@ bool GenerateMediaInfo(const MuxerOptions& muxer_options,
                        MediaInfo* media_info) {
   DCHECK(media_info);
 
+  SetMediaInfoContainerType(container_type, media_info);
   SetMediaInfoMuxerOptions(muxer_options, media_info);
   SetMediaInfoStreamInfo(stream_info, media_info);
-  SetMediaInfoContainerType(container_type, media_info);
   if (reference_time_scale > 0)
     media_info->set_reference_time_scale(reference_time_scale);
   if (muxer_options.bandwidth > 0)
@@ -0,0 +1,102 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/event/progress_muxer_listener.h>
+
+#include <absl/log/check.h>
+
+#include <packager/macros/compiler.h>
+#include <packager/media/base/progress_tracker.h>
+
+namespace shaka {
+namespace media {
+
+ProgressMuxerListener::ProgressMuxerListener(ProgressTracker* progress_tracker)
+    : progress_tracker_(progress_tracker) {
+  DCHECK(progress_tracker_);
+}
+
+ProgressMuxerListener::~ProgressMuxerListener() {}
+
+void ProgressMuxerListener::OnEncryptionInfoReady(
+    bool is_initial_encryption_info,
+    FourCC protection_scheme,
+    const std::vector<uint8_t>& key_id,
+    const std::vector<uint8_t>& iv,
+    const std::vector<ProtectionSystemSpecificInfo>& key_system_info) {
+  UNUSED(is_initial_encryption_info);
+  UNUSED(protection_scheme);
+  UNUSED(key_id);
+  UNUSED(iv);
+  UNUSED(key_system_info);
+}
+
+void ProgressMuxerListener::OnEncryptionStart() {}
+
+void ProgressMuxerListener::OnMediaStart(const MuxerOptions& muxer_options,
+                                         const StreamInfo& stream_info,
+                                         int32_t time_scale,
+                                         ContainerType container_type) {
+  UNUSED(muxer_options);
+  UNUSED(stream_info);
+  UNUSED(time_scale);
+  UNUSED(container_type);
+}
+
+void ProgressMuxerListener::OnSampleDurationReady(int32_t sample_duration) {
+  UNUSED(sample_duration);
+}
+
+void ProgressMuxerListener::OnMediaEnd(const MediaRanges& media_ranges,
+                                       float duration_seconds) {
+  UNUSED(media_ranges);
+  UNUSED(duration_seconds);
+}
+
+void ProgressMuxerListener::OnNewSegment(const std::string& file_name,
+                                         int64_t start_time,
+                                         int64_t duration,
+                                         uint64_t segment_file_size,
+                                         int64_t segment_number) {
+  UNUSED(file_name);
+  UNUSED(start_time);
+  UNUSED(duration);
+  UNUSED(segment_number);
+  progress_tracker_->AddOutputBytes(segment_file_size);
+  progress_tracker_->MaybeReport();
+}
+
+void ProgressMuxerListener::OnNewBundledSegment(const std::string& bundle_name,
+                                                int64_t start_time,
+                                                int64_t duration,
+                                                uint64_t start_byte_offset,
+                                                uint64_t segment_size,
+                                                int64_t segment_number) {
+  UNUSED(bundle_name);
+  UNUSED(start_time);
+  UNUSED(duration);
+  UNUSED(start_byte_offset);
+  UNUSED(segment_number);
+  progress_tracker_->AddOutputBytes(segment_size);
+  progress_tracker_->MaybeReport();
+}
+
+void ProgressMuxerListener::OnKeyFrame(int64_t timestamp,
+                                       uint64_t start_byte_offset,
+                                       uint64_t size) {
+  UNUSED(timestamp);
+  UNUSED(start_byte_offset);
+  UNUSED(size);
+}
+
+void ProgressMuxerListener::OnCueEvent(int64_t timestamp,
+                                       const std::string& cue_data) {
+  UNUSED(timestamp);
+  UNUSED(cue_data);
+}
+
+}  // namespace media
+}  // namespace shaka
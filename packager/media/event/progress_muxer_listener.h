@@ -0,0 +1,75 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// Implementation of MuxerListener that counts the bytes of the segments
+// written in the progress of the packager.
+
+#ifndef PACKAGER_MEDIA_EVENT_PROGRESS_MUXER_LISTENER_H_
+#define PACKAGER_MEDIA_EVENT_PROGRESS_MUXER_LISTENER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <packager/media/event/muxer_listener.h>
+
+namespace shaka {
+namespace media {
+
+class ProgressTracker;
+
+/// Adds the size of each segment of a stream to the output bytes of a
+/// ProgressTracker, once the segment is written, and lets the tracker report.
+class ProgressMuxerListener : public MuxerListener {
+ public:
+  /// @param progress_tracker must outlive the listener.
+  explicit ProgressMuxerListener(ProgressTracker* progress_tracker);
+  ~ProgressMuxerListener() override;
+
+  /// @name MuxerListener implementation overrides.
+  /// @{
+  void OnEncryptionInfoReady(bool is_initial_encryption_info,
+                             FourCC protection_scheme,
+                             const std::vector<uint8_t>& key_id,
+                             const std::vector<uint8_t>& iv,
+                             const std::vector<ProtectionSystemSpecificInfo>&
+                                 key_system_info) override;
+  void OnEncryptionStart() override;
+  void OnMediaStart(const MuxerOptions& muxer_options,
+                    const StreamInfo& stream_info,
+                    int32_t time_scale,
+                    ContainerType container_type) override;
+  void OnSampleDurationReady(int32_t sample_duration) override;
+  void OnMediaEnd(const MediaRanges& media_ranges,
+                  float duration_seconds) override;
+  void OnNewSegment(const std::string& file_name,
+                    int64_t start_time,
+                    int64_t duration,
+                    uint64_t segment_file_size,
+                    int64_t segment_number) override;
+  void OnNewBundledSegment(const std::string& bundle_name,
+                           int64_t start_time,
+                           int64_t duration,
+                           uint64_t start_byte_offset,
+                           uint64_t segment_size,
+                           int64_t segment_number) override;
+  void OnKeyFrame(int64_t timestamp,
+                  uint64_t start_byte_offset,
+                  uint64_t size) override;
+  void OnCueEvent(int64_t timestamp, const std::string& cue_data) override;
+  /// @}
+
+ private:
+  ProgressMuxerListener(const ProgressMuxerListener&) = delete;
+  ProgressMuxerListener& operator=(const ProgressMuxerListener&) = delete;
+
+  ProgressTracker* const progress_tracker_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_EVENT_PROGRESS_MUXER_LISTENER_H_
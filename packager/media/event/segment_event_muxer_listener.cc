@@ -0,0 +1,255 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/event/segment_event_muxer_listener.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <absl/strings/match.h>
+#include <absl/time/time.h>
+#include <nlohmann/json.hpp>
+
+#include <packager/file.h>
+#include <packager/file/http_file.h>
+#include <packager/macros/compiler.h>
+#include <packager/media/base/muxer_options.h>
+#include <packager/media/base/stream_info.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+// Events published while this many are queued are dropped.
+const size_t kMaxQueuedEvents = 4096;
+// The most events sent in a request.
+const size_t kMaxBatchSize = 256;
+// A request waits this long after its first event for more events.
+const absl::Duration kMaxBatchDelay = absl::Milliseconds(20);
+const int32_t kRequestTimeoutInSeconds = 10;
+
+}  // namespace
+
+SegmentEventPublisher::~SegmentEventPublisher() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopping_ = true;
+    events_available_.Signal();
+    if (num_dropped_events_ > 0) {
+      LOG(WARNING) << num_dropped_events_ << " segment events to " << url_
+                   << " were dropped.";
+    }
+  }
+  if (thread_.joinable())
+    thread_.join();
+}
+
+Status SegmentEventPublisher::Open(const std::string& url) {
+  DCHECK(!thread_.joinable());
+  url_ = url;
+  if (absl::StartsWith(url, kUdpFilePrefix)) {
+    // The events are not MPEG-TS, so they are sent as they are written.
+    const std::string udp_url =
+        url + (url.find('?') == std::string::npos ? "?" : "&") + "pacing=0";
+    udp_file_.reset(File::OpenWithNoBuffering(udp_url.c_str(), "w"));
+    if (!udp_file_) {
+      return Status(error::FILE_FAILURE,
+                    "Cannot open segment event socket " + url);
+    }
+  } else if (absl::StartsWith(url, kHttpFilePrefix) ||
+             absl::StartsWith(url, "https://")) {
+    batched_ = true;
+  } else {
+    return Status(error::INVALID_ARGUMENT,
+                  "Segment events can only be sent to udp://, http:// or "
+                  "https:// URLs, not " +
+                      url);
+  }
+  thread_ = std::thread(&SegmentEventPublisher::Run, this);
+  return Status::OK;
+}
+
+void SegmentEventPublisher::Publish(std::string event) {
+  absl::MutexLock lock(&mutex_);
+  if (events_.size() >= kMaxQueuedEvents) {
+    if (num_dropped_events_++ == 0) {
+      LOG(WARNING) << "Dropping segment events, as " << url_
+                   << " does not keep up.";
+    }
+    return;
+  }
+  events_.push_back(std::move(event));
+  events_available_.Signal();
+}
+
+void SegmentEventPublisher::Run() {
+  while (true) {
+    std::vector<std::string> events;
+    {
+      absl::MutexLock lock(&mutex_);
+      while (events_.empty() && !stopping_)
+        events_available_.Wait(&mutex_);
+      if (events_.empty())
+        return;
+      if (batched_) {
+        const absl::Time deadline = absl::Now() + kMaxBatchDelay;
+        while (events_.size() < kMaxBatchSize && !stopping_ &&
+               !events_available_.WaitWithDeadline(&mutex_, deadline)) {
+        }
+      }
+      const size_t num_events =
+          batched_ ? std::min(events_.size(), kMaxBatchSize) : events_.size();
+      for (size_t i = 0; i < num_events; ++i) {
+        events.push_back(std::move(events_.front()));
+        events_.pop_front();
+      }
+    }
+    Send(events);
+  }
+}
+
+void SegmentEventPublisher::Send(const std::vector<std::string>& events) {
+  if (!batched_) {
+    // Each event is flushed as a datagram of its own.
+    for (const std::string& event : events) {
+      const std::string line = event + "\n";
+      if (udp_file_->Write(line.data(), line.size()) !=
+              static_cast<int64_t>(line.size()) ||
+          !udp_file_->Flush()) {
+        LOG(WARNING) << "Failed to send segment event to " << url_;
+      }
+    }
+    return;
+  }
+
+  std::string body;
+  for (const std::string& event : events)
+    body += event + "\n";
+  std::unique_ptr<HttpFile, FileCloser> file(
+      new HttpFile(HttpMethod::kPost, url_, "application/x-ndjson",
+                   std::vector<std::string>(), kRequestTimeoutInSeconds));
+  if (!file->Open()) {
+    LOG(WARNING) << "Cannot open " << url_ << " to send segment events.";
+    return;
+  }
+  file->Write(body.data(), body.size());
+  const Status status = file.release()->CloseWithStatus();
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to send segment events to " << url_ << ": "
+                 << status;
+  }
+}
+
+SegmentEventMuxerListener::SegmentEventMuxerListener(
+    SegmentEventPublisher* publisher)
+    : publisher_(publisher) {
+  DCHECK(publisher_);
+}
+
+SegmentEventMuxerListener::~SegmentEventMuxerListener() {}
+
+void SegmentEventMuxerListener::OnEncryptionInfoReady(
+    bool is_initial_encryption_info,
+    FourCC protection_scheme,
+    const std::vector<uint8_t>& key_id,
+    const std::vector<uint8_t>& iv,
+    const std::vector<ProtectionSystemSpecificInfo>& key_system_info) {
+  UNUSED(is_initial_encryption_info);
+  UNUSED(protection_scheme);
+  UNUSED(key_id);
+  UNUSED(iv);
+  UNUSED(key_system_info);
+}
+
+void SegmentEventMuxerListener::OnEncryptionStart() {}
+
+void SegmentEventMuxerListener::OnMediaStart(const MuxerOptions& muxer_options,
+                                             const StreamInfo& stream_info,
+                                             int32_t time_scale,
+                                             ContainerType container_type) {
+  UNUSED(container_type);
+  output_ = muxer_options.segment_template.empty()
+                ? muxer_options.output_file_name
+                : muxer_options.segment_template;
+  stream_type_ = StreamTypeToString(stream_info.stream_type());
+  codec_ = stream_info.codec_string();
+  time_scale_ = time_scale;
+}
+
+void SegmentEventMuxerListener::OnSampleDurationReady(int32_t sample_duration) {
+  UNUSED(sample_duration);
+}
+
+void SegmentEventMuxerListener::OnMediaEnd(const MediaRanges& media_ranges,
+                                           float duration_seconds) {
+  UNUSED(media_ranges);
+  UNUSED(duration_seconds);
+}
+
+void SegmentEventMuxerListener::OnNewSegment(const std::string& file_name,
+                                             int64_t start_time,
+                                             int64_t duration,
+                                             uint64_t segment_file_size,
+                                             int64_t segment_number) {
+  PublishSegment(file_name, start_time, duration, nullptr, segment_file_size,
+                 segment_number);
+}
+
+void SegmentEventMuxerListener::OnNewBundledSegment(
+    const std::string& bundle_name,
+    int64_t start_time,
+    int64_t duration,
+    uint64_t start_byte_offset,
+    uint64_t segment_size,
+    int64_t segment_number) {
+  PublishSegment(bundle_name, start_time, duration, &start_byte_offset,
+                 segment_size, segment_number);
+}
+
+void SegmentEventMuxerListener::OnKeyFrame(int64_t timestamp,
+                                           uint64_t start_byte_offset,
+                                           uint64_t size) {
+  UNUSED(timestamp);
+  UNUSED(start_byte_offset);
+  UNUSED(size);
+}
+
+void SegmentEventMuxerListener::OnCueEvent(int64_t timestamp,
+                                           const std::string& cue_data) {
+  UNUSED(timestamp);
+  UNUSED(cue_data);
+}
+
+void SegmentEventMuxerListener::PublishSegment(
+    const std::string& file_name,
+    int64_t start_time,
+    int64_t duration,
+    const uint64_t* start_byte_offset,
+    uint64_t size,
+    int64_t segment_number) {
+  nlohmann::json json = {
+      {"output", output_},
+      {"stream_type", stream_type_},
+      {"codec", codec_},
+      {"segment", file_name},
+      {"segment_number", segment_number},
+      {"start_time", start_time},
+      {"duration", duration},
+      {"time_scale", time_scale_},
+      {"size", size},
+      {"written_ms", std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count()},
+  };
+  if (start_byte_offset)
+    json["offset"] = *start_byte_offset;
+  publisher_->Publish(json.dump());
+}
+
+}  // namespace media
+}  // namespace shaka
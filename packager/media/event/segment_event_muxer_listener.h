@@ -0,0 +1,136 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// Implementation of MuxerListener that publishes an event for each segment
+// written, e.g. for a CDN to prefetch the segments before players ask for
+// them.
+
+#ifndef PACKAGER_MEDIA_EVENT_SEGMENT_EVENT_MUXER_LISTENER_H_
+#define PACKAGER_MEDIA_EVENT_SEGMENT_EVENT_MUXER_LISTENER_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+
+#include <packager/file/file_closer.h>
+#include <packager/media/event/muxer_listener.h>
+#include <packager/status.h>
+
+namespace shaka {
+namespace media {
+
+/// Sends the segment events to a URL from a thread of its own, so that the
+/// muxers never wait for the network. It is shared by the
+/// SegmentEventMuxerListeners of all the streams.
+///
+/// The events are sent as lines of JSON: a udp:// URL receives a datagram
+/// for each event, and an http:// or https:// URL receives POST requests,
+/// each with the events published within a short delay of each other.
+class SegmentEventPublisher {
+ public:
+  SegmentEventPublisher() = default;
+  /// Sends the events queued, then stops.
+  ~SegmentEventPublisher();
+
+  /// Set the URL to send the events to, and start sending.
+  Status Open(const std::string& url);
+
+  /// Queue an event to be sent. It is called from the threads of the muxers,
+  /// and never blocks on I/O: the event is dropped if too many events are
+  /// queued already.
+  void Publish(std::string event);
+
+ private:
+  SegmentEventPublisher(const SegmentEventPublisher&) = delete;
+  SegmentEventPublisher& operator=(const SegmentEventPublisher&) = delete;
+
+  void Run();
+  void Send(const std::vector<std::string>& events);
+
+  std::string url_;
+  bool batched_ = false;
+  // Used by the thread only.
+  std::unique_ptr<File, FileCloser> udp_file_;
+
+  absl::Mutex mutex_;
+  absl::CondVar events_available_;
+  std::deque<std::string> events_ ABSL_GUARDED_BY(mutex_);
+  uint64_t num_dropped_events_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool stopping_ ABSL_GUARDED_BY(mutex_) = false;
+
+  std::thread thread_;
+};
+
+/// Publishes an event to a SegmentEventPublisher for each segment of a
+/// stream, once the segment is written, with the name, size, timestamps and
+/// output of the segment.
+class SegmentEventMuxerListener : public MuxerListener {
+ public:
+  /// @param publisher must outlive the listener.
+  explicit SegmentEventMuxerListener(SegmentEventPublisher* publisher);
+  ~SegmentEventMuxerListener() override;
+
+  /// @name MuxerListener implementation overrides.
+  /// @{
+  void OnEncryptionInfoReady(bool is_initial_encryption_info,
+                             FourCC protection_scheme,
+                             const std::vector<uint8_t>& key_id,
+                             const std::vector<uint8_t>& iv,
+                             const std::vector<ProtectionSystemSpecificInfo>&
+                                 key_system_info) override;
+  void OnEncryptionStart() override;
+  void OnMediaStart(const MuxerOptions& muxer_options,
+                    const StreamInfo& stream_info,
+                    int32_t time_scale,
+                    ContainerType container_type) override;
+  void OnSampleDurationReady(int32_t sample_duration) override;
+  void OnMediaEnd(const MediaRanges& media_ranges,
+                  float duration_seconds) override;
+  void OnNewSegment(const std::string& file_name,
+                    int64_t start_time,
+                    int64_t duration,
+                    uint64_t segment_file_size,
+                    int64_t segment_number) override;
+  void OnNewBundledSegment(const std::string& bundle_name,
+                           int64_t start_time,
+                           int64_t duration,
+                           uint64_t start_byte_offset,
+                           uint64_t segment_size,
+                           int64_t segment_number) override;
+  void OnKeyFrame(int64_t timestamp,
+                  uint64_t start_byte_offset,
+                  uint64_t size) override;
+  void OnCueEvent(int64_t timestamp, const std::string& cue_data) override;
+  /// @}
+
+ private:
+  SegmentEventMuxerListener(const SegmentEventMuxerListener&) = delete;
+  SegmentEventMuxerListener& operator=(const SegmentEventMuxerListener&) =
+      delete;
+
+  void PublishSegment(const std::string& file_name,
+                      int64_t start_time,
+                      int64_t duration,
+                      const uint64_t* start_byte_offset,
+                      uint64_t size,
+                      int64_t segment_number);
+
+  SegmentEventPublisher* const publisher_;
+  std::string output_;
+  std::string stream_type_;
+  std::string codec_;
+  int32_t time_scale_ = 0;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_EVENT_SEGMENT_EVENT_MUXER_LISTENER_H_
@@ -0,0 +1,115 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/event/segment_event_muxer_listener.h>
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include <packager/file.h>
+#include <packager/file/file_closer.h>
+#include <packager/media/base/muxer_options.h>
+#include <packager/media/base/video_stream_info.h>
+#include <packager/media/event/muxer_listener_test_helper.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const char kEventUrl[] = "udp://127.0.0.1:48911";
+const int32_t kTimeScale = 1000;
+const int64_t kSegmentStartTime = 1000;
+const int64_t kSegmentDuration = 2000;
+const uint64_t kSegmentSize = 12345;
+const int64_t kSegmentNumber = 2;
+
+}  // namespace
+
+class SegmentEventMuxerListenerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Bound before the events are sent.
+    receiver_.reset(File::OpenWithNoBuffering(
+        (std::string(kEventUrl) + "?timeout=5000000").c_str(), "r"));
+    ASSERT_TRUE(receiver_);
+    publisher_.reset(new SegmentEventPublisher);
+    ASSERT_TRUE(publisher_->Open(kEventUrl).ok());
+    listener_.reset(new SegmentEventMuxerListener(publisher_.get()));
+
+    MuxerOptions muxer_options;
+    SetDefaultMuxerOptions(&muxer_options);
+    muxer_options.segment_template = "video-$Number$.m4s";
+    std::shared_ptr<StreamInfo> stream_info =
+        CreateVideoStreamInfo(GetDefaultVideoStreamInfoParams());
+    listener_->OnMediaStart(muxer_options, *stream_info, kTimeScale,
+                            MuxerListener::kContainerMp4);
+  }
+
+  // Receives |num_events| events.
+  std::vector<nlohmann::json> ReceiveEvents(size_t num_events) {
+    std::string content;
+    std::vector<uint8_t> buffer(65536);
+    std::vector<nlohmann::json> events;
+    while (events.size() < num_events) {
+      const int64_t size = receiver_->Read(buffer.data(), buffer.size());
+      if (size <= 0) {
+        ADD_FAILURE() << "Only received " << events.size() << " events.";
+        break;
+      }
+      content.append(buffer.begin(), buffer.begin() + size);
+      size_t end;
+      while ((end = content.find('\n')) != std::string::npos) {
+        events.push_back(nlohmann::json::parse(content.substr(0, end)));
+        content.erase(0, end + 1);
+      }
+    }
+    return events;
+  }
+
+  std::unique_ptr<File, FileCloser> receiver_;
+  std::unique_ptr<SegmentEventPublisher> publisher_;
+  std::unique_ptr<SegmentEventMuxerListener> listener_;
+};
+
+TEST_F(SegmentEventMuxerListenerTest, PublishesSegments) {
+  const auto before_write = std::chrono::system_clock::now();
+  listener_->OnNewSegment("video-2.m4s", kSegmentStartTime, kSegmentDuration,
+                          kSegmentSize, kSegmentNumber);
+  listener_->OnNewBundledSegment("video-2.m4s",
+                                 kSegmentStartTime + kSegmentDuration,
+                                 kSegmentDuration, kSegmentSize, kSegmentSize,
+                                 kSegmentNumber + 1);
+
+  std::vector<nlohmann::json> events = ReceiveEvents(2);
+  ASSERT_EQ(2u, events.size());
+  EXPECT_EQ("video-$Number$.m4s", events[0]["output"]);
+  EXPECT_EQ("Video", events[0]["stream_type"]);
+  EXPECT_EQ("video-2.m4s", events[0]["segment"]);
+  EXPECT_EQ(kSegmentNumber, events[0]["segment_number"]);
+  EXPECT_EQ(kSegmentStartTime, events[0]["start_time"]);
+  EXPECT_EQ(kSegmentDuration, events[0]["duration"]);
+  EXPECT_EQ(kTimeScale, events[0]["time_scale"]);
+  EXPECT_EQ(kSegmentSize, events[0]["size"]);
+  EXPECT_FALSE(events[0].contains("offset"));
+  EXPECT_GE(events[0]["written_ms"].get<int64_t>(),
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                before_write.time_since_epoch())
+                .count());
+
+  EXPECT_EQ("video-2.m4s", events[1]["segment"]);
+  EXPECT_EQ(kSegmentNumber + 1, events[1]["segment_number"]);
+  EXPECT_EQ(kSegmentSize, events[1]["offset"]);
+  EXPECT_EQ(kSegmentSize, events[1]["size"]);
+}
+
+TEST(SegmentEventPublisherTest, UnsupportedUrl) {
+  SegmentEventPublisher publisher;
+  EXPECT_EQ(error::INVALID_ARGUMENT,
+            publisher.Open("events.jsonl").error_code());
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,217 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/event/segment_index_muxer_listener.h>
+
+#include <memory>
+#include <optional>
+
+#include <absl/log/log.h>
+
+#include <packager/file.h>
+#include <packager/file/file_closer.h>
+#include <packager/macros/compiler.h>
+#include <packager/media/base/buffer_reader.h>
+#include <packager/media/base/buffer_writer.h>
+#include <packager/media/base/muxer_options.h>
+#include <packager/media/base/rcheck.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const char kIndexFileSuffix[] = ".idx";
+const char kIndexMagic[] = "SPIX";
+const uint8_t kIndexVersion = 1;
+
+void WriteRange(const std::optional<Range>& range, BufferWriter* buffer) {
+  buffer->AppendInt(static_cast<uint64_t>(range ? range->start : 0));
+  buffer->AppendInt(
+      static_cast<uint64_t>(range ? range->end - range->start + 1 : 0));
+}
+
+bool ReadRange(BufferReader* reader, std::optional<Range>* range) {
+  uint64_t offset = 0;
+  uint64_t size = 0;
+  RCHECK(reader->Read8(&offset) && reader->Read8(&size));
+  if (size == 0)
+    range->reset();
+  else
+    *range = Range{offset, offset + size - 1};
+  return true;
+}
+
+bool ParseSegmentIndex(BufferReader* reader, SegmentIndex* index) {
+  std::string magic;
+  uint8_t version = 0;
+  RCHECK(reader->ReadToString(&magic, 4) && magic == kIndexMagic &&
+         reader->Read1(&version) && version == kIndexVersion &&
+         reader->SkipBytes(3) && reader->Read4s(&index->time_scale) &&
+         ReadRange(reader, &index->init_range) &&
+         ReadRange(reader, &index->index_range));
+
+  uint32_t num_segments = 0;
+  RCHECK(reader->Read4(&num_segments));
+  index->segments.clear();
+  for (uint32_t i = 0; i < num_segments; ++i) {
+    SegmentIndex::Segment segment;
+    std::optional<Range> range;
+    uint32_t num_key_frames = 0;
+    RCHECK(reader->Read8s(&segment.start_time) &&
+           reader->Read8s(&segment.duration) && ReadRange(reader, &range) &&
+           range && reader->Read4(&num_key_frames));
+    segment.range = *range;
+    for (uint32_t j = 0; j < num_key_frames; ++j) {
+      SegmentIndex::KeyFrame key_frame;
+      RCHECK(reader->Read8s(&key_frame.timestamp) &&
+             ReadRange(reader, &range) && range);
+      key_frame.range = *range;
+      segment.key_frames.push_back(key_frame);
+    }
+    index->segments.push_back(std::move(segment));
+  }
+  return !reader->HasBytes(1);
+}
+
+}  // namespace
+
+Status ReadSegmentIndex(const std::string& output_file_name,
+                        SegmentIndex* index) {
+  const std::string index_file_name = output_file_name + kIndexFileSuffix;
+  std::string content;
+  if (!File::ReadFileToString(index_file_name.c_str(), &content)) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot read segment index " + index_file_name);
+  }
+  BufferReader reader(reinterpret_cast<const uint8_t*>(content.data()),
+                      content.size());
+  if (!ParseSegmentIndex(&reader, index)) {
+    return Status(error::PARSER_FAILURE,
+                  "Invalid segment index " + index_file_name);
+  }
+  return Status::OK;
+}
+
+SegmentIndexMuxerListener::SegmentIndexMuxerListener() = default;
+
+SegmentIndexMuxerListener::~SegmentIndexMuxerListener() = default;
+
+void SegmentIndexMuxerListener::OnEncryptionInfoReady(
+    bool is_initial_encryption_info,
+    FourCC protection_scheme,
+    const std::vector<uint8_t>& key_id,
+    const std::vector<uint8_t>& iv,
+    const std::vector<ProtectionSystemSpecificInfo>& key_system_info) {
+  UNUSED(is_initial_encryption_info);
+  UNUSED(protection_scheme);
+  UNUSED(key_id);
+  UNUSED(iv);
+  UNUSED(key_system_info);
+}
+
+void SegmentIndexMuxerListener::OnEncryptionStart() {}
+
+void SegmentIndexMuxerListener::OnMediaStart(const MuxerOptions& muxer_options,
+                                             const StreamInfo& stream_info,
+                                             int32_t time_scale,
+                                             ContainerType container_type) {
+  UNUSED(stream_info);
+  UNUSED(container_type);
+  index_file_name_ = muxer_options.segment_template.empty()
+                         ? muxer_options.output_file_name + kIndexFileSuffix
+                         : std::string();
+  time_scale_ = time_scale;
+  segments_.clear();
+  key_frames_.clear();
+}
+
+void SegmentIndexMuxerListener::OnSampleDurationReady(int32_t sample_duration) {
+  UNUSED(sample_duration);
+}
+
+void SegmentIndexMuxerListener::OnMediaEnd(const MediaRanges& media_ranges,
+                                           float duration_seconds) {
+  UNUSED(duration_seconds);
+  if (index_file_name_.empty())
+    return;
+  if (media_ranges.subsegment_ranges.size() != segments_.size()) {
+    LOG(WARNING) << "Not writing " << index_file_name_ << ": "
+                 << media_ranges.subsegment_ranges.size()
+                 << " subsegment ranges for " << segments_.size()
+                 << " segments.";
+    return;
+  }
+
+  BufferWriter buffer;
+  buffer.AppendArray(reinterpret_cast<const uint8_t*>(kIndexMagic), 4);
+  buffer.AppendInt(kIndexVersion);
+  buffer.AppendNBytes(0, 3);
+  buffer.AppendInt(time_scale_);
+  WriteRange(media_ranges.init_range, &buffer);
+  WriteRange(media_ranges.index_range, &buffer);
+  buffer.AppendInt(static_cast<uint32_t>(segments_.size()));
+  for (size_t i = 0; i < segments_.size(); ++i) {
+    const Segment& segment = segments_[i];
+    const Range& range = media_ranges.subsegment_ranges[i];
+    buffer.AppendInt(segment.start_time);
+    buffer.AppendInt(segment.duration);
+    WriteRange(range, &buffer);
+    buffer.AppendInt(static_cast<uint32_t>(segment.key_frames.size()));
+    for (const KeyFrame& key_frame : segment.key_frames) {
+      buffer.AppendInt(key_frame.timestamp);
+      buffer.AppendInt(range.start + key_frame.offset);
+      buffer.AppendInt(key_frame.size);
+    }
+  }
+
+  std::unique_ptr<File, FileCloser> file(
+      File::OpenWithNoBuffering(index_file_name_.c_str(), "w"));
+  if (!file) {
+    LOG(ERROR) << "Cannot open file for write " << index_file_name_;
+    return;
+  }
+  const Status status = buffer.WriteToFile(file.get());
+  if (!status.ok() || !file.release()->Close())
+    LOG(ERROR) << "Cannot write segment index " << index_file_name_;
+}
+
+void SegmentIndexMuxerListener::OnNewSegment(const std::string& file_name,
+                                             int64_t start_time,
+                                             int64_t duration,
+                                             uint64_t segment_file_size,
+                                             int64_t segment_number) {
+  UNUSED(file_name);
+  UNUSED(segment_file_size);
+  UNUSED(segment_number);
+  if (index_file_name_.empty())
+    return;
+  Segment segment;
+  segment.start_time = start_time;
+  segment.duration = duration;
+  segment.key_frames.swap(key_frames_);
+  segments_.push_back(std::move(segment));
+}
+
+void SegmentIndexMuxerListener::OnKeyFrame(int64_t timestamp,
+                                           uint64_t start_byte_offset,
+                                           uint64_t size) {
+  if (index_file_name_.empty())
+    return;
+  KeyFrame key_frame;
+  key_frame.timestamp = timestamp;
+  key_frame.offset = start_byte_offset;
+  key_frame.size = size;
+  key_frames_.push_back(key_frame);
+}
+
+void SegmentIndexMuxerListener::OnCueEvent(int64_t timestamp,
+                                           const std::string& cue_data) {
+  UNUSED(timestamp);
+  UNUSED(cue_data);
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,132 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// Implementation of MuxerListener that writes a binary index of the segments
+// of a single-file output next to it.
+
+#ifndef PACKAGER_MEDIA_EVENT_SEGMENT_INDEX_MUXER_LISTENER_H_
+#define PACKAGER_MEDIA_EVENT_SEGMENT_INDEX_MUXER_LISTENER_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <packager/media/base/range.h>
+#include <packager/media/event/muxer_listener.h>
+#include <packager/status.h>
+
+namespace shaka {
+namespace media {
+
+/// Writes the byte ranges of the segments of a single-file output, e.g. an
+/// on-demand MP4, and of their key frames to a file next to the output, at
+/// its name with ".idx" appended. An origin can then serve the segments, e.g.
+/// of an HLS playlist with EXT-X-BYTERANGE, without parsing the output.
+/// Outputs with a segment template are ignored.
+///
+/// The index is big-endian:
+///   - "SPIX", then the version, 1, as a byte, then 3 reserved bytes.
+///   - The timescale of the times, 32 bits.
+///   - The offset and the size of the init section, then of the index
+///     section, 64 bits each. The size is 0 if there is no such section.
+///   - The number of segments, 32 bits, then for each segment:
+///     - Its start time and its duration, 64 bits each.
+///     - Its offset and its size in the output, 64 bits each.
+///     - Its number of key frames, 32 bits, then for each key frame its time,
+///       its offset in the output and its size, 64 bits each.
+class SegmentIndexMuxerListener : public MuxerListener {
+ public:
+  SegmentIndexMuxerListener();
+  ~SegmentIndexMuxerListener() override;
+
+  /// @name MuxerListener implementation overrides.
+  /// @{
+  void OnEncryptionInfoReady(bool is_initial_encryption_info,
+                             FourCC protection_scheme,
+                             const std::vector<uint8_t>& key_id,
+                             const std::vector<uint8_t>& iv,
+                             const std::vector<ProtectionSystemSpecificInfo>&
+                                 key_system_info) override;
+  void OnEncryptionStart() override;
+  void OnMediaStart(const MuxerOptions& muxer_options,
+                    const StreamInfo& stream_info,
+                    int32_t time_scale,
+                    ContainerType container_type) override;
+  void OnSampleDurationReady(int32_t sample_duration) override;
+  void OnMediaEnd(const MediaRanges& media_ranges,
+                  float duration_seconds) override;
+  void OnNewSegment(const std::string& file_name,
+                    int64_t start_time,
+                    int64_t duration,
+                    uint64_t segment_file_size,
+                    int64_t segment_number) override;
+  void OnKeyFrame(int64_t timestamp,
+                  uint64_t start_byte_offset,
+                  uint64_t size) override;
+  void OnCueEvent(int64_t timestamp, const std::string& cue_data) override;
+  /// @}
+
+ private:
+  SegmentIndexMuxerListener(const SegmentIndexMuxerListener&) = delete;
+  SegmentIndexMuxerListener& operator=(const SegmentIndexMuxerListener&) =
+      delete;
+
+  struct KeyFrame {
+    int64_t timestamp = 0;
+    // The offset in the segment.
+    uint64_t offset = 0;
+    uint64_t size = 0;
+  };
+
+  struct Segment {
+    int64_t start_time = 0;
+    int64_t duration = 0;
+    std::vector<KeyFrame> key_frames;
+  };
+
+  // Empty if the output is not a single file.
+  std::string index_file_name_;
+  int32_t time_scale_ = 0;
+  std::vector<Segment> segments_;
+  // The key frames of the next segment.
+  std::vector<KeyFrame> key_frames_;
+};
+
+/// The content of an index written by SegmentIndexMuxerListener.
+struct SegmentIndex {
+  struct KeyFrame {
+    int64_t timestamp = 0;
+    /// The byte range of the key frame in the output.
+    Range range = {};
+  };
+
+  struct Segment {
+    int64_t start_time = 0;
+    int64_t duration = 0;
+    /// The byte range of the segment in the output.
+    Range range = {};
+    std::vector<KeyFrame> key_frames;
+  };
+
+  int32_t time_scale = 0;
+  /// Not set if the output has no such section.
+  std::optional<Range> init_range;
+  std::optional<Range> index_range;
+  std::vector<Segment> segments;
+};
+
+/// Read the index written by SegmentIndexMuxerListener next to an output.
+/// @param output_file_name is the name of the output, not of the index.
+/// @param index receives the index on success.
+/// @return OK on success, an error if the index cannot be read or is invalid.
+Status ReadSegmentIndex(const std::string& output_file_name,
+                        SegmentIndex* index);
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_EVENT_SEGMENT_INDEX_MUXER_LISTENER_H_
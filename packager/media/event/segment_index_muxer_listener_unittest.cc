@@ -0,0 +1,170 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/event/segment_index_muxer_listener.h>
+
+#include <gtest/gtest.h>
+
+#include <packager/file.h>
+#include <packager/media/base/buffer_reader.h>
+#include <packager/media/base/muxer_options.h>
+#include <packager/media/base/video_stream_info.h>
+#include <packager/media/event/muxer_listener_test_helper.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const char kOutputFileName[] = "memory://segment_index/video.mp4";
+const char kIndexFileName[] = "memory://segment_index/video.mp4.idx";
+const int32_t kTimeScale = 1000;
+
+}  // namespace
+
+class SegmentIndexMuxerListenerTest : public ::testing::Test {
+ protected:
+  void StartMedia(const std::string& segment_template) {
+    MuxerOptions muxer_options;
+    SetDefaultMuxerOptions(&muxer_options);
+    muxer_options.output_file_name = kOutputFileName;
+    muxer_options.segment_template = segment_template;
+    std::shared_ptr<StreamInfo> stream_info =
+        CreateVideoStreamInfo(GetDefaultVideoStreamInfoParams());
+    listener_.OnMediaStart(muxer_options, *stream_info, kTimeScale,
+                           MuxerListener::kContainerMp4);
+  }
+
+  void TearDown() override { File::Delete(kIndexFileName); }
+
+  SegmentIndexMuxerListener listener_;
+};
+
+TEST_F(SegmentIndexMuxerListenerTest, WritesIndex) {
+  StartMedia("");
+  listener_.OnKeyFrame(0, 8, 500);
+  listener_.OnNewSegment(kOutputFileName, 0, 2000, 1000, 1);
+  listener_.OnKeyFrame(2000, 8, 600);
+  listener_.OnKeyFrame(3000, 700, 300);
+  listener_.OnNewSegment(kOutputFileName, 2000, 2000, 1200, 2);
+
+  MuxerListener::MediaRanges media_ranges;
+  media_ranges.init_range = Range{0, 99};
+  media_ranges.index_range = Range{100, 199};
+  media_ranges.subsegment_ranges = {Range{200, 1199}, Range{1200, 2399}};
+  listener_.OnMediaEnd(media_ranges, 4);
+
+  std::string index;
+  ASSERT_TRUE(File::ReadFileToString(kIndexFileName, &index));
+  BufferReader reader(reinterpret_cast<const uint8_t*>(index.data()),
+                      index.size());
+  std::string magic;
+  ASSERT_TRUE(reader.ReadToString(&magic, 4));
+  EXPECT_EQ("SPIX", magic);
+  uint32_t version;
+  ASSERT_TRUE(reader.Read4(&version));
+  EXPECT_EQ(0x01000000u, version);
+  uint32_t time_scale;
+  ASSERT_TRUE(reader.Read4(&time_scale));
+  EXPECT_EQ(static_cast<uint32_t>(kTimeScale), time_scale);
+
+  uint64_t values[4];
+  for (uint64_t& value : values)
+    ASSERT_TRUE(reader.Read8(&value));
+  EXPECT_EQ(0u, values[0]);
+  EXPECT_EQ(100u, values[1]);
+  EXPECT_EQ(100u, values[2]);
+  EXPECT_EQ(100u, values[3]);
+
+  uint32_t num_segments;
+  ASSERT_TRUE(reader.Read4(&num_segments));
+  ASSERT_EQ(2u, num_segments);
+
+  // The first segment.
+  for (uint64_t& value : values)
+    ASSERT_TRUE(reader.Read8(&value));
+  EXPECT_EQ(0u, values[0]);
+  EXPECT_EQ(2000u, values[1]);
+  EXPECT_EQ(200u, values[2]);
+  EXPECT_EQ(1000u, values[3]);
+  uint32_t num_key_frames;
+  ASSERT_TRUE(reader.Read4(&num_key_frames));
+  ASSERT_EQ(1u, num_key_frames);
+  uint64_t key_frame[3];
+  for (uint64_t& value : key_frame)
+    ASSERT_TRUE(reader.Read8(&value));
+  EXPECT_EQ(0u, key_frame[0]);
+  EXPECT_EQ(208u, key_frame[1]);
+  EXPECT_EQ(500u, key_frame[2]);
+
+  // The second segment.
+  for (uint64_t& value : values)
+    ASSERT_TRUE(reader.Read8(&value));
+  EXPECT_EQ(2000u, values[0]);
+  EXPECT_EQ(2000u, values[1]);
+  EXPECT_EQ(1200u, values[2]);
+  EXPECT_EQ(1200u, values[3]);
+  ASSERT_TRUE(reader.Read4(&num_key_frames));
+  ASSERT_EQ(2u, num_key_frames);
+  for (uint64_t& value : key_frame)
+    ASSERT_TRUE(reader.Read8(&value));
+  EXPECT_EQ(2000u, key_frame[0]);
+  EXPECT_EQ(1208u, key_frame[1]);
+  for (uint64_t& value : key_frame)
+    ASSERT_TRUE(reader.Read8(&value));
+  EXPECT_EQ(3000u, key_frame[0]);
+  EXPECT_EQ(1900u, key_frame[1]);
+  EXPECT_EQ(300u, key_frame[2]);
+
+  EXPECT_FALSE(reader.HasBytes(1));
+}
+
+TEST_F(SegmentIndexMuxerListenerTest, ReadsIndex) {
+  StartMedia("");
+  listener_.OnKeyFrame(0, 8, 500);
+  listener_.OnNewSegment(kOutputFileName, 0, 2000, 1000, 1);
+  listener_.OnNewSegment(kOutputFileName, 2000, 2000, 1200, 2);
+
+  MuxerListener::MediaRanges media_ranges;
+  media_ranges.init_range = Range{0, 99};
+  media_ranges.subsegment_ranges = {Range{200, 1199}, Range{1200, 2399}};
+  listener_.OnMediaEnd(media_ranges, 4);
+
+  SegmentIndex index;
+  ASSERT_TRUE(ReadSegmentIndex(kOutputFileName, &index).ok());
+  EXPECT_EQ(kTimeScale, index.time_scale);
+  ASSERT_TRUE(index.init_range);
+  EXPECT_EQ(0u, index.init_range->start);
+  EXPECT_EQ(99u, index.init_range->end);
+  EXPECT_FALSE(index.index_range);
+  ASSERT_EQ(2u, index.segments.size());
+  EXPECT_EQ(2000, index.segments[1].start_time);
+  EXPECT_EQ(2000, index.segments[1].duration);
+  EXPECT_EQ(1200u, index.segments[1].range.start);
+  EXPECT_EQ(2399u, index.segments[1].range.end);
+  ASSERT_EQ(1u, index.segments[0].key_frames.size());
+  EXPECT_EQ(208u, index.segments[0].key_frames[0].range.start);
+  EXPECT_EQ(707u, index.segments[0].key_frames[0].range.end);
+  EXPECT_TRUE(index.segments[1].key_frames.empty());
+}
+
+TEST_F(SegmentIndexMuxerListenerTest, ReadsInvalidIndex) {
+  ASSERT_TRUE(File::WriteStringToFile(kIndexFileName, "SPIX"));
+  SegmentIndex index;
+  EXPECT_FALSE(ReadSegmentIndex(kOutputFileName, &index).ok());
+}
+
+TEST_F(SegmentIndexMuxerListenerTest, IgnoresSegmentTemplates) {
+  StartMedia("memory://segment_index/video-$Number$.m4s");
+  listener_.OnNewSegment("memory://segment_index/video-1.m4s", 0, 2000, 1000,
+                         1);
+  listener_.OnMediaEnd(MuxerListener::MediaRanges(), 2);
+
+  std::string index;
+  EXPECT_FALSE(File::ReadFileToString(kIndexFileName, &index));
+}
+
+}  // namespace media
+}  // namespace shaka
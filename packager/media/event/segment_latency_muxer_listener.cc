@@ -0,0 +1,158 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/event/segment_latency_muxer_listener.h>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <nlohmann/json.hpp>
+
+#include <packager/macros/compiler.h>
+#include <packager/media/base/muxer_options.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+// Adds |time| to |json| as milliseconds since the epoch, unless it is unknown.
+void AddTime(const char* name,
+             std::chrono::system_clock::time_point time,
+             nlohmann::json* json) {
+  if (time == std::chrono::system_clock::time_point())
+    return;
+  (*json)[name] = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      time.time_since_epoch())
+                      .count();
+}
+
+}  // namespace
+
+Status SegmentLatencyLog::Open(const std::string& file_name) {
+  absl::MutexLock lock(&mutex_);
+  file_.reset(File::Open(file_name.c_str(), "w"));
+  if (!file_) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot open segment latency log " + file_name);
+  }
+  return Status::OK;
+}
+
+void SegmentLatencyLog::WriteLine(const std::string& line) {
+  const std::string data = line + "\n";
+  absl::MutexLock lock(&mutex_);
+  if (!file_)
+    return;
+  // Flush each line so that the log can be followed while packaging.
+  if (file_->Write(data.data(), data.size()) !=
+          static_cast<int64_t>(data.size()) ||
+      !file_->Flush()) {
+    LOG(WARNING) << "Failed to write to segment latency log "
+                 << file_->file_name();
+  }
+}
+
+SegmentLatencyMuxerListener::SegmentLatencyMuxerListener(SegmentLatencyLog* log)
+    : log_(log) {
+  DCHECK(log_);
+}
+
+SegmentLatencyMuxerListener::~SegmentLatencyMuxerListener() {}
+
+void SegmentLatencyMuxerListener::OnEncryptionInfoReady(
+    bool is_initial_encryption_info,
+    FourCC protection_scheme,
+    const std::vector<uint8_t>& key_id,
+    const std::vector<uint8_t>& iv,
+    const std::vector<ProtectionSystemSpecificInfo>& key_system_info) {
+  UNUSED(is_initial_encryption_info);
+  UNUSED(protection_scheme);
+  UNUSED(key_id);
+  UNUSED(iv);
+  UNUSED(key_system_info);
+}
+
+void SegmentLatencyMuxerListener::OnEncryptionStart() {}
+
+void SegmentLatencyMuxerListener::OnMediaStart(
+    const MuxerOptions& muxer_options,
+    const StreamInfo& stream_info,
+    int32_t time_scale,
+    ContainerType container_type) {
+  UNUSED(stream_info);
+  UNUSED(container_type);
+  output_ = muxer_options.segment_template.empty()
+                ? muxer_options.output_file_name
+                : muxer_options.segment_template;
+  time_scale_ = time_scale;
+}
+
+void SegmentLatencyMuxerListener::OnSampleDurationReady(
+    int32_t sample_duration) {
+  UNUSED(sample_duration);
+}
+
+void SegmentLatencyMuxerListener::OnMediaEnd(const MediaRanges& media_ranges,
+                                             float duration_seconds) {
+  UNUSED(media_ranges);
+  UNUSED(duration_seconds);
+}
+
+void SegmentLatencyMuxerListener::OnNewSegment(const std::string& file_name,
+                                               int64_t start_time,
+                                               int64_t duration,
+                                               uint64_t segment_file_size,
+                                               int64_t segment_number) {
+  UNUSED(start_time);
+  FlushedSegment segment;
+  segment.file_name = file_name;
+  segment.duration = duration;
+  segment.size = segment_file_size;
+  segment.segment_number = segment_number;
+  segment.flushed_time = std::chrono::system_clock::now();
+  flushed_segment_ = std::move(segment);
+}
+
+void SegmentLatencyMuxerListener::OnSegmentLatency(
+    const SegmentLatency& latency) {
+  nlohmann::json json = {
+      {"output", output_},
+      {"start_time", latency.start_time},
+      {"time_scale", time_scale_},
+  };
+  // Segments of single-segment outputs are not notified with OnNewSegment().
+  if (flushed_segment_) {
+    json["segment"] = flushed_segment_->file_name;
+    json["segment_number"] = flushed_segment_->segment_number;
+    json["duration"] = flushed_segment_->duration;
+    json["size"] = flushed_segment_->size;
+  }
+  AddTime("first_sample_ms", latency.first_sample_time, &json);
+  AddTime("chunked_ms", latency.chunked_time, &json);
+  AddTime("encrypted_ms", latency.encrypted_time, &json);
+  if (flushed_segment_)
+    AddTime("flushed_ms", flushed_segment_->flushed_time, &json);
+  AddTime("published_ms", latency.published_time, &json);
+  flushed_segment_.reset();
+
+  log_->WriteLine(json.dump());
+}
+
+void SegmentLatencyMuxerListener::OnKeyFrame(int64_t timestamp,
+                                             uint64_t start_byte_offset,
+                                             uint64_t size) {
+  UNUSED(timestamp);
+  UNUSED(start_byte_offset);
+  UNUSED(size);
+}
+
+void SegmentLatencyMuxerListener::OnCueEvent(int64_t timestamp,
+                                             const std::string& cue_data) {
+  UNUSED(timestamp);
+  UNUSED(cue_data);
+}
+
+}  // namespace media
+}  // namespace shaka
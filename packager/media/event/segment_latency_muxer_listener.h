@@ -0,0 +1,112 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// Implementation of MuxerListener that logs the latency of each segment as a
+// line of JSON.
+
+#ifndef PACKAGER_MEDIA_EVENT_SEGMENT_LATENCY_MUXER_LISTENER_H_
+#define PACKAGER_MEDIA_EVENT_SEGMENT_LATENCY_MUXER_LISTENER_H_
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+
+#include <packager/file/file_closer.h>
+#include <packager/media/event/muxer_listener.h>
+#include <packager/status.h>
+
+namespace shaka {
+namespace media {
+
+/// A JSON-lines file, shared by the SegmentLatencyMuxerListeners of all the
+/// streams.
+class SegmentLatencyLog {
+ public:
+  SegmentLatencyLog() = default;
+
+  /// Open the file to write the lines to, which replaces its content.
+  Status Open(const std::string& file_name);
+
+  /// Write @a line, followed by a new line. It is called from the threads of
+  /// the muxers.
+  void WriteLine(const std::string& line);
+
+ private:
+  SegmentLatencyLog(const SegmentLatencyLog&) = delete;
+  SegmentLatencyLog& operator=(const SegmentLatencyLog&) = delete;
+
+  absl::Mutex mutex_;
+  std::unique_ptr<File, FileCloser> file_ ABSL_GUARDED_BY(mutex_);
+};
+
+/// Writes a line to a SegmentLatencyLog for each segment, with the wall-clock
+/// times, in milliseconds since the epoch, at which the segment went through
+/// the packager.
+///
+/// The segment is flushed when OnNewSegment() is received, so this listener
+/// should be added before the listeners which update the manifests.
+class SegmentLatencyMuxerListener : public MuxerListener {
+ public:
+  /// @param log must outlive the listener.
+  explicit SegmentLatencyMuxerListener(SegmentLatencyLog* log);
+  ~SegmentLatencyMuxerListener() override;
+
+  /// @name MuxerListener implementation overrides.
+  /// @{
+  void OnEncryptionInfoReady(bool is_initial_encryption_info,
+                             FourCC protection_scheme,
+                             const std::vector<uint8_t>& key_id,
+                             const std::vector<uint8_t>& iv,
+                             const std::vector<ProtectionSystemSpecificInfo>&
+                                 key_system_info) override;
+  void OnEncryptionStart() override;
+  void OnMediaStart(const MuxerOptions& muxer_options,
+                    const StreamInfo& stream_info,
+                    int32_t time_scale,
+                    ContainerType container_type) override;
+  void OnSampleDurationReady(int32_t sample_duration) override;
+  void OnMediaEnd(const MediaRanges& media_ranges,
+                  float duration_seconds) override;
+  void OnNewSegment(const std::string& file_name,
+                    int64_t start_time,
+                    int64_t duration,
+                    uint64_t segment_file_size,
+                    int64_t segment_number) override;
+  void OnSegmentLatency(const SegmentLatency& latency) override;
+  void OnKeyFrame(int64_t timestamp,
+                  uint64_t start_byte_offset,
+                  uint64_t size) override;
+  void OnCueEvent(int64_t timestamp, const std::string& cue_data) override;
+  /// @}
+
+ private:
+  SegmentLatencyMuxerListener(const SegmentLatencyMuxerListener&) = delete;
+  SegmentLatencyMuxerListener& operator=(const SegmentLatencyMuxerListener&) =
+      delete;
+
+  // The segment of the last OnNewSegment(), which OnSegmentLatency() follows.
+  struct FlushedSegment {
+    std::string file_name;
+    int64_t duration = 0;
+    uint64_t size = 0;
+    int64_t segment_number = 0;
+    std::chrono::system_clock::time_point flushed_time;
+  };
+
+  SegmentLatencyLog* const log_;
+  std::string output_;
+  int32_t time_scale_ = 0;
+  std::optional<FlushedSegment> flushed_segment_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_EVENT_SEGMENT_LATENCY_MUXER_LISTENER_H_
@@ -0,0 +1,140 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/event/segment_latency_muxer_listener.h>
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include <packager/file.h>
+#include <packager/media/base/muxer_options.h>
+#include <packager/media/base/video_stream_info.h>
+#include <packager/media/event/muxer_listener_test_helper.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const char kLogFileName[] = "memory://segment_latency.jsonl";
+const int32_t kTimeScale = 1000;
+const int64_t kSegmentStartTime = 1000;
+const int64_t kSegmentDuration = 2000;
+const uint64_t kSegmentSize = 12345;
+const int64_t kSegmentNumber = 2;
+
+std::chrono::system_clock::time_point FromMilliseconds(int64_t ms) {
+  return std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+}
+
+}  // namespace
+
+class SegmentLatencyMuxerListenerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(log_.Open(kLogFileName).ok());
+    listener_.reset(new SegmentLatencyMuxerListener(&log_));
+
+    MuxerOptions muxer_options;
+    SetDefaultMuxerOptions(&muxer_options);
+    muxer_options.segment_template = "video-$Number$.m4s";
+    std::shared_ptr<StreamInfo> stream_info =
+        CreateVideoStreamInfo(GetDefaultVideoStreamInfoParams());
+    listener_->OnMediaStart(muxer_options, *stream_info, kTimeScale,
+                            MuxerListener::kContainerMp4);
+  }
+
+  void TearDown() override { File::Delete(kLogFileName); }
+
+  std::vector<nlohmann::json> ReadLines() {
+    std::string content;
+    EXPECT_TRUE(File::ReadFileToString(kLogFileName, &content));
+    std::vector<nlohmann::json> lines;
+    size_t start = 0;
+    size_t end;
+    while ((end = content.find('\n', start)) != std::string::npos) {
+      lines.push_back(nlohmann::json::parse(content.substr(start, end - start)));
+      start = end + 1;
+    }
+    EXPECT_EQ(content.size(), start);
+    return lines;
+  }
+
+  SegmentLatencyLog log_;
+  std::unique_ptr<SegmentLatencyMuxerListener> listener_;
+};
+
+TEST_F(SegmentLatencyMuxerListenerTest, LogsSegment) {
+  SegmentLatency latency;
+  latency.start_time = kSegmentStartTime;
+  latency.first_sample_time = FromMilliseconds(1000);
+  latency.chunked_time = FromMilliseconds(3000);
+  latency.encrypted_time = FromMilliseconds(3010);
+  latency.published_time = std::chrono::system_clock::now() +
+                           std::chrono::hours(1);
+
+  const auto before_flush = std::chrono::system_clock::now();
+  listener_->OnNewSegment("video-2.m4s", kSegmentStartTime, kSegmentDuration,
+                          kSegmentSize, kSegmentNumber);
+  listener_->OnSegmentLatency(latency);
+
+  std::vector<nlohmann::json> lines = ReadLines();
+  ASSERT_EQ(1u, lines.size());
+  const nlohmann::json& line = lines[0];
+  EXPECT_EQ("video-$Number$.m4s", line["output"]);
+  EXPECT_EQ("video-2.m4s", line["segment"]);
+  EXPECT_EQ(kSegmentNumber, line["segment_number"]);
+  EXPECT_EQ(kSegmentStartTime, line["start_time"]);
+  EXPECT_EQ(kSegmentDuration, line["duration"]);
+  EXPECT_EQ(kTimeScale, line["time_scale"]);
+  EXPECT_EQ(kSegmentSize, line["size"]);
+  EXPECT_EQ(1000, line["first_sample_ms"]);
+  EXPECT_EQ(3000, line["chunked_ms"]);
+  EXPECT_EQ(3010, line["encrypted_ms"]);
+  const int64_t flushed_ms = line["flushed_ms"];
+  EXPECT_GE(flushed_ms, std::chrono::duration_cast<std::chrono::milliseconds>(
+                            before_flush.time_since_epoch())
+                            .count());
+  EXPECT_LT(flushed_ms, line["published_ms"].get<int64_t>());
+}
+
+TEST_F(SegmentLatencyMuxerListenerTest, OmitsUnknownTimes) {
+  SegmentLatency latency;
+  latency.start_time = kSegmentStartTime;
+  latency.published_time = FromMilliseconds(5000);
+  // No OnNewSegment(), e.g. for a segment of a single-segment output.
+  listener_->OnSegmentLatency(latency);
+
+  std::vector<nlohmann::json> lines = ReadLines();
+  ASSERT_EQ(1u, lines.size());
+  const nlohmann::json& line = lines[0];
+  EXPECT_EQ(kSegmentStartTime, line["start_time"]);
+  EXPECT_EQ(5000, line["published_ms"]);
+  EXPECT_FALSE(line.contains("segment"));
+  EXPECT_FALSE(line.contains("first_sample_ms"));
+  EXPECT_FALSE(line.contains("chunked_ms"));
+  EXPECT_FALSE(line.contains("encrypted_ms"));
+  EXPECT_FALSE(line.contains("flushed_ms"));
+}
+
+TEST_F(SegmentLatencyMuxerListenerTest, LogsOneLinePerSegment) {
+  SegmentLatency latency;
+  for (int64_t i = 0; i < 3; ++i) {
+    latency.start_time = i * kSegmentDuration;
+    listener_->OnNewSegment("video-" + std::to_string(i + 1) + ".m4s",
+                            latency.start_time, kSegmentDuration, kSegmentSize,
+                            i + 1);
+    listener_->OnSegmentLatency(latency);
+  }
+
+  std::vector<nlohmann::json> lines = ReadLines();
+  ASSERT_EQ(3u, lines.size());
+  EXPECT_EQ("video-1.m4s", lines[0]["segment"]);
+  EXPECT_EQ("video-3.m4s", lines[2]["segment"]);
+  EXPECT_EQ(2 * kSegmentDuration, lines[2]["start_time"]);
+}
+
+}  // namespace media
+}  // namespace shaka
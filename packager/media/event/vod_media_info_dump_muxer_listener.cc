@@ -17,6 +17,7 @@
 #include <packager/macros/logging.h>
 #include <packager/media/base/muxer_options.h>
 #include <packager/media/base/protection_system_specific_info.h>
+#include <packager/media/base/proto_json_util.h>
 #include <packager/media/base/stream_info.h>
 #include <packager/media/event/muxer_listener_internal.h>
 #include <packager/mpd/base/media_info.pb.h>
@@ -89,7 +90,10 @@ void VodMediaInfoDumpMuxerListener::OnMediaEnd(const MediaRanges& media_ranges,
   }
   if (!media_info_->has_bandwidth())
     media_info_->set_bandwidth(max_bitrate_);
-  WriteMediaInfoToFile(*media_info_, output_file_name_);
+  if (media_info_callback_)
+    media_info_callback_(*media_info_);
+  if (!output_file_name_.empty())
+    WriteMediaInfoToFile(*media_info_, output_file_name_, media_info_format_);
 }
 
 void VodMediaInfoDumpMuxerListener::OnNewSegment(const std::string& file_name,
@@ -126,10 +130,24 @@ void VodMediaInfoDumpMuxerListener::OnCueEvent(int64_t timestamp,
 // static
 bool VodMediaInfoDumpMuxerListener::WriteMediaInfoToFile(
     const MediaInfo& media_info,
-    const std::string& output_file_path) {
+    const std::string& output_file_path,
+    MediaInfoFormat format) {
   std::string output_string;
-  if (!google::protobuf::TextFormat::PrintToString(media_info,
-                                                   &output_string)) {
+  bool serialized = false;
+  switch (format) {
+    case MediaInfoFormat::kText:
+      serialized = google::protobuf::TextFormat::PrintToString(media_info,
+                                                               &output_string);
+      break;
+    case MediaInfoFormat::kBinary:
+      serialized = media_info.SerializeToString(&output_string);
+      break;
+    case MediaInfoFormat::kJson:
+      output_string = MessageToJsonString(media_info);
+      serialized = true;
+      break;
+  }
+  if (!serialized) {
     LOG(ERROR) << "Failed to serialize MediaInfo to string.";
     return false;
   }
@@ -151,5 +169,19 @@ bool VodMediaInfoDumpMuxerListener::WriteMediaInfoToFile(
   return true;
 }
 
+// static
+const char* VodMediaInfoDumpMuxerListener::GetMediaInfoFileSuffix(
+    MediaInfoFormat format) {
+  switch (format) {
+    case MediaInfoFormat::kText:
+      return ".media_info";
+    case MediaInfoFormat::kBinary:
+      return ".media_info.pb";
+    case MediaInfoFormat::kJson:
+      return ".media_info.json";
+  }
+  return ".media_info";
+}
+
 }  // namespace media
 }  // namespace shaka
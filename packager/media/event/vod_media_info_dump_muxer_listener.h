@@ -11,6 +11,7 @@
 #ifndef PACKAGER_MEDIA_EVENT_VOD_MEDIA_INFO_DUMP_MUXER_LISTENER_H_
 #define PACKAGER_MEDIA_EVENT_VOD_MEDIA_INFO_DUMP_MUXER_LISTENER_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -18,6 +19,7 @@
 #include <packager/macros/classes.h>
 #include <packager/media/base/muxer_options.h>
 #include <packager/media/event/muxer_listener.h>
+#include <packager/packager.h>
 
 namespace shaka {
 
@@ -27,7 +29,12 @@ namespace media {
 
 class VodMediaInfoDumpMuxerListener : public MuxerListener {
  public:
-  VodMediaInfoDumpMuxerListener(const std::string& output_file_name, bool use_segment_list);
+  using MediaInfoCallback = std::function<void(const MediaInfo& media_info)>;
+
+  /// @param output_file_name is the file the MediaInfo is written to. Nothing
+  ///        is written if it is empty.
+  VodMediaInfoDumpMuxerListener(const std::string& output_file_name,
+                                bool use_segment_list);
   ~VodMediaInfoDumpMuxerListener() override;
 
   /// @name MuxerListener implementation overrides.
@@ -57,17 +64,34 @@ class VodMediaInfoDumpMuxerListener : public MuxerListener {
   void OnCueEvent(int64_t timestamp, const std::string& cue_data) override;
   /// @}
 
-  /// Write @a media_info to @a output_file_path in human readable format.
+  /// Write @a media_info to @a output_file_path.
   /// @param media_info is the MediaInfo to write out.
   /// @param output_file_path is the path of the output file.
+  /// @param format is the format of the output file.
   /// @return true on success, false otherwise.
   // TODO(rkuroiwa): Move this to muxer_listener_internal and rename
   // muxer_listener_internal to muxer_listener_util.
-  static bool WriteMediaInfoToFile(const MediaInfo& media_info,
-                                   const std::string& output_file_path);
+  static bool WriteMediaInfoToFile(
+      const MediaInfo& media_info,
+      const std::string& output_file_path,
+      MediaInfoFormat format = MediaInfoFormat::kText);
+
+  /// @return The suffix appended to output names for MediaInfo files in
+  ///         @a format.
+  static const char* GetMediaInfoFileSuffix(MediaInfoFormat format);
 
   void set_use_segment_list(bool value) {use_segment_list_ = value;}
 
+  void set_media_info_format(MediaInfoFormat format) {
+    media_info_format_ = format;
+  }
+
+  /// @param callback is called with the MediaInfo once it is complete, in
+  ///        addition to writing it to the output file.
+  void set_media_info_callback(MediaInfoCallback callback) {
+    media_info_callback_ = std::move(callback);
+  }
+
  private:
   std::string output_file_name_;
   std::unique_ptr<MediaInfo> media_info_;
@@ -80,6 +104,8 @@ class VodMediaInfoDumpMuxerListener : public MuxerListener {
   std::vector<ProtectionSystemSpecificInfo> key_system_info_;
 
   bool use_segment_list_ = false;
+  MediaInfoFormat media_info_format_ = MediaInfoFormat::kText;
+  MediaInfoCallback media_info_callback_;
 
   DISALLOW_COPY_AND_ASSIGN(VodMediaInfoDumpMuxerListener);
 };
@@ -327,5 +327,32 @@ TEST_F(VodMediaInfoDumpMuxerListenerTest, UnencryptedStream_Normal_SegmentList)
   EXPECT_THAT(temp_file_path_, FileContentEqualsProto(kExpectedProtobufOutput));
 }
 
+// The MediaInfo passed to the callback is the one written to the file.
+TEST_F(VodMediaInfoDumpMuxerListenerTest, BinaryFormatWithCallback) {
+  listener_->set_media_info_format(MediaInfoFormat::kBinary);
+  MediaInfo callback_media_info;
+  int num_callbacks = 0;
+  listener_->set_media_info_callback(
+      [&callback_media_info, &num_callbacks](const MediaInfo& media_info) {
+        callback_media_info = media_info;
+        ++num_callbacks;
+      });
+
+  std::shared_ptr<StreamInfo> stream_info =
+      CreateVideoStreamInfo(GetDefaultVideoStreamInfoParams());
+  FireOnMediaStartWithDefaultMuxerOptions(*stream_info, !kEnableEncryption);
+  FireOnMediaEndWithParams(GetDefaultOnMediaEndParams());
+
+  ASSERT_EQ(1, num_callbacks);
+  EXPECT_EQ("test_output_file_name.mp4", callback_media_info.media_file_name());
+
+  std::string file_content;
+  ASSERT_TRUE(File::ReadFileToString(temp_file_path_.c_str(), &file_content));
+  MediaInfo file_media_info;
+  ASSERT_TRUE(file_media_info.ParseFromString(file_content));
+  EXPECT_TRUE(::google::protobuf::util::MessageDifferencer::Equals(
+      callback_media_info, file_media_info));
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -46,10 +46,46 @@ bool IsTransparent(const RgbaColor* colors, uint16_t width, uint16_t height) {
   return true;
 }
 
-bool GetImageData(const DvbImageBuilder* image,
-                  std::vector<uint8_t>* data,
-                  uint16_t* width,
-                  uint16_t* height) {
+// Hashes the visible pixels of an image (64-bit FNV-1a).  Rows are
+// |stride| pixels apart, but only the first |width| pixels of each are used.
+uint64_t HashPixels(const RgbaColor* pixels,
+                    size_t stride,
+                    uint16_t width,
+                    uint16_t height) {
+  const uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ull;
+  const uint64_t kFnvPrime = 0x100000001b3ull;
+
+  uint64_t hash = kFnvOffsetBasis;
+  for (size_t y = 0; y < height; y++) {
+    const uint8_t* row = reinterpret_cast<const uint8_t*>(pixels + stride * y);
+    for (size_t i = 0; i < width * sizeof(RgbaColor); i++) {
+      hash ^= row[i];
+      hash *= kFnvPrime;
+    }
+  }
+  return hash;
+}
+
+bool SamePixels(const std::vector<RgbaColor>& cached_pixels,
+                const RgbaColor* pixels,
+                size_t stride,
+                uint16_t width,
+                uint16_t height) {
+  DCHECK_EQ(cached_pixels.size(), static_cast<size_t>(width) * height);
+  for (size_t y = 0; y < height; y++) {
+    if (memcmp(&cached_pixels[width * y], pixels + stride * y,
+               width * sizeof(RgbaColor)) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool EncodePng(const RgbaColor* pixels,
+               size_t stride,
+               uint16_t width,
+               uint16_t height,
+               std::vector<uint8_t>* data) {
   // CAREFUL in this method since this uses long-jumps.  A long-jump causes the
   // execution to jump to another point *without executing returns*.  This
   // causes C++ objects to not get destroyed.  This also causes the same code to
@@ -74,19 +110,14 @@ bool GetImageData(const DvbImageBuilder* image,
   }
   png_set_write_fn(png, data, &PngWriteData, &PngFlushData);
 
-  const RgbaColor* pixels;
-  if (!image->GetPixels(&pixels, width, height))
-    return false;
-  if (IsTransparent(pixels, *width, *height))
-    return true;  // Skip empty/transparent images.
-  png_set_IHDR(png, info, *width, *height, 8, PNG_COLOR_TYPE_RGBA,
+  png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_RGBA,
                PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE,
                PNG_FILTER_TYPE_BASE);
   png_write_info(png, info);
 
   const uint8_t* in_data = reinterpret_cast<const uint8_t*>(pixels);
-  for (size_t y = 0; y < *height; y++) {
-    size_t offset = image->max_width() * y * sizeof(RgbaColor);
+  for (size_t y = 0; y < height; y++) {
+    size_t offset = stride * y * sizeof(RgbaColor);
     png_write_row(png, in_data + offset);
   }
   png_write_end(png, nullptr);
@@ -217,14 +248,18 @@ bool SubtitleComposer::GetSamples(
     }
 
     uint16_t width, height;
-    std::vector<uint8_t> image_data;
-    if (!GetImageData(&it->second, &image_data, &width, &height))
+    const RgbaColor* pixels;
+    if (!it->second.GetPixels(&pixels, &width, &height))
       return false;
-    if (image_data.empty()) {
+    if (IsTransparent(pixels, width, height)) {
       VLOG(1) << "Skipping transparent object";
       continue;
     }
-    TextFragment body({}, image_data);
+    const std::vector<uint8_t>* image_data =
+        GetPngImage(pixels, it->second.max_width(), width, height);
+    if (!image_data)
+      return false;
+    TextFragment body({}, *image_data);
     DCHECK_LE(width, display_width_);
     DCHECK_LE(height, display_height_);
 
@@ -247,6 +282,39 @@ bool SubtitleComposer::GetSamples(
   return true;
 }
 
+const std::vector<uint8_t>* SubtitleComposer::GetPngImage(
+    const RgbaColor* pixels,
+    size_t stride,
+    uint16_t width,
+    uint16_t height) const {
+  const uint64_t hash = HashPixels(pixels, stride, width, height);
+  for (auto it = png_cache_.begin(); it != png_cache_.end(); ++it) {
+    if (it->hash == hash && it->width == width && it->height == height &&
+        SamePixels(it->pixels, pixels, stride, width, height)) {
+      // Keep the most recently used image at the front.
+      png_cache_.splice(png_cache_.begin(), png_cache_, it);
+      return &png_cache_.front().data;
+    }
+  }
+
+  CachedPng png;
+  png.hash = hash;
+  png.width = width;
+  png.height = height;
+  png.pixels.reserve(static_cast<size_t>(width) * height);
+  for (size_t y = 0; y < height; y++) {
+    png.pixels.insert(png.pixels.end(), pixels + stride * y,
+                      pixels + stride * y + width);
+  }
+  if (!EncodePng(pixels, stride, width, height, &png.data))
+    return nullptr;
+
+  png_cache_.push_front(std::move(png));
+  if (png_cache_.size() > kMaxCachedPngImages)
+    png_cache_.pop_back();
+  return &png_cache_.front().data;
+}
+
 void SubtitleComposer::ClearObjects() {
   regions_.clear();
   objects_.clear();
@@ -7,6 +7,7 @@
 #ifndef PACKAGER_MEDIA_DVB_SUBTITLE_COMPOSER_H_
 #define PACKAGER_MEDIA_DVB_SUBTITLE_COMPOSER_H_
 
+#include <list>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -64,6 +65,29 @@ class SubtitleComposer {
     uint16_t y = 0;
   };
 
+  struct CachedPng {
+    uint64_t hash = 0;
+    uint16_t width = 0;
+    uint16_t height = 0;
+    // The visible pixels, with the palette already applied, so that a hash
+    // collision is not mistaken for the same image.
+    std::vector<RgbaColor> pixels;
+    std::vector<uint8_t> data;
+  };
+
+  // Returns the PNG encoding of the given pixels, reusing a cached encoding
+  // when the same image was output recently.  Returns nullptr on error.
+  const std::vector<uint8_t>* GetPngImage(const RgbaColor* pixels,
+                                          size_t stride,
+                                          uint16_t width,
+                                          uint16_t height) const;
+
+  // DVB-sub pages are often sent repeatedly with the same content, so keep the
+  // last few encoded images, most recently used first, to avoid encoding the
+  // same image again.  This is kept across ClearObjects.
+  static constexpr size_t kMaxCachedPngImages = 8;
+  mutable std::list<CachedPng> png_cache_;
+
   // Maps of IDs to their respective object.
   std::unordered_map<uint8_t, RegionInfo> regions_;
   std::unordered_map<uint8_t, DvbImageColorSpace> color_spaces_;
@@ -143,6 +143,40 @@ TEST(SubtitleComposerTest, ClearObjects) {
   EXPECT_EQ(samples.size(), 1u);
 }
 
+TEST(SubtitleComposerTest, ReusesImagesOfRepeatedPages) {
+  const uint8_t kColorSpaceId = 2;
+  const uint16_t kObjectId = 5;
+  const uint16_t kRegionId = 1;
+
+  SubtitleComposer composer;
+  std::vector<std::shared_ptr<TextSample>> samples;
+  for (int page = 0; page < 2; page++) {
+    composer.ClearObjects();
+    ASSERT_TRUE(composer.SetRegionInfo(kRegionId, kColorSpaceId, 10, 10));
+    ASSERT_TRUE(
+        composer.SetObjectInfo(kObjectId, kRegionId, 0, 0, kNoBgColor));
+    CreateDefaultImage(&composer, kObjectId);
+    ASSERT_TRUE(composer.GetSamples(page, page + 1, &samples));
+  }
+
+  // A different image shouldn't reuse the previous one.
+  composer.ClearObjects();
+  ASSERT_TRUE(composer.SetRegionInfo(kRegionId, kColorSpaceId, 10, 10));
+  ASSERT_TRUE(composer.SetObjectInfo(kObjectId, kRegionId, 0, 0, kNoBgColor));
+  {
+    auto* image = composer.GetObjectImage(kObjectId);
+    EXPECT_TRUE(image->AddPixel(BitDepth::k8Bit, 1, true));
+    EXPECT_TRUE(image->AddPixel(BitDepth::k8Bit, 1, true));
+    image->NewRow(true);
+  }
+  ASSERT_TRUE(composer.GetSamples(2, 3, &samples));
+
+  ASSERT_EQ(samples.size(), 3u);
+  EXPECT_FALSE(samples[0]->body().image.empty());
+  EXPECT_EQ(samples[0]->body().image, samples[1]->body().image);
+  EXPECT_NE(samples[0]->body().image, samples[2]->body().image);
+}
+
 TEST(SubtitleComposerTest, IgnoresEmptyImages) {
   const uint8_t kColorSpaceId = 1;
   const uint16_t kRegionId = 1;
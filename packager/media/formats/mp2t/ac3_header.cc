@@ -130,6 +130,30 @@ size_t Ac3Header::GetFrameSizeWithoutParsing(const uint8_t* data,
   return CalcFrameSize(fscod, frmsizecod);
 }
 
+bool Ac3Header::HasSameFixedFields(const uint8_t* data) const {
+  // The lsb of frmsizecod only selects the frame size at 44.1 kHz.
+  const uint8_t fscod = data[4] >> 6;
+  const uint8_t bit_rate_code = (data[4] & 0x3f) >> 1;
+  const uint8_t bsid = data[5] >> 3;
+  const uint8_t bsmod = data[5] & 0x07;
+  const uint8_t acmod = data[6] >> 5;
+  if (fscod != fscod_ || bit_rate_code != frmsizecod_ >> 1 || bsid != bsid_ ||
+      bsmod != bsmod_ || acmod != acmod_) {
+    return false;
+  }
+  // lfeon follows the optional mixing levels, see Parse.
+  size_t lfeon_bit_position = 51;
+  if ((acmod_ & 0x01) && (acmod_ != 0x01))
+    lfeon_bit_position += 2;
+  if (acmod_ & 0x04)
+    lfeon_bit_position += 2;
+  if (acmod_ == 0x02)
+    lfeon_bit_position += 2;
+  const uint8_t lfeon =
+      (data[lfeon_bit_position / 8] >> (7 - lfeon_bit_position % 8)) & 0x01;
+  return lfeon == lfeon_;
+}
+
 void Ac3Header::GetAudioSpecificConfig(std::vector<uint8_t>* buffer) const {
   DCHECK(buffer);
   buffer->clear();
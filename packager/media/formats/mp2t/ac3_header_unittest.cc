@@ -161,6 +161,22 @@ TEST_F(Ac3HeaderTest, ParseVariousDataSize) {
   EXPECT_FALSE(ac3_header.Parse(ac3_frame_44100_hz_.data(), 5));
 }
 
+TEST_F(Ac3HeaderTest, HasSameFixedFields) {
+  Ac3Header ac3_header;
+  ASSERT_TRUE(ac3_header.Parse(ac3_frame_44100_hz_.data(),
+                               ac3_frame_44100_hz_.size()));
+  EXPECT_TRUE(ac3_header.HasSameFixedFields(ac3_frame_44100_hz_.data()));
+  EXPECT_FALSE(ac3_header.HasSameFixedFields(ac3_frame_48k_hz_.data()));
+  EXPECT_FALSE(ac3_header.HasSameFixedFields(ac3_frame_six_channels_.data()));
+
+  // The frame size code may change by its lsb at 44.1 kHz.
+  std::vector<uint8_t> frame = ac3_frame_44100_hz_;
+  frame[4] ^= 0x01;
+  EXPECT_TRUE(ac3_header.HasSameFixedFields(frame.data()));
+  frame[4] ^= 0x02;
+  EXPECT_FALSE(ac3_header.HasSameFixedFields(frame.data()));
+}
+
 }  // Namespace mp2t
 }  // namespace media
 }  // namespace shaka
@@ -98,6 +98,19 @@ size_t AdtsHeader::GetFrameSizeWithoutParsing(const uint8_t* data,
           ((static_cast<int>(data[3]) & 0x3) << 11));
 }
 
+bool AdtsHeader::HasSameFixedFields(const uint8_t* data) const {
+  const uint8_t protection_absent = data[1] & 0x01;
+  const uint8_t profile = data[2] >> 6;
+  const uint8_t sampling_frequency_index = (data[2] >> 2) & 0x0f;
+  const uint8_t channel_configuration =
+      ((data[2] & 0x01) << 2) | (data[3] >> 6);
+  const uint8_t num_blocks_minus_1 = data[6] & 0x03;
+  return protection_absent == protection_absent_ && profile == profile_ &&
+         sampling_frequency_index == sampling_frequency_index_ &&
+         channel_configuration == channel_configuration_ &&
+         num_blocks_minus_1 == 0;
+}
+
 void AdtsHeader::GetAudioSpecificConfig(std::vector<uint8_t>* buffer) const {
   DCHECK(buffer);
   buffer->clear();
@@ -33,6 +33,7 @@ class AdtsHeader : public AudioHeader {
   size_t GetFrameSize() const override;
   size_t GetFrameSizeWithoutParsing(const uint8_t* data,
                                     size_t num_bytes) const override;
+  bool HasSameFixedFields(const uint8_t* data) const override;
   void GetAudioSpecificConfig(std::vector<uint8_t>* buffer) const override;
   uint8_t GetObjectType() const override;
   uint32_t GetSamplingFrequency() const override;
@@ -92,6 +92,22 @@ TEST_F(AdtsHeaderTest, ParseVariousDataSize) {
   EXPECT_FALSE(adts_header.Parse(adts_frame_.data(), header_size - 1));
 }
 
+TEST_F(AdtsHeaderTest, HasSameFixedFields) {
+  AdtsHeader adts_header;
+  ASSERT_TRUE(adts_header.Parse(adts_frame_.data(), adts_frame_.size()));
+  EXPECT_TRUE(adts_header.HasSameFixedFields(adts_frame_.data()));
+
+  // The frame size and the buffer fullness may change.
+  std::vector<uint8_t> frame = adts_frame_;
+  frame[4] ^= 0xff;
+  frame[5] ^= 0xff;
+  EXPECT_TRUE(adts_header.HasSameFixedFields(frame.data()));
+
+  // The sampling frequency index may not.
+  frame[2] ^= 0x04;
+  EXPECT_FALSE(adts_header.HasSameFixedFields(frame.data()));
+}
+
 }  // Namespace mp2t
 }  // namespace media
 }  // namespace shaka
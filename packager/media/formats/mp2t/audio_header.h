@@ -55,6 +55,16 @@ class AudioHeader {
   virtual size_t GetFrameSizeWithoutParsing(const uint8_t* data,
                                             size_t num_bytes) const = 0;
 
+  /// Check whether the header of a frame has the same fields as the last
+  /// parsed header, except the ones which may change from frame to frame
+  /// without changing the audio configuration, e.g. the frame size. Such a
+  /// frame does not need a full Parse.
+  /// Should only be called after a successful Parse.
+  /// @param data points to the frame. Must be at least GetMinFrameSize()
+  ///        bytes and start with a syncword.
+  /// @return true if the header has the same fields.
+  virtual bool HasSameFixedFields(const uint8_t* data) const = 0;
+
   /// Synthesize an AudioSpecificConfig record from the fields within the audio
   /// header.
   /// Should only be called after a successful Parse.
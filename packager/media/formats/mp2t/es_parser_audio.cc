@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <list>
 
 #include <absl/log/check.h>
@@ -38,6 +39,7 @@ namespace mp2t {
 // Return whether a syncword was found.
 static bool LookForSyncWord(const uint8_t* raw_es,
                             int raw_es_size,
+                            uint8_t sync_byte,
                             int pos,
                             int* new_pos,
                             AudioHeader* audio_header) {
@@ -58,6 +60,13 @@ static bool LookForSyncWord(const uint8_t* raw_es,
   }
 
   for (int offset = pos; offset < max_offset; offset++) {
+    // Skip to the next candidate with memchr, which is vectorized.
+    const void* sync_byte_ptr =
+        memchr(&raw_es[offset], sync_byte, max_offset - offset);
+    if (!sync_byte_ptr)
+      break;
+    offset = static_cast<int>(static_cast<const uint8_t*>(sync_byte_ptr) -
+                              raw_es);
     const uint8_t* cur_buf = &raw_es[offset];
 
     if (!audio_header->IsSyncWord(cur_buf))
@@ -90,6 +99,28 @@ static bool LookForSyncWord(const uint8_t* raw_es,
   return false;
 }
 
+// Check whether a full frame at |pos| has the same configuration as the last
+// frame parsed by |audio_header|, which is the case of every frame once the
+// stream is synchronized. It is then not parsed again.
+// |frame_size| returns the size of the frame if so.
+static bool IsFrameWithSameFixedFields(const uint8_t* raw_es,
+                                       int raw_es_size,
+                                       int pos,
+                                       const AudioHeader& audio_header,
+                                       size_t* frame_size) {
+  const size_t remaining_size = static_cast<size_t>(raw_es_size - pos);
+  if (remaining_size < audio_header.GetMinFrameSize())
+    return false;
+  const uint8_t* frame = &raw_es[pos];
+  if (!audio_header.IsSyncWord(frame) ||
+      !audio_header.HasSameFixedFields(frame)) {
+    return false;
+  }
+  *frame_size = audio_header.GetFrameSizeWithoutParsing(frame, remaining_size);
+  return *frame_size >= audio_header.GetMinFrameSize() &&
+         *frame_size <= remaining_size;
+}
+
 EsParserAudio::EsParserAudio(uint32_t pid,
                              TsStreamType stream_type,
                              const NewStreamInfoCB& new_stream_info_cb,
@@ -102,12 +133,15 @@ EsParserAudio::EsParserAudio(uint32_t pid,
       sbr_in_mimetype_(sbr_in_mimetype) {
   if (stream_type == TsStreamType::kAc3) {
     audio_header_.reset(new Ac3Header);
+    sync_byte_ = 0x0B;
   } else if (stream_type == TsStreamType::kMpeg1Audio) {
     audio_header_.reset(new Mpeg1Header);
+    sync_byte_ = 0xFF;
   } else {
     DCHECK_EQ(static_cast<int>(stream_type),
               static_cast<int>(TsStreamType::kAdtsAac));
     audio_header_.reset(new AdtsHeader);
+    sync_byte_ = 0xFF;
   }
 }
 
@@ -133,11 +167,25 @@ bool EsParserAudio::Parse(const uint8_t* buf,
 
   // Look for every frame in the ES buffer starting at offset = 0
   int es_position = 0;
-  while (LookForSyncWord(raw_es, raw_es_size, es_position, &es_position,
-                         audio_header_.get())) {
+  while (true) {
+    // Once a configuration is signalled, the frames which keep it are only
+    // checked. The other ones are looked for and parsed.
+    size_t frame_size = 0;
+    bool is_parsed = false;
+    if (!last_audio_decoder_config_ ||
+        !IsFrameWithSameFixedFields(raw_es, raw_es_size, es_position,
+                                    *audio_header_, &frame_size)) {
+      if (!LookForSyncWord(raw_es, raw_es_size, sync_byte_, es_position,
+                           &es_position, audio_header_.get())) {
+        break;
+      }
+      frame_size = audio_header_->GetFrameSize();
+      is_parsed = true;
+    }
+
     const uint8_t* frame_ptr = raw_es + es_position;
     DVLOG(LOG_LEVEL_ES) << "syncword @ pos=" << es_position
-                        << " frame_size=" << audio_header_->GetFrameSize();
+                        << " frame_size=" << frame_size;
     DVLOG(LOG_LEVEL_ES) << "header: "
                         << absl::BytesToHexString(absl::string_view(
                                reinterpret_cast<const char*>(frame_ptr),
@@ -145,11 +193,11 @@ bool EsParserAudio::Parse(const uint8_t* buf,
 
     // Do not process the frame if this one is a partial frame.
     int remaining_size = raw_es_size - es_position;
-    if (static_cast<int>(audio_header_->GetFrameSize()) > remaining_size)
+    if (static_cast<int>(frame_size) > remaining_size)
       break;
 
     // Update the audio configuration if needed.
-    if (!UpdateAudioConfiguration(*audio_header_))
+    if (is_parsed && !UpdateAudioConfiguration(*audio_header_))
       return false;
 
     // Get the PTS & the duration of this access unit.
@@ -167,7 +215,7 @@ bool EsParserAudio::Parse(const uint8_t* buf,
 
     std::shared_ptr<MediaSample> sample = MediaSample::CopyFrom(
         frame_ptr + audio_header_->GetHeaderSize(),
-        audio_header_->GetFrameSize() - audio_header_->GetHeaderSize(),
+        frame_size - audio_header_->GetHeaderSize(),
         is_key_frame);
     sample->set_pts(current_pts);
     sample->set_dts(current_pts);
@@ -178,7 +226,7 @@ bool EsParserAudio::Parse(const uint8_t* buf,
     audio_timestamp_helper_->AddFrames(audio_header_->GetSamplesPerFrame());
 
     // Skip the current frame.
-    es_position += static_cast<int>(audio_header_->GetFrameSize());
+    es_position += static_cast<int>(frame_size);
   }
 
   // Discard all the bytes that have been processed.
@@ -57,6 +57,8 @@ class EsParserAudio : public EsParser {
 
   const TsStreamType stream_type_;
   std::unique_ptr<AudioHeader> audio_header_;
+  // The first byte of the syncwords of |audio_header_|.
+  uint8_t sync_byte_ = 0;
 
   // Callbacks:
   // - to signal a new audio configuration,
@@ -54,22 +54,29 @@ bool EsParserH264::ProcessNalu(const Nalu& nalu,
     case Nalu::H264_SPS: {
       DVLOG(LOG_LEVEL_ES) << "Nalu: SPS";
       int sps_id;
-      auto status = h264_parser_->ParseSps(nalu, &sps_id);
-      if (status == H264Parser::kOk)
-        decoder_config_check_pending_ = true;
-      else if (status == H264Parser::kUnsupportedStream)
+      bool is_repeated = false;
+      auto status = h264_parser_->ParseSps(nalu, &sps_id, &is_repeated);
+      if (status == H264Parser::kOk) {
+        // A SPS repeated unchanged, e.g. before every key frame, does not
+        // change the decoder config.
+        if (!is_repeated)
+          decoder_config_check_pending_ = true;
+      } else if (status == H264Parser::kUnsupportedStream) {
         // Indicate the stream can't be parsed.
         new_stream_info_cb_(nullptr);
-      else
+      } else {
         return false;
+      }
       break;
     }
     case Nalu::H264_PPS: {
       DVLOG(LOG_LEVEL_ES) << "Nalu: PPS";
       int pps_id;
-      auto status = h264_parser_->ParsePps(nalu, &pps_id);
+      bool is_repeated = false;
+      auto status = h264_parser_->ParsePps(nalu, &pps_id, &is_repeated);
       if (status == H264Parser::kOk) {
-        decoder_config_check_pending_ = true;
+        if (!is_repeated)
+          decoder_config_check_pending_ = true;
       } else if (status == H264Parser::kUnsupportedStream) {
         // Indicate the stream can't be parsed.
         new_stream_info_cb_(nullptr);
@@ -322,10 +322,9 @@ bool EsParserH26x::EmitFrame(int64_t access_unit_pos,
   media_sample->set_pts(current_timing_desc.pts);
   if (pending_sample_) {
     if (media_sample->dts() <= pending_sample_->dts()) {
-      LOG(WARNING) << "[MPEG-2 TS] PID " << pid() << " dts "
-                   << media_sample->dts()
-                   << " less than or equal to previous dts "
-                   << pending_sample_->dts();
+      LOG_RATE_LIMITED(WARNING)
+          << "[MPEG-2 TS] PID " << pid() << " dts " << media_sample->dts()
+          << " less than or equal to previous dts " << pending_sample_->dts();
       // Keep the sample but adjust the sample duration to a very small value,
       // in case that the sample is still needed for the decoding afterwards.
       const int64_t kArbitrarySmallDuration = 0.001 * kMpeg2Timescale;  // 1ms.
@@ -337,10 +336,11 @@ bool EsParserH26x::EmitFrame(int64_t access_unit_pos,
       const int kArbitraryGapScale = 10;
       if (pending_sample_duration_ &&
           sample_duration > kArbitraryGapScale * pending_sample_duration_) {
-        LOG(WARNING) << "[MPEG-2 TS] PID " << pid() << " Possible GAP at dts "
-                     << pending_sample_->dts() << " with next sample at dts "
-                     << media_sample->dts() << " (difference "
-                     << sample_duration << ")";
+        LOG_RATE_LIMITED(WARNING)
+            << "[MPEG-2 TS] PID " << pid() << " Possible GAP at dts "
+            << pending_sample_->dts() << " with next sample at dts "
+            << media_sample->dts() << " (difference " << sample_duration
+            << ")";
       }
 
       pending_sample_duration_ = sample_duration;
@@ -24,25 +24,22 @@ const uint8_t EBU_TELETEXT_WITH_SUBTITLING = 0x03;
 const int kPayloadSize = 40;
 const int kNumTriplets = 13;
 
-template <typename T>
-constexpr T bit(T value, const size_t bit_pos) {
-  return (value >> bit_pos) & 0x1;
-}
-
 uint8_t ReadHamming(BitReader& reader) {
   uint8_t bits;
   RCHECK(reader.ReadBits(8, &bits));
   return TELETEXT_HAMMING_8_4[bits];
 }
 
-bool Hamming_24_18(const uint32_t value, uint32_t& out_result) {
-  uint32_t result = value;
+// Decodes the Hamming 24/18 coded triplet at |data|, correcting single bit
+// errors.
+bool Hamming_24_18(const uint8_t* data, uint32_t& out_result) {
+  uint32_t result = (TELETEXT_BITREVERSE_8[data[2]] << 16) |
+                    (TELETEXT_BITREVERSE_8[data[1]] << 8) |
+                    TELETEXT_BITREVERSE_8[data[0]];
 
-  uint8_t test = 0;
-  for (uint8_t i = 0; i < 23; i++) {
-    test ^= ((result >> i) & 0x01) * (i + 0x21);
-  }
-  test ^= ((result >> 0x17) & 0x01) * 0x20;
+  const uint8_t test = TELETEXT_HAMMING_24_18_SYNDROME[0][data[0]] ^
+                       TELETEXT_HAMMING_24_18_SYNDROME[1][data[1]] ^
+                       TELETEXT_HAMMING_24_18_SYNDROME[2][data[2]];
 
   if ((test & 0x1f) != 0x1f) {
     if ((test & 0x20) == 0x20) {
@@ -149,10 +146,23 @@ bool EsParserTeletext::Flush() {
   return true;
 }
 
+void EsParserTeletext::SetSelectedPages(const std::set<uint16_t>& pages) {
+  selected_pages_ = pages;
+  selected_magazines_ = 0;
+  for (const uint16_t index : pages) {
+    const uint16_t magazine = index / 100;
+    if (magazine <= 8) {
+      selected_magazines_ |= 1 << magazine;
+    }
+  }
+  page_selected_ = selected_pages_.empty();
+}
+
 void EsParserTeletext::Reset() {
   page_state_.clear();
   magazine_ = 0;
   page_number_ = 0;
+  page_selected_ = selected_pages_.empty();
   sent_info_ = false;
   charset_code_ = 0;
   UpdateCharset();
@@ -186,22 +196,20 @@ bool EsParserTeletext::ParseInternal(const uint8_t* data,
 
     RCHECK(reader.SkipBits(16));
 
-    uint16_t address_bits;
-    RCHECK(reader.ReadBits(16, &address_bits));
-
-    uint8_t magazine = bit(address_bits, 14) + 2 * bit(address_bits, 12) +
-                       4 * bit(address_bits, 10);
+    const uint8_t address_low = ReadHamming(reader);
+    const uint8_t address_high = ReadHamming(reader);
+    const uint8_t* data_block = reader.current_byte_ptr();
+    RCHECK(reader.SkipBytes(40));
+    if (address_low == 0xff || address_high == 0xff) {
+      // The packet address cannot be corrected.
+      continue;
+    }
 
+    uint8_t magazine = address_low & 0x7;
     if (magazine == 0) {
       magazine = 8;
     }
-
-    const uint8_t packet_nr =
-        (bit(address_bits, 8) + 2 * bit(address_bits, 6) +
-         4 * bit(address_bits, 4) + 8 * bit(address_bits, 2) +
-         16 * bit(address_bits, 0));
-    const uint8_t* data_block = reader.current_byte_ptr();
-    RCHECK(reader.SkipBytes(40));
+    const uint8_t packet_nr = (address_low >> 3) | (address_high << 1);
 
     TextRow row;
     if (ParseDataBlock(pts, data_block, packet_nr, magazine, row)) {
@@ -237,15 +245,28 @@ bool EsParserTeletext::ParseDataBlock(const int64_t pts,
     last_pts_ = pts;
     BitReader reader(data_block, 32);
 
+    // The pages of the magazines without a selected page are not decoded.
+    if (!selected_pages_.empty() &&
+        (selected_magazines_ & (1 << magazine)) == 0) {
+      page_selected_ = false;
+      return false;
+    }
+
     const uint8_t page_number_units = ReadHamming(reader);
     const uint8_t page_number_tens = ReadHamming(reader);
-    if (page_number_units == 0xf || page_number_tens == 0xf) {
-      RCHECK(reader.SkipBits(40));
+    if (page_number_units == 0xf || page_number_tens == 0xf ||
+        page_number_units == 0xff || page_number_tens == 0xff) {
+      page_selected_ = selected_pages_.empty();
       return false;
     }
     const uint8_t page_number = 10 * page_number_tens + page_number_units;
 
     const uint16_t index = magazine * 100 + page_number;
+    page_selected_ =
+        selected_pages_.empty() || selected_pages_.count(index) > 0;
+    if (!page_selected_) {
+      return false;
+    }
     SendPending(index, pts);
 
     page_number_ = page_number;
@@ -254,13 +275,16 @@ bool EsParserTeletext::ParseDataBlock(const int64_t pts,
     RCHECK(reader.SkipBits(40));
     const uint8_t subcode_c11_c14 = ReadHamming(reader);
     const uint8_t charset_code = subcode_c11_c14 >> 1;
-    if (charset_code != charset_code_) {
+    if (subcode_c11_c14 != 0xff && charset_code != charset_code_) {
       charset_code_ = charset_code;
       UpdateCharset();
     }
 
     return false;
 
+  } else if (!page_selected_) {
+    return false;
+
   } else if (packet_nr == 26) {
     ParsePacket26(data_block);
     return false;
@@ -419,8 +443,7 @@ EsParserTeletext::TextRow EsParserTeletext::BuildRow(const uint8_t* data_block,
       }
     }
 
-    char next_char =
-        static_cast<char>(TELETEXT_BITREVERSE_8[data_block[i]] & 0x7f);
+    char next_char = static_cast<char>(TELETEXT_ODD_PARITY_7[data_block[i]]);
 
     if (next_char < 0x20) {
       // Here are control characters, which are not printable.
@@ -531,11 +554,8 @@ void EsParserTeletext::ParsePacket26(const uint8_t* data_block) {
   std::vector<uint32_t> x26_triplets;
   x26_triplets.reserve(kNumTriplets);
   for (uint8_t i = 1; i < kPayloadSize; i += 3) {
-    const uint32_t bytes = (TELETEXT_BITREVERSE_8[data_block[i + 2]] << 16) |
-                           (TELETEXT_BITREVERSE_8[data_block[i + 1]] << 8) |
-                           TELETEXT_BITREVERSE_8[data_block[i]];
     uint32_t triplet;
-    if (Hamming_24_18(bytes, triplet)) {
+    if (Hamming_24_18(data_block + i, triplet)) {
       x26_triplets.emplace_back(triplet);
     }
   }
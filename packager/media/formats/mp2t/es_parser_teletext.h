@@ -8,6 +8,7 @@
 #define PACKAGER_MEDIA_FORMATS_MP2T_ES_PARSER_TELETEXT_H_
 
 #include <cstdint>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -34,6 +35,12 @@ class EsParserTeletext : public EsParser {
   bool Flush() override;
   void Reset() override;
 
+  /// Only decode some of the pages, e.g. those of the cc_index of the
+  /// outputs. The packets of the other pages are skipped without decoding.
+  /// @param pages are the sub-stream indexes of the pages, i.e. the magazine
+  ///        number times 100 plus the page number, or empty for all pages.
+  void SetSelectedPages(const std::set<uint16_t>& pages);
+
  private:
   using RowColReplacementMap =
       std::unordered_map<uint8_t, std::unordered_map<uint8_t, std::string>>;
@@ -76,6 +83,11 @@ class EsParserTeletext : public EsParser {
   bool sent_info_ = false;
   uint8_t magazine_;
   uint8_t page_number_;
+  std::set<uint16_t> selected_pages_;
+  // Bit |m| is set if magazine |m| has a selected page.
+  uint16_t selected_magazines_ = 0;
+  // Whether the page being transmitted is decoded.
+  bool page_selected_ = true;
   std::unordered_map<uint16_t, TextBlock> page_state_;
   uint8_t charset_code_;
   char current_charset_[96][3];
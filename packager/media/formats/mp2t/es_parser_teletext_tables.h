@@ -37,29 +37,128 @@ const uint8_t TELETEXT_BITREVERSE_8[] = {
     0x0f, 0x8f, 0x4f, 0xcf, 0x2f, 0xaf, 0x6f, 0xef, 0x1f, 0x9f, 0x5f, 0xdf,
     0x3f, 0xbf, 0x7f, 0xff};
 
+// The 4 data bits of a Hamming 8/4 coded byte, with single bit errors
+// corrected, or 0xff if it has more.
 const uint8_t TELETEXT_HAMMING_8_4[] = {
-    0x00, 0x08, 0x00, 0x08, 0x04, 0x0c, 0x04, 0x0c, 0x00, 0x08, 0x00, 0x08,
-    0x04, 0x0c, 0x04, 0x0c, 0x02, 0x0a, 0x02, 0x0a, 0x06, 0x0e, 0x06, 0x0e,
-    0x02, 0x0a, 0x02, 0x0a, 0x06, 0x0e, 0x06, 0x0e, 0x00, 0x08, 0x00, 0x08,
-    0x04, 0x0c, 0x04, 0x0c, 0x00, 0x08, 0x00, 0x08, 0x04, 0x0c, 0x04, 0x0c,
-    0x02, 0x0a, 0x02, 0x0a, 0x06, 0x0e, 0x06, 0x0e, 0x02, 0x0a, 0x02, 0x0a,
-    0x06, 0x0e, 0x06, 0x0e, 0x01, 0x09, 0x01, 0x09, 0x05, 0x0d, 0x05, 0x0d,
-    0x01, 0x09, 0x01, 0x09, 0x05, 0x0d, 0x05, 0x0d, 0x03, 0x0b, 0x03, 0x0b,
-    0x07, 0x0f, 0x07, 0x0f, 0x03, 0x0b, 0x03, 0x0b, 0x07, 0x0f, 0x07, 0x0f,
-    0x01, 0x09, 0x01, 0x09, 0x05, 0x0d, 0x05, 0x0d, 0x01, 0x09, 0x01, 0x09,
-    0x05, 0x0d, 0x05, 0x0d, 0x03, 0x0b, 0x03, 0x0b, 0x07, 0x0f, 0x07, 0x0f,
-    0x03, 0x0b, 0x03, 0x0b, 0x07, 0x0f, 0x07, 0x0f, 0x00, 0x08, 0x00, 0x08,
-    0x04, 0x0c, 0x04, 0x0c, 0x00, 0x08, 0x00, 0x08, 0x04, 0x0c, 0x04, 0x0c,
-    0x02, 0x0a, 0x02, 0x0a, 0x06, 0x0e, 0x06, 0x0e, 0x02, 0x0a, 0x02, 0x0a,
-    0x06, 0x0e, 0x06, 0x0e, 0x00, 0x08, 0x00, 0x08, 0x04, 0x0c, 0x04, 0x0c,
-    0x00, 0x08, 0x00, 0x08, 0x04, 0x0c, 0x04, 0x0c, 0x02, 0x0a, 0x02, 0x0a,
-    0x06, 0x0e, 0x06, 0x0e, 0x02, 0x0a, 0x02, 0x0a, 0x06, 0x0e, 0x06, 0x0e,
-    0x01, 0x09, 0x01, 0x09, 0x05, 0x0d, 0x05, 0x0d, 0x01, 0x09, 0x01, 0x09,
-    0x05, 0x0d, 0x05, 0x0d, 0x03, 0x0b, 0x03, 0x0b, 0x07, 0x0f, 0x07, 0x0f,
-    0x03, 0x0b, 0x03, 0x0b, 0x07, 0x0f, 0x07, 0x0f, 0x01, 0x09, 0x01, 0x09,
-    0x05, 0x0d, 0x05, 0x0d, 0x01, 0x09, 0x01, 0x09, 0x05, 0x0d, 0x05, 0x0d,
-    0x03, 0x0b, 0x03, 0x0b, 0x07, 0x0f, 0x07, 0x0f, 0x03, 0x0b, 0x03, 0x0b,
-    0x07, 0x0f, 0x07, 0x0f};
+    0x01, 0xff, 0xff, 0x08, 0xff, 0x0c, 0x04, 0xff, 0xff, 0x08, 0x08, 0x08,
+    0x06, 0xff, 0xff, 0x08, 0xff, 0x0a, 0x02, 0xff, 0x06, 0xff, 0xff, 0x0f,
+    0x06, 0xff, 0xff, 0x08, 0x06, 0x06, 0x06, 0xff, 0xff, 0x0a, 0x04, 0xff,
+    0x04, 0xff, 0x04, 0x04, 0x00, 0xff, 0xff, 0x08, 0xff, 0x0d, 0x04, 0xff,
+    0x0a, 0x0a, 0xff, 0x0a, 0xff, 0x0a, 0x04, 0xff, 0xff, 0x0a, 0x03, 0xff,
+    0x06, 0xff, 0xff, 0x0e, 0x01, 0x01, 0x01, 0xff, 0x01, 0xff, 0xff, 0x0f,
+    0x01, 0xff, 0xff, 0x08, 0xff, 0x0d, 0x05, 0xff, 0x01, 0xff, 0xff, 0x0f,
+    0xff, 0x0f, 0x0f, 0x0f, 0xff, 0x0b, 0x03, 0xff, 0x06, 0xff, 0xff, 0x0f,
+    0x01, 0xff, 0xff, 0x09, 0xff, 0x0d, 0x04, 0xff, 0xff, 0x0d, 0x03, 0xff,
+    0x0d, 0x0d, 0xff, 0x0d, 0xff, 0x0a, 0x03, 0xff, 0x07, 0xff, 0xff, 0x0f,
+    0x03, 0xff, 0x03, 0x03, 0xff, 0x0d, 0x03, 0xff, 0xff, 0x0c, 0x02, 0xff,
+    0x0c, 0x0c, 0xff, 0x0c, 0x00, 0xff, 0xff, 0x08, 0xff, 0x0c, 0x05, 0xff,
+    0x02, 0xff, 0x02, 0x02, 0xff, 0x0c, 0x02, 0xff, 0xff, 0x0b, 0x02, 0xff,
+    0x06, 0xff, 0xff, 0x0e, 0x00, 0xff, 0xff, 0x09, 0xff, 0x0c, 0x04, 0xff,
+    0x00, 0x00, 0x00, 0xff, 0x00, 0xff, 0xff, 0x0e, 0xff, 0x0a, 0x02, 0xff,
+    0x07, 0xff, 0xff, 0x0e, 0x00, 0xff, 0xff, 0x0e, 0xff, 0x0e, 0x0e, 0x0e,
+    0x01, 0xff, 0xff, 0x09, 0xff, 0x0c, 0x05, 0xff, 0xff, 0x0b, 0x05, 0xff,
+    0x05, 0xff, 0x05, 0x05, 0xff, 0x0b, 0x02, 0xff, 0x07, 0xff, 0xff, 0x0f,
+    0x0b, 0x0b, 0xff, 0x0b, 0xff, 0x0b, 0x05, 0xff, 0xff, 0x09, 0x09, 0x09,
+    0x07, 0xff, 0xff, 0x09, 0x00, 0xff, 0xff, 0x09, 0xff, 0x0d, 0x05, 0xff,
+    0x07, 0xff, 0xff, 0x09, 0x07, 0x07, 0x07, 0xff, 0xff, 0x0b, 0x03, 0xff,
+    0x07, 0xff, 0xff, 0x0e};
+
+// The 7-bit character of an odd parity coded byte, or a space if its parity
+// is wrong.
+const uint8_t TELETEXT_ODD_PARITY_7[] = {
+    0x20, 0x00, 0x40, 0x20, 0x20, 0x20, 0x20, 0x60, 0x10, 0x20, 0x20, 0x50,
+    0x20, 0x30, 0x70, 0x20, 0x08, 0x20, 0x20, 0x48, 0x20, 0x28, 0x68, 0x20,
+    0x20, 0x18, 0x58, 0x20, 0x38, 0x20, 0x20, 0x78, 0x04, 0x20, 0x20, 0x44,
+    0x20, 0x24, 0x64, 0x20, 0x20, 0x14, 0x54, 0x20, 0x34, 0x20, 0x20, 0x74,
+    0x20, 0x0c, 0x4c, 0x20, 0x2c, 0x20, 0x20, 0x6c, 0x1c, 0x20, 0x20, 0x5c,
+    0x20, 0x3c, 0x7c, 0x20, 0x02, 0x20, 0x20, 0x42, 0x20, 0x22, 0x62, 0x20,
+    0x20, 0x12, 0x52, 0x20, 0x32, 0x20, 0x20, 0x72, 0x20, 0x0a, 0x4a, 0x20,
+    0x2a, 0x20, 0x20, 0x6a, 0x1a, 0x20, 0x20, 0x5a, 0x20, 0x3a, 0x7a, 0x20,
+    0x20, 0x06, 0x46, 0x20, 0x26, 0x20, 0x20, 0x66, 0x16, 0x20, 0x20, 0x56,
+    0x20, 0x36, 0x76, 0x20, 0x0e, 0x20, 0x20, 0x4e, 0x20, 0x2e, 0x6e, 0x20,
+    0x20, 0x1e, 0x5e, 0x20, 0x3e, 0x20, 0x20, 0x7e, 0x01, 0x20, 0x20, 0x41,
+    0x20, 0x21, 0x61, 0x20, 0x20, 0x11, 0x51, 0x20, 0x31, 0x20, 0x20, 0x71,
+    0x20, 0x09, 0x49, 0x20, 0x29, 0x20, 0x20, 0x69, 0x19, 0x20, 0x20, 0x59,
+    0x20, 0x39, 0x79, 0x20, 0x20, 0x05, 0x45, 0x20, 0x25, 0x20, 0x20, 0x65,
+    0x15, 0x20, 0x20, 0x55, 0x20, 0x35, 0x75, 0x20, 0x0d, 0x20, 0x20, 0x4d,
+    0x20, 0x2d, 0x6d, 0x20, 0x20, 0x1d, 0x5d, 0x20, 0x3d, 0x20, 0x20, 0x7d,
+    0x20, 0x03, 0x43, 0x20, 0x23, 0x20, 0x20, 0x63, 0x13, 0x20, 0x20, 0x53,
+    0x20, 0x33, 0x73, 0x20, 0x0b, 0x20, 0x20, 0x4b, 0x20, 0x2b, 0x6b, 0x20,
+    0x20, 0x1b, 0x5b, 0x20, 0x3b, 0x20, 0x20, 0x7b, 0x07, 0x20, 0x20, 0x47,
+    0x20, 0x27, 0x67, 0x20, 0x20, 0x17, 0x57, 0x20, 0x37, 0x20, 0x20, 0x77,
+    0x20, 0x0f, 0x4f, 0x20, 0x2f, 0x20, 0x20, 0x6f, 0x1f, 0x20, 0x20, 0x5f,
+    0x20, 0x3f, 0x7f, 0x20};
+
+// The contribution of each of the 3 bytes of a Hamming 24/18 coded triplet
+// to its syndrome: the syndrome of a triplet is the XOR of the entries of its
+// bytes.
+const uint8_t TELETEXT_HAMMING_24_18_SYNDROME[3][256] = {
+    {0x00, 0x28, 0x27, 0x0f, 0x26, 0x0e, 0x01, 0x29, 0x25, 0x0d, 0x02, 0x2a,
+     0x03, 0x2b, 0x24, 0x0c, 0x24, 0x0c, 0x03, 0x2b, 0x02, 0x2a, 0x25, 0x0d,
+     0x01, 0x29, 0x26, 0x0e, 0x27, 0x0f, 0x00, 0x28, 0x23, 0x0b, 0x04, 0x2c,
+     0x05, 0x2d, 0x22, 0x0a, 0x06, 0x2e, 0x21, 0x09, 0x20, 0x08, 0x07, 0x2f,
+     0x07, 0x2f, 0x20, 0x08, 0x21, 0x09, 0x06, 0x2e, 0x22, 0x0a, 0x05, 0x2d,
+     0x04, 0x2c, 0x23, 0x0b, 0x22, 0x0a, 0x05, 0x2d, 0x04, 0x2c, 0x23, 0x0b,
+     0x07, 0x2f, 0x20, 0x08, 0x21, 0x09, 0x06, 0x2e, 0x06, 0x2e, 0x21, 0x09,
+     0x20, 0x08, 0x07, 0x2f, 0x23, 0x0b, 0x04, 0x2c, 0x05, 0x2d, 0x22, 0x0a,
+     0x01, 0x29, 0x26, 0x0e, 0x27, 0x0f, 0x00, 0x28, 0x24, 0x0c, 0x03, 0x2b,
+     0x02, 0x2a, 0x25, 0x0d, 0x25, 0x0d, 0x02, 0x2a, 0x03, 0x2b, 0x24, 0x0c,
+     0x00, 0x28, 0x27, 0x0f, 0x26, 0x0e, 0x01, 0x29, 0x21, 0x09, 0x06, 0x2e,
+     0x07, 0x2f, 0x20, 0x08, 0x04, 0x2c, 0x23, 0x0b, 0x22, 0x0a, 0x05, 0x2d,
+     0x05, 0x2d, 0x22, 0x0a, 0x23, 0x0b, 0x04, 0x2c, 0x20, 0x08, 0x07, 0x2f,
+     0x06, 0x2e, 0x21, 0x09, 0x02, 0x2a, 0x25, 0x0d, 0x24, 0x0c, 0x03, 0x2b,
+     0x27, 0x0f, 0x00, 0x28, 0x01, 0x29, 0x26, 0x0e, 0x26, 0x0e, 0x01, 0x29,
+     0x00, 0x28, 0x27, 0x0f, 0x03, 0x2b, 0x24, 0x0c, 0x25, 0x0d, 0x02, 0x2a,
+     0x03, 0x2b, 0x24, 0x0c, 0x25, 0x0d, 0x02, 0x2a, 0x26, 0x0e, 0x01, 0x29,
+     0x00, 0x28, 0x27, 0x0f, 0x27, 0x0f, 0x00, 0x28, 0x01, 0x29, 0x26, 0x0e,
+     0x02, 0x2a, 0x25, 0x0d, 0x24, 0x0c, 0x03, 0x2b, 0x20, 0x08, 0x07, 0x2f,
+     0x06, 0x2e, 0x21, 0x09, 0x05, 0x2d, 0x22, 0x0a, 0x23, 0x0b, 0x04, 0x2c,
+     0x04, 0x2c, 0x23, 0x0b, 0x22, 0x0a, 0x05, 0x2d, 0x21, 0x09, 0x06, 0x2e,
+     0x07, 0x2f, 0x20, 0x08},
+    {0x00, 0x30, 0x2f, 0x1f, 0x2e, 0x1e, 0x01, 0x31, 0x2d, 0x1d, 0x02, 0x32,
+     0x03, 0x33, 0x2c, 0x1c, 0x2c, 0x1c, 0x03, 0x33, 0x02, 0x32, 0x2d, 0x1d,
+     0x01, 0x31, 0x2e, 0x1e, 0x2f, 0x1f, 0x00, 0x30, 0x2b, 0x1b, 0x04, 0x34,
+     0x05, 0x35, 0x2a, 0x1a, 0x06, 0x36, 0x29, 0x19, 0x28, 0x18, 0x07, 0x37,
+     0x07, 0x37, 0x28, 0x18, 0x29, 0x19, 0x06, 0x36, 0x2a, 0x1a, 0x05, 0x35,
+     0x04, 0x34, 0x2b, 0x1b, 0x2a, 0x1a, 0x05, 0x35, 0x04, 0x34, 0x2b, 0x1b,
+     0x07, 0x37, 0x28, 0x18, 0x29, 0x19, 0x06, 0x36, 0x06, 0x36, 0x29, 0x19,
+     0x28, 0x18, 0x07, 0x37, 0x2b, 0x1b, 0x04, 0x34, 0x05, 0x35, 0x2a, 0x1a,
+     0x01, 0x31, 0x2e, 0x1e, 0x2f, 0x1f, 0x00, 0x30, 0x2c, 0x1c, 0x03, 0x33,
+     0x02, 0x32, 0x2d, 0x1d, 0x2d, 0x1d, 0x02, 0x32, 0x03, 0x33, 0x2c, 0x1c,
+     0x00, 0x30, 0x2f, 0x1f, 0x2e, 0x1e, 0x01, 0x31, 0x29, 0x19, 0x06, 0x36,
+     0x07, 0x37, 0x28, 0x18, 0x04, 0x34, 0x2b, 0x1b, 0x2a, 0x1a, 0x05, 0x35,
+     0x05, 0x35, 0x2a, 0x1a, 0x2b, 0x1b, 0x04, 0x34, 0x28, 0x18, 0x07, 0x37,
+     0x06, 0x36, 0x29, 0x19, 0x02, 0x32, 0x2d, 0x1d, 0x2c, 0x1c, 0x03, 0x33,
+     0x2f, 0x1f, 0x00, 0x30, 0x01, 0x31, 0x2e, 0x1e, 0x2e, 0x1e, 0x01, 0x31,
+     0x00, 0x30, 0x2f, 0x1f, 0x03, 0x33, 0x2c, 0x1c, 0x2d, 0x1d, 0x02, 0x32,
+     0x03, 0x33, 0x2c, 0x1c, 0x2d, 0x1d, 0x02, 0x32, 0x2e, 0x1e, 0x01, 0x31,
+     0x00, 0x30, 0x2f, 0x1f, 0x2f, 0x1f, 0x00, 0x30, 0x01, 0x31, 0x2e, 0x1e,
+     0x02, 0x32, 0x2d, 0x1d, 0x2c, 0x1c, 0x03, 0x33, 0x28, 0x18, 0x07, 0x37,
+     0x06, 0x36, 0x29, 0x19, 0x05, 0x35, 0x2a, 0x1a, 0x2b, 0x1b, 0x04, 0x34,
+     0x04, 0x34, 0x2b, 0x1b, 0x2a, 0x1a, 0x05, 0x35, 0x29, 0x19, 0x06, 0x36,
+     0x07, 0x37, 0x28, 0x18},
+    {0x00, 0x20, 0x37, 0x17, 0x36, 0x16, 0x01, 0x21, 0x35, 0x15, 0x02, 0x22,
+     0x03, 0x23, 0x34, 0x14, 0x34, 0x14, 0x03, 0x23, 0x02, 0x22, 0x35, 0x15,
+     0x01, 0x21, 0x36, 0x16, 0x37, 0x17, 0x00, 0x20, 0x33, 0x13, 0x04, 0x24,
+     0x05, 0x25, 0x32, 0x12, 0x06, 0x26, 0x31, 0x11, 0x30, 0x10, 0x07, 0x27,
+     0x07, 0x27, 0x30, 0x10, 0x31, 0x11, 0x06, 0x26, 0x32, 0x12, 0x05, 0x25,
+     0x04, 0x24, 0x33, 0x13, 0x32, 0x12, 0x05, 0x25, 0x04, 0x24, 0x33, 0x13,
+     0x07, 0x27, 0x30, 0x10, 0x31, 0x11, 0x06, 0x26, 0x06, 0x26, 0x31, 0x11,
+     0x30, 0x10, 0x07, 0x27, 0x33, 0x13, 0x04, 0x24, 0x05, 0x25, 0x32, 0x12,
+     0x01, 0x21, 0x36, 0x16, 0x37, 0x17, 0x00, 0x20, 0x34, 0x14, 0x03, 0x23,
+     0x02, 0x22, 0x35, 0x15, 0x35, 0x15, 0x02, 0x22, 0x03, 0x23, 0x34, 0x14,
+     0x00, 0x20, 0x37, 0x17, 0x36, 0x16, 0x01, 0x21, 0x31, 0x11, 0x06, 0x26,
+     0x07, 0x27, 0x30, 0x10, 0x04, 0x24, 0x33, 0x13, 0x32, 0x12, 0x05, 0x25,
+     0x05, 0x25, 0x32, 0x12, 0x33, 0x13, 0x04, 0x24, 0x30, 0x10, 0x07, 0x27,
+     0x06, 0x26, 0x31, 0x11, 0x02, 0x22, 0x35, 0x15, 0x34, 0x14, 0x03, 0x23,
+     0x37, 0x17, 0x00, 0x20, 0x01, 0x21, 0x36, 0x16, 0x36, 0x16, 0x01, 0x21,
+     0x00, 0x20, 0x37, 0x17, 0x03, 0x23, 0x34, 0x14, 0x35, 0x15, 0x02, 0x22,
+     0x03, 0x23, 0x34, 0x14, 0x35, 0x15, 0x02, 0x22, 0x36, 0x16, 0x01, 0x21,
+     0x00, 0x20, 0x37, 0x17, 0x37, 0x17, 0x00, 0x20, 0x01, 0x21, 0x36, 0x16,
+     0x02, 0x22, 0x35, 0x15, 0x34, 0x14, 0x03, 0x23, 0x30, 0x10, 0x07, 0x27,
+     0x06, 0x26, 0x31, 0x11, 0x05, 0x25, 0x32, 0x12, 0x33, 0x13, 0x04, 0x24,
+     0x04, 0x24, 0x33, 0x13, 0x32, 0x12, 0x05, 0x25, 0x31, 0x11, 0x06, 0x26,
+     0x07, 0x27, 0x30, 0x10}};
 
 const uint8_t TELETEXT_CHARSET_G0_LATIN[96][3] = {
     {0x20, 0x0, 0x0},  {0x21, 0x0, 0x0},  {0x22, 0x0, 0x0},  {0xc2, 0xa3, 0x0},
@@ -300,6 +300,49 @@ TEST_F(EsParserTeletextTest, pes_283413_line_emitted_on_next_pes) {
   EXPECT_EQ(TextUnitType::kLines, settings.line.value().type);
 }
 
+TEST_F(EsParserTeletextTest, selected_page_is_emitted) {
+  auto on_new_stream = std::bind(&EsParserTeletextTest::OnNewStreamInfo, this,
+                                 kPesPid, std::placeholders::_1);
+  auto on_emit_text = std::bind(&EsParserTeletextTest::OnEmitTextSample, this,
+                                kPesPid, std::placeholders::_1);
+
+  std::unique_ptr<EsParserTeletext> es_parser_teletext(new EsParserTeletext(
+      kPesPid, on_new_stream, on_emit_text, DESCRIPTOR, 12));
+  es_parser_teletext->SetSelectedPages({888});
+
+  EXPECT_TRUE(
+      es_parser_teletext->Parse(PES_283413, sizeof(PES_283413), 283413, 0));
+  EXPECT_TRUE(
+      es_parser_teletext->Parse(PES_407876, sizeof(PES_407876), 407876, 0));
+
+  ASSERT_NE(nullptr, text_sample_.get());
+  EXPECT_EQ(888, text_sample_->sub_stream_index());
+  EXPECT_EQ("Bon dia!", text_sample_->body().body);
+}
+
+TEST_F(EsParserTeletextTest, unselected_pages_are_skipped) {
+  auto on_new_stream = std::bind(&EsParserTeletextTest::OnNewStreamInfo, this,
+                                 kPesPid, std::placeholders::_1);
+  auto on_emit_text = std::bind(&EsParserTeletextTest::OnEmitTextSample, this,
+                                kPesPid, std::placeholders::_1);
+
+  std::unique_ptr<EsParserTeletext> es_parser_teletext(new EsParserTeletext(
+      kPesPid, on_new_stream, on_emit_text, DESCRIPTOR, 12));
+  // Page 888 is in magazine 8, page 101 in magazine 1 and page 899 in
+  // magazine 8 too.
+  es_parser_teletext->SetSelectedPages({101, 899});
+
+  EXPECT_TRUE(
+      es_parser_teletext->Parse(PES_283413, sizeof(PES_283413), 283413, 0));
+  EXPECT_TRUE(
+      es_parser_teletext->Parse(PES_407876, sizeof(PES_407876), 407876, 0));
+  EXPECT_TRUE(es_parser_teletext->Flush());
+
+  // The sub-streams are still announced, but no page is decoded.
+  EXPECT_NE(nullptr, stream_info_.get());
+  EXPECT_TRUE(text_samples_.empty());
+}
+
 TEST_F(EsParserTeletextTest, multiple_lines_with_same_pts) {
   auto on_new_stream = std::bind(&EsParserTeletextTest::OnNewStreamInfo, this,
                                  kPesPid, std::placeholders::_1);
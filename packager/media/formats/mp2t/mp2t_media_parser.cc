@@ -193,64 +193,77 @@ bool Mp2tMediaParser::Flush() {
   return result;
 }
 
+void Mp2tMediaParser::SetSelectedTracks(const std::set<uint32_t>& track_ids) {
+  selected_pids_ = track_ids;
+  track_selection_pending_ = true;
+}
+
 bool Mp2tMediaParser::Parse(const uint8_t* buf, int size) {
   DVLOG(2) << "Mp2tMediaParser::Parse size=" << size;
 
   // Add the data to the parser state.
   ts_byte_queue_.Push(buf, size);
-
-  while (true) {
-    const uint8_t* ts_buffer;
-    int ts_buffer_size;
-    ts_byte_queue_.Peek(&ts_buffer, &ts_buffer_size);
-    if (ts_buffer_size < TsPacket::kPacketSize)
-      break;
+  if (track_selection_pending_)
+    ApplyTrackSelection();
+
+  // Parse all the complete TS packets in the queue and pop them at once. The
+  // same TsPacket is used for all of them.
+  const uint8_t* ts_buffer;
+  int ts_buffer_size;
+  ts_byte_queue_.Peek(&ts_buffer, &ts_buffer_size);
+  TsPacket ts_packet;
+  int offset = 0;
+  while (ts_buffer_size - offset >= TsPacket::kPacketSize) {
+    const uint8_t* const packet_buffer = ts_buffer + offset;
+    const int packet_buffer_size = ts_buffer_size - offset;
 
     // Synchronization.
-    int skipped_bytes = TsPacket::Sync(ts_buffer, ts_buffer_size);
+    int skipped_bytes = TsPacket::Sync(packet_buffer, packet_buffer_size);
     if (skipped_bytes > 0) {
       DVLOG(1) << "Packet not aligned on a TS syncword:"
                << " skipped_bytes=" << skipped_bytes;
-      ts_byte_queue_.Pop(skipped_bytes);
+      offset += skipped_bytes;
       continue;
     }
 
     // Parse the TS header, skipping 1 byte if the header is invalid.
-    std::unique_ptr<TsPacket> ts_packet(
-        TsPacket::Parse(ts_buffer, ts_buffer_size));
-    if (!ts_packet) {
+    if (!ts_packet.Parse(packet_buffer, packet_buffer_size)) {
       DVLOG(1) << "Error: invalid TS packet";
-      ts_byte_queue_.Pop(1);
+      offset += 1;
       continue;
     }
-    DVLOG(LOG_LEVEL_TS) << "Processing PID=" << ts_packet->pid()
+    DVLOG(LOG_LEVEL_TS) << "Processing PID=" << ts_packet.pid()
                         << " start_unit="
-                        << ts_packet->payload_unit_start_indicator()
+                        << ts_packet.payload_unit_start_indicator()
                         << " continuity_counter="
-                        << ts_packet->continuity_counter();
+                        << ts_packet.continuity_counter();
     // Parse the section.
-    auto it = pids_.find(ts_packet->pid());
+    auto it = pids_.find(ts_packet.pid());
     if (it == pids_.end() &&
-        ts_packet->pid() == TsSection::kPidPat) {
+        ts_packet.pid() == TsSection::kPidPat) {
       // Create the PAT state here if needed.
       std::unique_ptr<TsSection> pat_section_parser(new TsSectionPat(
           std::bind(&Mp2tMediaParser::RegisterPmt, this, std::placeholders::_1,
                     std::placeholders::_2)));
       std::unique_ptr<PidState> pat_pid_state(new PidState(
-          ts_packet->pid(), PidState::kPidPat, std::move(pat_section_parser)));
+          ts_packet.pid(), PidState::kPidPat, std::move(pat_section_parser)));
       pat_pid_state->Enable();
-      it = pids_.emplace(ts_packet->pid(), std::move(pat_pid_state)).first;
+      it = pids_.emplace(ts_packet.pid(), std::move(pat_pid_state)).first;
     }
 
     if (it != pids_.end()) {
-      RCHECK(it->second->PushTsPacket(*ts_packet));
+      RCHECK(it->second->PushTsPacket(ts_packet));
+      RCHECK(!pending_limit_exceeded_);
+      if (track_selection_pending_)
+        ApplyTrackSelection();
     } else {
-      DVLOG(LOG_LEVEL_TS) << "Ignoring TS packet for pid: " << ts_packet->pid();
+      DVLOG(LOG_LEVEL_TS) << "Ignoring TS packet for pid: " << ts_packet.pid();
     }
 
     // Go to the next packet.
-    ts_byte_queue_.Pop(TsPacket::kPacketSize);
+    offset += TsPacket::kPacketSize;
   }
+  ts_byte_queue_.Pop(offset);
 
   // Emit the A/V buffers that kept accumulating during TS parsing.
   return EmitRemainingSamples();
@@ -330,11 +343,15 @@ void Mp2tMediaParser::RegisterPes(int pmt_pid,
                                       descriptor, descriptor_length));
       pid_type = PidState::kPidTextPes;
       break;
-    case TsStreamType::kTeletextSubtitles:
-      es_parser.reset(new EsParserTeletext(pes_pid, on_new_stream, on_emit_text,
-                                           descriptor, descriptor_length));
+    case TsStreamType::kTeletextSubtitles: {
+      std::unique_ptr<EsParserTeletext> teletext_parser(
+          new EsParserTeletext(pes_pid, on_new_stream, on_emit_text,
+                               descriptor, descriptor_length));
+      teletext_parser->SetSelectedPages(selected_text_sub_streams_);
+      es_parser = std::move(teletext_parser);
       pid_type = PidState::kPidTextPes;
       break;
+    }
 
     default: {
       auto type = static_cast<int>(stream_type);
@@ -353,7 +370,8 @@ void Mp2tMediaParser::RegisterPes(int pmt_pid,
       new TsSectionPes(std::move(es_parser)));
   std::unique_ptr<PidState> pes_pid_state(
       new PidState(pes_pid, pid_type, std::move(pes_section_parser)));
-  pes_pid_state->Enable();
+  if (!selected_pids_ || selected_pids_->count(pes_pid) > 0)
+    pes_pid_state->Enable();
   pids_.emplace(pes_pid, std::move(pes_pid_state));
 
   // Store PES metadata.
@@ -446,7 +464,50 @@ void Mp2tMediaParser::OnEmitMediaSample(
                << ").";
     return;
   }
+  const size_t sample_size = new_sample->data_size();
   pid_state->second->media_sample_queue_.push_back(std::move(new_sample));
+
+  if (!is_initialized_) {
+    pending_bytes_ += sample_size;
+    if (max_pending_bytes_ > 0 && pending_bytes_ > max_pending_bytes_)
+      OnPendingLimitExceeded();
+  }
+}
+
+void Mp2tMediaParser::OnPendingLimitExceeded() {
+  std::vector<int> pending_pids;
+  bool has_config = false;
+  for (const auto& pair : pids_) {
+    const PidState* pid_state = pair.second.get();
+    if ((pid_state->pid_type() == PidState::kPidAudioPes ||
+         pid_state->pid_type() == PidState::kPidVideoPes ||
+         pid_state->pid_type() == PidState::kPidTextPes) &&
+        pid_state->IsEnabled()) {
+      if (pid_state->config_)
+        has_config = true;
+      else
+        pending_pids.push_back(pair.first);
+    }
+  }
+
+  if (!drop_pending_streams_ || !has_config) {
+    LOG(ERROR) << "The samples queued until all the streams start exceed "
+               << max_pending_bytes_ << " bytes.";
+    pending_limit_exceeded_ = true;
+    return;
+  }
+
+  for (int pid : pending_pids) {
+    LOG(WARNING) << "Dropping the stream with pid=" << pid
+                 << ", which has not started after " << pending_bytes_
+                 << " bytes of samples.";
+    PidState* pid_state = pids_[pid].get();
+    pid_state->Disable();
+    pid_state->media_sample_queue_.clear();
+    pid_state->text_sample_queue_.clear();
+  }
+  pending_bytes_ = 0;
+  FinishInitializationIfNeeded();
 }
 
 void Mp2tMediaParser::OnEmitTextSample(uint32_t pes_pid,
@@ -466,12 +527,31 @@ void Mp2tMediaParser::OnEmitTextSample(uint32_t pes_pid,
   pid_state->second->text_sample_queue_.push_back(std::move(new_sample));
 }
 
+void Mp2tMediaParser::ApplyTrackSelection() {
+  DCHECK(selected_pids_);
+  for (const auto& pair : pids_) {
+    PidState* pid_state = pair.second.get();
+    if ((pid_state->pid_type() == PidState::kPidAudioPes ||
+         pid_state->pid_type() == PidState::kPidVideoPes ||
+         pid_state->pid_type() == PidState::kPidTextPes) &&
+        pid_state->IsEnabled() && selected_pids_->count(pair.first) == 0) {
+      VLOG(1) << "Skipping the unselected stream with pid=" << pair.first;
+      pid_state->Disable();
+      pid_state->media_sample_queue_.clear();
+      pid_state->text_sample_queue_.clear();
+    }
+  }
+  track_selection_pending_ = false;
+}
+
 bool Mp2tMediaParser::EmitRemainingSamples() {
   DVLOG(LOG_LEVEL_ES) << "Mp2tMediaParser::EmitRemainingBuffers";
 
   // No buffer should be sent until fully initialized.
   if (!is_initialized_)
     return true;
+  if (track_selection_pending_)
+    ApplyTrackSelection();
 
   // Buffer emission.
   for (const auto& pid_pair : pids_) {
@@ -9,6 +9,8 @@
 #include <deque>
 #include <map>
 #include <memory>
+#include <optional>
+#include <set>
 #include <string>
 
 #include <packager/macros/classes.h>
@@ -48,8 +50,29 @@ class Mp2tMediaParser : public MediaParser {
             KeySource* decryption_key_source) override;
   [[nodiscard]] bool Flush() override;
   [[nodiscard]] bool Parse(const uint8_t* buf, int size) override;
+  void SetSelectedTracks(const std::set<uint32_t>& track_ids) override;
   /// @}
 
+  /// Limit the size of the samples queued until all the streams have their
+  /// configuration, e.g. while an audio PID which starts late has not sent
+  /// any. Must be called before parsing.
+  /// @param max_pending_bytes is the limit, or 0 for no limit.
+  /// @param drop_pending_streams is true to drop the streams which do not
+  ///        have their configuration when the limit is exceeded, and to go
+  ///        on with the others. Otherwise parsing fails.
+  void SetPendingStreamLimit(uint64_t max_pending_bytes,
+                             bool drop_pending_streams) {
+    max_pending_bytes_ = max_pending_bytes;
+    drop_pending_streams_ = drop_pending_streams;
+  }
+
+  /// Only decode the given sub-streams of the text streams, i.e. teletext
+  /// pages. Must be called before parsing.
+  /// @param sub_streams are the sub-stream indexes, or empty for all.
+  void SetSelectedTextSubStreams(const std::set<uint16_t>& sub_streams) {
+    selected_text_sub_streams_ = sub_streams;
+  }
+
  private:
   // Callback invoked to register a Program Map Table.
   // Note: Does nothing if the PID is already registered.
@@ -85,8 +108,16 @@ class Mp2tMediaParser : public MediaParser {
   // Invoke the initialization callback if needed.
   bool FinishInitializationIfNeeded();
 
+  // Called when the samples queued before initialization exceed
+  // |max_pending_bytes_|.
+  void OnPendingLimitExceeded();
+
   bool EmitRemainingSamples();
 
+  // Disable the PES PIDs which are not selected, which are then no longer
+  // reassembled and parsed.
+  void ApplyTrackSelection();
+
   /// Set the value of the "SBR in mime-type" flag which leads to sample rate
   /// doubling. Default value is false.
   void set_sbr_in_mime_type(bool sbr_in_mimetype) {
@@ -113,6 +144,22 @@ class Mp2tMediaParser : public MediaParser {
   // Whether |init_cb_| has been invoked.
   bool is_initialized_;
 
+  uint64_t max_pending_bytes_ = 0;
+  bool drop_pending_streams_ = false;
+  // The size of the media samples queued until initialization. The text
+  // samples, which are small, are not counted.
+  uint64_t pending_bytes_ = 0;
+  // Set if parsing must fail because of |max_pending_bytes_|.
+  bool pending_limit_exceeded_ = false;
+
+  // The PIDs selected with SetSelectedTracks(), if any.
+  std::optional<std::set<uint32_t>> selected_pids_;
+  // Set until the selection is applied to the PIDs, which are not disabled
+  // from the callbacks of their own parsers.
+  bool track_selection_pending_ = false;
+
+  std::set<uint16_t> selected_text_sub_streams_;
+
   // A map used to track unsupported stream types and make sure the error is
   // only logged once.
   std::bitset<256> stream_type_logged_once_;
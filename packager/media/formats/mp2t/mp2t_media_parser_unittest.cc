@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <set>
 #include <string>
 
 #include <absl/log/log.h>
@@ -47,6 +48,8 @@ class Mp2tMediaParserTest : public testing::Test {
   int64_t video_max_dts_;
   int64_t video_min_pts_;
   int64_t video_max_pts_;
+  // Whether only the video streams are selected on initialization.
+  bool select_video_only_ = false;
 
   bool AppendData(const uint8_t* data, size_t length) {
     return parser_->Parse(data, static_cast<int>(length));
@@ -73,6 +76,14 @@ class Mp2tMediaParserTest : public testing::Test {
       DVLOG(1) << stream_info->ToString();
       stream_map_[stream_info->track_id()] = stream_info;
     }
+    if (select_video_only_) {
+      std::set<uint32_t> video_track_ids;
+      for (const auto& stream_info : stream_infos) {
+        if (stream_info->stream_type() == kStreamVideo)
+          video_track_ids.insert(stream_info->track_id());
+      }
+      parser_->SetSelectedTracks(video_track_ids);
+    }
   }
 
   bool OnNewSample(uint32_t track_id, std::shared_ptr<MediaSample> sample) {
@@ -204,6 +215,76 @@ TEST_F(Mp2tMediaParserTest, PmtEsDescriptors) {
   EXPECT_EQ(131600, audio_info->max_bitrate());
 }
 
+namespace {
+
+const int kTsPacketSize = 188;
+// The audio PID of "bear-640x360.ts".
+const int kBearAudioPid = 257;
+
+// Removes the packets of |pid|, so that its stream never starts.
+std::vector<uint8_t> RemovePid(const std::vector<uint8_t>& ts, int pid) {
+  std::vector<uint8_t> filtered;
+  for (size_t i = 0; i + kTsPacketSize <= ts.size(); i += kTsPacketSize) {
+    if ((((ts[i + 1] & 0x1F) << 8) | ts[i + 2]) != pid)
+      filtered.insert(filtered.end(), &ts[i], &ts[i] + kTsPacketSize);
+  }
+  return filtered;
+}
+
+}  // namespace
+
+TEST_F(Mp2tMediaParserTest, PendingStreamNoLimit) {
+  InitializeParser();
+  const std::vector<uint8_t> buffer =
+      RemovePid(ReadTestDataFile("bear-640x360.ts"), kBearAudioPid);
+  ASSERT_TRUE(AppendDataInPieces(buffer.data(), buffer.size(), 512));
+  EXPECT_TRUE(parser_->Flush());
+  // The video samples are queued forever waiting for the audio stream.
+  EXPECT_TRUE(stream_map_.empty());
+  EXPECT_EQ(0, video_frame_count_);
+}
+
+TEST_F(Mp2tMediaParserTest, PendingStreamLimitFail) {
+  parser_->SetPendingStreamLimit(50000, false);
+  InitializeParser();
+  const std::vector<uint8_t> buffer =
+      RemovePid(ReadTestDataFile("bear-640x360.ts"), kBearAudioPid);
+  EXPECT_FALSE(AppendDataInPieces(buffer.data(), buffer.size(), 512));
+  EXPECT_TRUE(stream_map_.empty());
+}
+
+TEST_F(Mp2tMediaParserTest, PendingStreamLimitDrop) {
+  parser_->SetPendingStreamLimit(50000, true);
+  InitializeParser();
+  const std::vector<uint8_t> buffer =
+      RemovePid(ReadTestDataFile("bear-640x360.ts"), kBearAudioPid);
+  ASSERT_TRUE(AppendDataInPieces(buffer.data(), buffer.size(), 512));
+  EXPECT_TRUE(parser_->Flush());
+  // The audio stream is dropped, and no video sample is lost.
+  ASSERT_EQ(1u, stream_map_.size());
+  EXPECT_EQ(kStreamVideo, stream_map_.begin()->second->stream_type());
+  EXPECT_EQ(82, video_frame_count_);
+  EXPECT_EQ(0, audio_frame_count_);
+}
+
+TEST_F(Mp2tMediaParserTest, PendingStreamLimitNotReached) {
+  parser_->SetPendingStreamLimit(50000, false);
+  ASSERT_TRUE(ParseMpeg2TsFile("bear-640x360.ts", 512));
+  EXPECT_TRUE(parser_->Flush());
+  EXPECT_EQ(2u, stream_map_.size());
+  EXPECT_EQ(82, video_frame_count_);
+}
+
+TEST_F(Mp2tMediaParserTest, SelectedTracks) {
+  select_video_only_ = true;
+  ASSERT_TRUE(ParseMpeg2TsFile("bear-640x360.ts", 512));
+  EXPECT_TRUE(parser_->Flush());
+  EXPECT_EQ(2u, stream_map_.size());
+  EXPECT_EQ(82, video_frame_count_);
+  // The audio samples are not parsed once the audio track is unselected.
+  EXPECT_EQ(0, audio_frame_count_);
+}
+
 }  // namespace mp2t
 }  // namespace media
 }  // namespace shaka
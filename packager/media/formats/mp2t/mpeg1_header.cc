@@ -187,6 +187,19 @@ size_t Mpeg1Header::GetFrameSizeWithoutParsing(const uint8_t* data,
   return Mpeg1FrameSize(layer, bitrate, samplerate, padded);
 }
 
+bool Mpeg1Header::HasSameFixedFields(const uint8_t* data) const {
+  // The bitrate and the padding only change the frame size.
+  const uint8_t version = (data[1] & 0b00011000) >> 3;
+  const uint8_t layer = (data[1] & 0b00000110) >> 1;
+  const uint8_t protection_absent = data[1] & 0b00000001;
+  const uint8_t sr_idx = (data[2] & 0b00001100) >> 2;
+  const uint8_t channel_mode = data[3] >> 6;
+  return version == version_ && layer == layer_ &&
+         protection_absent == protection_absent_ && sr_idx != 0b11 &&
+         Mpeg1SampleRate(sr_idx, version) == sample_rate_ &&
+         channel_mode == channel_mode_;
+}
+
 void Mpeg1Header::GetAudioSpecificConfig(std::vector<uint8_t>* buffer) const {
   // The following conversion table is extracted from ISO 14496 Part 3 -
   // Table 1.16 - Sampling Frequency Index.
@@ -108,15 +108,14 @@ bool PesPacketGenerator::PushSample(const MediaSample& sample) {
     if (sample.decrypt_config())
       subsamples = sample.decrypt_config()->subsamples();
     const bool kEscapeEncryptedNalu = true;
-    std::vector<uint8_t> byte_stream;
     if (!converter_->ConvertUnitToByteStreamWithSubsamples(
             sample.data(), sample.data_size(), sample.is_key_frame(),
-            kEscapeEncryptedNalu, &byte_stream, &subsamples)) {
+            kEscapeEncryptedNalu, current_processing_pes_->mutable_data(),
+            &subsamples)) {
       LOG(ERROR) << "Failed to convert sample to byte stream.";
       return false;
     }
 
-    current_processing_pes_->mutable_data()->swap(byte_stream);
     current_processing_pes_->set_stream_id(kVideoStreamId);
     pes_packets_.push_back(std::move(current_processing_pes_));
     return true;
@@ -114,16 +114,18 @@ uint32_t Crc32Mpeg2(const uint8_t* data, size_t data_size) {
   return crc;
 }
 
-void WritePmtToBuffer(const uint8_t* pmt,
-                      size_t pmt_size,
-                      ContinuityCounter* continuity_counter,
-                      BufferWriter* writer) {
+// Puts |pmt| into TS packets in |packets|. The continuity counters are set
+// when the packets are written with WritePacketsToBufferWriter().
+void PacketizePmt(const BufferWriter& pmt, BufferWriter* packets) {
   const bool kPayloadUnitStartIndicator = true;
   const bool kHasPcr = true;
   const uint64_t kAnyPcrBase = 0;
-  WritePayloadToBufferWriter(pmt, pmt_size, kPayloadUnitStartIndicator,
+  ContinuityCounter any_continuity_counter;
+  packets->Clear();
+  WritePayloadToBufferWriter(pmt.Buffer(), pmt.Size(),
+                             kPayloadUnitStartIndicator,
                              ProgramMapTableWriter::kPmtPid, !kHasPcr,
-                             kAnyPcrBase, continuity_counter, writer);
+                             kAnyPcrBase, &any_continuity_counter, packets);
 }
 
 void WritePrivateDataIndicatorDescriptor(FourCC fourcc, BufferWriter* output) {
@@ -243,14 +245,14 @@ bool ProgramMapTableWriter::EncryptedSegmentPmt(BufferWriter* writer) {
       return false;
 
     const bool has_clear_lead = clear_pmt_.Size() > 0;
+    BufferWriter pmt;
     WritePmtWithParameters(static_cast<uint8_t>(stream_type),
                            has_clear_lead ? kVersion1 : kVersion0, kCurrent,
-                           descriptors.Buffer(), descriptors.Size(),
-                           &encrypted_pmt_);
+                           descriptors.Buffer(), descriptors.Size(), &pmt);
+    PacketizePmt(pmt, &encrypted_pmt_);
     DCHECK_NE(encrypted_pmt_.Size(), 0u);
   }
-  WritePmtToBuffer(encrypted_pmt_.Buffer(), encrypted_pmt_.Size(),
-                   &continuity_counter_, writer);
+  WritePacketsToBufferWriter(encrypted_pmt_, &continuity_counter_, writer);
   return true;
 }
 
@@ -278,12 +280,13 @@ bool ProgramMapTableWriter::ClearSegmentPmt(BufferWriter* writer) {
         return false;
     }
 
+    BufferWriter pmt;
     WritePmtWithParameters(static_cast<uint8_t>(stream_type), kVersion0,
-                           kCurrent, nullptr, 0, &clear_pmt_);
+                           kCurrent, nullptr, 0, &pmt);
+    PacketizePmt(pmt, &clear_pmt_);
     DCHECK_NE(clear_pmt_.Size(), 0u);
   }
-  WritePmtToBuffer(clear_pmt_.Buffer(), clear_pmt_.Size(), &continuity_counter_,
-                   writer);
+  WritePacketsToBufferWriter(clear_pmt_, &continuity_counter_, writer);
   return true;
 }
 
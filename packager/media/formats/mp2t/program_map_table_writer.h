@@ -56,6 +56,8 @@ class ProgramMapTableWriter {
 
   const Codec codec_;
   ContinuityCounter continuity_counter_;
+  // The TS packets of the PMTs, which are built once. Only their continuity
+  // counters change from segment to segment.
   BufferWriter clear_pmt_;
   BufferWriter encrypted_pmt_;
 };
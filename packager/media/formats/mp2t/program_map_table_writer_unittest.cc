@@ -91,6 +91,28 @@ TEST_F(ProgramMapTableWriterTest, ClearH264) {
                           kPmtH264, std::size(kPmtH264), buffer.Buffer()));
 }
 
+// Verify that the PMT of each segment is the same except for the continuity
+// counter, which wraps around after 15.
+TEST_F(ProgramMapTableWriterTest, ClearPmtOfEachSegment) {
+  VideoProgramMapTableWriter writer(kCodecH264);
+  BufferWriter first_segment;
+  writer.ClearSegmentPmt(&first_segment);
+  ASSERT_EQ(kTsPacketSize, first_segment.Size());
+
+  for (int i = 1; i <= 16; ++i) {
+    BufferWriter buffer;
+    writer.ClearSegmentPmt(&buffer);
+    ASSERT_EQ(kTsPacketSize, buffer.Size());
+    std::vector<uint8_t> expected(first_segment.Buffer(),
+                                  first_segment.Buffer() + kTsPacketSize);
+    // Adaptation field and payload are both present.
+    expected[3] = static_cast<uint8_t>(0x30 | (i % 16));
+    EXPECT_EQ(expected, std::vector<uint8_t>(buffer.Buffer(),
+                                             buffer.Buffer() + kTsPacketSize))
+        << "segment " << i;
+  }
+}
+
 // Verify that PSI for encrypted segments after clear lead is generated
 // correctly.
 TEST_F(ProgramMapTableWriterTest, EncryptedSegmentsAfterClearLeadH264) {
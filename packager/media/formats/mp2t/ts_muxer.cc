@@ -81,8 +81,9 @@ Status TsMuxer::FinalizeSegment(size_t stream_id,
   std::string segment_path =
       options().segment_template.empty()
           ? options().output_file_name
-          : GetSegmentName(options().segment_template, segment_start_timestamp,
-                           segment_info.segment_number, options().bandwidth);
+          : segment_template().GetSegmentName(segment_start_timestamp,
+                                              segment_info.segment_number,
+                                              options().bandwidth);
 
   const int64_t file_size = segmenter_->segment_buffer()->Size();
 
@@ -117,7 +118,7 @@ Status TsMuxer::WriteSegment(const std::string& segment_path,
     range.end = range.start + segment_buffer->Size() - 1;
     media_ranges_.subsegment_ranges.push_back(range);
   } else {
-    file.reset(File::Open(segment_path.c_str(), "w"));
+    file.reset(File::OpenWithNoBuffering(segment_path.c_str(), "w"));
     if (!file) {
       return Status(error::FILE_FAILURE,
                     "Cannot open file for write " + segment_path);
@@ -47,12 +47,17 @@ int TsPacket::Sync(const uint8_t* buf, int size) {
   return k;
 }
 
-// static
-TsPacket* TsPacket::Parse(const uint8_t* buf, int size) {
+TsPacket::TsPacket() {
+}
+
+TsPacket::~TsPacket() {
+}
+
+bool TsPacket::Parse(const uint8_t* buf, int size) {
   if (size < kPacketSize) {
     DVLOG(1) << "Buffer does not hold one full TS packet:"
              << " buffer_size=" << size;
-    return NULL;
+    return false;
   }
 
   DCHECK_EQ(buf[0], kTsHeaderSyncword);
@@ -60,22 +65,14 @@ TsPacket* TsPacket::Parse(const uint8_t* buf, int size) {
     DVLOG(1) << "Not on a TS syncword:"
              << " buf[0]="
              << std::hex << static_cast<int>(buf[0]) << std::dec;
-    return NULL;
+    return false;
   }
 
-  std::unique_ptr<TsPacket> ts_packet(new TsPacket());
-  bool status = ts_packet->ParseHeader(buf);
-  if (!status) {
+  if (!ParseHeader(buf)) {
     DVLOG(1) << "Parsing header failed";
-    return NULL;
+    return false;
   }
-  return ts_packet.release();
-}
-
-TsPacket::TsPacket() {
-}
-
-TsPacket::~TsPacket() {
+  return true;
 }
 
 bool TsPacket::ParseHeader(const uint8_t* buf) {
@@ -24,13 +24,13 @@ class TsPacket {
   // to be synchronized on a TS syncword.
   static int Sync(const uint8_t* buf, int size);
 
-  // Parse a TS packet.
-  // Return a TsPacket only when parsing was successful.
-  // Return NULL otherwise.
-  static TsPacket* Parse(const uint8_t* buf, int size);
-
+  TsPacket();
   ~TsPacket();
 
+  // Parse a TS packet. The same TsPacket can be used to parse many packets.
+  // Return true only when parsing was successful.
+  bool Parse(const uint8_t* buf, int size);
+
   // TS header accessors.
   bool payload_unit_start_indicator() const {
     return payload_unit_start_indicator_;
@@ -45,8 +45,6 @@ class TsPacket {
   int payload_size() const { return payload_size_; }
 
  private:
-  TsPacket();
-
   // Parse an Mpeg2 TS header.
   // The buffer size should be at least |kPacketSize|
   bool ParseHeader(const uint8_t* buf);
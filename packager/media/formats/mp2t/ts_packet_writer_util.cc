@@ -162,6 +162,23 @@ void WritePayloadToBufferWriter(const uint8_t* payload,
   } while (payload_bytes_written < payload_size);
 }
 
+void WritePacketsToBufferWriter(const BufferWriter& packets,
+                                ContinuityCounter* continuity_counter,
+                                BufferWriter* output) {
+  DCHECK_EQ(packets.Size() % kTsPacketSize, 0u);
+  // The continuity_counter is the low 4 bits of the last byte of the header.
+  const size_t kContinuityCounterOffset = kTsPacketHeaderSize - 1;
+  for (size_t offset = 0; offset < packets.Size(); offset += kTsPacketSize) {
+    const uint8_t* packet = packets.Buffer() + offset;
+    output->AppendArray(packet, kContinuityCounterOffset);
+    output->AppendInt(static_cast<uint8_t>(
+        (packet[kContinuityCounterOffset] & 0xF0) |
+        continuity_counter->GetNext()));
+    output->AppendArray(packet + kTsPacketHeaderSize,
+                        kTsPacketMaximumPayloadSize);
+  }
+}
+
 }  // namespace mp2t
 }  // namespace media
 }  // namespace shaka
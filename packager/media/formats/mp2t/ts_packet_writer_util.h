@@ -40,6 +40,17 @@ void WritePayloadToBufferWriter(const uint8_t* payload,
                                 ContinuityCounter* continuity_counter,
                                 BufferWriter* output);
 
+/// Writes TS packets written by WritePayloadToBufferWriter before, e.g. the
+/// packets of a PSI table which does not change, so that the payload does not
+/// have to be packetized again. Only the continuity counters of the packets
+/// are rewritten.
+/// @param packets is the TS packets to write.
+/// @param continuity_counter is the continuity_counter for these TS packets.
+/// @param output is where the TS packets get written.
+void WritePacketsToBufferWriter(const BufferWriter& packets,
+                                ContinuityCounter* continuity_counter,
+                                BufferWriter* output);
+
 }  // namespace mp2t
 }  // namespace media
 }  // namespace shaka
@@ -57,15 +57,6 @@ const int kTsPacketMaximumPayloadSize =
 
 const size_t kMaxPesPacketLengthValue = 0xFFFF;
 
-void WritePatToBuffer(const uint8_t* pat,
-                      int pat_size,
-                      ContinuityCounter* continuity_counter,
-                      BufferWriter* writer) {
-  const int kPatPid = 0;
-  WritePayloadToBufferWriter(pat, pat_size, kPayloadUnitStartIndicator, kPatPid,
-                             !kHasPcr, 0, continuity_counter, writer);
-}
-
 // The only difference between writing PTS or DTS is the leading bits.
 void WritePtsOrDts(uint8_t leading_bits,
                    uint64_t pts_or_dts,
@@ -103,7 +94,7 @@ bool WritePesToBuffer(const PesPacket& pes,
   const int pid = ProgramMapTableWriter::kElementaryPid;
 
   // This writer will hold part of PES packet after PES_packet_length field.
-  BufferWriter pes_header_writer;
+  BufferWriter pes_header_writer(kTsPacketSize);
   // The first bit must be '10' for PES with video or audio stream id. The other
   // flags (bits) don't matter so they are 0.
   pes_header_writer.AppendInt(static_cast<uint8_t>(0x80));
@@ -141,34 +132,41 @@ bool WritePesToBuffer(const PesPacket& pes,
   const size_t bytes_consumed = std::min(pes.data().size(), available_payload);
   first_ts_packet_buffer.AppendArray(pes.data().data(), bytes_consumed);
 
-  BufferWriter output_writer;
+  // The TS packets are written straight to |current_buffer|, which holds the
+  // whole segment and grows geometrically as it is appended to.
+  const size_t remaining_pes_data_size = pes.data().size() - bytes_consumed;
+
   WritePayloadToBufferWriter(first_ts_packet_buffer.Buffer(),
                              first_ts_packet_buffer.Size(),
                              kPayloadUnitStartIndicator, pid, kHasPcr, pcr_base,
-                             continuity_counter, &output_writer);
+                             continuity_counter, current_buffer);
 
-  const size_t remaining_pes_data_size = pes.data().size() - bytes_consumed;
   if (remaining_pes_data_size > 0) {
     WritePayloadToBufferWriter(pes.data().data() + bytes_consumed,
                                remaining_pes_data_size,
                                !kPayloadUnitStartIndicator, pid, !kHasPcr, 0,
-                               continuity_counter, &output_writer);
+                               continuity_counter, current_buffer);
   }
-
-  current_buffer->AppendBuffer(output_writer);
   return true;
 }
 
 }  // namespace
 
 TsWriter::TsWriter(std::unique_ptr<ProgramMapTableWriter> pmt_writer)
-    : pmt_writer_(std::move(pmt_writer)) {}
+    : pmt_writer_(std::move(pmt_writer)) {
+  const int kPatPid = 0;
+  ContinuityCounter any_continuity_counter;
+  WritePayloadToBufferWriter(kPat, std::size(kPat), kPayloadUnitStartIndicator,
+                             kPatPid, !kHasPcr, 0, &any_continuity_counter,
+                             &pat_);
+}
 
 TsWriter::~TsWriter() {}
 
 bool TsWriter::NewSegment(BufferWriter* buffer) {
-  BufferWriter psi;
-  WritePatToBuffer(kPat, std::size(kPat), &pat_continuity_counter_, &psi);
+  // PAT and PMT usually take one TS packet each.
+  BufferWriter psi(2 * kTsPacketSize);
+  WritePacketsToBufferWriter(pat_, &pat_continuity_counter_, &psi);
   if (encrypted_) {
     if (!pmt_writer_->EncryptedSegmentPmt(&psi)) {
       return false;
@@ -55,6 +55,9 @@ class TsWriter {
   // True if further segments generated by this instance should be encrypted.
   bool encrypted_ = false;
 
+  // The TS packet of the PAT, which is built once. Only its continuity
+  // counter changes from segment to segment.
+  BufferWriter pat_;
   ContinuityCounter pat_continuity_counter_;
   ContinuityCounter elementary_stream_continuity_counter_;
 
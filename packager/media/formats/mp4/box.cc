@@ -29,6 +29,9 @@ void Box::Write(BufferWriter* writer) {
   // Compute and update box size.
   uint32_t size = ComputeSize();
   DCHECK_EQ(size, box_size_);
+  // The size of the whole box tree is known here, so grow the buffer once
+  // instead of while writing big sample tables, e.g. trun and senc.
+  writer->Reserve(size);
 
   size_t buffer_size_before_write = writer->Size();
   BoxBuffer buffer(writer);
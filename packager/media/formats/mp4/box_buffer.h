@@ -113,6 +113,14 @@ class BoxBuffer {
   }
   /// @}
 
+  /// Read/write @a count 32-bit integers at once.
+  bool ReadWriteUInt32Array(uint32_t* values, size_t count) {
+    if (reader_)
+      return reader_->Read4Array(values, count);
+    writer_->AppendInts(values, count);
+    return true;
+  }
+
   /// Read/write the least significant |num_bytes| of |v| from/to the buffer.
   /// @param num_bytes should not be larger than sizeof(v), i.e. 8.
   /// @return true on success, false otherwise.
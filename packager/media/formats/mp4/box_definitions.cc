@@ -133,6 +133,34 @@ FourCC TrackTypeToFourCC(TrackType track_type) {
   }
 }
 
+// A table of records of 32-bit fields, e.g. the entries of a sample table,
+// which is read or written at once rather than field by field.
+class FieldTable {
+ public:
+  FieldTable(size_t num_records, size_t num_fields)
+      : fields_(num_records * num_fields), num_fields_(num_fields) {}
+
+  uint32_t* record(size_t index) { return &fields_[index * num_fields_]; }
+
+  bool ReadWrite(BoxBuffer* buffer) {
+    return buffer->ReadWriteUInt32Array(fields_.data(), fields_.size());
+  }
+
+ private:
+  std::vector<uint32_t> fields_;
+  const size_t num_fields_;
+};
+
+// @return true if there are enough bytes left in the box to read
+//         |num_records| records of |num_fields| 32-bit fields, so that tables
+//         are not allocated for counts which cannot be right. Always true when
+//         writing.
+bool HasFields(const BoxBuffer& buffer, size_t num_records, size_t num_fields) {
+  if (!buffer.Reading() || num_fields == 0)
+    return true;
+  return num_records <= buffer.BytesLeft() / (num_fields * sizeof(uint32_t));
+}
+
 bool IsProtectionSchemeSupported(FourCC scheme) {
   return scheme == FOURCC_cenc || scheme == FOURCC_cens ||
          scheme == FOURCC_cbc1 || scheme == FOURCC_cbcs;
@@ -707,11 +735,22 @@ FourCC DecodingTimeToSample::BoxType() const {
 bool DecodingTimeToSample::ReadWriteInternal(BoxBuffer* buffer) {
   uint32_t count = static_cast<uint32_t>(decoding_time.size());
   RCHECK(ReadWriteHeaderInternal(buffer) && buffer->ReadWriteUInt32(&count));
+  RCHECK(HasFields(*buffer, count, 2));
 
-  decoding_time.resize(count);
-  for (uint32_t i = 0; i < count; ++i) {
-    RCHECK(buffer->ReadWriteUInt32(&decoding_time[i].sample_count) &&
-           buffer->ReadWriteUInt32(&decoding_time[i].sample_delta));
+  FieldTable table(count, 2);
+  if (!buffer->Reading()) {
+    for (uint32_t i = 0; i < count; ++i) {
+      table.record(i)[0] = decoding_time[i].sample_count;
+      table.record(i)[1] = decoding_time[i].sample_delta;
+    }
+  }
+  RCHECK(table.ReadWrite(buffer));
+  if (buffer->Reading()) {
+    decoding_time.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      decoding_time[i].sample_count = table.record(i)[0];
+      decoding_time[i].sample_delta = table.record(i)[1];
+    }
   }
   return true;
 }
@@ -744,19 +783,25 @@ bool CompositionTimeToSample::ReadWriteInternal(BoxBuffer* buffer) {
   }
 
   RCHECK(ReadWriteHeaderInternal(buffer) && buffer->ReadWriteUInt32(&count));
+  RCHECK(HasFields(*buffer, count, 2));
 
-  composition_offset.resize(count);
-  for (uint32_t i = 0; i < count; ++i) {
-    RCHECK(buffer->ReadWriteUInt32(&composition_offset[i].sample_count));
-
-    if (version == 0) {
-      uint32_t sample_offset = composition_offset[i].sample_offset;
-      RCHECK(buffer->ReadWriteUInt32(&sample_offset));
-      composition_offset[i].sample_offset = sample_offset;
-    } else {
-      int32_t sample_offset = composition_offset[i].sample_offset;
-      RCHECK(buffer->ReadWriteInt32(&sample_offset));
-      composition_offset[i].sample_offset = sample_offset;
+  FieldTable table(count, 2);
+  if (!buffer->Reading()) {
+    for (uint32_t i = 0; i < count; ++i) {
+      table.record(i)[0] = composition_offset[i].sample_count;
+      table.record(i)[1] =
+          static_cast<uint32_t>(composition_offset[i].sample_offset);
+    }
+  }
+  RCHECK(table.ReadWrite(buffer));
+  if (buffer->Reading()) {
+    composition_offset.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      composition_offset[i].sample_count = table.record(i)[0];
+      // The offsets are unsigned in version 0 and signed in version 1.
+      composition_offset[i].sample_offset =
+          version == 0 ? static_cast<int64_t>(table.record(i)[1])
+                       : static_cast<int32_t>(table.record(i)[1]);
     }
   }
   return true;
@@ -784,12 +829,24 @@ FourCC SampleToChunk::BoxType() const {
 bool SampleToChunk::ReadWriteInternal(BoxBuffer* buffer) {
   uint32_t count = static_cast<uint32_t>(chunk_info.size());
   RCHECK(ReadWriteHeaderInternal(buffer) && buffer->ReadWriteUInt32(&count));
+  RCHECK(HasFields(*buffer, count, 3));
 
+  FieldTable table(count, 3);
+  if (!buffer->Reading()) {
+    for (uint32_t i = 0; i < count; ++i) {
+      table.record(i)[0] = chunk_info[i].first_chunk;
+      table.record(i)[1] = chunk_info[i].samples_per_chunk;
+      table.record(i)[2] = chunk_info[i].sample_description_index;
+    }
+  }
+  RCHECK(table.ReadWrite(buffer));
   chunk_info.resize(count);
   for (uint32_t i = 0; i < count; ++i) {
-    RCHECK(buffer->ReadWriteUInt32(&chunk_info[i].first_chunk) &&
-           buffer->ReadWriteUInt32(&chunk_info[i].samples_per_chunk) &&
-           buffer->ReadWriteUInt32(&chunk_info[i].sample_description_index));
+    if (buffer->Reading()) {
+      chunk_info[i].first_chunk = table.record(i)[0];
+      chunk_info[i].samples_per_chunk = table.record(i)[1];
+      chunk_info[i].sample_description_index = table.record(i)[2];
+    }
     // first_chunk values are always increasing.
     RCHECK(i == 0 ? chunk_info[i].first_chunk == 1
                   : chunk_info[i].first_chunk > chunk_info[i - 1].first_chunk);
@@ -815,12 +872,13 @@ bool SampleSize::ReadWriteInternal(BoxBuffer* buffer) {
          buffer->ReadWriteUInt32(&sample_count));
 
   if (sample_size == 0) {
-    if (buffer->Reading())
+    if (buffer->Reading()) {
+      RCHECK(HasFields(*buffer, sample_count, 1));
       sizes.resize(sample_count);
-    else
+    } else {
       DCHECK(sample_count == sizes.size());
-    for (uint32_t i = 0; i < sample_count; ++i)
-      RCHECK(buffer->ReadWriteUInt32(&sizes[i]));
+    }
+    RCHECK(buffer->ReadWriteUInt32Array(sizes.data(), sample_count));
   }
   return true;
 }
@@ -897,10 +955,19 @@ FourCC ChunkOffset::BoxType() const {
 bool ChunkOffset::ReadWriteInternal(BoxBuffer* buffer) {
   uint32_t count = static_cast<uint32_t>(offsets.size());
   RCHECK(ReadWriteHeaderInternal(buffer) && buffer->ReadWriteUInt32(&count));
+  RCHECK(HasFields(*buffer, count, 1));
 
-  offsets.resize(count);
-  for (uint32_t i = 0; i < count; ++i)
-    RCHECK(buffer->ReadWriteUInt64NBytes(&offsets[i], sizeof(uint32_t)));
+  FieldTable table(count, 1);
+  if (!buffer->Reading()) {
+    for (uint32_t i = 0; i < count; ++i)
+      *table.record(i) = static_cast<uint32_t>(offsets[i]);
+  }
+  RCHECK(table.ReadWrite(buffer));
+  if (buffer->Reading()) {
+    offsets.resize(count);
+    for (uint32_t i = 0; i < count; ++i)
+      offsets[i] = *table.record(i);
+  }
   return true;
 }
 
@@ -956,10 +1023,10 @@ FourCC SyncSample::BoxType() const {
 bool SyncSample::ReadWriteInternal(BoxBuffer* buffer) {
   uint32_t count = static_cast<uint32_t>(sample_number.size());
   RCHECK(ReadWriteHeaderInternal(buffer) && buffer->ReadWriteUInt32(&count));
+  RCHECK(HasFields(*buffer, count, 1));
 
   sample_number.resize(count);
-  for (uint32_t i = 0; i < count; ++i)
-    RCHECK(buffer->ReadWriteUInt32(&sample_number[i]));
+  RCHECK(buffer->ReadWriteUInt32Array(sample_number.data(), count));
   return true;
 }
 
@@ -2706,6 +2773,12 @@ bool TrackFragmentRun::ReadWriteInternal(BoxBuffer* buffer) {
   bool sample_flags_present = (flags & kSampleFlagsPresentMask) != 0;
   bool sample_composition_time_offsets_present =
       (flags & kSampleCompTimeOffsetsPresentMask) != 0;
+  // The number of fields present for each sample, which are stored in the
+  // order above.
+  const size_t num_fields = (sample_duration_present ? 1 : 0) +
+                            (sample_size_present ? 1 : 0) +
+                            (sample_flags_present ? 1 : 0) +
+                            (sample_composition_time_offsets_present ? 1 : 0);
 
   if (data_offset_present) {
     RCHECK(buffer->ReadWriteUInt32(&data_offset));
@@ -2724,6 +2797,7 @@ bool TrackFragmentRun::ReadWriteInternal(BoxBuffer* buffer) {
   if (buffer->Reading()) {
     if (first_sample_flags_present)
       RCHECK(buffer->ReadWriteUInt32(&first_sample_flags));
+    RCHECK(HasFields(*buffer, sample_count, num_fields));
 
     if (sample_duration_present)
       sample_durations.resize(sample_count);
@@ -2750,24 +2824,33 @@ bool TrackFragmentRun::ReadWriteInternal(BoxBuffer* buffer) {
       DCHECK(sample_composition_time_offsets.size() == sample_count);
   }
 
-  for (uint32_t i = 0; i < sample_count; ++i) {
+  // The fields of all the samples are read or written at once.
+  FieldTable table(sample_count, num_fields);
+  for (uint32_t i = 0; i < sample_count && !buffer->Reading(); ++i) {
+    uint32_t* field = table.record(i);
     if (sample_duration_present)
-      RCHECK(buffer->ReadWriteUInt32(&sample_durations[i]));
+      *field++ = sample_durations[i];
     if (sample_size_present)
-      RCHECK(buffer->ReadWriteUInt32(&sample_sizes[i]));
+      *field++ = sample_sizes[i];
     if (sample_flags_present)
-      RCHECK(buffer->ReadWriteUInt32(&sample_flags[i]));
-
+      *field++ = sample_flags[i];
+    if (sample_composition_time_offsets_present)
+      *field++ = static_cast<uint32_t>(sample_composition_time_offsets[i]);
+  }
+  RCHECK(table.ReadWrite(buffer));
+  for (uint32_t i = 0; i < sample_count && buffer->Reading(); ++i) {
+    const uint32_t* field = table.record(i);
+    if (sample_duration_present)
+      sample_durations[i] = *field++;
+    if (sample_size_present)
+      sample_sizes[i] = *field++;
+    if (sample_flags_present)
+      sample_flags[i] = *field++;
+    // The offsets are unsigned in version 0 and signed in version 1.
     if (sample_composition_time_offsets_present) {
-      if (version == 0) {
-        uint32_t sample_offset = sample_composition_time_offsets[i];
-        RCHECK(buffer->ReadWriteUInt32(&sample_offset));
-        sample_composition_time_offsets[i] = sample_offset;
-      } else {
-        int32_t sample_offset = sample_composition_time_offsets[i];
-        RCHECK(buffer->ReadWriteInt32(&sample_offset));
-        sample_composition_time_offsets[i] = sample_offset;
-      }
+      sample_composition_time_offsets[i] =
+          version == 0 ? static_cast<int64_t>(*field)
+                       : static_cast<int32_t>(*field);
     }
   }
 
@@ -2946,6 +3029,58 @@ size_t SegmentIndex::ComputeSizeInternal() {
                  static_cast<size_t>(std::numeric_limits<uint16_t>::max()));
 }
 
+DASHEventMessageBox::DASHEventMessageBox() = default;
+DASHEventMessageBox::~DASHEventMessageBox() = default;
+
+FourCC DASHEventMessageBox::BoxType() const {
+  return FOURCC_emsg;
+}
+
+bool DASHEventMessageBox::ReadWriteInternal(BoxBuffer* buffer) {
+  RCHECK(ReadWriteHeaderInternal(buffer));
+  // Version 0, with a presentation time delta, is not supported.
+  RCHECK(version == 1);
+  RCHECK(buffer->ReadWriteUInt32(&timescale) &&
+         buffer->ReadWriteUInt64(&presentation_time) &&
+         buffer->ReadWriteUInt32(&event_duration) &&
+         buffer->ReadWriteUInt32(&id) &&
+         buffer->ReadWriteCString(&scheme_id_uri) &&
+         buffer->ReadWriteCString(&value));
+  const size_t message_data_size =
+      buffer->Reading() ? buffer->BytesLeft() : message_data.size();
+  RCHECK(buffer->ReadWriteVector(&message_data, message_data_size));
+  return true;
+}
+
+size_t DASHEventMessageBox::ComputeSizeInternal() {
+  version = 1;
+  return HeaderSize() + sizeof(timescale) + sizeof(presentation_time) +
+         sizeof(event_duration) + sizeof(id) + scheme_id_uri.size() + 1 +
+         value.size() + 1 + message_data.size();
+}
+
+ProducerReferenceTime::ProducerReferenceTime() = default;
+ProducerReferenceTime::~ProducerReferenceTime() = default;
+
+FourCC ProducerReferenceTime::BoxType() const {
+  return FOURCC_prft;
+}
+
+bool ProducerReferenceTime::ReadWriteInternal(BoxBuffer* buffer) {
+  size_t num_bytes = (version == 1) ? sizeof(uint64_t) : sizeof(uint32_t);
+  RCHECK(ReadWriteHeaderInternal(buffer) &&
+         buffer->ReadWriteUInt32(&reference_track_id) &&
+         buffer->ReadWriteUInt64(&ntp_timestamp) &&
+         buffer->ReadWriteUInt64NBytes(&media_time, num_bytes));
+  return true;
+}
+
+size_t ProducerReferenceTime::ComputeSizeInternal() {
+  version = IsFitIn32Bits(media_time) ? 0 : 1;
+  return HeaderSize() + sizeof(reference_track_id) + sizeof(ntp_timestamp) +
+         sizeof(uint32_t) * (1 + version);
+}
+
 MediaData::MediaData() = default;
 MediaData::~MediaData() = default;
 
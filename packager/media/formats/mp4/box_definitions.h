@@ -853,6 +853,27 @@ struct SegmentIndex : FullBox {
   std::vector<SegmentReference> references;
 };
 
+// Version 1 of the event message box, ISO/IEC 23009-1.
+struct DASHEventMessageBox : FullBox {
+  DECLARE_BOX_METHODS(DASHEventMessageBox);
+
+  std::string scheme_id_uri;
+  std::string value;
+  uint32_t timescale = 0u;
+  uint64_t presentation_time = 0u;
+  uint32_t event_duration = 0u;
+  uint32_t id = 0u;
+  std::vector<uint8_t> message_data;
+};
+
+struct ProducerReferenceTime : FullBox {
+  DECLARE_BOX_METHODS(ProducerReferenceTime);
+
+  uint32_t reference_track_id = 0u;
+  uint64_t ntp_timestamp = 0u;
+  uint64_t media_time = 0u;
+};
+
 // The actual data is parsed and written separately.
 struct MediaData : Box {
   DECLARE_BOX_METHODS(MediaData);
@@ -463,6 +463,22 @@ inline bool operator==(const SegmentIndex& lhs, const SegmentIndex& rhs) {
          lhs.references == rhs.references;
 }
 
+inline bool operator==(const DASHEventMessageBox& lhs,
+                       const DASHEventMessageBox& rhs) {
+  return lhs.scheme_id_uri == rhs.scheme_id_uri && lhs.value == rhs.value &&
+         lhs.timescale == rhs.timescale &&
+         lhs.presentation_time == rhs.presentation_time &&
+         lhs.event_duration == rhs.event_duration && lhs.id == rhs.id &&
+         lhs.message_data == rhs.message_data;
+}
+
+inline bool operator==(const ProducerReferenceTime& lhs,
+                       const ProducerReferenceTime& rhs) {
+  return lhs.reference_track_id == rhs.reference_track_id &&
+         lhs.ntp_timestamp == rhs.ntp_timestamp &&
+         lhs.media_time == rhs.media_time;
+}
+
 inline bool operator==(const CueSourceIDBox& lhs,
                        const CueSourceIDBox& rhs) {
   return lhs.source_id == rhs.source_id;
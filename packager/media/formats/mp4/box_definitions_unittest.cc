@@ -922,6 +922,34 @@ class BoxDefinitionsTestGeneral : public testing::Test {
     sidx->version = 1;
   }
 
+  void Fill(DASHEventMessageBox* emsg) {
+    emsg->scheme_id_uri = "urn:scte:scte35:2013:bin";
+    emsg->timescale = 90000;
+    emsg->presentation_time = 1234567;
+    emsg->event_duration = 0xFFFFFFFF;
+    emsg->id = 1;
+    emsg->message_data.assign(kData8, kData8 + std::size(kData8));
+    emsg->version = 1;
+  }
+
+  void Modify(DASHEventMessageBox* emsg) {
+    emsg->value = "1";
+    emsg->presentation_time = 0x1FFFFFFFFULL;
+    emsg->message_data.clear();
+  }
+
+  void Fill(ProducerReferenceTime* prft) {
+    prft->reference_track_id = 1;
+    prft->ntp_timestamp = 0xE9A1B2C3D4E5F607ULL;
+    prft->media_time = 90000;
+    prft->version = 0;
+  }
+
+  void Modify(ProducerReferenceTime* prft) {
+    prft->media_time = 0x1FFFFFFFFULL;
+    prft->version = 1;
+  }
+
   void Fill(CueSourceIDBox* vsid) {
     vsid->source_id = 5;
   }
@@ -1088,6 +1116,8 @@ typedef testing::Types<MediaHeader,
                        TrackFragment,
                        MovieFragment,
                        SegmentIndex,
+                       DASHEventMessageBox,
+                       ProducerReferenceTime,
                        CueSourceIDBox,
                        CueTimeBox,
                        CueIDBox,
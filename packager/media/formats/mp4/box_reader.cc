@@ -26,11 +26,9 @@ BoxReader::BoxReader(const uint8_t* buf, size_t size)
 }
 
 BoxReader::~BoxReader() {
-  if (scanned_ && !children_.empty()) {
-    for (ChildMap::iterator itr = children_.begin(); itr != children_.end();
-         ++itr) {
-      DVLOG(1) << "Skipping unknown box: " << FourCCToString(itr->first);
-    }
+  for (const Child& child : children_) {
+    if (!child.read)
+      DVLOG(1) << "Skipping unknown box: " << FourCCToString(child.type);
   }
 }
 
@@ -71,16 +69,14 @@ bool BoxReader::ScanChildren() {
   scanned_ = true;
 
   while (pos() < size()) {
-    std::unique_ptr<BoxReader> child(
-        new BoxReader(&data()[pos()], size() - pos()));
+    BoxReader child(&data()[pos()], size() - pos());
     bool err;
-    if (!child->ReadHeader(&err))
+    if (!child.ReadHeader(&err))
       return false;
 
-    FourCC box_type = child->type();
-    size_t box_size = child->size();
-    children_.insert(std::pair<FourCC, std::unique_ptr<BoxReader>>(
-        box_type, std::move(child)));
+    FourCC box_type = child.type();
+    size_t box_size = child.size();
+    children_.push_back(Child{box_type, pos(), box_size, false});
     VLOG(2) << "Child " << FourCCToString(box_type) << " size 0x" << std::hex
             << box_size << std::dec;
     RCHECK(SkipBytes(box_size));
@@ -93,24 +89,38 @@ bool BoxReader::ReadChild(Box* child) {
   DCHECK(scanned_);
   FourCC child_type = child->BoxType();
 
-  ChildMap::iterator itr = children_.find(child_type);
-  RCHECK(itr != children_.end());
+  Child* found = FindChild(child_type);
+  RCHECK(found);
   DVLOG(2) << "Found a " << FourCCToString(child_type) << " box.";
-  RCHECK(child->Parse(itr->second.get()));
-  children_.erase(itr);
-  return true;
+  return ParseChild(found, child);
 }
 
 bool BoxReader::ChildExist(Box* child) {
-  return children_.count(child->BoxType()) > 0;
+  return FindChild(child->BoxType()) != NULL;
 }
 
 bool BoxReader::TryReadChild(Box* child) {
-  if (!children_.count(child->BoxType()))
+  if (!FindChild(child->BoxType()))
     return true;
   return ReadChild(child);
 }
 
+BoxReader::Child* BoxReader::FindChild(FourCC type) {
+  for (Child& child : children_) {
+    if (child.type == type && !child.read)
+      return &child;
+  }
+  return NULL;
+}
+
+bool BoxReader::ParseChild(Child* child, Box* box) {
+  child->read = true;
+  BoxReader child_reader(&data()[child->pos], child->size);
+  bool err;
+  RCHECK(child_reader.ReadHeader(&err));
+  return box->Parse(&child_reader);
+}
+
 bool BoxReader::ReadHeader(bool* err) {
   uint64_t size = 0;
   *err = false;
@@ -5,7 +5,7 @@
 #ifndef PACKAGER_MEDIA_FORMATS_MP4_BOX_READER_H_
 #define PACKAGER_MEDIA_FORMATS_MP4_BOX_READER_H_
 
-#include <map>
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -60,7 +60,8 @@ class BoxReader : public BufferReader {
 
   /// Scan through all boxes within the current box, starting at the current
   /// buffer position. Must be called before any of the @b *Child functions
-  /// work.
+  /// work. Only the headers of the children are read; a child is only parsed
+  /// once it is read, so the boxes which are not needed are skipped.
   /// @return true on success, false otherwise.
   [[nodiscard]] bool ScanChildren();
 
@@ -114,13 +115,27 @@ class BoxReader : public BufferReader {
   // true, the error is unrecoverable and the stream should be aborted.
   bool ReadHeader(bool* err);
 
-  FourCC type_;
+  // A child box found by ScanChildren().
+  struct Child {
+    FourCC type;
+    // Position and size of the box in the buffer.
+    size_t pos;
+    size_t size;
+    bool read;
+  };
+
+  // @return The first child of type @a type which has not been read yet, or
+  //         NULL if there is none.
+  Child* FindChild(FourCC type);
+  // Parses @a box from @a child, and marks @a child as read.
+  bool ParseChild(Child* child, Box* box);
 
-  typedef std::multimap<FourCC, std::unique_ptr<BoxReader>> ChildMap;
+  FourCC type_;
 
-  // The set of child box FourCCs and their corresponding buffer readers. Only
-  // valid if scanned_ is true.
-  ChildMap children_;
+  // The child boxes, in the order of the buffer. A flat vector, as boxes have
+  // few children, other than 'moov' with many 'trak' children which are read
+  // together. Only valid if scanned_ is true.
+  std::vector<Child> children_;
   bool scanned_;
 
   DISALLOW_COPY_AND_ASSIGN(BoxReader);
@@ -141,15 +156,19 @@ bool BoxReader::TryReadChildren(std::vector<T>* children) {
   children->resize(1);
   FourCC child_type = (*children)[0].BoxType();
 
-  ChildMap::iterator start_itr = children_.lower_bound(child_type);
-  ChildMap::iterator end_itr = children_.upper_bound(child_type);
-  children->resize(std::distance(start_itr, end_itr));
+  size_t num_children = 0;
+  for (const Child& child : children_) {
+    if (child.type == child_type && !child.read)
+      ++num_children;
+  }
+  children->resize(num_children);
   typename std::vector<T>::iterator child_itr = children->begin();
-  for (ChildMap::iterator itr = start_itr; itr != end_itr; ++itr) {
-    RCHECK(child_itr->Parse(itr->second.get()));
+  for (Child& child : children_) {
+    if (child.type != child_type || child.read)
+      continue;
+    RCHECK(ParseChild(&child, &*child_itr));
     ++child_itr;
   }
-  children_.erase(start_itr, end_itr);
 
   DVLOG(2) << "Found " << children->size() << " " << FourCCToString(child_type)
            << " boxes.";
@@ -162,6 +162,7 @@ TEST_F(BoxReaderTest, ScanChildrenTest) {
 
   EXPECT_TRUE(reader->ReadChildren(&kids));
   EXPECT_EQ(2u, kids.size());
+  EXPECT_EQ(kids[0].val, 0xdeadbeef);  // Ensure order is preserved.
   kids.clear();
   EXPECT_FALSE(reader->ReadChildren(&kids));
   EXPECT_TRUE(reader->TryReadChildren(&kids));
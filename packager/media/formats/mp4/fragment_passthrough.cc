@@ -0,0 +1,467 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/formats/mp4/fragment_passthrough.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+
+#include <packager/file.h>
+#include <packager/file/file_closer.h>
+#include <packager/macros/logging.h>
+#include <packager/macros/status.h>
+#include <packager/media/base/buffer_reader.h>
+#include <packager/media/base/buffer_writer.h>
+#include <packager/media/base/muxer_util.h>
+#include <packager/media/base/stream_info.h>
+#include <packager/media/event/muxer_listener.h>
+#include <packager/media/formats/mp4/box_reader.h>
+#include <packager/media/formats/mp4/mp4_media_parser.h>
+#include <packager/media/formats/mp4/track_run_iterator.h>
+
+namespace shaka {
+namespace media {
+namespace mp4 {
+namespace {
+
+const size_t kBoxHeaderSize = 8;
+const size_t kLargeBoxHeaderSize = 16;
+// The offset of the sequence number in 'mfhd', which is the first child of
+// 'moof': the box header, then the version and the flags.
+const size_t kSequenceNumberOffset = kBoxHeaderSize + 4;
+
+// Same as in ChunkingHandler: the segment index may go back by one, as it is
+// computed from presentation timestamps.
+bool IsNewSegmentIndex(int64_t new_index, int64_t current_index) {
+  return new_index != current_index && new_index != current_index - 1;
+}
+
+// Reads up to |size| bytes, stopping early at the end of |file|.
+// @return the number of bytes read, or -1 on error.
+int64_t ReadFully(File* file, uint8_t* buffer, size_t size) {
+  size_t bytes_read = 0;
+  while (bytes_read < size) {
+    const int64_t result = file->Read(buffer + bytes_read, size - bytes_read);
+    if (result < 0)
+      return -1;
+    if (result == 0)
+      break;
+    bytes_read += static_cast<size_t>(result);
+  }
+  return static_cast<int64_t>(bytes_read);
+}
+
+// Reads the next top-level box of |file|, header included, into |box|.
+// |type| is set to FOURCC_NULL at the end of the file.
+Status ReadBox(File* file, FourCC* type, std::vector<uint8_t>* box) {
+  box->resize(kBoxHeaderSize);
+  const int64_t bytes_read = ReadFully(file, box->data(), box->size());
+  if (bytes_read == 0) {
+    *type = FOURCC_NULL;
+    return Status::OK;
+  }
+  if (bytes_read != static_cast<int64_t>(box->size()))
+    return Status(error::FILE_FAILURE, "Cannot read box header.");
+
+  uint64_t box_size = 0;
+  bool err = false;
+  if (!BoxReader::StartBox(box->data(), box->size(), type, &box_size, &err) &&
+      !err) {
+    // A 64-bit box size follows the type.
+    box->resize(kLargeBoxHeaderSize);
+    if (ReadFully(file, box->data() + kBoxHeaderSize,
+                  kLargeBoxHeaderSize - kBoxHeaderSize) !=
+        static_cast<int64_t>(kLargeBoxHeaderSize - kBoxHeaderSize)) {
+      return Status(error::FILE_FAILURE, "Cannot read box header.");
+    }
+    if (!BoxReader::StartBox(box->data(), box->size(), type, &box_size,
+                             &err)) {
+      err = true;
+    }
+  }
+  if (err || box_size < box->size() ||
+      box_size > std::numeric_limits<size_t>::max()) {
+    return Status(error::PARSER_FAILURE, "Invalid box header.");
+  }
+
+  const size_t header_size = box->size();
+  box->resize(static_cast<size_t>(box_size));
+  if (ReadFully(file, box->data() + header_size, box->size() - header_size) !=
+      static_cast<int64_t>(box->size() - header_size)) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot read box " + FourCCToString(*type));
+  }
+  return Status::OK;
+}
+
+template <typename BoxType>
+bool ParseBox(const std::vector<uint8_t>& data, BoxType* box) {
+  bool err = false;
+  std::unique_ptr<BoxReader> reader(
+      BoxReader::ReadBox(data.data(), data.size(), &err));
+  return reader && box->Parse(reader.get());
+}
+
+}  // namespace
+
+// static
+bool FragmentPassthrough::CanPassThrough(const std::string& file_name,
+                                         const std::string& stream_selector) {
+  std::unique_ptr<File, FileCloser> file(File::Open(file_name.c_str(), "r"));
+  if (!file)
+    return false;
+
+  bool has_ftyp = false;
+  std::vector<uint8_t> box;
+  while (true) {
+    FourCC type = FOURCC_NULL;
+    if (!ReadBox(file.get(), &type, &box).ok())
+      return false;
+    if (type == FOURCC_ftyp)
+      has_ftyp = true;
+    if (type == FOURCC_moov)
+      break;
+    // Only 'ftyp' and the boxes ignored by the players may come before
+    // 'moov', so that they form the init segment.
+    if (type != FOURCC_ftyp && type != FOURCC_free && type != FOURCC_skip)
+      return false;
+  }
+
+  Movie moov;
+  if (!has_ftyp || !ParseBox(box, &moov) || moov.tracks.size() != 1 ||
+      moov.extends.tracks.size() != 1) {
+    return false;
+  }
+  const Track& track = moov.tracks[0];
+  if (!track.edit.list.edits.empty())
+    return false;
+
+  const SampleDescription& description =
+      track.media.information.sample_table.description;
+  switch (description.type) {
+    case kVideo:
+      if (stream_selector != "video" && stream_selector != "0")
+        return false;
+      for (const VideoSampleEntry& entry : description.video_entries) {
+        if (entry.format == FOURCC_encv)
+          return false;
+      }
+      return !description.video_entries.empty();
+    case kAudio:
+      if (stream_selector != "audio" && stream_selector != "0")
+        return false;
+      for (const AudioSampleEntry& entry : description.audio_entries) {
+        if (entry.format == FOURCC_enca)
+          return false;
+      }
+      return !description.audio_entries.empty();
+    default:
+      return false;
+  }
+}
+
+FragmentPassthrough::FragmentPassthrough(
+    const std::string& file_name,
+    const MuxerOptions& options,
+    const ChunkingParams& chunking_params,
+    std::unique_ptr<MuxerListener> muxer_listener)
+    : file_name_(file_name),
+      options_(options),
+      segment_template_(options.segment_template),
+      chunking_params_(chunking_params),
+      muxer_listener_(std::move(muxer_listener)),
+      segment_number_(chunking_params.start_segment_number) {}
+
+FragmentPassthrough::~FragmentPassthrough() = default;
+
+Status FragmentPassthrough::InitializeInternal() {
+  if (options_.segment_template.empty()) {
+    return Status(error::INVALID_ARGUMENT,
+                  "Fragment passthrough requires a segment template.");
+  }
+  return Status::OK;
+}
+
+Status FragmentPassthrough::Run() {
+  std::unique_ptr<File, FileCloser> file(File::Open(file_name_.c_str(), "r"));
+  if (!file)
+    return Status(error::FILE_FAILURE, "Cannot open file " + file_name_);
+
+  std::vector<uint8_t> ftyp;
+  std::vector<uint8_t> moof;
+  std::vector<uint8_t> box;
+  while (!cancelled_) {
+    FourCC type = FOURCC_NULL;
+    RETURN_IF_ERROR(ReadBox(file.get(), &type, &box));
+    switch (type) {
+      case FOURCC_NULL:
+        if (!moof.empty()) {
+          return Status(error::PARSER_FAILURE,
+                        "'moof' without 'mdat' at the end of " + file_name_);
+        }
+        RETURN_IF_ERROR(WriteSegment());
+        if (muxer_listener_ && stream_info_) {
+          muxer_listener_->OnMediaEnd(
+              MuxerListener::MediaRanges(),
+              static_cast<float>(total_duration_) / stream_info_->time_scale());
+        }
+        return Status::OK;
+      case FOURCC_ftyp:
+        ftyp.swap(box);
+        break;
+      case FOURCC_moov:
+        if (moov_)
+          return Status(error::PARSER_FAILURE, "Multiple 'moov' boxes.");
+        RETURN_IF_ERROR(StartMedia(ftyp, box));
+        break;
+      case FOURCC_moof:
+        if (!moov_ || !moof.empty()) {
+          return Status(error::PARSER_FAILURE,
+                        "Unexpected 'moof' in " + file_name_);
+        }
+        moof.swap(box);
+        break;
+      case FOURCC_mdat:
+        // Only the 'mdat' following a 'moof' is expected to hold samples.
+        if (!moof.empty()) {
+          RETURN_IF_ERROR(AddFragment(std::move(moof), std::move(box)));
+          moof.clear();
+        }
+        break;
+      default:
+        VLOG(2) << "Skipping box " << FourCCToString(type) << " of "
+                << file_name_;
+        break;
+    }
+  }
+  return Status(error::CANCELLED, "Fragment passthrough cancelled.");
+}
+
+void FragmentPassthrough::Cancel() {
+  cancelled_ = true;
+}
+
+Status FragmentPassthrough::StartMedia(const std::vector<uint8_t>& ftyp,
+                                       const std::vector<uint8_t>& moov) {
+  auto moov_box = std::make_unique<Movie>();
+  FileType ftyp_box;
+  if (ftyp.empty() || !ParseBox(ftyp, &ftyp_box) ||
+      !ParseBox(moov, moov_box.get()) || moov_box->tracks.size() != 1) {
+    return Status(error::PARSER_FAILURE,
+                  "Cannot pass through the 'moov' of " + file_name_);
+  }
+
+  // The parser turns the 'moov' into a StreamInfo, as the demuxer would.
+  std::vector<uint8_t> init_segment(ftyp);
+  init_segment.insert(init_segment.end(), moov.begin(), moov.end());
+  MP4MediaParser parser;
+  parser.Init(
+      [this](const std::vector<std::shared_ptr<StreamInfo>>& streams) {
+        if (streams.size() == 1)
+          stream_info_ = streams[0];
+      },
+      [](uint32_t, std::shared_ptr<MediaSample>) { return true; },
+      [](uint32_t, std::shared_ptr<TextSample>) { return true; }, nullptr);
+  if (!parser.Parse(init_segment.data(),
+                    static_cast<int>(init_segment.size())) ||
+      !stream_info_) {
+    return Status(error::PARSER_FAILURE,
+                  "Cannot parse the 'moov' of " + file_name_);
+  }
+
+  styp_ = std::make_unique<SegmentType>();
+  styp_->major_brand = ftyp_box.major_brand;
+  styp_->minor_version = ftyp_box.minor_version;
+  styp_->compatible_brands = ftyp_box.compatible_brands;
+  // Same as MultiSegmentSegmenter.
+  std::replace(styp_->compatible_brands.begin(), styp_->compatible_brands.end(),
+               FOURCC_cmfc, FOURCC_cmfs);
+  moov_ = std::move(moov_box);
+  segment_clock_ = SegmentClock(chunking_params_.segment_duration_in_seconds,
+                                stream_info_->time_scale());
+
+  std::unique_ptr<File, FileCloser> file(
+      File::OpenWithNoBuffering(options_.output_file_name.c_str(), "w"));
+  if (!file) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot open file for write " + options_.output_file_name);
+  }
+  if (file->Write(init_segment.data(), init_segment.size()) !=
+          static_cast<int64_t>(init_segment.size()) ||
+      !file.release()->Close()) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot write file " + options_.output_file_name);
+  }
+
+  if (muxer_listener_) {
+    muxer_listener_->OnMediaStart(options_, *stream_info_,
+                                  stream_info_->time_scale(),
+                                  MuxerListener::kContainerMp4);
+  }
+  return Status::OK;
+}
+
+Status FragmentPassthrough::AddFragment(std::vector<uint8_t> moof,
+                                        std::vector<uint8_t> mdat) {
+  MovieFragment moof_box;
+  if (!ParseBox(moof, &moof_box))
+    return Status(error::PARSER_FAILURE, "Cannot parse 'moof'.");
+
+  // The samples keep the timestamps of the input, which are those of the
+  // copied fragments.
+  const uint32_t track_id = moov_->tracks[0].header.track_id;
+  TrackRunIterator runs(moov_.get());
+  runs.set_timestamp_adjustments({{track_id, 0}});
+  if (!runs.Init(moof_box))
+    return Status(error::PARSER_FAILURE, "Cannot parse 'moof'.");
+
+  Fragment fragment;
+  const int64_t fragment_size = static_cast<int64_t>(moof.size() + mdat.size());
+  bool has_samples = false;
+  // The timestamp the segment boundaries are checked against, which is that
+  // of the first sample, as in ChunkingHandler.
+  int64_t start_time = 0;
+  for (; runs.IsRunValid(); runs.AdvanceRun()) {
+    if (runs.track_id() != track_id || runs.is_encrypted()) {
+      return Status(error::PARSER_FAILURE,
+                    "Cannot pass through the fragments of " + file_name_);
+    }
+    for (; runs.IsSampleValid(); runs.AdvanceSample()) {
+      // The fragment is copied as a whole, so its samples must be in it.
+      if (runs.sample_offset() < static_cast<int64_t>(moof.size()) ||
+          runs.sample_offset() + runs.sample_size() > fragment_size) {
+        return Status(error::PARSER_FAILURE,
+                      "Samples outside of the 'mdat' following 'moof' in " +
+                          file_name_);
+      }
+      if (!has_samples) {
+        has_samples = true;
+        fragment.starts_with_key_frame = runs.is_keyframe();
+        fragment.earliest_presentation_time = runs.cts();
+        start_time = runs.cts();
+        if (sample_duration_ == 0)
+          sample_duration_ = runs.duration();
+      }
+      fragment.earliest_presentation_time =
+          std::min(fragment.earliest_presentation_time, runs.cts());
+      fragment.duration += runs.duration();
+    }
+  }
+  if (!has_samples)
+    return Status::OK;
+
+  // 'mfhd' is the first child of 'moof'.
+  uint32_t child_type = 0;
+  BufferReader reader(moof.data() + kBoxHeaderSize + 4, 4);
+  if (moof.size() < kBoxHeaderSize + kSequenceNumberOffset + 4 ||
+      !reader.Read4(&child_type) || child_type != FOURCC_mfhd) {
+    return Status(error::PARSER_FAILURE, "'moof' does not start with 'mfhd'.");
+  }
+
+  const bool can_start_segment = fragment.starts_with_key_frame ||
+                                 !chunking_params_.segment_sap_aligned;
+  if (!can_start_segment && fragments_.empty()) {
+    VLOG(1) << "Dropping a fragment before the first key frame of "
+            << file_name_;
+    return Status::OK;
+  }
+  if (can_start_segment) {
+    const int64_t segment_index = segment_clock_.GetSegmentIndex(start_time);
+    if (fragments_.empty() ||
+        IsNewSegmentIndex(segment_index, segment_index_)) {
+      RETURN_IF_ERROR(WriteSegment());
+      segment_index_ = segment_index;
+    }
+  }
+
+  // The fragments are numbered from 1 in the output, as in Fragmenter.
+  ++sequence_number_;
+  uint8_t* sequence_number = moof.data() + kBoxHeaderSize +
+                             kSequenceNumberOffset;
+  for (int i = 0; i < 4; ++i)
+    sequence_number[i] = static_cast<uint8_t>(sequence_number_ >> (24 - 8 * i));
+
+  fragment.data = std::move(moof);
+  fragment.data.insert(fragment.data.end(), mdat.begin(), mdat.end());
+  fragments_.push_back(std::move(fragment));
+  return Status::OK;
+}
+
+Status FragmentPassthrough::WriteSegment() {
+  if (fragments_.empty())
+    return Status::OK;
+
+  SegmentIndex sidx;
+  sidx.reference_id = moov_->tracks[0].header.track_id;
+  sidx.timescale = stream_info_->time_scale();
+  const int64_t segment_start_time = fragments_[0].earliest_presentation_time;
+  sidx.earliest_presentation_time = segment_start_time;
+  int64_t segment_duration = 0;
+  for (const Fragment& fragment : fragments_) {
+    SegmentReference reference;
+    reference.referenced_size = static_cast<uint32_t>(fragment.data.size());
+    reference.subsegment_duration = static_cast<uint32_t>(fragment.duration);
+    reference.starts_with_sap = fragment.starts_with_key_frame;
+    reference.sap_type = fragment.starts_with_key_frame
+                             ? SegmentReference::Type1
+                             : SegmentReference::TypeUnknown;
+    reference.earliest_presentation_time = fragment.earliest_presentation_time;
+    sidx.references.push_back(reference);
+    segment_duration += fragment.duration;
+  }
+
+  BufferWriter header;
+  styp_->Write(&header);
+  if (options_.mp4_params.generate_sidx_in_media_segments)
+    sidx.Write(&header);
+
+  // The header and the fragments are written together, without
+  // concatenating them first.
+  std::vector<File::IoBuffer> buffers;
+  buffers.push_back({header.Buffer(), header.Size()});
+  uint64_t segment_size = header.Size();
+  for (const Fragment& fragment : fragments_) {
+    buffers.push_back({fragment.data.data(), fragment.data.size()});
+    segment_size += fragment.data.size();
+  }
+
+  const std::string file_name =
+      segment_template_.GetSegmentName(segment_start_time,
+                                       static_cast<uint32_t>(segment_number_),
+                                       options_.bandwidth);
+  std::unique_ptr<File, FileCloser> file(
+      File::OpenWithNoBuffering(file_name.c_str(), "w"));
+  if (!file) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot open file for write " + file_name);
+  }
+  if (file->WriteV(buffers.data(), buffers.size()) !=
+      static_cast<int64_t>(segment_size)) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot write segment to file " + file_name);
+  }
+  if (!file.release()->Close())
+    return Status(error::FILE_FAILURE, "Cannot close file " + file_name);
+  fragments_.clear();
+
+  total_duration_ += segment_duration;
+  if (muxer_listener_) {
+    muxer_listener_->OnSampleDurationReady(
+        static_cast<int32_t>(sample_duration_));
+    muxer_listener_->OnNewSegment(file_name, segment_start_time,
+                                  segment_duration, segment_size,
+                                  segment_number_);
+  }
+  ++segment_number_;
+  return Status::OK;
+}
+
+}  // namespace mp4
+}  // namespace media
+}  // namespace shaka
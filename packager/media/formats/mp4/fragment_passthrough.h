@@ -0,0 +1,128 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_FORMATS_MP4_FRAGMENT_PASSTHROUGH_H_
+#define PACKAGER_MEDIA_FORMATS_MP4_FRAGMENT_PASSTHROUGH_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <packager/chunking_params.h>
+#include <packager/media/base/muxer_options.h>
+#include <packager/media/base/muxer_util.h>
+#include <packager/media/chunking/segment_clock.h>
+#include <packager/media/formats/mp4/box_definitions.h>
+#include <packager/media/origin/origin_handler.h>
+
+namespace shaka {
+
+class File;
+
+namespace media {
+
+class MuxerListener;
+class StreamInfo;
+
+namespace mp4 {
+
+/// Packages a fragmented MP4 input with a single clear track into a segment
+/// template output without turning its samples into MediaSamples. The 'ftyp'
+/// and 'moov' boxes of the input are the init segment, and its 'moof' and
+/// 'mdat' boxes are copied verbatim into the media segments, with only the
+/// sequence numbers of the fragments rewritten. A segment starts at a
+/// fragment starting with a key frame in a new segment of the
+/// ChunkingParams, so the fragments are never split, and the fragments of
+/// the output are those of the input. The other top-level boxes of the
+/// input, e.g. 'sidx' and 'emsg', are dropped.
+///
+/// This is a pipeline of its own: the handler has no outputs, and notifies
+/// its MuxerListener like an MP4Muxer writing the same segments would.
+class FragmentPassthrough : public OriginHandler {
+ public:
+  /// @param file_name is the name of the input.
+  /// @param stream_selector is the stream selector of the output.
+  /// @return true if the input is a fragmented MP4 file with a single clear
+  ///         audio or video track, without an edit list, and that track is
+  ///         selected by @a stream_selector. Only the boxes up to 'moov' are
+  ///         read.
+  static bool CanPassThrough(const std::string& file_name,
+                             const std::string& stream_selector);
+
+  /// @param file_name is the name of the input, for which CanPassThrough()
+  ///        returned true.
+  /// @param options is the options of the output, which must have a segment
+  ///        template.
+  /// @param chunking_params sets the segment boundaries. Subsegments do not
+  ///        apply.
+  /// @param muxer_listener is notified of the output. Can be null.
+  FragmentPassthrough(const std::string& file_name,
+                      const MuxerOptions& options,
+                      const ChunkingParams& chunking_params,
+                      std::unique_ptr<MuxerListener> muxer_listener);
+  ~FragmentPassthrough() override;
+
+  /// @name OriginHandler implementation overrides.
+  /// @{
+  Status Run() override;
+  void Cancel() override;
+  /// @}
+
+ protected:
+  /// @name MediaHandler implementation overrides.
+  /// @{
+  Status InitializeInternal() override;
+  /// @}
+
+ private:
+  FragmentPassthrough(const FragmentPassthrough&) = delete;
+  FragmentPassthrough& operator=(const FragmentPassthrough&) = delete;
+
+  struct Fragment {
+    // 'moof' followed by 'mdat'.
+    std::vector<uint8_t> data;
+    int64_t earliest_presentation_time = 0;
+    int64_t duration = 0;
+    bool starts_with_key_frame = false;
+  };
+
+  // Writes the init segment and notifies the listener of the stream.
+  Status StartMedia(const std::vector<uint8_t>& ftyp,
+                    const std::vector<uint8_t>& moov);
+  Status AddFragment(std::vector<uint8_t> moof, std::vector<uint8_t> mdat);
+  Status WriteSegment();
+
+  const std::string file_name_;
+  const MuxerOptions options_;
+  const SegmentTemplate segment_template_;
+  const ChunkingParams chunking_params_;
+  std::unique_ptr<MuxerListener> muxer_listener_;
+  std::atomic<bool> cancelled_{false};
+
+  std::unique_ptr<Movie> moov_;
+  std::unique_ptr<SegmentType> styp_;
+  std::shared_ptr<StreamInfo> stream_info_;
+  SegmentClock segment_clock_;
+  // The duration of the first sample, which is reported as the sample
+  // duration of the stream.
+  int64_t sample_duration_ = 0;
+  uint32_t sequence_number_ = 0;
+  int64_t segment_number_ = 0;
+  int64_t total_duration_ = 0;
+
+  // The fragments of the segment being built. Empty before the first
+  // segment starts.
+  std::vector<Fragment> fragments_;
+  int64_t segment_index_ = 0;
+};
+
+}  // namespace mp4
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_FORMATS_MP4_FRAGMENT_PASSTHROUGH_H_
@@ -0,0 +1,176 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/formats/mp4/fragment_passthrough.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <packager/file.h>
+#include <packager/media/base/buffer_reader.h>
+#include <packager/media/event/mock_muxer_listener.h>
+#include <packager/media/formats/mp4/mp4_media_parser.h>
+#include <packager/media/test/test_data_util.h>
+
+using ::testing::_;
+using ::testing::StrEq;
+
+namespace shaka {
+namespace media {
+namespace mp4 {
+namespace {
+
+// A single AAC track in three fragments, with 'styp' and 'sidx'.
+const char kInputFile[] = "bear-mpeg2-aac-only_frag.mp4";
+const char kInitSegment[] = "memory://passthrough/init.mp4";
+const char kSegmentTemplate[] = "memory://passthrough/$Number$.m4s";
+
+std::string GetInputPath(const std::string& name) {
+  return GetTestDataFilePath(name).string();
+}
+
+// @return the number of samples in |data|.
+size_t CountSamples(const std::vector<std::string>& data) {
+  size_t num_samples = 0;
+  MP4MediaParser parser;
+  parser.Init([](const std::vector<std::shared_ptr<StreamInfo>>&) {},
+              [&num_samples](uint32_t, std::shared_ptr<MediaSample>) {
+                ++num_samples;
+                return true;
+              },
+              [](uint32_t, std::shared_ptr<TextSample>) { return true; },
+              nullptr);
+  for (const std::string& chunk : data) {
+    EXPECT_TRUE(parser.Parse(reinterpret_cast<const uint8_t*>(chunk.data()),
+                             static_cast<int>(chunk.size())));
+  }
+  EXPECT_TRUE(parser.Flush());
+  return num_samples;
+}
+
+// @return the types of the top-level boxes of |data|, and the sequence
+//         numbers of its fragments in |sequence_numbers|.
+std::vector<FourCC> GetBoxes(const std::string& data,
+                             std::vector<uint32_t>* sequence_numbers) {
+  std::vector<FourCC> boxes;
+  BufferReader reader(reinterpret_cast<const uint8_t*>(data.data()),
+                      data.size());
+  while (reader.HasBytes(8)) {
+    const size_t box_start = reader.pos();
+    uint32_t size = 0;
+    uint32_t type = 0;
+    EXPECT_TRUE(reader.Read4(&size) && reader.Read4(&type));
+    boxes.push_back(static_cast<FourCC>(type));
+    if (type == FOURCC_moof) {
+      // The sequence number follows the headers of 'moof' and 'mfhd'.
+      uint32_t sequence_number = 0;
+      EXPECT_TRUE(reader.SkipBytes(12) && reader.Read4(&sequence_number));
+      sequence_numbers->push_back(sequence_number);
+    }
+    EXPECT_TRUE(reader.SkipBytes(box_start + size - reader.pos()));
+  }
+  return boxes;
+}
+
+}  // namespace
+
+class FragmentPassthroughTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    options_.output_file_name = kInitSegment;
+    options_.segment_template = kSegmentTemplate;
+  }
+
+  std::unique_ptr<FragmentPassthrough> CreatePassthrough(
+      double segment_duration_in_seconds) {
+    ChunkingParams chunking_params;
+    chunking_params.segment_duration_in_seconds = segment_duration_in_seconds;
+    listener_ = new MockMuxerListener;
+    return std::make_unique<FragmentPassthrough>(
+        GetInputPath(kInputFile), options_, chunking_params,
+        std::unique_ptr<MuxerListener>(listener_));
+  }
+
+  MuxerOptions options_;
+  // Owned by the FragmentPassthrough.
+  MockMuxerListener* listener_ = nullptr;
+};
+
+TEST_F(FragmentPassthroughTest, CanPassThrough) {
+  EXPECT_TRUE(
+      FragmentPassthrough::CanPassThrough(GetInputPath(kInputFile), "audio"));
+  EXPECT_TRUE(
+      FragmentPassthrough::CanPassThrough(GetInputPath(kInputFile), "0"));
+  EXPECT_FALSE(
+      FragmentPassthrough::CanPassThrough(GetInputPath(kInputFile), "video"));
+  // Two tracks.
+  EXPECT_FALSE(FragmentPassthrough::CanPassThrough(
+      GetInputPath("bear-640x360-av_frag.mp4"), "video"));
+  // Encrypted.
+  EXPECT_FALSE(FragmentPassthrough::CanPassThrough(
+      GetInputPath("bear-640x360-v_frag-cenc-senc.mp4"), "video"));
+  // Not fragmented.
+  EXPECT_FALSE(FragmentPassthrough::CanPassThrough(
+      GetInputPath("bear-640x360-aac_lc-silent_right.mp4"), "audio"));
+}
+
+TEST_F(FragmentPassthroughTest, CopiesFragments) {
+  std::unique_ptr<FragmentPassthrough> passthrough = CreatePassthrough(100);
+
+  EXPECT_CALL(*listener_, OnMediaStart(_, _, _, _));
+  EXPECT_CALL(*listener_, OnSampleDurationReady(_));
+  EXPECT_CALL(*listener_,
+              OnNewSegment(StrEq("memory://passthrough/1.m4s"), _, _, _, 1));
+  EXPECT_CALL(*listener_, OnMediaEndMock(_, _, _, _, _, _, _, _, _));
+  ASSERT_TRUE(passthrough->Initialize().ok());
+  ASSERT_TRUE(passthrough->Run().ok());
+
+  std::string init_segment;
+  std::string segment;
+  ASSERT_TRUE(File::ReadFileToString(kInitSegment, &init_segment));
+  ASSERT_TRUE(File::ReadFileToString("memory://passthrough/1.m4s", &segment));
+
+  std::vector<uint32_t> sequence_numbers;
+  EXPECT_EQ((std::vector<FourCC>{FOURCC_ftyp, FOURCC_moov}),
+            GetBoxes(init_segment, &sequence_numbers));
+  EXPECT_EQ((std::vector<FourCC>{FOURCC_styp, FOURCC_sidx, FOURCC_moof,
+                                 FOURCC_mdat, FOURCC_moof, FOURCC_mdat,
+                                 FOURCC_moof, FOURCC_mdat}),
+            GetBoxes(segment, &sequence_numbers));
+  EXPECT_EQ((std::vector<uint32_t>{1, 2, 3}), sequence_numbers);
+
+  std::string input;
+  ASSERT_TRUE(File::ReadFileToString(GetInputPath(kInputFile).c_str(), &input));
+  EXPECT_EQ(CountSamples({input}), CountSamples({init_segment, segment}));
+}
+
+TEST_F(FragmentPassthroughTest, SegmentPerFragment) {
+  std::unique_ptr<FragmentPassthrough> passthrough = CreatePassthrough(0.1);
+
+  EXPECT_CALL(*listener_, OnMediaStart(_, _, _, _));
+  EXPECT_CALL(*listener_, OnSampleDurationReady(_)).Times(3);
+  EXPECT_CALL(*listener_,
+              OnNewSegment(StrEq("memory://passthrough/1.m4s"), _, _, _, 1));
+  EXPECT_CALL(*listener_,
+              OnNewSegment(StrEq("memory://passthrough/2.m4s"), _, _, _, 2));
+  EXPECT_CALL(*listener_,
+              OnNewSegment(StrEq("memory://passthrough/3.m4s"), _, _, _, 3));
+  EXPECT_CALL(*listener_, OnMediaEndMock(_, _, _, _, _, _, _, _, _));
+  ASSERT_TRUE(passthrough->Initialize().ok());
+  ASSERT_TRUE(passthrough->Run().ok());
+
+  std::string segment;
+  ASSERT_TRUE(File::ReadFileToString("memory://passthrough/3.m4s", &segment));
+  std::vector<uint32_t> sequence_numbers;
+  EXPECT_EQ((std::vector<FourCC>{FOURCC_styp, FOURCC_sidx, FOURCC_moof,
+                                 FOURCC_mdat}),
+            GetBoxes(segment, &sequence_numbers));
+  EXPECT_EQ((std::vector<uint32_t>{3}), sequence_numbers);
+}
+
+}  // namespace mp4
+}  // namespace media
+}  // namespace shaka
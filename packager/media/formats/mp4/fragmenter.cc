@@ -11,12 +11,14 @@
 
 #include <absl/log/check.h>
 
+#include <packager/macros/logging.h>
 #include <packager/macros/status.h>
 #include <packager/media/base/audio_stream_info.h>
 #include <packager/media/base/buffer_writer.h>
 #include <packager/media/base/media_sample.h>
 #include <packager/media/formats/mp4/box_definitions.h>
 #include <packager/media/formats/mp4/key_frame_info.h>
+#include <packager/utils/trace.h>
 
 namespace shaka {
 namespace media {
@@ -41,10 +43,10 @@ void NewSampleEncryptionEntry(const DecryptConfig& decrypt_config,
   if (!use_constant_iv)
     sample_encryption_entry.initialization_vector = decrypt_config.iv();
   sample_encryption_entry.subsamples = decrypt_config.subsamples();
-  sample_encryption.sample_encryption_entries.push_back(
-      sample_encryption_entry);
   traf->auxiliary_size.sample_info_sizes.push_back(
       sample_encryption_entry.ComputeSize());
+  sample_encryption.sample_encryption_entries.push_back(
+      std::move(sample_encryption_entry));
 }
 
 }  // namespace
@@ -57,9 +59,11 @@ Fragmenter::Fragmenter(std::shared_ptr<const StreamInfo> stream_info,
       edit_list_offset_(edit_list_offset),
       seek_preroll_(GetSeekPreroll(*stream_info_)),
       earliest_presentation_time_(kInvalidTime),
-      first_sap_time_(kInvalidTime) {
+      first_sap_time_(kInvalidTime),
+      data_(new BufferWriter()) {
   DCHECK(stream_info_);
   DCHECK(traf);
+  data_->UseHugePages();
 }
 
 Fragmenter::~Fragmenter() {}
@@ -69,13 +73,15 @@ Status Fragmenter::AddSample(const MediaSample& sample) {
   const int64_t dts = sample.dts();
   const int64_t duration = sample.duration();
   if (duration == 0)
-    LOG(WARNING) << "Unexpected sample with zero duration @ dts " << dts;
+    LOG_RATE_LIMITED(WARNING)
+        << "Unexpected sample with zero duration @ dts " << dts;
 
   if (!fragment_initialized_)
     RETURN_IF_ERROR(InitializeFragment(dts));
 
   if (sample.side_data_size() > 0)
-    LOG(WARNING) << "MP4 samples do not support side data. Side data ignored.";
+    LOG_RATE_LIMITED(WARNING)
+        << "MP4 samples do not support side data. Side data ignored.";
 
   // Fill in sample parameters. It will be optimized later.
   traf_->runs[0].sample_sizes.push_back(
@@ -97,6 +103,7 @@ Status Fragmenter::AddSample(const MediaSample& sample) {
   }
 
   data_->AppendArray(sample.data(), sample.data_size());
+  data_memory_.Set(data_->Capacity());
 
   traf_->runs[0].sample_composition_time_offsets.push_back(pts - dts);
   if (pts != dts)
@@ -138,9 +145,18 @@ Status Fragmenter::InitializeFragment(int64_t first_sample_dts) {
   const int64_t dts_before_edit = first_sample_dts + edit_list_offset_;
   traf_->decode_time.decode_time = dts_before_edit;
 
-  traf_->runs.clear();
+  // Reset the run in place, keeping its vectors, which have grown to the
+  // sample count of the previous fragments, as the data buffer below.
   traf_->runs.resize(1);
-  traf_->runs[0].flags = TrackFragmentRun::kDataOffsetPresentMask;
+  TrackFragmentRun& run = traf_->runs[0];
+  run.version = 0;
+  run.flags = TrackFragmentRun::kDataOffsetPresentMask;
+  run.sample_count = 0;
+  run.data_offset = 0;
+  run.sample_flags.clear();
+  run.sample_sizes.clear();
+  run.sample_durations.clear();
+  run.sample_composition_time_offsets.clear();
   traf_->auxiliary_size.sample_info_sizes.clear();
   traf_->auxiliary_offset.offsets.clear();
   traf_->sample_encryption.sample_encryption_entries.clear();
@@ -153,7 +169,8 @@ Status Fragmenter::InitializeFragment(int64_t first_sample_dts) {
   fragment_duration_ = 0;
   earliest_presentation_time_ = kInvalidTime;
   first_sap_time_ = kInvalidTime;
-  data_.reset(new BufferWriter());
+  // Keep the buffer, which has grown to the size of the previous fragments.
+  data_->Clear();
   key_frame_infos_.clear();
   return Status::OK;
 }
@@ -161,6 +178,7 @@ Status Fragmenter::InitializeFragment(int64_t first_sample_dts) {
 Status Fragmenter::FinalizeFragment() {
   if (!fragment_initialized_)
     return Status::OK;
+  ScopedTraceEvent trace_event("Fragmenter::FinalizeFragment");
 
   if (stream_info_->is_encrypted()) {
     Status status = FinalizeFragmentForEncryption();
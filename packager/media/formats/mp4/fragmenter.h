@@ -15,6 +15,7 @@
 
 #include <packager/macros/classes.h>
 #include <packager/status.h>
+#include <packager/utils/memory_accounting.h>
 
 namespace shaka {
 namespace media {
@@ -98,6 +99,7 @@ class Fragmenter {
   int64_t earliest_presentation_time_ = 0;
   int64_t first_sap_time_ = 0;
   std::unique_ptr<BufferWriter> data_;
+  MemoryCharge data_memory_{MemorySubsystem::kFragmenterBuffers};
   // Saves key frames information, for Video.
   std::vector<KeyFrameInfo> key_frame_infos_;
 
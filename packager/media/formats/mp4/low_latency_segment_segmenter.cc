@@ -82,22 +82,6 @@ Status LowLatencySegmentSegmenter::DoFinalizeChunk(int64_t segment_number) {
   return WriteChunk();
 }
 
-Status LowLatencySegmentSegmenter::WriteInitSegment() {
-  DCHECK(ftyp());
-  DCHECK(moov());
-  // Generate the output file with init segment.
-  std::unique_ptr<File, FileCloser> file(
-      File::Open(options().output_file_name.c_str(), "w"));
-  if (!file) {
-    return Status(error::FILE_FAILURE,
-                  "Cannot open file for write " + options().output_file_name);
-  }
-  std::unique_ptr<BufferWriter> buffer(new BufferWriter);
-  ftyp()->Write(buffer.get());
-  moov()->Write(buffer.get());
-  return buffer->WriteToFile(file.get());
-}
-
 Status LowLatencySegmentSegmenter::WriteInitialChunk(int64_t segment_number) {
   DCHECK(sidx());
   DCHECK(fragment_buffer());
@@ -113,9 +97,9 @@ Status LowLatencySegmentSegmenter::WriteInitialChunk(int64_t segment_number) {
     // Append the segment to output file if segment template is not specified.
     file_name_ = options().output_file_name.c_str();
   } else {
-    file_name_ = GetSegmentName(options().segment_template,
-                                sidx()->earliest_presentation_time,
-                                num_segments_, options().bandwidth);
+    file_name_ = segment_template().GetSegmentName(
+        sidx()->earliest_presentation_time, num_segments_,
+        options().bandwidth);
   }
 
   // Create the segment file
@@ -125,10 +109,12 @@ Status LowLatencySegmentSegmenter::WriteInitialChunk(int64_t segment_number) {
                   "Cannot open segment file: " + file_name_);
   }
 
-  std::unique_ptr<BufferWriter> buffer(new BufferWriter());
+  BufferWriter* buffer = segment_header_buffer();
+  buffer->Clear();
 
   // Write the styp header to the beginning of the segment.
-  styp_->Write(buffer.get());
+  styp_->Write(buffer);
+  WriteEventBoxes(buffer);
 
   const size_t segment_header_size = buffer->Size();
   segment_size_ = segment_header_size + fragment_buffer()->Size();
@@ -164,6 +150,7 @@ Status LowLatencySegmentSegmenter::WriteInitialChunk(int64_t segment_number) {
     muxer_listener()->OnNewSegment(
         file_name_, sidx()->earliest_presentation_time, segment_duration,
         segment_size_, segment_number);
+    NotifyNewChunk(0);
     is_initial_chunk_in_seg_ = false;
   }
 
@@ -173,14 +160,29 @@ Status LowLatencySegmentSegmenter::WriteInitialChunk(int64_t segment_number) {
 Status LowLatencySegmentSegmenter::WriteChunk() {
   DCHECK(fragment_buffer());
 
+  const uint64_t chunk_offset = segment_size_;
+  segment_size_ += fragment_buffer()->Size();
+
   // Write the chunk data to the file
   RETURN_IF_ERROR(fragment_buffer()->WriteToFile(segment_file_.get()));
 
   UpdateProgress(GetSegmentDuration());
 
+  if (muxer_listener())
+    NotifyNewChunk(chunk_offset);
+
   return Status::OK;
 }
 
+void LowLatencySegmentSegmenter::NotifyNewChunk(uint64_t chunk_offset) {
+  DCHECK(sidx());
+  DCHECK(!sidx()->references.empty());
+  const SegmentReference& reference = sidx()->references.back();
+  muxer_listener()->OnNewChunk(
+      reference.earliest_presentation_time, reference.subsegment_duration,
+      chunk_offset, segment_size_ - chunk_offset, reference.starts_with_sap);
+}
+
 Status LowLatencySegmentSegmenter::FinalizeSegment() {
   if (muxer_listener()) {
     muxer_listener()->OnCompletedSegment(GetSegmentDuration(), segment_size_);
@@ -48,10 +48,12 @@ class LowLatencySegmentSegmenter : public Segmenter {
   Status DoFinalizeChunk(int64_t segment_number) override;
 
   // Write segment to file.
-  Status WriteInitSegment();
   Status WriteChunk();
   Status WriteInitialChunk(int64_t segment_number);
   Status FinalizeSegment();
+  // Notify the listener of the chunk just written at |chunk_offset| in the
+  // segment file.
+  void NotifyNewChunk(uint64_t chunk_offset);
 
   uint64_t GetSegmentDuration();
 
@@ -5,15 +5,18 @@
 #include <packager/media/formats/mp4/mp4_media_parser.h>
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
 #include <limits>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 #include <absl/strings/numbers.h>
+#include <absl/synchronization/notification.h>
 
 #include <packager/file.h>
 #include <packager/file/file_closer.h>
+#include <packager/file/thread_pool.h>
 #include <packager/macros/compiler.h>
 #include <packager/macros/logging.h>
 #include <packager/media/base/audio_stream_info.h>
@@ -239,13 +242,24 @@ const uint64_t kNanosecondsPerSecond = 1000000000ull;
 
 }  // namespace
 
+// A sample being decrypted on a worker thread.
+struct MP4MediaParser::PendingSample {
+  uint32_t track_id = 0;
+  std::shared_ptr<MediaSample> stream_sample;
+  // Set by the worker thread before |done| is notified.
+  bool success = false;
+  absl::Notification done;
+};
+
 MP4MediaParser::MP4MediaParser()
     : state_(kWaitingForInit),
       decryption_key_source_(NULL),
       moof_head_(0),
       mdat_tail_(0) {}
 
-MP4MediaParser::~MP4MediaParser() {}
+MP4MediaParser::~MP4MediaParser() {
+  DropPendingSamples();
+}
 
 void MP4MediaParser::Init(const InitCB& init_cb,
                           const NewMediaSampleCB& new_media_sample_cb,
@@ -260,11 +274,19 @@ void MP4MediaParser::Init(const InitCB& init_cb,
   init_cb_ = init_cb;
   new_sample_cb_ = new_media_sample_cb;
   decryption_key_source_ = decryption_key_source;
-  if (decryption_key_source)
+  if (decryption_key_source && decrypt_samples_) {
     decryptor_source_.reset(new DecryptorSource(decryption_key_source));
+    if (num_decryption_threads_ > 1) {
+      for (uint32_t i = 0; i < num_decryption_threads_; ++i) {
+        sample_decryptor_sources_.emplace_back(
+            new DecryptorSource(decryption_key_source));
+      }
+    }
+  }
 }
 
 void MP4MediaParser::Reset() {
+  DropPendingSamples();
   queue_.Reset();
   runs_.reset();
   moof_head_ = 0;
@@ -273,6 +295,7 @@ void MP4MediaParser::Reset() {
 
 bool MP4MediaParser::Flush() {
   DCHECK_NE(state_, kWaitingForInit);
+  RCHECK(DispatchPendingSamples(0));
   Reset();
   ChangeState(kParsingBoxes);
   return true;
@@ -301,6 +324,10 @@ bool MP4MediaParser::Parse(const uint8_t* buf, int size) {
     }
   } while (result && !err);
 
+  // Do not hold samples back until more data is parsed.
+  if (!err && !DispatchPendingSamples(0))
+    err = true;
+
   if (err) {
     DLOG(ERROR) << "Error while parsing MP4";
     moov_.reset();
@@ -387,6 +414,145 @@ bool MP4MediaParser::LoadMoov(const std::string& file_path) {
   return true;
 }
 
+bool MP4MediaParser::LoadMoov(const uint8_t* data, uint64_t size) {
+  uint64_t position(0);
+  bool mdat_seen(false);
+  while (true) {
+    const uint32_t kBoxHeaderReadSize(16);
+    if (position >= size) {
+      LOG(ERROR) << "Could not find 'moov' box in media file.";
+      return false;
+    }
+    if (size - position < kBoxHeaderReadSize) {
+      LOG(ERROR) << "Error reading media file.";
+      return false;
+    }
+    uint64_t box_size;
+    FourCC box_type;
+    bool err;
+    if (!BoxReader::StartBox(data + position, kBoxHeaderReadSize, &box_type,
+                             &box_size, &err) ||
+        box_size == 0) {
+      LOG(ERROR) << "Could not start box from media file.";
+      return false;
+    }
+    if (box_type == FOURCC_mdat) {
+      mdat_seen = true;
+    } else if (box_type == FOURCC_moov) {
+      if (!mdat_seen) {
+        // 'moov' is before 'mdat'. Nothing to do.
+        break;
+      }
+      // 'mdat' before 'moov'. Parse 'moov' directly from memory.
+      if (box_size > size - position ||
+          box_size > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+        LOG(ERROR) << "Invalid 'moov' box size " << box_size;
+        return false;
+      }
+      if (!Parse(data + position, static_cast<int>(box_size))) {
+        LOG(ERROR) << "Error parsing mp4 file.";
+        return false;
+      }
+      queue_.Reset();  // So that we don't need to adjust data offsets.
+      mdat_tail_ = 0;  // So it will skip boxes until mdat.
+      break;  // Done.
+    }
+    position += box_size;
+  }
+  return true;
+}
+
+bool MP4MediaParser::IsFullyIndexed() const {
+  // Without 'mvex', there are no fragments and 'moov' describes all the
+  // samples.
+  return state_ == kEmittingSamples && moov_ && runs_ &&
+         moov_->extends.tracks.empty();
+}
+
+void MP4MediaParser::StartIndexedReading(const std::set<uint32_t>& track_ids,
+                                         const ReadAtCB& read_cb) {
+  DCHECK(IsFullyIndexed());
+  DCHECK(read_cb);
+  indexed_track_ids_ = track_ids;
+  read_at_cb_ = read_cb;
+  // The data passed to Parse() so far is not needed anymore.
+  queue_.Reset();
+}
+
+void MP4MediaParser::SeekIndexed(double start_seconds) {
+  DCHECK(read_at_cb_);
+  for (const Track& track : moov_->tracks) {
+    const uint32_t track_id = track.header.track_id;
+    if (indexed_track_ids_.count(track_id) == 0)
+      continue;
+    const int64_t pts =
+        std::llround(start_seconds * track.media.header.timescale);
+    int64_t dts = 0;
+    if (runs_->FindKeyFrameDts(track_id, pts, &dts))
+      indexed_start_dts_[track_id] = dts;
+  }
+}
+
+bool MP4MediaParser::ParseIndexedRun(bool* end_of_stream) {
+  DCHECK(read_at_cb_);
+  DCHECK(end_of_stream);
+  *end_of_stream = false;
+
+  while (true) {
+    // Skip the runs of the other tracks without reading their data.
+    while (runs_->IsRunValid() &&
+           (!runs_->IsSampleValid() ||
+            (!runs_->is_audio() && !runs_->is_video()) ||
+            indexed_track_ids_.count(runs_->track_id()) == 0)) {
+      runs_->AdvanceRun();
+    }
+    if (!runs_->IsRunValid()) {
+      *end_of_stream = true;
+      return true;
+    }
+    // Likewise for the samples before the seek point.
+    const auto start_dts = indexed_start_dts_.find(runs_->track_id());
+    if (start_dts == indexed_start_dts_.end())
+      break;
+    while (runs_->IsSampleValid() && runs_->dts() < start_dts->second)
+      runs_->AdvanceSample();
+    if (runs_->IsSampleValid())
+      break;
+    runs_->AdvanceRun();
+  }
+
+  if (runs_->AuxInfoNeedsToBeCached()) {
+    std::vector<uint8_t> aux_info(runs_->aux_info_size());
+    RCHECK(read_at_cb_(runs_->aux_info_offset() + moof_head_, aux_info.data(),
+                       aux_info.size()));
+    RCHECK(runs_->CacheAuxInfo(aux_info.data(), aux_info.size()));
+  }
+
+  // The samples of a run are contiguous, so read them all at once.
+  const int64_t run_offset = runs_->sample_offset() + moof_head_;
+  const int64_t run_size = runs_->GetRemainingRunSize();
+  std::shared_ptr<uint8_t> run_data(new uint8_t[run_size],
+                                    std::default_delete<uint8_t[]>());
+  if (!read_at_cb_(run_offset, run_data.get(), run_size)) {
+    LOG(ERROR) << "Cannot read " << run_size << " bytes of samples at offset "
+               << run_offset;
+    return false;
+  }
+  for (; runs_->IsSampleValid(); runs_->AdvanceSample()) {
+    const uint8_t* media_data =
+        run_data.get() + (runs_->sample_offset() + moof_head_ - run_offset);
+    RCHECK(EmitSample(media_data, run_data));
+  }
+  runs_->AdvanceRun();
+  return DispatchPendingSamples(0);
+}
+
+void MP4MediaParser::SetTimestampAdjustments(
+    const std::map<uint32_t, int64_t>& timestamp_adjustments) {
+  DCHECK(!runs_);
+  timestamp_adjustments_ = timestamp_adjustments;
+}
+
 bool MP4MediaParser::ParseBox(bool* err) {
   const uint8_t* buf;
   int size;
@@ -879,6 +1045,7 @@ bool MP4MediaParser::ParseMoov(BoxReader* reader) {
   if (!FetchKeysIfNecessary(moov_->pssh))
     return false;
   runs_.reset(new TrackRunIterator(moov_.get()));
+  runs_->set_timestamp_adjustments(timestamp_adjustments_);
   RCHECK(runs_->Init());
   ChangeState(kEmittingSamples);
   return true;
@@ -889,8 +1056,10 @@ bool MP4MediaParser::ParseMoof(BoxReader* reader) {
   RCHECK(moov_.get());
   MovieFragment moof;
   RCHECK(moof.Parse(reader));
-  if (!runs_)
+  if (!runs_) {
     runs_.reset(new TrackRunIterator(moov_.get()));
+    runs_->set_timestamp_adjustments(timestamp_adjustments_);
+  }
   RCHECK(runs_->Init(moof));
   if (!FetchKeysIfNecessary(moof.pssh))
     return false;
@@ -907,6 +1076,9 @@ bool MP4MediaParser::FetchKeysIfNecessary(
   if (!decryption_key_source_)
     return true;
 
+  // The keys are not looked up while samples are being decrypted.
+  RCHECK(DispatchPendingSamples(0));
+
   std::vector<uint8_t> pssh_raw_data;
   for (const auto& header : headers) {
     pssh_raw_data.insert(pssh_raw_data.end(), header.raw_box.begin(),
@@ -975,20 +1147,39 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
     return false;
   }
 
-  const uint8_t* media_data = buf;
+  if (!EmitSample(buf, nullptr)) {
+    *err = true;
+    return false;
+  }
+  runs_->AdvanceSample();
+  return true;
+}
+
+bool MP4MediaParser::EmitSample(
+    const uint8_t* media_data,
+    const std::shared_ptr<const uint8_t>& run_data) {
   const size_t media_data_size = runs_->sample_size();
   // Use a dummy data size of 0 to avoid copying overhead.
   // Actual media data is set later.
   const size_t kDummyDataSize = 0;
   std::shared_ptr<MediaSample> stream_sample(
       MediaSample::CopyFrom(media_data, kDummyDataSize, runs_->is_keyframe()));
+  stream_sample->set_dts(runs_->dts());
+  stream_sample->set_pts(runs_->cts());
+  stream_sample->set_duration(runs_->duration());
+
+  DVLOG(3) << "Pushing frame: "
+           << ", key=" << runs_->is_keyframe()
+           << ", dur=" << runs_->duration()
+           << ", dts=" << runs_->dts()
+           << ", cts=" << runs_->cts()
+           << ", size=" << runs_->sample_size();
 
   if (runs_->is_encrypted()) {
-    std::shared_ptr<uint8_t> decrypted_media_data(
-        new uint8_t[media_data_size], std::default_delete<uint8_t[]>());
+    std::shared_ptr<uint8_t> decrypted_media_data =
+        MediaSample::AllocateData(media_data_size);
     std::unique_ptr<DecryptConfig> decrypt_config = runs_->GetDecryptConfig();
     if (!decrypt_config) {
-      *err = true;
       LOG(ERROR) << "Missing decrypt config.";
       return false;
     }
@@ -999,42 +1190,107 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
       // decrypt_config so that the demuxed sample can be decrypted later.
       stream_sample->set_decrypt_config(std::move(decrypt_config));
       stream_sample->set_is_encrypted(true);
+    } else if (!sample_decryptor_sources_.empty()) {
+      uint8_t* decrypted_data = decrypted_media_data.get();
+      stream_sample->TransferData(std::move(decrypted_media_data),
+                                  media_data_size);
+      std::shared_ptr<const uint8_t> encrypted_data =
+          run_data ? std::shared_ptr<const uint8_t>(run_data, media_data)
+                   : queue_.Share(media_data);
+      return DecryptSampleOnWorkerThread(std::move(decrypt_config),
+                                         std::move(encrypted_data),
+                                         std::move(stream_sample),
+                                         decrypted_data);
     } else {
       if (!decryptor_source_->DecryptSampleBuffer(decrypt_config.get(),
                                                   media_data, media_data_size,
                                                   decrypted_media_data.get())) {
-        *err = true;
         LOG(ERROR) << "Cannot decrypt samples.";
         return false;
       }
       stream_sample->TransferData(std::move(decrypted_media_data),
                                   media_data_size);
     }
+  } else if (run_data) {
+    stream_sample->TransferData(
+        std::shared_ptr<const uint8_t>(run_data, media_data), media_data_size);
   } else {
-    stream_sample->SetData(media_data, media_data_size);
+    // Reference the sample in the queue instead of copying it.
+    stream_sample->TransferData(queue_.Share(media_data), media_data_size);
   }
 
-  stream_sample->set_dts(runs_->dts());
-  stream_sample->set_pts(runs_->cts());
-  stream_sample->set_duration(runs_->duration());
-
-  DVLOG(3) << "Pushing frame: "
-           << ", key=" << runs_->is_keyframe()
-           << ", dur=" << runs_->duration()
-           << ", dts=" << runs_->dts()
-           << ", cts=" << runs_->cts()
-           << ", size=" << runs_->sample_size();
+  if (!pending_samples_.empty()) {
+    // Queue the sample behind the samples being decrypted.
+    std::shared_ptr<PendingSample> pending_sample(new PendingSample);
+    pending_sample->track_id = runs_->track_id();
+    pending_sample->stream_sample = std::move(stream_sample);
+    pending_sample->success = true;
+    pending_sample->done.Notify();
+    pending_samples_.push_back(std::move(pending_sample));
+    return true;
+  }
 
   if (!new_sample_cb_(runs_->track_id(), stream_sample)) {
-    *err = true;
     LOG(ERROR) << "Failed to process the sample.";
     return false;
   }
+  return true;
+}
 
-  runs_->AdvanceSample();
+bool MP4MediaParser::DecryptSampleOnWorkerThread(
+    std::unique_ptr<DecryptConfig> decrypt_config,
+    std::shared_ptr<const uint8_t> encrypted_data,
+    std::shared_ptr<MediaSample> stream_sample,
+    uint8_t* decrypted_data) {
+  // At most |num_decryption_threads_| - 1 samples are pending here, so the
+  // decryptor source is not in use by the sample it was last used for.
+  DecryptorSource* decryptor_source =
+      sample_decryptor_sources_[next_sample_decryptor_source_].get();
+  next_sample_decryptor_source_ =
+      (next_sample_decryptor_source_ + 1) % sample_decryptor_sources_.size();
+
+  std::shared_ptr<PendingSample> pending_sample(new PendingSample);
+  pending_sample->track_id = runs_->track_id();
+  pending_sample->stream_sample = std::move(stream_sample);
+  const size_t data_size = pending_sample->stream_sample->data_size();
+  std::shared_ptr<const DecryptConfig> config(std::move(decrypt_config));
+  ThreadPool::instance.PostTask([pending_sample, decryptor_source, config,
+                                 encrypted_data, data_size, decrypted_data]() {
+    pending_sample->success = decryptor_source->DecryptSampleBuffer(
+        config.get(), encrypted_data.get(), data_size, decrypted_data);
+    pending_sample->done.Notify();
+  });
+  pending_samples_.push_back(std::move(pending_sample));
+
+  return DispatchPendingSamples(num_decryption_threads_ - 1);
+}
+
+bool MP4MediaParser::DispatchPendingSamples(size_t max_pending_samples) {
+  while (pending_samples_.size() > max_pending_samples) {
+    std::shared_ptr<PendingSample> pending_sample =
+        std::move(pending_samples_.front());
+    pending_samples_.pop_front();
+
+    pending_sample->done.WaitForNotification();
+    if (!pending_sample->success) {
+      LOG(ERROR) << "Cannot decrypt samples.";
+      return false;
+    }
+    if (!new_sample_cb_(pending_sample->track_id,
+                        std::move(pending_sample->stream_sample))) {
+      LOG(ERROR) << "Failed to process the sample.";
+      return false;
+    }
+  }
   return true;
 }
 
+void MP4MediaParser::DropPendingSamples() {
+  for (const std::shared_ptr<PendingSample>& pending_sample : pending_samples_)
+    pending_sample->done.WaitForNotification();
+  pending_samples_.clear();
+}
+
 bool MP4MediaParser::ReadAndDiscardMDATsUntil(const int64_t offset) {
   bool err = false;
   while (mdat_tail_ < offset) {
@@ -8,8 +8,11 @@
 #define PACKAGER_MEDIA_FORMATS_MP4_MP4_MEDIA_PARSER_H_
 
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <map>
 #include <memory>
+#include <set>
 #include <vector>
 
 #include <absl/flags/declare.h>
@@ -54,7 +57,73 @@ class MP4MediaParser : public MediaParser {
   /// @return true if successful, false otherwise.
   bool LoadMoov(const std::string& file_path);
 
+  /// Same as above, but walks the boxes of a media file which is already in
+  /// memory, e.g. memory mapped.
+  /// @param data points to the start of the media file.
+  /// @param size is the size of the media file.
+  /// @return true if successful, false otherwise.
+  bool LoadMoov(const uint8_t* data, uint64_t size);
+
+  /// Called to read @a size bytes at @a position of the media file into
+  /// @a buffer.
+  /// @return true if all the bytes were read.
+  typedef std::function<bool(uint64_t position, uint8_t* buffer, uint64_t size)>
+      ReadAtCB;
+
+  /// @return true if 'moov' has been parsed and describes all the samples,
+  ///         i.e. the file is not fragmented, so that the samples can be read
+  ///         with ParseIndexedRun() instead of Parse().
+  bool IsFullyIndexed() const;
+
+  /// Switch to reading the samples directly from their positions in the media
+  /// file, instead of parsing the data passed to Parse(). Only the samples of
+  /// the tracks in @a track_ids are read. Must only be called if
+  /// IsFullyIndexed() returns true.
+  /// @param track_ids are the ids of the tracks to emit samples for.
+  /// @param read_cb is called to read sample data from the media file.
+  void StartIndexedReading(const std::set<uint32_t>& track_ids,
+                           const ReadAtCB& read_cb);
+
+  /// Skip the samples of the selected tracks before their last key frame
+  /// presented at or before @a start_seconds, without reading them. Must only
+  /// be called after StartIndexedReading().
+  /// @param start_seconds is a time in seconds of the input timeline.
+  void SeekIndexed(double start_seconds);
+
+  /// Read and emit the samples of the next run of a selected track. Must only
+  /// be called after StartIndexedReading().
+  /// @param end_of_stream is set to true if there are no more samples.
+  /// @return true if successful, false otherwise.
+  [[nodiscard]] bool ParseIndexedRun(bool* end_of_stream);
+
+  /// Use the given timestamp adjustments instead of determining them from the
+  /// first track fragments. This allows parsing the fragments of a file
+  /// without the fragments before them. Must be called before parsing the
+  /// 'moov'.
+  /// @param timestamp_adjustments are the adjustments by track ID, as returned
+  ///        by TrackRunIterator::timestamp_adjustments().
+  void SetTimestampAdjustments(
+      const std::map<uint32_t, int64_t>& timestamp_adjustments);
+
+  /// @param num_decryption_threads is the maximum number of samples decrypted
+  ///        concurrently on worker threads. Samples are still emitted in
+  ///        order. 0 or 1 means samples are decrypted on the parsing thread.
+  ///        Must be called before Init().
+  void set_num_decryption_threads(uint32_t num_decryption_threads) {
+    num_decryption_threads_ = num_decryption_threads;
+  }
+
+  /// @param decrypt_samples is false to keep the samples encrypted, with their
+  ///        decrypt config, even if a key source is passed to Init(). The
+  ///        keys are still fetched, so the samples can be decrypted later with
+  ///        the key source. Must be called before Init().
+  void set_decrypt_samples(bool decrypt_samples) {
+    decrypt_samples_ = decrypt_samples;
+  }
+
  private:
+  struct PendingSample;
+
   enum State {
     kWaitingForInit,
     kParsingBoxes,
@@ -83,6 +152,24 @@ class MP4MediaParser : public MediaParser {
 
   bool EnqueueSample(bool* err);
 
+  // Emits the current sample of |runs_|, whose data is at |media_data|. The
+  // sample references |run_data| if it is set, or the data in |queue_|
+  // otherwise.
+  bool EmitSample(const uint8_t* media_data,
+                  const std::shared_ptr<const uint8_t>& run_data);
+  // Decrypts |stream_sample| on a worker thread, then emits it once the
+  // samples before it are emitted.
+  bool DecryptSampleOnWorkerThread(
+      std::unique_ptr<DecryptConfig> decrypt_config,
+      std::shared_ptr<const uint8_t> encrypted_data,
+      std::shared_ptr<MediaSample> stream_sample,
+      uint8_t* decrypted_data);
+  // Emits the samples decrypted on worker threads in order, until at most
+  // |max_pending_samples| are left.
+  bool DispatchPendingSamples(size_t max_pending_samples);
+  // Waits for the samples being decrypted and drops them.
+  void DropPendingSamples();
+
   void Reset();
 
   State state_;
@@ -90,6 +177,13 @@ class MP4MediaParser : public MediaParser {
   NewMediaSampleCB new_sample_cb_;
   KeySource* decryption_key_source_;
   std::unique_ptr<DecryptorSource> decryptor_source_;
+  uint32_t num_decryption_threads_ = 0;
+  bool decrypt_samples_ = true;
+  // One decryptor source per sample decrypted concurrently, each caching the
+  // decryptors of the keys it has seen. Used in turn.
+  std::vector<std::unique_ptr<DecryptorSource>> sample_decryptor_sources_;
+  size_t next_sample_decryptor_source_ = 0;
+  std::deque<std::shared_ptr<PendingSample>> pending_samples_;
 
   OffsetByteQueue queue_;
 
@@ -106,6 +200,15 @@ class MP4MediaParser : public MediaParser {
   std::unique_ptr<Movie> moov_;
   std::unique_ptr<TrackRunIterator> runs_;
 
+  std::map<uint32_t, int64_t> timestamp_adjustments_;
+
+  // Only used after StartIndexedReading().
+  std::set<uint32_t> indexed_track_ids_;
+  ReadAtCB read_at_cb_;
+  // The decoding timestamp of the first sample to read, by track ID. Set by
+  // SeekIndexed().
+  std::map<uint32_t, int64_t> indexed_start_dts_;
+
   DISALLOW_COPY_AND_ASSIGN(MP4MediaParser);
 };
 
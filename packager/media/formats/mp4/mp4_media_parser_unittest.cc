@@ -211,6 +211,17 @@ TEST_F(MP4MediaParserTest, TrailingMoovAndAdditionalMdat) {
   EXPECT_EQ(201u, num_samples_);
 }
 
+TEST_F(MP4MediaParserTest, TrailingMoovLoadedFromMemory) {
+  InitializeParser(NULL);
+  std::vector<uint8_t> buffer =
+      ReadTestDataFile("bear-640x360-trailing-moov-additional-mdat.mp4");
+  ASSERT_FALSE(buffer.empty());
+  ASSERT_TRUE(parser_->LoadMoov(buffer.data(), buffer.size()));
+  ASSERT_TRUE(AppendDataInPieces(buffer.data(), buffer.size(), 1024));
+  EXPECT_EQ(2u, num_streams_);
+  EXPECT_EQ(201u, num_samples_);
+}
+
 TEST_F(MP4MediaParserTest, Flush) {
   // Flush while reading sample data, then start a new stream.
   InitializeParser(NULL);
@@ -254,6 +265,39 @@ TEST_F(MP4MediaParserTest, NON_FRAGMENTED_MP4) {
   EXPECT_EQ(201u, num_samples_);
 }
 
+TEST_F(MP4MediaParserTest, IndexedReadingOfSelectedTracks) {
+  InitializeParser(NULL);
+  std::vector<uint8_t> buffer = ReadTestDataFile("bear-640x360.mp4");
+  ASSERT_FALSE(buffer.empty());
+
+  // Append until the index has been parsed.
+  const size_t kPieceSize = 512;
+  size_t position = 0;
+  while (!parser_->IsFullyIndexed() && position < buffer.size()) {
+    const size_t size = std::min(kPieceSize, buffer.size() - position);
+    ASSERT_TRUE(AppendData(buffer.data() + position, size));
+    position += size;
+  }
+  ASSERT_TRUE(parser_->IsFullyIndexed());
+  EXPECT_EQ(2u, num_streams_);
+
+  // Only read the samples of the video track.
+  const uint32_t kVideoTrackId = 1;
+  num_samples_ = 0;
+  parser_->StartIndexedReading(
+      {kVideoTrackId},
+      [&buffer](uint64_t position, uint8_t* data, uint64_t size) {
+        if (position + size > buffer.size())
+          return false;
+        memcpy(data, buffer.data() + position, size);
+        return true;
+      });
+  bool end_of_stream = false;
+  while (!end_of_stream)
+    ASSERT_TRUE(parser_->ParseIndexedRun(&end_of_stream));
+  EXPECT_EQ(82u, num_samples_);
+}
+
 TEST_F(MP4MediaParserTest, CencWithoutDecryptionSource) {
   ASSERT_TRUE(ParseMP4File("bear-640x360-v_frag-cenc-aux.mp4", 512));
   EXPECT_EQ(1u, num_streams_);
@@ -318,6 +362,58 @@ TEST_F(MP4MediaParserTest, CencWithDecryptionSourceAndSenc) {
   EXPECT_EQ(82u, num_samples_);
 }
 
+TEST_F(MP4MediaParserTest, CencDecryptedOnWorkerThreads) {
+  MockKeySource mock_key_source;
+  EXPECT_CALL(mock_key_source, FetchKeys(_, _))
+      .WillRepeatedly(Return(Status::OK));
+
+  EncryptionKey encryption_key;
+  encryption_key.key.assign(kKey, kKey + strlen(kKey));
+  // Each worker slot looks up the key once.
+  EXPECT_CALL(mock_key_source,
+              GetKey(std::vector<uint8_t>(kKeyId, kKeyId + strlen(kKeyId)), _))
+      .WillRepeatedly(
+          DoAll(SetArgPointee<1>(encryption_key), Return(Status::OK)));
+
+  std::vector<uint8_t> buffer =
+      ReadTestDataFile("bear-640x360-v_frag-cenc-senc.mp4");
+  ASSERT_FALSE(buffer.empty());
+
+  auto parse = [&](uint32_t num_decryption_threads,
+                   std::vector<std::shared_ptr<MediaSample>>* samples) {
+    MP4MediaParser parser;
+    parser.set_num_decryption_threads(num_decryption_threads);
+    parser.Init(
+        [](const std::vector<std::shared_ptr<StreamInfo>>&) {},
+        [samples](uint32_t, std::shared_ptr<MediaSample> sample) {
+          samples->push_back(std::move(sample));
+          return true;
+        },
+        [](uint32_t, std::shared_ptr<TextSample>) { return false; },
+        &mock_key_source);
+    return parser.Parse(buffer.data(), static_cast<int>(buffer.size())) &&
+           parser.Flush();
+  };
+
+  std::vector<std::shared_ptr<MediaSample>> expected_samples;
+  ASSERT_TRUE(parse(0, &expected_samples));
+  std::vector<std::shared_ptr<MediaSample>> samples;
+  ASSERT_TRUE(parse(4, &samples));
+
+  ASSERT_EQ(82u, samples.size());
+  ASSERT_EQ(expected_samples.size(), samples.size());
+  for (size_t i = 0; i < samples.size(); ++i) {
+    EXPECT_EQ(expected_samples[i]->dts(), samples[i]->dts());
+    EXPECT_FALSE(samples[i]->is_encrypted());
+    EXPECT_EQ(std::vector<uint8_t>(expected_samples[i]->data(),
+                                   expected_samples[i]->data() +
+                                       expected_samples[i]->data_size()),
+              std::vector<uint8_t>(samples[i]->data(),
+                                   samples[i]->data() +
+                                       samples[i]->data_size()));
+  }
+}
+
 TEST_F(MP4MediaParserTest, NonInterleavedFMP4) {
   // Test small, non-interleaved fragment MP4 with one track per fragment.
   EXPECT_TRUE(ParseMP4File("BigBuckBunny_10s.ismv", 512));
@@ -14,6 +14,7 @@
 #include <absl/strings/numbers.h>
 
 #include <packager/file.h>
+#include <packager/macros/compiler.h>
 #include <packager/macros/logging.h>
 #include <packager/macros/status.h>
 #include <packager/media/base/aes_encryptor.h>
@@ -206,6 +207,14 @@ Status MP4Muxer::AddMediaSample(size_t stream_id, const MediaSample& sample) {
   return segmenter_->AddSample(stream_id, sample);
 }
 
+Status MP4Muxer::AddCueEvent(size_t stream_id, const CueEvent& cue_event) {
+  UNUSED(stream_id);
+  // There is no media segment before the first sample.
+  if (segmenter_)
+    segmenter_->AddCueEvent(cue_event);
+  return Status::OK;
+}
+
 Status MP4Muxer::FinalizeSegment(size_t stream_id,
                                  const SegmentInfo& segment_info) {
   DCHECK(segmenter_);
@@ -216,12 +225,7 @@ Status MP4Muxer::FinalizeSegment(size_t stream_id,
   return segmenter_->FinalizeSegment(stream_id, segment_info);
 }
 
-Status MP4Muxer::DelayInitializeMuxer() {
-  DCHECK(!streams().empty());
-
-  std::unique_ptr<FileType> ftyp(new FileType);
-  std::unique_ptr<Movie> moov(new Movie);
-
+void MP4Muxer::GenerateFileType(FileType* ftyp) {
   ftyp->major_brand = FOURCC_mp41;
   ftyp->compatible_brands.push_back(FOURCC_iso8);
   ftyp->compatible_brands.push_back(FOURCC_isom);
@@ -270,21 +274,50 @@ Status MP4Muxer::DelayInitializeMuxer() {
         ftyp->compatible_brands.push_back(FOURCC_iamf);
     }
   }
+}
 
-  moov->header.creation_time = IsoTimeNow();
-  moov->header.modification_time = IsoTimeNow();
-  moov->header.next_track_id = static_cast<uint32_t>(streams().size()) + 1;
+Status MP4Muxer::DelayInitializeMuxer() {
+  DCHECK(!streams().empty());
 
-  moov->tracks.resize(streams().size());
-  moov->extends.tracks.resize(streams().size());
+  // The boxes are generated again for the streams which changed since the
+  // last initialization only, e.g. at a period change, as generating the
+  // sample descriptions is costly.
+  const bool same_streams_size =
+      generated_moov_ && generated_streams_.size() == streams().size();
+  auto stream_changed = [this](size_t i) {
+    return i >= generated_streams_.size() ||
+           generated_streams_[i] != streams()[i];
+  };
+  if (!same_streams_size || stream_changed(0)) {
+    generated_ftyp_.reset(new FileType);
+    GenerateFileType(generated_ftyp_.get());
+  }
+  if (!generated_moov_)
+    generated_moov_.reset(new Movie);
+  Movie* generated_moov = generated_moov_.get();
+
+  if (creation_time_ == 0)
+    creation_time_ = IsoTimeNow();
+  generated_moov->header.creation_time = creation_time_;
+  generated_moov->header.modification_time = creation_time_;
+  generated_moov->header.next_track_id =
+      static_cast<uint32_t>(streams().size()) + 1;
+
+  generated_moov->tracks.resize(streams().size());
+  generated_moov->extends.tracks.resize(streams().size());
 
   // Initialize tracks.
   for (uint32_t i = 0; i < streams().size(); ++i) {
+    if (same_streams_size && !stream_changed(i))
+      continue;
+
     const StreamInfo* stream = streams()[i].get();
-    Track& trak = moov->tracks[i];
+    Track& trak = generated_moov->tracks[i];
+    trak = Track();
     trak.header.track_id = i + 1;
 
-    TrackExtends& trex = moov->extends.tracks[i];
+    TrackExtends& trex = generated_moov->extends.tracks[i];
+    trex = TrackExtends();
     trex.track_id = trak.header.track_id;
     trex.default_sample_description_index = 1;
 
@@ -306,8 +339,11 @@ Status MP4Muxer::DelayInitializeMuxer() {
         NOTIMPLEMENTED() << "Not implemented for stream type: "
                          << stream->stream_type();
     }
-    if (!generate_trak_result)
+    if (!generate_trak_result) {
+      generated_moov_.reset();
+      generated_streams_.clear();
       return Status(error::MUXER_FAILURE, "Failed to generate trak.");
+    }
 
     // Generate EditList if needed. See UpdateEditListOffsetFromSample() for
     // more information.
@@ -317,19 +353,30 @@ Status MP4Muxer::DelayInitializeMuxer() {
       entry.media_rate_integer = 1;
       trak.edit.list.edits.push_back(entry);
     }
+  }
 
-    if (stream->is_encrypted() && options().mp4_params.include_pssh_in_stream) {
-      moov->pssh.clear();
-      const auto& key_system_info = stream->encryption_config().key_system_info;
-      for (const ProtectionSystemSpecificInfo& system : key_system_info) {
-        if (system.psshs.empty())
-          continue;
-        ProtectionSystemSpecificHeader pssh;
-        pssh.raw_box = system.psshs;
-        moov->pssh.push_back(pssh);
-      }
+  // The pssh boxes are those of the last encrypted stream.
+  generated_moov->pssh.clear();
+  for (const auto& stream : streams()) {
+    if (!stream->is_encrypted() ||
+        !options().mp4_params.include_pssh_in_stream) {
+      continue;
+    }
+    generated_moov->pssh.clear();
+    const auto& key_system_info = stream->encryption_config().key_system_info;
+    for (const ProtectionSystemSpecificInfo& system : key_system_info) {
+      if (system.psshs.empty())
+        continue;
+      ProtectionSystemSpecificHeader pssh;
+      pssh.raw_box = system.psshs;
+      generated_moov->pssh.push_back(pssh);
     }
   }
+  generated_streams_ = streams();
+
+  // The segmenter updates its boxes, so it gets copies of them.
+  std::unique_ptr<FileType> ftyp(new FileType(*generated_ftyp_));
+  std::unique_ptr<Movie> moov(new Movie(*generated_moov_));
 
   if (options().segment_template.empty()) {
     segmenter_.reset(new SingleSegmentSegmenter(options(), std::move(ftyp),
@@ -342,6 +389,9 @@ Status MP4Muxer::DelayInitializeMuxer() {
         new MultiSegmentSegmenter(options(), std::move(ftyp), std::move(moov)));
   }
 
+  segmenter_->set_clock(clock());
+  segmenter_->set_written_init_segment(&written_init_segment_);
+
   const Status segmenter_initialized =
       segmenter_->Initialize(streams(), muxer_listener(), progress_listener());
   if (!segmenter_initialized.ok())
@@ -413,12 +463,11 @@ Status MP4Muxer::UpdateEditListOffsetFromSample(const MediaSample& sample) {
 }
 
 void MP4Muxer::InitializeTrak(const StreamInfo* info, Track* trak) {
-  int64_t now = IsoTimeNow();
-  trak->header.creation_time = now;
-  trak->header.modification_time = now;
+  trak->header.creation_time = creation_time_;
+  trak->header.modification_time = creation_time_;
   trak->header.duration = 0;
-  trak->media.header.creation_time = now;
-  trak->media.header.modification_time = now;
+  trak->media.header.creation_time = creation_time_;
+  trak->media.header.modification_time = creation_time_;
   trak->media.header.timescale = info->time_scale();
   trak->media.header.duration = 0;
   if (!info->language().empty()) {
@@ -7,11 +7,13 @@
 #ifndef PACKAGER_MEDIA_FORMATS_MP4_MP4_MUXER_H_
 #define PACKAGER_MEDIA_FORMATS_MP4_MP4_MUXER_H_
 
+#include <memory>
 #include <optional>
 #include <vector>
 
 #include <packager/macros/classes.h>
 #include <packager/media/base/muxer.h>
+#include <packager/media/formats/mp4/segmenter.h>
 
 namespace shaka {
 namespace media {
@@ -23,8 +25,6 @@ class VideoStreamInfo;
 
 namespace mp4 {
 
-class Segmenter;
-
 struct ProtectionSchemeInfo;
 struct Track;
 
@@ -41,10 +41,12 @@ class MP4Muxer : public Muxer {
   Status InitializeMuxer() override;
   Status Finalize() override;
   Status AddMediaSample(size_t stream_id, const MediaSample& sample) override;
+  Status AddCueEvent(size_t stream_id, const CueEvent& cue_event) override;
   Status FinalizeSegment(size_t stream_id,
                          const SegmentInfo& segment_info) override;
 
   Status DelayInitializeMuxer();
+  void GenerateFileType(FileType* ftyp);
   Status UpdateEditListOffsetFromSample(const MediaSample& sample);
 
   // Generate Audio/Video Track box.
@@ -73,6 +75,17 @@ class MP4Muxer : public Muxer {
   std::optional<int64_t> edit_list_offset_;
 
   std::unique_ptr<Segmenter> segmenter_;
+  // The boxes generated for |generated_streams_| by the last initialization,
+  // which the next ones copy, so that only the tracks of the streams which
+  // changed are generated again.
+  std::vector<std::shared_ptr<const StreamInfo>> generated_streams_;
+  std::unique_ptr<FileType> generated_ftyp_;
+  std::unique_ptr<Movie> generated_moov_;
+  // The init segment last written by a segmenter of this muxer.
+  WrittenInitSegment written_init_segment_;
+  // The creation time of the boxes, which is kept when the muxer is
+  // reinitialized, not to change an init segment which is otherwise the same.
+  uint64_t creation_time_ = 0;
 
   DISALLOW_COPY_AND_ASSIGN(MP4Muxer);
 };
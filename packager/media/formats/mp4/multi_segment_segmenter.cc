@@ -7,8 +7,11 @@
 #include <packager/media/formats/mp4/multi_segment_segmenter.h>
 
 #include <algorithm>
+#include <cstring>
 
 #include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <absl/strings/match.h>
 #include <absl/strings/numbers.h>
 #include <absl/strings/str_format.h>
 
@@ -26,12 +29,26 @@
 namespace shaka {
 namespace media {
 namespace mp4 {
+namespace {
+
+// Parses |file_name| if it is the name of a callback file.
+bool ParseCallbackFileName(const std::string& file_name,
+                           const BufferCallbackParams** callback_params,
+                           std::string* name) {
+  if (!absl::StartsWith(file_name, kCallbackFilePrefix))
+    return false;
+  return File::ParseCallbackFileName(
+      file_name.substr(strlen(kCallbackFilePrefix)), callback_params, name);
+}
+
+}  // namespace
 
 MultiSegmentSegmenter::MultiSegmentSegmenter(const MuxerOptions& options,
                                              std::unique_ptr<FileType> ftyp,
                                              std::unique_ptr<Movie> moov)
     : Segmenter(options, std::move(ftyp), std::move(moov)),
-      styp_(new SegmentType) {
+      styp_(new SegmentType),
+      bundle_segments_(BundlesMp4Segments(options)) {
   // Use the same brands for styp as ftyp.
   styp_->major_brand = Segmenter::ftyp()->major_brand;
   styp_->compatible_brands = Segmenter::ftyp()->compatible_brands;
@@ -40,7 +57,9 @@ MultiSegmentSegmenter::MultiSegmentSegmenter(const MuxerOptions& options,
                FOURCC_cmfc, FOURCC_cmfs);
 }
 
-MultiSegmentSegmenter::~MultiSegmentSegmenter() {}
+MultiSegmentSegmenter::~MultiSegmentSegmenter() {
+  DiscardNextSegment();
+}
 
 bool MultiSegmentSegmenter::GetInitRange(size_t* offset, size_t* size) {
   VLOG(1) << "MultiSegmentSegmenter outputs init segment: "
@@ -63,6 +82,10 @@ Status MultiSegmentSegmenter::DoInitialize() {
 }
 
 Status MultiSegmentSegmenter::DoFinalize() {
+  // There is no next segment.
+  DiscardNextSegment();
+  RETURN_IF_ERROR(NotifyUploadedSegments(0));
+  RETURN_IF_ERROR(CloseBundle());
   // Update init segment with media duration set.
   RETURN_IF_ERROR(WriteInitSegment());
   SetComplete();
@@ -73,20 +96,11 @@ Status MultiSegmentSegmenter::DoFinalizeSegment(int64_t segment_number) {
   return WriteSegment(segment_number);
 }
 
-Status MultiSegmentSegmenter::WriteInitSegment() {
-  DCHECK(ftyp());
-  DCHECK(moov());
-  // Generate the output file with init segment.
-  std::unique_ptr<File, FileCloser> file(
-      File::Open(options().output_file_name.c_str(), "w"));
-  if (!file) {
-    return Status(error::FILE_FAILURE,
-                  "Cannot open file for write " + options().output_file_name);
-  }
-  std::unique_ptr<BufferWriter> buffer(new BufferWriter);
-  ftyp()->Write(buffer.get());
-  moov()->Write(buffer.get());
-  return buffer->WriteToFile(file.get());
+Status MultiSegmentSegmenter::DoAddSample() {
+  if (pending_segments_.empty())
+    return Status::OK;
+  return NotifyUploadedSegments(
+      static_cast<size_t>(options().mp4_params.max_pending_segment_uploads));
 }
 
 Status MultiSegmentSegmenter::WriteSegment(int64_t segment_number) {
@@ -100,38 +114,103 @@ Status MultiSegmentSegmenter::WriteSegment(int64_t segment_number) {
   sidx()->earliest_presentation_time =
       sidx()->references[0].earliest_presentation_time;
 
-  std::unique_ptr<BufferWriter> buffer(new BufferWriter());
+  BufferWriter* buffer = segment_header_buffer();
+  buffer->Clear();
   std::unique_ptr<File, FileCloser> file;
   std::string file_name;
+  // Set if the segment is handed whole to the segment write function.
+  const BufferCallbackParams* callback_params = nullptr;
+  BufferCallbackParams::SegmentInfo segment_info;
+  // Set if the segment is written in the background.
+  bool upload_async = false;
   if (options().segment_template.empty()) {
     // Append the segment to output file if segment template is not specified.
     file_name = options().output_file_name.c_str();
-    file.reset(File::Open(file_name.c_str(), "a"));
+    file.reset(File::OpenWithNoBuffering(file_name.c_str(), "a"));
     if (!file) {
       return Status(error::FILE_FAILURE, "Cannot open file for append " +
                                              options().output_file_name);
     }
   } else {
-    file_name = GetSegmentName(options().segment_template,
-                               sidx()->earliest_presentation_time,
-                               segment_number, options().bandwidth);
-    file.reset(File::Open(file_name.c_str(), "w"));
-    if (!file) {
-      return Status(error::FILE_FAILURE,
-                    "Cannot open file for write " + file_name);
+    file_name = segment_template().GetSegmentName(
+        sidx()->earliest_presentation_time, segment_number,
+        options().bandwidth);
+    if (bundle_segments_) {
+      if (!bundle_file_) {
+        // The bundle is named after its first segment.
+        bundle_file_name_ = file_name;
+        bundle_file_.reset(File::OpenWithNoBuffering(file_name.c_str(), "w"));
+        if (!bundle_file_) {
+          return Status(error::FILE_FAILURE,
+                        "Cannot open file for write " + file_name);
+        }
+      }
+      file_name = bundle_file_name_;
+    } else if (!ParseCallbackFileName(file_name, &callback_params,
+                                      &segment_info.name) ||
+               !callback_params->segment_write_func) {
+      callback_params = nullptr;
+      if (options().mp4_params.async_segment_uploads) {
+        upload_async = true;
+      } else if (next_segment_file_ && next_segment_file_name_ == file_name) {
+        file = std::move(next_segment_file_);
+      } else {
+        DiscardNextSegment();
+        file.reset(File::OpenWithNoBuffering(file_name.c_str(), "w"));
+      }
+      if (!file && !upload_async) {
+        return Status(error::FILE_FAILURE,
+                      "Cannot open file for write " + file_name);
+      }
     }
-    styp_->Write(buffer.get());
+    styp_->Write(buffer);
   }
 
-  if (options().mp4_params.generate_sidx_in_media_segments)
-    sidx()->Write(buffer.get());
+  BufferWriter event_boxes;
+  WriteEventBoxes(&event_boxes);
+  if (options().mp4_params.generate_sidx_in_media_segments) {
+    // The event boxes are between the sidx and the first fragment.
+    sidx()->first_offset = event_boxes.Size();
+    sidx()->Write(buffer);
+  }
+  buffer->AppendBuffer(event_boxes);
 
   const size_t segment_header_size = buffer->Size();
   const size_t segment_size = segment_header_size + fragment_buffer()->Size();
   DCHECK_NE(segment_size, 0u);
 
-  RETURN_IF_ERROR(buffer->WriteToFile(file.get()));
-  if (muxer_listener()) {
+  int64_t segment_duration = 0;
+  // ISO/IEC 23009-1:2012: the value shall be identical to sum of the the
+  // values of all Subsegment_duration fields in the first ‘sidx’ box.
+  for (size_t i = 0; i < sidx()->references.size(); ++i)
+    segment_duration += sidx()->references[i].subsegment_duration;
+
+  if (upload_async) {
+    // The muxer carries on with the next segment while the segment is
+    // written. The listeners are notified once it is written.
+    std::vector<uint8_t> data;
+    fragment_buffer()->SwapBuffer(&data);
+    data.insert(data.begin(), buffer->Buffer(),
+                buffer->Buffer() + buffer->Size());
+    buffer->Clear();
+
+    PendingSegment segment;
+    segment.upload =
+        FileUploader::GetInstance()->Write(file_name, std::move(data));
+    segment.file_name = file_name;
+    segment.start_time = sidx()->earliest_presentation_time;
+    segment.duration = segment_duration;
+    segment.size = segment_size;
+    segment.segment_number = segment_number;
+    segment.key_frames = key_frame_infos();
+    for (KeyFrameInfo& key_frame_info : segment.key_frames)
+      key_frame_info.start_byte_offset += segment_header_size;
+    pending_segments_.push_back(std::move(segment));
+    return NotifyUploadedSegments(
+        static_cast<size_t>(options().mp4_params.max_pending_segment_uploads));
+  }
+
+  if (muxer_listener() && !bundle_segments_) {
     for (const KeyFrameInfo& key_frame_info : key_frame_infos()) {
       muxer_listener()->OnKeyFrame(
           key_frame_info.timestamp,
@@ -139,22 +218,78 @@ Status MultiSegmentSegmenter::WriteSegment(int64_t segment_number) {
           key_frame_info.size);
     }
   }
-  RETURN_IF_ERROR(fragment_buffer()->WriteToFile(file.get()));
-
-  // Close the file, which also does flushing, to make sure the file is written
-  // before manifest is updated.
-  if (!file.release()->Close()) {
-    return Status(
-        error::FILE_FAILURE,
-        "Cannot close file " + file_name +
-            ", possibly file permission issue or running out of disk space.");
-  }
 
-  int64_t segment_duration = 0;
-  // ISO/IEC 23009-1:2012: the value shall be identical to sum of the the
-  // values of all Subsegment_duration fields in the first ‘sidx’ box.
-  for (size_t i = 0; i < sidx()->references.size(); ++i)
-    segment_duration += sidx()->references[i].subsegment_duration;
+  if (callback_params) {
+    // The fragments are handed over rather than copied, behind the header.
+    std::vector<uint8_t> data;
+    fragment_buffer()->SwapBuffer(&data);
+    data.insert(data.begin(), buffer->Buffer(),
+                buffer->Buffer() + buffer->Size());
+    buffer->Clear();
+
+    const BufferCallbackParams* output_callback_params = nullptr;
+    if (!ParseCallbackFileName(options().output_file_name,
+                               &output_callback_params,
+                               &segment_info.stream_name)) {
+      segment_info.stream_name = options().output_file_name;
+    }
+    segment_info.segment_number = segment_number;
+    segment_info.start_time = sidx()->earliest_presentation_time;
+    segment_info.duration = segment_duration;
+    segment_info.timescale = sidx()->timescale;
+    if (!callback_params->segment_write_func(segment_info, std::move(data))) {
+      return Status(error::FILE_FAILURE,
+                    "Cannot write segment " + segment_info.name);
+    }
+  } else {
+    // The header and the fragments are written together, without
+    // concatenating them first.
+    File* output = bundle_segments_ ? bundle_file_.get() : file.get();
+    const File::IoBuffer buffers[] = {
+        {buffer->Buffer(), buffer->Size()},
+        {fragment_buffer()->Buffer(), fragment_buffer()->Size()}};
+    if (output->WriteV(buffers, 2) != static_cast<int64_t>(segment_size)) {
+      return Status(error::FILE_FAILURE,
+                    "Cannot write segment to file " + file_name);
+    }
+    buffer->Clear();
+    fragment_buffer()->Clear();
+
+    if (bundle_segments_) {
+      PendingSegment segment;
+      segment.file_name = file_name;
+      segment.start_time = sidx()->earliest_presentation_time;
+      segment.duration = segment_duration;
+      segment.start_byte_offset = bundle_size_;
+      segment.size = segment_size;
+      segment.segment_number = segment_number;
+      segment.key_frames = key_frame_infos();
+      for (KeyFrameInfo& key_frame_info : segment.key_frames) {
+        key_frame_info.start_byte_offset +=
+            bundle_size_ + segment_header_size;
+      }
+      bundled_segments_.push_back(std::move(segment));
+      bundle_size_ += segment_size;
+      bundle_duration_ += segment_duration;
+      if (bundle_duration_ <
+          options().mp4_params.segment_bundle_duration_in_seconds *
+              sidx()->timescale) {
+        return Status::OK;
+      }
+      return CloseBundle();
+    }
+
+    // Close the file, which also does flushing, to make sure the file is
+    // written before manifest is updated.
+    if (!file.release()->Close()) {
+      return Status(error::FILE_FAILURE,
+                    "Cannot close file " + file_name +
+                        ", possibly file permission issue or running out of "
+                        "disk space.");
+    }
+    if (!options().segment_template.empty())
+      PreopenNextSegment(segment_number);
+  }
 
   UpdateProgress(segment_duration);
   if (muxer_listener()) {
@@ -167,6 +302,83 @@ Status MultiSegmentSegmenter::WriteSegment(int64_t segment_number) {
   return Status::OK;
 }
 
+Status MultiSegmentSegmenter::NotifyUploadedSegments(size_t max_pending) {
+  while (!pending_segments_.empty() &&
+         (pending_segments_.size() > max_pending ||
+          pending_segments_.front().upload->done())) {
+    const PendingSegment& segment = pending_segments_.front();
+    RETURN_IF_ERROR(segment.upload->Wait());
+    NotifySegment(segment, false);
+    pending_segments_.pop_front();
+  }
+  return Status::OK;
+}
+
+Status MultiSegmentSegmenter::CloseBundle() {
+  if (!bundle_file_)
+    return Status::OK;
+  if (!bundle_file_.release()->Close()) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot close file " + bundle_file_name_ +
+                      ", possibly file permission issue or running out of "
+                      "disk space.");
+  }
+  for (const PendingSegment& segment : bundled_segments_)
+    NotifySegment(segment, true);
+  bundled_segments_.clear();
+  bundle_size_ = 0;
+  bundle_duration_ = 0;
+  return Status::OK;
+}
+
+void MultiSegmentSegmenter::NotifySegment(const PendingSegment& segment,
+                                          bool bundled) {
+  UpdateProgress(segment.duration);
+  if (!muxer_listener())
+    return;
+  for (const KeyFrameInfo& key_frame_info : segment.key_frames) {
+    muxer_listener()->OnKeyFrame(key_frame_info.timestamp,
+                                 key_frame_info.start_byte_offset,
+                                 key_frame_info.size);
+  }
+  muxer_listener()->OnSampleDurationReady(sample_duration());
+  if (bundled) {
+    muxer_listener()->OnNewBundledSegment(
+        segment.file_name, segment.start_time, segment.duration,
+        segment.start_byte_offset, segment.size, segment.segment_number);
+  } else {
+    muxer_listener()->OnNewSegment(segment.file_name, segment.start_time,
+                                   segment.duration, segment.size,
+                                   segment.segment_number);
+  }
+}
+
+void MultiSegmentSegmenter::PreopenNextSegment(int64_t segment_number) {
+  // The time of the next segment is only known once it is complete.
+  if (!options().mp4_params.preopen_next_segment ||
+      absl::StrContains(options().segment_template, "$Time")) {
+    return;
+  }
+  next_segment_file_name_ = segment_template().GetSegmentName(
+      0, segment_number + 1, options().bandwidth);
+  next_segment_file_.reset(
+      File::OpenWithNoBuffering(next_segment_file_name_.c_str(), "w"));
+  // The file is opened again when the segment is written.
+  LOG_IF(WARNING, !next_segment_file_)
+      << "Cannot open file for write ahead of the segment "
+      << next_segment_file_name_;
+}
+
+void MultiSegmentSegmenter::DiscardNextSegment() {
+  if (!next_segment_file_)
+    return;
+  next_segment_file_.reset();
+  if (!File::Delete(next_segment_file_name_.c_str())) {
+    LOG(WARNING) << "Cannot delete the unused segment file "
+                 << next_segment_file_name_;
+  }
+}
+
 }  // namespace mp4
 }  // namespace media
 }  // namespace shaka
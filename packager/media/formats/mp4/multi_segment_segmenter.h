@@ -7,7 +7,17 @@
 #ifndef PACKAGER_MEDIA_FORMATS_MP4_MULTI_SEGMENT_SEGMENTER_H_
 #define PACKAGER_MEDIA_FORMATS_MP4_MULTI_SEGMENT_SEGMENTER_H_
 
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <packager/file.h>
+#include <packager/file/file_closer.h>
+#include <packager/file/file_uploader.h>
 #include <packager/macros/classes.h>
+#include <packager/media/formats/mp4/key_frame_info.h>
 #include <packager/media/formats/mp4/segmenter.h>
 
 namespace shaka {
@@ -40,12 +50,57 @@ class MultiSegmentSegmenter : public Segmenter {
   Status DoInitialize() override;
   Status DoFinalize() override;
   Status DoFinalizeSegment(int64_t segment_number) override;
+  Status DoAddSample() override;
 
   // Write segment to file.
-  Status WriteInitSegment();
   Status WriteSegment(int64_t segment_number);
 
+  // Opens the file of the segment after |segment_number| if enabled.
+  void PreopenNextSegment(int64_t segment_number);
+  // Closes and deletes the file opened for the next segment, if any.
+  void DiscardNextSegment();
+
+  // Notifies the listeners of the segments written in the background, in
+  // order, waiting for the oldest ones while more than |max_pending| are
+  // being written.
+  Status NotifyUploadedSegments(size_t max_pending);
+
+  // Closes the bundle being written, if any, and notifies the listeners of
+  // its segments.
+  Status CloseBundle();
+
+  // A segment being written in the background, or appended to a bundle.
+  struct PendingSegment {
+    std::shared_ptr<FileUploader::Upload> upload;
+    // The name of the bundle, if bundled.
+    std::string file_name;
+    int64_t start_time = 0;
+    int64_t duration = 0;
+    // In the bundle, if bundled.
+    uint64_t start_byte_offset = 0;
+    uint64_t size = 0;
+    int64_t segment_number = 0;
+    // With the offsets in the file.
+    std::vector<KeyFrameInfo> key_frames;
+  };
+
+  // Notifies the listeners of a segment which is written.
+  void NotifySegment(const PendingSegment& segment, bool bundled);
+
   std::unique_ptr<SegmentType> styp_;
+  // The file of the next segment, opened ahead of the segment.
+  std::unique_ptr<File, FileCloser> next_segment_file_;
+  std::string next_segment_file_name_;
+  std::deque<PendingSegment> pending_segments_;
+
+  const bool bundle_segments_;
+  // The bundle being written, named after its first segment.
+  std::unique_ptr<File, FileCloser> bundle_file_;
+  std::string bundle_file_name_;
+  uint64_t bundle_size_ = 0;
+  int64_t bundle_duration_ = 0;
+  // The segments in |bundle_file_|, which are notified once it is closed.
+  std::vector<PendingSegment> bundled_segments_;
 
   DISALLOW_COPY_AND_ASSIGN(MultiSegmentSegmenter);
 };
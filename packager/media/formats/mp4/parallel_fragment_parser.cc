@@ -0,0 +1,289 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/formats/mp4/parallel_fragment_parser.h>
+
+#include <algorithm>
+#include <functional>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <absl/synchronization/notification.h>
+
+#include <packager/file.h>
+#include <packager/file/file_closer.h>
+#include <packager/file/thread_pool.h>
+#include <packager/macros/logging.h>
+#include <packager/media/base/media_sample.h>
+#include <packager/media/base/text_sample.h>
+#include <packager/media/formats/mp4/box_definitions.h>
+#include <packager/media/formats/mp4/box_reader.h>
+#include <packager/media/formats/mp4/mp4_media_parser.h>
+#include <packager/media/formats/mp4/track_run_iterator.h>
+
+namespace shaka {
+namespace media {
+namespace mp4 {
+namespace {
+
+bool ReadFully(File* file, uint8_t* buffer, uint64_t size) {
+  while (size > 0) {
+    const int64_t bytes_read = file->Read(buffer, size);
+    if (bytes_read <= 0)
+      return false;
+    buffer += bytes_read;
+    size -= bytes_read;
+  }
+  return true;
+}
+
+bool ReadAt(File* file, uint64_t position, uint8_t* buffer, uint64_t size) {
+  return file->Seek(position) && ReadFully(file, buffer, size);
+}
+
+// Reads the box of |size| bytes at |position| and parses it into |box|.
+bool ReadBox(File* file, uint64_t position, uint64_t size, Box* box) {
+  std::vector<uint8_t> data(size);
+  if (!ReadAt(file, position, data.data(), size))
+    return false;
+  bool err = false;
+  std::unique_ptr<BoxReader> reader(
+      BoxReader::ReadBox(data.data(), data.size(), &err));
+  return reader && box->Parse(reader.get());
+}
+
+// A fragment can be parsed without the fragments before it if the decode time
+// of each track fragment is explicit and its data offsets are relative to the
+// fragment.
+bool IsSelfContained(const MovieFragment& moof) {
+  for (const TrackFragment& traf : moof.tracks) {
+    if (traf.decode_time_absent ||
+        (traf.header.flags & TrackFragmentHeader::kBaseDataOffsetPresentMask)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Parser::Parse() takes the size as an int.
+const uint64_t kMaxParseSize = 1 << 30;
+
+bool ParseAll(MP4MediaParser* parser, const uint8_t* data, uint64_t size) {
+  while (size > 0) {
+    const uint64_t parse_size = std::min(size, kMaxParseSize);
+    if (!parser->Parse(data, static_cast<int>(parse_size)))
+      return false;
+    data += parse_size;
+    size -= parse_size;
+  }
+  return true;
+}
+
+}  // namespace
+
+struct ParallelFragmentParser::Range {
+  struct Sample {
+    uint32_t track_id;
+    std::shared_ptr<MediaSample> media_sample;
+    std::shared_ptr<TextSample> text_sample;
+  };
+
+  uint64_t start = 0;
+  uint64_t size = 0;
+  std::vector<Sample> samples;
+  bool ok = false;
+  // Notified when |samples| and |ok| are set.
+  absl::Notification done;
+};
+
+ParallelFragmentParser::ParallelFragmentParser(const std::string& file_name,
+                                               uint32_t num_threads,
+                                               uint64_t min_range_size)
+    : file_name_(file_name),
+      num_threads_(num_threads),
+      min_range_size_(min_range_size) {
+  DCHECK_GT(num_threads_, 0u);
+}
+
+ParallelFragmentParser::~ParallelFragmentParser() {
+  WaitForPendingRanges();
+}
+
+bool ParallelFragmentParser::Initialize() {
+  std::unique_ptr<File, FileCloser> file(
+      File::OpenWithNoBuffering(file_name_.c_str(), "r"));
+  if (!file)
+    return false;
+  const int64_t file_size = file->Size();
+  if (file_size <= 0)
+    return false;
+
+  std::vector<uint64_t> fragment_starts;
+  Movie moov;
+  bool moov_seen = false;
+  // Used to find the timestamp adjustments that sequential parsing would
+  // determine from the first fragments.
+  std::unique_ptr<TrackRunIterator> runs;
+  uint64_t position = 0;
+  while (position < static_cast<uint64_t>(file_size)) {
+    const uint32_t kBoxHeaderReadSize = 16;
+    uint8_t box_header[kBoxHeaderReadSize];
+    const uint64_t header_size = std::min<uint64_t>(
+        kBoxHeaderReadSize, static_cast<uint64_t>(file_size) - position);
+    if (!ReadAt(file.get(), position, box_header, header_size))
+      return false;
+    FourCC box_type;
+    uint64_t box_size;
+    bool err = false;
+    if (!BoxReader::StartBox(box_header, header_size, &box_type, &box_size,
+                             &err)) {
+      return false;
+    }
+
+    if (box_type == FOURCC_moof) {
+      if (!moov_seen)
+        return false;
+      MovieFragment moof;
+      if (!ReadBox(file.get(), position, box_size, &moof))
+        return false;
+      if (!IsSelfContained(moof)) {
+        VLOG(1) << "The fragments of '" << file_name_
+                << "' cannot be parsed independently.";
+        return false;
+      }
+      if (timestamp_adjustments_.size() < moov.tracks.size()) {
+        if (!runs->Init(moof))
+          return false;
+        timestamp_adjustments_ = runs->timestamp_adjustments();
+      }
+      fragment_starts.push_back(position);
+    } else if (fragment_starts.empty()) {
+      // Samples in the initial 'mdat' need the 'moov' sample tables.
+      if (box_type == FOURCC_mdat)
+        return false;
+      if (box_type == FOURCC_moov) {
+        if (moov_seen || !ReadBox(file.get(), position, box_size, &moov))
+          return false;
+        runs.reset(new TrackRunIterator(&moov));
+        if (!runs->Init())
+          return false;
+        moov_seen = true;
+      }
+    }
+    position += box_size;
+  }
+  if (fragment_starts.empty())
+    return false;
+
+  // Group consecutive fragments into ranges of at least |min_range_size_|
+  // bytes, except for the last one.
+  const uint64_t end = static_cast<uint64_t>(file_size);
+  uint64_t range_start = fragment_starts[0];
+  for (size_t i = 1; i <= fragment_starts.size(); ++i) {
+    const uint64_t range_end =
+        i < fragment_starts.size() ? fragment_starts[i] : end;
+    if (range_end - range_start < min_range_size_ && range_end != end)
+      continue;
+    std::shared_ptr<Range> range(new Range);
+    range->start = range_start;
+    range->size = range_end - range_start;
+    ranges_.push_back(range);
+    range_start = range_end;
+  }
+  if (ranges_.size() < 2)
+    return false;
+
+  header_.reset(new std::vector<uint8_t>(fragment_starts[0]));
+  if (!ReadAt(file.get(), 0, header_->data(), header_->size()))
+    return false;
+
+  VLOG(1) << "Parsing " << fragment_starts.size() << " fragments of '"
+          << file_name_ << "' in " << ranges_.size() << " ranges.";
+  return true;
+}
+
+bool ParallelFragmentParser::ParseNextRange(
+    const MediaParser::NewMediaSampleCB& new_media_sample_cb,
+    const MediaParser::NewTextSampleCB& new_text_sample_cb,
+    bool* end_of_stream) {
+  DCHECK(end_of_stream);
+  if (next_range_ == ranges_.size()) {
+    *end_of_stream = true;
+    return true;
+  }
+  *end_of_stream = false;
+
+  while (next_range_to_parse_ < ranges_.size() &&
+         next_range_to_parse_ < next_range_ + num_threads_) {
+    ThreadPool::instance.PostTask(
+        std::bind(&ParallelFragmentParser::ParseRange, file_name_, header_,
+                  timestamp_adjustments_, ranges_[next_range_to_parse_]));
+    ++next_range_to_parse_;
+  }
+
+  std::shared_ptr<Range> range = std::move(ranges_[next_range_]);
+  ++next_range_;
+  range->done.WaitForNotification();
+  if (!range->ok)
+    return false;
+  for (const Range::Sample& sample : range->samples) {
+    const bool result =
+        sample.media_sample
+            ? new_media_sample_cb(sample.track_id, sample.media_sample)
+            : new_text_sample_cb(sample.track_id, sample.text_sample);
+    if (!result)
+      return false;
+  }
+  return true;
+}
+
+// static
+void ParallelFragmentParser::ParseRange(
+    const std::string& file_name,
+    std::shared_ptr<const std::vector<uint8_t>> header,
+    const std::map<uint32_t, int64_t>& timestamp_adjustments,
+    std::shared_ptr<Range> range) {
+  std::unique_ptr<File, FileCloser> file(
+      File::OpenWithNoBuffering(file_name.c_str(), "r"));
+  std::vector<uint8_t> data(range->size);
+  if (!file || !ReadAt(file.get(), range->start, data.data(), data.size())) {
+    LOG(ERROR) << "Cannot read " << range->size << " bytes at "
+               << range->start << " of '" << file_name << "'.";
+    range->done.Notify();
+    return;
+  }
+
+  Range* const range_ptr = range.get();
+  MP4MediaParser parser;
+  parser.Init(
+      [](const std::vector<std::shared_ptr<StreamInfo>>&) {},
+      [range_ptr](uint32_t track_id, std::shared_ptr<MediaSample> sample) {
+        range_ptr->samples.push_back({track_id, std::move(sample), nullptr});
+        return true;
+      },
+      [range_ptr](uint32_t track_id, std::shared_ptr<TextSample> sample) {
+        range_ptr->samples.push_back({track_id, nullptr, std::move(sample)});
+        return true;
+      },
+      nullptr);
+  parser.SetTimestampAdjustments(timestamp_adjustments);
+  range->ok = ParseAll(&parser, header->data(), header->size()) &&
+              ParseAll(&parser, data.data(), data.size()) && parser.Flush();
+  if (!range->ok) {
+    LOG(ERROR) << "Cannot parse the fragments at " << range->start << " of '"
+               << file_name << "'.";
+  }
+  range->done.Notify();
+}
+
+void ParallelFragmentParser::WaitForPendingRanges() {
+  for (size_t i = next_range_; i < next_range_to_parse_; ++i)
+    ranges_[i]->done.WaitForNotification();
+}
+
+}  // namespace mp4
+}  // namespace media
+}  // namespace shaka
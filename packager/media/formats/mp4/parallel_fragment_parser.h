@@ -0,0 +1,95 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_FORMATS_MP4_PARALLEL_FRAGMENT_PARSER_H_
+#define PACKAGER_MEDIA_FORMATS_MP4_PARALLEL_FRAGMENT_PARSER_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <packager/media/base/media_parser.h>
+
+namespace shaka {
+namespace media {
+namespace mp4 {
+
+/// Parses the fragments of a fragmented MP4 file on multiple threads.
+///
+/// The file is split at 'moof' boxes into ranges of whole fragments. Each
+/// range is parsed by its own MP4MediaParser, primed with the boxes before the
+/// first fragment, on the thread pool. The samples are handed out range by
+/// range in file order, so they come out exactly as if the file was parsed
+/// sequentially. Only a few ranges are parsed ahead of the one being handed
+/// out, which bounds the memory used.
+class ParallelFragmentParser {
+ public:
+  /// @param file_name is the name of the input, which must support seeking.
+  /// @param num_threads is the number of ranges parsed in parallel.
+  /// @param min_range_size is the minimum size, in bytes, of each range.
+  ParallelFragmentParser(const std::string& file_name,
+                         uint32_t num_threads,
+                         uint64_t min_range_size);
+  ~ParallelFragmentParser();
+
+  /// Find the fragments of the input.
+  /// @return true if the input can be parsed in parallel: it is seekable and
+  ///         fragmented, with a 'moov' and no 'mdat' before the first 'moof',
+  ///         it has at least two ranges, and every fragment has a 'tfdt' and
+  ///         no explicit base data offset, so that fragments can be parsed
+  ///         independently of each other.
+  bool Initialize();
+
+  /// @return The boxes before the first fragment, which include the 'moov'.
+  ///         Valid after a successful call to Initialize().
+  const std::vector<uint8_t>& header() const { return *header_; }
+
+  /// Wait for the next range to be parsed and pass its samples, in order, to
+  /// the callbacks. Starts parsing the ranges after it in the background.
+  /// @param[out] end_of_stream is set to true if all the ranges have been
+  ///             handed out.
+  /// @return false if the range cannot be parsed or a callback fails.
+  bool ParseNextRange(const MediaParser::NewMediaSampleCB& new_media_sample_cb,
+                      const MediaParser::NewTextSampleCB& new_text_sample_cb,
+                      bool* end_of_stream);
+
+ private:
+  ParallelFragmentParser(const ParallelFragmentParser&) = delete;
+  ParallelFragmentParser& operator=(const ParallelFragmentParser&) = delete;
+
+  struct Range;
+
+  // Parses |range| of |file_name| with a new parser primed with |header| and
+  // |timestamp_adjustments|.
+  static void ParseRange(
+      const std::string& file_name,
+      std::shared_ptr<const std::vector<uint8_t>> header,
+      const std::map<uint32_t, int64_t>& timestamp_adjustments,
+      std::shared_ptr<Range> range);
+  // Waits for the ranges which are still being parsed.
+  void WaitForPendingRanges();
+
+  const std::string file_name_;
+  const uint32_t num_threads_;
+  const uint64_t min_range_size_;
+  std::shared_ptr<std::vector<uint8_t>> header_;
+  // The timestamp adjustments, by track ID, which sequential parsing would
+  // determine from the first fragments.
+  std::map<uint32_t, int64_t> timestamp_adjustments_;
+  std::vector<std::shared_ptr<Range>> ranges_;
+  // The index of the next range to hand out.
+  size_t next_range_ = 0;
+  // The index of the next range to start parsing.
+  size_t next_range_to_parse_ = 0;
+};
+
+}  // namespace mp4
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_FORMATS_MP4_PARALLEL_FRAGMENT_PARSER_H_
@@ -0,0 +1,100 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/formats/mp4/parallel_fragment_parser.h>
+
+#include <gtest/gtest.h>
+
+#include <packager/media/base/media_sample.h>
+#include <packager/media/base/stream_info.h>
+#include <packager/media/formats/mp4/mp4_media_parser.h>
+#include <packager/media/test/test_data_util.h>
+
+namespace shaka {
+namespace media {
+namespace mp4 {
+namespace {
+
+const char kFragmentedFile[] = "bear-640x360-av_frag.mp4";
+// Put every fragment in its own range.
+const uint64_t kMinRangeSize = 1;
+const uint32_t kNumThreads = 3;
+
+struct Sample {
+  uint32_t track_id;
+  std::shared_ptr<MediaSample> sample;
+};
+
+bool AppendSample(std::vector<Sample>* samples,
+                  uint32_t track_id,
+                  std::shared_ptr<MediaSample> sample) {
+  samples->push_back({track_id, sample});
+  return true;
+}
+
+std::vector<Sample> ParseSequentially(const std::string& file_name) {
+  std::vector<Sample> samples;
+  MP4MediaParser parser;
+  parser.Init([](const std::vector<std::shared_ptr<StreamInfo>>&) {},
+              std::bind(&AppendSample, &samples, std::placeholders::_1,
+                        std::placeholders::_2),
+              [](uint32_t, std::shared_ptr<TextSample>) { return false; },
+              nullptr);
+  std::vector<uint8_t> buffer = ReadTestDataFile(file_name);
+  EXPECT_TRUE(parser.Parse(buffer.data(), static_cast<int>(buffer.size())));
+  EXPECT_TRUE(parser.Flush());
+  return samples;
+}
+
+}  // namespace
+
+TEST(ParallelFragmentParserTest, SamplesMatchSequentialParsing) {
+  ParallelFragmentParser parser(GetTestDataFilePath(kFragmentedFile).string(),
+                                kNumThreads, kMinRangeSize);
+  ASSERT_TRUE(parser.Initialize());
+
+  std::vector<Sample> samples;
+  bool end_of_stream = false;
+  while (!end_of_stream) {
+    ASSERT_TRUE(parser.ParseNextRange(
+        std::bind(&AppendSample, &samples, std::placeholders::_1,
+                  std::placeholders::_2),
+        [](uint32_t, std::shared_ptr<TextSample>) { return false; },
+        &end_of_stream));
+  }
+
+  const std::vector<Sample> expected_samples =
+      ParseSequentially(kFragmentedFile);
+  ASSERT_EQ(expected_samples.size(), samples.size());
+  for (size_t i = 0; i < samples.size(); ++i) {
+    EXPECT_EQ(expected_samples[i].track_id, samples[i].track_id);
+    EXPECT_EQ(expected_samples[i].sample->ToString(),
+              samples[i].sample->ToString());
+    EXPECT_EQ(std::vector<uint8_t>(expected_samples[i].sample->data(),
+                                   expected_samples[i].sample->data() +
+                                       expected_samples[i].sample->data_size()),
+              std::vector<uint8_t>(
+                  samples[i].sample->data(),
+                  samples[i].sample->data() + samples[i].sample->data_size()));
+  }
+}
+
+TEST(ParallelFragmentParserTest, RejectsSingleRange) {
+  ParallelFragmentParser parser(GetTestDataFilePath(kFragmentedFile).string(),
+                                kNumThreads, 1ULL << 40);
+  EXPECT_FALSE(parser.Initialize());
+}
+
+TEST(ParallelFragmentParserTest, RejectsNonFragmentedFile) {
+  ParallelFragmentParser parser(
+      GetTestDataFilePath("bear-640x360.mp4").string(), kNumThreads,
+      kMinRangeSize);
+  EXPECT_FALSE(parser.Initialize());
+}
+
+}  // namespace mp4
+}  // namespace media
+}  // namespace shaka
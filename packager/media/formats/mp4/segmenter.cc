@@ -7,12 +7,20 @@
 #include <packager/media/formats/mp4/segmenter.h>
 
 #include <algorithm>
+#include <chrono>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
+#include <absl/synchronization/blocking_counter.h>
 
+#include <packager/file.h>
+#include <packager/file/file_closer.h>
+#include <packager/file/thread_pool.h>
+#include <packager/macros/logging.h>
+#include <packager/macros/status.h>
 #include <packager/media/base/buffer_writer.h>
 #include <packager/media/base/id3_tag.h>
+#include <packager/media/base/media_handler.h>
 #include <packager/media/base/media_sample.h>
 #include <packager/media/base/muxer_options.h>
 #include <packager/media/base/muxer_util.h>
@@ -22,6 +30,8 @@
 #include <packager/media/formats/mp4/box_definitions.h>
 #include <packager/media/formats/mp4/fragmenter.h>
 #include <packager/media/formats/mp4/key_frame_info.h>
+#include <packager/utils/clock.h>
+#include <packager/utils/trace.h>
 #include <packager/version/version.h>
 
 namespace shaka {
@@ -30,6 +40,12 @@ namespace mp4 {
 
 namespace {
 
+// The scheme of the event messages of the cues, with the cue data as the
+// message data.
+const char kScte35SchemeIdUri[] = "urn:scte:scte35:2013:bin";
+// The seconds from the NTP epoch, 1900, to the Unix epoch, 1970.
+const uint64_t kNtpEpochOffsetSeconds = 2208988800ULL;
+
 int64_t Rescale(int64_t time_in_old_scale,
                 int32_t old_scale,
                 int32_t new_scale) {
@@ -42,11 +58,15 @@ Segmenter::Segmenter(const MuxerOptions& options,
                      std::unique_ptr<FileType> ftyp,
                      std::unique_ptr<Movie> moov)
     : options_(options),
+      segment_template_(options.segment_template),
       ftyp_(std::move(ftyp)),
       moov_(std::move(moov)),
       moof_(new MovieFragment()),
       fragment_buffer_(new BufferWriter()),
-      sidx_(new SegmentIndex()) {}
+      segment_header_buffer_(new BufferWriter()),
+      sidx_(new SegmentIndex()) {
+  fragment_buffer_->UseHugePages();
+}
 
 Segmenter::~Segmenter() {}
 
@@ -62,6 +82,7 @@ Status Segmenter::Initialize(
   moof_->tracks.resize(streams.size());
   fragmenters_.resize(streams.size());
   stream_durations_.resize(streams.size());
+  fragment_ended_.resize(streams.size());
 
   for (uint32_t i = 0; i < streams.size(); ++i) {
     moof_->tracks[i].header.track_id = i + 1;
@@ -124,6 +145,8 @@ Status Segmenter::Finalize() {
 }
 
 Status Segmenter::AddSample(size_t stream_id, const MediaSample& sample) {
+  RETURN_IF_ERROR(DoAddSample());
+
   // Set default sample duration if it has not been set yet.
   if (moov_->extends.tracks[stream_id].default_sample_duration == 0) {
     moov_->extends.tracks[stream_id].default_sample_duration =
@@ -132,7 +155,7 @@ Status Segmenter::AddSample(size_t stream_id, const MediaSample& sample) {
 
   DCHECK_LT(stream_id, fragmenters_.size());
   Fragmenter* fragmenter = fragmenters_[stream_id].get();
-  if (fragmenter->fragment_finalized()) {
+  if (fragment_ended_[stream_id]) {
     return Status(error::FRAGMENT_FINALIZED,
                   "Current fragment is finalized already.");
   }
@@ -153,6 +176,7 @@ Status Segmenter::AddSample(size_t stream_id, const MediaSample& sample) {
 
 Status Segmenter::FinalizeSegment(size_t stream_id,
                                   const SegmentInfo& segment_info) {
+  ScopedTraceEvent trace_event("Segmenter::FinalizeSegment");
   if (segment_info.key_rotation_encryption_config) {
     FinalizeFragmentForKeyRotation(
         stream_id, segment_info.is_encrypted,
@@ -160,17 +184,26 @@ Status Segmenter::FinalizeSegment(size_t stream_id,
   }
 
   DCHECK_LT(stream_id, fragmenters_.size());
-  Fragmenter* specified_fragmenter = fragmenters_[stream_id].get();
-  DCHECK(specified_fragmenter);
-  Status status = specified_fragmenter->FinalizeFragment();
+  fragment_ended_[stream_id] = true;
+
+  // Check if all tracks are ready for fragmentation.
+  if (std::find(fragment_ended_.begin(), fragment_ended_.end(), false) !=
+      fragment_ended_.end()) {
+    return Status::OK;
+  }
+  Status status = FinalizeFragments();
   if (!status.ok())
     return status;
 
-  // Check if all tracks are ready for fragmentation.
-  for (const std::unique_ptr<Fragmenter>& fragmenter : fragmenters_) {
-    if (!fragmenter->fragment_finalized())
-      return Status::OK;
+  // A track without samples has no fragment to finalize, and holds the
+  // fragment back until it has one.
+  bool all_finalized = true;
+  for (size_t i = 0; i < fragmenters_.size(); ++i) {
+    fragment_ended_[i] = fragmenters_[i]->fragment_finalized();
+    all_finalized = all_finalized && fragment_ended_[i];
   }
+  if (!all_finalized)
+    return Status::OK;
 
   MediaData mdat;
   // Data offset relative to 'moof': moof size + mdat header size.
@@ -231,6 +264,7 @@ Status Segmenter::FinalizeSegment(size_t stream_id,
 
   for (std::unique_ptr<Fragmenter>& fragmenter : fragmenters_)
     fragmenter->ClearFragmentFinalized();
+  std::fill(fragment_ended_.begin(), fragment_ended_.end(), false);
 
   if (segment_info.is_chunk) {
     // Finalize the completed chunk for the LL-DASH case.
@@ -251,6 +285,106 @@ Status Segmenter::FinalizeSegment(size_t stream_id,
   return Status::OK;
 }
 
+Status Segmenter::FinalizeFragments() {
+  if (fragmenters_.size() == 1)
+    return fragmenters_[0]->FinalizeFragment();
+
+  // The fragments of the tracks are independent, so they are finalized
+  // concurrently, the first one on this thread.
+  std::vector<Status> statuses(fragmenters_.size());
+  absl::BlockingCounter fragments_finalized(
+      static_cast<int>(fragmenters_.size() - 1));
+  for (size_t i = 1; i < fragmenters_.size(); ++i) {
+    ThreadPool::instance.PostTask([this, i, &statuses, &fragments_finalized]() {
+      statuses[i] = fragmenters_[i]->FinalizeFragment();
+      fragments_finalized.DecrementCount();
+    });
+  }
+  statuses[0] = fragmenters_[0]->FinalizeFragment();
+  fragments_finalized.Wait();
+
+  for (const Status& status : statuses)
+    RETURN_IF_ERROR(status);
+  return Status::OK;
+}
+
+void Segmenter::AddCueEvent(const CueEvent& cue_event) {
+  if (!options_.mp4_params.include_emsg_in_segments)
+    return;
+  DASHEventMessageBox emsg;
+  emsg.scheme_id_uri = kScte35SchemeIdUri;
+  emsg.timescale = GetReferenceTimeScale();
+  emsg.presentation_time =
+      static_cast<uint64_t>(cue_event.time_in_seconds * emsg.timescale);
+  // The duration is unknown.
+  emsg.event_duration = 0xFFFFFFFF;
+  emsg.id = next_event_message_id_++;
+  emsg.message_data.assign(cue_event.cue_data.begin(),
+                           cue_event.cue_data.end());
+  event_messages_.push_back(std::move(emsg));
+}
+
+void Segmenter::WriteEventBoxes(BufferWriter* buffer) {
+  if (options_.mp4_params.include_prft_in_segments) {
+    const std::chrono::system_clock::time_point now =
+        clock_ ? clock_->now() : std::chrono::system_clock::now();
+    const auto since_epoch =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            now.time_since_epoch());
+    const uint64_t seconds = since_epoch.count() / 1000000000;
+    const uint64_t nanoseconds = since_epoch.count() % 1000000000;
+
+    ProducerReferenceTime prft;
+    // The time is when the box is written.
+    prft.flags = 8;
+    prft.reference_track_id = sidx_->reference_id;
+    prft.ntp_timestamp = ((seconds + kNtpEpochOffsetSeconds) << 32) |
+                         ((nanoseconds << 32) / 1000000000);
+    prft.media_time = sidx_->earliest_presentation_time;
+    prft.Write(buffer);
+  }
+  for (DASHEventMessageBox& emsg : event_messages_)
+    emsg.Write(buffer);
+  event_messages_.clear();
+}
+
+Status Segmenter::WriteInitSegment() {
+  DCHECK(ftyp());
+  DCHECK(moov());
+  BufferWriter buffer;
+  ftyp()->Write(&buffer);
+  moov()->Write(&buffer);
+
+  const std::string& file_name = options_.output_file_name;
+  if (written_init_segment_ && written_init_segment_->file_name == file_name &&
+      written_init_segment_->data.size() == buffer.Size() &&
+      std::equal(written_init_segment_->data.begin(),
+                 written_init_segment_->data.end(), buffer.Buffer())) {
+    VLOG(1) << "Init segment " << file_name << " is not changed.";
+    return Status::OK;
+  }
+
+  // The buffer is cleared once written.
+  std::vector<uint8_t> data;
+  if (written_init_segment_)
+    data.assign(buffer.Buffer(), buffer.Buffer() + buffer.Size());
+
+  // Generate the output file with init segment.
+  std::unique_ptr<File, FileCloser> file(
+      File::OpenWithNoBuffering(file_name.c_str(), "w"));
+  if (!file) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot open file for write " + file_name);
+  }
+  RETURN_IF_ERROR(buffer.WriteToFile(file.get()));
+
+  if (written_init_segment_) {
+    written_init_segment_->file_name = file_name;
+    written_init_segment_->data = std::move(data);
+  }
+  return Status::OK;
+}
+
 int32_t Segmenter::GetReferenceTimeScale() const {
   return moov_->header.timescale;
 }
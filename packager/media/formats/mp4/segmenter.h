@@ -10,17 +10,23 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include <packager/macros/classes.h>
 #include <packager/media/base/fourccs.h>
+#include <packager/media/base/muxer_util.h>
 #include <packager/media/base/range.h>
 #include <packager/media/formats/mp4/box_definitions.h>
 #include <packager/status.h>
 
 namespace shaka {
+
+class Clock;
+
 namespace media {
 
+struct CueEvent;
 struct EncryptionConfig;
 struct MuxerOptions;
 struct SegmentInfo;
@@ -36,6 +42,14 @@ namespace mp4 {
 class Fragmenter;
 struct KeyFrameInfo;
 
+/// The init segment last written to a file. It outlives the segmenters of a
+/// muxer, so that an init segment which has not changed is not written again
+/// when the muxer is reinitialized.
+struct WrittenInitSegment {
+  std::string file_name;
+  std::vector<uint8_t> data;
+};
+
 /// This class defines the Segmenter which is responsible for organizing
 /// fragments into segments/subsegments and package them into a MP4 file.
 /// Inherited by MultiSegmentSegmenter and SingleSegmentSegmenter.
@@ -77,6 +91,21 @@ class Segmenter {
   /// @return OK on success, an error status otherwise.
   Status FinalizeSegment(size_t stream_id, const SegmentInfo& segment_info);
 
+  /// Adds an event message for @a cue_event to the next media segment, if
+  /// enabled in the MP4 output params.
+  /// @param cue_event is the cue, with its time in seconds.
+  void AddCueEvent(const CueEvent& cue_event);
+
+  /// Sets the clock of the producer reference time boxes. It must outlive the
+  /// segmenter. Uses the system clock by default.
+  void set_clock(Clock* clock) { clock_ = clock; }
+
+  /// Sets where the init segment last written is kept. It must outlive the
+  /// segmenter. The init segment is always written by default.
+  void set_written_init_segment(WrittenInitSegment* written_init_segment) {
+    written_init_segment_ = written_init_segment;
+  }
+
   // TODO(rkuroiwa): Change these Get*Range() methods to return
   // std::optional<Range> as well.
   /// @return true if there is an initialization range, while setting @a offset
@@ -110,9 +139,17 @@ class Segmenter {
   void SetComplete();
 
   const MuxerOptions& options() const { return options_; }
+  /// @return the segment template of the options, parsed once.
+  const SegmentTemplate& segment_template() const { return segment_template_; }
   FileType* ftyp() { return ftyp_.get(); }
   Movie* moov() { return moov_.get(); }
   BufferWriter* fragment_buffer() { return fragment_buffer_.get(); }
+  /// @return the buffer for the boxes preceding the fragments in a media
+  ///         segment, e.g. styp and sidx. It is kept between segments to
+  ///         avoid allocating a new buffer for every segment.
+  BufferWriter* segment_header_buffer() {
+    return segment_header_buffer_.get();
+  }
   SegmentIndex* sidx() { return sidx_.get(); }
   MuxerListener* muxer_listener() { return muxer_listener_; }
   uint64_t progress_target() { return progress_target_; }
@@ -124,26 +161,46 @@ class Segmenter {
     progress_target_ = progress_target;
   }
 
+  /// Writes the boxes preceding the first fragment of a media segment, which
+  /// starts at the earliest presentation time of the sidx: the producer
+  /// reference time box and the pending event messages, if enabled.
+  void WriteEventBoxes(BufferWriter* buffer);
+
+  /// Writes the init segment, i.e. 'ftyp' and 'moov', to the output file,
+  /// unless it is the same as the init segment last written to that file.
+  Status WriteInitSegment();
+
  private:
   virtual Status DoInitialize() = 0;
   virtual Status DoFinalize() = 0;
   virtual Status DoFinalizeSegment(int64_t segment_number) = 0;
   virtual Status DoFinalizeChunk(int64_t segment_number) { return Status::OK; }
+  // Called before each sample is added, e.g. to catch up on work completed in
+  // the background.
+  virtual Status DoAddSample() { return Status::OK; }
 
   uint32_t GetReferenceStreamId();
 
+  // Finalizes the fragments of all the tracks.
+  Status FinalizeFragments();
+
   void FinalizeFragmentForKeyRotation(
       size_t stream_id,
       bool fragment_encrypted,
       const EncryptionConfig& encryption_config);
 
   const MuxerOptions& options_;
+  const SegmentTemplate segment_template_;
   std::unique_ptr<FileType> ftyp_;
   std::unique_ptr<Movie> moov_;
   std::unique_ptr<MovieFragment> moof_;
   std::unique_ptr<BufferWriter> fragment_buffer_;
+  std::unique_ptr<BufferWriter> segment_header_buffer_;
   std::unique_ptr<SegmentIndex> sidx_;
   std::vector<std::unique_ptr<Fragmenter>> fragmenters_;
+  // Whether the current fragment of each track has ended. The fragments are
+  // finalized together once they have all ended.
+  std::vector<bool> fragment_ended_;
   MuxerListener* muxer_listener_ = nullptr;
   ProgressListener* progress_listener_ = nullptr;
   uint64_t progress_target_ = 0u;
@@ -152,6 +209,11 @@ class Segmenter {
   size_t num_samples_ = 0;
   std::vector<uint64_t> stream_durations_;
   std::vector<KeyFrameInfo> key_frame_infos_;
+  // The event messages of the next media segment.
+  std::vector<DASHEventMessageBox> event_messages_;
+  uint32_t next_event_message_id_ = 0;
+  Clock* clock_ = nullptr;
+  WrittenInitSegment* written_init_segment_ = nullptr;
 
   DISALLOW_COPY_AND_ASSIGN(Segmenter);
 };
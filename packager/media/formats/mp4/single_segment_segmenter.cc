@@ -123,6 +123,39 @@ Status SingleSegmentSegmenter::DoFinalize() {
   if (!status.ok())
     return status;
 
+  // The target of 2nd stage of single segment segmentation.
+  const uint64_t re_segment_progress_target = progress_target() * 0.5;
+
+  // If the output is a local file, let the kernel append the temp file to it
+  // instead of reading the media data back through a userspace buffer.
+  if (File::IsLocalRegularFile(options().output_file_name.c_str())) {
+    if (!file.release()->Close()) {
+      return Status(
+          error::FILE_FAILURE,
+          "Cannot close file " + options().output_file_name +
+              ", possibly file permission issue or running out of disk space.");
+    }
+    status = AppendLocalFileInKernel(
+        temp_file_name_, options().output_file_name,
+        [this, re_segment_progress_target](uint64_t chunk_size,
+                                           uint64_t file_size) {
+          UpdateProgress(static_cast<double>(chunk_size) / file_size *
+                         re_segment_progress_target);
+        });
+    if (status.ok()) {
+      SetComplete();
+      return Status::OK;
+    }
+    if (status.error_code() != error::UNIMPLEMENTED)
+      return status;
+
+    file.reset(File::Open(options().output_file_name.c_str(), "a"));
+    if (file == NULL) {
+      return Status(error::FILE_FAILURE,
+                    "Cannot open file to write " + options().output_file_name);
+    }
+  }
+
   // Load the temp file and write to output file.
   std::unique_ptr<File, FileCloser> temp_file(
       File::Open(temp_file_name_.c_str(), "r"));
@@ -131,9 +164,6 @@ Status SingleSegmentSegmenter::DoFinalize() {
                   "Cannot open file to read " + temp_file_name_);
   }
 
-  // The target of 2nd stage of single segment segmentation.
-  const uint64_t re_segment_progress_target = progress_target() * 0.5;
-
   const int kBufSize = 0x200000;  // 2MB.
   std::unique_ptr<uint8_t[]> buf(new uint8_t[kBufSize]);
   while (true) {
@@ -69,6 +69,14 @@ struct TrackRunInfo {
   std::vector<uint8_t> aux_info_sizes;  // Populated if default_size == 0.
   int aux_info_total_size;
 
+  // For non-fragmented mp4, |samples| is only decoded from the sample table
+  // while the run is the current run. Null for fragmented mp4.
+  const SampleTable* sample_table;
+  // Zero-based index in the track of the first sample of the run. Only valid
+  // if |sample_table| is set.
+  uint32_t first_sample_index;
+  uint32_t sample_count;
+
   TrackRunInfo();
   ~TrackRunInfo();
 };
@@ -83,9 +91,38 @@ TrackRunInfo::TrackRunInfo()
       video_description(NULL),
       aux_info_start_offset(-1),
       aux_info_default_size(0),
-      aux_info_total_size(0) {}
+      aux_info_total_size(0),
+      sample_table(NULL),
+      first_sample_index(0),
+      sample_count(0) {}
 TrackRunInfo::~TrackRunInfo() {}
 
+// Iterates over the sample table of a track while its runs are decoded. The
+// runs of a track are usually reached in order, so a cursor only moves
+// forward, and starts over otherwise.
+struct TrackRunIterator::SampleTableCursor {
+  explicit SampleTableCursor(const SampleTable& sample_table)
+      : decoding_time(sample_table.decoding_time_to_sample),
+        composition_offset(sample_table.composition_time_to_sample),
+        has_composition_offset(composition_offset.IsValid()),
+        sync_sample(sample_table.sync_sample) {}
+
+  void AdvanceSample() {
+    decoding_time.AdvanceSample();
+    if (has_composition_offset)
+      composition_offset.AdvanceSample();
+    sync_sample.AdvanceSample();
+    ++sample_index;
+  }
+
+  DecodingTimeIterator decoding_time;
+  CompositionOffsetIterator composition_offset;
+  const bool has_composition_offset;
+  SyncSampleIterator sync_sample;
+  // Zero-based index of the sample the iterators point to.
+  uint32_t sample_index = 0;
+};
+
 TrackRunIterator::TrackRunIterator(const Movie* moov)
     : moov_(moov), sample_dts_(0), sample_offset_(0) {
   CHECK(moov);
@@ -161,6 +198,7 @@ class CompareMinTrackRunDataOffset {
 
 bool TrackRunIterator::Init() {
   runs_.clear();
+  sample_table_cursors_.clear();
 
   for (std::vector<Track>::const_iterator trak = moov_->tracks.begin();
        trak != moov_->tracks.end(); ++trak) {
@@ -178,8 +216,6 @@ bool TrackRunIterator::Init() {
     bool has_composition_offset = composition_offset.IsValid();
     ChunkInfoIterator chunk_info(
         trak->media.information.sample_table.sample_to_chunk);
-    SyncSampleIterator sync_sample(
-        trak->media.information.sample_table.sync_sample);
     // Skip processing saiz and saio boxes for non-fragmented mp4 as we
     // don't support encrypted non-fragmented mp4.
 
@@ -210,6 +246,8 @@ bool TrackRunIterator::Init() {
       RCHECK(decoding_time.IsValid());
       RCHECK(chunk_info.IsValid());
     }
+    if (sample_size.sample_size == 0)
+      RCHECK(sample_size.sizes.size() >= num_samples);
 
     uint32_t sample_index = 0;
     for (uint32_t chunk_index = 0; chunk_index < num_chunks; ++chunk_index) {
@@ -244,37 +282,36 @@ bool TrackRunIterator::Init() {
                    .default_is_protected == 0);
       }
 
-      uint32_t samples_per_chunk = chunk_info.samples_per_chunk();
-      tri.samples.resize(samples_per_chunk);
-      for (uint32_t k = 0; k < samples_per_chunk; ++k) {
-        SampleInfo& sample = tri.samples[k];
-        sample.size = sample_size.sample_size != 0
-                          ? sample_size.sample_size
-                          : sample_size.sizes[sample_index];
-        sample.duration = decoding_time.sample_delta();
-        sample.cts_offset =
-            has_composition_offset ? composition_offset.sample_offset() : 0;
-        sample.is_keyframe = sync_sample.IsSyncSample();
-
-        run_start_dts += sample.duration;
+      // The samples are only decoded once the run is reached, so that the
+      // sample information of long files is not all held at once. Only the
+      // tables are checked, and the start time of each run computed, here.
+      tri.sample_table = &trak->media.information.sample_table;
+      tri.first_sample_index = sample_index;
+      tri.sample_count = chunk_info.samples_per_chunk();
+      for (uint32_t k = 0; k < tri.sample_count; ++k) {
+        run_start_dts += decoding_time.sample_delta();
 
         // Advance to next sample. Should success except for last sample.
         ++sample_index;
-        RCHECK(chunk_info.AdvanceSample() && sync_sample.AdvanceSample());
+        RCHECK(chunk_info.AdvanceSample());
         if (sample_index == num_samples) {
-          // We should hit end of tables for decoding time and composition
-          // offset.
+          // We should hit end of tables for decoding time.
           RCHECK(!decoding_time.AdvanceSample());
-          if (has_composition_offset)
-            RCHECK(!composition_offset.AdvanceSample());
         } else {
           RCHECK(decoding_time.AdvanceSample());
-          if (has_composition_offset)
-            RCHECK(composition_offset.AdvanceSample());
         }
       }
 
-      runs_.push_back(tri);
+      runs_.push_back(std::move(tri));
+    }
+
+    if (has_composition_offset) {
+      // We should hit end of table for composition offset with the last
+      // sample.
+      const uint32_t num_composition_offsets = composition_offset.NumSamples();
+      RCHECK(sample_index == num_samples
+                 ? num_composition_offsets == num_samples
+                 : num_composition_offsets >= sample_index);
     }
   }
 
@@ -440,18 +477,81 @@ bool TrackRunIterator::Init(const MovieFragment& moof) {
 }
 
 void TrackRunIterator::AdvanceRun() {
+  TrackRunInfo& run = runs_[run_itr_ - runs_.begin()];
+  if (run.sample_table)
+    std::vector<SampleInfo>().swap(run.samples);
   ++run_itr_;
   ResetRun();
 }
 
+bool TrackRunIterator::FindKeyFrameDts(uint32_t track_id,
+                                       int64_t pts,
+                                       int64_t* dts) const {
+  DCHECK(dts);
+  const auto timestamp_adjustment = timestamp_adjustment_map_.find(track_id);
+  if (timestamp_adjustment == timestamp_adjustment_map_.end())
+    return false;
+  for (const Track& track : moov_->tracks) {
+    if (track.header.track_id != track_id)
+      continue;
+    const SampleTable& sample_table = track.media.information.sample_table;
+    // The tables have been checked to cover all the samples in Init().
+    SampleTableCursor cursor(sample_table);
+    int64_t sample_dts = timestamp_adjustment->second;
+    bool found = false;
+    for (uint32_t i = 0;
+         i < sample_table.sample_size.sample_count && sample_dts <= pts; ++i) {
+      const int64_t sample_pts =
+          sample_dts + (cursor.has_composition_offset
+                            ? cursor.composition_offset.sample_offset()
+                            : 0);
+      if (cursor.sync_sample.IsSyncSample() && (!found || sample_pts <= pts)) {
+        *dts = sample_dts;
+        found = true;
+      }
+      sample_dts += cursor.decoding_time.sample_delta();
+      cursor.AdvanceSample();
+    }
+    return found;
+  }
+  return false;
+}
+
 void TrackRunIterator::ResetRun() {
   if (!IsRunValid())
     return;
+  if (run_itr_->sample_table && run_itr_->samples.empty())
+    DecodeSamples(&runs_[run_itr_ - runs_.begin()]);
   sample_dts_ = run_itr_->start_dts;
   sample_offset_ = run_itr_->sample_start_offset;
   sample_itr_ = run_itr_->samples.begin();
 }
 
+void TrackRunIterator::DecodeSamples(TrackRunInfo* run) {
+  std::unique_ptr<SampleTableCursor>& cursor =
+      sample_table_cursors_[run->track_id];
+  if (!cursor || cursor->sample_index > run->first_sample_index)
+    cursor.reset(new SampleTableCursor(*run->sample_table));
+  while (cursor->sample_index < run->first_sample_index)
+    cursor->AdvanceSample();
+
+  // The tables have been checked to cover all the samples of the runs in
+  // Init().
+  const SampleSize& sample_size = run->sample_table->sample_size;
+  run->samples.resize(run->sample_count);
+  for (SampleInfo& sample : run->samples) {
+    sample.size = sample_size.sample_size != 0
+                      ? sample_size.sample_size
+                      : sample_size.sizes[cursor->sample_index];
+    sample.duration = cursor->decoding_time.sample_delta();
+    sample.cts_offset = cursor->has_composition_offset
+                            ? cursor->composition_offset.sample_offset()
+                            : 0;
+    sample.is_keyframe = cursor->sync_sample.IsSyncSample();
+    cursor->AdvanceSample();
+  }
+}
+
 void TrackRunIterator::AdvanceSample() {
   DCHECK(IsSampleValid());
   sample_dts_ += sample_itr_->duration;
@@ -498,6 +598,14 @@ bool TrackRunIterator::IsSampleValid() const {
   return IsRunValid() && (sample_itr_ != run_itr_->samples.end());
 }
 
+int64_t TrackRunIterator::GetRemainingRunSize() const {
+  DCHECK(IsRunValid());
+  int64_t size = 0;
+  for (auto it = sample_itr_; it != run_itr_->samples.end(); ++it)
+    size += it->size;
+  return size;
+}
+
 // Because tracks are in sorted order and auxiliary information is cached when
 // returning samples, it is guaranteed that no data will be required before the
 // lesser of the minimum data offset of this track and the next in sequence.
@@ -629,7 +737,7 @@ std::unique_ptr<DecryptConfig> TrackRunIterator::GetDecryptConfig() {
                                         : video_description().sinf.type.type;
   if (iv.empty()) {
     if (protection_scheme != FOURCC_cbcs) {
-      LOG(WARNING)
+      LOG_RATE_LIMITED(WARNING)
           << "Constant IV should only be used with 'cbcs' protection scheme.";
     }
     iv = track_encryption().default_constant_iv;
@@ -30,7 +30,8 @@ class TrackRunIterator {
   ~TrackRunIterator();
 
   /// For non-fragmented mp4, moov contains all the chunk information; This
-  /// function sets up the iterator to access all the chunks.
+  /// function sets up the iterator to access all the chunks. The samples of a
+  /// chunk are only decoded from the sample table once the chunk is reached.
   /// For fragmented mp4, chunk and sample information are generally contained
   /// in moof. This function is a no-op in this case. Init(moof) will be called
   /// later after parsing moof.
@@ -73,6 +74,11 @@ class TrackRunIterator {
   ///         head of the MOOF box).
   int64_t GetMaxClearOffset();
 
+  /// @return the total size of the current sample and the samples after it in
+  ///         the current run, which are stored contiguously. Only valid if
+  ///         IsRunValid().
+  int64_t GetRemainingRunSize() const;
+
   /// @name Properties of the current run. Only valid if IsRunValid().
   /// @{
   uint32_t track_id() const;
@@ -98,12 +104,40 @@ class TrackRunIterator {
   bool is_keyframe() const;
   /// @}
 
+  /// @return the timestamp adjustments, by track ID, which have been
+  ///         determined so far from the edit lists or the first track
+  ///         fragments.
+  const std::map<uint32_t, int64_t>& timestamp_adjustments() const {
+    return timestamp_adjustment_map_;
+  }
+  /// Use the given timestamp adjustments, e.g. from an iterator over the
+  /// earlier fragments of the same file, instead of determining them again.
+  void set_timestamp_adjustments(
+      const std::map<uint32_t, int64_t>& timestamp_adjustments) {
+    timestamp_adjustment_map_ = timestamp_adjustments;
+  }
+
+  /// Find where to start decoding a track of a non-fragmented mp4 to present
+  /// @a pts, from the sample table of the track. Must be called after Init().
+  /// @param track_id is the ID of the track.
+  /// @param pts is a presentation timestamp in the timescale of the track.
+  /// @param[out] dts is set to the decoding timestamp of the last key frame
+  ///             presented at or before @a pts, or of the first key frame if
+  ///             there is none.
+  /// @return false if the track has no key frame decoded at or before
+  ///         @a pts.
+  bool FindKeyFrameDts(uint32_t track_id, int64_t pts, int64_t* dts) const;
+
   /// Only call when is_encrypted() is true and AuxInfoNeedsToBeCached() is
   /// false. Result is owned by caller.
   std::unique_ptr<DecryptConfig> GetDecryptConfig();
 
  private:
+  struct SampleTableCursor;
+
   void ResetRun();
+  // Decodes the samples of a run of non-fragmented mp4.
+  void DecodeSamples(TrackRunInfo* run);
   const TrackEncryption& track_encryption() const;
   int64_t GetTimestampAdjustment(const Movie& movie,
                                  const Track& track,
@@ -122,6 +156,9 @@ class TrackRunIterator {
   int64_t sample_dts_;
   int64_t sample_offset_;
 
+  // TrackId => position in the sample table, for non-fragmented mp4.
+  std::map<uint32_t, std::unique_ptr<SampleTableCursor>> sample_table_cursors_;
+
   // TrackId => adjustment map.
   std::map<uint32_t, int64_t> timestamp_adjustment_map_;
 
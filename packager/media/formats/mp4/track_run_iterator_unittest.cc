@@ -815,6 +815,69 @@ TEST_F(TrackRunIteratorTest, UnexpectedOrderingTest) {
   EXPECT_EQ(iter_->GetMaxClearOffset(), 10000);
 }
 
+TEST_F(TrackRunIteratorTest, NonFragmentedTest) {
+  SampleTable& audio_table = moov_.tracks[0].media.information.sample_table;
+  audio_table.decoding_time_to_sample.decoding_time = {{6, 1024}};
+  audio_table.sample_to_chunk.chunk_info = {{1, 3, 1}};
+  audio_table.sample_size.sample_count = 6;
+  audio_table.sample_size.sizes = {1, 2, 3, 4, 5, 6};
+  audio_table.chunk_large_offset.offsets = {100, 1000};
+
+  SampleTable& video_table = moov_.tracks[1].media.information.sample_table;
+  video_table.decoding_time_to_sample.decoding_time = {{4, 1}};
+  video_table.composition_time_to_sample.composition_offset = {{2, 0},
+                                                                {2, 1}};
+  video_table.sample_to_chunk.chunk_info = {{1, 2, 1}};
+  video_table.sample_size.sample_size = 10;
+  video_table.sample_size.sample_count = 4;
+  video_table.chunk_large_offset.offsets = {500, 2000};
+  video_table.sync_sample.sample_number = {1, 3};
+
+  // The chunks of both tracks are interleaved, so the samples of each track
+  // are decoded over several runs.
+  iter_.reset(new TrackRunIterator(&moov_));
+  ASSERT_TRUE(iter_->Init());
+  EXPECT_EQ(iter_->track_id(), 1u);
+  EXPECT_EQ(iter_->sample_offset(), 100);
+  EXPECT_EQ(iter_->sample_size(), 1);
+  EXPECT_EQ(iter_->dts(), 0);
+  EXPECT_EQ(iter_->GetRemainingRunSize(), 6);
+  iter_->AdvanceSample();
+  iter_->AdvanceSample();
+  EXPECT_EQ(iter_->sample_offset(), 103);
+  EXPECT_EQ(iter_->sample_size(), 3);
+  EXPECT_EQ(iter_->dts(), 2048);
+
+  iter_->AdvanceRun();
+  EXPECT_EQ(iter_->track_id(), 2u);
+  EXPECT_EQ(iter_->sample_offset(), 500);
+  EXPECT_EQ(iter_->sample_size(), 10);
+  EXPECT_EQ(iter_->cts(), 0);
+  EXPECT_TRUE(iter_->is_keyframe());
+  iter_->AdvanceSample();
+  EXPECT_EQ(iter_->dts(), 1);
+  EXPECT_FALSE(iter_->is_keyframe());
+
+  iter_->AdvanceRun();
+  EXPECT_EQ(iter_->track_id(), 1u);
+  EXPECT_EQ(iter_->sample_offset(), 1000);
+  EXPECT_EQ(iter_->sample_size(), 4);
+  EXPECT_EQ(iter_->dts(), 3072);
+
+  iter_->AdvanceRun();
+  EXPECT_EQ(iter_->track_id(), 2u);
+  EXPECT_EQ(iter_->sample_offset(), 2000);
+  EXPECT_EQ(iter_->dts(), 2);
+  EXPECT_EQ(iter_->cts(), 3);
+  EXPECT_TRUE(iter_->is_keyframe());
+  iter_->AdvanceSample();
+  EXPECT_EQ(iter_->cts(), 4);
+  EXPECT_FALSE(iter_->is_keyframe());
+
+  iter_->AdvanceRun();
+  EXPECT_FALSE(iter_->IsRunValid());
+}
+
 }  // namespace mp4
 }  // namespace media
 }  // namespace shaka
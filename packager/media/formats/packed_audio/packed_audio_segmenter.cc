@@ -142,14 +142,24 @@ Status PackedAudioSegmenter::StartNewSegment(const MediaSample& sample) {
     return Status(error::MUXER_FAILURE, "Unsupported negative timestamp.");
   }
 
-  // Use a unique_ptr so it can be mocked for testing.
-  std::unique_ptr<Id3Tag> id3_tag = CreateId3Tag();
-  id3_tag->AddPrivateFrame(kTimestampOwnerIdentifier, TimestampToString(pts));
-  if (!audio_setup_information_.empty()) {
-    id3_tag->AddPrivateFrame(kAudioDescriptionOwnerIdentifier,
-                             audio_setup_information_);
+  // The tag of a segment only differs from the tag of the previous segment by
+  // its timestamp, until the audio setup information shows up, so the tag is
+  // only created again then.
+  const std::string timestamp = TimestampToString(pts);
+  const bool has_audio_setup = !audio_setup_information_.empty();
+  if (id3_tag_ && id3_tag_has_audio_setup_ == has_audio_setup) {
+    CHECK(id3_tag_->SetPrivateFrameData(kTimestampOwnerIdentifier, timestamp));
+  } else {
+    // Use a unique_ptr so it can be mocked for testing.
+    id3_tag_ = CreateId3Tag();
+    id3_tag_->AddPrivateFrame(kTimestampOwnerIdentifier, timestamp);
+    if (has_audio_setup) {
+      id3_tag_->AddPrivateFrame(kAudioDescriptionOwnerIdentifier,
+                                audio_setup_information_);
+    }
+    id3_tag_has_audio_setup_ = has_audio_setup;
   }
-  CHECK(id3_tag->WriteToBuffer(&segment_buffer_));
+  CHECK(id3_tag_->WriteToBuffer(&segment_buffer_));
 
   return Status::OK;
 }
@@ -93,6 +93,11 @@ class PackedAudioSegmenter {
 
   // Audio setup information for encrypted segment.
   std::string audio_setup_information_;
+  // The ID3 tag of the segments, which is patched with the timestamp of each
+  // segment.
+  std::unique_ptr<Id3Tag> id3_tag_;
+  // Whether |id3_tag_| carries the audio setup information.
+  bool id3_tag_has_audio_setup_ = false;
   // AAC is carried in ADTS.
   std::unique_ptr<AACAudioSpecificConfig> adts_converter_;
 
@@ -115,6 +115,8 @@ class MockId3Tag : public Id3Tag {
  public:
   MOCK_METHOD2(AddPrivateFrame,
                void(const std::string&, const std::string& data));
+  MOCK_METHOD2(SetPrivateFrameData,
+               bool(const std::string&, const std::string& data));
   MOCK_METHOD1(WriteToBuffer, bool(BufferWriter* buffer_writer));
 };
 
@@ -264,15 +266,25 @@ TEST_F(PackedAudioSegmenterTest, Ac3AddSampleTwice) {
 TEST_F(PackedAudioSegmenterTest, Ac3AddSampleTwiceWithFinalize) {
   ASSERT_OK(segmenter_.Initialize(*CreateAudioStreamInfo(kCodecAC3)));
 
+  // The tag of the first segment is patched for the second segment.
   std::unique_ptr<MockId3Tag> mock_id3_tag(new MockId3Tag);
   EXPECT_CALL(*mock_id3_tag,
               AddPrivateFrame(
                   kTimestampOwnerIdentifier,
                   std::string(std::begin(kScaledPts1), std::end(kScaledPts1))));
+  EXPECT_CALL(*mock_id3_tag,
+              SetPrivateFrameData(
+                  kTimestampOwnerIdentifier,
+                  std::string(std::begin(kScaledPts2), std::end(kScaledPts2))))
+      .WillOnce(Return(true));
   EXPECT_CALL(*mock_id3_tag, WriteToBuffer(_))
       .WillOnce(Invoke([](BufferWriter* buffer) {
         buffer->AppendString(kSegment1Data);
         return true;
+      }))
+      .WillOnce(Invoke([](BufferWriter* buffer) {
+        buffer->AppendString(kSegment2Data);
+        return true;
       }));
   EXPECT_CALL(segmenter_, CreateId3Tag())
       .WillOnce(Return(ByMove(std::move(mock_id3_tag))));
@@ -281,19 +293,6 @@ TEST_F(PackedAudioSegmenterTest, Ac3AddSampleTwiceWithFinalize) {
   ASSERT_OK(segmenter_.FinalizeSegment());
   EXPECT_EQ(std::string(kSegment1Data) + kSample1Data, GetSegmentData());
 
-  std::unique_ptr<MockId3Tag> mock_id3_tag2(new MockId3Tag);
-  EXPECT_CALL(*mock_id3_tag2,
-              AddPrivateFrame(
-                  kTimestampOwnerIdentifier,
-                  std::string(std::begin(kScaledPts2), std::end(kScaledPts2))));
-  EXPECT_CALL(*mock_id3_tag2, WriteToBuffer(_))
-      .WillOnce(Invoke([](BufferWriter* buffer) {
-        buffer->AppendString(kSegment2Data);
-        return true;
-      }));
-  EXPECT_CALL(segmenter_, CreateId3Tag())
-      .WillOnce(Return(ByMove(std::move(mock_id3_tag2))));
-
   ASSERT_OK(segmenter_.AddSample(*CreateSample(kPts2, kDts2, kSample2Data)));
   EXPECT_EQ(std::string(kSegment2Data) + kSample2Data, GetSegmentData());
 }
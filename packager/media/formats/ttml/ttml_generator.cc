@@ -6,11 +6,12 @@
 
 #include <packager/media/formats/ttml/ttml_generator.h>
 
+#include <algorithm>
+
+#include <absl/log/check.h>
 #include <absl/strings/escaping.h>
 #include <absl/strings/str_format.h>
 
-#include <packager/media/base/rcheck.h>
-
 namespace shaka {
 namespace media {
 namespace ttml {
@@ -19,6 +20,10 @@ namespace {
 
 constexpr const char* kRegionIdPrefix = "_shaka_region_";
 constexpr const char* kRegionTeletextPrefix = "ttx_";
+constexpr const char* kXmlDeclaration =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+// libxml2 indents by two spaces per level, up to 30 levels.
+constexpr int kMaxIndentLevel = 30;
 
 std::string ToTtmlTime(int64_t time, int32_t timescale) {
   int64_t remaining = time * 1000 / timescale;
@@ -41,8 +46,174 @@ std::string ToTtmlSize(const TextNumber& x, const TextNumber& y) {
                          kSuffixMap[static_cast<int>(y.type)]);
 }
 
+// Escapes text content as libxml2 does.
+void AppendEscapedText(const std::string& text, std::string* output) {
+  for (char c : text) {
+    switch (c) {
+      case '<':
+        output->append("&lt;");
+        break;
+      case '>':
+        output->append("&gt;");
+        break;
+      case '&':
+        output->append("&amp;");
+        break;
+      case '\r':
+        output->append("&#13;");
+        break;
+      default:
+        output->push_back(c);
+    }
+  }
+}
+
+// Escapes an attribute value as libxml2 does.
+void AppendEscapedAttribute(const std::string& value, std::string* output) {
+  for (char c : value) {
+    switch (c) {
+      case '<':
+        output->append("&lt;");
+        break;
+      case '>':
+        output->append("&gt;");
+        break;
+      case '&':
+        output->append("&amp;");
+        break;
+      case '"':
+        output->append("&quot;");
+        break;
+      case '\n':
+        output->append("&#10;");
+        break;
+      case '\r':
+        output->append("&#13;");
+        break;
+      case '\t':
+        output->append("&#9;");
+        break;
+      default:
+        output->push_back(c);
+    }
+  }
+}
+
+void AppendIndent(int level, std::string* output) {
+  output->append(2 * std::min(level, kMaxIndentLevel), ' ');
+}
+
+// Whether the content of |fragment| adds text to the element it is in, after
+// the span of |fragment| itself if it has one.
+bool ContentHasText(const TextFragment& fragment);
+
+bool UsesSpan(const TextFragment& fragment) {
+  return fragment.style.bold || fragment.style.italic ||
+         fragment.style.underline || !fragment.style.color.empty() ||
+         !fragment.style.backgroundColor.empty();
+}
+
+// Whether |fragment| adds text to the element it is converted into.
+bool HasText(const TextFragment& fragment) {
+  return !fragment.newline && !UsesSpan(fragment) && ContentHasText(fragment);
+}
+
+bool ContentHasText(const TextFragment& fragment) {
+  if (!fragment.body.empty())
+    return true;
+  if (!fragment.image.empty())
+    return false;
+  return std::any_of(fragment.sub_fragments.begin(),
+                     fragment.sub_fragments.end(), HasText);
+}
+
 }  // namespace
 
+// Serializes an element directly, byte for byte as libxml2 formats the same
+// tree: child elements go on lines of their own, indented by their level,
+// unless the element has text children, in which case nothing below it is
+// formatted. The children are serialized before the element, so that its
+// attributes can be set until then.
+class TtmlGenerator::XmlElement {
+ public:
+  // |has_text| tells whether text will be added to the element.
+  XmlElement(const char* name, int level, bool format, bool has_text)
+      : name_(name), level_(level), format_(format && !has_text) {}
+
+  // @return a child of this element, which is added with AddChild().
+  XmlElement Child(const char* name, bool has_text) const {
+    return XmlElement(name, level_ + 1, format_, has_text);
+  }
+
+  // Sets an attribute, in place if it is set already.
+  void SetAttribute(const std::string& name, const std::string& value) {
+    for (auto& attribute : attributes_) {
+      if (attribute.first == name) {
+        attribute.second = value;
+        return;
+      }
+    }
+    attributes_.emplace_back(name, value);
+  }
+
+  void AddText(const std::string& text) {
+    DCHECK(!format_);
+    if (text.empty())
+      return;
+    AppendEscapedText(text, &children_);
+    has_children_ = true;
+  }
+
+  void AddChild(const XmlElement& child) {
+    AddSerializedChild(child.ToString());
+  }
+
+  // Adds a child serialized by ToString().
+  void AddSerializedChild(const std::string& child) {
+    if (format_)
+      AppendIndent(level_ + 1, &children_);
+    children_.append(child);
+    if (format_)
+      children_.push_back('\n');
+    has_children_ = true;
+  }
+
+  std::string ToString() const {
+    std::string output = "<";
+    output.append(name_);
+    for (const auto& attribute : attributes_) {
+      output.push_back(' ');
+      output.append(attribute.first);
+      output.append("=\"");
+      AppendEscapedAttribute(attribute.second, &output);
+      output.push_back('"');
+    }
+    if (!has_children_) {
+      output.append("/>");
+      return output;
+    }
+    output.push_back('>');
+    if (format_)
+      output.push_back('\n');
+    output.append(children_);
+    if (format_)
+      AppendIndent(level_, &output);
+    output.append("</");
+    output.append(name_);
+    output.push_back('>');
+    return output;
+  }
+
+ private:
+  const char* const name_;
+  const int level_;
+  // Whether the children are formatted.
+  const bool format_;
+  std::vector<std::pair<std::string, std::string>> attributes_;
+  std::string children_;
+  bool has_children_ = false;
+};
+
 const char* TtmlGenerator::kTtNamespace = "http://www.w3.org/ns/ttml";
 
 TtmlGenerator::TtmlGenerator() {}
@@ -67,6 +238,22 @@ void TtmlGenerator::Initialize(const std::map<std::string, TextRegion>& regions,
     const std::string id = kRegionTeletextPrefix + std::to_string(i);
     regions_.emplace(id, region);
   }
+
+  // The layout only depends on the regions used by each document, so the
+  // regions are serialized once.
+  region_elements_.clear();
+  for (const auto& r : regions_) {
+    const auto origin =
+        ToTtmlSize(r.second.window_anchor_x, r.second.window_anchor_y);
+    const auto extent = ToTtmlSize(r.second.width, r.second.height);
+    // The level does not matter as regions have no children.
+    XmlElement region("region", 0, true, false);
+    region.SetAttribute("xml:id", r.first);
+    region.SetAttribute("tts:origin", origin);
+    region.SetAttribute("tts:extent", extent);
+    region.SetAttribute("tts:overflow", "visible");
+    region_elements_[r.first] = region.ToString();
+  }
 }
 
 void TtmlGenerator::AddSample(const TextSample& sample) {
@@ -78,79 +265,73 @@ void TtmlGenerator::Reset() {
 }
 
 bool TtmlGenerator::Dump(std::string* result) const {
-  xml::XmlNode root("tt");
+  XmlElement root("tt", 0, true, false);
   bool ebuTTDFormat = isEbuTTTD();
-  RCHECK(root.SetStringAttribute("xmlns", kTtNamespace));
-  RCHECK(root.SetStringAttribute("xmlns:tts",
-                                 "http://www.w3.org/ns/ttml#styling"));
-  RCHECK(root.SetStringAttribute("xmlns:tts",
-                                 "http://www.w3.org/ns/ttml#styling"));
-  RCHECK(root.SetStringAttribute("xml:lang", language_));
+  root.SetAttribute("xmlns", kTtNamespace);
+  root.SetAttribute("xmlns:tts", "http://www.w3.org/ns/ttml#styling");
+  root.SetAttribute("xml:lang", language_);
 
   if (ebuTTDFormat) {
-    RCHECK(root.SetStringAttribute("xmlns:ttp",
-                                   "http://www.w3.org/ns/ttml#parameter"));
-    RCHECK(root.SetStringAttribute("xmlns:ttm",
-                                   "http://www.w3.org/ns/ttml#metadata"));
-    RCHECK(root.SetStringAttribute("xmlns:ebuttm", "urn:ebu:tt:metadata"));
-    RCHECK(root.SetStringAttribute("xmlns:ebutts", "urn:ebu:tt:style"));
-    RCHECK(root.SetStringAttribute("xml:space", "default"));
-    RCHECK(root.SetStringAttribute("ttp:timeBase", "media"));
-    RCHECK(root.SetStringAttribute("ttp:cellResolution", "32 15"));
+    root.SetAttribute("xmlns:ttp", "http://www.w3.org/ns/ttml#parameter");
+    root.SetAttribute("xmlns:ttm", "http://www.w3.org/ns/ttml#metadata");
+    root.SetAttribute("xmlns:ebuttm", "urn:ebu:tt:metadata");
+    root.SetAttribute("xmlns:ebutts", "urn:ebu:tt:style");
+    root.SetAttribute("xml:space", "default");
+    root.SetAttribute("ttp:timeBase", "media");
+    root.SetAttribute("ttp:cellResolution", "32 15");
   }
 
-  xml::XmlNode head("head");
-  xml::XmlNode styling("styling");
-  xml::XmlNode metadata("metadata");
-  xml::XmlNode layout("layout");
-  RCHECK(addRegions(layout));
+  XmlElement head = root.Child("head", false);
+  XmlElement styling = head.Child("styling", false);
+  XmlElement metadata = head.Child("metadata", false);
+  XmlElement layout = head.Child("layout", false);
+  addRegions(&layout);
 
-  xml::XmlNode body("body");
+  XmlElement body = root.Child("body", false);
   if (ebuTTDFormat) {
-    RCHECK(body.SetStringAttribute("style", "default"));
+    body.SetAttribute("style", "default");
   }
   size_t image_count = 0;
   std::unordered_set<std::string> fragmentStyles;
-  xml::XmlNode div("div");
+  XmlElement div = body.Child("div", false);
   for (const auto& sample : samples_) {
-    RCHECK(
-        AddSampleToXml(sample, &div, &metadata, fragmentStyles, &image_count));
+    AddSampleToXml(sample, &div, &metadata, fragmentStyles, &image_count);
   }
   if (image_count > 0) {
-    RCHECK(root.SetStringAttribute(
-        "xmlns:smpte", "http://www.smpte-ra.org/schemas/2052-1/2010/smpte-tt"));
+    root.SetAttribute("xmlns:smpte",
+                      "http://www.smpte-ra.org/schemas/2052-1/2010/smpte-tt");
   }
-  RCHECK(body.AddChild(std::move(div)));
-  RCHECK(head.AddChild(std::move(metadata)));
-  RCHECK(addStyling(styling, fragmentStyles));
-  RCHECK(head.AddChild(std::move(styling)));
-  RCHECK(head.AddChild(std::move(layout)));
-  RCHECK(root.AddChild(std::move(head)));
-
-  RCHECK(root.AddChild(std::move(body)));
-
-  *result = root.ToString(/* comment= */ "");
+  body.AddChild(div);
+  head.AddChild(metadata);
+  addStyling(&styling, fragmentStyles);
+  head.AddChild(styling);
+  head.AddChild(layout);
+  root.AddChild(head);
+
+  root.AddChild(body);
+
+  *result = kXmlDeclaration;
+  result->append(root.ToString());
+  result->push_back('\n');
   return true;
 }
 
-bool TtmlGenerator::AddSampleToXml(
+void TtmlGenerator::AddSampleToXml(
     const TextSample& sample,
-    xml::XmlNode* body,
-    xml::XmlNode* metadata,
+    XmlElement* body,
+    XmlElement* metadata,
     std::unordered_set<std::string>& fragmentStyles,
     size_t* image_count) const {
-  xml::XmlNode p("p");
+  XmlElement p = body->Child("p", HasText(sample.body()));
   if (!isEbuTTTD()) {
-    RCHECK(p.SetStringAttribute("xml:space", "preserve"));
+    p.SetAttribute("xml:space", "preserve");
   }
-  RCHECK(p.SetStringAttribute("begin",
-                              ToTtmlTime(sample.start_time(), time_scale_)));
-  RCHECK(
-      p.SetStringAttribute("end", ToTtmlTime(sample.EndTime(), time_scale_)));
-  RCHECK(ConvertFragmentToXml(sample.body(), &p, metadata, fragmentStyles,
-                              image_count));
+  p.SetAttribute("begin", ToTtmlTime(sample.start_time(), time_scale_));
+  p.SetAttribute("end", ToTtmlTime(sample.EndTime(), time_scale_));
+  ConvertFragmentToXml(sample.body(), &p, metadata, fragmentStyles,
+                       image_count);
   if (!sample.id().empty())
-    RCHECK(p.SetStringAttribute("xml:id", sample.id()));
+    p.SetAttribute("xml:id", sample.id());
 
   const auto& settings = sample.settings();
   bool regionFound = false;
@@ -158,7 +339,7 @@ bool TtmlGenerator::AddSampleToXml(
     auto reg = regions_.find(settings.region);
     if (reg != regions_.end()) {
       regionFound = true;
-      RCHECK(p.SetStringAttribute("region", settings.region));
+      p.SetAttribute("region", settings.region);
     }
   }
 
@@ -173,12 +354,12 @@ bool TtmlGenerator::AddSampleToXml(
         settings.height.value_or(TextNumber(100, TextUnitType::kPercent)));
 
     const std::string id = kRegionIdPrefix + std::to_string(region_id_++);
-    xml::XmlNode region("region");
-    RCHECK(region.SetStringAttribute("xml:id", id));
-    RCHECK(region.SetStringAttribute("tts:origin", origin));
-    RCHECK(region.SetStringAttribute("tts:extent", extent));
-    RCHECK(p.SetStringAttribute("region", id));
-    RCHECK(body->AddChild(std::move(region)));
+    XmlElement region = body->Child("region", false);
+    region.SetAttribute("xml:id", id);
+    region.SetAttribute("tts:origin", origin);
+    region.SetAttribute("tts:extent", extent);
+    p.SetAttribute("region", id);
+    body->AddChild(region);
   }
 
   if (settings.writing_direction != WritingDirection::kHorizontal) {
@@ -186,59 +367,54 @@ bool TtmlGenerator::AddSampleToXml(
         settings.writing_direction == WritingDirection::kVerticalGrowingLeft
             ? "tbrl"
             : "tblr";
-    RCHECK(p.SetStringAttribute("tts:writingMode", dir));
+    p.SetAttribute("tts:writingMode", dir);
   }
   if (settings.text_alignment != TextAlignment::kStart) {
     switch (settings.text_alignment) {
       case TextAlignment::kStart:  // To avoid compiler warning.
       case TextAlignment::kCenter:
-        RCHECK(p.SetStringAttribute("tts:textAlign", "center"));
+        p.SetAttribute("tts:textAlign", "center");
         break;
       case TextAlignment::kEnd:
-        RCHECK(p.SetStringAttribute("tts:textAlign", "end"));
+        p.SetAttribute("tts:textAlign", "end");
         break;
       case TextAlignment::kLeft:
-        RCHECK(p.SetStringAttribute("tts:textAlign", "left"));
+        p.SetAttribute("tts:textAlign", "left");
         break;
       case TextAlignment::kRight:
-        RCHECK(p.SetStringAttribute("tts:textAlign", "right"));
+        p.SetAttribute("tts:textAlign", "right");
         break;
     }
   }
 
-  RCHECK(body->AddChild(std::move(p)));
-  return true;
+  body->AddChild(p);
 }
 
-bool TtmlGenerator::ConvertFragmentToXml(
+void TtmlGenerator::ConvertFragmentToXml(
     const TextFragment& body,
-    xml::XmlNode* parent,
-    xml::XmlNode* metadata,
+    XmlElement* parent,
+    XmlElement* metadata,
     std::unordered_set<std::string>& fragmentStyles,
     size_t* image_count) const {
   if (body.newline) {
-    xml::XmlNode br("br");
-    return parent->AddChild(std::move(br));
+    parent->AddChild(parent->Child("br", false));
+    return;
   }
-  xml::XmlNode span("span");
-  xml::XmlNode* node = parent;
-  bool useSpan =
-      (body.style.bold || body.style.italic || body.style.underline ||
-       !body.style.color.empty() || !body.style.backgroundColor.empty());
+  const bool useSpan = UsesSpan(body);
+  XmlElement span = parent->Child("span", useSpan && ContentHasText(body));
+  XmlElement* node = parent;
   if (useSpan) {
     node = &span;
     if (body.style.bold) {
-      RCHECK(span.SetStringAttribute("tts:fontWeight",
-                                     *body.style.bold ? "bold" : "normal"));
+      span.SetAttribute("tts:fontWeight", *body.style.bold ? "bold" : "normal");
     }
     if (body.style.italic) {
-      RCHECK(span.SetStringAttribute("tts:fontStyle",
-                                     *body.style.italic ? "italic" : "normal"));
+      span.SetAttribute("tts:fontStyle",
+                        *body.style.italic ? "italic" : "normal");
     }
     if (body.style.underline) {
-      RCHECK(span.SetStringAttribute(
-          "tts:textDecoration",
-          *body.style.underline ? "underline" : "noUnderline"));
+      span.SetAttribute("tts:textDecoration",
+                        *body.style.underline ? "underline" : "noUnderline");
     }
     std::string color = "white";
     std::string backgroundColor = "black";
@@ -253,36 +429,33 @@ bool TtmlGenerator::ConvertFragmentToXml(
 
     const std::string fragStyle = color + "_" + backgroundColor;
     fragmentStyles.insert(fragStyle);
-    RCHECK(span.SetStringAttribute("style", fragStyle));
+    span.SetAttribute("style", fragStyle);
   }
 
   if (!body.body.empty()) {
-    node->AddContent(body.body);
+    node->AddText(body.body);
   } else if (!body.image.empty()) {
     std::string image_data(body.image.begin(), body.image.end());
     std::string base64_data;
     absl::Base64Escape(image_data, &base64_data);
     std::string id = "img_" + std::to_string(++*image_count);
 
-    xml::XmlNode image_xml("smpte:image");
-    RCHECK(image_xml.SetStringAttribute("imageType", "PNG"));
-    RCHECK(image_xml.SetStringAttribute("encoding", "Base64"));
-    RCHECK(image_xml.SetStringAttribute("xml:id", id));
-    image_xml.SetContent(base64_data);
-    RCHECK(metadata->AddChild(std::move(image_xml)));
+    XmlElement image_xml = metadata->Child("smpte:image", true);
+    image_xml.SetAttribute("imageType", "PNG");
+    image_xml.SetAttribute("encoding", "Base64");
+    image_xml.SetAttribute("xml:id", id);
+    image_xml.AddText(base64_data);
+    metadata->AddChild(image_xml);
 
-    RCHECK(node->SetStringAttribute("smpte:backgroundImage", "#" + id));
+    node->SetAttribute("smpte:backgroundImage", "#" + id);
   } else {
     for (const auto& frag : body.sub_fragments) {
-      if (!ConvertFragmentToXml(frag, node, metadata, fragmentStyles,
-                                image_count))
-        return false;
+      ConvertFragmentToXml(frag, node, metadata, fragmentStyles, image_count);
     }
   }
 
   if (useSpan)
-    RCHECK(parent->AddChild(std::move(span)));
-  return true;
+    parent->AddChild(span);
 }
 
 std::vector<std::string> TtmlGenerator::usedRegions() const {
@@ -295,59 +468,47 @@ std::vector<std::string> TtmlGenerator::usedRegions() const {
   return uRegions;
 }
 
-bool TtmlGenerator::addRegions(xml::XmlNode& layout) const {
+void TtmlGenerator::addRegions(XmlElement* layout) const {
   auto regNames = usedRegions();
-  for (const auto& r : regions_) {
+  for (const auto& r : region_elements_) {
     bool used = false;
     for (const auto& name : regNames) {
       if (r.first == name) {
         used = true;
       }
     }
-    if (used) {
-      xml::XmlNode region("region");
-      const auto origin =
-          ToTtmlSize(r.second.window_anchor_x, r.second.window_anchor_y);
-      const auto extent = ToTtmlSize(r.second.width, r.second.height);
-      RCHECK(region.SetStringAttribute("xml:id", r.first));
-      RCHECK(region.SetStringAttribute("tts:origin", origin));
-      RCHECK(region.SetStringAttribute("tts:extent", extent));
-      RCHECK(region.SetStringAttribute("tts:overflow", "visible"));
-      RCHECK(layout.AddChild(std::move(region)));
-    }
+    if (used)
+      layout->AddSerializedChild(r.second);
   }
-  return true;
 }
 
-bool TtmlGenerator::addStyling(
-    xml::XmlNode& styling,
+void TtmlGenerator::addStyling(
+    XmlElement* styling,
     const std::unordered_set<std::string>& fragmentStyles) const {
   if (fragmentStyles.empty()) {
-    return true;
+    return;
   }
   // Add default style
-  xml::XmlNode defaultStyle("style");
-  RCHECK(defaultStyle.SetStringAttribute("xml:id", "default"));
-  RCHECK(defaultStyle.SetStringAttribute("tts:fontStyle", "normal"));
-  RCHECK(defaultStyle.SetStringAttribute("tts:fontFamily", "sansSerif"));
-  RCHECK(defaultStyle.SetStringAttribute("tts:fontSize", "100%"));
-  RCHECK(defaultStyle.SetStringAttribute("tts:lineHeight", "normal"));
-  RCHECK(defaultStyle.SetStringAttribute("tts:textAlign", "center"));
-  RCHECK(defaultStyle.SetStringAttribute("ebutts:linePadding", "0.5c"));
-  RCHECK(styling.AddChild(std::move(defaultStyle)));
+  XmlElement defaultStyle = styling->Child("style", false);
+  defaultStyle.SetAttribute("xml:id", "default");
+  defaultStyle.SetAttribute("tts:fontStyle", "normal");
+  defaultStyle.SetAttribute("tts:fontFamily", "sansSerif");
+  defaultStyle.SetAttribute("tts:fontSize", "100%");
+  defaultStyle.SetAttribute("tts:lineHeight", "normal");
+  defaultStyle.SetAttribute("tts:textAlign", "center");
+  defaultStyle.SetAttribute("ebutts:linePadding", "0.5c");
+  styling->AddChild(defaultStyle);
 
   for (const auto& name : fragmentStyles) {
     auto pos = name.find('_');
     auto color = name.substr(0, pos);
     auto backgroundColor = name.substr(pos + 1, name.size());
-    xml::XmlNode fragStyle("style");
-    RCHECK(fragStyle.SetStringAttribute("xml:id", name));
-    RCHECK(
-        fragStyle.SetStringAttribute("tts:backgroundColor", backgroundColor));
-    RCHECK(fragStyle.SetStringAttribute("tts:color", color));
-    RCHECK(styling.AddChild(std::move(fragStyle)));
+    XmlElement fragStyle = styling->Child("style", false);
+    fragStyle.SetAttribute("xml:id", name);
+    fragStyle.SetAttribute("tts:backgroundColor", backgroundColor);
+    fragStyle.SetAttribute("tts:color", color);
+    styling->AddChild(fragStyle);
   }
-  return true;
 }
 
 bool TtmlGenerator::isEbuTTTD() const {
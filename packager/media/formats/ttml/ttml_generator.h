@@ -14,7 +14,6 @@
 
 #include <packager/media/base/text_sample.h>
 #include <packager/media/base/text_stream_info.h>
-#include <packager/mpd/base/xml/xml_node.h>
 
 namespace shaka {
 namespace media {
@@ -36,25 +35,30 @@ class TtmlGenerator {
   bool Dump(std::string* result) const;
 
  private:
-  bool AddSampleToXml(const TextSample& sample,
-                      xml::XmlNode* body,
-                      xml::XmlNode* metadata,
+  class XmlElement;
+
+  void AddSampleToXml(const TextSample& sample,
+                      XmlElement* body,
+                      XmlElement* metadata,
                       std::unordered_set<std::string>& fragmentStyles,
                       size_t* image_count) const;
-  bool ConvertFragmentToXml(const TextFragment& fragment,
-                            xml::XmlNode* parent,
-                            xml::XmlNode* metadata,
+  void ConvertFragmentToXml(const TextFragment& fragment,
+                            XmlElement* parent,
+                            XmlElement* metadata,
                             std::unordered_set<std::string>& fragmentStyles,
                             size_t* image_count) const;
 
-  bool addStyling(xml::XmlNode& styling,
+  void addStyling(XmlElement* styling,
                   const std::unordered_set<std::string>& fragmentStyles) const;
-  bool addRegions(xml::XmlNode& layout) const;
+  void addRegions(XmlElement* layout) const;
   std::vector<std::string> usedRegions() const;
   bool isEbuTTTD() const;
 
   std::list<TextSample> samples_;
   std::map<std::string, TextRegion> regions_;
+  // The serialized region elements of |regions_|, which are the same for all
+  // the documents of the stream.
+  std::map<std::string, std::string> region_elements_;
   std::string language_;
   int32_t time_scale_;
   // This is modified in "const" methods to create unique IDs.
@@ -0,0 +1,150 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/formats/webm/cluster_writer.h>
+
+#include <absl/log/check.h>
+#include <common/webmids.h>
+#include <mkvmuxer/mkvmuxerutil.h>
+
+#include <packager/media/formats/webm/mkv_writer.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+// The size of the cluster is written on 8 bytes, so that it can be filled in
+// once the cluster is complete. Until then, it is "unknown".
+const int32_t kClusterSizeBytes = 8;
+const uint64_t kUnknownClusterSize = 0x01FFFFFFFFFFFFFFULL;
+// The largest timecode of a block relative to its cluster.
+const int64_t kMaxBlockTimecode = 0x7FFF;
+// ID, size, track number, timecode and flags.
+const size_t kMaxSimpleBlockHeaderSize = 1 + 8 + 8 + 2 + 1;
+
+// Serializes |value| to |buf| as an EBML coded integer of the smallest size,
+// like mkvmuxer::WriteUInt() does.
+// Returns the number of bytes written.
+size_t SerializeCodedUInt(uint64_t value, uint8_t* buf) {
+  const int32_t size = mkvmuxer::GetCodedUIntSize(value);
+  value |= UINT64_C(1) << (size * 7);
+  for (int32_t i = 0; i < size; ++i)
+    buf[i] = static_cast<uint8_t>(value >> ((size - 1 - i) * 8));
+  return size;
+}
+
+}  // namespace
+
+ClusterWriter::ClusterWriter(uint64_t timecode,
+                             uint64_t timecode_scale,
+                             MkvWriter* writer)
+    : timecode_(timecode),
+      timecode_scale_(timecode_scale),
+      writer_(writer),
+      block_group_context_(timecode, 0, timecode_scale) {
+  DCHECK(writer_);
+}
+
+ClusterWriter::~ClusterWriter() {}
+
+bool ClusterWriter::AddSimpleBlock(uint64_t track_number,
+                                   int64_t relative_timecode,
+                                   bool is_key_frame,
+                                   const uint8_t* prefix,
+                                   size_t prefix_size,
+                                   const uint8_t* data,
+                                   size_t data_size) {
+  DCHECK(!finalized_);
+  if (!data || data_size == 0 || track_number == 0 ||
+      track_number > mkvmuxer::kMaxTrackNumber ||
+      relative_timecode < 0 || relative_timecode > kMaxBlockTimecode) {
+    return false;
+  }
+  if (!WriteHeaderIfNeeded())
+    return false;
+
+  const uint64_t block_size = mkvmuxer::GetCodedUIntSize(track_number) + 2 +
+                              1 + prefix_size + data_size;
+  uint8_t header[kMaxSimpleBlockHeaderSize];
+  size_t header_size = 0;
+  header[header_size++] = static_cast<uint8_t>(libwebm::kMkvSimpleBlock);
+  header_size += SerializeCodedUInt(block_size, header + header_size);
+  header_size += SerializeCodedUInt(track_number, header + header_size);
+  header[header_size++] = static_cast<uint8_t>(relative_timecode >> 8);
+  header[header_size++] = static_cast<uint8_t>(relative_timecode);
+  header[header_size++] = is_key_frame ? 0x80 : 0;
+
+  // The payload is written from the sample, without an intermediate copy.
+  if (writer_->Write(header, static_cast<uint32_t>(header_size)) ||
+      (prefix_size > 0 &&
+       writer_->Write(prefix, static_cast<uint32_t>(prefix_size))) ||
+      writer_->Write(data, static_cast<uint32_t>(data_size))) {
+    return false;
+  }
+  payload_size_ += header_size + prefix_size + data_size;
+  return true;
+}
+
+bool ClusterWriter::AddFrame(const mkvmuxer::Frame& frame) {
+  DCHECK(!finalized_);
+  if (!frame.IsValid() || !WriteHeaderIfNeeded())
+    return false;
+  const uint64_t element_size =
+      mkvmuxer::WriteFrame(writer_, &frame, &block_group_context_);
+  if (element_size == 0)
+    return false;
+  payload_size_ += element_size;
+  return true;
+}
+
+bool ClusterWriter::Finalize() {
+  if (finalized_ || size_position_ == -1)
+    return false;
+
+  if (writer_->Seekable()) {
+    const int64_t position = writer_->Position();
+    if (writer_->Position(size_position_) ||
+        mkvmuxer::WriteUIntSize(writer_, payload_size_, kClusterSizeBytes) ||
+        writer_->Position(position)) {
+      return false;
+    }
+  }
+  finalized_ = true;
+  return true;
+}
+
+uint64_t ClusterWriter::Size() const {
+  return mkvmuxer::GetUIntSize(libwebm::kMkvCluster) + kClusterSizeBytes +
+         payload_size_;
+}
+
+int64_t ClusterWriter::GetRelativeTimecode(int64_t abs_timecode) const {
+  const int64_t relative_timecode =
+      abs_timecode - static_cast<int64_t>(timecode_);
+  if (relative_timecode < 0 || relative_timecode > kMaxBlockTimecode)
+    return -1;
+  return relative_timecode;
+}
+
+bool ClusterWriter::WriteHeaderIfNeeded() {
+  if (size_position_ != -1)
+    return true;
+
+  if (mkvmuxer::WriteID(writer_, libwebm::kMkvCluster))
+    return false;
+  const int64_t size_position = writer_->Position();
+  if (mkvmuxer::SerializeInt(writer_, kUnknownClusterSize,
+                             kClusterSizeBytes) ||
+      !mkvmuxer::WriteEbmlElement(writer_, libwebm::kMkvTimecode, timecode_)) {
+    return false;
+  }
+  payload_size_ += mkvmuxer::EbmlElementSize(libwebm::kMkvTimecode, timecode_);
+  size_position_ = size_position;
+  return true;
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,90 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_FORMATS_WEBM_CLUSTER_WRITER_H_
+#define PACKAGER_MEDIA_FORMATS_WEBM_CLUSTER_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <mkvmuxer/mkvmuxer.h>
+
+#include <packager/macros/classes.h>
+
+namespace shaka {
+namespace media {
+
+class MkvWriter;
+
+/// Writes a Cluster element to the output stream, block by block. Unlike
+/// mkvmuxer::Cluster, SimpleBlocks are written straight from the sample data:
+/// the block header is serialized on its own and the payload is handed to the
+/// writer as is, without first being copied into a mkvmuxer::Frame.
+class ClusterWriter {
+ public:
+  /// @param timecode is the timecode of the cluster, in WebM timecode units.
+  /// @param timecode_scale is the timecode scale of the segment.
+  /// @param writer is where the cluster is written. Must outlive this object.
+  ClusterWriter(uint64_t timecode, uint64_t timecode_scale, MkvWriter* writer);
+  ~ClusterWriter();
+
+  /// Writes a SimpleBlock with the given payload.
+  /// @param relative_timecode is the timecode of the block relative to the
+  ///        cluster, as returned by GetRelativeTimecode().
+  /// @param prefix points to @a prefix_size bytes written before @a data in
+  ///        the payload, e.g. the signal byte and the encryption info of an
+  ///        encrypted frame. It can be null if @a prefix_size is 0.
+  /// @return true on success.
+  bool AddSimpleBlock(uint64_t track_number,
+                      int64_t relative_timecode,
+                      bool is_key_frame,
+                      const uint8_t* prefix,
+                      size_t prefix_size,
+                      const uint8_t* data,
+                      size_t data_size);
+  /// Writes a frame which may need a BlockGroup, e.g. because it has a
+  /// duration or additional data.
+  /// @return true on success.
+  bool AddFrame(const mkvmuxer::Frame& frame);
+
+  /// Writes the size of the cluster, if the writer is seekable. Must be called
+  /// after adding the last block.
+  /// @return true on success.
+  bool Finalize();
+
+  /// @return The size of the cluster written so far, header included.
+  uint64_t Size() const;
+  /// @return The timecode of @a abs_timecode relative to the cluster, or -1
+  ///         if it does not fit in a block.
+  int64_t GetRelativeTimecode(int64_t abs_timecode) const;
+
+  uint64_t timecode() const { return timecode_; }
+  uint64_t timecode_scale() const { return timecode_scale_; }
+
+ private:
+  bool WriteHeaderIfNeeded();
+
+  const uint64_t timecode_;
+  const uint64_t timecode_scale_;
+  MkvWriter* const writer_;
+  // Only provides the timecodes to mkvmuxer::WriteFrame(), which writes the
+  // frames added with AddFrame(). It is never initialized, so it does not
+  // write anything itself.
+  mkvmuxer::Cluster block_group_context_;
+
+  // The position of the size of the cluster, or -1 before the header is
+  // written.
+  int64_t size_position_ = -1;
+  uint64_t payload_size_ = 0;
+  bool finalized_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(ClusterWriter);
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_FORMATS_WEBM_CLUSTER_WRITER_H_
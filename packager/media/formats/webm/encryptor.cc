@@ -98,14 +98,20 @@ Status UpdateTrackForEncryption(const std::vector<uint8_t>& key_id,
   return Status::OK;
 }
 
+void WriteFrameEncryptionHeader(const MediaSample& sample,
+                                BufferWriter* header) {
+  DCHECK(header);
+  WriteEncryptedFrameHeader(sample.decrypt_config(), header);
+}
+
 void UpdateFrameForEncryption(MediaSample* sample) {
   DCHECK(sample);
   BufferWriter header_buffer;
-  WriteEncryptedFrameHeader(sample->decrypt_config(), &header_buffer);
+  WriteFrameEncryptionHeader(*sample, &header_buffer);
 
   const size_t sample_size = header_buffer.Size() + sample->data_size();
-  std::shared_ptr<uint8_t> new_sample_data(new uint8_t[sample_size],
-                                           std::default_delete<uint8_t[]>());
+  std::shared_ptr<uint8_t> new_sample_data =
+      MediaSample::AllocateData(sample_size);
   memcpy(new_sample_data.get(), header_buffer.Buffer(), header_buffer.Size());
   memcpy(&new_sample_data.get()[header_buffer.Size()], sample->data(),
          sample->data_size());
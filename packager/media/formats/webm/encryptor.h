@@ -16,6 +16,7 @@
 namespace shaka {
 namespace media {
 
+class BufferWriter;
 class MediaSample;
 
 namespace webm {
@@ -25,8 +26,15 @@ namespace webm {
 Status UpdateTrackForEncryption(const std::vector<uint8_t>& key_id,
                                 mkvmuxer::Track* track);
 
+/// Write the signal byte, and the encryption information if it is encrypted,
+/// which precede the frame data of @a sample in the block of a track with
+/// encryption.
+void WriteFrameEncryptionHeader(const MediaSample& sample,
+                                BufferWriter* header);
+
 /// Update the frame with signal bytes and encryption information if it is
-/// encrypted.
+/// encrypted. The frame data is copied; prefer writing the header of
+/// WriteFrameEncryptionHeader() before the frame data.
 void UpdateFrameForEncryption(MediaSample* sample);
 
 }  // namespace webm
@@ -10,6 +10,7 @@
 
 #include <gtest/gtest.h>
 
+#include <packager/media/base/buffer_writer.h>
 #include <packager/media/base/media_sample.h>
 #include <packager/media/formats/webm/webm_constants.h>
 #include <packager/status/status_test_util.h>
@@ -57,6 +58,16 @@ TEST(EncryptionUtilTest, SampleNotEncrypted) {
                                  sample->data() + sample->data_size()));
 }
 
+TEST(EncryptionUtilTest, FrameEncryptionHeaderNotEncrypted) {
+  auto sample = MediaSample::CopyFrom(kData, sizeof(kData), kKeyFrame);
+  BufferWriter header;
+  WriteFrameEncryptionHeader(*sample, &header);
+  ASSERT_EQ(1u, header.Size());
+  EXPECT_EQ(0u, header.Buffer()[0]);
+  // The frame data is left as is.
+  EXPECT_EQ(sizeof(kData), sample->data_size());
+}
+
 namespace {
 
 const SubsampleEntry kSubsamples1[] = {
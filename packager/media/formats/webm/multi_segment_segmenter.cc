@@ -36,9 +36,8 @@ Status MultiSegmentSegmenter::FinalizeSegment(int64_t start_timestamp,
     return Status(error::FILE_FAILURE, "Error finalizing segment.");
 
   if (!is_subsegment) {
-    std::string segment_name =
-        GetSegmentName(options().segment_template, start_timestamp,
-                       segment_number, options().bandwidth);
+    std::string segment_name = segment_template().GetSegmentName(
+        start_timestamp, segment_number, options().bandwidth);
 
     // Close the file, which also does flushing, to make sure the file is
     // written before manifest is updated.
@@ -93,9 +92,8 @@ Status MultiSegmentSegmenter::NewSegment(int64_t start_timestamp,
                                          bool is_subsegment) {
   if (!is_subsegment) {
     temp_file_name_ =
-        "memory://" + GetSegmentName(options().segment_template,
-                                     start_timestamp, num_segment_,
-                                     options().bandwidth);
+        "memory://" + segment_template().GetSegmentName(
+                          start_timestamp, num_segment_, options().bandwidth);
 
     writer_.reset(new MkvWriter);
     Status status = writer_->Open(temp_file_name_);
@@ -0,0 +1,147 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/formats/webm/one_pass_single_segment_segmenter.h>
+
+#include <algorithm>
+#include <memory>
+
+#include <absl/log/log.h>
+#include <common/webmids.h>
+#include <mkvmuxer/mkvmuxer.h>
+#include <mkvmuxer/mkvmuxerutil.h>
+
+#include <packager/macros/logging.h>
+#include <packager/media/base/muxer_options.h>
+#include <packager/media/formats/webm/mkv_writer.h>
+
+namespace shaka {
+namespace media {
+namespace webm {
+namespace {
+
+// Clusters start on key frames, so the estimate assumes at most one cluster
+// per second of media; WebM timecodes are in milliseconds.
+const int64_t kEstimatedClusterDurationTimecode = 1000;
+// Cluster position used to estimate the size of a CuePoint; positions below
+// 1TB take at most this many bytes.
+const uint64_t kEstimatedMaxClusterPosition = (1ULL << 40) - 1;
+// The smallest Void element is an ID and a one byte size.
+const uint64_t kMinVoidSize = 2;
+// The largest Void element which can use a one byte size.
+const uint64_t kMaxSmallVoidSize = 128;
+
+// Writes a Void element which takes exactly |size| bytes, which must be at
+// least kMinVoidSize.  Unlike mkvmuxer::WriteVoidElement, this works for any
+// size.
+bool WriteVoid(mkvmuxer::IMkvWriter* writer, uint64_t size) {
+  const int32_t size_size = size > kMaxSmallVoidSize ? 8 : 1;
+  if (mkvmuxer::WriteID(writer, libwebm::kMkvVoid) != 0)
+    return false;
+  uint64_t payload_size = size - mkvmuxer::GetUIntSize(libwebm::kMkvVoid) -
+                          size_size;
+  if (mkvmuxer::WriteUIntSize(writer, payload_size, size_size) != 0)
+    return false;
+
+  static const uint8_t kZeros[4096] = {};
+  while (payload_size > 0) {
+    const uint32_t chunk_size = static_cast<uint32_t>(
+        std::min<uint64_t>(payload_size, sizeof(kZeros)));
+    if (writer->Write(kZeros, chunk_size) != 0)
+      return false;
+    payload_size -= chunk_size;
+  }
+  return true;
+}
+
+}  // namespace
+
+OnePassSingleSegmentSegmenter::OnePassSingleSegmentSegmenter(
+    const MuxerOptions& options)
+    : SingleSegmentSegmenter(options) {}
+
+OnePassSingleSegmentSegmenter::~OnePassSingleSegmentSegmenter() {}
+
+Status OnePassSingleSegmentSegmenter::DoInitialize() {
+  std::unique_ptr<MkvWriter> mkv_writer(new MkvWriter);
+  Status status = mkv_writer->Open(options().output_file_name);
+  if (!status.ok())
+    return status;
+  if (!mkv_writer->Seekable()) {
+    return Status(error::FILE_FAILURE,
+                  "One-pass WebM output requires a seekable output file.");
+  }
+  set_writer(std::move(mkv_writer));
+
+  status = SingleSegmentSegmenter::DoInitialize();
+  if (!status.ok())
+    return status;
+
+  cues_reserve_start_ = writer()->Position();
+  cues_reserve_size_ = EstimateCuesSize();
+  if (cues_reserve_size_ > 0 &&
+      !WriteVoid(writer(), cues_reserve_size_)) {
+    return Status(error::FILE_FAILURE, "Error reserving space for Cues.");
+  }
+  seek_head()->set_cluster_pos(writer()->Position() -
+                               segment_payload_pos());
+  return Status::OK;
+}
+
+Status OnePassSingleSegmentSegmenter::DoFinalize() {
+  const uint64_t clusters_end = writer()->Position();
+  const uint64_t cues_size = cues()->Size();
+  // What is left of the reserved space after the Cues must fit a Void
+  // element.
+  const bool cues_fit = cues_size == cues_reserve_size_ ||
+                        cues_size + kMinVoidSize <= cues_reserve_size_;
+  uint64_t file_size = clusters_end;
+  if (cues_fit) {
+    if (writer()->Position(cues_reserve_start_) != 0)
+      return Status(error::FILE_FAILURE, "Error seeking to the Cues.");
+  } else {
+    VLOG(1) << "Reserved " << cues_reserve_size_ << " bytes for "
+            << cues_size << " bytes of Cues; writing them after the clusters.";
+    file_size += cues_size;
+  }
+
+  const uint64_t index_start = writer()->Position();
+  set_index_start(index_start);
+  seek_head()->set_cues_pos(index_start - segment_payload_pos());
+  if (!cues()->Write(writer()))
+    return Status(error::FILE_FAILURE, "Error writing Cues data.");
+  set_index_end(writer()->Position() - 1);
+
+  if (cues_fit && cues_size < cues_reserve_size_ &&
+      !WriteVoid(writer(), cues_reserve_size_ - cues_size)) {
+    return Status(error::FILE_FAILURE, "Error writing Void element.");
+  }
+
+  writer()->Position(0);
+  Status status = WriteSegmentHeader(file_size, writer());
+  status.Update(writer()->Close());
+  return status;
+}
+
+uint64_t OnePassSingleSegmentSegmenter::EstimateCuesSize() {
+  const int64_t duration_timecode = FromBmffTimestamp(duration());
+  if (duration_timecode <= 0)
+    return 0;
+  const uint64_t num_cue_points =
+      duration_timecode / kEstimatedClusterDurationTimecode + 1;
+
+  mkvmuxer::CuePoint cue_point;
+  cue_point.set_time(duration_timecode);
+  cue_point.set_track(track_id());
+  cue_point.set_cluster_pos(kEstimatedMaxClusterPosition);
+  const uint64_t payload_size = num_cue_points * cue_point.Size();
+  return mkvmuxer::EbmlMasterElementSize(libwebm::kMkvCues, payload_size) +
+         payload_size;
+}
+
+}  // namespace webm
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,53 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_FORMATS_WEBM_ONE_PASS_SINGLE_SEGMENT_SEGMENTER_H_
+#define PACKAGER_MEDIA_FORMATS_WEBM_ONE_PASS_SINGLE_SEGMENT_SEGMENTER_H_
+
+#include <cstdint>
+
+#include <packager/macros/classes.h>
+#include <packager/media/formats/webm/single_segment_segmenter.h>
+#include <packager/status.h>
+
+namespace shaka {
+namespace media {
+
+struct MuxerOptions;
+
+namespace webm {
+
+/// An implementation of a Segmenter for a single-segment that writes the
+/// output in one pass.  Space for the Cues is reserved with a Void element
+/// right after the header, based on the stream duration; the Cues are written
+/// there once the clusters are done and the rest of the reserved space stays
+/// a Void element.  If the Cues do not fit, they are written to the end of the
+/// file instead.  This requires the output file to be seekable.
+class OnePassSingleSegmentSegmenter : public SingleSegmentSegmenter {
+ public:
+  explicit OnePassSingleSegmentSegmenter(const MuxerOptions& options);
+  ~OnePassSingleSegmentSegmenter() override;
+
+ protected:
+  // Segmenter implementation overrides.
+  Status DoInitialize() override;
+  Status DoFinalize() override;
+
+ private:
+  // Returns the number of bytes to reserve for the Cues.
+  uint64_t EstimateCuesSize();
+
+  uint64_t cues_reserve_start_ = 0;
+  uint64_t cues_reserve_size_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(OnePassSingleSegmentSegmenter);
+};
+
+}  // namespace webm
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_FORMATS_WEBM_ONE_PASS_SINGLE_SEGMENT_SEGMENTER_H_
@@ -0,0 +1,96 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/formats/webm/one_pass_single_segment_segmenter.h>
+
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include <packager/media/formats/webm/segmenter_test_base.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const int32_t kTimeScale = 1000000;
+// One second per sample.
+const int64_t kDuration = 1000000;
+const bool kSubsegment = true;
+
+}  // namespace
+
+class OnePassSingleSegmentSegmenterTest : public SegmentTestBase {
+ public:
+  OnePassSingleSegmentSegmenterTest()
+      : info_(CreateVideoStreamInfo(kTimeScale)) {}
+
+ protected:
+  void InitializeSegmenter(const MuxerOptions& options) {
+    ASSERT_NO_FATAL_FAILURE(
+        CreateAndInitializeSegmenter<webm::OnePassSingleSegmentSegmenter>(
+            options, *info_, &segmenter_));
+  }
+
+  // Adds |num_segments| segments of |samples_per_segment| key frames each.
+  void AddSegments(int num_segments, int samples_per_segment) {
+    for (int i = 0; i < num_segments; ++i) {
+      for (int j = 0; j < samples_per_segment; ++j) {
+        std::shared_ptr<MediaSample> sample =
+            CreateSample(kKeyFrame, kDuration, kNoSideData);
+        ASSERT_OK(segmenter_->AddSample(*sample));
+      }
+      ASSERT_OK(segmenter_->FinalizeSegment(
+          i * samples_per_segment * kDuration, samples_per_segment * kDuration,
+          !kSubsegment, i + 1));
+    }
+  }
+
+  std::shared_ptr<StreamInfo> info_;
+  std::unique_ptr<webm::Segmenter> segmenter_;
+};
+
+TEST_F(OnePassSingleSegmentSegmenterTest, WritesCuesBeforeClusters) {
+  MuxerOptions options = CreateMuxerOptions();
+  ASSERT_NO_FATAL_FAILURE(InitializeSegmenter(options));
+  ASSERT_NO_FATAL_FAILURE(AddSegments(2, 4));
+  ASSERT_OK(segmenter_->Finalize());
+
+  ClusterParser parser;
+  ASSERT_NO_FATAL_FAILURE(parser.PopulateFromSegment(OutputFileName()));
+  ASSERT_EQ(2u, parser.cluster_count());
+  EXPECT_EQ(4u, parser.GetFrameCountForCluster(0));
+  EXPECT_EQ(4u, parser.GetFrameCountForCluster(1));
+
+  uint64_t init_start, init_end, index_start, index_end;
+  ASSERT_TRUE(segmenter_->GetInitRangeStartAndEnd(&init_start, &init_end));
+  ASSERT_TRUE(segmenter_->GetIndexRangeStartAndEnd(&index_start, &index_end));
+  EXPECT_EQ(init_end + 1, index_start);
+  const std::vector<Range> ranges = segmenter_->GetSegmentRanges();
+  ASSERT_EQ(2u, ranges.size());
+  EXPECT_LT(index_end, ranges[0].start);
+}
+
+TEST_F(OnePassSingleSegmentSegmenterTest, WritesCuesAtEndIfTheyDoNotFit) {
+  MuxerOptions options = CreateMuxerOptions();
+  ASSERT_NO_FATAL_FAILURE(InitializeSegmenter(options));
+  // The stream info claims 8 seconds, but there are 16 one second clusters.
+  ASSERT_NO_FATAL_FAILURE(AddSegments(16, 1));
+  ASSERT_OK(segmenter_->Finalize());
+
+  ClusterParser parser;
+  ASSERT_NO_FATAL_FAILURE(parser.PopulateFromSegment(OutputFileName()));
+  ASSERT_EQ(16u, parser.cluster_count());
+
+  uint64_t index_start, index_end;
+  ASSERT_TRUE(segmenter_->GetIndexRangeStartAndEnd(&index_start, &index_end));
+  const std::vector<Range> ranges = segmenter_->GetSegmentRanges();
+  ASSERT_EQ(16u, ranges.size());
+  EXPECT_EQ(ranges.back().end + 1, index_start);
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -69,7 +69,8 @@ int64_t WebMTimecodeToNs(int64_t timecode, int64_t timecode_scale) {
 
 }  // namespace
 
-Segmenter::Segmenter(const MuxerOptions& options) : options_(options) {}
+Segmenter::Segmenter(const MuxerOptions& options)
+    : options_(options), segment_template_(options.segment_template) {}
 
 Segmenter::~Segmenter() {}
 
@@ -187,8 +188,12 @@ Status Segmenter::AddSample(const MediaSample& source_sample) {
   if (!status.ok())
     return status;
 
-  if (is_encrypted_)
-    UpdateFrameForEncryption(sample.get());
+  // The header of an encrypted frame is written before its data when the
+  // frame is written, so that the data is not copied to prepend it.
+  if (is_encrypted_) {
+    frame_header_.Clear();
+    WriteFrameEncryptionHeader(*sample, &frame_header_);
+  }
 
   new_subsegment_ = false;
   new_segment_ = false;
@@ -267,8 +272,7 @@ Status Segmenter::SetCluster(int64_t start_webm_timecode,
                              uint64_t position,
                              MkvWriter* writer) {
   const int64_t scale = segment_info_.timecode_scale();
-  cluster_.reset(new mkvmuxer::Cluster(start_webm_timecode, position, scale));
-  cluster_->Init(writer);
+  cluster_.reset(new ClusterWriter(start_webm_timecode, scale, writer));
   return Status::OK;
 }
 
@@ -377,12 +381,62 @@ Status Segmenter::InitializeAudioTrack(const AudioStreamInfo& info,
 }
 
 Status Segmenter::WriteFrame(bool write_duration) {
+  const int64_t timestamp_ns =
+      BmffTimestampToNs(prev_sample_->pts(), time_scale_);
+
+  // GetRelativeTimecode will return -1 if the relative timecode is too large
+  // to fit in the frame.
+  const int64_t relative_timecode = cluster_->GetRelativeTimecode(
+      NsToWebMTimecode(timestamp_ns, cluster_->timecode_scale()));
+  if (relative_timecode < 0) {
+    const double segment_duration =
+        static_cast<double>(timestamp_ns -
+                            WebMTimecodeToNs(cluster_->timecode(),
+                                             cluster_->timecode_scale())) /
+        kSecondsToNs;
+    LOG(ERROR) << "Error adding sample to segment: segment too large, "
+               << segment_duration
+               << " seconds. Please check your GOP size and segment duration.";
+    return Status(error::MUXER_FAILURE,
+                  "Error adding sample to segment: segment too large");
+  }
+
+  // A reference frame is needed for non-keyframes.  Having a reference to the
+  // previous block is good enough.
+  // See libwebm Segment::AddGenericFrame
+  const int64_t reference_frame_timestamp = reference_frame_timestamp_;
+  reference_frame_timestamp_ = prev_sample_->pts();
+
+  // Most frames are SimpleBlocks, which are written straight from the sample.
+  if (!write_duration && prev_sample_->side_data_size() == 0) {
+    if (!cluster_->AddSimpleBlock(
+            track_id_, relative_timecode, prev_sample_->is_key_frame(),
+            frame_header_.Buffer(), frame_header_.Size(),
+            prev_sample_->data(), prev_sample_->data_size())) {
+      return Status(
+          error::MUXER_FAILURE,
+          "Error adding sample to segment: Cluster::AddSimpleBlock failed");
+    }
+    return Status::OK;
+  }
+
   // Create a frame manually so we can create non-SimpleBlock frames.  This
-  // is required to allow the frame duration to be added.  If the duration
-  // is not set, then a SimpleBlock will still be written.
+  // is required to allow the frame duration to be added.
   mkvmuxer::Frame frame;
 
-  if (!frame.Init(prev_sample_->data(), prev_sample_->data_size())) {
+  // mkvmuxer::Frame keeps a copy of the data, so the header is prepended in a
+  // reused buffer.
+  const uint8_t* frame_data = prev_sample_->data();
+  size_t frame_data_size = prev_sample_->data_size();
+  if (frame_header_.Size() > 0) {
+    frame_buffer_.assign(frame_header_.Buffer(),
+                         frame_header_.Buffer() + frame_header_.Size());
+    frame_buffer_.insert(frame_buffer_.end(), frame_data,
+                         frame_data + frame_data_size);
+    frame_data = frame_buffer_.data();
+    frame_data_size = frame_buffer_.size();
+  }
+  if (!frame.Init(frame_data, frame_data_size)) {
     return Status(error::MUXER_FAILURE,
                   "Error adding sample to segment: Frame::Init failed");
   }
@@ -392,8 +446,7 @@ Status Segmenter::WriteFrame(bool write_duration) {
         BmffTimestampToNs(prev_sample_->duration(), time_scale_));
   }
   frame.set_is_key(prev_sample_->is_key_frame());
-  frame.set_timestamp(
-      BmffTimestampToNs(prev_sample_->pts(), time_scale_));
+  frame.set_timestamp(timestamp_ns);
   frame.set_track_number(track_id_);
 
   if (prev_sample_->side_data_size() > 0) {
@@ -414,34 +467,13 @@ Status Segmenter::WriteFrame(bool write_duration) {
 
   if (!prev_sample_->is_key_frame() && !frame.CanBeSimpleBlock()) {
     frame.set_reference_block_timestamp(
-        BmffTimestampToNs(reference_frame_timestamp_, time_scale_));
-  }
-
-  // GetRelativeTimecode will return -1 if the relative timecode is too large
-  // to fit in the frame.
-  if (cluster_->GetRelativeTimecode(NsToWebMTimecode(
-          frame.timestamp(), cluster_->timecode_scale())) < 0) {
-    const double segment_duration =
-        static_cast<double>(frame.timestamp() -
-                            WebMTimecodeToNs(cluster_->timecode(),
-                                             cluster_->timecode_scale())) /
-        kSecondsToNs;
-    LOG(ERROR) << "Error adding sample to segment: segment too large, "
-               << segment_duration
-               << " seconds. Please check your GOP size and segment duration.";
-    return Status(error::MUXER_FAILURE,
-                  "Error adding sample to segment: segment too large");
+        BmffTimestampToNs(reference_frame_timestamp, time_scale_));
   }
 
-  if (!cluster_->AddFrame(&frame)) {
+  if (!cluster_->AddFrame(frame)) {
     return Status(error::MUXER_FAILURE,
                   "Error adding sample to segment: Cluster::AddFrame failed");
   }
-
-  // A reference frame is needed for non-keyframes.  Having a reference to the
-  // previous block is good enough.
-  // See libwebm Segment::AddGenericFrame
-  reference_frame_timestamp_ = prev_sample_->pts();
   return Status::OK;
 }
 
@@ -8,11 +8,15 @@
 #define PACKAGER_MEDIA_FORMATS_WEBM_SEGMENTER_H_
 
 #include <memory>
+#include <vector>
 
 #include <mkvmuxer/mkvmuxer.h>
 
 #include <packager/macros/classes.h>
+#include <packager/media/base/buffer_writer.h>
+#include <packager/media/base/muxer_util.h>
 #include <packager/media/base/range.h>
+#include <packager/media/formats/webm/cluster_writer.h>
 #include <packager/media/formats/webm/mkv_writer.h>
 #include <packager/media/formats/webm/seek_head.h>
 #include <packager/status.h>
@@ -84,7 +88,7 @@ class Segmenter {
   int64_t FromWebMTimecode(int64_t webm_timecode);
   /// Writes the Segment header to @a writer.
   Status WriteSegmentHeader(uint64_t file_size, MkvWriter* writer);
-  /// Creates a Cluster object with the given parameters.
+  /// Creates a ClusterWriter with the given parameters.
   Status SetCluster(int64_t start_webm_timecode,
                     uint64_t position,
                     MkvWriter* writer);
@@ -94,7 +98,9 @@ class Segmenter {
   void set_progress_target(uint64_t target) { progress_target_ = target; }
 
   const MuxerOptions& options() const { return options_; }
-  mkvmuxer::Cluster* cluster() { return cluster_.get(); }
+  /// @return the segment template of the options, parsed once.
+  const SegmentTemplate& segment_template() const { return segment_template_; }
+  ClusterWriter* cluster() { return cluster_.get(); }
   mkvmuxer::Cues* cues() { return &cues_; }
   MuxerListener* muxer_listener() { return muxer_listener_; }
   SeekHead* seek_head() { return &seek_head_; }
@@ -124,13 +130,20 @@ class Segmenter {
 
   // Store the previous sample so we know which one is the last frame.
   std::shared_ptr<const MediaSample> prev_sample_;
+  // The signal byte and encryption info written before the data of
+  // |prev_sample_|, if the track is encrypted.
+  BufferWriter frame_header_;
+  // The frame data with its header, for the frames written as a
+  // mkvmuxer::Frame.
+  std::vector<uint8_t> frame_buffer_;
   // The reference frame timestamp; used to populate the ReferenceBlock element
   // when writing non-keyframe BlockGroups.
   int64_t reference_frame_timestamp_ = 0;
 
   const MuxerOptions& options_;
+  const SegmentTemplate segment_template_;
 
-  std::unique_ptr<mkvmuxer::Cluster> cluster_;
+  std::unique_ptr<ClusterWriter> cluster_;
   mkvmuxer::Cues cues_;
   SeekHead seek_head_;
   mkvmuxer::SegmentInfo segment_info_;
@@ -26,6 +26,45 @@ namespace {
 
 const int64_t kMicrosecondsPerMillisecond = 1000;
 
+// The length of an EBML variable size integer, indexed by its first byte. 0 if
+// the first byte is not valid.
+struct VintLengthTable {
+  constexpr VintLengthTable() : lengths() {
+    for (int i = 1; i < 256; ++i) {
+      int length = 1;
+      for (int mask = 0x80; !(i & mask); mask >>= 1)
+        ++length;
+      lengths[i] = static_cast<uint8_t>(length);
+    }
+  }
+  uint8_t lengths[256];
+};
+constexpr VintLengthTable kVintLengths;
+
+// Reads the size field of an element header.
+// Returns the number of bytes read, 0 if more data is needed, or -1 if the
+// size is not valid or unknown.
+int ReadElementSize(const uint8_t* buf, int size, int64_t* element_size) {
+  if (size < 1)
+    return 0;
+  const int length = kVintLengths.lengths[buf[0]];
+  if (length == 0)
+    return -1;
+  if (length > size)
+    return 0;
+  const int first_byte_mask = 0xff >> length;
+  int64_t value = buf[0] & first_byte_mask;
+  bool all_ones = value == first_byte_mask;
+  for (int i = 1; i < length; ++i) {
+    value = (value << 8) | buf[i];
+    all_ones &= buf[i] == 0xff;
+  }
+  if (all_ones)
+    return -1;
+  *element_size = value;
+  return length;
+}
+
 }  // namespace
 
 WebMClusterParser::WebMClusterParser(
@@ -99,7 +138,23 @@ bool WebMClusterParser::Flush() {
 }
 
 int WebMClusterParser::Parse(const uint8_t* buf, int size) {
-  int result = parser_.Parse(buf, size);
+  int result = 0;
+  while (result < size && !parser_.IsParsingComplete()) {
+    const uint8_t* cur = buf + result;
+    const int cur_size = size - result;
+    int bytes_parsed = ParseSimpleBlocks(cur, cur_size);
+    if (bytes_parsed == 0) {
+      // Hand the next element to the generic parser, so that the fast path
+      // resumes right after it.
+      bytes_parsed = parser_.Parse(cur, GetGenericParseSize(cur, cur_size));
+    }
+    if (bytes_parsed <= 0) {
+      if (bytes_parsed < 0)
+        result = bytes_parsed;
+      break;
+    }
+    result += bytes_parsed;
+  }
 
   if (result < 0) {
     cluster_ended_ = false;
@@ -131,6 +186,53 @@ int WebMClusterParser::Parse(const uint8_t* buf, int size) {
   return result;
 }
 
+int WebMClusterParser::ParseSimpleBlocks(const uint8_t* buf, int size) {
+  int64_t bytes_remaining = parser_.GetRootBytesRemaining();
+  int bytes_parsed = 0;
+  while (bytes_remaining > 0 && bytes_parsed < size) {
+    const uint8_t* cur = buf + bytes_parsed;
+    const int cur_size = size - bytes_parsed;
+    // The ID of SimpleBlock takes a single byte.
+    static_assert(kWebMIdSimpleBlock <= 0xff, "");
+    if (cur[0] != kWebMIdSimpleBlock)
+      break;
+    int64_t block_size = 0;
+    const int size_bytes = ReadElementSize(cur + 1, cur_size - 1, &block_size);
+    // Leave the incomplete and the invalid elements to the generic parser.
+    if (size_bytes <= 0)
+      break;
+    const int64_t element_size = 1 + size_bytes + block_size;
+    if (element_size > cur_size || element_size > bytes_remaining)
+      break;
+    if (!ParseBlock(true, cur + 1 + size_bytes, static_cast<int>(block_size),
+                    NULL, 0, -1, 0, false)) {
+      return -1;
+    }
+    bytes_parsed += static_cast<int>(element_size);
+    if (bytes_remaining != kWebMUnknownSize)
+      bytes_remaining -= element_size;
+  }
+  if (bytes_parsed > 0 && !parser_.SkipRootChildren(bytes_parsed))
+    return -1;
+  return bytes_parsed;
+}
+
+int WebMClusterParser::GetGenericParseSize(const uint8_t* buf,
+                                           int size) const {
+  int id = 0;
+  int64_t element_size = 0;
+  const int header_size = WebMParseElementHeader(buf, size, &id, &element_size);
+  if (header_size <= 0)
+    return size;
+  // Stop after the header of the cluster, so that its children may take the
+  // fast path.
+  if (id == kWebMIdCluster)
+    return header_size;
+  if (element_size == kWebMUnknownSize || header_size + element_size > size)
+    return size;
+  return header_size + static_cast<int>(element_size);
+}
+
 WebMParserClient* WebMClusterParser::OnListStart(int id) {
   if (id == kWebMIdCluster) {
     cluster_timecode_ = -1;
@@ -332,6 +434,9 @@ bool WebMClusterParser::OnBlock(bool is_simple_block,
     return false;
   }
 
+  if (selected_tracks_ && selected_tracks_->count(track_num) == 0)
+    return true;
+
   Track* track = NULL;
   StreamType stream_type = kStreamUnknown;
   std::string encryption_key_id;
@@ -394,8 +499,8 @@ bool WebMClusterParser::OnBlock(bool is_simple_block,
         buffer->set_decrypt_config(std::move(decrypt_config));
         buffer->set_is_encrypted(true);
       } else {
-        std::shared_ptr<uint8_t> decrypted_media_data(
-            new uint8_t[media_data_size], std::default_delete<uint8_t[]>());
+        std::shared_ptr<uint8_t> decrypted_media_data =
+            MediaSample::AllocateData(media_data_size);
         if (!decryptor_source_->DecryptSampleBuffer(
                 decrypt_config.get(), media_data, media_data_size,
                 decrypted_media_data.get())) {
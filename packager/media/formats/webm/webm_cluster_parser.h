@@ -8,6 +8,7 @@
 #include <deque>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 
@@ -153,6 +154,11 @@ class WebMClusterParser : public WebMParserClient {
   /// @return true if the last Parse() call stopped at the end of a cluster.
   bool cluster_ended() const { return cluster_ended_; }
 
+  /// Skip the blocks of the tracks not in @a track_ids from now on.
+  void SetSelectedTracks(const std::set<uint32_t>& track_ids) {
+    selected_tracks_ = track_ids;
+  }
+
  private:
   // WebMParserClient methods.
   WebMParserClient* OnListStart(int id) override;
@@ -160,6 +166,15 @@ class WebMClusterParser : public WebMParserClient {
   bool OnUInt(int id, int64_t val) override;
   bool OnBinary(int id, const uint8_t* data, int size) override;
 
+  // Parses the SimpleBlocks at the start of |buf| without going through the
+  // generic WebMListParser, which dominates the cost of parsing clusters made
+  // of SimpleBlocks only. Stops at any other element.
+  // Returns the number of bytes parsed, or -1 if the parse fails.
+  int ParseSimpleBlocks(const uint8_t* buf, int size);
+  // Returns the number of bytes of |buf| to hand to the generic parser, i.e.
+  // the next element if it is complete and the whole buffer otherwise.
+  int GetGenericParseSize(const uint8_t* buf, int size) const;
+
   bool ParseBlock(bool is_simple_block,
                   const uint8_t* buf,
                   int size,
@@ -193,6 +208,8 @@ class WebMClusterParser : public WebMParserClient {
   std::shared_ptr<VideoStreamInfo> video_stream_info_;
   VPCodecConfigurationRecord vp_config_;
   std::set<int64_t> ignored_tracks_;
+  // The tracks whose blocks are not skipped, if set.
+  std::optional<std::set<uint32_t>> selected_tracks_;
 
   std::unique_ptr<DecryptorSource> decryptor_source_;
   std::string audio_encryption_key_id_;
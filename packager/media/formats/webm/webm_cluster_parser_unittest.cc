@@ -690,6 +690,29 @@ TEST_F(WebMClusterParserTest, ParseSimpleBlockAndBlockGroupMixture) {
   ASSERT_TRUE(VerifyBuffers(kBlockInfo, block_count));
 }
 
+TEST_F(WebMClusterParserTest, ParseSimpleBlocksInUnknownSizeCluster) {
+  const BlockInfo kBlockInfo[] = {
+      {kAudioTrackNum, 0, 23, true, NULL, 0, true},
+      {kAudioTrackNum, 23, 23, true, NULL, 0, false},
+  };
+  int block_count = std::size(kBlockInfo);
+
+  const uint8_t kClusterData[] = {
+    0x1F, 0x43, 0xB6, 0x75, 0xFF,  // Cluster(size="unknown")
+    0xE7, 0x81, 0x00,  // Timecode(size=1, value=0)
+    0xA3, 0x85, 0x81, 0x00, 0x00, 0x80, 0xaa,  // SimpleBlock(track=1, ts=0)
+    0xA3, 0x85, 0x81, 0x00, 0x17, 0x00, 0x55,  // SimpleBlock(track=1, ts=23)
+    0x1F, 0x43, 0xB6, 0x75, 0x85,  // Cluster(size=5)
+  };
+  // The parse stops at the header of the next cluster.
+  const int kClusterSize = std::size(kClusterData) - 5;
+
+  EXPECT_EQ(kClusterSize, parser_->Parse(kClusterData, kClusterSize + 5));
+  EXPECT_TRUE(parser_->cluster_ended());
+  EXPECT_TRUE(parser_->Flush());
+  ASSERT_TRUE(VerifyBuffers(kBlockInfo, block_count));
+}
+
 TEST_F(WebMClusterParserTest, IgnoredTracks) {
   std::set<int64_t> ignored_tracks;
   ignored_tracks.insert(kTextTrackNum);
@@ -103,6 +103,12 @@ bool WebMMediaParser::Parse(const uint8_t* buf, int size) {
   return true;
 }
 
+void WebMMediaParser::SetSelectedTracks(const std::set<uint32_t>& track_ids) {
+  selected_tracks_ = track_ids;
+  if (cluster_parser_)
+    cluster_parser_->SetSelectedTracks(track_ids);
+}
+
 void WebMMediaParser::ChangeState(State new_state) {
   DVLOG(1) << "ChangeState() : " << state_ << " -> " << new_state;
   state_ = new_state;
@@ -216,6 +222,8 @@ int WebMMediaParser::ParseInfoAndTracks(const uint8_t* data, int size) {
       tracks_parser.audio_encryption_key_id(),
       tracks_parser.video_encryption_key_id(), new_sample_cb_, init_cb_,
       decryption_key_source_));
+  if (selected_tracks_)
+    cluster_parser_->SetSelectedTracks(*selected_tracks_);
 
   return bytes_parsed;
 }
@@ -5,6 +5,9 @@
 #ifndef PACKAGER_MEDIA_FORMATS_WEBM_WEBM_MEDIA_PARSER_H_
 #define PACKAGER_MEDIA_FORMATS_WEBM_WEBM_MEDIA_PARSER_H_
 
+#include <optional>
+#include <set>
+
 #include <packager/macros/classes.h>
 #include <packager/media/base/byte_queue.h>
 #include <packager/media/base/media_parser.h>
@@ -27,6 +30,7 @@ class WebMMediaParser : public MediaParser {
             KeySource* decryption_key_source) override;
   [[nodiscard]] bool Flush() override;
   [[nodiscard]] bool Parse(const uint8_t* buf, int size) override;
+  void SetSelectedTracks(const std::set<uint32_t>& track_ids) override;
   /// @}
 
  private:
@@ -72,6 +76,8 @@ class WebMMediaParser : public MediaParser {
 
   std::unique_ptr<WebMClusterParser> cluster_parser_;
   ByteQueue byte_queue_;
+  // The tracks selected with SetSelectedTracks(), if any.
+  std::optional<std::set<uint32_t>> selected_tracks_;
 
   DISALLOW_COPY_AND_ASSIGN(WebMMediaParser);
 };
@@ -14,6 +14,7 @@
 #include <packager/media/base/stream_info.h>
 #include <packager/media/formats/webm/mkv_writer.h>
 #include <packager/media/formats/webm/multi_segment_segmenter.h>
+#include <packager/media/formats/webm/one_pass_single_segment_segmenter.h>
 #include <packager/media/formats/webm/single_segment_segmenter.h>
 #include <packager/media/formats/webm/two_pass_single_segment_segmenter.h>
 
@@ -36,6 +37,8 @@ Status WebMMuxer::InitializeMuxer() {
 
   if (!options().segment_template.empty()) {
     segmenter_.reset(new MultiSegmentSegmenter(options()));
+  } else if (options().webm_one_pass_single_segment) {
+    segmenter_.reset(new OnePassSingleSegmentSegmenter(options()));
   } else {
     segmenter_.reset(new TwoPassSingleSegmentSegmenter(options()));
   }
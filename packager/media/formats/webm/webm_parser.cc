@@ -832,6 +832,24 @@ bool WebMListParser::IsParsingComplete() const {
   return state_ == DONE_PARSING_LIST;
 }
 
+int64_t WebMListParser::GetRootBytesRemaining() const {
+  if (state_ != INSIDE_LIST || list_state_stack_.size() != 1)
+    return -1;
+  const ListState& list_state = list_state_stack_.back();
+  if (list_state.size_ == kWebMUnknownSize)
+    return kWebMUnknownSize;
+  return list_state.size_ - list_state.bytes_parsed_;
+}
+
+bool WebMListParser::SkipRootChildren(int size) {
+  DCHECK_GE(GetRootBytesRemaining(), size);
+  ListState& list_state = list_state_stack_.back();
+  list_state.bytes_parsed_ += size;
+  if (list_state.bytes_parsed_ == list_state.size_)
+    return OnListEnd();
+  return true;
+}
+
 void WebMListParser::ChangeState(State new_state) {
   state_ = new_state;
 }
@@ -69,6 +69,17 @@ class WebMListParser {
   /// @return true if the entire list has been parsed.
   bool IsParsingComplete() const;
 
+  /// @return The number of bytes left in the root list if the parser stands
+  ///         between two children of the root list, kWebMUnknownSize if the
+  ///         root list has an unknown size, or -1 otherwise.
+  int64_t GetRootBytesRemaining() const;
+
+  /// Accounts for |size| bytes of children of the root list which the caller
+  /// parsed itself, e.g. on a fast path for frequent elements. Must only be
+  /// called when GetRootBytesRemaining() is at least |size|.
+  /// @return false if ending the root list fails.
+  bool SkipRootChildren(int size);
+
  private:
   enum State {
     NEED_LIST_HEADER,
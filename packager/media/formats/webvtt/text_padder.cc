@@ -35,6 +35,9 @@ Status TextPadder::Process(std::unique_ptr<StreamData> data) {
 
 Status TextPadder::OnTextSample(std::unique_ptr<StreamData> data) {
   const TextSample& sample = *data->text_sample;
+  // A heartbeat is not shown, so there is no gap to fill before it.
+  if (sample.is_heartbeat())
+    return Dispatch(std::move(data));
 
   // If this is the first sample we have seen, we need to check if we should
   // start at time zero.
@@ -40,7 +40,8 @@ Status WebVttMuxer::AddTextSampleInternal(const TextSample& sample) {
 Status WebVttMuxer::WriteToFile(const std::string& filename, uint64_t* size) {
   // Write everything to the file before telling the manifest so that the
   // file will exist on disk.
-  std::unique_ptr<File, FileCloser> file(File::Open(filename.c_str(), "w"));
+  std::unique_ptr<File, FileCloser> file(
+      File::OpenWithNoBuffering(filename.c_str(), "w"));
   if (!file) {
     return Status(error::FILE_FAILURE, "Failed to open " + filename);
   }
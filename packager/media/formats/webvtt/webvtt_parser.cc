@@ -8,6 +8,7 @@
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
+#include <absl/strings/ascii.h>
 #include <absl/strings/numbers.h>
 #include <absl/strings/str_format.h>
 #include <absl/strings/str_split.h>
@@ -15,7 +16,6 @@
 #include <packager/kv_pairs/kv_pairs.h>
 #include <packager/media/base/text_stream_info.h>
 #include <packager/media/formats/webvtt/webvtt_utils.h>
-#include <packager/utils/string_trim_split.h>
 
 namespace shaka {
 namespace media {
@@ -78,10 +78,10 @@ bool IsLikelyRegion(const std::string& line) {
   return absl::StripTrailingAsciiWhitespace(line) == "REGION";
 }
 
-bool ParsePercent(const std::string& str, float* value) {
+bool ParsePercent(std::string_view str, float* value) {
   // https://www.w3.org/TR/webvtt1/#webvtt-percentage
   // E.g. "4%" or "1.5%"
-  if (str[str.size() - 1] != '%') {
+  if (str.empty() || str.back() != '%') {
     return false;
   }
 
@@ -93,15 +93,16 @@ bool ParsePercent(const std::string& str, float* value) {
   return true;
 }
 
-bool ParseDoublePercent(const std::string& str, float* a, float* b) {
-  std::vector<std::string> percents = SplitAndTrimSkipEmpty(str, ',');
+bool ParseDoublePercent(std::string_view str, float* a, float* b) {
+  std::vector<std::string_view> percents =
+      absl::StrSplit(str, ',', absl::SkipWhitespace());
 
   if (percents.size() != 2) {
     return false;
   }
   float temp_a, temp_b;
-  if (!ParsePercent(percents[0], &temp_a) ||
-      !ParsePercent(percents[1], &temp_b)) {
+  if (!ParsePercent(absl::StripAsciiWhitespace(percents[0]), &temp_a) ||
+      !ParsePercent(absl::StripAsciiWhitespace(percents[1]), &temp_b)) {
     return false;
   }
   *a = temp_a;
@@ -109,12 +110,12 @@ bool ParseDoublePercent(const std::string& str, float* a, float* b) {
   return true;
 }
 
-void ParseSettings(const std::string& id,
-                   const std::string& value,
+void ParseSettings(std::string_view id,
+                   std::string_view value,
                    TextSettings* settings) {
   // https://www.w3.org/TR/webvtt1/#ref-for-parse-the-webvtt-cue-settings-1
   if (id == "region") {
-    settings->region = value;
+    settings->region = std::string(value);
   } else if (id == "vertical") {
     if (value == "rl") {
       settings->writing_direction = WritingDirection::kVerticalGrowingLeft;
@@ -125,14 +126,12 @@ void ParseSettings(const std::string& id,
     }
   } else if (id == "line") {
     const auto pos = value.find(',');
-    const std::string line = value.substr(0, pos);
-    const std::string align =
-        pos != std::string::npos ? value.substr(pos + 1) : "";
-    if (pos != std::string::npos) {
+    const std::string_view line = value.substr(0, pos);
+    if (pos != std::string_view::npos) {
       LOG(WARNING) << "WebVTT line alignment isn't supported";
     }
 
-    if (!line.empty() && line[line.size() - 1] == '%') {
+    if (!line.empty() && line.back() == '%') {
       float temp;
       if (!ParsePercent(line, &temp)) {
         LOG(WARNING) << "Invalid WebVTT line: " << value;
@@ -149,10 +148,8 @@ void ParseSettings(const std::string& id,
     }
   } else if (id == "position") {
     const auto pos = value.find(',');
-    const std::string position = value.substr(0, pos);
-    const std::string align =
-        pos != std::string::npos ? value.substr(pos + 1) : "";
-    if (pos != std::string::npos) {
+    const std::string_view position = value.substr(0, pos);
+    if (pos != std::string_view::npos) {
       LOG(WARNING) << "WebVTT position alignment isn't supported";
     }
 
@@ -237,13 +234,15 @@ bool WebVttParser::Parse() {
 
   std::vector<std::string> block;
   while (reader_.Next(&block)) {
-    if (!ParseBlock(block))
+    if (!ParseBlock(&block))
       return false;
   }
   return true;
 }
 
-bool WebVttParser::ParseBlock(const std::vector<std::string>& block) {
+bool WebVttParser::ParseBlock(std::vector<std::string>* block_ptr) {
+  std::vector<std::string>& block = *block_ptr;
+
   // NOTE
   if (IsLikelyNote(block[0])) {
     // We can safely ignore the whole block.
@@ -278,13 +277,13 @@ bool WebVttParser::ParseBlock(const std::vector<std::string>& block) {
 
   // CUE with ID
   if (block.size() >= 2 && MaybeCueId(block[0]) &&
-      IsLikelyCueTiming(block[1]) && ParseCueWithId(block)) {
+      IsLikelyCueTiming(block[1]) && ParseCueWithId(block_ptr)) {
     saw_cue_ = true;
     return true;
   }
 
   // CUE with no ID
-  if (IsLikelyCueTiming(block[0]) && ParseCueWithNoId(block)) {
+  if (IsLikelyCueTiming(block[0]) && ParseCueWithNoId(block_ptr)) {
     saw_cue_ = true;
     return true;
   }
@@ -378,27 +377,37 @@ bool WebVttParser::ParseRegion(const std::vector<std::string>& block) {
   return true;
 }
 
-bool WebVttParser::ParseCueWithNoId(const std::vector<std::string>& block) {
-  return ParseCue("", block.data(), block.size());
+bool WebVttParser::ParseCueWithNoId(std::vector<std::string>* block) {
+  return ParseCue("", block->data(), block->size());
 }
 
-bool WebVttParser::ParseCueWithId(const std::vector<std::string>& block) {
-  return ParseCue(block[0], block.data() + 1, block.size() - 1);
+bool WebVttParser::ParseCueWithId(std::vector<std::string>* block) {
+  return ParseCue((*block)[0], block->data() + 1, block->size() - 1);
 }
 
 bool WebVttParser::ParseCue(const std::string& id,
-                            const std::string* block,
+                            std::string* block,
                             size_t block_size) {
-  std::vector<std::string> time_and_style =
-      SplitAndTrimSkipEmpty(block[0], ' ');
+  // The timing line is tokenized in place; the tokens are views into
+  // |block[0]|, so no strings are allocated for them.
+  auto time_and_style = absl::StrSplit(std::string_view(block[0]), ' ',
+                                       absl::SkipWhitespace());
+  auto token = time_and_style.begin();
+  const auto next_token = [&token, &time_and_style]() {
+    if (token == time_and_style.end())
+      return std::string_view();
+    return absl::StripAsciiWhitespace(*token++);
+  };
 
   int64_t start_time = 0;
   int64_t end_time = 0;
 
-  const bool parsed_time =
-      time_and_style.size() >= 3 && time_and_style[1] == "-->" &&
-      WebVttTimestampToMs(time_and_style[0], &start_time) &&
-      WebVttTimestampToMs(time_and_style[2], &end_time);
+  const std::string_view start_token = next_token();
+  const std::string_view arrow_token = next_token();
+  const std::string_view end_token = next_token();
+  const bool parsed_time = !end_token.empty() && arrow_token == "-->" &&
+                           WebVttTimestampToMs(start_token, &start_time) &&
+                           WebVttTimestampToMs(end_token, &end_time);
 
   if (!parsed_time) {
     LOG(ERROR) << "Could not parse start time, -->, and end time from "
@@ -429,30 +438,31 @@ bool WebVttParser::ParseCue(const std::string& id,
   }
 
   TextSettings settings;
-  for (size_t i = 3; i < time_and_style.size(); i++) {
-    const auto pos = time_and_style[i].find(':');
-    if (pos == std::string::npos) {
+  for (std::string_view setting = next_token(); !setting.empty();
+       setting = next_token()) {
+    const auto pos = setting.find(':');
+    if (pos == std::string_view::npos) {
       continue;
     }
 
-    const std::string key = time_and_style[i].substr(0, pos);
-    const std::string value = time_and_style[i].substr(pos + 1);
-    ParseSettings(key, value, &settings);
+    ParseSettings(setting.substr(0, pos), setting.substr(pos + 1), &settings);
   }
 
-  // The rest of the block is the payload.
+  // The rest of the block is the payload. The lines are not needed after this,
+  // so they are moved into the sample rather than copied.
   // TODO: Parse tags to support <b>, <i>, etc.
   TextFragment body;
   TextFragmentStyle no_styles;
+  body.sub_fragments.reserve(block_size > 1 ? 2 * block_size - 3 : 0);
   for (size_t i = 1; i < block_size; i++) {
     if (i > 1 && i != block_size) {
       body.sub_fragments.emplace_back(no_styles, /* newline= */ true);
     }
-    body.sub_fragments.emplace_back(no_styles, block[i]);
+    body.sub_fragments.emplace_back(no_styles, std::move(block[i]));
   }
 
-  const auto sample =
-      std::make_shared<TextSample>(id, start_time, end_time, settings, body);
+  const auto sample = std::make_shared<TextSample>(id, start_time, end_time,
+                                                   settings, std::move(body));
   return new_text_sample_cb_(kStreamIndex, sample);
 }
 
@@ -324,6 +324,34 @@ TEST_F(WebVttParserTest, ParseOneCueWithId) {
   ExpectPlainCueWithBody(samples_[0]->body(), "subtitle");
 }
 
+TEST_F(WebVttParserTest, ParseOneMultiLineCueWithId) {
+  const uint8_t text[] =
+      "WEBVTT\n"
+      "\n"
+      "id\n"
+      "00:01:00.000  -->  01:00:00.000  size:50%\n"
+      "line one\n"
+      "line two\n";
+
+  ASSERT_NO_FATAL_FAILURE(SetUpAndInitialize());
+
+  ASSERT_TRUE(parser_->Parse(text, sizeof(text) - 1));
+  ASSERT_TRUE(parser_->Flush());
+
+  ASSERT_EQ(streams_.size(), 1u);
+  ASSERT_EQ(samples_.size(), 1u);
+  EXPECT_EQ(samples_[0]->id(), "id");
+  EXPECT_EQ(samples_[0]->start_time(), 60000);
+  EXPECT_EQ(samples_[0]->EndTime(), 3600000);
+  EXPECT_EQ(samples_[0]->settings().width.value().value, 50.0f);
+
+  const auto& sub_fragments = samples_[0]->body().sub_fragments;
+  ASSERT_EQ(sub_fragments.size(), 3u);
+  EXPECT_EQ(sub_fragments[0].body, "line one");
+  EXPECT_TRUE(sub_fragments[1].newline);
+  EXPECT_EQ(sub_fragments[2].body, "line two");
+}
+
 TEST_F(WebVttParserTest, ParseOneEmptyCueWithId) {
   const uint8_t text[] =
       "WEBVTT\n"
@@ -7,7 +7,6 @@
 #include <packager/media/formats/webvtt/webvtt_to_mp4_handler.h>
 
 #include <algorithm>
-#include <map>
 
 #include <absl/log/check.h>
 
@@ -23,38 +22,8 @@ namespace media {
 namespace {
 size_t kTrackId = 0;
 
-enum class DisplayActionType { ADD, REMOVE };
-
-struct DisplayAction {
-  DisplayActionType type;
-  const TextSample* sample;
-};
-
-std::multimap<int64_t, DisplayAction> CreateActionList(
-    int64_t segment_start,
-    int64_t segment_end,
-    const std::list<std::shared_ptr<const TextSample>>& samples) {
-  std::multimap<int64_t, DisplayAction> actions;
-
-  for (const auto& sample : samples) {
-    DCHECK(sample);
-
-    // The add action should occur either in this segment or in a previous
-    // segment.
-    DCHECK_LT(sample->start_time(), segment_end);
-    actions.insert(
-        {sample->start_time(), {DisplayActionType::ADD, sample.get()}});
-
-    // If the remove happens in a later segment, then we don't want to include
-    // that action.
-    if (sample->EndTime() < segment_end) {
-      actions.insert(
-          {sample->EndTime(), {DisplayActionType::REMOVE, sample.get()}});
-    }
-  }
-
-  return actions;
-}
+// The vtte box of the sections without a cue.
+const uint8_t kEmptyCueBox[] = {0x00, 0x00, 0x00, 0x08, 'v', 't', 't', 'e'};
 
 void WriteSample(const TextSample& sample, BufferWriter* out) {
   mp4::VTTCueBox box;
@@ -73,20 +42,6 @@ void WriteSample(const TextSample& sample, BufferWriter* out) {
   box.Write(out);
 }
 
-void WriteSamples(const std::list<const TextSample*>& samples,
-                  BufferWriter* writer) {
-  DCHECK_GE(samples.size(), 0u);
-
-  for (const auto& sample : samples) {
-    WriteSample(*sample, writer);
-  }
-}
-
-void WriteEmptySample(BufferWriter* writer) {
-  mp4::VTTEmptyCueBox box;
-  box.Write(writer);
-}
-
 std::shared_ptr<MediaSample> CreateMediaSample(const BufferWriter& buffer,
                                                int64_t start_time,
                                                int64_t end_time) {
@@ -192,19 +147,65 @@ Status WebVttToMp4Handler::OnTextSample(
   return Status::OK;
 }
 
+void WebVttToMp4Handler::WriteCueBoxes() {
+  previous_cue_boxes_.swap(cue_boxes_);
+  previous_cue_box_writer_.Swap(&cue_box_writer_);
+  cue_boxes_.clear();
+  cue_box_writer_.Clear();
+
+  for (const auto& sample : current_segment_) {
+    DCHECK(sample);
+    CueBox cue_box{sample, cue_box_writer_.Size(), 0};
+    auto previous = std::find_if(
+        previous_cue_boxes_.begin(), previous_cue_boxes_.end(),
+        [&sample](const CueBox& box) { return box.sample == sample; });
+    if (previous != previous_cue_boxes_.end()) {
+      cue_box_writer_.AppendArray(
+          previous_cue_box_writer_.Buffer() + previous->offset,
+          previous->size);
+    } else {
+      WriteSample(*sample, &cue_box_writer_);
+    }
+    cue_box.size = cue_box_writer_.Size() - cue_box.offset;
+    cue_boxes_.push_back(std::move(cue_box));
+  }
+  // Release the samples which ended in the previous segment.
+  previous_cue_boxes_.clear();
+}
+
 Status WebVttToMp4Handler::DispatchCurrentSegment(int64_t segment_start,
                                                   int64_t segment_end) {
+  WriteCueBoxes();
+
+  // |actions_| is a list of [time] -> [action], sorted by time.
+  actions_.clear();
+  for (size_t i = 0; i < cue_boxes_.size(); ++i) {
+    const TextSample& sample = *cue_boxes_[i].sample;
+
+    // The add action should occur either in this segment or in a previous
+    // segment.
+    DCHECK_LT(sample.start_time(), segment_end);
+    actions_.push_back({sample.start_time(), DisplayActionType::ADD, i});
+
+    // If the remove happens in a later segment, then we don't want to include
+    // that action.
+    if (sample.EndTime() < segment_end) {
+      actions_.push_back({sample.EndTime(), DisplayActionType::REMOVE, i});
+    }
+  }
+  std::stable_sort(actions_.begin(), actions_.end(),
+                   [](const DisplayAction& a, const DisplayAction& b) {
+                     return a.time < b.time;
+                   });
+  auto front = actions_.begin();
+
   // Active will hold all the samples that are "on screen" for the current
   // section of time.
-  std::list<const TextSample*> active;
+  active_.clear();
 
   // Move through the segment, jumping between each change to the current state.
   // A change is defined as a group of one or more DisplayActions.
-  int section_start = segment_start;
-
-  // |actions| is a map of [time] -> [action].
-  auto actions = CreateActionList(segment_start, segment_end, current_segment_);
-  auto front = actions.begin();
+  int64_t section_start = segment_start;
 
   // As it is possible to have a segment with no samples, we can't base this
   // loop on the number of actions. So we need to keep iterating until we
@@ -215,18 +216,19 @@ Status WebVttToMp4Handler::DispatchCurrentSegment(int64_t segment_start,
     // samples to span multiple segments, their start time will be before the
     // segment's start time. So we want to apply them too if they come before
     // the segment. Thus why we use "<=".
-    while (front != actions.end() && front->first <= section_start) {
-      auto& action = front->second;
+    while (front != actions_.end() && front->time <= section_start) {
+      auto& action = *front;
 
       switch (action.type) {
         case DisplayActionType::ADD: {
-          active.push_back(action.sample);
+          active_.push_back(action.cue_index);
           break;
         }
         case DisplayActionType::REMOVE: {
-          auto found = std::find(active.begin(), active.end(), action.sample);
-          DCHECK(found != active.end());
-          active.erase(found);
+          auto found =
+              std::find(active_.begin(), active_.end(), action.cue_index);
+          DCHECK(found != active_.end());
+          active_.erase(found);
           break;
         }
         default: {
@@ -242,31 +244,33 @@ Status WebVttToMp4Handler::DispatchCurrentSegment(int64_t segment_start,
 
     // The end of the section will either be the start of the next section or
     // the end of the segment.
-    int64_t section_end = front == actions.end() ? segment_end : front->first;
+    int64_t section_end = front == actions_.end() ? segment_end : front->time;
     DCHECK_GT(section_end, section_start);
     DCHECK_LE(section_end, segment_end);
-    RETURN_IF_ERROR(MergeDispatchSamples(section_start, section_end, active));
+    RETURN_IF_ERROR(MergeDispatchSamples(section_start, section_end));
 
     section_start = section_end;
   }
 
-  DCHECK(front == actions.end()) << "We should have processed all actions.";
+  DCHECK(front == actions_.end()) << "We should have processed all actions.";
 
   return Status::OK;
 }
 
-Status WebVttToMp4Handler::MergeDispatchSamples(
-    int64_t start_time,
-    int64_t end_time,
-    const std::list<const TextSample*>& state) {
+Status WebVttToMp4Handler::MergeDispatchSamples(int64_t start_time,
+                                                int64_t end_time) {
   DCHECK_GT(end_time, start_time);
 
   box_writer_.Clear();
 
-  if (state.size()) {
-    WriteSamples(state, &box_writer_);
+  if (active_.size()) {
+    for (const size_t cue_index : active_) {
+      const CueBox& cue_box = cue_boxes_[cue_index];
+      box_writer_.AppendArray(cue_box_writer_.Buffer() + cue_box.offset,
+                              cue_box.size);
+    }
   } else {
-    WriteEmptySample(&box_writer_);
+    box_writer_.AppendArray(kEmptyCueBox, sizeof(kEmptyCueBox));
   }
 
   return DispatchMediaSample(
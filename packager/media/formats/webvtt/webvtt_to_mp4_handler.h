@@ -8,8 +8,8 @@
 #define PACKAGER_MEDIA_FORMATS_WEBVTT_WEBVTT_MP4_CUE_HANDLER_H_
 
 #include <cstdint>
-#include <list>
-#include <queue>
+#include <memory>
+#include <vector>
 
 #include <packager/media/base/buffer_writer.h>
 #include <packager/media/base/media_handler.h>
@@ -38,11 +38,40 @@ class WebVttToMp4Handler : public MediaHandler {
   Status OnTextSample(std::unique_ptr<StreamData> stream_data);
 
   Status DispatchCurrentSegment(int64_t segment_start, int64_t segment_end);
-  Status MergeDispatchSamples(int64_t start_in_seconds,
-                              int64_t end_in_seconds,
-                              const std::list<const TextSample*>& state);
+  Status MergeDispatchSamples(int64_t start_time, int64_t end_time);
+  void WriteCueBoxes();
 
-  std::list<std::shared_ptr<const TextSample>> current_segment_;
+  enum class DisplayActionType { ADD, REMOVE };
+
+  struct DisplayAction {
+    int64_t time;
+    DisplayActionType type;
+    // The index of the sample in |cue_boxes_|.
+    size_t cue_index;
+  };
+
+  // The vttc box of a sample, at |offset| in its writer.
+  struct CueBox {
+    std::shared_ptr<const TextSample> sample;
+    size_t offset;
+    size_t size;
+  };
+
+  std::vector<std::shared_ptr<const TextSample>> current_segment_;
+
+  // The vttc boxes of the samples of the current segment, in their order.
+  // They are serialized once per sample and copied into every section of the
+  // segment the sample is on screen in. The samples which span segments keep
+  // the boxes of the previous segment.
+  std::vector<CueBox> cue_boxes_;
+  BufferWriter cue_box_writer_;
+  std::vector<CueBox> previous_cue_boxes_;
+  BufferWriter previous_cue_box_writer_;
+
+  // The actions of the current segment and the samples on screen, as indexes
+  // in |cue_boxes_|. They are kept to reuse their memory.
+  std::vector<DisplayAction> actions_;
+  std::vector<size_t> active_;
 
   // This is the current state of the box we are writing.
   BufferWriter box_writer_;
@@ -90,6 +90,11 @@ class WebVttToMp4HandlerTest : public MediaHandlerTestBase {
         StreamData::FromTextSample(kStreamIndex, std::move(sample)));
   }
 
+  Status DispatchText(std::shared_ptr<const TextSample> sample) {
+    return In()->Dispatch(
+        StreamData::FromTextSample(kStreamIndex, std::move(sample)));
+  }
+
   Status DispatchSegment(int64_t start_time, int64_t end_time) {
     DCHECK_GT(end_time, start_time);
 
@@ -701,5 +706,61 @@ TEST_F(WebVttToMp4HandlerTest, CrossSegmentSamples) {
   ASSERT_OK(DispatchSegment(kSegment2Start, kSegment2End));
   ASSERT_OK(Flush());
 }
+
+// Verify that a sample which spans segments, which the text chunker passes to
+// each of them, is written to all of them, along with the other samples.
+TEST_F(WebVttToMp4HandlerTest, SameSampleInConsecutiveSegments) {
+  const int64_t kSegment1Start = 0;
+  const int64_t kSegment1End = 10000;
+  const int64_t kSegment2Start = 10000;
+  const int64_t kSegment2End = 20000;
+
+  const int64_t kSample1Start = 0;
+  const int64_t kSample1End = 15000;
+  const int64_t kSample2Start = 10000;
+  const int64_t kSample2End = 20000;
+
+  ASSERT_OK(SetUpTestGraph());
+
+  {
+    testing::InSequence s;
+
+    EXPECT_CALL(*Out(), OnProcess(IsStreamInfo(kStreamIndex, _, _, _)));
+
+    EXPECT_CALL(*Out(),
+                OnProcess(AllOf(IsMediaSample(kStreamIndex, kSegment1Start,
+                                              10000, !kEncrypted, _),
+                                MediaSampleContainsId(kId1))));
+    EXPECT_CALL(*Out(), OnProcess(IsSegmentInfo(kStreamIndex, kSegment1Start,
+                                                10000, !kSubSegment,
+                                                !kEncrypted)));
+
+    EXPECT_CALL(*Out(),
+                OnProcess(AllOf(IsMediaSample(kStreamIndex, kSegment2Start,
+                                              5000, !kEncrypted, _),
+                                MediaSampleContainsId(kId1),
+                                MediaSampleContainsId(kId2))));
+    EXPECT_CALL(*Out(), OnProcess(AllOf(IsMediaSample(kStreamIndex, 15000,
+                                                      5000, !kEncrypted, _),
+                                        Not(MediaSampleContainsId(kId1)),
+                                        MediaSampleContainsId(kId2))));
+    EXPECT_CALL(*Out(), OnProcess(IsSegmentInfo(kStreamIndex, kSegment2Start,
+                                                10000, !kSubSegment,
+                                                !kEncrypted)));
+
+    EXPECT_CALL(*Out(), OnFlush(kStreamIndex));
+  }
+
+  std::shared_ptr<const TextSample> sample =
+      GetTextSample(kId1, kSample1Start, kSample1End, kSimplePayload);
+
+  ASSERT_OK(DispatchStream());
+  ASSERT_OK(DispatchText(sample));
+  ASSERT_OK(DispatchSegment(kSegment1Start, kSegment1End));
+  ASSERT_OK(DispatchText(sample));
+  ASSERT_OK(DispatchText(kId2, kSimplePayload, kSample2Start, kSample2End));
+  ASSERT_OK(DispatchSegment(kSegment2Start, kSegment2End));
+  ASSERT_OK(Flush());
+}
 }  // namespace media
 }  // namespace shaka
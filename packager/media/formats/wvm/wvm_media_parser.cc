@@ -10,7 +10,6 @@
 
 #include <absl/base/internal/endian.h>
 #include <absl/log/check.h>
-#include <absl/strings/str_format.h>
 
 #include <packager/media/base/aes_decryptor.h>
 #include <packager/media/base/audio_stream_info.h>
@@ -68,6 +67,10 @@ const uint32_t kAssetKeySizeBytes = 16;
 // Default audio and video PES stream IDs.
 const uint8_t kDefaultAudioStreamId = kPesStreamIdAudio;
 const uint8_t kDefaultVideoStreamId = kPesStreamIdVideo;
+// Size of the fixed part of a pack header, after the start code.
+const size_t kPackHeaderSize = 10;
+// Size of a PTS or a DTS in a PES header.
+const size_t kTimestampSize = 5;
 
 enum Type {
   Type_void = 0,
@@ -82,6 +85,26 @@ enum Type {
   Type_string = 9,
   Type_BinaryData = 10
 };
+
+// @return the key of the demux stream of |pes_stream_id| in |program_id| in
+//         WvmMediaParser::program_demux_stream_map_.
+uint64_t DemuxStreamKey(uint8_t program_id, uint32_t pes_stream_id) {
+  return (static_cast<uint64_t>(program_id) << 32) | pes_stream_id;
+}
+
+// @return the 33-bit PTS or DTS at |data|.
+int64_t ReadTimestamp(const uint8_t* data) {
+  return (static_cast<int64_t>(data[0] & 0x0E) << 29) |
+         (static_cast<int64_t>(data[1]) << 22) |
+         (static_cast<int64_t>(data[2] >> 1) << 15) |
+         (static_cast<int64_t>(data[3]) << 7) | (data[4] >> 1);
+}
+
+void AppendData(const uint8_t* data,
+                size_t size,
+                std::vector<uint8_t>* buffer) {
+  buffer->insert(buffer->end(), data, data + size);
+}
 }  // namespace
 
 namespace shaka {
@@ -126,17 +149,23 @@ void WvmMediaParser::Init(const InitCB& init_cb,
 
 bool WvmMediaParser::Parse(const uint8_t* buf, int size) {
   size_t num_bytes = 0;
-  size_t prev_size = 0;
   const uint8_t* read_ptr = buf;
   const uint8_t* end = read_ptr + size;
 
   while (read_ptr < end) {
     switch (parse_state_) {
-      case StartCode1:
-        if (*read_ptr == kStartCode1) {
-          parse_state_ = StartCode2;
+      case StartCode1: {
+        // Find the next start code candidate in bulk.
+        const uint8_t* start_code = static_cast<const uint8_t*>(
+            memchr(read_ptr, kStartCode1, end - read_ptr));
+        if (!start_code) {
+          read_ptr = end;
+          continue;
         }
+        read_ptr = start_code;
+        parse_state_ = StartCode2;
         break;
+      }
       case StartCode2:
         if (*read_ptr == kStartCode2) {
           parse_state_ = StartCode3;
@@ -168,6 +197,14 @@ bool WvmMediaParser::Parse(const uint8_t* buf, int size) {
         }
         break;
       case PackHeader1:
+        if (static_cast<size_t>(end - read_ptr) >= kPackHeaderSize) {
+          // The whole fixed part of the header is available. Only the
+          // stuffing length is needed.
+          skip_bytes_ = read_ptr[kPackHeaderSize - 1] & 0x07;
+          read_ptr += kPackHeaderSize;
+          parse_state_ = PackHeaderStuffingSkip;
+          continue;
+        }
         parse_state_ = PackHeader2;
         break;
       case PackHeader2:
@@ -277,6 +314,19 @@ bool WvmMediaParser::Parse(const uint8_t* buf, int size) {
         }
         break;
       case Pts1:
+        if (static_cast<size_t>(end - read_ptr) >= kTimestampSize) {
+          pts_ = ReadTimestamp(read_ptr);
+          read_ptr += kTimestampSize;
+          pes_header_data_bytes_ -= kTimestampSize;
+          pes_packet_bytes_ -= kTimestampSize;
+          if (pes_flags_2_ & kPesOptDts) {
+            parse_state_ = Dts1;
+          } else {
+            dts_ = pts_;
+            parse_state_ = PesHeaderData;
+          }
+          continue;
+        }
         timestamp_ = (*read_ptr & 0x0E);
         --pes_header_data_bytes_;
         --pes_packet_bytes_;
@@ -317,6 +367,14 @@ bool WvmMediaParser::Parse(const uint8_t* buf, int size) {
         }
         break;
       case Dts1:
+        if (static_cast<size_t>(end - read_ptr) >= kTimestampSize) {
+          dts_ = ReadTimestamp(read_ptr);
+          read_ptr += kTimestampSize;
+          pes_header_data_bytes_ -= kTimestampSize;
+          pes_packet_bytes_ -= kTimestampSize;
+          parse_state_ = PesHeaderData;
+          continue;
+        }
         timestamp_ = (*read_ptr & 0x0E);
         --pes_header_data_bytes_;
         --pes_packet_bytes_;
@@ -392,9 +450,7 @@ bool WvmMediaParser::Parse(const uint8_t* buf, int size) {
         }
         if (num_bytes > 0) {
           pes_packet_bytes_ -= num_bytes;
-          prev_size = psm_data_.size();
-          psm_data_.resize(prev_size + num_bytes);
-          memcpy(&psm_data_[prev_size], read_ptr, num_bytes);
+          AppendData(read_ptr, num_bytes, &psm_data_);
         }
         read_ptr += num_bytes;
         continue;
@@ -406,9 +462,7 @@ bool WvmMediaParser::Parse(const uint8_t* buf, int size) {
         }
         if (num_bytes > 0) {
           pes_packet_bytes_ -= num_bytes;
-          prev_size = ecm_.size();
-          ecm_.resize(prev_size + num_bytes);
-          memcpy(&ecm_[prev_size], read_ptr, num_bytes);
+          AppendData(read_ptr, num_bytes, &ecm_);
         }
         if ((pes_packet_bytes_ == 0) && !ecm_.empty()) {
           if (!ProcessEcm()) {
@@ -425,9 +479,7 @@ bool WvmMediaParser::Parse(const uint8_t* buf, int size) {
         }
         if (num_bytes > 0) {
           pes_packet_bytes_ -= num_bytes;
-          prev_size = index_data_.size();
-          index_data_.resize(prev_size + num_bytes);
-          memcpy(&index_data_[prev_size], read_ptr, num_bytes);
+          AppendData(read_ptr, num_bytes, &index_data_);
         }
         if (pes_packet_bytes_ == 0 && !index_data_.empty()) {
           if (!metadata_is_complete_) {
@@ -446,9 +498,7 @@ bool WvmMediaParser::Parse(const uint8_t* buf, int size) {
         }
         pes_packet_bytes_ -= num_bytes;
         if (pes_stream_id_ !=  kV2MetadataStreamId) {
-          sample_data_.resize(sample_data_.size() + num_bytes);
-          memcpy(&sample_data_[sample_data_.size() - num_bytes], read_ptr,
-                 num_bytes);
+          AppendData(read_ptr, num_bytes, &sample_data_);
         }
         prev_pes_stream_id_ = pes_stream_id_;
         read_ptr += num_bytes;
@@ -491,9 +541,8 @@ bool WvmMediaParser::Parse(const uint8_t* buf, int size) {
 bool WvmMediaParser::EmitLastSample(
     uint32_t stream_id,
     const std::shared_ptr<MediaSample>& new_sample) {
-  std::string key = absl::StrFormat("%u:%u", current_program_id_, stream_id);
-  std::map<std::string, uint32_t>::iterator it =
-      program_demux_stream_map_.find(key);
+  auto it = program_demux_stream_map_.find(
+      DemuxStreamKey(current_program_id_, stream_id));
   if (it == program_demux_stream_map_.end())
     return false;
   return EmitSample(stream_id, (*it).second, new_sample, true);
@@ -748,8 +797,8 @@ bool WvmMediaParser::ParseIndexEntry() {
           0 /*matrix_coefficients */, 0 /* transfer_characteristics */,
           trick_play_factor, nalu_length_size, std::string(),
           decryption_key_source_ ? false : true));
-      program_demux_stream_map_[absl::StrFormat(
-          "%u:%u", index_program_id_,
+      program_demux_stream_map_[DemuxStreamKey(
+          index_program_id_,
           video_pes_stream_id ? video_pes_stream_id : kDefaultVideoStreamId)] =
           stream_id_count_++;
     }
@@ -763,8 +812,8 @@ bool WvmMediaParser::ParseIndexEntry() {
           0 /* seek preroll */, 0 /* codec delay */, 0 /* max bitrate */,
           0 /* avg bitrate */, std::string(),
           decryption_key_source_ ? false : true));
-      program_demux_stream_map_[absl::StrFormat(
-          "%u:%u", index_program_id_,
+      program_demux_stream_map_[DemuxStreamKey(
+          index_program_id_,
           audio_pes_stream_id ? audio_pes_stream_id : kDefaultAudioStreamId)] =
           stream_id_count_++;
     }
@@ -967,10 +1016,8 @@ bool WvmMediaParser::Output(bool output_encrypted_sample) {
   }
 
   DCHECK_GT(media_sample_->data_size(), 0UL);
-  std::string key =
-      absl::StrFormat("%u:%u", current_program_id_, prev_pes_stream_id_);
-  std::map<std::string, uint32_t>::iterator it =
-      program_demux_stream_map_.find(key);
+  auto it = program_demux_stream_map_.find(
+      DemuxStreamKey(current_program_id_, prev_pes_stream_id_));
   if (it == program_demux_stream_map_.end()) {
     // TODO(ramjic): Log error message here and in other error cases through
     // this method.
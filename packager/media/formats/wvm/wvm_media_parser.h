@@ -247,7 +247,8 @@ class WvmMediaParser : public MediaParser {
   std::vector<uint8_t, std::allocator<uint8_t>> ecm_;
   std::vector<uint8_t> psm_data_;
   std::vector<uint8_t> index_data_;
-  std::map<std::string, uint32_t> program_demux_stream_map_;
+  // Keyed by the program ID and the PES stream ID, see DemuxStreamKey().
+  std::map<uint64_t, uint32_t> program_demux_stream_map_;
   int stream_id_count_;
   std::vector<std::shared_ptr<StreamInfo>> stream_infos_;
   std::deque<DemuxStreamIdMediaSample> media_sample_queue_;
@@ -18,5 +18,10 @@ Status OriginHandler::Process(std::unique_ptr<StreamData> /* ignored */) {
                 "An origin handlers should never be a downstream handler.");
 }
 
+bool OriginHandler::StartAsync(
+    std::function<void(const Status&)> /* on_complete */) {
+  return false;
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -7,6 +7,8 @@
 #ifndef PACKAGER_MEDIA_ORIGIN_ORIGIN_HANDLER_H_
 #define PACKAGER_MEDIA_ORIGIN_ORIGIN_HANDLER_H_
 
+#include <functional>
+
 #include <packager/media/base/media_handler.h>
 
 namespace shaka {
@@ -26,6 +28,13 @@ class OriginHandler : public MediaHandler {
   // be used.
   virtual Status Run() = 0;
 
+  // Non-blocking alternative to |Run|, for the handlers driven by the arrival
+  // of their data rather than by a thread of their own. If it returns true,
+  // |on_complete| is called once, from any thread, with the status |Run|
+  // would have returned, and |Cancel| makes it complete soon. Otherwise,
+  // |Run| must be called.
+  virtual bool StartAsync(std::function<void(const Status&)> on_complete);
+
   // Non-blocking call to the handler, requesting that it exit the
   // current call to |Run|. The handler should stop processing data
   // as soon is convenient.
@@ -0,0 +1,135 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/replicator/async_handoff_handler.h>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+
+#include <packager/utils/resource_quota.h>
+#include <packager/utils/work_priority.h>
+
+namespace shaka {
+namespace media {
+
+AsyncHandoffHandler::AsyncHandoffHandler(size_t queue_capacity)
+    : queue_capacity_(queue_capacity) {
+  DCHECK_GT(queue_capacity_, 0u);
+}
+
+AsyncHandoffHandler::~AsyncHandoffHandler() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopped_ = true;
+    not_empty_.SignalAll();
+    not_full_.SignalAll();
+    flush_completed_.SignalAll();
+  }
+  if (worker_)
+    worker_->join();
+}
+
+Status AsyncHandoffHandler::InitializeInternal() {
+  if (num_input_streams() != 1 || next_output_stream_index() != 1) {
+    return Status(error::INVALID_ARGUMENT,
+                  "AsyncHandoffHandler supports exactly one input and one "
+                  "output.");
+  }
+  DCHECK(!worker_);
+  // The worker takes the priority and the resource quota of the job
+  // initializing the handler.
+  worker_.reset(new std::thread(&AsyncHandoffHandler::WorkerLoop, this,
+                                WorkPriority::IsBackground(),
+                                ResourceQuota::current()));
+  return Status::OK;
+}
+
+Status AsyncHandoffHandler::Process(std::unique_ptr<StreamData> stream_data) {
+  absl::MutexLock lock(&mutex_);
+  if (queue_.size() >= queue_capacity_) {
+    const auto wait_start = std::chrono::steady_clock::now();
+    while (queue_.size() >= queue_capacity_ && downstream_status_.ok() &&
+           !stopped_) {
+      not_full_.Wait(&mutex_);
+    }
+    AddBlockedTime(wait_start);
+  }
+  if (!downstream_status_.ok())
+    return downstream_status_;
+  if (stopped_)
+    return Status(error::STOPPED, "AsyncHandoffHandler is stopped.");
+
+  if (queue_.empty())
+    not_empty_.Signal();
+  queue_.push_back(std::move(stream_data));
+  return Status::OK;
+}
+
+Status AsyncHandoffHandler::OnFlushRequest(size_t input_stream_index) {
+  DCHECK_EQ(input_stream_index, 0u);
+
+  absl::MutexLock lock(&mutex_);
+  // Flush requests are not subject to the queue capacity so that a flush can
+  // always be delivered, even if the worker has failed.
+  if (queue_.empty())
+    not_empty_.Signal();
+  queue_.push_back(nullptr);
+  const uint64_t flush_id = ++flushes_requested_;
+
+  while (flushes_completed_ < flush_id && !stopped_)
+    flush_completed_.Wait(&mutex_);
+  if (flushes_completed_ < flush_id)
+    return Status(error::STOPPED, "AsyncHandoffHandler is stopped.");
+  return downstream_status_;
+}
+
+void AsyncHandoffHandler::WorkerLoop(bool background,
+                                     std::shared_ptr<ResourceQuota> quota) {
+  if (background)
+    WorkPriority::DedicateThreadToBackgroundWork();
+  ScopedResourceQuota scoped_quota(std::move(quota));
+
+  while (true) {
+    std::unique_ptr<StreamData> stream_data;
+    bool skip = false;
+    {
+      absl::MutexLock lock(&mutex_);
+      while (queue_.empty() && !stopped_)
+        not_empty_.Wait(&mutex_);
+      if (stopped_)
+        return;
+
+      not_full_.Signal();
+      stream_data = std::move(queue_.front());
+      queue_.pop_front();
+      // Once downstream has failed, stream data is dropped; flush requests
+      // are still acknowledged so that the upstream does not block forever.
+      skip = !downstream_status_.ok();
+    }
+
+    const bool is_flush = !stream_data;
+    Status status;
+    if (!skip) {
+      status = is_flush ? FlushDownstream(0) : Dispatch(std::move(stream_data));
+      if (!status.ok())
+        LOG(ERROR) << "Downstream failed in AsyncHandoffHandler: " << status;
+    }
+
+    absl::MutexLock lock(&mutex_);
+    if (!status.ok() && downstream_status_.ok()) {
+      downstream_status_ = status;
+      // Unblock a producer waiting on capacity so it sees the error.
+      not_full_.SignalAll();
+    }
+    if (is_flush) {
+      ++flushes_completed_;
+      flush_completed_.SignalAll();
+    }
+  }
+}
+
+}  // namespace media
+}  // namespace shaka
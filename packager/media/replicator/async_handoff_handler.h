@@ -0,0 +1,81 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_REPLICATOR_ASYNC_HANDOFF_HANDLER_H_
+#define PACKAGER_MEDIA_REPLICATOR_ASYNC_HANDOFF_HANDLER_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <thread>
+
+#include <absl/synchronization/mutex.h>
+
+#include <packager/media/base/media_handler.h>
+
+namespace shaka {
+
+class ResourceQuota;
+
+namespace media {
+
+/// AsyncHandoffHandler moves the work of its downstream handlers off the
+/// calling thread. Stream data received in Process() is put in a bounded queue
+/// and dispatched downstream from a dedicated worker thread, so that each
+/// output branch of a Replicator can run on its own core.
+///
+/// It is a single input single output handler which preserves the ordering
+/// guarantees of a synchronous graph:
+///   - Stream data is dispatched downstream in the order it was received.
+///   - OnFlushRequest() blocks until all the stream data queued before it has
+///     been dispatched and the downstream flush has completed.
+///   - The first error returned downstream is latched and returned from all
+///     subsequent calls to Process() and OnFlushRequest().
+class AsyncHandoffHandler : public MediaHandler {
+ public:
+  /// @param queue_capacity is the maximum number of stream data that can be
+  ///        queued before Process() blocks. Must be positive.
+  explicit AsyncHandoffHandler(size_t queue_capacity);
+  ~AsyncHandoffHandler() override;
+
+ protected:
+  /// @name MediaHandler implementation overrides.
+  /// @{
+  Status InitializeInternal() override;
+  Status Process(std::unique_ptr<StreamData> stream_data) override;
+  Status OnFlushRequest(size_t input_stream_index) override;
+  /// @}
+
+ private:
+  AsyncHandoffHandler(const AsyncHandoffHandler&) = delete;
+  AsyncHandoffHandler& operator=(const AsyncHandoffHandler&) = delete;
+
+  // Pulls stream data from |queue_| and dispatches it downstream until
+  // |stopped_| is set. |background| is whether the work of the handler is
+  // background work, see WorkPriority, and |quota| is its resource quota.
+  void WorkerLoop(bool background, std::shared_ptr<ResourceQuota> quota);
+
+  const size_t queue_capacity_;
+
+  absl::Mutex mutex_;
+  absl::CondVar not_empty_ ABSL_GUARDED_BY(mutex_);
+  absl::CondVar not_full_ ABSL_GUARDED_BY(mutex_);
+  absl::CondVar flush_completed_ ABSL_GUARDED_BY(mutex_);
+  // Pending stream data. A null entry marks a flush request.
+  std::deque<std::unique_ptr<StreamData>> queue_ ABSL_GUARDED_BY(mutex_);
+  // The first error returned by the downstream handlers.
+  Status downstream_status_ ABSL_GUARDED_BY(mutex_);
+  uint64_t flushes_requested_ ABSL_GUARDED_BY(mutex_) = 0;
+  uint64_t flushes_completed_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+
+  std::unique_ptr<std::thread> worker_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_REPLICATOR_ASYNC_HANDOFF_HANDLER_H_
@@ -0,0 +1,123 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/replicator/async_handoff_handler.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <packager/media/base/media_handler_test_base.h>
+#include <packager/status/status_test_util.h>
+
+using ::testing::_;
+
+namespace shaka {
+namespace media {
+namespace {
+
+const size_t kInputCount = 1;
+const size_t kOutputCount = 1;
+const size_t kInputIndex = 0;
+const size_t kOutputIndex = 0;
+const size_t kStreamIndex = 0;
+const size_t kQueueCapacity = 2;
+const int32_t kTimescale = 1000;
+const int64_t kDuration = 100;
+const bool kKeyFrame = true;
+const bool kEncrypted = true;
+
+// A downstream handler which fails on every media sample.
+class FailingMediaHandler : public MediaHandler {
+ private:
+  Status InitializeInternal() override { return Status::OK; }
+  Status Process(std::unique_ptr<StreamData> stream_data) override {
+    if (stream_data->stream_data_type == StreamDataType::kMediaSample)
+      return Status(error::MUXER_FAILURE, "Failed to mux.");
+    return Status::OK;
+  }
+  Status OnFlushRequest(size_t) override { return Status::OK; }
+};
+
+}  // namespace
+
+class AsyncHandoffHandlerTest : public MediaHandlerTestBase {
+ protected:
+  Status DispatchVideoInfo() {
+    return Input(kInputIndex)
+        ->Dispatch(StreamData::FromStreamInfo(kStreamIndex,
+                                              GetVideoStreamInfo(kTimescale)));
+  }
+
+  Status DispatchSample(int64_t timestamp) {
+    return Input(kInputIndex)
+        ->Dispatch(StreamData::FromMediaSample(
+            kStreamIndex, GetMediaSample(timestamp, kDuration, kKeyFrame)));
+  }
+
+  Status Flush() { return Input(kInputIndex)->FlushAllDownstreams(); }
+};
+
+TEST_F(AsyncHandoffHandlerTest, DispatchesInOrderBeforeFlushReturns) {
+  ASSERT_OK(SetUpAndInitializeGraph(
+      std::make_shared<AsyncHandoffHandler>(kQueueCapacity), kInputCount,
+      kOutputCount));
+
+  const int kNumSamples = 10;
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*Output(kOutputIndex),
+                OnProcess(IsStreamInfo(kStreamIndex, kTimescale, !kEncrypted,
+                                       _)));
+    for (int i = 0; i < kNumSamples; ++i) {
+      EXPECT_CALL(*Output(kOutputIndex),
+                  OnProcess(IsMediaSample(kStreamIndex, i * kDuration,
+                                          kDuration, !kEncrypted, kKeyFrame)));
+    }
+    EXPECT_CALL(*Output(kOutputIndex), OnFlush(kStreamIndex));
+  }
+
+  ASSERT_OK(DispatchVideoInfo());
+  for (int i = 0; i < kNumSamples; ++i)
+    ASSERT_OK(DispatchSample(i * kDuration));
+  ASSERT_OK(Flush());
+
+  // Everything must have reached downstream by the time Flush() returns.
+  EXPECT_TRUE(testing::Mock::VerifyAndClearExpectations(Output(kOutputIndex)));
+}
+
+TEST_F(AsyncHandoffHandlerTest, PropagatesDownstreamError) {
+  auto input = std::make_shared<FakeInputMediaHandler>();
+  auto handoff = std::make_shared<AsyncHandoffHandler>(kQueueCapacity);
+  ASSERT_OK(MediaHandler::Chain(
+      {input, handoff, std::make_shared<FailingMediaHandler>()}));
+  ASSERT_OK(input->Initialize());
+
+  ASSERT_OK(input->Dispatch(StreamData::FromStreamInfo(
+      kStreamIndex, GetVideoStreamInfo(kTimescale))));
+
+  // The first failure may only be observed on a later call, but it must be
+  // observed no later than the flush.
+  Status status;
+  const int kNumSamples = 10;
+  for (int i = 0; i < kNumSamples && status.ok(); ++i) {
+    status = input->Dispatch(StreamData::FromMediaSample(
+        kStreamIndex, GetMediaSample(i * kDuration, kDuration, kKeyFrame)));
+  }
+  if (status.ok())
+    status = input->FlushAllDownstreams();
+  EXPECT_EQ(error::MUXER_FAILURE, status.error_code());
+
+  // The error is latched.
+  EXPECT_EQ(error::MUXER_FAILURE, input->FlushAllDownstreams().error_code());
+}
+
+TEST_F(AsyncHandoffHandlerTest, RejectsMultipleOutputs) {
+  EXPECT_NOT_OK(SetUpAndInitializeGraph(
+      std::make_shared<AsyncHandoffHandler>(kQueueCapacity), kInputCount, 2));
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -17,16 +17,7 @@ Status Replicator::InitializeInternal() {
 }
 
 Status Replicator::Process(std::unique_ptr<StreamData> stream_data) {
-  Status status;
-
-  for (auto& out : output_handlers()) {
-    std::unique_ptr<StreamData> copy(new StreamData(*stream_data));
-    copy->stream_index = out.first;
-
-    status.Update(Dispatch(std::move(copy)));
-  }
-
-  return status;
+  return DispatchToAllOutputs(std::move(stream_data));
 }
 
 bool Replicator::ValidateOutputStreamIndex(size_t /* ignored */) const {
@@ -6,12 +6,15 @@
 
 #include <packager/media/test/test_web_server.h>
 
+#include <algorithm>
 #include <chrono>
 #include <random>
+#include <string>
 #include <string_view>
 
 #include <absl/strings/numbers.h>
 #include <absl/strings/str_format.h>
+#include <absl/strings/strip.h>
 #include <mongoose.h>
 #include <nlohmann/json.hpp>
 
@@ -21,6 +24,7 @@
 // 1. Reflect the request method, body, and headers
 // 2. Return a requested status code
 // 3. Delay a response by a requested amount of time
+// 4. Fail a number of requests before succeeding
 
 namespace {
 
@@ -208,6 +212,12 @@ void TestWebServer::HandleEvent(struct mg_connection* connection,
   } else if (mg_http_match_uri(message, "/delay")) {
     if (instance->HandleDelay(message, connection))
       return;
+  } else if (mg_http_match_uri(message, "/range")) {
+    if (instance->HandleRange(message, connection))
+      return;
+  } else if (mg_http_match_uri(message, "/flaky")) {
+    if (instance->HandleFlaky(message, connection))
+      return;
   }
 
   mg_http_reply(connection, 400 /* bad request */, NULL /* headers */,
@@ -278,5 +288,70 @@ bool TestWebServer::HandleReflect(struct mg_http_message* message,
   return true;
 }
 
+bool TestWebServer::HandleFlaky(struct mg_http_message* message,
+                                struct mg_connection* connection) {
+  int failures = 0;
+  if (!GetIntQueryParameter(message, "failures", &failures))
+    return false;
+
+  if (flaky_requests_++ < failures) {
+    mg_http_reply(connection, 503 /* service unavailable */, NULL /* headers */,
+                  "%s", "{}");
+    return true;
+  }
+  return HandleReflect(message, connection);
+}
+
+bool TestWebServer::HandleRange(struct mg_http_message* message,
+                                struct mg_connection* connection) {
+  int size = 0;
+  if (!GetIntQueryParameter(message, "size", &size) || size < 0)
+    return false;
+
+  if (MongooseStringView(message->method) == "HEAD") {
+    mg_printf(connection,
+              "HTTP/1.1 200 OK\r\nAccept-Ranges: bytes\r\n"
+              "ETag: \"range-%d\"\r\nContent-Length: %d\r\n\r\n",
+              size, size);
+    return true;
+  }
+  ++range_get_requests_;
+
+  int first = 0;
+  int last = size - 1;
+  struct mg_str* range = mg_http_get_header(message, "Range");
+  const bool is_range_request = range != NULL;
+  if (is_range_request) {
+    // Only "bytes=first-last" is supported.
+    std::string_view value = MongooseStringView(*range);
+    if (!absl::ConsumePrefix(&value, "bytes="))
+      return false;
+    const size_t dash = value.find('-');
+    if (dash == std::string_view::npos ||
+        !absl::SimpleAtoi(value.substr(0, dash), &first) ||
+        !absl::SimpleAtoi(value.substr(dash + 1), &last) || first > last ||
+        first >= size) {
+      return false;
+    }
+    last = std::min(last, size - 1);
+  }
+
+  std::string body;
+  for (int i = first; i <= last; ++i)
+    body.push_back(static_cast<char>(RangeContentByte(i)));
+
+  if (is_range_request) {
+    mg_printf(connection,
+              "HTTP/1.1 206 Partial Content\r\n"
+              "Content-Range: bytes %d-%d/%d\r\nContent-Length: %d\r\n\r\n",
+              first, last, size, static_cast<int>(body.size()));
+  } else {
+    mg_printf(connection, "HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n",
+              static_cast<int>(body.size()));
+  }
+  mg_send(connection, body.data(), body.size());
+  return true;
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -7,8 +7,11 @@
 #ifndef PACKAGER_MEDIA_TEST_TEST_WEB_SERVER_H_
 #define PACKAGER_MEDIA_TEST_TEST_WEB_SERVER_H_
 
+#include <atomic>
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <string>
 #include <thread>
 
 #include <absl/synchronization/mutex.h>
@@ -42,6 +45,23 @@ class TestWebServer {
     return base_url_ + "/delay?seconds=" + std::to_string(seconds);
   }
 
+  // Serves |size| bytes, where byte i is RangeContentByte(i).  Supports HEAD
+  // requests, which return an ETag, and single byte range requests.
+  std::string RangeUrl(int size) {
+    return base_url_ + "/range?size=" + std::to_string(size);
+  }
+
+  static uint8_t RangeContentByte(int position) { return position % 251; }
+
+  // The number of GET requests to RangeUrl().
+  int range_get_requests() const { return range_get_requests_; }
+
+  // Responds with HTTP 503 to the first |failures| requests to this URL, then
+  // reflects the requests as ReflectUrl() does.
+  std::string FlakyUrl(int failures) {
+    return base_url_ + "/flaky?failures=" + std::to_string(failures);
+  }
+
  private:
   enum TestWebServerStatus {
     kNew,
@@ -61,6 +81,11 @@ class TestWebServer {
   // simulate delays.  Only ever accessed from |thread_|.
   std::map<struct mg_connection*, absl::Time> delayed_connections_;
 
+  // The number of requests to FlakyUrl().  Only ever accessed from |thread_|.
+  int flaky_requests_ = 0;
+
+  std::atomic<int> range_get_requests_{0};
+
   std::unique_ptr<std::thread> thread_;
 
   std::string base_url_;
@@ -81,6 +106,10 @@ class TestWebServer {
                    struct mg_connection* connection);
   bool HandleReflect(struct mg_http_message* message,
                      struct mg_connection* connection);
+  bool HandleRange(struct mg_http_message* message,
+                   struct mg_connection* connection);
+  bool HandleFlaky(struct mg_http_message* message,
+                   struct mg_connection* connection);
 };
 
 }  // namespace media
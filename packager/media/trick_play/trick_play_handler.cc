@@ -9,6 +9,7 @@
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 
+#include <packager/macros/status.h>
 #include <packager/media/base/video_stream_info.h>
 #include <packager/status.h>
 
@@ -16,12 +17,19 @@ namespace shaka {
 namespace media {
 namespace {
 const size_t kStreamIndexIn = 0;
-const size_t kStreamIndexOut = 0;
 }  // namespace
 
-TrickPlayHandler::TrickPlayHandler(uint32_t factor) : factor_(factor) {
-  DCHECK_GE(factor, 1u)
-      << "Trick Play Handles must have a factor of 1 or higher.";
+TrickPlayHandler::TrickPlayHandler(uint32_t factor)
+    : TrickPlayHandler(std::vector<uint32_t>{factor}) {}
+
+TrickPlayHandler::TrickPlayHandler(const std::vector<uint32_t>& factors) {
+  DCHECK(!factors.empty());
+  streams_.reserve(factors.size());
+  for (uint32_t factor : factors) {
+    DCHECK_GE(factor, 1u)
+        << "Trick Play Handles must have a factor of 1 or higher.";
+    streams_.emplace_back(factor);
+  }
 }
 
 Status TrickPlayHandler::InitializeInternal() {
@@ -32,26 +40,44 @@ Status TrickPlayHandler::Process(std::unique_ptr<StreamData> stream_data) {
   DCHECK(stream_data);
   DCHECK_EQ(stream_data->stream_index, kStreamIndexIn);
 
-  switch (stream_data->stream_data_type) {
-    case StreamDataType::kStreamInfo:
-      return OnStreamInfo(*stream_data->stream_info);
-
-    case StreamDataType::kSegmentInfo:
-      return OnSegmentInfo(std::move(stream_data->segment_info));
-
-    case StreamDataType::kMediaSample:
-      return OnMediaSample(*stream_data->media_sample);
-
-    case StreamDataType::kCueEvent:
-      // Add the cue event to be dispatched later.
-      delayed_messages_.push_back(std::move(stream_data));
-      return Status::OK;
+  if (stream_data->stream_data_type == StreamDataType::kMediaSample) {
+    total_frames_++;
+    if (stream_data->media_sample->is_key_frame())
+      total_key_frames_++;
+  }
 
-    default:
-      return Status(error::TRICK_PLAY_ERROR,
-                    "Trick play only supports stream info, segment info, and "
-                    "media sample messages.");
+  for (size_t stream_index = 0; stream_index < streams_.size();
+       ++stream_index) {
+    TrickPlayStream* stream = &streams_[stream_index];
+    switch (stream_data->stream_data_type) {
+      case StreamDataType::kStreamInfo:
+        RETURN_IF_ERROR(
+            OnStreamInfo(*stream_data->stream_info, stream_index, stream));
+        break;
+
+      case StreamDataType::kSegmentInfo:
+        RETURN_IF_ERROR(
+            OnSegmentInfo(stream_data->segment_info, stream_index, stream));
+        break;
+
+      case StreamDataType::kMediaSample:
+        RETURN_IF_ERROR(
+            OnMediaSample(*stream_data->media_sample, stream_index, stream));
+        break;
+
+      case StreamDataType::kCueEvent:
+        // Add the cue event to be dispatched later.
+        stream->delayed_messages.push_back(
+            StreamData::FromCueEvent(stream_index, stream_data->cue_event));
+        break;
+
+      default:
+        return Status(error::TRICK_PLAY_ERROR,
+                      "Trick play only supports stream info, segment info, "
+                      "and media sample messages.");
+    }
   }
+  return Status::OK;
 }
 
 Status TrickPlayHandler::OnFlushRequest(size_t input_stream_index) {
@@ -60,15 +86,23 @@ Status TrickPlayHandler::OnFlushRequest(size_t input_stream_index) {
   // Send everything out in its "as-is" state as we no longer need to update
   // anything.
   Status s;
-  while (s.ok() && delayed_messages_.size()) {
-    s.Update(Dispatch(std::move(delayed_messages_.front())));
-    delayed_messages_.pop_front();
+  for (TrickPlayStream& stream : streams_) {
+    while (s.ok() && stream.delayed_messages.size()) {
+      s.Update(Dispatch(std::move(stream.delayed_messages.front())));
+      stream.delayed_messages.pop_front();
+    }
   }
 
   return s.ok() ? MediaHandler::FlushAllDownstreams() : s;
 }
 
-Status TrickPlayHandler::OnStreamInfo(const StreamInfo& info) {
+bool TrickPlayHandler::ValidateOutputStreamIndex(size_t stream_index) const {
+  return stream_index < streams_.size();
+}
+
+Status TrickPlayHandler::OnStreamInfo(const StreamInfo& info,
+                                      size_t stream_index,
+                                      TrickPlayStream* stream) {
   if (info.stream_type() != kStreamVideo) {
     return Status(error::TRICK_PLAY_ERROR,
                   "Trick play does not support non-video stream");
@@ -76,29 +110,30 @@ Status TrickPlayHandler::OnStreamInfo(const StreamInfo& info) {
 
   // Copy the video so we can edit it. Set play back rate to be zero. It will be
   // updated later before being dispatched downstream.
-  video_info_ = std::make_shared<VideoStreamInfo>(
+  stream->video_info = std::make_shared<VideoStreamInfo>(
       static_cast<const VideoStreamInfo&>(info));
 
-  if (video_info_->trick_play_factor() > 0) {
+  if (stream->video_info->trick_play_factor() > 0) {
     return Status(error::TRICK_PLAY_ERROR,
                   "This stream is already a trick play stream.");
   }
 
-  video_info_->set_trick_play_factor(factor_);
-  video_info_->set_playback_rate(0);
+  stream->video_info->set_trick_play_factor(stream->factor);
+  stream->video_info->set_playback_rate(0);
 
   // Add video info to the message queue so that it can be sent out with all
   // other messages. It won't be sent until the second trick play frame comes
-  // through. Until then, it can be updated via the |video_info_| member.
-  delayed_messages_.push_back(
-      StreamData::FromStreamInfo(kStreamIndexOut, video_info_));
+  // through. Until then, it can be updated via the |video_info| member.
+  stream->delayed_messages.push_back(
+      StreamData::FromStreamInfo(stream_index, stream->video_info));
 
   return Status::OK;
 }
 
-Status TrickPlayHandler::OnSegmentInfo(
-    std::shared_ptr<const SegmentInfo> info) {
-  if (delayed_messages_.empty()) {
+Status TrickPlayHandler::OnSegmentInfo(std::shared_ptr<const SegmentInfo> info,
+                                       size_t stream_index,
+                                       TrickPlayStream* stream) {
+  if (stream->delayed_messages.empty()) {
     return Status(error::TRICK_PLAY_ERROR,
                   "Cannot handle segments with no preceding samples.");
   }
@@ -109,14 +144,14 @@ Status TrickPlayHandler::OnSegmentInfo(
   }
 
   const StreamDataType previous_type =
-      delayed_messages_.back()->stream_data_type;
+      stream->delayed_messages.back()->stream_data_type;
 
   switch (previous_type) {
     case StreamDataType::kSegmentInfo:
       // In the case that there was an empty segment (no trick frame between in
       // a segment) extend the previous segment to include the empty segment to
       // avoid holes.
-      previous_segment_->duration += info->duration;
+      stream->previous_segment->duration += info->duration;
       return Status::OK;
 
     case StreamDataType::kMediaSample:
@@ -124,9 +159,9 @@ Status TrickPlayHandler::OnSegmentInfo(
       // Add the segment info to the list of delayed messages. Segment info will
       // not get sent downstream until the next trick play frame comes through
       // or flush is called.
-      previous_segment_ = std::make_shared<SegmentInfo>(*info);
-      delayed_messages_.push_back(
-          StreamData::FromSegmentInfo(kStreamIndexOut, previous_segment_));
+      stream->previous_segment = std::make_shared<SegmentInfo>(*info);
+      stream->delayed_messages.push_back(
+          StreamData::FromSegmentInfo(stream_index, stream->previous_segment));
       return Status::OK;
 
     default:
@@ -136,60 +171,58 @@ Status TrickPlayHandler::OnSegmentInfo(
   }
 }
 
-Status TrickPlayHandler::OnMediaSample(const MediaSample& sample) {
-  total_frames_++;
-
-  if (sample.is_key_frame()) {
-    total_key_frames_++;
+Status TrickPlayHandler::OnMediaSample(const MediaSample& sample,
+                                       size_t stream_index,
+                                       TrickPlayStream* stream) {
+  if (sample.is_key_frame() && (total_key_frames_ - 1) % stream->factor == 0)
+    return OnTrickFrame(sample, stream_index, stream);
 
-    if ((total_key_frames_ - 1) % factor_ == 0) {
-      return OnTrickFrame(sample);
-    }
-  }
   // If the frame is not a trick play frame, then take the duration of this
   // frame and add it to the previous trick play frame so that it will span the
   // gap created by not passing this frame through.
-  DCHECK(previous_trick_frame_);
-  previous_trick_frame_->set_duration(previous_trick_frame_->duration() +
-                                      sample.duration());
+  DCHECK(stream->previous_trick_frame);
+  stream->previous_trick_frame->set_duration(
+      stream->previous_trick_frame->duration() + sample.duration());
 
   return Status::OK;
 }
 
-Status TrickPlayHandler::OnTrickFrame(const MediaSample& sample) {
-  total_trick_frames_++;
+Status TrickPlayHandler::OnTrickFrame(const MediaSample& sample,
+                                      size_t stream_index,
+                                      TrickPlayStream* stream) {
+  stream->total_trick_frames++;
 
   // Make a message we can store until later.
-  previous_trick_frame_ = sample.Clone();
+  stream->previous_trick_frame = sample.Clone();
 
   // Add the message to our queue so that it will be ready to go out.
-  delayed_messages_.push_back(
-      StreamData::FromMediaSample(kStreamIndexOut, previous_trick_frame_));
+  stream->delayed_messages.push_back(
+      StreamData::FromMediaSample(stream_index, stream->previous_trick_frame));
 
   // We need two trick play frames before we can send out our stream info, so we
   // cannot send this media sample until after we send our sample info
   // downstream.
-  if (total_trick_frames_ < 2) {
+  if (stream->total_trick_frames < 2) {
     return Status::OK;
   }
 
   // Update this now as it may be sent out soon via the delay message queue.
-  if (total_trick_frames_ == 2) {
+  if (stream->total_trick_frames == 2) {
     // At this point, video_info will be at the head of the delay message queue
     // and can still be updated safely.
 
     // The play back rate is determined by the number of frames between the
     // first two trick play frames. The first trick play frame will be the
     // first frame in the video.
-    video_info_->set_playback_rate(total_frames_ - 1);
+    stream->video_info->set_playback_rate(total_frames_ - 1);
   }
 
   // Send out all delayed messages up until the new trick play frame we just
   // added.
   Status s;
-  while (s.ok() && delayed_messages_.size() > 1) {
-    s.Update(Dispatch(std::move(delayed_messages_.front())));
-    delayed_messages_.pop_front();
+  while (s.ok() && stream->delayed_messages.size() > 1) {
+    s.Update(Dispatch(std::move(stream->delayed_messages.front())));
+    stream->delayed_messages.pop_front();
   }
   return s;
 }
@@ -40,6 +40,12 @@ class TrickPlayHandlerTest : public MediaHandlerTestBase {
         std::make_shared<TrickPlayHandler>(factor), kInputCount, kOutputCount));
   }
 
+  void SetUpAndInitializeGraph(const std::vector<uint32_t>& factors) {
+    ASSERT_OK(MediaHandlerTestBase::SetUpAndInitializeGraph(
+        std::make_shared<TrickPlayHandler>(factors), kInputCount,
+        factors.size()));
+  }
+
   Status DispatchVideoInfo() {
     auto info = GetVideoStreamInfo(kTimescale);
     auto data = StreamData::FromStreamInfo(kStreamIndex, std::move(info));
@@ -302,5 +308,59 @@ TEST_F(TrickPlayHandlerTest, TrickTrackWithSamplesAndSegments) {
   ASSERT_OK(Flush());
 }
 
+// This test makes sure that a single handler makes the trick play streams of
+// several factors, each on its own output.
+TEST_F(TrickPlayHandlerTest, TrickTracksWithSeveralFactors) {
+  const uint32_t kTrickPlayFactor1 = 1u;
+  const uint32_t kTrickPlayFactor2 = 2u;
+  const size_t kOutputIndex1 = 0;
+  const size_t kOutputIndex2 = 1;
+
+  const int64_t kFrameDuration = 100;
+  const int64_t kFrame0 = 0;
+  const int64_t kFrame2 = 200;
+  const int64_t kFrame4 = 400;
+  const int64_t kFrame6 = 600;
+
+  // Key frame every two frames.
+  const int64_t kPlayRate1 = 2;
+  const int64_t kTrickPlayDuration1 = kFrameDuration * 2;
+  const int64_t kPlayRate2 = 4;
+  const int64_t kTrickPlayDuration2 = kFrameDuration * 4;
+
+  SetUpAndInitializeGraph({kTrickPlayFactor1, kTrickPlayFactor2});
+
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*Output(kOutputIndex1),
+                OnProcess(IsVideoStream(_, kTrickPlayFactor1, kPlayRate1)));
+    for (int64_t frame : {kFrame0, kFrame2, kFrame4, kFrame6}) {
+      EXPECT_CALL(*Output(kOutputIndex1),
+                  OnProcess(IsMediaSample(_, frame, kTrickPlayDuration1, _,
+                                          kKeyFrame)));
+    }
+    EXPECT_CALL(*Output(kOutputIndex1), OnFlush(_));
+  }
+
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*Output(kOutputIndex2),
+                OnProcess(IsVideoStream(_, kTrickPlayFactor2, kPlayRate2)));
+    for (int64_t frame : {kFrame0, kFrame4}) {
+      EXPECT_CALL(*Output(kOutputIndex2),
+                  OnProcess(IsMediaSample(_, frame, kTrickPlayDuration2, _,
+                                          kKeyFrame)));
+    }
+    EXPECT_CALL(*Output(kOutputIndex2), OnFlush(_));
+  }
+
+  ASSERT_OK(DispatchVideoInfo());
+  for (int64_t frame = 0; frame < 8; ++frame) {
+    ASSERT_OK(
+        DispatchSample(frame * kFrameDuration, kFrameDuration, frame % 2 == 0));
+  }
+  ASSERT_OK(Flush());
+}
+
 }  // namespace media
 }  // namespace shaka
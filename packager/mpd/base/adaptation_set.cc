@@ -6,7 +6,9 @@
 
 #include <packager/mpd/base/adaptation_set.h>
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
@@ -257,7 +259,7 @@ bool AdaptationSet::SwitchableAdaptationSet(
   return false;
 }
 
-Representation* AdaptationSet::AddRepresentation(const MediaInfo& media_info) {
+Representation* AdaptationSet::AddRepresentation(MediaInfo media_info) {
   const uint32_t representation_id = media_info.has_index()
                                          ? media_info.index()
                                          : (*representation_counter_)++;
@@ -266,14 +268,15 @@ Representation* AdaptationSet::AddRepresentation(const MediaInfo& media_info) {
   // will die before AdaptationSet.
   std::unique_ptr<RepresentationStateChangeListener> listener(
       new RepresentationStateChangeListenerImpl(representation_id, this));
-  std::unique_ptr<Representation> new_representation(new Representation(
-      media_info, mpd_options_, representation_id, std::move(listener)));
+  std::unique_ptr<Representation> new_representation(
+      new Representation(std::move(media_info), mpd_options_,
+                         representation_id, std::move(listener)));
 
   if (!new_representation->Init()) {
     LOG(ERROR) << "Failed to initialize Representation.";
     return NULL;
   }
-  UpdateFromMediaInfo(media_info);
+  UpdateFromMediaInfo(new_representation->GetMediaInfo());
   Representation* representation_ptr = new_representation.get();
   representation_map_[representation_ptr->id()] = std::move(new_representation);
   return representation_ptr;
@@ -513,21 +516,48 @@ void AdaptationSet::ForceStartwithSAP(uint32_t sap_value) {
   start_with_sap_ = sap_value;
 }
 
-// For dynamic MPD, storing all start_time and duration will out-of-memory
-// because there's no way of knowing when it will end. Static MPD
-// subsegmentAlignment check is *not* done here because it is possible that some
+// Each segment is checked against the segment with the same index of the
+// other Representations as it is added. This assumes that each
+// Representation's segments are contiguous.
+// For static MPD, subsegmentAlignment is only settled in
+// CheckStaticSegmentAlignment() because it is possible that some
 // Representations might not have been added yet (e.g. a thread is assigned per
-// muxer so one might run faster than others). To be clear, for dynamic MPD, all
+// muxer so one might run faster than others). For dynamic MPD, all
 // Representations should be added before a segment is added.
 void AdaptationSet::OnNewSegmentForRepresentation(uint32_t representation_id,
                                                   int64_t start_time,
                                                   int64_t duration) {
-  if (mpd_options_.mpd_type == MpdType::kDynamic) {
-    CheckDynamicSegmentAlignment(representation_id, start_time, duration);
-  } else {
-    representation_segment_start_times_[representation_id].push_back(
-        start_time);
+  if (segments_aligned_ == kSegmentAlignmentFalse ||
+      force_set_segment_alignment_) {
+    return;
   }
+
+  SegmentCursor& cursor = representation_segment_cursors_[representation_id];
+  const uint64_t index = cursor.num_segments++;
+  cursor.end_time = start_time + duration;
+  if (index >= first_segment_index_ + segment_start_times_.size()) {
+    // The first Representation to reach this segment.
+    segment_start_times_.push_back(start_time);
+  } else if (index >= first_segment_index_) {
+    const int64_t expected_start_time =
+        segment_start_times_[index - first_segment_index_];
+    if (expected_start_time != start_time) {
+      VLOG(1) << "Seeing Misaligned segments with different start_times: "
+              << expected_start_time << " vs " << start_time;
+      // Flag as false and clear the start times data, no need to keep it
+      // around.
+      segments_aligned_ = kSegmentAlignmentFalse;
+      representation_segment_cursors_.clear();
+      segment_start_times_.clear();
+      return;
+    }
+  }
+  // Otherwise the start time was dropped, which only happens if the
+  // Representation was added after segments of dynamic MPD, and it cannot be
+  // checked.
+
+  if (mpd_options_.mpd_type == MpdType::kDynamic)
+    UpdateDynamicSegmentAlignment();
 }
 
 void AdaptationSet::OnSetFrameRateForRepresentation(uint32_t representation_id,
@@ -595,133 +625,69 @@ void AdaptationSet::UpdateFromMediaInfo(const MediaInfo& media_info) {
   }
 }
 
-// This implementation assumes that each representations' segments' are
-// contiguous.
-// Also assumes that all Representations are added before this is called.
-// This checks whether the first elements of the lists in
-// representation_segment_start_times_ are aligned.
-// For example, suppose this method was just called with args rep_id=2
-// start_time=1.
-// 1 -> [1, 100, 200]
-// 2 -> [1]
-// The timestamps of the first elements match, so this flags
-// segments_aligned_=true.
-// Also since the first segment start times match, the first element of all the
-// lists are removed, so the map of lists becomes:
-// 1 -> [100, 200]
-// 2 -> []
-// Note that there could be false positives.
-// e.g. just got rep_id=3 start_time=1 duration=300, and the duration of the
-// whole AdaptationSet is 300.
+// There could be false positives, e.g. just got rep_id=3 start_time=1
+// duration=300, and the duration of the whole AdaptationSet is 300:
 // 1 -> [1, 100, 200]
 // 2 -> [1, 90, 100]
 // 3 -> [1]
-// They are not aligned but this will be marked as aligned.
-// But since this is unlikely to happen in the packager (and to save
-// computation), this isn't handled at the moment.
-void AdaptationSet::CheckDynamicSegmentAlignment(uint32_t representation_id,
-                                                 int64_t start_time,
-                                                 int64_t /* duration */) {
-  if (segments_aligned_ == kSegmentAlignmentFalse ||
-      force_set_segment_alignment_) {
-    return;
-  }
-
-  std::list<int64_t>& current_representation_start_times =
-      representation_segment_start_times_[representation_id];
-  current_representation_start_times.push_back(start_time);
+// They are not aligned but this will be marked as aligned until the second
+// segment of 3 is added. But since this is unlikely to happen in the packager,
+// this isn't handled at the moment.
+void AdaptationSet::UpdateDynamicSegmentAlignment() {
   // There's no way to detemine whether the segments are aligned if some
   // representations do not have any segments.
-  if (representation_segment_start_times_.size() != representation_map_.size())
+  if (representation_segment_cursors_.size() != representation_map_.size())
     return;
 
-  DCHECK(!current_representation_start_times.empty());
-  const int64_t expected_start_time =
-      current_representation_start_times.front();
-  for (const auto& key_value : representation_segment_start_times_) {
-    const std::list<int64_t>& representation_start_time = key_value.second;
-    // If there are no entries in a list, then there is no way for the
-    // segment alignment status to change.
-    // Note that it can be empty because entries get deleted below.
-    if (representation_start_time.empty())
-      return;
-
-    if (expected_start_time != representation_start_time.front()) {
-      VLOG(1) << "Seeing Misaligned segments with different start_times: "
-              << expected_start_time << " vs "
-              << representation_start_time.front();
-      // Flag as false and clear the start times data, no need to keep it
-      // around.
-      segments_aligned_ = kSegmentAlignmentFalse;
-      representation_segment_start_times_.clear();
-      return;
-    }
+  uint64_t min_num_segments = std::numeric_limits<uint64_t>::max();
+  for (const auto& key_value : representation_segment_cursors_) {
+    min_num_segments =
+        std::min(min_num_segments, key_value.second.num_segments);
   }
+  DCHECK_GT(min_num_segments, 0u);
   segments_aligned_ = kSegmentAlignmentTrue;
 
-  for (auto& key_value : representation_segment_start_times_) {
-    std::list<int64_t>& representation_start_time = key_value.second;
-    representation_start_time.pop_front();
+  while (first_segment_index_ < min_num_segments &&
+         !segment_start_times_.empty()) {
+    segment_start_times_.pop_front();
+    ++first_segment_index_;
   }
 }
 
-// Make sure all segements start times match for all Representations.
-// This assumes that the segments are contiguous.
+// Make sure all segements start times match for all Representations, which
+// OnNewSegmentForRepresentation() did as they were added, and that their last
+// segments end at the same time.
 void AdaptationSet::CheckStaticSegmentAlignment() {
   if (segments_aligned_ == kSegmentAlignmentFalse ||
       force_set_segment_alignment_) {
     return;
   }
-  if (representation_segment_start_times_.empty())
-    return;
-  if (representation_segment_start_times_.size() == 1) {
-    segments_aligned_ = kSegmentAlignmentTrue;
+  if (representation_segment_cursors_.empty())
     return;
-  }
-
-  // This is not the most efficient implementation to compare the values
-  // because expected_time_line is compared against all other time lines, but
-  // probably the most readable.
-  const std::list<int64_t>& expected_time_line =
-      representation_segment_start_times_.begin()->second;
-
-  bool all_segment_time_line_same_length = true;
-  // Note that the first entry is skipped because it is expected_time_line.
-  RepresentationTimeline::const_iterator it =
-      representation_segment_start_times_.begin();
-  for (++it; it != representation_segment_start_times_.end(); ++it) {
-    const std::list<int64_t>& other_time_line = it->second;
-    if (expected_time_line.size() != other_time_line.size()) {
-      all_segment_time_line_same_length = false;
-    }
 
-    const std::list<int64_t>* longer_list = &other_time_line;
-    const std::list<int64_t>* shorter_list = &expected_time_line;
-    if (expected_time_line.size() > other_time_line.size()) {
-      shorter_list = &other_time_line;
-      longer_list = &expected_time_line;
+  const SegmentCursor& expected_cursor =
+      representation_segment_cursors_.begin()->second;
+  for (const auto& key_value : representation_segment_cursors_) {
+    const SegmentCursor& cursor = key_value.second;
+    // For example:
+    // (a)  3 4 5
+    // (b)  3 4 5 6
+    // could be true or false depending on the length of the third segment of
+    // (a), i.e. if length of the third segment is 2, then this is not aligned.
+    // It is not settled until (a) has the same number of segments.
+    if (cursor.num_segments != expected_cursor.num_segments) {
+      segments_aligned_ = kSegmentAlignmentUnknown;
+      return;
     }
-
-    if (!std::equal(shorter_list->begin(), shorter_list->end(),
-                    longer_list->begin())) {
-      // Some segments are definitely unaligned.
+    if (cursor.end_time != expected_cursor.end_time) {
+      VLOG(1) << "Seeing Misaligned segments with different end times: "
+              << expected_cursor.end_time << " vs " << cursor.end_time;
       segments_aligned_ = kSegmentAlignmentFalse;
-      representation_segment_start_times_.clear();
+      representation_segment_cursors_.clear();
+      segment_start_times_.clear();
       return;
     }
   }
-
-  // TODO(rkuroiwa): The right way to do this is to also check the durations.
-  // For example:
-  // (a)  3 4 5
-  // (b)  3 4 5 6
-  // could be true or false depending on the length of the third segment of (a).
-  // i.e. if length of the third segment is 2, then this is not aligned.
-  if (!all_segment_time_line_same_length) {
-    segments_aligned_ = kSegmentAlignmentUnknown;
-    return;
-  }
-
   segments_aligned_ = kSegmentAlignmentTrue;
 }
 
@@ -10,6 +10,7 @@
 #define PACKAGER_MPD_BASE_ADAPTATION_SET_H_
 
 #include <cstdint>
+#include <deque>
 #include <list>
 #include <map>
 #include <memory>
@@ -62,7 +63,7 @@ class AdaptationSet {
   ///        AudioInfo, or TextInfo, i.e. VideoInfo XOR AudioInfo XOR TextInfo.
   /// @return On success, returns a pointer to Representation. Otherwise returns
   ///         NULL. The returned pointer is owned by the AdaptationSet instance.
-  virtual Representation* AddRepresentation(const MediaInfo& media_info);
+  virtual Representation* AddRepresentation(MediaInfo media_info);
 
   /// Copy a Representation instance from @a representation in another
   /// AdaptationSet. One use case is to duplicate Representation in different
@@ -286,31 +287,25 @@ class AdaptationSet {
     kSegmentAlignmentFalse
   };
 
-  // This maps Representations (IDs) to a list of start times of the segments.
-  // e.g.
-  // If Representation 1 has start time 0, 100, 200 and Representation 2 has
-  // start times 0, 200, 400, then the map contains:
-  // 1 -> [0, 100, 200]
-  // 2 -> [0, 200, 400]
-  typedef std::map<uint32_t, std::list<int64_t>> RepresentationTimeline;
+  // The position of a Representation in the segment timeline.
+  struct SegmentCursor {
+    // The number of segments added to the Representation.
+    uint64_t num_segments = 0;
+    // The end time of its last segment.
+    int64_t end_time = 0;
+  };
 
   // Update AdaptationSet attributes for new MediaInfo.
   void UpdateFromMediaInfo(const MediaInfo& media_info);
 
-  /// Called from OnNewSegmentForRepresentation(). Checks whether the segments
-  /// are aligned. Sets segments_aligned_.
-  /// This is only for dynamic MPD. For static MPD,
-  /// CheckStaticSegmentAlignment() should be used.
-  /// @param representation_id is the id of the Representation with a new
-  ///        segment.
-  /// @param start_time is the start time of the new segment.
-  /// @param duration is the duration of the new segment.
-  void CheckDynamicSegmentAlignment(uint32_t representation_id,
-                                    int64_t start_time,
-                                    int64_t duration);
+  // Called from OnNewSegmentForRepresentation() for dynamic MPD, once the
+  // segment is checked against segment_start_times_. Sets segments_aligned_
+  // once all the Representations have reached a segment, and drops the start
+  // times which all of them have passed.
+  void UpdateDynamicSegmentAlignment();
 
-  // Checks representation_segment_start_times_ and sets segments_aligned_.
-  // Use this for static MPD, do not use for dynamic MPD.
+  // Sets segments_aligned_ from the segments added so far, which must all be
+  // added. Use this for static MPD, do not use for dynamic MPD.
   void CheckStaticSegmentAlignment();
 
   // Records the framerate of a Representation.
@@ -381,14 +376,18 @@ class AdaptationSet {
   // The stream access point for segment
   uint8_t start_with_sap_ = 0;
 
-  // Keeps track of segment start times of Representations.
-  // For static MPD, this will not be cleared, all the segment start times are
-  // stored in this. This should not out-of-memory for a reasonable length
-  // video and reasonable subsegment length.
-  // For dynamic MPD, the entries are deleted (see
-  // CheckDynamicSegmentAlignment() implementation comment) because storing the
-  // entire timeline is not reasonable and may cause an out-of-memory problem.
-  RepresentationTimeline representation_segment_start_times_;
+  // Representation ID => its position in the segment timeline, for the
+  // Representations with segments.
+  std::map<uint32_t, SegmentCursor> representation_segment_cursors_;
+  // The start times of the segments from the (first_segment_index_)th one, as
+  // added by the first Representation to reach each of them. Every other
+  // Representation is checked against them as its segments are added.
+  // For dynamic MPD, the start times which all the Representations have passed
+  // are dropped, so this only spans the lag between the Representations.
+  // For static MPD, Representations may still be added, so the start times are
+  // kept, once per AdaptationSet.
+  std::deque<int64_t> segment_start_times_;
+  uint64_t first_segment_index_ = 0;
 
   // Record the original AdaptationSets the trick play stream belongs to. There
   // can be more than one reference AdaptationSets as multiple streams e.g. SD
@@ -869,6 +869,56 @@ TEST_F(LiveAdaptationSetTest, SegmentAlignmentStaticMpd) {
   EXPECT_THAT(aligned, AttributeEqual("segmentAlignment", "true"));
 }
 
+// Verify that the last segments of a static MPD must end at the same time.
+TEST_F(LiveAdaptationSetTest, SegmentAlignmentStaticMpdLastSegmentDuration) {
+  const int64_t kStartTime = 0;
+  const int64_t kDuration = 10;
+  const uint64_t kAnySize = 19834u;
+
+  const char k480pMediaInfo[] =
+      "video_info {\n"
+      "  codec: 'avc1'\n"
+      "  width: 720\n"
+      "  height: 480\n"
+      "  time_scale: 10\n"
+      "  frame_duration: 10\n"
+      "  pixel_width: 8\n"
+      "  pixel_height: 9\n"
+      "}\n"
+      "container_type: 1\n";
+  const char k360pMediaInfo[] =
+      "video_info {\n"
+      "  codec: 'avc1'\n"
+      "  width: 640\n"
+      "  height: 360\n"
+      "  time_scale: 10\n"
+      "  frame_duration: 10\n"
+      "  pixel_width: 1\n"
+      "  pixel_height: 1\n"
+      "}\n"
+      "container_type: 1\n";
+
+  mpd_options_.mpd_type = MpdType::kStatic;
+
+  auto adaptation_set = CreateAdaptationSet(kNoLanguage);
+  Representation* representation_480p =
+      adaptation_set->AddRepresentation(ConvertToMediaInfo(k480pMediaInfo));
+  Representation* representation_360p =
+      adaptation_set->AddRepresentation(ConvertToMediaInfo(k360pMediaInfo));
+
+  representation_480p->AddNewSegment(kStartTime, kDuration, kAnySize,
+                                     kAnySegmentNumber);
+  representation_360p->AddNewSegment(kStartTime, kDuration, kAnySize,
+                                     kAnySegmentNumber);
+  representation_480p->AddNewSegment(kStartTime + kDuration, kDuration,
+                                     kAnySize, kAnySegmentNumber);
+  representation_360p->AddNewSegment(kStartTime + kDuration, kDuration / 2,
+                                     kAnySize, kAnySegmentNumber);
+
+  auto unaligned = adaptation_set->GetXml();
+  EXPECT_THAT(unaligned, Not(AttributeSet("segmentAlignment")));
+}
+
 // Verify that the width and height attribute are set if all the video
 // representations have the same width and height.
 TEST_F(OnDemandAdaptationSetTest, AdapatationSetWidthAndHeight) {
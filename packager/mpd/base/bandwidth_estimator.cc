@@ -17,7 +17,8 @@
 
 namespace shaka {
 
-BandwidthEstimator::BandwidthEstimator() = default;
+BandwidthEstimator::BandwidthEstimator(size_t num_blocks)
+    : num_blocks_(num_blocks) {}
 
 BandwidthEstimator::~BandwidthEstimator() = default;
 
@@ -30,8 +31,21 @@ void BandwidthEstimator::AddBlock(uint64_t size_in_bytes, double duration) {
 
   const int kBitsInByte = 8;
   const uint64_t size_in_bits = size_in_bytes * kBitsInByte;
+  const uint64_t block_index = num_added_blocks_++;
   total_size_in_bits_ += size_in_bits;
   total_duration_ += duration;
+  if (num_blocks_ != 0) {
+    window_blocks_.push_back({size_in_bits, duration});
+    if (window_blocks_.size() > num_blocks_) {
+      total_size_in_bits_ -= window_blocks_.front().size_in_bits;
+      total_duration_ -= window_blocks_.front().duration;
+      window_blocks_.pop_front();
+    }
+    while (!max_bitrates_.empty() &&
+           IsExpired(max_bitrates_.front().block_index)) {
+      max_bitrates_.pop_front();
+    }
+  }
 
   const size_t kTargetDurationThreshold = 10;
   if (initial_blocks_.size() < kTargetDurationThreshold) {
@@ -43,40 +57,57 @@ void BandwidthEstimator::AddBlock(uint64_t size_in_bytes, double duration) {
     // Use the average duration as the target block duration. It will be used
     // to filter small blocks from bandwidth calculation.
     target_block_duration_ = GetAverageBlockDuration();
-    for (const Block& block : initial_blocks_) {
-      max_bitrate_ =
-          std::max(max_bitrate_, GetBitrate(block, target_block_duration_));
-    }
+    for (size_t i = 0; i < initial_blocks_.size(); ++i)
+      AddBitrate(i, GetBitrate(initial_blocks_[i], target_block_duration_));
     return;
   }
-  max_bitrate_ = std::max(max_bitrate_, GetBitrate({size_in_bits, duration},
-                                                   target_block_duration_));
+  AddBitrate(block_index,
+             GetBitrate({size_in_bits, duration}, target_block_duration_));
 }
 
 uint64_t BandwidthEstimator::Estimate() const {
-  if (total_duration_ == 0)
+  if (total_duration_ <= 0)
     return 0;
   return static_cast<uint64_t>(ceil(total_size_in_bits_ / total_duration_));
 }
 
 uint64_t BandwidthEstimator::Max() const {
-  if (max_bitrate_ != 0)
-    return max_bitrate_;
+  if (!max_bitrates_.empty() && max_bitrates_.front().bitrate != 0)
+    return max_bitrates_.front().bitrate;
 
   // We don't have the |target_block_duration_| yet. Calculate a target
   // duration from the current available blocks.
-  DCHECK(target_block_duration_ == 0);
+  if (target_block_duration_ != 0)
+    return 0;
   const double target_block_duration = GetAverageBlockDuration();
 
   // Calculate maximum bitrate with the target duration calculated above.
   uint64_t max_bitrate = 0;
-  for (const Block& block : initial_blocks_) {
-    max_bitrate =
-        std::max(max_bitrate, GetBitrate(block, target_block_duration));
+  for (size_t i = 0; i < initial_blocks_.size(); ++i) {
+    if (IsExpired(i))
+      continue;
+    max_bitrate = std::max(
+        max_bitrate, GetBitrate(initial_blocks_[i], target_block_duration));
   }
   return max_bitrate;
 }
 
+void BandwidthEstimator::AddBitrate(uint64_t block_index, uint64_t bitrate) {
+  if (IsExpired(block_index))
+    return;
+  // The smaller bitrates of the older blocks can no longer be the max.
+  while (!max_bitrates_.empty() && max_bitrates_.back().bitrate <= bitrate)
+    max_bitrates_.pop_back();
+  // Only the max is needed if the blocks never expire.
+  if (num_blocks_ == 0 && !max_bitrates_.empty())
+    return;
+  max_bitrates_.push_back({block_index, bitrate});
+}
+
+bool BandwidthEstimator::IsExpired(uint64_t block_index) const {
+  return num_blocks_ != 0 && block_index + num_blocks_ < num_added_blocks_;
+}
+
 double BandwidthEstimator::GetAverageBlockDuration() const {
   if (initial_blocks_.empty())
     return 0.0;
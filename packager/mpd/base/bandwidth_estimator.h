@@ -7,14 +7,20 @@
 #ifndef MPD_BASE_BANDWIDTH_ESTIMATOR_H_
 #define MPD_BASE_BANDWIDTH_ESTIMATOR_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <vector>
 
 namespace shaka {
 
 class BandwidthEstimator {
  public:
-  BandwidthEstimator();
+  /// @param num_blocks is the number of most recent blocks the estimates are
+  ///        computed from. All the blocks are used if it is 0. The memory
+  ///        used is bounded by @a num_blocks otherwise, so that it does not
+  ///        grow with the lifetime of a live stream.
+  explicit BandwidthEstimator(size_t num_blocks = 0);
   ~BandwidthEstimator();
 
   /// @param size is the size of the block in bytes. Should be positive.
@@ -41,20 +47,36 @@ class BandwidthEstimator {
     uint64_t size_in_bits;
     double duration;
   };
+  struct BlockBitrate {
+    uint64_t block_index;
+    uint64_t bitrate;
+  };
   // Return the average block duration of the blocks in |initial_blocks_|.
   double GetAverageBlockDuration() const;
   // Return the bitrate of the block. Note that a bitrate of 0 is returned if
   // the block duration is less than 50% of target block duration.
   uint64_t GetBitrate(const Block& block, double target_block_duration) const;
+  // Add the bitrate of the block at |block_index| for the max bandwidth.
+  void AddBitrate(uint64_t block_index, uint64_t bitrate);
+  // Return true if the block at |block_index| is out of the window.
+  bool IsExpired(uint64_t block_index) const;
+
+  const size_t num_blocks_;
+  uint64_t num_added_blocks_ = 0;
 
   std::vector<Block> initial_blocks_;
   // Target block duration will be estimated from the average duration of the
   // initial blocks.
   double target_block_duration_ = 0;
 
+  // The blocks in the window. Only kept if |num_blocks_| is not 0.
+  std::deque<Block> window_blocks_;
   uint64_t total_size_in_bits_ = 0;
   double total_duration_ = 0;
-  uint64_t max_bitrate_ = 0;
+  // The bitrates which are the max of the window, now or once the blocks
+  // before them expire. The bitrates decrease from the front, which is the
+  // max bitrate. It holds a single bitrate if |num_blocks_| is 0.
+  std::deque<BlockBitrate> max_bitrates_;
 };
 
 }  // namespace shaka
@@ -63,4 +63,34 @@ TEST(BandwidthEstimatorTest, ExcludeShortBlocksMore) {
   EXPECT_EQ(kExpectedMax, be.Max());
 }
 
-} // namespace shaka
+TEST(BandwidthEstimatorTest, Window) {
+  const double kDuration = 1.0;
+  const size_t kNumBlocks = 5;
+  BandwidthEstimator be(kNumBlocks);
+
+  // Bitrates go up, then down. The estimates only follow the last 5 blocks.
+  const uint64_t kNumBlocksToAdd = 100;
+  for (uint64_t i = 1; i <= kNumBlocksToAdd; ++i)
+    be.AddBlock(i, kDuration);
+  EXPECT_EQ(98 * kBitsInByte, be.Estimate());
+  EXPECT_EQ(100 * kBitsInByte, be.Max());
+
+  for (uint64_t i = kNumBlocksToAdd; i >= 1; --i)
+    be.AddBlock(i, kDuration);
+  EXPECT_EQ(3 * kBitsInByte, be.Estimate());
+  EXPECT_EQ(5 * kBitsInByte, be.Max());
+}
+
+TEST(BandwidthEstimatorTest, WindowWithInitialBlocks) {
+  const double kDuration = 1.0;
+  BandwidthEstimator be(2);
+
+  be.AddBlock(10, kDuration);
+  be.AddBlock(1, kDuration);
+  be.AddBlock(2, kDuration);
+  // The first block is out of the window.
+  EXPECT_EQ(2 * kBitsInByte, be.Max());
+  EXPECT_EQ(static_cast<uint64_t>(1.5 * kBitsInByte), be.Estimate());
+}
+
+}  // namespace shaka
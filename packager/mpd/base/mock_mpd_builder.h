@@ -26,6 +26,8 @@ class MockMpdBuilder : public MpdBuilder {
 
   MOCK_METHOD1(GetOrCreatePeriod, Period*(double start_time_in_seconds));
   MOCK_METHOD1(ToString, bool(std::string* output));
+  MOCK_METHOD2(ToStringWithPatch,
+               bool(std::string* output, std::string* patch));
 };
 
 class MockPeriod : public Period {
@@ -46,7 +48,7 @@ class MockAdaptationSet : public AdaptationSet {
   MockAdaptationSet();
   ~MockAdaptationSet() override;
 
-  MOCK_METHOD1(AddRepresentation, Representation*(const MediaInfo& media_info));
+  MOCK_METHOD1(AddRepresentation, Representation*(MediaInfo media_info));
   MOCK_METHOD1(CopyRepresentation,
                Representation*(const Representation& representation));
   MOCK_METHOD1(AddContentProtectionElement,
@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <chrono>
 #include <filesystem>
+#include <iterator>
 #include <optional>
 
 #include <absl/log/check.h>
@@ -88,12 +89,28 @@ std::string XmlDateTimeNowWithOffset(int32_t offset_seconds, Clock* clock) {
   return ss.str();
 }
 
+// Same as above with milliseconds, for |time|.
+std::string XmlDateTimeWithMilliseconds(Clock::time_point time) {
+  auto time_t = std::chrono::system_clock::to_time_t(
+      std::chrono::time_point_cast<std::chrono::seconds>(time));
+  std::tm* tm = std::gmtime(&time_t);
+  const int64_t milliseconds =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          time.time_since_epoch())
+          .count() %
+      1000;
+
+  std::stringstream ss;
+  ss << std::put_time(tm, "%Y-%m-%dT%H:%M:%S");
+  return absl::StrFormat("%s.%03dZ", ss.str(), milliseconds);
+}
+
 bool SetIfPositive(const char* attr_name, double value, XmlNode* mpd) {
   return !Positive(value) ||
          mpd->SetStringAttribute(attr_name, SecondsToXmlDuration(value));
 }
 
-// Spooky static initialization/cleanup of libxml.
+// Initialization of libxml on first use, and cleanup at exit.
 class LibXmlInitializer {
  public:
   LibXmlInitializer() : initialized_(false) {
@@ -119,6 +136,19 @@ class LibXmlInitializer {
   DISALLOW_COPY_AND_ASSIGN(LibXmlInitializer);
 };
 
+void InitializeLibXml() {
+  static LibXmlInitializer lib_xml_initializer;
+}
+
+std::string GetGeneratedWithComment() {
+  std::string version = GetPackagerVersion();
+  if (!version.empty()) {
+    version = absl::StrFormat("Generated with %s version %s",
+                              GetPackagerProjectUrl().c_str(), version.c_str());
+  }
+  return version;
+}
+
 }  // namespace
 
 MpdBuilder::MpdBuilder(const MpdOptions& mpd_options)
@@ -146,18 +176,45 @@ Period* MpdBuilder::GetOrCreatePeriod(double start_time_in_seconds) {
 
 bool MpdBuilder::ToString(std::string* output) {
   DCHECK(output);
-  static LibXmlInitializer lib_xml_initializer;
+  InitializeLibXml();
 
   auto mpd = GenerateMpd();
   if (!mpd)
     return false;
 
-  std::string version = GetPackagerVersion();
-  if (!version.empty()) {
-    version = absl::StrFormat("Generated with %s version %s",
-                              GetPackagerProjectUrl().c_str(), version.c_str());
+  *output = mpd->ToString(GetGeneratedWithComment());
+  return true;
+}
+
+bool MpdBuilder::ToStringWithPatch(std::string* output, std::string* patch) {
+  DCHECK(output);
+  DCHECK(patch);
+  if (!HasPatches()) {
+    patch->clear();
+    return ToString(output);
+  }
+  InitializeLibXml();
+
+  auto mpd = GenerateMpd();
+  if (!mpd)
+    return false;
+
+  xml::MpdPatchGenerator::SegmentTimelineCaches segment_timeline_caches;
+  for (const auto& period : periods_) {
+    for (const auto* adaptation_set : period->GetAdaptationSets()) {
+      for (auto* representation : adaptation_set->GetRepresentations()) {
+        segment_timeline_caches[representation->id()] =
+            representation->segment_timeline_cache();
+      }
+    }
   }
-  *output = mpd->ToString(version);
+  XmlNode patch_node("Patch");
+  if (!patch_generator_.Generate(*mpd, segment_timeline_caches, &patch_node))
+    return false;
+
+  const std::string comment = GetGeneratedWithComment();
+  *output = mpd->ToString(comment);
+  *patch = patch_node.ToString(comment);
   return true;
 }
 
@@ -173,7 +230,20 @@ std::optional<xml::XmlNode> MpdBuilder::GenerateMpd() {
       return std::nullopt;
   }
 
+  if (HasPatches()) {
+    // The MPD Patch is next to the MPD.
+    XmlNode patch_location("PatchLocation");
+    patch_location.SetContent(
+        std::filesystem::path(mpd_options_.mpd_params.mpd_patch_output)
+            .filename()
+            .string());
+    if (!mpd.AddChild(std::move(patch_location)))
+      return std::nullopt;
+  }
+
   bool output_period_duration = false;
+  if (mpd_options_.mpd_type == MpdType::kDynamic)
+    RemoveExpiredPeriods();
   if (mpd_options_.mpd_type == MpdType::kStatic) {
     UpdatePeriodDurationAndPresentationTimestamp();
     // Only output period duration if there are more than one period. In the
@@ -264,9 +334,16 @@ bool MpdBuilder::AddDynamicMpdInfo(XmlNode* mpd_node) {
   static const char kDynamicMpdType[] = "dynamic";
   RCHECK(mpd_node->SetStringAttribute("type", kDynamicMpdType));
 
-  // No offset from NOW.
-  RCHECK(mpd_node->SetStringAttribute(
-      "publishTime", XmlDateTimeNowWithOffset(0, clock_.get())));
+  if (HasPatches()) {
+    // The MPD Patches name the MPD they apply to.
+    const std::string id =
+        std::filesystem::path(mpd_options_.mpd_params.mpd_output)
+            .stem()
+            .string();
+    RCHECK(mpd_node->SetStringAttribute("id", id.empty() ? "mpd" : id));
+  }
+
+  RCHECK(mpd_node->SetStringAttribute("publishTime", GetPublishTime()));
 
   // 'availabilityStartTime' is required for dynamic profile. Calculate if
   // not already calculated.
@@ -406,6 +483,69 @@ void MpdBuilder::UpdatePeriodDurationAndPresentationTimestamp() {
   }
 }
 
+void MpdBuilder::RemoveExpiredPeriods() {
+  const double time_shift_buffer_depth =
+      mpd_options_.mpd_params.time_shift_buffer_depth;
+  if (!Positive(time_shift_buffer_depth))
+    return;
+
+  std::optional<double> latest_end_time;
+  for (const auto& period : periods_) {
+    if (period->closed())
+      continue;
+    std::optional<double> end_time = period->GetEndTimeInSeconds();
+    if (end_time) {
+      latest_end_time =
+          std::max(latest_end_time.value_or(*end_time), *end_time);
+    }
+  }
+  if (!latest_end_time)
+    return;
+
+  auto is_expired = [&](const std::unique_ptr<Period>& period) {
+    if (!period->closed())
+      return false;
+    std::optional<double> end_time = period->GetEndTimeInSeconds();
+    return !end_time || *end_time + time_shift_buffer_depth < *latest_end_time;
+  };
+  if (mpd_options_.mpd_params.vod_archive_mpd_output.empty()) {
+    periods_.remove_if(is_expired);
+    return;
+  }
+  // Kept in order for the VOD archive.
+  for (auto iter = periods_.begin(); iter != periods_.end();) {
+    auto next = std::next(iter);
+    if (is_expired(*iter))
+      expired_periods_.splice(expired_periods_.end(), periods_, iter);
+    iter = next;
+  }
+}
+
+bool MpdBuilder::HasPatches() const {
+  return mpd_options_.mpd_type == MpdType::kDynamic &&
+         !mpd_options_.mpd_params.mpd_patch_output.empty();
+}
+
+std::string MpdBuilder::GetPublishTime() {
+  // No offset from NOW.
+  if (!HasPatches())
+    return XmlDateTimeNowWithOffset(0, clock_.get());
+
+  Clock::time_point now =
+      std::chrono::time_point_cast<std::chrono::milliseconds>(clock_->now());
+  if (now <= last_publish_time_)
+    now = last_publish_time_ + std::chrono::milliseconds(1);
+  last_publish_time_ = now;
+  return XmlDateTimeWithMilliseconds(now);
+}
+
+void MpdBuilder::ConvertToVodArchive() {
+  periods_.splice(periods_.begin(), expired_periods_);
+  for (const auto& period : periods_)
+    period->RestoreArchivedSegments();
+  mpd_options_.mpd_type = MpdType::kStatic;
+}
+
 void MpdBuilder::MakePathsRelativeToMpd(const std::string& mpd_path,
                                         MediaInfo* media_info) {
   DCHECK(media_info);
@@ -5,8 +5,9 @@
 // https://developers.google.com/open-source/licenses/bsd
 //
 /// All the methods that are virtual are virtual for mocking.
-/// NOTE: Inclusion of this module will cause xmlInitParser and xmlCleanupParser
-///       to be called at static initialization / deinitialization time.
+/// NOTE: The first call to MpdBuilder::ToString() calls xmlInitParser, and
+///       xmlCleanupParser is then called at exit, so that runs without DASH
+///       output never initialize libxml2.
 
 #ifndef MPD_BASE_MPD_BUILDER_H_
 #define MPD_BASE_MPD_BUILDER_H_
@@ -59,6 +60,21 @@ class MpdBuilder {
   // TODO(kqyang): Handle file IO in this class as in HLS media_playlist?
   [[nodiscard]] virtual bool ToString(std::string* output);
 
+  /// Same as ToString(), and also writes the MPD Patch which updates the MPD
+  /// last written by this method to the new one, for a dynamic MPD with
+  /// MpdParams::mpd_patch_output.
+  /// @param[out] output is an output string where the MPD gets written.
+  /// @param[out] patch is an output string where the MPD Patch gets written.
+  ///        It is empty if the MPD does not have patches.
+  /// @return true on success, false otherwise.
+  [[nodiscard]] virtual bool ToStringWithPatch(std::string* output,
+                                               std::string* patch);
+
+  /// Turn the dynamic MPD, once its live presentation has ended, into a
+  /// static MPD of all its segments, including the ones which have left the
+  /// live window with MpdParams::vod_archive_mpd_output set.
+  virtual void ConvertToVodArchive();
+
   /// Adjusts the fields of MediaInfo so that paths are relative to the
   /// specified MPD path.
   /// @param mpd_path is the file path of the MPD file.
@@ -115,8 +131,23 @@ class MpdBuilder {
   // Update Period durations and presentation timestamps.
   void UpdatePeriodDurationAndPresentationTimestamp();
 
+  // Removes the closed Periods which end more than |time_shift_buffer_depth|
+  // before the latest segment of the open Periods.
+  void RemoveExpiredPeriods();
+
+  // Whether the MPD references MPD Patches.
+  bool HasPatches() const;
+
+  // Returns MPD@publishTime. With MPD Patches, it has milliseconds and
+  // increases with each MPD, as it tells the clients which MPD a patch
+  // applies to.
+  std::string GetPublishTime();
+
   MpdOptions mpd_options_;
   std::list<std::unique_ptr<Period>> periods_;
+  // The Periods removed by RemoveExpiredPeriods(), with
+  // MpdParams::vod_archive_mpd_output.
+  std::list<std::unique_ptr<Period>> expired_periods_;
 
   std::list<std::string> base_urls_;
   std::string availability_start_time_;
@@ -127,6 +158,10 @@ class MpdBuilder {
   // By default, this returns the current time. This can be injected for
   // testing.
   std::unique_ptr<Clock> clock_;
+
+  xml::MpdPatchGenerator patch_generator_;
+  // MPD@publishTime of the last MPD with MPD Patches.
+  Clock::time_point last_publish_time_;
 };
 
 }  // namespace shaka
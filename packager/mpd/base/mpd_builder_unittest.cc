@@ -21,6 +21,7 @@
 #include <packager/version/version.h>
 
 using ::testing::HasSubstr;
+using ::testing::Not;
 
 namespace shaka {
 
@@ -243,6 +244,96 @@ TEST_F(LiveMpdBuilderTest, MultiplePeriodCheckXmlTest) {
                                  "  <Period id=\"2\" start=\"PT8S\"/>\n"));
 }
 
+// Closed Periods out of the time shift buffer are removed.
+TEST_F(LiveMpdBuilderTest, RemoveExpiredPeriods) {
+  mutable_mpd_options()->mpd_params.time_shift_buffer_depth = 10;
+  Period* period1 = mpd_.GetOrCreatePeriod(0);
+  Period* period2 = mpd_.GetOrCreatePeriod(20);
+  Period* period3 = mpd_.GetOrCreatePeriod(40);
+  AddSegmentToPeriod(0, 20, period1);
+  AddSegmentToPeriod(20, 20, period2);
+  AddSegmentToPeriod(40, 5, period3);
+
+  // Open Periods are kept.
+  std::string mpd_doc;
+  ASSERT_TRUE(mpd_.ToString(&mpd_doc));
+  EXPECT_THAT(mpd_doc, HasSubstr("<Period id=\"0\""));
+
+  period1->Close();
+  period2->Close();
+  ASSERT_TRUE(mpd_.ToString(&mpd_doc));
+  EXPECT_THAT(mpd_doc, Not(HasSubstr("<Period id=\"0\"")));
+  EXPECT_THAT(mpd_doc, HasSubstr("<Period id=\"1\""));
+  EXPECT_THAT(mpd_doc, HasSubstr("<Period id=\"2\""));
+
+  // The XML of a closed Period is reused.
+  std::string mpd_doc_again;
+  ASSERT_TRUE(mpd_.ToString(&mpd_doc_again));
+  EXPECT_EQ(mpd_doc, mpd_doc_again);
+}
+
+// Each update of a dynamic MPD comes with an MPD Patch from the previous one.
+TEST_F(LiveMpdBuilderTest, MpdPatch) {
+  const char kMediaInfo[] =
+      "video_info {\n"
+      "  codec: 'avc1.010101'\n"
+      "  width: 720\n"
+      "  height: 480\n"
+      "  time_scale: 10\n"
+      "  frame_duration: 1\n"
+      "  pixel_width: 1\n"
+      "  pixel_height: 1\n"
+      "}\n"
+      "reference_time_scale: 1000\n"
+      "container_type: 1\n"
+      "init_segment_url: 'init.mp4'\n"
+      "segment_template_url: '$Time$.mp4'\n";
+  mutable_mpd_options()->mpd_params.mpd_output = "foo/live.mpd";
+  mutable_mpd_options()->mpd_params.mpd_patch_output = "foo/live.mpp";
+  const MediaInfo media_info = ConvertToMediaInfo(kMediaInfo);
+  AdaptationSet* adaptation_set =
+      mpd_.GetOrCreatePeriod(0)->GetOrCreateAdaptationSet(media_info, false);
+  Representation* representation =
+      adaptation_set->AddRepresentation(media_info);
+  const size_t kBytes = 1000;
+  representation->AddNewSegment(0, 2000, kBytes, 1);
+
+  std::string mpd_doc;
+  std::string patch;
+  ASSERT_TRUE(mpd_.ToStringWithPatch(&mpd_doc, &patch));
+  EXPECT_THAT(mpd_doc, HasSubstr(" id=\"live\""));
+  EXPECT_THAT(mpd_doc, HasSubstr("<PatchLocation>live.mpp</PatchLocation>"));
+  // The first patch has no previous MPD to apply to.
+  EXPECT_THAT(patch,
+              HasSubstr(" mpdId=\"live\""
+                        " originalPublishTime=\"2016-01-11T15:10:24.000Z\""
+                        " publishTime=\"2016-01-11T15:10:24.000Z\"/>"));
+
+  // The last S element is repeated and a new one is added.
+  representation->AddNewSegment(2000, 2000, kBytes, 2);
+  representation->AddNewSegment(4000, 3000, kBytes, 3);
+  ASSERT_TRUE(mpd_.ToStringWithPatch(&mpd_doc, &patch));
+  EXPECT_THAT(mpd_doc, HasSubstr(" publishTime=\"2016-01-11T15:10:24.001Z\""));
+  EXPECT_THAT(patch,
+              HasSubstr(" originalPublishTime=\"2016-01-11T15:10:24.000Z\""
+                        " publishTime=\"2016-01-11T15:10:24.001Z\">"));
+  EXPECT_THAT(patch,
+              HasSubstr("<replace sel=\"/MPD/@publishTime\">"
+                        "2016-01-11T15:10:24.001Z</replace>"));
+  const std::string kTimelineSelector =
+      "/MPD/Period[@id='0']/AdaptationSet[@id='0']/Representation[@id='0']"
+      "/SegmentTemplate[1]/SegmentTimeline[1]";
+  EXPECT_THAT(patch, HasSubstr("<replace sel=\"" + kTimelineSelector +
+                               "/S[1]\">\n"
+                               "    <S t=\"0\" d=\"2000\" r=\"1\"/>\n"
+                               "  </replace>"));
+  EXPECT_THAT(patch, HasSubstr("<add sel=\"" + kTimelineSelector + "\">\n"
+                               "    <S t=\"4000\" d=\"3000\"/>\n"
+                               "  </add>"));
+  // The patch is the whole update.
+  EXPECT_THAT(patch, Not(HasSubstr("<Period")));
+}
+
 // Check whether the attributes are set correctly for dynamic <MPD> element.
 // This test must use ASSERT_EQ for comparison because XmlEqual() cannot
 // handle namespaces correctly yet.
@@ -95,6 +95,25 @@ class MpdNotifier {
                                 uint64_t size,
                                 int64_t segment_number) = 0;
 
+  /// Notifies MpdBuilder that there is a new segment ready, which is a byte
+  /// range of a bundle file, see
+  /// Mp4OutputParams::segment_bundle_duration_in_seconds. The bundle is
+  /// named after its first segment, i.e. the segment at offset 0.
+  /// @param start_byte_offset is the offset of the segment in the bundle.
+  /// The other parameters are the same as for NotifyNewSegment(), which is
+  /// called by default.
+  /// @return true on success, false otherwise.
+  virtual bool NotifyNewBundledSegment(uint32_t container_id,
+                                       int64_t start_time,
+                                       int64_t duration,
+                                       uint64_t start_byte_offset,
+                                       uint64_t size,
+                                       int64_t segment_number) {
+    UNUSED(start_byte_offset);
+    return NotifyNewSegment(container_id, start_time, duration, size,
+                            segment_number);
+  }
+
   /// Notifies MpdBuilder that a segment is fully written and provides the
   /// segment's complete duration and size. For Low Latency only. Note, size and
   /// duration are not known when the low latency segment is first registered
@@ -148,6 +167,18 @@ class MpdNotifier {
   /// forces a flush.
   virtual bool Flush() = 0;
 
+  /// Call this method to request a flush after the MPD has been updated.
+  /// Unlike Flush(), implementations may delay the flush and coalesce several
+  /// requests into a single write. The default implementation flushes
+  /// immediately.
+  virtual bool RequestFlush() { return Flush(); }
+
+  /// Write the static MPD of a live presentation which has ended, see
+  /// MpdParams::vod_archive_mpd_output. The MPD is not updated after.
+  /// @return true on success or if there is nothing to write, false
+  ///         otherwise.
+  virtual bool WriteVodArchive() { return true; }
+
   /// @return include_mspr_pro option flag
   bool include_mspr_pro() const { return mpd_options_.mpd_params.include_mspr_pro; }
 
@@ -6,12 +6,15 @@
 
 #include <packager/mpd/base/period.h>
 
+#include <algorithm>
+
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 
 #include <packager/mpd/base/adaptation_set.h>
 #include <packager/mpd/base/mpd_options.h>
 #include <packager/mpd/base/mpd_utils.h>
+#include <packager/mpd/base/representation.h>
 #include <packager/mpd/base/xml/xml_node.h>
 
 namespace shaka {
@@ -116,6 +119,11 @@ AdaptationSet* Period::GetOrCreateAdaptationSet(
 }
 
 std::optional<xml::XmlNode> Period::GetXml(bool output_period_duration) {
+  if (closed_xml_ &&
+      closed_xml_output_period_duration_ == output_period_duration) {
+    return closed_xml_->Copy();
+  }
+
   adaptation_sets_.sort(
       [](const std::unique_ptr<AdaptationSet>& adaptation_set_a,
          const std::unique_ptr<AdaptationSet>& adaptation_set_b) {
@@ -177,6 +185,11 @@ std::optional<xml::XmlNode> Period::GetXml(bool output_period_duration) {
       return std::nullopt;
     }
   }
+
+  if (closed_) {
+    closed_xml_ = period.Copy();
+    closed_xml_output_period_duration_ = output_period_duration;
+  }
   return period;
 }
 
@@ -188,6 +201,29 @@ const std::list<AdaptationSet*> Period::GetAdaptationSets() const {
   return adaptation_sets;
 }
 
+void Period::RestoreArchivedSegments() {
+  for (const auto& adaptation_set : adaptation_sets_) {
+    for (auto* representation : adaptation_set->GetRepresentations())
+      representation->RestoreArchivedSegments();
+  }
+  closed_xml_.reset();
+}
+
+std::optional<double> Period::GetEndTimeInSeconds() const {
+  std::optional<double> end_time;
+  for (const auto& adaptation_set : adaptation_sets_) {
+    for (const auto* representation : adaptation_set->GetRepresentations()) {
+      double representation_end_time = 0;
+      if (representation->GetStartAndEndTimestamps(nullptr,
+                                                   &representation_end_time)) {
+        end_time = std::max(end_time.value_or(representation_end_time),
+                            representation_end_time);
+      }
+    }
+  }
+  return end_time;
+}
+
 std::unique_ptr<AdaptationSet> Period::NewAdaptationSet(
     const std::string& language,
     const MpdOptions& options,
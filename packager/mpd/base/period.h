@@ -51,6 +51,22 @@ class Period {
   /// @return The list of AdaptationSets in this Period.
   const std::list<AdaptationSet*> GetAdaptationSets() const;
 
+  /// Marks this Period as closed, i.e. no more segments are added to it, as
+  /// when all its Representations continue in a later Period after a cue
+  /// event. The XML of a closed Period is generated once and then reused.
+  void Close() { closed_ = true; }
+
+  /// @return true if the Period is closed.
+  bool closed() const { return closed_; }
+
+  /// Add back the segments of the Representations which have left the live
+  /// window, see Representation::RestoreArchivedSegments().
+  void RestoreArchivedSegments();
+
+  /// @return The end time of the latest segment in this Period, in seconds,
+  ///         or std::nullopt if it has no segment.
+  std::optional<double> GetEndTimeInSeconds() const;
+
   /// @return The start time of this Period.
   double start_time_in_seconds() const { return start_time_in_seconds_; }
 
@@ -133,6 +149,12 @@ class Period {
   // grouping key. These AdaptationSets still have not found reference
   // AdaptationSet.
   std::map<std::string, std::list<AdaptationSet*>> trickplay_cache_;
+
+  bool closed_ = false;
+  // The XML generated once the Period is closed, with the value of
+  // |output_period_duration| it was generated for.
+  std::optional<xml::XmlNode> closed_xml_;
+  bool closed_xml_output_period_duration_ = false;
 };
 
 }  // namespace shaka
@@ -13,7 +13,7 @@
 #include <absl/log/log.h>
 #include <absl/strings/str_format.h>
 
-#include <packager/file.h>
+#include <packager/file/file_reaper.h>
 #include <packager/macros/logging.h>
 #include <packager/media/base/muxer_util.h>
 #include <packager/mpd/base/mpd_options.h>
@@ -85,18 +85,19 @@ int32_t GetTimeScale(const MediaInfo& media_info) {
 }  // namespace
 
 Representation::Representation(
-    const MediaInfo& media_info,
+    MediaInfo media_info,
     const MpdOptions& mpd_options,
     uint32_t id,
     std::unique_ptr<RepresentationStateChangeListener> state_change_listener)
-    : media_info_(media_info),
+    : media_info_(std::move(media_info)),
       id_(id),
+      bandwidth_estimator_(mpd_options.mpd_params.bandwidth_window_segments),
       mpd_options_(mpd_options),
       state_change_listener_(std::move(state_change_listener)),
       allow_approximate_segment_timeline_(
           // TODO(kqyang): Need a better check. $Time is legitimate but not a
           // template.
-          media_info.segment_template().find("$Time") == std::string::npos &&
+          media_info_.segment_template().find("$Time") == std::string::npos &&
           mpd_options_.mpd_params.allow_approximate_segment_timeline) {}
 
 Representation::Representation(
@@ -108,6 +109,8 @@ Representation::Representation(
                      std::move(state_change_listener)) {
   mime_type_ = representation.mime_type_;
   codecs_ = representation.codecs_;
+  // The bundle may carry on into the next period.
+  bundle_url_ = representation.bundle_url_;
 }
 
 Representation::~Representation() {}
@@ -188,6 +191,9 @@ void Representation::AddNewSegment(int64_t start_time,
     state_change_listener_->OnNewSegmentForRepresentation(start_time, duration);
 
   AddSegmentInfo(start_time, duration, segment_number);
+  segment_infos_memory_.Set(
+      (segment_infos_.size() + archived_segment_infos_.size()) *
+      sizeof(SegmentInfo));
 
   // Only update the buffer depth and bandwidth estimator when the full segment
   // is completed. In the low latency case, only the first chunk in the segment
@@ -202,6 +208,23 @@ void Representation::AddNewSegment(int64_t start_time,
   }
 }
 
+void Representation::AddNewBundledSegment(int64_t start_time,
+                                          int64_t duration,
+                                          uint64_t start_byte_offset,
+                                          uint64_t size,
+                                          int64_t segment_number) {
+  if (start_byte_offset == 0) {
+    bundle_url_ = media::GetSegmentName(media_info_.segment_template_url(),
+                                        start_time, segment_number,
+                                        media_info_.bandwidth());
+  }
+  AddNewSegment(start_time, duration, size, segment_number);
+  // Ignored by AddNewSegment().
+  if (start_time == 0 && duration == 0)
+    return;
+  bundled_segments_.push_back({bundle_url_, start_byte_offset, size});
+}
+
 void Representation::UpdateCompletedSegment(int64_t duration, uint64_t size) {
   if (!mpd_options_.mpd_params.low_latency_dash_mode) {
     LOG(WARNING)
@@ -317,7 +340,9 @@ std::optional<xml::XmlNode> Representation::GetXml() {
   if (HasLiveOnlyFields(media_info_) &&
       !representation.AddLiveOnlyInfo(
           media_info_, segment_infos_,
-          mpd_options_.mpd_params.low_latency_dash_mode)) {
+          mpd_options_.mpd_params.low_latency_dash_mode,
+          &segment_timeline_cache_,
+          media_info_.segments_bundled() ? &bundled_segments_ : nullptr)) {
     LOG(ERROR) << "Failed to add Live info.";
     return std::nullopt;
   }
@@ -501,8 +526,8 @@ void Representation::SlideWindow() {
   if (current_buffer_depth_ <= time_shift_buffer_depth)
     return;
 
-  std::list<SegmentInfo>::iterator first = segment_infos_.begin();
-  std::list<SegmentInfo>::iterator last = first;
+  std::deque<SegmentInfo>::iterator first = segment_infos_.begin();
+  std::deque<SegmentInfo>::iterator last = first;
   for (; last != segment_infos_.end(); ++last) {
     // Remove the current segment only if it falls completely out of time shift
     // buffer range.
@@ -524,24 +549,77 @@ void Representation::RemoveOldSegment(SegmentInfo* segment_info) {
   int64_t start_number = segment_info->start_segment_number;
   segment_info->start_segment_number++;
 
-  if (mpd_options_.mpd_params.preserved_segments_outside_live_window == 0)
+  const bool archive = !mpd_options_.mpd_params.vod_archive_mpd_output.empty();
+  if (archive) {
+    SegmentInfo* last_archived = archived_segment_infos_.empty()
+                                     ? nullptr
+                                     : &archived_segment_infos_.back();
+    if (last_archived && last_archived->duration == segment_info->duration &&
+        last_archived->start_time +
+                last_archived->duration * (last_archived->repeat + 1) ==
+            segment_start_time) {
+      ++last_archived->repeat;
+    } else {
+      archived_segment_infos_.push_back(
+          {segment_start_time, segment_info->duration, 0, start_number});
+    }
+  }
+
+  // A bundle is named after its first segment, and queued for removal with
+  // it. It is only deleted once a later bundle is queued, by when all its
+  // segments are out of the window.
+  bool starts_file = true;
+  if (!bundled_segments_.empty()) {
+    starts_file = bundled_segments_.front().start_byte_offset == 0;
+    if (archive)
+      archived_bundled_segments_.push_back(bundled_segments_.front());
+    bundled_segments_.pop_front();
+  }
+
+  if (mpd_options_.mpd_params.preserved_segments_outside_live_window == 0 ||
+      !starts_file) {
     return;
+  }
 
   segments_to_be_removed_.push_back(
       media::GetSegmentName(media_info_.segment_template(), segment_start_time,
                             start_number, media_info_.bandwidth()));
   while (segments_to_be_removed_.size() >
          mpd_options_.mpd_params.preserved_segments_outside_live_window) {
-    VLOG(2) << "Deleting " << segments_to_be_removed_.front();
-    if (!File::Delete(segments_to_be_removed_.front().c_str())) {
-      LOG(WARNING) << "Failed to delete " << segments_to_be_removed_.front()
-                   << "; Will retry later.";
-      break;
-    }
+    // Deleted in the background, not to delay the manifest update.
+    FileReaper::GetInstance()->Delete(segments_to_be_removed_.front());
     segments_to_be_removed_.pop_front();
   }
 }
 
+void Representation::RestoreArchivedSegments() {
+  if (archived_segment_infos_.empty())
+    return;
+  // The first segment left may continue the last archived entry.
+  if (!segment_infos_.empty()) {
+    const SegmentInfo& last_archived = archived_segment_infos_.back();
+    SegmentInfo& first = segment_infos_.front();
+    if (first.duration == last_archived.duration &&
+        last_archived.start_time +
+                last_archived.duration * (last_archived.repeat + 1) ==
+            first.start_time) {
+      first.start_time = last_archived.start_time;
+      first.repeat += last_archived.repeat + 1;
+      first.start_segment_number = last_archived.start_segment_number;
+      archived_segment_infos_.pop_back();
+    }
+  }
+  segment_infos_.insert(segment_infos_.begin(),
+                        archived_segment_infos_.begin(),
+                        archived_segment_infos_.end());
+  archived_segment_infos_.clear();
+  bundled_segments_.insert(bundled_segments_.begin(),
+                           archived_bundled_segments_.begin(),
+                           archived_bundled_segments_.end());
+  archived_bundled_segments_.clear();
+  segment_infos_memory_.Set(segment_infos_.size() * sizeof(SegmentInfo));
+}
+
 std::string Representation::GetVideoMimeType() const {
   return GetMimeType("video", media_info_.container_type());
 }
@@ -10,6 +10,7 @@
 #define PACKAGER_MPD_BASE_REPRESENTATION_H_
 
 #include <cstdint>
+#include <deque>
 #include <list>
 #include <memory>
 #include <optional>
@@ -18,6 +19,7 @@
 #include <packager/mpd/base/media_info.pb.h>
 #include <packager/mpd/base/segment_info.h>
 #include <packager/mpd/base/xml/xml_node.h>
+#include <packager/utils/memory_accounting.h>
 
 namespace shaka {
 
@@ -105,6 +107,18 @@ class Representation {
                              uint64_t size,
                              int64_t segment_number);
 
+  /// Add a media segment which is a byte range of a bundle file, see
+  /// Mp4OutputParams::segment_bundle_duration_in_seconds. The bundle is
+  /// named after its first segment, i.e. the segment at offset 0, with the
+  /// segment template.
+  /// @param start_byte_offset is the offset of the segment in the bundle.
+  /// The other parameters are the same as for AddNewSegment().
+  virtual void AddNewBundledSegment(int64_t start_time,
+                                    int64_t duration,
+                                    uint64_t start_byte_offset,
+                                    uint64_t size,
+                                    int64_t segment_number);
+
   /// Update a media segment in the Representation.
   /// In the low latency case, the segment duration will not be ready until the
   /// entire segment has been processed. This allows setting the full duration
@@ -160,10 +174,24 @@ class Representation {
   bool GetStartAndEndTimestamps(double* start_timestamp_seconds,
                                 double* end_timestamp_seconds) const;
 
+  /// Add back the segments which have left the live window, kept with
+  /// MpdParams::vod_archive_mpd_output, so that the Representation lists all
+  /// its segments, e.g. for a static MPD of a live presentation which has
+  /// ended.
+  void RestoreArchivedSegments();
+
   /// @return ID number for <Representation>.
   uint32_t id() const { return id_; }
 
-  void set_media_info(const MediaInfo& media_info) { media_info_ = media_info; }
+  /// @return the cache of the SegmentTimeline element of the Representation,
+  ///         which also tracks its changes for the MPD Patches.
+  xml::SegmentTimelineCache* segment_timeline_cache() {
+    return &segment_timeline_cache_;
+  }
+
+  void set_media_info(MediaInfo media_info) {
+    media_info_ = std::move(media_info);
+  }
 
  protected:
   /// @param media_info is a MediaInfo containing information on the media.
@@ -175,7 +203,7 @@ class Representation {
   /// @param state_change_listener is an event handler for state changes to
   ///        the representation. If null, no event handler registered.
   Representation(
-      const MediaInfo& media_info,
+      MediaInfo media_info,
       const MpdOptions& mpd_options,
       uint32_t representation_id,
       std::unique_ptr<RepresentationStateChangeListener> state_change_listener);
@@ -241,7 +269,20 @@ class Representation {
 
   int64_t current_buffer_depth_ = 0;
   // TODO(kqyang): Address sliding window issue with multiple periods.
-  std::list<SegmentInfo> segment_infos_;
+  std::deque<SegmentInfo> segment_infos_;
+  MemoryCharge segment_infos_memory_{MemorySubsystem::kMpdSegments};
+  // Keeps the SegmentTimeline generated from |segment_infos_| between calls to
+  // GetXml().
+  xml::SegmentTimelineCache segment_timeline_cache_;
+  // The byte range of each segment of |segment_infos_| in its bundle, if the
+  // segments are bundled.
+  std::deque<BundledSegment> bundled_segments_;
+  // The segments removed from |segment_infos_| and |bundled_segments_| by
+  // SlideWindow(), with MpdParams::vod_archive_mpd_output.
+  std::deque<SegmentInfo> archived_segment_infos_;
+  std::deque<BundledSegment> archived_bundled_segments_;
+  // The URL of the last bundle.
+  std::string bundle_url_;
   // A list to hold the file names of the segments to be removed temporarily.
   // Once a file is actually removed, it is removed from the list.
   std::list<std::string> segments_to_be_removed_;
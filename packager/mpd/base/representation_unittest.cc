@@ -17,6 +17,7 @@
 
 #include <packager/file.h>
 #include <packager/file/file_closer.h>
+#include <packager/file/file_reaper.h>
 #include <packager/flag_saver.h>
 #include <packager/mpd/base/mpd_options.h>
 #include <packager/mpd/test/mpd_builder_test_helper.h>
@@ -526,7 +527,7 @@ class SegmentTemplateTest : public RepresentationTest {
   }
 
   std::unique_ptr<Representation> representation_;
-  std::list<SegmentInfo> segment_infos_for_expected_out_;
+  std::deque<SegmentInfo> segment_infos_for_expected_out_;
   std::string expected_s_elements_;
   BandwidthEstimator bandwidth_estimator_;
   int64_t segment_number_ = 1;
@@ -602,6 +603,46 @@ TEST_F(SegmentTemplateTest, RepresentationClone) {
   EXPECT_THAT(cloned_representation->GetXml(), XmlNodeEqual(kExpectedXml));
 }
 
+// Bundled segments are listed in a SegmentList, with their byte ranges in
+// the bundles, which are named after their first segments.
+TEST_F(SegmentTemplateTest, BundledSegments) {
+  MediaInfo media_info = ConvertToMediaInfo(GetDefaultMediaInfo());
+  media_info.set_segment_template_url("$Number$.mp4");
+  media_info.set_segments_bundled(true);
+  representation_ =
+      CreateRepresentation(media_info, kAnyRepresentationId, NoListener());
+  ASSERT_TRUE(representation_->Init());
+
+  const int64_t kDuration = 10;
+  const uint64_t kSizes[] = {100, 120, 110};
+  const uint64_t kOffsets[] = {0, 100, 0};
+  for (int i = 0; i < 3; ++i) {
+    representation_->AddNewBundledSegment(i * kDuration, kDuration,
+                                          kOffsets[i], kSizes[i], i + 1);
+    bandwidth_estimator_.AddBlock(
+        kSizes[i], static_cast<double>(kDuration) / kDefaultTimeScale);
+  }
+
+  const char kOutputTemplate[] =
+      "<Representation id=\"1\" bandwidth=\"%" PRIu64
+      "\" "
+      " codecs=\"avc1.010101\" mimeType=\"video/mp4\" sar=\"1:1\" "
+      " width=\"720\" height=\"480\" frameRate=\"10/5\">\n"
+      "  <SegmentList timescale=\"1000\" startNumber=\"1\">\n"
+      "    <Initialization sourceURL=\"init.mp4\"/>\n"
+      "    <SegmentTimeline>\n"
+      "      <S t=\"0\" d=\"10\" r=\"2\"/>\n"
+      "    </SegmentTimeline>\n"
+      "    <SegmentURL media=\"1.mp4\" mediaRange=\"0-99\"/>\n"
+      "    <SegmentURL media=\"1.mp4\" mediaRange=\"100-219\"/>\n"
+      "    <SegmentURL media=\"3.mp4\" mediaRange=\"0-109\"/>\n"
+      "  </SegmentList>\n"
+      "</Representation>\n";
+  EXPECT_THAT(representation_->GetXml(),
+              XmlNodeEqual(absl::StrFormat(kOutputTemplate,
+                                           bandwidth_estimator_.Max())));
+}
+
 TEST_F(SegmentTemplateTest, PresentationTimeOffset) {
   const int64_t kStartTime = 0;
   const int64_t kDuration = 10;
@@ -1065,6 +1106,27 @@ TEST_P(TimeShiftBufferDepthTest, Normal) {
       XmlNodeEqual(ExpectedXml(expected_s_element, kExpectedStartNumber)));
 }
 
+// The segments out of the live window are added back for the VOD archive.
+TEST_P(TimeShiftBufferDepthTest, RestoreArchivedSegments) {
+  const int kTimeShiftBufferDepth = 10;  // 10 sec.
+  mutable_mpd_options()->mpd_params.time_shift_buffer_depth =
+      kTimeShiftBufferDepth;
+  mutable_mpd_options()->mpd_params.vod_archive_mpd_output = "vod.mpd";
+
+  const int64_t kDuration = kDefaultTimeScale;
+  const uint64_t kSize = 10000;
+  const int kRepeat = 100;
+  AddSegments(initial_start_time_, kDuration, kSize, kRepeat);
+  representation_->RestoreArchivedSegments();
+
+  const std::string expected_s_element = absl::StrFormat(
+      kSElementTemplate, initial_start_time_, kDuration, kRepeat);
+  const int kExpectedStartNumber = 1;
+  EXPECT_THAT(
+      representation_->GetXml(),
+      XmlNodeEqual(ExpectedXml(expected_s_element, kExpectedStartNumber)));
+}
+
 // TimeShiftBufferDepth is shorter than a segment. This should not discard the
 // segment that can play TimeShiftBufferDepth.
 // For example if TimeShiftBufferDepth = 1 min. and a 10 min segment was just
@@ -1346,6 +1408,7 @@ class RepresentationDeleteSegmentsTest : public SegmentTimelineTestBase {
   }
 
   bool SegmentDeleted(const std::string& segment_name) {
+    FileReaper::GetInstance()->Flush();
     std::unique_ptr<File, FileCloser> file_closer(
         File::Open(segment_name.c_str(), "r"));
     return file_closer.get() == nullptr;
@@ -1403,4 +1466,23 @@ TEST_F(RepresentationDeleteSegmentsTest, ManyRepeatingSegments) {
       absl::StrFormat(kStringPrintTemplate, last_available_segment_index - 1)));
 }
 
+// A bundle is deleted once all its segments are out of the window, and as
+// many bundles as preserved segments follow it out.
+TEST_F(RepresentationDeleteSegmentsTest, Bundles) {
+  // Bundles of two segments, i.e. "1.mp4", "3.mp4" etc.
+  const int kNumSegments = 20;
+  for (int i = 0; i < kNumSegments; ++i) {
+    representation_->AddNewBundledSegment(kInitialStartTime + i * kDuration,
+                                          kDuration, (i % 2) * kSize, kSize,
+                                          i + 1);
+  }
+  // The window has segments 18 to 20, and the preserved bundles out of the
+  // window are "13.mp4", "15.mp4" and "17.mp4".
+  EXPECT_FALSE(SegmentDeleted(absl::StrFormat(kStringPrintTemplate, 13)));
+  EXPECT_TRUE(SegmentDeleted(absl::StrFormat(kStringPrintTemplate, 11)));
+  EXPECT_TRUE(SegmentDeleted(absl::StrFormat(kStringPrintTemplate, 1)));
+  // Not a bundle.
+  EXPECT_FALSE(SegmentDeleted(absl::StrFormat(kStringPrintTemplate, 2)));
+}
+
 }  // namespace shaka
@@ -8,6 +8,7 @@
 #define MPD_BASE_SEGMENT_INFO_H_
 
 #include <cstdint>
+#include <string>
 
 namespace shaka {
 
@@ -26,6 +27,16 @@ struct SegmentInfo {
   int64_t start_segment_number;
 };
 
+/// The byte range of a media segment in a bundle file, for the segments of a
+/// Representation appended to bundles, see
+/// Mp4OutputParams::segment_bundle_duration_in_seconds.
+struct BundledSegment {
+  // The URL of the bundle, relative to the MPD like the segment template.
+  std::string url;
+  uint64_t start_byte_offset;
+  uint64_t size;
+};
+
 }  // namespace shaka
 
 #endif  // MPD_BASE_SEGMENT_INFO_H_
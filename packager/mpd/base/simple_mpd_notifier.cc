@@ -9,28 +9,60 @@
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 
+#include <packager/file.h>
+#include <packager/file/file_util.h>
 #include <packager/mpd/base/adaptation_set.h>
 #include <packager/mpd/base/mpd_builder.h>
 #include <packager/mpd/base/mpd_notifier_util.h>
 #include <packager/mpd/base/mpd_utils.h>
 #include <packager/mpd/base/period.h>
 #include <packager/mpd/base/representation.h>
+#include <packager/utils/metrics.h>
+#include <packager/utils/trace.h>
 
 namespace shaka {
 
 SimpleMpdNotifier::SimpleMpdNotifier(const MpdOptions& mpd_options)
     : MpdNotifier(mpd_options),
       output_path_(mpd_options.mpd_params.mpd_output),
+      vod_archive_output_path_(mpd_options.mpd_params.vod_archive_mpd_output),
+      patch_output_path_(mpd_options.mpd_params.mpd_patch_output),
+      write_gzip_mpd_(mpd_options.mpd_params.write_gzip_mpd),
       mpd_builder_(new MpdBuilder(mpd_options)),
       content_protection_in_adaptation_set_(
-          mpd_options.mpd_params.generate_dash_if_iop_compliant_mpd) {
+          mpd_options.mpd_params.generate_dash_if_iop_compliant_mpd),
+      min_write_interval_(
+          absl::Seconds(mpd_options.mpd_params.min_write_interval)) {
   for (const std::string& base_url : mpd_options.mpd_params.base_urls)
     mpd_builder_->AddBaseUrl(base_url);
 }
 
-SimpleMpdNotifier::~SimpleMpdNotifier() {}
+SimpleMpdNotifier::~SimpleMpdNotifier() {
+  if (!writer_)
+    return;
+  bool flush_pending;
+  {
+    absl::MutexLock lock(&flush_lock_);
+    stopped_ = true;
+    flush_requested_.Signal();
+    flush_pending = flush_pending_;
+  }
+  writer_->join();
+  // Do not lose the last update.
+  if (flush_pending)
+    Flush();
+}
+
+void SimpleMpdNotifier::InjectClock(std::unique_ptr<Clock> clock) {
+  mpd_builder_->InjectClockForTesting(std::move(clock));
+}
 
 bool SimpleMpdNotifier::Init() {
+  if (mpd_type() == MpdType::kDynamic &&
+      min_write_interval_ > absl::ZeroDuration()) {
+    DCHECK(!writer_);
+    writer_.reset(new std::thread(&SimpleMpdNotifier::WriterLoop, this));
+  }
   return true;
 }
 
@@ -55,7 +87,7 @@ bool SimpleMpdNotifier::NotifyNewContainer(const MediaInfo& media_info,
   if (!adaptation_set->has_id())
     adaptation_set->set_id(next_adaptation_set_id_++);
   Representation* representation =
-      adaptation_set->AddRepresentation(adjusted_media_info);
+      adaptation_set->AddRepresentation(std::move(adjusted_media_info));
   if (!representation)
     return false;
 
@@ -69,39 +101,45 @@ bool SimpleMpdNotifier::NotifyNewContainer(const MediaInfo& media_info,
     AddContentProtectionElements(media_info, representation);
   }
   representation_map_[representation->id()] = representation;
+  representation_locks_[representation->id()] =
+      GetAdaptationSetLock(adaptation_set);
+  representation_periods_[representation->id()] = period;
   return true;
 }
 
 bool SimpleMpdNotifier::NotifyAvailabilityTimeOffset(uint32_t container_id) {
-  absl::MutexLock lock(&lock_);
+  absl::ReaderMutexLock lock(&lock_);
   auto it = representation_map_.find(container_id);
   if (it == representation_map_.end()) {
     LOG(ERROR) << "Unexpected container_id: " << container_id;
     return false;
   }
+  absl::MutexLock adaptation_set_lock(representation_locks_.at(container_id));
   it->second->SetAvailabilityTimeOffset();
   return true;
 }
 
 bool SimpleMpdNotifier::NotifySampleDuration(uint32_t container_id,
                                              int32_t sample_duration) {
-  absl::MutexLock lock(&lock_);
+  absl::ReaderMutexLock lock(&lock_);
   auto it = representation_map_.find(container_id);
   if (it == representation_map_.end()) {
     LOG(ERROR) << "Unexpected container_id: " << container_id;
     return false;
   }
+  absl::MutexLock adaptation_set_lock(representation_locks_.at(container_id));
   it->second->SetSampleDuration(sample_duration);
   return true;
 }
 
 bool SimpleMpdNotifier::NotifySegmentDuration(uint32_t container_id) {
-  absl::MutexLock lock(&lock_);
+  absl::ReaderMutexLock lock(&lock_);
   auto it = representation_map_.find(container_id);
   if (it == representation_map_.end()) {
     LOG(ERROR) << "Unexpected container_id: " << container_id;
     return false;
   }
+  absl::MutexLock adaptation_set_lock(representation_locks_.at(container_id));
   it->second->SetSegmentDuration();
   return true;
 }
@@ -111,25 +149,45 @@ bool SimpleMpdNotifier::NotifyNewSegment(uint32_t container_id,
                                          int64_t duration,
                                          uint64_t size,
                                          int64_t segment_number) {
-  absl::MutexLock lock(&lock_);
+  absl::ReaderMutexLock lock(&lock_);
   auto it = representation_map_.find(container_id);
   if (it == representation_map_.end()) {
     LOG(ERROR) << "Unexpected container_id: " << container_id;
     return false;
   }
+  absl::MutexLock adaptation_set_lock(representation_locks_.at(container_id));
   it->second->AddNewSegment(start_time, duration, size, segment_number);
   return true;
 }
 
+bool SimpleMpdNotifier::NotifyNewBundledSegment(uint32_t container_id,
+                                                int64_t start_time,
+                                                int64_t duration,
+                                                uint64_t start_byte_offset,
+                                                uint64_t size,
+                                                int64_t segment_number) {
+  absl::ReaderMutexLock lock(&lock_);
+  auto it = representation_map_.find(container_id);
+  if (it == representation_map_.end()) {
+    LOG(ERROR) << "Unexpected container_id: " << container_id;
+    return false;
+  }
+  absl::MutexLock adaptation_set_lock(representation_locks_.at(container_id));
+  it->second->AddNewBundledSegment(start_time, duration, start_byte_offset,
+                                   size, segment_number);
+  return true;
+}
+
 bool SimpleMpdNotifier::NotifyCompletedSegment(uint32_t container_id,
                                                int64_t duration,
                                                uint64_t size) {
-  absl::MutexLock lock(&lock_);
+  absl::ReaderMutexLock lock(&lock_);
   auto it = representation_map_.find(container_id);
   if (it == representation_map_.end()) {
     LOG(ERROR) << "Unexpected container_id: " << container_id;
     return false;
   }
+  absl::MutexLock adaptation_set_lock(representation_locks_.at(container_id));
   it->second->UpdateCompletedSegment(duration, size);
   return true;
 }
@@ -175,6 +233,13 @@ bool SimpleMpdNotifier::NotifyCueEvent(uint32_t container_id,
     AddContentProtectionElements(media_info, representation);
   }
   representation_map_[representation->id()] = representation;
+  representation_locks_[representation->id()] =
+      GetAdaptationSetLock(adaptation_set);
+
+  Period* original_period = representation_periods_[representation->id()];
+  representation_periods_[representation->id()] = period;
+  if (original_period && original_period != period)
+    ClosePeriodIfDone(original_period);
   return true;
 }
 
@@ -214,13 +279,129 @@ bool SimpleMpdNotifier::NotifyMediaInfoUpdate(uint32_t container_id,
   MediaInfo adjusted_media_info(media_info);
   MpdBuilder::MakePathsRelativeToMpd(output_path_, &adjusted_media_info);
 
-  it->second->set_media_info(adjusted_media_info);
+  it->second->set_media_info(std::move(adjusted_media_info));
   return true;
 }
 
+void SimpleMpdNotifier::ClosePeriodIfDone(Period* period) {
+  for (const auto& entry : representation_periods_) {
+    if (entry.second == period)
+      return;
+  }
+  period->Close();
+  for (const AdaptationSet* adaptation_set : period->GetAdaptationSets())
+    adaptation_set_locks_.erase(adaptation_set);
+}
+
+absl::Mutex* SimpleMpdNotifier::GetAdaptationSetLock(
+    const AdaptationSet* adaptation_set) {
+  std::unique_ptr<absl::Mutex>& adaptation_set_lock =
+      adaptation_set_locks_[adaptation_set];
+  if (!adaptation_set_lock)
+    adaptation_set_lock.reset(new absl::Mutex);
+  return adaptation_set_lock.get();
+}
+
 bool SimpleMpdNotifier::Flush() {
-  absl::MutexLock lock(&lock_);
-  return WriteMpdToFile(output_path_, mpd_builder_.get());
+  static MetricDurations* const flush_durations =
+      MetricsRegistry::GetInstance()->GetDurations(
+          "shaka_mpd_flush_seconds", "Time spent generating and writing MPDs.");
+
+  absl::MutexLock write_lock(&write_lock_);
+  ScopedMetricTimer timer(flush_durations);
+  ScopedTraceEvent trace_event("SimpleMpdNotifier::Flush");
+  {
+    // The MPD written below includes all the updates so far.
+    absl::MutexLock lock(&flush_lock_);
+    flush_pending_ = false;
+  }
+
+  // Only hold |lock_| while generating the MPD, so that the muxer threads
+  // are not blocked on the file write.
+  std::string mpd;
+  std::string patch;
+  {
+    absl::MutexLock lock(&lock_);
+    const bool generated = patch_output_path_.empty()
+                               ? mpd_builder_->ToString(&mpd)
+                               : mpd_builder_->ToStringWithPatch(&mpd, &patch);
+    if (!generated) {
+      LOG(ERROR) << "Failed to write MPD to string.";
+      return false;
+    }
+  }
+  // The MPD Patch goes first, so that the clients which have the previous MPD
+  // can update it as soon as the new one is out.
+  if (!patch.empty() &&
+      !File::WriteFileAtomically(patch_output_path_.c_str(), patch)) {
+    LOG(ERROR) << "Failed to write MPD Patch to: " << patch_output_path_;
+    return false;
+  }
+  if (!File::WriteFileAtomically(output_path_.c_str(), mpd)) {
+    LOG(ERROR) << "Failed to write mpd to: " << output_path_;
+    return false;
+  }
+  if (write_gzip_mpd_ && !WriteGzipFileAtomically(output_path_ + ".gz", mpd)) {
+    LOG(ERROR) << "Failed to write compressed mpd to: " << output_path_
+               << ".gz";
+    return false;
+  }
+  return true;
+}
+
+bool SimpleMpdNotifier::WriteVodArchive() {
+  if (vod_archive_output_path_.empty() || mpd_type() != MpdType::kDynamic)
+    return true;
+
+  absl::MutexLock write_lock(&write_lock_);
+  {
+    // The live MPD is not written any more.
+    absl::MutexLock lock(&flush_lock_);
+    flush_pending_ = false;
+  }
+  std::string mpd;
+  {
+    absl::MutexLock lock(&lock_);
+    mpd_builder_->ConvertToVodArchive();
+    if (!mpd_builder_->ToString(&mpd)) {
+      LOG(ERROR) << "Failed to write VOD MPD to string.";
+      return false;
+    }
+  }
+  if (!File::WriteFileAtomically(vod_archive_output_path_.c_str(), mpd)) {
+    LOG(ERROR) << "Failed to write VOD mpd to: " << vod_archive_output_path_;
+    return false;
+  }
+  return true;
+}
+
+bool SimpleMpdNotifier::RequestFlush() {
+  if (!writer_)
+    return Flush();
+  absl::MutexLock lock(&flush_lock_);
+  flush_pending_ = true;
+  flush_requested_.Signal();
+  return true;
+}
+
+void SimpleMpdNotifier::WriterLoop() {
+  absl::Time next_write_time = absl::InfinitePast();
+  absl::MutexLock lock(&flush_lock_);
+  while (true) {
+    while (!flush_pending_ && !stopped_)
+      flush_requested_.Wait(&flush_lock_);
+    // Coalesce the requests received until the interval has elapsed.
+    while (!stopped_ && absl::Now() < next_write_time)
+      flush_requested_.WaitWithDeadline(&flush_lock_, next_write_time);
+    if (stopped_)
+      return;
+
+    flush_lock_.Unlock();
+    next_write_time = absl::Now() + min_write_interval_;
+    if (!Flush())
+      LOG(ERROR) << "Failed to write dynamic MPD to " << output_path_;
+    flush_lock_.Lock();
+  }
 }
 
 }  // namespace shaka
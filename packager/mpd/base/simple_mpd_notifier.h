@@ -10,9 +10,11 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <absl/synchronization/mutex.h>
+#include <absl/time/time.h>
 
 #include <packager/mpd/base/mpd_notifier.h>
 #include <packager/mpd/base/mpd_notifier_util.h>
@@ -20,7 +22,9 @@
 namespace shaka {
 
 class AdaptationSet;
+class Clock;
 class MpdBuilder;
+class Period;
 class Representation;
 
 struct MpdOptions;
@@ -46,6 +50,12 @@ class SimpleMpdNotifier : public MpdNotifier {
                         int64_t duration,
                         uint64_t size,
                         int64_t segment_number) override;
+  bool NotifyNewBundledSegment(uint32_t container_id,
+                               int64_t start_time,
+                               int64_t duration,
+                               uint64_t start_byte_offset,
+                               uint64_t size,
+                               int64_t segment_number) override;
   bool NotifyCompletedSegment(uint32_t container_id,
                               int64_t duration,
                               uint64_t size) override;
@@ -57,8 +67,17 @@ class SimpleMpdNotifier : public MpdNotifier {
   bool NotifyMediaInfoUpdate(uint32_t container_id,
                              const MediaInfo& media_info) override;
   bool Flush() override;
+  /// If MpdParams::min_write_interval is set for a dynamic MPD, the MPD is
+  /// written from a background thread at most once per interval; otherwise
+  /// this is the same as Flush().
+  bool RequestFlush() override;
+  bool WriteVodArchive() override;
   /// @}
 
+  /// Replace the clock giving the current time of the MPD, e.g. to package
+  /// live in simulated time. Must be called before Init().
+  void InjectClock(std::unique_ptr<Clock> clock);
+
  private:
   SimpleMpdNotifier(const SimpleMpdNotifier&) = delete;
   SimpleMpdNotifier& operator=(const SimpleMpdNotifier&) = delete;
@@ -73,10 +92,32 @@ class SimpleMpdNotifier : public MpdNotifier {
     mpd_builder_ = std::move(mpd_builder);
   }
 
+  // Writes the MPD whenever a flush is requested, at most once per
+  // |min_write_interval_|, until |stopped_| is set.
+  void WriterLoop();
+
+  // Returns the lock for the Representations in |adaptation_set|, creating it
+  // if needed.
+  absl::Mutex* GetAdaptationSetLock(const AdaptationSet* adaptation_set)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Closes |period| if none of the Representations is updated in it anymore.
+  void ClosePeriodIfDone(Period* period) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // MPD output path.
   std::string output_path_;
+  // Path of the static MPD written by WriteVodArchive(), if any.
+  const std::string vod_archive_output_path_;
+  // Path of the MPD Patches written with the dynamic MPD, if any.
+  const std::string patch_output_path_;
+  // Whether the MPD is also written compressed, to |output_path_| + ".gz".
+  const bool write_gzip_mpd_;
   std::unique_ptr<MpdBuilder> mpd_builder_;
   bool content_protection_in_adaptation_set_ = true;
+  // Held exclusively to change the structure of the MPD or to generate it.
+  // Updates to a single Representation only hold it in shared mode, together
+  // with the lock of the AdaptationSet in |representation_locks_|, so updates
+  // to different AdaptationSets do not contend.
   absl::Mutex lock_;
 
   uint32_t next_adaptation_set_id_ = 0;
@@ -84,6 +125,25 @@ class SimpleMpdNotifier : public MpdNotifier {
   std::map<uint32_t, Representation*> representation_map_;
   // Maps Representation ID to AdaptationSet. This is for updating the PSSH.
   std::map<uint32_t, AdaptationSet*> representation_id_to_adaptation_set_;
+  // Maps Representation ID to the lock of its AdaptationSet. The lock is shared
+  // by the Representations of an AdaptationSet as they update it, e.g. to
+  // check segment alignment.
+  std::map<uint32_t, absl::Mutex*> representation_locks_;
+  std::map<const AdaptationSet*, std::unique_ptr<absl::Mutex>>
+      adaptation_set_locks_;
+  // Maps Representation ID to the Period it is updated in.
+  std::map<uint32_t, Period*> representation_periods_;
+
+  // Serializes MPD writes so that an older MPD never overwrites a newer one.
+  // Acquired before |lock_|, which is only held while generating the MPD.
+  absl::Mutex write_lock_;
+
+  const absl::Duration min_write_interval_;
+  absl::Mutex flush_lock_;
+  absl::CondVar flush_requested_ ABSL_GUARDED_BY(flush_lock_);
+  bool flush_pending_ ABSL_GUARDED_BY(flush_lock_) = false;
+  bool stopped_ ABSL_GUARDED_BY(flush_lock_) = false;
+  std::unique_ptr<std::thread> writer_;
 };
 
 }  // namespace shaka
@@ -11,6 +11,7 @@
 #include <gmock/gmock.h>
 #include <google/protobuf/util/message_differencer.h>
 #include <gtest/gtest.h>
+#include <absl/synchronization/notification.h>
 
 #include <packager/file/file_test_util.h>
 #include <packager/mpd/base/mock_mpd_builder.h>
@@ -205,6 +206,36 @@ TEST_F(SimpleMpdNotifierTest, NotifyAvailabilityTimeOffset) {
 // https://github.com/shaka-project/shaka-packager/issues/45
 // This issue identified a bug where using SimpleMpdNotifier with multiple
 // threads causes a deadlock.
+// Verify that flush requests for a dynamic MPD are coalesced when a minimum
+// write interval is set, and that a pending update is written on destruction.
+TEST_F(SimpleMpdNotifierTest, RequestFlushCoalescesWrites) {
+  MpdOptions mpd_options = empty_mpd_option_;
+  mpd_options.mpd_type = MpdType::kDynamic;
+  mpd_options.mpd_params.min_write_interval = 3600;
+  std::unique_ptr<SimpleMpdNotifier> notifier(
+      new SimpleMpdNotifier(mpd_options));
+
+  absl::Notification first_write;
+  std::unique_ptr<MockMpdBuilder> mock_mpd_builder(new MockMpdBuilder());
+  EXPECT_CALL(*mock_mpd_builder, ToString(_))
+      .WillOnce(testing::Invoke([&first_write](std::string*) {
+        first_write.Notify();
+        return true;
+      }))
+      .WillOnce(Return(true));
+  SetMpdBuilder(notifier.get(), std::move(mock_mpd_builder));
+  ASSERT_TRUE(notifier->Init());
+
+  // The first request is written right away.
+  EXPECT_TRUE(notifier->RequestFlush());
+  first_write.WaitForNotification();
+
+  // The following requests fall within the interval and are written once.
+  EXPECT_TRUE(notifier->RequestFlush());
+  EXPECT_TRUE(notifier->RequestFlush());
+  notifier.reset();
+}
+
 TEST_F(SimpleMpdNotifierTest, NotifyNewContainerAndSampleDurationNoMock) {
   SimpleMpdNotifier notifier(empty_mpd_option_);
   uint32_t container_id;
@@ -297,6 +328,9 @@ TEST_F(SimpleMpdNotifierTest, NotifyCueEvent) {
               CopyRepresentation(Ref(*mock_representation)))
       .WillOnce(Return(mock_representation2.get()));
   EXPECT_TRUE(notifier.NotifyCueEvent(container_id, kCueEventTimestamp));
+  // The only Representation has moved to the new Period.
+  EXPECT_TRUE(mock_period->closed());
+  EXPECT_FALSE(mock_period2->closed());
 }
 
 TEST_F(SimpleMpdNotifierTest,
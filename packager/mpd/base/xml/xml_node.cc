@@ -9,13 +9,18 @@
 #include <cinttypes>
 #include <cmath>
 #include <limits>
+#include <map>
+#include <optional>
 #include <set>
+#include <utility>
+#include <vector>
 
 #include <absl/base/internal/endian.h>
 #include <absl/flags/flag.h>
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 #include <absl/strings/escaping.h>
+#include <absl/strings/match.h>
 #include <absl/strings/numbers.h>
 #include <absl/strings/str_format.h>
 #include <curl/curl.h>
@@ -72,7 +77,7 @@ std::string RangeToString(const Range& range) {
 
 // Check if segments are continuous and all segments except the last one are of
 // the same duration.
-bool IsTimelineConstantDuration(const std::list<SegmentInfo>& segment_infos,
+bool IsTimelineConstantDuration(const std::deque<SegmentInfo>& segment_infos,
                                 uint32_t start_number) {
   if (!absl::GetFlag(FLAGS_segment_template_constant_duration))
     return false;
@@ -98,21 +103,33 @@ bool IsTimelineConstantDuration(const std::list<SegmentInfo>& segment_infos,
   return expected_last_segment_start_time == last_segment.start_time;
 }
 
-bool PopulateSegmentTimeline(const std::list<SegmentInfo>& segment_infos,
-                             XmlNode* segment_timeline) {
-  for (const SegmentInfo& segment_info : segment_infos) {
-    XmlNode s_element("S");
-    RCHECK(s_element.SetIntegerAttribute("t", segment_info.start_time));
-    RCHECK(s_element.SetIntegerAttribute("d", segment_info.duration));
-    if (segment_info.repeat > 0)
-      RCHECK(s_element.SetIntegerAttribute("r", segment_info.repeat));
-
-    RCHECK(segment_timeline->AddChild(std::move(s_element)));
-  }
+bool SetIntegerProp(xmlNode* node, const char* name, uint64_t number) {
+  return xmlSetProp(node, BAD_CAST name,
+                    BAD_CAST(absl::StrFormat("%" PRIu64, number).c_str())) !=
+         nullptr;
+}
 
+bool SetSegmentTimelineEntry(const SegmentInfo& segment_info,
+                             xmlNode* s_element) {
+  RCHECK(SetIntegerProp(s_element, "t", segment_info.start_time));
+  RCHECK(SetIntegerProp(s_element, "d", segment_info.duration));
+  if (segment_info.repeat > 0)
+    RCHECK(SetIntegerProp(s_element, "r", segment_info.repeat));
+  else
+    xmlUnsetProp(s_element, BAD_CAST "r");
   return true;
 }
 
+bool IsSameSegmentTimelineEntry(const SegmentInfo& a, const SegmentInfo& b) {
+  return a.start_time == b.start_time && a.duration == b.duration &&
+         a.repeat == b.repeat;
+}
+
+int64_t SegmentInfoEndTime(const SegmentInfo& segment_info) {
+  return segment_info.start_time +
+         segment_info.duration * (segment_info.repeat + 1);
+}
+
 void CollectNamespaceFromName(const std::string& name,
                               std::set<std::string>* namespaces) {
   const size_t pos = name.find(':');
@@ -139,6 +156,172 @@ void TraverseNodesAndCollectNamespaces(const xmlNode* node,
   }
 }
 
+std::string GetProperty(const xmlNode* node, const std::string& name) {
+  xml::scoped_xml_ptr<xmlChar> value(xmlGetProp(node, BAD_CAST name.c_str()));
+  return value ? reinterpret_cast<const char*>(value.get()) : "";
+}
+
+// Returns the attributes of |node| by name, or only its namespace
+// declarations if |namespaces_only|.
+std::map<std::string, std::string> GetAttributes(const xmlNode* node,
+                                                 bool namespaces_only) {
+  std::map<std::string, std::string> attributes;
+  for (const xmlAttr* attribute = node->properties; attribute;
+       attribute = attribute->next) {
+    const std::string name = reinterpret_cast<const char*>(attribute->name);
+    if (!namespaces_only || absl::StartsWith(name, "xmlns"))
+      attributes[name] = GetProperty(node, name);
+  }
+  return attributes;
+}
+
+// Returns the text of |node|, without that of its descendants.
+std::string GetText(const xmlNode* node) {
+  std::string text;
+  for (const xmlNode* child = node->children; child; child = child->next) {
+    if (child->type == XML_TEXT_NODE && child->content)
+      text += reinterpret_cast<const char*>(child->content);
+  }
+  return text;
+}
+
+std::vector<const xmlNode*> GetChildElements(const xmlNode* node) {
+  std::vector<const xmlNode*> children;
+  for (const xmlNode* child = node->children; child; child = child->next) {
+    if (child->type == XML_ELEMENT_NODE)
+      children.push_back(child);
+  }
+  return children;
+}
+
+bool IsPeriod(const xmlNode* node) {
+  return xmlStrEqual(node->name, BAD_CAST "Period");
+}
+
+bool IsSameElement(const xmlNode* a, const xmlNode* b) {
+  if (!xmlStrEqual(a->name, b->name) ||
+      GetAttributes(a, false) != GetAttributes(b, false) ||
+      GetText(a) != GetText(b)) {
+    return false;
+  }
+  const std::vector<const xmlNode*> a_children = GetChildElements(a);
+  const std::vector<const xmlNode*> b_children = GetChildElements(b);
+  if (a_children.size() != b_children.size())
+    return false;
+  for (size_t i = 0; i < a_children.size(); ++i) {
+    if (!IsSameElement(a_children[i], b_children[i]))
+      return false;
+  }
+  return true;
+}
+
+// Whether |a| and |b| have the same text and the same child elements, by
+// name and @id.
+bool HaveSameChildren(const xmlNode* a, const xmlNode* b) {
+  if (GetText(a) != GetText(b))
+    return false;
+  const std::vector<const xmlNode*> a_children = GetChildElements(a);
+  const std::vector<const xmlNode*> b_children = GetChildElements(b);
+  if (a_children.size() != b_children.size())
+    return false;
+  for (size_t i = 0; i < a_children.size(); ++i) {
+    const xmlNode* a_child = a_children[i];
+    const xmlNode* b_child = b_children[i];
+    if (!xmlStrEqual(a_child->name, b_child->name) ||
+        !xmlHasProp(a_child, BAD_CAST "id") !=
+            !xmlHasProp(b_child, BAD_CAST "id") ||
+        GetProperty(a_child, "id") != GetProperty(b_child, "id")) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the last step of the selector of |node| in an MPD Patch: by its
+// @id if it has one, or else by its position among the siblings with the
+// same name.
+std::string GetSelectorStep(const xmlNode* node) {
+  const char* name = reinterpret_cast<const char*>(node->name);
+  if (xmlHasProp(node, BAD_CAST "id"))
+    return absl::StrFormat("%s[@id='%s']", name, GetProperty(node, "id"));
+  size_t position = 1;
+  for (const xmlNode* sibling = node->prev; sibling; sibling = sibling->prev) {
+    if (sibling->type == XML_ELEMENT_NODE &&
+        xmlStrEqual(sibling->name, node->name)) {
+      ++position;
+    }
+  }
+  return absl::StrFormat("%s[%u]", name, position);
+}
+
+xmlNode* CopyNode(const xmlNode* node) {
+  return xmlCopyNode(const_cast<xmlNode*>(node), true);
+}
+
+// Returns a copy of |node| without the S elements of its SegmentTimelines.
+xmlNode* CopyWithoutSegments(const xmlNode* node) {
+  static const int kCopyProperties = 2;
+  xml::scoped_xml_ptr<xmlNode> copy(
+      xmlCopyNode(const_cast<xmlNode*>(node), kCopyProperties));
+  if (!copy || xmlStrEqual(node->name, BAD_CAST "SegmentTimeline"))
+    return copy.release();
+  for (const xmlNode* child = node->children; child; child = child->next) {
+    xmlNode* child_copy = child->type == XML_ELEMENT_NODE
+                              ? CopyWithoutSegments(child)
+                              : CopyNode(child);
+    if (!child_copy || !xmlAddChild(copy.get(), child_copy)) {
+      xmlFreeNode(child_copy);
+      return nullptr;
+    }
+  }
+  return copy.release();
+}
+
+// Adds an operation of RFC 5261, e.g. "add", to |patch|.
+// Returns the operation, or nullptr on failure.
+xmlNode* AddPatchOperation(const char* operation,
+                           const std::string& selector,
+                           xmlNode* patch,
+                           const std::string& content = "") {
+  xmlNode* node = xmlNewTextChild(
+      patch, nullptr, BAD_CAST operation,
+      content.empty() ? nullptr : BAD_CAST content.c_str());
+  if (!node || !xmlSetProp(node, BAD_CAST "sel", BAD_CAST selector.c_str()))
+    return nullptr;
+  return node;
+}
+
+// Adds the operations which update the attributes of |old_element| to those
+// of |new_element|, selected by |selector|, to |patch|.
+bool AddAttributeOperations(const xmlNode* old_element,
+                            const xmlNode* new_element,
+                            const std::string& selector,
+                            xmlNode* patch) {
+  const std::map<std::string, std::string> old_attributes =
+      GetAttributes(old_element, false);
+  const std::map<std::string, std::string> new_attributes =
+      GetAttributes(new_element, false);
+  for (const auto& attribute : new_attributes) {
+    auto old_attribute = old_attributes.find(attribute.first);
+    if (old_attribute == old_attributes.end()) {
+      xmlNode* add =
+          AddPatchOperation("add", selector, patch, attribute.second);
+      RCHECK(add && xmlSetProp(add, BAD_CAST "type",
+                               BAD_CAST("@" + attribute.first).c_str()));
+    } else if (old_attribute->second != attribute.second) {
+      RCHECK(AddPatchOperation("replace", selector + "/@" + attribute.first,
+                               patch, attribute.second));
+    }
+  }
+  for (const auto& attribute : old_attributes) {
+    if (new_attributes.count(attribute.first) == 0) {
+      RCHECK(AddPatchOperation("remove", selector + "/@" + attribute.first,
+                               patch));
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 namespace xml {
@@ -253,16 +436,18 @@ std::set<std::string> XmlNode::ExtractReferencedNamespaces() const {
 }
 
 std::string XmlNode::ToString(const std::string& comment) const {
-  // Create an xmlDoc from xmlNodePtr. The node is copied so ownership does not
-  // transfer.
+  // Create an xmlDoc from xmlNodePtr. The node is only attached to the xmlDoc
+  // while formatting, instead of copying the whole tree, and ownership does
+  // not transfer.
+  xmlNode* node = impl_->node.get();
   xml::scoped_xml_ptr<xmlDoc> doc(xmlNewDoc(BAD_CAST "1.0"));
   if (comment.empty()) {
-    xmlDocSetRootElement(doc.get(), xmlCopyNode(impl_->node.get(), true));
+    xmlDocSetRootElement(doc.get(), node);
   } else {
     xml::scoped_xml_ptr<xmlNode> comment_xml(
         xmlNewDocComment(doc.get(), BAD_CAST comment.c_str()));
     xmlDocSetRootElement(doc.get(), comment_xml.get());
-    xmlAddSibling(comment_xml.release(), xmlCopyNode(impl_->node.get(), true));
+    xmlAddSibling(comment_xml.release(), node);
   }
 
   // Format the xmlDoc to string.
@@ -273,9 +458,20 @@ std::string XmlNode::ToString(const std::string& comment) const {
                             kNiceFormat);
   std::string output(doc_str, doc_str + doc_str_size);
   xmlFree(doc_str);
+
+  // Detach the node so that it is not freed with the xmlDoc.
+  xmlUnlinkNode(node);
+  xmlSetTreeDoc(node, nullptr);
   return output;
 }
 
+XmlNode XmlNode::Copy() const {
+  XmlNode copy(reinterpret_cast<const char*>(impl_->node->name));
+  copy.impl_->node.reset(xmlCopyNode(impl_->node.get(), true));
+  DCHECK(copy.impl_->node);
+  return copy;
+}
+
 bool XmlNode::GetAttribute(const std::string& name, std::string* value) const {
   xml::scoped_xml_ptr<xmlChar> str(
       xmlGetProp(impl_->node.get(), BAD_CAST name.c_str()));
@@ -496,9 +692,14 @@ bool RepresentationXmlNode::AddVODOnlyInfo(const MediaInfo& media_info,
 
 bool RepresentationXmlNode::AddLiveOnlyInfo(
     const MediaInfo& media_info,
-    const std::list<SegmentInfo>& segment_infos,
-    bool low_latency_dash_mode) {
-  XmlNode segment_template("SegmentTemplate");
+    const std::deque<SegmentInfo>& segment_infos,
+    bool low_latency_dash_mode,
+    SegmentTimelineCache* segment_timeline_cache,
+    const std::deque<BundledSegment>* bundled_segments) {
+  // A SegmentTemplate cannot address byte ranges of the bundles.
+  const bool use_segment_list = bundled_segments != nullptr;
+  XmlNode segment_template(use_segment_list ? "SegmentList"
+                                            : "SegmentTemplate");
 
   int start_number =
       segment_infos.empty() ? 1 : segment_infos.begin()->start_segment_number;
@@ -529,13 +730,22 @@ bool RepresentationXmlNode::AddLiveOnlyInfo(
   }
 
   if (media_info.has_init_segment_url()) {
-    RCHECK(segment_template.SetStringAttribute("initialization",
+    if (use_segment_list) {
+      XmlNode initialization("Initialization");
+      RCHECK(initialization.SetStringAttribute("sourceURL",
                                                media_info.init_segment_url()));
+      RCHECK(segment_template.AddChild(std::move(initialization)));
+    } else {
+      RCHECK(segment_template.SetStringAttribute(
+          "initialization", media_info.init_segment_url()));
+    }
   }
 
   if (media_info.has_segment_template_url()) {
-    RCHECK(segment_template.SetStringAttribute(
-        "media", media_info.segment_template_url()));
+    if (!use_segment_list) {
+      RCHECK(segment_template.SetStringAttribute(
+          "media", media_info.segment_template_url()));
+    }
     RCHECK(segment_template.SetIntegerAttribute("startNumber", start_number));
   }
 
@@ -556,12 +766,27 @@ bool RepresentationXmlNode::AddLiveOnlyInfo(
       }
     } else {
       if (!low_latency_dash_mode) {
-        XmlNode segment_timeline("SegmentTimeline");
-        RCHECK(PopulateSegmentTimeline(segment_infos, &segment_timeline));
-        RCHECK(segment_template.AddChild(std::move(segment_timeline)));
+        SegmentTimelineCache local_segment_timeline_cache;
+        if (!segment_timeline_cache)
+          segment_timeline_cache = &local_segment_timeline_cache;
+        RCHECK(segment_timeline_cache->Update(segment_infos));
+        RCHECK(segment_template.AddChild(segment_timeline_cache->Copy()));
       }
     }
   }
+
+  if (use_segment_list) {
+    for (const BundledSegment& bundled_segment : *bundled_segments) {
+      XmlNode segment_url("SegmentURL");
+      RCHECK(segment_url.SetStringAttribute("media", bundled_segment.url));
+      RCHECK(segment_url.SetStringAttribute(
+          "mediaRange",
+          absl::StrFormat("%u-%u", bundled_segment.start_byte_offset,
+                          bundled_segment.start_byte_offset +
+                              bundled_segment.size - 1)));
+      RCHECK(segment_template.AddChild(std::move(segment_url)));
+    }
+  }
   return AddChild(std::move(segment_template));
 }
 
@@ -678,5 +903,315 @@ bool RepresentationXmlNode::AddAudioSamplingRateInfo(
                              audio_info.sampling_frequency());
 }
 
+SegmentTimelineCache::SegmentTimelineCache()
+    : segment_timeline_("SegmentTimeline") {}
+
+SegmentTimelineCache::~SegmentTimelineCache() {}
+
+bool SegmentTimelineCache::Update(
+    const std::deque<SegmentInfo>& segment_infos) {
+  xmlNode* segment_timeline = segment_timeline_.GetRawPtr();
+
+  // Drop the S elements of the segments which have been removed from the
+  // beginning of the list. A partially removed element is updated below.
+  if (!segment_infos.empty()) {
+    const int64_t start_time = segment_infos.front().start_time;
+    size_t num_patched_removed = 0;
+    while (!segment_infos_.empty() &&
+           SegmentInfoEndTime(segment_infos_.front()) <= start_time) {
+      xmlNode* s_element = segment_timeline->children;
+      xmlUnlinkNode(s_element);
+      xmlFreeNode(s_element);
+      segment_infos_.pop_front();
+      if (patch_kept_ > 0) {
+        --patch_kept_;
+        ++num_patched_removed;
+      }
+    }
+    if (num_patched_removed > 0) {
+      patch_removed_front_ += num_patched_removed;
+      std::set<size_t> patch_updated;
+      for (size_t index : patch_updated_) {
+        if (index >= num_patched_removed)
+          patch_updated.insert(index - num_patched_removed);
+      }
+      patch_updated_.swap(patch_updated);
+    }
+  }
+
+  // Update the S elements which changed and add the new ones.
+  xmlNode* s_element = segment_timeline->children;
+  auto cached_segment_info = segment_infos_.begin();
+  size_t index = 0;
+  for (const SegmentInfo& segment_info : segment_infos) {
+    if (cached_segment_info == segment_infos_.end()) {
+      s_element = xmlNewChild(segment_timeline, nullptr, BAD_CAST "S", nullptr);
+      RCHECK(s_element);
+      RCHECK(SetSegmentTimelineEntry(segment_info, s_element));
+      segment_infos_.push_back(segment_info);
+      cached_segment_info = segment_infos_.end();
+      s_element = nullptr;
+      continue;
+    }
+    if (!IsSameSegmentTimelineEntry(*cached_segment_info, segment_info)) {
+      RCHECK(SetSegmentTimelineEntry(segment_info, s_element));
+      *cached_segment_info = segment_info;
+      if (index < patch_kept_)
+        patch_updated_.insert(index);
+    }
+    ++cached_segment_info;
+    ++index;
+    s_element = s_element->next;
+  }
+
+  // Remove the S elements which are left over.
+  while (cached_segment_info != segment_infos_.end()) {
+    xmlNode* next = s_element->next;
+    xmlUnlinkNode(s_element);
+    xmlFreeNode(s_element);
+    s_element = next;
+    cached_segment_info = segment_infos_.erase(cached_segment_info);
+    if (index < patch_kept_) {
+      --patch_kept_;
+      ++patch_removed_back_;
+    }
+  }
+  patch_updated_.erase(patch_updated_.lower_bound(patch_kept_),
+                       patch_updated_.end());
+  return true;
+}
+
+XmlNode SegmentTimelineCache::Copy() const {
+  XmlNode copy("SegmentTimeline");
+  copy.impl_->node.reset(xmlCopyNode(segment_timeline_.GetRawPtr(), true));
+  DCHECK(copy.impl_->node);
+  return copy;
+}
+
+void SegmentTimelineCache::MarkPatched() {
+  patch_removed_front_ = 0;
+  patch_removed_back_ = 0;
+  patch_kept_ = segment_infos_.size();
+  patch_updated_.clear();
+}
+
+bool SegmentTimelineCache::AddPatchOperations(const std::string& selector,
+                                              xmlNode* patch) const {
+  // The operations apply in order, so the first S element is removed as many
+  // times as needed, and the indexes of the others are as of after that.
+  for (size_t i = 0; i < patch_removed_front_; ++i)
+    RCHECK(AddPatchOperation("remove", selector + "/S[1]", patch));
+
+  scoped_xml_ptr<xmlNode> add(xmlNewNode(nullptr, BAD_CAST "add"));
+  RCHECK(add &&
+         xmlSetProp(add.get(), BAD_CAST "sel", BAD_CAST selector.c_str()));
+  size_t index = 0;
+  for (xmlNode* s_element = segment_timeline_.GetRawPtr()->children;
+       s_element; s_element = s_element->next, ++index) {
+    if (index >= patch_kept_) {
+      RCHECK(xmlAddChild(add.get(), xmlCopyNode(s_element, true)));
+    } else if (patch_updated_.count(index) > 0) {
+      xmlNode* replace = AddPatchOperation(
+          "replace", absl::StrFormat("%s/S[%u]", selector, index + 1), patch);
+      RCHECK(replace && xmlAddChild(replace, xmlCopyNode(s_element, true)));
+    }
+  }
+
+  for (size_t i = 0; i < patch_removed_back_; ++i) {
+    RCHECK(AddPatchOperation(
+        "remove", absl::StrFormat("%s/S[%u]", selector, patch_kept_ + 1),
+        patch));
+  }
+  if (add->children)
+    RCHECK(xmlAddChild(patch, add.release()));
+  return true;
+}
+
+MpdPatchGenerator::MpdPatchGenerator() {}
+
+MpdPatchGenerator::~MpdPatchGenerator() {}
+
+bool MpdPatchGenerator::Generate(
+    const XmlNode& mpd,
+    const SegmentTimelineCaches& segment_timeline_caches,
+    XmlNode* patch) {
+  const xmlNode* new_mpd = mpd.GetRawPtr();
+  const std::string publish_time = GetProperty(new_mpd, "publishTime");
+
+  // Without operations, the patch only applies to |mpd| itself.
+  std::string original_publish_time = publish_time;
+  *patch = XmlNode("Patch");
+  if (last_mpd_) {
+    if (AddMpdOperations(last_mpd_->GetRawPtr(), new_mpd,
+                         segment_timeline_caches, patch->GetRawPtr())) {
+      original_publish_time = GetProperty(last_mpd_->GetRawPtr(),
+                                          "publishTime");
+    } else {
+      VLOG(1) << "The MPD changed in a way which cannot be patched.";
+      *patch = XmlNode("Patch");
+    }
+  }
+
+  static const char kPatchNamespace[] = "urn:mpeg:dash:schema:mpd-patch:2020";
+  static const char kXmlNamespaceXsi[] =
+      "http://www.w3.org/2001/XMLSchema-instance";
+  static const char kDashSchemaMpdPatch[] =
+      "urn:mpeg:dash:schema:mpd-patch:2020 DASH-MPD-PATCH.xsd";
+  RCHECK(patch->SetStringAttribute("xmlns", kPatchNamespace));
+  RCHECK(patch->SetStringAttribute("xmlns:xsi", kXmlNamespaceXsi));
+  RCHECK(patch->SetStringAttribute("xsi:schemaLocation", kDashSchemaMpdPatch));
+  // The elements of the MPD in the operations keep their prefixes.
+  for (const xmlAttr* attribute = new_mpd->properties; attribute;
+       attribute = attribute->next) {
+    const std::string name = reinterpret_cast<const char*>(attribute->name);
+    if (absl::StartsWith(name, "xmlns:") && name != "xmlns:xsi") {
+      RCHECK(patch->SetStringAttribute(name, GetProperty(new_mpd, name)));
+    }
+  }
+  RCHECK(patch->SetStringAttribute("mpdId", GetProperty(new_mpd, "id")));
+  RCHECK(patch->SetStringAttribute("originalPublishTime",
+                                   original_publish_time));
+  RCHECK(patch->SetStringAttribute("publishTime", publish_time));
+
+  XmlNode last_mpd("MPD");
+  last_mpd.impl_->node.reset(CopyWithoutSegments(new_mpd));
+  if (!last_mpd.impl_->node) {
+    last_mpd_.reset();
+    return false;
+  }
+  last_mpd_ = std::move(last_mpd);
+  for (const auto& entry : segment_timeline_caches)
+    entry.second->MarkPatched();
+  return true;
+}
+
+bool MpdPatchGenerator::AddMpdOperations(
+    const xmlNode* old_mpd,
+    const xmlNode* new_mpd,
+    const SegmentTimelineCaches& segment_timeline_caches,
+    xmlNode* patch) {
+  static const char kMpdSelector[] = "/MPD";
+  // The namespace declarations apply to the whole MPD.
+  RCHECK(GetAttributes(old_mpd, true) == GetAttributes(new_mpd, true));
+  RCHECK(AddAttributeOperations(old_mpd, new_mpd, kMpdSelector, patch));
+
+  // Only the Periods are expected to change: they are added at the end, and
+  // removed from the beginning as they leave the time shift buffer. The
+  // other elements must stay the same.
+  std::vector<const xmlNode*> old_others;
+  std::vector<const xmlNode*> new_others;
+  // The old Periods by @id, with their position.
+  std::map<std::string, std::pair<size_t, const xmlNode*>> old_periods;
+  std::set<std::string> new_period_ids;
+  for (const xmlNode* child : GetChildElements(old_mpd)) {
+    if (IsPeriod(child)) {
+      const size_t position = old_periods.size();
+      old_periods[GetProperty(child, "id")] = {position, child};
+    } else {
+      old_others.push_back(child);
+    }
+  }
+  for (const xmlNode* child : GetChildElements(new_mpd)) {
+    if (IsPeriod(child))
+      new_period_ids.insert(GetProperty(child, "id"));
+    else
+      new_others.push_back(child);
+  }
+  RCHECK(old_others.size() == new_others.size());
+  for (size_t i = 0; i < old_others.size(); ++i)
+    RCHECK(IsSameElement(old_others[i], new_others[i]));
+
+  for (const auto& old_period : old_periods) {
+    if (new_period_ids.count(old_period.first) == 0) {
+      RCHECK(AddPatchOperation(
+          "remove",
+          absl::StrFormat("%s/Period[@id='%s']", kMpdSelector,
+                          old_period.first),
+          patch));
+    }
+  }
+
+  const xmlNode* previous_element = nullptr;
+  std::optional<size_t> previous_position;
+  for (const xmlNode* child : GetChildElements(new_mpd)) {
+    if (IsPeriod(child)) {
+      auto old_period = old_periods.find(GetProperty(child, "id"));
+      if (old_period == old_periods.end()) {
+        // A new Period goes after the element before it, which is already
+        // in the patched MPD.
+        xmlNode* add =
+            previous_element
+                ? AddPatchOperation(
+                      "add",
+                      absl::StrFormat("%s/%s", kMpdSelector,
+                                      GetSelectorStep(previous_element)),
+                      patch)
+                : AddPatchOperation("add", kMpdSelector, patch);
+        RCHECK(add);
+        RCHECK(xmlSetProp(add, BAD_CAST "pos",
+                          BAD_CAST(previous_element ? "after" : "prepend")));
+        RCHECK(xmlAddChild(add, CopyNode(child)));
+      } else {
+        // The Periods are not reordered.
+        const size_t position = old_period->second.first;
+        RCHECK(!previous_position || position > *previous_position);
+        previous_position = position;
+        RCHECK(AddElementOperations(
+            old_period->second.second, child,
+            absl::StrFormat("%s/%s", kMpdSelector, GetSelectorStep(child)),
+            nullptr, segment_timeline_caches, patch));
+      }
+    }
+    previous_element = child;
+  }
+  return true;
+}
+
+bool MpdPatchGenerator::AddElementOperations(
+    const xmlNode* old_element,
+    const xmlNode* new_element,
+    const std::string& selector,
+    const SegmentTimelineCache* segment_timeline_cache,
+    const SegmentTimelineCaches& segment_timeline_caches,
+    xmlNode* patch) {
+  const bool is_segment_timeline =
+      xmlStrEqual(new_element->name, BAD_CAST "SegmentTimeline");
+  if (is_segment_timeline && segment_timeline_cache &&
+      GetAttributes(old_element, false) == GetAttributes(new_element, false)) {
+    return segment_timeline_cache->AddPatchOperations(selector, patch);
+  }
+
+  // Replace the element if it changed other than by its attributes and its
+  // descendants.
+  if (is_segment_timeline || !HaveSameChildren(old_element, new_element)) {
+    xmlNode* replace = AddPatchOperation("replace", selector, patch);
+    return replace && xmlAddChild(replace, CopyNode(new_element));
+  }
+  RCHECK(AddAttributeOperations(old_element, new_element, selector, patch));
+
+  if (xmlStrEqual(new_element->name, BAD_CAST "Representation")) {
+    segment_timeline_cache = nullptr;
+    uint32_t id = 0;
+    if (absl::SimpleAtoi(GetProperty(new_element, "id"), &id)) {
+      auto iter = segment_timeline_caches.find(id);
+      if (iter != segment_timeline_caches.end())
+        segment_timeline_cache = iter->second;
+    }
+  }
+
+  const std::vector<const xmlNode*> old_children =
+      GetChildElements(old_element);
+  const std::vector<const xmlNode*> new_children =
+      GetChildElements(new_element);
+  DCHECK_EQ(old_children.size(), new_children.size());
+  for (size_t i = 0; i < new_children.size(); ++i) {
+    RCHECK(AddElementOperations(
+        old_children[i], new_children[i],
+        absl::StrFormat("%s/%s", selector, GetSelectorStep(new_children[i])),
+        segment_timeline_cache, segment_timeline_caches, patch));
+  }
+  return true;
+}
+
 }  // namespace xml
 }  // namespace shaka
@@ -11,7 +11,10 @@
 #define MPD_BASE_XML_XML_NODE_H_
 
 #include <cstdint>
+#include <deque>
 #include <list>
+#include <map>
+#include <optional>
 #include <set>
 #include <string>
 #include <vector>
@@ -25,9 +28,12 @@ typedef struct _xmlNode xmlNode;
 namespace shaka {
 
 class MpdBuilder;
+struct BundledSegment;
 struct SegmentInfo;
 
 namespace xml {
+class MpdPatchGenerator;
+class SegmentTimelineCache;
 class XmlNode;
 }  // namespace xml
 
@@ -108,9 +114,14 @@ class XmlNode {
   /// @return True if the attribute exists, false if not.
   bool GetAttribute(const std::string& name, std::string* value) const;
 
+  /// @return A deep copy of this element.
+  XmlNode Copy() const;
+
  private:
   friend bool shaka::XmlEqual(const std::string& xml1,
                               const xml::XmlNode& xml2);
+  friend class MpdPatchGenerator;
+  friend class SegmentTimelineCache;
   xmlNode* GetRawPtr() const;
 
   // Don't use xmlNode directly so we don't have to forward-declare a bunch of
@@ -221,10 +232,18 @@ class RepresentationXmlNode : public RepresentationBaseXmlNode {
 
   /// @param segment_infos is a set of SegmentInfos. This method assumes that
   ///        SegmentInfos are sorted by its start time.
+  /// @param segment_timeline_cache, if not null, keeps the SegmentTimeline
+  ///        element between calls so that it does not have to be rebuilt
+  ///        from scratch every time.
+  /// @param bundled_segments, if not null, is the byte range of each segment
+  ///        of @a segment_infos in its bundle. The segments are then listed
+  ///        in a SegmentList instead of a SegmentTemplate.
   [[nodiscard]] bool AddLiveOnlyInfo(
       const MediaInfo& media_info,
-      const std::list<SegmentInfo>& segment_infos,
-      bool low_latency_dash_mode);
+      const std::deque<SegmentInfo>& segment_infos,
+      bool low_latency_dash_mode,
+      SegmentTimelineCache* segment_timeline_cache = nullptr,
+      const std::deque<BundledSegment>* bundled_segments = nullptr);
 
  private:
   // Add AudioChannelConfiguration element. Note that it is a required element
@@ -239,6 +258,107 @@ class RepresentationXmlNode : public RepresentationBaseXmlNode {
   DISALLOW_COPY_AND_ASSIGN(RepresentationXmlNode);
 };
 
+/// Keeps the SegmentTimeline element of a live Representation between MPD
+/// generations. The segment list of a live Representation usually only changes
+/// at both ends, i.e. segments are added or extended at the end and removed
+/// from the beginning, so only the S elements which changed are rebuilt.
+class SegmentTimelineCache {
+ public:
+  SegmentTimelineCache();
+  ~SegmentTimelineCache();
+
+  /// Update the cached SegmentTimeline element to match @a segment_infos.
+  /// @param segment_infos is a set of SegmentInfos sorted by start time.
+  /// @return true on success, false otherwise.
+  [[nodiscard]] bool Update(const std::deque<SegmentInfo>& segment_infos);
+
+  /// @return a copy of the cached SegmentTimeline element.
+  XmlNode Copy() const;
+
+  /// Make the current S elements the base of the next MPD Patch, see
+  /// MpdPatchGenerator.
+  void MarkPatched();
+
+ private:
+  friend class MpdPatchGenerator;
+
+  // Adds the operations which update the S elements as of MarkPatched() to
+  // the current ones to |patch|. |selector| selects the SegmentTimeline.
+  [[nodiscard]] bool AddPatchOperations(const std::string& selector,
+                                        xmlNode* patch) const;
+
+  XmlNode segment_timeline_;
+  // The SegmentInfo of each child of |segment_timeline_|, in the same order.
+  std::deque<SegmentInfo> segment_infos_;
+
+  // The changes to the S elements since MarkPatched(): the number of them
+  // removed from the beginning and from the end, the number of those left
+  // which come first, and the indexes of those which were updated. The other
+  // S elements have been added.
+  size_t patch_removed_front_ = 0;
+  size_t patch_removed_back_ = 0;
+  size_t patch_kept_ = 0;
+  std::set<size_t> patch_updated_;
+
+  DISALLOW_COPY_AND_ASSIGN(SegmentTimelineCache);
+};
+
+/// Generates the MPD Patches of a dynamic MPD, see ISO/IEC 23009-1 5.15, so
+/// that the clients can update their MPD instead of downloading it again.
+/// Each patch updates the MPD given to the previous call of Generate() to the
+/// one given to this call, with the operations of RFC 5261. The changes to
+/// the S elements, which make most of a live MPD, are taken from the
+/// SegmentTimelineCache of the Representations; only the rest of the MPD is
+/// kept and compared. The elements which changed otherwise are replaced
+/// whole.
+class MpdPatchGenerator {
+ public:
+  /// Maps the ID of the Representations to the cache of their
+  /// SegmentTimeline.
+  typedef std::map<uint32_t, SegmentTimelineCache*> SegmentTimelineCaches;
+
+  MpdPatchGenerator();
+  ~MpdPatchGenerator();
+
+  /// @param mpd is the MPD just generated. It must have MPD@id and a
+  ///        MPD@publishTime which differs from those of the previous MPDs.
+  /// @param segment_timeline_caches are the caches of the SegmentTimelines
+  ///        of @a mpd. They are marked as patched.
+  /// @param[out] patch is the MPD Patch. If the changes cannot be patched,
+  ///        e.g. there was no MPD before, it only applies to @a mpd and has
+  ///        no operations, so that the clients with an older MPD download
+  ///        the MPD again.
+  /// @return true on success, false otherwise.
+  [[nodiscard]] bool Generate(
+      const XmlNode& mpd,
+      const SegmentTimelineCaches& segment_timeline_caches,
+      XmlNode* patch);
+
+ private:
+  // Adds the operations which update |old_mpd| to |new_mpd| to |patch|.
+  // Returns false if they cannot be patched.
+  bool AddMpdOperations(const xmlNode* old_mpd,
+                        const xmlNode* new_mpd,
+                        const SegmentTimelineCaches& segment_timeline_caches,
+                        xmlNode* patch);
+
+  // Same as above for an element below the MPD, selected by |selector|.
+  // |segment_timeline_cache| is the cache of the Representation it is in,
+  // if any.
+  bool AddElementOperations(
+      const xmlNode* old_element,
+      const xmlNode* new_element,
+      const std::string& selector,
+      const SegmentTimelineCache* segment_timeline_cache,
+      const SegmentTimelineCaches& segment_timeline_caches,
+      xmlNode* patch);
+
+  // The last MPD, without its S elements.
+  std::optional<XmlNode> last_mpd_;
+
+  DISALLOW_COPY_AND_ASSIGN(MpdPatchGenerator);
+};
+
 }  // namespace xml
 }  // namespace shaka
 #endif  // MPD_BASE_XML_XML_NODE_H_
@@ -6,6 +6,7 @@
 
 #include <packager/mpd/base/xml/xml_node.h>
 
+#include <deque>
 #include <list>
 
 #include <absl/flags/declare.h>
@@ -376,7 +377,7 @@ TEST_F(LiveSegmentTimelineTest, OneSegmentInfo) {
   const uint64_t kRepeat = 9;
   const bool kIsLowLatency = false;
 
-  std::list<SegmentInfo> segment_infos = {
+  std::deque<SegmentInfo> segment_infos = {
       {kStartTime, kDuration, kRepeat, kSegmentNumber},
   };
   RepresentationXmlNode representation;
@@ -398,7 +399,7 @@ TEST_F(LiveSegmentTimelineTest, OneSegmentInfoNonZeroStartTime) {
   const uint64_t kRepeat = 9;
   const bool kIsLowLatency = false;
 
-  std::list<SegmentInfo> segment_infos = {
+  std::deque<SegmentInfo> segment_infos = {
       {kNonZeroStartTime, kDuration, kRepeat, kSegmentNumber},
   };
   RepresentationXmlNode representation;
@@ -423,7 +424,7 @@ TEST_F(LiveSegmentTimelineTest, OneSegmentInfoMatchingStartTimeAndNumber) {
   const uint64_t kRepeat = 9;
   const bool kIsLowLatency = false;
 
-  std::list<SegmentInfo> segment_infos = {
+  std::deque<SegmentInfo> segment_infos = {
       {kNonZeroStartTime, kDuration, kRepeat, kSegmentNumber},
   };
   RepresentationXmlNode representation;
@@ -451,7 +452,7 @@ TEST_F(LiveSegmentTimelineTest, AllSegmentsSameDurationExpectLastOne) {
   const int64_t kDuration2 = 200;
   const uint64_t kRepeat2 = 0;
 
-  std::list<SegmentInfo> segment_infos = {
+  std::deque<SegmentInfo> segment_infos = {
       {kStartTime1, kDuration1, kRepeat1, kSegmentNumber1},
       {kStartTime2, kDuration2, kRepeat2, kSegmentNumber11},
   };
@@ -480,7 +481,7 @@ TEST_F(LiveSegmentTimelineTest, SecondSegmentInfoNonZeroRepeat) {
   const int64_t kDuration2 = 200;
   const uint64_t kRepeat2 = 1;
 
-  std::list<SegmentInfo> segment_infos = {
+  std::deque<SegmentInfo> segment_infos = {
       {kStartTime1, kDuration1, kRepeat1, kSegmentNumber1},
       {kStartTime2, kDuration2, kRepeat2, kSegmentNumber11},
   };
@@ -514,7 +515,7 @@ TEST_F(LiveSegmentTimelineTest, TwoSegmentInfoWithGap) {
   const int64_t kDuration2 = 200;
   const uint64_t kRepeat2 = 0;
 
-  std::list<SegmentInfo> segment_infos = {
+  std::deque<SegmentInfo> segment_infos = {
       {kStartTime1, kDuration1, kRepeat1, kSegmentNumber1},
       {kStartTime2, kDuration2, kRepeat2, kSegmentNumber11},
   };
@@ -541,7 +542,7 @@ TEST_F(LiveSegmentTimelineTest, LastSegmentNumberSupplementalProperty) {
   const uint64_t kRepeat = 9;
   const bool kIsLowLatency = false;
 
-  std::list<SegmentInfo> segment_infos = {
+  std::deque<SegmentInfo> segment_infos = {
       {kStartTime, kDuration, kRepeat, kSegmentNumber},
   };
   RepresentationXmlNode representation;
@@ -562,6 +563,67 @@ TEST_F(LiveSegmentTimelineTest, LastSegmentNumberSupplementalProperty) {
                    "</Representation>"));
 }
 
+TEST_F(LiveSegmentTimelineTest, SegmentTimelineCacheFollowsSlidingWindow) {
+  const bool kIsLowLatency = false;
+  SegmentTimelineCache segment_timeline_cache;
+
+  std::deque<SegmentInfo> segment_infos = {
+      {0, 100, 1, 1},
+      {200, 150, 0, 3},
+      {350, 100, 0, 4},
+  };
+  RepresentationXmlNode representation1;
+  ASSERT_TRUE(representation1.AddLiveOnlyInfo(
+      media_info_, segment_infos, kIsLowLatency, &segment_timeline_cache));
+  EXPECT_THAT(representation1,
+              XmlNodeEqual(
+                  "<Representation>"
+                  "  <SegmentTemplate media=\"$Number$.m4s\" startNumber=\"1\">"
+                  "    <SegmentTimeline>"
+                  "      <S t=\"0\" d=\"100\" r=\"1\"/>"
+                  "      <S t=\"200\" d=\"150\"/>"
+                  "      <S t=\"350\" d=\"100\"/>"
+                  "    </SegmentTimeline>"
+                  "  </SegmentTemplate>"
+                  "</Representation>"));
+
+  // Slide the window past the first segment, and extend the last entry.
+  segment_infos.front() = {100, 100, 0, 2};
+  segment_infos.back().repeat = 1;
+  RepresentationXmlNode representation2;
+  ASSERT_TRUE(representation2.AddLiveOnlyInfo(
+      media_info_, segment_infos, kIsLowLatency, &segment_timeline_cache));
+  EXPECT_THAT(representation2,
+              XmlNodeEqual(
+                  "<Representation>"
+                  "  <SegmentTemplate media=\"$Number$.m4s\" startNumber=\"2\">"
+                  "    <SegmentTimeline>"
+                  "      <S t=\"100\" d=\"100\"/>"
+                  "      <S t=\"200\" d=\"150\"/>"
+                  "      <S t=\"350\" d=\"100\" r=\"1\"/>"
+                  "    </SegmentTimeline>"
+                  "  </SegmentTemplate>"
+                  "</Representation>"));
+
+  // Remove the first two entries and add a new one.
+  segment_infos.pop_front();
+  segment_infos.pop_front();
+  segment_infos.push_back({550, 200, 0, 6});
+  RepresentationXmlNode representation3;
+  ASSERT_TRUE(representation3.AddLiveOnlyInfo(
+      media_info_, segment_infos, kIsLowLatency, &segment_timeline_cache));
+  EXPECT_THAT(representation3,
+              XmlNodeEqual(
+                  "<Representation>"
+                  "  <SegmentTemplate media=\"$Number$.m4s\" startNumber=\"4\">"
+                  "    <SegmentTimeline>"
+                  "      <S t=\"350\" d=\"100\" r=\"1\"/>"
+                  "      <S t=\"550\" d=\"200\"/>"
+                  "    </SegmentTimeline>"
+                  "  </SegmentTemplate>"
+                  "</Representation>"));
+}
+
 // Creating a separate Test Suite for RepresentationXmlNode::AddVODOnlyInfo
 class OnDemandVODSegmentTest : public ::testing::Test {
 };
@@ -751,7 +813,7 @@ TEST_F(LowLatencySegmentTest, LowLatencySegmentTemplate) {
   const uint64_t kRepeat = 0;
   const bool kIsLowLatency = true;
 
-  std::list<SegmentInfo> segment_infos = {
+  std::deque<SegmentInfo> segment_infos = {
       {kStartNumber, kDuration, kRepeat, kStartNumber},
   };
   RepresentationXmlNode representation;
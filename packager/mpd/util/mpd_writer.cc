@@ -11,6 +11,7 @@
 #include <absl/flags/flag.h>
 #include <absl/log/check.h>
 #include <absl/log/log.h>
+#include <absl/strings/match.h>
 #include <google/protobuf/text_format.h>
 
 #include <packager/file.h>
@@ -29,6 +30,9 @@ namespace shaka {
 
 namespace {
 
+// The extension of MediaInfo files in the binary protobuf format.
+const char kBinaryMediaInfoExtension[] = ".pb";
+
 // Factory that creates SimpleMpdNotifier instances.
 class SimpleMpdNotifierFactory : public MpdNotifierFactory {
  public:
@@ -53,8 +57,13 @@ bool MpdWriter::AddFile(const std::string& media_info_path) {
   }
 
   MediaInfo media_info;
-  if (!::google::protobuf::TextFormat::ParseFromString(file_content,
-                                                       &media_info)) {
+  if (absl::EndsWith(media_info_path, kBinaryMediaInfoExtension)) {
+    if (!media_info.ParseFromString(file_content)) {
+      LOG(ERROR) << "Failed to parse " << media_info_path << " to MediaInfo.";
+      return false;
+    }
+  } else if (!::google::protobuf::TextFormat::ParseFromString(file_content,
+                                                              &media_info)) {
     LOG(ERROR) << "Failed to parse " << file_content << " to MediaInfo.";
     return false;
   }
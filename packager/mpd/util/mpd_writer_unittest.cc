@@ -9,9 +9,12 @@
 #include <filesystem>
 
 #include <gmock/gmock.h>
+#include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
 
+#include <packager/file.h>
 #include <packager/file/file_test_util.h>
+#include <packager/mpd/base/media_info.pb.h>
 #include <packager/mpd/base/mock_mpd_notifier.h>
 #include <packager/mpd/base/mpd_options.h>
 #include <packager/mpd/test/mpd_builder_test_helper.h>
@@ -69,6 +72,19 @@ class MpdWriterTest : public ::testing::Test {
     mpd_writer_.SetMpdNotifierFactoryForTest(std::move(notifier_factory_));
   }
 
+  // Writes the text MediaInfo in |text_path| as a binary MediaInfo to
+  // |binary_path|.
+  void WriteBinaryMediaInfo(const std::filesystem::path& text_path,
+                            const std::string& binary_path) {
+    std::string content;
+    ASSERT_TRUE(File::ReadFileToString(text_path.string().c_str(), &content));
+    MediaInfo media_info;
+    ASSERT_TRUE(
+        ::google::protobuf::TextFormat::ParseFromString(content, &media_info));
+    ASSERT_TRUE(File::WriteStringToFile(binary_path.c_str(),
+                                        media_info.SerializeAsString()));
+  }
+
   std::unique_ptr<TestMpdNotifierFactory> notifier_factory_;
   MpdWriter mpd_writer_;
 };
@@ -99,4 +115,24 @@ TEST_F(MpdWriterTest, WriteMpdToFile) {
   EXPECT_TRUE(mpd_writer_.WriteMpdToFile(temp->path().c_str()));
 }
 
+// Verify that MediaInfo files in the binary format are parsed.
+TEST_F(MpdWriterTest, WriteMpdToFileFromBinaryMediaInfo) {
+  const std::string media_info_file1 = generate_unique_temp_path() + ".pb";
+  const std::string media_info_file2 = generate_unique_temp_path() + ".pb";
+  WriteBinaryMediaInfo(GetTestDataFilePath(kFileNameVideoMediaInfo1),
+                       media_info_file1);
+  WriteBinaryMediaInfo(GetTestDataFilePath(kFileNameVideoMediaInfo2),
+                       media_info_file2);
+
+  SetMpdNotifierFactoryForTest();
+  EXPECT_TRUE(mpd_writer_.AddFile(media_info_file1));
+  EXPECT_TRUE(mpd_writer_.AddFile(media_info_file2));
+
+  TempFile mpd_file;
+  EXPECT_TRUE(mpd_writer_.WriteMpdToFile(mpd_file.path().c_str()));
+
+  delete_file(media_info_file1);
+  delete_file(media_info_file2);
+}
+
 }  // namespace shaka
@@ -7,41 +7,73 @@
 #include <packager/packager.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <deque>
+#include <limits>
+#include <map>
 #include <optional>
+#include <set>
+#include <thread>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
+#include <absl/strings/ascii.h>
 #include <absl/strings/match.h>
 #include <absl/strings/str_format.h>
+#include <absl/synchronization/blocking_counter.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/time/time.h>
+#include <nlohmann/json.hpp>
 
 #include <packager/app/job_manager.h>
 #include <packager/app/muxer_factory.h>
 #include <packager/app/packager_util.h>
 #include <packager/app/single_thread_job_manager.h>
 #include <packager/file.h>
+#include <packager/file/file_closer.h>
+#include <packager/file/file_reaper.h>
+#include <packager/file/thread_pool.h>
 #include <packager/hls/base/hls_notifier.h>
 #include <packager/hls/base/simple_hls_notifier.h>
 #include <packager/macros/logging.h>
 #include <packager/macros/status.h>
+#include <packager/media/base/aes_cipher.h>
+#include <packager/media/base/audio_stream_info.h>
 #include <packager/media/base/cc_stream_filter.h>
 #include <packager/media/base/language_utils.h>
 #include <packager/media/base/muxer.h>
 #include <packager/media/base/muxer_util.h>
+#include <packager/media/base/progress_tracker.h>
+#include <packager/media/base/video_stream_info.h>
 #include <packager/media/chunking/chunking_handler.h>
 #include <packager/media/chunking/cue_alignment_handler.h>
+#include <packager/media/chunking/segment_clock.h>
 #include <packager/media/chunking/text_chunker.h>
 #include <packager/media/crypto/encryption_handler.h>
+#include <packager/media/demuxer/demux_hub.h>
 #include <packager/media/demuxer/demuxer.h>
+#include <packager/media/demuxer/text_multiplexer.h>
+#include <packager/media/event/manifest_aggregation.h>
 #include <packager/media/event/muxer_listener_factory.h>
+#include <packager/media/event/segment_index_muxer_listener.h>
+#include <packager/media/event/segment_event_muxer_listener.h>
+#include <packager/media/event/segment_latency_muxer_listener.h>
 #include <packager/media/event/vod_media_info_dump_muxer_listener.h>
+#include <packager/media/formats/mp4/fragment_passthrough.h>
 #include <packager/media/formats/ttml/ttml_to_mp4_handler.h>
 #include <packager/media/formats/webvtt/text_padder.h>
 #include <packager/media/formats/webvtt/webvtt_to_mp4_handler.h>
+#include <packager/media/replicator/async_handoff_handler.h>
 #include <packager/media/replicator/replicator.h>
 #include <packager/media/trick_play/trick_play_handler.h>
 #include <packager/mpd/base/media_info.pb.h>
 #include <packager/mpd/base/simple_mpd_notifier.h>
+#include <packager/utils/huge_pages.h>
+#include <packager/utils/memory_accounting.h>
+#include <packager/utils/memory_budget.h>
+#include <packager/utils/resource_quota.h>
+#include <packager/utils/work_priority.h>
 #include <packager/version/version.h>
 
 namespace shaka {
@@ -53,11 +85,20 @@ using media::KeySource;
 using media::MuxerOptions;
 using media::SingleThreadJobManager;
 using media::SyncPointQueue;
+using media::TextMultiplexer;
 
 namespace media {
 namespace {
 
-const char kMediaInfoSuffix[] = ".media_info";
+// Maximum number of stream data queued for each output stream when
+// |thread_per_output| is enabled.
+const size_t kOutputQueueCapacity = 256;
+// Maximum number of stream data queued for each packager reading a shared
+// input, when |share_inputs| is enabled.
+const size_t kSharedInputQueueCapacity = 256;
+// How long the manifest notifications are waited for to reach the aggregator
+// once the jobs are done.
+const absl::Duration kManifestEventsTimeout = absl::Seconds(60);
 
 MuxerListenerFactory::StreamData ToMuxerListenerData(
     const StreamDescriptor& stream) {
@@ -249,6 +290,14 @@ Status ValidateStreamDescriptor(bool dump_stream_info,
     }
   }
 
+  const double clip_start = stream.clip_start_in_seconds.value_or(0);
+  if (clip_start < 0 || (stream.clip_end_in_seconds &&
+                         *stream.clip_end_in_seconds <= clip_start)) {
+    return Status(error::INVALID_ARGUMENT,
+                  "The clip of a stream must start at a non-negative time "
+                  "before its end.");
+  }
+
   if (stream.output.find('$') != std::string::npos) {
     if (output_format == CONTAINER_WEBVTT) {
       return Status(
@@ -280,6 +329,12 @@ Status ValidateParams(const PackagingParams& packaging_params,
                   "Negative --start_segment_number is not allowed.");
   }
 
+  const double cpu_share = packaging_params.resource_quota_params.cpu_share;
+  if (!(cpu_share >= 0 && cpu_share <= 1)) {
+    return Status(error::INVALID_ARGUMENT,
+                  "The CPU share of the resource quota must be within [0, 1].");
+  }
+
   if (stream_descriptors.empty()) {
     return Status(error::INVALID_ARGUMENT,
                   "Stream descriptors cannot be empty.");
@@ -291,6 +346,8 @@ Status ValidateParams(const PackagingParams& packaging_params,
       stream_descriptors.begin()->segment_template.empty();
   std::set<std::string> outputs;
   std::set<std::string> segment_templates;
+  // The first stream descriptor of each input.
+  std::map<std::string, const StreamDescriptor*> inputs;
   for (const auto& descriptor : stream_descriptors) {
     if (on_demand_dash_profile != descriptor.segment_template.empty()) {
       return Status(error::INVALID_ARGUMENT,
@@ -302,6 +359,23 @@ Status ValidateParams(const PackagingParams& packaging_params,
     RETURN_IF_ERROR(ValidateStreamDescriptor(
         packaging_params.test_params.dump_stream_info, descriptor));
 
+    const bool has_clip = descriptor.clip_start_in_seconds ||
+                          descriptor.clip_end_in_seconds;
+    if (has_clip && packaging_params.share_inputs) {
+      return Status(error::UNIMPLEMENTED,
+                    "Clips are not supported with shared inputs.");
+    }
+    const StreamDescriptor* first_descriptor =
+        inputs.emplace(descriptor.input, &descriptor).first->second;
+    if (first_descriptor->clip_start_in_seconds !=
+            descriptor.clip_start_in_seconds ||
+        first_descriptor->clip_end_in_seconds !=
+            descriptor.clip_end_in_seconds) {
+      return Status(error::INVALID_ARGUMENT,
+                    "All the streams of input '" + descriptor.input +
+                        "' must have the same clip.");
+    }
+
     if (absl::StartsWith(descriptor.input, "udp://")) {
       const HlsParams& hls_params = packaging_params.hls_params;
       if (!hls_params.master_playlist_output.empty() &&
@@ -345,6 +419,12 @@ Status ValidateParams(const PackagingParams& packaging_params,
                   "(not using segment_template).");
   }
 
+  if (packaging_params.media_info_callback && !on_demand_dash_profile) {
+    return Status(error::UNIMPLEMENTED,
+                  "media_info_callback is only supported for on-demand "
+                  "profile (not using segment_template).");
+  }
+
   if (on_demand_dash_profile &&
       !packaging_params.mpd_params.mpd_output.empty() &&
       !packaging_params.mp4_output_params.generate_sidx_in_media_segments &&
@@ -375,6 +455,59 @@ Status ValidateParams(const PackagingParams& packaging_params,
                   "if --low_latency_dash_mode is enabled.");
   }
 
+  if (packaging_params.hls_params.low_latency_hls_mode) {
+    // The partial segments are built from the low latency chunks.
+    if (!packaging_params.chunking_params.low_latency_dash_mode) {
+      return Status(error::INVALID_ARGUMENT,
+                    "--low_latency_dash_mode must be set "
+                    "if --low_latency_hls_mode is enabled.");
+    }
+    if (packaging_params.hls_params.playlist_type == HlsPlaylistType::kVod) {
+      return Status(error::INVALID_ARGUMENT,
+                    "--hls_playlist_type must be LIVE or EVENT "
+                    "if --low_latency_hls_mode is enabled.");
+    }
+    if (packaging_params.hls_params.part_target_duration <= 0) {
+      return Status(error::INVALID_ARGUMENT,
+                    "--hls_part_target_duration must be positive.");
+    }
+  }
+
+  if (packaging_params.mp4_output_params.segment_bundle_duration_in_seconds <
+      0) {
+    return Status(error::INVALID_ARGUMENT,
+                  "--mp4_segment_bundle_duration must not be negative.");
+  }
+  if (packaging_params.mp4_output_params.segment_bundle_duration_in_seconds >
+          0 &&
+      packaging_params.mp4_output_params.low_latency_dash_mode) {
+    return Status(error::INVALID_ARGUMENT,
+                  "--mp4_segment_bundle_duration cannot be set "
+                  "if --low_latency_dash_mode is enabled.");
+  }
+
+  if (packaging_params.hls_params.delta_updates &&
+      packaging_params.hls_params.playlist_type == HlsPlaylistType::kVod) {
+    return Status(error::INVALID_ARGUMENT,
+                  "--hls_playlist_type must be LIVE or EVENT "
+                  "if --hls_delta_updates is enabled.");
+  }
+
+  // The segments of the VOD archives must outlive the live window.
+  if (!packaging_params.mpd_params.vod_archive_mpd_output.empty() &&
+      packaging_params.mpd_params.preserved_segments_outside_live_window > 0) {
+    return Status(error::INVALID_ARGUMENT,
+                  "--preserved_segments_outside_live_window must be 0 "
+                  "if --mpd_vod_archive_output is set.");
+  }
+  if (!packaging_params.hls_params.vod_archive_master_playlist_output
+           .empty() &&
+      packaging_params.hls_params.preserved_segments_outside_live_window > 0) {
+    return Status(error::INVALID_ARGUMENT,
+                  "--preserved_segments_outside_live_window must be 0 "
+                  "if --hls_vod_archive_output is set.");
+  }
+
   return Status::OK;
 }
 
@@ -406,6 +539,17 @@ class FakeClock : public Clock {
   }
 };
 
+// A clock which returns the time of a function, see TestParams::clock.
+class FunctionClock : public Clock {
+ public:
+  explicit FunctionClock(std::function<time_point()> now) : now_(now) {}
+
+  time_point now() noexcept override { return now_(); }
+
+ private:
+  std::function<time_point()> now_;
+};
+
 bool StreamInfoToTextMediaInfo(const StreamDescriptor& stream_descriptor,
                                MediaInfo* text_media_info) {
   std::string codec;
@@ -458,6 +602,18 @@ Status CreateDemuxer(const StreamDescriptor& stream,
   std::shared_ptr<Demuxer> demuxer = std::make_shared<Demuxer>(stream.input);
   demuxer->set_dump_stream_info(packaging_params.test_params.dump_stream_info);
   demuxer->set_input_format(stream.input_format);
+  demuxer->set_use_mmap(packaging_params.mmap_local_inputs);
+  demuxer->set_num_parsing_threads(packaging_params.parsing_threads);
+  demuxer->set_pending_stream_limit(
+      packaging_params.max_pending_stream_bytes,
+      packaging_params.pending_stream_policy == PendingStreamPolicy::kDrop);
+  demuxer->set_text_heartbeat_interval(
+      packaging_params.text_heartbeat_interval_ms / 1000.0);
+  if (stream.clip_start_in_seconds || stream.clip_end_in_seconds) {
+    demuxer->SetClipRange(stream.clip_start_in_seconds.value_or(0),
+                          stream.clip_end_in_seconds.value_or(
+                              std::numeric_limits<double>::infinity()));
+  }
 
   if (packaging_params.decryption_params.key_provider != KeyProvider::kNone) {
     std::unique_ptr<KeySource> decryption_key_source(
@@ -468,16 +624,133 @@ Status CreateDemuxer(const StreamDescriptor& stream,
           "Must define decryption key source when defining key provider");
     }
     demuxer->SetKeySource(std::move(decryption_key_source));
+    demuxer->set_num_decryption_threads(
+        packaging_params.decryption_params.sample_decryption_threads);
   }
 
   *new_demuxer = std::move(demuxer);
   return Status::OK;
 }
 
+/// Subscribes to the demuxer of |stream.input| shared in the process. If the
+/// input is not being demuxed yet, its demuxer is created from |stream|.
+Status SubscribeToSharedInput(
+    const StreamDescriptor& stream,
+    const std::vector<std::reference_wrapper<const StreamDescriptor>>& streams,
+    const PackagingParams& packaging_params,
+    std::shared_ptr<DemuxHubSubscriber>* subscriber) {
+  auto create_demuxer = [&](std::shared_ptr<Demuxer>* demuxer) -> Status {
+    RETURN_IF_ERROR(CreateDemuxer(stream, packaging_params, demuxer));
+    // The handlers are set through the subscribers, so the language overrides
+    // of all the streams of the input are set here.
+    for (const StreamDescriptor& other : streams) {
+      if (other.input == stream.input && !other.language.empty()) {
+        (*demuxer)->SetLanguageOverride(other.stream_selector,
+                                        other.language);
+      }
+    }
+    return Status::OK;
+  };
+  return DemuxHub::GetInstance()->Subscribe(
+      stream.input, create_demuxer, kSharedInputQueueCapacity, subscriber);
+}
+
+/// Whether the samples of |input| can be transcrypted by the encryption
+/// handlers instead of being decrypted by its demuxer, i.e. whether all its
+/// streams with an output are encrypted.
+bool CanTranscryptInput(
+    const std::string& input,
+    const std::vector<std::reference_wrapper<const StreamDescriptor>>&
+        streams) {
+  for (const StreamDescriptor& stream : streams) {
+    if (stream.input != input ||
+        (stream.output.empty() && stream.segment_template.empty())) {
+      continue;
+    }
+    if (IsTextStream(stream) || stream.skip_encryption)
+      return false;
+  }
+  return true;
+}
+
+/// Whether the fragments of |stream.input| can be copied verbatim into the
+/// output of |stream| by a FragmentPassthrough, i.e. the passthrough is
+/// enabled, nothing else needs the samples of the input and the input is a
+/// fragmented MP4 file with a single clear track.
+bool CanPassThroughFragments(
+    const StreamDescriptor& stream,
+    const std::vector<std::reference_wrapper<const StreamDescriptor>>& streams,
+    const PackagingParams& packaging_params,
+    KeySource* encryption_key_source,
+    SyncPointQueue* sync_points,
+    const std::map<std::string, std::shared_ptr<Demuxer>>& push_demuxers) {
+  if (!packaging_params.mp4_output_params.passthrough_fragments ||
+      packaging_params.share_inputs || sync_points ||
+      (encryption_key_source && !stream.skip_encryption) ||
+      packaging_params.decryption_params.key_provider != KeyProvider::kNone ||
+      packaging_params.chunking_params.low_latency_dash_mode ||
+      packaging_params.mp4_output_params.include_prft_in_segments ||
+      packaging_params.mp4_output_params.segment_bundle_duration_in_seconds >
+          0) {
+    return false;
+  }
+  if (GetOutputFormat(stream) != CONTAINER_MOV ||
+      stream.segment_template.empty() || stream.trick_play_factor ||
+      stream.cc_index >= 0 || !stream.language.empty() ||
+      stream.clip_start_in_seconds || stream.clip_end_in_seconds ||
+      push_demuxers.count(stream.input)) {
+    return false;
+  }
+  for (const StreamDescriptor& other : streams) {
+    if (&other != &stream && other.input == stream.input)
+      return false;
+  }
+  // The input is read twice, so it must be a file rather than a stream.
+  return File::GetFileSize(stream.input.c_str()) > 0 &&
+         mp4::FragmentPassthrough::CanPassThrough(
+             stream.input, stream.stream_selector);
+}
+
+/// Whether all the streams of |input| are text streams, so that the input can
+/// be run by a TextMultiplexer.
+bool IsTextOnlyInput(
+    const std::string& input,
+    const std::vector<std::reference_wrapper<const StreamDescriptor>>&
+        streams) {
+  for (const StreamDescriptor& stream : streams) {
+    if (stream.input == input && !IsTextStream(stream))
+      return false;
+  }
+  return true;
+}
+
+/// The sub-streams of the text streams of |input| which have an output, or
+/// none if an output takes all of them, e.g. the teletext pages of the
+/// cc_index of the outputs, which are the only ones the demuxer decodes.
+std::set<uint16_t> GetSelectedTextSubStreams(
+    const std::string& input,
+    const std::vector<std::reference_wrapper<const StreamDescriptor>>&
+        streams) {
+  std::set<uint16_t> sub_streams;
+  for (const StreamDescriptor& stream : streams) {
+    if (stream.input != input ||
+        (stream.output.empty() && stream.segment_template.empty()) ||
+        stream.stream_selector == "audio" ||
+        stream.stream_selector == "video") {
+      continue;
+    }
+    if (stream.cc_index < 0)
+      return {};
+    sub_streams.insert(static_cast<uint16_t>(stream.cc_index));
+  }
+  return sub_streams;
+}
+
 std::shared_ptr<MediaHandler> CreateEncryptionHandler(
     const PackagingParams& packaging_params,
     const StreamDescriptor& stream,
-    KeySource* key_source) {
+    KeySource* key_source,
+    KeySource* decryption_key_source) {
   if (stream.skip_encryption) {
     return nullptr;
   }
@@ -515,7 +788,8 @@ std::shared_ptr<MediaHandler> CreateEncryptionHandler(
         kDefaultMaxHdPixels, kDefaultMaxUhd1Pixels, std::placeholders::_1);
   }
 
-  return std::make_shared<EncryptionHandler>(encryption_params, key_source);
+  return std::make_shared<EncryptionHandler>(encryption_params, key_source,
+                                             decryption_key_source);
 }
 
 std::unique_ptr<MediaHandler> CreateTextChunker(
@@ -580,65 +854,199 @@ Status CreateTtmlJobs(
       }
 
       if (packaging_params.output_media_info) {
+        const MediaInfoFormat format = packaging_params.media_info_format;
         VodMediaInfoDumpMuxerListener::WriteMediaInfoToFile(
-            text_media_info, stream.output + kMediaInfoSuffix);
+            text_media_info,
+            stream.output +
+                VodMediaInfoDumpMuxerListener::GetMediaInfoFileSuffix(format),
+            format);
       }
+      if (packaging_params.media_info_callback)
+        packaging_params.media_info_callback(stream.output, text_media_info);
     }
   }
 
   return Status::OK;
 }
 
+// Enables the statistics of |handler| if they are collected, i.e. if
+// |handler_stats| is not null, and adds them to |handler_stats|.
+void EnableHandlerStats(
+    const std::string& label,
+    const std::shared_ptr<MediaHandler>& handler,
+    std::vector<std::shared_ptr<const MediaHandlerStats>>* handler_stats) {
+  if (handler_stats && handler)
+    handler_stats->push_back(handler->EnableStats(label));
+}
+
 Status CreateAudioVideoJobs(
-    const std::vector<std::reference_wrapper<const StreamDescriptor>>& streams,
+    const std::vector<std::reference_wrapper<const StreamDescriptor>>&
+        all_streams,
     const PackagingParams& packaging_params,
     KeySource* encryption_key_source,
     SyncPointQueue* sync_points,
     MuxerListenerFactory* muxer_listener_factory,
     MuxerFactory* muxer_factory,
-    JobManager* job_manager) {
+    JobManager* job_manager,
+    ProgressTracker* progress_tracker,
+    std::vector<std::shared_ptr<const MediaHandlerStats>>* handler_stats,
+    std::map<std::string, std::shared_ptr<Demuxer>>* push_demuxers) {
   DCHECK(muxer_listener_factory);
   DCHECK(muxer_factory);
   DCHECK(job_manager);
+
+  // The streams which are copied verbatim get a job of their own, and the
+  // others are remuxed.
+  std::vector<std::reference_wrapper<const StreamDescriptor>> streams;
+  for (const StreamDescriptor& stream : all_streams) {
+    if (!CanPassThroughFragments(stream, all_streams, packaging_params,
+                                 encryption_key_source, sync_points,
+                                 *push_demuxers)) {
+      streams.push_back(stream);
+      continue;
+    }
+    auto passthrough = std::make_shared<mp4::FragmentPassthrough>(
+        stream.input, muxer_factory->CreateMuxerOptions(stream),
+        packaging_params.chunking_params,
+        muxer_listener_factory->CreateListener(ToMuxerListenerData(stream)));
+    job_manager->Add("PassthroughJob", passthrough);
+  }
+
   // Store all the demuxers in a map so that we can look up a stream's demuxer.
   // This is step one in making this part of the pipeline less dependant on
   // order.
   std::map<std::string, std::shared_ptr<Demuxer>> sources;
+  // The inputs shared with other packagers, if |share_inputs| is set.
+  std::map<std::string, std::shared_ptr<DemuxHubSubscriber>> shared_sources;
   std::map<std::string, std::shared_ptr<MediaHandler>> cue_aligners;
+  // Runs the text inputs in a single job, if |multiplex_text_inputs| is set.
+  // The text inputs then share a cue alignment handler too.
+  std::shared_ptr<TextMultiplexer> text_multiplexer;
+  std::shared_ptr<MediaHandler> text_cue_aligner;
+  std::set<std::string> multiplexed_inputs;
 
   for (const StreamDescriptor& stream : streams) {
-    bool seen_input_before = sources.find(stream.input) != sources.end();
+    bool seen_input_before =
+        cue_aligners.find(stream.input) != cue_aligners.end();
     if (seen_input_before) {
       continue;
     }
 
-    RETURN_IF_ERROR(
-        CreateDemuxer(stream, packaging_params, &sources[stream.input]));
+    std::shared_ptr<OriginHandler> source;
+    if (packaging_params.multiplex_text_inputs &&
+        !packaging_params.share_inputs &&
+        IsTextOnlyInput(stream.input, streams)) {
+      RETURN_IF_ERROR(
+          CreateDemuxer(stream, packaging_params, &sources[stream.input]));
+      if (!text_multiplexer) {
+        text_multiplexer = std::make_shared<TextMultiplexer>();
+        text_cue_aligner =
+            sync_points ? std::make_shared<CueAlignmentHandler>(
+                              sync_points,
+                              packaging_params.ad_cue_generator_params
+                                  .max_buffered_bytes_per_input,
+                              packaging_params.temp_dir)
+                        : nullptr;
+        EnableHandlerStats("TextMultiplexer", text_multiplexer,
+                           handler_stats);
+        EnableHandlerStats("TextMultiplexer/CueAlignmentHandler",
+                           text_cue_aligner, handler_stats);
+      }
+      cue_aligners[stream.input] = text_cue_aligner;
+      multiplexed_inputs.insert(stream.input);
+      continue;
+    }
+
+    if (packaging_params.share_inputs) {
+      RETURN_IF_ERROR(SubscribeToSharedInput(stream, streams, packaging_params,
+                                             &shared_sources[stream.input]));
+      source = shared_sources[stream.input];
+    } else {
+      RETURN_IF_ERROR(
+          CreateDemuxer(stream, packaging_params, &sources[stream.input]));
+      // Decrypting and encrypting the samples in one pass saves a copy.
+      if (encryption_key_source && CanTranscryptInput(stream.input, streams))
+        sources[stream.input]->set_decrypt_samples(false);
+      auto push_demuxer = push_demuxers->find(stream.input);
+      if (push_demuxer != push_demuxers->end()) {
+        sources[stream.input]->set_push_mode(true);
+        push_demuxer->second = sources[stream.input];
+      }
+      source = sources[stream.input];
+    }
     cue_aligners[stream.input] =
-        sync_points ? std::make_shared<CueAlignmentHandler>(sync_points)
-                    : nullptr;
+        sync_points
+            ? std::make_shared<CueAlignmentHandler>(
+                  sync_points,
+                  packaging_params.ad_cue_generator_params
+                      .max_buffered_bytes_per_input,
+                  packaging_params.temp_dir)
+            : nullptr;
+
+    EnableHandlerStats(stream.input + "/Demuxer", source, handler_stats);
+    EnableHandlerStats(stream.input + "/CueAlignmentHandler",
+                       cue_aligners[stream.input], handler_stats);
   }
 
   for (auto& source : sources) {
+    // Unlike |shared_sources|, which other packagers read too, the inputs
+    // are read for this packager alone, so their progress is its own.
+    if (progress_tracker)
+      source.second->set_progress_tracker(progress_tracker);
+    source.second->set_selected_text_sub_streams(
+        GetSelectedTextSubStreams(source.first, streams));
+    // The multiplexed text inputs are run by the text multiplexer.
+    if (multiplexed_inputs.count(source.first) == 0)
+      job_manager->Add("RemuxJob", source.second);
+  }
+  if (text_multiplexer)
+    job_manager->Add("TextMuxJob", text_multiplexer);
+  for (auto& source : shared_sources) {
     job_manager->Add("RemuxJob", source.second);
   }
 
+  // The trick play factors of the streams with the same input and stream
+  // selector, in the order of the streams.
+  std::map<std::pair<std::string, std::string>, std::vector<uint32_t>>
+      trick_play_factors;
+  for (const StreamDescriptor& stream : streams) {
+    if (stream.trick_play_factor &&
+        (!stream.output.empty() || !stream.segment_template.empty())) {
+      trick_play_factors[{stream.input, stream.stream_selector}].push_back(
+          stream.trick_play_factor);
+    }
+  }
+
   // Replicators are shared among all streams with the same input and stream
   // selector.
   std::shared_ptr<MediaHandler> replicator;
+  // The trick play handler makes the trick play streams of all the factors of
+  // a stream in one pass, so it is shared among them too.
+  std::shared_ptr<MediaHandler> trick_play_handler;
+  // Likewise, the channels of a text stream are split among their outputs in
+  // one pass.
+  std::shared_ptr<CcStreamSplitter> cc_stream_splitter;
 
   std::string previous_input;
   std::string previous_selector;
 
   for (const StreamDescriptor& stream : streams) {
-    // Get the demuxer for this stream.
-    auto& demuxer = sources[stream.input];
+    // Get the demuxer for this stream, or its subscriber if it is shared.
+    std::shared_ptr<Demuxer> demuxer;
+    std::shared_ptr<DemuxHubSubscriber> shared_source;
+    if (packaging_params.share_inputs)
+      shared_source = shared_sources[stream.input];
+    else
+      demuxer = sources[stream.input];
     auto& cue_aligner = cue_aligners[stream.input];
 
     const bool new_input_file = stream.input != previous_input;
     const bool new_stream =
         new_input_file || previous_selector != stream.stream_selector;
     const bool is_text = IsTextStream(stream);
+    // Labels the handlers of the stream in the statistics.
+    const std::string stream_label =
+        stream.input + ":" + stream.stream_selector + "/";
     previous_input = stream.input;
     previous_selector = stream.stream_selector;
 
@@ -652,7 +1060,7 @@ Status CreateAudioVideoJobs(
     // new stream. Multiple stream descriptors may have the same stream but
     // only differ by trick play factor.
     if (new_stream) {
-      if (!stream.language.empty()) {
+      if (demuxer && !stream.language.empty()) {
         demuxer->SetLanguageOverride(stream.stream_selector, stream.language);
       }
 
@@ -660,6 +1068,8 @@ Status CreateAudioVideoJobs(
       if (is_text) {
         handlers.emplace_back(std::make_shared<TextPadder>(
             packaging_params.default_text_zero_bias_ms));
+        EnableHandlerStats(stream_label + "TextPadder", handlers.back(),
+                           handler_stats);
       }
       if (sync_points) {
         handlers.emplace_back(cue_aligner);
@@ -667,15 +1077,33 @@ Status CreateAudioVideoJobs(
       if (!is_text) {
         handlers.emplace_back(std::make_shared<ChunkingHandler>(
             packaging_params.chunking_params));
-        handlers.emplace_back(CreateEncryptionHandler(packaging_params, stream,
-                                                      encryption_key_source));
+        EnableHandlerStats(stream_label + "ChunkingHandler", handlers.back(),
+                           handler_stats);
+        handlers.emplace_back(CreateEncryptionHandler(
+            packaging_params, stream, encryption_key_source,
+            demuxer ? demuxer->key_source() : nullptr));
+        EnableHandlerStats(stream_label + "EncryptionHandler",
+                           handlers.back(), handler_stats);
       }
 
       replicator = std::make_shared<Replicator>();
       handlers.emplace_back(replicator);
+      EnableHandlerStats(stream_label + "Replicator", replicator,
+                         handler_stats);
 
       RETURN_IF_ERROR(MediaHandler::Chain(handlers));
-      RETURN_IF_ERROR(demuxer->SetHandler(stream.stream_selector, handlers[0]));
+      if (multiplexed_inputs.count(stream.input)) {
+        RETURN_IF_ERROR(text_multiplexer->AddInput(
+            demuxer, stream.stream_selector, handlers[0]));
+      } else if (demuxer) {
+        RETURN_IF_ERROR(
+            demuxer->SetHandler(stream.stream_selector, handlers[0]));
+      } else {
+        RETURN_IF_ERROR(
+            shared_source->SetHandler(stream.stream_selector, handlers[0]));
+      }
+      trick_play_handler = nullptr;
+      cc_stream_splitter = nullptr;
     }
 
     // Create the muxer (output) for this track.
@@ -692,37 +1120,96 @@ Status CreateAudioVideoJobs(
         muxer_listener_factory->CreateListener(ToMuxerListenerData(stream));
     muxer->SetMuxerListener(std::move(muxer_listener));
 
-    std::vector<std::shared_ptr<MediaHandler>> handlers;
-    handlers.emplace_back(replicator);
+    // Labels the handlers of this output in the statistics.
+    const std::string output_label =
+        stream_label +
+        (stream.output.empty() ? stream.segment_template : stream.output) + "/";
+
+    // Trick play is optional. The first trick play stream connects the shared
+    // trick play handler to the replicator, and each trick play stream is then
+    // fed by its own output of the trick play handler.
+    if (stream.trick_play_factor && !trick_play_handler) {
+      std::vector<std::shared_ptr<MediaHandler>> handlers;
+      handlers.emplace_back(replicator);
+      if (packaging_params.thread_per_output &&
+          !packaging_params.single_threaded) {
+        handlers.emplace_back(
+            std::make_shared<AsyncHandoffHandler>(kOutputQueueCapacity));
+        EnableHandlerStats(stream_label + "TrickPlay/AsyncHandoffHandler",
+                           handlers.back(), handler_stats);
+      }
+      trick_play_handler = std::make_shared<TrickPlayHandler>(
+          trick_play_factors[{stream.input, stream.stream_selector}]);
+      handlers.emplace_back(trick_play_handler);
+      EnableHandlerStats(stream_label + "TrickPlayHandler", trick_play_handler,
+                         handler_stats);
+      RETURN_IF_ERROR(MediaHandler::Chain(handlers));
+    }
+
+    // The first channel output connects the shared splitter to the
+    // replicator, and each channel output is then fed by its own output of the
+    // splitter, which only receives the samples of its channel.
+    const bool split_cc = stream.cc_index >= 0 && !stream.trick_play_factor;
+    if (split_cc && !cc_stream_splitter) {
+      cc_stream_splitter = std::make_shared<CcStreamSplitter>();
+      EnableHandlerStats(stream_label + "CcStreamSplitter", cc_stream_splitter,
+                         handler_stats);
+      RETURN_IF_ERROR(MediaHandler::Chain({replicator, cc_stream_splitter}));
+    }
 
-    // Trick play is optional.
+    std::vector<std::shared_ptr<MediaHandler>> handlers;
     if (stream.trick_play_factor) {
-      handlers.emplace_back(
-          std::make_shared<TrickPlayHandler>(stream.trick_play_factor));
+      handlers.emplace_back(trick_play_handler);
+    } else {
+      if (!split_cc)
+        handlers.emplace_back(replicator);
+
+      // Hand the rest of the output chain over to its own thread if
+      // requested.
+      if (packaging_params.thread_per_output &&
+          !packaging_params.single_threaded) {
+        handlers.emplace_back(
+            std::make_shared<AsyncHandoffHandler>(kOutputQueueCapacity));
+        EnableHandlerStats(output_label + "AsyncHandoffHandler",
+                           handlers.back(), handler_stats);
+      }
     }
 
-    if (stream.cc_index >= 0) {
+    if (stream.cc_index >= 0 && !split_cc) {
       handlers.emplace_back(
           std::make_shared<CcStreamFilter>(stream.language, stream.cc_index));
+      EnableHandlerStats(output_label + "CcStreamFilter", handlers.back(),
+                         handler_stats);
     }
 
     if (is_text &&
         (!stream.segment_template.empty() || output_format == CONTAINER_MOV)) {
       handlers.emplace_back(
           CreateTextChunker(packaging_params.chunking_params));
+      EnableHandlerStats(output_label + "TextChunker", handlers.back(),
+                         handler_stats);
     }
 
     if (is_text && output_format == CONTAINER_MOV) {
       const auto output_codec = GetTextOutputCodec(stream);
       if (output_codec == CONTAINER_WEBVTT) {
         handlers.emplace_back(std::make_shared<WebVttToMp4Handler>());
+        EnableHandlerStats(output_label + "WebVttToMp4Handler",
+                           handlers.back(), handler_stats);
       } else if (output_codec == CONTAINER_TTML) {
         handlers.emplace_back(std::make_shared<ttml::TtmlToMp4Handler>());
+        EnableHandlerStats(output_label + "TtmlToMp4Handler", handlers.back(),
+                           handler_stats);
       }
     }
 
     handlers.emplace_back(muxer);
+    EnableHandlerStats(output_label + "Muxer", muxer, handler_stats);
     RETURN_IF_ERROR(MediaHandler::Chain(handlers));
+    if (split_cc) {
+      RETURN_IF_ERROR(cc_stream_splitter->AddOutput(
+          stream.language, stream.cc_index, handlers.front()));
+    }
   }
 
   return Status::OK;
@@ -735,10 +1222,16 @@ Status CreateAllJobs(const std::vector<StreamDescriptor>& stream_descriptors,
                      SyncPointQueue* sync_points,
                      MuxerListenerFactory* muxer_listener_factory,
                      MuxerFactory* muxer_factory,
-                     JobManager* job_manager) {
+                     JobManager* job_manager,
+                     ProgressTracker* progress_tracker,
+                     std::vector<std::shared_ptr<const MediaHandlerStats>>*
+                         handler_stats,
+                     std::map<std::string, std::shared_ptr<Demuxer>>*
+                         push_demuxers) {
   DCHECK(muxer_factory);
   DCHECK(muxer_listener_factory);
   DCHECK(job_manager);
+  DCHECK(push_demuxers);
 
   // Group all streams based on which pipeline they will use.
   std::vector<std::reference_wrapper<const StreamDescriptor>> ttml_streams;
@@ -795,27 +1288,310 @@ Status CreateAllJobs(const std::vector<StreamDescriptor>& stream_descriptors,
                                  muxer_factory, mpd_notifier, job_manager));
   RETURN_IF_ERROR(CreateAudioVideoJobs(
       audio_video_streams, packaging_params, encryption_key_source, sync_points,
-      muxer_listener_factory, muxer_factory, job_manager));
+      muxer_listener_factory, muxer_factory, job_manager, progress_tracker,
+      handler_stats, push_demuxers));
 
   // Initialize processing graph.
   return job_manager->InitializeJobs();
 }
 
+// The segment duration of the segments packaged on request, long enough for
+// any segment of the intermediate.
+const double kSegmentRequestDurationInSeconds = 1e9;
+// Used to name the memory files of the segments packaged on request.
+std::atomic<uint64_t> g_segment_request_count{0};
+
+// @return the extension of |file_name|, including the dot, or an empty string
+//         if it has none.
+std::string GetExtension(const std::string& file_name) {
+  const size_t pos = file_name.find_last_of("./");
+  if (pos == std::string::npos || file_name[pos] != '.')
+    return std::string();
+  return file_name.substr(pos);
+}
+
+Status CopyRange(File* source, const Range& range, File* destination) {
+  const int64_t size = static_cast<int64_t>(range.end - range.start + 1);
+  if (!source->Seek(range.start) ||
+      File::Copy(source, destination, size) != size) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot read " + std::to_string(size) + " bytes at " +
+                      std::to_string(range.start) + " from " +
+                      source->file_name());
+  }
+  return Status::OK;
+}
+
+// Write the init section and the segments |first_segment| to |last_segment|
+// of |input| to |file_name|.
+Status WriteSegmentInput(const std::string& input,
+                         const SegmentIndex& index,
+                         size_t first_segment,
+                         size_t last_segment,
+                         const std::string& file_name) {
+  DCHECK_LE(first_segment, last_segment);
+  if (!index.init_range) {
+    return Status(error::INVALID_ARGUMENT,
+                  "The segment index of " + input + " has no init section.");
+  }
+  if (last_segment >= index.segments.size()) {
+    return Status(error::NOT_FOUND,
+                  "Segment " + std::to_string(last_segment) + " is not in " +
+                      input + ", which has " +
+                      std::to_string(index.segments.size()) + " segments.");
+  }
+
+  std::unique_ptr<File, FileCloser> source(File::Open(input.c_str(), "r"));
+  if (!source)
+    return Status(error::FILE_FAILURE, "Cannot open file " + input);
+  std::unique_ptr<File, FileCloser> destination(
+      File::Open(file_name.c_str(), "w"));
+  if (!destination)
+    return Status(error::FILE_FAILURE, "Cannot open file " + file_name);
+  RETURN_IF_ERROR(
+      CopyRange(source.get(), *index.init_range, destination.get()));
+  // The segments of an on-demand output are contiguous.
+  const Range range = {index.segments[first_segment].range.start,
+                       index.segments[last_segment].range.end};
+  RETURN_IF_ERROR(CopyRange(source.get(), range, destination.get()));
+  if (!destination.release()->Close())
+    return Status(error::FILE_FAILURE, "Cannot close file " + file_name);
+  return Status::OK;
+}
+
+Status ReadOutput(const std::string& file_name, std::vector<uint8_t>* data) {
+  std::string content;
+  if (!File::ReadFileToString(file_name.c_str(), &content))
+    return Status(error::FILE_FAILURE, "Cannot read file " + file_name);
+  data->assign(content.begin(), content.end());
+  return Status::OK;
+}
+
+// @return true if |chunking_params| starts the segments of |index| at the same
+//         key frames as in |index|, as when it was packaged with them.
+bool MatchesChunking(const SegmentIndex& index,
+                     const ChunkingParams& chunking_params) {
+  if (!chunking_params.segment_sap_aligned)
+    return false;
+  const SegmentClock segment_clock(
+      chunking_params.segment_duration_in_seconds, index.time_scale);
+  if (segment_clock.segment_duration() <= 0)
+    return false;
+  // As in ChunkingHandler, a segment starts at a key frame in another
+  // segment duration, unless it is the previous one.
+  auto get_segment_index = [&segment_clock](int64_t timestamp) {
+    return segment_clock.GetSegmentIndex(timestamp);
+  };
+  auto starts_segment = [](int64_t new_index, int64_t current_index) {
+    return new_index != current_index && new_index != current_index - 1;
+  };
+  std::optional<int64_t> current_index;
+  for (const SegmentIndex::Segment& segment : index.segments) {
+    const int64_t segment_index = get_segment_index(segment.start_time);
+    if (current_index && !starts_segment(segment_index, *current_index))
+      return false;
+    current_index = segment_index;
+    for (const SegmentIndex::KeyFrame& key_frame : segment.key_frames) {
+      if (key_frame.timestamp != segment.start_time &&
+          starts_segment(get_segment_index(key_frame.timestamp),
+                         segment_index)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Package the segments |first_segment| to |last_segment| of the input of
+// |stream_descriptor| to the outputs of |descriptor|, numbering them from
+// their index in the input.
+Status PackageSegmentRange(const PackagingParams& packaging_params,
+                           const StreamDescriptor& stream_descriptor,
+                           const SegmentIndex& index,
+                           size_t first_segment,
+                           size_t last_segment,
+                           StreamDescriptor descriptor,
+                           const std::string& input) {
+  PackagingParams params = packaging_params;
+  params.output_media_info = false;
+  params.media_info_callback = nullptr;
+  params.output_segment_index = false;
+  params.segment_latency_log.clear();
+  params.segment_event_url.clear();
+  params.share_inputs = false;
+  params.buffer_callback_params.read_func = nullptr;
+  params.chunking_params.start_segment_number +=
+      static_cast<int64_t>(first_segment);
+  // The clear lead is counted from the first segment of the input.
+  if (first_segment < index.segments.size() && index.time_scale > 0) {
+    const double start_in_seconds =
+        static_cast<double>(index.segments[first_segment].start_time -
+                            index.segments[0].start_time) /
+        index.time_scale;
+    params.encryption_params.clear_lead_in_seconds = std::max(
+        0.0, params.encryption_params.clear_lead_in_seconds - start_in_seconds);
+  }
+
+  descriptor.input = input;
+  descriptor.input_format.clear();
+
+  Status status = WriteSegmentInput(stream_descriptor.input, index,
+                                    first_segment, last_segment, input);
+  if (status.ok()) {
+    Packager packager;
+    status = packager.Initialize(params, {descriptor});
+    if (status.ok())
+      status = packager.Run();
+  }
+  File::Delete(input.c_str());
+  return status;
+}
+
+// The prefix of the inputs fed with Packager::PushInput().
+const char kPushInputPrefix[] = "push://";
+
+// The data pushed to an input, read by its demuxer, or given to it as it
+// arrives if the demuxer is in push mode.
+class PushedInput {
+ public:
+  // @param demuxer is the demuxer of the input, if it is in push mode.
+  void set_demuxer(std::shared_ptr<Demuxer> demuxer) {
+    demuxer_ = std::move(demuxer);
+  }
+
+  // @return false if the input has ended already.
+  bool Push(std::vector<uint8_t> data) {
+    if (demuxer_)
+      return demuxer_->PushData(std::move(data));
+    absl::MutexLock lock(&mutex_);
+    if (ended_)
+      return false;
+    if (!data.empty())
+      chunks_.push_back(std::move(data));
+    data_available_.Signal();
+    return true;
+  }
+
+  void End() {
+    if (demuxer_) {
+      demuxer_->EndOfData();
+      return;
+    }
+    absl::MutexLock lock(&mutex_);
+    ended_ = true;
+    data_available_.Signal();
+  }
+
+  // Makes the pending and the next reads fail.
+  void Cancel() {
+    absl::MutexLock lock(&mutex_);
+    cancelled_ = true;
+    data_available_.Signal();
+  }
+
+  // Blocks until there is data to read, or the input has ended.
+  // @return the number of bytes read, 0 at the end of the input, or -1 if the
+  //         input is cancelled.
+  int64_t Read(void* buffer, uint64_t size) {
+    absl::MutexLock lock(&mutex_);
+    while (chunks_.empty() && !ended_ && !cancelled_)
+      data_available_.Wait(&mutex_);
+    if (cancelled_)
+      return -1;
+
+    uint8_t* output = static_cast<uint8_t*>(buffer);
+    uint64_t bytes_read = 0;
+    while (bytes_read < size && !chunks_.empty()) {
+      const std::vector<uint8_t>& chunk = chunks_.front();
+      const uint64_t bytes_to_copy =
+          std::min<uint64_t>(size - bytes_read, chunk.size() - offset_);
+      memcpy(output + bytes_read, chunk.data() + offset_, bytes_to_copy);
+      bytes_read += bytes_to_copy;
+      offset_ += bytes_to_copy;
+      if (offset_ == chunk.size()) {
+        chunks_.pop_front();
+        offset_ = 0;
+      }
+    }
+    return static_cast<int64_t>(bytes_read);
+  }
+
+ private:
+  std::shared_ptr<Demuxer> demuxer_;
+  absl::Mutex mutex_;
+  absl::CondVar data_available_ ABSL_GUARDED_BY(mutex_);
+  // The pushed data, kept as given to save a copy.
+  std::deque<std::vector<uint8_t>> chunks_ ABSL_GUARDED_BY(mutex_);
+  // The offset of the next byte to read in the first chunk.
+  size_t offset_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool ended_ ABSL_GUARDED_BY(mutex_) = false;
+  bool cancelled_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+HugePages::Mode GetHugePageMode(HugePageMode mode) {
+  switch (mode) {
+    case HugePageMode::kNone:
+      return HugePages::Mode::kNone;
+    case HugePageMode::kTransparent:
+      return HugePages::Mode::kTransparent;
+    case HugePageMode::kExplicit:
+      return HugePages::Mode::kExplicit;
+  }
+  return HugePages::Mode::kNone;
+}
+
 }  // namespace
 }  // namespace media
 
 struct Packager::PackagerInternal {
-  std::shared_ptr<media::FakeClock> fake_clock;
+  // Set up once, by Packager::Initialize().
+  PackagingParams packaging_params;
   std::unique_ptr<KeySource> encryption_key_source;
+  BufferCallbackParams buffer_callback_params;
+
+  // Sends the manifest notifications to the aggregator, if any. Kept across
+  // the sets of stream descriptors, so that the aggregator sees one node.
+  std::unique_ptr<media::ManifestEventSender> manifest_event_sender;
+
+  // The resources of the packager, kept across the sets of stream descriptors
+  // so that its usage adds up.
+  std::shared_ptr<ResourceQuota> resource_quota;
+
+  // Set up anew for each set of stream descriptors.
+  std::shared_ptr<Clock> fake_clock;
   std::unique_ptr<MpdNotifier> mpd_notifier;
   std::unique_ptr<hls::HlsNotifier> hls_notifier;
-  BufferCallbackParams buffer_callback_params;
+  std::unique_ptr<media::SegmentLatencyLog> segment_latency_log;
+  std::unique_ptr<media::SegmentEventPublisher> segment_event_publisher;
+  std::unique_ptr<media::ProgressTracker> progress_tracker;
   std::unique_ptr<media::JobManager> job_manager;
+  // Empty unless PackagingParams::collect_handler_stats is set.
+  std::vector<std::shared_ptr<const media::MediaHandlerStats>> handler_stats;
+  // The inputs fed with Packager::PushInput(), by StreamDescriptor::input.
+  // Their demuxers read them as callback files, with |push_callback_params|.
+  std::map<std::string, std::shared_ptr<media::PushedInput>> pushed_inputs;
+  BufferCallbackParams push_callback_params;
+
+  // Runs the jobs started with Packager::Start(), until Packager::Wait().
+  std::thread run_thread;
+  Status run_status;
+
+  // Builds the packaging graph of |stream_descriptors|, dropping the previous
+  // one if any.
+  Status CreateJobs(const std::vector<StreamDescriptor>& stream_descriptors);
+  // Runs the jobs to completion, then flushes the manifests.
+  Status RunJobs();
+  Status RunJobsAndFlushManifests();
 };
 
 Packager::Packager() {}
 
-Packager::~Packager() {}
+Packager::~Packager() {
+  if (internal_ && internal_->run_thread.joinable()) {
+    Cancel();
+    internal_->run_thread.join();
+  }
+}
 
 Status Packager::Initialize(
     const PackagingParams& packaging_params,
@@ -830,18 +1606,89 @@ Status Packager::Initialize(
         packaging_params.test_params.injected_library_version);
   }
 
+  // Before the key sources, which may decrypt their keys.
+  if (!media::AesCipher::SetBackend(packaging_params.crypto_backend)) {
+    return Status(error::INVALID_ARGUMENT,
+                  "Unknown crypto backend: " + packaging_params.crypto_backend);
+  }
+
   std::unique_ptr<PackagerInternal> internal(new PackagerInternal);
+  internal->packaging_params = packaging_params;
 
-  // Create encryption key source if needed.
+  // Create encryption key source if needed. The keys are fetched while the
+  // inputs are opened and probed below.
   if (packaging_params.encryption_params.key_provider != KeyProvider::kNone) {
     internal->encryption_key_source = CreateEncryptionKeySource(
         static_cast<media::FourCC>(
             packaging_params.encryption_params.protection_scheme),
-        packaging_params.encryption_params);
+        packaging_params.encryption_params, true /* fetch_keys_async */);
     if (!internal->encryption_key_source)
       return Status(error::INVALID_ARGUMENT, "Failed to create key source.");
   }
 
+  // Store callback params to make it available during packaging.
+  internal->buffer_callback_params = packaging_params.buffer_callback_params;
+  PackagerInternal* internal_ptr = internal.get();
+  internal->push_callback_params.read_func =
+      [internal_ptr](const std::string& name, void* buffer,
+                     uint64_t size) -> int64_t {
+    auto iter = internal_ptr->pushed_inputs.find(name);
+    if (iter == internal_ptr->pushed_inputs.end())
+      return -1;
+    return iter->second->Read(buffer, size);
+  };
+
+  MemoryBudget::SetLimit(packaging_params.memory_budget_bytes);
+  WorkPriority::SetBackgroundIoLimit(
+      packaging_params.background_io_bytes_per_second);
+  File::SetAtomicWriteDurability(packaging_params.atomic_write_durability);
+  HugePages::SetMode(media::GetHugePageMode(packaging_params.huge_page_mode));
+
+  const ResourceQuotaParams& quota_params =
+      packaging_params.resource_quota_params;
+  internal->resource_quota = std::make_shared<ResourceQuota>(
+      quota_params.cpu_share * std::thread::hardware_concurrency(),
+      quota_params.memory_bytes, quota_params.max_uploads_in_flight);
+
+  RETURN_IF_ERROR(internal->CreateJobs(stream_descriptors));
+
+  internal_ = std::move(internal);
+  return Status::OK;
+}
+
+Status Packager::Reinitialize(
+    const std::vector<StreamDescriptor>& stream_descriptors) {
+  if (!internal_)
+    return Status(error::INVALID_ARGUMENT, "Not yet initialized.");
+  if (internal_->run_thread.joinable())
+    return Status(error::INVALID_ARGUMENT, "Started, call Wait() first.");
+
+  RETURN_IF_ERROR(
+      media::ValidateParams(internal_->packaging_params, stream_descriptors));
+
+  Status status = internal_->CreateJobs(stream_descriptors);
+  // A partly built graph must not run.
+  if (!status.ok())
+    internal_->job_manager.reset();
+  return status;
+}
+
+Status Packager::PackagerInternal::CreateJobs(
+    const std::vector<StreamDescriptor>& stream_descriptors) {
+  // The inputs opened and the threads started while building the graph are
+  // charged to the packager.
+  ScopedResourceQuota scoped_quota(resource_quota);
+
+  // The handlers of the previous graph refer to the notifiers.
+  job_manager.reset();
+  handler_stats.clear();
+  pushed_inputs.clear();
+  mpd_notifier.reset();
+  hls_notifier.reset();
+  segment_latency_log.reset();
+  segment_event_publisher.reset();
+  fake_clock.reset();
+
   // Update MPD output and HLS output if needed.
   MpdParams mpd_params = packaging_params.mpd_params;
   HlsParams hls_params = packaging_params.hls_params;
@@ -853,13 +1700,11 @@ Status Packager::Initialize(
   mpd_params.target_segment_duration = target_segment_duration;
   hls_params.target_segment_duration = target_segment_duration;
 
-  // Store callback params to make it available during packaging.
-  internal->buffer_callback_params = packaging_params.buffer_callback_params;
-  if (internal->buffer_callback_params.write_func) {
+  if (buffer_callback_params.write_func) {
     mpd_params.mpd_output = File::MakeCallbackFileName(
-        internal->buffer_callback_params, mpd_params.mpd_output);
+        buffer_callback_params, mpd_params.mpd_output);
     hls_params.master_playlist_output = File::MakeCallbackFileName(
-        internal->buffer_callback_params, hls_params.master_playlist_output);
+        buffer_callback_params, hls_params.master_playlist_output);
   }
 
   // Both DASH and HLS require language to follow RFC5646
@@ -876,13 +1721,43 @@ Status Packager::Initialize(
   hls_params.is_independent_segments =
       packaging_params.chunking_params.segment_sap_aligned;
 
+  const bool distributed = !packaging_params.manifest_aggregator_url.empty();
+  if (distributed && (!mpd_params.mpd_output.empty() ||
+                      !hls_params.master_playlist_output.empty())) {
+    for (const StreamDescriptor& descriptor : stream_descriptors) {
+      if (descriptor.segment_template.empty()) {
+        return Status(error::INVALID_ARGUMENT,
+                      "Manifest aggregation requires segment templates.");
+      }
+    }
+    if (!manifest_event_sender) {
+      manifest_event_sender = media::ManifestEventSender::Create(
+          packaging_params.manifest_aggregator_url,
+          packaging_params.manifest_node_id);
+      LOG(INFO) << "Sending the manifest notifications of node "
+                << manifest_event_sender->node_id() << " to "
+                << packaging_params.manifest_aggregator_url;
+    }
+  }
+
   if (!mpd_params.mpd_output.empty()) {
     const bool on_demand_dash_profile =
         stream_descriptors.begin()->segment_template.empty();
     const MpdOptions mpd_options =
         media::GetMpdOptions(on_demand_dash_profile, mpd_params);
-    internal->mpd_notifier.reset(new SimpleMpdNotifier(mpd_options));
-    if (!internal->mpd_notifier->Init()) {
+    if (distributed) {
+      mpd_notifier.reset(new media::RemoteMpdNotifier(
+          mpd_options, manifest_event_sender.get()));
+    } else {
+      std::unique_ptr<SimpleMpdNotifier> simple_mpd_notifier(
+          new SimpleMpdNotifier(mpd_options));
+      if (packaging_params.test_params.clock) {
+        simple_mpd_notifier->InjectClock(std::unique_ptr<Clock>(
+            new media::FunctionClock(packaging_params.test_params.clock)));
+      }
+      mpd_notifier = std::move(simple_mpd_notifier);
+    }
+    if (!mpd_notifier->Init()) {
       LOG(ERROR) << "MpdNotifier failed to initialize.";
       return Status(error::INVALID_ARGUMENT,
                     "Failed to initialize MpdNotifier.");
@@ -890,7 +1765,12 @@ Status Packager::Initialize(
   }
 
   if (!hls_params.master_playlist_output.empty()) {
-    internal->hls_notifier.reset(new hls::SimpleHlsNotifier(hls_params));
+    if (distributed) {
+      hls_notifier.reset(new media::RemoteHlsNotifier(
+          hls_params, manifest_event_sender.get()));
+    } else {
+      hls_notifier.reset(new hls::SimpleHlsNotifier(hls_params));
+    }
   }
 
   std::unique_ptr<SyncPointQueue> sync_points;
@@ -899,11 +1779,15 @@ Status Packager::Initialize(
         new SyncPointQueue(packaging_params.ad_cue_generator_params));
   }
   if (packaging_params.single_threaded) {
-    internal->job_manager.reset(
-        new SingleThreadJobManager(std::move(sync_points)));
+    job_manager.reset(new SingleThreadJobManager(std::move(sync_points)));
   } else {
-    internal->job_manager.reset(new JobManager(std::move(sync_points)));
+    job_manager.reset(
+        new JobManager(std::move(sync_points), packaging_params.job_threads));
   }
+  job_manager->set_cpu_placement_params(
+      packaging_params.cpu_placement_params);
+  job_manager->set_priority_class(packaging_params.priority_class);
+  job_manager->set_resource_quota(resource_quota);
 
   std::vector<StreamDescriptor> streams_for_jobs;
 
@@ -911,16 +1795,23 @@ Status Packager::Initialize(
     // We may need to overwrite some values, so make a copy first.
     StreamDescriptor copy = descriptor;
 
-    if (internal->buffer_callback_params.read_func) {
-      copy.input = File::MakeCallbackFileName(internal->buffer_callback_params,
-                                              descriptor.input);
+    if (absl::StartsWith(descriptor.input, media::kPushInputPrefix)) {
+      std::shared_ptr<media::PushedInput>& pushed_input =
+          pushed_inputs[descriptor.input];
+      if (!pushed_input)
+        pushed_input = std::make_shared<media::PushedInput>();
+      copy.input =
+          File::MakeCallbackFileName(push_callback_params, descriptor.input);
+    } else if (buffer_callback_params.read_func) {
+      copy.input =
+          File::MakeCallbackFileName(buffer_callback_params, descriptor.input);
     }
 
-    if (internal->buffer_callback_params.write_func) {
-      copy.output = File::MakeCallbackFileName(internal->buffer_callback_params,
+    if (buffer_callback_params.write_func) {
+      copy.output = File::MakeCallbackFileName(buffer_callback_params,
                                                descriptor.output);
       copy.segment_template = File::MakeCallbackFileName(
-          internal->buffer_callback_params, descriptor.segment_template);
+          buffer_callback_params, descriptor.segment_template);
     }
 
     // Update language to ISO_639_2 code if set.
@@ -937,55 +1828,445 @@ Status Packager::Initialize(
   }
 
   media::MuxerFactory muxer_factory(packaging_params);
-  if (packaging_params.test_params.inject_fake_clock) {
-    internal->fake_clock.reset(new media::FakeClock());
-    muxer_factory.OverrideClock(internal->fake_clock);
+  if (packaging_params.test_params.clock) {
+    fake_clock.reset(
+        new media::FunctionClock(packaging_params.test_params.clock));
+    muxer_factory.OverrideClock(fake_clock);
+  } else if (packaging_params.test_params.inject_fake_clock) {
+    fake_clock.reset(new media::FakeClock());
+    muxer_factory.OverrideClock(fake_clock);
+  }
+
+  if (!packaging_params.segment_latency_log.empty()) {
+    segment_latency_log.reset(new media::SegmentLatencyLog);
+    RETURN_IF_ERROR(
+        segment_latency_log->Open(packaging_params.segment_latency_log));
+  }
+
+  if (!packaging_params.segment_event_url.empty()) {
+    segment_event_publisher.reset(new media::SegmentEventPublisher);
+    RETURN_IF_ERROR(
+        segment_event_publisher->Open(packaging_params.segment_event_url));
   }
 
+  progress_tracker.reset(new media::ProgressTracker(
+      absl::Milliseconds(packaging_params.progress_interval_ms),
+      packaging_params.progress_callback));
+
   media::MuxerListenerFactory muxer_listener_factory(
       packaging_params.output_media_info,
       packaging_params.mpd_params.use_segment_list,
-      internal->mpd_notifier.get(), internal->hls_notifier.get());
+      mpd_notifier.get(), hls_notifier.get(), segment_latency_log.get());
+  muxer_listener_factory.set_media_info_format(
+      packaging_params.media_info_format);
+  muxer_listener_factory.set_media_info_callback(
+      packaging_params.media_info_callback);
+  muxer_listener_factory.set_output_segment_index(
+      packaging_params.output_segment_index);
+  muxer_listener_factory.set_async_notifications(
+      packaging_params.async_manifest_updates);
+  muxer_listener_factory.set_segment_event_publisher(
+      segment_event_publisher.get());
+  muxer_listener_factory.set_progress_tracker(progress_tracker.get());
+
+  // The pushed inputs are parsed as they arrive where possible.
+  std::map<std::string, std::shared_ptr<Demuxer>> push_demuxers;
+  for (const auto& pushed_input : pushed_inputs) {
+    push_demuxers[File::MakeCallbackFileName(push_callback_params,
+                                             pushed_input.first)] = nullptr;
+  }
 
   RETURN_IF_ERROR(media::CreateAllJobs(
-      streams_for_jobs, packaging_params, internal->mpd_notifier.get(),
-      internal->encryption_key_source.get(),
-      internal->job_manager->sync_points(), &muxer_listener_factory,
-      &muxer_factory, internal->job_manager.get()));
-
-  internal_ = std::move(internal);
+      streams_for_jobs, packaging_params, mpd_notifier.get(),
+      encryption_key_source.get(), job_manager->sync_points(),
+      &muxer_listener_factory, &muxer_factory, job_manager.get(),
+      progress_tracker.get(),
+      packaging_params.collect_handler_stats ? &handler_stats : nullptr,
+      &push_demuxers));
+
+  for (auto& pushed_input : pushed_inputs) {
+    pushed_input.second->set_demuxer(
+        push_demuxers[File::MakeCallbackFileName(push_callback_params,
+                                                 pushed_input.first)]);
+  }
   return Status::OK;
 }
 
-Status Packager::Run() {
-  if (!internal_)
-    return Status(error::INVALID_ARGUMENT, "Not yet initialized.");
+Status Packager::PackagerInternal::RunJobs() {
+  Status status = RunJobsAndFlushManifests();
+  // Finish deleting the segments which have left the manifests before the
+  // process may exit, whether or not the jobs succeeded.
+  FileReaper::GetInstance()->Flush();
+  return status;
+}
 
-  RETURN_IF_ERROR(internal_->job_manager->RunJobs());
+Status Packager::PackagerInternal::RunJobsAndFlushManifests() {
+  progress_tracker->Start();
+  Status status = job_manager->RunJobs();
+  // The final progress, whether or not the jobs succeeded.
+  progress_tracker->Report();
+  RETURN_IF_ERROR(status);
 
-  if (internal_->hls_notifier) {
-    if (!internal_->hls_notifier->Flush())
+  if (hls_notifier) {
+    if (!hls_notifier->Flush())
       return Status(error::INVALID_ARGUMENT, "Failed to flush Hls.");
   }
-  if (internal_->mpd_notifier) {
-    if (!internal_->mpd_notifier->Flush())
+  if (mpd_notifier) {
+    if (!mpd_notifier->Flush())
       return Status(error::INVALID_ARGUMENT, "Failed to flush Mpd.");
   }
+  if (manifest_event_sender &&
+      !manifest_event_sender->WaitUntilSent(media::kManifestEventsTimeout)) {
+    return Status(error::HTTP_FAILURE,
+                  "Failed to send the manifest notifications to the "
+                  "aggregator.");
+  }
+
+  // The live presentation has ended.
+  if (hls_notifier && !hls_notifier->WriteVodArchive()) {
+    return Status(error::FILE_FAILURE,
+                  "Failed to write the VOD archive of the HLS playlists.");
+  }
+  if (mpd_notifier && !mpd_notifier->WriteVodArchive())
+    return Status(error::FILE_FAILURE, "Failed to write the VOD archive MPD.");
+  return Status::OK;
+}
+
+Status Packager::Run() {
+  if (!internal_ || !internal_->job_manager)
+    return Status(error::INVALID_ARGUMENT, "Not yet initialized.");
+  if (internal_->run_thread.joinable())
+    return Status(error::INVALID_ARGUMENT, "Already started.");
+  return internal_->RunJobs();
+}
+
+Status Packager::Start(
+    std::function<void(const Status& status)> completion_callback) {
+  if (!internal_ || !internal_->job_manager)
+    return Status(error::INVALID_ARGUMENT, "Not yet initialized.");
+  if (internal_->run_thread.joinable())
+    return Status(error::INVALID_ARGUMENT, "Already started.");
+
+  PackagerInternal* internal = internal_.get();
+  internal->run_thread = std::thread([internal, completion_callback]() {
+    internal->run_status = internal->RunJobs();
+    if (completion_callback)
+      completion_callback(internal->run_status);
+  });
+  return Status::OK;
+}
+
+Status Packager::Wait() {
+  if (!internal_ || !internal_->run_thread.joinable())
+    return Status(error::INVALID_ARGUMENT, "Not started.");
+  internal_->run_thread.join();
+  return internal_->run_status;
+}
+
+Status Packager::PushInput(const std::string& input,
+                           std::vector<uint8_t> data) {
+  if (!internal_)
+    return Status(error::INVALID_ARGUMENT, "Not yet initialized.");
+  auto iter = internal_->pushed_inputs.find(input);
+  if (iter == internal_->pushed_inputs.end())
+    return Status(error::INVALID_ARGUMENT, "Not a pushed input: " + input);
+  if (!iter->second->Push(std::move(data)))
+    return Status(error::INVALID_ARGUMENT, "Input already ended: " + input);
+  return Status::OK;
+}
+
+Status Packager::EndInput(const std::string& input) {
+  if (!internal_)
+    return Status(error::INVALID_ARGUMENT, "Not yet initialized.");
+  auto iter = internal_->pushed_inputs.find(input);
+  if (iter == internal_->pushed_inputs.end())
+    return Status(error::INVALID_ARGUMENT, "Not a pushed input: " + input);
+  iter->second->End();
   return Status::OK;
 }
 
 void Packager::Cancel() {
-  if (!internal_) {
+  if (!internal_ || !internal_->job_manager) {
     LOG(INFO) << "Not yet initialized. Return directly.";
     return;
   }
+  // The demuxers may be waiting for pushed data which will not come.
+  for (const auto& pushed_input : internal_->pushed_inputs)
+    pushed_input.second->Cancel();
+  // The jobs may be waiting for keys which will not come.
+  if (internal_->encryption_key_source)
+    internal_->encryption_key_source->Cancel();
   internal_->job_manager->CancelJobs();
 }
 
+bool Packager::Cancel(std::chrono::milliseconds timeout) {
+  if (!internal_ || !internal_->job_manager) {
+    LOG(INFO) << "Not yet initialized. Return directly.";
+    return true;
+  }
+  Cancel();
+  // Cancelling the jobs again is harmless.
+  return internal_->job_manager->CancelJobs(absl::FromChrono(timeout));
+}
+
+std::vector<HandlerStats> Packager::GetHandlerStats() const {
+  std::vector<HandlerStats> all_stats;
+  if (!internal_)
+    return all_stats;
+
+  const double kMicrosecondsPerSecond = 1e6;
+  for (const auto& stats : internal_->handler_stats) {
+    HandlerStats handler_stats;
+    handler_stats.label = stats->label;
+    handler_stats.samples = stats->samples.load(std::memory_order_relaxed);
+    handler_stats.bytes = stats->bytes.load(std::memory_order_relaxed);
+    handler_stats.process_seconds =
+        stats->process_time_us.load(std::memory_order_relaxed) /
+        kMicrosecondsPerSecond;
+    handler_stats.blocked_seconds =
+        stats->blocked_time_us.load(std::memory_order_relaxed) /
+        kMicrosecondsPerSecond;
+    all_stats.push_back(std::move(handler_stats));
+  }
+  return all_stats;
+}
+
+PackagingProgress Packager::GetProgress() const {
+  if (!internal_ || !internal_->progress_tracker)
+    return PackagingProgress();
+  return internal_->progress_tracker->GetProgress();
+}
+
+ResourceUsage Packager::GetResourceUsage() const {
+  ResourceUsage resource_usage;
+  if (!internal_)
+    return resource_usage;
+
+  const ResourceQuota::Usage usage = internal_->resource_quota->GetUsage();
+  resource_usage.cpu_seconds = usage.cpu_seconds;
+  resource_usage.memory_bytes = usage.memory_bytes;
+  resource_usage.peak_memory_bytes = usage.peak_memory_bytes;
+  resource_usage.uploads_in_flight = usage.uploads_in_flight;
+  resource_usage.throttled_seconds = usage.throttled_seconds;
+  return resource_usage;
+}
+
+MemoryStats Packager::GetMemoryStats() {
+  MemoryStats memory_stats;
+  memory_stats.peak_rss_bytes = MemoryAccounting::peak_rss_bytes();
+  for (int i = 0; i < kNumMemorySubsystems; ++i) {
+    const MemorySubsystem subsystem = static_cast<MemorySubsystem>(i);
+    SubsystemMemoryStats subsystem_stats;
+    subsystem_stats.name = MemoryAccounting::name(subsystem);
+    subsystem_stats.bytes = MemoryAccounting::bytes(subsystem);
+    subsystem_stats.peak_bytes = MemoryAccounting::peak_bytes(subsystem);
+    memory_stats.subsystems.push_back(std::move(subsystem_stats));
+  }
+  return memory_stats;
+}
+
 std::string Packager::GetLibraryVersion() {
   return GetPackagerVersion();
 }
 
+Status Packager::ProbeInput(const std::string& input,
+                            const std::string& input_format,
+                            std::string* json) {
+  DCHECK(json);
+  Demuxer demuxer(input);
+  demuxer.set_input_format(input_format);
+  std::vector<std::shared_ptr<media::StreamInfo>> stream_infos;
+  RETURN_IF_ERROR(demuxer.Probe(&stream_infos));
+
+  nlohmann::json streams = nlohmann::json::array();
+  for (size_t i = 0; i < stream_infos.size(); ++i) {
+    const media::StreamInfo& stream_info = *stream_infos[i];
+    nlohmann::json stream = {
+        {"index", i},
+        {"track_id", stream_info.track_id()},
+        {"type", absl::AsciiStrToLower(
+                     media::StreamTypeToString(stream_info.stream_type()))},
+        {"codec", stream_info.codec_string()},
+        {"time_scale", stream_info.time_scale()},
+        {"duration_seconds",
+         stream_info.time_scale() > 0
+             ? static_cast<double>(stream_info.duration()) /
+                   stream_info.time_scale()
+             : 0},
+        {"language", stream_info.language()},
+        {"encrypted", stream_info.is_encrypted()},
+    };
+    if (stream_info.stream_type() == media::kStreamVideo) {
+      const auto& video_info =
+          static_cast<const media::VideoStreamInfo&>(stream_info);
+      stream["width"] = video_info.width();
+      stream["height"] = video_info.height();
+      stream["pixel_width"] = video_info.pixel_width();
+      stream["pixel_height"] = video_info.pixel_height();
+    } else if (stream_info.stream_type() == media::kStreamAudio) {
+      const auto& audio_info =
+          static_cast<const media::AudioStreamInfo&>(stream_info);
+      stream["sample_rate"] = audio_info.sampling_frequency();
+      stream["channels"] = audio_info.num_channels();
+      stream["sample_bits"] = audio_info.sample_bits();
+    }
+    streams.push_back(std::move(stream));
+  }
+  *json = nlohmann::json({{"input", input}, {"streams", std::move(streams)}})
+              .dump();
+  return Status::OK;
+}
+
+Status Packager::PrefetchKeys(
+    const EncryptionParams& encryption_params,
+    const std::vector<std::vector<uint8_t>>& content_ids,
+    uint32_t max_concurrent_requests) {
+  return media::PrefetchEncryptionKeys(
+      static_cast<media::FourCC>(encryption_params.protection_scheme),
+      encryption_params, content_ids, max_concurrent_requests);
+}
+
+Status Packager::PackageSegment(const PackagingParams& packaging_params,
+                                const StreamDescriptor& stream_descriptor,
+                                size_t segment_index,
+                                std::vector<uint8_t>* init_segment,
+                                std::vector<uint8_t>* segment) {
+  DCHECK(segment);
+  if (init_segment)
+    init_segment->clear();
+  media::SegmentIndex index;
+  RETURN_IF_ERROR(media::ReadSegmentIndex(stream_descriptor.input, &index));
+
+  const media::MediaContainerName output_format =
+      media::GetOutputFormat(stream_descriptor);
+  if (output_format == media::CONTAINER_UNKNOWN)
+    return Status(error::INVALID_ARGUMENT, "Unsupported output format.");
+  const std::string extension =
+      media::GetExtension(stream_descriptor.segment_template.empty()
+                              ? stream_descriptor.output
+                              : stream_descriptor.segment_template);
+
+  PackagingParams params = packaging_params;
+  params.mpd_params.mpd_output.clear();
+  params.hls_params.master_playlist_output.clear();
+  params.ad_cue_generator_params = AdCueGeneratorParams();
+  params.buffer_callback_params = BufferCallbackParams();
+  // Package the whole range as one segment.
+  params.chunking_params.segment_duration_in_seconds =
+      media::kSegmentRequestDurationInSeconds;
+
+  const std::string directory =
+      "memory://segment_request/" +
+      std::to_string(media::g_segment_request_count++) + "/";
+  StreamDescriptor descriptor = stream_descriptor;
+  descriptor.output.clear();
+  if (output_format == media::CONTAINER_MOV ||
+      output_format == media::CONTAINER_WEBM) {
+    descriptor.output = directory + "init" + extension;
+  }
+  descriptor.segment_template = directory + "segment-$Number$" + extension;
+  const std::string segment_name = media::GetSegmentName(
+      descriptor.segment_template, 0,
+      static_cast<uint32_t>(params.chunking_params.start_segment_number +
+                            static_cast<int64_t>(segment_index)),
+      0);
+
+  Status status = media::PackageSegmentRange(
+      params, stream_descriptor, index, segment_index, segment_index,
+      descriptor, directory + "input.mp4");
+  if (status.ok() && init_segment && !descriptor.output.empty())
+    status = media::ReadOutput(descriptor.output, init_segment);
+  if (status.ok())
+    status = media::ReadOutput(segment_name, segment);
+
+  if (!descriptor.output.empty())
+    File::Delete(descriptor.output.c_str());
+  File::Delete(segment_name.c_str());
+  return status;
+}
+
+Status Packager::PackageInParallel(const PackagingParams& packaging_params,
+                                   const StreamDescriptor& stream_descriptor,
+                                   uint32_t num_ranges) {
+  if (num_ranges == 0) {
+    return Status(error::INVALID_ARGUMENT,
+                  "'num_ranges' should be positive.");
+  }
+  if (stream_descriptor.segment_template.empty()) {
+    return Status(error::INVALID_ARGUMENT,
+                  "Parallel packaging requires a segment template.");
+  }
+  if (!packaging_params.mpd_params.mpd_output.empty() ||
+      !packaging_params.hls_params.master_playlist_output.empty()) {
+    return Status(error::UNIMPLEMENTED,
+                  "Manifests are not supported with parallel packaging.");
+  }
+  if (!packaging_params.ad_cue_generator_params.cue_points.empty()) {
+    return Status(error::UNIMPLEMENTED,
+                  "Ad cues are not supported with parallel packaging.");
+  }
+  const EncryptionParams& encryption_params =
+      packaging_params.encryption_params;
+  bool has_explicit_iv = !encryption_params.raw_key.iv.empty();
+  for (const auto& entry : encryption_params.raw_key.key_map)
+    has_explicit_iv |= !entry.second.iv.empty();
+  if (encryption_params.key_provider != KeyProvider::kNone &&
+      encryption_params.protection_scheme !=
+          EncryptionParams::kProtectionSchemeCbcs &&
+      !encryption_params.derive_sample_ivs && has_explicit_iv) {
+    return Status(error::INVALID_ARGUMENT,
+                  "Parallel packaging would reuse the explicit IVs in each "
+                  "range, which is only allowed with 'cbcs' or with "
+                  "'derive_sample_ivs'.");
+  }
+
+  media::SegmentIndex index;
+  RETURN_IF_ERROR(media::ReadSegmentIndex(stream_descriptor.input, &index));
+  if (index.segments.empty()) {
+    return Status(error::INVALID_ARGUMENT,
+                  "There are no segments in " + stream_descriptor.input);
+  }
+  if (!media::MatchesChunking(index, packaging_params.chunking_params)) {
+    return Status(error::INVALID_ARGUMENT,
+                  "The segments of " + stream_descriptor.input +
+                      " would be split differently with the chunking "
+                      "parameters. Package it with the same parameters.");
+  }
+
+  const std::string directory =
+      "memory://segment_request/" +
+      std::to_string(media::g_segment_request_count++) + "/";
+  const size_t num_segments = index.segments.size();
+  const size_t num_jobs = std::min<size_t>(num_ranges, num_segments);
+  std::vector<Status> statuses(num_jobs);
+  absl::BlockingCounter jobs_done(static_cast<int>(num_jobs));
+  for (size_t i = 0; i < num_jobs; ++i) {
+    const size_t first_segment = i * num_segments / num_jobs;
+    const size_t last_segment = (i + 1) * num_segments / num_jobs - 1;
+    // Only the first range writes the init segment.
+    StreamDescriptor descriptor = stream_descriptor;
+    if (i > 0 && !descriptor.output.empty()) {
+      descriptor.output = directory + "init-" + std::to_string(i) +
+                          media::GetExtension(stream_descriptor.output);
+    }
+    ThreadPool::instance.PostTask([&, i, first_segment, last_segment,
+                                   descriptor]() {
+      statuses[i] = media::PackageSegmentRange(
+          packaging_params, stream_descriptor, index, first_segment,
+          last_segment, descriptor,
+          directory + "input-" + std::to_string(i) + ".mp4");
+      if (i > 0 && !descriptor.output.empty())
+        File::Delete(descriptor.output.c_str());
+      jobs_done.DecrementCount();
+    });
+  }
+  jobs_done.Wait();
+
+  for (const Status& status : statuses)
+    RETURN_IF_ERROR(status);
+  return Status::OK;
+}
+
 std::string Packager::DefaultStreamLabelFunction(
     int max_sd_pixels,
     int max_hd_pixels,
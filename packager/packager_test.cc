@@ -4,6 +4,8 @@
 // license that can be found in the LICENSE file or at
 // https://developers.google.com/open-source/licenses/bsd
 
+#include <cstring>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -113,6 +115,177 @@ TEST_F(PackagerTest, Success) {
   ASSERT_EQ(Status::OK, packager.Run());
 }
 
+TEST_F(PackagerTest, SuccessWithLimitedJobThreads) {
+  const char kSecondTestFile[] = "packager/media/test/data/bear-640x360.ts";
+  const char kOutputSecondVideo[] = "output_video_2.mp4";
+
+  std::vector<StreamDescriptor> stream_descriptors = SetupStreamDescriptors();
+  StreamDescriptor stream_descriptor;
+  stream_descriptor.input = kSecondTestFile;
+  stream_descriptor.stream_selector = "video";
+  stream_descriptor.output = GetFullPath(kOutputSecondVideo);
+  stream_descriptors.push_back(stream_descriptor);
+
+  PackagingParams packaging_params = SetupPackagingParams();
+  // Two inputs sharing a single job thread.
+  packaging_params.job_threads = 1;
+
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(packaging_params, stream_descriptors));
+  ASSERT_EQ(Status::OK, packager.Run());
+}
+
+TEST_F(PackagerTest, Reinitialize) {
+  Packager packager;
+  ASSERT_EQ(Status::OK, packager.Initialize(SetupPackagingParams(),
+                                            SetupStreamDescriptors()));
+  ASSERT_EQ(Status::OK, packager.Run());
+
+  std::vector<StreamDescriptor> stream_descriptors = SetupStreamDescriptors();
+  stream_descriptors[0].output = GetFullPath("output_video_2.mp4");
+  stream_descriptors[1].output = GetFullPath("output_audio_2.mp4");
+  ASSERT_EQ(Status::OK, packager.Reinitialize(stream_descriptors));
+  ASSERT_EQ(Status::OK, packager.Run());
+}
+
+TEST_F(PackagerTest, ReinitializeFailed) {
+  Packager packager;
+  EXPECT_NE(Status::OK, packager.Reinitialize(SetupStreamDescriptors()));
+
+  ASSERT_EQ(Status::OK, packager.Initialize(SetupPackagingParams(),
+                                            SetupStreamDescriptors()));
+  EXPECT_NE(Status::OK,
+            packager.Reinitialize(std::vector<StreamDescriptor>()));
+}
+
+TEST_F(PackagerTest, CollectsHandlerStats) {
+  PackagingParams packaging_params = SetupPackagingParams();
+  packaging_params.collect_handler_stats = true;
+
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(packaging_params, SetupStreamDescriptors()));
+  ASSERT_EQ(Status::OK, packager.Run());
+
+  bool found_video_muxer = false;
+  for (const HandlerStats& stats : packager.GetHandlerStats()) {
+    EXPECT_GE(stats.process_seconds, 0);
+    if (stats.label == std::string(kTestFile) + ":video/" +
+                           GetFullPath(kOutputVideo) + "/Muxer") {
+      found_video_muxer = true;
+      EXPECT_GT(stats.samples, 0u);
+      EXPECT_GT(stats.bytes, 0u);
+    }
+  }
+  EXPECT_TRUE(found_video_muxer);
+}
+
+TEST_F(PackagerTest, NoHandlerStatsByDefault) {
+  Packager packager;
+  ASSERT_EQ(Status::OK, packager.Initialize(SetupPackagingParams(),
+                                            SetupStreamDescriptors()));
+  ASSERT_EQ(Status::OK, packager.Run());
+  EXPECT_TRUE(packager.GetHandlerStats().empty());
+}
+
+TEST_F(PackagerTest, MemoryStats) {
+  Packager packager;
+  ASSERT_EQ(Status::OK, packager.Initialize(SetupPackagingParams(),
+                                            SetupStreamDescriptors()));
+  ASSERT_EQ(Status::OK, packager.Run());
+
+  const MemoryStats memory_stats = Packager::GetMemoryStats();
+  bool found_media_samples = false;
+  for (const SubsystemMemoryStats& stats : memory_stats.subsystems) {
+    EXPECT_GE(stats.bytes, 0);
+    EXPECT_GE(stats.peak_bytes, stats.bytes);
+    if (stats.name == "media_samples") {
+      found_media_samples = true;
+      EXPECT_GT(stats.peak_bytes, 0);
+    }
+  }
+  EXPECT_TRUE(found_media_samples);
+}
+
+TEST_F(PackagerTest, Progress) {
+  PackagingParams packaging_params = SetupPackagingParams();
+  std::vector<PackagingProgress> reports;
+  packaging_params.progress_callback =
+      [&reports](const PackagingProgress& progress) {
+        reports.push_back(progress);
+      };
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(packaging_params, SetupStreamDescriptors()));
+  ASSERT_EQ(Status::OK, packager.Run());
+
+  // At least the final report.
+  ASSERT_FALSE(reports.empty());
+  const PackagingProgress& progress = reports.back();
+  EXPECT_DOUBLE_EQ(1, progress.fraction);
+  EXPECT_GT(progress.media_seconds, 0);
+  EXPECT_GT(progress.input_bytes, 0u);
+  EXPECT_GT(progress.output_bytes, 0u);
+  EXPECT_EQ(0, progress.eta_seconds);
+  EXPECT_DOUBLE_EQ(progress.media_seconds,
+                   packager.GetProgress().media_seconds);
+}
+
+TEST_F(PackagerTest, ResourceUsage) {
+  PackagingParams packaging_params = SetupPackagingParams();
+  packaging_params.resource_quota_params.cpu_share = 1;
+  packaging_params.resource_quota_params.memory_bytes = 1024 * 1024;
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(packaging_params, SetupStreamDescriptors()));
+  ASSERT_EQ(Status::OK, packager.Run());
+
+  const ResourceUsage usage = packager.GetResourceUsage();
+  EXPECT_GT(usage.cpu_seconds, 0);
+  // The I/O caches are released once the files are closed.
+  EXPECT_EQ(0u, usage.memory_bytes);
+  EXPECT_GT(usage.peak_memory_bytes, 0u);
+  EXPECT_EQ(0u, usage.uploads_in_flight);
+}
+
+TEST_F(PackagerTest, InvalidResourceQuota) {
+  PackagingParams packaging_params = SetupPackagingParams();
+  packaging_params.resource_quota_params.cpu_share = 2;
+  Packager packager;
+  EXPECT_EQ(error::INVALID_ARGUMENT,
+            packager.Initialize(packaging_params, SetupStreamDescriptors())
+                .error_code());
+}
+
+TEST_F(PackagerTest, ProbeInput) {
+  std::string json;
+  ASSERT_EQ(Status::OK, Packager::ProbeInput(kTestFile, "", &json));
+  EXPECT_THAT(json, ::testing::HasSubstr("\"type\":\"video\""));
+  EXPECT_THAT(json, ::testing::HasSubstr("\"width\":640"));
+  EXPECT_THAT(json, ::testing::HasSubstr("\"type\":\"audio\""));
+  EXPECT_THAT(json, ::testing::HasSubstr("\"sample_rate\":44100"));
+}
+
+TEST_F(PackagerTest, ProbeMissingInput) {
+  std::string json;
+  EXPECT_EQ(error::FILE_FAILURE,
+            Packager::ProbeInput("file_not_exist.mp4", "", &json).error_code());
+}
+
+TEST_F(PackagerTest, PrefetchKeysRequiresWidevineKeyCache) {
+  const std::vector<std::vector<uint8_t>> kContentIds = {{0x01}, {0x02}};
+  EncryptionParams encryption_params =
+      SetupPackagingParams().encryption_params;
+  EXPECT_EQ(error::INVALID_ARGUMENT,
+            Packager::PrefetchKeys(encryption_params, kContentIds).error_code());
+
+  encryption_params.key_provider = KeyProvider::kWidevine;
+  encryption_params.widevine.key_server_url = "http://localhost/key";
+  EXPECT_EQ(error::INVALID_ARGUMENT,
+            Packager::PrefetchKeys(encryption_params, kContentIds).error_code());
+}
+
 TEST_F(PackagerTest, MissingStreamDescriptors) {
   std::vector<StreamDescriptor> stream_descriptors;
   Packager packager;
@@ -226,6 +399,132 @@ TEST_F(PackagerTest, WriteOutputToBuffer) {
   ASSERT_EQ(Status::OK, packager.Run());
 }
 
+TEST_F(PackagerTest, WriteSegmentsToBuffer) {
+  auto packaging_params = SetupPackagingParams();
+  packaging_params.buffer_callback_params.write_func =
+      [](const std::string& name, const void* buffer, uint64_t length) {
+        return static_cast<int64_t>(length);
+      };
+  int num_segments = 0;
+  packaging_params.buffer_callback_params.segment_write_func =
+      [&num_segments](const BufferCallbackParams::SegmentInfo& info,
+                      std::vector<uint8_t> data) {
+        ++num_segments;
+        EXPECT_EQ("video_" + std::to_string(info.segment_number) + ".m4s",
+                  info.name);
+        EXPECT_EQ("output_video.mp4", info.stream_name);
+        EXPECT_GT(info.duration, 0);
+        EXPECT_GT(info.timescale, 0u);
+        // The segment starts with its styp box.
+        EXPECT_GT(data.size(), 8u);
+        EXPECT_EQ(0, memcmp(&data[4], "styp", 4));
+        return true;
+      };
+
+  std::vector<StreamDescriptor> stream_descriptors(1);
+  stream_descriptors[0].input = kTestFile;
+  stream_descriptors[0].stream_selector = "video";
+  stream_descriptors[0].output = "output_video.mp4";
+  stream_descriptors[0].segment_template = "video_$Number$.m4s";
+
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(packaging_params, stream_descriptors));
+  ASSERT_EQ(Status::OK, packager.Run());
+  EXPECT_GT(num_segments, 0);
+}
+
+TEST_F(PackagerTest, PackageSegment) {
+  PackagingParams intermediate_params;
+  intermediate_params.temp_dir = test_directory_;
+  intermediate_params.chunking_params.segment_duration_in_seconds =
+      kSegmentDurationInSeconds;
+  intermediate_params.output_segment_index = true;
+
+  std::vector<StreamDescriptor> stream_descriptors(1);
+  stream_descriptors[0].input = kTestFile;
+  stream_descriptors[0].stream_selector = "video";
+  stream_descriptors[0].output = GetFullPath(kOutputVideo);
+
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(intermediate_params, stream_descriptors));
+  ASSERT_EQ(Status::OK, packager.Run());
+
+  StreamDescriptor stream_descriptor;
+  stream_descriptor.input = GetFullPath(kOutputVideo);
+  stream_descriptor.stream_selector = "video";
+  stream_descriptor.output = "video.mp4";
+  stream_descriptor.segment_template = kOutputVideoTemplate;
+
+  std::vector<uint8_t> init_segment;
+  std::vector<uint8_t> segment;
+  ASSERT_EQ(Status::OK,
+            Packager::PackageSegment(SetupPackagingParams(), stream_descriptor,
+                                     1, &init_segment, &segment));
+  ASSERT_GT(init_segment.size(), 8u);
+  EXPECT_EQ(0, memcmp(&init_segment[4], "ftyp", 4));
+  ASSERT_GT(segment.size(), 8u);
+  EXPECT_EQ(0, memcmp(&segment[4], "styp", 4));
+
+  // TS segments have no init segment.
+  stream_descriptor.output.clear();
+  stream_descriptor.segment_template = "video_$Number$.ts";
+  ASSERT_EQ(Status::OK,
+            Packager::PackageSegment(SetupPackagingParams(), stream_descriptor,
+                                     1, &init_segment, &segment));
+  EXPECT_TRUE(init_segment.empty());
+  ASSERT_FALSE(segment.empty());
+  EXPECT_EQ(0x47, segment[0]);
+
+  EXPECT_EQ(error::NOT_FOUND,
+            Packager::PackageSegment(SetupPackagingParams(), stream_descriptor,
+                                     1000, &init_segment, &segment)
+                .error_code());
+}
+
+TEST_F(PackagerTest, PackageInParallel) {
+  PackagingParams intermediate_params;
+  intermediate_params.temp_dir = test_directory_;
+  intermediate_params.chunking_params.segment_duration_in_seconds =
+      kSegmentDurationInSeconds;
+  intermediate_params.output_segment_index = true;
+
+  std::vector<StreamDescriptor> stream_descriptors(1);
+  stream_descriptors[0].input = kTestFile;
+  stream_descriptors[0].stream_selector = "video";
+  stream_descriptors[0].output = GetFullPath("intermediate.mp4");
+
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(intermediate_params, stream_descriptors));
+  ASSERT_EQ(Status::OK, packager.Run());
+
+  StreamDescriptor stream_descriptor;
+  stream_descriptor.input = GetFullPath("intermediate.mp4");
+  stream_descriptor.stream_selector = "video";
+  stream_descriptor.output = GetFullPath(kOutputVideo);
+  stream_descriptor.segment_template = GetFullPath(kOutputVideoTemplate);
+
+  PackagingParams packaging_params = SetupPackagingParams();
+  packaging_params.mpd_params.mpd_output.clear();
+  ASSERT_EQ(Status::OK, Packager::PackageInParallel(packaging_params,
+                                                    stream_descriptor, 2));
+  std::string content;
+  EXPECT_TRUE(
+      File::ReadFileToString(GetFullPath(kOutputVideo).c_str(), &content));
+  EXPECT_TRUE(File::ReadFileToString(
+      GetFullPath("output_video_1.m4s").c_str(), &content));
+  EXPECT_TRUE(File::ReadFileToString(
+      GetFullPath("output_video_2.m4s").c_str(), &content));
+
+  // The segments of the intermediate would be merged.
+  packaging_params.chunking_params.segment_duration_in_seconds = 10;
+  EXPECT_EQ(error::INVALID_ARGUMENT,
+            Packager::PackageInParallel(packaging_params, stream_descriptor, 2)
+                .error_code());
+}
+
 TEST_F(PackagerTest, ReadFromBuffer) {
   auto packaging_params = SetupPackagingParams();
 
@@ -267,6 +566,77 @@ TEST_F(PackagerTest, ReadFromBufferFailed) {
   ASSERT_EQ(error::FILE_FAILURE, packager.Run().error_code());
 }
 
+TEST_F(PackagerTest, StartAndWait) {
+  Packager packager;
+  ASSERT_EQ(Status::OK, packager.Initialize(SetupPackagingParams(),
+                                            SetupStreamDescriptors()));
+  MockFunction<void(const Status& status)> mock_completion_callback;
+  EXPECT_CALL(mock_completion_callback, Call(Status::OK));
+  ASSERT_EQ(Status::OK,
+            packager.Start(mock_completion_callback.AsStdFunction()));
+  EXPECT_NE(Status::OK, packager.Run());
+  EXPECT_NE(Status::OK, packager.Start(nullptr));
+  EXPECT_EQ(Status::OK, packager.Wait());
+  EXPECT_NE(Status::OK, packager.Wait());
+}
+
+TEST_F(PackagerTest, PushInput) {
+  const char kPushedInput[] = "push://bear";
+  std::vector<StreamDescriptor> stream_descriptors = SetupStreamDescriptors();
+  for (StreamDescriptor& stream_descriptor : stream_descriptors)
+    stream_descriptor.input = kPushedInput;
+
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(SetupPackagingParams(), stream_descriptors));
+  EXPECT_NE(Status::OK, packager.PushInput(kTestFile, {0}));
+  ASSERT_EQ(Status::OK, packager.Start(nullptr));
+
+  FILE* file_ptr = fopen(kTestFile, "rb");
+  ASSERT_TRUE(file_ptr);
+  std::vector<uint8_t> data(4096);
+  size_t size = 0;
+  while ((size = fread(data.data(), 1, data.size(), file_ptr)) > 0) {
+    ASSERT_EQ(Status::OK, packager.PushInput(
+                              kPushedInput, std::vector<uint8_t>(
+                                                data.begin(),
+                                                data.begin() + size)));
+  }
+  fclose(file_ptr);
+  ASSERT_EQ(Status::OK, packager.EndInput(kPushedInput));
+  EXPECT_NE(Status::OK, packager.PushInput(kPushedInput, {0}));
+  EXPECT_EQ(Status::OK, packager.Wait());
+}
+
+TEST_F(PackagerTest, CancelPushInput) {
+  const char kPushedInput[] = "push://bear";
+  std::vector<StreamDescriptor> stream_descriptors = SetupStreamDescriptors();
+  for (StreamDescriptor& stream_descriptor : stream_descriptors)
+    stream_descriptor.input = kPushedInput;
+
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(SetupPackagingParams(), stream_descriptors));
+  ASSERT_EQ(Status::OK, packager.Start(nullptr));
+  // The demuxer waits for data which never comes.
+  packager.Cancel();
+  EXPECT_NE(Status::OK, packager.Wait());
+}
+
+TEST_F(PackagerTest, CancelWithTimeout) {
+  const char kPushedInput[] = "push://bear";
+  std::vector<StreamDescriptor> stream_descriptors = SetupStreamDescriptors();
+  for (StreamDescriptor& stream_descriptor : stream_descriptors)
+    stream_descriptor.input = kPushedInput;
+
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(SetupPackagingParams(), stream_descriptors));
+  ASSERT_EQ(Status::OK, packager.Start(nullptr));
+  EXPECT_TRUE(packager.Cancel(std::chrono::seconds(5)));
+  EXPECT_NE(Status::OK, packager.Wait());
+}
+
 TEST_F(PackagerTest, LowLatencyDashEnabledAndFragmentDurationSet) {
   auto packaging_params = SetupPackagingParams();
   packaging_params.chunking_params.low_latency_dash_mode = true;
@@ -288,6 +658,76 @@ TEST_F(PackagerTest, LowLatencyDashEnabledAndUtcTimingNotSet) {
   EXPECT_THAT(status.error_message(),
               HasSubstr("--utc_timings must be be set"));
 }
+TEST_F(PackagerTest, BundleSegments) {
+  PackagingParams packaging_params = SetupPackagingParams();
+  packaging_params.mp4_output_params.segment_bundle_duration_in_seconds = 100;
+
+  std::vector<StreamDescriptor> stream_descriptors(1);
+  stream_descriptors[0].input = kTestFile;
+  stream_descriptors[0].stream_selector = "video";
+  stream_descriptors[0].output = GetFullPath(kOutputVideo);
+  stream_descriptors[0].segment_template = GetFullPath(kOutputVideoTemplate);
+
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(packaging_params, stream_descriptors));
+  ASSERT_EQ(Status::OK, packager.Run());
+
+  // All the segments are in the bundle named after the first.
+  std::string content;
+  ASSERT_TRUE(File::ReadFileToString(
+      GetFullPath("output_video_1.m4s").c_str(), &content));
+  EXPECT_EQ("styp", content.substr(4, 4));
+  EXPECT_FALSE(File::ReadFileToString(
+      GetFullPath("output_video_2.m4s").c_str(), &content));
+
+  std::string mpd;
+  ASSERT_TRUE(File::ReadFileToString(GetFullPath(kOutputMpd).c_str(), &mpd));
+  EXPECT_THAT(mpd, HasSubstr("<SegmentList"));
+  EXPECT_THAT(mpd, HasSubstr("mediaRange=\"0-"));
+}
+
+TEST_F(PackagerTest, BundleSegmentsWithLowLatencyDash) {
+  PackagingParams packaging_params = SetupPackagingParams();
+  packaging_params.mp4_output_params.segment_bundle_duration_in_seconds = 10;
+  packaging_params.mp4_output_params.low_latency_dash_mode = true;
+  Packager packager;
+  auto status = packager.Initialize(packaging_params, SetupStreamDescriptors());
+  ASSERT_EQ(error::INVALID_ARGUMENT, status.error_code());
+  EXPECT_THAT(status.error_message(),
+              HasSubstr("--mp4_segment_bundle_duration cannot be set"));
+}
+
+TEST_F(PackagerTest, BackgroundPriority) {
+  PackagingParams packaging_params = SetupPackagingParams();
+  packaging_params.priority_class = PriorityClass::kBackground;
+  packaging_params.background_io_bytes_per_second = 100 * 1024 * 1024;
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(packaging_params, SetupStreamDescriptors()));
+  ASSERT_EQ(Status::OK, packager.Run());
+}
+
+#if defined(__linux__)
+TEST_F(PackagerTest, PlaceJobsOnCpus) {
+  PackagingParams packaging_params = SetupPackagingParams();
+  packaging_params.cpu_placement_params.placement = CpuPlacement::kPerJob;
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(packaging_params, SetupStreamDescriptors()));
+  ASSERT_EQ(Status::OK, packager.Run());
+}
+
+TEST_F(PackagerTest, PlaceJobsOnInvalidCpus) {
+  PackagingParams packaging_params = SetupPackagingParams();
+  packaging_params.cpu_placement_params.cpus = "3-1";
+  Packager packager;
+  EXPECT_EQ(error::INVALID_ARGUMENT,
+            packager.Initialize(packaging_params, SetupStreamDescriptors())
+                .error_code());
+}
+#endif  // defined(__linux__)
+
 // TODO(kqyang): Add more tests.
 
 }  // namespace shaka
@@ -68,27 +68,27 @@ const char* ErrorCodeToString(Code error_code) {
 const Status Status::OK = Status(error::OK, "");
 const Status Status::UNKNOWN = Status(error::UNKNOWN, "");
 
-Status::Status(error::Code error_code, const std::string& error_message)
-    : error_code_(error_code) {
-  if (!ok()) {
-    error_message_ = error_message;
+Status::Status(error::Code error_code, const std::string& error_message) {
+  if (error_code != error::OK) {
+    error_.reset(new Error{error_code, error_message});
     if (!error_message.empty())
       VLOG(1) << ToString();
   }
 }
 
-void Status::Update(Status new_status) {
-  if (ok())
-    *this = std::move(new_status);
-}
-
 std::string Status::ToString() const {
-  if (error_code_ == error::OK)
+  if (ok())
     return "OK";
 
-  return absl::StrFormat("%d (%s): %s", error_code_,
-                         error::ErrorCodeToString(error_code_),
-                         error_message_.c_str());
+  return absl::StrFormat("%d (%s): %s", error_->error_code,
+                         error::ErrorCodeToString(error_->error_code),
+                         error_->error_message.c_str());
+}
+
+// static
+const std::string& Status::EmptyErrorMessage() {
+  static const std::string* const empty_error_message = new std::string;
+  return *empty_error_message;
 }
 
 std::ostream& operator<<(std::ostream& os, const Status& x) {
@@ -48,6 +48,19 @@ TEST(Status, Filled) {
   CheckStatus(Status(error::CANCELLED, "message"), error::CANCELLED, "message");
 }
 
+TEST(Status, OKIsASinglePointer) {
+  EXPECT_EQ(sizeof(void*), sizeof(Status));
+}
+
+TEST(Status, Move) {
+  Status a(error::CANCELLED, "message");
+  Status b(std::move(a));
+  CheckStatus(b, error::CANCELLED, "message");
+  Status c;
+  c = std::move(b);
+  CheckStatus(c, error::CANCELLED, "message");
+}
+
 TEST(Status, Copy) {
   Status a(error::CANCELLED, "message");
   Status b(a);
@@ -0,0 +1,117 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/utils/container_limits.h>
+
+#include <fstream>
+#include <vector>
+
+#include <absl/strings/ascii.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+
+namespace shaka {
+namespace {
+
+#if defined(__linux__)
+const char kCgroupRoot[] = "/sys/fs/cgroup";
+#endif  // defined(__linux__)
+
+// The value of the unlimited cgroup v2 limits.
+const char kUnlimited[] = "max";
+// cgroup v1 reports the unlimited memory as the largest page aligned signed
+// 64-bit value. Anything above this is not a real limit either.
+const uint64_t kMaxMemoryLimit = 1ULL << 62;
+
+// Reads the first line of |path|, trimmed. Returns false if the file cannot be
+// read, e.g. if it does not exist.
+bool ReadLine(const std::string& path, std::string* line) {
+  std::ifstream file(path);
+  if (!file || !std::getline(file, *line))
+    return false;
+  absl::StripAsciiWhitespace(line);
+  return true;
+}
+
+std::optional<double> GetCpus(int64_t quota, int64_t period) {
+  if (quota <= 0 || period <= 0)
+    return std::nullopt;
+  return static_cast<double>(quota) / period;
+}
+
+std::optional<uint64_t> GetMemoryBytes(uint64_t limit) {
+  if (limit == 0 || limit >= kMaxMemoryLimit)
+    return std::nullopt;
+  return limit;
+}
+
+// Reads the cgroup v2 limits. Returns false if |cgroup_root| is not a cgroup
+// v2 file system.
+bool ReadV2(const std::string& cgroup_root, ContainerLimits* limits) {
+  std::string cpu_max;
+  std::string memory_max;
+  const bool has_cpu_max = ReadLine(cgroup_root + "/cpu.max", &cpu_max);
+  const bool has_memory_max =
+      ReadLine(cgroup_root + "/memory.max", &memory_max);
+  if (!has_cpu_max && !has_memory_max)
+    return false;
+
+  // "$MAX $PERIOD", where $MAX is "max" if the CPU time is not limited.
+  const std::vector<std::string> cpu_fields =
+      absl::StrSplit(cpu_max, ' ', absl::SkipEmpty());
+  int64_t quota = 0;
+  int64_t period = 0;
+  if (cpu_fields.size() == 2 && cpu_fields[0] != kUnlimited &&
+      absl::SimpleAtoi(cpu_fields[0], &quota) &&
+      absl::SimpleAtoi(cpu_fields[1], &period)) {
+    limits->cpus = GetCpus(quota, period);
+  }
+
+  uint64_t memory_limit = 0;
+  if (memory_max != kUnlimited && absl::SimpleAtoi(memory_max, &memory_limit))
+    limits->memory_bytes = GetMemoryBytes(memory_limit);
+  return true;
+}
+
+void ReadV1(const std::string& cgroup_root, ContainerLimits* limits) {
+  std::string line;
+  int64_t quota = 0;
+  int64_t period = 0;
+  // The quota is -1 if the CPU time is not limited.
+  if (ReadLine(cgroup_root + "/cpu/cpu.cfs_quota_us", &line) &&
+      absl::SimpleAtoi(line, &quota) &&
+      ReadLine(cgroup_root + "/cpu/cpu.cfs_period_us", &line) &&
+      absl::SimpleAtoi(line, &period)) {
+    limits->cpus = GetCpus(quota, period);
+  }
+
+  uint64_t memory_limit = 0;
+  if (ReadLine(cgroup_root + "/memory/memory.limit_in_bytes", &line) &&
+      absl::SimpleAtoi(line, &memory_limit)) {
+    limits->memory_bytes = GetMemoryBytes(memory_limit);
+  }
+}
+
+}  // namespace
+
+ContainerLimits ContainerLimits::Get() {
+#if defined(__linux__)
+  // In a container, the cgroup namespace makes the control group of the
+  // container the root of the file system.
+  return Read(kCgroupRoot);
+#else
+  return ContainerLimits();
+#endif  // defined(__linux__)
+}
+
+ContainerLimits ContainerLimits::Read(const std::string& cgroup_root) {
+  ContainerLimits limits;
+  if (!ReadV2(cgroup_root, &limits))
+    ReadV1(cgroup_root, &limits);
+  return limits;
+}
+
+}  // namespace shaka
@@ -0,0 +1,40 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_UTILS_CONTAINER_LIMITS_H_
+#define PACKAGER_UTILS_CONTAINER_LIMITS_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace shaka {
+
+/// The CPU and memory limits of the control group of the process, e.g. the
+/// limits of the container it runs in. Both cgroup v2 and cgroup v1 are
+/// supported.
+///
+/// The limits are only known on Linux. Elsewhere, the process is considered
+/// unlimited.
+struct ContainerLimits {
+  /// The CPU quota, in CPUs, e.g. 1.5 if the process may use 150ms of CPU
+  /// time every 100ms. Unset if the CPU time is not limited.
+  std::optional<double> cpus;
+  /// The memory limit, in bytes. Unset if the memory is not limited.
+  std::optional<uint64_t> memory_bytes;
+
+  /// @return the limits of the calling process.
+  static ContainerLimits Get();
+
+  /// @return the limits in a control group file system mounted on
+  ///         |cgroup_root|. The cgroup v2 files are used if present, the
+  ///         cgroup v1 files of the cpu and memory controllers otherwise.
+  static ContainerLimits Read(const std::string& cgroup_root);
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_UTILS_CONTAINER_LIMITS_H_
@@ -0,0 +1,165 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/utils/cpu_affinity.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif  // defined(__linux__)
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+#include <absl/log/log.h>
+#include <absl/strings/ascii.h>
+#include <absl/strings/match.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_cat.h>
+#include <absl/strings/str_split.h>
+
+#include <packager/macros/compiler.h>
+
+namespace shaka {
+namespace {
+
+#if defined(__linux__)
+const char kNumaNodesDir[] = "/sys/devices/system/node";
+#endif  // defined(__linux__)
+
+}  // namespace
+
+std::atomic<bool> CpuAffinity::pinned_{false};
+
+bool CpuAffinity::ParseCpuList(const std::string& list,
+                               std::vector<int>* cpus) {
+  cpus->clear();
+  const std::string trimmed_list(absl::StripAsciiWhitespace(list));
+  if (trimmed_list.empty())
+    return false;
+  const std::vector<std::string> ranges = absl::StrSplit(trimmed_list, ',');
+  for (const std::string& range : ranges) {
+    std::vector<std::string> bounds = absl::StrSplit(range, '-');
+    int first = 0;
+    int last = 0;
+    if (bounds.size() > 2 || !absl::SimpleAtoi(bounds[0], &first) ||
+        !absl::SimpleAtoi(bounds.back(), &last) || first < 0 || last < first) {
+      return false;
+    }
+    for (int cpu = first; cpu <= last; ++cpu)
+      cpus->push_back(cpu);
+  }
+  std::sort(cpus->begin(), cpus->end());
+  cpus->erase(std::unique(cpus->begin(), cpus->end()), cpus->end());
+  return true;
+}
+
+std::string CpuAffinity::FormatCpuList(const std::vector<int>& cpus) {
+  std::string list;
+  for (size_t i = 0; i < cpus.size();) {
+    size_t last = i;
+    while (last + 1 < cpus.size() && cpus[last + 1] == cpus[last] + 1)
+      ++last;
+    if (!list.empty())
+      list += ",";
+    absl::StrAppend(&list, cpus[i]);
+    if (last > i)
+      absl::StrAppend(&list, "-", cpus[last]);
+    i = last + 1;
+  }
+  return list;
+}
+
+std::vector<std::vector<int>> CpuAffinity::GetNumaNodes() {
+  std::map<int, std::vector<int>> nodes;
+#if defined(__linux__)
+  std::error_code ec;
+  for (const auto& entry :
+       std::filesystem::directory_iterator(kNumaNodesDir, ec)) {
+    const std::string name = entry.path().filename().string();
+    int node = 0;
+    if (!absl::StartsWith(name, "node") ||
+        !absl::SimpleAtoi(name.substr(4), &node)) {
+      continue;
+    }
+    std::ifstream cpu_list_file(entry.path() / "cpulist");
+    std::string cpu_list;
+    std::getline(cpu_list_file, cpu_list);
+    std::vector<int> cpus;
+    // Nodes with memory only have an empty list.
+    if (!cpu_list_file ||
+        (!cpu_list.empty() && !ParseCpuList(cpu_list, &cpus))) {
+      LOG(WARNING) << "Cannot read the CPUs of " << entry.path();
+      nodes.clear();
+      break;
+    }
+    nodes[node] = std::move(cpus);
+  }
+#endif  // defined(__linux__)
+
+  if (nodes.empty())
+    return {GetThreadCpus()};
+  std::vector<std::vector<int>> node_cpus(nodes.rbegin()->first + 1);
+  for (auto& node : nodes)
+    node_cpus[node.first] = std::move(node.second);
+  return node_cpus;
+}
+
+std::vector<int> CpuAffinity::GetThreadCpus() {
+  std::vector<int> cpus;
+#if defined(__linux__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0)
+    return cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &cpu_set))
+      cpus.push_back(cpu);
+  }
+#endif  // defined(__linux__)
+  return cpus;
+}
+
+bool CpuAffinity::SetThreadCpus(const std::vector<int>& cpus) {
+#if defined(__linux__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int cpu : cpus) {
+    if (cpu >= CPU_SETSIZE)
+      return false;
+    CPU_SET(cpu, &cpu_set);
+  }
+  if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0)
+    return false;
+  pinned_.store(true, std::memory_order_relaxed);
+  return true;
+#else
+  UNUSED(cpus);
+  return false;
+#endif  // defined(__linux__)
+}
+
+ScopedCpuAffinity::ScopedCpuAffinity(const std::vector<int>& cpus) {
+  if (cpus.empty())
+    return;
+  std::vector<int> current_cpus = CpuAffinity::GetThreadCpus();
+  if (current_cpus == cpus)
+    return;
+  if (!CpuAffinity::SetThreadCpus(cpus)) {
+    LOG(WARNING) << "Cannot run on CPUs " << CpuAffinity::FormatCpuList(cpus);
+    return;
+  }
+  previous_cpus_ = std::move(current_cpus);
+}
+
+ScopedCpuAffinity::~ScopedCpuAffinity() {
+  if (!previous_cpus_.empty())
+    CpuAffinity::SetThreadCpus(previous_cpus_);
+}
+
+}  // namespace shaka
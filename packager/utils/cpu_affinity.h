@@ -0,0 +1,74 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_UTILS_CPU_AFFINITY_H_
+#define PACKAGER_UTILS_CPU_AFFINITY_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace shaka {
+
+/// The CPUs a thread runs on, as sorted CPU numbers. Threads inherit the CPUs
+/// of the thread which creates them. Linux allocates memory on the NUMA node
+/// of the CPU which first writes it, so the memory of a thread pinned to the
+/// CPUs of a NUMA node is local to it.
+///
+/// Pinning is only supported on Linux. Elsewhere, the CPUs of a thread are
+/// unknown and cannot be set.
+class CpuAffinity {
+ public:
+  /// Parse a list of CPUs and ranges of CPUs, e.g. "0-11,24-35", as in
+  /// `taskset -c`.
+  /// @return false if |list| is malformed.
+  static bool ParseCpuList(const std::string& list, std::vector<int>* cpus);
+
+  /// @return |cpus| as a list of CPUs and ranges of CPUs, e.g. "0-11,24-35".
+  static std::string FormatCpuList(const std::vector<int>& cpus);
+
+  /// @return the CPUs of each NUMA node, by node number. Nodes without CPUs
+  ///         are empty. A single node with all the CPUs is returned if the
+  ///         topology is unknown.
+  static std::vector<std::vector<int>> GetNumaNodes();
+
+  /// @return the CPUs the calling thread may run on, or an empty set if they
+  ///         are unknown.
+  static std::vector<int> GetThreadCpus();
+
+  /// Restrict the calling thread to |cpus|.
+  /// @return false if the thread cannot run on |cpus|.
+  static bool SetThreadCpus(const std::vector<int>& cpus);
+
+  /// @return whether SetThreadCpus was called by any thread. The threads
+  ///         handing work over to other threads only pass their CPUs along
+  ///         then.
+  static bool pinned() { return pinned_.load(std::memory_order_relaxed); }
+
+ private:
+  static std::atomic<bool> pinned_;
+};
+
+/// Runs the calling thread on a set of CPUs in its scope, then restores the
+/// CPUs it ran on before.
+class ScopedCpuAffinity {
+ public:
+  /// @param cpus are the CPUs to run on. Nothing is changed if it is empty or
+  ///        already the CPUs of the thread.
+  explicit ScopedCpuAffinity(const std::vector<int>& cpus);
+  ~ScopedCpuAffinity();
+
+ private:
+  ScopedCpuAffinity(const ScopedCpuAffinity&) = delete;
+  ScopedCpuAffinity& operator=(const ScopedCpuAffinity&) = delete;
+
+  // Empty unless the CPUs were changed.
+  std::vector<int> previous_cpus_;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_UTILS_CPU_AFFINITY_H_
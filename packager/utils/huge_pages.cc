@@ -0,0 +1,111 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/utils/huge_pages.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif  // defined(__linux__)
+
+#include <cstdint>
+#include <new>
+
+#include <absl/log/log.h>
+
+#include <packager/macros/compiler.h>
+
+namespace shaka {
+namespace {
+
+#if defined(__linux__)
+size_t RoundUpToHugePage(size_t size) {
+  return (size + HugePages::kHugePageSize - 1) &
+         ~(HugePages::kHugePageSize - 1);
+}
+
+// Maps |size| bytes, a multiple of the huge page size, at an address aligned
+// to a huge page, so that all of it can be backed by transparent huge pages.
+void* MapTransparentHugePages(size_t size) {
+  const size_t mapped_size = size + HugePages::kHugePageSize;
+  void* mapping = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED)
+    return nullptr;
+
+  // Unmap the unaligned head and the tail.
+  const uintptr_t start = reinterpret_cast<uintptr_t>(mapping);
+  const uintptr_t aligned_start = RoundUpToHugePage(start);
+  if (aligned_start > start)
+    munmap(mapping, aligned_start - start);
+  const uintptr_t end = start + mapped_size;
+  if (end > aligned_start + size) {
+    munmap(reinterpret_cast<void*>(aligned_start + size),
+           end - aligned_start - size);
+  }
+
+  void* ptr = reinterpret_cast<void*>(aligned_start);
+  // Not all kernels have transparent huge pages. The mapping is still usable.
+  madvise(ptr, size, MADV_HUGEPAGE);
+  return ptr;
+}
+#endif  // defined(__linux__)
+
+}  // namespace
+
+std::atomic<HugePages::Mode> HugePages::mode_{HugePages::Mode::kNone};
+
+void* HugePages::Allocate(size_t size, bool huge) {
+#if defined(__linux__)
+  if (huge && size >= kHugePageSize) {
+    const size_t mapped_size = RoundUpToHugePage(size);
+    if (mode() == Mode::kExplicit) {
+      void* ptr = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (ptr != MAP_FAILED)
+        return ptr;
+      LOG_FIRST_N(WARNING, 1) << "No reserved huge pages left, using "
+                                 "transparent huge pages instead.";
+    }
+    void* ptr = MapTransparentHugePages(mapped_size);
+    if (!ptr)
+      throw std::bad_alloc();
+    return ptr;
+  }
+#else
+  UNUSED(huge);
+#endif  // defined(__linux__)
+  return ::operator new(size);
+}
+
+void HugePages::Free(void* ptr, size_t size, bool huge) {
+#if defined(__linux__)
+  if (huge && size >= kHugePageSize) {
+    munmap(ptr, RoundUpToHugePage(size));
+    return;
+  }
+#else
+  UNUSED(huge);
+#endif  // defined(__linux__)
+  UNUSED(size);
+  ::operator delete(ptr);
+}
+
+void HugePages::Advise(void* ptr, size_t size) {
+#if defined(__linux__)
+  if (mode() == Mode::kNone)
+    return;
+  const uintptr_t start = RoundUpToHugePage(reinterpret_cast<uintptr_t>(ptr));
+  const uintptr_t end =
+      (reinterpret_cast<uintptr_t>(ptr) + size) & ~(kHugePageSize - 1);
+  if (end > start)
+    madvise(reinterpret_cast<void*>(start), end - start, MADV_HUGEPAGE);
+#else
+  UNUSED(ptr);
+  UNUSED(size);
+#endif  // defined(__linux__)
+}
+
+}  // namespace shaka
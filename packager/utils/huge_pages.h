@@ -0,0 +1,99 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_UTILS_HUGE_PAGES_H_
+#define PACKAGER_UTILS_HUGE_PAGES_H_
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace shaka {
+
+/// Backs the large buffers which live long, e.g. the I/O caches and the
+/// fragment buffers of the segmenters, with huge pages, so that copying
+/// through many of them misses the TLB less. Buffers smaller than a huge page
+/// are allocated as usual. Huge pages are only supported on Linux; elsewhere,
+/// and when the kernel cannot provide them, regular pages are used.
+class HugePages {
+ public:
+  enum class Mode {
+    /// Regular pages.
+    kNone,
+    /// Transparent huge pages, which the kernel provides when it can.
+    kTransparent,
+    /// Huge pages reserved by the administrator, e.g. with
+    /// /proc/sys/vm/nr_hugepages. Transparent huge pages are used once the
+    /// reserved pages run out.
+    kExplicit,
+  };
+
+  /// The size of the huge pages, which is the default size on x86-64 and
+  /// arm64.
+  static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+  /// Set the pages of the buffers allocated from now on. It applies to the
+  /// whole process.
+  static void SetMode(Mode mode) {
+    mode_.store(mode, std::memory_order_relaxed);
+  }
+  static Mode mode() { return mode_.load(std::memory_order_relaxed); }
+
+  /// Allocate |size| bytes, with huge pages if |huge| and |size| is at least a
+  /// huge page. Throws std::bad_alloc if the memory cannot be allocated.
+  static void* Allocate(size_t size, bool huge);
+  /// Free memory allocated with Allocate() with the same |size| and |huge|.
+  static void Free(void* ptr, size_t size, bool huge);
+
+  /// Advise the kernel to back the whole huge pages in [ptr, ptr + size) of a
+  /// regular allocation with transparent huge pages, if enabled. It is
+  /// effective for the memory not written yet.
+  static void Advise(void* ptr, size_t size);
+
+ private:
+  static std::atomic<Mode> mode_;
+};
+
+/// An allocator which allocates with huge pages if they are enabled when it
+/// is constructed, see HugePages.
+template <typename T>
+class HugePageAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  HugePageAllocator() : huge_(HugePages::mode() != HugePages::Mode::kNone) {}
+  template <typename U>
+  HugePageAllocator(const HugePageAllocator<U>& other) : huge_(other.huge_) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(HugePages::Allocate(n * sizeof(T), huge_));
+  }
+  void deallocate(T* ptr, size_t n) {
+    HugePages::Free(ptr, n * sizeof(T), huge_);
+  }
+
+  template <typename U>
+  bool operator==(const HugePageAllocator<U>& other) const {
+    return huge_ == other.huge_;
+  }
+  template <typename U>
+  bool operator!=(const HugePageAllocator<U>& other) const {
+    return huge_ != other.huge_;
+  }
+
+ private:
+  template <typename U>
+  friend class HugePageAllocator;
+
+  bool huge_;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_UTILS_HUGE_PAGES_H_
@@ -0,0 +1,106 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/utils/memory_accounting.h>
+
+#include <string>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+#include <packager/utils/metrics.h>
+
+namespace shaka {
+namespace {
+
+const char* const kSubsystemNames[kNumMemorySubsystems] = {
+    "media_samples",
+    "io_caches",
+    "cue_alignment_queues",
+    "fragmenter_buffers",
+    "mpd_segments",
+    "hls_playlist_entries",
+    "key_pools",
+};
+
+struct Account {
+  MetricGauge* bytes;
+  MetricGauge* peak_bytes;
+};
+
+Account* GetAccounts() {
+  static Account* const accounts = [] {
+    Account* accounts = new Account[kNumMemorySubsystems];
+    MetricsRegistry* registry = MetricsRegistry::GetInstance();
+    for (int i = 0; i < kNumMemorySubsystems; ++i) {
+      const std::string prefix =
+          std::string("shaka_memory_") + kSubsystemNames[i];
+      accounts[i].bytes = registry->GetGauge(
+          prefix + "_bytes",
+          std::string("Bytes used by the ") + kSubsystemNames[i] + ".");
+      accounts[i].peak_bytes = registry->GetGauge(
+          prefix + "_peak_bytes",
+          std::string("Peak bytes used by the ") + kSubsystemNames[i] + ".");
+    }
+    return accounts;
+  }();
+  return accounts;
+}
+
+Account* GetAccount(MemorySubsystem subsystem) {
+  return &GetAccounts()[static_cast<int>(subsystem)];
+}
+
+}  // namespace
+
+void MemoryAccounting::Add(MemorySubsystem subsystem, int64_t delta) {
+  Account* account = GetAccount(subsystem);
+  const int64_t bytes = account->bytes->Add(delta);
+  if (delta > 0)
+    account->peak_bytes->UpdateMax(bytes);
+}
+
+int64_t MemoryAccounting::bytes(MemorySubsystem subsystem) {
+  return GetAccount(subsystem)->bytes->value();
+}
+
+int64_t MemoryAccounting::peak_bytes(MemorySubsystem subsystem) {
+  return GetAccount(subsystem)->peak_bytes->value();
+}
+
+int64_t MemoryAccounting::total_bytes() {
+  int64_t total = 0;
+  for (int i = 0; i < kNumMemorySubsystems; ++i) {
+    const MemorySubsystem subsystem = static_cast<MemorySubsystem>(i);
+    if (subsystem != MemorySubsystem::kCueAlignmentQueues)
+      total += bytes(subsystem);
+  }
+  return total;
+}
+
+const char* MemoryAccounting::name(MemorySubsystem subsystem) {
+  return kSubsystemNames[static_cast<int>(subsystem)];
+}
+
+int64_t MemoryAccounting::peak_rss_bytes() {
+#if defined(_WIN32)
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined(__APPLE__)
+  // In bytes on macOS.
+  return usage.ru_maxrss;
+#else
+  // In kilobytes on Linux.
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+}  // namespace shaka
@@ -0,0 +1,91 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_UTILS_MEMORY_ACCOUNTING_H_
+#define PACKAGER_UTILS_MEMORY_ACCOUNTING_H_
+
+#include <cstdint>
+
+namespace shaka {
+
+/// The subsystems whose memory is accounted for, which are the largest
+/// consumers of memory in live packaging.
+enum class MemorySubsystem {
+  /// Payloads of the media samples in flight.
+  kMediaSamples,
+  /// Caches of the threaded files.
+  kIoCaches,
+  /// Samples queued by the cue alignment handlers.
+  kCueAlignmentQueues,
+  /// Fragments being built by the MP4 fragmenters.
+  kFragmenterBuffers,
+  /// Segments kept in the timelines of the DASH representations.
+  kMpdSegments,
+  /// Entries of the HLS media playlists.
+  kHlsPlaylistEntries,
+  /// Keys fetched ahead by the Widevine key sources.
+  kKeyPools,
+};
+
+/// The number of MemorySubsystem values.
+constexpr int kNumMemorySubsystems =
+    static_cast<int>(MemorySubsystem::kKeyPools) + 1;
+
+/// Counts the bytes used by each subsystem, and their peak. The counts are
+/// exported as the shaka_memory_<subsystem>_bytes and
+/// shaka_memory_<subsystem>_peak_bytes metrics. They can be updated from any
+/// thread without locking.
+class MemoryAccounting {
+ public:
+  static void Add(MemorySubsystem subsystem, int64_t delta);
+
+  /// @return The bytes in use by @a subsystem.
+  static int64_t bytes(MemorySubsystem subsystem);
+  /// @return The highest number of bytes used by @a subsystem.
+  static int64_t peak_bytes(MemorySubsystem subsystem);
+  /// @return The bytes in use by all the subsystems. The samples queued by the
+  ///         cue alignment handlers are only counted as media samples.
+  static int64_t total_bytes();
+  /// @return The name of @a subsystem, e.g. "media_samples".
+  static const char* name(MemorySubsystem subsystem);
+
+  /// @return The peak resident set size of the process, in bytes, or 0 if it
+  ///         is not available.
+  static int64_t peak_rss_bytes();
+};
+
+/// Charges the bytes of an object, e.g. a buffer, to a subsystem. The charge
+/// follows the size of the object, and is released on destruction.
+class MemoryCharge {
+ public:
+  explicit MemoryCharge(MemorySubsystem subsystem) : subsystem_(subsystem) {}
+  MemoryCharge(MemorySubsystem subsystem, int64_t bytes)
+      : subsystem_(subsystem) {
+    Set(bytes);
+  }
+  ~MemoryCharge() { Set(0); }
+
+  /// Changes the charge to @a bytes.
+  void Set(int64_t bytes) {
+    if (bytes == bytes_)
+      return;
+    MemoryAccounting::Add(subsystem_, bytes - bytes_);
+    bytes_ = bytes;
+  }
+
+  int64_t bytes() const { return bytes_; }
+
+ private:
+  MemoryCharge(const MemoryCharge&) = delete;
+  MemoryCharge& operator=(const MemoryCharge&) = delete;
+
+  const MemorySubsystem subsystem_;
+  int64_t bytes_ = 0;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_UTILS_MEMORY_ACCOUNTING_H_
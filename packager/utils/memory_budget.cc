@@ -0,0 +1,61 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/utils/memory_budget.h>
+
+#include <chrono>
+
+#include <absl/log/log.h>
+#include <absl/time/clock.h>
+#include <absl/time/time.h>
+
+#include <packager/utils/memory_accounting.h>
+#include <packager/utils/metrics.h>
+
+namespace shaka {
+namespace {
+
+// How often the memory is checked while throttled, and how long a producer is
+// held at most.
+const absl::Duration kPollInterval = absl::Milliseconds(5);
+const absl::Duration kMaxThrottleTime = absl::Seconds(1);
+
+bool OverBudget() {
+  return MemoryAccounting::total_bytes() >
+         static_cast<int64_t>(MemoryBudget::limit());
+}
+
+MetricDurations* ThrottleDurations() {
+  static MetricDurations* const throttle_durations =
+      MetricsRegistry::GetInstance()->GetDurations(
+          "shaka_memory_budget_throttle_seconds",
+          "Time readers and writers were held because the memory budget was "
+          "exceeded.");
+  return throttle_durations;
+}
+
+}  // namespace
+
+std::atomic<uint64_t> MemoryBudget::limit_{0};
+
+void MemoryBudget::ThrottleInternal() {
+  if (!OverBudget())
+    return;
+
+  ScopedMetricTimer timer(ThrottleDurations());
+  const absl::Time deadline = absl::Now() + kMaxThrottleTime;
+  while (OverBudget()) {
+    if (absl::Now() >= deadline) {
+      LOG_EVERY_N_SEC(WARNING, 10)
+          << "Memory budget of " << limit() << " bytes exceeded, with "
+          << MemoryAccounting::total_bytes() << " bytes in use.";
+      return;
+    }
+    absl::SleepFor(kPollInterval);
+  }
+}
+
+}  // namespace shaka
@@ -0,0 +1,45 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_UTILS_MEMORY_BUDGET_H_
+#define PACKAGER_UTILS_MEMORY_BUDGET_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace shaka {
+
+/// A process-wide budget for the memory counted by MemoryAccounting. While the
+/// budget is exceeded, the producers of data, i.e. the demuxers reading their
+/// inputs and the muxers writing through threaded files, are throttled so that
+/// the consumers can release memory.
+///
+/// A producer is never held for more than a bounded time, as the memory may
+/// only be released once it produces more data, e.g. when the cue alignment
+/// handlers wait for all the streams to reach a cue.
+class MemoryBudget {
+ public:
+  /// @param bytes is the budget, or 0 for no budget.
+  static void SetLimit(uint64_t bytes) {
+    limit_.store(bytes, std::memory_order_relaxed);
+  }
+  static uint64_t limit() { return limit_.load(std::memory_order_relaxed); }
+
+  /// Waits while the budget is exceeded, up to a bounded time.
+  static void Throttle() {
+    if (limit() > 0)
+      ThrottleInternal();
+  }
+
+ private:
+  static void ThrottleInternal();
+
+  static std::atomic<uint64_t> limit_;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_UTILS_MEMORY_BUDGET_H_
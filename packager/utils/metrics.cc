@@ -0,0 +1,96 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/utils/metrics.h>
+
+#include <absl/strings/str_format.h>
+
+namespace shaka {
+namespace {
+
+template <typename T>
+T* GetOrCreate(const std::string& name,
+               const std::string& help,
+               std::map<std::string, T>* metrics) {
+  auto& metric = (*metrics)[name];
+  if (!metric.value) {
+    metric.help = help;
+    metric.value.reset(new typename decltype(metric.value)::element_type);
+  }
+  return &metric;
+}
+
+void AppendHeader(const std::string& name,
+                  const std::string& help,
+                  const char* type,
+                  std::string* out) {
+  absl::StrAppendFormat(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name,
+                        type);
+}
+
+}  // namespace
+
+MetricsRegistry* MetricsRegistry::GetInstance() {
+  // Never destroyed, so that metrics can be updated during shutdown.
+  static MetricsRegistry* const instance = new MetricsRegistry;
+  return instance;
+}
+
+MetricCounter* MetricsRegistry::GetCounter(const std::string& name,
+                                           const std::string& help) {
+  absl::MutexLock lock(&mutex_);
+  return GetOrCreate(name, help, &counters_)->value.get();
+}
+
+MetricGauge* MetricsRegistry::GetGauge(const std::string& name,
+                                       const std::string& help) {
+  absl::MutexLock lock(&mutex_);
+  return GetOrCreate(name, help, &gauges_)->value.get();
+}
+
+MetricDurations* MetricsRegistry::GetDurations(const std::string& name,
+                                               const std::string& help) {
+  absl::MutexLock lock(&mutex_);
+  return GetOrCreate(name, help, &durations_)->value.get();
+}
+
+void MetricsRegistry::AddCollector(std::function<void()> collector) {
+  absl::MutexLock lock(&mutex_);
+  collectors_.push_back(std::move(collector));
+}
+
+std::string MetricsRegistry::ToPrometheusText() const {
+  std::vector<std::function<void()>> collectors;
+  {
+    absl::MutexLock lock(&mutex_);
+    collectors = collectors_;
+  }
+  // Called without the lock, so that they can get metrics.
+  for (const auto& collector : collectors)
+    collector();
+
+  std::string out;
+  absl::MutexLock lock(&mutex_);
+  for (const auto& pair : counters_) {
+    AppendHeader(pair.first, pair.second.help, "counter", &out);
+    absl::StrAppendFormat(&out, "%s %d\n", pair.first,
+                          pair.second.value->value());
+  }
+  for (const auto& pair : gauges_) {
+    AppendHeader(pair.first, pair.second.help, "gauge", &out);
+    absl::StrAppendFormat(&out, "%s %d\n", pair.first,
+                          pair.second.value->value());
+  }
+  for (const auto& pair : durations_) {
+    AppendHeader(pair.first, pair.second.help, "summary", &out);
+    absl::StrAppendFormat(&out, "%s_count %d\n%s_sum %.6f\n", pair.first,
+                          pair.second.value->count(), pair.first,
+                          pair.second.value->sum_seconds());
+  }
+  return out;
+}
+
+}  // namespace shaka
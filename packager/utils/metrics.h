@@ -0,0 +1,145 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_UTILS_METRICS_H_
+#define PACKAGER_UTILS_METRICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+
+namespace shaka {
+
+/// A value which only goes up, e.g. a number of requests. It can be updated
+/// from any thread without locking.
+class MetricCounter {
+ public:
+  void Increment(uint64_t count = 1) {
+    value_.fetch_add(count, std::memory_order_relaxed);
+  }
+  uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint64_t> value_{0};
+};
+
+/// A value which goes up and down, e.g. a number of buffered bytes. It can be
+/// updated from any thread without locking.
+class MetricGauge {
+ public:
+  /// @return The new value.
+  int64_t Add(int64_t delta) {
+    return value_.fetch_add(delta, std::memory_order_relaxed) + delta;
+  }
+  void Set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+  /// Raises the value to @a value if it is lower, e.g. to keep a peak.
+  void UpdateMax(int64_t value) {
+    int64_t current = value_.load(std::memory_order_relaxed);
+    while (current < value &&
+           !value_.compare_exchange_weak(current, value,
+                                         std::memory_order_relaxed)) {
+    }
+  }
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+/// The durations of an operation, kept as their number and their sum. It can
+/// be updated from any thread without locking.
+class MetricDurations {
+ public:
+  void Record(std::chrono::steady_clock::duration duration) {
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_us_.fetch_add(
+        std::chrono::duration_cast<std::chrono::microseconds>(duration)
+            .count(),
+        std::memory_order_relaxed);
+  }
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  double sum_seconds() const {
+    return sum_us_.load(std::memory_order_relaxed) / 1e6;
+  }
+
+ private:
+  std::atomic<uint64_t> count_{0};
+  std::atomic<int64_t> sum_us_{0};
+};
+
+/// Records the time spent in its scope in a MetricDurations.
+class ScopedMetricTimer {
+ public:
+  explicit ScopedMetricTimer(MetricDurations* durations)
+      : durations_(durations), start_(std::chrono::steady_clock::now()) {}
+  ~ScopedMetricTimer() {
+    durations_->Record(std::chrono::steady_clock::now() - start_);
+  }
+
+ private:
+  ScopedMetricTimer(const ScopedMetricTimer&) = delete;
+  ScopedMetricTimer& operator=(const ScopedMetricTimer&) = delete;
+
+  MetricDurations* const durations_;
+  const std::chrono::steady_clock::time_point start_;
+};
+
+/// The metrics of the process, which can be exported in the Prometheus text
+/// format. A metric is created the first time it is requested and lives as
+/// long as the process, so callers should request it once, e.g. into a
+/// function-local static, and then update it without locking.
+class MetricsRegistry {
+ public:
+  static MetricsRegistry* GetInstance();
+
+  /// @param name is the Prometheus name of the metric.
+  /// @param help describes the metric.
+  /// @return The counter with the given name, created if needed.
+  MetricCounter* GetCounter(const std::string& name, const std::string& help);
+  /// @return The gauge with the given name, created if needed.
+  MetricGauge* GetGauge(const std::string& name, const std::string& help);
+  /// @return The durations with the given name, created if needed. They are
+  ///         exported as a summary, in seconds.
+  MetricDurations* GetDurations(const std::string& name,
+                                const std::string& help);
+
+  /// Add a function which updates metrics from another source, e.g. the
+  /// allocator, each time the metrics are exported.
+  void AddCollector(std::function<void()> collector);
+
+  /// @return All the metrics in the Prometheus text exposition format.
+  std::string ToPrometheusText() const;
+
+ private:
+  template <typename T>
+  struct Metric {
+    std::string help;
+    std::unique_ptr<T> value;
+  };
+
+  MetricsRegistry() = default;
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+  mutable absl::Mutex mutex_;
+  std::map<std::string, Metric<MetricCounter>> counters_
+      ABSL_GUARDED_BY(mutex_);
+  std::map<std::string, Metric<MetricGauge>> gauges_ ABSL_GUARDED_BY(mutex_);
+  std::map<std::string, Metric<MetricDurations>> durations_
+      ABSL_GUARDED_BY(mutex_);
+  std::vector<std::function<void()>> collectors_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_UTILS_METRICS_H_
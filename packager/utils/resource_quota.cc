@@ -0,0 +1,174 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/utils/resource_quota.h>
+
+#if !defined(OS_WIN)
+#include <time.h>
+#endif  // !defined(OS_WIN)
+
+#include <algorithm>
+
+#include <absl/time/clock.h>
+
+#include <packager/utils/metrics.h>
+
+namespace shaka {
+namespace {
+
+// How far ahead of its CPU time a quota may be, to allow for bursts, and how
+// long a thread is held at most at a time.
+const absl::Duration kMaxCpuBurst = absl::Milliseconds(100);
+const absl::Duration kMaxThrottleTime = absl::Seconds(1);
+// How often a thread waiting for an upload slot checks whether it is aborted.
+const absl::Duration kUploadPollInterval = absl::Milliseconds(100);
+
+MetricDurations* ThrottleDurations() {
+  static MetricDurations* const throttle_durations =
+      MetricsRegistry::GetInstance()->GetDurations(
+          "shaka_resource_quota_throttle_seconds",
+          "Time the threads of the packagers were held by their quotas.");
+  return throttle_durations;
+}
+
+// @return the CPU time of the calling thread, or 0 if it is unknown.
+int64_t ThreadCpuNanoseconds() {
+#if defined(OS_WIN)
+  return 0;
+#else
+  struct timespec time;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+    return 0;
+  return static_cast<int64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+#endif  // defined(OS_WIN)
+}
+
+}  // namespace
+
+thread_local std::shared_ptr<ResourceQuota> ResourceQuota::current_;
+thread_local int64_t ResourceQuota::thread_cpu_nanoseconds_ = 0;
+
+ResourceQuota::ResourceQuota(double cpus,
+                             uint64_t memory_bytes,
+                             uint32_t max_uploads)
+    : cpus_(cpus), memory_limit_(memory_bytes), max_uploads_(max_uploads) {}
+
+ResourceQuota::Usage ResourceQuota::GetUsage() const {
+  absl::MutexLock lock(&mutex_);
+  Usage usage;
+  usage.cpu_seconds = cpu_seconds_;
+  usage.memory_bytes = memory_bytes_;
+  usage.peak_memory_bytes = peak_memory_bytes_;
+  usage.uploads_in_flight = uploads_in_flight_;
+  usage.throttled_seconds = absl::ToDoubleSeconds(throttled_time_);
+  return usage;
+}
+
+uint64_t ResourceQuota::FitIoCache(uint64_t bytes, uint64_t min_bytes) {
+  if (!current_ || current_->memory_limit_ == 0)
+    return bytes;
+  absl::MutexLock lock(&current_->mutex_);
+  const uint64_t available =
+      current_->memory_limit_ > current_->memory_bytes_
+          ? current_->memory_limit_ - current_->memory_bytes_
+          : 0;
+  return std::max(min_bytes, std::min(bytes, available));
+}
+
+void ResourceQuota::AddMemory(int64_t delta) {
+  absl::MutexLock lock(&mutex_);
+  memory_bytes_ += delta;
+  peak_memory_bytes_ = std::max(peak_memory_bytes_, memory_bytes_);
+}
+
+bool ResourceQuota::AcquireUpload(const absl::Notification& abort_event) {
+  absl::MutexLock lock(&mutex_);
+  if (max_uploads_ > 0 && uploads_in_flight_ >= max_uploads_) {
+    ScopedMetricTimer timer(ThrottleDurations());
+    const absl::Time wait_start = absl::Now();
+    while (uploads_in_flight_ >= max_uploads_) {
+      if (abort_event.HasBeenNotified())
+        break;
+      upload_released_.WaitWithTimeout(&mutex_, kUploadPollInterval);
+    }
+    throttled_time_ += absl::Now() - wait_start;
+    if (uploads_in_flight_ >= max_uploads_)
+      return false;
+  }
+  ++uploads_in_flight_;
+  return true;
+}
+
+void ResourceQuota::ReleaseUpload() {
+  absl::MutexLock lock(&mutex_);
+  --uploads_in_flight_;
+  upload_released_.Signal();
+}
+
+void ResourceQuota::ChargeThreadCpuTime() {
+  const int64_t now_nanoseconds = ThreadCpuNanoseconds();
+  const int64_t cpu_nanoseconds = now_nanoseconds - thread_cpu_nanoseconds_;
+  thread_cpu_nanoseconds_ = now_nanoseconds;
+  if (cpu_nanoseconds <= 0)
+    return;
+
+  const double cpu_seconds = cpu_nanoseconds / 1e9;
+  absl::MutexLock lock(&mutex_);
+  cpu_seconds_ += cpu_seconds;
+  if (cpus_ > 0) {
+    cpu_theoretical_arrival_time_ =
+        std::max(cpu_theoretical_arrival_time_, absl::Now() - kMaxCpuBurst) +
+        absl::Seconds(cpu_seconds / cpus_);
+  }
+}
+
+void ResourceQuota::ThrottleThread() {
+  ChargeThreadCpuTime();
+  if (cpus_ <= 0)
+    return;
+
+  absl::Duration wait;
+  {
+    absl::MutexLock lock(&mutex_);
+    wait = std::min(cpu_theoretical_arrival_time_ - absl::Now(),
+                    kMaxThrottleTime);
+    if (wait <= absl::ZeroDuration())
+      return;
+    throttled_time_ += wait;
+  }
+  ScopedMetricTimer timer(ThrottleDurations());
+  absl::SleepFor(wait);
+  // The time asleep is not CPU time.
+  thread_cpu_nanoseconds_ = ThreadCpuNanoseconds();
+}
+
+ScopedResourceQuota::ScopedResourceQuota(std::shared_ptr<ResourceQuota> quota)
+    : previous_quota_(ResourceQuota::current_) {
+  if (previous_quota_)
+    previous_quota_->ChargeThreadCpuTime();
+  ResourceQuota::current_ = std::move(quota);
+  ResourceQuota::thread_cpu_nanoseconds_ = ThreadCpuNanoseconds();
+}
+
+ScopedResourceQuota::~ScopedResourceQuota() {
+  if (ResourceQuota::current_)
+    ResourceQuota::current_->ChargeThreadCpuTime();
+  ResourceQuota::current_ = std::move(previous_quota_);
+  ResourceQuota::thread_cpu_nanoseconds_ = ThreadCpuNanoseconds();
+}
+
+ResourceQuotaCharge::ResourceQuotaCharge(uint64_t bytes)
+    : quota_(ResourceQuota::current()), bytes_(bytes) {
+  if (quota_)
+    quota_->AddMemory(static_cast<int64_t>(bytes_));
+}
+
+ResourceQuotaCharge::~ResourceQuotaCharge() {
+  if (quota_)
+    quota_->AddMemory(-static_cast<int64_t>(bytes_));
+}
+
+}  // namespace shaka
@@ -0,0 +1,136 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_UTILS_RESOURCE_QUOTA_H_
+#define PACKAGER_UTILS_RESOURCE_QUOTA_H_
+
+#include <cstdint>
+#include <memory>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/synchronization/notification.h>
+#include <absl/time/time.h>
+
+namespace shaka {
+
+/// The resources of one of the packagers of a process, e.g. of one tenant of
+/// a service, so that a packager cannot starve the others. The threads doing
+/// the work of the packager are bound to its quota, see ScopedResourceQuota,
+/// and the threads they start or post tasks to inherit it:
+///  - their CPU time, measured whenever they are throttled and when they
+///    leave the quota, is limited to a number of CPUs;
+///  - the I/O caches of the files they open are charged to the quota, and
+///    shrunk so that they stay within its memory;
+///  - the HTTP uploads they start wait while the quota has too many in
+///    flight.
+/// The usage is counted even when there is no limit.
+class ResourceQuota {
+ public:
+  /// @param cpus is the CPU time allowed per second, e.g. 2.5 for two and a
+  ///        half CPUs, or 0 for no limit.
+  /// @param memory_bytes is the memory of the I/O caches, or 0 for no limit.
+  /// @param max_uploads is the number of uploads in flight, or 0 for no
+  ///        limit.
+  ResourceQuota(double cpus, uint64_t memory_bytes, uint32_t max_uploads);
+
+  /// The resources used under the quota.
+  struct Usage {
+    double cpu_seconds = 0;
+    uint64_t memory_bytes = 0;
+    uint64_t peak_memory_bytes = 0;
+    uint32_t uploads_in_flight = 0;
+    /// Time the threads were held by the CPU and upload limits.
+    double throttled_seconds = 0;
+  };
+  Usage GetUsage() const;
+
+  /// @return the quota of the calling thread, or nullptr if it has none.
+  static std::shared_ptr<ResourceQuota> current() { return current_; }
+
+  /// Charges the CPU time of the calling thread to its quota, if any, then
+  /// waits while the quota is over its CPU time. Called by the producers of
+  /// data, i.e. the demuxers and the file writers.
+  static void Throttle() {
+    if (current_)
+      current_->ThrottleThread();
+  }
+
+  /// @return the size of the I/O cache of a file opened by the calling
+  ///         thread: |bytes|, or less if the memory left in its quota is
+  ///         smaller, but at least |min_bytes|.
+  static uint64_t FitIoCache(uint64_t bytes, uint64_t min_bytes);
+
+  void AddMemory(int64_t delta);
+
+  /// Waits for an upload slot, unless @a abort_event is notified first.
+  /// @return true if a slot was taken, to be given back with ReleaseUpload().
+  bool AcquireUpload(const absl::Notification& abort_event);
+  void ReleaseUpload();
+
+ private:
+  friend class ScopedResourceQuota;
+
+  ResourceQuota(const ResourceQuota&) = delete;
+  ResourceQuota& operator=(const ResourceQuota&) = delete;
+
+  // Charges the CPU time of the calling thread since it was last charged.
+  void ChargeThreadCpuTime();
+  void ThrottleThread();
+
+  static thread_local std::shared_ptr<ResourceQuota> current_;
+  // The CPU time of the calling thread when it was last charged.
+  static thread_local int64_t thread_cpu_nanoseconds_;
+
+  const double cpus_;
+  const uint64_t memory_limit_;
+  const uint32_t max_uploads_;
+
+  mutable absl::Mutex mutex_;
+  double cpu_seconds_ ABSL_GUARDED_BY(mutex_) = 0;
+  // The token bucket of the CPU time, as the time at which the CPU time used
+  // so far is within the limit.
+  absl::Time cpu_theoretical_arrival_time_ ABSL_GUARDED_BY(mutex_);
+  uint64_t memory_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  uint64_t peak_memory_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  uint32_t uploads_in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::CondVar upload_released_ ABSL_GUARDED_BY(mutex_);
+  absl::Duration throttled_time_ ABSL_GUARDED_BY(mutex_);
+};
+
+/// Binds the calling thread to a quota in its scope. The CPU time it uses in
+/// the scope is charged to the quota.
+class ScopedResourceQuota {
+ public:
+  /// @param quota is the quota, or nullptr for none.
+  explicit ScopedResourceQuota(std::shared_ptr<ResourceQuota> quota);
+  ~ScopedResourceQuota();
+
+ private:
+  ScopedResourceQuota(const ScopedResourceQuota&) = delete;
+  ScopedResourceQuota& operator=(const ScopedResourceQuota&) = delete;
+
+  std::shared_ptr<ResourceQuota> previous_quota_;
+};
+
+/// Charges memory to the quota of the calling thread, if any, for its
+/// lifetime.
+class ResourceQuotaCharge {
+ public:
+  explicit ResourceQuotaCharge(uint64_t bytes);
+  ~ResourceQuotaCharge();
+
+ private:
+  ResourceQuotaCharge(const ResourceQuotaCharge&) = delete;
+  ResourceQuotaCharge& operator=(const ResourceQuotaCharge&) = delete;
+
+  const std::shared_ptr<ResourceQuota> quota_;
+  const uint64_t bytes_;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_UTILS_RESOURCE_QUOTA_H_
@@ -0,0 +1,143 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/utils/trace.h>
+
+#include <memory>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+#include <nlohmann/json.hpp>
+
+namespace shaka {
+namespace {
+
+struct TraceEvent {
+  const char* name;
+  std::string detail;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point end;
+};
+
+// The events of one thread. Only that thread appends to it, but Stop() takes
+// the events from another thread.
+struct ThreadBuffer {
+  uint32_t thread_id;
+  absl::Mutex mutex;
+  std::vector<TraceEvent> events ABSL_GUARDED_BY(mutex);
+};
+
+// The buffers of all the threads which recorded events, which outlive the
+// threads so that the events can be written at the end.
+struct TraceSession {
+  absl::Mutex mutex;
+  std::chrono::steady_clock::time_point start_time ABSL_GUARDED_BY(mutex);
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers ABSL_GUARDED_BY(mutex);
+  // Incremented by each session, so that threads drop buffers of previous
+  // sessions.
+  uint32_t generation ABSL_GUARDED_BY(mutex) = 0;
+};
+
+TraceSession* GetSession() {
+  static TraceSession* const session = new TraceSession;
+  return session;
+}
+
+std::atomic<uint32_t> g_session_generation{0};
+
+ThreadBuffer* GetThreadBuffer() {
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+  thread_local uint32_t buffer_generation = 0;
+
+  const uint32_t generation =
+      g_session_generation.load(std::memory_order_acquire);
+  if (!buffer || buffer_generation != generation) {
+    TraceSession* session = GetSession();
+    absl::MutexLock lock(&session->mutex);
+    buffer = std::make_shared<ThreadBuffer>();
+    buffer->thread_id = static_cast<uint32_t>(session->buffers.size() + 1);
+    session->buffers.push_back(buffer);
+    buffer_generation = generation;
+  }
+  return buffer.get();
+}
+
+int64_t ToMicroseconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+      .count();
+}
+
+}  // namespace
+
+std::atomic<bool> Tracing::enabled_{false};
+
+void Tracing::Start() {
+  TraceSession* session = GetSession();
+  absl::MutexLock lock(&session->mutex);
+  session->start_time = std::chrono::steady_clock::now();
+  session->buffers.clear();
+  g_session_generation.store(++session->generation, std::memory_order_release);
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+std::string Tracing::Stop() {
+  enabled_.store(false, std::memory_order_relaxed);
+
+  TraceSession* session = GetSession();
+  absl::MutexLock lock(&session->mutex);
+  nlohmann::json events = nlohmann::json::array();
+  for (const auto& buffer : session->buffers) {
+    std::vector<TraceEvent> buffer_events;
+    {
+      absl::MutexLock buffer_lock(&buffer->mutex);
+      buffer_events.swap(buffer->events);
+    }
+    for (const TraceEvent& event : buffer_events) {
+      nlohmann::json json_event = {
+          {"name", event.name},
+          {"ph", "X"},
+          {"ts", ToMicroseconds(event.start - session->start_time)},
+          {"dur", ToMicroseconds(event.end - event.start)},
+          {"pid", 1},
+          {"tid", buffer->thread_id},
+      };
+      if (!event.detail.empty())
+        json_event["args"] = {{"detail", event.detail}};
+      events.push_back(std::move(json_event));
+    }
+  }
+  session->buffers.clear();
+  return nlohmann::json{{"traceEvents", std::move(events)}}.dump();
+}
+
+void Tracing::AddCompleteEvent(const char* name,
+                               std::string detail,
+                               std::chrono::steady_clock::time_point start,
+                               std::chrono::steady_clock::time_point end) {
+  ThreadBuffer* buffer = GetThreadBuffer();
+  absl::MutexLock lock(&buffer->mutex);
+  buffer->events.push_back({name, std::move(detail), start, end});
+}
+
+ScopedTraceEvent::ScopedTraceEvent(const char* name, const std::string& detail)
+    : name_(name) {
+  if (!Tracing::enabled())
+    return;
+  detail_ = detail;
+  start_ = std::chrono::steady_clock::now();
+}
+
+ScopedTraceEvent::~ScopedTraceEvent() {
+  // Events which started before tracing was enabled are dropped.
+  if (!Tracing::enabled() ||
+      start_ == std::chrono::steady_clock::time_point()) {
+    return;
+  }
+  Tracing::AddCompleteEvent(name_, std::move(detail_), start_,
+                            std::chrono::steady_clock::now());
+}
+
+}  // namespace shaka
@@ -0,0 +1,65 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_UTILS_TRACE_H_
+#define PACKAGER_UTILS_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace shaka {
+
+/// Records trace events, e.g. segment finalization or manifest flushes, to be
+/// written in the Chrome trace event format, which chrome://tracing and the
+/// Perfetto UI open.
+///
+/// Each thread appends its events to a buffer of its own, whose lock is only
+/// contended while Stop() collects the events.
+class Tracing {
+ public:
+  /// Starts recording trace events.
+  static void Start();
+
+  /// Stops recording. Events which are still being recorded by other threads
+  /// may be dropped.
+  /// @return the events recorded so far, in the Chrome trace event format.
+  static std::string Stop();
+
+  static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+ private:
+  friend class ScopedTraceEvent;
+
+  static void AddCompleteEvent(const char* name,
+                               std::string detail,
+                               std::chrono::steady_clock::time_point start,
+                               std::chrono::steady_clock::time_point end);
+
+  static std::atomic<bool> enabled_;
+};
+
+/// Records the time spent in its scope as a trace event, if tracing is
+/// enabled. |name| must outlive the tracing session, e.g. be a literal.
+class ScopedTraceEvent {
+ public:
+  explicit ScopedTraceEvent(const char* name) : ScopedTraceEvent(name, "") {}
+  /// @param detail is shown with the event, e.g. the name of a file.
+  ScopedTraceEvent(const char* name, const std::string& detail);
+  ~ScopedTraceEvent();
+
+ private:
+  ScopedTraceEvent(const ScopedTraceEvent&) = delete;
+  ScopedTraceEvent& operator=(const ScopedTraceEvent&) = delete;
+
+  const char* const name_;
+  std::string detail_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_UTILS_TRACE_H_
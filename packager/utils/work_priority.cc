@@ -0,0 +1,97 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/utils/work_priority.h>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // defined(__linux__)
+
+#include <algorithm>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/log/log.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/time/clock.h>
+#include <absl/time/time.h>
+
+#include <packager/utils/metrics.h>
+
+namespace shaka {
+namespace {
+
+// The nice value of the threads dedicated to background work. The scheduler
+// gives a thread at nice 10 about a tenth of the CPU time of a thread at 0
+// when they compete, and all of it otherwise.
+#if defined(__linux__)
+const int kBackgroundNiceValue = 10;
+#endif  // defined(__linux__)
+// How far ahead of the rate the background I/O may be, to allow for bursts.
+const absl::Duration kMaxIoBurst = absl::Milliseconds(100);
+
+MetricDurations* ThrottleDurations() {
+  static MetricDurations* const throttle_durations =
+      MetricsRegistry::GetInstance()->GetDurations(
+          "shaka_background_io_throttle_seconds",
+          "Time the background file I/O was held for the live work.");
+  return throttle_durations;
+}
+
+// The token bucket of the background I/O, as the time at which the I/O done
+// so far is within the rate.
+absl::Mutex g_io_mutex;
+absl::Time g_io_theoretical_arrival_time ABSL_GUARDED_BY(g_io_mutex);
+
+}  // namespace
+
+thread_local bool WorkPriority::background_ = false;
+std::atomic<uint64_t> WorkPriority::io_limit_{0};
+std::atomic<int> WorkPriority::live_work_{0};
+
+void WorkPriority::DedicateThreadToBackgroundWork() {
+  background_ = true;
+#if defined(__linux__)
+  // The nice value is per thread on Linux.
+  const id_t thread_id = static_cast<id_t>(syscall(SYS_gettid));
+  if (setpriority(PRIO_PROCESS, thread_id, kBackgroundNiceValue) != 0)
+    LOG(WARNING) << "Cannot lower the priority of a background thread.";
+#endif  // defined(__linux__)
+}
+
+void WorkPriority::ThrottleIoInternal(uint64_t bytes) {
+  const absl::Duration cost =
+      absl::Seconds(static_cast<double>(bytes) / background_io_limit());
+  absl::Duration wait;
+  {
+    absl::MutexLock lock(&g_io_mutex);
+    const absl::Time now = absl::Now();
+    g_io_theoretical_arrival_time =
+        std::max(g_io_theoretical_arrival_time, now - kMaxIoBurst) + cost;
+    wait = g_io_theoretical_arrival_time - now;
+  }
+  if (wait <= absl::ZeroDuration())
+    return;
+  ScopedMetricTimer timer(ThrottleDurations());
+  absl::SleepFor(wait);
+}
+
+ScopedWorkPriority::ScopedWorkPriority(bool background)
+    : background_(background),
+      previous_background_(WorkPriority::background_) {
+  WorkPriority::background_ = background_;
+  if (!background_)
+    WorkPriority::live_work_.fetch_add(1, std::memory_order_relaxed);
+}
+
+ScopedWorkPriority::~ScopedWorkPriority() {
+  if (!background_)
+    WorkPriority::live_work_.fetch_sub(1, std::memory_order_relaxed);
+  WorkPriority::background_ = previous_background_;
+}
+
+}  // namespace shaka
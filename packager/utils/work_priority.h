@@ -0,0 +1,76 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_UTILS_WORK_PRIORITY_H_
+#define PACKAGER_UTILS_WORK_PRIORITY_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace shaka {
+
+/// The priority of the work of the threads of the process. The work is live
+/// by default. Background work, e.g. VOD backfill, yields to the live work:
+/// the threads dedicated to it run at a lower scheduling priority, and while
+/// any live work runs, its file I/O is limited to a rate shared by all the
+/// background work of the process.
+class WorkPriority {
+ public:
+  /// @return whether the calling thread does background work.
+  static bool IsBackground() { return background_; }
+
+  /// Dedicate the calling thread to background work, lowering its scheduling
+  /// priority and that of the threads it creates. The priority cannot be
+  /// raised back. Only Linux supports per-thread priorities.
+  static void DedicateThreadToBackgroundWork();
+
+  /// @param bytes_per_second is the file I/O rate of the background work while
+  ///        live work runs, or 0 for no limit.
+  static void SetBackgroundIoLimit(uint64_t bytes_per_second) {
+    io_limit_.store(bytes_per_second, std::memory_order_relaxed);
+  }
+  static uint64_t background_io_limit() {
+    return io_limit_.load(std::memory_order_relaxed);
+  }
+
+  /// Waits until the calling thread may read or write |bytes|, if it does
+  /// background work while live work runs.
+  static void ThrottleIo(uint64_t bytes) {
+    if (background_ && background_io_limit() > 0 &&
+        live_work_.load(std::memory_order_relaxed) > 0) {
+      ThrottleIoInternal(bytes);
+    }
+  }
+
+ private:
+  friend class ScopedWorkPriority;
+
+  static void ThrottleIoInternal(uint64_t bytes);
+
+  static thread_local bool background_;
+  static std::atomic<uint64_t> io_limit_;
+  // The number of live work scopes.
+  static std::atomic<int> live_work_;
+};
+
+/// Sets the priority of the work of the calling thread in its scope. Live work
+/// in scope throttles the I/O of the background work.
+class ScopedWorkPriority {
+ public:
+  explicit ScopedWorkPriority(bool background);
+  ~ScopedWorkPriority();
+
+ private:
+  ScopedWorkPriority(const ScopedWorkPriority&) = delete;
+  ScopedWorkPriority& operator=(const ScopedWorkPriority&) = delete;
+
+  const bool background_;
+  const bool previous_background_;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_UTILS_WORK_PRIORITY_H_